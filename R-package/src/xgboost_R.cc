@@ -3,6 +3,8 @@
 #include <dmlc/omp.h>
 #include <dmlc/common.h>
 #include <xgboost/c_api.h>
+#include <xgboost/json.h>
+#include <xgboost/linalg.h>
 #include <vector>
 #include <string>
 #include <utility>
@@ -40,6 +42,54 @@
 
 using namespace dmlc;
 
+namespace {
+/*!
+ * \brief Array interface of a R matrix, R stores matrices in column-major so strides are
+ *        used to describe the layout without making a transposed copy.
+ */
+template <typename T>
+std::string MatrixArrayInterface(T const *data, size_t nrow, size_t ncol) {
+  xgboost::linalg::TensorView<T const, 2> view{
+      xgboost::common::Span<T const>{data, nrow * ncol}, {nrow, ncol}, {1, nrow}, -1};
+  return xgboost::linalg::ArrayInterfaceStr(view);
+}
+
+std::string MatrixArrayInterface(SEXP mat) {
+  SEXP dim = getAttrib(mat, R_DimSymbol);
+  size_t nrow = static_cast<size_t>(INTEGER(dim)[0]);
+  size_t ncol = static_cast<size_t>(INTEGER(dim)[1]);
+  if (TYPEOF(mat) == INTSXP) {
+    return MatrixArrayInterface(INTEGER(mat), nrow, ncol);
+  }
+  return MatrixArrayInterface(REAL(mat), nrow, ncol);
+}
+
+/*!
+ * \brief Convert prediction returned by the C API into a list of shape and result.
+ */
+SEXP MakePrediction(bst_ulong const *out_shape, bst_ulong out_dim, float const *out_result) {
+  SEXP r_out_shape = PROTECT(allocVector(INTSXP, out_dim));
+  size_t len = 1;
+  for (size_t i = 0; i < out_dim; ++i) {
+    INTEGER(r_out_shape)[i] = out_shape[i];
+    len *= out_shape[i];
+  }
+  SEXP r_out_result = PROTECT(allocVector(REALSXP, len));
+  double *p_result = REAL(r_out_result);
+
+#pragma omp parallel for
+  for (omp_ulong i = 0; i < len; ++i) {
+    p_result[i] = out_result[i];
+  }
+
+  SEXP r_out = PROTECT(allocVector(VECSXP, 2));
+  SET_VECTOR_ELT(r_out, 0, r_out_shape);
+  SET_VECTOR_ELT(r_out, 1, r_out_result);
+  UNPROTECT(3);
+  return r_out;
+}
+}  // anonymous namespace
+
 XGB_DLL SEXP XGCheckNullPtr_R(SEXP handle) {
   return ScalarLogical(R_ExternalPtrAddr(handle) == NULL);
 }
@@ -82,33 +132,16 @@ XGB_DLL SEXP XGDMatrixCreateFromFile_R(SEXP fname, SEXP silent) {
 XGB_DLL SEXP XGDMatrixCreateFromMat_R(SEXP mat, SEXP missing, SEXP n_threads) {
   SEXP ret;
   R_API_BEGIN();
-  SEXP dim = getAttrib(mat, R_DimSymbol);
-  size_t nrow = static_cast<size_t>(INTEGER(dim)[0]);
-  size_t ncol = static_cast<size_t>(INTEGER(dim)[1]);
-  const bool is_int = TYPEOF(mat) == INTSXP;
-  double *din;
-  int *iin;
-  if (is_int) {
-    iin = INTEGER(mat);
-  } else {
-    din = REAL(mat);
-  }
-  std::vector<float> data(nrow * ncol);
-  dmlc::OMPException exc;
-  int32_t threads = xgboost::common::OmpGetNumThreads(asInteger(n_threads));
-
-#pragma omp parallel for schedule(static) num_threads(threads)
-  for (omp_ulong i = 0; i < nrow; ++i) {
-    exc.Run([&]() {
-      for (size_t j = 0; j < ncol; ++j) {
-        data[i * ncol +j] = is_int ? static_cast<float>(iin[i + nrow * j]) : din[i + nrow * j];
-      }
-    });
-  }
-  exc.Rethrow();
+  // The matrix is read in place through its array interface.
+  std::string array_interface = MatrixArrayInterface(mat);
+  xgboost::Json config{xgboost::Object{}};
+  config["missing"] = xgboost::Number{static_cast<float>(asReal(missing))};
+  config["nthread"] = xgboost::Integer{
+      static_cast<int64_t>(xgboost::common::OmpGetNumThreads(asInteger(n_threads)))};
+  std::string c_config;
+  xgboost::Json::Dump(config, &c_config);
   DMatrixHandle handle;
-  CHECK_CALL(XGDMatrixCreateFromMat_omp(BeginPtr(data), nrow, ncol,
-                                        asReal(missing), &handle, threads));
+  CHECK_CALL(XGDMatrixCreateFromDense(array_interface.c_str(), c_config.c_str(), &handle));
   ret = PROTECT(R_MakeExternalPtr(handle, R_NilValue, R_NilValue));
   R_RegisterCFinalizerEx(ret, _DMatrixFinalizer, TRUE);
   R_API_END();
@@ -377,8 +410,6 @@ XGB_DLL SEXP XGBoosterPredict_R(SEXP handle, SEXP dmat, SEXP option_mask,
 }
 
 XGB_DLL SEXP XGBoosterPredictFromDMatrix_R(SEXP handle, SEXP dmat, SEXP json_config)  {
-  SEXP r_out_shape;
-  SEXP r_out_result;
   SEXP r_out;
 
   R_API_BEGIN();
@@ -390,27 +421,35 @@ XGB_DLL SEXP XGBoosterPredictFromDMatrix_R(SEXP handle, SEXP dmat, SEXP json_con
   CHECK_CALL(XGBoosterPredictFromDMatrix(R_ExternalPtrAddr(handle),
                                          R_ExternalPtrAddr(dmat), c_json_config,
                                          &out_shape, &out_dim, &out_result));
+  r_out = PROTECT(MakePrediction(out_shape, out_dim, out_result));
+  R_API_END();
+  UNPROTECT(1);
 
-  r_out_shape = PROTECT(allocVector(INTSXP, out_dim));
-  size_t len = 1;
-  for (size_t i = 0; i < out_dim; ++i) {
-    INTEGER(r_out_shape)[i] = out_shape[i];
-    len *= out_shape[i];
-  }
-  r_out_result = PROTECT(allocVector(REALSXP, len));
-
-#pragma omp parallel for
-  for (omp_ulong i = 0; i < len; ++i) {
-    REAL(r_out_result)[i] = out_result[i];
-  }
+  return r_out;
+}
 
-  r_out = PROTECT(allocVector(VECSXP, 2));
+XGB_DLL SEXP XGBoosterPredictFromDense_R(SEXP handle, SEXP mat, SEXP missing,
+                                         SEXP json_config) {
+  SEXP r_out;
 
-  SET_VECTOR_ELT(r_out, 0, r_out_shape);
-  SET_VECTOR_ELT(r_out, 1, r_out_result);
+  R_API_BEGIN();
+  std::string array_interface = MatrixArrayInterface(mat);
+  char const *c_json_config = CHAR(asChar(json_config));
+  auto config = xgboost::Json::Load(xgboost::StringView{c_json_config});
+  config["missing"] = xgboost::Number{static_cast<float>(asReal(missing))};
+  config["cache_id"] = xgboost::Integer{static_cast<int64_t>(0)};
+  std::string c_config;
+  xgboost::Json::Dump(config, &c_config);
 
+  bst_ulong out_dim;
+  bst_ulong const *out_shape;
+  float const *out_result;
+  CHECK_CALL(XGBoosterPredictFromDense(R_ExternalPtrAddr(handle), array_interface.c_str(),
+                                       c_config.c_str(), nullptr, &out_shape, &out_dim,
+                                       &out_result));
+  r_out = PROTECT(MakePrediction(out_shape, out_dim, out_result));
   R_API_END();
-  UNPROTECT(3);
+  UNPROTECT(1);
 
   return r_out;
 }
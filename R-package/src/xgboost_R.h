@@ -185,6 +185,19 @@ XGB_DLL SEXP XGBoosterPredict_R(SEXP handle, SEXP dmat, SEXP option_mask,
  * \return A list containing 2 vectors, first one for shape while second one for prediction result.
  */
 XGB_DLL SEXP XGBoosterPredictFromDMatrix_R(SEXP handle, SEXP dmat, SEXP json_config);
+/*!
+ * \brief Run inplace prediction on a dense R matrix without creating DMatrix, the matrix
+ *        is read in column-major without copying.
+ * \param handle handle
+ * \param mat R Matrix object, either numeric or integer
+ * \param missing which value to represent missing value
+ * \param json_config See `XGBoosterPredictFromDense` in xgboost c_api.h, `missing` and
+ *        `cache_id` are filled in.
+ *
+ * \return A list containing 2 vectors, first one for shape while second one for prediction result.
+ */
+XGB_DLL SEXP XGBoosterPredictFromDense_R(SEXP handle, SEXP mat, SEXP missing,
+                                         SEXP json_config);
 /*!
  * \brief load model from existing file
  * \param handle handle
@@ -16,6 +16,7 @@
 #include "../src/metric/rank_metric.cc"
 #include "../src/metric/auc.cc"
 #include "../src/metric/survival_metric.cc"
+#include "../src/metric/plugin_metric.cc"
 
 // objectives
 #include "../src/objective/objective.cc"
@@ -24,6 +25,7 @@
 #include "../src/objective/rank_obj.cc"
 #include "../src/objective/hinge.cc"
 #include "../src/objective/aft_obj.cc"
+#include "../src/objective/plugin_obj.cc"
 
 // gbms
 #include "../src/gbm/gbm.cc"
@@ -36,18 +38,30 @@
 #include "../src/data/data.cc"
 #include "../src/data/simple_dmatrix.cc"
 #include "../src/data/sparse_page_raw_format.cc"
+#include "../src/data/sparse_page_compressed_format.cc"
 #include "../src/data/ellpack_page.cc"
 #include "../src/data/gradient_index.cc"
 #include "../src/data/gradient_index_page_source.cc"
 #include "../src/data/gradient_index_format.cc"
 #include "../src/data/sparse_page_dmatrix.cc"
 #include "../src/data/proxy_dmatrix.cc"
+#include "../src/data/iterative_dmatrix.cc"
+#include "../src/data/text_parser.cc"
+#include "../src/data/slice_dmatrix.cc"
 
 // prediction
 #include "../src/predictor/predictor.cc"
 #include "../src/predictor/cpu_predictor.cc"
+#include "../src/predictor/flat_forest.cc"
+#include "../src/predictor/simd_traversal.cc"
+#include "../src/predictor/quickscorer_predictor.cc"
+#include "../src/predictor/compiled_forest.cc"
+#include "../src/predictor/compiled_predictor.cc"
+#include "../src/predictor/tree_shap.cc"
+#include "../src/predictor/row_cache.cc"
 
 // trees
+#include "../src/tree/compact_tree.cc"
 #include "../src/tree/param.cc"
 #include "../src/tree/tree_model.cc"
 #include "../src/tree/tree_updater.cc"
@@ -69,16 +83,24 @@
 #include "../src/logging.cc"
 #include "../src/global_config.cc"
 #include "../src/common/common.cc"
+#include "../src/common/base64.cc"
 #include "../src/common/random.cc"
 #include "../src/common/charconv.cc"
 #include "../src/common/timer.cc"
 #include "../src/common/quantile.cc"
 #include "../src/common/host_device_vector.cc"
 #include "../src/common/hist_util.cc"
+#include "../src/common/hist_simd.cc"
+#include "../src/common/feature_bundle.cc"
+#include "../src/common/column_subset.cc"
+#include "../src/common/missing_bin.cc"
+#include "../src/common/category_dictionary.cc"
 #include "../src/common/json.cc"
 #include "../src/common/io.cc"
+#include "../src/common/compression.cc"
 #include "../src/common/survival_util.cc"
 #include "../src/common/version.cc"
+#include "../src/common/plugin_loader.cc"
 
 // c_api
 #include "../src/c_api/c_api.cc"
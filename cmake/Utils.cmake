@@ -130,6 +130,20 @@ macro(enable_nvtx target)
   target_compile_definitions(${target} PRIVATE -DXGBOOST_USE_NVTX=1)
 endmacro()
 
+macro(enable_itt target)
+  find_package(ITT REQUIRED)
+  target_include_directories(${target} PRIVATE "${ITT_INCLUDE_DIR}")
+  target_link_libraries(${target} PRIVATE "${ITT_LIBRARY}" ${CMAKE_DL_LIBS})
+  target_compile_definitions(${target} PRIVATE -DXGBOOST_USE_ITT=1)
+endmacro()
+
+macro(enable_rsocket target)
+  find_package(RSocket REQUIRED)
+  target_include_directories(${target} PRIVATE "${RSOCKET_INCLUDE_DIR}")
+  target_link_libraries(${target} PRIVATE "${RSOCKET_LIBRARY}")
+  target_compile_definitions(${target} PRIVATE -DRABIT_USE_RSOCKET=1)
+endmacro()
+
 # Set CUDA related flags to target.  Must be used after code `format_gencode_flags`.
 function(xgboost_set_cuda_flags target)
   target_compile_options(${target} PRIVATE
@@ -209,7 +223,9 @@ macro(xgboost_target_properties target)
   target_compile_options(${target}
     PRIVATE
     $<$<AND:$<CXX_COMPILER_ID:MSVC>,$<COMPILE_LANGUAGE:CXX>>:/MP>
-    $<$<AND:$<NOT:$<CXX_COMPILER_ID:MSVC>>,$<COMPILE_LANGUAGE:CXX>>:-funroll-loops>)
+    $<$<AND:$<NOT:$<CXX_COMPILER_ID:MSVC>>,$<COMPILE_LANGUAGE:CXX>>:-funroll-loops>
+    # Floating point exceptions are not used, let loops with float comparisons vectorize.
+    $<$<AND:$<NOT:$<CXX_COMPILER_ID:MSVC>>,$<COMPILE_LANGUAGE:CXX>>:-fno-trapping-math>)
 
   if (MSVC)
     target_compile_options(${target} PRIVATE
@@ -275,7 +291,15 @@ macro(xgboost_target_link_libraries target)
     enable_nvtx(${target})
   endif (USE_NVTX)
 
+  if (USE_ITT)
+    enable_itt(${target})
+  endif (USE_ITT)
+
   if (RABIT_BUILD_MPI)
     target_link_libraries(${target} PRIVATE MPI::MPI_CXX)
   endif (RABIT_BUILD_MPI)
+
+  if (RABIT_USE_RSOCKET)
+    enable_rsocket(${target})
+  endif (RABIT_USE_RSOCKET)
 endmacro(xgboost_target_link_libraries)
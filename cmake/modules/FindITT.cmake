@@ -0,0 +1,24 @@
+if (ITT_LIBRARY)
+  unset(ITT_LIBRARY CACHE)
+endif (ITT_LIBRARY)
+
+set(ITT_LIB_NAME ittnotify)
+
+find_path(ITT_INCLUDE_DIR
+  NAMES ittnotify.h
+  PATHS ${VTUNE_HOME}/include $ENV{VTUNE_PROFILER_DIR}/include /opt/intel/oneapi/vtune/latest/include)
+
+find_library(ITT_LIBRARY
+  NAMES ittnotify
+  PATHS ${VTUNE_HOME}/lib64 $ENV{VTUNE_PROFILER_DIR}/lib64 /opt/intel/oneapi/vtune/latest/lib64)
+
+message(STATUS "Using itt library: ${ITT_LIBRARY}")
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(ITT DEFAULT_MSG
+                                  ITT_INCLUDE_DIR ITT_LIBRARY)
+
+mark_as_advanced(
+  ITT_INCLUDE_DIR
+  ITT_LIBRARY
+)
@@ -0,0 +1,22 @@
+if (RSOCKET_LIBRARY)
+  unset(RSOCKET_LIBRARY CACHE)
+endif (RSOCKET_LIBRARY)
+
+find_path(RSOCKET_INCLUDE_DIR
+  NAMES rdma/rsocket.h
+  PATHS ${RDMA_HOME}/include $ENV{RDMA_HOME}/include)
+
+find_library(RSOCKET_LIBRARY
+  NAMES rdmacm
+  PATHS ${RDMA_HOME}/lib64 ${RDMA_HOME}/lib $ENV{RDMA_HOME}/lib64 $ENV{RDMA_HOME}/lib)
+
+message(STATUS "Using rdmacm library: ${RSOCKET_LIBRARY}")
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(RSocket DEFAULT_MSG
+                                  RSOCKET_INCLUDE_DIR RSOCKET_LIBRARY)
+
+mark_as_advanced(
+  RSOCKET_INCLUDE_DIR
+  RSOCKET_LIBRARY
+)
@@ -9,6 +9,7 @@
 #include <dmlc/base.h>
 #include <dmlc/omp.h>
 #include <cmath>
+#include <functional>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -261,6 +262,11 @@ using GradientPairPrecise = detail::GradientPairInternal<double>;
 using GradientPairInt32 = detail::GradientPairInternal<int>;
 /*! \brief Fixed point representation for high precision gradient pair. */
 using GradientPairInt64 = detail::GradientPairInternal<int64_t>;
+/*!
+ * \brief Computes gradient of rows in [begin, end) into a pre-allocated gradient vector.
+ *        Used for fusing gradient computation into the first pass over data.
+ */
+using GradientSource = std::function<void(size_t begin, size_t end)>;
 
 using Args = std::vector<std::pair<std::string, std::string> >;
 
@@ -30,6 +30,10 @@ typedef uint64_t bst_ulong;  // NOLINT(*)
 typedef void *DMatrixHandle;  // NOLINT(*)
 /*! \brief handle to Booster */
 typedef void *BoosterHandle;  // NOLINT(*)
+/*! \brief handle to prediction session */
+typedef void *PredictionSessionHandle;  // NOLINT(*)
+/*! \brief handle to result of asynchronous prediction */
+typedef void *PredictFutureHandle;  // NOLINT(*)
 
 /*!
  * \brief Return the version of the XGBoost library being currently used.
@@ -89,6 +93,50 @@ XGB_DLL int XGBSetGlobalConfig(const char* json_str);
  */
 XGB_DLL int XGBGetGlobalConfig(const char** json_str);
 
+/*!
+ * \brief Load a shared library registering objectives and metrics implemented with the C
+ *        interface in `xgboost/plugin_abi.h`.  Registered names can then be used as
+ *        `objective` and `eval_metric` parameters of any booster in the process.  The
+ *        library is never unloaded, loading the same path again is a no-op.
+ * \param path Path to the shared library.
+ * \return 0 for success, -1 for failure
+ */
+XGB_DLL int XGBLoadPlugin(char const *path);
+
+/*!
+ * \brief Start recording the begin/end events of internal timers for all threads.
+ *        Events from the previous recording session are discarded.
+ * \param json_config JSON encoded configuration, can be NULL.  Accepted keys:
+ *                    - buffer_size: Maximum number of events kept for each thread, older
+ *                      events are overwritten.  Default to 65536.
+ * \return 0 for success, -1 for failure
+ */
+XGB_DLL int XGBTraceStart(char const* json_config);
+
+/*!
+ * \brief Stop recording events and dump them in the Chrome trace event format, which
+ *        can be loaded by Perfetto or chrome://tracing.  Process ID of the events is
+ *        the rank of worker.
+ * \param out_trace pointer to received JSON string, valid until next call to the
+ *                  function in current thread.
+ * \return 0 for success, -1 for failure
+ */
+XGB_DLL int XGBTraceStop(char const** out_trace);
+
+/*!
+ * \brief Get current and peak bytes held by major buffers, grouped by owner.  Tracking
+ *        is enabled by the `track_memory` global parameter, buffers allocated before
+ *        that are not accounted for.
+ * \param json_config JSON encoded configuration, can be NULL.  Accepted keys:
+ *                    - reset_peak: Set the peak to current usage after reading.  Default
+ *                      to false.
+ * \param out_str Pointer to received JSON object in the form of
+ *                {"owner": {"current": bytes, "peak": bytes}}, valid until next call to
+ *                the function in current thread.
+ * \return 0 for success, -1 for failure
+ */
+XGB_DLL int XGBGetMemoryUsage(char const* json_config, char const** out_str);
+
 /*!
  * \brief load a data matrix
  * \param fname the name of the file
@@ -219,6 +267,31 @@ XGB_DLL int XGDMatrixCreateFromDT(void** data,
                                   DMatrixHandle* out,
                                   int nthread);
 
+/*!
+ * \brief Create a matrix from arrow record batch exported through Arrow C data interface.
+ *        Null values are treated as missing and dictionary encoded columns are treated as
+ *        categorical features, with the dictionary indices being the category.  Field
+ *        names are used as feature names.  The input is not released by XGBoost.
+ *
+ *        String columns and dictionaries of strings are categorical features encoded by a
+ *        dictionary of categories kept with the DMatrix.  Boosters trained on the DMatrix
+ *        save the dictionary in the model, other DMatrix are recoded with the model's
+ *        dictionary before prediction, and categories unknown to the model are treated as
+ *        missing.
+ *
+ * \param array       Pointer to `struct ArrowArray` of the record batch (a struct array).
+ * \param schema      Pointer to `struct ArrowSchema` of the record batch.
+ * \param json_config JSON encoded configuration.  Required values are:
+ *
+ *          - missing
+ *          - nthread
+ *
+ * \param out created dmatrix
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixCreateFromArrow(void *array, void *schema, char const *json_config,
+                                     DMatrixHandle *out);
+
 /*!
  * \brief Create DMatrix from CUDA columnar format. (cuDF)
  * \param data Array of JSON encoded __cuda_array_interface__ for each column.
@@ -278,6 +351,7 @@ XGB_DLL int XGDMatrixCreateFromCudaArrayInterface(char const *data,
  * # Factory functions
  * - \ref XGDMatrixCreateFromCallback for external memory
  * - \ref XGDeviceQuantileDMatrixCreateFromCallback for quantile DMatrix
+ * - \ref XGQuantileDMatrixCreateFromCallback for quantile DMatrix on CPU
  *
  * # Proxy that callers can use to pass data to XGBoost
  * - \ref XGProxyDMatrixCreate
@@ -410,6 +484,20 @@ XGB_EXTERN_C typedef void DataIterResetCallback(DataIterHandle handle); // NOLIN
  *   - missing:      Which value to represent missing value
  *   - cache_prefix: The path of cache file, caller must initialize all the directories in this path.
  *   - nthread (optional): Number of threads used for initializing DMatrix.
+ *   - page_format (optional): Format of cache pages, "raw" (default) or "compressed".  The
+ *     compressed format produces smaller cache files at the cost of extra CPU time, which
+ *     is spent in the prefetching threads.
+ *   - prefetch_batches (optional): Number of batches read ahead on a background thread
+ *     while the current batch is written to cache, 0 (default) calls `next` synchronously.
+ *     See \ref XGQuantileDMatrixCreateFromCallback for the thread-safety requirements.
+ *   - memory_budget (optional): When positive, data is loaded into memory first and only
+ *     spilled to cache files with `cache_prefix` when the raw data plus the estimated size
+ *     of its gradient index exceeds this number of bytes.
+ *   - quantized_checkpoint (optional): Keep the quantized data used by the CPU `hist` tree
+ *     method in a file named after `cache_prefix` that is not removed with the DMatrix.
+ *     When the file exists and matches the data and parameters, it's loaded instead of
+ *     sketching and quantizing the data again, for example by workers restarted after a
+ *     failure.  In distributed training it's used only if all workers have a valid file.
  *
  * \param[out] out      The created external memory DMatrix
  *
@@ -451,6 +539,50 @@ XGB_DLL int XGDeviceQuantileDMatrixCreateFromCallback(
     XGDMatrixCallbackNext *next, float missing, int nthread, int max_bin,
     DMatrixHandle *out);
 
+/*!
+ * \brief Create a Quantile DMatrix with data iterator for the CPU `hist` tree method.
+ *
+ * Usage is the same as \ref XGDeviceQuantileDMatrixCreateFromCallback, but the data is
+ * quantized into a gradient index on host memory.  The iterator is consumed 3 times, for
+ * obtaining the shape of data, sketching and quantization respectively.  Raw data is not
+ * kept nor written to any cache, so only one batch needs to be resident in memory.
+ *
+ * With a reference DMatrix, the data is quantized with the histogram cuts of the reference
+ * and the sketching pass is skipped.  This is useful for training continuation on
+ * successive micro-batches, as the cost of construction only depends on the new batch and
+ * the histogram buffers of the `hist` updater are reused between updates.
+ *
+ * \param iter           A handle to external data iterator.
+ * \param proxy          A DMatrix proxy handle created by `XGProxyDMatrixCreate`.
+ * \param ref            Optional reference DMatrix providing the histogram cuts, can be
+ *                       NULL.  It must have the same number of features and be quantized
+ *                       with the same `max_bin`, for instance another Quantile DMatrix or the
+ *                       training DMatrix of `hist` tree method.
+ * \param reset          Callback function resetting the iterator state.
+ * \param next           Callback function yielding the next batch of data.
+ * \param c_json_config  JSON encoded parameters for DMatrix construction.  Accepted fields are:
+ *
+ *   - missing: Which value to represent missing value.
+ *   - max_bin: Maximum number of bins for building histogram.
+ *   - nthread (optional): Number of threads used for initializing DMatrix.
+ *   - prefetch_batches (optional): Number of batches read ahead on a background thread
+ *     while the current batch is sketched or quantized, 0 (default) calls `next`
+ *     synchronously.  When positive, `reset` and `next` may be called from a thread
+ *     other than the caller of this function.  They are never called concurrently, and data set
+ *     on the proxy is copied before the next call to `next`, so it only needs to stay
+ *     valid until then.  Memory usage grows by one copied batch for each prefetched batch.
+ *
+ * \param[out] out       The created Quantile DMatrix
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGQuantileDMatrixCreateFromCallback(DataIterHandle iter, DMatrixHandle proxy,
+                                                DMatrixHandle ref,
+                                                DataIterResetCallback *reset,
+                                                XGDMatrixCallbackNext *next,
+                                                char const *c_json_config,
+                                                DMatrixHandle *out);
+
 /*!
  * \brief Set data on a DMatrix proxy.
  *
@@ -535,6 +667,36 @@ XGB_DLL int XGDMatrixSliceDMatrixEx(DMatrixHandle handle,
                                     bst_ulong len,
                                     DMatrixHandle *out,
                                     int allow_groups);
+/*!
+ * \brief Create a view of selected rows in an existing matrix.  Unlike
+ *        `XGDMatrixSliceDMatrixEx`, the data is not copied.  The view refers to the original
+ *        matrix, which is kept alive until the view is freed, and gathers the quantized data
+ *        from it when needed.
+ * \param handle instance of data matrix to be sliced
+ * \param idxset index set
+ * \param len length of index set
+ * \param out a view of the matrix
+ * \param allow_groups allow slicing of an array with groups
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixSliceDMatrixView(DMatrixHandle handle,
+                                      const int *idxset,
+                                      bst_ulong len,
+                                      DMatrixHandle *out,
+                                      int allow_groups);
+/*!
+ * \brief Build the quantized data used by the `hist` tree method ahead of training.  The
+ *        result is cached in the DMatrix and shared by all boosters trained on it with the
+ *        same `max_bin`, including boosters trained concurrently from different threads.
+ * \param handle instance of data matrix
+ * \param json_config JSON encoded parameters, with the following keys:
+ *
+ *   - max_bin: Maximum number of bins for each feature.
+ *   - sparse_threshold: Same as the training parameter, used to build the column matrix.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixQuantize(DMatrixHandle handle, char const *json_config);
 /*!
  * \brief free space in data matrix
  * \return 0 when success, -1 when failure happens
@@ -549,6 +711,22 @@ XGB_DLL int XGDMatrixFree(DMatrixHandle handle);
  */
 XGB_DLL int XGDMatrixSaveBinary(DMatrixHandle handle,
                                 const char *fname, int silent);
+/*!
+ * \brief Save a data matrix into binary file, optionally with the quantized data used by
+ *        the `hist` tree method.  Loading a file with quantized data doesn't need to sketch
+ *        the data again when training with the same `max_bin`.
+ * \param handle a instance of data matrix
+ * \param fname file name
+ * \param json_config JSON encoded parameters, with the following keys:
+ *
+ *   - max_bin (optional): When specified, the quantized data for `max_bin` is saved
+ *     along with the raw data.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGDMatrixSaveBinaryEx(DMatrixHandle handle, const char *fname,
+                                  char const *json_config);
+
 
 /*!
  * \brief Set content in array interface to a content in info.
@@ -778,6 +956,19 @@ XGB_DLL int XGBoosterSlice(BoosterHandle handle, int begin_layer,
  */
 XGB_DLL int XGBoosterBoostedRounds(BoosterHandle handle, int* out);
 
+/*!
+ * \brief Get performance counters, like number of rows accumulated into histograms and
+ *        bytes passed to allreduce.  Counters are shared by all boosters in the process,
+ *        calling this with reset after each iteration obtains per-iteration values.
+ * \param handle Handle to booster.
+ * \param json_config JSON encoded configuration, can be NULL.  Accepted keys:
+ *                    - reset: Start counting from 0 after reading.  Default to false.
+ * \param out_str Pointer to received flat JSON object mapping counter names to values.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterGetPerfCounters(BoosterHandle handle, char const *json_config,
+                                     char const **out_str);
+
 /*!
  * \brief set parameters
  * \param handle handle
@@ -822,6 +1013,24 @@ XGB_DLL int XGBoosterBoostOneIter(BoosterHandle handle,
                                   float *grad,
                                   float *hess,
                                   bst_ulong len);
+
+/*!
+ * \brief Update the model with gradient given by array interface, the gradient is copied
+ *        once into the booster without staging through a separate float buffer.
+ *
+ * \param handle Booster handle.
+ * \param dtrain Training data.
+ * \param iter   Current iteration round.
+ * \param grad   JSON encoded __(cuda_)array_interface__.  When `hess` is NULL, it's a
+ *               (n_samples, 2) array with gradient and hessian interleaved, which is
+ *               copied with a single memcpy when the type is float32 and the array is
+ *               contiguous.  Otherwise it's a vector of gradient.
+ * \param hess   JSON encoded __(cuda_)array_interface__ for hessian, or NULL.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterBoostOneIterFromInterface(BoosterHandle handle, DMatrixHandle dtrain,
+                                               int iter, char const *grad, char const *hess);
 /*!
  * \brief get evaluation statistics for xgboost
  * \param handle handle
@@ -838,6 +1047,80 @@ XGB_DLL int XGBoosterEvalOneIter(BoosterHandle handle,
                                  const char *evnames[],
                                  bst_ulong len,
                                  const char **out_result);
+/*!
+ * \brief Split an evaluation dataset into cohorts.  XGBoosterEvalOneIter then reports the
+ *        metrics of each non-empty cohort as `name[cohort]-metric` after the whole dataset,
+ *        computed from a single prediction.
+ * \param handle  handle
+ * \param dmat    data to be evaluated
+ * \param cohorts cohort id of each row
+ * \param len     length of cohorts, either the number of rows or 0 to remove the cohorts
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterSetEvalCohorts(BoosterHandle handle, DMatrixHandle dmat,
+                                    unsigned const *cohorts, bst_ulong len);
+
+/*!
+ * \brief Run the training loop natively, evaluating the model with cached predictions and
+ *        stopping early when the score on the last evaluation dataset stops improving.
+ *        Rounds are added on top of the current model.
+ *
+ * \param handle             handle
+ * \param dtrain             training data
+ * \param dmats              pointers to data to be evaluated
+ * \param len                length of dmats
+ * \param config             JSON encoded configuration, with following keys:
+ *
+ *     - num_boost_round: int, number of boosting rounds.
+ *     - early_stopping_rounds: int, optional, 0 (default) disables early stopping.
+ *     - eval_period: int, optional, evaluate every this many rounds, default to 1.  The last
+ *       round is always evaluated.
+ *     - metric: str, optional, metric for early stopping, default to the last metric.
+ *     - maximize: bool, optional, inferred from the name of metric by default.
+ *
+ * \param out_n_rounds       number of rounds boosted.
+ * \param out_best_iteration iteration with the best score, -1 if nothing is evaluated.
+ * \param out_best_score     score of the best iteration.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterTrain(BoosterHandle handle, DMatrixHandle dtrain, DMatrixHandle dmats[],
+                           bst_ulong len, char const *config, bst_ulong *out_n_rounds,
+                           int *out_best_iteration, double *out_best_score);
+
+/*!
+ * \brief Train boosters with different configurations on the same training data
+ *        concurrently, dividing threads among them and stopping the worst boosters with
+ *        successive halving.  Quantized data is shared by boosters with the same `max_bin`.
+ *
+ * \param handles            boosters to be trained
+ * \param n_boosters         length of handles
+ * \param dtrain             training data
+ * \param dmats              pointers to data to be evaluated, boosters are ranked by the
+ *                           last one
+ * \param len                length of dmats
+ * \param config             JSON encoded configuration, with following keys:
+ *
+ *     - num_boost_round: int, maximum number of boosting rounds.
+ *     - rung_rounds: int, optional, boosters are ranked every this many rounds, 0 (default)
+ *       trains all boosters for `num_boost_round`.
+ *     - keep_ratio: float, optional, fraction of boosters continuing after each rung,
+ *       default to 0.5.
+ *     - metric: str, optional, metric for ranking, default to the last metric.
+ *     - maximize: bool, optional, inferred from the name of metric by default.
+ *     - nthread: int, optional, total number of threads, default to all available.
+ *
+ * \param out_n_rounds       caller allocated array of n_boosters, rounds boosted by each
+ *                           booster.
+ * \param out_best_iteration caller allocated array of n_boosters, iteration with the best
+ *                           score for each booster, -1 if nothing is evaluated.
+ * \param out_best_score     caller allocated array of n_boosters, best score of each
+ *                           booster.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterTrainSweep(BoosterHandle handles[], bst_ulong n_boosters,
+                                DMatrixHandle dtrain, DMatrixHandle dmats[], bst_ulong len,
+                                char const *config, bst_ulong *out_n_rounds,
+                                int *out_best_iteration, double *out_best_score);
 
 /*!
  * \brief make prediction based on dmat (deprecated, use `XGBoosterPredictFromDMatrix` instead)
@@ -931,6 +1214,166 @@ XGB_DLL int XGBoosterPredictFromDMatrix(BoosterHandle handle,
                                         bst_ulong const **out_shape,
                                         bst_ulong *out_dim,
                                         float const **out_result);
+/*!
+ * \brief Create a prediction session with fixed configuration.  The configuration is
+ *        parsed only once, and each thread invoking the session reuses its own output
+ *        buffers.  The session can be used concurrently from multiple threads.
+ *
+ * \param handle        Booster handle, must outlive the session.
+ * \param c_json_config See `XGBoosterPredictFromDMatrix` for more info.
+ * \param out           Created prediction session.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterCreatePredictionSession(BoosterHandle handle,
+                                             char const *c_json_config,
+                                             PredictionSessionHandle *out);
+/*!
+ * \brief Make prediction from DMatrix with a prediction session.
+ *
+ * \param handle     Prediction session handle.
+ * \param dmat       DMatrix handle.
+ * \param out_shape  See `XGBoosterPredictFromDMatrix` for more info.
+ * \param out_dim    See `XGBoosterPredictFromDMatrix` for more info.
+ * \param out_result Buffer storing prediction value, valid until next call to the same
+ *                   session from the same thread.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGPredictionSessionPredictFromDMatrix(PredictionSessionHandle handle,
+                                                  DMatrixHandle dmat,
+                                                  bst_ulong const **out_shape,
+                                                  bst_ulong *out_dim,
+                                                  float const **out_result);
+/*!
+ * \brief Free a prediction session.
+ *
+ * \param handle Prediction session handle.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGPredictionSessionFree(PredictionSessionHandle handle);
+
+/*!
+ * \brief Callback of asynchronous prediction, invoked on a worker thread once the
+ *        prediction is finished.
+ *
+ * \param user_data User data passed to the prediction call.
+ * \param status    0 when success, -1 when failure happens.
+ * \param error     Error message when failed, NULL otherwise.  Only valid during the call.
+ */
+XGB_EXTERN_C typedef void XGBPredictCallback(void *user_data, int status,  // NOLINT(*)
+                                             char const *error);
+
+/*!
+ * \brief Make prediction from DMatrix asynchronously with a prediction session.  The
+ *        prediction is queued onto an internal thread pool and this function returns
+ *        immediately.  The session, the DMatrix and the output buffer must stay valid until
+ *        the prediction is finished.
+ *
+ * \param handle     Prediction session handle.
+ * \param dmat       DMatrix handle.
+ * \param out_result Caller owned output buffer for the flat prediction, see
+ *                   `XGBoosterPredictFromDMatrix` for the shape.
+ * \param out_len    Length of the output buffer, prediction fails if it's too small.
+ * \param callback   Optional (NULL if not needed) callback invoked when finished.
+ * \param user_data  Passed to the callback.
+ * \param out_future Optional (NULL if not needed) handle for waiting the result, must be
+ *                   freed by `XGPredictFutureFree`.
+ *
+ * \return 0 when the prediction is queued, -1 when failure happens
+ */
+XGB_DLL int XGPredictionSessionPredictAsync(PredictionSessionHandle handle,
+                                            DMatrixHandle dmat, float *out_result,
+                                            bst_ulong out_len, XGBPredictCallback *callback,
+                                            void *user_data, PredictFutureHandle *out_future);
+/*!
+ * \brief Wait for an asynchronous prediction to finish.  The callback, if any, has returned
+ *        when this function returns.
+ *
+ * \param handle Future handle.
+ *
+ * \return 0 when the prediction succeeded, -1 when it failed with the error available
+ *         from `XGBGetLastError`
+ */
+XGB_DLL int XGPredictFutureWait(PredictFutureHandle handle);
+/*!
+ * \brief Check whether an asynchronous prediction has finished without blocking.
+ *
+ * \param handle    Future handle.
+ * \param out_ready 1 if finished, 0 otherwise.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGPredictFutureReady(PredictFutureHandle handle, int *out_ready);
+/*!
+ * \brief Free a future handle.  The prediction itself is not cancelled.
+ *
+ * \param handle Future handle.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGPredictFutureFree(PredictFutureHandle handle);
+
+/*!
+ * \brief Cascaded prediction with early exit for models with a single output group.  Trees
+ *        are evaluated in stages, rows whose partial margin falls outside of
+ *        [margin_lower, margin_upper] after a stage are not evaluated any further.
+ *
+ * \param handle        Booster handle.
+ * \param dmat          DMatrix handle.
+ * \param c_json_config String encoded prediction configuration in JSON format, with
+ *                      following available fields in the JSON object:
+ *
+ *    "stage_rounds": int
+ *      Number of boosting rounds in each stage.
+ *    "margin_lower": float
+ *      Rows with partial margin below this value stop.
+ *    "margin_upper": float
+ *      Rows with partial margin above this value stop.
+ *    "output_margin": bool
+ *      Whether to output the raw margin instead of the transformed prediction.
+ *    "iteration_begin": int
+ *      Beginning iteration of prediction.
+ *    "iteration_end": int
+ *      End iteration of prediction.  Set to 0 to use all trees.
+ *
+ * \param out_result    Predictions, one value for each row.
+ * \param out_n_trees   Number of trees evaluated for each row.
+ * \param out_len       Number of rows.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterPredictCascade(BoosterHandle handle, DMatrixHandle dmat,
+                                    char const *c_json_config, float const **out_result,
+                                    uint32_t const **out_n_trees, bst_ulong *out_len);
+
+/*!
+ * \brief Predict a DMatrix with multiple boosters in a single pass over the data.  Features
+ *        of each row are filled once and trees of all boosters are evaluated while the row
+ *        is in cache.  All trees of each booster are used.
+ *
+ * \param handles       Booster handles, each booster can appear only once.
+ * \param n_boosters    Number of boosters.
+ * \param dmat          DMatrix handle.
+ * \param c_json_config String encoded prediction configuration in JSON format, with
+ *                      following available fields in the JSON object:
+ *
+ *    "output_margin": bool
+ *      Whether to output the raw margin instead of the transformed prediction.
+ *
+ * \param out_results   Caller allocated array of length `n_boosters`, receiving the
+ *                      prediction of each booster.  Memory is owned by the booster, as in
+ *                      `XGBoosterPredictFromDMatrix`.
+ * \param out_lens      Caller allocated array of length `n_boosters`, receiving the length
+ *                      of each prediction.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterPredictManyFromDMatrix(BoosterHandle const *handles, bst_ulong n_boosters,
+                                            DMatrixHandle dmat, char const *c_json_config,
+                                            float const **out_results, bst_ulong *out_lens);
+
 /*
  * \brief Inplace prediction from CPU dense matrix.
  *
@@ -958,6 +1401,85 @@ XGB_DLL int XGBoosterPredictFromDense(BoosterHandle handle,
                                       bst_ulong *out_dim,
                                       const float **out_result);
 
+/*
+ * \brief Inplace prediction from CPU dense matrix that only evaluates the boosting rounds
+ *        added since the last call, for scoring the same data after each training round.
+ *        The raw margin is kept by the caller and accumulated across calls, a fingerprint
+ *        of the data is checked to make sure the data is unchanged.
+ *
+ * \param handle        Booster handle.
+ * \param values        JSON encoded __array_interface__ to values.
+ * \param c_json_config See `XGBoosterPredictFromDense` for more info, iteration range is
+ *                      ignored.
+ * \param m             An optional (NULL if not available) proxy DMatrix instance
+ *                      storing meta info, only used when the margin is started.
+ * \param margin        Caller allocated raw margin of length `n_rows * n_groups`.
+ * \param margin_len    Length of margin.
+ * \param n_layers      Number of boosting rounds accumulated in margin, set it to 0 for
+ *                      starting a new margin.  Updated to the number of rounds of the model.
+ * \param fingerprint   Fingerprint of the data from the previous call, ignored when
+ *                      `n_layers` is 0.  Updated to the fingerprint of current data.
+ * \param out_shape     See `XGBoosterPredictFromDMatrix` for more info.
+ * \param out_dim       See `XGBoosterPredictFromDMatrix` for more info.
+ * \param out_result    Prediction of all boosting rounds, see `XGBoosterPredictFromDMatrix`
+ *                      for more info.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterPredictFromDenseIncremental(BoosterHandle handle, char const *values,
+                                                 char const *c_json_config, DMatrixHandle m,
+                                                 float *margin, bst_ulong margin_len,
+                                                 unsigned *n_layers, uint64_t *fingerprint,
+                                                 bst_ulong const **out_shape, bst_ulong *out_dim,
+                                                 const float **out_result);
+
+/*
+ * \brief Low latency prediction for a single row or a small batch of rows stored in CPU
+ *        dense matrix.  Unlike `XGBoosterPredictFromDense`, the prediction runs on the
+ *        calling thread without parsing configuration and writes the result into a caller
+ *        provided buffer.  No memory is allocated after the first call on each thread.
+ *        Only gbtree booster is supported.
+ *
+ * \param handle          Booster handle.
+ * \param values          Row major dense feature values with size `n_rows * n_cols`.
+ * \param n_rows          Number of rows.
+ * \param n_cols          Number of columns, must equal to number of features in model.
+ * \param missing         Missing value in the data.
+ * \param type            0 for normal prediction, 1 for output margin.
+ * \param iteration_begin Beginning iteration of prediction.
+ * \param iteration_end   End iteration of prediction.  Set to 0 to use all trees.
+ * \param out_result      Output buffer with size at least `n_rows * n_groups`.
+ * \param out_len         Length of the output buffer.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterPredictFromRows(BoosterHandle handle, float const *values,
+                                     bst_ulong n_rows, bst_ulong n_cols, float missing,
+                                     int type, unsigned iteration_begin,
+                                     unsigned iteration_end, float *out_result,
+                                     bst_ulong out_len);
+/*!
+ * \brief Asynchronous version of `XGBoosterPredictFromRows`.  The prediction is queued onto
+ *        an internal thread pool and this function returns immediately, so that a single
+ *        thread can keep many requests in flight.  The booster, input and output buffers
+ *        must stay valid until the prediction is finished.
+ *
+ * \param callback   Optional (NULL if not needed) callback invoked when finished.
+ * \param user_data  Passed to the callback.
+ * \param out_future Optional (NULL if not needed) handle for waiting the result, must be
+ *                   freed by `XGPredictFutureFree`.
+ *
+ * See `XGBoosterPredictFromRows` for other parameters.
+ *
+ * \return 0 when the prediction is queued, -1 when failure happens
+ */
+XGB_DLL int XGBoosterPredictFromRowsAsync(BoosterHandle handle, float const *values,
+                                          bst_ulong n_rows, bst_ulong n_cols, float missing,
+                                          int type, unsigned iteration_begin,
+                                          unsigned iteration_end, float *out_result,
+                                          bst_ulong out_len, XGBPredictCallback *callback,
+                                          void *user_data, PredictFutureHandle *out_future);
+
 /*
  * \brief Inplace prediction from CPU CSR matrix.
  *
@@ -987,6 +1509,32 @@ XGB_DLL int XGBoosterPredictFromCSR(BoosterHandle handle, char const *indptr,
                                     bst_ulong *out_dim,
                                     const float **out_result);
 
+/*
+ * \brief Inplace prediction from arrow record batch exported through Arrow C data
+ *        interface.  See `XGDMatrixCreateFromArrow` for how the data is interpreted.
+ *        Strings are encoded with the categories saved in the model.
+ *
+ * \param handle        Booster handle.
+ * \param array         Pointer to `struct ArrowArray` of the record batch.
+ * \param schema        Pointer to `struct ArrowSchema` of the record batch.
+ * \param c_json_config See `XGBoosterPredictFromDMatrix` for more info.
+ *   Additional fields for inplace prediction are:
+ *     "missing": float
+ *
+ * \param m             An optional (NULL if not available) proxy DMatrix instance
+ *                      storing meta info.
+ *
+ * \param out_shape     See `XGBoosterPredictFromDMatrix` for more info.
+ * \param out_dim       See `XGBoosterPredictFromDMatrix` for more info.
+ * \param out_result    See `XGBoosterPredictFromDMatrix` for more info.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterPredictFromArrow(BoosterHandle handle, void *array, void *schema,
+                                      char const *c_json_config, DMatrixHandle m,
+                                      bst_ulong const **out_shape, bst_ulong *out_dim,
+                                      const float **out_result);
+
 /*
  * \brief Inplace prediction from CUDA Dense matrix (cupy in Python).
  *
@@ -1058,19 +1606,79 @@ XGB_DLL int XGBoosterPredictFromCudaColumnar(
 /*!
  * \brief Load model from existing file
  * \param handle handle
- * \param fname File URI or file name.
+ * \param fname File URI or file name.  Files ending with `.json` are loaded as JSON,
+ *              `.ubj` as UBJSON (binary JSON).
 * \return 0 when success, -1 when failure happens
  */
 XGB_DLL int XGBoosterLoadModel(BoosterHandle handle,
                                const char *fname);
+/*!
+ * \brief Load model from a local file on first use.  The file is memory mapped and parsed
+ *        when the booster is used for the first time, which reduces startup time of
+ *        processes serving many models.  The file must not be modified before the model
+ *        is used.
+ * \param handle handle
+ * \param fname File name.  Any format supported by XGBoosterLoadModel is accepted,
+ *              remote URIs are loaded eagerly.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterLoadModelLazy(BoosterHandle handle,
+                                   const char *fname);
+/*!
+ * \brief Load model saved by `XGBoosterSaveSharedModelToBuffer` from a local file.  The
+ *        file is memory mapped and trees are used in place, so processes loading the same
+ *        file share one copy of the model in physical memory.  On Linux a POSIX shared
+ *        memory segment can be loaded by its path under `/dev/shm`.  The file must not be
+ *        modified while the booster is alive.  The booster can only be used for prediction
+ *        with `cpu_predictor`.
+ * \param handle handle
+ * \param fname File name.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterLoadSharedModel(BoosterHandle handle, const char *fname);
+/*!
+ * \brief Load model saved by `XGBoosterSaveSharedModelToBuffer` from memory owned by the
+ *        caller, like a shared memory segment mapped by the serving process.  Trees are
+ *        used in place without copying.
+ * \param handle handle
+ * \param buf    Pointer to the model, must be aligned to 16 bytes and stay valid and
+ *               unmodified until the booster is freed or loads another model.
+ * \param len    Length of the model in bytes.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterLoadSharedModelFromBuffer(BoosterHandle handle, const void *buf,
+                                               bst_ulong len);
 /*!
  * \brief Save model into existing file
  * \param handle handle
- * \param fname File URI or file name.
+ * \param fname File URI or file name.  The model is saved as JSON when the file name ends
+ *              with `.json`, as UBJSON (binary JSON) with `.ubj`, in the deprecated binary
+ *              format otherwise.
  * \return 0 when success, -1 when failure happens
  */
 XGB_DLL int XGBoosterSaveModel(BoosterHandle handle,
                                const char *fname);
+/*!
+ * \brief Save the prediction cache of a training dataset, so training can be continued from
+ *        a saved model without predicting the existing trees on the dataset again.
+ * \param handle handle
+ * \param dmat   Training data.
+ * \param fname  File URI or file name.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterSavePredictionCache(BoosterHandle handle, DMatrixHandle dmat,
+                                         const char *fname);
+/*!
+ * \brief Restore the prediction cache saved by XGBoosterSavePredictionCache.  The model
+ *        must be loaded first, an error is returned if the cache doesn't match the model
+ *        or the dataset.
+ * \param handle handle
+ * \param dmat   Training data.
+ * \param fname  File URI or file name.
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterLoadPredictionCache(BoosterHandle handle, DMatrixHandle dmat,
+                                         const char *fname);
 /*!
  * \brief load model from in memory buffer
  * \param handle handle
@@ -1092,6 +1700,65 @@ XGB_DLL int XGBoosterLoadModelFromBuffer(BoosterHandle handle,
 XGB_DLL int XGBoosterGetModelRaw(BoosterHandle handle, bst_ulong *out_len,
                                  const char **out_dptr);
 
+/*!
+ * \brief Save model into raw bytes in the specified format, which can be loaded by
+ *        `XGBoosterLoadModelFromBuffer`.  User must copy the result out before next
+ *        xgboost call.
+ *
+ * \param handle      handle
+ * \param json_config JSON encoded string storing parameters for the function.  Following
+ *                    keys are expected in the JSON document:
+ *
+ *     "format": str
+ *       - json: Output booster will be encoded as JSON.
+ *       - ubj:  Output booster will be encoded as Universal binary JSON, numeric fields of
+ *               trees are stored as typed arrays.
+ *       - deprecated: Output booster will be encoded as old custom binary format.
+ *
+ * \param out_len     the argument to hold the output length
+ * \param out_dptr    the argument to hold the output data pointer
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterSaveModelToBuffer(BoosterHandle handle, char const *json_config,
+                                       bst_ulong *out_len, char const **out_dptr);
+
+/*!
+ * \brief Save model into compact inference only format, which can be loaded by
+ *        `XGBoosterLoadModelFromBuffer`.  Training statistics are dropped and leaf values
+ *        are quantized, the loaded model can not be used for SHAP values or training
+ *        continuation.  The bound of prediction error is recorded in the
+ *        `compact_margin_error` attribute of the loaded model.  Only gbtree booster with
+ *        numerical splits is supported.  User must copy the result out before next
+ *        xgboost call.
+ *
+ * \param handle      handle
+ * \param json_config JSON encoded string storing parameters for the function.  Following
+ *                    keys are expected in the JSON document:
+ *
+ *     "leaf_type": str
+ *       Encoding of leaf values, either "fp16" or "int8" with a scale for each tree.
+ *
+ * \param out_len     the argument to hold the output length
+ * \param out_dptr    the argument to hold the output data pointer
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterSaveCompactModelToBuffer(BoosterHandle handle, char const *json_config,
+                                              bst_ulong *out_len, char const **out_dptr);
+/*!
+ * \brief Save model into shared inference only format, which can be loaded in place by
+ *        `XGBoosterLoadSharedModel` and `XGBoosterLoadSharedModelFromBuffer`, or copied
+ *        by `XGBoosterLoadModelFromBuffer`.  Trees are stored as a position independent
+ *        flattened forest.  Only gbtree booster with numerical splits and scalar leaves
+ *        is supported.  User must copy the result out before next xgboost call.
+ *
+ * \param handle   handle
+ * \param out_len  the argument to hold the output length
+ * \param out_dptr the argument to hold the output data pointer
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterSaveSharedModelToBuffer(BoosterHandle handle, bst_ulong *out_len,
+                                             char const **out_dptr);
+
 /*!
  * \brief Memory snapshot based serialization method.  Saves everything states
  * into buffer.
@@ -1114,6 +1781,29 @@ XGB_DLL int XGBoosterSerializeToBuffer(BoosterHandle handle, bst_ulong *out_len,
  */
 XGB_DLL int XGBoosterUnserializeFromBuffer(BoosterHandle handle,
                                            const void *buf, bst_ulong len);
+/*!
+ * \brief Same as `XGBoosterSerializeToBuffer`, but the output is encoded as base64 text
+ *        with padding during serialization, which avoids encoding a copy of the snapshot
+ *        in language bindings.  User must copy the result out before next xgboost call.
+ *
+ * \param handle   handle
+ * \param out_len  the argument to hold the output length
+ * \param out_dptr the argument to hold the output data pointer
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterSerializeToBase64(BoosterHandle handle, bst_ulong *out_len,
+                                       const char **out_dptr);
+/*!
+ * \brief Loads the base64 text returned from `XGBoosterSerializeToBase64`.  Leading and
+ *        trailing whitespace is ignored.
+ *
+ * \param handle handle
+ * \param buf    pointer to the base64 text
+ * \param len    the length of the text
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterUnserializeFromBase64(BoosterHandle handle, const char *buf,
+                                           bst_ulong len);
 
 /*!
  * \brief Initialize the booster from rabit checkpoint.
@@ -1235,6 +1925,41 @@ XGB_DLL int XGBoosterDumpModelExWithFeatures(BoosterHandle handle,
                                              bst_ulong *out_len,
                                              const char ***out_models);
 
+/*!
+ * \brief Dump nodes of all trees as a columnar table, skipping text formatting.  Only
+ *        supported by tree boosters.
+ *
+ * \param handle      Booster handle.
+ * \param json_config Reserved for future use, pass "{}".
+ * \param out_n_nodes Number of rows in the table.
+ * \param out_table   JSON object mapping column names to array interfaces, columns are
+ *                    "tree_id", "node_id", "feature", "value", "gain", "cover", "left",
+ *                    "right" and "missing".  "feature" and children are -1 for leaf,
+ *                    "value" is leaf value for leaf and split condition otherwise (NaN for
+ *                    categorical split).  The arrays are valid until next call from the same
+ *                    thread.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterDumpModelTable(BoosterHandle handle, char const *json_config,
+                                    bst_ulong *out_n_nodes, char const **out_table);
+
+/*!
+ * \brief Generate C source of a tree model, with trees unrolled into nested branches.  The
+ *        source is compiled into a shared library for the `compiled_predictor`, set with
+ *        the `compiled_library` parameter, or linked into other programs.  Only supported
+ *        by tree boosters without vector leaf.
+ *
+ * \param handle      Booster handle.
+ * \param json_config Reserved for future use, pass "{}".
+ * \param out_len     Length of the source.
+ * \param out_source  Generated source, valid until next call from the same thread.
+ *
+ * \return 0 when success, -1 when failure happens
+ */
+XGB_DLL int XGBoosterGenerateSource(BoosterHandle handle, char const *json_config,
+                                    bst_ulong *out_len, char const **out_source);
+
 /*!
  * \brief Get string attribute from Booster.
  * \param handle handle
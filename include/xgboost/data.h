@@ -26,6 +26,9 @@
 namespace xgboost {
 // forward declare dmatrix.
 class DMatrix;
+namespace common {
+class CategoryDictionary;
+}  // namespace common
 
 /*! \brief data type accepted by xgboost interface */
 enum class DataType : uint8_t {
@@ -96,6 +99,11 @@ class MetaInfo {
    *        selected when using column sampling.
    */
   HostDeviceVector<float> feature_weights;
+  /*!
+   * \brief String categories of features encoded as codes in the data, null when the data
+   *        has no string category.  Shared with slices and boosters trained on the data.
+   */
+  std::shared_ptr<common::CategoryDictionary const> categories;
 
   /*! \brief default constructor */
   MetaInfo()  = default;
@@ -130,6 +138,14 @@ class MetaInfo {
 
     return label_order_cache_;
   }
+  /*!
+   * \brief Labels packed into bits (bit i is set for a positive label i), used by metrics
+   *        of binary classification so that only 1 bit of each label is read per
+   *        evaluation.  The result is cached.
+   *
+   * \return nullptr if any of the labels is not 0 or 1.
+   */
+  std::vector<uint64_t> const* BinaryLabelBits() const;
   /*! \brief clear all the information */
   void Clear();
   /*!
@@ -182,6 +198,14 @@ class MetaInfo {
 
   /*! \brief argsort of labels */
   mutable std::vector<size_t> label_order_cache_;
+  /*! \brief packed binary labels, see `BinaryLabelBits` */
+  struct LabelBitsCache {
+    bool initialized {false};
+    bool binary {false};
+    size_t n_labels {0};
+    std::vector<uint64_t> bits;
+  };
+  mutable LabelBitsCache label_bits_cache_;
 };
 
 /*! \brief Element from a sparse vector */
@@ -219,6 +243,18 @@ struct BatchParam {
   common::Span<float> hess;
   /*! \brief Whether should DMatrix regenerate the batch.  Only used for GHistIndex. */
   bool regen {false};
+  /*! \brief Number of rows sampled for sketching, 0 means using all rows.  Only used for
+   *         GHistIndex. */
+  bst_row_t sketch_sample_rows {0};
+  /*! \brief Maximum number of bins of each feature, overriding `max_bin` for features with
+   *         a positive value.  Only used for GHistIndex. */
+  std::vector<int32_t> feature_max_bin;
+  /*! \brief Upper bound of the total number of bins of numerical features, 0 means no
+   *         bound.  Only used for GHistIndex. */
+  size_t max_total_bins {0};
+  /*! \brief Store bins of features with few bins in 2 or 4 bits for dense data.  Only used
+   *         for GHistIndex. */
+  bool pack_bins {false};
 
   BatchParam() = default;
   BatchParam(int32_t device, int32_t max_bin)
@@ -231,11 +267,19 @@ struct BatchParam {
              bool regenerate = false)
       : gpu_id{device}, max_bin{max_bin}, hess{hessian}, regen{regenerate} {}
 
+  /*! \brief Whether bins of features are limited by anything other than `max_bin`. */
+  bool HasBinBudget() const { return !feature_max_bin.empty() || max_total_bins != 0; }
+
   bool operator!=(const BatchParam& other) const {
+    bool budget_differs = feature_max_bin != other.feature_max_bin ||
+                          max_total_bins != other.max_total_bins ||
+                          pack_bins != other.pack_bins;
     if (hess.empty() && other.hess.empty()) {
-      return gpu_id != other.gpu_id || max_bin != other.max_bin;
+      return gpu_id != other.gpu_id || max_bin != other.max_bin ||
+             sketch_sample_rows != other.sketch_sample_rows || budget_differs;
     }
-    return gpu_id != other.gpu_id || max_bin != other.max_bin || hess.data() != other.hess.data();
+    return gpu_id != other.gpu_id || max_bin != other.max_bin || hess.data() != other.hess.data() ||
+           sketch_sample_rows != other.sketch_sample_rows || budget_differs;
   }
 };
 
@@ -303,7 +347,13 @@ class SparsePage {
     base_rowid = row_id;
   }
 
-  SparsePage GetTranspose(int num_columns) const;
+  /**
+   * \brief Transpose the page, rows of the result are columns of this page.
+   *
+   * \param num_columns   Number of columns of this page.
+   * \param sort_by_value Sort each column by feature value, as required by `SortedCSCPage`.
+   */
+  SparsePage GetTranspose(int num_columns, bool sort_by_value = false) const;
 
   void SortRows() {
     auto ncol = static_cast<bst_omp_uint>(this->Size());
@@ -577,17 +627,42 @@ class DMatrix {
    * \param missing Value that should be treated as missing.
    * \param nthread number of threads used for initialization.
    * \param cache   Prefix of cache file path.
+   * \param page_format Format of cache pages, either "raw" or "compressed".
+   * \param prefetch_batches Number of batches read ahead from the iterator on a background
+   *                         thread, 0 to call `next` synchronously.
+   * \param memory_budget    When positive, data is loaded into memory first and spilled to
+   *                         external memory with the cache prefix only if it doesn't fit
+   *                         into this number of bytes.
+   * \param quantized_checkpoint Keep the quantized data for `hist` in a file with the cache
+   *                         prefix that outlives the DMatrix, and reuse it when it's valid.
    *
-   * \return A created external memory DMatrix.
+   * \return A created DMatrix, in external memory unless it fits into the memory budget.
    */
   template <typename DataIterHandle, typename DMatrixHandle,
             typename DataIterResetCallback, typename XGDMatrixCallbackNext>
   static DMatrix *Create(DataIterHandle iter, DMatrixHandle proxy,
                          DataIterResetCallback *reset,
                          XGDMatrixCallbackNext *next, float missing,
-                         int32_t nthread, std::string cache);
+                         int32_t nthread, std::string cache,
+                         std::string page_format = "raw", size_t prefetch_batches = 0,
+                         size_t memory_budget = 0, bool quantized_checkpoint = false);
 
   virtual DMatrix *Slice(common::Span<int32_t const> ridxs) = 0;
+  /**
+   * \brief Drop the raw data after the gradient index is built.  Only training with `hist`
+   *        and prediction using the gradient index are supported afterward.
+   *
+   * \return Whether the raw data is released.
+   */
+  virtual bool ReleaseRawData() { return false; }
+  /**
+   * \brief Replace codes of categorical features in the data, the map of each feature
+   *        gives the new code for each old code, features with an empty map are not
+   *        changed.  Entries mapped to NaN become missing.
+   *
+   * \return Whether the data is recoded.
+   */
+  virtual bool RecodeCategories(std::vector<std::vector<float>> const&) { return false; }
   /*! \brief Number of rows per page in external memory.  Approximately 100MB per page for
    *  dataset with 100 features. */
   static const size_t kPageSize = 32UL << 12UL;
@@ -601,6 +676,7 @@ class DMatrix {
 
   virtual bool EllpackExists() const = 0;
   virtual bool SparsePageExists() const = 0;
+  virtual bool GHistIndexExists() const = 0;
 };
 
 template<>
@@ -618,6 +694,11 @@ inline bool DMatrix::PageExists<SparsePage>() const {
   return this->SparsePageExists();
 }
 
+template<>
+inline bool DMatrix::PageExists<GHistIndexMatrix>() const {
+  return this->GHistIndexExists();
+}
+
 template<>
 inline BatchSet<CSCPage> DMatrix::GetBatches(const BatchParam&) {
   return GetColumnBatches();
@@ -31,6 +31,7 @@ class ObjFunction;
 struct GenericParameter;
 struct LearnerModelParam;
 struct PredictionCacheEntry;
+struct TreeTable;
 class PredictionContainer;
 
 /*!
@@ -79,6 +80,13 @@ class GradientBooster : public Model, public Configurable {
   virtual bool AllowLazyCheckPoint() const {
     return false;
   }
+  /*!
+   * \brief Whether prediction of existing layers stays the same when new layers are added,
+   *        so that prediction can be accumulated layer by layer.
+   */
+  virtual bool AdditiveLayers() const {
+    return false;
+  }
   /*! \brief Return number of boosted rounds.
    */
   virtual int32_t BoostedRounds() const = 0;
@@ -92,6 +100,20 @@ class GradientBooster : public Model, public Configurable {
   virtual void DoBoost(DMatrix* p_fmat,
                        HostDeviceVector<GradientPair>* in_gpair,
                        PredictionCacheEntry*) = 0;
+  /*!
+   * \brief Same as `DoBoost`, but `in_gpair` is filled lazily by `source`.  Boosters
+   *        capable of fusing gradient computation into their first pass over data pass
+   *        it down, others obtain the full gradient before boosting.
+   * \param p_fmat   feature matrix that provide access to features
+   * \param in_gpair gradient vector allocated by the objective, filled by `source`.
+   * \param predt    The output prediction cache entry that needs to be updated.
+   * \param source   Computes gradient of a range of rows, each row is computed only once.
+   */
+  virtual void DoBoostFused(DMatrix* p_fmat, HostDeviceVector<GradientPair>* in_gpair,
+                            PredictionCacheEntry* predt, GradientSource const& source) {
+    source(0, p_fmat->Info().num_row_);
+    this->DoBoost(p_fmat, in_gpair, predt);
+  }
 
   /*!
    * \brief generate predictions for given feature matrix
@@ -107,6 +129,19 @@ class GradientBooster : public Model, public Configurable {
                             bool training,
                             unsigned layer_begin,
                             unsigned layer_end) = 0;
+  /*!
+   * \brief Predict the same data with multiple boosters in a single pass over the data,
+   *        using all trees of each booster.
+   * \param dmat      feature matrix
+   * \param boosters  boosters to predict from, including this one
+   * \param out_preds output margin for each booster
+   * \return false if the boosters can not be predicted together, nothing is written in
+   *         this case.
+   */
+  virtual bool PredictBatchMany(DMatrix*, std::vector<GradientBooster const*> const&,
+                                std::vector<HostDeviceVector<bst_float>*> const&) const {
+    return false;
+  }
 
   /*!
    * \brief Inplace prediction.
@@ -123,6 +158,35 @@ class GradientBooster : public Model, public Configurable {
                               uint32_t) const {
     LOG(FATAL) << "Inplace predict is not supported by current booster.";
   }
+  /*!
+   * \brief Low latency prediction for a small number of dense rows on the calling thread.
+   *
+   * \param           values      Row major dense feature values.
+   * \param           missing     Missing value in the data.
+   * \param [out]     out_preds   Caller provided output buffer for raw margin.
+   * \param           layer_begin Beginning of boosted tree layer used for prediction.
+   * \param           layer_end   End of booster layer. 0 means do not limit trees.
+   */
+  virtual void PredictRows(common::Span<float const>, float, common::Span<float>, uint32_t,
+                           uint32_t) const {
+    LOG(FATAL) << "Row prediction is not supported by current booster.";
+  }
+  /*!
+   * \brief Cascaded prediction with early exit, see `Predictor::PredictCascade`.
+   *
+   * \param           dmat         Feature matrix.
+   * \param [out]     out_preds    Raw margin.
+   * \param [out]     out_n_trees  Number of trees evaluated for each row.
+   * \param           stage_layers Number of boosted layers in each stage.
+   * \param           margin_lower Lower bound of partial margin for continuing.
+   * \param           margin_upper Upper bound of partial margin for continuing.
+   * \param           layer_begin  Beginning of boosted tree layer used for prediction.
+   * \param           layer_end    End of booster layer. 0 means do not limit trees.
+   */
+  virtual void PredictCascade(DMatrix*, HostDeviceVector<bst_float>*, std::vector<uint32_t>*,
+                              uint32_t, float, float, uint32_t, uint32_t) const {
+    LOG(FATAL) << "Cascaded prediction is not supported by current booster.";
+  }
   /*!
    * \brief online prediction function, predict score for one instance at a time
    *  NOTE: use the batch prediction interface if possible, batch prediction is usually
@@ -181,6 +245,29 @@ class GradientBooster : public Model, public Configurable {
   virtual std::vector<std::string> DumpModel(const FeatureMap& fmap,
                                              bool with_stats,
                                              std::string format) const = 0;
+  /*!
+   * \brief dump nodes of all trees into a columnar table.
+   * \param out output table, overwritten.
+   */
+  virtual void DumpModelTable(TreeTable*) const {
+    LOG(FATAL) << "Dumping model as table is only supported by tree boosters.";
+  }
+  /*!
+   * \brief generate C source of the model for ahead-of-time compilation.
+   * \param out output source, overwritten.
+   */
+  virtual void GenerateSource(std::string*) const {
+    LOG(FATAL) << "Code generation is only supported by tree boosters.";
+  }
+  /*!
+   * \brief predict with a flattened forest viewing shared model image instead of trees,
+   *        see `Learner::LoadSharedModel`.
+   * \param image flattened forest image viewed in place.
+   * \param owner kept alive as long as the forest is used, can be null.
+   */
+  virtual void UseSharedForest(common::Span<char const>, std::shared_ptr<void const>) {
+    LOG(FATAL) << "Shared model is only supported by `gbtree` booster.";
+  }
 
   virtual void FeatureScore(std::string const& importance_type,
                             common::Span<int32_t const> trees,
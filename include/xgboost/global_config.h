@@ -17,6 +17,11 @@ class Json;
 struct GlobalConfiguration : public XGBoostParameter<GlobalConfiguration> {
   int verbosity { 1 };
   bool use_rmm { false };
+  bool use_device_memory_pool { true };
+  int64_t sketch_memory_budget { 0 };
+  bool track_memory { false };
+  std::string threading_backend { "omp" };
+  std::string huge_pages { "none" };
   DMLC_DECLARE_PARAMETER(GlobalConfiguration) {
     DMLC_DECLARE_FIELD(verbosity)
         .set_range(0, 3)
@@ -25,6 +30,26 @@ struct GlobalConfiguration : public XGBoostParameter<GlobalConfiguration> {
     DMLC_DECLARE_FIELD(use_rmm)
         .set_default(false)
         .describe("Whether to use RAPIDS Memory Manager to allocate GPU memory in XGBoost");
+    DMLC_DECLARE_FIELD(use_device_memory_pool)
+        .set_default(true)
+        .describe("Whether to allocate GPU memory from the stream-ordered memory pool of "
+                  "CUDA, when RMM is not used.");
+    DMLC_DECLARE_FIELD(sketch_memory_budget)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe("Maximum bytes of GPU memory used for building quantile sketches, 0 to "
+                  "use most of the available memory.");
+    DMLC_DECLARE_FIELD(track_memory)
+        .set_default(false)
+        .describe("Account memory held by major buffers and log it after each iteration.");
+    DMLC_DECLARE_FIELD(threading_backend)
+        .set_default("omp")
+        .describe("Threads used by parallel loops, `omp` for OpenMP or `pool` for a "
+                  "bounded pool shared by all calling threads.");
+    DMLC_DECLARE_FIELD(huge_pages)
+        .set_default("none")
+        .describe("Back large training buffers by huge pages, one of `none`, "
+                  "`transparent` or `explicit`.");
   }
 };
 
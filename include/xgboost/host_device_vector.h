@@ -49,6 +49,7 @@
 #ifndef XGBOOST_HOST_DEVICE_VECTOR_H_
 #define XGBOOST_HOST_DEVICE_VECTOR_H_
 
+#include <cstdint>
 #include <initializer_list>
 #include <vector>
 #include <type_traits>
@@ -82,6 +83,20 @@ enum GPUAccess {
   kWrite
 };
 
+/*!
+ * \brief Host memory used by a `HostDeviceVector` for transfers between host and device.
+ *
+ *   - kPageable: Transfers go through ordinary host memory, copying to host is synchronous.
+ *   - kPinned: Transfers are staged through a page-locked buffer owned by the vector, so
+ *     they are issued asynchronously and copying to host can be started ahead of access
+ *     with `PrefetchHost`.
+ *   - kDeviceOnly: The host copy is released once data is written on device, copying it
+ *     back to host is an error.
+ *
+ * Without CUDA all of them are the same.
+ */
+enum class HostMemory : std::uint8_t { kPageable = 0, kPinned = 1, kDeviceOnly = 2 };
+
 template <typename T>
 class HostDeviceVector {
   static_assert(std::is_standard_layout<T>::value, "HostDeviceVector admits only POD types");
@@ -134,6 +149,22 @@ class HostDeviceVector {
 
   void SetDevice(int device) const;
 
+  void SetHostMemory(HostMemory kind) const;
+  HostMemory GetHostMemory() const;
+  /*!
+   * \brief Start copying device data to host without waiting for it, the next host access
+   *        waits for the copy instead of issuing a new one.  Only effective for pinned
+   *        memory, and data must not be modified on device before the host access.
+   */
+  void PrefetchHost() const;
+#ifdef __CUDACC__
+  /*!
+   * \brief Stream for transfers of this vector, the default stream if not set.  Work using
+   *        the data must be ordered with the stream.
+   */
+  void SetStream(cudaStream_t stream) const;
+#endif  // __CUDACC__
+
   void Resize(size_t new_size, T v = T());
 
   using value_type = T;  // NOLINT
@@ -10,6 +10,7 @@
 #include <xgboost/string_view.h>
 
 #include <functional>
+#include <ios>
 #include <map>
 #include <memory>
 #include <string>
@@ -39,7 +40,12 @@ class Value {
     kObject,  // std::map
     kArray,   // std::vector
     kBoolean,
-    kNull
+    kNull,
+    // typed arrays, only used for numeric data in models.
+    kF32Array,
+    kU8Array,
+    kI32Array,
+    kI64Array
   };
 
   explicit Value(ValueKind _kind) : kind_{_kind} {}
@@ -134,6 +140,51 @@ class JsonArray : public Value {
   }
 };
 
+/*!
+ * \brief Array of numbers with the same type, stored contiguously.  Generated by model IO
+ *        for large numeric fields, the text JSON writer outputs it as a normal array and
+ *        the binary (UBJSON) writer as a strongly typed array that can be loaded in bulk.
+ */
+template <typename T, Value::ValueKind kind>
+class JsonTypedArray : public Value {
+  std::vector<T> vec_;
+
+ public:
+  using Type = T;
+
+  JsonTypedArray() : Value(kind) {}
+  explicit JsonTypedArray(size_t n) : Value(kind) { vec_.resize(n); }
+  JsonTypedArray(std::vector<T>&& vec) noexcept :  // NOLINT
+      Value(kind), vec_{std::move(vec)} {}
+  JsonTypedArray(JsonTypedArray&& that) noexcept : Value{kind}, vec_{std::move(that.vec_)} {}
+
+  void Save(JsonWriter* writer) override;
+
+  Json& operator[](std::string const& key) override;
+  Json& operator[](int ind) override;
+
+  size_t Size() const { return vec_.size(); }
+  std::vector<T> const& GetArray() &&      { return vec_; }
+  std::vector<T> const& GetArray() const & { return vec_; }
+  std::vector<T>&       GetArray()       & { return vec_; }
+
+  bool operator==(Value const& rhs) const override;
+  Value& operator=(Value const& rhs) override;
+
+  static bool IsClassOf(Value const* value) {
+    return value->Type() == kind;
+  }
+};
+
+/*! \brief Typed array for 32-bit floating point. */
+using F32Array = JsonTypedArray<float, Value::ValueKind::kF32Array>;
+/*! \brief Typed array for uint8_t, used for flags. */
+using U8Array = JsonTypedArray<uint8_t, Value::ValueKind::kU8Array>;
+/*! \brief Typed array for 32-bit signed integer. */
+using I32Array = JsonTypedArray<int32_t, Value::ValueKind::kI32Array>;
+/*! \brief Typed array for 64-bit signed integer. */
+using I64Array = JsonTypedArray<int64_t, Value::ValueKind::kI64Array>;
+
 class JsonObject : public Value {
   std::map<std::string, Json> object_;
 
@@ -320,11 +371,21 @@ class Json {
   friend JsonWriter;
 
  public:
-  /*! \brief Load a Json object from string. */
-  static Json Load(StringView str);
+  /*!
+   * \brief Load a Json object from string.
+   *
+   * \param mode std::ios::binary for UBJSON, text JSON otherwise.
+   */
+  static Json Load(StringView str, std::ios::openmode mode = std::ios::in);
   /*! \brief Pass your own JsonReader. */
   static Json Load(JsonReader* reader);
-  static void Dump(Json json, std::string* out);
+  /*!
+   * \brief Encode a Json object.
+   *
+   * \param mode std::ios::binary for UBJSON, text JSON otherwise.
+   */
+  static void Dump(Json json, std::string* out, std::ios::openmode mode = std::ios::out);
+  static void Dump(Json json, std::vector<char>* out, std::ios::openmode mode = std::ios::out);
 
   Json() : ptr_{new JsonNull} {}
 
@@ -350,6 +411,16 @@ class Json {
     return *this;
   }
 
+  // typed array
+  template <typename T, Value::ValueKind kind>
+  explicit Json(JsonTypedArray<T, kind> list) :
+      ptr_{new JsonTypedArray<T, kind>(std::move(list))} {}
+  template <typename T, Value::ValueKind kind>
+  Json& operator=(JsonTypedArray<T, kind> array) {
+    ptr_.reset(new JsonTypedArray<T, kind>(std::move(array)));
+    return *this;
+  }
+
   // object
   explicit Json(JsonObject object) :
       ptr_{new JsonObject(std::move(object))} {}
@@ -492,6 +563,18 @@ std::vector<Json> const& GetImpl(T& val) {  // NOLINT
   return val.GetArray();
 }
 
+// Typed Array
+template <typename T,
+          typename std::enable_if<
+            std::is_same<T, F32Array>::value || std::is_same<T, F32Array const>::value ||
+            std::is_same<T, U8Array>::value || std::is_same<T, U8Array const>::value ||
+            std::is_same<T, I32Array>::value || std::is_same<T, I32Array const>::value ||
+            std::is_same<T, I64Array>::value ||
+            std::is_same<T, I64Array const>::value>::type* = nullptr>
+auto& GetImpl(T& val) {  // NOLINT
+  return val.GetArray();
+}
+
 // Object
 template <typename T,
           typename std::enable_if<
@@ -540,6 +623,37 @@ Object ToJson(Parameter const& param) {
   return obj;
 }
 
+/*!
+ * \brief Get numeric array saved by model IO.  It's a typed array when loaded from
+ *        UBJSON, and an array of numbers, integers or booleans when loaded from text JSON.
+ */
+template <typename T>
+std::vector<T> GetNumericArray(Json const& j_arr) {
+  auto copy = [](auto const& arr) { return std::vector<T>(arr.cbegin(), arr.cend()); };
+  if (IsA<F32Array>(j_arr)) {
+    return copy(get<F32Array const>(j_arr));
+  } else if (IsA<U8Array>(j_arr)) {
+    return copy(get<U8Array const>(j_arr));
+  } else if (IsA<I32Array>(j_arr)) {
+    return copy(get<I32Array const>(j_arr));
+  } else if (IsA<I64Array>(j_arr)) {
+    return copy(get<I64Array const>(j_arr));
+  }
+  auto const& arr = get<Array const>(j_arr);
+  std::vector<T> out(arr.size());
+  for (size_t i = 0; i < arr.size(); ++i) {
+    auto const& v = arr[i];
+    if (IsA<Integer>(v)) {
+      out[i] = static_cast<T>(get<Integer const>(v));
+    } else if (IsA<Boolean>(v)) {
+      out[i] = static_cast<T>(get<Boolean const>(v));
+    } else {
+      out[i] = static_cast<T>(get<Number const>(v));
+    }
+  }
+  return out;
+}
+
 template <typename Parameter>
 Args FromJson(Json const& obj, Parameter* param) {
   auto const& j_param = get<Object const>(obj);
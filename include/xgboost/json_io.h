@@ -15,6 +15,7 @@
 #include <sstream>
 #include <locale>
 #include <cinttypes>
+#include <cstring>
 
 namespace xgboost {
 /*
@@ -36,7 +37,7 @@ class JsonReader {
     void Forward() {
       pos_++;
     }
-    void Forward(uint32_t n) {
+    void Forward(size_t n) {
       pos_ += n;
     }
   } cursor_;
@@ -94,6 +95,9 @@ class JsonReader {
     Error(msg);
   }
 
+  /* \brief Parse a quoted string without wrapping it into Json. */
+  std::string DecodeQuotedStr();
+
   virtual Json ParseString();
   virtual Json ParseObject();
   virtual Json ParseArray();
@@ -109,13 +113,15 @@ class JsonReader {
 
   virtual ~JsonReader() = default;
 
-  Json Load();
+  virtual Json Load();
 };
 
 class JsonWriter {
   static constexpr size_t kIndentSize = 2;
 
   size_t n_spaces_;
+
+ protected:
   std::vector<char>* stream_;
 
  public:
@@ -127,6 +133,10 @@ class JsonWriter {
   void Save(Json json);
 
   virtual void Visit(JsonArray  const* arr);
+  virtual void Visit(F32Array const* arr);
+  virtual void Visit(U8Array const* arr);
+  virtual void Visit(I32Array const* arr);
+  virtual void Visit(I64Array const* arr);
   virtual void Visit(JsonObject const* obj);
   virtual void Visit(JsonNumber const* num);
   virtual void Visit(JsonInteger const* num);
@@ -134,6 +144,62 @@ class JsonWriter {
   virtual void Visit(JsonString const* str);
   virtual void Visit(JsonBoolean const* boolean);
 };
+
+/*!
+ * \brief Reader for UBJSON https://ubjson.org/ , numeric arrays with a type marker are
+ *        loaded as typed arrays.
+ */
+class UBJReader : public JsonReader {
+  Json Parse();
+  Json ParseValue(char type);
+
+  template <typename T>
+  T ReadStream() {
+    auto ptr = this->raw_str_.c_str() + cursor_.Pos();
+    if (XGBOOST_EXPECT(cursor_.Pos() + sizeof(T) > raw_str_.size(), false)) {
+      Error("Unexpected end of UBJSON input.");
+    }
+    T v{0};
+    std::memcpy(&v, ptr, sizeof(v));
+    cursor_.Forward(sizeof(T));
+    return v;
+  }
+  // UBJSON stores numbers in big endian.
+  template <typename T>
+  T ReadPrimitive();
+  int64_t ReadLength();
+  std::string DecodeStr();
+  template <typename TypedArray>
+  Json ParseTypedArray(int64_t n);
+
+  Json ParseArray() override;
+  Json ParseObject() override;
+
+ public:
+  using JsonReader::JsonReader;
+  Json Load() override;
+};
+
+/*!
+ * \brief Writer for UBJSON https://ubjson.org/ , typed arrays are written as strongly typed
+ *        containers.
+ */
+class UBJWriter : public JsonWriter {
+ public:
+  using JsonWriter::JsonWriter;
+
+  void Visit(JsonArray const* arr) override;
+  void Visit(F32Array const* arr) override;
+  void Visit(U8Array const* arr) override;
+  void Visit(I32Array const* arr) override;
+  void Visit(I64Array const* arr) override;
+  void Visit(JsonObject const* obj) override;
+  void Visit(JsonNumber const* num) override;
+  void Visit(JsonInteger const* num) override;
+  void Visit(JsonNull const* null) override;
+  void Visit(JsonString const* str) override;
+  void Visit(JsonBoolean const* boolean) override;
+};
 }      // namespace xgboost
 
 #endif  // XGBOOST_JSON_IO_H_
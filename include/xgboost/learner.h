@@ -16,6 +16,7 @@
 #include <xgboost/model.h>
 #include <xgboost/predictor.h>
 #include <xgboost/task.h>
+#include <xgboost/tree_model.h>
 
 #include <map>
 #include <memory>
@@ -30,6 +31,9 @@ class GradientBooster;
 class ObjFunction;
 class DMatrix;
 class Json;
+namespace common {
+class CategoryDictionary;
+}  // namespace common
 
 enum class PredictionType : std::uint8_t {  // NOLINT
   kValue = 0,
@@ -53,10 +57,71 @@ struct XGBAPIThreadLocalEntry {
   std::vector<bst_float> ret_vec_float;
   /*! \brief temp variable of gradient pairs. */
   std::vector<GradientPair> tmp_gpair;
+  /*! \brief Gradient from custom objective, reused across iterations. */
+  HostDeviceVector<GradientPair> custom_gpair;
   /*! \brief Temp variable for returning prediction result. */
   PredictionCacheEntry prediction_entry;
   /*! \brief Temp variable for returning prediction shape. */
   std::vector<bst_ulong> prediction_shape;
+  /*! \brief Temp variable for transforming row prediction. */
+  HostDeviceVector<bst_float> row_predictions;
+  /*! \brief Temp variable for returning number of trees used by cascaded prediction. */
+  std::vector<uint32_t> prediction_n_trees;
+  /*! \brief Temp variable for returning model table. */
+  TreeTable model_table;
+
+  XGBAPIThreadLocalEntry() {
+    // Both are copied between host and device in every iteration with custom objectives.
+    custom_gpair.SetHostMemory(HostMemory::kPinned);
+    prediction_entry.predictions.SetHostMemory(HostMemory::kPinned);
+  }
+};
+
+/*! \brief Parameters of the native training loop, see `Learner::Train`. */
+struct TrainLoopParam {
+  /*! \brief Number of boosting rounds. */
+  int32_t num_boost_round {10};
+  /*!
+   * \brief Stop training when the score on the last evaluation dataset hasn't improved in
+   *        this many rounds.  0 disables early stopping.
+   */
+  int32_t early_stopping_rounds {0};
+  /*! \brief Evaluate every `eval_period` rounds, the last round is always evaluated. */
+  int32_t eval_period {1};
+  /*! \brief Metric used for early stopping, the last configured metric when empty. */
+  std::string metric;
+  /*! \brief 1 to maximize the metric, 0 to minimize, -1 to infer from the metric name. */
+  int32_t maximize {-1};
+};
+
+/*! \brief Result of the native training loop. */
+struct TrainLoopResult {
+  /*! \brief Number of rounds boosted by the loop. */
+  int32_t n_rounds {0};
+  /*! \brief Iteration with the best score, -1 if nothing is evaluated. */
+  int32_t best_iteration {-1};
+  /*! \brief Score of the best iteration. */
+  double best_score {0.0};
+  /*! \brief Whether a larger score is better for the metric used. */
+  bool maximize {false};
+};
+
+/*! \brief Parameters of training multiple boosters concurrently, see `Learner::TrainSweep`. */
+struct SweepParam {
+  /*! \brief Maximum number of boosting rounds for each booster. */
+  int32_t num_boost_round {10};
+  /*!
+   * \brief Boosters are evaluated every `rung_rounds` rounds, after which only the best
+   *        `keep_ratio` of them continue.  0 trains all boosters for `num_boost_round`.
+   */
+  int32_t rung_rounds {0};
+  double keep_ratio {0.5};
+  /*! \brief Metric for ranking boosters, the last configured metric when empty. */
+  std::string metric;
+  /*! \brief 1 to maximize the metric, 0 to minimize, -1 to infer from the metric name. */
+  int32_t maximize {-1};
+  /*! \brief Total number of threads shared by all boosters, 0 for all available. */
+  int32_t n_threads {0};
 };
 
 /*!
@@ -110,6 +175,73 @@ class Learner : public Model, public Configurable, public dmlc::Serializable {
   virtual std::string EvalOneIter(int iter,
                                   const std::vector<std::shared_ptr<DMatrix>>& data_sets,
                                   const std::vector<std::string>& data_names) = 0;
+  /*!
+   * \brief Evaluate the model for specific iteration on a background thread, so that
+   *        evaluation overlaps with the next call to `UpdateOneIter`.  The model is
+   *        snapshot at the time of this call, and the background thread keeps its own
+   *        prediction cache for the datasets.  Datasets must not be used for training
+   *        until the evaluation finishes.  Not supported in distributed training.
+   * \param iter iteration number
+   * \param data_sets datasets to be evaluated.
+   * \param data_names name of each dataset
+   * \return result of the previous call, empty for the first call.
+   */
+  virtual std::string EvalOneIterAsync(int iter,
+                                       const std::vector<std::shared_ptr<DMatrix>>& data_sets,
+                                       const std::vector<std::string>& data_names) = 0;
+  /*!
+   * \brief Wait for the evaluation started by the last call to `EvalOneIterAsync`.
+   * \return result of the evaluation, empty if there's no pending evaluation.
+   */
+  virtual std::string WaitEvalOneIter() = 0;
+  /*!
+   * \brief evaluate the model using the configured metrics, without formatting the result.
+   * \param data_sets   datasets to be evaluated.
+   * \param out_names   name of each metric.
+   * \param out_results metric values, one row of `out_names.size()` values for each dataset.
+   */
+  virtual void EvalMetrics(std::vector<std::shared_ptr<DMatrix>> const& data_sets,
+                           std::vector<std::string>* out_names,
+                           std::vector<double>* out_results) = 0;
+  /*!
+   * \brief Split an evaluation dataset into cohorts.  `EvalOneIter` then reports the
+   *        metrics of each non-empty cohort as `name[cohort]` after the whole dataset,
+   *        using the same prediction.  Meta info is copied at the time of this call, and
+   *        in distributed training it must be called on all workers.
+   * \param data    dataset to be evaluated.
+   * \param cohorts cohort id of each row, an empty vector removes the cohorts.
+   */
+  virtual void SetEvalCohorts(std::shared_ptr<DMatrix> data,
+                              std::vector<uint32_t> const& cohorts) = 0;
+  /*!
+   * \brief Boost `param.num_boost_round` rounds on top of the current model, evaluating
+   *        the model periodically and stopping early when the score on the last evaluation
+   *        dataset stops improving.  When early stopping is enabled, the `best_iteration`
+   *        and `best_score` attributes are set the same way as the language bindings.
+   * \param train training data.
+   * \param evals datasets to be evaluated.
+   * \param param parameters of the loop.
+   */
+  TrainLoopResult Train(std::shared_ptr<DMatrix> train,
+                        std::vector<std::shared_ptr<DMatrix>> const& evals,
+                        TrainLoopParam const& param);
+  /*!
+   * \brief Train boosters with different configurations on the same data concurrently
+   *        with successive halving.  Boosters are trained in rungs, threads are divided
+   *        among the remaining boosters and the worst ones stop after each rung by their
+   *        score on the last evaluation dataset.  The first round of each booster runs
+   *        alone so data shared by boosters, like the quantized matrix for `hist`, is built
+   *        once.  Boosters should use the same `max_bin` to share it.
+   * \param learners boosters to be trained, the `nthread` parameter is managed by the sweep.
+   * \param train    training data.
+   * \param evals    datasets to be evaluated, required when boosters are ranked.
+   * \param param    parameters of the sweep.
+   * \return Result of each booster, `n_rounds` is smaller than `num_boost_round` for
+   *         boosters stopped by successive halving.
+   */
+  static std::vector<TrainLoopResult> TrainSweep(
+      std::vector<Learner*> const& learners, std::shared_ptr<DMatrix> train,
+      std::vector<std::shared_ptr<DMatrix>> const& evals, SweepParam const& param);
   /*!
    * \brief get prediction given the model.
    * \param data input data
@@ -137,6 +269,12 @@ class Learner : public Model, public Configurable, public dmlc::Serializable {
   /*!
    * \brief Inplace prediction.
    *
+   *   Once the learner is configured, the model and predictor state used here are read
+   *   only, multiple threads can call this function on the same learner concurrently
+   *   without locking.  Each thread gets its own output buffer from `GetThreadLocal`.
+   *   Any call that modifies the learner (setting parameters, training, loading model)
+   *   must not run concurrently with prediction.
+   *
    * \param          x           A type erased data adapter.
    * \param          p_m         An optional Proxy DMatrix object storing meta info like
    *                             base margin.  Can be nullptr.
@@ -153,6 +291,76 @@ class Learner : public Model, public Configurable, public dmlc::Serializable {
                               HostDeviceVector<bst_float> **out_preds,
                               uint32_t layer_begin, uint32_t layer_end) = 0;
 
+  /*!
+   * \brief Inplace prediction that only evaluates the boosted layers added since the last
+   *        call, for predicting the same data repeatedly while the model grows.  The
+   *        caller owns the raw margin and is responsible for passing the same data.
+   *
+   * \param          x           A type erased data adapter.
+   * \param          p_m         An optional Proxy DMatrix object storing meta info like
+   *                             base margin, only used when the margin is started.
+   * \param          type        Prediction type, only value and margin are supported.
+   * \param          missing     Missing value in the data.
+   * \param [in,out] margin      Raw margin of size `n_rows * num_output_group`,
+   *                             accumulated across calls.
+   * \param [in,out] n_layers    Number of layers already accumulated in `margin`, 0 starts
+   *                             from the base margin.  Set to number of boosted layers.
+   * \param [out]    out_preds   Prediction for all layers.
+   */
+  virtual void InplacePredictIncremental(dmlc::any const &x, std::shared_ptr<DMatrix> p_m,
+                                         PredictionType type, float missing,
+                                         common::Span<float> margin, uint32_t *n_layers,
+                                         HostDeviceVector<bst_float> **out_preds) = 0;
+
+  /*!
+   * \brief Low latency prediction for a small number of dense rows.  Runs on the calling
+   *        thread and writes into the caller provided buffer.
+   *
+   * \param values          Row major dense feature values.
+   * \param missing         Missing value in the data.
+   * \param type            Prediction type, only value and margin are supported.
+   * \param out_preds       Output buffer of size `n_rows * num_output_group`.
+   * \param layer_begin     Beginning of boosted tree layer used for prediction.
+   * \param layer_end       End of booster layer. 0 means do not limit trees.
+   */
+  virtual void PredictRows(common::Span<float const> values, float missing,
+                           PredictionType type, common::Span<float> out_preds,
+                           uint32_t layer_begin, uint32_t layer_end) = 0;
+
+  /*!
+   * \brief Cascaded prediction that stops evaluating trees for rows whose partial margin
+   *        has left [margin_lower, margin_upper], checked every `stage_layers` layers.
+   *
+   * \param data            Input data.
+   * \param output_margin   Whether to output raw margin instead of transformed value.
+   * \param stage_layers    Number of boosted layers in each stage.
+   * \param margin_lower    Lower bound of partial margin for continuing.
+   * \param margin_upper    Upper bound of partial margin for continuing.
+   * \param out_preds       Output predictions.
+   * \param out_n_trees     Number of trees evaluated for each row.
+   * \param layer_begin     Beginning of boosted tree layer used for prediction.
+   * \param layer_end       End of booster layer. 0 means do not limit trees.
+   */
+  virtual void PredictCascade(std::shared_ptr<DMatrix> data, bool output_margin,
+                              uint32_t stage_layers, float margin_lower, float margin_upper,
+                              HostDeviceVector<bst_float> *out_preds,
+                              std::vector<uint32_t> *out_n_trees, uint32_t layer_begin,
+                              uint32_t layer_end) = 0;
+
+  /*!
+   * \brief Predict the same data with multiple models in a single pass over the data, all
+   *        trees of each model are used.  Models that can not share the pass, like dart
+   *        or models configured for GPU, fall back to `Predict`.
+   *
+   * \param learners        Models used for prediction.
+   * \param data            Input data.
+   * \param output_margin   Whether to output raw margin instead of transformed value.
+   * \param out_preds       Output predictions for each model.
+   */
+  static void PredictMany(std::vector<Learner*> const& learners, std::shared_ptr<DMatrix> data,
+                          bool output_margin,
+                          std::vector<HostDeviceVector<bst_float>*> const& out_preds);
+
   /*!
    * \brief Calculate feature score.  See doc in C API for outputs.
    */
@@ -172,6 +380,67 @@ class Learner : public Model, public Configurable, public dmlc::Serializable {
 
   virtual void LoadModel(dmlc::Stream* fi) = 0;
   virtual void SaveModel(dmlc::Stream* fo) const = 0;
+  /*!
+   * \brief Save the model in compact inference only format, which can be loaded by
+   *        `LoadModel`.  Training statistics are dropped and leaf values are quantized,
+   *        the bound of prediction error is recorded in the `compact_margin_error`
+   *        attribute of loaded model.  Only gbtree booster with numerical splits is
+   *        supported.
+   *
+   * \param fo        Output stream.
+   * \param leaf_type Encoding of leaf values, either "fp16" or "int8".
+   */
+  virtual void SaveCompactModel(dmlc::Stream* fo, std::string const& leaf_type) const = 0;
+  /*!
+   * \brief Save the model in shared inference only format, which can be loaded by
+   *        `LoadSharedModel` or `LoadModel`.  Trees are stored as a position independent
+   *        flattened forest that is used in place, so serving processes mapping the same
+   *        file or shared memory segment share one copy of the model in physical memory.
+   *        Only gbtree booster with numerical splits and scalar leaves is supported.
+   *
+   * \param fo Output stream.
+   */
+  virtual void SaveSharedModel(dmlc::Stream* fo) const = 0;
+  /*!
+   * \brief Load model saved by `SaveSharedModel` without copying its trees.  Only memory
+   *        for model parameters and per-thread prediction buffers is allocated by the
+   *        learner.  The loaded model can be used for prediction with `cpu_predictor`,
+   *        but not for training, slicing, saving or SHAP values.
+   *
+   * \param image Content of the saved model, must be aligned to 16 bytes.  Memory
+   *              mapped files and shared memory segments are page aligned.
+   * \param owner Kept alive as long as the model uses the image, can be null if caller
+   *              guarantees the image outlives the model.
+   */
+  virtual void LoadSharedModel(common::Span<char const> image,
+                               std::shared_ptr<void const> owner) = 0;
+  /*!
+   * \brief Load model from a local file on first use.  The file is memory mapped and only
+   *        parsed once the model is configured or any of its attributes is accessed, so
+   *        an unused model costs nothing but address space.  Any format accepted by
+   *        `LoadModel(dmlc::Stream*)` is supported, remote URIs are loaded eagerly.
+   *
+   * \param fname Path to the model file.
+   */
+  virtual void LoadModelLazy(std::string const& fname) = 0;
+  /*!
+   * \brief Save the prediction cache of a dataset along with the model, so training can be
+   *        continued on the same dataset without predicting the existing trees again.
+   *
+   * \param data Dataset used for training, the cache is brought up to date with the model.
+   * \param fo   Output stream.
+   */
+  virtual void SavePredictionCache(std::shared_ptr<DMatrix> data, dmlc::Stream* fo) = 0;
+  /*!
+   * \brief Restore the prediction cache saved by `SavePredictionCache`.  The cache is checked
+   *        against a fingerprint of the dataset (shape, labels, weights and base margin) and
+   *        the number of boosted rounds of the current model, so the model should be loaded
+   *        before the cache.
+   *
+   * \param data Dataset used for training.
+   * \param fi   Input stream.
+   */
+  virtual void LoadPredictionCache(std::shared_ptr<DMatrix> data, dmlc::Stream* fi) = 0;
 
   /*!
    * \brief Set multiple parameters at once.
@@ -243,6 +512,12 @@ class Learner : public Model, public Configurable, public dmlc::Serializable {
    * \param fn Output feature types
    */
   virtual void GetFeatureTypes(std::vector<std::string>* ft) const = 0;
+  /*!
+   * \brief Get the string categories learned from training data, which are used to encode
+   *        string columns for prediction.
+   * \return null if the model is not trained on data with string categories.
+   */
+  virtual std::shared_ptr<common::CategoryDictionary const> GetCategories() const = 0;
 
   /*!
    * \return whether the model allow lazy checkpoint in rabit.
@@ -270,6 +545,17 @@ class Learner : public Model, public Configurable, public dmlc::Serializable {
   virtual std::vector<std::string> DumpModel(const FeatureMap& fmap,
                                              bool with_stats,
                                              std::string format) = 0;
+  /*!
+   * \brief dump nodes of all trees into a columnar table.
+   * \param out output table, overwritten.
+   */
+  virtual void DumpModelTable(TreeTable* out) = 0;
+  /*!
+   * \brief generate C source of the model for ahead-of-time compilation, the compiled
+   *        library is used by `compiled_predictor`.
+   * \param out output source, overwritten.
+   */
+  virtual void GenerateSource(std::string* out) = 0;
 
   virtual XGBAPIThreadLocalEntry& GetThreadLocal() const = 0;
   /*!
@@ -13,10 +13,12 @@
 #include <xgboost/data.h>
 #include <xgboost/base.h>
 #include <xgboost/host_device_vector.h>
+#include <xgboost/task.h>
 
 #include <vector>
 #include <string>
 #include <functional>
+#include <memory>
 #include <utility>
 
 namespace xgboost {
@@ -73,6 +75,23 @@ class Metric : public Configurable {
    * \return the created metric.
    */
   static Metric* Create(const std::string& name, GenericParameter const* tparam);
+  /*!
+   * \brief evaluate multiple metrics on the same prediction.  Element-wise metrics are
+   *        fused into a single pass over data, and their statistics are gathered with one
+   *        call to Allreduce.  Other metrics are evaluated one by one.
+   * \param metrics     metrics to be evaluated.
+   * \param preds       prediction
+   * \param info        information, including label etc.
+   * \param distributed whether a call to Allreduce is needed.
+   * \param out         result of each metric.
+   * \param transform   element-wise transformation that needs to be applied to `preds`
+   *                    before evaluation.  Fused element-wise metrics apply it inside the
+   *                    reduction, so no transformed copy of prediction is made for them.
+   */
+  static void EvalMany(std::vector<std::unique_ptr<Metric>> const& metrics,
+                       HostDeviceVector<bst_float> const& preds, MetaInfo const& info,
+                       bool distributed, std::vector<double>* out,
+                       PredTransformKind transform = PredTransformKind::kIdentity);
 };
 
 /*!
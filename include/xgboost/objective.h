@@ -46,6 +46,29 @@ class ObjFunction : public Configurable {
                            const MetaInfo& info,
                            int iteration,
                            HostDeviceVector<GradientPair>* out_gpair) = 0;
+  /*!
+   * \brief Whether gradient can be computed for a range of rows on CPU with
+   *        `GetGradientRange`.  Objectives returning true must produce non-negative
+   *        hessian when sample weights are non-negative.
+   */
+  virtual bool SupportsGradientRange() const { return false; }
+  /*!
+   * \brief Validate input and allocate `out_gpair` for `GetGradientRange`, gradient is not
+   *        computed.  Parameters are the same as `GetGradient`.
+   */
+  virtual void PrepareGradient(const HostDeviceVector<bst_float>& preds, const MetaInfo& info,
+                               int iteration, HostDeviceVector<GradientPair>* out_gpair) {
+    LOG(FATAL) << "Computing gradient for a range of rows is not supported by objective.";
+  }
+  /*!
+   * \brief Compute gradient of rows in [begin, end) on CPU, including all outputs of these
+   *        rows.  Can be called concurrently for disjoint ranges after `PrepareGradient`.
+   */
+  virtual void GetGradientRange(const HostDeviceVector<bst_float>& preds, const MetaInfo& info,
+                                size_t begin, size_t end,
+                                HostDeviceVector<GradientPair>* out_gpair) const {
+    LOG(FATAL) << "Computing gradient for a range of rows is not supported by objective.";
+  }
 
   /*! \return the default evaluation metric for the objective */
   virtual const char* DefaultEvalMetric() const = 0;
@@ -64,6 +87,11 @@ class ObjFunction : public Configurable {
   virtual void EvalTransform(HostDeviceVector<bst_float> *io_preds) {
     this->PredTransform(io_preds);
   }
+  /*!
+   * \brief The element-wise transformation performed by `EvalTransform`, if there's one.
+   *        The default `kOther` is always safe, as the learner then calls `EvalTransform`.
+   */
+  virtual PredTransformKind EvalTransformKind() const { return PredTransformKind::kOther; }
   /*!
    * \brief transform probability value back to margin
    * this is used to transform user-set base_score back to margin
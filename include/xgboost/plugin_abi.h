@@ -0,0 +1,124 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file plugin_abi.h
+ * \brief Stable C interface for objectives and metrics implemented in shared libraries
+ *        loaded at runtime with `XGBLoadPlugin`.
+ *
+ *  A plugin library exports a function named by `XGBOOST_PLUGIN_INIT_SYMBOL`:
+ *
+ * \code
+ *   int XGBoostPluginInit(XGBPluginHost const *host) {
+ *     if (host->abi_version != XGBOOST_PLUGIN_ABI_VERSION) { return -1; }
+ *     return host->register_objective(&my_objective);
+ *   }
+ * \endcode
+ *
+ *  Callbacks operate on blocks of rows and are called concurrently for disjoint blocks,
+ *  so they must not modify the plugin state.  All callbacks return 0 on success.
+ */
+#ifndef XGBOOST_PLUGIN_ABI_H_
+#define XGBOOST_PLUGIN_ABI_H_
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif  // __cplusplus
+
+/*! \brief Incremented for every incompatible change of the structures below. */
+#define XGBOOST_PLUGIN_ABI_VERSION 1
+/*! \brief Name of the initialization function exported by plugin libraries. */
+#define XGBOOST_PLUGIN_INIT_SYMBOL "XGBoostPluginInit"
+
+/*! \brief Task of a plugin objective, same as `xgboost::ObjInfo::Task`. */
+enum XGBPluginTask {
+  kXGBPluginRegression = 0,
+  kXGBPluginBinary = 1,
+  kXGBPluginClassification = 2,
+  kXGBPluginSurvival = 3,
+  kXGBPluginRanking = 4,
+  kXGBPluginOther = 5
+};
+
+/*! \brief A contiguous block of rows passed to plugin callbacks. */
+typedef struct {  // NOLINT(*)
+  /*! \brief Index of the first row in the block. */
+  size_t row_begin;
+  size_t n_rows;
+  /*! \brief Number of outputs for each row. */
+  size_t n_targets;
+  /*! \brief Raw prediction of the block, n_rows * n_targets in row major. */
+  float const *predt;
+  /*! \brief Labels of the block, n_rows * n_targets in row major. */
+  float const *labels;
+  /*! \brief Sample weights of the block, n_rows.  NULL when there's no weight. */
+  float const *weights;
+} XGBPluginBlock;
+
+typedef struct {  // NOLINT(*)
+  /*! \brief Name used as `objective` parameter. */
+  char const *name;
+  /*! \brief Name of the default evaluation metric. */
+  char const *default_metric;
+  /*! \brief One of `XGBPluginTask`. */
+  int32_t task;
+  /*!
+   * \brief Create the plugin state.  Optional.
+   * \param json_config JSON object of all string parameters given to the booster.
+   */
+  void *(*create)(char const *json_config);
+  /*! \brief Free the state returned by `create`.  Optional. */
+  void (*destroy)(void *state);
+  /*!
+   * \brief Compute gradient of a block.
+   * \param out_gpair n_rows * n_targets pairs of gradient and hessian, interleaved.
+   */
+  int (*gradient)(void const *state, XGBPluginBlock const *block, float *out_gpair);
+  /*! \brief Transform raw prediction of n elements in place.  Optional. */
+  int (*pred_transform)(void const *state, float *predt, size_t n);
+  /*! \brief Transform base score into margin.  Optional. */
+  float (*prob_to_margin)(void const *state, float base_score);
+} XGBPluginObjective;
+
+typedef struct {  // NOLINT(*)
+  /*! \brief Name used as `eval_metric` parameter, as in `name@param`. */
+  char const *name;
+  /*!
+   * \brief Create the plugin state.  Optional.
+   * \param param The string after `@` in metric name, NULL if there's none.
+   */
+  void *(*create)(char const *param);
+  /*! \brief Free the state returned by `create`.  Optional. */
+  void (*destroy)(void *state);
+  /*!
+   * \brief Evaluate a block of transformed prediction.
+   * \param out_sum  Sum of losses in the block.
+   * \param out_wsum Sum of weights in the block.
+   */
+  int (*eval)(void const *state, XGBPluginBlock const *block, double *out_sum,
+              double *out_wsum);
+  /*!
+   * \brief Final result from sums over all blocks and workers.  Optional, default to
+   *        sum / wsum.
+   */
+  double (*finalize)(void const *state, double sum, double wsum);
+} XGBPluginMetric;
+
+/*! \brief Passed to the initialization function of plugins. */
+typedef struct {  // NOLINT(*)
+  int32_t abi_version;
+  /*! \brief Register an objective, the structure is copied. */
+  int (*register_objective)(XGBPluginObjective const *obj);
+  /*! \brief Register a metric, the structure is copied. */
+  int (*register_metric)(XGBPluginMetric const *metric);
+} XGBPluginHost;
+
+typedef int (*XGBPluginInitFn)(XGBPluginHost const *host);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // XGBOOST_PLUGIN_ABI_H_
@@ -9,7 +9,9 @@
 #include <xgboost/data.h>
 #include <xgboost/generic_parameters.h>
 #include <xgboost/host_device_vector.h>
+#include <xgboost/span.h>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -24,6 +26,9 @@ class TreeUpdater;
 namespace gbm {
 struct GBTreeModel;
 }  // namespace gbm
+namespace common {
+class TrackedBytes;
+}  // namespace common
 }
 
 namespace xgboost {
@@ -54,10 +59,14 @@ struct PredictionCacheEntry {
  */
 class PredictionContainer {
   std::unordered_map<DMatrix *, PredictionCacheEntry> container_;
+  // Memory held by cached predictions, sampled on each access to the container.
+  std::unique_ptr<common::TrackedBytes> tracked_;
   void ClearExpiredEntries();
+  void Track();
 
  public:
-  PredictionContainer() = default;
+  PredictionContainer();
+  ~PredictionContainer();
   /* \brief Add a new DMatrix to the cache, at the same time this function will clear out
    *        all expired caches by checking the `std::weak_ptr`.  Caching an existing
    *        DMatrix won't renew it.
@@ -92,6 +101,47 @@ class PredictionContainer {
   decltype(container_) const& Container();
 };
 
+/**
+ * \brief Ordinal of each leaf within its tree, used by compact leaf prediction.  Leaves are
+ *        numbered in the order of their node index, and the one-hot column of a leaf is its
+ *        ordinal plus the number of leaves in previous trees.
+ */
+class LeafOrdinals {
+  // Position of the first node of each tree in `ordinals_`.
+  std::vector<size_t> node_ptr_;
+  std::vector<uint32_t> ordinals_;
+  // First one-hot column of each tree.
+  std::vector<size_t> column_ptr_;
+  size_t max_leaves_{0};
+
+ public:
+  /**
+   * \param model    The tree model.
+   * \param tree_end Number of trees, 0 for all trees.
+   */
+  LeafOrdinals(gbm::GBTreeModel const& model, uint32_t tree_end);
+
+  uint32_t Ordinal(uint32_t tree_id, bst_node_t nidx) const {
+    return ordinals_[node_ptr_[tree_id] + nidx];
+  }
+  size_t Column(uint32_t tree_id, bst_node_t nidx) const {
+    return column_ptr_[tree_id] + this->Ordinal(tree_id, nidx);
+  }
+  uint32_t NumTrees() const { return static_cast<uint32_t>(column_ptr_.size() - 1); }
+  /*! \brief Number of one-hot columns, which is the total number of leaves. */
+  size_t NumColumns() const { return column_ptr_.back(); }
+  size_t MaxLeaves() const { return max_leaves_; }
+  /**
+   * \brief Check the output of compact leaf prediction.
+   *
+   * \param n_rows    Number of rows of the input.
+   * \param out_size  Number of elements in the output.
+   * \param max_value Largest value the output type can hold.
+   * \param one_hot   Whether the output holds one-hot columns instead of ordinals.
+   */
+  void CheckOutput(size_t n_rows, size_t out_size, uint64_t max_value, bool one_hot) const;
+};
+
 /**
  * \class Predictor
  *
@@ -143,6 +193,22 @@ class Predictor {
                             const gbm::GBTreeModel& model, uint32_t tree_begin,
                             uint32_t tree_end = 0) const = 0;
 
+  /**
+   * \brief Predict the same feature matrix with multiple models in a single pass over the
+   *        data.  Features of each row are filled once and all trees of all models are
+   *        traversed while the row is still in cache.
+   *
+   * \param           dmat       Feature matrix.
+   * \param           models     Models to predict from, all trees of each model are used.
+   * \param [in,out]  out_preds  Output for each model, initialized by `InitOutPredictions`.
+   */
+  virtual void PredictBatchMany(DMatrix * /*dmat*/,
+                                std::vector<gbm::GBTreeModel const *> const & /*models*/,
+                                std::vector<HostDeviceVector<bst_float> *> const & /*out_preds*/)
+      const {
+    LOG(FATAL) << "Predicting multiple models at once is not supported by current predictor.";
+  }
+
   /**
    * \brief Inplace prediction.
    * \param           x                      Type erased data adapter.
@@ -159,6 +225,48 @@ class Predictor {
                               PredictionCacheEntry *out_preds,
                               uint32_t tree_begin = 0,
                               uint32_t tree_end = 0) const = 0;
+  /**
+   * \brief Low latency prediction for a small number of dense rows.  The prediction runs
+   *        on the calling thread and writes into caller provided buffer, no memory is
+   *        allocated once the thread local workspace is initialized.
+   *
+   * \param          values     Row major dense feature values, the number of rows is
+   *                             `values.size() / num_feature`.
+   * \param          missing    Missing value in the data.
+   * \param [out]    out_preds  Output buffer of size `n_rows * num_output_group`, filled
+   *                             with raw margin including base score.
+   * \param          model      The model to predict from.
+   * \param          tree_begin Beginning of boosted trees used for prediction.
+   * \param          tree_end   End of booster trees. 0 means do not limit trees.
+   */
+  virtual void PredictRows(common::Span<float const> /*values*/, float /*missing*/,
+                           common::Span<float> /*out_preds*/,
+                           const gbm::GBTreeModel & /*model*/, uint32_t /*tree_begin*/ = 0,
+                           uint32_t /*tree_end*/ = 0) const {
+    LOG(FATAL) << "Row prediction is not supported by current predictor.";
+  }
+  /**
+   * \brief Cascaded prediction with early exit.  Trees are evaluated in stages, after each
+   *        stage rows with partial margin outside of [margin_lower, margin_upper] stop
+   *        accumulating.  Only models with a single output group are supported.
+   *
+   * \param          dmat         Feature matrix.
+   * \param [out]    out_preds    Raw margin including base margin.
+   * \param [out]    out_n_trees  Number of trees evaluated for each row.
+   * \param          model        The model to predict from.
+   * \param          stage_trees  Number of trees in each stage.
+   * \param          margin_lower Rows with partial margin below this value stop.
+   * \param          margin_upper Rows with partial margin above this value stop.
+   * \param          tree_begin   Beginning of boosted trees used for prediction.
+   * \param          tree_end     End of booster trees. 0 means do not limit trees.
+   */
+  virtual void PredictCascade(DMatrix * /*dmat*/, HostDeviceVector<bst_float> * /*out_preds*/,
+                              std::vector<uint32_t> * /*out_n_trees*/,
+                              const gbm::GBTreeModel & /*model*/, uint32_t /*stage_trees*/,
+                              float /*margin_lower*/, float /*margin_upper*/,
+                              uint32_t /*tree_begin*/, uint32_t /*tree_end*/) const {
+    LOG(FATAL) << "Cascaded prediction is not supported by current predictor.";
+  }
   /**
    * \brief online prediction function, predict score for one instance at a time
    * NOTE: use the batch prediction interface if possible, batch prediction is
@@ -190,6 +298,36 @@ class Predictor {
                            const gbm::GBTreeModel& model,
                            unsigned tree_end = 0) const = 0;
 
+  /**
+   * \brief Predict the ordinal of leaf within each tree (see `LeafOrdinals`) into a caller
+   *        provided buffer of nsample * ntree elements.  Unlike `PredictLeaf`, the output
+   *        takes 1 or 2 bytes per leaf, each tree must have at most 256 or 65536 leaves
+   *        respectively.
+   *
+   * \param [in,out]  dmat        The input feature matrix.
+   * \param [out]     out         The output leaf ordinals, in row major.
+   * \param           model       Model to make predictions from.
+   * \param           tree_end    (Optional) The tree end index.
+   */
+  virtual void PredictLeafOrdinal(DMatrix* dmat, common::Span<std::uint8_t> out,
+                                  const gbm::GBTreeModel& model, unsigned tree_end = 0) const;
+  virtual void PredictLeafOrdinal(DMatrix* dmat, common::Span<std::uint16_t> out,
+                                  const gbm::GBTreeModel& model, unsigned tree_end = 0) const;
+
+  /**
+   * \brief Predict leaves as a one-hot CSR matrix with a column for each leaf of the
+   *        forest (see `LeafOrdinals::Column`).  Each row has one entry valued 1 for each
+   *        tree, so the row pointer is `ridx * ntree` and only the column indices are
+   *        written, sorted within each row.
+   *
+   * \param [in,out]  dmat        The input feature matrix.
+   * \param [out]     out_indices Column indices of nsample * ntree elements.
+   * \param           model       Model to make predictions from.
+   * \param           tree_end    (Optional) The tree end index.
+   */
+  virtual void PredictLeafOneHot(DMatrix* dmat, common::Span<std::uint32_t> out_indices,
+                                 const gbm::GBTreeModel& model, unsigned tree_end = 0) const;
+
   /**
    * \brief feature contributions to individual predictions; the output will be
    * a vector of length (nfeats + 1) * num_output_group * nsample, arranged in
@@ -35,5 +35,18 @@ struct ObjInfo {
   explicit ObjInfo(Task t) : task{t} {}
   ObjInfo(Task t, bool khess) : task{t}, const_hess{khess} {}
 };
+
+/*!
+ * \brief Element-wise transformation performed by `ObjFunction::EvalTransform`.  Knowing
+ *        it allows metrics to transform the raw margin lazily during reduction instead of
+ *        working on a transformed copy of the prediction.  `kOther` means the transformation
+ *        is not element-wise or is unknown.
+ */
+enum class PredTransformKind : uint8_t {
+  kIdentity = 0,
+  kSigmoid = 1,
+  kExp = 2,
+  kOther = 3,
+};
 }  // namespace xgboost
 #endif  // XGBOOST_TASK_H_
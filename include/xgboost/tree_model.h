@@ -349,6 +349,25 @@ class RegTree : public Model {
     return stats_[nid];
   }
 
+  /*! \brief Whether leaves of this tree hold a vector of weights, one for each target. */
+  bool IsMultiTarget() const { return param.size_leaf_vector > 0; }
+  /*! \brief Number of targets predicted by this tree. */
+  bst_group_t NumTargets() const {
+    return IsMultiTarget() ? static_cast<bst_group_t>(param.size_leaf_vector) : 1;
+  }
+  /*!
+   * \brief Turn an unexpanded tree into a vector-leaf tree with `n_targets` weights in each
+   *        leaf.  Scalar leaf values of vector-leaf trees are not used.
+   */
+  void SetNumTargets(bst_group_t n_targets);
+  /*! \brief Weights of a leaf in vector-leaf tree. */
+  common::Span<float const> LeafVector(bst_node_t nidx) const {
+    auto n = static_cast<size_t>(param.size_leaf_vector);
+    return {leaf_vector_.data() + nidx * n, n};
+  }
+  /*! \brief Set weights of a leaf in vector-leaf tree, learning rate is not applied. */
+  void SetLeafVector(bst_node_t nidx, common::Span<float const> weights);
+
   /*!
    * \brief load model from stream
    * \param fi input stream
@@ -365,7 +384,8 @@ class RegTree : public Model {
 
   bool operator==(const RegTree& b) const {
     return nodes_ == b.nodes_ && stats_ == b.stats_ &&
-           deleted_nodes_ == b.deleted_nodes_ && param == b.param;
+           deleted_nodes_ == b.deleted_nodes_ && param == b.param &&
+           leaf_vector_ == b.leaf_vector_;
   }
   /* \brief Iterate through all nodes in this tree.
    *
@@ -503,12 +523,26 @@ class RegTree : public Model {
      * \param inst The sparse instance to fill.
      */
     void Fill(const SparsePage::Inst& inst);
+    /*!
+     * \brief fill the vector with sparse vector, storing only the features selected by a
+     *        compact index so that the vector can be much smaller than number of features.
+     * \param inst The sparse instance to fill.
+     * \param compact Position of each feature in this vector, -1 for unselected feature.
+     *        Features beyond the size of compact are not selected.
+     */
+    void Fill(const SparsePage::Inst& inst, common::Span<int32_t const> compact);
 
     /*!
      * \brief drop the trace after fill, must be called after fill.
      * \param inst The sparse instance to drop.
      */
     void Drop(const SparsePage::Inst& inst);
+    /*!
+     * \brief drop the trace after fill with compact index.
+     * \param inst The sparse instance to drop.
+     * \param compact The same compact index used by fill.
+     */
+    void Drop(const SparsePage::Inst& inst, common::Span<int32_t const> compact);
     /*!
      * \brief returns the size of the feature vector
      * \return the size of the feature vector
@@ -643,6 +677,8 @@ class RegTree : public Model {
   std::vector<uint32_t> split_categories_;
   // Ptr to split categories of each node.
   std::vector<Segment> split_categories_segments_;
+  // Leaf weights of vector-leaf tree, `size_leaf_vector` values for each node.
+  std::vector<float> leaf_vector_;
 
   // allocate a new node,
   // !!!!!! NOTE: may cause BUG here, nodes.resize
@@ -661,6 +697,7 @@ class RegTree : public Model {
     stats_.resize(param.num_nodes);
     split_types_.resize(param.num_nodes, FeatureType::kNumerical);
     split_categories_segments_.resize(param.num_nodes);
+    leaf_vector_.resize(static_cast<size_t>(param.num_nodes) * param.size_leaf_vector, 0.0f);
     return nd;
   }
   // delete a tree node, keep the parent field to allow trace back
@@ -708,6 +745,30 @@ inline void RegTree::FVec::Drop(const SparsePage::Inst& inst) {
   has_missing_ = true;
 }
 
+inline void RegTree::FVec::Fill(const SparsePage::Inst& inst,
+                                common::Span<int32_t const> compact) {
+  size_t feature_count = 0;
+  for (auto const& entry : inst) {
+    if (entry.index >= compact.size() || compact[entry.index] < 0) {
+      continue;
+    }
+    data_[compact[entry.index]].fvalue = entry.fvalue;
+    ++feature_count;
+  }
+  has_missing_ = data_.size() != feature_count;
+}
+
+inline void RegTree::FVec::Drop(const SparsePage::Inst& inst,
+                                common::Span<int32_t const> compact) {
+  for (auto const& entry : inst) {
+    if (entry.index >= compact.size() || compact[entry.index] < 0) {
+      continue;
+    }
+    data_[compact[entry.index]].flag = -1;
+  }
+  has_missing_ = true;
+}
+
 inline size_t RegTree::FVec::Size() const {
   return data_.size();
 }
@@ -723,5 +784,36 @@ inline bool RegTree::FVec::IsMissing(size_t i) const {
 inline bool RegTree::FVec::HasMissing() const {
   return has_missing_;
 }
+
+/*!
+ * \brief Nodes of trees in columnar layout with one row for each node, used to export
+ *        models to external tools without formatting text dumps.
+ */
+struct TreeTable {
+  std::vector<int32_t> tree_id;
+  std::vector<int32_t> node_id;
+  /*! \brief Split feature, -1 for leaf. */
+  std::vector<int32_t> feature;
+  /*! \brief Split condition of numerical split, leaf value of leaf, NaN for categorical split. */
+  std::vector<float> value;
+  /*! \brief Loss change of split. */
+  std::vector<float> gain;
+  /*! \brief Sum of hessian. */
+  std::vector<float> cover;
+  /*! \brief Left, right and default child, -1 for leaf. */
+  std::vector<int32_t> left;
+  std::vector<int32_t> right;
+  std::vector<int32_t> missing;
+
+  size_t Size() const { return tree_id.size(); }
+  void Resize(size_t n) {
+    for (auto* column : {&tree_id, &node_id, &feature, &left, &right, &missing}) {
+      column->resize(n);
+    }
+    for (auto* column : {&value, &gain, &cover}) {
+      column->resize(n);
+    }
+  }
+};
 }  // namespace xgboost
 #endif  // XGBOOST_TREE_MODEL_H_
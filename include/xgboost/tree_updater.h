@@ -61,6 +61,16 @@ class TreeUpdater : public Configurable {
   virtual void Update(HostDeviceVector<GradientPair>* gpair,
                       DMatrix* data,
                       const std::vector<RegTree*>& trees) = 0;
+  /*!
+   * \brief Same as `Update`, but gradient of rows is computed by `source` on demand.  All
+   *        rows must be computed before returning.  The default implementation computes
+   *        the full gradient upfront.
+   */
+  virtual void UpdateFused(HostDeviceVector<GradientPair>* gpair, GradientSource const& source,
+                           DMatrix* data, const std::vector<RegTree*>& trees) {
+    source(0, data->Info().num_row_);
+    this->Update(gpair, data, trees);
+  }
 
   /*!
    * \brief determines whether updater has enough knowledge about a given dataset
@@ -76,6 +86,15 @@ class TreeUpdater : public Configurable {
                                      linalg::VectorView<float> /*out_preds*/) {
     return false;
   }
+  /*!
+   * \brief Same as `UpdatePredictionCache`, but for the last tree with vector leaves.
+   *        Predictions of all targets are updated in a single pass over rows.
+   * \param out_preds: prediction cache with one column for each target.
+   */
+  virtual bool UpdateMultiTargetPredictionCache(const DMatrix * /*data*/,
+                                                linalg::MatrixView<float> /*out_preds*/) {
+    return false;
+  }
 
   virtual char const* Name() const = 0;
 
@@ -16,6 +16,8 @@
 package ml.dmlc.xgboost4j.java;
 
 import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.Arrays;
 import java.util.HashMap;
 import java.util.HashSet;
@@ -275,6 +277,61 @@ public class Booster implements Serializable, KryoSerializable {
     return evalInfo;
   }
 
+  /**
+   * Predict dense rows stored in a direct buffer, writing the result into another direct
+   * buffer without any copy between JVM and native memory.  Both buffers must use the native
+   * byte order and are accessed from index 0 regardless of their positions.  Unlike the
+   * DMatrix based predict, this method is not synchronized and can be called concurrently.
+   *
+   * @param data         row major float32 values, with at least nRows * nCols elements
+   * @param nRows        number of rows
+   * @param nCols        number of columns, must equal to the number of features of model
+   * @param missing      value treated as missing, NaN is always treated as missing
+   * @param outputMargin output margin
+   * @param out          output buffer, with at least one float32 for each output of each row
+   * @throws XGBoostError native error
+   */
+  public void predictDirect(ByteBuffer data, long nRows, long nCols, float missing,
+                            boolean outputMargin, ByteBuffer out) throws XGBoostError {
+    checkDirectBuffer(data, nRows * nCols, "data");
+    checkDirectBuffer(out, 0, "out");
+    XGBoostJNI.checkCall(XGBoostJNI.XGBoosterPredictFromRowsDirect(handle, data, nRows, nCols,
+            missing, outputMargin ? 1 : 0, 0, 0, out));
+  }
+
+  /**
+   * Same as {@link #predictDirect} but takes raw addresses of off-heap memory, for callers
+   * that manage native memory themselves.  The memory must stay valid during the call.
+   *
+   * @param dataAddress  address of row major float32 values
+   * @param nRows        number of rows
+   * @param nCols        number of columns, must equal to the number of features of model
+   * @param missing      value treated as missing, NaN is always treated as missing
+   * @param outputMargin output margin
+   * @param outAddress   address of output buffer
+   * @param outLen       number of float32 elements in the output buffer
+   * @throws XGBoostError native error
+   */
+  public void predictDirect(long dataAddress, long nRows, long nCols, float missing,
+                            boolean outputMargin, long outAddress, long outLen)
+          throws XGBoostError {
+    XGBoostJNI.checkCall(XGBoostJNI.XGBoosterPredictFromRowsAddress(handle, dataAddress, nRows,
+            nCols, missing, outputMargin ? 1 : 0, 0, 0, outAddress, outLen));
+  }
+
+  private static void checkDirectBuffer(ByteBuffer buffer, long nFloats, String name) {
+    if (buffer == null || !buffer.isDirect()) {
+      throw new IllegalArgumentException(name + " must be a direct ByteBuffer");
+    }
+    if (buffer.order() != ByteOrder.nativeOrder()) {
+      throw new IllegalArgumentException(name + " must use the native byte order");
+    }
+    if ((long) buffer.capacity() < nFloats * 4) {
+      throw new IllegalArgumentException(name + " has capacity " + buffer.capacity() +
+              " bytes, expecting at least " + nFloats * 4);
+    }
+  }
+
   /**
    * Advanced predict function with all the options.
    *
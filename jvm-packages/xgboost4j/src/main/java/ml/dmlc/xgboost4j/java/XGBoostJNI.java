@@ -101,6 +101,18 @@ class XGBoostJNI {
   public final static native int XGBoosterPredict(long handle, long dmat, int option_mask,
                                                   int ntree_limit, float[][] predicts);
 
+  public final static native int XGBoosterPredictFromRowsDirect(long handle, ByteBuffer data,
+                                                                long nRows, long nCols,
+                                                                float missing, int type,
+                                                                int iterBegin, int iterEnd,
+                                                                ByteBuffer out);
+
+  public final static native int XGBoosterPredictFromRowsAddress(long handle, long dataAddress,
+                                                                 long nRows, long nCols,
+                                                                 float missing, int type,
+                                                                 int iterBegin, int iterEnd,
+                                                                 long outAddress, long outLen);
+
   public final static native int XGBoosterLoadModel(long handle, String fname);
 
   public final static native int XGBoosterSaveModel(long handle, String fname);
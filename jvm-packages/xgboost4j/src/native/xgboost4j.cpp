@@ -608,6 +608,37 @@ JNIEXPORT jint JNICALL Java_ml_dmlc_xgboost4j_java_XGBoostJNI_XGBoosterPredict
   return ret;
 }
 
+/*
+ * Class:     ml_dmlc_xgboost4j_java_XGBoostJNI
+ * Method:    XGBoosterPredictFromRowsDirect
+ * Signature: (JLjava/nio/ByteBuffer;JJFIIILjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_ml_dmlc_xgboost4j_java_XGBoostJNI_XGBoosterPredictFromRowsDirect
+  (JNIEnv *jenv, jclass jcls, jlong jhandle, jobject jdata, jlong jnrow, jlong jncol,
+   jfloat jmissing, jint jtype, jint jbegin, jint jend, jobject jout) {
+  BoosterHandle handle = (BoosterHandle) jhandle;
+  // Both buffers are used in place, predictions are written directly into `jout`.
+  float const *data = (float const *) jenv->GetDirectBufferAddress(jdata);
+  float *out = (float *) jenv->GetDirectBufferAddress(jout);
+  bst_ulong out_len = (bst_ulong) jenv->GetDirectBufferCapacity(jout) / sizeof(float);
+  return XGBoosterPredictFromRows(handle, data, (bst_ulong) jnrow, (bst_ulong) jncol, jmissing,
+                                  jtype, (unsigned) jbegin, (unsigned) jend, out, out_len);
+}
+
+/*
+ * Class:     ml_dmlc_xgboost4j_java_XGBoostJNI
+ * Method:    XGBoosterPredictFromRowsAddress
+ * Signature: (JJJJFIIIJJ)I
+ */
+JNIEXPORT jint JNICALL Java_ml_dmlc_xgboost4j_java_XGBoostJNI_XGBoosterPredictFromRowsAddress
+  (JNIEnv *jenv, jclass jcls, jlong jhandle, jlong jdata, jlong jnrow, jlong jncol,
+   jfloat jmissing, jint jtype, jint jbegin, jint jend, jlong jout, jlong jout_len) {
+  BoosterHandle handle = (BoosterHandle) jhandle;
+  return XGBoosterPredictFromRows(handle, (float const *) jdata, (bst_ulong) jnrow,
+                                  (bst_ulong) jncol, jmissing, jtype, (unsigned) jbegin,
+                                  (unsigned) jend, (float *) jout, (bst_ulong) jout_len);
+}
+
 /*
  * Class:     ml_dmlc_xgboost4j_java_XGBoostJNI
  * Method:    XGBoosterLoadModel
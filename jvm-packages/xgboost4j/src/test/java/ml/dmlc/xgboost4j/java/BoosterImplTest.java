@@ -16,6 +16,9 @@
 package ml.dmlc.xgboost4j.java;
 
 import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
 import java.util.Arrays;
 import java.util.HashMap;
 import java.util.LinkedHashMap;
@@ -102,6 +105,41 @@ public class BoosterImplTest {
     TestCase.assertTrue(eval.eval(predicts, testMat) < 0.1f);
   }
 
+  @Test
+  public void testPredictDirect() throws XGBoostError {
+    float[] values = new float[]{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    float[] labels = new float[]{0, 1, 0, 1};
+    int nRows = 4, nCols = 3;
+    DMatrix trainMat = new DMatrix(values, nRows, nCols, Float.NaN);
+    trainMat.setLabel(labels);
+    Map<String, Object> paramMap = new HashMap<String, Object>() {
+      {
+        put("max_depth", 2);
+        put("objective", "binary:logistic");
+      }
+    };
+    Map<String, DMatrix> watches = new HashMap<>();
+    Booster booster = XGBoost.train(trainMat, paramMap, 4, watches, null, null);
+    float[][] expected = booster.predict(trainMat, true);
+
+    ByteBuffer data = ByteBuffer.allocateDirect(values.length * 4).order(ByteOrder.nativeOrder());
+    data.asFloatBuffer().put(values);
+    ByteBuffer out = ByteBuffer.allocateDirect(nRows * 4).order(ByteOrder.nativeOrder());
+    booster.predictDirect(data, nRows, nCols, Float.NaN, true, out);
+    FloatBuffer predicts = out.asFloatBuffer();
+    for (int i = 0; i < nRows; ++i) {
+      TestCase.assertEquals(expected[i][0], predicts.get(i), 1e-6);
+    }
+
+    try {
+      booster.predictDirect(ByteBuffer.allocate(values.length * 4), nRows, nCols, Float.NaN,
+          true, out);
+      TestCase.fail("heap buffer should be rejected");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+
   @Test
   public void saveLoadModelWithPath() throws XGBoostError, IOException {
     DMatrix trainMat = new DMatrix(this.train_uri);
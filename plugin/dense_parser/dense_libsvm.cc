@@ -3,10 +3,31 @@
  * \file dense_libsvm.cc
  * \brief Plugin to load in libsvm, but fill all the missing entries with zeros.
  *  This plugin is mainly used for benchmark purposes and do not need to be included.
+ *
+ *  Both `dense_libsvm` and `projected_libsvm` formats accept a column projection, only
+ *  the selected columns are materialized:
+ *
+ *    columns=1,5,10-20   selected column indices, ranges are inclusive.
+ *    model=xgb.model     select columns used by splits of a model.
+ *    remap=1             renumber the selected columns into [0, n_selected).
+ *
+ *  For example `train.libsvm?format=projected_libsvm&model=xgb.model`.  `dense_libsvm`
+ *  fills the missing entries of selected columns with zeros.
  */
 #include <xgboost/base.h>
+#include <xgboost/json.h>
+#include <xgboost/learner.h>
 #include <dmlc/data.h>
+
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../src/common/common.h"
+#include "../../src/common/io.h"
 
 namespace dmlc {
 namespace data {
@@ -69,12 +90,167 @@ class DensifyParser : public dmlc::Parser<IndexType> {
   std::vector<xgboost::bst_float> dense_value_;
 };
 
+/*!
+ * \brief Keep only the selected columns of rows from another parser, optionally filling
+ *        missing entries of the selected columns with zeros.
+ */
+template<typename IndexType>
+class ProjectParser : public dmlc::Parser<IndexType> {
+ public:
+  ProjectParser(dmlc::Parser<IndexType>* parser, std::vector<uint32_t> columns, bool remap,
+                bool dense)
+      : parser_(parser), columns_(std::move(columns)), remap_(remap), dense_(dense) {
+    CHECK(!columns_.empty()) << "No column is selected.";
+    std::sort(columns_.begin(), columns_.end());
+    columns_.erase(std::unique(columns_.begin(), columns_.end()), columns_.end());
+    slot_.resize(columns_.back() + 1, -1);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+      slot_[columns_[i]] = static_cast<int32_t>(i);
+    }
+  }
+
+  void BeforeFirst() override {
+    parser_->BeforeFirst();
+  }
+
+  bool Next() override {
+    if (!parser_->Next()) return false;
+    const RowBlock<IndexType>& batch = parser_->Value();
+    size_t n_selected = columns_.size();
+    offset_.resize(batch.size + 1);
+    offset_[0] = 0;
+    index_.clear();
+    value_.clear();
+    if (dense_) {
+      index_.resize(batch.size * n_selected);
+      value_.resize(batch.size * n_selected, 0.0f);
+    }
+
+    for (size_t i = 0; i < batch.size; ++i) {
+      Row<IndexType> row = batch[i];
+      if (dense_) {
+        for (size_t j = 0; j < n_selected; ++j) {
+          index_[i * n_selected + j] = remap_ ? j : columns_[j];
+        }
+      }
+      for (size_t k = 0; k < row.length; ++k) {
+        IndexType index = row.get_index(k);
+        if (index >= slot_.size() || slot_[index] < 0) {
+          continue;
+        }
+        if (dense_) {
+          value_[i * n_selected + slot_[index]] = row.get_value(k);
+        } else {
+          index_.push_back(remap_ ? slot_[index] : index);
+          value_.push_back(row.get_value(k));
+        }
+      }
+      offset_[i + 1] = dense_ ? (i + 1) * n_selected : index_.size();
+    }
+    out_ = batch;
+    out_.field = nullptr;
+    out_.index = dmlc::BeginPtr(index_);
+    out_.value = dmlc::BeginPtr(value_);
+    out_.offset = dmlc::BeginPtr(offset_);
+    return true;
+  }
+
+  const dmlc::RowBlock<IndexType>& Value() const override {
+    return out_;
+  }
+
+  size_t BytesRead() const override {
+    return parser_->BytesRead();
+  }
+
+ private:
+  RowBlock<IndexType> out_;
+  std::unique_ptr<Parser<IndexType> > parser_;
+  std::vector<uint32_t> columns_;
+  // Position of each column in the selected columns, -1 for unselected columns.
+  std::vector<int32_t> slot_;
+  bool remap_;
+  bool dense_;
+  std::vector<size_t> offset_;
+  std::vector<IndexType> index_;
+  std::vector<xgboost::bst_float> value_;
+};
+
+/*! \brief Parse a list of column indices and inclusive ranges like `1,5,10-20`. */
+inline std::vector<uint32_t> ParseColumns(std::string const& str) {
+  std::vector<uint32_t> columns;
+  for (auto const& item : xgboost::common::Split(str, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    auto range = xgboost::common::Split(item, '-');
+    CHECK(range.size() == 1 || range.size() == 2) << "Invalid column range: " << item;
+    uint32_t begin = std::stoul(range.front());
+    uint32_t end = std::stoul(range.back());
+    CHECK_LE(begin, end) << "Invalid column range: " << item;
+    for (uint32_t i = begin; i <= end; ++i) {
+      columns.push_back(i);
+    }
+  }
+  return columns;
+}
+
+/*! \brief Columns used by splits of a model. */
+inline std::vector<uint32_t> ModelColumns(std::string const& path) {
+  std::unique_ptr<xgboost::Learner> learner{xgboost::Learner::Create({})};
+  if (xgboost::common::FileExtension(path) == "json") {
+    auto str = xgboost::common::LoadSequentialFile(path);
+    learner->LoadModel(xgboost::Json::Load({str.c_str(), str.size()}));
+  } else {
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(path.c_str(), "r"));
+    learner->LoadModel(fi.get());
+  }
+  std::vector<xgboost::bst_feature_t> features;
+  std::vector<float> scores;
+  learner->CalcFeatureScore("weight", {}, &features, &scores);
+  return {features.cbegin(), features.cend()};
+}
+
+/*! \brief Selected columns from parser arguments, empty if there's no projection. */
+inline std::vector<uint32_t> ProjectedColumns(const std::map<std::string, std::string>& args) {
+  std::vector<uint32_t> columns;
+  if (args.count("columns") != 0) {
+    columns = ParseColumns(args.at("columns"));
+  }
+  if (args.count("model") != 0) {
+    auto used = ModelColumns(args.at("model"));
+    columns.insert(columns.end(), used.cbegin(), used.cend());
+  }
+  return columns;
+}
+
+template<typename IndexType, typename DType = real_t>
+Parser<IndexType> *
+CreateProjectedLibSVMParser(const std::string& path,
+                            const std::map<std::string, std::string>& args,
+                            unsigned part_index,
+                            unsigned num_parts) {
+  auto columns = ProjectedColumns(args);
+  CHECK(!columns.empty()) << "expect columns or model in projected_libsvm";
+  bool remap = args.count("remap") != 0 && atoi(args.at("remap").c_str()) != 0;
+  return new ProjectParser<IndexType>(
+      Parser<IndexType>::Create(path.c_str(), part_index, num_parts, "libsvm"),
+      std::move(columns), remap, false);
+}
+
 template<typename IndexType, typename DType = real_t>
 Parser<IndexType> *
 CreateDenseLibSVMParser(const std::string& path,
                         const std::map<std::string, std::string>& args,
                         unsigned part_index,
                         unsigned num_parts) {
+  auto columns = ProjectedColumns(args);
+  if (!columns.empty()) {
+    bool remap = args.count("remap") != 0 && atoi(args.at("remap").c_str()) != 0;
+    return new ProjectParser<IndexType>(
+        Parser<IndexType>::Create(path.c_str(), part_index, num_parts, "libsvm"),
+        std::move(columns), remap, true);
+  }
   CHECK_NE(args.count("num_col"), 0) << "expect num_col in dense_libsvm";
   return new DensifyParser<IndexType>(
             Parser<IndexType>::Create(path.c_str(), part_index, num_parts, "libsvm"),
@@ -84,4 +260,6 @@ CreateDenseLibSVMParser(const std::string& path,
 
 DMLC_REGISTER_DATA_PARSER(uint32_t, real_t, dense_libsvm,
   data::CreateDenseLibSVMParser<uint32_t __DMLC_COMMA real_t>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, real_t, projected_libsvm,
+  data::CreateProjectedLibSVMParser<uint32_t __DMLC_COMMA real_t>);
 }  // namespace dmlc
@@ -1,6 +1,7 @@
 /*!
  * Copyright by Contributors 2017-2020
  */
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 #include <mutex>
@@ -14,8 +15,10 @@
 #include "xgboost/host_device_vector.h"
 
 #include "../../src/data/adapter.h"
+#include "../../src/common/common.h"
 #include "../../src/common/math.h"
 #include "../../src/gbm/gbtree_model.h"
+#include "./usm_vector_oneapi.h"
 
 #include "CL/sycl.hpp"
 
@@ -24,6 +27,13 @@ namespace predictor {
 
 DMLC_REGISTRY_FILE_TAG(predictor_oneapi);
 
+// Number of rows processed by a work-group.
+constexpr size_t kRowsPerGroup = 64;
+// Trees are split into tiles until there are at least this many work-items ...
+constexpr size_t kMinWorkItems = 1 << 14;
+// ... but a tile has no fewer trees than this.
+constexpr size_t kMinTreesPerTile = 16;
+
 /*! \brief Element from a sparse vector */
 struct EntryOneAPI {
   /*! \brief feature index */
@@ -149,58 +159,49 @@ struct DeviceNodeOneAPI {
   float GetWeight() const { return val.leaf_weight; }
 };
 
+/*!
+ * \brief Flattened trees in USM, cached across calls as long as the generation of model
+ *        is unchanged.  New trees committed during training are appended.
+ */
 class DeviceModelOneAPI {
- public:
-  cl::sycl::queue qu_;
-  DeviceNodeOneAPI* nodes;
-  size_t* tree_segments;
-  int* tree_group;
-  size_t tree_beg_;
-  size_t tree_end_;
-  int num_group;
-
-  DeviceModelOneAPI() : nodes(nullptr), tree_segments(nullptr), tree_group(nullptr) {}
+  uint64_t generation_{0};
+  size_t n_trees_{0};
 
-  ~DeviceModelOneAPI() {
-    Reset();
-  }
-
-  void Reset() {
-    if (nodes)
-      cl::sycl::free(nodes, qu_);
-    if (tree_segments)
-      cl::sycl::free(tree_segments, qu_);
-    if (tree_group)
-      cl::sycl::free(tree_group, qu_);
-  }
+ public:
+  // Nodes of all trees, indexed by absolute tree index through `tree_segments`.
+  USMVector<DeviceNodeOneAPI> nodes;
+  USMVector<size_t> tree_segments;
+  USMVector<int> tree_group;
 
-  void Init(const gbm::GBTreeModel& model, size_t tree_begin, size_t tree_end, cl::sycl::queue qu) {
-    qu_ = qu;
+  void Init(const gbm::GBTreeModel& model, cl::sycl::queue qu) {
     CHECK_EQ(model.param.size_leaf_vector, 0);
-    Reset();
-
-    tree_segments = cl::sycl::malloc_shared<size_t>((tree_end - tree_begin) + 1, qu_);
-    int sum = 0;
-    tree_segments[0] = sum;
-    for (int tree_idx = tree_begin; tree_idx < tree_end; tree_idx++) {
-      sum += model.trees[tree_idx]->GetNodes().size();
-      tree_segments[tree_idx - tree_begin + 1] = sum;
+    size_t n_trees = model.trees.size();
+    if (generation_ != model.Generation() || n_trees < n_trees_) {
+      n_trees_ = 0;
+    }
+    if (n_trees_ == n_trees) {
+      return;
     }
 
-    nodes = cl::sycl::malloc_shared<DeviceNodeOneAPI>(sum, qu_);
-    for (int tree_idx = tree_begin; tree_idx < tree_end; tree_idx++) {
+    tree_segments.Resize(n_trees + 1, qu);
+    size_t* segments = tree_segments.Data();
+    segments[0] = 0;
+    for (size_t tree_idx = n_trees_; tree_idx < n_trees; tree_idx++) {
+      segments[tree_idx + 1] = segments[tree_idx] + model.trees[tree_idx]->GetNodes().size();
+    }
+
+    nodes.Resize(segments[n_trees], qu);
+    for (size_t tree_idx = n_trees_; tree_idx < n_trees; tree_idx++) {
       auto& src_nodes = model.trees[tree_idx]->GetNodes();
-      for (size_t node_idx = 0; node_idx < src_nodes.size(); node_idx++)
-        nodes[node_idx + tree_segments[tree_idx - tree_begin]] = src_nodes[node_idx];
+      std::copy(src_nodes.cbegin(), src_nodes.cend(), nodes.Data() + segments[tree_idx]);
     }
 
-    tree_group = cl::sycl::malloc_shared<int>(model.tree_info.size(), qu_);
-    for (size_t tree_idx = 0; tree_idx < model.tree_info.size(); tree_idx++)
-      tree_group[tree_idx] = model.tree_info[tree_idx];
+    tree_group.Resize(n_trees, qu);
+    std::copy(model.tree_info.cbegin() + n_trees_, model.tree_info.cend(),
+              tree_group.Data() + n_trees_);
 
-    tree_beg_ = tree_begin;
-    tree_end_ = tree_end;
-    num_group = model.learner_model_param->num_output_group; 
+    generation_ = model.Generation();
+    n_trees_ = n_trees;
   }
 };
 
@@ -289,44 +290,65 @@ class PredictorOneAPI : public Predictor {
   void DevicePredictInternal(DeviceMatrixOneAPI* dmat, HostDeviceVector<float>* out_preds,
                              const gbm::GBTreeModel& model, size_t tree_begin,
                              size_t tree_end) {
-    if (tree_end - tree_begin == 0) {
+    size_t num_rows = dmat->row_ptr_size - 1;
+    if (tree_end - tree_begin == 0 || num_rows == 0) {
       return;
     }
-    model_.Init(model, tree_begin, tree_end, qu_);
-
-    auto& out_preds_vec = out_preds->HostVector();
+    std::lock_guard<std::mutex> guard{lock_};
+    model_.Init(model, qu_);
 
-    DeviceNodeOneAPI* nodes = model_.nodes;
-    cl::sycl::buffer<float, 1> out_preds_buf(out_preds_vec.data(), out_preds_vec.size());
-    size_t* tree_segments = model_.tree_segments;
-    int* tree_group = model_.tree_group;
+    DeviceNodeOneAPI const* nodes = model_.nodes.Data();
+    size_t const* tree_segments = model_.tree_segments.Data();
+    int const* tree_group = model_.tree_group.Data();
     size_t* row_ptr = dmat->row_ptr;
     EntryOneAPI* data = dmat->data;
-    int num_features = dmat->p_mat->Info().num_col_;
-    int num_rows = dmat->row_ptr_size - 1;
-    int num_group = model.learner_model_param->num_output_group;
+    size_t num_group = model.learner_model_param->num_output_group;
+
+    // Split trees into tiles so that small batches still occupy the device.  Each tile
+    // writes partial sums, which are reduced into the output afterward.
+    size_t n_trees = tree_end - tree_begin;
+    size_t n_tiles = std::max(std::min(common::DivRoundUp(kMinWorkItems, num_rows),
+                                       common::DivRoundUp(n_trees, kMinTreesPerTile)),
+                              static_cast<size_t>(1));
+    size_t trees_per_tile = common::DivRoundUp(n_trees, n_tiles);
+    n_tiles = common::DivRoundUp(n_trees, trees_per_tile);
+    size_t n_padded_rows = common::DivRoundUp(num_rows, kRowsPerGroup) * kRowsPerGroup;
+
+    size_t n_out = num_rows * num_group;
+    partial_.Resize(n_tiles * n_out, qu_);
+    float* partial = partial_.Data();
 
     qu_.submit([&](cl::sycl::handler& cgh) {
-      auto out_predictions = out_preds_buf.get_access<cl::sycl::access::mode::read_write>(cgh);
-      cgh.parallel_for<class PredictInternal>(cl::sycl::range<1>(num_rows), [=](cl::sycl::id<1> pid) {
-        int global_idx = pid[0];
-        if (global_idx >= num_rows) return;
-        if (num_group == 1) {
-          float sum = 0.0;
-          for (int tree_idx = tree_begin; tree_idx < tree_end; tree_idx++) {
-            const DeviceNodeOneAPI* tree = nodes + tree_segments[tree_idx - tree_begin];
-            sum += GetLeafWeight(global_idx, tree, data, row_ptr);
-          }
-          out_predictions[global_idx] += sum;
-        } else {
-          for (int tree_idx = tree_begin; tree_idx < tree_end; tree_idx++) {
-            const DeviceNodeOneAPI* tree = nodes + tree_segments[tree_idx - tree_begin];
-            int out_prediction_idx = global_idx * num_group + tree_group[tree_idx];
-            out_predictions[out_prediction_idx] += GetLeafWeight(global_idx, tree, data, row_ptr);
-          }
-        }
-      });
+      cgh.parallel_for<class PredictInternal>(
+          cl::sycl::nd_range<2>(cl::sycl::range<2>(n_padded_rows, n_tiles),
+                                cl::sycl::range<2>(kRowsPerGroup, 1)),
+          [=](cl::sycl::nd_item<2> item) {
+            size_t ridx = item.get_global_id(0);
+            size_t tile = item.get_global_id(1);
+            if (ridx >= num_rows) return;
+            float* out = partial + tile * n_out + ridx * num_group;
+            for (size_t gidx = 0; gidx < num_group; ++gidx) {
+              out[gidx] = 0;
+            }
+            size_t beg = tree_begin + tile * trees_per_tile;
+            size_t end = std::min(beg + trees_per_tile, tree_end);
+            for (size_t tree_idx = beg; tree_idx < end; tree_idx++) {
+              const DeviceNodeOneAPI* tree = nodes + tree_segments[tree_idx];
+              out[num_group == 1 ? 0 : tree_group[tree_idx]] +=
+                  GetLeafWeight(static_cast<int>(ridx), tree, data, row_ptr);
+            }
+          });
     }).wait();
+
+    auto& out_preds_vec = out_preds->HostVector();
+    CHECK_EQ(out_preds_vec.size(), n_out);
+    for (size_t i = 0; i < n_out; ++i) {
+      float sum = 0;
+      for (size_t tile = 0; tile < n_tiles; ++tile) {
+        sum += partial[tile * n_out + i];
+      }
+      out_preds_vec[i] += sum;
+    }
   }
 
  public:
@@ -431,6 +453,8 @@ class PredictorOneAPI : public Predictor {
  private:
   cl::sycl::queue qu_;
   DeviceModelOneAPI model_;
+  // Partial predictions of each tile of trees.
+  USMVector<float> partial_;
 
   std::mutex lock_;
   std::unique_ptr<Predictor> cpu_predictor;
@@ -0,0 +1,558 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ * \file updater_quantile_hist_oneapi.cc
+ * \brief Hist tree method with histograms and row partitions on oneAPI devices.
+ */
+#include <dmlc/omp.h>
+#include <rabit/rabit.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/json.h"
+#include "xgboost/logging.h"
+#include "xgboost/tree_updater.h"
+
+#include "../../src/common/common.h"
+#include "../../src/common/hist_util.h"
+#include "../../src/common/random.h"
+#include "../../src/common/timer.h"
+#include "../../src/tree/driver.h"
+#include "../../src/tree/hist/evaluate_splits.h"
+#include "../../src/tree/hist/expand_entry.h"
+#include "../../src/tree/param.h"
+#include "./usm_vector_oneapi.h"
+
+#include "CL/sycl.hpp"
+
+namespace xgboost {
+namespace tree {
+
+DMLC_REGISTRY_FILE_TAG(updater_quantile_hist_oneapi);
+
+// Rows accumulated sequentially by a work-item when building histograms.
+constexpr size_t kMinRowsPerHistBlock = 256;
+// Upper bound of the number of bins in all partial histograms.
+constexpr size_t kMaxHistBlockEntries = 1 << 22;
+// Rows scattered sequentially by a work-item, which keeps the row partition stable.
+constexpr size_t kRowsPerPartitionBlock = 1024;
+
+/*!
+ * \brief Quantized features on device in ELLPACK layout.  Each row stores `row_stride`
+ *        global bin indices padded by `null_bin`.  For dense data the k^th bin of a row
+ *        belongs to the k^th feature.
+ */
+class DeviceGHistIndexOneAPI {
+ public:
+  USMVector<uint32_t> gidx;
+  USMVector<float> cut_values;
+  USMVector<uint32_t> cut_ptrs;
+  size_t row_stride{0};
+  uint32_t null_bin{0};
+  bool is_dense{false};
+
+  void Init(DMatrix* p_fmat, common::HistogramCuts const& cut, cl::sycl::queue qu) {
+    auto const& h_values = cut.Values();
+    auto const& h_ptrs = cut.Ptrs();
+    cut_values.Resize(h_values.size(), qu);
+    std::copy(h_values.cbegin(), h_values.cend(), cut_values.Data());
+    cut_ptrs.Resize(h_ptrs.size(), qu);
+    std::copy(h_ptrs.cbegin(), h_ptrs.cend(), cut_ptrs.Data());
+
+    auto const& info = p_fmat->Info();
+    null_bin = h_ptrs.back();
+    is_dense = info.num_nonzero_ == info.num_row_ * info.num_col_;
+    row_stride = 0;
+    for (auto const& batch : p_fmat->GetBatches<SparsePage>()) {
+      auto const& h_offset = batch.offset.ConstHostVector();
+      for (size_t i = 0; i < batch.Size(); ++i) {
+        row_stride = std::max(row_stride, static_cast<size_t>(h_offset[i + 1] - h_offset[i]));
+      }
+    }
+    gidx.Resize(info.num_row_ * row_stride, qu);
+
+    USMVector<Entry> entries;
+    USMVector<size_t> offsets;
+    for (auto const& batch : p_fmat->GetBatches<SparsePage>()) {
+      size_t batch_size = batch.Size();
+      if (batch_size == 0) {
+        continue;
+      }
+      auto const& h_data = batch.data.ConstHostVector();
+      auto const& h_offset = batch.offset.ConstHostVector();
+      entries.Resize(h_data.size(), qu);
+      std::copy(h_data.cbegin(), h_data.cend(), entries.Data());
+      offsets.Resize(h_offset.size(), qu);
+      std::copy(h_offset.cbegin(), h_offset.cend(), offsets.Data());
+
+      uint32_t* d_gidx = gidx.Data() + batch.base_rowid * row_stride;
+      Entry const* d_entries = entries.Data();
+      size_t const* d_offsets = offsets.Data();
+      float const* d_values = cut_values.Data();
+      uint32_t const* d_ptrs = cut_ptrs.Data();
+      size_t stride = row_stride;
+      uint32_t null = null_bin;
+      bool dense = is_dense;
+      qu.submit([&](cl::sycl::handler& cgh) {
+        cgh.parallel_for<class QuantizeOneAPI>(cl::sycl::range<1>(batch_size),
+                                               [=](cl::sycl::id<1> pid) {
+          size_t ridx = pid[0];
+          uint32_t* out = d_gidx + ridx * stride;
+          size_t k = 0;
+          for (size_t j = d_offsets[ridx]; j < d_offsets[ridx + 1]; ++j, ++k) {
+            auto fidx = d_entries[j].index;
+            float fvalue = d_entries[j].fvalue;
+            // Same as `HistogramCuts::SearchBin`, the first cut greater than the value.
+            uint32_t beg = d_ptrs[fidx];
+            uint32_t end = d_ptrs[fidx + 1];
+            while (beg < end) {
+              uint32_t mid = beg + (end - beg) / 2;
+              if (d_values[mid] <= fvalue) {
+                beg = mid + 1;
+              } else {
+                end = mid;
+              }
+            }
+            uint32_t bin = beg == d_ptrs[fidx + 1] ? beg - 1 : beg;
+            out[dense ? fidx : k] = bin;
+          }
+          for (; k < stride; ++k) {
+            out[k] = null;
+          }
+        });
+      }).wait();
+    }
+  }
+};
+
+/*!
+ * \brief Grow tree with the hist method.  Quantization, histogram building and row
+ *        partitioning run on the device, split evaluation reuses the CPU `HistEvaluator`
+ *        on histograms read from shared USM.
+ */
+class QuantileHistMakerOneAPI : public TreeUpdater {
+  using GradientSumT = double;
+  using DeviceHist = USMVector<GradientPairPrecise>;
+
+  TrainParam param_;
+  ObjInfo task_;
+  std::unique_ptr<TreeUpdater> syncher_;
+  // Preserve the rng for the entire training session.
+  std::shared_ptr<common::ColumnSampler> column_sampler_{
+      std::make_shared<common::ColumnSampler>()};
+  std::unique_ptr<HistEvaluator<GradientSumT, CPUExpandEntry>> evaluator_;
+  common::HistogramCuts cut_;
+  DMatrix const* p_last_fmat_{nullptr};
+  int32_t last_max_bin_{0};
+
+  cl::sycl::queue qu_;
+  DeviceGHistIndexOneAPI gmat_;
+  USMVector<GradientPair> gpair_;
+  // Sampled rows grouped by node, rows of a node are `rows_[begin, end)`.
+  USMVector<size_t> rows_;
+  USMVector<size_t> rows_buffer_;
+  USMVector<uint8_t> go_left_;
+  USMVector<size_t> block_counts_;
+  std::map<bst_node_t, std::pair<size_t, size_t>> segments_;
+  // Histograms of nodes waiting to be expanded, released histograms are reused.
+  std::map<bst_node_t, std::unique_ptr<DeviceHist>> hist_;
+  std::vector<std::unique_ptr<DeviceHist>> free_hist_;
+  USMVector<GradientPairPrecise> block_hist_;
+  // Host histograms used by the evaluator.
+  common::HistCollection<GradientSumT> host_hist_;
+  common::Monitor monitor_;
+
+  size_t NumBins() const { return gmat_.null_bin; }
+  size_t NumRows(bst_node_t nidx) const {
+    auto const& seg = segments_.at(nidx);
+    return seg.second - seg.first;
+  }
+
+  void InitData(DMatrix* p_fmat, std::vector<GradientPair> const& h_gpair) {
+    monitor_.Start(__func__);
+    auto const& info = p_fmat->Info();
+    CHECK_EQ(h_gpair.size(), info.num_row_)
+        << "Mismatching size between number of rows and size of gradient.";
+    if (p_fmat != p_last_fmat_ || param_.max_bin != last_max_bin_) {
+      auto const& h_ft = info.feature_types.ConstHostVector();
+      CHECK(std::none_of(h_ft.cbegin(), h_ft.cend(),
+                         [](FeatureType t) { return t == FeatureType::kCategorical; }))
+          << "oneAPI hist doesn't support categorical data.";
+      cut_ = common::SketchOnDMatrix(p_fmat, param_.max_bin, {}, param_.sketch_sample_rows);
+      gmat_.Init(p_fmat, cut_, qu_);
+      p_last_fmat_ = p_fmat;
+      last_max_bin_ = param_.max_bin;
+    }
+
+    gpair_.Resize(h_gpair.size(), qu_);
+    std::copy(h_gpair.cbegin(), h_gpair.cend(), gpair_.Data());
+
+    rows_.Resize(info.num_row_, qu_);
+    size_t* h_rows = rows_.Data();
+    size_t n_rows = 0;
+    auto& rnd = common::GlobalRandom();
+    std::bernoulli_distribution coin_flip(param_.subsample);
+    for (size_t ridx = 0; ridx < info.num_row_; ++ridx) {
+      // Rows with negative hessian are dropped, same as the CPU hist.
+      if (h_gpair[ridx].GetHess() < 0.0f || (param_.subsample < 1.0f && !coin_flip(rnd))) {
+        continue;
+      }
+      h_rows[n_rows++] = ridx;
+    }
+    rows_buffer_.Resize(n_rows, qu_);
+    go_left_.Resize(n_rows, qu_);
+    segments_.clear();
+    segments_[RegTree::kRoot] = {0, n_rows};
+
+    for (auto& kv : hist_) {
+      free_hist_.emplace_back(std::move(kv.second));
+    }
+    hist_.clear();
+    host_hist_.Init(NumBins());
+    evaluator_.reset(new HistEvaluator<GradientSumT, CPUExpandEntry>{
+        param_, info, omp_get_max_threads(), column_sampler_, task_});
+    monitor_.Stop(__func__);
+  }
+
+  DeviceHist* AllocateHist(bst_node_t nidx) {
+    std::unique_ptr<DeviceHist> hist;
+    if (free_hist_.empty()) {
+      hist.reset(new DeviceHist);
+    } else {
+      hist = std::move(free_hist_.back());
+      free_hist_.pop_back();
+    }
+    hist->Resize(NumBins(), qu_);
+    auto p_hist = hist.get();
+    hist_[nidx] = std::move(hist);
+    return p_hist;
+  }
+
+  void FreeHist(bst_node_t nidx) {
+    auto it = hist_.find(nidx);
+    if (it != hist_.end()) {
+      free_hist_.emplace_back(std::move(it->second));
+      hist_.erase(it);
+    }
+  }
+
+  void BuildHist(bst_node_t nidx) {
+    monitor_.Start(__func__);
+    auto const& seg = segments_.at(nidx);
+    size_t n = seg.second - seg.first;
+    size_t n_bins = NumBins();
+    GradientPairPrecise* d_hist = this->AllocateHist(nidx)->Data();
+
+    // Rows are divided into blocks, each block accumulates into its own histogram.
+    size_t n_blocks = std::max(std::min(common::DivRoundUp(n, kMinRowsPerHistBlock),
+                                        kMaxHistBlockEntries / n_bins),
+                               static_cast<size_t>(1));
+    size_t block_size = std::max(common::DivRoundUp(n, n_blocks), static_cast<size_t>(1));
+    block_hist_.Resize(n_blocks * n_bins, qu_);
+    GradientPairPrecise* d_blocks = block_hist_.Data();
+    size_t const* d_rows = rows_.Data() + seg.first;
+    uint32_t const* d_gidx = gmat_.gidx.Data();
+    uint32_t const* d_ptrs = gmat_.cut_ptrs.Data();
+    GradientPair const* d_gpair = gpair_.Data();
+    size_t stride = gmat_.row_stride;
+    uint32_t null = gmat_.null_bin;
+
+    if (gmat_.is_dense) {
+      // Bins of different features don't overlap, so a work-item handles a single feature
+      // of a block.
+      qu_.submit([&](cl::sycl::handler& cgh) {
+        cgh.parallel_for<class BuildDenseHistOneAPI>(cl::sycl::range<2>(n_blocks, stride),
+                                                     [=](cl::sycl::id<2> pid) {
+          size_t b = pid[0];
+          size_t fidx = pid[1];
+          GradientPairPrecise* local = d_blocks + b * n_bins;
+          for (uint32_t i = d_ptrs[fidx]; i < d_ptrs[fidx + 1]; ++i) {
+            local[i] = GradientPairPrecise{};
+          }
+          size_t end = std::min((b + 1) * block_size, n);
+          for (size_t i = b * block_size; i < end; ++i) {
+            size_t ridx = d_rows[i];
+            auto g = d_gpair[ridx];
+            local[d_gidx[ridx * stride + fidx]].Add(g.GetGrad(), g.GetHess());
+          }
+        });
+      }).wait();
+    } else {
+      qu_.submit([&](cl::sycl::handler& cgh) {
+        cgh.parallel_for<class BuildHistOneAPI>(cl::sycl::range<1>(n_blocks),
+                                                [=](cl::sycl::id<1> pid) {
+          size_t b = pid[0];
+          GradientPairPrecise* local = d_blocks + b * n_bins;
+          for (size_t i = 0; i < n_bins; ++i) {
+            local[i] = GradientPairPrecise{};
+          }
+          size_t end = std::min((b + 1) * block_size, n);
+          for (size_t i = b * block_size; i < end; ++i) {
+            size_t ridx = d_rows[i];
+            auto g = d_gpair[ridx];
+            uint32_t const* row = d_gidx + ridx * stride;
+            for (size_t k = 0; k < stride && row[k] != null; ++k) {
+              local[row[k]].Add(g.GetGrad(), g.GetHess());
+            }
+          }
+        });
+      }).wait();
+    }
+    qu_.submit([&](cl::sycl::handler& cgh) {
+      cgh.parallel_for<class ReduceHistOneAPI>(cl::sycl::range<1>(n_bins),
+                                               [=](cl::sycl::id<1> pid) {
+        size_t i = pid[0];
+        GradientPairPrecise sum;
+        for (size_t b = 0; b < n_blocks; ++b) {
+          sum += d_blocks[b * n_bins + i];
+        }
+        d_hist[i] = sum;
+      });
+    }).wait();
+    rabit::Allreduce<rabit::op::Sum, GradientSumT>(reinterpret_cast<GradientSumT*>(d_hist),
+                                                    n_bins * 2);
+    monitor_.Stop(__func__);
+  }
+
+  // Obtain the histogram of the larger child by subtracting the smaller one from parent.
+  void SubtractionTrick(bst_node_t parent, bst_node_t small, bst_node_t large) {
+    GradientPairPrecise* d_parent = hist_.at(parent)->Data();
+    GradientPairPrecise const* d_small = hist_.at(small)->Data();
+    qu_.submit([&](cl::sycl::handler& cgh) {
+      cgh.parallel_for<class SubtractHistOneAPI>(cl::sycl::range<1>(NumBins()),
+                                                 [=](cl::sycl::id<1> pid) {
+        d_parent[pid[0]] -= d_small[pid[0]];
+      });
+    }).wait();
+    hist_[large] = std::move(hist_.at(parent));
+    hist_.erase(parent);
+  }
+
+  void EvaluateSplits(DMatrix* p_fmat, RegTree const& tree,
+                      std::vector<CPUExpandEntry>* p_entries) {
+    monitor_.Start(__func__);
+    for (auto const& e : *p_entries) {
+      host_hist_.AddHistRow(e.nid);
+      host_hist_.AllocateData(e.nid);
+      auto const* d_hist = hist_.at(e.nid)->Data();
+      std::copy(d_hist, d_hist + NumBins(), host_hist_[e.nid].data());
+    }
+    evaluator_->EvaluateSplits(host_hist_, cut_, p_fmat->Info().feature_types.ConstHostSpan(),
+                               tree, p_entries);
+    for (auto const& e : *p_entries) {
+      host_hist_.FreeHistRow(e.nid);
+    }
+    monitor_.Stop(__func__);
+  }
+
+  void ApplySplit(CPUExpandEntry const& candidate, RegTree* p_tree) {
+    monitor_.Start(__func__);
+    evaluator_->ApplyTreeSplit(candidate, p_tree);
+    auto const& seg = segments_.at(candidate.nid);
+    size_t n = seg.second - seg.first;
+    size_t* d_rows = rows_.Data() + seg.first;
+    size_t* d_buffer = rows_buffer_.Data();
+    uint8_t* d_left = go_left_.Data();
+    uint32_t const* d_gidx = gmat_.gidx.Data();
+    float const* d_values = gmat_.cut_values.Data();
+    uint32_t const* d_ptrs = gmat_.cut_ptrs.Data();
+    size_t stride = gmat_.row_stride;
+    bool dense = gmat_.is_dense;
+    bst_feature_t fidx = candidate.split.SplitIndex();
+    float split_value = candidate.split.split_value;
+    bool default_left = candidate.split.DefaultLeft();
+
+    qu_.submit([&](cl::sycl::handler& cgh) {
+      cgh.parallel_for<class PartitionDecisionOneAPI>(cl::sycl::range<1>(n),
+                                                      [=](cl::sycl::id<1> pid) {
+        size_t i = pid[0];
+        uint32_t const* row = d_gidx + d_rows[i] * stride;
+        bool left = default_left;
+        if (dense) {
+          left = d_values[row[fidx]] <= split_value;
+        } else {
+          for (size_t k = 0; k < stride; ++k) {
+            if (row[k] >= d_ptrs[fidx] && row[k] < d_ptrs[fidx + 1]) {
+              left = d_values[row[k]] <= split_value;
+              break;
+            }
+          }
+        }
+        d_left[i] = left;
+      });
+    }).wait();
+
+    // Count the left rows of each block, then scatter rows with the scanned offsets.
+    size_t n_blocks = common::DivRoundUp(n, kRowsPerPartitionBlock);
+    block_counts_.Resize(n_blocks * 3, qu_);
+    size_t* d_counts = block_counts_.Data();
+    qu_.submit([&](cl::sycl::handler& cgh) {
+      cgh.parallel_for<class PartitionCountOneAPI>(cl::sycl::range<1>(n_blocks),
+                                                   [=](cl::sycl::id<1> pid) {
+        size_t b = pid[0];
+        size_t end = std::min((b + 1) * kRowsPerPartitionBlock, n);
+        size_t cnt = 0;
+        for (size_t i = b * kRowsPerPartitionBlock; i < end; ++i) {
+          cnt += d_left[i];
+        }
+        d_counts[b] = cnt;
+      });
+    }).wait();
+    size_t n_left = 0;
+    for (size_t b = 0; b < n_blocks; ++b) {
+      d_counts[n_blocks + b] = n_left;
+      n_left += d_counts[b];
+    }
+    for (size_t b = 0, n_right = 0; b < n_blocks; ++b) {
+      d_counts[2 * n_blocks + b] = n_left + n_right;
+      n_right += std::min(kRowsPerPartitionBlock, n - b * kRowsPerPartitionBlock) - d_counts[b];
+    }
+    qu_.submit([&](cl::sycl::handler& cgh) {
+      cgh.parallel_for<class PartitionScatterOneAPI>(cl::sycl::range<1>(n_blocks),
+                                                     [=](cl::sycl::id<1> pid) {
+        size_t b = pid[0];
+        size_t end = std::min((b + 1) * kRowsPerPartitionBlock, n);
+        size_t left_pos = d_counts[n_blocks + b];
+        size_t right_pos = d_counts[2 * n_blocks + b];
+        for (size_t i = b * kRowsPerPartitionBlock; i < end; ++i) {
+          d_buffer[d_left[i] ? left_pos++ : right_pos++] = d_rows[i];
+        }
+      });
+    }).wait();
+    qu_.submit([&](cl::sycl::handler& cgh) {
+      cgh.parallel_for<class PartitionCopyOneAPI>(cl::sycl::range<1>(n),
+                                                  [=](cl::sycl::id<1> pid) {
+        d_rows[pid[0]] = d_buffer[pid[0]];
+      });
+    }).wait();
+
+    auto begin = seg.first;
+    auto end = seg.second;
+    segments_[(*p_tree)[candidate.nid].LeftChild()] = {begin, begin + n_left};
+    segments_[(*p_tree)[candidate.nid].RightChild()] = {begin + n_left, end};
+    segments_.erase(candidate.nid);
+    monitor_.Stop(__func__);
+  }
+
+  void UpdateTree(HostDeviceVector<GradientPair>* gpair, DMatrix* p_fmat, RegTree* p_tree) {
+    monitor_.Start(__func__);
+    CHECK(!p_tree->IsMultiTarget()) << "oneAPI hist doesn't support multi-target tree.";
+    auto const& h_gpair = gpair->ConstHostVector();
+    this->InitData(p_fmat, h_gpair);
+
+    GradStats root_sum;
+    size_t const* h_rows = rows_.Data();
+    for (size_t i = 0; i < NumRows(RegTree::kRoot); ++i) {
+      root_sum.Add(h_gpair[h_rows[i]]);
+    }
+    rabit::Allreduce<rabit::op::Sum, GradientSumT>(reinterpret_cast<GradientSumT*>(&root_sum),
+                                                    2);
+    auto weight = evaluator_->InitRoot(root_sum);
+    p_tree->Stat(RegTree::kRoot).sum_hess = root_sum.GetHess();
+    p_tree->Stat(RegTree::kRoot).base_weight = weight;
+    (*p_tree)[RegTree::kRoot].SetLeaf(param_.learning_rate * weight);
+
+    Driver<CPUExpandEntry> driver(static_cast<TrainParam::TreeGrowPolicy>(param_.grow_policy));
+    std::vector<CPUExpandEntry> entries{
+        CPUExpandEntry{RegTree::kRoot, p_tree->GetDepth(RegTree::kRoot), 0.0f}};
+    this->BuildHist(RegTree::kRoot);
+    this->EvaluateSplits(p_fmat, *p_tree, &entries);
+    driver.Push(entries.front());
+
+    int32_t num_leaves = 1;
+    auto expand_set = driver.Pop();
+    while (!expand_set.empty()) {
+      std::vector<CPUExpandEntry> valid_candidates;
+      for (auto const& candidate : expand_set) {
+        if (!candidate.IsValid(param_, num_leaves)) {
+          this->FreeHist(candidate.nid);
+          continue;
+        }
+        this->ApplySplit(candidate, p_tree);
+        num_leaves++;
+
+        int32_t depth = candidate.depth + 1;
+        if (!CPUExpandEntry::ChildIsValid(param_, depth, num_leaves)) {
+          this->FreeHist(candidate.nid);
+          continue;
+        }
+        // Build the histogram of the smaller child, the other one is obtained by
+        // subtracting it from the parent.
+        auto left_nidx = (*p_tree)[candidate.nid].LeftChild();
+        auto right_nidx = (*p_tree)[candidate.nid].RightChild();
+        bool left_smaller = NumRows(left_nidx) <= NumRows(right_nidx);
+        auto small_nidx = left_smaller ? left_nidx : right_nidx;
+        auto large_nidx = left_smaller ? right_nidx : left_nidx;
+        this->BuildHist(small_nidx);
+        this->SubtractionTrick(candidate.nid, small_nidx, large_nidx);
+
+        std::vector<CPUExpandEntry> children{CPUExpandEntry{left_nidx, depth, 0.0f},
+                                             CPUExpandEntry{right_nidx, depth, 0.0f}};
+        this->EvaluateSplits(p_fmat, *p_tree, &children);
+        valid_candidates.insert(valid_candidates.end(), children.cbegin(), children.cend());
+      }
+      driver.Push(valid_candidates.begin(), valid_candidates.end());
+      expand_set = driver.Pop();
+    }
+    for (auto& kv : hist_) {
+      free_hist_.emplace_back(std::move(kv.second));
+    }
+    hist_.clear();
+    monitor_.Stop(__func__);
+  }
+
+ public:
+  explicit QuantileHistMakerOneAPI(ObjInfo task) : task_{task} {
+    cl::sycl::default_selector selector;
+    qu_ = cl::sycl::queue(selector);
+    monitor_.Init("QuantileHistMakerOneAPI");
+  }
+
+  void Configure(const Args& args) override {
+    param_.UpdateAllowUnknown(args);
+    // Splits violating `min_split_loss` or `max_depth` are never applied, only the
+    // synchronization is needed.
+    if (!syncher_) {
+      syncher_.reset(TreeUpdater::Create("sync", tparam_, task_));
+    }
+    syncher_->Configure(args);
+  }
+
+  void LoadConfig(Json const& in) override {
+    auto const& config = get<Object const>(in);
+    FromJson(config.at("train_param"), &this->param_);
+  }
+  void SaveConfig(Json* p_out) const override {
+    auto& out = *p_out;
+    out["train_param"] = ToJson(param_);
+  }
+
+  void Update(HostDeviceVector<GradientPair>* gpair, DMatrix* p_fmat,
+              const std::vector<RegTree*>& trees) override {
+    // rescale learning rate according to size of trees
+    float lr = param_.learning_rate;
+    param_.learning_rate = lr / trees.size();
+    for (auto tree : trees) {
+      this->UpdateTree(gpair, p_fmat, tree);
+    }
+    param_.learning_rate = lr;
+    syncher_->Update(gpair, p_fmat, trees);
+  }
+
+  char const* Name() const override { return "grow_quantile_histmaker_oneapi"; }
+};
+
+XGBOOST_REGISTER_TREE_UPDATER(QuantileHistMakerOneAPI, "grow_quantile_histmaker_oneapi")
+.describe("Grow tree using quantized histogram on oneAPI device.")
+.set_body(
+    [](ObjInfo task) {
+      return new QuantileHistMakerOneAPI(task);
+    });
+}  // namespace tree
+}  // namespace xgboost
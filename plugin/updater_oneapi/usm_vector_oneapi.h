@@ -0,0 +1,54 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#ifndef XGBOOST_USM_VECTOR_ONEAPI_H_
+#define XGBOOST_USM_VECTOR_ONEAPI_H_
+
+#include <algorithm>
+#include <cstddef>
+
+#include "CL/sycl.hpp"
+
+namespace xgboost {
+
+/*!
+ * \brief USM shared allocation reused across calls.  The capacity only grows, so repeated
+ *        calls don't pay for device allocation.
+ */
+template <typename T>
+class USMVector {
+  cl::sycl::queue qu_;
+  T* ptr_{nullptr};
+  size_t size_{0};
+  size_t capacity_{0};
+
+ public:
+  USMVector() = default;
+  USMVector(USMVector const&) = delete;
+  USMVector& operator=(USMVector const&) = delete;
+  ~USMVector() {
+    if (ptr_) {
+      cl::sycl::free(ptr_, qu_);
+    }
+  }
+  /*! \brief Resize the vector, existing elements are kept. */
+  void Resize(size_t n, cl::sycl::queue qu) {
+    if (n > capacity_) {
+      size_t capacity = std::max(n, capacity_ * 2);
+      T* ptr = cl::sycl::malloc_shared<T>(capacity, qu);
+      if (ptr_) {
+        std::copy(ptr_, ptr_ + size_, ptr);
+        cl::sycl::free(ptr_, qu_);
+      }
+      qu_ = qu;
+      ptr_ = ptr;
+      capacity_ = capacity;
+    }
+    size_ = n;
+  }
+  T* Data() const { return ptr_; }
+  size_t Size() const { return size_; }
+};
+}  // namespace xgboost
+
+#endif  // XGBOOST_USM_VECTOR_ONEAPI_H_
@@ -6,7 +6,7 @@ Contributors: https://github.com/dmlc/xgboost/blob/master/CONTRIBUTORS.md
 
 import os
 
-from .core import DMatrix, DeviceQuantileDMatrix, Booster, DataIter, build_info
+from .core import DMatrix, DeviceQuantileDMatrix, QuantileDMatrix, Booster, DataIter, build_info
 from .training import train, cv
 from . import rabit  # noqa
 from . import tracker  # noqa
@@ -29,6 +29,7 @@ __all__ = [
     # core
     "DMatrix",
     "DeviceQuantileDMatrix",
+    "QuantileDMatrix",
     "Booster",
     "DataIter",
     "train",
@@ -316,12 +316,19 @@ class DataIter:  # pylint: disable=too-many-instance-attributes
     cache_prefix:
         Prefix to the cache files, only used in external memory.  It can be either an URI
         or a file path.
+    page_format:
+        Format of the cache files, only used in external memory.  Either ``raw`` or
+        ``compressed``.  Compressed cache files are smaller but take more CPU time to
+        read and write.
 
     """
     _T = TypeVar("_T")
 
-    def __init__(self, cache_prefix: Optional[str] = None) -> None:
+    def __init__(
+        self, cache_prefix: Optional[str] = None, page_format: str = "raw"
+    ) -> None:
         self.cache_prefix = cache_prefix
+        self.page_format = page_format
 
         self._handle = _ProxyDMatrix()
         self._exception: Optional[Exception] = None
@@ -636,6 +643,7 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes
             "missing": self.missing,
             "nthread": self.nthread,
             "cache_prefix": it.cache_prefix if it.cache_prefix else "",
+            "page_format": getattr(it, "page_format", "raw"),
         }
         args = from_pystr_to_cstr(json.dumps(args))
         handle = ctypes.c_void_p()
@@ -787,7 +795,7 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes
         from .data import dispatch_meta_backend
         dispatch_meta_backend(self, data, field, 'uint32')
 
-    def save_binary(self, fname, silent=True) -> None:
+    def save_binary(self, fname, silent=True, max_bin: Optional[int] = None) -> None:
         """Save DMatrix to an XGBoost buffer.  Saved binary can be later loaded
         by providing the path to :py:func:`xgboost.DMatrix` as input.
 
@@ -797,11 +805,21 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes
             Name of the output buffer file.
         silent : bool (optional; default: True)
             If set, the output is suppressed.
+        max_bin :
+            When specified, the quantized data used by the ``hist`` tree method is saved
+            along with the raw data.  Training on the loaded DMatrix with the same
+            ``max_bin`` doesn't need to sketch the data again.
+
+            .. versionadded:: 1.6.0
         """
         fname = os.fspath(os.path.expanduser(fname))
-        _check_call(_LIB.XGDMatrixSaveBinary(self.handle,
-                                             c_str(fname),
-                                             ctypes.c_int(silent)))
+        if max_bin is None:
+            _check_call(_LIB.XGDMatrixSaveBinary(self.handle,
+                                                 c_str(fname),
+                                                 ctypes.c_int(silent)))
+        else:
+            config = from_pystr_to_cstr(json.dumps({"max_bin": int(max_bin)}))
+            _check_call(_LIB.XGDMatrixSaveBinaryEx(self.handle, c_str(fname), config))
 
     def set_label(self, label) -> None:
         """Set label of dmatrix
@@ -912,7 +930,10 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes
         return ret.value
 
     def slice(
-        self, rindex: Union[List[int], np.ndarray], allow_groups: bool = False
+        self,
+        rindex: Union[List[int], np.ndarray],
+        allow_groups: bool = False,
+        view: bool = False,
     ) -> "DMatrix":
         """Slice the DMatrix and return a new DMatrix that only contains `rindex`.
 
@@ -922,6 +943,12 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes
             List of indices to be selected.
         allow_groups
             Allow slicing of a matrix with a groups attribute
+        view
+            Return a view that refers to this DMatrix instead of copying the selected rows.
+            The quantized data used by the ``hist`` tree method is gathered from this
+            DMatrix, so the raw data is not duplicated.
+
+            .. versionadded:: 1.6.0
 
         Returns
         -------
@@ -933,8 +960,9 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes
         res = DMatrix(None)
         res.handle = ctypes.c_void_p()
         rindex = _maybe_np_slice(rindex, dtype=np.int32)
+        slice_fn = _LIB.XGDMatrixSliceDMatrixView if view else _LIB.XGDMatrixSliceDMatrixEx
         _check_call(
-            _LIB.XGDMatrixSliceDMatrixEx(
+            slice_fn(
                 self.handle,
                 c_array(ctypes.c_int, rindex),
                 c_bst_ulong(len(rindex)),
@@ -944,6 +972,25 @@ class DMatrix:  # pylint: disable=too-many-instance-attributes
         )
         return res
 
+    def quantize(self, max_bin: int = 256, sparse_threshold: float = 0.2) -> None:
+        """Build the quantized data used by the ``hist`` tree method ahead of training.
+        The result is cached in this DMatrix and shared by all boosters trained on it with
+        the same ``max_bin``, including boosters trained concurrently in different threads.
+
+        .. versionadded:: 1.6.0
+
+        Parameters
+        ----------
+        max_bin
+            Maximum number of bins for each feature, same as the training parameter.
+        sparse_threshold
+            Same as the training parameter of the ``hist`` tree method.
+        """
+        config = {"max_bin": int(max_bin), "sparse_threshold": float(sparse_threshold)}
+        _check_call(
+            _LIB.XGDMatrixQuantize(self.handle, from_pystr_to_cstr(json.dumps(config)))
+        )
+
     @property
     def feature_names(self) -> Optional[List[str]]:
         """Get feature names (column labels).
@@ -1236,6 +1283,66 @@ class DeviceQuantileDMatrix(DMatrix):
         self.handle = handle
 
 
+class QuantileDMatrix(DeviceQuantileDMatrix):
+    """Host memory counterpart of :py:class:`DeviceQuantileDMatrix` for training with
+    tree_method='hist'.  Data is quantized batch by batch into the histogram index
+    without keeping a copy of the raw data, so only ``hist`` tree method can be used and
+    the object should not be used for test/validation tasks.  When constructed from a
+    :py:class:`DataIter`, the iterator is consumed 3 times and no cache is written.
+
+    When ``ref`` is specified, the data is quantized with the histogram cuts of the
+    reference DMatrix instead of being sketched, for instance when training continues on
+    successive micro-batches.  The reference must have the same number of features and
+    ``max_bin``.
+
+    .. versionadded:: 1.6.0
+
+    """
+
+    def __init__(  # pylint: disable=keyword-arg-before-vararg
+        self, data, label=None, *args, ref: Optional[DMatrix] = None, **kwargs
+    ) -> None:
+        self.ref = ref
+        super().__init__(data, label, *args, **kwargs)
+
+    def _init(self, data, enable_categorical: bool, **meta) -> None:
+        from .data import _is_iter, SingleBatchInternalIter
+
+        if _is_iter(data):
+            it = data
+        else:
+            it = SingleBatchInternalIter(data=data, **meta)
+
+        handle = ctypes.c_void_p()
+        # pylint: disable=protected-access
+        reset_callback, next_callback = it._get_callbacks(True, enable_categorical)
+        if it.cache_prefix is not None:
+            raise ValueError(
+                "QuantileDMatrix doesn't cache data, remove the cache_prefix "
+                "in iterator to fix this error."
+            )
+        args = {
+            "missing": self.missing,
+            "nthread": self.nthread,
+            "max_bin": self.max_bin,
+        }
+        args = from_pystr_to_cstr(json.dumps(args))
+        ret = _LIB.XGQuantileDMatrixCreateFromCallback(
+            None,
+            it.proxy.handle,
+            self.ref.handle if self.ref is not None else None,
+            reset_callback,
+            next_callback,
+            args,
+            ctypes.byref(handle),
+        )
+        # pylint: disable=protected-access
+        it._reraise()
+        # delay check_call to throw intermediate exception first
+        _check_call(ret)
+        self.handle = handle
+
+
 Objective = Callable[[np.ndarray, DMatrix], Tuple[np.ndarray, np.ndarray]]
 Metric = Callable[[np.ndarray, DMatrix], Tuple[str, float]]
 
@@ -1700,6 +1807,8 @@ class Booster:
             The second order of gradient.
 
         """
+        from .data import _array_interface
+
         if len(grad) != len(hess):
             raise ValueError(
                 f"grad / hess length mismatch: {len(grad)} / {len(hess)}"
@@ -1708,11 +1817,66 @@ class Booster:
             raise TypeError(f"invalid training matrix: {type(dtrain).__name__}")
         self._validate_features(dtrain)
 
+        def interface(data: Any) -> Optional[bytes]:
+            if getattr(data, "ndim", None) != 1:
+                return None
+            if hasattr(data, "__cuda_array_interface__"):
+                return _cuda_array_interface(data)
+            if isinstance(data, np.ndarray) and data.dtype.kind in "fiu":
+                return _array_interface(data)
+            return None
+
+        # Pass arrays to XGBoost without converting them to float buffers first.
+        grad_interface, hess_interface = interface(grad), interface(hess)
+        if grad_interface is not None and hess_interface is not None:
+            _check_call(
+                _LIB.XGBoosterBoostOneIterFromInterface(
+                    self.handle,
+                    dtrain.handle,
+                    ctypes.c_int(0),
+                    grad_interface,
+                    hess_interface,
+                )
+            )
+            return
+
         _check_call(_LIB.XGBoosterBoostOneIter(self.handle, dtrain.handle,
                                                c_array(ctypes.c_float, grad),
                                                c_array(ctypes.c_float, hess),
                                                c_bst_ulong(len(grad))))
 
+    def set_eval_cohorts(
+        self, data: DMatrix, cohorts: Optional[Union[np.ndarray, List[int]]]
+    ) -> None:
+        """Split an evaluation dataset into cohorts.  :py:meth:`eval_set` then reports
+        the metrics of each non-empty cohort as ``name[cohort]-metric`` after the whole
+        dataset, computed from a single prediction.  The label and weight are copied
+        when this method is called.
+
+        .. versionadded:: 1.6.0
+
+        Parameters
+        ----------
+        data :
+            The evaluation dataset.
+        cohorts :
+            Non-negative integer cohort id for each row, or ``None`` to remove the cohorts.
+
+        """
+        if cohorts is None:
+            cohorts = []
+        cohorts = np.asarray(cohorts, dtype=np.uint32)
+        if cohorts.size != 0 and cohorts.shape != (data.num_row(),):
+            raise ValueError("Cohort must be specified for each row.")
+        _check_call(
+            _LIB.XGBoosterSetEvalCohorts(
+                self.handle,
+                data.handle,
+                c_array(ctypes.c_uint, cohorts),
+                c_bst_ulong(cohorts.size),
+            )
+        )
+
     def eval_set(
         self,
         evals: Sequence[Tuple[DMatrix, str]],
@@ -1966,7 +2130,7 @@ class Booster:
         Parameters
         ----------
         data : numpy.ndarray/scipy.sparse.csr_matrix/cupy.ndarray/
-               cudf.DataFrame/pd.DataFrame
+               cudf.DataFrame/pd.DataFrame/pyarrow.Table/pyarrow.RecordBatch
             The input data, must not be a view for numpy array.  Set
             ``predictor`` to ``gpu_predictor`` for running prediction on CuPy
             array or CuDF DataFrame.
@@ -2022,6 +2186,30 @@ class Booster:
             proxy = None
             p_handle = ctypes.c_void_p()
         assert proxy is None or isinstance(proxy, _ProxyDMatrix)
+
+        from .data import _is_arrow, _arrow_to_batch, _arrow_export
+        if _is_arrow(data):
+            batch = _arrow_to_batch(data)
+            if validate_features and self.num_features() != batch.num_columns:
+                raise ValueError(
+                    f"Feature shape mismatch, expected: {self.num_features()}, "
+                    f"got {batch.num_columns}"
+                )
+            with _arrow_export(batch) as (array, schema):
+                _check_call(
+                    _LIB.XGBoosterPredictFromArrow(
+                        self.handle,
+                        array,
+                        schema,
+                        from_pystr_to_cstr(json.dumps(args)),
+                        p_handle,
+                        ctypes.byref(shape),
+                        ctypes.byref(dims),
+                        ctypes.byref(preds),
+                    )
+                )
+                return _prediction_output(shape, dims, preds, False)
+
         if validate_features:
             if not hasattr(data, "shape"):
                 raise TypeError(
@@ -2144,18 +2332,25 @@ class Booster:
         else:
             raise TypeError("fname must be a string or os PathLike")
 
-    def save_raw(self) -> bytearray:
+    def save_raw(self, raw_format: str = "deprecated") -> bytearray:
         """Save the model to a in memory buffer representation instead of file.
 
+        Parameters
+        ----------
+        raw_format :
+            Format of output buffer. Can be `json`, `ubj` or `deprecated`.  `ubj` is a
+            binary encoding of the JSON model which is faster to save and load.
+
         Returns
         -------
         a in memory buffer representation of the model
         """
         length = c_bst_ulong()
         cptr = ctypes.POINTER(ctypes.c_char)()
-        _check_call(_LIB.XGBoosterGetModelRaw(self.handle,
-                                              ctypes.byref(length),
-                                              ctypes.byref(cptr)))
+        config = c_str(json.dumps({"format": raw_format}))
+        _check_call(_LIB.XGBoosterSaveModelToBuffer(self.handle, config,
+                                                    ctypes.byref(length),
+                                                    ctypes.byref(cptr)))
         return ctypes2buffer(cptr, length.value)
 
     def load_model(self, fname: Union[str, bytearray, os.PathLike]) -> None:
@@ -2197,6 +2392,44 @@ class Booster:
         if self.attr("best_ntree_limit") is not None:
             self.best_ntree_limit = int(self.attr("best_ntree_limit"))
 
+    def save_prediction_cache(self, dtrain: DMatrix, fname: Union[str, os.PathLike]) -> None:
+        """Save the prediction cache of the training data along with the model.  Training
+        can then be continued from the saved model by :py:meth:`load_prediction_cache`
+        without predicting the existing trees on the training data again.
+
+        .. versionadded:: 1.6.0
+
+        Parameters
+        ----------
+        dtrain :
+            The training data.
+        fname :
+            Output file name.
+
+        """
+        fname = os.fspath(os.path.expanduser(fname))
+        _check_call(_LIB.XGBoosterSavePredictionCache(self.handle, dtrain.handle,
+                                                      c_str(fname)))
+
+    def load_prediction_cache(self, dtrain: DMatrix, fname: Union[str, os.PathLike]) -> None:
+        """Restore the prediction cache saved by :py:meth:`save_prediction_cache`.  The
+        model must be loaded first, the cache is checked against the number of boosted rounds
+        and a fingerprint of the training data (shape, label, weight and base margin).
+
+        .. versionadded:: 1.6.0
+
+        Parameters
+        ----------
+        dtrain :
+            The training data.
+        fname :
+            Input file name.
+
+        """
+        fname = os.fspath(os.path.expanduser(fname))
+        _check_call(_LIB.XGBoosterLoadPredictionCache(self.handle, dtrain.handle,
+                                                      c_str(fname)))
+
     def num_boosted_rounds(self) -> int:
         '''Get number of boosted rounds.  For gblinear this is reset to 0 after
         serializing the model.
@@ -1,6 +1,7 @@
 # pylint: disable=too-many-arguments, too-many-branches, too-many-lines
 # pylint: disable=too-many-return-statements, import-error
 '''Data dispatching for DMatrix.'''
+import contextlib
 import ctypes
 import json
 import warnings
@@ -465,6 +466,89 @@ def _from_dt_df(
     return handle, feature_names, feature_types
 
 
+def _is_arrow(data) -> bool:
+    return lazy_isinstance(data, "pyarrow.lib", "Table") or lazy_isinstance(
+        data, "pyarrow.lib", "RecordBatch"
+    )
+
+
+def _arrow_to_batch(data):
+    """Convert arrow table to a single record batch."""
+    if lazy_isinstance(data, "pyarrow.lib", "RecordBatch"):
+        return data
+    batches = data.combine_chunks().to_batches()
+    if len(batches) != 1:
+        raise ValueError("Expecting a non-empty arrow table.")
+    return batches[0]
+
+
+@contextlib.contextmanager
+def _arrow_export(batch):
+    """Export arrow record batch through Arrow C data interface, the exported structs
+    are released when the context exits.
+
+    """
+    from pyarrow.cffi import ffi
+
+    c_schema = ffi.new("struct ArrowSchema*")
+    c_array = ffi.new("struct ArrowArray*")
+    ptr_schema = int(ffi.cast("uintptr_t", c_schema))
+    ptr_array = int(ffi.cast("uintptr_t", c_array))
+    batch._export_to_c(ptr_array, ptr_schema)  # pylint: disable=protected-access
+    try:
+        yield ctypes.c_void_p(ptr_array), ctypes.c_void_p(ptr_schema)
+    finally:
+        c_array.release(c_array)
+        c_schema.release(c_schema)
+
+
+def _arrow_feature_info(
+    batch,
+    feature_names: Optional[List[str]],
+    feature_types: Optional[List[str]],
+    enable_categorical: bool,
+) -> Tuple[Optional[List[str]], Optional[List[str]]]:
+    import pyarrow as pa
+
+    is_cat = [pa.types.is_dictionary(field.type) for field in batch.schema]
+    if any(is_cat) and not enable_categorical:
+        raise ValueError(
+            "Dictionary encoded arrow columns are supported only when categorical "
+            "feature is enabled."
+        )
+    if feature_names is None:
+        feature_names = batch.schema.names
+    if feature_types is None and any(is_cat):
+        feature_types = ["c" if c else "q" for c in is_cat]
+    return feature_names, feature_types
+
+
+def _from_arrow(
+    data,
+    missing,
+    nthread,
+    feature_names: Optional[List[str]],
+    feature_types: Optional[List[str]],
+    enable_categorical: bool,
+) -> Tuple[ctypes.c_void_p, Optional[List[str]], Optional[List[str]]]:
+    """Initialize data from arrow table or record batch without copying to numpy."""
+    batch = _arrow_to_batch(data)
+    feature_names, feature_types = _arrow_feature_info(
+        batch, feature_names, feature_types, enable_categorical
+    )
+    handle = ctypes.c_void_p()
+    args = {
+        "missing": float(missing),
+        "nthread": int(nthread),
+    }
+    config = bytes(json.dumps(args), "utf-8")
+    with _arrow_export(batch) as (array, schema):
+        _check_call(
+            _LIB.XGDMatrixCreateFromArrow(array, schema, config, ctypes.byref(handle))
+        )
+    return handle, feature_names, feature_types
+
+
 def _is_cudf_df(data):
     try:
         import cudf
@@ -817,6 +901,10 @@ def dispatch_data_backend(
         return _from_pandas_series(
             data, missing, threads, enable_categorical, feature_names, feature_types
         )
+    if _is_arrow(data):
+        return _from_arrow(
+            data, missing, threads, feature_names, feature_types, enable_categorical
+        )
     if _has_array_protocol(data):
         array = np.asarray(data)
         return _from_numpy_array(array, missing, threads, feature_names, feature_types)
@@ -9,11 +9,13 @@ import socket
 import struct
 import time
 import logging
+import queue
+from concurrent.futures import ThreadPoolExecutor
 from threading import Thread
 import argparse
 import sys
 
-from typing import Dict, List, Tuple, Union, Optional
+from typing import Dict, List, Tuple, Union, Optional, Set
 
 _RingMap = Dict[int, Tuple[int, int]]
 _TreeMap = Dict[int, List[int]]
@@ -65,6 +67,8 @@ def get_family(addr: str) -> int:
 
 class WorkerEntry:
     def __init__(self, sock: socket.socket, s_addr: Tuple[str, int]):
+        # The protocol exchanges many small messages, avoid delayed ACK stalls.
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
         worker = ExSocket(sock)
         self.sock = worker
         self.host = get_some_ip(s_addr[0])
@@ -77,6 +81,7 @@ class WorkerEntry:
         self.cmd = worker.recvstr()
         self.wait_accept = 0
         self.port: Optional[int] = None
+        self.neighbors: Set[int] = set()
 
     def decide_rank(self, job_map: Dict[str, int]) -> int:
         if self.rank >= 0:
@@ -93,6 +98,17 @@ class WorkerEntry:
         parent_map: Dict[int, int],
         ring_map: _RingMap,
     ) -> List[int]:
+        self.send_rank(rank, tree_map, parent_map, ring_map)
+        return self.connect_links(wait_conn)
+
+    def send_rank(
+        self,
+        rank: int,
+        tree_map: _TreeMap,
+        parent_map: Dict[int, int],
+        ring_map: _RingMap,
+    ) -> None:
+        """Send the rank and neighbors, after which the worker starts listening for links."""
         self.rank = rank
         nnset = set(tree_map[rank])
         rprev, rnext = ring_map[rank]
@@ -117,6 +133,12 @@ class WorkerEntry:
             self.sock.sendint(rnext)
         else:
             self.sock.sendint(-1)
+        self.neighbors = nnset
+
+    def connect_links(self, wait_conn: Dict[int, "WorkerEntry"]) -> List[int]:
+        """Tell the worker which neighbors in `wait_conn` to connect, the rest of neighbors
+        will connect to this worker later."""
+        nnset = self.neighbors
         while True:
             ngood = self.sock.recvint()
             goodset = set([])
@@ -163,6 +185,7 @@ class RabitTracker:
         port: int = 9091,
         port_end: int = 9999,
         use_logger: bool = False,
+        topology: Optional[Dict[str, str]] = None,
     ) -> None:
         """A Python implementation of RABIT tracker.
 
@@ -171,6 +194,11 @@ class RabitTracker:
         use_logger:
             Use logging.info for tracker print command.  When set to False, Python print
             function is used instead.
+        topology:
+            Mapping from worker host (IP address or host name) to a location label like
+            the rack name.  Workers are ranked by location then host, so the ring and
+            the tree cross between locations as few times as possible.  Hosts without a
+            label are treated as their own location.
 
         """
         sock = socket.socket(get_family(hostIP), socket.SOCK_STREAM)
@@ -183,12 +211,20 @@ class RabitTracker:
                 if e.errno in [98, 48]:
                     continue
                 raise
-        sock.listen(256)
+        # Workers of large jobs connect all at once.
+        sock.listen(max(256, n_workers))
         self.sock = sock
         self.hostIP = hostIP
         self.thread: Optional[Thread] = None
         self.n_workers = n_workers
         self._use_logger = use_logger
+        self._topology: Dict[str, str] = {}
+        for host, label in (topology or {}).items():
+            self._topology[get_some_ip(host)] = label
+        # host of each rank, for diagnostic.
+        self.hosts: Dict[int, str] = {}
+        # ring links of each rank as (prev, next), for diagnostic.
+        self.ring_map: _RingMap = {}
         logging.info('start listen on %s:%d', hostIP, self.port)
 
     def __del__(self) -> None:
@@ -206,6 +242,18 @@ class RabitTracker:
             ret.append(rank * 2)
         return ret
 
+    def location(self, host: str) -> str:
+        """Location label of a worker host."""
+        return self._topology.get(host, host)
+
+    def ring_crossings(self) -> int:
+        """Number of ring links between workers in different locations."""
+        return sum(
+            1 for r, (_, rnext) in self.ring_map.items()
+            if rnext != -1 and r in self.hosts and rnext in self.hosts and
+            self.location(self.hosts[r]) != self.location(self.hosts[rnext])
+        )
+
     def worker_envs(self) -> Dict[str, Union[str, int]]:
         """
         get environment variables for workers
@@ -285,6 +333,30 @@ class RabitTracker:
                 parent_map_[rmap[k]] = -1
         return tree_map_, parent_map_, ring_map_
 
+    def _handshake(
+        self, fd: socket.socket, s_addr: Tuple[str, int], entries: "queue.Queue[WorkerEntry]"
+    ) -> None:
+        try:
+            entries.put(WorkerEntry(fd, s_addr))
+        except Exception as e:  # pylint: disable=broad-except
+            logging.warning('Failed handshake with %s: %s', s_addr[0], e)
+            fd.close()
+
+    def _accept_entries(self, entries: "queue.Queue[WorkerEntry]", done: List[bool]) -> None:
+        """Accept connections and run the handshakes concurrently, so a slow worker doesn't
+        hold up the others."""
+        pool = ThreadPoolExecutor(max_workers=32)
+        self.sock.settimeout(1.0)
+        while not done[0]:
+            try:
+                fd, s_addr = self.sock.accept()
+            except socket.timeout:
+                continue
+            except OSError:
+                break
+            pool.submit(self._handshake, fd, s_addr, entries)
+        pool.shutdown(wait=False)
+
     def accept_workers(self, n_workers: int) -> None:
         # set of nodes that finishes the job
         shutdown: Dict[int, WorkerEntry] = {}
@@ -299,9 +371,13 @@ class RabitTracker:
 
         start_time = time.time()
 
+        entries: "queue.Queue[WorkerEntry]" = queue.Queue()
+        done = [False]
+        acceptor = Thread(target=self._accept_entries, args=(entries, done), daemon=True)
+        acceptor.start()
+
         while len(shutdown) != n_workers:
-            fd, s_addr = self.sock.accept()
-            s = WorkerEntry(fd, s_addr)
+            s = entries.get()
             if s.cmd == 'print':
                 msg = s.sock.recvstr()
                 # On dask we use print to avoid setting global verbosity.
@@ -323,6 +399,7 @@ class RabitTracker:
                 if s.world_size > 0:
                     n_workers = s.world_size
                 tree_map, parent_map, ring_map = self.get_link_map(n_workers)
+                self.ring_map = ring_map
                 # set of nodes that is pending for getting up
                 todo_nodes = list(range(n_workers))
             else:
@@ -336,23 +413,37 @@ class RabitTracker:
                 assert todo_nodes
                 pending.append(s)
                 if len(pending) == len(todo_nodes):
-                    pending.sort(key=lambda x: x.host)
+                    # Ranks follow the ring and subtrees of the tree take consecutive
+                    # ranks, grouping workers by location minimizes links across
+                    # locations.
+                    pending.sort(key=lambda x: (self.location(x.host), x.host))
+                    # Send all ranks first so workers set up their listeners in parallel,
+                    # leaving only the link exchange to be done one worker at a time.
                     for s in pending:
                         rank = todo_nodes.pop(0)
                         if s.jobid != 'NULL':
                             job_map[s.jobid] = rank
-                        s.assign_rank(rank, wait_conn, tree_map, parent_map, ring_map)
+                        s.send_rank(rank, tree_map, parent_map, ring_map)
+                    for s in pending:
+                        s.connect_links(wait_conn)
+                        self.hosts[s.rank] = s.host
                         if s.wait_accept > 0:
-                            wait_conn[rank] = s
+                            wait_conn[s.rank] = s
                         logging.debug('Received %s signal from %s; assign rank %d',
                                       s.cmd, s.host, s.rank)
                 if not todo_nodes:
                     logging.info('@tracker All of %d nodes getting started', n_workers)
+                    if self._topology:
+                        logging.info('@tracker %d ring links across locations',
+                                     self.ring_crossings())
             else:
                 s.assign_rank(rank, wait_conn, tree_map, parent_map, ring_map)
+                self.hosts[rank] = s.host
                 logging.debug('Received %s signal from %d', s.cmd, s.rank)
                 if s.wait_accept > 0:
                     wait_conn[rank] = s
+        done[0] = True
+        acceptor.join()
         logging.info('@tracker All nodes finishes job')
         end_time = time.time()
         logging.info(
@@ -408,8 +499,18 @@ def start_rabit_tracker(args: argparse.Namespace) -> None:
     args: arguments to start the rabit tracker.
     """
     envs = {"DMLC_NUM_WORKER": args.num_workers, "DMLC_NUM_SERVER": args.num_servers}
+    topology: Dict[str, str] = {}
+    if args.topology is not None:
+        with open(args.topology, "r", encoding="utf-8") as fd:
+            for line in fd:
+                fields = line.split()
+                if len(fields) == 2:
+                    topology[fields[0]] = fields[1]
     rabit = RabitTracker(
-        hostIP=get_host_ip(args.host_ip), n_workers=args.num_workers, use_logger=True
+        hostIP=get_host_ip(args.host_ip),
+        n_workers=args.num_workers,
+        use_logger=True,
+        topology=topology,
     )
     envs.update(rabit.worker_envs())
     rabit.start(args.num_workers)
@@ -434,6 +535,10 @@ def main() -> None:
     parser.add_argument('--host-ip', default=None, type=str,
                         help=('Host IP addressed, this is only needed ' +
                               'if the host IP cannot be automatically guessed.'))
+    parser.add_argument('--topology', default=None, type=str,
+                        help=('File with one "host label" pair per line, workers ' +
+                              'with the same label like a rack are placed next to ' +
+                              'each other in the ring.'))
     parser.add_argument('--log-level', default='INFO', type=str,
                         choices=['INFO', 'DEBUG'],
                         help='Logging level of the logger.')
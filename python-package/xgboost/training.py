@@ -288,9 +288,9 @@ def mkgroupfold(dall, nfold, param, evals=(), fpreproc=None, shuffle=True):
     ret = []
     for k in range(nfold):
         # perform the slicing using the indexes determined by the above methods
-        dtrain = dall.slice(in_idset[k], allow_groups=True)
+        dtrain = dall.slice(in_idset[k], allow_groups=True, view=True)
         dtrain.set_group(group_sizes[in_group_idset[k]])
-        dtest = dall.slice(out_idset[k], allow_groups=True)
+        dtest = dall.slice(out_idset[k], allow_groups=True, view=True)
         dtest.set_group(group_sizes[out_group_idset[k]])
         # run preprocessing on the data set if needed
         if fpreproc is not None:
@@ -344,8 +344,8 @@ def mknfold(dall, nfold, param, seed, evals=(), fpreproc=None, stratified=False,
     ret = []
     for k in range(nfold):
         # perform the slicing using the indexes determined by the above methods
-        dtrain = dall.slice(in_idset[k])
-        dtest = dall.slice(out_idset[k])
+        dtrain = dall.slice(in_idset[k], view=True)
+        dtest = dall.slice(out_idset[k], view=True)
         # run preprocessing on the data set if needed
         if fpreproc is not None:
             dtrain, dtest, tparam = fpreproc(dtrain, dtest, param.copy())
@@ -0,0 +1,281 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file rabit_bench.cc
+ * \brief Micro-benchmark for the collectives of the rabit engine.
+ *
+ *  Every worker runs the same sweep over message sizes, the slowest worker
+ *  defines the latency of each collective.  Parameters are passed as key=value
+ *  pairs along with the usual rabit parameters:
+ *
+ *    coll=allreduce,broadcast,allgather   collectives to run
+ *    dtype=float                          float, double, int or int64
+ *    op=sum                               sum, max, min or bitor (allreduce only)
+ *    algo=auto                            auto, tree or ring (allreduce only)
+ *    min_bytes=8 max_bytes=64MB factor=2  message sizes
+ *    warmup=5 iters=20                    iterations per message size
+ *    format=text                          text or json
+ *
+ *  Bus bandwidth follows the convention of nccl-tests, which normalises the
+ *  algorithm bandwidth by the amount of data each link has to carry so that
+ *  numbers are comparable across world sizes.
+ */
+#define _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_DEPRECATE
+#include <rabit/rabit.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+struct BenchParam {
+  std::vector<std::string> collectives {"allreduce", "broadcast", "allgather"};
+  std::string dtype {"float"};
+  std::string op {"sum"};
+  std::string algo {"auto"};
+  size_t min_bytes {8};
+  size_t max_bytes {64UL << 20};
+  size_t factor {2};
+  int warmup {5};
+  int iters {20};
+  std::string format {"text"};
+};
+
+struct Result {
+  std::string collective;
+  std::string algo;
+  size_t bytes;
+  size_t count;
+  double latency_us;
+  double algbw;
+  double busbw;
+};
+
+std::vector<std::string> Split(const std::string &str, char delim) {
+  std::vector<std::string> out;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, delim)) {
+    if (!item.empty()) {
+      out.push_back(item);
+    }
+  }
+  return out;
+}
+
+// parse size with optional B, KB, MB or GB suffix, same as rabit_reduce_buffer
+size_t ParseBytes(const char *val) {
+  char unit;
+  unsigned long amount;  // NOLINT(*)
+  int n = sscanf(val, "%lu%c", &amount, &unit);
+  size_t amt = amount;
+  if (n == 2) {
+    switch (unit) {
+      case 'B': return amt;
+      case 'K': return amt << 10UL;
+      case 'M': return amt << 20UL;
+      case 'G': return amt << 30UL;
+      default: rabit::utils::Error("invalid size format %s", val);
+    }
+  }
+  rabit::utils::Check(n == 1, "invalid size format %s", val);
+  return amt;
+}
+
+BenchParam ParseArgs(int argc, char *argv[]) {
+  BenchParam param;
+  char name[256], val[256];
+  for (int i = 1; i < argc; ++i) {
+    if (sscanf(argv[i], "%255[^=]=%255s", name, val) != 2) {
+      continue;
+    }
+    if (!strcmp(name, "coll")) param.collectives = Split(val, ',');
+    if (!strcmp(name, "dtype")) param.dtype = val;
+    if (!strcmp(name, "op")) param.op = val;
+    if (!strcmp(name, "algo")) param.algo = val;
+    if (!strcmp(name, "min_bytes")) param.min_bytes = ParseBytes(val);
+    if (!strcmp(name, "max_bytes")) param.max_bytes = ParseBytes(val);
+    if (!strcmp(name, "factor")) param.factor = atoi(val);
+    if (!strcmp(name, "warmup")) param.warmup = atoi(val);
+    if (!strcmp(name, "iters")) param.iters = atoi(val);
+    if (!strcmp(name, "format")) param.format = val;
+  }
+  rabit::utils::Check(param.algo == "auto" || param.algo == "tree" || param.algo == "ring",
+                      "algo must be one of auto, tree, ring");
+  rabit::utils::Check(param.format == "text" || param.format == "json",
+                      "format must be text or json");
+  rabit::utils::Check(param.factor > 1, "factor should be greater than 1");
+  rabit::utils::Check(param.iters > 0, "iters should be greater than 0");
+  rabit::utils::Check(param.min_bytes > 0 && param.min_bytes <= param.max_bytes,
+                      "invalid range of message size");
+  return param;
+}
+
+template <typename DType>
+class Bench {
+ public:
+  explicit Bench(BenchParam const &param) : param_{param} {}
+
+  void Run(std::vector<Result> *results) {
+    for (auto const &coll : param_.collectives) {
+      for (size_t bytes = param_.min_bytes; bytes <= param_.max_bytes; bytes *= param_.factor) {
+        size_t count = std::max(bytes / sizeof(DType), static_cast<size_t>(1));
+        results->push_back(this->RunOne(coll, count));
+      }
+    }
+  }
+
+ private:
+  void Allreduce(DType *data, size_t count) {
+    if (param_.op == "sum") {
+      rabit::Allreduce<rabit::op::Sum>(data, count);
+    } else if (param_.op == "max") {
+      rabit::Allreduce<rabit::op::Max>(data, count);
+    } else if (param_.op == "min") {
+      rabit::Allreduce<rabit::op::Min>(data, count);
+    } else if (param_.op == "bitor") {
+      this->BitOR(data, count);
+    } else {
+      rabit::utils::Error("unknown op %s", param_.op.c_str());
+    }
+  }
+  template <typename T = DType>
+  typename std::enable_if<std::is_integral<T>::value>::type BitOR(T *data, size_t count) {
+    rabit::Allreduce<rabit::op::BitOR>(data, count);
+  }
+  template <typename T = DType>
+  typename std::enable_if<!std::is_integral<T>::value>::type BitOR(T *, size_t) {
+    rabit::utils::Error("bitor requires an integral dtype");
+  }
+
+  Result RunOne(std::string const &coll, size_t count) {
+    int world = rabit::GetWorldSize();
+    int rank = rabit::GetRank();
+    // allgather needs equal slices, round the message up to a multiple of world size
+    if (coll == "allgather") {
+      count = (count + world - 1) / world * world;
+    }
+    std::vector<DType> buffer(count, static_cast<DType>(rank + 1));
+    size_t slice = count / world;
+    auto run = [&]() {
+      if (coll == "allreduce") {
+        this->Allreduce(buffer.data(), count);
+      } else if (coll == "broadcast") {
+        rabit::Broadcast(buffer.data(), count * sizeof(DType), 0);
+      } else if (coll == "allgather") {
+        rabit::Allgather(buffer.data(), count, rank * slice, slice, slice);
+      } else {
+        rabit::utils::Error("unknown collective %s", coll.c_str());
+      }
+    };
+    for (int i = 0; i < param_.warmup; ++i) {
+      run();
+    }
+    // line up all workers before timing.
+    int sync = 0;
+    rabit::Allreduce<rabit::op::Max>(&sync, 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < param_.iters; ++i) {
+      run();
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    rabit::Allreduce<rabit::op::Max>(&elapsed, 1);
+
+    Result res;
+    res.collective = coll;
+    if (coll == "allreduce") {
+      res.algo = param_.algo;
+    } else {
+      res.algo = coll == "broadcast" ? "tree" : "ring";
+    }
+    res.bytes = count * sizeof(DType);
+    res.count = count;
+    double seconds = elapsed / param_.iters;
+    res.latency_us = seconds * 1e6;
+    res.algbw = static_cast<double>(res.bytes) / seconds / 1e9;
+    double n = world;
+    double bus_factor = 1.0;
+    if (coll == "allreduce") {
+      bus_factor = 2.0 * (n - 1) / n;
+    } else if (coll == "allgather") {
+      bus_factor = (n - 1) / n;
+    }
+    res.busbw = res.algbw * bus_factor;
+    return res;
+  }
+
+  BenchParam param_;
+};
+
+void Print(BenchParam const &param, std::vector<Result> const &results) {
+  int world = rabit::GetWorldSize();
+  if (param.format == "json") {
+    printf("{\"world_size\": %d, \"dtype\": \"%s\", \"op\": \"%s\", \"iters\": %d, "
+           "\"results\": [",
+           world, param.dtype.c_str(), param.op.c_str(), param.iters);
+    for (size_t i = 0; i < results.size(); ++i) {
+      auto const &r = results[i];
+      printf("%s\n  {\"collective\": \"%s\", \"algo\": \"%s\", \"bytes\": %lu, "
+             "\"count\": %lu, \"latency_us\": %.3f, \"algbw_GBps\": %.6f, "
+             "\"busbw_GBps\": %.6f}",
+             i == 0 ? "" : ",", r.collective.c_str(), r.algo.c_str(),
+             static_cast<unsigned long>(r.bytes), static_cast<unsigned long>(r.count),  // NOLINT
+             r.latency_us, r.algbw, r.busbw);
+    }
+    printf("\n]}\n");
+  } else {
+    printf("# rabit_bench: world_size=%d dtype=%s op=%s iters=%d\n", world,
+           param.dtype.c_str(), param.op.c_str(), param.iters);
+    printf("%12s %6s %14s %14s %14s %14s\n", "collective", "algo", "bytes", "time(us)",
+           "algbw(GB/s)", "busbw(GB/s)");
+    for (auto const &r : results) {
+      printf("%12s %6s %14lu %14.2f %14.3f %14.3f\n", r.collective.c_str(), r.algo.c_str(),
+             static_cast<unsigned long>(r.bytes), r.latency_us, r.algbw, r.busbw);  // NOLINT
+    }
+  }
+  fflush(stdout);
+}
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  BenchParam param = ParseArgs(argc, argv);
+  // force the allreduce algorithm through the ring threshold of the engine.
+  std::vector<char *> args(argv, argv + argc);
+  std::string mincount;
+  if (param.algo == "tree") {
+    mincount = "rabit_reduce_ring_mincount=" + std::to_string(std::numeric_limits<int>::max());
+  } else if (param.algo == "ring") {
+    mincount = "rabit_reduce_ring_mincount=1";
+  }
+  if (!mincount.empty()) {
+    args.push_back(&mincount[0]);
+  }
+  rabit::Init(static_cast<int>(args.size()), args.data());
+
+  std::vector<Result> results;
+  if (param.dtype == "float") {
+    Bench<float>{param}.Run(&results);
+  } else if (param.dtype == "double") {
+    Bench<double>{param}.Run(&results);
+  } else if (param.dtype == "int") {
+    Bench<int32_t>{param}.Run(&results);
+  } else if (param.dtype == "int64") {
+    Bench<int64_t>{param}.Run(&results);
+  } else {
+    rabit::utils::Error("unknown dtype %s", param.dtype.c_str());
+  }
+  if (rabit::GetRank() == 0) {
+    Print(param, results);
+  }
+  rabit::Finalize();
+  return 0;
+}
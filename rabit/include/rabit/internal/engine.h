@@ -6,7 +6,10 @@
  */
 #ifndef RABIT_INTERNAL_ENGINE_H_
 #define RABIT_INTERNAL_ENGINE_H_
+#include <cstdint>
+#include <future>
 #include <string>
+#include <utility>
 #include "rabit/serializable.h"
 
 namespace MPI {  // NOLINT
@@ -79,6 +82,20 @@ class IEngine {
                          ReduceFunction reducer,
                          PreprocFunction prepare_fun = nullptr,
                          void *prepare_arg = nullptr) = 0;
+  /*!
+   * \brief performs in-place reduce-scatter, on sendrecvbuf
+   *  after the call, node k holds the reduction result of the k-th segment
+   *  [k * step, min((k + 1) * step, count)) where step = ceil(count / world_size),
+   *  content of other segments is unspecified.
+   * \param sendrecvbuf_ buffer for both sending and receiving data
+   * \param type_nbytes the number of bytes the type has
+   * \param count number of elements to be reduced
+   * \param reducer reduce function
+   */
+  virtual void ReduceScatter(void *sendrecvbuf_,
+                             size_t type_nbytes,
+                             size_t count,
+                             ReduceFunction reducer) = 0;
   /*!
    * \brief broadcasts data from root to every other node
    * \param sendrecvbuf_ buffer for both sending and receiving data
@@ -180,6 +197,8 @@ bool Init(int argc, char *argv[]);
 bool Finalize();
 /*! \brief singleton method to get engine */
 IEngine *GetEngine();
+/*! \brief total number of bytes passed to the reduction collectives by this process */
+uint64_t BytesReduced();
 
 /*! \brief namespace that contains stubs to be compatible with MPI */
 namespace mpi {
@@ -245,6 +264,67 @@ void Allreduce_(void *sendrecvbuf,  // NOLINT
                 mpi::OpType op,
                 IEngine::PreprocFunction prepare_fun = nullptr,
                 void *prepare_arg = nullptr);
+/*!
+ * \brief perform in-place reduce-scatter, on sendrecvbuf
+ *   this is an internal function used by rabit to be able to compile with MPI
+ *   do not use this function directly
+ * \param sendrecvbuf buffer for both sending and receiving data
+ * \param type_nbytes the number of bytes the type has
+ * \param count number of elements to be reduced
+ * \param reducer reduce function
+ * \param dtype the data type
+ * \param op the reduce operator type
+ * \sa IEngine::ReduceScatter
+ */
+void ReduceScatter_(void *sendrecvbuf,  // NOLINT
+                    size_t type_nbytes,
+                    size_t count,
+                    IEngine::ReduceFunction red,
+                    mpi::DataType dtype,
+                    mpi::OpType op);
+/*!
+ * \brief handle of a non-blocking collective operation, returned by IAllreduce_
+ */
+class Request {
+ public:
+  Request() = default;
+  explicit Request(std::shared_future<void> future) : future_{std::move(future)} {}
+  /*!
+   * \brief blocks until the operation finishes, errors raised by the operation are
+   *        rethrown here.  Waiting on a finished or empty request returns immediately.
+   */
+  void Wait() {
+    if (future_.valid()) {
+      future_.get();
+    }
+  }
+
+ private:
+  std::shared_future<void> future_;
+};
+/*!
+ * \brief starts a non-blocking in-place Allreduce on sendrecvbuf
+ *   this is an internal function used by rabit to be able to compile with MPI
+ *   do not use this function directly
+ *
+ *   Requests started by the same thread are performed in the order they are started,
+ *   by a communication thread so computation can overlap with them.  The buffer must be
+ *   kept alive and untouched until the request is waited, and no blocking collective
+ *   may be called while requests are pending.
+ * \param sendrecvbuf buffer for both sending and receiving data
+ * \param type_nbytes the number of bytes the type has
+ * \param count number of elements to be reduced
+ * \param reducer reduce function
+ * \param dtype the data type
+ * \param op the reduce operator type
+ * \return request used to wait for the result
+ */
+Request IAllreduce_(void *sendrecvbuf,  // NOLINT
+                    size_t type_nbytes,
+                    size_t count,
+                    IEngine::ReduceFunction red,
+                    mpi::DataType dtype,
+                    mpi::OpType op);
 /*!
  * \brief handle for customized reducer, used to handle customized reduce
  *  this class is mainly created for compatiblity issues with MPI's customized reduce
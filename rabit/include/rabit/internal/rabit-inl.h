@@ -165,6 +165,19 @@ inline void Allreduce(DType *sendrecvbuf, size_t count,
                      engine::mpi::GetType<DType>(), OP::kType, prepare_fun, prepare_arg);
 }
 
+// start a non-blocking Allreduce
+template<typename OP, typename DType>
+inline Request IAllreduce(DType *sendrecvbuf, size_t count) {
+  return engine::IAllreduce_(sendrecvbuf, sizeof(DType), count, op::Reducer<OP, DType>,
+                             engine::mpi::GetType<DType>(), OP::kType);
+}
+// perform inplace reduce-scatter
+template<typename OP, typename DType>
+inline void ReduceScatter(DType *sendrecvbuf, size_t count) {
+  engine::ReduceScatter_(sendrecvbuf, sizeof(DType), count, op::Reducer<OP, DType>,
+                         engine::mpi::GetType<DType>(), OP::kType);
+}
+
 // C++11 support for lambda prepare function
 #if DMLC_USE_CXX11
 inline void InvokeLambda(void *fun) {
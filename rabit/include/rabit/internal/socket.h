@@ -22,6 +22,7 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 
@@ -29,6 +30,10 @@
 #include <sys/sockio.h>
 #endif  // defined(__sun) || defined(sun)
 
+#if defined(RABIT_USE_RSOCKET)
+#include <rdma/rsocket.h>
+#endif  // defined(RABIT_USE_RSOCKET)
+
 #endif  // defined(_WIN32)
 
 #include <string>
@@ -99,8 +104,53 @@ namespace utils {
 
 static constexpr int kInvalidSocket = -1;
 
+/*!
+ * \brief transport carrying the stream of a socket
+ *  kRSocket uses rsockets from librdmacm, a socket compatible API over RDMA, so
+ *  the same code path runs over InfiniBand or RoCE without going through the kernel
+ *  TCP stack. Only available when built with RABIT_USE_RSOCKET.
+ */
+enum class Transport : int { kTCP = 0, kRSocket = 1 };
+
+/*! \brief whether the transport is available in this build */
+inline bool TransportSupported(Transport transport) {
+#if defined(RABIT_USE_RSOCKET)
+  return true;
+#else
+  return transport == Transport::kTCP;
+#endif  // defined(RABIT_USE_RSOCKET)
+}
+
+/*! \brief parse name of a transport, one of tcp and rsocket */
+inline Transport ParseTransport(const char *name) {
+  Transport transport = Transport::kTCP;
+  if (!strcmp(name, "tcp")) {
+    transport = Transport::kTCP;
+  } else if (!strcmp(name, "rsocket")) {
+    transport = Transport::kRSocket;
+  } else {
+    Error("unknown transport %s, should be one of tcp, rsocket", name);
+  }
+  Check(TransportSupported(transport),
+        "transport %s is not supported, build with RABIT_USE_RSOCKET=ON", name);
+  return transport;
+}
+
+/*!
+ * \brief call a socket function of the transport, rsockets prefix every function of
+ *  the socket API with `r`
+ */
+#if defined(RABIT_USE_RSOCKET)
+#define RABIT_SOCKET_CALL(transport, fn, ...)                                 \
+  ((transport) == ::rabit::utils::Transport::kRSocket ? r##fn(__VA_ARGS__)   \
+                                                      : fn(__VA_ARGS__))
+#else
+#define RABIT_SOCKET_CALL(transport, fn, ...) fn(__VA_ARGS__)
+#endif  // defined(RABIT_USE_RSOCKET)
+
 template <typename PollFD>
-int PollImpl(PollFD *pfd, int nfds, std::chrono::seconds timeout) {
+int PollImpl(PollFD *pfd, int nfds, std::chrono::seconds timeout,
+             Transport transport = Transport::kTCP) {
 #if defined(_WIN32)
 
 #if IS_MINGW()
@@ -111,7 +161,9 @@ int PollImpl(PollFD *pfd, int nfds, std::chrono::seconds timeout) {
 #endif  // IS_MINGW()
 
 #else
-  return poll(pfd, nfds, std::chrono::milliseconds(timeout).count());
+  // rpoll also handles normal file descriptors
+  return RABIT_SOCKET_CALL(transport, poll, pfd, nfds,
+                           std::chrono::milliseconds(timeout).count());
 #endif  // IS_MINGW()
 }
 
@@ -176,6 +228,8 @@ class Socket {
  public:
   /*! \brief the file descriptor of socket */
   SOCKET sockfd;
+  /*! \brief transport of the socket, set before Create */
+  Transport transport {Transport::kTCP};
   // default conversion to int
   operator SOCKET() const {  // NOLINT
     return sockfd;
@@ -248,7 +302,7 @@ class Socket {
     }
 #endif  // !IS_MINGW()
 #else
-    int flag = fcntl(sockfd, F_GETFL, 0);
+    int flag = RABIT_SOCKET_CALL(transport, fcntl, sockfd, F_GETFL, 0);
     if (flag == -1) {
       Socket::Error("SetNonBlock-1");
     }
@@ -257,7 +311,7 @@ class Socket {
     } else {
       flag &= ~O_NONBLOCK;
     }
-    if (fcntl(sockfd, F_SETFL, flag) == -1) {
+    if (RABIT_SOCKET_CALL(transport, fcntl, sockfd, F_SETFL, flag) == -1) {
       Socket::Error("SetNonBlock-2");
     }
 #endif  // _WIN32
@@ -268,8 +322,9 @@ class Socket {
    */
   inline void Bind(const SockAddr &addr) {
 #if !IS_MINGW()
-    if (bind(sockfd, reinterpret_cast<const sockaddr*>(&addr.addr),
-             sizeof(addr.addr)) == -1) {
+    if (RABIT_SOCKET_CALL(transport, bind, sockfd,
+                          reinterpret_cast<const sockaddr *>(&addr.addr),
+                          sizeof(addr.addr)) == -1) {
       Socket::Error("Bind");
     }
 #endif  // !IS_MINGW()
@@ -285,8 +340,9 @@ class Socket {
 #if !IS_MINGW()
     for (int port = start_port; port < end_port; ++port) {
       SockAddr addr("0.0.0.0", port);
-      if (bind(sockfd, reinterpret_cast<sockaddr*>(&addr.addr),
-               sizeof(addr.addr)) == 0) {
+      if (RABIT_SOCKET_CALL(transport, bind, sockfd,
+                            reinterpret_cast<sockaddr *>(&addr.addr),
+                            sizeof(addr.addr)) == 0) {
         return port;
       }
 #if defined(_WIN32)
@@ -307,8 +363,8 @@ class Socket {
     int error = 0;
     socklen_t len = sizeof(error);
 #if !IS_MINGW()
-    if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR,
-                   reinterpret_cast<char *>(&error), &len) != 0) {
+    if (RABIT_SOCKET_CALL(transport, getsockopt, sockfd, SOL_SOCKET, SO_ERROR,
+                          reinterpret_cast<char *>(&error), &len) != 0) {
       Error("GetSockError");
     }
 #else
@@ -336,7 +392,7 @@ class Socket {
       closesocket(sockfd);
 #endif  // !IS_MINGW()
 #else
-      close(sockfd);
+      RABIT_SOCKET_CALL(transport, close, sockfd);
 #endif
       sockfd = kInvalidSocket;
     } else {
@@ -354,7 +410,8 @@ class Socket {
   }
 
  protected:
-  explicit Socket(SOCKET sockfd) : sockfd(sockfd) {
+  explicit Socket(SOCKET sockfd, Transport transport = Transport::kTCP)
+      : sockfd(sockfd), transport(transport) {
   }
 };
 
@@ -366,7 +423,8 @@ class TCPSocket : public Socket{
   // constructor
   TCPSocket() : Socket(kInvalidSocket) {
   }
-  explicit TCPSocket(SOCKET sockfd) : Socket(sockfd) {
+  explicit TCPSocket(SOCKET sockfd, Transport transport = Transport::kTCP)
+      : Socket(sockfd, transport) {
   }
   /*!
    * \brief enable/disable TCP keepalive
@@ -375,18 +433,34 @@ class TCPSocket : public Socket{
   void SetKeepAlive(bool keepalive) {
 #if !IS_MINGW()
     int opt = static_cast<int>(keepalive);
-    if (setsockopt(sockfd, SOL_SOCKET, SO_KEEPALIVE,
-                   reinterpret_cast<char*>(&opt), sizeof(opt)) < 0) {
+    if (RABIT_SOCKET_CALL(transport, setsockopt, sockfd, SOL_SOCKET, SO_KEEPALIVE,
+                          reinterpret_cast<char *>(&opt), sizeof(opt)) < 0) {
       Socket::Error("SetKeepAlive");
     }
 #endif  // !IS_MINGW()
+  }
+  /*!
+   * \brief enable/disable Nagle's algorithm
+   * \param no_delay whether to send small segments without delay
+   */
+  void SetNoDelay(bool no_delay) {
+#if defined(__unix__)
+    int opt = static_cast<int>(no_delay);
+    if (RABIT_SOCKET_CALL(transport, setsockopt, sockfd, IPPROTO_TCP, TCP_NODELAY,
+                          reinterpret_cast<char *>(&opt), sizeof(opt)) < 0) {
+      Socket::Error("SetNoDelay");
+    }
+#else
+    LOG(WARNING) << "tcp no delay is not implemented on non unix platforms";
+#endif  // defined(__unix__)
   }
   inline void SetLinger(int timeout = 0) {
 #if !IS_MINGW()
     struct linger sl;
     sl.l_onoff = 1;    /* non-zero value enables linger option in kernel */
     sl.l_linger = timeout;    /* timeout interval in seconds */
-    if (setsockopt(sockfd, SOL_SOCKET, SO_LINGER, reinterpret_cast<char*>(&sl), sizeof(sl)) == -1) {
+    if (RABIT_SOCKET_CALL(transport, setsockopt, sockfd, SOL_SOCKET, SO_LINGER,
+                          reinterpret_cast<char *>(&sl), sizeof(sl)) == -1) {
       Socket::Error("SO_LINGER");
     }
 #endif  // !IS_MINGW()
@@ -397,29 +471,37 @@ class TCPSocket : public Socket{
    */
   inline void Create(int af = PF_INET) {
 #if !IS_MINGW()
-    sockfd = socket(PF_INET, SOCK_STREAM, 0);
+    sockfd = RABIT_SOCKET_CALL(transport, socket, PF_INET, SOCK_STREAM, 0);
     if (sockfd == kInvalidSocket) {
       Socket::Error("Create");
     }
 #endif  // !IS_MINGW()
   }
+  /*!
+   * \brief create the socket over a transport
+   * \param transport transport of the socket
+   */
+  inline void Create(Transport transport) {
+    this->transport = transport;
+    this->Create();
+  }
   /*!
    * \brief perform listen of the socket
    * \param backlog backlog parameter
    */
   inline void Listen(int backlog = 16) {
 #if !IS_MINGW()
-    listen(sockfd, backlog);
+    RABIT_SOCKET_CALL(transport, listen, sockfd, backlog);
 #endif  // !IS_MINGW()
   }
   /*! \brief get a new connection */
   TCPSocket Accept() {
 #if !IS_MINGW()
-    SOCKET newfd = accept(sockfd, nullptr, nullptr);
+    SOCKET newfd = RABIT_SOCKET_CALL(transport, accept, sockfd, nullptr, nullptr);
     if (newfd == kInvalidSocket) {
       Socket::Error("Accept");
     }
-    return TCPSocket(newfd);
+    return TCPSocket(newfd, transport);
 #else
     return TCPSocket();
 #endif // !IS_MINGW()
@@ -436,6 +518,8 @@ class TCPSocket : public Socket{
     if (ioctlsocket(sockfd, SIOCATMARK, &atmark) != NO_ERROR) return -1;
 #else
     int atmark;
+    // out of band data is not supported by rsockets
+    if (transport != Transport::kTCP) return -1;
     if (ioctl(sockfd, SIOCATMARK, &atmark) == -1) return -1;
 #endif  // _WIN32
 
@@ -452,8 +536,9 @@ class TCPSocket : public Socket{
    */
   inline bool Connect(const SockAddr &addr) {
 #if !IS_MINGW()
-    return connect(sockfd, reinterpret_cast<const sockaddr*>(&addr.addr),
-                   sizeof(addr.addr)) == 0;
+    return RABIT_SOCKET_CALL(transport, connect, sockfd,
+                             reinterpret_cast<const sockaddr *>(&addr.addr),
+                             sizeof(addr.addr)) == 0;
 #else
     return false;
 #endif  // !IS_MINGW()
@@ -469,7 +554,7 @@ class TCPSocket : public Socket{
   inline ssize_t Send(const void *buf_, size_t len, int flag = 0) {
     const char *buf = reinterpret_cast<const char*>(buf_);
 #if !IS_MINGW()
-    return send(sockfd, buf, static_cast<sock_size_t>(len), flag);
+    return RABIT_SOCKET_CALL(transport, send, sockfd, buf, static_cast<sock_size_t>(len), flag);
 #else
     return 0;
 #endif  // !IS_MINGW()
@@ -485,7 +570,7 @@ class TCPSocket : public Socket{
   inline ssize_t Recv(void *buf_, size_t len, int flags = 0) {
     char *buf = reinterpret_cast<char*>(buf_);
 #if !IS_MINGW()
-    return recv(sockfd, buf, static_cast<sock_size_t>(len), flags);
+    return RABIT_SOCKET_CALL(transport, recv, sockfd, buf, static_cast<sock_size_t>(len), flags);
 #else
     return 0;
 #endif  // !IS_MINGW()
@@ -502,7 +587,8 @@ class TCPSocket : public Socket{
     size_t ndone = 0;
 #if !IS_MINGW()
     while (ndone <  len) {
-      ssize_t ret = send(sockfd, buf, static_cast<ssize_t>(len - ndone), 0);
+      ssize_t ret = RABIT_SOCKET_CALL(transport, send, sockfd, buf,
+                                      static_cast<ssize_t>(len - ndone), 0);
       if (ret == -1) {
         if (LastErrorWouldBlock()) return ndone;
         Socket::Error("SendAll");
@@ -525,8 +611,8 @@ class TCPSocket : public Socket{
     size_t ndone = 0;
 #if !IS_MINGW()
     while (ndone <  len) {
-      ssize_t ret = recv(sockfd, buf,
-                         static_cast<sock_size_t>(len - ndone), MSG_WAITALL);
+      ssize_t ret = RABIT_SOCKET_CALL(transport, recv, sockfd, buf,
+                                      static_cast<sock_size_t>(len - ndone), MSG_WAITALL);
       if (ret == -1) {
         if (LastErrorWouldBlock()) return ndone;
         Socket::Error("RecvAll");
@@ -597,6 +683,21 @@ struct PollHelper {
     pfd.fd = fd;
     pfd.events |= POLLPRI;
   }
+  /*! \brief add socket to watch for read, sockets may use a transport other than TCP */
+  inline void WatchRead(const Socket &sock) {
+    this->Track(sock);
+    this->WatchRead(sock.sockfd);
+  }
+  /*! \brief add socket to watch for write */
+  inline void WatchWrite(const Socket &sock) {
+    this->Track(sock);
+    this->WatchWrite(sock.sockfd);
+  }
+  /*! \brief add socket to watch for exception */
+  inline void WatchException(const Socket &sock) {
+    this->Track(sock);
+    this->WatchException(sock.sockfd);
+  }
   /*!
    * \brief Check if the descriptor is ready for read
    * \param fd file descriptor to check status
@@ -625,7 +726,7 @@ struct PollHelper {
     for (auto kv : fds) {
       fdset.push_back(kv.second);
     }
-    int ret = PollImpl(fdset.data(), fdset.size(), timeout);
+    int ret = PollImpl(fdset.data(), fdset.size(), timeout, transport);
     if (ret == 0) {
       LOG(FATAL) << "Poll timeout";
     } else if (ret < 0) {
@@ -643,6 +744,15 @@ struct PollHelper {
   }
 
   std::unordered_map<SOCKET, pollfd> fds;
+  // poll with rsockets once any of the sockets is an rsocket
+  Transport transport {Transport::kTCP};
+
+ private:
+  inline void Track(const Socket &sock) {
+    if (sock.transport != Transport::kTCP) {
+      transport = sock.transport;
+    }
+  }
 };
 }  // namespace utils
 }  // namespace rabit
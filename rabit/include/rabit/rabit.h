@@ -154,6 +154,50 @@ template<typename OP, typename DType>
 inline void Allreduce(DType *sendrecvbuf, size_t count,
                       void (*prepare_fun)(void *) = nullptr,
                       void *prepare_arg = nullptr);
+/*! \brief handle of a non-blocking collective operation */
+using Request = engine::Request;
+/*!
+ * \brief starts a non-blocking in-place Allreduce on sendrecvbuf
+ *        this function is NOT thread-safe
+ *
+ *   The reduction is performed in background so the caller can continue with other
+ *   computation.  Requests are performed in the order they are started, the buffer must
+ *   be kept alive and untouched until the returned request is waited, and no other
+ *   collective operation may be called while requests are pending.
+ *
+ * Example Usage: overlap the reduction of two buffers with computation
+ * \code{.cpp}
+ * auto first = IAllreduce<op::Sum>(&a[0], a.size());
+ * ComputeB(&b);
+ * auto second = IAllreduce<op::Sum>(&b[0], b.size());
+ * first.Wait();
+ * second.Wait();
+ * \endcode
+ *
+ * \param sendrecvbuf buffer for both sending and receiving data
+ * \param count number of elements to be reduced
+ * \tparam OP see namespace op, reduce operator
+ * \tparam DType data type
+ * \return request used to wait for the result
+ */
+template<typename OP, typename DType>
+inline Request IAllreduce(DType *sendrecvbuf, size_t count);
+/*!
+ * \brief performs in-place reduce-scatter on sendrecvbuf
+ *        this function is NOT thread-safe
+ *
+ *   After the call, the k-th worker holds the reduction result of the k-th segment
+ *   [k * step, min((k + 1) * step, count)) where step = ceil(count / world_size), other
+ *   segments are left unspecified.  Each worker receives 1 / world_size of the data
+ *   an Allreduce would deliver.
+ *
+ * \param sendrecvbuf buffer for both sending and receiving data
+ * \param count number of elements to be reduced
+ * \tparam OP see namespace op, reduce operator
+ * \tparam DType data type
+ */
+template<typename OP, typename DType>
+inline void ReduceScatter(DType *sendrecvbuf, size_t count);
 
 /*!
 * \brief Allgather function, each node have a segment of data in the ring of sendrecvbuf,
@@ -12,13 +12,37 @@
 
 #ifndef _WIN32
 #include <netinet/tcp.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #endif  // _WIN32
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 #include <map>
+#include <new>
+#include <random>
+#include <thread>
 
 namespace rabit {
 namespace engine {
+namespace {
+/*!
+ * \brief Time to wait before the next retry of connecting.  Waits grow exponentially and are
+ *        randomized so that thousands of workers failing together don't retry together.
+ */
+std::chrono::milliseconds RetryBackoff(int retry, int64_t base_ms) {
+  static thread_local std::mt19937 rng{std::random_device{}()};
+  int64_t constexpr kMaxMs = 30000;
+  int64_t wait = std::min(base_ms << std::min(retry - 1, 5), kMaxMs);
+  std::uniform_int_distribution<int64_t> dist(wait / 2, wait);
+  return std::chrono::milliseconds(dist(rng));
+}
+}  // anonymous namespace
+
 // constructor
 AllreduceBase::AllreduceBase() {
   tracker_uri = "NULL";
@@ -35,6 +59,9 @@ AllreduceBase::AllreduceBase() {
   reduce_ring_mincount = 32 << 10;
   // 1M reducer size each time
   tree_reduce_minsize = 1 << 20;
+  // 256K per broadcast step, 4M to switch to the ring
+  broadcast_chunk_size = 256 << 10;
+  broadcast_ring_minsize = 4 << 20;
   // tracker URL
   task_id = "NULL";
   err_link = nullptr;
@@ -115,11 +142,19 @@ bool AllreduceBase::Init(int argc, char* argv[]) {
   utils::Assert(all_links.size() == 0, "can only call Init once");
   this->host_uri = utils::SockAddr::GetHostName();
   // get information from tracker
-  return this->ReConnectLinks();
+  if (!this->ReConnectLinks()) {
+    return false;
+  }
+  if (rabit_shm_allreduce && world_size > 1) {
+    return this->InitHierarchy();
+  }
+  return true;
 }
 
 bool AllreduceBase::Shutdown() {
   try {
+    this->WaitCheckPoint();
+    this->ShutdownHierarchy();
     for (auto & all_link : all_links) {
       if (!all_link.sock.IsClosed()) {
         all_link.sock.Close();
@@ -196,6 +231,13 @@ void AllreduceBase::SetParam(const char *name, const char *val) {
   if (!strcmp(name, "rabit_reduce_buffer")) {
     reduce_buffer_size = (ParseUnit(name, val) + 7) >> 3;
   }
+  if (!strcmp(name, "rabit_broadcast_chunk")) {
+    broadcast_chunk_size = ParseUnit(name, val);
+    utils::Assert(broadcast_chunk_size > 0, "rabit_broadcast_chunk should be greater than 0");
+  }
+  if (!strcmp(name, "rabit_broadcast_ring_minsize")) {
+    broadcast_ring_minsize = ParseUnit(name, val);
+  }
   if (!strcmp(name, "DMLC_WORKER_CONNECT_RETRY")) {
     connect_retry = atoi(val);
   }
@@ -212,6 +254,24 @@ void AllreduceBase::SetParam(const char *name, const char *val) {
     timeout_sec = std::chrono::seconds(atoi(val));
     utils::Assert(timeout_sec.count() >= 0, "rabit_timeout_sec should be non negative second");
   }
+  if (!strcmp(name, "rabit_checkpoint_path")) {
+    checkpoint_path = val;
+  }
+  if (!strcmp(name, "rabit_checkpoint_interval")) {
+    checkpoint_interval = atoi(val);
+    utils::Assert(checkpoint_interval > 0, "rabit_checkpoint_interval should be greater than 0");
+  }
+  if (!strcmp(name, "rabit_shm_allreduce")) {
+    rabit_shm_allreduce = utils::StringToBool(val);
+  }
+  if (!strcmp(name, "rabit_shm_buffer")) {
+    // keep slots aligned to cache lines
+    shm_slot_size = (ParseUnit(name, val) + 63) / 64 * 64;
+    utils::Assert(shm_slot_size > 0, "rabit_shm_buffer should be greater than 0");
+  }
+  if (!strcmp(name, "rabit_transport")) {
+    link_transport = utils::ParseTransport(val);
+  }
   if (!strcmp(name, "rabit_enable_tcp_no_delay")) {
     if (!strcmp(val, "true")) {
       rabit_enable_tcp_no_delay = true;
@@ -238,16 +298,16 @@ utils::TCPSocket AllreduceBase::ConnectTracker() const {
         utils::Socket::Error("Connect");
       } else {
         LOG(WARNING) << "Retry connect to ip(retry time " << retry << "): [" << tracker_uri << "]\n";
-#if defined(_MSC_VER) || defined (__MINGW32__)
-        Sleep(retry << 1);
-#else
-        sleep(retry << 1);
-#endif
+        std::this_thread::sleep_for(RetryBackoff(retry, 1000));
         continue;
       }
     }
     break;
   } while (true);
+#if defined(__unix__)
+  // The protocol exchanges many small messages, avoid delayed ACK stalls.
+  tracker.SetNoDelay(true);
+#endif  // defined(__unix__)
 
   using utils::Assert;
   Assert(tracker.SendAll(&magic, sizeof(magic)) == sizeof(magic),
@@ -262,6 +322,28 @@ utils::TCPSocket AllreduceBase::ConnectTracker() const {
   tracker.SendStr(task_id);
   return tracker;
 }
+bool AllreduceBase::ConnectPeer(PeerAddr const &peer, LinkRecord *p_link) const {
+  // Peers are listening before the tracker hands out their addresses, failures are
+  // transient and the tracker is waiting on this worker, so retries are short.
+  int constexpr kPeerRetry = 3;
+  for (int retry = 0; retry < kPeerRetry; ++retry) {
+    if (retry != 0) {
+      std::this_thread::sleep_for(RetryBackoff(retry, 50));
+    }
+    p_link->sock.Create(link_transport);
+    if (!p_link->sock.Connect(utils::SockAddr(peer.host.c_str(), peer.port))) {
+      p_link->sock.Close();
+      continue;
+    }
+    if (p_link->sock.SendAll(&rank, sizeof(rank)) != sizeof(rank) ||
+        p_link->sock.RecvAll(&p_link->rank, sizeof(p_link->rank)) != sizeof(p_link->rank)) {
+      p_link->sock.Close();
+      continue;
+    }
+    return true;
+  }
+  return false;
+}
 /*!
  * \brief connect to the tracker to fix the the missing links
  *   this function is also used when the engine start up
@@ -316,8 +398,8 @@ bool AllreduceBase::ReConnectLinks(const char *cmd) {
     if (!sock_listen.IsClosed()) {
       sock_listen.Close();
     }
-    // create listening socket
-    sock_listen.Create();
+    // create listening socket, links between workers use the configured transport
+    sock_listen.Create(link_transport);
     int port = sock_listen.TryBindHost(slave_port, slave_port + nport_trial);
     utils::Check(port != -1, "ReConnectLink fail to bind the ports specified");
     sock_listen.Listen();
@@ -346,26 +428,38 @@ bool AllreduceBase::ReConnectLinks(const char *cmd) {
       Assert(tracker.RecvAll(&num_accept, sizeof(num_accept)) == \
            sizeof(num_accept), "ReConnectLink failure 8");
       num_error = 0;
-      for (int i = 0; i < num_conn; ++i) {
-        LinkRecord r;
-        int hport, hrank;
-        std::string hname;
-        tracker.RecvStr(&hname);
-        Assert(tracker.RecvAll(&hport, sizeof(hport)) == sizeof(hport),
+      std::vector<PeerAddr> peers(num_conn);
+      for (auto &peer : peers) {
+        tracker.RecvStr(&peer.host);
+        Assert(tracker.RecvAll(&peer.port, sizeof(peer.port)) == sizeof(peer.port),
                "ReConnectLink failure 9");
-        Assert(tracker.RecvAll(&hrank, sizeof(hrank)) == sizeof(hrank),
+        Assert(tracker.RecvAll(&peer.rank, sizeof(peer.rank)) == sizeof(peer.rank),
                "ReConnectLink failure 10");
-
-        r.sock.Create();
-        if (!r.sock.Connect(utils::SockAddr(hname.c_str(), hport))) {
+      }
+      // Peers are connected concurrently, each retrying with backoff on its own so that a
+      // slow peer doesn't fail the whole round with the tracker.
+      std::vector<LinkRecord> links(peers.size());
+      std::vector<int> connected(peers.size(), 0);
+      std::vector<std::thread> connectors;
+      for (size_t i = 0; i < peers.size(); ++i) {
+        connectors.emplace_back([&, i] {
+          try {
+            connected[i] = this->ConnectPeer(peers[i], &links[i]);
+          } catch (std::exception const &e) {
+            LOG(WARNING) << "Failed to connect to rank " << peers[i].rank << ": " << e.what();
+          }
+        });
+      }
+      for (auto &t : connectors) {
+        t.join();
+      }
+      for (size_t i = 0; i < peers.size(); ++i) {
+        LinkRecord &r = links[i];
+        int hrank = peers[i].rank;
+        if (!connected[i]) {
           num_error += 1;
-          r.sock.Close();
           continue;
         }
-        Assert(r.sock.SendAll(&rank, sizeof(rank)) == sizeof(rank),
-               "ReConnectLink failure 12");
-        Assert(r.sock.RecvAll(&r.rank, sizeof(r.rank)) == sizeof(r.rank),
-               "ReConnectLink failure 13");
         utils::Check(hrank == r.rank,
                      "ReConnectLink failure, link rank inconsistent");
         bool match = false;
@@ -412,19 +506,13 @@ bool AllreduceBase::ReConnectLinks(const char *cmd) {
     this->parent_index = -1;
     // setup tree links and ring structure
     tree_links.plinks.clear();
-    int tcpNoDelay = 1;
-    for (auto & all_link : all_links) {
+      for (auto & all_link : all_links) {
       utils::Assert(!all_link.sock.BadSocket(), "ReConnectLink: bad socket");
       // set the socket to non-blocking mode, enable TCP keepalive
       all_link.sock.SetNonBlock(true);
       all_link.sock.SetKeepAlive(true);
       if (rabit_enable_tcp_no_delay) {
-#if defined(__unix__)
-        setsockopt(all_link.sock, IPPROTO_TCP,
-                   TCP_NODELAY, reinterpret_cast<void *>(&tcpNoDelay), sizeof(tcpNoDelay));
-#else
-        LOG(WARNING) << "tcp no delay is not implemented on non unix platforms";
-#endif
+        all_link.sock.SetNoDelay(true);
       }
       if (tree_neighbors.count(all_link.rank) != 0) {
         if (all_link.rank == parent_rank) {
@@ -467,6 +555,9 @@ AllreduceBase::TryAllreduce(void *sendrecvbuf_,
                             size_t type_nbytes,
                             size_t count,
                             ReduceFunction reducer) {
+  if (hierarchical) {
+    return this->TryAllreduceHierarchical(sendrecvbuf_, type_nbytes, count, reducer);
+  }
   if (count > reduce_ring_mincount) {
     return this->TryAllreduceRing(sendrecvbuf_, type_nbytes, count, reducer);
   } else {
@@ -673,6 +764,8 @@ AllreduceBase::TryAllreduceTree(void *sendrecvbuf_,
 }
 /*!
  * \brief broadcast data from root to all nodes, this function can fail,and will return the cause of failure
+ *  data is forwarded in chunks of at most broadcast_chunk_size bytes, so a node starts
+ *  sending to its children before it has received the whole buffer
  * \param sendrecvbuf_ buffer for both sending and receiving data
  * \param total_size the size of the data to be broadcasted
  * \param root the root worker id to broadcast the data
@@ -685,6 +778,9 @@ AllreduceBase::TryBroadcast(void *sendrecvbuf_, size_t total_size, int root) {
   if (links.Size() == 0 || total_size == 0) return kSuccess;
   utils::Check(root < world_size,
                "Broadcast: root should be smaller than world size");
+  if (total_size >= broadcast_ring_minsize && world_size > 2) {
+    return this->TryBroadcastRing(sendrecvbuf_, total_size, root);
+  }
   // number of links
   const int nlink = static_cast<int>(links.Size());
   // size of space already read from data
@@ -729,7 +825,8 @@ AllreduceBase::TryBroadcast(void *sendrecvbuf_, size_t total_size, int root) {
       // probe in-link
       for (int i = 0; i < nlink; ++i) {
         if (watcher.CheckRead(links[i].sock)) {
-          ReturnType ret = links[i].ReadToArray(sendrecvbuf_, total_size);
+          ReturnType ret = links[i].ReadToArray(
+              sendrecvbuf_, std::min(total_size, broadcast_chunk_size));
           if (ret != kSuccess) {
             return ReportError(&links[i], ret);
           }
@@ -742,7 +839,8 @@ AllreduceBase::TryBroadcast(void *sendrecvbuf_, size_t total_size, int root) {
     } else {
       // read from in link
       if (in_link >= 0 && watcher.CheckRead(links[in_link].sock)) {
-        ReturnType ret = links[in_link].ReadToArray(sendrecvbuf_, total_size);
+        ReturnType ret = links[in_link].ReadToArray(
+            sendrecvbuf_, std::min(total_size, size_in + broadcast_chunk_size));
         if (ret != kSuccess) {
           return ReportError(&links[in_link], ret);
         }
@@ -752,7 +850,8 @@ AllreduceBase::TryBroadcast(void *sendrecvbuf_, size_t total_size, int root) {
     // send data to all out-link
     for (int i = 0; i < nlink; ++i) {
       if (i != in_link && links[i].size_write < size_in) {
-        ReturnType ret = links[i].WriteFromArray(sendrecvbuf_, size_in);
+        ReturnType ret = links[i].WriteFromArray(
+            sendrecvbuf_, std::min(size_in, links[i].size_write + broadcast_chunk_size));
         if (ret != kSuccess) {
           return ReportError(&links[i], ret);
         }
@@ -761,6 +860,78 @@ AllreduceBase::TryBroadcast(void *sendrecvbuf_, size_t total_size, int root) {
   }
   return kSuccess;
 }
+/*!
+ * \brief broadcast data from root along the ring, each node forwards every chunk to
+ *  the next node as soon as it is received, so the latency is about
+ *  total_size / bandwidth + world_size * chunk_size / bandwidth, and every node sends
+ *  the buffer exactly once regardless of the fan-out of the tree
+ * \param sendrecvbuf_ buffer for both sending and receiving data
+ * \param total_size the size of the data to be broadcasted
+ * \param root the root worker id to broadcast the data
+ * \return this function can return kSuccess, kSockError, kGetExcept, see ReturnType for details
+ * \sa ReturnType
+ */
+AllreduceBase::ReturnType
+AllreduceBase::TryBroadcastRing(void *sendrecvbuf_, size_t total_size, int root) {
+  LinkRecord &prev = *ring_prev, &next = *ring_next;
+  // need to reply on special rank structure
+  utils::Assert(next.rank == (rank + 1) % world_size &&
+                rank == (prev.rank + 1) % world_size,
+                "need to assume rank structure");
+  char *sendrecvbuf = reinterpret_cast<char*>(sendrecvbuf_);
+  // the root has all the data, the node before the root has nothing to forward
+  size_t read_ptr = rank == root ? total_size : 0;
+  const size_t stop_write = next.rank == root ? 0 : total_size;
+  size_t write_ptr = 0;
+
+  while (true) {
+    bool finished = true;
+    utils::PollHelper watcher;
+    if (read_ptr != total_size) {
+      watcher.WatchRead(prev.sock);
+      watcher.WatchException(prev.sock);
+      finished = false;
+    }
+    if (write_ptr != stop_write) {
+      if (write_ptr < read_ptr) {
+        watcher.WatchWrite(next.sock);
+      }
+      watcher.WatchException(next.sock);
+      finished = false;
+    }
+    if (finished) break;
+    watcher.Poll(timeout_sec);
+    if (read_ptr != total_size && watcher.CheckRead(prev.sock)) {
+      size_t size = std::min(total_size - read_ptr, broadcast_chunk_size);
+      ssize_t len = prev.sock.Recv(sendrecvbuf + read_ptr, size);
+      if (len == 0) {
+        prev.sock.Close();
+        return ReportError(&prev, kRecvZeroLen);
+      }
+      if (len != -1) {
+        read_ptr += static_cast<size_t>(len);
+      } else {
+        ReturnType ret = Errno2Return();
+        if (ret != kSuccess) {
+          return ReportError(&prev, ret);
+        }
+      }
+    }
+    if (write_ptr < read_ptr && write_ptr != stop_write) {
+      size_t size = std::min(read_ptr - write_ptr, broadcast_chunk_size);
+      ssize_t len = next.sock.Send(sendrecvbuf + write_ptr, size);
+      if (len != -1) {
+        write_ptr += static_cast<size_t>(len);
+      } else {
+        ReturnType ret = Errno2Return();
+        if (ret != kSuccess) {
+          return ReportError(&next, ret);
+        }
+      }
+    }
+  }
+  return kSuccess;
+}
 /*!
  * \brief internal Allgather function, each node have a segment of data in the ring of sendrecvbuf,
  *  the data provided by current node k is [slice_begin, slice_end),
@@ -979,5 +1150,320 @@ AllreduceBase::TryAllreduceRing(void *sendrecvbuf_,
        (std::min((prank + 1) * step, count) -
         std::min(prank * step, count)) * type_nbytes);
 }
+
+void AllreduceBase::WaitCheckPoint() {
+  if (checkpoint_writer.valid()) {
+    checkpoint_writer.get();
+  }
+}
+
+void AllreduceBase::SaveLocalCheckPoint(const Serializable *global_model) {
+  if (checkpoint_path.empty() || global_model == nullptr ||
+      version_number % checkpoint_interval != 0) {
+    return;
+  }
+  // only one write in flight, older checkpoints are never written after newer ones.
+  this->WaitCheckPoint();
+  std::string buffer;
+  utils::MemoryBufferStream fs(&buffer);
+  fs.Write(&version_number, sizeof(version_number));
+  global_model->Save(&fs);
+  std::string path = checkpoint_path + "." + std::to_string(std::max(rank, 0));
+  checkpoint_writer = std::async(std::launch::async, [path, buffer]() {
+    // write to a temporary file first so a crash never leaves a partial checkpoint.
+    std::string tmp = path + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    utils::Check(fp != nullptr, "cannot open checkpoint file %s", tmp.c_str());
+    size_t n_written = fwrite(buffer.data(), 1, buffer.size(), fp);
+    utils::Check(fclose(fp) == 0 && n_written == buffer.size(),
+                 "failed to write checkpoint file %s", tmp.c_str());
+    utils::Check(std::rename(tmp.c_str(), path.c_str()) == 0,
+                 "failed to replace checkpoint file %s", path.c_str());
+  });
+}
+
+int AllreduceBase::LoadLocalCheckPoint(Serializable *global_model) {
+  if (checkpoint_path.empty() || global_model == nullptr) {
+    return 0;
+  }
+  this->WaitCheckPoint();
+  std::string path = checkpoint_path + "." + std::to_string(std::max(rank, 0));
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (fp == nullptr) {
+    return 0;
+  }
+  std::string buffer;
+  char chunk[1 << 16];
+  size_t n_read;
+  while ((n_read = fread(chunk, 1, sizeof(chunk), fp)) != 0) {
+    buffer.append(chunk, n_read);
+  }
+  fclose(fp);
+  utils::MemoryBufferStream fs(&buffer);
+  int version;
+  utils::Check(fs.Read(&version, sizeof(version)) == sizeof(version),
+               "invalid checkpoint file %s", path.c_str());
+  global_model->Load(&fs);
+  version_number = version;
+  return version;
+}
+
+namespace {
+// header of the shared memory segment, padded to a cache line
+struct ShmHeader {
+  std::atomic<uint32_t> count;
+  std::atomic<uint32_t> sense;
+};
+constexpr size_t kShmHeaderSize = 64;
+static_assert(sizeof(ShmHeader) <= kShmHeaderSize, "shared memory header too large");
+
+// address of a worker published to all other workers during InitHierarchy
+struct PeerInfo {
+  char host[256];
+  int32_t port;
+  int32_t padding;
+};
+}  // anonymous namespace
+
+bool AllreduceBase::InitHierarchy() {
+#if defined(_WIN32)
+  LOG(WARNING) << "rabit_shm_allreduce is not supported on Windows, ignored";
+  return true;
+#else
+  try {
+    using utils::Assert;
+    // publish host name and a listening port, used by host leaders to form their ring
+    utils::TCPSocket sock_listen;
+    sock_listen.Create(link_transport);
+    int port = sock_listen.TryBindHost(slave_port, slave_port + nport_trial);
+    utils::Check(port != -1, "InitHierarchy fail to bind the ports specified");
+    sock_listen.Listen();
+
+    std::vector<PeerInfo> peers(world_size);
+    std::memset(peers.data(), 0, peers.size() * sizeof(PeerInfo));
+    std::strncpy(peers[rank].host, host_uri.c_str(), sizeof(PeerInfo::host) - 1);
+    peers[rank].port = port;
+    Assert(TryAllgatherRing(peers.data(), peers.size() * sizeof(PeerInfo),
+                            rank * sizeof(PeerInfo), (rank + 1) * sizeof(PeerInfo),
+                            sizeof(PeerInfo)) == kSuccess,
+           "InitHierarchy failed to gather hosts");
+
+    // the worker with lowest rank on each host is the leader of that host
+    std::string const my_host{peers[rank].host};
+    std::vector<int> leaders;
+    std::map<std::string, int> host_leader;
+    int max_local_size = 0;
+    local_rank = 0;
+    local_size = 0;
+    for (int r = 0; r < world_size; ++r) {
+      std::string host{peers[r].host};
+      if (host_leader.find(host) == host_leader.cend()) {
+        host_leader[host] = r;
+        leaders.push_back(r);
+      }
+      if (host == my_host) {
+        if (r < rank) {
+          ++local_rank;
+        }
+        ++local_size;
+      }
+    }
+    for (auto const &kv : host_leader) {
+      int n = 0;
+      for (int r = 0; r < world_size; ++r) {
+        n += static_cast<int>(kv.first == peers[r].host);
+      }
+      max_local_size = std::max(max_local_size, n);
+    }
+    num_leaders = static_cast<int>(leaders.size());
+    int my_leader = host_leader.at(my_host);
+    leader_rank = static_cast<int>(
+        std::find(leaders.cbegin(), leaders.cend(), my_leader) - leaders.cbegin());
+    if (max_local_size == 1) {
+      // one worker per host, nothing to be shared.
+      sock_listen.Close();
+      local_rank = 0;
+      local_size = 1;
+      return true;
+    }
+
+    // connect ring between host leaders, send before receiving to avoid waiting on each other
+    if (local_rank == 0 && num_leaders > 1) {
+      int next = leaders[(leader_rank + 1) % num_leaders];
+      LinkRecord &next_link = leader_links[0];
+      LinkRecord &prev_link = leader_links[1];
+      next_link.sock.Create(link_transport);
+      utils::Check(next_link.sock.Connect(utils::SockAddr(peers[next].host, peers[next].port)),
+                   "InitHierarchy failed to connect to the next host leader");
+      Assert(next_link.sock.SendAll(&leader_rank, sizeof(leader_rank)) == sizeof(leader_rank),
+             "InitHierarchy failure 1");
+      prev_link.sock = sock_listen.Accept();
+      Assert(prev_link.sock.RecvAll(&prev_link.rank, sizeof(prev_link.rank)) ==
+                 sizeof(prev_link.rank),
+             "InitHierarchy failure 2");
+      Assert(prev_link.sock.SendAll(&leader_rank, sizeof(leader_rank)) == sizeof(leader_rank),
+             "InitHierarchy failure 3");
+      Assert(next_link.sock.RecvAll(&next_link.rank, sizeof(next_link.rank)) ==
+                 sizeof(next_link.rank),
+             "InitHierarchy failure 4");
+      utils::Check(next_link.rank == (leader_rank + 1) % num_leaders &&
+                       leader_rank == (prev_link.rank + 1) % num_leaders,
+                   "InitHierarchy failure, leader rank inconsistent");
+      for (auto &link : leader_links) {
+        link.sock.SetNonBlock(true);
+        link.sock.SetKeepAlive(true);
+      }
+    }
+    sock_listen.Close();
+
+    // map the segment, created by the leader before anyone else opens it
+    std::string name = "/rabit-" + tracker_uri + "-" + std::to_string(tracker_port) + "-" +
+                       std::to_string(my_leader);
+    shm_segment_size = kShmHeaderSize + shm_slot_size * local_size;
+    int fd = -1;
+    int barrier = 0;
+    auto global_barrier = [&]() {
+      Assert(TryAllreduce(&barrier, sizeof(barrier), 1, op::Reducer<op::Max, int>) ==
+                 kSuccess,
+             "InitHierarchy barrier failed");
+    };
+    if (local_rank == 0) {
+      shm_unlink(name.c_str());
+      fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+      utils::Check(fd != -1, "InitHierarchy failed to create shared memory %s", name.c_str());
+      utils::Check(ftruncate(fd, shm_segment_size) == 0,
+                   "InitHierarchy failed to allocate shared memory");
+    }
+    global_barrier();
+    if (local_rank != 0) {
+      fd = shm_open(name.c_str(), O_RDWR, 0600);
+      utils::Check(fd != -1, "InitHierarchy failed to open shared memory %s", name.c_str());
+    }
+    void *ptr = mmap(nullptr, shm_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    utils::Check(ptr != MAP_FAILED, "InitHierarchy failed to map shared memory");
+    shm_segment = static_cast<char *>(ptr);
+    if (local_rank == 0) {
+      new (shm_segment) ShmHeader{};
+    }
+    global_barrier();
+    if (local_rank == 0) {
+      // the mapping stays valid, no file is left behind if a worker dies.
+      shm_unlink(name.c_str());
+    }
+    shm_sense = 0;
+    hierarchical = true;
+    LOG(INFO) << "rank " << rank << " uses shared memory allreduce, local rank " << local_rank
+              << " of " << local_size << ", " << num_leaders << " hosts";
+    return true;
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "failed in InitHierarchy " << e.what();
+    return false;
+  }
+#endif  // defined(_WIN32)
+}
+
+void AllreduceBase::ShutdownHierarchy() {
+#if !defined(_WIN32)
+  if (shm_segment != nullptr) {
+    munmap(shm_segment, shm_segment_size);
+    shm_segment = nullptr;
+  }
+#endif  // !defined(_WIN32)
+  for (auto &link : leader_links) {
+    if (!link.sock.IsClosed()) {
+      link.sock.Close();
+    }
+  }
+  hierarchical = false;
+}
+
+void AllreduceBase::LocalBarrier() {
+  auto *header = reinterpret_cast<ShmHeader *>(shm_segment);
+  shm_sense = shm_sense == 0 ? 1 : 0;
+  if (header->count.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+      static_cast<uint32_t>(local_size)) {
+    header->count.store(0, std::memory_order_relaxed);
+    header->sense.store(shm_sense, std::memory_order_release);
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (header->sense.load(std::memory_order_acquire) != shm_sense) {
+    std::this_thread::yield();
+    if (rabit_timeout && std::chrono::steady_clock::now() - start > timeout_sec) {
+      LOG(FATAL) << "[" << rank << "] timeout waiting for workers on the same host.";
+    }
+  }
+}
+
+char *AllreduceBase::ShmSlot(int i) const {
+  return shm_segment + kShmHeaderSize + shm_slot_size * i;
+}
+
+AllreduceBase::ReturnType
+AllreduceBase::TryAllreduceLeaders(void *sendrecvbuf_,
+                                   size_t type_nbytes,
+                                   size_t count,
+                                   ReduceFunction reducer) {
+  if (num_leaders == 1 || count == 0) return kSuccess;
+  // run the ring algorithm with the leader ring in place of the global ring.
+  LinkRecord *prev = ring_prev, *next = ring_next;
+  int global_rank = rank, global_size = world_size;
+  ring_next = &leader_links[0];
+  ring_prev = &leader_links[1];
+  rank = leader_rank;
+  world_size = num_leaders;
+  ReturnType ret = TryAllreduceRing(sendrecvbuf_, type_nbytes, count, reducer);
+  ring_prev = prev;
+  ring_next = next;
+  rank = global_rank;
+  world_size = global_size;
+  return ret;
+}
+
+AllreduceBase::ReturnType
+AllreduceBase::TryAllreduceHierarchical(void *sendrecvbuf_,
+                                        size_t type_nbytes,
+                                        size_t count,
+                                        ReduceFunction reducer) {
+  if (local_size == 1) {
+    return this->TryAllreduceLeaders(sendrecvbuf_, type_nbytes, count, reducer);
+  }
+  char *sendrecvbuf = reinterpret_cast<char *>(sendrecvbuf_);
+  const size_t chunk = shm_slot_size / type_nbytes;
+  utils::Assert(chunk != 0, "too large type_nbytes=%lu, rabit_shm_buffer=%lu", type_nbytes,
+                shm_slot_size);
+  MPI::Datatype dtype(type_nbytes);
+  ReturnType ret = kSuccess;
+  for (size_t begin = 0; begin < count; begin += chunk) {
+    const size_t n = std::min(chunk, count - begin);
+    char *data = sendrecvbuf + begin * type_nbytes;
+    std::memcpy(ShmSlot(local_rank), data, n * type_nbytes);
+    this->LocalBarrier();
+    // each worker reduces a stripe of all slots into the leader's slot
+    const size_t stripe = (n + local_size - 1) / local_size;
+    const size_t stripe_begin = std::min(stripe * local_rank, n);
+    const size_t stripe_end = std::min(stripe_begin + stripe, n);
+    if (stripe_end != stripe_begin) {
+      for (int i = 1; i < local_size; ++i) {
+        reducer(ShmSlot(i) + stripe_begin * type_nbytes,
+                ShmSlot(0) + stripe_begin * type_nbytes,
+                static_cast<int>(stripe_end - stripe_begin), dtype);
+      }
+    }
+    this->LocalBarrier();
+    if (local_rank == 0) {
+      ret = this->TryAllreduceLeaders(ShmSlot(0), type_nbytes, n, reducer);
+    }
+    this->LocalBarrier();
+    std::memcpy(data, ShmSlot(0), n * type_nbytes);
+    // the leader's slot is overwritten by the next chunk
+    this->LocalBarrier();
+    if (ret != kSuccess) {
+      return ret;
+    }
+  }
+  return ret;
+}
 }  // namespace engine
 }  // namespace rabit
@@ -129,6 +129,27 @@ class AllreduceBase : public IEngine {
                       kSuccess,
                   "Allreduce failed");
   }
+  /*!
+   * \brief perform in-place reduce-scatter, on sendrecvbuf
+   * \param sendrecvbuf_ buffer for both sending and receiving data
+   * \param type_nbytes the unit number of bytes the type have
+   * \param count number of elements to be reduced
+   * \param reducer reduce function
+   * \sa IEngine::ReduceScatter
+   */
+  void ReduceScatter(void *sendrecvbuf_, size_t type_nbytes, size_t count,
+                     ReduceFunction reducer) override {
+    if (world_size == 1 || world_size == -1) return;
+    if (hierarchical) {
+      // the ring is only formed between host leaders, full result is a valid output.
+      utils::Assert(TryAllreduce(sendrecvbuf_, type_nbytes, count, reducer) == kSuccess,
+                    "ReduceScatter failed");
+      return;
+    }
+    utils::Assert(TryReduceScatterRing(sendrecvbuf_, type_nbytes, count, reducer) ==
+                      kSuccess,
+                  "ReduceScatter failed");
+  }
   /*!
    * \brief broadcast data from root to all nodes
    * \param sendrecvbuf_ buffer for both sending and receiving data
@@ -167,7 +188,7 @@ class AllreduceBase : public IEngine {
    */
   int LoadCheckPoint(Serializable *global_model,
                      Serializable *local_model = nullptr) override {
-    return 0;
+    return this->LoadLocalCheckPoint(global_model);
   }
   /*!
    * \brief checkpoint the model, meaning we finished a stage of execution
@@ -188,6 +209,7 @@ class AllreduceBase : public IEngine {
   void CheckPoint(const Serializable *global_model,
                   const Serializable *local_model = nullptr) override {
     version_number += 1;
+    this->SaveLocalCheckPoint(global_model);
   }
   /*!
    * \brief This function can be used to replace CheckPoint for global_model only,
@@ -211,6 +233,7 @@ class AllreduceBase : public IEngine {
    */
   void LazyCheckPoint(const Serializable *global_model) override {
     version_number += 1;
+    this->SaveLocalCheckPoint(global_model);
   }
   /*!
    * \return version number of current stored model,
@@ -391,6 +414,17 @@ class AllreduceBase : public IEngine {
    * \return a socket that initializes the connection
    */
   utils::TCPSocket ConnectTracker() const;
+  /*! \brief Address of a peer to connect, sent by the tracker. */
+  struct PeerAddr {
+    std::string host;
+    int port;
+    int rank;
+  };
+  /*!
+   * \brief Connect to a peer and exchange ranks, retrying a few times with backoff.
+   * \return Whether the link is established.
+   */
+  bool ConnectPeer(PeerAddr const &peer, LinkRecord *p_link) const;
   /*!
    * \brief connect to the tracker to fix the the missing links
    *   this function is also used when the engine start up
@@ -425,6 +459,15 @@ class AllreduceBase : public IEngine {
    * \sa ReturnType
    */
   ReturnType TryBroadcast(void *sendrecvbuf_, size_t size, int root);
+  /*!
+   * \brief broadcast data from root to all nodes along the ring, used for large buffers
+   * \param sendrecvbuf_ buffer for both sending and receiving data
+   * \param size the size of the data to be broadcasted
+   * \param root the root worker id to broadcast the data
+   * \return this function can return kSuccess, kSockError, kGetExcept, see ReturnType for details
+   * \sa ReturnType
+   */
+  ReturnType TryBroadcastRing(void *sendrecvbuf_, size_t size, int root);
   /*!
    * \brief perform in-place allreduce, on sendrecvbuf,
    * this function implements tree-shape reduction
@@ -491,6 +534,55 @@ class AllreduceBase : public IEngine {
                               size_t type_nbytes,
                               size_t count,
                               ReduceFunction reducer);
+  /*!
+   * \brief persist global model to rabit_checkpoint_path every rabit_checkpoint_interval
+   *  versions.  The model is serialized by the calling thread and written to disk in
+   *  background, replacing the previous file once complete.
+   */
+  void SaveLocalCheckPoint(const Serializable *global_model);
+  /*!
+   * \brief load the checkpoint persisted by this rank, if any.
+   * \return version of the loaded checkpoint, 0 if there's none.
+   */
+  int LoadLocalCheckPoint(Serializable *global_model);
+  /*! \brief wait for the pending checkpoint write */
+  void WaitCheckPoint();
+  /*!
+   * \brief group workers running on the same host, map the shared memory segment used
+   *  for intra-host reduction and connect the ring among host leaders.
+   *  Called by Init when rabit_shm_allreduce is set.
+   */
+  bool InitHierarchy();
+  /*! \brief unmap the shared memory segment and close links between host leaders */
+  void ShutdownHierarchy();
+  /*! \brief barrier among workers on the same host, through the shared memory segment */
+  void LocalBarrier();
+  /*! \brief get the slot of i-th worker on this host in the shared memory segment */
+  char *ShmSlot(int i) const;
+  /*!
+   * \brief perform in-place allreduce among host leaders only, using the ring between leaders
+   * \sa TryAllreduceRing
+   */
+  ReturnType TryAllreduceLeaders(void *sendrecvbuf_,
+                                 size_t type_nbytes,
+                                 size_t count,
+                                 ReduceFunction reducer);
+  /*!
+   * \brief perform in-place allreduce, on sendrecvbuf,
+   *  reduce among workers on the same host through shared memory, then allreduce
+   *  among host leaders through TCP, the result is read back from shared memory.
+   *
+   * \param sendrecvbuf_ buffer for both sending and receiving data
+   * \param type_nbytes the unit number of bytes the type have
+   * \param count number of elements to be reduced
+   * \param reducer reduce function
+   * \return this function can return kSuccess, kSockError, kGetExcept, see ReturnType for details
+   * \sa ReturnType
+   */
+  ReturnType TryAllreduceHierarchical(void *sendrecvbuf_,
+                                      size_t type_nbytes,
+                                      size_t count,
+                                      ReduceFunction reducer);
   /*!
    * \brief function used to report error when a link goes wrong
    * \param link the pointer to the link who causes the error
@@ -544,6 +636,10 @@ class AllreduceBase : public IEngine {
   size_t reduce_ring_mincount;  // NOLINT
   // minimum block size per tree reduce
   size_t tree_reduce_minsize;  // NOLINT
+  // maximum number of bytes forwarded by each step of broadcast
+  size_t broadcast_chunk_size;  // NOLINT
+  // minimum number of bytes to broadcast along the ring instead of the tree
+  size_t broadcast_ring_minsize;  // NOLINT
   // current rank
   int rank;  // NOLINT
   // world size
@@ -560,6 +656,37 @@ class AllreduceBase : public IEngine {
   bool rabit_timeout = false;  // NOLINT
   // Enable TCP node delay
   bool rabit_enable_tcp_no_delay = false;  // NOLINT
+  // transport of links between workers, the tracker is always reached over TCP
+  utils::Transport link_transport {utils::Transport::kTCP};  // NOLINT
+  //----- local checkpoint -----
+  // prefix of checkpoint files, rank is appended. Empty means checkpoints are not persisted
+  std::string checkpoint_path;  // NOLINT
+  // persist every this number of checkpoints
+  int checkpoint_interval {1};  // NOLINT
+  // pending write of checkpoint
+  std::future<void> checkpoint_writer;  // NOLINT
+  //----- hierarchical allreduce -----
+  // reduce among workers on the same host through shared memory
+  bool rabit_shm_allreduce = false;  // NOLINT
+  // size of the shared memory slot of each worker, in bytes
+  size_t shm_slot_size = 4UL << 20UL;  // NOLINT
+  // whether allreduce goes through the hierarchy, same on all workers
+  bool hierarchical = false;  // NOLINT
+  // rank among workers on the same host, 0 is the host leader
+  int local_rank {0};  // NOLINT
+  // number of workers on the same host
+  int local_size {1};  // NOLINT
+  // rank of this host among all hosts, only valid on host leaders
+  int leader_rank {0};  // NOLINT
+  // number of hosts
+  int num_leaders {1};  // NOLINT
+  // mapped shared memory segment, barrier header followed by one slot per local worker
+  char *shm_segment {nullptr};  // NOLINT
+  size_t shm_segment_size {0};  // NOLINT
+  // sense of the local barrier, flipped on every barrier
+  uint32_t shm_sense {0};  // NOLINT
+  // ring between host leaders, 0 is the link to next leader, 1 is from previous leader
+  LinkRecord leader_links[2];  // NOLINT
 };
 }  // namespace engine
 }  // namespace rabit
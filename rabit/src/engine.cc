@@ -9,6 +9,8 @@
 #include <rabit/base.h>
 #include <dmlc/thread_local.h>
 
+#include <atomic>
+#include <future>
 #include <memory>
 #include "rabit/internal/engine.h"
 #include "allreduce_base.h"
@@ -26,12 +28,17 @@ typedef AllreduceMock Manager;
 typedef AllreduceBase Manager;
 #endif  // RABIT_USE_BASE
 
+/*! \brief bytes passed to reduction collectives, shared by all threads */
+std::atomic<uint64_t> bytes_reduced{0};
+
 /*! \brief entry to to easily hold returning information */
 struct ThreadLocalEntry {
   /*! \brief stores the current engine */
   std::unique_ptr<Manager> engine;
   /*! \brief whether init has been called */
   bool initialized{false};
+  /*! \brief the last started non-blocking operation */
+  std::shared_future<void> last_request;
   /*! \brief constructor */
   ThreadLocalEntry() = default;
 };
@@ -81,6 +88,10 @@ IEngine *GetEngine() {
   }
 }
 
+uint64_t BytesReduced() {
+  return bytes_reduced.load(std::memory_order_relaxed);
+}
+
 // perform in-place allgather, on sendrecvbuf
 void Allgather(void *sendrecvbuf_, size_t total_size,
                    size_t slice_begin,
@@ -100,10 +111,46 @@ void Allreduce_(void *sendrecvbuf,  // NOLINT
                 mpi::OpType ,
                 IEngine::PreprocFunction prepare_fun,
                 void *prepare_arg) {
+  bytes_reduced.fetch_add(type_nbytes * count, std::memory_order_relaxed);
   GetEngine()->Allreduce(sendrecvbuf, type_nbytes, count, red, prepare_fun,
     prepare_arg);
 }
 
+// perform in-place reduce-scatter, on sendrecvbuf
+void ReduceScatter_(void *sendrecvbuf,  // NOLINT
+                    size_t type_nbytes,
+                    size_t count,
+                    IEngine::ReduceFunction red,
+                    mpi::DataType,
+                    mpi::OpType) {
+  bytes_reduced.fetch_add(type_nbytes * count, std::memory_order_relaxed);
+  GetEngine()->ReduceScatter(sendrecvbuf, type_nbytes, count, red);
+}
+
+// start a non-blocking in-place allreduce, on sendrecvbuf
+Request IAllreduce_(void *sendrecvbuf,  // NOLINT
+                    size_t type_nbytes,
+                    size_t count,
+                    IEngine::ReduceFunction red,
+                    mpi::DataType,
+                    mpi::OpType) {
+  bytes_reduced.fetch_add(type_nbytes * count, std::memory_order_relaxed);
+  ThreadLocalEntry* e = EngineThreadLocal::Get();
+  // The engine is thread local, get it from the calling thread.
+  IEngine* engine = GetEngine();
+  std::shared_future<void> prev = e->last_request;
+  // Each request waits for the previous one so links are used by one operation at a time.
+  std::shared_future<void> future =
+      std::async(std::launch::async, [=]() {
+        if (prev.valid()) {
+          prev.wait();
+        }
+        engine->Allreduce(sendrecvbuf, type_nbytes, count, red, nullptr, nullptr);
+      }).share();
+  e->last_request = future;
+  return Request{future};
+}
+
 // code for reduce handle
 ReduceHandle::ReduceHandle() = default;
 ReduceHandle::~ReduceHandle() = default;
@@ -122,6 +169,7 @@ void ReduceHandle::Allreduce(void *sendrecvbuf,
                              IEngine::PreprocFunction prepare_fun,
                              void *prepare_arg) {
   utils::Assert(redfunc_ != nullptr, "must initialize handle to call AllReduce");
+  bytes_reduced.fetch_add(type_nbytes * count, std::memory_order_relaxed);
   GetEngine()->Allreduce(sendrecvbuf, type_nbytes, count,
                          redfunc_, prepare_fun, prepare_arg);
 }
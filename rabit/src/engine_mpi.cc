@@ -9,6 +9,7 @@
 #define NOMINMAX
 #include <mpi.h>
 #include <rabit/base.h>
+#include <atomic>
 #include <cstdio>
 #include <string>
 #include "rabit/internal/engine.h"
@@ -32,6 +33,11 @@ class MPIEngine : public IEngine {
     utils::Error("MPIEngine:: Allreduce is not supported,"\
                  "use Allreduce_ instead");
   }
+  void ReduceScatter(void *sendrecvbuf_, size_t type_nbytes, size_t count,
+                     ReduceFunction reducer) override {
+    utils::Error("MPIEngine:: ReduceScatter is not supported,"\
+                 "use ReduceScatter_ instead");
+  }
   int GetRingPrevRank(void) const override {
     utils::Error("MPIEngine:: GetRingPrevRank is not supported");
     return -1;
@@ -145,6 +151,13 @@ inline MPI::Op GetOp(mpi::OpType otype) {
   utils::Error("unknown mpi::OpType");
   return MPI::MAX;
 }
+/*! \brief bytes passed to reduction collectives, shared by all threads */
+std::atomic<uint64_t> bytes_reduced{0};
+
+uint64_t BytesReduced() {
+  return bytes_reduced.load(std::memory_order_relaxed);
+}
+
 // perform in-place allreduce, on sendrecvbuf
 void Allreduce_(void *sendrecvbuf,
                 size_t type_nbytes,
@@ -154,11 +167,37 @@ void Allreduce_(void *sendrecvbuf,
                 mpi::OpType op,
                 IEngine::PreprocFunction prepare_fun,
                 void *prepare_arg) {
+  bytes_reduced.fetch_add(type_nbytes * count, std::memory_order_relaxed);
   if (prepare_fun != NULL) prepare_fun(prepare_arg);
   MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE, sendrecvbuf,
                             count, GetType(dtype), GetOp(op));
 }
 
+// the full reduction result contains the segment of every node.
+void ReduceScatter_(void *sendrecvbuf,
+                    size_t type_nbytes,
+                    size_t count,
+                    IEngine::ReduceFunction red,
+                    mpi::DataType dtype,
+                    mpi::OpType op) {
+  Allreduce_(sendrecvbuf, type_nbytes, count, red, dtype, op, nullptr, nullptr);
+}
+
+// MPI may not be initialized with multi-threading support, the reduction is performed when
+// the request is waited.
+Request IAllreduce_(void *sendrecvbuf,
+                    size_t type_nbytes,
+                    size_t count,
+                    IEngine::ReduceFunction red,
+                    mpi::DataType dtype,
+                    mpi::OpType op) {
+  std::shared_future<void> future =
+      std::async(std::launch::deferred, [=]() {
+        Allreduce_(sendrecvbuf, type_nbytes, count, red, dtype, op, nullptr, nullptr);
+      }).share();
+  return Request{future};
+}
+
 // code for reduce handle
 ReduceHandle::ReduceHandle(void)
     : handle_(NULL), redfunc_(NULL), htype_(NULL) {
@@ -242,6 +281,7 @@ void ReduceHandle::Allreduce(void *sendrecvbuf,
     dtype->Commit();
     created_type_nbytes_ = type_nbytes;
   }
+  bytes_reduced.fetch_add(type_nbytes * count, std::memory_order_relaxed);
   if (prepare_fun != NULL) prepare_fun(prepare_arg);
   MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE, sendrecvbuf, count, *dtype, *op);
 }
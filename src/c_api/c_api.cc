@@ -6,6 +6,8 @@
 #include <cstring>
 #include <fstream>
 #include <algorithm>
+#include <future>
+#include <thread>
 #include <vector>
 #include <string>
 #include <memory>
@@ -22,11 +24,24 @@
 
 #include "c_api_error.h"
 #include "c_api_utils.h"
+#include "prediction_session.h"
+#include "../common/base64.h"
+#include "../common/huge_page_allocator.h"
 #include "../common/io.h"
+#include "../common/memory_tracker.h"
+#include "../common/perf_counters.h"
+#include "../common/plugin_loader.h"
 #include "../common/charconv.h"
+#include "../common/common.h"
+#include "../common/threading_utils.h"
+#include "../common/threadpool.h"
+#include "../common/timer.h"
 #include "../data/adapter.h"
+#include "../data/array_interface.h"
 #include "../data/simple_dmatrix.h"
 #include "../data/proxy_dmatrix.h"
+#include "../data/iterative_dmatrix.h"
+#include "../data/slice_dmatrix.h"
 
 using namespace xgboost; // NOLINT(*);
 
@@ -52,6 +67,11 @@ void XGBBuildInfoDevice(Json *p_info) {
   info["USE_NCCL"] = Boolean{false};
   info["USE_RMM"] = Boolean{false};
 }
+
+void CopyGradientFromCUDAArrays(Json const &, Json const *, int32_t,
+                                HostDeviceVector<GradientPair> *) {
+  common::AssertGPUSupport();
+}
 }  // namespace xgboost
 #endif
 
@@ -154,6 +174,10 @@ XGB_DLL int XGBSetGlobalConfig(const char* json_str) {
     }
     LOG(FATAL) << ss.str()  << " }";
   }
+  auto const& global_config = *GlobalConfigThreadLocalStore::Get();
+  common::MemoryTracker::Get()->SetEnabled(global_config.track_memory);
+  common::ParallelPool::SetBackend(global_config.threading_backend);
+  common::detail::SetHugePageMode(global_config.huge_pages);
   API_END();
 }
 
@@ -193,6 +217,55 @@ XGB_DLL int XGBGetGlobalConfig(const char** json_str) {
   API_END();
 }
 
+XGB_DLL int XGBLoadPlugin(char const *path) {
+  API_BEGIN();
+  CHECK(path) << "Invalid pointer argument: path";
+  common::LoadPlugin(path);
+  API_END();
+}
+
+XGB_DLL int XGBTraceStart(char const* json_config) {
+  API_BEGIN();
+  size_t buffer_size = common::Tracer::kDefaultBufferSize;
+  if (json_config != nullptr) {
+    auto config = Json::Load(StringView{json_config});
+    if (!IsA<Null>(config["buffer_size"])) {
+      auto n = get<Integer const>(config["buffer_size"]);
+      CHECK_GT(n, 0) << "buffer_size must be positive.";
+      buffer_size = static_cast<size_t>(n);
+    }
+  }
+  common::Tracer::Get()->Start(buffer_size);
+  API_END();
+}
+
+XGB_DLL int XGBTraceStop(char const** out_trace) {
+  API_BEGIN();
+  auto& local = *GlobalConfigAPIThreadLocalStore::Get();
+  common::Tracer::Get()->Stop(&local.ret_str);
+  *out_trace = local.ret_str.c_str();
+  API_END();
+}
+
+XGB_DLL int XGBGetMemoryUsage(char const* json_config, char const** out_str) {
+  API_BEGIN();
+  bool reset_peak = false;
+  if (json_config != nullptr) {
+    auto config = Json::Load(StringView{json_config});
+    if (!IsA<Null>(config["reset_peak"])) {
+      reset_peak = get<Boolean const>(config["reset_peak"]);
+    }
+  }
+  auto* tracker = common::MemoryTracker::Get();
+  auto& local = *GlobalConfigAPIThreadLocalStore::Get();
+  Json::Dump(tracker->ToJson(), &local.ret_str);
+  if (reset_peak) {
+    tracker->ResetPeak();
+  }
+  *out_str = local.ret_str.c_str();
+  API_END();
+}
+
 XGB_DLL int XGDMatrixCreateFromFile(const char *fname,
                                     int silent,
                                     DMatrixHandle *out) {
@@ -262,8 +335,25 @@ XGB_DLL int XGDMatrixCreateFromCallback(DataIterHandle iter,
   if (!IsA<Null>(config["nthread"])) {
     n_threads = get<Integer const>(config["nthread"]);
   }
-  *out = new std::shared_ptr<xgboost::DMatrix>{xgboost::DMatrix::Create(
-      iter, proxy, reset, next, missing, n_threads, cache)};
+  std::string page_format = "raw";
+  if (!IsA<Null>(config["page_format"])) {
+    page_format = get<String const>(config["page_format"]);
+  }
+  size_t prefetch_batches = 0;
+  if (!IsA<Null>(config["prefetch_batches"])) {
+    prefetch_batches = get<Integer const>(config["prefetch_batches"]);
+  }
+  size_t memory_budget = 0;
+  if (!IsA<Null>(config["memory_budget"])) {
+    memory_budget = get<Integer const>(config["memory_budget"]);
+  }
+  bool quantized_checkpoint = false;
+  if (!IsA<Null>(config["quantized_checkpoint"])) {
+    quantized_checkpoint = get<Boolean const>(config["quantized_checkpoint"]);
+  }
+  *out = new std::shared_ptr<xgboost::DMatrix>{
+      xgboost::DMatrix::Create(iter, proxy, reset, next, missing, n_threads, cache, page_format,
+                               prefetch_batches, memory_budget, quantized_checkpoint)};
   API_END();
 }
 
@@ -277,6 +367,33 @@ XGB_DLL int XGDeviceQuantileDMatrixCreateFromCallback(
   API_END();
 }
 
+XGB_DLL int XGQuantileDMatrixCreateFromCallback(DataIterHandle iter, DMatrixHandle proxy,
+                                                DMatrixHandle ref,
+                                                DataIterResetCallback *reset,
+                                                XGDMatrixCallbackNext *next,
+                                                char const *c_json_config,
+                                                DMatrixHandle *out) {
+  API_BEGIN();
+  auto config = Json::Load(StringView{c_json_config});
+  float missing = get<Number const>(config["missing"]);
+  int32_t max_bin = get<Integer const>(config["max_bin"]);
+  int32_t n_threads = omp_get_max_threads();
+  if (!IsA<Null>(config["nthread"])) {
+    n_threads = get<Integer const>(config["nthread"]);
+  }
+  size_t prefetch_batches = 0;
+  if (!IsA<Null>(config["prefetch_batches"])) {
+    prefetch_batches = get<Integer const>(config["prefetch_batches"]);
+  }
+  std::shared_ptr<xgboost::DMatrix> p_ref;
+  if (ref) {
+    p_ref = *static_cast<std::shared_ptr<xgboost::DMatrix> *>(ref);
+  }
+  *out = new std::shared_ptr<xgboost::DMatrix>{new xgboost::data::IterativeDMatrix(
+      iter, proxy, reset, next, missing, n_threads, max_bin, prefetch_batches, p_ref)};
+  API_END();
+}
+
 XGB_DLL int XGProxyDMatrixCreate(DMatrixHandle* out) {
   API_BEGIN();
   *out = new std::shared_ptr<xgboost::DMatrix>(new xgboost::data::DMatrixProxy);;
@@ -422,6 +539,36 @@ XGB_DLL int XGDMatrixCreateFromDT(void** data, const char** feature_stypes,
   API_END();
 }
 
+XGB_DLL int XGDMatrixCreateFromArrow(void *array, void *schema, char const *c_json_config,
+                                     DMatrixHandle *out) {
+  API_BEGIN();
+  data::ArrowAdapter adapter{static_cast<ArrowArray const *>(array),
+                             static_cast<ArrowSchema const *>(schema)};
+  auto config = Json::Load(StringView{c_json_config});
+  float missing = GetMissing(config);
+  auto nthread = get<Integer const>(config["nthread"]);
+  std::shared_ptr<DMatrix> p_m{DMatrix::Create(&adapter, missing, nthread)};
+
+  auto const &batch = adapter.Value();
+  p_m->Info().categories = batch.Categories();
+  auto set_str_info = [&](char const *key, std::vector<std::string> const &values) {
+    std::vector<char const *> c_values(values.size());
+    std::transform(values.cbegin(), values.cend(), c_values.begin(),
+                   [](std::string const &str) { return str.c_str(); });
+    p_m->Info().SetFeatureInfo(key, c_values.data(), c_values.size());
+  };
+  auto types = batch.FeatureTypes();
+  if (std::any_of(types.cbegin(), types.cend(), [](auto const &t) { return t == "c"; })) {
+    set_str_info("feature_type", types);
+  }
+  auto const &names = batch.FeatureNames();
+  if (std::none_of(names.cbegin(), names.cend(), [](auto const &n) { return n.empty(); })) {
+    set_str_info("feature_name", names);
+  }
+  *out = new std::shared_ptr<DMatrix>(p_m);
+  API_END();
+}
+
 XGB_DLL int XGDMatrixSliceDMatrix(DMatrixHandle handle,
                                   const int* idxset,
                                   xgboost::bst_ulong len,
@@ -450,6 +597,44 @@ XGB_DLL int XGDMatrixSliceDMatrixEx(DMatrixHandle handle,
   API_END();
 }
 
+XGB_DLL int XGDMatrixSliceDMatrixView(DMatrixHandle handle,
+                                      const int* idxset,
+                                      xgboost::bst_ulong len,
+                                      DMatrixHandle* out,
+                                      int allow_groups) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto p_fmat = *static_cast<std::shared_ptr<DMatrix>*>(handle);
+  if (!allow_groups) {
+    CHECK_EQ(p_fmat->Info().group_ptr_.size(), 0U) << "slice does not support group structure";
+  }
+  common::Span<int32_t const> ridxs{idxset, static_cast<std::size_t>(len)};
+  if (auto view = dynamic_cast<data::SliceDMatrix*>(p_fmat.get())) {
+    // Composes the indices instead of stacking views.
+    *out = new std::shared_ptr<DMatrix>(view->Slice(ridxs));
+  } else {
+    *out = new std::shared_ptr<DMatrix>(new data::SliceDMatrix(p_fmat, ridxs));
+  }
+  API_END();
+}
+
+XGB_DLL int XGDMatrixQuantize(DMatrixHandle handle, char const *json_config) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto p_fmat = *static_cast<std::shared_ptr<DMatrix>*>(handle);
+  auto config = Json::Load(StringView{json_config});
+  auto max_bin = get<Integer const>(config["max_bin"]);
+  auto sparse_threshold = get<Number const>(config["sparse_threshold"]);
+  BatchParam param{GenericParameter::kCpuId, static_cast<int32_t>(max_bin)};
+  for (auto const &page : p_fmat->GetBatches<GHistIndexMatrix>(param)) {
+    // Pages of external memory are not kept in memory, there's nothing to share.
+    if (p_fmat->SingleColBlock()) {
+      page.Columns(sparse_threshold);
+    }
+  }
+  API_END();
+}
+
 XGB_DLL int XGDMatrixFree(DMatrixHandle handle) {
   API_BEGIN();
   CHECK_HANDLE();
@@ -470,6 +655,25 @@ XGB_DLL int XGDMatrixSaveBinary(DMatrixHandle handle, const char* fname,
   API_END();
 }
 
+XGB_DLL int XGDMatrixSaveBinaryEx(DMatrixHandle handle, const char *fname,
+                                  char const *json_config) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto dmat = static_cast<std::shared_ptr<DMatrix>*>(handle)->get();
+  auto config = Json::Load(StringView{json_config});
+  int32_t max_bin = 0;
+  if (!IsA<Null>(config["max_bin"])) {
+    max_bin = get<Integer const>(config["max_bin"]);
+    CHECK_GE(max_bin, 2);
+  }
+  if (data::SimpleDMatrix* derived = dynamic_cast<data::SimpleDMatrix*>(dmat)) {
+    derived->SaveToLocalFile(fname, max_bin);
+  } else {
+    LOG(FATAL) << "binary saving only supported by SimpleDMatrix";
+  }
+  API_END();
+}
+
 XGB_DLL int XGDMatrixSetFloatInfo(DMatrixHandle handle,
                                   const char* field,
                                   const bst_float* info,
@@ -642,6 +846,27 @@ XGB_DLL int XGBoosterBoostedRounds(BoosterHandle handle, int* out) {
   API_END();
 }
 
+XGB_DLL int XGBoosterGetPerfCounters(BoosterHandle handle, char const *json_config,
+                                     char const **out_str) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  bool reset = false;
+  if (json_config != nullptr) {
+    auto config = Json::Load(StringView{json_config});
+    if (!IsA<Null>(config["reset"])) {
+      reset = get<Boolean const>(config["reset"]);
+    }
+  }
+  auto* counters = common::PerfCounters::Get();
+  auto& out = static_cast<Learner*>(handle)->GetThreadLocal().ret_str;
+  Json::Dump(counters->ToJson(), &out);
+  if (reset) {
+    counters->Reset();
+  }
+  *out_str = out.c_str();
+  API_END();
+}
+
 XGB_DLL int XGBoosterLoadJsonConfig(BoosterHandle handle, char const* json_parameters) {
   API_BEGIN();
   CHECK_HANDLE();
@@ -686,20 +911,77 @@ XGB_DLL int XGBoosterBoostOneIter(BoosterHandle handle,
                                   xgboost::bst_ulong len) {
   API_BEGIN();
   CHECK_HANDLE();
-  HostDeviceVector<GradientPair> tmp_gpair;
   auto* bst = static_cast<Learner*>(handle);
   auto* dtr =
       static_cast<std::shared_ptr<DMatrix>*>(dtrain);
+  auto& tmp_gpair = bst->GetThreadLocal().custom_gpair;
+  tmp_gpair.SetDevice(GenericParameter::kCpuId);
   tmp_gpair.Resize(len);
   std::vector<GradientPair>& tmp_gpair_h = tmp_gpair.HostVector();
-  for (xgboost::bst_ulong i = 0; i < len; ++i) {
+  common::ParallelFor(len, bst->GetGenericParameter().Threads(), [&](xgboost::bst_ulong i) {
     tmp_gpair_h[i] = GradientPair(grad[i], hess[i]);
-  }
+  });
 
   bst->BoostOneIter(0, *dtr, &tmp_gpair);
   API_END();
 }
 
+namespace {
+void CopyGradientFromHostArrays(Json const &grad, Json const *hess, int32_t n_threads,
+                                HostDeviceVector<GradientPair> *out_gpair) {
+  static_assert(sizeof(GradientPair) == sizeof(float) * 2, "Unexpected gradient layout.");
+  out_gpair->SetDevice(GenericParameter::kCpuId);
+  auto &h_gpair = out_gpair->HostVector();
+  if (!hess) {
+    ArrayInterface<2> interleaved{grad};
+    CHECK_EQ(interleaved.Shape(1), 2)
+        << "Interleaved gradient should have shape (n_samples, 2).";
+    h_gpair.resize(interleaved.Shape(0));
+    if (interleaved.type == ArrayInterfaceHandler::kF4 && interleaved.is_contiguous) {
+      // Same layout as gradient pair.
+      std::memcpy(h_gpair.data(), interleaved.data, h_gpair.size() * sizeof(GradientPair));
+      return;
+    }
+    common::ParallelFor(h_gpair.size(), n_threads, [&](size_t i) {
+      h_gpair[i] = GradientPair{interleaved(i, 0), interleaved(i, 1)};
+    });
+    return;
+  }
+
+  ArrayInterface<1> g{grad}, h{*hess};
+  CHECK_EQ(g.Shape(0), h.Shape(0)) << "grad / hess length mismatch.";
+  h_gpair.resize(g.Shape(0));
+  common::ParallelFor(h_gpair.size(), n_threads, [&](size_t i) {
+    h_gpair[i] = GradientPair{g(i), h(i)};
+  });
+}
+}  // anonymous namespace
+
+XGB_DLL int XGBoosterBoostOneIterFromInterface(BoosterHandle handle, DMatrixHandle dtrain,
+                                               int iter, char const *grad, char const *hess) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  CHECK(grad) << "Gradient is required.";
+  auto *bst = static_cast<Learner *>(handle);
+  auto *dtr = static_cast<std::shared_ptr<DMatrix> *>(dtrain);
+
+  auto j_grad = Json::Load(StringView{grad});
+  Json j_hess;
+  if (hess) {
+    j_hess = Json::Load(StringView{hess});
+  }
+  auto ptr = ArrayInterfaceHandler::GetPtrFromArrayData<void *>(get<Object const>(j_grad));
+  auto &gpair = bst->GetThreadLocal().custom_gpair;
+  auto const &ctx = bst->GetGenericParameter();
+  if (ArrayInterfaceHandler::IsCudaPtr(ptr)) {
+    CopyGradientFromCUDAArrays(j_grad, hess ? &j_hess : nullptr, ctx.gpu_id, &gpair);
+  } else {
+    CopyGradientFromHostArrays(j_grad, hess ? &j_hess : nullptr, ctx.Threads(), &gpair);
+  }
+  bst->BoostOneIter(iter, *dtr, &gpair);
+  API_END();
+}
+
 XGB_DLL int XGBoosterEvalOneIter(BoosterHandle handle,
                                  int iter,
                                  DMatrixHandle dmats[],
@@ -724,6 +1006,98 @@ XGB_DLL int XGBoosterEvalOneIter(BoosterHandle handle,
   API_END();
 }
 
+XGB_DLL int XGBoosterSetEvalCohorts(BoosterHandle handle, DMatrixHandle dmat,
+                                    unsigned const *cohorts, xgboost::bst_ulong len) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto *p_fmat = static_cast<std::shared_ptr<DMatrix> *>(dmat);
+  std::vector<uint32_t> h_cohorts(cohorts, cohorts + len);
+  static_cast<Learner *>(handle)->SetEvalCohorts(*p_fmat, h_cohorts);
+  API_END();
+}
+
+XGB_DLL int XGBoosterTrain(BoosterHandle handle, DMatrixHandle dtrain, DMatrixHandle dmats[],
+                           xgboost::bst_ulong len, char const *c_json_config,
+                           xgboost::bst_ulong *out_n_rounds, int *out_best_iteration,
+                           double *out_best_score) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto *bst = static_cast<Learner *>(handle);
+  auto *dtr = static_cast<std::shared_ptr<DMatrix> *>(dtrain);
+  std::vector<std::shared_ptr<DMatrix>> data_sets;
+  for (xgboost::bst_ulong i = 0; i < len; ++i) {
+    data_sets.push_back(*static_cast<std::shared_ptr<DMatrix> *>(dmats[i]));
+  }
+
+  auto config = Json::Load(StringView{c_json_config});
+  TrainLoopParam param;
+  param.num_boost_round = get<Integer const>(config["num_boost_round"]);
+  if (!IsA<Null>(config["early_stopping_rounds"])) {
+    param.early_stopping_rounds = get<Integer const>(config["early_stopping_rounds"]);
+  }
+  if (!IsA<Null>(config["eval_period"])) {
+    param.eval_period = get<Integer const>(config["eval_period"]);
+  }
+  if (!IsA<Null>(config["metric"])) {
+    param.metric = get<String const>(config["metric"]);
+  }
+  if (!IsA<Null>(config["maximize"])) {
+    param.maximize = get<Boolean const>(config["maximize"]);
+  }
+
+  auto result = bst->Train(*dtr, data_sets, param);
+  *out_n_rounds = result.n_rounds;
+  *out_best_iteration = result.best_iteration;
+  *out_best_score = result.best_score;
+  API_END();
+}
+
+XGB_DLL int XGBoosterTrainSweep(BoosterHandle handles[], xgboost::bst_ulong n_boosters,
+                                DMatrixHandle dtrain, DMatrixHandle dmats[],
+                                xgboost::bst_ulong len, char const *c_json_config,
+                                xgboost::bst_ulong *out_n_rounds, int *out_best_iteration,
+                                double *out_best_score) {
+  API_BEGIN();
+  std::vector<Learner *> learners;
+  for (xgboost::bst_ulong i = 0; i < n_boosters; ++i) {
+    CHECK(handles[i]) << "Booster has not been initialized or has already been disposed.";
+    learners.push_back(static_cast<Learner *>(handles[i]));
+  }
+  auto *dtr = static_cast<std::shared_ptr<DMatrix> *>(dtrain);
+  std::vector<std::shared_ptr<DMatrix>> data_sets;
+  for (xgboost::bst_ulong i = 0; i < len; ++i) {
+    data_sets.push_back(*static_cast<std::shared_ptr<DMatrix> *>(dmats[i]));
+  }
+
+  auto config = Json::Load(StringView{c_json_config});
+  SweepParam param;
+  param.num_boost_round = get<Integer const>(config["num_boost_round"]);
+  if (!IsA<Null>(config["rung_rounds"])) {
+    param.rung_rounds = get<Integer const>(config["rung_rounds"]);
+  }
+  if (!IsA<Null>(config["keep_ratio"])) {
+    auto const& ratio = config["keep_ratio"];
+    param.keep_ratio = IsA<Integer>(ratio) ? get<Integer const>(ratio) : get<Number const>(ratio);
+  }
+  if (!IsA<Null>(config["metric"])) {
+    param.metric = get<String const>(config["metric"]);
+  }
+  if (!IsA<Null>(config["maximize"])) {
+    param.maximize = get<Boolean const>(config["maximize"]);
+  }
+  if (!IsA<Null>(config["nthread"])) {
+    param.n_threads = get<Integer const>(config["nthread"]);
+  }
+
+  auto results = Learner::TrainSweep(learners, *dtr, data_sets, param);
+  for (size_t i = 0; i < results.size(); ++i) {
+    out_n_rounds[i] = results[i].n_rounds;
+    out_best_iteration[i] = results[i].best_iteration;
+    out_best_score[i] = results[i].best_score;
+  }
+  API_END();
+}
+
 XGB_DLL int XGBoosterPredict(BoosterHandle handle,
                              DMatrixHandle dmat,
                              int option_mask,
@@ -804,6 +1178,119 @@ XGB_DLL int XGBoosterPredictFromDMatrix(BoosterHandle handle,
   API_END();
 }
 
+XGB_DLL int XGBoosterCreatePredictionSession(BoosterHandle handle,
+                                             char const *c_json_config,
+                                             PredictionSessionHandle *out) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto config = Json::Load(StringView{c_json_config});
+  auto *learner = static_cast<Learner *>(handle);
+  *out = new PredictionSession{learner, config};
+  API_END();
+}
+
+XGB_DLL int XGPredictionSessionPredictFromDMatrix(PredictionSessionHandle handle,
+                                                  DMatrixHandle dmat,
+                                                  xgboost::bst_ulong const **out_shape,
+                                                  xgboost::bst_ulong *out_dim,
+                                                  float const **out_result) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  if (dmat == nullptr) {
+    LOG(FATAL) << "DMatrix has not been initialized or has already been disposed.";
+  }
+  auto p_m = *static_cast<std::shared_ptr<DMatrix> *>(dmat);
+  static_cast<PredictionSession const *>(handle)->Predict(p_m, out_shape, out_dim,
+                                                          out_result);
+  API_END();
+}
+
+XGB_DLL int XGPredictionSessionFree(PredictionSessionHandle handle) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  delete static_cast<PredictionSession *>(handle);
+  API_END();
+}
+
+namespace {
+using PredictFuture = std::shared_future<void>;
+
+common::ThreadPool *AsyncPredictPool() {
+  // Not destroyed at exit, pending predictions might use objects that are already gone.
+  static auto *pool = new common::ThreadPool{
+      std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 1)};
+  return pool;
+}
+
+template <typename Fn>
+void SubmitAsyncPredict(Fn &&fn, XGBPredictCallback *callback, void *user_data,
+                        PredictFutureHandle *out_future) {
+  auto fut = AsyncPredictPool()->Submit([fn, callback, user_data] {
+    try {
+      fn();
+    } catch (std::exception const &e) {
+      if (callback) {
+        callback(user_data, -1, e.what());
+      }
+      throw;
+    }
+    if (callback) {
+      callback(user_data, 0, nullptr);
+    }
+  });
+  if (out_future) {
+    *out_future = new PredictFuture{fut.share()};
+  }
+}
+}  // anonymous namespace
+
+XGB_DLL int XGPredictionSessionPredictAsync(PredictionSessionHandle handle,
+                                            DMatrixHandle dmat, float *out_result,
+                                            xgboost::bst_ulong out_len,
+                                            XGBPredictCallback *callback, void *user_data,
+                                            PredictFutureHandle *out_future) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  if (dmat == nullptr) {
+    LOG(FATAL) << "DMatrix has not been initialized or has already been disposed.";
+  }
+  CHECK(out_result || out_len == 0);
+  auto p_m = *static_cast<std::shared_ptr<DMatrix> *>(dmat);
+  auto const *session = static_cast<PredictionSession const *>(handle);
+  SubmitAsyncPredict(
+      [=] {
+        HostDeviceVector<float> predt;
+        session->Predict(p_m, &predt);
+        auto const &h_predt = predt.ConstHostVector();
+        CHECK_LE(h_predt.size(), out_len) << "Output buffer is too small.";
+        std::copy(h_predt.cbegin(), h_predt.cend(), out_result);
+      },
+      callback, user_data, out_future);
+  API_END();
+}
+
+XGB_DLL int XGPredictFutureWait(PredictFutureHandle handle) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  static_cast<PredictFuture *>(handle)->get();
+  API_END();
+}
+
+XGB_DLL int XGPredictFutureReady(PredictFutureHandle handle, int *out_ready) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto status = static_cast<PredictFuture *>(handle)->wait_for(std::chrono::seconds{0});
+  *out_ready = status == std::future_status::ready;
+  API_END();
+}
+
+XGB_DLL int XGPredictFutureFree(PredictFutureHandle handle) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  delete static_cast<PredictFuture *>(handle);
+  API_END();
+}
+
 template <typename T>
 void InplacePredictImpl(std::shared_ptr<T> x, std::shared_ptr<DMatrix> p_m,
                         char const *c_json_config, Learner *learner,
@@ -851,6 +1338,205 @@ XGB_DLL int XGBoosterPredictFromDense(BoosterHandle handle,
   API_END();
 }
 
+namespace {
+// FNV-1a over the shape and values of data, one 64-bit word for each element.  Blocks of
+// rows are hashed in parallel and combined in order.
+template <typename Adapter>
+uint64_t AdapterFingerprint(Adapter *adapter, float missing) {
+  auto constexpr kOffset = 14695981039346656037ULL;
+  auto constexpr kPrime = 1099511628211ULL;
+  auto const &batch = adapter->Value();
+  size_t constexpr kBlockOfRows = 1024;
+  size_t n_blocks = common::DivRoundUp(batch.Size(), kBlockOfRows);
+  std::vector<uint64_t> block_hash(n_blocks, kOffset);
+  common::ParallelFor(n_blocks, [&](size_t block) {
+    uint64_t hash = kOffset;
+    size_t end = std::min(batch.Size(), (block + 1) * kBlockOfRows);
+    for (size_t i = block * kBlockOfRows; i < end; ++i) {
+      auto line = batch.GetLine(i);
+      for (size_t j = 0; j < line.Size(); ++j) {
+        auto e = line.GetElement(j);
+        uint32_t bits;
+        std::memcpy(&bits, &e.value, sizeof(bits));
+        hash = (hash ^ ((static_cast<uint64_t>(e.column_idx) << 32) | bits)) * kPrime;
+      }
+    }
+    block_hash[block] = hash;
+  });
+  uint32_t missing_bits;
+  std::memcpy(&missing_bits, &missing, sizeof(missing_bits));
+  uint64_t hash = kOffset;
+  for (uint64_t word : {static_cast<uint64_t>(adapter->NumRows()),
+                        static_cast<uint64_t>(adapter->NumColumns()),
+                        static_cast<uint64_t>(missing_bits)}) {
+    hash = (hash ^ word) * kPrime;
+  }
+  for (auto h : block_hash) {
+    hash = (hash ^ h) * kPrime;
+  }
+  return hash;
+}
+}  // anonymous namespace
+
+XGB_DLL int XGBoosterPredictFromDenseIncremental(BoosterHandle handle,
+                                                 char const *array_interface,
+                                                 char const *c_json_config, DMatrixHandle m,
+                                                 float *margin, xgboost::bst_ulong margin_len,
+                                                 unsigned *n_layers, uint64_t *fingerprint,
+                                                 xgboost::bst_ulong const **out_shape,
+                                                 xgboost::bst_ulong *out_dim,
+                                                 const float **out_result) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  CHECK(margin || margin_len == 0);
+  CHECK(n_layers && fingerprint);
+  auto config = Json::Load(StringView{c_json_config});
+  auto type = PredictionType(get<Integer const>(config["type"]));
+  float missing = GetMissing(config);
+  std::shared_ptr<xgboost::data::ArrayAdapter> x{
+      new xgboost::data::ArrayAdapter(StringView{array_interface})};
+  auto digest = AdapterFingerprint(x.get(), missing);
+  if (*n_layers != 0) {
+    CHECK_EQ(digest, *fingerprint)
+        << "Data has changed since the margin was computed, restart the margin from 0 layer.";
+  }
+  std::shared_ptr<DMatrix> p_m {nullptr};
+  if (m) {
+    p_m = *static_cast<std::shared_ptr<DMatrix> *>(m);
+  }
+  auto *learner = static_cast<xgboost::Learner *>(handle);
+  HostDeviceVector<float> *p_predt{nullptr};
+  uint32_t layers = *n_layers;
+  learner->InplacePredictIncremental(
+      x, p_m, type, missing, common::Span<float>{margin, static_cast<size_t>(margin_len)},
+      &layers, &p_predt);
+  CHECK(p_predt);
+  *n_layers = layers;
+  *fingerprint = digest;
+
+  auto n_rows = x->NumRows();
+  auto &shape = learner->GetThreadLocal().prediction_shape;
+  auto chunksize = n_rows == 0 ? 0 : p_predt->Size() / n_rows;
+  bool strict_shape = get<Boolean const>(config["strict_shape"]);
+  CalcPredictShape(strict_shape, type, n_rows, x->NumColumns(), chunksize, learner->Groups(),
+                   learner->BoostedRounds(), &shape, out_dim);
+  *out_result = dmlc::BeginPtr(p_predt->HostVector());
+  *out_shape = dmlc::BeginPtr(shape);
+  API_END();
+}
+
+XGB_DLL int XGBoosterPredictFromRows(BoosterHandle handle, float const *values,
+                                     xgboost::bst_ulong n_rows, xgboost::bst_ulong n_cols,
+                                     float missing, int type, unsigned iteration_begin,
+                                     unsigned iteration_end, float *out_result,
+                                     xgboost::bst_ulong out_len) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  CHECK(values || n_rows == 0);
+  CHECK(out_result || out_len == 0);
+  auto *learner = static_cast<xgboost::Learner *>(handle);
+  learner->Configure();
+  CHECK_EQ(n_cols, learner->GetNumFeature())
+      << "Number of columns in data must equal to trained model.";
+  common::Span<float const> x{values, static_cast<size_t>(n_rows * n_cols)};
+  common::Span<float> out{out_result, static_cast<size_t>(out_len)};
+  learner->PredictRows(x, missing, static_cast<PredictionType>(type), out, iteration_begin,
+                       iteration_end);
+  API_END();
+}
+
+XGB_DLL int XGBoosterPredictFromRowsAsync(BoosterHandle handle, float const *values,
+                                          xgboost::bst_ulong n_rows, xgboost::bst_ulong n_cols,
+                                          float missing, int type, unsigned iteration_begin,
+                                          unsigned iteration_end, float *out_result,
+                                          xgboost::bst_ulong out_len,
+                                          XGBPredictCallback *callback, void *user_data,
+                                          PredictFutureHandle *out_future) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  CHECK(values || n_rows == 0);
+  CHECK(out_result || out_len == 0);
+  auto *learner = static_cast<xgboost::Learner *>(handle);
+  // Configure on the calling thread so that errors in parameters are reported immediately.
+  learner->Configure();
+  CHECK_EQ(n_cols, learner->GetNumFeature())
+      << "Number of columns in data must equal to trained model.";
+  common::Span<float const> x{values, static_cast<size_t>(n_rows * n_cols)};
+  common::Span<float> out{out_result, static_cast<size_t>(out_len)};
+  SubmitAsyncPredict(
+      [=] {
+        learner->PredictRows(x, missing, static_cast<PredictionType>(type), out,
+                             iteration_begin, iteration_end);
+      },
+      callback, user_data, out_future);
+  API_END();
+}
+
+XGB_DLL int XGBoosterPredictCascade(BoosterHandle handle, DMatrixHandle dmat,
+                                    char const *c_json_config, float const **out_result,
+                                    uint32_t const **out_n_trees, xgboost::bst_ulong *out_len) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  if (dmat == nullptr) {
+    LOG(FATAL) << "DMatrix has not been initialized or has already been disposed.";
+  }
+  auto config = Json::Load(StringView{c_json_config});
+  auto get_float = [&](char const *key) {
+    auto const &value = config[key];
+    if (IsA<Integer const>(value)) {
+      return static_cast<float>(get<Integer const>(value));
+    }
+    return static_cast<float>(get<Number const>(value));
+  };
+  auto *learner = static_cast<Learner *>(handle);
+  auto &entry = learner->GetThreadLocal().prediction_entry;
+  auto &n_trees = learner->GetThreadLocal().prediction_n_trees;
+  auto p_m = *static_cast<std::shared_ptr<DMatrix> *>(dmat);
+  learner->PredictCascade(p_m, get<Boolean const>(config["output_margin"]),
+                          get<Integer const>(config["stage_rounds"]),
+                          get_float("margin_lower"), get_float("margin_upper"),
+                          &entry.predictions, &n_trees,
+                          get<Integer const>(config["iteration_begin"]),
+                          get<Integer const>(config["iteration_end"]));
+  *out_result = dmlc::BeginPtr(entry.predictions.ConstHostVector());
+  *out_n_trees = dmlc::BeginPtr(n_trees);
+  *out_len = static_cast<xgboost::bst_ulong>(n_trees.size());
+  API_END();
+}
+
+XGB_DLL int XGBoosterPredictManyFromDMatrix(BoosterHandle const *handles,
+                                            xgboost::bst_ulong n_boosters, DMatrixHandle dmat,
+                                            char const *c_json_config,
+                                            float const **out_results,
+                                            xgboost::bst_ulong *out_lens) {
+  API_BEGIN();
+  CHECK(handles || n_boosters == 0);
+  if (dmat == nullptr) {
+    LOG(FATAL) << "DMatrix has not been initialized or has already been disposed.";
+  }
+  auto config = Json::Load(StringView{c_json_config});
+  std::vector<Learner *> learners;
+  std::vector<HostDeviceVector<float> *> predts;
+  for (xgboost::bst_ulong i = 0; i < n_boosters; ++i) {
+    if (handles[i] == nullptr) {
+      LOG(FATAL) << "Booster has not been initialized or has already been disposed.";
+    }
+    auto *learner = static_cast<Learner *>(handles[i]);
+    // Each booster returns its prediction in its own thread local entry.
+    CHECK(std::find(learners.cbegin(), learners.cend(), learner) == learners.cend())
+        << "Duplicated booster at position " << i << ".";
+    learners.push_back(learner);
+    predts.push_back(&learner->GetThreadLocal().prediction_entry.predictions);
+  }
+  auto p_m = *static_cast<std::shared_ptr<DMatrix> *>(dmat);
+  Learner::PredictMany(learners, p_m, get<Boolean const>(config["output_margin"]), predts);
+  for (size_t i = 0; i < predts.size(); ++i) {
+    out_results[i] = dmlc::BeginPtr(predts[i]->ConstHostVector());
+    out_lens[i] = static_cast<xgboost::bst_ulong>(predts[i]->Size());
+  }
+  API_END();
+}
+
 // A hidden API as cache id is not being supported yet.
 XGB_DLL int XGBoosterPredictFromCSR(BoosterHandle handle, char const *indptr,
                                     char const *indices, char const *data,
@@ -875,6 +1561,27 @@ XGB_DLL int XGBoosterPredictFromCSR(BoosterHandle handle, char const *indptr,
   API_END();
 }
 
+XGB_DLL int XGBoosterPredictFromArrow(BoosterHandle handle, void *array, void *schema,
+                                      char const *c_json_config, DMatrixHandle m,
+                                      xgboost::bst_ulong const **out_shape,
+                                      xgboost::bst_ulong *out_dim,
+                                      const float **out_result) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto *learner = static_cast<xgboost::Learner *>(handle);
+  // Strings are encoded directly with the categories of the model.
+  std::shared_ptr<xgboost::data::ArrowAdapter> x{new xgboost::data::ArrowAdapter{
+      static_cast<ArrowArray const *>(array), static_cast<ArrowSchema const *>(schema),
+      learner->GetCategories(), false}};
+  std::shared_ptr<DMatrix> p_m {nullptr};
+  if (m) {
+    p_m = *static_cast<std::shared_ptr<DMatrix> *>(m);
+  }
+  InplacePredictImpl(x, p_m, c_json_config, learner, x->NumRows(),
+                     x->NumColumns(), out_shape, out_dim, out_result);
+  API_END();
+}
+
 #if !defined(XGBOOST_USE_CUDA)
 XGB_DLL int XGBoosterPredictFromCUDAArray(
     BoosterHandle handle, char const *c_json_strs, char const *c_json_config,
@@ -900,11 +1607,13 @@ XGB_DLL int XGBoosterPredictFromCUDAColumnar(
 XGB_DLL int XGBoosterLoadModel(BoosterHandle handle, const char* fname) {
   API_BEGIN();
   CHECK_HANDLE();
-  if (common::FileExtension(fname) == "json") {
+  auto ext = common::FileExtension(fname);
+  if (ext == "json" || ext == "ubj") {
     auto str = common::LoadSequentialFile(fname);
     CHECK_GT(str.size(), 2);
     CHECK_EQ(str[0], '{');
-    Json in { Json::Load({str.c_str(), str.size()}) };
+    auto mode = ext == "ubj" ? std::ios::binary : std::ios::in;
+    Json in { Json::Load({str.c_str(), str.size()}, mode) };
     static_cast<Learner*>(handle)->LoadModel(in);
   } else {
     std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname, "r"));
@@ -913,18 +1622,44 @@ XGB_DLL int XGBoosterLoadModel(BoosterHandle handle, const char* fname) {
   API_END();
 }
 
+XGB_DLL int XGBoosterLoadModelLazy(BoosterHandle handle, const char* fname) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  static_cast<Learner*>(handle)->LoadModelLazy(fname);
+  API_END();
+}
+
+XGB_DLL int XGBoosterLoadSharedModel(BoosterHandle handle, const char* fname) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto file = std::make_shared<common::MmapFile>(fname);
+  common::Span<char const> image{file->Data(), file->Size()};
+  static_cast<Learner*>(handle)->LoadSharedModel(image, std::move(file));
+  API_END();
+}
+
+XGB_DLL int XGBoosterLoadSharedModelFromBuffer(BoosterHandle handle, const void* buf,
+                                               xgboost::bst_ulong len) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  common::Span<char const> image{static_cast<char const*>(buf), static_cast<size_t>(len)};
+  static_cast<Learner*>(handle)->LoadSharedModel(image, nullptr);
+  API_END();
+}
+
 XGB_DLL int XGBoosterSaveModel(BoosterHandle handle, const char* c_fname) {
   API_BEGIN();
   CHECK_HANDLE();
   std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(c_fname, "w"));
   auto *learner = static_cast<Learner *>(handle);
   learner->Configure();
-  if (common::FileExtension(c_fname) == "json") {
+  auto ext = common::FileExtension(c_fname);
+  if (ext == "json" || ext == "ubj") {
     Json out { Object() };
     learner->SaveModel(&out);
-    std::string str;
-    Json::Dump(out, &str);
-    fo->Write(str.c_str(), str.size());
+    std::vector<char> str;
+    Json::Dump(out, &str, ext == "ubj" ? std::ios::binary : std::ios::out);
+    fo->Write(str.data(), str.size());
   } else {
     auto *bst = static_cast<Learner*>(handle);
     bst->SaveModel(fo.get());
@@ -932,6 +1667,26 @@ XGB_DLL int XGBoosterSaveModel(BoosterHandle handle, const char* c_fname) {
   API_END();
 }
 
+XGB_DLL int XGBoosterSavePredictionCache(BoosterHandle handle, DMatrixHandle dmat,
+                                         const char *fname) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname, "w"));
+  auto *p_fmat = static_cast<std::shared_ptr<DMatrix> *>(dmat);
+  static_cast<Learner *>(handle)->SavePredictionCache(*p_fmat, fo.get());
+  API_END();
+}
+
+XGB_DLL int XGBoosterLoadPredictionCache(BoosterHandle handle, DMatrixHandle dmat,
+                                         const char *fname) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname, "r"));
+  auto *p_fmat = static_cast<std::shared_ptr<DMatrix> *>(dmat);
+  static_cast<Learner *>(handle)->LoadPredictionCache(*p_fmat, fi.get());
+  API_END();
+}
+
 XGB_DLL int XGBoosterLoadModelFromBuffer(BoosterHandle handle,
                                          const void* buf,
                                          xgboost::bst_ulong len) {
@@ -960,6 +1715,68 @@ XGB_DLL int XGBoosterGetModelRaw(BoosterHandle handle,
   API_END();
 }
 
+XGB_DLL int XGBoosterSaveModelToBuffer(BoosterHandle handle, char const *json_config,
+                                       xgboost::bst_ulong *out_len, char const **out_dptr) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto config = Json::Load(StringView{json_config});
+  auto format = get<String const>(config["format"]);
+  auto *learner = static_cast<Learner*>(handle);
+  std::string& raw_str = learner->GetThreadLocal().ret_str;
+  raw_str.clear();
+
+  learner->Configure();
+  if (format == "json" || format == "ubj") {
+    Json out { Object() };
+    learner->SaveModel(&out);
+    Json::Dump(out, &raw_str, format == "ubj" ? std::ios::binary : std::ios::out);
+  } else if (format == "deprecated") {
+    common::MemoryBufferStream fo(&raw_str);
+    learner->SaveModel(&fo);
+  } else {
+    LOG(FATAL) << "Unknown format: `" << format << "`";
+  }
+  *out_dptr = dmlc::BeginPtr(raw_str);
+  *out_len = static_cast<xgboost::bst_ulong>(raw_str.length());
+  API_END();
+}
+
+XGB_DLL int XGBoosterSaveCompactModelToBuffer(BoosterHandle handle, char const *json_config,
+                                              xgboost::bst_ulong *out_len,
+                                              char const **out_dptr) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto config = Json::Load(StringView{json_config});
+  auto *learner = static_cast<Learner*>(handle);
+  std::string& raw_str = learner->GetThreadLocal().ret_str;
+  raw_str.resize(0);
+
+  common::MemoryBufferStream fo(&raw_str);
+
+  learner->Configure();
+  learner->SaveCompactModel(&fo, get<String const>(config["leaf_type"]));
+  *out_dptr = dmlc::BeginPtr(raw_str);
+  *out_len = static_cast<xgboost::bst_ulong>(raw_str.length());
+  API_END();
+}
+
+XGB_DLL int XGBoosterSaveSharedModelToBuffer(BoosterHandle handle, xgboost::bst_ulong *out_len,
+                                             char const **out_dptr) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto *learner = static_cast<Learner*>(handle);
+  std::string& raw_str = learner->GetThreadLocal().ret_str;
+  raw_str.resize(0);
+
+  common::MemoryBufferStream fo(&raw_str);
+
+  learner->Configure();
+  learner->SaveSharedModel(&fo);
+  *out_dptr = dmlc::BeginPtr(raw_str);
+  *out_len = static_cast<xgboost::bst_ulong>(raw_str.length());
+  API_END();
+}
+
 // The following two functions are `Load` and `Save` for memory based
 // serialization methods. E.g. Python pickle.
 XGB_DLL int XGBoosterSerializeToBuffer(BoosterHandle handle,
@@ -988,6 +1805,34 @@ XGB_DLL int XGBoosterUnserializeFromBuffer(BoosterHandle handle,
   API_END();
 }
 
+XGB_DLL int XGBoosterSerializeToBase64(BoosterHandle handle, xgboost::bst_ulong *out_len,
+                                       const char **out_dptr) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto *learner = static_cast<Learner*>(handle);
+  std::string &raw_str = learner->GetThreadLocal().ret_str;
+  raw_str.resize(0);
+  common::MemoryBufferStream fo(&raw_str);
+  common::Base64OutStream b64(&fo);
+  learner->Configure();
+  learner->Save(&b64);
+  b64.Finish();
+  *out_dptr = dmlc::BeginPtr(raw_str);
+  *out_len = static_cast<xgboost::bst_ulong>(raw_str.length());
+  API_END();
+}
+
+XGB_DLL int XGBoosterUnserializeFromBase64(BoosterHandle handle, const char *buf,
+                                           xgboost::bst_ulong len) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  std::string raw;
+  common::base64::Decode(buf, len, &raw);
+  common::MemoryFixSizeBuffer fs(dmlc::BeginPtr(raw), raw.size());
+  static_cast<Learner*>(handle)->Load(&fs);
+  API_END();
+}
+
 XGB_DLL int XGBoosterLoadRabitCheckpoint(BoosterHandle handle,
                                          int* version) {
   API_BEGIN();
@@ -1102,6 +1947,46 @@ XGB_DLL int XGBoosterDumpModelExWithFeatures(BoosterHandle handle,
   API_END();
 }
 
+XGB_DLL int XGBoosterDumpModelTable(BoosterHandle handle, char const *json_config,
+                                    xgboost::bst_ulong *out_n_nodes, char const **out_table) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto *learner = static_cast<Learner *>(handle);
+  auto &table = learner->GetThreadLocal().model_table;
+  learner->DumpModelTable(&table);
+
+  Json j_table{Object{}};
+  auto add = [&](char const *name, auto const &column) {
+    j_table[name] = linalg::ArrayInterface(linalg::MakeVec(column.data(), column.size()));
+  };
+  add("tree_id", table.tree_id);
+  add("node_id", table.node_id);
+  add("feature", table.feature);
+  add("value", table.value);
+  add("gain", table.gain);
+  add("cover", table.cover);
+  add("left", table.left);
+  add("right", table.right);
+  add("missing", table.missing);
+  auto &str = learner->GetThreadLocal().ret_str;
+  Json::Dump(j_table, &str);
+  *out_n_nodes = table.Size();
+  *out_table = str.c_str();
+  API_END();
+}
+
+XGB_DLL int XGBoosterGenerateSource(BoosterHandle handle, char const *json_config,
+                                    xgboost::bst_ulong *out_len, char const **out_source) {
+  API_BEGIN();
+  CHECK_HANDLE();
+  auto *learner = static_cast<Learner *>(handle);
+  auto &str = learner->GetThreadLocal().ret_str;
+  learner->GenerateSource(&str);
+  *out_len = static_cast<xgboost::bst_ulong>(str.size());
+  *out_source = str.c_str();
+  API_END();
+}
+
 XGB_DLL int XGBoosterGetAttr(BoosterHandle handle,
                      const char* key,
                      const char** out,
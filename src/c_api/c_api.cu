@@ -4,6 +4,7 @@
 #include "xgboost/learner.h"
 #include "c_api_error.h"
 #include "c_api_utils.h"
+#include "../data/array_interface.h"
 #include "../data/device_adapter.cuh"
 
 namespace xgboost {
@@ -38,6 +39,38 @@ void XGBBuildInfoDevice(Json *p_info) {
 #endif
 }
 
+void CopyGradientFromCUDAArrays(Json const &grad, Json const *hess, int32_t device,
+                                HostDeviceVector<GradientPair> *out_gpair) {
+  CHECK_GE(device, 0) << "Gradient is on CUDA device, set `gpu_id` to a valid device.";
+  dh::safe_cuda(cudaSetDevice(device));
+  out_gpair->SetDevice(device);
+  if (!hess) {
+    ArrayInterface<2> interleaved{grad};
+    CHECK_EQ(interleaved.Shape(1), 2)
+        << "Interleaved gradient should have shape (n_samples, 2).";
+    out_gpair->Resize(interleaved.Shape(0));
+    auto d_gpair = out_gpair->DeviceSpan();
+    if (interleaved.type == ArrayInterfaceHandler::kF4 && interleaved.is_contiguous) {
+      // Same layout as gradient pair.
+      dh::safe_cuda(cudaMemcpyAsync(d_gpair.data(), interleaved.data, d_gpair.size_bytes(),
+                                    cudaMemcpyDeviceToDevice));
+      return;
+    }
+    dh::LaunchN(d_gpair.size(), [=] __device__(size_t i) {
+      d_gpair[i] = GradientPair{interleaved(i, 0), interleaved(i, 1)};
+    });
+    return;
+  }
+
+  ArrayInterface<1> g{grad}, h{*hess};
+  CHECK_EQ(g.Shape(0), h.Shape(0)) << "grad / hess length mismatch.";
+  out_gpair->Resize(g.Shape(0));
+  auto d_gpair = out_gpair->DeviceSpan();
+  dh::LaunchN(d_gpair.size(), [=] __device__(size_t i) {
+    d_gpair[i] = GradientPair{g(i), h(i)};
+  });
+}
+
 void XGBoostAPIGuard::SetGPUAttribute() {
   try {
     device_id_ = dh::CurrentDevice();
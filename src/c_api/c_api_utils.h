@@ -241,5 +241,12 @@ inline void GenerateFeatureMap(Learner const *learner,
 }
 
 void XGBBuildInfoDevice(Json* p_info);
+
+/*!
+ * \brief Copy gradient given by `__cuda_array_interface__` into `out_gpair` on `device`.
+ *        See `XGBoosterBoostOneIterFromInterface` for the accepted layouts.
+ */
+void CopyGradientFromCUDAArrays(Json const &grad, Json const *hess, int32_t device,
+                                HostDeviceVector<GradientPair> *out_gpair);
 }  // namespace xgboost
 #endif  // XGBOOST_C_API_C_API_UTILS_H_
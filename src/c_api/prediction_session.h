@@ -0,0 +1,104 @@
+/*!
+ * Copyright (c) 2021 by XGBoost Contributors
+ */
+#ifndef XGBOOST_C_API_PREDICTION_SESSION_H_
+#define XGBOOST_C_API_PREDICTION_SESSION_H_
+
+#include <dmlc/thread_local.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "xgboost/data.h"
+#include "xgboost/host_device_vector.h"
+#include "xgboost/json.h"
+#include "xgboost/learner.h"
+#include "xgboost/logging.h"
+#include "c_api_utils.h"
+
+namespace xgboost {
+/**
+ * \brief Prediction configuration parsed once from JSON and reused across calls.  Each
+ *        thread invoking the session gets its own output buffers, which are reused by
+ *        later calls on the same thread.
+ */
+class PredictionSession {
+  struct Buffers {
+    HostDeviceVector<float> predictions;
+    std::vector<bst_ulong> shape;
+  };
+  using ThreadLocalBuffers =
+      dmlc::ThreadLocalStore<std::map<PredictionSession const *, Buffers>>;
+
+  Learner *learner_;
+  PredictionType type_;
+  uint32_t iteration_begin_;
+  uint32_t iteration_end_;
+  bool training_;
+  bool strict_shape_;
+
+ public:
+  /**
+   * \param learner The booster, must outlive the session.
+   * \param config  Same as the configuration of `XGBoosterPredictFromDMatrix`.
+   */
+  PredictionSession(Learner *learner, Json const &config) : learner_{learner} {
+    auto const &j_config = get<Object const>(config);
+    type_ = PredictionType(get<Integer const>(j_config.at("type")));
+    iteration_begin_ = get<Integer const>(j_config.at("iteration_begin"));
+    iteration_end_ = get<Integer const>(j_config.at("iteration_end"));
+    auto ntree_limit_it = j_config.find("ntree_limit");
+    if (ntree_limit_it != j_config.cend() && !IsA<Null>(ntree_limit_it->second) &&
+        get<Integer const>(ntree_limit_it->second) != 0) {
+      CHECK(iteration_end_ == 0) <<
+          "Only one of the `ntree_limit` or `iteration_range` can be specified.";
+      LOG(WARNING) << "`ntree_limit` is deprecated, use `iteration_range` instead.";
+      iteration_end_ =
+          GetIterationFromTreeLimit(get<Integer const>(ntree_limit_it->second), learner);
+    }
+    training_ = get<Boolean const>(j_config.at("training"));
+    strict_shape_ = get<Boolean const>(j_config.at("strict_shape"));
+  }
+
+  ~PredictionSession() {
+    auto local_map = ThreadLocalBuffers::Get();
+    if (local_map->find(this) != local_map->cend()) {
+      local_map->erase(this);
+    }
+  }
+
+  /**
+   * \brief Run prediction on a DMatrix, see `XGBoosterPredictFromDMatrix` for the
+   *        output.  The result is valid until next call from the same thread.
+   */
+  void Predict(std::shared_ptr<DMatrix> p_m, bst_ulong const **out_shape, bst_ulong *out_dim,
+               float const **out_result) const {
+    auto &buffers = (*ThreadLocalBuffers::Get())[this];
+    this->Predict(p_m, &buffers.predictions);
+    *out_result = dmlc::BeginPtr(buffers.predictions.ConstHostVector());
+    auto n_rows = p_m->Info().num_row_;
+    auto chunksize = n_rows == 0 ? 0 : buffers.predictions.Size() / n_rows;
+    auto rounds = iteration_end_ - iteration_begin_;
+    rounds = rounds == 0 ? learner_->BoostedRounds() : rounds;
+    CalcPredictShape(strict_shape_, type_, n_rows, p_m->Info().num_col_, chunksize,
+                     learner_->Groups(), rounds, &buffers.shape, out_dim);
+    *out_shape = dmlc::BeginPtr(buffers.shape);
+  }
+  /**
+   * \brief Run prediction on a DMatrix into the flat output vector.
+   */
+  void Predict(std::shared_ptr<DMatrix> p_m, HostDeviceVector<float> *out_predt) const {
+    bool approximate = type_ == PredictionType::kApproxContribution ||
+                       type_ == PredictionType::kApproxInteraction;
+    bool contribs = type_ == PredictionType::kContribution ||
+                    type_ == PredictionType::kApproxContribution;
+    bool interactions = type_ == PredictionType::kInteraction ||
+                        type_ == PredictionType::kApproxInteraction;
+    learner_->Predict(p_m, type_ == PredictionType::kMargin, out_predt, iteration_begin_,
+                      iteration_end_, training_, type_ == PredictionType::kLeaf, contribs,
+                      approximate, interactions);
+  }
+};
+}  // namespace xgboost
+#endif  // XGBOOST_C_API_PREDICTION_SESSION_H_
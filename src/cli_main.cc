@@ -15,23 +15,37 @@
 #include <xgboost/logging.h>
 #include <xgboost/parameter.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <ctime>
+#include <future>
 #include <string>
 #include <cstdio>
 #include <cstring>
 #include <vector>
+#include "common/charconv.h"
 #include "common/common.h"
 #include "common/config.h"
 #include "common/io.h"
+#include "common/threadpool.h"
 #include "common/version.h"
 #include "c_api/c_api_utils.h"
+#include "data/adapter.h"
+#include "data/text_parser.h"
+#include "serve/scoring_server.h"
 
 namespace xgboost {
 enum CLITask {
   kTrain = 0,
   kDumpModel = 1,
-  kPredict = 2
+  kPredict = 2,
+  kPredictStream = 3,
+  kServe = 4
+};
+
+enum CLIPredFormat {
+  kPredText = 0,
+  kPredBinary = 1
 };
 
 struct CLIParam : public XGBoostParameter<CLIParam> {
@@ -39,6 +53,8 @@ struct CLIParam : public XGBoostParameter<CLIParam> {
   int task;
   /*! \brief whether evaluate training statistics */
   bool eval_train;
+  /*! \brief whether evaluate on a background thread, overlapped with the next round */
+  bool eval_async;
   /*! \brief number of boosting iterations */
   int num_round;
   /*! \brief the period to save the model, 0 means only save the final round model */
@@ -63,6 +79,22 @@ struct CLIParam : public XGBoostParameter<CLIParam> {
   int iteration_end;
   /*!\brief whether to directly output margin value */
   bool pred_margin;
+  /*! \brief number of rows predicted at a time by the streaming predict task */
+  size_t pred_chunk_rows;
+  /*! \brief output format of the streaming predict task */
+  int pred_format;
+  /*! \brief comma separated paths of models loaded by the serve task */
+  std::string serve_models;
+  /*! \brief TCP port of the serve task */
+  int serve_port;
+  /*! \brief path of Unix domain socket of the serve task, used instead of TCP if set */
+  std::string serve_socket;
+  /*! \brief maximum number of rows in a batch of the serve task */
+  int serve_batch_rows;
+  /*! \brief maximum delay of a request for batching in the serve task */
+  int serve_max_delay_us;
+  /*! \brief interval of reporting serving statistics in seconds */
+  int serve_report_interval;
   /*! \brief whether dump statistics along with model */
   int dump_stats;
   /*! \brief what format to dump the model in */
@@ -87,9 +119,14 @@ struct CLIParam : public XGBoostParameter<CLIParam> {
         .add_enum("train", kTrain)
         .add_enum("dump", kDumpModel)
         .add_enum("pred", kPredict)
+        .add_enum("pred_stream", kPredictStream)
+        .add_enum("serve", kServe)
         .describe("Task to be performed by the CLI program.");
     DMLC_DECLARE_FIELD(eval_train).set_default(false)
         .describe("Whether evaluate on training data during training.");
+    DMLC_DECLARE_FIELD(eval_async).set_default(false)
+        .describe("Evaluate each round on a background thread while the next round is "
+                  "trained, results are printed one round late.");
     DMLC_DECLARE_FIELD(num_round).set_default(10).set_lower_bound(1)
         .describe("Number of boosting iterations");
     DMLC_DECLARE_FIELD(save_period).set_default(0).set_lower_bound(0)
@@ -119,10 +156,29 @@ struct CLIParam : public XGBoostParameter<CLIParam> {
         .describe("End of boosted tree iteration used for prediction.  0 means all the trees.");
     DMLC_DECLARE_FIELD(pred_margin).set_default(false)
         .describe("Whether to predict margin value instead of probability.");
+    DMLC_DECLARE_FIELD(pred_chunk_rows).set_default(1 << 16).set_lower_bound(1)
+        .describe("Number of rows predicted at a time by the pred_stream task.");
+    DMLC_DECLARE_FIELD(pred_format).set_default(kPredText)
+        .add_enum("text", kPredText)
+        .add_enum("binary", kPredBinary)
+        .describe("Output format of the pred_stream task, text or raw float32.");
+    DMLC_DECLARE_FIELD(serve_models).set_default("NULL")
+        .describe("Comma separated paths of models for the serve task, model_in is used "
+                  "if not specified.");
+    DMLC_DECLARE_FIELD(serve_port).set_default(9091).set_range(1, 65535)
+        .describe("TCP port of the serve task.");
+    DMLC_DECLARE_FIELD(serve_socket).set_default("NULL")
+        .describe("Path of Unix domain socket for the serve task, used instead of TCP.");
+    DMLC_DECLARE_FIELD(serve_batch_rows).set_default(1024).set_lower_bound(1)
+        .describe("Maximum number of rows predicted in one batch by the serve task.");
+    DMLC_DECLARE_FIELD(serve_max_delay_us).set_default(1000).set_lower_bound(0)
+        .describe("Maximum time in microseconds a request waits for batching.");
+    DMLC_DECLARE_FIELD(serve_report_interval).set_default(60).set_lower_bound(0)
+        .describe("Interval in seconds of logging serving statistics, 0 to disable.");
     DMLC_DECLARE_FIELD(dump_stats).set_default(false)
         .describe("Whether dump the model statistics.");
     DMLC_DECLARE_FIELD(dump_format).set_default("text")
-        .describe("What format to dump the model in.");
+        .describe("What format to dump the model in, `c` for source of compiled_predictor.");
     DMLC_DECLARE_FIELD(name_fmap).set_default("NULL")
         .describe("Name of the feature map file.");
     DMLC_DECLARE_FIELD(name_dump).set_default("dump.txt")
@@ -162,6 +218,85 @@ constexpr char const* const CLIParam::kNull;
 
 DMLC_REGISTER_PARAMETER(CLIParam);
 
+namespace {
+/*! \brief A chunk of rows in CSR format. */
+struct RowChunk {
+  std::vector<size_t> offset{0};
+  std::vector<uint32_t> index;
+  std::vector<float> value;
+
+  size_t Size() const { return offset.size() - 1; }
+};
+
+/*!
+ * \brief Re-batch the blocks produced by a text parser into chunks with a fixed number of
+ *        rows.  Labels and weights in the input are ignored.
+ */
+class ChunkReader {
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser_;
+  size_t chunk_rows_;
+  bst_feature_t n_features_;
+  // Position of the next row in current parser block.
+  size_t pos_{0};
+  size_t block_size_{0};
+
+ public:
+  ChunkReader(std::string const &uri, uint32_t part_idx, uint32_t n_parts, size_t chunk_rows,
+              bst_feature_t n_features)
+      : chunk_rows_{chunk_rows}, n_features_{n_features} {
+    parser_.reset(data::TextParser::Create(uri, part_idx, n_parts, "auto",
+                                           omp_get_max_threads()));
+    if (!parser_) {
+      parser_.reset(dmlc::Parser<uint32_t>::Create(uri.c_str(), part_idx, n_parts, "auto"));
+    }
+  }
+
+  RowChunk Next() {
+    RowChunk chunk;
+    while (chunk.Size() < chunk_rows_) {
+      if (pos_ == block_size_) {
+        if (!parser_->Next()) {
+          break;
+        }
+        pos_ = 0;
+        block_size_ = parser_->Value().size;
+        continue;
+      }
+      auto const &block = parser_->Value();
+      size_t n = std::min(chunk_rows_ - chunk.Size(), block_size_ - pos_);
+      for (size_t i = pos_; i < pos_ + n; ++i) {
+        for (size_t j = block.offset[i]; j < block.offset[i + 1]; ++j) {
+          CHECK_LT(block.index[j], n_features_)
+              << "Number of columns in data must not exceed the trained model.";
+          chunk.index.push_back(block.index[j]);
+          chunk.value.push_back(block.value ? block.value[j] : 1.0f);
+        }
+        chunk.offset.push_back(chunk.index.size());
+      }
+      pos_ += n;
+    }
+    return chunk;
+  }
+};
+
+void WritePredictions(std::vector<float> const &preds, int format, dmlc::Stream *fo) {
+  if (format == kPredBinary) {
+    fo->Write(preds.data(), preds.size() * sizeof(float));
+    return;
+  }
+  std::string buffer(preds.size() * (NumericLimits<float>::kToCharsSize + 1), '\0');
+  char *ptr = &buffer[0];
+  char *end = ptr + buffer.size();
+  for (auto p : preds) {
+    auto ret = to_chars(ptr, end, p);
+    CHECK(ret.ec == std::errc());
+    ptr = ret.ptr;
+    *ptr++ = '\n';
+  }
+  fo->Write(buffer.data(), ptr - buffer.data());
+}
+}  // anonymous namespace
+
 std::string CliHelp() {
   return "Use xgboost -h for showing help information.\n";
 }
@@ -222,6 +357,9 @@ class CLI {
     }
     std::vector<std::string> eval_data_names = param_.eval_data_names;
     if (param_.eval_train) {
+      CHECK(!param_.eval_async)
+          << "`eval_train` is not supported with `eval_async`, training data is being "
+             "used by the next round.";
       eval_datasets.push_back(dtrain);
       eval_data_names.emplace_back("train");
     }
@@ -246,8 +384,12 @@ class CLI {
         version += 1;
       }
       CHECK_EQ(version, rabit::VersionNumber());
-      std::string res = learner_->EvalOneIter(i, eval_datasets, eval_data_names);
-      if (rabit::IsDistributed()) {
+      std::string res = param_.eval_async
+                            ? learner_->EvalOneIterAsync(i, eval_datasets, eval_data_names)
+                            : learner_->EvalOneIter(i, eval_datasets, eval_data_names);
+      if (res.empty()) {
+        // Result of the first asynchronous evaluation is not ready yet.
+      } else if (rabit::IsDistributed()) {
         if (rabit::GetRank() == 0) {
           LOG(TRACKER) << res;
         }
@@ -270,6 +412,12 @@ class CLI {
       version += 1;
       CHECK_EQ(version, rabit::VersionNumber());
     }
+    if (param_.eval_async) {
+      std::string res = learner_->WaitEvalOneIter();
+      if (!res.empty()) {
+        LOG(CONSOLE) << res;
+      }
+    }
     LOG(INFO) << "Complete Training loop time: " << dmlc::GetTime() - start
               << " sec";
     // always save final round
@@ -302,6 +450,13 @@ class CLI {
     CHECK_NE(param_.model_in, CLIParam::kNull) << "Must specify model_in for dump";
     this->ResetLearner({});
 
+    if (param_.dump_format == "c") {
+      std::string source;
+      learner_->GenerateSource(&source);
+      std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(param_.name_dump.c_str(), "w"));
+      fo->Write(source.data(), source.size());
+      return;
+    }
     // dump data
     std::vector<std::string> dump =
         learner_->DumpModel(fmap, param_.dump_stats, param_.dump_format);
@@ -361,6 +516,104 @@ class CLI {
     os.set_stream(nullptr);
   }
 
+  /*!
+   * \brief Predict the test data chunk by chunk with constant memory usage.  Parsing of the
+   *        next chunk and writing of the previous result are overlapped with prediction.
+   */
+  void CLIPredictStream() {
+    CHECK_NE(param_.test_path, CLIParam::kNull)
+        << "Test dataset parameter test:data must be specified.";
+    CHECK_NE(param_.model_in, CLIParam::kNull) << "Must specify model_in for predict";
+    this->ResetLearner({});
+    if (param_.ntree_limit != 0) {
+      param_.iteration_end = GetIterationFromTreeLimit(param_.ntree_limit, learner_.get());
+      LOG(WARNING) << "`ntree_limit` is deprecated, use `iteration_begin` and "
+                      "`iteration_end` instead.";
+    }
+    uint32_t part_idx = 0, n_parts = 1;
+    if (param_.dsplit == 2) {
+      part_idx = rabit::GetRank();
+      n_parts = rabit::GetWorldSize();
+    }
+    auto n_features = learner_->GetNumFeature();
+    ChunkReader reader{param_.test_path, part_idx, n_parts, param_.pred_chunk_rows, n_features};
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(param_.name_pred.c_str(), "w"));
+    auto type = param_.pred_margin ? PredictionType::kMargin : PredictionType::kValue;
+
+    LOG(INFO) << "Start streaming prediction...";
+    // One thread for parsing and one for writing, each stage holds at most one chunk.
+    common::ThreadPool pool{2};
+    auto next = pool.Submit([&] { return reader.Next(); });
+    std::future<void> written;
+    size_t n_rows{0};
+    while (true) {
+      auto chunk = next.get();
+      if (chunk.Size() == 0) {
+        break;
+      }
+      next = pool.Submit([&] { return reader.Next(); });
+
+      auto adapter = std::make_shared<data::CSRAdapter>(
+          chunk.offset.data(), chunk.index.data(), chunk.value.data(), chunk.Size(),
+          chunk.index.size(), n_features);
+      HostDeviceVector<float> *p_preds{nullptr};
+      learner_->InplacePredict(adapter, nullptr, type, std::numeric_limits<float>::quiet_NaN(),
+                               &p_preds, param_.iteration_begin, param_.iteration_end);
+      std::vector<float> preds{p_preds->ConstHostVector()};
+      n_rows += chunk.Size();
+
+      if (written.valid()) {
+        written.get();
+      }
+      written = pool.Submit([&fo, format = param_.pred_format, preds = std::move(preds)] {
+        WritePredictions(preds, format, fo.get());
+      });
+    }
+    if (written.valid()) {
+      written.get();
+    }
+    LOG(CONSOLE) << "Wrote prediction of " << n_rows << " rows to " << param_.name_pred;
+  }
+
+  void CLIServe() {
+    auto paths = param_.serve_models != CLIParam::kNull ? common::Split(param_.serve_models, ',')
+                                                         : std::vector<std::string>{};
+    if (paths.empty()) {
+      CHECK_NE(param_.model_in, CLIParam::kNull) << "Must specify serve_models or model_in";
+      paths.push_back(param_.model_in);
+    }
+    if (param_.ntree_limit != 0) {
+      LOG(WARNING) << "`ntree_limit` is not supported by serve, use `iteration_begin` and "
+                      "`iteration_end` instead.";
+    }
+    serve::BatchConfig config;
+    config.max_batch_rows = param_.serve_batch_rows;
+    config.max_delay = std::chrono::microseconds{param_.serve_max_delay_us};
+    config.type = param_.pred_margin ? PredictionType::kMargin : PredictionType::kValue;
+    config.iteration_begin = param_.iteration_begin;
+    config.iteration_end = param_.iteration_end;
+
+    std::vector<std::unique_ptr<serve::MicroBatcher>> models;
+    for (auto const &path : paths) {
+      std::unique_ptr<Learner> learner{Learner::Create({})};
+      this->LoadModel(path, learner.get());
+      learner->SetParams(param_.cfg);
+      models.emplace_back(new serve::MicroBatcher{std::move(learner), config});
+      LOG(CONSOLE) << "Loaded model " << models.size() - 1 << " from " << path;
+    }
+
+    serve::ScoringServer server{std::move(models),
+                                std::chrono::seconds{param_.serve_report_interval}};
+    if (param_.serve_socket != CLIParam::kNull) {
+      server.ListenUnix(param_.serve_socket);
+      LOG(CONSOLE) << "Serving on " << param_.serve_socket;
+    } else {
+      server.ListenTCP(param_.serve_port, param_.serve_port + 1);
+      LOG(CONSOLE) << "Serving on port " << param_.serve_port;
+    }
+    server.Run();
+  }
+
   void LoadModel(std::string const& path, Learner* learner) const {
     if (common::FileExtension(path) == "json") {
       auto str = common::LoadSequentialFile(path);
@@ -512,6 +765,12 @@ class CLI {
       case kPredict:
         CLIPredict();
         break;
+      case kPredictStream:
+        CLIPredictStream();
+        break;
+      case kServe:
+        CLIServe();
+        break;
       }
     } catch (dmlc::Error const& e) {
       xgboost::CLIError(e);
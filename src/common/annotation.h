@@ -0,0 +1,113 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file annotation.h
+ * \brief Named ranges shown on profiler timelines, NVTX for Nsight Systems and ITT for
+ *        VTune.  Everything here compiles to nothing unless xgboost is built with
+ *        `USE_NVTX` or `USE_ITT`.
+ */
+#ifndef XGBOOST_COMMON_ANNOTATION_H_
+#define XGBOOST_COMMON_ANNOTATION_H_
+
+#include <string>
+
+#if defined(XGBOOST_USE_NVTX)
+#include <nvToolsExt.h>
+#endif  // defined(XGBOOST_USE_NVTX)
+
+#if defined(XGBOOST_USE_ITT)
+#include <ittnotify.h>
+#endif  // defined(XGBOOST_USE_ITT)
+
+namespace xgboost {
+namespace common {
+/*!
+ * \brief A range registered with the profilers once, pushed and popped on the calling
+ *        thread.
+ */
+class Annotation {
+#if defined(XGBOOST_USE_NVTX)
+  nvtxStringHandle_t nvtx_name_ {nullptr};
+  static nvtxDomainHandle_t NvtxDomain() {
+    static nvtxDomainHandle_t domain = nvtxDomainCreateA("xgboost");
+    return domain;
+  }
+#endif  // defined(XGBOOST_USE_NVTX)
+#if defined(XGBOOST_USE_ITT)
+  __itt_string_handle* itt_name_ {nullptr};
+  static __itt_domain* IttDomain() {
+    static __itt_domain* domain = __itt_domain_create("xgboost");
+    return domain;
+  }
+#endif  // defined(XGBOOST_USE_ITT)
+  bool initialized_ {false};
+
+ public:
+#if defined(XGBOOST_USE_NVTX) || defined(XGBOOST_USE_ITT)
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif  // defined(XGBOOST_USE_NVTX) || defined(XGBOOST_USE_ITT)
+
+  Annotation() = default;
+  explicit Annotation(std::string const& name) { this->Init(name); }
+
+  bool Initialized() const { return initialized_; }
+  void Init(std::string const& name) {
+#if defined(XGBOOST_USE_NVTX)
+    nvtx_name_ = nvtxDomainRegisterStringA(NvtxDomain(), name.c_str());
+#endif  // defined(XGBOOST_USE_NVTX)
+#if defined(XGBOOST_USE_ITT)
+    itt_name_ = __itt_string_handle_create(name.c_str());
+#endif  // defined(XGBOOST_USE_ITT)
+    initialized_ = true;
+  }
+  void Push() const {
+#if defined(XGBOOST_USE_NVTX)
+    nvtxEventAttributes_t attrib {};
+    attrib.version = NVTX_VERSION;
+    attrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE;
+    attrib.messageType = NVTX_MESSAGE_TYPE_REGISTERED;
+    attrib.message.registered = nvtx_name_;
+    nvtxDomainRangePushEx(NvtxDomain(), &attrib);
+#endif  // defined(XGBOOST_USE_NVTX)
+#if defined(XGBOOST_USE_ITT)
+    __itt_task_begin(IttDomain(), __itt_null, __itt_null, itt_name_);
+#endif  // defined(XGBOOST_USE_ITT)
+  }
+  void Pop() const {
+#if defined(XGBOOST_USE_NVTX)
+    nvtxDomainRangePop(NvtxDomain());
+#endif  // defined(XGBOOST_USE_NVTX)
+#if defined(XGBOOST_USE_ITT)
+    __itt_task_end(IttDomain());
+#endif  // defined(XGBOOST_USE_ITT)
+  }
+};
+
+class ScopedAnnotation {
+  Annotation const& annotation_;
+
+ public:
+  explicit ScopedAnnotation(Annotation const& annotation) : annotation_{annotation} {
+    annotation_.Push();
+  }
+  ~ScopedAnnotation() { annotation_.Pop(); }
+  ScopedAnnotation(ScopedAnnotation const&) = delete;
+  ScopedAnnotation& operator=(ScopedAnnotation const&) = delete;
+};
+}  // namespace common
+}  // namespace xgboost
+
+/*!
+ * \brief Annotate the rest of the enclosing scope, for code paths without a Monitor.  The
+ *        name is registered on first use.
+ */
+#if defined(XGBOOST_USE_NVTX) || defined(XGBOOST_USE_ITT)
+#define XGBOOST_ANNOTATE_SCOPE(name)                                           \
+  static ::xgboost::common::Annotation const xgboost_annotation_{name};        \
+  ::xgboost::common::ScopedAnnotation xgboost_scoped_annotation_{xgboost_annotation_}
+#else
+#define XGBOOST_ANNOTATE_SCOPE(name)
+#endif  // defined(XGBOOST_USE_NVTX) || defined(XGBOOST_USE_ITT)
+
+#endif  // XGBOOST_COMMON_ANNOTATION_H_
@@ -0,0 +1,53 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace xgboost {
+namespace common {
+constexpr std::size_t Arena::kMinBlockSize;
+
+void Arena::Grow(std::size_t bytes) {
+  std::size_t size = blocks_.empty() ? kMinBlockSize : blocks_.back().size * 2;
+  size = std::max(size, bytes);
+  blocks_.push_back(Block{std::unique_ptr<char[]>{new char[size]}, size});
+  offset_ = 0;
+}
+
+void* Arena::Allocate(std::size_t bytes, std::size_t align) {
+  if (bytes == 0) {
+    bytes = 1;
+  }
+  auto aligned = [&]() {
+    auto base = reinterpret_cast<std::uintptr_t>(blocks_.back().data.get());
+    return (base + offset_ + align - 1) / align * align - base;
+  };
+  if (blocks_.empty() || aligned() + bytes > blocks_.back().size) {
+    this->Grow(bytes + align);
+  }
+  auto begin = aligned();
+  offset_ = begin + bytes;
+  return blocks_.back().data.get() + begin;
+}
+
+void Arena::Reset() {
+  if (blocks_.size() > 1) {
+    auto size = this->Capacity();
+    blocks_.clear();
+    blocks_.push_back(Block{std::unique_ptr<char[]>{new char[size]}, size});
+  }
+  offset_ = 0;
+}
+
+std::size_t Arena::Capacity() const {
+  std::size_t size = 0;
+  for (auto const& block : blocks_) {
+    size += block.size;
+  }
+  return size;
+}
+}  // namespace common
+}  // namespace xgboost
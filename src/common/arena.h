@@ -0,0 +1,96 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file arena.h
+ * \brief Bump allocator for temporary buffers of tree updaters.
+ */
+#ifndef XGBOOST_COMMON_ARENA_H_
+#define XGBOOST_COMMON_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "span.h"
+
+namespace xgboost {
+namespace common {
+/*!
+ * \brief Memory for temporaries that live no longer than a tree.  Allocations bump a
+ *        pointer inside large blocks and are never freed individually, `Reset` reclaims
+ *        all of them at once.  When a tree needs more than one block, the blocks are
+ *        merged into a single one on reset, so after the first few trees the updater
+ *        runs without touching the heap.  Not thread safe, allocate before entering
+ *        parallel regions.
+ */
+class Arena {
+  struct Block {
+    std::unique_ptr<char[]> data;
+    std::size_t size;
+  };
+  std::vector<Block> blocks_;
+  // offset into the last block.
+  std::size_t offset_{0};
+
+  void Grow(std::size_t bytes);
+
+ public:
+  static constexpr std::size_t kMinBlockSize = 64 * 1024;
+
+  Arena() = default;
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  void* Allocate(std::size_t bytes, std::size_t align);
+  /*! \brief Array of `n` copies of `v`, valid until the next `Reset`. */
+  template <typename T>
+  Span<T> Alloc(std::size_t n, T const& v = T{}) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Destructors are not run for objects in arena.");
+    auto ptr = static_cast<T*>(this->Allocate(n * sizeof(T), alignof(T)));
+    std::uninitialized_fill_n(ptr, n, v);
+    return {ptr, n};
+  }
+  /*! \brief Invalidate all allocations while keeping the memory. */
+  void Reset();
+  std::size_t Capacity() const;
+};
+
+/*!
+ * \brief Standard allocator drawing from an `Arena`, deallocation is a no-op.  Containers
+ *        using it must be destroyed before the arena is reset.
+ */
+template <typename T>
+class ArenaAllocator {
+  Arena* arena_;
+
+  template <typename U>
+  friend class ArenaAllocator;
+
+ public:
+  using value_type = T;  // NOLINT
+
+  explicit ArenaAllocator(Arena* arena) : arena_{arena} {}
+  template <typename U>
+  ArenaAllocator(ArenaAllocator<U> const& that) : arena_{that.arena_} {}  // NOLINT
+
+  T* allocate(std::size_t n) {  // NOLINT
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T*, std::size_t) {}  // NOLINT
+
+  template <typename U>
+  bool operator==(ArenaAllocator<U> const& that) const {
+    return arena_ == that.arena_;
+  }
+  template <typename U>
+  bool operator!=(ArenaAllocator<U> const& that) const {
+    return !(*this == that);
+  }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_ARENA_H_
@@ -0,0 +1,238 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "base64.h"
+
+#include <cctype>
+#include <cstdint>
+#include <string>
+
+#include "xgboost/logging.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XGBOOST_SIMD_BASE64 1
+#else
+#define XGBOOST_SIMD_BASE64 0
+#endif  // defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+namespace xgboost {
+namespace common {
+namespace base64 {
+namespace {
+// Number of groups processed by each iteration of the vectorized loops.
+constexpr size_t kSimdGroups = 8;
+constexpr uint8_t kInvalid = 0xFF;
+
+struct Tables {
+  // 6 bit value of each character, `kInvalid` for characters outside of the alphabet.
+  uint8_t decode[256];
+
+  Tables() {
+    for (auto& v : decode) {
+      v = kInvalid;
+    }
+    for (uint8_t i = 0; i < 64; ++i) {
+      decode[static_cast<uint8_t>(EncodeTable[i])] = i;
+    }
+  }
+};
+
+Tables const& GetTables() {
+  static Tables const tables;
+  return tables;
+}
+
+void EncodeScalar(uint8_t const* in, size_t n_groups, char* out) {
+  for (size_t i = 0; i < n_groups; ++i, in += 3, out += 4) {
+    uint32_t v = (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) |
+                 in[2];
+    out[0] = EncodeTable[v >> 18];
+    out[1] = EncodeTable[(v >> 12) & 0x3F];
+    out[2] = EncodeTable[(v >> 6) & 0x3F];
+    out[3] = EncodeTable[v & 0x3F];
+  }
+}
+
+size_t DecodeScalar(char const* in, size_t n_groups, uint8_t* out) {
+  auto const& decode = GetTables().decode;
+  for (size_t i = 0; i < n_groups; ++i, in += 4, out += 3) {
+    uint32_t a = decode[static_cast<uint8_t>(in[0])], b = decode[static_cast<uint8_t>(in[1])],
+             c = decode[static_cast<uint8_t>(in[2])], d = decode[static_cast<uint8_t>(in[3])];
+    if (((a | b | c | d) & 0xC0) != 0) {
+      return i;
+    }
+    uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+    out[0] = static_cast<uint8_t>(v >> 16);
+    out[1] = static_cast<uint8_t>(v >> 8);
+    out[2] = static_cast<uint8_t>(v);
+  }
+  return n_groups;
+}
+
+#if XGBOOST_SIMD_BASE64
+// Encode 8 groups, reading 28 bytes from input.
+__attribute__((target("avx2")))
+void EncodeAVX2(uint8_t const* in, char* out) {
+  __m256i v = _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in))),
+      _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 12)), 1);
+  // Each 32 bit word holds bytes [b, a, c, b] of a group [a, b, c].
+  v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                              1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  // Move the 4 6-bit values into separated bytes.
+  __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)),
+                                  _mm256_set1_epi32(0x04000040));
+  __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)),
+                                  _mm256_set1_epi32(0x01000010));
+  __m256i idx = _mm256_or_si256(t0, t1);
+  // Map values to characters by adding an offset for each range:
+  // [0, 26) -> 13, [26, 52) -> 0, [52, 62) -> [1, 10], 62 -> 11, 63 -> 12.
+  __m256i range = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+  range = _mm256_or_si256(
+      range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx),
+                              _mm256_set1_epi8(13)));
+  auto constexpr kDigit = static_cast<char>('0' - 52);
+  __m256i const offset = _mm256_setr_epi8(
+      'a' - 26, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit,
+      static_cast<char>('+' - 62), static_cast<char>('/' - 63), 'A', 0, 0,
+      'a' - 26, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit, kDigit,
+      static_cast<char>('+' - 62), static_cast<char>('/' - 63), 'A', 0, 0);
+  __m256i chars = _mm256_add_epi8(idx, _mm256_shuffle_epi8(offset, range));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), chars);
+}
+
+__attribute__((target("avx2")))
+inline __m256i InRange(__m256i c, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), c));
+}
+
+// Decode 8 groups, writing 28 bytes to output.  Returns false without writing anything
+// if there's any character outside of the alphabet.
+__attribute__((target("avx2")))
+bool DecodeAVX2(char const* in, uint8_t* out) {
+  __m256i c = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in));
+  // Characters greater than 127 are negative and fall out of all ranges.
+  __m256i upper = InRange(c, 'A', 'Z');
+  __m256i lower = InRange(c, 'a', 'z');
+  __m256i digit = InRange(c, '0', '9');
+  __m256i plus = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('+'));
+  __m256i slash = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('/'));
+  __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                  _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+  if (_mm256_movemask_epi8(valid) != -1) {
+    return false;
+  }
+  __m256i shift = _mm256_or_si256(
+      _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+                      _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+      _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+                      _mm256_or_si256(_mm256_and_si256(plus, _mm256_set1_epi8(62 - '+')),
+                                      _mm256_and_si256(slash, _mm256_set1_epi8(63 - '/')))));
+  __m256i v = _mm256_add_epi8(c, shift);
+  // Pack 4 6-bit values of each group into the lower 24 bits of a 32 bit word.
+  v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+  v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+  v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                              -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                              -1, -1, -1, -1));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(v));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm256_extracti128_si256(v, 1));
+  return true;
+}
+#endif  // XGBOOST_SIMD_BASE64
+
+bool DetectSupport() {
+#if XGBOOST_SIMD_BASE64
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif  // XGBOOST_SIMD_BASE64
+}
+
+bool SimdSupported() {
+  static bool const supported = DetectSupport();
+  return supported;
+}
+}  // anonymous namespace
+
+void EncodeGroups(uint8_t const* in, size_t n_groups, char* out) {
+  size_t i = 0;
+#if XGBOOST_SIMD_BASE64
+  if (SimdSupported()) {
+    // The last iteration reads 4 bytes beyond its groups, which must be inside the input.
+    for (; i + kSimdGroups + 2 <= n_groups; i += kSimdGroups) {
+      EncodeAVX2(in + i * 3, out + i * 4);
+    }
+  }
+#endif  // XGBOOST_SIMD_BASE64
+  EncodeScalar(in + i * 3, n_groups - i, out + i * 4);
+}
+
+size_t DecodeGroups(char const* in, size_t n_groups, uint8_t* out) {
+  size_t i = 0;
+#if XGBOOST_SIMD_BASE64
+  if (SimdSupported()) {
+    // The last iteration writes 4 bytes beyond its groups, which must be inside the output.
+    for (; i + kSimdGroups + 2 <= n_groups; i += kSimdGroups) {
+      if (!DecodeAVX2(in + i * 4, out + i * 3)) {
+        break;
+      }
+    }
+  }
+#endif  // XGBOOST_SIMD_BASE64
+  return i + DecodeScalar(in + i * 4, n_groups - i, out + i * 3);
+}
+
+void Encode(void const* data, size_t size, std::string* out) {
+  auto const* in = static_cast<uint8_t const*>(data);
+  size_t n_groups = size / 3;
+  size_t rest = size - n_groups * 3;
+  out->resize((n_groups + (rest != 0)) * 4);
+  EncodeGroups(in, n_groups, &(*out)[0]);
+  if (rest != 0) {
+    uint8_t last[3] = {0, 0, 0};
+    for (size_t i = 0; i < rest; ++i) {
+      last[i] = in[n_groups * 3 + i];
+    }
+    auto* tail = &(*out)[n_groups * 4];
+    EncodeScalar(last, 1, tail);
+    tail[3] = '=';
+    if (rest == 1) {
+      tail[2] = '=';
+    }
+  }
+}
+
+void Decode(char const* in, size_t size, std::string* out) {
+  while (size != 0 && isspace(static_cast<unsigned char>(in[0]))) {
+    ++in;
+    --size;
+  }
+  while (size != 0 && isspace(static_cast<unsigned char>(in[size - 1]))) {
+    --size;
+  }
+  CHECK_EQ(size % 4, 0) << "invalid base64 format";
+  size_t n_groups = size / 4;
+  size_t n_padding = 0;
+  if (n_groups != 0 && in[size - 1] == '=') {
+    n_padding = in[size - 2] == '=' ? 2 : 1;
+  }
+  out->resize(n_groups * 3);
+  auto* p_out = reinterpret_cast<uint8_t*>(&(*out)[0]);
+  size_t n_full = n_groups - (n_padding != 0);
+  CHECK_EQ(DecodeGroups(in, n_full, p_out), n_full) << "invalid base64 format";
+  if (n_padding != 0) {
+    char last[4] = {in[size - 4], in[size - 3], 'A', 'A'};
+    if (n_padding == 1) {
+      last[2] = in[size - 2];
+    }
+    CHECK_EQ(DecodeScalar(last, 1, p_out + n_full * 3), 1) << "invalid base64 format";
+    out->resize(n_groups * 3 - n_padding);
+  }
+}
+}  // namespace base64
+}  // namespace common
+}  // namespace xgboost
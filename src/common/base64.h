@@ -9,7 +9,9 @@
 #define XGBOOST_COMMON_BASE64_H_
 
 #include <xgboost/logging.h>
+#include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <cstdio>
 #include <string>
 #include "./io.h"
@@ -49,6 +51,22 @@ class StreamBufferReader {
   inline bool AtEnd(void) const {
     return read_len_ == 0;
   }
+  /*! \brief put back the last character returned by GetChar */
+  inline void Unget(void) {
+    CHECK_NE(read_ptr_, 0);
+    --read_ptr_;
+  }
+  /*! \brief characters in the buffer that are not yet read */
+  inline const char *Data(void) const {
+    return &buffer_[read_ptr_];
+  }
+  inline size_t Available(void) const {
+    return read_ptr_ < read_len_ ? read_len_ - read_ptr_ : 0;
+  }
+  /*! \brief skip characters in the buffer, must be less than available */
+  inline void Skip(size_t n) {
+    read_ptr_ += n;
+  }
 
  private:
   /*! \brief the underlying stream */
@@ -79,11 +97,31 @@ const char DecodeTable[] = {
 };
 static const char EncodeTable[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*!
+ * \brief encode groups of 3 bytes into 4 characters each without padding, using SIMD
+ *        instructions when available.
+ * \param in       input of 3 * n_groups bytes.
+ * \param n_groups number of groups.
+ * \param out      output of 4 * n_groups characters.
+ */
+void EncodeGroups(uint8_t const *in, size_t n_groups, char *out);
+/*!
+ * \brief decode groups of 4 characters into 3 bytes each, using SIMD instructions when
+ *        available.  Decoding stops at the first group with characters outside of the
+ *        alphabet, including padding and whitespace.
+ * \return number of decoded groups.
+ */
+size_t DecodeGroups(char const *in, size_t n_groups, uint8_t *out);
+/*! \brief encode a buffer into base64 string with padding. */
+void Encode(void const *data, size_t size, std::string *out);
+/*! \brief decode a base64 string with padding, leading and trailing whitespace is ignored. */
+void Decode(char const *in, size_t size, std::string *out);
 }  // namespace base64
 /*! \brief the stream that reads from base64, note we take from file pointers */
 class Base64InStream: public dmlc::Stream {
  public:
-  explicit Base64InStream(dmlc::Stream *fs) : reader_(256) {
+  explicit Base64InStream(dmlc::Stream *fs, size_t buffer_size = 256) : reader_(buffer_size) {
     reader_.set_stream(fs);
     num_prev = 0; tmp_ch = 0;
   }
@@ -131,6 +169,20 @@ class Base64InStream: public dmlc::Stream {
     // note: everything goes with 4 bytes in Base64
     // so we process 4 bytes a unit
     while (tlen && tmp_ch != EOF && !isspace(tmp_ch)) {
+      // decode whole groups in the reader buffer at once, padding and groups crossing the
+      // buffer boundary are handled one character at a time below.
+      if (tlen >= 3) {
+        reader_.Unget();
+        size_t n = std::min(tlen / 3, reader_.Available() / 4);
+        n = base64::DecodeGroups(reader_.Data(), n, cptr);
+        reader_.Skip(n * 4);
+        cptr += n * 3;
+        tlen -= n * 3;
+        tmp_ch = reader_.GetChar();
+        if (tlen == 0 || tmp_ch == EOF || isspace(tmp_ch)) {
+          break;
+        }
+      }
       // first byte
       nvalue = DecodeTable[tmp_ch] << 18;
       {
@@ -209,6 +261,17 @@ class Base64OutStream: public dmlc::Stream {
     size_t tlen = size;
     const unsigned char *cptr = static_cast<const unsigned char*>(ptr);
     while (tlen) {
+      // encode whole groups at once when there's no pending byte.
+      if (buf_top == 0 && tlen >= 3) {
+        size_t n = std::min(tlen / 3, kBlockGroups);
+        this->Flush();
+        out_buf.resize(n * 4);
+        base64::EncodeGroups(cptr, n, &out_buf[0]);
+        this->Flush();
+        cptr += n * 3;
+        tlen -= n * 3;
+        continue;
+      }
       while (buf_top < 3  && tlen != 0) {
         buf[++buf_top] = *cptr++; --tlen;
       }
@@ -255,6 +318,8 @@ class Base64OutStream: public dmlc::Stream {
   unsigned char buf[4];
   std::string out_buf;
   static const size_t kBufferSize = 256;
+  // number of groups encoded by each write to the underlying stream.
+  static const size_t kBlockGroups = 1 << 14;
 
   inline void PutChar(char ch) {
     out_buf += ch;
@@ -0,0 +1,153 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file category_dictionary.cc
+ */
+#include "category_dictionary.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace common {
+namespace {
+// FNV-1a
+uint64_t HashBytes(char const *str, size_t len) {
+  uint64_t h = 14695981039346656037ull;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= static_cast<uint8_t>(str[i]);
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+// Codes are stored as float feature values.
+constexpr size_t kMaxCategories = size_t{1} << 24;
+}  // anonymous namespace
+
+bst_cat_t CategoryDictionary::Feature::Find(char const *str, size_t len,
+                                            size_t *p_slot) const {
+  if (slots.empty()) {
+    return kUnknown;
+  }
+  size_t mask = slots.size() - 1;
+  size_t i = HashBytes(str, len) & mask;
+  while (true) {
+    auto s = slots[i];
+    if (s == 0) {
+      *p_slot = i;
+      return kUnknown;
+    }
+    auto const &cat = categories[s - 1];
+    if (cat.size() == len && std::memcmp(cat.data(), str, len) == 0) {
+      return s - 1;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+void CategoryDictionary::Feature::Rehash() {
+  size_t n = std::max(slots.size(), static_cast<size_t>(16));
+  // Keep the load factor under 0.5.
+  while (n < (categories.size() + 1) * 2) {
+    n *= 2;
+  }
+  slots.assign(n, 0);
+  for (size_t c = 0; c < categories.size(); ++c) {
+    size_t slot = 0;
+    auto code = this->Find(categories[c].data(), categories[c].size(), &slot);
+    CHECK_EQ(code, kUnknown) << "Duplicated category: " << categories[c];
+    slots[slot] = static_cast<bst_cat_t>(c + 1);
+  }
+}
+
+bool CategoryDictionary::Empty() const {
+  return std::all_of(features_.cbegin(), features_.cend(),
+                     [](Feature const &f) { return f.categories.empty(); });
+}
+
+bst_cat_t CategoryDictionary::Find(bst_feature_t fidx, char const *str, size_t len) const {
+  if (fidx >= features_.size()) {
+    return kUnknown;
+  }
+  size_t slot = 0;
+  return features_[fidx].Find(str, len, &slot);
+}
+
+bst_cat_t CategoryDictionary::Insert(bst_feature_t fidx, char const *str, size_t len) {
+  auto &feature = features_.at(fidx);
+  if (feature.slots.size() < (feature.categories.size() + 1) * 2) {
+    feature.Rehash();
+  }
+  size_t slot = 0;
+  auto code = feature.Find(str, len, &slot);
+  if (code != kUnknown) {
+    return code;
+  }
+  CHECK_LT(feature.categories.size(), kMaxCategories)
+      << "Too many categories for feature " << fidx << ".";
+  feature.categories.emplace_back(str, len);
+  code = static_cast<bst_cat_t>(feature.categories.size() - 1);
+  feature.slots[slot] = code + 1;
+  return code;
+}
+
+void CategoryDictionary::Merge(CategoryDictionary const &that) {
+  this->Resize(that.NumFeatures());
+  for (bst_feature_t f = 0; f < that.NumFeatures(); ++f) {
+    for (auto const &cat : that.Categories(f)) {
+      this->Insert(f, cat.data(), cat.size());
+    }
+  }
+}
+
+bool CategoryDictionary::Remap(CategoryDictionary const &that,
+                               std::vector<std::vector<float>> *out) const {
+  out->clear();
+  out->resize(that.NumFeatures());
+  bool all_same = true;
+  for (bst_feature_t f = 0; f < that.NumFeatures(); ++f) {
+    auto const &cats = that.Categories(f);
+    std::vector<float> map(cats.size());
+    bool same = true;
+    for (size_t c = 0; c < cats.size(); ++c) {
+      auto code = this->Find(f, cats[c].data(), cats[c].size());
+      map[c] = code == kUnknown ? std::numeric_limits<float>::quiet_NaN()
+                                : static_cast<float>(code);
+      same = same && code == static_cast<bst_cat_t>(c);
+    }
+    if (!same) {
+      out->at(f) = std::move(map);
+    }
+    all_same = all_same && same;
+  }
+  return all_same;
+}
+
+void CategoryDictionary::SaveModel(Json *p_out) const {
+  std::vector<Json> features(features_.size());
+  for (size_t f = 0; f < features_.size(); ++f) {
+    std::vector<Json> cats;
+    for (auto const &cat : features_[f].categories) {
+      cats.emplace_back(String{cat});
+    }
+    features[f] = Array{std::move(cats)};
+  }
+  *p_out = Array{std::move(features)};
+}
+
+void CategoryDictionary::LoadModel(Json const &in) {
+  auto const &features = get<Array const>(in);
+  features_.clear();
+  features_.resize(features.size());
+  for (size_t f = 0; f < features.size(); ++f) {
+    auto &feature = features_[f];
+    for (auto const &cat : get<Array const>(features[f])) {
+      feature.categories.emplace_back(get<String const>(cat));
+    }
+    feature.Rehash();
+  }
+}
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,77 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file category_dictionary.h
+ * \brief Mapping between string categories and the codes used as feature values.
+ */
+#ifndef XGBOOST_COMMON_CATEGORY_DICTIONARY_H_
+#define XGBOOST_COMMON_CATEGORY_DICTIONARY_H_
+
+#include <xgboost/base.h>
+#include <xgboost/json.h>
+
+#include <string>
+#include <vector>
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief Categories of each feature, the code of a category is its position in the list of
+ *        the feature.  Features without string categories have empty lists.
+ *
+ *   Lookup is done with an open addressing hash table over the stored strings so that
+ *   strings from input buffers can be encoded without being copied.  Categories are only
+ *   appended, existing codes never change, so a dictionary extended by new data is
+ *   still valid for models trained with the old one.  Different features can be extended
+ *   concurrently.
+ */
+class CategoryDictionary {
+  struct Feature {
+    std::vector<std::string> categories;
+    // Code + 1 of the category in each slot, 0 for empty slots.
+    std::vector<bst_cat_t> slots;
+
+    bst_cat_t Find(char const *str, size_t len, size_t *p_slot) const;
+    void Rehash();
+  };
+  std::vector<Feature> features_;
+
+ public:
+  static bst_cat_t constexpr kUnknown = -1;
+
+  CategoryDictionary() = default;
+  explicit CategoryDictionary(bst_feature_t n_features) : features_(n_features) {}
+
+  /*! \brief Make sure there's an entry for each of the features. */
+  void Resize(bst_feature_t n_features) {
+    if (features_.size() < n_features) {
+      features_.resize(n_features);
+    }
+  }
+  bst_feature_t NumFeatures() const { return static_cast<bst_feature_t>(features_.size()); }
+  /*! \brief Whether none of the features has any category. */
+  bool Empty() const;
+  std::vector<std::string> const &Categories(bst_feature_t fidx) const {
+    return features_.at(fidx).categories;
+  }
+
+  /*! \brief Code of a category, `kUnknown` if it's not in the dictionary. */
+  bst_cat_t Find(bst_feature_t fidx, char const *str, size_t len) const;
+  /*! \brief Code of a category, which is appended to the dictionary if it's not found. */
+  bst_cat_t Insert(bst_feature_t fidx, char const *str, size_t len);
+  /*! \brief Append categories of another dictionary not found in this one. */
+  void Merge(CategoryDictionary const &that);
+  /**
+   * \brief Codes of categories of another dictionary in this one, for each feature.  The
+   *        map of a feature is empty when the codes are the same in both dictionaries,
+   *        otherwise unknown categories are mapped to NaN.
+   *
+   * \return Whether all codes are the same.
+   */
+  bool Remap(CategoryDictionary const &that, std::vector<std::vector<float>> *out) const;
+
+  void SaveModel(Json *p_out) const;
+  void LoadModel(Json const &in);
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_CATEGORY_DICTIONARY_H_
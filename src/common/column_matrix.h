@@ -12,6 +12,7 @@
 #include <vector>
 #include <memory>
 #include "hist_util.h"
+#include "memory_tracker.h"
 #include "../data/gradient_index.h"
 
 namespace xgboost {
@@ -187,7 +188,12 @@ class ColumnMatrix {
 
     SetTypeSize(gmat.max_num_bins);
 
-    index_.resize(feature_offsets_[nfeature] * bins_type_size_, 0);
+    if (all_dense) {
+      // Every element is written by `SetIndexAllDense` in parallel over rows.
+      index_.resize(feature_offsets_[nfeature] * bins_type_size_);
+    } else {
+      index_.resize(feature_offsets_[nfeature] * bins_type_size_, 0);
+    }
     if (!all_dense) {
       row_ind_.resize(feature_offsets_[nfeature]);
     }
@@ -205,7 +211,17 @@ class ColumnMatrix {
     }
 
     // pre-fill index_ for dense columns
-    if (all_dense) {
+    if (all_dense && gmat.index.IsMixed()) {
+      CHECK(noMissingValues);
+      if (bins_type_size_ == kUint8BinsTypeSize) {
+          SetIndexMixed<uint8_t>(gmat, nrow, nfeature);
+      } else if (bins_type_size_ == kUint16BinsTypeSize) {
+          SetIndexMixed<uint16_t>(gmat, nrow, nfeature);
+      } else {
+          CHECK_EQ(bins_type_size_, kUint32BinsTypeSize);
+          SetIndexMixed<uint32_t>(gmat, nrow, nfeature);
+      }
+    } else if (all_dense) {
       BinTypeSize gmat_bin_size = gmat.index.GetBinTypeSize();
       if (gmat_bin_size == kUint8BinsTypeSize) {
           SetIndexAllDense(gmat.index.data<uint8_t>(), gmat, nrow, nfeature, noMissingValues);
@@ -227,6 +243,9 @@ class ColumnMatrix {
           SetIndex<uint32_t>(gmat.index.data<uint32_t>(), gmat, nfeature);
       }
     }
+    tracked_.Update(index_.capacity() + row_ind_.capacity() * sizeof(size_t) +
+                    missing_flags_.capacity() / 8 +
+                    (feature_counts_.capacity() + feature_offsets_.capacity()) * sizeof(size_t));
   }
 
   /* Set the number of bytes based on numeric limit of maximum number of bins provided by user */
@@ -263,6 +282,21 @@ class ColumnMatrix {
     return res;
   }
 
+  /* Gradient index with mixed bin types is always dense, columns are stored with the
+     widest type. */
+  template <typename T>
+  inline void SetIndexMixed(const GHistIndexMatrix &gmat, const size_t nrow,
+                            const size_t nfeature) {
+    T* local_index = reinterpret_cast<T*>(&index_[0]);
+    uint32_t const* offsets = gmat.index.Offset();
+    ParallelFor(omp_ulong(nrow), [&](omp_ulong rid) {
+      for (size_t j = 0; j < nfeature; ++j) {
+        local_index[feature_offsets_[j] + rid] =
+            static_cast<T>(gmat.index[rid * nfeature + j] - offsets[j]);
+      }
+    });
+  }
+
   template <typename T>
   inline void SetIndexAllDense(T *index, const GHistIndexMatrix &gmat,
                                const size_t nrow, const size_t nfeature,
@@ -282,30 +316,18 @@ class ColumnMatrix {
         }
       });
     } else {
-      /* to handle rows in all batches, sum of all batch sizes equal to gmat.row_ptr.size() - 1 */
-      size_t rbegin = 0;
-      for (const auto &batch : gmat.p_fmat->GetBatches<SparsePage>()) {
-        const xgboost::Entry* data_ptr = batch.data.HostVector().data();
-        const std::vector<bst_row_t>& offset_vec = batch.offset.HostVector();
-        const size_t batch_size = batch.Size();
-        CHECK_LT(batch_size, offset_vec.size());
-        for (size_t rid = 0; rid < batch_size; ++rid) {
-          const size_t size = offset_vec[rid + 1] - offset_vec[rid];
-          SparsePage::Inst inst = {data_ptr + offset_vec[rid], size};
-          const size_t ibegin = gmat.row_ptr[rbegin + rid];
-          const size_t iend = gmat.row_ptr[rbegin + rid + 1];
-          CHECK_EQ(ibegin + inst.size(), iend);
-          size_t j = 0;
-          size_t fid = 0;
-          for (size_t i = ibegin; i < iend; ++i, ++j) {
-              fid = inst[j].index;
-              const size_t idx = feature_offsets_[fid];
-              /* rbegin allows to store indexes from specific SparsePage batch */
-              local_index[idx + rbegin + rid] = index[i];
-              missing_flags_[idx + rbegin + rid] = false;
-          }
+      /* Feature index is recovered from the global bin id, so the raw data is not needed
+         and gmat can come from a DMatrix without SparsePage. */
+      auto bin_feature = BinFeatureMap(gmat.cut);
+      for (size_t rid = 0; rid < nrow; ++rid) {
+        const size_t ibegin = gmat.row_ptr[rid];
+        const size_t iend = gmat.row_ptr[rid + 1];
+        for (size_t i = ibegin; i < iend; ++i) {
+          const size_t fid = bin_feature[gmat.index[i]];
+          const size_t idx = feature_offsets_[fid];
+          local_index[idx + rid] = index[i];
+          missing_flags_[idx + rid] = false;
         }
-        rbegin += batch.Size();
       }
     }
   }
@@ -318,44 +340,47 @@ class ColumnMatrix {
     std::fill(num_nonzeros.begin(), num_nonzeros.end(), 0);
 
     T* local_index = reinterpret_cast<T*>(&index_[0]);
-    size_t rbegin = 0;
-    for (const auto &batch : gmat.p_fmat->GetBatches<SparsePage>()) {
-      const xgboost::Entry* data_ptr = batch.data.HostVector().data();
-      const std::vector<bst_row_t>& offset_vec = batch.offset.HostVector();
-      const size_t batch_size = batch.Size();
-      CHECK_LT(batch_size, offset_vec.size());
-      for (size_t rid = 0; rid < batch_size; ++rid) {
-        const size_t ibegin = gmat.row_ptr[rbegin + rid];
-        const size_t iend = gmat.row_ptr[rbegin + rid + 1];
-        size_t fid = 0;
-        const size_t size = offset_vec[rid + 1] - offset_vec[rid];
-        SparsePage::Inst inst = {data_ptr + offset_vec[rid], size};
-
-        CHECK_EQ(ibegin + inst.size(), iend);
-        size_t j = 0;
-        for (size_t i = ibegin; i < iend; ++i, ++j) {
-          const uint32_t bin_id = index[i];
-
-          fid = inst[j].index;
-          if (type_[fid] == kDenseColumn) {
-            T* begin = &local_index[feature_offsets_[fid]];
-            begin[rid + rbegin] = bin_id - index_base_[fid];
-            missing_flags_[feature_offsets_[fid] + rid + rbegin] = false;
-          } else {
-            T* begin = &local_index[feature_offsets_[fid]];
-            begin[num_nonzeros[fid]] = bin_id - index_base_[fid];
-            row_ind_[feature_offsets_[fid] + num_nonzeros[fid]] = rid + rbegin;
-            ++num_nonzeros[fid];
-          }
+    auto bin_feature = BinFeatureMap(gmat.cut);
+    const size_t nrow = gmat.row_ptr.size() - 1;
+    for (size_t rid = 0; rid < nrow; ++rid) {
+      const size_t ibegin = gmat.row_ptr[rid];
+      const size_t iend = gmat.row_ptr[rid + 1];
+      for (size_t i = ibegin; i < iend; ++i) {
+        const uint32_t bin_id = index[i];
+        const size_t fid = bin_feature[bin_id];
+        if (type_[fid] == kDenseColumn) {
+          T* begin = &local_index[feature_offsets_[fid]];
+          begin[rid] = bin_id - index_base_[fid];
+          missing_flags_[feature_offsets_[fid] + rid] = false;
+        } else {
+          T* begin = &local_index[feature_offsets_[fid]];
+          begin[num_nonzeros[fid]] = bin_id - index_base_[fid];
+          row_ind_[feature_offsets_[fid] + num_nonzeros[fid]] = rid;
+          ++num_nonzeros[fid];
         }
       }
-      rbegin += batch.Size();
     }
   }
+
+  /* Map each global bin id to the feature it belongs to. */
+  static std::vector<bst_feature_t> BinFeatureMap(HistogramCuts const& cut) {
+    auto const& ptrs = cut.Ptrs();
+    std::vector<bst_feature_t> bin_feature(ptrs.back());
+    for (size_t fid = 0; fid + 1 < ptrs.size(); ++fid) {
+      std::fill(bin_feature.begin() + ptrs[fid], bin_feature.begin() + ptrs[fid + 1],
+                static_cast<bst_feature_t>(fid));
+    }
+    return bin_feature;
+  }
+
   BinTypeSize GetTypeSize() const {
     return bins_type_size_;
   }
 
+  ColumnType GetColumnType(bst_feature_t fidx) const { return type_[fidx]; }
+  /*! \brief Number of non-missing values in a column. */
+  size_t GetFeatureCount(bst_feature_t fidx) const { return feature_counts_[fidx]; }
+
   // This is just an utility function
   bool NoMissingValues(const size_t n_elements,
                              const size_t n_row, const size_t n_features) {
@@ -367,8 +392,49 @@ class ColumnMatrix {
     return any_missing_;
   }
 
+  /*!
+   * \brief Call `fn(ridx, bin)` for each non-missing value of a feature in ascending order
+   *        of rows, `bin` being the global bin index.
+   */
+  template <typename Fn>
+  void VisitColumn(bst_feature_t fidx, Fn&& fn) const {
+    switch (bins_type_size_) {
+      case kUint8BinsTypeSize:
+        this->VisitColumnImpl<uint8_t>(fidx, fn);
+        break;
+      case kUint16BinsTypeSize:
+        this->VisitColumnImpl<uint16_t>(fidx, fn);
+        break;
+      case kUint32BinsTypeSize:
+        this->VisitColumnImpl<uint32_t>(fidx, fn);
+        break;
+      default:
+        CHECK(false);  // no default behavior
+    }
+  }
+
  private:
-  std::vector<uint8_t> index_;
+  template <typename BinIdxType, typename Fn>
+  void VisitColumnImpl(bst_feature_t fidx, Fn&& fn) const {
+    size_t const offset = feature_offsets_[fidx];
+    size_t const size = feature_offsets_[fidx + 1] - offset;
+    auto const* index = reinterpret_cast<BinIdxType const*>(&index_[offset * bins_type_size_]);
+    uint32_t const base = index_base_[fidx];
+    if (type_[fidx] == ColumnType::kDenseColumn) {
+      for (size_t i = 0; i < size; ++i) {
+        if (!any_missing_ || !missing_flags_[offset + i]) {
+          fn(i, base + static_cast<uint32_t>(index[i]));
+        }
+      }
+    } else {
+      size_t const* rows = row_ind_.data() + offset;
+      for (size_t i = 0; i < size; ++i) {
+        fn(rows[i], base + static_cast<uint32_t>(index[i]));
+      }
+    }
+  }
+
+  std::vector<uint8_t, DefaultInitAllocator<uint8_t>> index_;
 
   std::vector<size_t> feature_counts_;
   std::vector<ColumnType> type_;
@@ -381,6 +447,7 @@ class ColumnMatrix {
   std::vector<bool> missing_flags_;
   BinTypeSize bins_type_size_;
   bool any_missing_;
+  TrackedBytes tracked_{MemoryTracker::kColumnMatrix};
 };
 
 }  // namespace common
@@ -0,0 +1,89 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file column_subset.cc
+ */
+#include "column_subset.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "threading_utils.h"
+
+namespace xgboost {
+namespace common {
+constexpr uint32_t ColumnSubset::kNotSampled;
+
+void ColumnSubset::Init(GHistIndexMatrix const &gmat, Span<bst_feature_t const> features,
+                        int32_t n_threads) {
+  CHECK(gmat.IsDense()) << "Column subset requires dense data.";
+  CHECK_EQ(gmat.base_rowid, 0) << "Column subset requires a single page.";
+  CHECK(!gmat.index.IsMixed()) << "Column subset requires a single bin type.";
+  CHECK(std::is_sorted(features.cbegin(), features.cend()));
+  auto const &ptrs = gmat.cut.Ptrs();
+  auto const &values = gmat.cut.Values();
+  auto const &mins = gmat.cut.MinValues();
+  auto n_features = static_cast<bst_feature_t>(ptrs.size() - 1);
+  size_t n_rows = gmat.Size();
+  size_t n_subset = features.size();
+
+  feature_begin_.assign(n_features, kNotSampled);
+  auto &sub_ptrs = index_.cut.cut_ptrs_.HostVector();
+  auto &sub_values = index_.cut.cut_values_.HostVector();
+  auto &sub_mins = index_.cut.min_vals_.HostVector();
+  sub_ptrs.assign(1, 0);
+  sub_values.clear();
+  sub_mins.clear();
+  index_.hit_count.clear();
+  for (auto fidx : features) {
+    CHECK_LT(fidx, n_features);
+    feature_begin_[fidx] = sub_ptrs.back();
+    sub_ptrs.push_back(sub_ptrs.back() + (ptrs[fidx + 1] - ptrs[fidx]));
+    sub_values.insert(sub_values.end(), values.cbegin() + ptrs[fidx],
+                      values.cbegin() + ptrs[fidx + 1]);
+    sub_mins.push_back(mins[fidx]);
+    index_.hit_count.insert(index_.hit_count.end(), gmat.hit_count.cbegin() + ptrs[fidx],
+                            gmat.hit_count.cbegin() + ptrs[fidx + 1]);
+  }
+
+  index_.p_fmat = gmat.p_fmat;
+  index_.base_rowid = 0;
+  index_.SetDense(true);
+  // Same bin type as the source index, so that bins are copied without conversion.
+  index_.max_num_bins = gmat.max_num_bins;
+  index_.row_ptr.resize(n_rows + 1);
+  for (size_t r = 0; r <= n_rows; ++r) {
+    index_.row_ptr[r] = r * n_subset;
+  }
+  index_.ResizeIndex(n_rows * n_subset, true);
+  CHECK_EQ(index_.index.GetBinTypeSize(), gmat.index.GetBinTypeSize());
+  index_.index.ResizeOffset(n_subset);
+  std::copy(sub_ptrs.cbegin(), sub_ptrs.cend() - 1, index_.index.Offset());
+
+  // Bins of a dense index are stored relative to the first bin of each feature.
+  auto copy = [&](auto const *src) {
+    using BinIdxType = std::remove_const_t<std::remove_pointer_t<decltype(src)>>;
+    auto *dst = index_.index.data<BinIdxType>();
+    ParallelFor(n_rows, n_threads, [&](size_t r) {
+      auto const *src_row = src + r * n_features;
+      auto *dst_row = dst + r * n_subset;
+      for (size_t j = 0; j < n_subset; ++j) {
+        dst_row[j] = src_row[features[j]];
+      }
+    });
+  };
+  switch (gmat.index.GetBinTypeSize()) {
+    case kUint8BinsTypeSize:
+      copy(gmat.index.data<uint8_t>());
+      break;
+    case kUint16BinsTypeSize:
+      copy(gmat.index.data<uint16_t>());
+      break;
+    case kUint32BinsTypeSize:
+      copy(gmat.index.data<uint32_t>());
+      break;
+    default:
+      CHECK(false);  // no default behavior
+  }
+}
+}  // namespace common
+}  // namespace xgboost
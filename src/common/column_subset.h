@@ -0,0 +1,52 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file column_subset.h
+ * \brief Dense quantized data restricted to the features sampled for a tree.
+ */
+#ifndef XGBOOST_COMMON_COLUMN_SUBSET_H_
+#define XGBOOST_COMMON_COLUMN_SUBSET_H_
+
+#include <xgboost/span.h>
+
+#include <limits>
+#include <vector>
+
+#include "hist_util.h"
+#include "../data/gradient_index.h"
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief Copy of a dense index with only a subset of features, so that histograms are
+ *        built and synchronized on bins of sampled features only.
+ *
+ *   Bins of each feature keep their order, and features are placed one after another in
+ *   the order of the subset.  The copy is reinitialized for every tree, with buffers
+ *   reused.
+ */
+class ColumnSubset {
+  // First bin of each feature in the subset index, kNotSampled for other features.
+  std::vector<uint32_t> feature_begin_;
+  GHistIndexMatrix index_;
+
+ public:
+  static constexpr uint32_t kNotSampled = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * \param gmat      A dense index with a single page.
+   * \param features  Sorted features in the subset.
+   * \param n_threads Number of threads used to copy the index.
+   */
+  void Init(GHistIndexMatrix const &gmat, Span<bst_feature_t const> features,
+            int32_t n_threads);
+
+  size_t NumFeatures() const { return index_.cut.Ptrs().size() - 1; }
+  /*! \brief Dense index with one column for each feature in the subset. */
+  GHistIndexMatrix const &Index() const { return index_; }
+  bool Contains(bst_feature_t fidx) const { return feature_begin_[fidx] != kNotSampled; }
+  /*! \brief First bin of a feature in the subset index. */
+  uint32_t FeatureBegin(bst_feature_t fidx) const { return feature_begin_[fidx]; }
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_COLUMN_SUBSET_H_
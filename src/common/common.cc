@@ -6,6 +6,12 @@
 #include <dmlc/thread_local.h>
 #include <xgboost/logging.h>
 
+#if defined(__linux__)
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <limits>
+
 #include "common.h"
 #include "./random.h"
 
@@ -23,6 +29,17 @@ GlobalRandomEngine& GlobalRandom() {
   return RandomThreadLocalStore::Get()->engine;
 }
 
+size_t AvailableHostMemory() {
+#if defined(__linux__)
+  auto n_pages = sysconf(_SC_AVPHYS_PAGES);
+  auto page_size = sysconf(_SC_PAGESIZE);
+  if (n_pages > 0 && page_size > 0) {
+    return static_cast<size_t>(n_pages) * static_cast<size_t>(page_size);
+  }
+#endif  // defined(__linux__)
+  return std::numeric_limits<size_t>::max();
+}
+
 #if !defined(XGBOOST_USE_CUDA)
 int AllVisibleGPUs() {
   return 0;
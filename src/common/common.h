@@ -14,6 +14,7 @@
 #include <exception>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <type_traits>
 #include <vector>
 #include <string>
@@ -87,6 +88,34 @@ XGBOOST_DEVICE T1 DivRoundUp(const T1 a, const T2 b) {
   return static_cast<T1>(std::ceil(static_cast<double>(a) / b));
 }
 
+/*!
+ * \brief Allocator that default initializes new elements instead of value initializing
+ *        them, so resizing a vector of trivial type doesn't write to the memory.  Pages
+ *        are then first touched by the threads filling the vector, which places them on
+ *        the NUMA node of those threads.
+ */
+template <typename T, typename A = std::allocator<T>>
+class DefaultInitAllocator : public A {
+  using Traits = std::allocator_traits<A>;
+
+ public:
+  template <typename U>
+  struct rebind {
+    using other = DefaultInitAllocator<U, typename Traits::template rebind_alloc<U>>;
+  };
+
+  using A::A;
+
+  template <typename U>
+  void construct(U* ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {
+    ::new (static_cast<void*>(ptr)) U;
+  }
+  template <typename U, typename... Args>
+  void construct(U* ptr, Args&&... args) {
+    Traits::construct(static_cast<A&>(*this), ptr, std::forward<Args>(args)...);
+  }
+};
+
 namespace detail {
 template <class T, std::size_t N, std::size_t... Idx>
 constexpr auto UnpackArr(std::array<T, N> &&arr, std::index_sequence<Idx...>) {
@@ -166,6 +195,12 @@ class Range {
 
 int AllVisibleGPUs();
 
+/*!
+ * \brief Free physical memory in bytes.  Returns the maximum value of size_t when it can not
+ *        be obtained.
+ */
+size_t AvailableHostMemory();
+
 inline void AssertGPUSupport() {
 #ifndef XGBOOST_USE_CUDA
     LOG(FATAL) << "XGBoost version not compiled with GPU support.";
@@ -0,0 +1,211 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file compression.cc
+ */
+#include "compression.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common.h"
+#include "threading_utils.h"
+
+namespace xgboost {
+namespace common {
+namespace {
+constexpr size_t kLZMinMatch = 4;
+constexpr size_t kLZMaxOffset = std::numeric_limits<uint16_t>::max();
+constexpr int32_t kLZHashLog = 14;
+// Size of independently compressed chunks in a block, so that both compression and
+// decompression can run in parallel.
+constexpr size_t kLZChunkSize = static_cast<size_t>(1) << 20;
+
+template <typename T>
+Span<T> LZChunk(Span<T> bytes, size_t i) {
+  auto begin = i * kLZChunkSize;
+  return bytes.subspan(begin, std::min(kLZChunkSize, bytes.size() - begin));
+}
+
+uint32_t LoadU32(uint8_t const* ptr) {
+  uint32_t v;
+  std::memcpy(&v, ptr, sizeof(v));
+  return v;
+}
+
+uint32_t LZHash(uint32_t seq) { return (seq * 2654435761u) >> (32 - kLZHashLog); }
+
+void WriteLZLength(size_t len, std::vector<uint8_t>* out) {
+  while (len >= 255) {
+    out->push_back(255);
+    len -= 255;
+  }
+  out->push_back(static_cast<uint8_t>(len));
+}
+
+bool ReadLZLength(Span<uint8_t const> in, size_t* ip, size_t* len) {
+  uint8_t byte = 0;
+  do {
+    if (*ip == in.size()) {
+      return false;
+    }
+    byte = in[(*ip)++];
+    *len += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * Each sequence starts with a token, high 4 bits is the length of literals and low 4 bits
+ * is the length of match minus `kLZMinMatch`, 15 means the length is continued in following
+ * bytes.  The last sequence contains only literals.
+ */
+void WriteLZSequence(Span<uint8_t const> literals, size_t offset, size_t match,
+                   std::vector<uint8_t>* out) {
+  size_t lit_len = literals.size();
+  auto lit_token = static_cast<uint8_t>(std::min(lit_len, static_cast<size_t>(15)));
+  uint8_t match_token{0};
+  if (match != 0) {
+    match_token = static_cast<uint8_t>(std::min(match - kLZMinMatch, static_cast<size_t>(15)));
+  }
+  out->push_back(static_cast<uint8_t>(lit_token << 4 | match_token));
+  if (lit_token == 15) {
+    WriteLZLength(lit_len - 15, out);
+  }
+  out->insert(out->end(), literals.cbegin(), literals.cend());
+  if (match == 0) {
+    return;
+  }
+  out->push_back(static_cast<uint8_t>(offset & 0xff));
+  out->push_back(static_cast<uint8_t>(offset >> 8));
+  if (match_token == 15) {
+    WriteLZLength(match - kLZMinMatch - 15, out);
+  }
+}
+}  // anonymous namespace
+
+void LZCompress(Span<uint8_t const> in, std::vector<uint8_t>* out) {
+  out->clear();
+  size_t n = in.size();
+  constexpr auto kEmpty = std::numeric_limits<size_t>::max();
+  std::vector<size_t> table(static_cast<size_t>(1) << kLZHashLog, kEmpty);
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + kLZMinMatch <= n) {
+    auto seq = LoadU32(in.data() + i);
+    auto& slot = table[LZHash(seq)];
+    size_t candidate = slot;
+    slot = i;
+    if (candidate != kEmpty && i - candidate <= kLZMaxOffset &&
+        LoadU32(in.data() + candidate) == seq) {
+      size_t match = kLZMinMatch;
+      while (i + match < n && in[candidate + match] == in[i + match]) {
+        ++match;
+      }
+      WriteLZSequence(in.subspan(anchor, i - anchor), i - candidate, match, out);
+      i += match;
+      anchor = i;
+    } else {
+      // Skip faster over incompressible data.
+      i += 1 + ((i - anchor) >> 6);
+    }
+  }
+  WriteLZSequence(in.subspan(anchor, n - anchor), 0, 0, out);
+}
+
+bool LZDecompress(Span<uint8_t const> in, Span<uint8_t> out) {
+  size_t ip = 0, op = 0;
+  while (true) {
+    // The last sequence must be literals, so running out of input here means truncation.
+    if (ip == in.size()) {
+      return false;
+    }
+    uint8_t token = in[ip++];
+    size_t lit_len = token >> 4;
+    if (lit_len == 15 && !ReadLZLength(in, &ip, &lit_len)) {
+      return false;
+    }
+    if (in.size() - ip < lit_len || out.size() - op < lit_len) {
+      return false;
+    }
+    std::copy_n(in.data() + ip, lit_len, out.data() + op);
+    ip += lit_len;
+    op += lit_len;
+    if (ip == in.size()) {
+      break;
+    }
+    if (in.size() - ip < 2) {
+      return false;
+    }
+    size_t offset = in[ip] | static_cast<size_t>(in[ip + 1]) << 8;
+    ip += 2;
+    size_t match = (token & 15);
+    if (match == 15 && !ReadLZLength(in, &ip, &match)) {
+      return false;
+    }
+    match += kLZMinMatch;
+    if (offset == 0 || offset > op || out.size() - op < match) {
+      return false;
+    }
+    // Match can overlap with the output, copy byte by byte.
+    for (size_t k = 0; k < match; ++k) {
+      out[op + k] = out[op - offset + k];
+    }
+    op += match;
+  }
+  return op == out.size();
+}
+
+namespace detail {
+/**
+ * Layout of LZ block: number of chunks, then for each chunk its compressed size followed by
+ * the data.  A chunk is stored as is when compression doesn't help, which is indicated by
+ * compressed size being equal to the chunk size.
+ */
+size_t WriteLZBlock(Span<uint8_t const> bytes, dmlc::Stream* fo) {
+  uint64_t n_chunks = DivRoundUp(bytes.size(), kLZChunkSize);
+  std::vector<std::vector<uint8_t>> compressed(n_chunks);
+  ParallelFor(n_chunks, omp_get_max_threads(), [&](size_t i) {
+    auto chunk = LZChunk(bytes, i);
+    LZCompress(chunk, &compressed[i]);
+    if (compressed[i].size() >= chunk.size()) {
+      compressed[i].assign(chunk.cbegin(), chunk.cend());
+    }
+  });
+  fo->Write(&n_chunks, sizeof(n_chunks));
+  size_t bytes_written = sizeof(n_chunks);
+  for (auto const& chunk : compressed) {
+    uint64_t size = chunk.size();
+    fo->Write(&size, sizeof(size));
+    fo->Write(chunk.data(), chunk.size());
+    bytes_written += sizeof(size) + chunk.size();
+  }
+  return bytes_written;
+}
+
+void ReadLZBlock(dmlc::Stream* fi, Span<uint8_t> bytes) {
+  uint64_t n_chunks{0};
+  CHECK_EQ(fi->Read(&n_chunks, sizeof(n_chunks)), sizeof(n_chunks))
+      << "Invalid compressed page.";
+  CHECK_EQ(n_chunks, DivRoundUp(bytes.size(), kLZChunkSize)) << "Invalid compressed page.";
+  std::vector<std::vector<uint8_t>> compressed(n_chunks);
+  for (auto& chunk : compressed) {
+    uint64_t size{0};
+    CHECK_EQ(fi->Read(&size, sizeof(size)), sizeof(size)) << "Invalid compressed page.";
+    chunk.resize(size);
+    CHECK_EQ(fi->Read(chunk.data(), size), size) << "Invalid compressed page.";
+  }
+  std::vector<int32_t> valid(n_chunks, 1);
+  ParallelFor(n_chunks, omp_get_max_threads(), [&](size_t i) {
+    auto out = LZChunk(bytes, i);
+    if (compressed[i].size() == out.size()) {
+      std::copy(compressed[i].cbegin(), compressed[i].cend(), out.begin());
+    } else {
+      valid[i] = LZDecompress(compressed[i], out);
+    }
+  });
+  CHECK(std::all_of(valid.cbegin(), valid.cend(), [](int32_t v) { return v; }))
+      << "Invalid compressed page.";
+}
+}  // namespace detail
+}  // namespace common
+}  // namespace xgboost
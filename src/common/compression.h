@@ -0,0 +1,191 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file compression.h
+ * \brief Light weight codecs for external memory cache pages.
+ */
+#ifndef XGBOOST_COMMON_COMPRESSION_H_
+#define XGBOOST_COMMON_COMPRESSION_H_
+
+#include <dmlc/io.h>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "xgboost/logging.h"
+#include "xgboost/span.h"
+
+namespace xgboost {
+namespace common {
+/*! \brief Codec of a block in compressed pages, recorded at the beginning of each block. */
+enum class BlockCodec : uint8_t {
+  kRaw = 0,
+  /*! \brief LZ77 with 64KB window, good for arbitrary bytes like bin index. */
+  kLZ = 1,
+  /*! \brief Zigzag delta followed by varint, good for offsets and small integers. */
+  kDeltaVarint = 2
+};
+
+/*!
+ * \brief Compress bytes with a LZ77 codec similar to the LZ4 block format.  Optimized for
+ *        speed over compression ratio.
+ */
+void LZCompress(Span<uint8_t const> in, std::vector<uint8_t>* out);
+/*!
+ * \brief Decompress data produced by `LZCompress`, `out` must have the exact size of the
+ *        uncompressed data.
+ *
+ * \return false if the input is corrupted.
+ */
+bool LZDecompress(Span<uint8_t const> in, Span<uint8_t> out);
+
+template <typename T>
+void DeltaVarintEncode(Span<T const> values, std::vector<uint8_t>* out) {
+  static_assert(std::is_integral<T>::value, "Only integers can be delta encoded.");
+  out->clear();
+  uint64_t prev = 0;
+  for (auto v : values) {
+    auto cur = static_cast<uint64_t>(v);
+    auto delta = cur - prev;
+    auto zigzag = (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+    prev = cur;
+    while (zigzag >= 0x80) {
+      out->push_back(static_cast<uint8_t>(zigzag | 0x80));
+      zigzag >>= 7;
+    }
+    out->push_back(static_cast<uint8_t>(zigzag));
+  }
+}
+
+/*! \return false if the input is corrupted. */
+template <typename T>
+bool DeltaVarintDecode(Span<uint8_t const> in, Span<T> out) {
+  static_assert(std::is_integral<T>::value, "Only integers can be delta encoded.");
+  size_t ip = 0;
+  uint64_t prev = 0;
+  for (auto& v : out) {
+    uint64_t zigzag = 0;
+    int32_t shift = 0;
+    uint8_t byte = 0;
+    do {
+      if (ip == in.size() || shift > 63) {
+        return false;
+      }
+      byte = in[ip++];
+      zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    prev += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+    v = static_cast<T>(prev);
+  }
+  return ip == in.size();
+}
+
+namespace detail {
+size_t WriteLZBlock(Span<uint8_t const> bytes, dmlc::Stream* fo);
+void ReadLZBlock(dmlc::Stream* fi, Span<uint8_t> bytes);
+
+template <typename T>
+void DecodeDelta(Span<uint8_t const> in, Span<T> out, std::true_type) {
+  CHECK(DeltaVarintDecode(in, out)) << "Invalid compressed page.";
+}
+template <typename T>
+void DecodeDelta(Span<uint8_t const>, Span<T>, std::false_type) {
+  LOG(FATAL) << "Invalid codec for non-integral block.";
+}
+}  // namespace detail
+
+/*!
+ * \brief Write an array as a block encoded by `codec`.  The codec is recorded in the block
+ *        so readers don't need to know how the block was written.
+ *
+ * \return Number of bytes written.
+ */
+template <typename T>
+size_t WriteBlock(BlockCodec codec, Span<T const> values, dmlc::Stream* fo) {
+  static_assert(std::is_trivially_copyable<T>::value, "Invalid type for block.");
+  auto codec_value = static_cast<std::underlying_type_t<BlockCodec>>(codec);
+  fo->Write(&codec_value, sizeof(codec_value));
+  uint64_t n = values.size();
+  fo->Write(&n, sizeof(n));
+  size_t bytes = sizeof(codec_value) + sizeof(n);
+  Span<uint8_t const> raw{reinterpret_cast<uint8_t const*>(values.data()), values.size_bytes()};
+  switch (codec) {
+    case BlockCodec::kRaw: {
+      fo->Write(raw.data(), raw.size());
+      bytes += raw.size();
+      break;
+    }
+    case BlockCodec::kLZ: {
+      bytes += detail::WriteLZBlock(raw, fo);
+      break;
+    }
+    case BlockCodec::kDeltaVarint: {
+      // Non integral types like `Entry` can't be delta encoded.
+      LOG(FATAL) << "Use `WriteIntegerBlock` for delta encoding.";
+      break;
+    }
+  }
+  return bytes;
+}
+
+/*! \brief Same as `WriteBlock`, but supports delta encoding. */
+template <typename T>
+size_t WriteIntegerBlock(BlockCodec codec, Span<T const> values, dmlc::Stream* fo) {
+  if (codec != BlockCodec::kDeltaVarint) {
+    return WriteBlock(codec, values, fo);
+  }
+  auto codec_value = static_cast<std::underlying_type_t<BlockCodec>>(codec);
+  fo->Write(&codec_value, sizeof(codec_value));
+  uint64_t n = values.size();
+  fo->Write(&n, sizeof(n));
+  std::vector<uint8_t> encoded;
+  DeltaVarintEncode(values, &encoded);
+  uint64_t n_bytes = encoded.size();
+  fo->Write(&n_bytes, sizeof(n_bytes));
+  fo->Write(encoded.data(), encoded.size());
+  return sizeof(codec_value) + sizeof(n) + sizeof(n_bytes) + encoded.size();
+}
+
+/*!
+ * \brief Read a block written by `WriteBlock` or `WriteIntegerBlock`.
+ *
+ * \return false if the end of stream is reached.
+ */
+template <typename T>
+bool ReadBlock(dmlc::Stream* fi, std::vector<T>* out) {
+  std::underlying_type_t<BlockCodec> codec_value{0};
+  if (fi->Read(&codec_value, sizeof(codec_value)) != sizeof(codec_value)) {
+    return false;
+  }
+  uint64_t n{0};
+  CHECK_EQ(fi->Read(&n, sizeof(n)), sizeof(n)) << "Invalid compressed page.";
+  out->resize(n);
+  Span<uint8_t> raw{reinterpret_cast<uint8_t*>(out->data()), n * sizeof(T)};
+  switch (static_cast<BlockCodec>(codec_value)) {
+    case BlockCodec::kRaw: {
+      CHECK_EQ(fi->Read(raw.data(), raw.size()), raw.size()) << "Invalid compressed page.";
+      break;
+    }
+    case BlockCodec::kLZ: {
+      detail::ReadLZBlock(fi, raw);
+      break;
+    }
+    case BlockCodec::kDeltaVarint: {
+      uint64_t n_bytes{0};
+      CHECK_EQ(fi->Read(&n_bytes, sizeof(n_bytes)), sizeof(n_bytes))
+          << "Invalid compressed page.";
+      std::vector<uint8_t> encoded(n_bytes);
+      CHECK_EQ(fi->Read(encoded.data(), n_bytes), n_bytes) << "Invalid compressed page.";
+      detail::DecodeDelta(Span<uint8_t const>{encoded}, Span<T>{*out}, std::is_integral<T>{});
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unknown codec in compressed page: " << static_cast<int32_t>(codec_value);
+  }
+  return true;
+}
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_COMPRESSION_H_
@@ -6,6 +6,7 @@
 #ifdef XGBOOST_USE_NCCL
 #include <nccl.h>
 #endif  // #ifdef XGBOOST_USE_NCCL
+#include <set>
 #include <sstream>
 
 #include "device_helpers.cuh"
@@ -74,6 +75,41 @@ void AllReducer::Init(int _device_ordinal) {
 #endif  // XGBOOST_USE_NCCL
 }
 
+void AllReducer::InitLocal(std::vector<int> const &devices,
+                           std::vector<std::unique_ptr<AllReducer>> *out) {
+#ifdef XGBOOST_USE_NCCL
+  CHECK(!devices.empty());
+  CHECK_EQ(std::set<int>(devices.cbegin(), devices.cend()).size(), devices.size())
+      << "Each device can be used only once in a process.";
+  auto const n_local = static_cast<int32_t>(devices.size());
+  out->clear();
+  for (auto device : devices) {
+    out->emplace_back(new AllReducer);
+    out->back()->device_ordinal_ = device;
+  }
+  // One id for the whole group.
+  ncclUniqueId id = out->front()->GetUniqueId();
+  int32_t const world = rabit::GetWorldSize() * n_local;
+  int32_t const rank_begin = rabit::GetRank() * n_local;
+  // Initialising multiple ranks from one thread must be grouped.
+  dh::safe_nccl(ncclGroupStart());
+  for (int32_t i = 0; i < n_local; ++i) {
+    auto &reducer = *out->at(i);
+    reducer.id_ = id;
+    dh::safe_cuda(cudaSetDevice(reducer.device_ordinal_));
+    dh::safe_nccl(ncclCommInitRank(&reducer.comm_, world, id, rank_begin + i));
+  }
+  dh::safe_nccl(ncclGroupEnd());
+  for (auto &reducer : *out) {
+    dh::safe_cuda(cudaSetDevice(reducer->device_ordinal_));
+    safe_cuda(cudaStreamCreate(&reducer->stream_));
+    reducer->initialised_ = true;
+  }
+#else
+  LOG(FATAL) << "XGBoost is not compiled with NCCL.";
+#endif  // XGBOOST_USE_NCCL
+}
+
 void AllReducer::AllGather(void const *data, size_t length_bytes,
                            std::vector<size_t> *segments,
                            dh::caching_device_vector<char> *recvbuf) {
@@ -23,7 +23,11 @@
 
 #include <algorithm>
 #include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -315,6 +319,60 @@ void Iota(Container array) {
 }
 
 namespace detail {
+/**
+ * \brief Whether the stream-ordered memory pool of CUDA can be used on current device.
+ *        Configures the pool to keep freed memory on first use.
+ */
+inline bool DeviceMemoryPoolAvailable() {
+#if CUDART_VERSION >= 11020
+  int device = CurrentDevice();
+  int supported = 0;
+  safe_cuda(cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, device));
+  if (!supported) {
+    return false;
+  }
+  static std::mutex lock;
+  static std::set<int> configured;
+  std::lock_guard<std::mutex> guard{lock};
+  if (configured.find(device) == configured.cend()) {
+    cudaMemPool_t pool;
+    safe_cuda(cudaDeviceGetDefaultMemPool(&pool, device));
+    // Don't release memory back to the driver on synchronization.
+    uint64_t threshold = std::numeric_limits<uint64_t>::max();
+    safe_cuda(cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+    configured.insert(device);
+  }
+  return true;
+#else
+  return false;
+#endif  // CUDART_VERSION >= 11020
+}
+
+/** \brief Statistics of the CUDA memory pool on a device, in bytes. */
+struct DeviceMemoryPoolStats {
+  uint64_t reserved { 0 };
+  uint64_t reserved_high { 0 };
+  uint64_t used { 0 };
+  uint64_t used_high { 0 };
+};
+
+inline DeviceMemoryPoolStats GetDeviceMemoryPoolStats(int device) {
+  DeviceMemoryPoolStats stats;
+#if CUDART_VERSION >= 11020
+  int supported = 0;
+  safe_cuda(cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, device));
+  if (supported) {
+    cudaMemPool_t pool;
+    safe_cuda(cudaDeviceGetDefaultMemPool(&pool, device));
+    safe_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReservedMemCurrent, &stats.reserved));
+    safe_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReservedMemHigh, &stats.reserved_high));
+    safe_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrUsedMemCurrent, &stats.used));
+    safe_cuda(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrUsedMemHigh, &stats.used_high));
+  }
+#endif  // CUDART_VERSION >= 11020
+  return stats;
+}
+
 /** \brief Keeps track of global device memory allocations. Thread safe.*/
 class MemoryLogger {
   // Information for a single device
@@ -389,6 +447,11 @@ public:
     LOG(CONSOLE) << "Peak memory usage: "
       << stats_.peak_allocated_bytes / 1048576 << "MiB";
     LOG(CONSOLE) << "Number of allocations: " << stats_.num_allocations;
+    auto pool = GetDeviceMemoryPoolStats(current_device);
+    if (pool.reserved_high != 0) {
+      LOG(CONSOLE) << "Memory pool high water mark: " << pool.used_high / 1048576
+                   << "MiB used, " << pool.reserved_high / 1048576 << "MiB reserved";
+    }
   }
 };
 }  // namespace detail
@@ -430,6 +493,8 @@ inline void ThrowOOMError(std::string const& err, size_t bytes) {
 
 /**
  * \brief Default memory allocator, uses cudaMalloc/Free and logs allocations if verbose.
+ *        When enabled, memory comes from the stream-ordered pool of CUDA on the default
+ *        stream instead, so freed memory is reused without synchronizing the device.
  */
 template <class T>
 struct XGBDefaultDeviceAllocatorImpl : XGBBaseDeviceAllocator<T> {
@@ -442,23 +507,55 @@ struct XGBDefaultDeviceAllocatorImpl : XGBBaseDeviceAllocator<T> {
   };
   pointer allocate(size_t n) {  // NOLINT
     pointer ptr;
-    try {
-      ptr = SuperT::allocate(n);
-      dh::safe_cuda(cudaGetLastError());
-    } catch (const std::exception &e) {
-      ThrowOOMError(e.what(), n * sizeof(T));
+    if (use_pool_) {
+#if CUDART_VERSION >= 11020
+      T* raw_ptr{nullptr};
+      auto errc = cudaMallocAsync(reinterpret_cast<void **>(&raw_ptr), n * sizeof(T), nullptr);
+      if (errc != cudaSuccess) {
+        ThrowOOMError(cudaGetErrorString(errc), n * sizeof(T));
+      }
+      ptr = pointer(raw_ptr);
+#endif  // CUDART_VERSION >= 11020
+    } else {
+      try {
+        ptr = SuperT::allocate(n);
+        dh::safe_cuda(cudaGetLastError());
+      } catch (const std::exception &e) {
+        ThrowOOMError(e.what(), n * sizeof(T));
+      }
     }
     GlobalMemoryLogger().RegisterAllocation(ptr.get(), n * sizeof(T));
     return ptr;
   }
   void deallocate(pointer ptr, size_t n) {  // NOLINT
     GlobalMemoryLogger().RegisterDeallocation(ptr.get(), n * sizeof(T));
-    SuperT::deallocate(ptr, n);
+    if (use_pool_) {
+#if CUDART_VERSION >= 11020
+      auto errc = cudaFreeAsync(ptr.get(), nullptr);
+      // Runtime might have been unloaded before static objects are destroyed.
+      if (errc != cudaErrorCudartUnloading) {
+        safe_cuda(errc);
+      }
+#endif  // CUDART_VERSION >= 11020
+    } else {
+      SuperT::deallocate(ptr, n);
+    }
   }
 #if defined(XGBOOST_USE_RMM) && XGBOOST_USE_RMM == 1
   XGBDefaultDeviceAllocatorImpl()
-    : SuperT(rmm::cuda_stream_default, rmm::mr::get_current_device_resource()) {}
+    : SuperT(rmm::cuda_stream_default, rmm::mr::get_current_device_resource()),
+      use_pool_(!xgboost::GlobalConfigThreadLocalStore::Get()->use_rmm &&
+                xgboost::GlobalConfigThreadLocalStore::Get()->use_device_memory_pool &&
+                DeviceMemoryPoolAvailable()) {}
+#else
+  XGBDefaultDeviceAllocatorImpl()
+      : use_pool_(xgboost::GlobalConfigThreadLocalStore::Get()->use_device_memory_pool &&
+                  DeviceMemoryPoolAvailable()) {}
 #endif  // defined(XGBOOST_USE_RMM) && XGBOOST_USE_RMM == 1
+
+ private:
+  // Decided on construction, memory must be freed the same way it's allocated.
+  bool use_pool_{false};
 };
 
 /**
@@ -763,6 +860,18 @@ class AllReducer {
    */
   void Init(int _device_ordinal);
 
+  /**
+   * \brief Initialise one reducer for each of the devices driven by this process.  All of
+   *        them join a single communication group with the devices of other workers, ranks
+   *        are ordered by worker first and then by position in `devices`.  Collective calls
+   *        must be made concurrently, with one host thread for each device.
+   *
+   * \param devices Device ordinals used by this process.
+   * \param out     Initialised reducers, one for each device.
+   */
+  static void InitLocal(std::vector<int> const& devices,
+                        std::vector<std::unique_ptr<AllReducer>>* out);
+
   ~AllReducer();
 
   /**
@@ -991,6 +1100,45 @@ XGBOOST_DEVICE auto tcrend(xgboost::common::Span<T> const &span) {  // NOLINT
   return tcrbegin(span) + span.size();
 }
 
+namespace detail {
+// Wrapper around cub sort for easier `descending` sort.
+template <bool descending, typename KeyT, typename ValueT,
+          typename BeginOffsetIteratorT, typename EndOffsetIteratorT>
+void DeviceSegmentedRadixSortPair(
+    void *d_temp_storage, size_t &temp_storage_bytes, const KeyT *d_keys_in, // NOLINT
+    KeyT *d_keys_out, const ValueT *d_values_in, ValueT *d_values_out,
+    size_t num_items, size_t num_segments, BeginOffsetIteratorT d_begin_offsets,
+    EndOffsetIteratorT d_end_offsets, int begin_bit = 0,
+    int end_bit = sizeof(KeyT) * 8) {
+  cub::DoubleBuffer<KeyT> d_keys(const_cast<KeyT *>(d_keys_in), d_keys_out);
+  cub::DoubleBuffer<ValueT> d_values(const_cast<ValueT *>(d_values_in),
+                                     d_values_out);
+  // In old version of cub, num_items in dispatch is also int32_t, no way to change.
+  using OffsetT =
+      std::conditional_t<BuildWithCUDACub() && HasThrustMinorVer<13>(), size_t,
+                         int32_t>;
+  CHECK_LE(num_items, std::numeric_limits<OffsetT>::max());
+  // For Thrust >= 1.12 or CUDA >= 11.4, we require system cub installation
+
+#if (THRUST_MAJOR_VERSION == 1 && THRUST_MINOR_VERSION >= 13) || THRUST_MAJOR_VERSION > 1
+  safe_cuda((cub::DispatchSegmentedRadixSort<
+             descending, KeyT, ValueT, BeginOffsetIteratorT, EndOffsetIteratorT,
+             OffsetT>::Dispatch(d_temp_storage, temp_storage_bytes, d_keys,
+                                d_values, num_items, num_segments,
+                                d_begin_offsets, d_end_offsets, begin_bit,
+                                end_bit, false, nullptr, false)));
+#else
+  safe_cuda((cub::DispatchSegmentedRadixSort<
+             descending, KeyT, ValueT, BeginOffsetIteratorT,
+             OffsetT>::Dispatch(d_temp_storage, temp_storage_bytes, d_keys,
+                                d_values, num_items, num_segments,
+                                d_begin_offsets, d_end_offsets, begin_bit,
+                                end_bit, false, nullptr, false)));
+#endif
+
+}
+}  // namespace detail
+
 // This type sorts an array which is divided into multiple groups. The sorting is influenced
 // by the function object 'Comparator'
 template <typename T>
@@ -1011,6 +1159,10 @@ class SegmentSorter {
   // Where did the item that was originally present at position 'x' move to after they are sorted
   caching_device_vector<uint32_t> dindexable_sorted_pos_;
 
+  // Input positions and temporary storage of the segmented radix sort, kept across sorts
+  caching_device_vector<uint32_t> dsequence_;
+  caching_device_vector<char> dtemp_storage_;
+
   // Initialize everything but the segments
   void Init(uint32_t num_elems) {
     ditems_.resize(num_elems);
@@ -1149,6 +1301,38 @@ class SegmentSorter {
                    thrust::device_ptr<const T>(ditems), ditems_.begin());
   }
 
+  // Sort an array descendingly within the groups given by the group pointer on the device,
+  // using a single segmented radix sort. Unlike SortItems, the group segments are not
+  // computed, and the buffers including the temporary storage of the sort are reused by the
+  // next call, so sorting a new array of the same layout allocates nothing.
+  void SortItemsSegmented(const T *ditems, uint32_t item_size,
+                          const xgboost::common::Span<const uint32_t> &dgroups) {
+    CHECK_GE(dgroups.size(), 1ul);
+    dgroups_.resize(dgroups.size());
+    thrust::copy(dh::tcbegin(dgroups), dh::tcend(dgroups), dgroups_.begin());
+    ditems_.resize(item_size);
+    doriginal_pos_.resize(item_size);
+    if (dsequence_.size() != item_size) {
+      dsequence_.resize(item_size);
+      thrust::sequence(dsequence_.begin(), dsequence_.end());
+    }
+
+    size_t n_groups = dgroups_.size() - 1;
+    const uint32_t *d_begin = dgroups_.data().get();
+    size_t bytes = 0;
+    detail::DeviceSegmentedRadixSortPair<true>(
+        nullptr, bytes, ditems, ditems_.data().get(), dsequence_.data().get(),
+        doriginal_pos_.data().get(), item_size, n_groups, d_begin, d_begin + 1);
+    if (dtemp_storage_.size() < bytes) {
+      dtemp_storage_.resize(bytes);
+    }
+    bytes = dtemp_storage_.size();
+    detail::DeviceSegmentedRadixSortPair<true>(
+        dtemp_storage_.data().get(), bytes, ditems, ditems_.data().get(),
+        dsequence_.data().get(), doriginal_pos_.data().get(), item_size, n_groups, d_begin,
+        d_begin + 1);
+  }
+
   // Determine where an item that was originally present at position 'x' has been relocated to
   // after a sort. Creation of such an index has to be explicitly requested after a sort
   void CreateIndexableSortedPositions() {
@@ -1463,45 +1647,6 @@ void ArgSort(xgboost::common::Span<U> keys, xgboost::common::Span<IdxT> sorted_i
                             sorted_idx.size_bytes(), cudaMemcpyDeviceToDevice));
 }
 
-namespace detail {
-// Wrapper around cub sort for easier `descending` sort.
-template <bool descending, typename KeyT, typename ValueT,
-          typename BeginOffsetIteratorT, typename EndOffsetIteratorT>
-void DeviceSegmentedRadixSortPair(
-    void *d_temp_storage, size_t &temp_storage_bytes, const KeyT *d_keys_in, // NOLINT
-    KeyT *d_keys_out, const ValueT *d_values_in, ValueT *d_values_out,
-    size_t num_items, size_t num_segments, BeginOffsetIteratorT d_begin_offsets,
-    EndOffsetIteratorT d_end_offsets, int begin_bit = 0,
-    int end_bit = sizeof(KeyT) * 8) {
-  cub::DoubleBuffer<KeyT> d_keys(const_cast<KeyT *>(d_keys_in), d_keys_out);
-  cub::DoubleBuffer<ValueT> d_values(const_cast<ValueT *>(d_values_in),
-                                     d_values_out);
-  // In old version of cub, num_items in dispatch is also int32_t, no way to change.
-  using OffsetT =
-      std::conditional_t<BuildWithCUDACub() && HasThrustMinorVer<13>(), size_t,
-                         int32_t>;
-  CHECK_LE(num_items, std::numeric_limits<OffsetT>::max());
-  // For Thrust >= 1.12 or CUDA >= 11.4, we require system cub installation
-
-#if (THRUST_MAJOR_VERSION == 1 && THRUST_MINOR_VERSION >= 13) || THRUST_MAJOR_VERSION > 1
-  safe_cuda((cub::DispatchSegmentedRadixSort<
-             descending, KeyT, ValueT, BeginOffsetIteratorT, EndOffsetIteratorT,
-             OffsetT>::Dispatch(d_temp_storage, temp_storage_bytes, d_keys,
-                                d_values, num_items, num_segments,
-                                d_begin_offsets, d_end_offsets, begin_bit,
-                                end_bit, false, nullptr, false)));
-#else
-  safe_cuda((cub::DispatchSegmentedRadixSort<
-             descending, KeyT, ValueT, BeginOffsetIteratorT,
-             OffsetT>::Dispatch(d_temp_storage, temp_storage_bytes, d_keys,
-                                d_values, num_items, num_segments,
-                                d_begin_offsets, d_end_offsets, begin_bit,
-                                end_bit, false, nullptr, false)));
-#endif
-
-}
-}  // namespace detail
-
 template <bool accending, typename U, typename V, typename IdxT>
 void SegmentedArgSort(xgboost::common::Span<U> values,
                       xgboost::common::Span<V> group_ptr,
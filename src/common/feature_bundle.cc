@@ -0,0 +1,245 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file feature_bundle.cc
+ */
+#include "feature_bundle.h"
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+
+#include "bitfield.h"
+#include "categorical.h"
+#include "threading_utils.h"
+
+namespace xgboost {
+namespace common {
+constexpr uint32_t FeatureBundles::kMaxBundleBins;
+constexpr size_t FeatureBundles::kMaxOpenBundles;
+constexpr double FeatureBundles::kMaxNonDefaultRatio;
+
+namespace {
+struct OpenBundle {
+  std::vector<bst_feature_t> features;
+  size_t n_entries{0};
+  uint32_t n_bins{0};
+  std::vector<LBitField64::value_type> storage;
+  LBitField64 rows;
+
+  explicit OpenBundle(size_t n_rows)
+      : storage(LBitField64::ComputeStorageSize(n_rows), 0), rows{Span<uint64_t>{storage}} {}
+  OpenBundle(OpenBundle const &that) = delete;
+  OpenBundle(OpenBundle &&that) = delete;
+};
+}  // anonymous namespace
+
+FeatureBundles::FeatureBundles(GHistIndexMatrix const &gmat, Span<FeatureType const> ft,
+                               int32_t n_threads) {
+  CHECK(gmat.IsDense()) << "Feature bundling requires dense data.";
+  CHECK_EQ(gmat.base_rowid, 0) << "Feature bundling requires a single page.";
+  auto const &ptrs = gmat.cut.Ptrs();
+  cut_ptr_ = ptrs;
+  auto n_features = static_cast<bst_feature_t>(ptrs.size() - 1);
+  size_t n_rows = gmat.Size();
+
+  // Choose the most frequent bin of each feature as its default bin.
+  std::vector<uint32_t> dft(n_features);
+  std::vector<size_t> n_entries(n_features);
+  std::vector<bst_feature_t> candidates;
+  for (bst_feature_t f = 0; f < n_features; ++f) {
+    auto beg = gmat.hit_count.cbegin() + ptrs[f];
+    auto end = gmat.hit_count.cbegin() + ptrs[f + 1];
+    dft[f] = ptrs[f] + static_cast<uint32_t>(std::max_element(beg, end) - beg);
+    n_entries[f] = n_rows - gmat.hit_count[dft[f]];
+    if (!IsCat(ft, f) && ptrs[f + 1] - ptrs[f] <= kMaxBundleBins &&
+        static_cast<double>(n_entries[f]) <= kMaxNonDefaultRatio * static_cast<double>(n_rows)) {
+      candidates.push_back(f);
+    }
+  }
+
+  // Rows with non-default bins of each candidate, sorted.
+  std::vector<size_t> entry_ptr(n_features + 1, 0);
+  for (auto f : candidates) {
+    entry_ptr[f + 1] = n_entries[f];
+  }
+  std::partial_sum(entry_ptr.cbegin(), entry_ptr.cend(), entry_ptr.begin());
+  std::vector<size_t> entries(entry_ptr.back());
+  {
+    auto n_blocks = static_cast<size_t>(std::max(n_threads, 1));
+    auto block_size = DivRoundUp(n_rows, n_blocks);
+    // Position of each block within rows of each candidate.
+    std::vector<size_t> pos(n_blocks * candidates.size(), 0);
+    auto for_each_entry = [&](size_t block, auto &&fn) {
+      auto rbeg = std::min(block * block_size, n_rows);
+      auto rend = std::min(rbeg + block_size, n_rows);
+      for (size_t r = rbeg; r < rend; ++r) {
+        for (size_t i = 0; i < candidates.size(); ++i) {
+          auto f = candidates[i];
+          if (gmat.index[r * n_features + f] != dft[f]) {
+            fn(r, i);
+          }
+        }
+      }
+    };
+    ParallelFor(n_blocks, n_threads, [&](size_t block) {
+      auto *p_pos = pos.data() + block * candidates.size();
+      for_each_entry(block, [&](size_t, size_t i) { ++p_pos[i]; });
+    });
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      size_t offset = entry_ptr[candidates[i]];
+      for (size_t block = 0; block < n_blocks; ++block) {
+        auto n = pos[block * candidates.size() + i];
+        pos[block * candidates.size() + i] = offset;
+        offset += n;
+      }
+    }
+    ParallelFor(n_blocks, n_threads, [&](size_t block) {
+      auto *p_pos = pos.data() + block * candidates.size();
+      for_each_entry(block, [&](size_t r, size_t i) { entries[p_pos[i]++] = r; });
+    });
+  }
+
+  // Greedily add features to the first open bundle without conflict, features with more
+  // entries first.
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [&](bst_feature_t l, bst_feature_t r) { return n_entries[l] > n_entries[r]; });
+  std::vector<std::unique_ptr<OpenBundle>> open;
+  for (auto f : candidates) {
+    auto f_bins = ptrs[f + 1] - ptrs[f];
+    auto f_beg = entries.cbegin() + entry_ptr[f];
+    auto f_end = entries.cbegin() + entry_ptr[f + 1];
+    OpenBundle *p_bundle = nullptr;
+    for (auto &bundle : open) {
+      if (bundle->n_entries + n_entries[f] > n_rows ||
+          bundle->n_bins + f_bins - 1 > kMaxBundleBins) {
+        continue;
+      }
+      auto const &rows = bundle->rows;
+      if (std::none_of(f_beg, f_end, [&](size_t r) { return rows.Check(r); })) {
+        p_bundle = bundle.get();
+        break;
+      }
+    }
+    if (!p_bundle) {
+      if (open.size() == kMaxOpenBundles) {
+        continue;
+      }
+      open.emplace_back(new OpenBundle{n_rows});
+      p_bundle = open.back().get();
+      p_bundle->n_bins = 1;
+    }
+    p_bundle->features.push_back(f);
+    p_bundle->n_entries += n_entries[f];
+    p_bundle->n_bins += f_bins - 1;
+    std::for_each(f_beg, f_end, [&](size_t r) { p_bundle->rows.Set(r); });
+  }
+
+  // Bundles are ordered by their first feature, features not bundled with others form
+  // their own bundles.
+  feature_bundle_.resize(n_features);
+  default_bin_.resize(n_features, -1);
+  std::vector<OpenBundle const *> bundle_of(n_features, nullptr);
+  for (auto const &bundle : open) {
+    if (bundle->features.size() > 1) {
+      std::sort(bundle->features.begin(), bundle->features.end());
+      for (auto f : bundle->features) {
+        bundle_of[f] = bundle.get();
+      }
+    }
+  }
+  bin_map_.resize(ptrs.back());
+  bundle_ptr_ = {0};
+  for (bst_feature_t f = 0; f < n_features; ++f) {
+    auto const *bundle = bundle_of[f];
+    if (!bundle) {
+      feature_bundle_[f] = NumBundles();
+      for (auto i = ptrs[f]; i < ptrs[f + 1]; ++i) {
+        bin_map_[i] = bundle_ptr_.back() + (i - ptrs[f]);
+      }
+      bundle_ptr_.push_back(bundle_ptr_.back() + (ptrs[f + 1] - ptrs[f]));
+    } else if (bundle->features.front() == f) {
+      auto b = static_cast<uint32_t>(NumBundles());
+      auto pos = bundle_ptr_.back();
+      ++pos;  // bin of rows with all features in their default bins
+      for (auto bf : bundle->features) {
+        feature_bundle_[bf] = b;
+        default_bin_[bf] = static_cast<int32_t>(dft[bf]);
+        for (auto i = ptrs[bf]; i < ptrs[bf + 1]; ++i) {
+          bin_map_[i] = i == dft[bf] ? bundle_ptr_.back() : pos++;
+        }
+      }
+      bundle_ptr_.push_back(pos);
+    }
+  }
+
+  // Build the bundled index.
+  auto n_bundles = this->NumBundles();
+  index_.cut.cut_ptrs_.HostVector() = bundle_ptr_;
+  index_.cut.cut_values_.HostVector().resize(bundle_ptr_.back(), 0.0f);
+  index_.cut.min_vals_.HostVector().resize(n_bundles, 0.0f);
+  index_.p_fmat = gmat.p_fmat;
+  index_.base_rowid = 0;
+  index_.SetDense(true);
+  index_.max_num_bins = 0;
+  for (size_t b = 0; b < n_bundles; ++b) {
+    index_.max_num_bins =
+        std::max(index_.max_num_bins, static_cast<size_t>(bundle_ptr_[b + 1] - bundle_ptr_[b]));
+  }
+  index_.row_ptr.resize(n_rows + 1);
+  for (size_t r = 0; r <= n_rows; ++r) {
+    index_.row_ptr[r] = r * n_bundles;
+  }
+  index_.ResizeIndex(n_rows * n_bundles, true);
+  index_.index.ResizeOffset(n_bundles);
+  std::copy(bundle_ptr_.cbegin(), bundle_ptr_.cend() - 1, index_.index.Offset());
+
+  auto fill = [&](auto *data) {
+    using BinIdxType = std::remove_pointer_t<decltype(data)>;
+    ParallelFor(n_rows, n_threads, [&](size_t r) {
+      auto *row = data + r * n_bundles;
+      std::fill_n(row, n_bundles, 0);
+      for (bst_feature_t f = 0; f < n_features; ++f) {
+        auto bin = gmat.index[r * n_features + f];
+        if (default_bin_[f] < 0 || bin != static_cast<uint32_t>(default_bin_[f])) {
+          auto b = feature_bundle_[f];
+          row[b] = static_cast<BinIdxType>(bin_map_[bin] - bundle_ptr_[b]);
+        }
+      }
+    });
+  };
+  switch (index_.index.GetBinTypeSize()) {
+    case kUint8BinsTypeSize:
+      fill(index_.index.data<uint8_t>());
+      break;
+    case kUint16BinsTypeSize:
+      fill(index_.index.data<uint16_t>());
+      break;
+    case kUint32BinsTypeSize:
+      fill(index_.index.data<uint32_t>());
+      break;
+    default:
+      CHECK(false);  // no default behavior
+  }
+
+  index_.hit_count.resize(bundle_ptr_.back(), 0);
+  for (bst_feature_t f = 0; f < n_features; ++f) {
+    for (auto i = ptrs[f]; i < ptrs[f + 1]; ++i) {
+      if (default_bin_[f] < 0 || i != static_cast<uint32_t>(default_bin_[f])) {
+        index_.hit_count[bin_map_[i]] += gmat.hit_count[i];
+      }
+    }
+  }
+  for (size_t b = 0; b < n_bundles; ++b) {
+    if (bundle_ptr_[b + 1] - bundle_ptr_[b] == 0) {
+      continue;
+    }
+    auto beg = index_.hit_count.cbegin() + bundle_ptr_[b];
+    auto end = index_.hit_count.cbegin() + bundle_ptr_[b + 1];
+    auto n_hits = std::accumulate(beg, end, static_cast<size_t>(0));
+    // The shared bin of a bundle has no entry from features.
+    index_.hit_count[bundle_ptr_[b]] += n_rows - n_hits;
+  }
+}
+}  // namespace common
+}  // namespace xgboost
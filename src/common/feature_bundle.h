@@ -0,0 +1,102 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file feature_bundle.h
+ * \brief Exclusive feature bundling for building histograms of dense quantized data.
+ */
+#ifndef XGBOOST_COMMON_FEATURE_BUNDLE_H_
+#define XGBOOST_COMMON_FEATURE_BUNDLE_H_
+
+#include <xgboost/span.h>
+
+#include <utility>
+#include <vector>
+
+#include "hist_util.h"
+#include "../data/gradient_index.h"
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief Merge mutually exclusive features into bundles, so that histograms are built on
+ *        one bin per bundle for each row instead of one bin per feature.
+ *
+ *   Only numerical features where most rows fall into the same bin (the default bin,
+ *   typically the zero of one-hot encoded data) are bundled.  A bundle with more than one
+ *   feature has a shared bin for rows where all its features are in their default bins,
+ *   followed by the other bins of each feature.  Features in a bundle never have
+ *   non-default bins in the same row, so the default bin of a feature is recovered from
+ *   the sum of the bundle minus the other bins of that feature.  Other features form
+ *   bundles of their own with unchanged bins.
+ */
+class FeatureBundles {
+  // Bundle of each feature.
+  std::vector<uint32_t> feature_bundle_;
+  // Default bin of each feature that shares its bundle with others, -1 otherwise.
+  std::vector<int32_t> default_bin_;
+  // Bundled bin of each bin in the original index.
+  std::vector<uint32_t> bin_map_;
+  // Range of bundled bins for each bundle.
+  std::vector<uint32_t> bundle_ptr_;
+  // Original bins of the source index, for recovering bins of a feature.
+  std::vector<uint32_t> cut_ptr_;
+  GHistIndexMatrix index_;
+
+ public:
+  /*! \brief Upper bound of bins in a bundle with more than one feature. */
+  static constexpr uint32_t kMaxBundleBins = 256;
+  /*! \brief Number of bundles searched for a feature, each of them keeps a row bitset. */
+  static constexpr size_t kMaxOpenBundles = 128;
+  /*! \brief Features with non-default bins in more than this ratio of rows are not bundled. */
+  static constexpr double kMaxNonDefaultRatio = 0.2;
+
+  /**
+   * \param gmat      A dense index with a single page.
+   * \param ft        Feature types, categorical features are not bundled.
+   * \param n_threads Number of threads used to build the bundled index.
+   */
+  FeatureBundles(GHistIndexMatrix const &gmat, Span<FeatureType const> ft, int32_t n_threads);
+
+  size_t NumBundles() const { return bundle_ptr_.size() - 1; }
+  size_t NumFeatures() const { return feature_bundle_.size(); }
+  /*! \brief Index of bundled bins, a dense index with one bundle for each column. */
+  GHistIndexMatrix const &Index() const { return index_; }
+  /*! \brief Whether the feature shares its bundle with other features. */
+  bool IsBundled(bst_feature_t fidx) const { return default_bin_[fidx] >= 0; }
+  /*! \brief First bundled bin of a feature that is not bundled with others. */
+  uint32_t FeatureBegin(bst_feature_t fidx) const { return bin_map_[cut_ptr_[fidx]]; }
+  /*! \brief Range of bundled bins for the bundle containing the feature. */
+  std::pair<uint32_t, uint32_t> BundleRange(bst_feature_t fidx) const {
+    auto b = feature_bundle_[fidx];
+    return {bundle_ptr_[b], bundle_ptr_[b + 1]};
+  }
+
+  /**
+   * \brief Recover histogram of a bundled feature.
+   *
+   * \param fidx Feature index, must be bundled with other features.
+   * \param get  Function returning the statistic of a bundled bin.
+   * \param out  Histogram of the feature, with its number of bins in the original index.
+   */
+  template <typename GradientT, typename Get>
+  void Unbundle(bst_feature_t fidx, Get &&get, Span<GradientT> out) const {
+    auto range = this->BundleRange(fidx);
+    GradientT total;
+    for (auto i = range.first; i < range.second; ++i) {
+      total += get(i);
+    }
+    auto beg = cut_ptr_[fidx];
+    auto end = cut_ptr_[fidx + 1];
+    auto dft = static_cast<uint32_t>(default_bin_[fidx]);
+    for (auto i = beg; i < end; ++i) {
+      if (i == dft) {
+        continue;
+      }
+      out[i - beg] = get(bin_map_[i]);
+      total -= out[i - beg];
+    }
+    out[dft - beg] = total;
+  }
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_FEATURE_BUNDLE_H_
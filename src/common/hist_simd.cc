@@ -0,0 +1,244 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "hist_simd.h"
+
+#include <cstring>
+
+#include "xgboost/logging.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XGBOOST_SIMD_HIST 1
+#else
+#define XGBOOST_SIMD_HIST 0
+#endif  // defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+// NEON is part of the AArch64 baseline, no runtime detection is needed.
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define XGBOOST_NEON_HIST 1
+#else
+#define XGBOOST_NEON_HIST 0
+#endif  // defined(__aarch64__) && defined(__ARM_NEON)
+
+namespace xgboost {
+namespace common {
+namespace {
+// Number of features processed by each iteration of the vectorized loop.
+constexpr size_t kSimdFeatures = 8;
+
+template <typename FPType, typename BinIdxType>
+void AddDenseRowScalar(BinIdxType const* gr_index, uint32_t const* offsets, size_t begin,
+                       size_t end, float const* gh, FPType* hist) {
+  for (size_t j = begin; j < end; ++j) {
+    uint32_t const idx_bin = 2 * (static_cast<uint32_t>(gr_index[j]) + offsets[j]);
+    hist[idx_bin] += static_cast<FPType>(gh[0]);
+    hist[idx_bin + 1] += static_cast<FPType>(gh[1]);
+  }
+}
+
+#if XGBOOST_SIMD_HIST
+// Load 8 bin indices and add feature offsets.
+__attribute__((target("avx512f")))
+inline __m256i LoadBins(uint8_t const* gr_index, uint32_t const* offsets) {
+  __m256i bins = _mm256_cvtepu8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<__m128i const*>(gr_index)));
+  return _mm256_add_epi32(bins, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(offsets)));
+}
+
+__attribute__((target("avx512f")))
+inline __m256i LoadBins(uint16_t const* gr_index, uint32_t const* offsets) {
+  __m256i bins = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<__m128i const*>(gr_index)));
+  return _mm256_add_epi32(bins, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(offsets)));
+}
+
+__attribute__((target("avx512f")))
+inline __m256i LoadBins(uint32_t const* gr_index, uint32_t const* offsets) {
+  __m256i bins = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(gr_index));
+  return _mm256_add_epi32(bins, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(offsets)));
+}
+
+template <typename BinIdxType>
+__attribute__((target("avx512f")))
+void AddDenseRowAVX512(BinIdxType const* gr_index, uint32_t const* offsets, size_t n_features,
+                       float const* gh, float* hist) {
+  // Gradient and hessian interleaved, (g, h) repeated 8 times.
+  int64_t gh_bits;
+  std::memcpy(&gh_bits, gh, sizeof(gh_bits));
+  __m512 const v_gh = _mm512_castsi512_ps(_mm512_set1_epi64(gh_bits));
+  // Each bin is expanded into 2 lanes for gradient and hessian.
+  __m512i const expand =
+      _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+  __m512i const interleave =
+      _mm512_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1);
+  size_t const n_simd = n_features - n_features % kSimdFeatures;
+  for (size_t j = 0; j < n_simd; j += kSimdFeatures) {
+    __m256i bins = _mm256_slli_epi32(LoadBins(gr_index + j, offsets + j), 1);
+    __m512i idx = _mm512_add_epi32(
+        _mm512_permutexvar_epi32(expand, _mm512_castsi256_si512(bins)), interleave);
+    __m512 v = _mm512_i32gather_ps(idx, hist, sizeof(float));
+    _mm512_i32scatter_ps(hist, idx, _mm512_add_ps(v, v_gh), sizeof(float));
+  }
+  AddDenseRowScalar(gr_index, offsets, n_simd, n_features, gh, hist);
+}
+
+template <typename BinIdxType>
+__attribute__((target("avx512f")))
+void AddDenseRowAVX512(BinIdxType const* gr_index, uint32_t const* offsets, size_t n_features,
+                       float const* gh, double* hist) {
+  __m512d const v_gh = _mm512_set4_pd(gh[1], gh[0], gh[1], gh[0]);
+  __m256i const expand_low = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  __m256i const expand_high = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+  __m256i const interleave = _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1);
+  size_t const n_simd = n_features - n_features % kSimdFeatures;
+  for (size_t j = 0; j < n_simd; j += kSimdFeatures) {
+    __m256i bins = _mm256_slli_epi32(LoadBins(gr_index + j, offsets + j), 1);
+    __m256i idx_low =
+        _mm256_add_epi32(_mm256_permutevar8x32_epi32(bins, expand_low), interleave);
+    __m256i idx_high =
+        _mm256_add_epi32(_mm256_permutevar8x32_epi32(bins, expand_high), interleave);
+    __m512d low = _mm512_i32gather_pd(idx_low, hist, sizeof(double));
+    __m512d high = _mm512_i32gather_pd(idx_high, hist, sizeof(double));
+    _mm512_i32scatter_pd(hist, idx_low, _mm512_add_pd(low, v_gh), sizeof(double));
+    _mm512_i32scatter_pd(hist, idx_high, _mm512_add_pd(high, v_gh), sizeof(double));
+  }
+  AddDenseRowScalar(gr_index, offsets, n_simd, n_features, gh, hist);
+}
+
+// Quantized gradient, each float holds an integer.
+template <typename BinIdxType>
+__attribute__((target("avx512f")))
+void AddDenseRowAVX512(BinIdxType const* gr_index, uint32_t const* offsets, size_t n_features,
+                       float const* gh, int64_t* hist) {
+  __m512i const v_gh =
+      _mm512_set4_epi64(static_cast<int64_t>(gh[1]), static_cast<int64_t>(gh[0]),
+                        static_cast<int64_t>(gh[1]), static_cast<int64_t>(gh[0]));
+  __m256i const expand_low = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  __m256i const expand_high = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+  __m256i const interleave = _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1);
+  size_t const n_simd = n_features - n_features % kSimdFeatures;
+  for (size_t j = 0; j < n_simd; j += kSimdFeatures) {
+    __m256i bins = _mm256_slli_epi32(LoadBins(gr_index + j, offsets + j), 1);
+    __m256i idx_low =
+        _mm256_add_epi32(_mm256_permutevar8x32_epi32(bins, expand_low), interleave);
+    __m256i idx_high =
+        _mm256_add_epi32(_mm256_permutevar8x32_epi32(bins, expand_high), interleave);
+    __m512i low = _mm512_i32gather_epi64(idx_low, hist, sizeof(int64_t));
+    __m512i high = _mm512_i32gather_epi64(idx_high, hist, sizeof(int64_t));
+    _mm512_i32scatter_epi64(hist, idx_low, _mm512_add_epi64(low, v_gh), sizeof(int64_t));
+    _mm512_i32scatter_epi64(hist, idx_high, _mm512_add_epi64(high, v_gh), sizeof(int64_t));
+  }
+  AddDenseRowScalar(gr_index, offsets, n_simd, n_features, gh, hist);
+}
+#endif  // XGBOOST_SIMD_HIST
+
+#if XGBOOST_NEON_HIST
+// NEON has no gather or scatter.  Bin indices of 8 features are computed with vector
+// instructions, then gradient and hessian are added to each bin as a single vector.
+inline void StoreBins(uint32x4_t low, uint32x4_t high, uint32_t const* offsets,
+                      uint32_t* out) {
+  vst1q_u32(out, vshlq_n_u32(vaddq_u32(low, vld1q_u32(offsets)), 1));
+  vst1q_u32(out + 4, vshlq_n_u32(vaddq_u32(high, vld1q_u32(offsets + 4)), 1));
+}
+
+inline void LoadBins(uint8_t const* gr_index, uint32_t const* offsets, uint32_t* out) {
+  uint16x8_t bins = vmovl_u8(vld1_u8(gr_index));
+  StoreBins(vmovl_u16(vget_low_u16(bins)), vmovl_u16(vget_high_u16(bins)), offsets, out);
+}
+
+inline void LoadBins(uint16_t const* gr_index, uint32_t const* offsets, uint32_t* out) {
+  uint16x8_t bins = vld1q_u16(gr_index);
+  StoreBins(vmovl_u16(vget_low_u16(bins)), vmovl_u16(vget_high_u16(bins)), offsets, out);
+}
+
+inline void LoadBins(uint32_t const* gr_index, uint32_t const* offsets, uint32_t* out) {
+  StoreBins(vld1q_u32(gr_index), vld1q_u32(gr_index + 4), offsets, out);
+}
+
+inline float32x2_t LoadGradient(float const* gh, float*) { return vld1_f32(gh); }
+inline float64x2_t LoadGradient(float const* gh, double*) { return vcvt_f64_f32(vld1_f32(gh)); }
+// Quantized gradient, each float holds an integer.
+inline int64x2_t LoadGradient(float const* gh, int64_t*) {
+  return vcvtq_s64_f64(vcvt_f64_f32(vld1_f32(gh)));
+}
+
+inline void AddGradient(float32x2_t gh, float* bin) { vst1_f32(bin, vadd_f32(vld1_f32(bin), gh)); }
+inline void AddGradient(float64x2_t gh, double* bin) {
+  vst1q_f64(bin, vaddq_f64(vld1q_f64(bin), gh));
+}
+inline void AddGradient(int64x2_t gh, int64_t* bin) {
+  vst1q_s64(bin, vaddq_s64(vld1q_s64(bin), gh));
+}
+
+template <typename FPType, typename BinIdxType>
+void AddDenseRowNEON(BinIdxType const* gr_index, uint32_t const* offsets, size_t n_features,
+                     float const* gh, FPType* hist) {
+  auto const v_gh = LoadGradient(gh, hist);
+  uint32_t bins[kSimdFeatures];
+  size_t const n_simd = n_features - n_features % kSimdFeatures;
+  for (size_t j = 0; j < n_simd; j += kSimdFeatures) {
+    LoadBins(gr_index + j, offsets + j, bins);
+    for (size_t k = 0; k < kSimdFeatures; ++k) {
+      AddGradient(v_gh, hist + bins[k]);
+    }
+  }
+  for (size_t j = n_simd; j < n_features; ++j) {
+    AddGradient(v_gh, hist + 2 * (static_cast<uint32_t>(gr_index[j]) + offsets[j]));
+  }
+}
+#endif  // XGBOOST_NEON_HIST
+
+bool DetectSupport() {
+#if XGBOOST_SIMD_HIST
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f");
+#elif XGBOOST_NEON_HIST
+  return true;
+#else
+  return false;
+#endif  // XGBOOST_SIMD_HIST
+}
+}  // anonymous namespace
+
+bool DenseHistSimdSupported() {
+  static bool const supported = DetectSupport();
+  return supported;
+}
+
+template <typename FPType, typename BinIdxType>
+void AddDenseRowSimd(BinIdxType const* gr_index, uint32_t const* offsets, size_t n_features,
+                     float const* gh, FPType* hist) {
+#if XGBOOST_SIMD_HIST
+  if (DenseHistSimdSupported()) {
+    AddDenseRowAVX512(gr_index, offsets, n_features, gh, hist);
+    return;
+  }
+#elif XGBOOST_NEON_HIST
+  AddDenseRowNEON(gr_index, offsets, n_features, gh, hist);
+  return;
+#endif  // XGBOOST_SIMD_HIST
+  LOG(FATAL) << "SIMD histogram is not supported on current CPU.";
+}
+
+template void AddDenseRowSimd(uint8_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, float* hist);
+template void AddDenseRowSimd(uint16_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, float* hist);
+template void AddDenseRowSimd(uint32_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, float* hist);
+template void AddDenseRowSimd(uint8_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, double* hist);
+template void AddDenseRowSimd(uint16_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, double* hist);
+template void AddDenseRowSimd(uint32_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, double* hist);
+template void AddDenseRowSimd(uint8_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, int64_t* hist);
+template void AddDenseRowSimd(uint16_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, int64_t* hist);
+template void AddDenseRowSimd(uint32_t const* gr_index, uint32_t const* offsets,
+                              size_t n_features, float const* gh, int64_t* hist);
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,37 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file hist_simd.h
+ * \brief Accumulate gradient of dense rows into histogram with SIMD instructions.
+ */
+#ifndef XGBOOST_COMMON_HIST_SIMD_H_
+#define XGBOOST_COMMON_HIST_SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief Whether `AddDenseRowSimd` is supported by current CPU.  AVX-512 is detected at
+ *        runtime, while NEON is always available on AArch64.
+ */
+bool DenseHistSimdSupported();
+
+/**
+ * \brief Add gradient pair of a dense row to histogram.  Each feature of a dense row falls
+ *        into a distinct bin, so bins of a row can be gathered, accumulated and scattered
+ *        without conflict.
+ *
+ * \param gr_index   Bin index of each feature relative to the feature offset.
+ * \param offsets    Offset of the first bin for each feature.
+ * \param n_features Number of features in the row.
+ * \param gh         Gradient and hessian of the row, holding integers for integer histogram.
+ * \param hist       Histogram with gradient and hessian interleaved, must have less than
+ *                   2^30 bins.
+ */
+template <typename FPType, typename BinIdxType>
+void AddDenseRowSimd(BinIdxType const* gr_index, uint32_t const* offsets, size_t n_features,
+                     float const* gh, FPType* hist);
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_HIST_SIMD_H_
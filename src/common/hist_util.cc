@@ -12,6 +12,7 @@
 #include "xgboost/base.h"
 #include "../common/common.h"
 #include "hist_util.h"
+#include "hist_simd.h"
 #include "random.h"
 #include "column_matrix.h"
 #include "quantile.h"
@@ -34,6 +35,63 @@ HistogramCuts::HistogramCuts() {
   cut_ptrs_.HostVector().emplace_back(0);
 }
 
+bool Index::HasMixedBinTypes(std::vector<uint32_t> const& cut_ptrs) {
+  bool types[kUint32BinsTypeSize + 1] = {false};
+  for (size_t f = 0; f + 1 < cut_ptrs.size(); ++f) {
+    types[BinTypeOf(cut_ptrs[f + 1] - cut_ptrs[f])] = true;
+  }
+  return types[kUint8BinsTypeSize] + types[kUint16BinsTypeSize] + types[kUint32BinsTypeSize] > 1;
+}
+
+bool Index::HasPackableBins(std::vector<uint32_t> const& cut_ptrs) {
+  for (size_t f = 0; f + 1 < cut_ptrs.size(); ++f) {
+    if (cut_ptrs[f + 1] - cut_ptrs[f] <= kMaxPackedBins) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Index::ResizeMixed(size_t n_rows, std::vector<uint32_t> const& cut_ptrs,
+                        bool pack_bins) {
+  auto n_features = cut_ptrs.size() - 1;
+  CHECK_LE(n_features, static_cast<size_t>(std::numeric_limits<uint32_t>::max()));
+  this->ResizeOffset(n_features);
+  std::copy_n(cut_ptrs.cbegin(), n_features, offset_ptr_);
+
+  segments_.clear();
+  feature_segment_.resize(n_features);
+  feature_pos_.resize(n_features);
+  size_t n_bytes = 0;
+  for (uint32_t bits : {2u, 4u, 8u, 16u, 32u}) {
+    auto type = bits <= 8 ? kUint8BinsTypeSize : static_cast<BinTypeSize>(bits / 8);
+    IndexSegment seg;
+    seg.bin_type_size = type;
+    seg.bits = bits;
+    seg.begin = n_bytes;
+    for (size_t f = 0; f < n_features; ++f) {
+      if (BinBitsOf(cut_ptrs[f + 1] - cut_ptrs[f], pack_bins) != bits) {
+        continue;
+      }
+      feature_segment_[f] = static_cast<uint8_t>(segments_.size());
+      feature_pos_[f] = static_cast<uint32_t>(seg.features.size());
+      seg.features.push_back(static_cast<bst_feature_t>(f));
+      seg.offset.push_back(cut_ptrs[f]);
+    }
+    if (seg.features.empty()) {
+      continue;
+    }
+    seg.row_bytes = DivRoundUp(seg.features.size() * bits, 8);
+    // Keep the next segment aligned for its wider type.
+    n_bytes += n_rows * seg.row_bytes;
+    n_bytes = DivRoundUp(n_bytes, sizeof(uint32_t)) * sizeof(uint32_t);
+    binTypeSize_ = type;
+    segments_.emplace_back(std::move(seg));
+  }
+  n_rows_ = n_rows;
+  this->Resize(n_bytes);
+}
+
 /*!
  * \brief fill a histogram by zeros in range [begin, end)
  */
@@ -51,6 +109,8 @@ template void InitilizeHistByZeroes(GHistRow<float> hist, size_t begin,
                                     size_t end);
 template void InitilizeHistByZeroes(GHistRow<double> hist, size_t begin,
                                     size_t end);
+template void InitilizeHistByZeroes(GHistRow<int64_t> hist, size_t begin,
+                                    size_t end);
 
 /*!
  * \brief Increment hist as dst += add in range [begin, end)
@@ -69,6 +129,8 @@ template void IncrementHist(GHistRow<float> dst, const GHistRow<float> add,
                             size_t begin, size_t end);
 template void IncrementHist(GHistRow<double> dst, const GHistRow<double> add,
                             size_t begin, size_t end);
+template void IncrementHist(GHistRow<int64_t> dst, const GHistRow<int64_t> add,
+                            size_t begin, size_t end);
 
 /*!
  * \brief Copy hist from src to dst in range [begin, end)
@@ -87,6 +149,8 @@ template void CopyHist(GHistRow<float> dst, const GHistRow<float> src,
                        size_t begin, size_t end);
 template void CopyHist(GHistRow<double> dst, const GHistRow<double> src,
                        size_t begin, size_t end);
+template void CopyHist(GHistRow<int64_t> dst, const GHistRow<int64_t> src,
+                       size_t begin, size_t end);
 
 /*!
  * \brief Compute Subtraction: dst = src1 - src2 in range [begin, end)
@@ -109,6 +173,9 @@ template void SubtractionHist(GHistRow<float> dst, const GHistRow<float> src1,
 template void SubtractionHist(GHistRow<double> dst, const GHistRow<double> src1,
                               const GHistRow<double> src2,
                               size_t begin, size_t end);
+template void SubtractionHist(GHistRow<int64_t> dst, const GHistRow<int64_t> src1,
+                              const GHistRow<int64_t> src2,
+                              size_t begin, size_t end);
 
 struct Prefetch {
  public:
@@ -133,19 +200,22 @@ struct Prefetch {
 
 constexpr size_t Prefetch::kNoPrefetchSize;
 
+/**
+ * \brief Accumulate rows into the histogram.  For dense data `gradient_index` can also be
+ *        a segment of an index with mixed bin types, with `n_features` features per row.
+ */
 template <typename FPType, bool do_prefetch, typename BinIdxType,
           bool first_page, bool any_missing = true>
 void BuildHistKernel(const std::vector<GradientPair> &gpair,
                      const RowSetCollection::Elem row_indices,
-                     const GHistIndexMatrix &gmat, GHistRow<FPType> hist) {
+                     const GHistIndexMatrix &gmat, const BinIdxType *gradient_index,
+                     const uint32_t *offsets, size_t n_features, GHistRow<FPType> hist) {
   const size_t size = row_indices.Size();
   const size_t *rid = row_indices.begin;
   auto const *pgh = reinterpret_cast<const float *>(gpair.data());
-  const BinIdxType *gradient_index = gmat.index.data<BinIdxType>();
 
   auto const &row_ptr = gmat.row_ptr.data();
   auto base_rowid = gmat.base_rowid;
-  const uint32_t *offsets = gmat.index.Offset();
   auto get_row_ptr = [&](size_t ridx) {
     return first_page ? row_ptr[ridx] : row_ptr[ridx - base_rowid];
   };
@@ -153,13 +223,15 @@ void BuildHistKernel(const std::vector<GradientPair> &gpair,
     return first_page ? ridx : (ridx - base_rowid);
   };
 
-  const size_t n_features =
-      get_row_ptr(row_indices.begin[0] + 1) - get_row_ptr(row_indices.begin[0]);
   auto hist_data = reinterpret_cast<FPType *>(hist.data());
   const uint32_t two{2};  // Each element from 'gpair' and 'hist' contains
                           // 2 FP values: gradient and hessian.
                           // So we need to multiply each row-index/bin-index by 2
                           // to work with gradient pairs as a singe row FP array
+  // Features of a dense row fall into distinct bins, which can be accumulated with
+  // gather/scatter without conflict.
+  const bool use_simd = !any_missing && DenseHistSimdSupported() &&
+                        gmat.cut.TotalBins() < (static_cast<size_t>(1) << 30);
 
   for (size_t i = 0; i < size; ++i) {
     const size_t icol_start =
@@ -186,12 +258,111 @@ void BuildHistKernel(const std::vector<GradientPair> &gpair,
       }
     }
     const BinIdxType *gr_index_local = gradient_index + icol_start;
+    if (use_simd) {
+      AddDenseRowSimd(gr_index_local, offsets, row_size, pgh + idx_gh, hist_data);
+      continue;
+    }
 
     for (size_t j = 0; j < row_size; ++j) {
       const uint32_t idx_bin = two * (static_cast<uint32_t>(gr_index_local[j]) +
                                       (any_missing ? 0 : offsets[j]));
-      hist_data[idx_bin] += pgh[idx_gh];
-      hist_data[idx_bin + 1] += pgh[idx_gh + 1];
+      hist_data[idx_bin] += static_cast<FPType>(pgh[idx_gh]);
+      hist_data[idx_bin + 1] += static_cast<FPType>(pgh[idx_gh + 1]);
+    }
+  }
+}
+
+template <typename FPType, bool do_prefetch, typename BinIdxType,
+          bool first_page, bool any_missing = true>
+void BuildHistKernel(const std::vector<GradientPair> &gpair,
+                     const RowSetCollection::Elem row_indices,
+                     const GHistIndexMatrix &gmat, GHistRow<FPType> hist) {
+  auto const &row_ptr = gmat.row_ptr;
+  auto ridx = row_indices.begin[0] - gmat.base_rowid;
+  const size_t n_features = row_ptr[ridx + 1] - row_ptr[ridx];
+  BuildHistKernel<FPType, do_prefetch, BinIdxType, first_page, any_missing>(
+      gpair, row_indices, gmat, gmat.index.data<BinIdxType>(), gmat.index.Offset(),
+      n_features, hist);
+}
+
+/**
+ * \brief Accumulate rows of a segment with packed bins into the histogram, bins of each
+ *        byte are unpacked with shifts.
+ */
+template <typename FPType, bool do_prefetch, uint32_t kBits>
+void BuildPackedHistKernel(const std::vector<GradientPair> &gpair,
+                           const RowSetCollection::Elem row_indices,
+                           uint8_t const *gradient_index, IndexSegment const &seg,
+                           GHistRow<FPType> hist) {
+  const size_t size = row_indices.Size();
+  const size_t *rid = row_indices.begin;
+  auto const *pgh = reinterpret_cast<const float *>(gpair.data());
+  auto hist_data = reinterpret_cast<FPType *>(hist.data());
+  auto const *offsets = seg.offset.data();
+  auto n_features = seg.features.size();
+  auto row_bytes = seg.row_bytes;
+
+  for (size_t i = 0; i < size; ++i) {
+    if (do_prefetch) {
+      auto rid_prefetch = rid[i + Prefetch::kPrefetchOffset];
+      PREFETCH_READ_T0(pgh + 2 * rid_prefetch);
+      for (size_t j = 0; j < row_bytes; j += Prefetch::kCacheLineSize) {
+        PREFETCH_READ_T0(gradient_index + rid_prefetch * row_bytes + j);
+      }
+    }
+    const size_t idx_gh = 2 * rid[i];
+    auto grad = static_cast<FPType>(pgh[idx_gh]);
+    auto hess = static_cast<FPType>(pgh[idx_gh + 1]);
+    UnpackRow<kBits>(gradient_index + rid[i] * row_bytes, n_features,
+                     [&](size_t j, uint32_t bin) {
+                       const size_t idx_bin = 2 * static_cast<size_t>(bin + offsets[j]);
+                       hist_data[idx_bin] += grad;
+                       hist_data[idx_bin + 1] += hess;
+                     });
+  }
+}
+
+/**
+ * \brief Build histogram for an index with mixed bin types, one segment at a time.  Each
+ *        bin belongs to a single feature, so the order of accumulation for a bin is the
+ *        same as building all features at once.
+ */
+template <typename FPType, bool do_prefetch>
+void BuildMixedHist(const std::vector<GradientPair> &gpair,
+                    const RowSetCollection::Elem row_indices,
+                    const GHistIndexMatrix &gmat, GHistRow<FPType> hist) {
+  CHECK_EQ(gmat.base_rowid, 0);
+  auto const &segments = gmat.index.Segments();
+  for (size_t s = 0; s < segments.size(); ++s) {
+    auto const &seg = segments[s];
+    auto n_features = seg.features.size();
+    if (seg.bits == 2) {
+      BuildPackedHistKernel<FPType, do_prefetch, 2>(
+          gpair, row_indices, gmat.index.SegmentData<uint8_t>(s), seg, hist);
+      continue;
+    } else if (seg.bits == 4) {
+      BuildPackedHistKernel<FPType, do_prefetch, 4>(
+          gpair, row_indices, gmat.index.SegmentData<uint8_t>(s), seg, hist);
+      continue;
+    }
+    switch (seg.bin_type_size) {
+    case kUint8BinsTypeSize:
+      BuildHistKernel<FPType, do_prefetch, uint8_t, true, false>(
+          gpair, row_indices, gmat, gmat.index.SegmentData<uint8_t>(s), seg.offset.data(),
+          n_features, hist);
+      break;
+    case kUint16BinsTypeSize:
+      BuildHistKernel<FPType, do_prefetch, uint16_t, true, false>(
+          gpair, row_indices, gmat, gmat.index.SegmentData<uint16_t>(s), seg.offset.data(),
+          n_features, hist);
+      break;
+    case kUint32BinsTypeSize:
+      BuildHistKernel<FPType, do_prefetch, uint32_t, true, false>(
+          gpair, row_indices, gmat, gmat.index.SegmentData<uint32_t>(s), seg.offset.data(),
+          n_features, hist);
+      break;
+    default:
+      CHECK(false);  // no default behavior
     }
   }
 }
@@ -201,7 +372,9 @@ void BuildHistDispatch(const std::vector<GradientPair> &gpair,
                        const RowSetCollection::Elem row_indices,
                        const GHistIndexMatrix &gmat, GHistRow<FPType> hist) {
   auto first_page = gmat.base_rowid == 0;
-  if (first_page) {
+  if (gmat.index.IsMixed()) {
+    BuildMixedHist<FPType, do_prefetch>(gpair, row_indices, gmat, hist);
+  } else if (first_page) {
     switch (gmat.index.GetBinTypeSize()) {
     case kUint8BinsTypeSize:
       BuildHistKernel<FPType, do_prefetch, uint8_t, true, any_missing>(
@@ -269,6 +442,137 @@ void GHistBuilder<GradientSumT>::BuildHist(
   }
 }
 
+template <typename FPType, typename BinIdxType, bool any_missing>
+void BuildSparseHistKernel(const std::vector<GradientPair> &gpair,
+                           const RowSetCollection::Elem row_indices,
+                           const GHistIndexMatrix &gmat, const BinIdxType *gradient_index,
+                           const uint32_t *offsets, size_t n_features,
+                           GHistRow<FPType> scratch, std::vector<uint32_t> *p_bins) {
+  auto const *pgh = reinterpret_cast<const float *>(gpair.data());
+  auto const &row_ptr = gmat.row_ptr.data();
+  auto base_rowid = gmat.base_rowid;
+  auto hist_data = reinterpret_cast<FPType *>(scratch.data());
+
+  auto &bins = *p_bins;
+  // Same order of accumulation as `BuildHistKernel`.
+  for (const size_t *it = row_indices.begin; it != row_indices.end; ++it) {
+    const size_t ridx = *it - base_rowid;
+    const size_t icol_start = any_missing ? row_ptr[ridx] : ridx * n_features;
+    const size_t icol_end = any_missing ? row_ptr[ridx + 1] : icol_start + n_features;
+    const size_t idx_gh = 2 * (*it);
+    for (size_t j = icol_start; j < icol_end; ++j) {
+      const uint32_t bin = static_cast<uint32_t>(gradient_index[j]) +
+                           (any_missing ? 0 : offsets[j - icol_start]);
+      bins.push_back(bin);
+      hist_data[2 * bin] += static_cast<FPType>(pgh[idx_gh]);
+      hist_data[2 * bin + 1] += static_cast<FPType>(pgh[idx_gh + 1]);
+    }
+  }
+}
+
+template <typename FPType, uint32_t kBits>
+void BuildPackedSparseHistKernel(const std::vector<GradientPair> &gpair,
+                                 const RowSetCollection::Elem row_indices,
+                                 uint8_t const *gradient_index, IndexSegment const &seg,
+                                 GHistRow<FPType> scratch, std::vector<uint32_t> *p_bins) {
+  auto const *pgh = reinterpret_cast<const float *>(gpair.data());
+  auto hist_data = reinterpret_cast<FPType *>(scratch.data());
+  auto const *offsets = seg.offset.data();
+  auto &bins = *p_bins;
+  for (const size_t *it = row_indices.begin; it != row_indices.end; ++it) {
+    const size_t idx_gh = 2 * (*it);
+    UnpackRow<kBits>(gradient_index + (*it) * seg.row_bytes, seg.features.size(),
+                     [&](size_t j, uint32_t local) {
+                       const uint32_t bin = local + offsets[j];
+                       bins.push_back(bin);
+                       hist_data[2 * bin] += static_cast<FPType>(pgh[idx_gh]);
+                       hist_data[2 * bin + 1] += static_cast<FPType>(pgh[idx_gh + 1]);
+                     });
+  }
+}
+
+template <typename FPType, typename BinIdxType, bool any_missing>
+void BuildSparseHistKernel(const std::vector<GradientPair> &gpair,
+                           const RowSetCollection::Elem row_indices,
+                           const GHistIndexMatrix &gmat, GHistRow<FPType> scratch,
+                           std::vector<uint32_t> *p_bins) {
+  const size_t n_features = any_missing ? 0 : gmat.cut.Ptrs().size() - 1;
+  BuildSparseHistKernel<FPType, BinIdxType, any_missing>(
+      gpair, row_indices, gmat, gmat.index.data<BinIdxType>(), gmat.index.Offset(),
+      n_features, scratch, p_bins);
+}
+
+template <typename GradientSumT>
+template <bool any_missing>
+void GHistBuilder<GradientSumT>::BuildSparseHist(const std::vector<GradientPair> &gpair,
+                                                 const RowSetCollection::Elem row_indices,
+                                                 const GHistIndexMatrix &gmat,
+                                                 GHistRowT scratch,
+                                                 SparseHistRow<GradientSumT> *out) const {
+  CHECK_EQ(scratch.size(), nbins_);
+  auto &bins = out->bins;
+  bins.clear();
+  if (gmat.index.IsMixed()) {
+    auto const &segments = gmat.index.Segments();
+    for (size_t s = 0; s < segments.size(); ++s) {
+      auto const &seg = segments[s];
+      auto n_features = seg.features.size();
+      if (seg.bits == 2) {
+        BuildPackedSparseHistKernel<GradientSumT, 2>(
+            gpair, row_indices, gmat.index.SegmentData<uint8_t>(s), seg, scratch, &bins);
+        continue;
+      } else if (seg.bits == 4) {
+        BuildPackedSparseHistKernel<GradientSumT, 4>(
+            gpair, row_indices, gmat.index.SegmentData<uint8_t>(s), seg, scratch, &bins);
+        continue;
+      }
+      switch (seg.bin_type_size) {
+        case kUint8BinsTypeSize:
+          BuildSparseHistKernel<GradientSumT, uint8_t, false>(
+              gpair, row_indices, gmat, gmat.index.SegmentData<uint8_t>(s),
+              seg.offset.data(), n_features, scratch, &bins);
+          break;
+        case kUint16BinsTypeSize:
+          BuildSparseHistKernel<GradientSumT, uint16_t, false>(
+              gpair, row_indices, gmat, gmat.index.SegmentData<uint16_t>(s),
+              seg.offset.data(), n_features, scratch, &bins);
+          break;
+        case kUint32BinsTypeSize:
+          BuildSparseHistKernel<GradientSumT, uint32_t, false>(
+              gpair, row_indices, gmat, gmat.index.SegmentData<uint32_t>(s),
+              seg.offset.data(), n_features, scratch, &bins);
+          break;
+        default:
+          CHECK(false);  // no default behavior
+      }
+    }
+  } else {
+    switch (gmat.index.GetBinTypeSize()) {
+      case kUint8BinsTypeSize:
+        BuildSparseHistKernel<GradientSumT, uint8_t, any_missing>(gpair, row_indices, gmat,
+                                                                   scratch, &bins);
+        break;
+      case kUint16BinsTypeSize:
+        BuildSparseHistKernel<GradientSumT, uint16_t, any_missing>(gpair, row_indices, gmat,
+                                                                    scratch, &bins);
+        break;
+      case kUint32BinsTypeSize:
+        BuildSparseHistKernel<GradientSumT, uint32_t, any_missing>(gpair, row_indices, gmat,
+                                                                    scratch, &bins);
+        break;
+      default:
+        CHECK(false);  // no default behavior
+    }
+  }
+  std::sort(bins.begin(), bins.end());
+  bins.erase(std::unique(bins.begin(), bins.end()), bins.end());
+  out->values.resize(bins.size());
+  for (size_t i = 0; i < bins.size(); ++i) {
+    out->values[i] = scratch[bins[i]];
+    scratch[bins[i]] = {};
+  }
+}
+
 template void
 GHistBuilder<float>::BuildHist<true>(const std::vector<GradientPair> &gpair,
                                      const RowSetCollection::Elem row_indices,
@@ -289,5 +593,33 @@ GHistBuilder<double>::BuildHist<false>(const std::vector<GradientPair> &gpair,
                                        const RowSetCollection::Elem row_indices,
                                        const GHistIndexMatrix &gmat,
                                        GHistRow<double> hist) const;
+template void
+GHistBuilder<int64_t>::BuildHist<true>(const std::vector<GradientPair> &gpair,
+                                       const RowSetCollection::Elem row_indices,
+                                       const GHistIndexMatrix &gmat,
+                                       GHistRow<int64_t> hist) const;
+template void
+GHistBuilder<int64_t>::BuildHist<false>(const std::vector<GradientPair> &gpair,
+                                        const RowSetCollection::Elem row_indices,
+                                        const GHistIndexMatrix &gmat,
+                                        GHistRow<int64_t> hist) const;
+template void GHistBuilder<float>::BuildSparseHist<true>(
+    const std::vector<GradientPair> &gpair, const RowSetCollection::Elem row_indices,
+    const GHistIndexMatrix &gmat, GHistRow<float> scratch, SparseHistRow<float> *out) const;
+template void GHistBuilder<float>::BuildSparseHist<false>(
+    const std::vector<GradientPair> &gpair, const RowSetCollection::Elem row_indices,
+    const GHistIndexMatrix &gmat, GHistRow<float> scratch, SparseHistRow<float> *out) const;
+template void GHistBuilder<double>::BuildSparseHist<true>(
+    const std::vector<GradientPair> &gpair, const RowSetCollection::Elem row_indices,
+    const GHistIndexMatrix &gmat, GHistRow<double> scratch, SparseHistRow<double> *out) const;
+template void GHistBuilder<double>::BuildSparseHist<false>(
+    const std::vector<GradientPair> &gpair, const RowSetCollection::Elem row_indices,
+    const GHistIndexMatrix &gmat, GHistRow<double> scratch, SparseHistRow<double> *out) const;
+template void GHistBuilder<int64_t>::BuildSparseHist<true>(
+    const std::vector<GradientPair> &gpair, const RowSetCollection::Elem row_indices,
+    const GHistIndexMatrix &gmat, GHistRow<int64_t> scratch, SparseHistRow<int64_t> *out) const;
+template void GHistBuilder<int64_t>::BuildSparseHist<false>(
+    const std::vector<GradientPair> &gpair, const RowSetCollection::Elem row_indices,
+    const GHistIndexMatrix &gmat, GHistRow<int64_t> scratch, SparseHistRow<int64_t> *out) const;
 }  // namespace common
 }  // namespace xgboost
@@ -2,6 +2,7 @@
  * Copyright 2018~2020 XGBoost contributors
  */
 
+#include <xgboost/global_config.h>
 #include <xgboost/logging.h>
 
 #include <thrust/copy.h>
@@ -14,11 +15,14 @@
 #include <thrust/binary_search.h>
 #include <thrust/execution_policy.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
 
+#include "annotation.h"
 #include "device_helpers.cuh"
 #include "hist_util.h"
 #include "hist_util.cuh"
@@ -89,19 +93,24 @@ size_t RequiredMemory(bst_row_t num_rows, bst_feature_t num_columns, size_t nnz,
   return peak;
 }
 
-size_t SketchBatchNumElements(size_t sketch_batch_num_elements,
-                              bst_row_t num_rows, bst_feature_t columns,
-                              size_t nnz, int device,
-                              size_t num_cuts, bool has_weight) {
+size_t SketchMemoryBudget(int device) {
+  auto budget = static_cast<size_t>(GlobalConfigThreadLocalStore::Get()->sketch_memory_budget);
 #if defined(XGBOOST_USE_RMM) && XGBOOST_USE_RMM == 1
   // device available memory is not accurate when rmm is used.
-  return nnz;
+  return budget == 0 ? std::numeric_limits<size_t>::max() : budget;
 #endif  // defined(XGBOOST_USE_RMM) && XGBOOST_USE_RMM == 1
+  // use up to 80% of available space
+  auto avail = static_cast<size_t>(dh::AvailableMemory(device) * 0.8);
+  return budget == 0 ? avail : std::min(avail, budget);
+}
 
+size_t SketchBatchNumElements(size_t sketch_batch_num_elements,
+                              bst_row_t num_rows, bst_feature_t columns,
+                              size_t nnz, int device,
+                              size_t num_cuts, bool has_weight) {
   if (sketch_batch_num_elements == 0) {
     auto required_memory = RequiredMemory(num_rows, columns, nnz, num_cuts, has_weight);
-    // use up to 80% of available space
-    auto avail = dh::AvailableMemory(device) * 0.8;
+    auto avail = SketchMemoryBudget(device);
     if (required_memory > avail) {
       sketch_batch_num_elements = avail / BytesPerElement(has_weight);
     } else {
@@ -296,6 +305,7 @@ void ProcessWeightedBatch(int device, const SparsePage& page,
 
 HistogramCuts DeviceSketch(int device, DMatrix* dmat, int max_bins,
                            size_t sketch_batch_num_elements) {
+  XGBOOST_ANNOTATE_SCOPE("xgboost::DeviceSketch");
   dmat->Info().feature_types.SetDevice(device);
   dmat->Info().feature_types.ConstDevicePointer();  // pull to device early
   // Configure batch size based on available memory
@@ -65,6 +65,11 @@ inline size_t constexpr BytesPerElement(bool has_weight) {
   return (has_weight ? sizeof(Entry) + sizeof(float) : sizeof(Entry)) * 2;
 }
 
+/* \brief Device memory available for sketching in bytes, bounded by the
+ *        `sketch_memory_budget` global configuration when it's set.
+ */
+size_t SketchMemoryBudget(int device);
+
 /* \brief Calcuate the length of sliding window. Returns `sketch_batch_num_elements`
  *        directly if it's not 0.
  */
@@ -273,6 +278,8 @@ void AdapterDeviceSketch(Batch batch, int num_bins,
   size_t num_cuts_per_feature = detail::RequiredSampleCutsPerColumn(num_bins, num_rows);
   int32_t device = sketch_container->DeviceIdx();
   bool weighted = info.weights_.Size() != 0;
+  // Summaries merged from previous windows are kept small so the next window fits.
+  size_t max_summary_bytes = detail::SketchMemoryBudget(device) / 4;
 
   if (weighted) {
     sketch_batch_num_elements = detail::SketchBatchNumElements(
@@ -285,6 +292,7 @@ void AdapterDeviceSketch(Batch batch, int num_bins,
                                    num_cuts_per_feature,
                                    HostSketchContainer::UseGroup(info), missing, device, num_cols, begin, end,
                                    sketch_container);
+      sketch_container->PruneIfLarger(max_summary_bytes);
     }
   } else {
     sketch_batch_num_elements = detail::SketchBatchNumElements(
@@ -295,6 +303,7 @@ void AdapterDeviceSketch(Batch batch, int num_bins,
       size_t end = std::min(batch.Size(), size_t(begin + sketch_batch_num_elements));
       ProcessSlidingWindow(batch, info, device, num_cols, begin, end, missing,
                            sketch_container, num_cuts_per_feature);
+      sketch_container->PruneIfLarger(max_summary_bytes);
     }
   }
 }
@@ -9,15 +9,20 @@
 
 #include <xgboost/data.h>
 #include <xgboost/generic_parameters.h>
+#include <atomic>
 #include <limits>
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <map>
 
+#include "annotation.h"
 #include "categorical.h"
 #include "common.h"
+#include "huge_page_allocator.h"
+#include "memory_tracker.h"
 #include "quantile.h"
 #include "row_set.h"
 #include "threading_utils.h"
@@ -80,6 +85,15 @@ class HistogramCuts {
     return cut_ptrs_.ConstHostVector().at(feature + 1) -
            cut_ptrs_.ConstHostVector()[feature];
   }
+  /*! \brief Largest number of bins among all features. */
+  uint32_t MaxFeatureBins() const {
+    auto const &ptrs = cut_ptrs_.ConstHostVector();
+    uint32_t n_bins = 0;
+    for (size_t i = 1; i < ptrs.size(); ++i) {
+      n_bins = std::max(n_bins, ptrs[i] - ptrs[i - 1]);
+    }
+    return n_bins;
+  }
 
   // Getters.  Cuts should be of no use after building histogram indices, but currently
   // they are deeply linked with quantile_hist, gpu sketcher and gpu_hist, so we preserve
@@ -130,28 +144,28 @@ class HistogramCuts {
 };
 
 inline HistogramCuts SketchOnDMatrix(DMatrix *m, int32_t max_bins,
-                                     Span<float> const hessian = {}) {
+                                     Span<float> const hessian = {},
+                                     bst_row_t sample_rows = 0,
+                                     Span<int32_t const> feature_max_bins = {},
+                                     size_t max_total_bins = 0) {
+  XGBOOST_ANNOTATE_SCOPE("xgboost::SketchOnDMatrix");
   HistogramCuts out;
   auto const& info = m->Info();
   const auto threads = omp_get_max_threads();
-  std::vector<std::vector<bst_row_t>> column_sizes(threads);
-  for (auto& column : column_sizes) {
-    column.resize(info.num_col_, 0);
-  }
+  // Column sizes are counted while streaming the pages into the sketches.
   std::vector<bst_row_t> reduced(info.num_col_, 0);
-  for (auto const& page : m->GetBatches<SparsePage>()) {
-    auto const &entries_per_column =
-        HostSketchContainer::CalcColumnSize(page, info.num_col_, threads);
-    for (size_t i = 0; i < entries_per_column.size(); ++i) {
-      reduced[i] += entries_per_column[i];
-    }
-  }
   HostSketchContainer container(reduced, max_bins,
                                 m->Info().feature_types.ConstHostSpan(),
-                                HostSketchContainer::UseGroup(info), threads);
+                                HostSketchContainer::UseGroup(info), threads, sample_rows,
+                                feature_max_bins, max_total_bins);
   for (auto const &page : m->GetBatches<SparsePage>()) {
     container.PushRowPage(page, info, hessian);
   }
+  if (!m->SingleColBlock()) {
+    // Start pre-fetching pages for the following pass over external memory, the page I/O
+    // then overlaps with the allreduce of sketches across workers.
+    m->GetBatches<SparsePage>();
+  }
   container.MakeCuts(&out);
   return out;
 }
@@ -162,6 +176,73 @@ enum BinTypeSize : uint32_t {
   kUint32BinsTypeSize = 4
 };
 
+/*! \brief Narrowest bin type for local bin index of features with `max_num_bins` bins. */
+inline BinTypeSize BinTypeOf(size_t max_num_bins) {
+  if (max_num_bins <= static_cast<size_t>(std::numeric_limits<uint8_t>::max()) + 1) {
+    return kUint8BinsTypeSize;
+  } else if (max_num_bins <= static_cast<size_t>(std::numeric_limits<uint16_t>::max()) + 1) {
+    return kUint16BinsTypeSize;
+  }
+  return kUint32BinsTypeSize;
+}
+
+/*! \brief Features of a dense index stored with the same bin type, see `Index::ResizeMixed`. */
+struct IndexSegment {
+  /*! \brief Storage type, `kUint8BinsTypeSize` for segments with packed bins. */
+  BinTypeSize bin_type_size;
+  /*! \brief Bits of each bin, 2 or 4 for packed bins and the size of the bin type otherwise. */
+  uint32_t bits;
+  /*! \brief Bytes of each row in this segment, rows of packed bins are padded to bytes. */
+  size_t row_bytes;
+  /*! \brief Features in this segment, sorted. */
+  std::vector<bst_feature_t> features;
+  /*! \brief First bin of each feature in this segment, like `Index::Offset`. */
+  std::vector<uint32_t> offset;
+  /*! \brief Position of this segment in the index data, in bytes. */
+  size_t begin;
+
+  bool IsPacked() const { return bits < 8; }
+};
+
+/*! \brief Largest number of bins of a feature stored with packed bins. */
+constexpr size_t kMaxPackedBins = 16;
+
+/*! \brief Bits of each bin for a feature with `n_bins` bins, see `Index::ResizeMixed`. */
+inline uint32_t BinBitsOf(size_t n_bins, bool pack_bins) {
+  if (pack_bins && n_bins <= 4) {
+    return 2;
+  } else if (pack_bins && n_bins <= kMaxPackedBins) {
+    return 4;
+  }
+  return BinTypeOf(n_bins) * 8;
+}
+
+/**
+ * \brief Call `fn(j, bin)` for the local bin of each feature in a row of packed bins, bins
+ *        of a byte are unpacked from the lowest bits.
+ */
+template <uint32_t kBits, typename Fn>
+inline void UnpackRow(uint8_t const *row, size_t n_features, Fn &&fn) {
+  static_assert(kBits == 2 || kBits == 4, "Invalid number of bits for packed bins.");
+  constexpr size_t kPerByte = 8 / kBits;
+  constexpr uint32_t kMask = (1u << kBits) - 1;
+  size_t j = 0;
+  for (; j + kPerByte <= n_features; j += kPerByte) {
+    uint32_t byte = row[j / kPerByte];
+    for (size_t k = 0; k < kPerByte; ++k) {
+      fn(j + k, byte & kMask);
+      byte >>= kBits;
+    }
+  }
+  if (j < n_features) {
+    uint32_t byte = row[j / kPerByte];
+    for (; j < n_features; ++j) {
+      fn(j, byte & kMask);
+      byte >>= kBits;
+    }
+  }
+}
+
 struct Index {
   Index() {
     SetBinTypeSize(binTypeSize_);
@@ -171,13 +252,16 @@ struct Index {
   Index(Index&& i) = delete;
   Index& operator=(Index&& i) = delete;
   uint32_t operator[](size_t i) const {
-    if (offset_ptr_ != nullptr) {
+    if (!segments_.empty()) {
+      return this->GetMixed(i);
+    } else if (offset_ptr_ != nullptr) {
       return func_(data_ptr_, i) + offset_ptr_[i%p_];
     } else {
       return func_(data_ptr_, i);
     }
   }
   void SetBinTypeSize(BinTypeSize binTypeSize) {
+    segments_.clear();
     binTypeSize_ = binTypeSize;
     switch (binTypeSize) {
       case kUint8BinsTypeSize:
@@ -209,8 +293,10 @@ struct Index {
     return offset_.size();
   }
   size_t Size() const {
-    return data_.size() / (binTypeSize_);
+    return segments_.empty() ? data_.size() / (binTypeSize_) : n_rows_ * p_;
   }
+  /*! \brief Size of the index data in bytes. */
+  size_t NumBytes() const { return data_.size(); }
   void Resize(const size_t nBytesData) {
     data_.resize(nBytesData);
     data_ptr_ = reinterpret_cast<void*>(data_.data());
@@ -220,6 +306,64 @@ struct Index {
     offset_ptr_ = offset_.data();
     p_ = nDisps;
   }
+  /**
+   * \brief Allocate a dense index of `n_rows` rows with the narrowest bin type of each
+   *        feature.  Features are grouped into uint8, uint16 and uint32 segments, each
+   *        segment stores its features row by row with its own offsets.  `Offset` still
+   *        returns the first bin of all features, while `data` is invalid and
+   *        `GetBinTypeSize` returns the widest type.
+   *
+   *        With `pack_bins`, features with at most 4 or 16 bins are grouped into segments
+   *        packing 2 or 4 bits for each bin.
+   */
+  void ResizeMixed(size_t n_rows, std::vector<uint32_t> const& cut_ptrs,
+                   bool pack_bins = false);
+  /*! \brief Whether features of this index are stored with different bin types. */
+  bool IsMixed() const { return !segments_.empty(); }
+  /*! \brief Whether some features of this index are stored with packed bins. */
+  bool IsPacked() const {
+    return std::any_of(segments_.cbegin(), segments_.cend(),
+                       [](IndexSegment const& seg) { return seg.IsPacked(); });
+  }
+  /*! \brief Whether `ResizeMixed` saves memory for features with these cuts. */
+  static bool HasMixedBinTypes(std::vector<uint32_t> const& cut_ptrs);
+  /*! \brief Whether some features with these cuts can be stored with packed bins. */
+  static bool HasPackableBins(std::vector<uint32_t> const& cut_ptrs);
+  std::vector<IndexSegment> const& Segments() const { return segments_; }
+  template <typename T>
+  T* SegmentData(size_t s) const {
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(data_ptr_) + segments_[s].begin);
+  }
+  /**
+   * \brief Set the global bin of element `i` in an index with mixed bin types.  Packed bins
+   *        share bytes within a row, so a row must be set by a single thread.
+   */
+  void SetMixed(size_t i, uint32_t bin) {
+    auto f = i % p_;
+    auto const& seg = segments_[feature_segment_[f]];
+    auto k = (i / p_) * seg.features.size() + feature_pos_[f];
+    auto local = bin - offset_ptr_[f];
+    auto* data = static_cast<uint8_t*>(data_ptr_) + seg.begin;
+    if (seg.IsPacked()) {
+      auto bit = feature_pos_[f] * seg.bits;
+      auto& byte = data[(i / p_) * seg.row_bytes + bit / 8];
+      auto mask = static_cast<uint8_t>(((1u << seg.bits) - 1) << (bit % 8));
+      byte = static_cast<uint8_t>((byte & ~mask) | (local << (bit % 8)));
+      return;
+    }
+    switch (seg.bin_type_size) {
+      case kUint8BinsTypeSize:
+        reinterpret_cast<uint8_t*>(data)[k] = static_cast<uint8_t>(local);
+        break;
+      case kUint16BinsTypeSize:
+        reinterpret_cast<uint16_t*>(data)[k] = static_cast<uint16_t>(local);
+        break;
+      case kUint32BinsTypeSize:
+        reinterpret_cast<uint32_t*>(data)[k] = local;
+        break;
+    }
+  }
+
   std::vector<uint8_t>::const_iterator begin() const {  // NOLINT
     return data_.begin();
   }
@@ -227,14 +371,33 @@ struct Index {
     return data_.end();
   }
 
-  std::vector<uint8_t>::iterator begin() {  // NOLINT
+  auto begin() {  // NOLINT
     return data_.begin();
   }
-  std::vector<uint8_t>::iterator end() {  // NOLINT
+  auto end() {  // NOLINT
     return data_.end();
   }
 
  private:
+  uint32_t GetMixed(size_t i) const {
+    auto f = i % p_;
+    auto const& seg = segments_[feature_segment_[f]];
+    auto k = (i / p_) * seg.features.size() + feature_pos_[f];
+    auto* data = static_cast<uint8_t*>(data_ptr_) + seg.begin;
+    if (seg.IsPacked()) {
+      auto bit = feature_pos_[f] * seg.bits;
+      uint32_t byte = data[(i / p_) * seg.row_bytes + bit / 8];
+      return ((byte >> (bit % 8)) & ((1u << seg.bits) - 1)) + offset_ptr_[f];
+    }
+    switch (seg.bin_type_size) {
+      case kUint8BinsTypeSize:
+        return GetValueFromUint8(data, k) + offset_ptr_[f];
+      case kUint16BinsTypeSize:
+        return GetValueFromUint16(data, k) + offset_ptr_[f];
+      default:
+        return GetValueFromUint32(data, k) + offset_ptr_[f];
+    }
+  }
   static uint32_t GetValueFromUint8(void *t, size_t i) {
     return reinterpret_cast<uint8_t*>(t)[i];
   }
@@ -247,13 +410,20 @@ struct Index {
 
   using Func = uint32_t (*)(void*, size_t);
 
-  std::vector<uint8_t> data_;
+  // Not initialized on resize, rows are first touched by threads quantizing them.
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> data_;
   std::vector<uint32_t> offset_;  // size of this field is equal to number of features
   void* data_ptr_;
   BinTypeSize binTypeSize_ {kUint8BinsTypeSize};
   size_t p_ {1};
   uint32_t* offset_ptr_ {nullptr};
   Func func_;
+  // Segments of an index with mixed bin types, the segment of each feature and its
+  // position in that segment.
+  std::vector<IndexSegment> segments_;
+  std::vector<uint8_t> feature_segment_;
+  std::vector<uint32_t> feature_pos_;
+  size_t n_rows_ {0};
 };
 
 template <typename GradientIndex>
@@ -284,6 +454,8 @@ int32_t XGBOOST_HOST_DEV_INLINE BinarySearchBin(size_t begin, size_t end,
 }
 
 class ColumnMatrix;
+class FeatureBundles;
+class MissingBins;
 
 template<typename GradientSumT>
 using GHistRow = Span<xgboost::detail::GradientPairInternal<GradientSumT> >;
@@ -316,14 +488,41 @@ void SubtractionHist(GHistRow<GradientSumT> dst, const GHistRow<GradientSumT> sr
                      const GHistRow<GradientSumT> src2,
                      size_t begin, size_t end);
 
+/*!
+ * \brief Histogram storing only the bins with entries, used by nodes with few rows.
+ */
+template <typename GradientSumT>
+struct SparseHistRow {
+  using GradientPairT = xgboost::detail::GradientPairInternal<GradientSumT>;
+  /*! \brief index of bins with entries, sorted. */
+  std::vector<uint32_t> bins;
+  /*! \brief statistics of each bin in `bins`. */
+  std::vector<GradientPairT> values;
+
+  size_t Size() const { return bins.size(); }
+  void Clear() {
+    bins.clear();
+    values.clear();
+  }
+  /*! \brief Range of entries belonging to bins in [bin_begin, bin_end). */
+  std::pair<size_t, size_t> Range(uint32_t bin_begin, uint32_t bin_end) const {
+    auto beg = std::lower_bound(bins.cbegin(), bins.cend(), bin_begin);
+    auto end = std::lower_bound(beg, bins.cend(), bin_end);
+    return {static_cast<size_t>(beg - bins.cbegin()), static_cast<size_t>(end - bins.cbegin())};
+  }
+};
+
 /*!
  * \brief histogram of gradient statistics for multiple nodes
+ *
+ * Histograms of nodes with few rows can be stored as `SparseHistRow`, see `IsSparse`.
  */
 template<typename GradientSumT>
 class HistCollection {
  public:
   using GHistRowT = GHistRow<GradientSumT>;
   using GradientPairT = xgboost::detail::GradientPairInternal<GradientSumT>;
+  using SparseRowT = SparseHistRow<GradientSumT>;
 
   // access histogram for i-th node
   GHistRowT operator[](bst_uint nid) const {
@@ -351,12 +550,19 @@ class HistCollection {
       nbins_ = nbins;
       // quite expensive operation, so let's do this only once
       data_.clear();
+      tracked_.Update(0);
     }
     row_ptr_.clear();
+    free_rows_.clear();
     n_nodes_added_ = 0;
+    sparse_ptr_.clear();
+    free_sparse_.clear();
+    for (uint32_t i = 0; i < sparse_.size(); ++i) {
+      free_sparse_.push_back(i);
+    }
   }
 
-  // create an empty histogram for i-th node
+  // create an empty histogram for i-th node, memory of released histograms is reused.
   void AddHistRow(bst_uint nid) {
     constexpr uint32_t kMax = std::numeric_limits<uint32_t>::max();
     if (nid >= row_ptr_.size()) {
@@ -364,17 +570,72 @@ class HistCollection {
     }
     CHECK_EQ(row_ptr_[nid], kMax);
 
-    if (data_.size() < (nid + 1)) {
-      data_.resize((nid + 1));
+    uint32_t id;
+    if (!free_rows_.empty()) {
+      id = free_rows_.back();
+      free_rows_.pop_back();
+    } else {
+      id = n_nodes_added_;
+      n_nodes_added_++;
     }
-
-    row_ptr_[nid] = n_nodes_added_;
-    n_nodes_added_++;
+    if (data_.size() < (id + 1)) {
+      data_.resize((id + 1));
+    }
+    row_ptr_[nid] = id;
   }
+  // release histogram of i-th node, so that the memory can be used by another node.
+  void FreeHistRow(bst_uint nid) {
+    CHECK(RowExists(nid));
+    free_rows_.push_back(row_ptr_[nid]);
+    row_ptr_[nid] = std::numeric_limits<uint32_t>::max();
+  }
+  // whether the histogram of i-th node is stored as a sparse row.
+  bool IsSparse(bst_uint nid) const {
+    return nid < sparse_ptr_.size() && sparse_ptr_[nid] != std::numeric_limits<uint32_t>::max();
+  }
+  // create an empty sparse histogram for i-th node.  References to other sparse rows are
+  // invalidated.
+  void AddSparseRow(bst_uint nid) {
+    constexpr uint32_t kMax = std::numeric_limits<uint32_t>::max();
+    if (nid >= sparse_ptr_.size()) {
+      sparse_ptr_.resize(nid + 1, kMax);
+    }
+    CHECK_EQ(sparse_ptr_[nid], kMax);
+    CHECK(!RowExists(nid));
+    if (!free_sparse_.empty()) {
+      sparse_ptr_[nid] = free_sparse_.back();
+      free_sparse_.pop_back();
+    } else {
+      sparse_ptr_[nid] = static_cast<uint32_t>(sparse_.size());
+      sparse_.emplace_back();
+    }
+    sparse_[sparse_ptr_[nid]].Clear();
+  }
+  SparseRowT const& SparseRow(bst_uint nid) const {
+    CHECK(IsSparse(nid));
+    return sparse_[sparse_ptr_[nid]];
+  }
+  SparseRowT& SparseRow(bst_uint nid) {
+    CHECK(IsSparse(nid));
+    return sparse_[sparse_ptr_[nid]];
+  }
+  // release sparse histogram of i-th node, capacity is kept for other nodes.
+  void FreeSparseRow(bst_uint nid) {
+    CHECK(IsSparse(nid));
+    free_sparse_.push_back(sparse_ptr_[nid]);
+    sparse_ptr_[nid] = std::numeric_limits<uint32_t>::max();
+  }
+  // number of histograms being held, including the released ones.
+  size_t AllocatedRows() const { return n_nodes_added_; }
+  // number of released histograms available for reuse.
+  size_t FreeRows() const { return free_rows_.size(); }
   // allocate thread local memory i-th node
   void AllocateData(bst_uint nid) {
-    if (data_[row_ptr_[nid]].size() == 0) {
-      data_[row_ptr_[nid]].resize(nbins_, {0, 0});
+    auto& hist = data_[row_ptr_[nid]];
+    if (hist.size() == 0) {
+      auto capacity = hist.capacity();
+      hist.resize(nbins_, {0, 0});
+      this->Track(capacity, hist.capacity());
     }
   }
   // allocate common buffer contiguously for all nodes, need for single Allreduce call
@@ -382,11 +643,17 @@ class HistCollection {
     const size_t new_size = nbins_*data_.size();
     contiguous_allocation_ = true;
     if (data_[0].size() != new_size) {
-      data_[0].resize(new_size);
+      auto capacity = data_[0].capacity();
+      data_[0].resize(new_size, {0, 0});
+      this->Track(capacity, data_[0].capacity());
     }
   }
 
  private:
+  void Track(size_t old_capacity, size_t new_capacity) {
+    tracked_.Update(tracked_.Bytes() + (new_capacity - old_capacity) * sizeof(GradientPairT));
+  }
+
   /*! \brief number of all bins over all features */
   uint32_t nbins_ = 0;
   /*! \brief amount of active nodes in hist collection */
@@ -394,21 +661,34 @@ class HistCollection {
   /*! \brief flag to identify contiguous memory allocation */
   bool contiguous_allocation_ = false;
 
-  std::vector<std::vector<GradientPairT>> data_;
+  std::vector<std::vector<GradientPairT, HugePageAllocator<GradientPairT>>> data_;
+  TrackedBytes tracked_{MemoryTracker::kHistCollection};
 
   /*! \brief row_ptr_[nid] locates bin for histogram of node nid */
   std::vector<size_t> row_ptr_;
+  /*! \brief histograms released by FreeHistRow */
+  std::vector<uint32_t> free_rows_;
+  /*! \brief sparse_ptr_[nid] locates sparse histogram of node nid */
+  std::vector<uint32_t> sparse_ptr_;
+  std::vector<SparseRowT> sparse_;
+  /*! \brief sparse histograms released by FreeSparseRow */
+  std::vector<uint32_t> free_sparse_;
 };
 
 /*!
  * \brief Stores temporary histograms to compute them in parallel
  * Supports processing multiple tree-nodes for nested parallelism
  * Able to reduce histograms across threads in efficient way
+ *
+ * Any thread can work on any node, buffers are bound to {tid, nid} pairs and allocated
+ * only when the pair is first used.  So it works with `ParallelFor2dSteal` where the
+ * mapping between threads and blocks is not known in advance.
  */
 template<typename GradientSumT>
 class ParallelGHistBuilder {
  public:
   using GHistRowT = GHistRow<GradientSumT>;
+  using GradientPairT = xgboost::detail::GradientPairInternal<GradientSumT>;
 
   void Init(size_t nbins) {
     if (nbins != nbins_) {
@@ -422,7 +702,6 @@ class ParallelGHistBuilder {
   void Reset(size_t nthreads, size_t nodes, const BlockedSpace2d& space,
              const std::vector<GHistRowT>& targeted_hists) {
     hist_buffer_.Init(nbins_);
-    tid_nid_to_hist_.clear();
     threads_to_nids_map_.clear();
 
     targeted_hists_ = targeted_hists;
@@ -433,11 +712,59 @@ class ParallelGHistBuilder {
     nthreads_ = nthreads;
 
     MatchThreadsToNodes(space);
-    AllocateAdditionalHistograms();
     MatchNodeNidPairToHist();
 
     hist_was_used_.resize(nthreads * nodes_);
     std::fill(hist_was_used_.begin(), hist_was_used_.end(), static_cast<int>(false));
+
+    if (block_rows_ != 0) {
+      block_n_rows_.resize(nthreads * nodes_);
+      std::fill(block_n_rows_.begin(), block_n_rows_.end(), 0);
+      if (precise_.size() < nodes_) {
+        precise_.resize(nodes_);
+        precise_locks_.reset(new std::mutex[nodes_]);
+      }
+      precise_used_.resize(nodes_);
+      std::fill(precise_used_.begin(), precise_used_.end(), static_cast<int>(false));
+    }
+  }
+
+  /**
+   * \brief Bound the number of rows accumulated in each histogram handed out by
+   *        `GetInitializedHist`.  Once rows added by a thread to a node reach `block_rows`,
+   *        its histogram is flushed into a double precision histogram of the node, and
+   *        `ReduceHist` sums them in double precision.  Keeps single precision histograms
+   *        accurate for large nodes.  0 means disabled.  Must be called before `Reset`.
+   */
+  void SetBlockRows(size_t block_rows) { block_rows_ = block_rows; }
+
+  /*! \brief Record the number of rows thread `tid` has added to its histogram of `nid`. */
+  void AddRows(size_t tid, size_t nid, size_t n_rows) {
+    if (block_rows_ == 0) {
+      return;
+    }
+    auto& block_n_rows = block_n_rows_[tid * nodes_ + nid];
+    block_n_rows += n_rows;
+    if (block_n_rows < block_rows_) {
+      return;
+    }
+    block_n_rows = 0;
+    int idx = tid_nid_to_hist_[tid * nodes_ + nid];
+    CHECK_NE(idx, static_cast<int>(kUnbound));
+    GHistRowT hist = idx == -1 ? targeted_hists_[nid] : hist_buffer_[idx];
+    {
+      std::lock_guard<std::mutex> guard{precise_locks_[nid]};
+      auto& precise = precise_[nid];
+      if (!precise_used_[nid]) {
+        precise.resize(nbins_);
+        std::fill(precise.begin(), precise.end(), GradientPairPrecise{});
+        precise_used_[nid] = static_cast<int>(true);
+      }
+      for (size_t i = 0; i < hist.size(); ++i) {
+        precise[i] += GradientPairPrecise{hist[i]};
+      }
+    }
+    InitilizeHistByZeroes(hist, 0, hist.size());
   }
 
   // Get specified hist, initialize hist by zeros if it wasn't used before
@@ -445,7 +772,13 @@ class ParallelGHistBuilder {
     CHECK_LT(nid, nodes_);
     CHECK_LT(tid, nthreads_);
 
-    int idx = tid_nid_to_hist_.at({tid, nid});
+    int idx = tid_nid_to_hist_[tid * nodes_ + nid];
+    if (idx == kUnbound) {
+      // Only thread `tid` binds this pair, and buffers are handed out in the order of use
+      // to keep them compact across resets.
+      idx = static_cast<int>(n_bound_.fetch_add(1, std::memory_order_relaxed));
+      tid_nid_to_hist_[tid * nodes_ + nid] = idx;
+    }
     if (idx >= 0) {
       hist_buffer_.AllocateData(idx);
     }
@@ -465,17 +798,39 @@ class ParallelGHistBuilder {
     CHECK_LT(nid, nodes_);
 
     GHistRowT dst = targeted_hists_[nid];
+    if (block_rows_ != 0) {
+      // Sum in double precision, rounded once into the target histogram.
+      std::vector<GradientPairPrecise> sum(end - begin);
+      if (precise_used_[nid]) {
+        std::copy(precise_[nid].cbegin() + begin, precise_[nid].cbegin() + end, sum.begin());
+      }
+      for (size_t tid = 0; tid < nthreads_; ++tid) {
+        int idx = tid_nid_to_hist_[tid * nodes_ + nid];
+        if (idx != kUnbound && hist_was_used_[tid * nodes_ + nid]) {
+          GHistRowT src = idx == -1 ? dst : hist_buffer_[idx];
+          for (size_t i = begin; i < end; ++i) {
+            sum[i - begin] += GradientPairPrecise{src[i]};
+          }
+        }
+      }
+      for (size_t i = begin; i < end; ++i) {
+        dst[i] = GradientPairT{sum[i - begin]};
+      }
+      return;
+    }
 
-    bool is_updated = false;
+    // The thread owning the target histogram might not have worked on this node, in which
+    // case the first used buffer is copied instead of accumulated.
+    bool is_updated = hist_was_used_[node_owner_[nid] * nodes_ + nid];
     for (size_t tid = 0; tid < nthreads_; ++tid) {
-      if (hist_was_used_[tid * nodes_ + nid]) {
-        is_updated = true;
-
-        int idx = tid_nid_to_hist_.at({tid, nid});
-        GHistRowT src = idx == -1 ? targeted_hists_[nid] : hist_buffer_[idx];
-
-        if (dst.data() != src.data()) {
+      int idx = tid_nid_to_hist_[tid * nodes_ + nid];
+      if (idx >= 0 && hist_was_used_[tid * nodes_ + nid]) {
+        GHistRowT src = hist_buffer_[idx];
+        if (is_updated) {
           IncrementHist(dst, src, begin, end);
+        } else {
+          CopyHist(dst, src, begin, end);
+          is_updated = true;
         }
       }
     }
@@ -508,48 +863,35 @@ class ParallelGHistBuilder {
     }
   }
 
-  void AllocateAdditionalHistograms() {
-    size_t hist_allocated_additionally = 0;
+  /*! \brief Thread writing directly into the targeted histogram of node. */
+  size_t NodeOwner(size_t nid) const { return node_owner_.at(nid); }
 
+ private:
+  void MatchNodeNidPairToHist() {
+    // The first thread statically scheduled for a node writes into the targeted hist,
+    // other pairs are bound to a buffer by `GetInitializedHist` once they are used.
+    node_owner_.resize(nodes_);
+    tid_nid_to_hist_.resize(nthreads_ * nodes_);
+    std::fill(tid_nid_to_hist_.begin(), tid_nid_to_hist_.end(), kUnbound);
     for (size_t nid = 0; nid < nodes_; ++nid) {
-      int nthreads_for_nid = 0;
-
+      node_owner_[nid] = 0;
       for (size_t tid = 0; tid < nthreads_; ++tid) {
         if (threads_to_nids_map_[tid * nodes_ + nid]) {
-          nthreads_for_nid++;
+          node_owner_[nid] = tid;
+          break;
         }
       }
-
-      // In distributed mode - some tree nodes can be empty on local machines,
-      // set nthreads_for_nid to 0 in this case.
-      // In another case - allocate additional (nthreads_for_nid - 1) histograms,
-      // because one is already allocated externally (will store final result for the node).
-      hist_allocated_additionally += std::max<int>(0, nthreads_for_nid - 1);
+      tid_nid_to_hist_[node_owner_[nid] * nodes_ + nid] = -1;
     }
-
-    for (size_t i = 0; i < hist_allocated_additionally; ++i) {
+    // Entries are cheap, memory is allocated only for buffers being used.
+    size_t n_buffers = (nthreads_ - 1) * nodes_;
+    for (size_t i = 0; i < n_buffers; ++i) {
       hist_buffer_.AddHistRow(i);
     }
+    n_bound_.store(0, std::memory_order_relaxed);
   }
 
- private:
-  void MatchNodeNidPairToHist() {
-    size_t hist_allocated_additionally = 0;
-
-    for (size_t nid = 0; nid < nodes_; ++nid) {
-      bool first_hist = true;
-      for (size_t tid = 0; tid < nthreads_; ++tid) {
-        if (threads_to_nids_map_[tid * nodes_ + nid]) {
-          if (first_hist) {
-            tid_nid_to_hist_[{tid, nid}] = -1;
-            first_hist = false;
-          } else {
-            tid_nid_to_hist_[{tid, nid}] = hist_allocated_additionally++;
-          }
-        }
-      }
-    }
-  }
+  enum : int { kUnbound = -2 };
 
   /*! \brief number of bins in each histogram */
   size_t nbins_ = 0;
@@ -571,10 +913,23 @@ class ParallelGHistBuilder {
   /*! \brief Contains histograms for final results  */
   std::vector<GHistRowT> targeted_hists_;
   /*!
-   * \brief map pair {tid, nid} to index of allocated histogram from hist_buffer_ and targeted_hists_,
-   * -1 is reserved for targeted_hists_
+   * \brief map pair {tid, nid} (as tid * nodes_ + nid) to index of histogram from
+   * hist_buffer_ and targeted_hists_, -1 is reserved for targeted_hists_ and -2 for
+   * pairs not being used yet.
    */
-  std::map<std::pair<size_t, size_t>, int> tid_nid_to_hist_;
+  std::vector<int> tid_nid_to_hist_;
+  /*! \brief Thread writing into targeted_hists_ for each node */
+  std::vector<size_t> node_owner_;
+  /*! \brief Number of buffers in hist_buffer_ bound to {tid, nid} pairs */
+  std::atomic<size_t> n_bound_{0};
+  /*! \brief Rows accumulated in a histogram before it's flushed, 0 means never */
+  size_t block_rows_{0};
+  /*! \brief Rows added to each {tid, nid} histogram since the last flush */
+  std::vector<size_t> block_n_rows_;
+  /*! \brief Double precision histogram of each node receiving flushed histograms */
+  std::vector<std::vector<GradientPairPrecise>> precise_;
+  std::vector<int> precise_used_;
+  std::unique_ptr<std::mutex[]> precise_locks_;
 };
 
 /*!
@@ -593,6 +948,17 @@ class GHistBuilder {
   void BuildHist(const std::vector<GradientPair> &gpair,
                  const RowSetCollection::Elem row_indices,
                  const GHistIndexMatrix &gmat, GHistRowT hist) const;
+  /**
+   * \brief Build histogram for a node with few rows, without touching the bins that
+   *        have no entry.
+   *
+   * \param scratch Histogram with all bins being zero, restored to zero on return.
+   * \param out     Bins with entries and their statistics, sorted by bin index.
+   */
+  template <bool any_missing>
+  void BuildSparseHist(const std::vector<GradientPair> &gpair,
+                       const RowSetCollection::Elem row_indices, const GHistIndexMatrix &gmat,
+                       GHistRowT scratch, SparseHistRow<GradientSumT> *out) const;
   uint32_t GetNumBins() const {
       return nbins_;
   }
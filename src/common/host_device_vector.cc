@@ -12,24 +12,38 @@
 #include <utility>
 #include "xgboost/tree_model.h"
 #include "xgboost/host_device_vector.h"
+#include "memory_tracker.h"
 
 namespace xgboost {
 
 template <typename T>
 struct HostDeviceVectorImpl {
-  explicit HostDeviceVectorImpl(size_t size, T v) : data_h_(size, v) {}
-  HostDeviceVectorImpl(std::initializer_list<T> init) : data_h_(init) {}
-  explicit HostDeviceVectorImpl(std::vector<T>  init) : data_h_(std::move(init)) {}
-  HostDeviceVectorImpl(HostDeviceVectorImpl&& that) : data_h_(std::move(that.data_h_)) {}
+  explicit HostDeviceVectorImpl(size_t size, T v) : data_h_(size, v) { this->Track(); }
+  HostDeviceVectorImpl(std::initializer_list<T> init) : data_h_(init) { this->Track(); }
+  explicit HostDeviceVectorImpl(std::vector<T>  init) : data_h_(std::move(init)) {
+    this->Track();
+  }
+  HostDeviceVectorImpl(HostDeviceVectorImpl&& that)
+      : kind{that.kind}, data_h_(std::move(that.data_h_)), tracked_(std::move(that.tracked_)) {}
 
   void Swap(HostDeviceVectorImpl &other) {
      data_h_.swap(other.data_h_);
+     std::swap(tracked_, other.tracked_);
+  }
+
+  // The vector can be resized through the returned reference, its size is recorded on
+  // the next access.
+  std::vector<T>& Vec() {
+    this->Track();
+    return data_h_;
   }
+  void Track() { tracked_.Update(data_h_.capacity() * sizeof(T)); }
 
-  std::vector<T>& Vec() { return data_h_; }
+  HostMemory kind{HostMemory::kPageable};
 
  private:
   std::vector<T> data_h_;
+  common::TrackedBytes tracked_{common::MemoryTracker::kHostDeviceVectorHost};
 };
 
 template <typename T>
@@ -112,6 +126,7 @@ const std::vector<T>& HostDeviceVector<T>::ConstHostVector() const {
 template <typename T>
 void HostDeviceVector<T>::Resize(size_t new_size, T v) {
   impl_->Vec().resize(new_size, v);
+  impl_->Track();
 }
 
 template <typename T>
@@ -168,6 +183,19 @@ bool HostDeviceVector<T>::DeviceCanWrite() const {
 template <typename T>
 void HostDeviceVector<T>::SetDevice(int) const {}
 
+template <typename T>
+void HostDeviceVector<T>::SetHostMemory(HostMemory kind) const {
+  impl_->kind = kind;
+}
+
+template <typename T>
+HostMemory HostDeviceVector<T>::GetHostMemory() const {
+  return impl_->kind;
+}
+
+template <typename T>
+void HostDeviceVector<T>::PrefetchHost() const {}
+
 // explicit instantiations are required, as HostDeviceVector isn't header-only
 template class HostDeviceVector<bst_float>;
 template class HostDeviceVector<double>;
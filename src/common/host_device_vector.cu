@@ -13,6 +13,7 @@
 #include "xgboost/host_device_vector.h"
 #include "xgboost/tree_model.h"
 #include "device_helpers.cuh"
+#include "memory_tracker.h"
 
 namespace xgboost {
 
@@ -34,6 +35,7 @@ class HostDeviceVectorImpl {
     } else {
       data_h_.resize(size, v);
     }
+    this->Track();
   }
 
   // Initializer can be std::vector<T> or std::initializer_list<T>
@@ -46,18 +48,34 @@ class HostDeviceVectorImpl {
     } else {
       data_h_ = init;
     }
+    this->Track();
   }
 
   HostDeviceVectorImpl(HostDeviceVectorImpl<T>&& that) :
     device_{that.device_},
     data_h_{std::move(that.data_h_)},
     data_d_{std::move(that.data_d_)},
-    gpu_access_{that.gpu_access_} {}
+    gpu_access_{that.gpu_access_},
+    tracked_h_{std::move(that.tracked_h_)},
+    tracked_d_{std::move(that.tracked_d_)},
+    host_memory_{that.host_memory_},
+    stream_{that.stream_},
+    pinned_{std::move(that.pinned_)},
+    event_{that.event_},
+    prefetched_{that.prefetched_} {
+    that.event_ = nullptr;
+    that.prefetched_ = false;
+  }
 
   ~HostDeviceVectorImpl() {
     if (device_ >= 0) {
       SetDevice();
     }
+    if (event_) {
+      // Might be called during program exit, errors are ignored.
+      cudaEventSynchronize(event_);
+      cudaEventDestroy(event_);
+    }
   }
 
   size_t Size() const {
@@ -91,6 +109,8 @@ class HostDeviceVectorImpl {
       std::fill(data_h_.begin(), data_h_.end(), v);
     } else {
       gpu_access_ = GPUAccess::kWrite;
+      prefetched_ = false;
+      this->ReleaseHost();
       SetDevice();
       auto s_data = dh::ToSpan(*data_d_);
       dh::LaunchN(data_d_->size(),
@@ -147,13 +167,17 @@ class HostDeviceVectorImpl {
     }
   }
 
+  // The host vector can be resized through the returned reference, its size is recorded
+  // on the next access.
   std::vector<T>& HostVector() {
     LazySyncHost(GPUAccess::kNone);
+    this->Track();
     return data_h_;
   }
 
   const std::vector<T>& ConstHostVector() {
     LazySyncHost(GPUAccess::kRead);
+    this->Track();
     return data_h_;
   }
 
@@ -161,6 +185,8 @@ class HostDeviceVectorImpl {
     if (device_ == device) { return; }
     if (device_ >= 0) {
       LazySyncHost(GPUAccess::kNone);
+      // The event belongs to the old device.
+      this->ReleaseStaging();
     }
     device_ = device;
     if (device_ >= 0) {
@@ -173,6 +199,7 @@ class HostDeviceVectorImpl {
     if ((Size() == 0 && device_ >= 0) || (DeviceCanWrite() && device_ >= 0)) {
       // fast on-device resize
       gpu_access_ = GPUAccess::kWrite;
+      prefetched_ = false;
       SetDevice();
       data_d_->resize(new_size, v);
     } else {
@@ -180,6 +207,7 @@ class HostDeviceVectorImpl {
       LazySyncHost(GPUAccess::kNone);
       data_h_.resize(new_size, v);
     }
+    this->Track();
   }
 
   void LazySyncHost(GPUAccess access) {
@@ -189,32 +217,81 @@ class HostDeviceVectorImpl {
       gpu_access_ = access;
       return;
     }
-    gpu_access_ = access;
-    if (data_h_.size() != data_d_->size()) { data_h_.resize(data_d_->size()); }
+    CHECK(host_memory_ != HostMemory::kDeviceOnly)
+        << "Data of a device only vector can not be accessed on host.";
+    if (data_h_.size() != data_d_->size()) {
+      data_h_.resize(data_d_->size());
+      this->Track();
+    }
     SetDevice();
-    dh::safe_cuda(cudaMemcpy(data_h_.data(),
-                             data_d_->data().get(),
-                             data_d_->size() * sizeof(T),
-                             cudaMemcpyDeviceToHost));
+    if (host_memory_ == HostMemory::kPinned) {
+      this->PrefetchHost();
+      prefetched_ = false;
+      dh::safe_cuda(cudaEventSynchronize(event_));
+      std::copy_n(static_cast<T const*>(pinned_->temp_storage), data_h_.size(),
+                  data_h_.data());
+    } else {
+      dh::safe_cuda(cudaMemcpyAsync(data_h_.data(),
+                                    data_d_->data().get(),
+                                    data_d_->size() * sizeof(T),
+                                    cudaMemcpyDeviceToHost, stream_));
+      dh::safe_cuda(cudaStreamSynchronize(stream_));
+    }
+    gpu_access_ = access;
   }
 
   void LazySyncDevice(GPUAccess access) {
+    if (access == GPUAccess::kWrite) {
+      prefetched_ = false;
+    }
     if (DeviceCanAccess(access)) { return; }
     if (DeviceCanRead()) {
       // deny read to the host
       gpu_access_ = access;
+      this->ReleaseHost();
       return;
     }
     // data is on the host
     LazyResizeDevice(data_h_.size());
     SetDevice();
-    dh::safe_cuda(cudaMemcpyAsync(data_d_->data().get(),
-                                  data_h_.data(),
-                                  data_d_->size() * sizeof(T),
-                                  cudaMemcpyHostToDevice));
+    if (host_memory_ == HostMemory::kPinned) {
+      // Stage through the pinned buffer so that the copy doesn't block the host.
+      auto staging = this->Staging(data_h_.size());
+      std::copy(data_h_.cbegin(), data_h_.cend(), staging.begin());
+      dh::safe_cuda(cudaMemcpyAsync(data_d_->data().get(), staging.data(),
+                                    staging.size_bytes(), cudaMemcpyHostToDevice, stream_));
+      dh::safe_cuda(cudaEventRecord(event_, stream_));
+    } else {
+      dh::safe_cuda(cudaMemcpyAsync(data_d_->data().get(),
+                                    data_h_.data(),
+                                    data_d_->size() * sizeof(T),
+                                    cudaMemcpyHostToDevice, stream_));
+    }
     gpu_access_ = access;
+    this->ReleaseHost();
   }
 
+  void PrefetchHost() {
+    if (host_memory_ != HostMemory::kPinned || HostCanRead() || prefetched_) {
+      return;
+    }
+    SetDevice();
+    auto staging = this->Staging(data_d_->size());
+    dh::safe_cuda(cudaMemcpyAsync(staging.data(), data_d_->data().get(), staging.size_bytes(),
+                                  cudaMemcpyDeviceToHost, stream_));
+    dh::safe_cuda(cudaEventRecord(event_, stream_));
+    prefetched_ = true;
+  }
+
+  void SetHostMemory(HostMemory kind) {
+    if (kind == host_memory_) { return; }
+    this->ReleaseStaging();
+    host_memory_ = kind;
+    this->ReleaseHost();
+  }
+  HostMemory GetHostMemory() const { return host_memory_; }
+  void SetStream(cudaStream_t stream) { stream_ = stream; }
+
   bool HostCanAccess(GPUAccess access) const { return gpu_access_ <= access; }
   bool HostCanRead() const { return HostCanAccess(GPUAccess::kRead); }
   bool HostCanWrite() const { return HostCanAccess(GPUAccess::kNone); }
@@ -228,8 +305,53 @@ class HostDeviceVectorImpl {
   std::vector<T> data_h_{};
   std::unique_ptr<dh::device_vector<T>> data_d_{};
   GPUAccess gpu_access_{GPUAccess::kNone};
+  common::TrackedBytes tracked_h_{common::MemoryTracker::kHostDeviceVectorHost};
+  common::TrackedBytes tracked_d_{common::MemoryTracker::kHostDeviceVectorDevice};
+  HostMemory host_memory_{HostMemory::kPageable};
+  cudaStream_t stream_{nullptr};
+  // Staging buffer for transfers of pinned vectors, created on the first transfer.
+  std::unique_ptr<dh::PinnedMemory> pinned_;
+  // Recorded after the last transfer using the staging buffer.
+  cudaEvent_t event_{nullptr};
+  // Whether the staging buffer holds an up-to-date copy of device data.
+  bool prefetched_{false};
+
+  common::Span<T> Staging(size_t n) {
+    if (!pinned_) {
+      pinned_.reset(new dh::PinnedMemory);
+      dh::safe_cuda(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
+    }
+    // The buffer might still be read by the previous transfer.
+    dh::safe_cuda(cudaEventSynchronize(event_));
+    return pinned_->GetSpan<T>(n);
+  }
+
+  void ReleaseStaging() {
+    if (!pinned_) { return; }
+    // Device data is still valid, only pending transfers need to finish.
+    dh::safe_cuda(cudaEventSynchronize(event_));
+    dh::safe_cuda(cudaEventDestroy(event_));
+    event_ = nullptr;
+    pinned_.reset();
+    prefetched_ = false;
+  }
+
+  // Drop the host copy of a device only vector once the device owns the data.
+  void ReleaseHost() {
+    if (host_memory_ == HostMemory::kDeviceOnly && gpu_access_ == GPUAccess::kWrite &&
+        !data_h_.empty()) {
+      std::vector<T>{}.swap(data_h_);
+      this->Track();
+    }
+  }
+
+  void Track() {
+    tracked_h_.Update(data_h_.capacity() * sizeof(T));
+    tracked_d_.Update(data_d_ ? data_d_->capacity() * sizeof(T) : 0);
+  }
 
   void CopyToDevice(HostDeviceVectorImpl* other) {
+    prefetched_ = false;
     if (other->HostCanWrite()) {
       CopyToDevice(other->data_h_.data());
     } else {
@@ -244,6 +366,8 @@ class HostDeviceVectorImpl {
   void CopyToDevice(const T* begin) {
     LazyResizeDevice(Size());
     gpu_access_ = GPUAccess::kWrite;
+    prefetched_ = false;
+    this->ReleaseHost();
     SetDevice();
     dh::safe_cuda(cudaMemcpyAsync(data_d_->data().get(), begin,
                                   data_d_->size() * sizeof(T), cudaMemcpyDefault));
@@ -253,6 +377,7 @@ class HostDeviceVectorImpl {
     if (data_d_ && new_size == data_d_->size()) { return; }
     SetDevice();
     data_d_->resize(new_size);
+    this->Track();
   }
 
   void SetDevice() {
@@ -391,6 +516,26 @@ void HostDeviceVector<T>::SetDevice(int device) const {
   impl_->SetDevice(device);
 }
 
+template <typename T>
+void HostDeviceVector<T>::SetHostMemory(HostMemory kind) const {
+  impl_->SetHostMemory(kind);
+}
+
+template <typename T>
+HostMemory HostDeviceVector<T>::GetHostMemory() const {
+  return impl_->GetHostMemory();
+}
+
+template <typename T>
+void HostDeviceVector<T>::PrefetchHost() const {
+  impl_->PrefetchHost();
+}
+
+template <typename T>
+void HostDeviceVector<T>::SetStream(cudaStream_t stream) const {
+  impl_->SetStream(stream);
+}
+
 template <typename T>
 void HostDeviceVector<T>::Resize(size_t new_size, T v) {
   impl_->Resize(new_size, v);
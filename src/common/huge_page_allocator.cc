@@ -0,0 +1,145 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif  // defined(__linux__)
+#if defined(_WIN32)
+#include <malloc.h>
+#endif  // defined(_WIN32)
+
+#include <atomic>
+#include <cstdlib>
+
+#include "huge_page_allocator.h"
+#include "perf_counters.h"
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace common {
+namespace detail {
+namespace {
+std::size_t constexpr kAlignment = 64;
+std::size_t constexpr kHugePageSize = 2 * 1024 * 1024;
+
+enum class Kind : int32_t { kAligned, kTransparent, kMapped };
+
+// Stored in front of the returned pointer, occupies one alignment unit.
+struct Header {
+  Kind kind;
+  std::size_t bytes;  // bytes of the whole allocation, including the header.
+};
+static_assert(sizeof(Header) <= kAlignment, "Header must fit into the alignment.");
+
+std::atomic<int32_t> mode{static_cast<int32_t>(HugePageMode::kNone)};
+std::atomic<int64_t> huge_page_bytes{0};
+
+void* AlignedAlloc(std::size_t alignment, std::size_t bytes) {
+#if defined(_WIN32)
+  return _aligned_malloc(bytes, alignment);
+#else
+  void* ptr{nullptr};
+  if (posix_memalign(&ptr, alignment, bytes) != 0) {
+    return nullptr;
+  }
+  return ptr;
+#endif  // defined(_WIN32)
+}
+
+void AlignedFree(void* ptr) {
+#if defined(_WIN32)
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif  // defined(_WIN32)
+}
+
+void AddHugePageBytes(int64_t bytes) {
+  auto value = huge_page_bytes.fetch_add(bytes) + bytes;
+  PerfCounters::Get()->Set(PerfCounters::kHugePageBytes, static_cast<uint64_t>(value));
+}
+}  // anonymous namespace
+
+void SetHugePageMode(std::string const& name) {
+  if (name == "none") {
+    mode = static_cast<int32_t>(HugePageMode::kNone);
+  } else if (name == "transparent") {
+    mode = static_cast<int32_t>(HugePageMode::kTransparent);
+  } else if (name == "explicit") {
+    mode = static_cast<int32_t>(HugePageMode::kExplicit);
+  } else {
+    LOG(FATAL) << "Unknown huge page mode: " << name
+               << ", expecting `none`, `transparent` or `explicit`.";
+  }
+}
+
+HugePageMode GetHugePageMode() { return static_cast<HugePageMode>(mode.load()); }
+
+void* AllocateLarge(std::size_t bytes) {
+  auto total = bytes + kAlignment;
+  auto huge = GetHugePageMode();
+  Header header{Kind::kAligned, total};
+  void* base{nullptr};
+#if defined(__linux__)
+  if (huge != HugePageMode::kNone && bytes >= kHugePageSize) {
+    auto rounded = (total + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    if (huge == HugePageMode::kExplicit) {
+      base = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (base == MAP_FAILED) {
+        base = nullptr;
+      } else {
+        header = Header{Kind::kMapped, rounded};
+      }
+    }
+    if (!base) {
+      base = AlignedAlloc(kHugePageSize, rounded);
+      if (base) {
+        // Only advice, failure leaves the memory backed by normal pages.
+        madvise(base, rounded, MADV_HUGEPAGE);
+        header = Header{Kind::kTransparent, rounded};
+      }
+    }
+    if (base) {
+      AddHugePageBytes(static_cast<int64_t>(header.bytes));
+    }
+  }
+#endif  // defined(__linux__)
+  if (!base) {
+    base = AlignedAlloc(kAlignment, total);
+  }
+  if (!base) {
+    throw std::bad_alloc{};
+  }
+  *static_cast<Header*>(base) = header;
+  return static_cast<char*>(base) + kAlignment;
+}
+
+void FreeLarge(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  void* base = static_cast<char*>(ptr) - kAlignment;
+  auto header = *static_cast<Header*>(base);
+  switch (header.kind) {
+    case Kind::kAligned: {
+      AlignedFree(base);
+      break;
+    }
+    case Kind::kTransparent: {
+      AddHugePageBytes(-static_cast<int64_t>(header.bytes));
+      AlignedFree(base);
+      break;
+    }
+    case Kind::kMapped: {
+      AddHugePageBytes(-static_cast<int64_t>(header.bytes));
+#if defined(__linux__)
+      munmap(base, header.bytes);
+#endif  // defined(__linux__)
+      break;
+    }
+  }
+}
+}  // namespace detail
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,75 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file huge_page_allocator.h
+ * \brief Allocator for large training buffers, backed by huge pages when requested.
+ */
+#ifndef XGBOOST_COMMON_HUGE_PAGE_ALLOCATOR_H_
+#define XGBOOST_COMMON_HUGE_PAGE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace xgboost {
+namespace common {
+namespace detail {
+enum class HugePageMode : int32_t {
+  kNone = 0,         // 64 bytes aligned allocation.
+  kTransparent = 1,  // advise the kernel to back the memory with transparent huge pages.
+  kExplicit = 2,     // map from the pool of reserved huge pages, fall back to transparent.
+};
+
+void SetHugePageMode(std::string const& name);
+HugePageMode GetHugePageMode();
+
+void* AllocateLarge(std::size_t bytes);
+void FreeLarge(void* ptr);
+}  // namespace detail
+
+/*!
+ * \brief Allocator returning 64 bytes aligned memory.  Allocations larger than 2MB are
+ *        backed by huge pages according to the `huge_pages` global parameter, which
+ *        reduces TLB misses when a buffer is accessed randomly, like bins during
+ *        histogram construction.
+ *
+ *   Same as `DefaultInitAllocator`, new elements are default initialized so the memory
+ *   is first touched by the threads filling it.
+ */
+template <typename T>
+class HugePageAllocator {
+ public:
+  using value_type = T;  // NOLINT
+
+  HugePageAllocator() = default;
+  template <typename U>
+  HugePageAllocator(HugePageAllocator<U> const&) {}  // NOLINT
+
+  T* allocate(std::size_t n) {  // NOLINT
+    return static_cast<T*>(detail::AllocateLarge(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, std::size_t) { detail::FreeLarge(ptr); }  // NOLINT
+
+  template <typename U>
+  void construct(U* ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {  // NOLINT
+    ::new (static_cast<void*>(ptr)) U;
+  }
+  template <typename U, typename... Args>
+  void construct(U* ptr, Args&&... args) {  // NOLINT
+    ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(HugePageAllocator<T> const&, HugePageAllocator<U> const&) {
+  return true;
+}
+template <typename T, typename U>
+bool operator!=(HugePageAllocator<T> const&, HugePageAllocator<U> const&) {
+  return false;
+}
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_HUGE_PAGE_ALLOCATOR_H_
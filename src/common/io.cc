@@ -1,12 +1,15 @@
 /*!
  * Copyright (c) by XGBoost Contributors 2019
  */
-#if defined(__unix__)
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
-#endif  // defined(__unix__)
+#define XGBOOST_HAS_MMAP 1
+#endif  // defined(__unix__) || defined(__APPLE__)
 #include <algorithm>
+#include <cerrno>
 #include <fstream>
 #include <string>
 #include <memory>
@@ -142,5 +145,44 @@ std::string LoadSequentialFile(std::string uri, bool stream) {
   buffer.resize(total);
   return buffer;
 }
+
+bool MmapFile::Supported(std::string const& path) {
+  auto parsed = dmlc::io::URI(path.c_str());
+  return parsed.protocol == "file://" || parsed.protocol.length() == 0;
+}
+
+MmapFile::MmapFile(std::string path) {
+  CHECK(Supported(path)) << "Memory map is not supported for: " << path;
+  auto parsed = dmlc::io::URI(path.c_str());
+  auto const& name = parsed.name;
+#if defined(XGBOOST_HAS_MMAP)
+  auto fd = open(name.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Failed to open " << name << ": " << strerror(errno);
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << name << ": " << strerror(errno);
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ != 0) {
+    auto ptr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    CHECK_NE(ptr, MAP_FAILED) << "Failed to map " << name << ": " << strerror(errno);
+    ptr_ = static_cast<char*>(ptr);
+  }
+  // The mapping is kept valid after closing the descriptor.
+  close(fd);
+#else
+  buffer_ = LoadSequentialFile(name);
+  // Remove the null terminator added by `LoadSequentialFile`.
+  buffer_.pop_back();
+  ptr_ = dmlc::BeginPtr(buffer_);
+  size_ = buffer_.size();
+#endif  // defined(XGBOOST_HAS_MMAP)
+}
+
+MmapFile::~MmapFile() {
+#if defined(XGBOOST_HAS_MMAP)
+  if (ptr_) {
+    munmap(ptr_, size_);
+  }
+#endif  // defined(XGBOOST_HAS_MMAP)
+}
 }  // namespace common
 }  // namespace xgboost
@@ -86,6 +86,32 @@ class FixedSizeStream : public PeekableInStream {
  */
 std::string LoadSequentialFile(std::string uri, bool stream = false);
 
+/*!
+ * \brief Read only memory mapped file.  The mapping is shared, so processes reading the
+ *        same file use the same physical memory in OS page cache and no read system call
+ *        is needed for pages that are already resident.  On platforms without mmap the
+ *        whole file is loaded into memory instead.
+ */
+class MmapFile {
+  char* ptr_{nullptr};
+  size_t size_{0};
+  // Used when mmap is not available.
+  std::string buffer_;
+
+ public:
+  explicit MmapFile(std::string path);
+  ~MmapFile();
+
+  MmapFile(MmapFile const&) = delete;
+  MmapFile& operator=(MmapFile const&) = delete;
+
+  char const* Data() const { return ptr_; }
+  size_t Size() const { return size_; }
+
+  /*! \brief Whether the file can be mapped, remote URIs are not supported. */
+  static bool Supported(std::string const& path);
+};
+
 inline std::string FileExtension(std::string const& fname) {
   auto splited = Split(fname, '.');
   if (splited.size() > 1) {
@@ -3,6 +3,8 @@
  */
 #include "xgboost/json.h"
 
+#include <dmlc/endian.h>
+
 #include <cctype>
 #include <cmath>
 #include <cstddef>
@@ -37,6 +39,40 @@ void JsonWriter::Visit(JsonArray const* arr) {
   stream_->emplace_back(']');
 }
 
+namespace {
+template <typename T>
+void WriteTextNumber(T value, std::vector<char>* stream) {
+  char number[NumericLimits<T>::kToCharsSize];
+  auto res = to_chars(number, number + sizeof(number), value);
+  auto end = res.ptr;
+  auto ori_size = stream->size();
+  stream->resize(ori_size + (end - number));
+  std::memcpy(stream->data() + ori_size, number, end - number);
+}
+
+template <typename T>
+void WriteTextArray(std::vector<T> const& vec, std::vector<char>* stream) {
+  // charconv supports only float and int64.
+  using OutT = typename std::conditional<std::is_integral<T>::value, int64_t, T>::type;
+  stream->emplace_back('[');
+  for (size_t i = 0; i < vec.size(); ++i) {
+    WriteTextNumber(static_cast<OutT>(vec[i]), stream);
+    if (i != vec.size() - 1) {
+      stream->emplace_back(',');
+    }
+  }
+  stream->emplace_back(']');
+}
+}  // anonymous namespace
+
+void JsonWriter::Visit(F32Array const* arr) { WriteTextArray(arr->GetArray(), stream_); }
+
+void JsonWriter::Visit(U8Array const* arr) { WriteTextArray(arr->GetArray(), stream_); }
+
+void JsonWriter::Visit(I32Array const* arr) { WriteTextArray(arr->GetArray(), stream_); }
+
+void JsonWriter::Visit(I64Array const* arr) { WriteTextArray(arr->GetArray(), stream_); }
+
 void JsonWriter::Visit(JsonObject const* obj) {
   stream_->emplace_back('{');
   size_t i = 0;
@@ -159,6 +195,10 @@ std::string Value::TypeStr() const {
     case ValueKind::kBoolean: return "Boolean"; break;
     case ValueKind::kNull:    return "Null";    break;
     case ValueKind::kInteger: return "Integer"; break;
+    case ValueKind::kF32Array: return "F32Array"; break;
+    case ValueKind::kU8Array: return "U8Array"; break;
+    case ValueKind::kI32Array: return "I32Array"; break;
+    case ValueKind::kI64Array: return "I64Array"; break;
   }
   return "";
 }
@@ -264,6 +304,53 @@ void JsonArray::Save(JsonWriter* writer) {
   writer->Visit(this);
 }
 
+// Json typed array
+template <typename T, Value::ValueKind kind>
+Json& JsonTypedArray<T, kind>::operator[](std::string const& ) {
+  LOG(FATAL) << "Object of type "
+             << Value::TypeStr() << " can not be indexed by string.";
+  return DummyJsonObject();
+}
+
+template <typename T, Value::ValueKind kind>
+Json& JsonTypedArray<T, kind>::operator[](int ) {
+  LOG(FATAL) << "Object of type "
+             << Value::TypeStr() << " can not be indexed by Integer."
+             << "  Please try obtaining the underlying vector first.";
+  return DummyJsonObject();
+}
+
+template <typename T, Value::ValueKind kind>
+bool JsonTypedArray<T, kind>::operator==(Value const& rhs) const {
+  if (!IsA<JsonTypedArray>(&rhs)) { return false; }
+  auto const& arr = Cast<JsonTypedArray const>(&rhs)->GetArray();
+  if (arr.size() != vec_.size()) { return false; }
+  for (size_t i = 0; i < arr.size(); ++i) {
+    // Same as JsonNumber, NaN equals NaN.
+    if (!(arr[i] == vec_[i] || (std::isnan(arr[i]) && std::isnan(vec_[i])))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, Value::ValueKind kind>
+Value& JsonTypedArray<T, kind>::operator=(Value const& rhs) {
+  auto const* casted = Cast<JsonTypedArray const>(&rhs);
+  vec_ = casted->GetArray();
+  return *this;
+}
+
+template <typename T, Value::ValueKind kind>
+void JsonTypedArray<T, kind>::Save(JsonWriter* writer) {
+  writer->Visit(this);
+}
+
+template class JsonTypedArray<float, Value::ValueKind::kF32Array>;
+template class JsonTypedArray<uint8_t, Value::ValueKind::kU8Array>;
+template class JsonTypedArray<int32_t, Value::ValueKind::kI32Array>;
+template class JsonTypedArray<int64_t, Value::ValueKind::kI64Array>;
+
 // Json Number
 Json& JsonNumber::operator[](std::string const& ) {
   LOG(FATAL) << "Object of type "
@@ -477,25 +564,26 @@ void JsonReader::SkipSpaces() {
   }
 }
 
-void ParseStr(std::string const& str) {
-  size_t end = 0;
-  for (size_t i = 0; i < str.size(); ++i) {
-    if (str[i] == '"' && i > 0 && str[i-1] != '\\') {
-      end = i;
-      break;
-    }
-  }
-  std::string result;
-  result.resize(end);
-}
-
-Json JsonReader::ParseString() {
-  char ch { GetConsecutiveChar('\"') };  // NOLINT
-  std::ostringstream output;
+std::string JsonReader::DecodeQuotedStr() {
+  GetConsecutiveChar('\"');
   std::string str;
+  auto const* beg = raw_str_.c_str();
+  auto const* end = beg + raw_str_.size();
   while (true) {
-    ch = GetNextChar();
-    if (ch == '\\') {
+    // Copy the plain characters in bulk, only quote, escape and line breaks need
+    // special treatment.
+    auto const* first = beg + cursor_.Pos();
+    auto const* last = first;
+    while (last != end && *last != '\"' && *last != '\\' && *last != '\n' && *last != '\r') {
+      ++last;
+    }
+    str.append(first, last);
+    cursor_.Forward(static_cast<size_t>(last - first));
+
+    char ch = GetNextChar();
+    if (ch == '\"') {
+      break;
+    } else if (ch == '\\') {
       char next = static_cast<char>(GetNextChar());
       switch (next) {
         case 'r':  str += u8"\r"; break;
@@ -510,14 +598,15 @@ Json JsonReader::ParseString() {
         default: Error("Unknown escape");
       }
     } else {
-      if (ch == '\"') break;
-      str += ch;
-    }
-    if (ch == EOF || ch == '\r' || ch == '\n') {
+      // EOF or line break.
       Expect('\"', ch);
     }
   }
-  return Json(std::move(str));
+  return str;
+}
+
+Json JsonReader::ParseString() {
+  return Json(this->DecodeQuotedStr());
 }
 
 Json JsonReader::ParseNull() {
@@ -541,8 +630,7 @@ Json JsonReader::ParseArray() {
       GetConsecutiveChar(']');
       return Json(std::move(data));
     }
-    auto obj = Parse();
-    data.emplace_back(obj);
+    data.emplace_back(Parse());
     ch = GetNextNonSpaceChar();
     if (ch == ']') break;
     if (ch != ',') {
@@ -573,7 +661,7 @@ Json JsonReader::ParseObject() {
     if (ch != '"') {
       Expect('"', ch);
     }
-    Json key = ParseString();
+    auto key = this->DecodeQuotedStr();
 
     ch = GetNextNonSpaceChar();
 
@@ -583,7 +671,10 @@ Json JsonReader::ParseObject() {
 
     Json value { Parse() };
 
-    data[get<String>(key)] = std::move(value);
+    // Keys written by JsonWriter are sorted, insert at the end without searching the
+    // tree.  Duplicated keys are overwritten by the last one.
+    auto it = data.emplace_hint(data.cend(), std::move(key), Json{});
+    it->second = std::move(value);
 
     ch = GetNextNonSpaceChar();
 
@@ -727,9 +818,15 @@ Json JsonReader::ParseBoolean() {
   return Json{JsonBoolean{result}};
 }
 
-Json Json::Load(StringView str) {
-  JsonReader reader(str);
-  Json json{reader.Load()};
+Json Json::Load(StringView str, std::ios::openmode mode) {
+  Json json;
+  if (mode & std::ios::binary) {
+    UBJReader reader(str);
+    json = reader.Load();
+  } else {
+    JsonReader reader(str);
+    json = reader.Load();
+  }
   return json;
 }
 
@@ -738,16 +835,293 @@ Json Json::Load(JsonReader* reader) {
   return json;
 }
 
-void Json::Dump(Json json, std::string* str) {
+void Json::Dump(Json json, std::string* str, std::ios::openmode mode) {
   std::vector<char> buffer;
-  JsonWriter writer(&buffer);
-  writer.Save(json);
+  Dump(json, &buffer, mode);
   str->resize(buffer.size());
   std::copy(buffer.cbegin(), buffer.cend(), str->begin());
 }
 
+void Json::Dump(Json json, std::vector<char>* str, std::ios::openmode mode) {
+  str->clear();
+  if (mode & std::ios::binary) {
+    UBJWriter writer{str};
+    writer.Save(json);
+  } else {
+    JsonWriter writer{str};
+    writer.Save(json);
+  }
+}
+
 Json& Json::operator=(Json const &other) = default;
 
+/*
+ * UBJSON
+ *
+ * Numbers are stored in big endian.  Lengths of strings and containers are written with
+ * the smallest integer type that fits.
+ */
+namespace {
+template <typename T>
+T ToBigEndian(T v) {
+  static_assert(std::is_pod<T>::value, "");
+#if DMLC_LITTLE_ENDIAN
+  dmlc::ByteSwap(&v, sizeof(v), 1);
+#endif  // DMLC_LITTLE_ENDIAN
+  return v;
+}
+
+template <typename T>
+void WritePrimitive(T v, std::vector<char>* stream) {
+  v = ToBigEndian(v);
+  auto s = stream->size();
+  stream->resize(s + sizeof(v));
+  std::memcpy(stream->data() + s, &v, sizeof(v));
+}
+
+void WriteLength(size_t n, std::vector<char>* stream) {
+  if (n <= std::numeric_limits<uint8_t>::max()) {
+    stream->push_back('U');
+    WritePrimitive(static_cast<uint8_t>(n), stream);
+  } else if (n <= static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    stream->push_back('l');
+    WritePrimitive(static_cast<int32_t>(n), stream);
+  } else {
+    stream->push_back('L');
+    WritePrimitive(static_cast<int64_t>(n), stream);
+  }
+}
+
+void EncodeStr(std::vector<char>* stream, std::string const& string) {
+  WriteLength(string.size(), stream);
+  auto s = stream->size();
+  stream->resize(s + string.size());
+  std::memcpy(stream->data() + s, string.data(), string.size());
+}
+
+template <typename T>
+void WriteTypedArray(char type, std::vector<T> const& vec, std::vector<char>* stream) {
+  stream->emplace_back('[');
+  stream->emplace_back('$');
+  stream->emplace_back(type);
+  stream->emplace_back('#');
+  WriteLength(vec.size(), stream);
+
+  auto s = stream->size();
+  stream->resize(s + vec.size() * sizeof(T));
+  auto ptr = stream->data() + s;
+  std::memcpy(ptr, vec.data(), vec.size() * sizeof(T));
+#if DMLC_LITTLE_ENDIAN
+  dmlc::ByteSwap(ptr, sizeof(T), vec.size());
+#endif  // DMLC_LITTLE_ENDIAN
+}
+}  // anonymous namespace
+
+void UBJWriter::Visit(JsonArray const* arr) {
+  stream_->emplace_back('[');
+  for (auto const& value : arr->GetArray()) {
+    this->Save(value);
+  }
+  stream_->emplace_back(']');
+}
+
+void UBJWriter::Visit(F32Array const* arr) { WriteTypedArray('d', arr->GetArray(), stream_); }
+
+void UBJWriter::Visit(U8Array const* arr) { WriteTypedArray('U', arr->GetArray(), stream_); }
+
+void UBJWriter::Visit(I32Array const* arr) { WriteTypedArray('l', arr->GetArray(), stream_); }
+
+void UBJWriter::Visit(I64Array const* arr) { WriteTypedArray('L', arr->GetArray(), stream_); }
+
+void UBJWriter::Visit(JsonObject const* obj) {
+  stream_->emplace_back('{');
+  for (auto const& value : obj->GetObject()) {
+    EncodeStr(stream_, value.first);
+    this->Save(value.second);
+  }
+  stream_->emplace_back('}');
+}
+
+void UBJWriter::Visit(JsonNumber const* num) {
+  stream_->emplace_back('d');
+  WritePrimitive(num->GetNumber(), stream_);
+}
+
+void UBJWriter::Visit(JsonInteger const* num) {
+  stream_->emplace_back('L');
+  WritePrimitive(num->GetInteger(), stream_);
+}
+
+void UBJWriter::Visit(JsonNull const*) { stream_->emplace_back('Z'); }
+
+void UBJWriter::Visit(JsonString const* str) {
+  stream_->emplace_back('S');
+  EncodeStr(stream_, str->GetString());
+}
+
+void UBJWriter::Visit(JsonBoolean const* boolean) {
+  stream_->emplace_back(boolean->GetBoolean() ? 'T' : 'F');
+}
+
+template <typename T>
+T UBJReader::ReadPrimitive() {
+  return ToBigEndian(this->ReadStream<T>());
+}
+
+int64_t UBJReader::ReadLength() {
+  int64_t n{0};
+  auto type = GetNextChar();
+  switch (type) {
+    case 'i': n = ReadPrimitive<int8_t>(); break;
+    case 'U': n = ReadPrimitive<uint8_t>(); break;
+    case 'I': n = ReadPrimitive<int16_t>(); break;
+    case 'l': n = ReadPrimitive<int32_t>(); break;
+    case 'L': n = ReadPrimitive<int64_t>(); break;
+    default: Error("Invalid type for length: " + std::to_string(type));
+  }
+  if (n < 0) {
+    Error("Negative length.");
+  }
+  return n;
+}
+
+std::string UBJReader::DecodeStr() {
+  auto n = static_cast<size_t>(this->ReadLength());
+  if (XGBOOST_EXPECT(cursor_.Pos() + n > raw_str_.size(), false)) {
+    Error("Unexpected end of UBJSON input.");
+  }
+  std::string str(raw_str_.c_str() + cursor_.Pos(), n);
+  cursor_.Forward(n);
+  return str;
+}
+
+template <typename TypedArray>
+Json UBJReader::ParseTypedArray(int64_t n) {
+  using T = typename TypedArray::Type;
+  size_t n_bytes = n * sizeof(T);
+  if (XGBOOST_EXPECT(cursor_.Pos() + n_bytes > raw_str_.size(), false)) {
+    Error("Unexpected end of UBJSON input.");
+  }
+  TypedArray results(n);
+  auto& vec = results.GetArray();
+  std::memcpy(vec.data(), raw_str_.c_str() + cursor_.Pos(), n_bytes);
+#if DMLC_LITTLE_ENDIAN
+  dmlc::ByteSwap(vec.data(), sizeof(T), vec.size());
+#endif  // DMLC_LITTLE_ENDIAN
+  cursor_.Forward(n_bytes);
+  return Json{std::move(results)};
+}
+
+Json UBJReader::ParseArray() {
+  // The '[' is consumed by Parse.
+  auto marker = PeekNextChar();
+  if (marker == '$') {
+    GetNextChar();
+    auto type = GetNextChar();
+    GetConsecutiveChar('#');
+    auto n = this->ReadLength();
+    switch (type) {
+      case 'd': return ParseTypedArray<F32Array>(n);
+      case 'U': return ParseTypedArray<U8Array>(n);
+      case 'l': return ParseTypedArray<I32Array>(n);
+      case 'L': return ParseTypedArray<I64Array>(n);
+      default: {
+        // Other strongly typed containers are loaded as normal arrays.
+        std::vector<Json> results;
+        results.reserve(n);
+        for (int64_t i = 0; i < n; ++i) {
+          results.emplace_back(this->ParseValue(type));
+        }
+        return Json{std::move(results)};
+      }
+    }
+  }
+
+  std::vector<Json> results;
+  if (marker == '#') {
+    GetNextChar();
+    auto n = this->ReadLength();
+    results.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+      results.emplace_back(this->Parse());
+    }
+    return Json{std::move(results)};
+  }
+
+  while (PeekNextChar() != ']') {
+    if (PeekNextChar() == -1) {
+      Error("Unexpected end of UBJSON input.");
+    }
+    results.emplace_back(this->Parse());
+  }
+  GetConsecutiveChar(']');
+  return Json{std::move(results)};
+}
+
+Json UBJReader::ParseObject() {
+  // The '{' is consumed by Parse.
+  std::map<std::string, Json> results;
+  if (PeekNextChar() == '#') {
+    GetNextChar();
+    auto n = this->ReadLength();
+    for (int64_t i = 0; i < n; ++i) {
+      auto key = this->DecodeStr();
+      auto it = results.emplace_hint(results.cend(), std::move(key), Json{});
+      it->second = this->Parse();
+    }
+    return Json{std::move(results)};
+  }
+
+  while (PeekNextChar() != '}') {
+    if (PeekNextChar() == -1) {
+      Error("Unexpected end of UBJSON input.");
+    }
+    auto key = this->DecodeStr();
+    auto it = results.emplace_hint(results.cend(), std::move(key), Json{});
+    it->second = this->Parse();
+  }
+  GetConsecutiveChar('}');
+  return Json{std::move(results)};
+}
+
+Json UBJReader::Load() {
+  Json result = this->Parse();
+  return result;
+}
+
+Json UBJReader::Parse() {
+  while (true) {
+    auto c = GetNextChar();
+    // no-op marker
+    if (c == 'N') {
+      continue;
+    }
+    return this->ParseValue(c);
+  }
+}
+
+Json UBJReader::ParseValue(char type) {
+  switch (type) {
+    case '{': return this->ParseObject();
+    case '[': return this->ParseArray();
+    case 'Z': return Json{JsonNull{}};
+    case 'T': return Json{JsonBoolean{true}};
+    case 'F': return Json{JsonBoolean{false}};
+    case 'i': return Json{JsonInteger{static_cast<Integer::Int>(ReadPrimitive<int8_t>())}};
+    case 'U': return Json{JsonInteger{static_cast<Integer::Int>(ReadPrimitive<uint8_t>())}};
+    case 'I': return Json{JsonInteger{static_cast<Integer::Int>(ReadPrimitive<int16_t>())}};
+    case 'l': return Json{JsonInteger{static_cast<Integer::Int>(ReadPrimitive<int32_t>())}};
+    case 'L': return Json{JsonInteger{ReadPrimitive<int64_t>()}};
+    case 'd': return Json{JsonNumber{ReadPrimitive<float>()}};
+    case 'D': return Json{JsonNumber{ReadPrimitive<double>()}};
+    case 'S': return Json{JsonString{this->DecodeStr()}};
+    case 'C': return Json{JsonString{std::string{static_cast<char>(ReadPrimitive<int8_t>())}}};
+    case -1: Error("Unexpected end of UBJSON input."); break;
+    default: Error("Unknown UBJSON type marker: " + std::to_string(type));
+  }
+  return {};
+}
+
 static_assert(std::is_nothrow_move_constructible<Json>::value, "");
 static_assert(std::is_nothrow_move_constructible<Object>::value, "");
 static_assert(std::is_nothrow_move_constructible<Array>::value, "");
@@ -11,6 +11,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -29,6 +31,79 @@ XGBOOST_DEVICE inline float Sigmoid(float x) {
 template <typename T>
 XGBOOST_DEVICE inline static T Sqr(T a) { return a * a; }
 
+/*!
+ * \brief Approximation of `expf` for non-positive inputs, used by CPU kernels.
+ *
+ *   The function is branch free so that loops calling it can be vectorized by the
+ *   compiler.  It follows the range reduction and polynomial of Cephes, with a relative
+ *   error below 1e-7 for x in [-87, 0].  Inputs below -87 return a value close to
+ *   `FLT_MIN` instead of a denormal.
+ */
+inline float ExpNonPositive(float x) {
+  constexpr float kLog2e = 1.44269504088896341f;
+  // ln(2) split into a part exactly representable with a few bits, and the remainder.
+  constexpr float kLn2Hi = 0.693359375f;
+  constexpr float kLn2Lo = -2.12194440e-4f;
+  x = std::min(std::max(x, -87.0f), 0.0f);
+  // round to nearest, x is non-positive.
+  auto n = static_cast<int32_t>(x * kLog2e - 0.5f);
+  auto fn = static_cast<float>(n);
+  x = x - fn * kLn2Hi - fn * kLn2Lo;
+  float z = x * x;
+  float y = 1.9875691500e-4f;
+  y = y * x + 1.3981999507e-3f;
+  y = y * x + 8.3334519073e-3f;
+  y = y * x + 4.1665795894e-2f;
+  y = y * x + 1.6666665459e-1f;
+  y = y * x + 5.0000001201e-1f;
+  y = y * z + x + 1.0f;
+  // 2^n
+  int32_t bits = (n + 127) << 23;
+  float scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return y * scale;
+}
+
+/*!
+ * \brief Branch free approximation of `expf` over the whole range, with the same
+ *        polynomial and error as `ExpNonPositive`.  Inputs above ln(FLT_MAX) return
+ *        infinity, inputs below -87 return a value close to `FLT_MIN`.
+ */
+inline float ExpBranchFree(float x) {
+  constexpr float kLog2e = 1.44269504088896341f;
+  constexpr float kLn2Hi = 0.693359375f;
+  constexpr float kLn2Lo = -2.12194440e-4f;
+  constexpr float kMax = 88.7228394f;
+  bool overflow = x > kMax;
+  float r = std::min(std::max(x, -87.0f), kMax);
+  // round to nearest by adding and subtracting 1.5 * 2^23
+  constexpr float kRound = 12582912.0f;
+  float fn = (r * kLog2e + kRound) - kRound;
+  auto n = static_cast<int32_t>(fn);
+  r = r - fn * kLn2Hi - fn * kLn2Lo;
+  float z = r * r;
+  float y = 1.9875691500e-4f;
+  y = y * r + 1.3981999507e-3f;
+  y = y * r + 8.3334519073e-3f;
+  y = y * r + 4.1665795894e-2f;
+  y = y * r + 1.6666665459e-1f;
+  y = y * r + 5.0000001201e-1f;
+  y = y * z + r + 1.0f;
+  // 2^n in two steps, as n reaches 128 near the upper bound.
+  int32_t half = n / 2;
+  int32_t bits_0 = (half + 127) << 23;
+  int32_t bits_1 = (n - half + 127) << 23;
+  float scale_0, scale_1;
+  std::memcpy(&scale_0, &bits_0, sizeof(scale_0));
+  std::memcpy(&scale_1, &bits_1, sizeof(scale_1));
+  return overflow ? std::numeric_limits<float>::infinity() : y * scale_0 * scale_1;
+}
+
+/*! \brief Sigmoid with `ExpBranchFree`, for CPU kernels that are vectorized. */
+inline float SigmoidBranchFree(float x) {
+  return 1.0f / (1.0f + ExpBranchFree(-x));
+}
+
 /*!
  * \brief Equality test for both integer and floating point.
  */
@@ -0,0 +1,62 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "memory_tracker.h"
+
+#include <dmlc/logging.h>
+
+namespace xgboost {
+namespace common {
+MemoryTracker::MemoryTracker() {
+  for (std::size_t i = 0; i < kNumOwners; ++i) {
+    current_[i].store(0, std::memory_order_relaxed);
+    peak_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+MemoryTracker* MemoryTracker::Get() {
+  static MemoryTracker tracker;
+  return &tracker;
+}
+
+void MemoryTracker::Allocate(Owner owner, int64_t bytes) {
+  auto value = current_[owner].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  auto peak = peak_[owner].load(std::memory_order_relaxed);
+  while (value > peak &&
+         !peak_[owner].compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+  }
+}
+
+void MemoryTracker::ResetPeak() {
+  for (std::size_t i = 0; i < kNumOwners; ++i) {
+    peak_[i].store(current_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+}
+
+char const* MemoryTracker::Name(Owner owner) {
+  switch (owner) {
+    case kHostDeviceVectorHost: return "host_device_vector_host";
+    case kHostDeviceVectorDevice: return "host_device_vector_device";
+    case kHistCollection: return "hist_collection";
+    case kGHistIndexMatrix: return "gradient_index";
+    case kColumnMatrix: return "column_matrix";
+    case kPredictionCache: return "prediction_cache";
+    case kPageRing: return "page_ring";
+    default: LOG(FATAL) << "Unknown owner: " << static_cast<std::size_t>(owner);
+  }
+  return "";
+}
+
+Json MemoryTracker::ToJson() const {
+  Json out{Object{}};
+  for (std::size_t i = 0; i < kNumOwners; ++i) {
+    auto owner = static_cast<Owner>(i);
+    Json entry{Object{}};
+    entry["current"] = Integer{static_cast<Integer::Int>(this->Current(owner))};
+    entry["peak"] = Integer{static_cast<Integer::Int>(this->Peak(owner))};
+    out[Name(owner)] = std::move(entry);
+  }
+  return out;
+}
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,109 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file memory_tracker.h
+ * \brief Optional accounting of memory held by major buffers, grouped by owner.
+ */
+#ifndef XGBOOST_COMMON_MEMORY_TRACKER_H_
+#define XGBOOST_COMMON_MEMORY_TRACKER_H_
+
+#include <xgboost/json.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace xgboost {
+namespace common {
+/*!
+ * \brief Process wide record of current and peak bytes for each owner.
+ *
+ *   Tracking is disabled by default, buffers allocated while it's disabled are not
+ *   accounted for.  `HostDeviceVector` is the storage for many of the other owners, so
+ *   its bytes overlap with theirs.
+ */
+class MemoryTracker {
+ public:
+  enum Owner : std::size_t {
+    kHostDeviceVectorHost = 0,
+    kHostDeviceVectorDevice,
+    kHistCollection,
+    kGHistIndexMatrix,
+    kColumnMatrix,
+    kPredictionCache,
+    kPageRing,
+    kNumOwners
+  };
+
+ private:
+  std::atomic<bool> enabled_{false};
+  std::array<std::atomic<int64_t>, kNumOwners> current_;
+  std::array<std::atomic<int64_t>, kNumOwners> peak_;
+
+  MemoryTracker();
+
+ public:
+  static MemoryTracker* Get();
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+  void Allocate(Owner owner, int64_t bytes);
+  void Free(Owner owner, int64_t bytes) { this->Allocate(owner, -bytes); }
+
+  int64_t Current(Owner owner) const {
+    return current_[owner].load(std::memory_order_relaxed);
+  }
+  int64_t Peak(Owner owner) const { return peak_[owner].load(std::memory_order_relaxed); }
+  /*! \brief Set peak of all owners to their current value. */
+  void ResetPeak();
+
+  static char const* Name(Owner owner);
+  /*! \brief {"owner": {"current": bytes, "peak": bytes}, ...} */
+  Json ToJson() const;
+};
+
+/*!
+ * \brief Bytes held by a single buffer.  The owning structure reports its new size after
+ *        each (re)allocation, the size is released on destruction.
+ */
+class TrackedBytes {
+  MemoryTracker::Owner owner_;
+  int64_t bytes_{0};
+
+ public:
+  explicit TrackedBytes(MemoryTracker::Owner owner) : owner_{owner} {}
+  TrackedBytes(TrackedBytes const& that) : owner_{that.owner_} { this->Update(that.bytes_); }
+  TrackedBytes(TrackedBytes&& that) : owner_{that.owner_}, bytes_{that.bytes_} {
+    that.bytes_ = 0;
+  }
+  TrackedBytes& operator=(TrackedBytes const& that) {
+    this->Update(that.bytes_);
+    return *this;
+  }
+  TrackedBytes& operator=(TrackedBytes&& that) {
+    this->Update(0);
+    owner_ = that.owner_;
+    bytes_ = that.bytes_;
+    that.bytes_ = 0;
+    return *this;
+  }
+  ~TrackedBytes() { this->Update(0); }
+
+  void Update(std::size_t bytes) {
+    auto tracker = MemoryTracker::Get();
+    // Once tracked, the buffer is followed until it's released even if tracking is
+    // disabled in between.
+    if (bytes_ == 0 && !tracker->Enabled()) {
+      return;
+    }
+    auto value = static_cast<int64_t>(bytes);
+    if (value != bytes_) {
+      tracker->Allocate(owner_, value - bytes_);
+      bytes_ = value;
+    }
+  }
+  std::size_t Bytes() const { return static_cast<std::size_t>(bytes_); }
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_MEMORY_TRACKER_H_
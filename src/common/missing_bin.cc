@@ -0,0 +1,88 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file missing_bin.cc
+ */
+#include "missing_bin.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+#include "column_matrix.h"
+#include "threading_utils.h"
+
+namespace xgboost {
+namespace common {
+MissingBins::MissingBins(GHistIndexMatrix const &gmat, int32_t n_threads) {
+  CHECK_EQ(gmat.base_rowid, 0) << "Missing bins require a single page.";
+  CHECK(!gmat.index.IsMixed());
+  auto const &ptrs = gmat.cut.Ptrs();
+  auto const &values = gmat.cut.Values();
+  auto n_features = static_cast<bst_feature_t>(ptrs.size() - 1);
+  size_t n_rows = gmat.Size();
+
+  // Cuts of the dense index, the missing bin has no split value.
+  auto &dense_ptrs = index_.cut.cut_ptrs_.HostVector();
+  auto &dense_values = index_.cut.cut_values_.HostVector();
+  dense_ptrs.assign(1, 0);
+  dense_values.clear();
+  index_.hit_count.clear();
+  index_.max_num_bins = 0;
+  for (bst_feature_t fidx = 0; fidx < n_features; ++fidx) {
+    auto n_bins = ptrs[fidx + 1] - ptrs[fidx];
+    dense_ptrs.push_back(dense_ptrs.back() + n_bins + 1);
+    dense_values.insert(dense_values.end(), values.cbegin() + ptrs[fidx],
+                        values.cbegin() + ptrs[fidx + 1]);
+    dense_values.push_back(std::numeric_limits<float>::infinity());
+    auto beg = gmat.hit_count.cbegin() + ptrs[fidx];
+    auto end = gmat.hit_count.cbegin() + ptrs[fidx + 1];
+    index_.hit_count.insert(index_.hit_count.end(), beg, end);
+    index_.hit_count.push_back(n_rows - std::accumulate(beg, end, static_cast<size_t>(0)));
+    index_.max_num_bins = std::max(index_.max_num_bins, static_cast<size_t>(n_bins + 1));
+  }
+  index_.cut.min_vals_.HostVector() = gmat.cut.MinValues();
+
+  index_.p_fmat = gmat.p_fmat;
+  index_.base_rowid = 0;
+  index_.SetDense(true);
+  index_.row_ptr.resize(n_rows + 1);
+  for (size_t r = 0; r <= n_rows; ++r) {
+    index_.row_ptr[r] = r * n_features;
+  }
+  index_.ResizeIndex(n_rows * n_features, true);
+  index_.index.ResizeOffset(n_features);
+  std::copy(dense_ptrs.cbegin(), dense_ptrs.cend() - 1, index_.index.Offset());
+
+  // Bins of a dense index are stored relative to the first bin of each feature.
+  auto bin_feature = ColumnMatrix::BinFeatureMap(gmat.cut);
+  auto fill = [&](auto *data) {
+    using BinIdxType = std::remove_pointer_t<decltype(data)>;
+    ParallelFor(n_rows, n_threads, [&](size_t r) {
+      auto *row = data + r * n_features;
+      for (bst_feature_t fidx = 0; fidx < n_features; ++fidx) {
+        row[fidx] = static_cast<BinIdxType>(ptrs[fidx + 1] - ptrs[fidx]);
+      }
+      for (auto i = gmat.row_ptr[r]; i < gmat.row_ptr[r + 1]; ++i) {
+        auto bin = gmat.index[i];
+        auto fidx = bin_feature[bin];
+        row[fidx] = static_cast<BinIdxType>(bin - ptrs[fidx]);
+      }
+    });
+  };
+  switch (index_.index.GetBinTypeSize()) {
+    case kUint8BinsTypeSize:
+      fill(index_.index.data<uint8_t>());
+      break;
+    case kUint16BinsTypeSize:
+      fill(index_.index.data<uint16_t>());
+      break;
+    case kUint32BinsTypeSize:
+      fill(index_.index.data<uint32_t>());
+      break;
+    default:
+      CHECK(false);  // no default behavior
+  }
+}
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,47 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file missing_bin.h
+ * \brief Dense layout of mostly dense quantized data with a bin for missing values.
+ */
+#ifndef XGBOOST_COMMON_MISSING_BIN_H_
+#define XGBOOST_COMMON_MISSING_BIN_H_
+
+#include <xgboost/span.h>
+
+#include <vector>
+
+#include "hist_util.h"
+#include "../data/gradient_index.h"
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief Dense copy of an index with missing values, so that histograms of mostly dense
+ *        data are built by the dense kernel.
+ *
+ *   Each feature keeps its bins in order followed by one more bin for rows where the
+ *   feature is missing, every row then has exactly one bin per feature.  The missing bin
+ *   is never used as a split candidate, it tells the evaluator whether a node has missing
+ *   values for the feature without comparing sums against the node statistics.
+ */
+class MissingBins {
+  GHistIndexMatrix index_;
+
+ public:
+  /**
+   * \param gmat      An index with a single page.
+   * \param n_threads Number of threads used to build the dense index.
+   */
+  MissingBins(GHistIndexMatrix const &gmat, int32_t n_threads);
+
+  size_t NumFeatures() const { return index_.cut.Ptrs().size() - 1; }
+  /*! \brief Dense index with one column for each feature, including its missing bin. */
+  GHistIndexMatrix const &Index() const { return index_; }
+  /*! \brief First bin of a feature in the dense index. */
+  uint32_t FeatureBegin(bst_feature_t fidx) const { return index_.cut.Ptrs()[fidx]; }
+  /*! \brief Bin of rows where the feature is missing, the last bin of the feature. */
+  uint32_t MissingBin(bst_feature_t fidx) const { return index_.cut.Ptrs()[fidx + 1] - 1; }
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_MISSING_BIN_H_
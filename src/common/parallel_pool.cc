@@ -0,0 +1,138 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "parallel_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace common {
+std::atomic<int32_t>& ParallelPool::BackendRef() {
+  static std::atomic<int32_t> backend{kOpenMP};
+  return backend;
+}
+
+int32_t& ParallelPool::LocalSlotRef() {
+  static thread_local int32_t slot{-1};
+  return slot;
+}
+
+void ParallelPool::SetBackend(std::string const& name) {
+  if (name == "omp") {
+    BackendRef().store(kOpenMP, std::memory_order_relaxed);
+  } else if (name == "pool") {
+    BackendRef().store(kPool, std::memory_order_relaxed);
+  } else {
+    LOG(FATAL) << "Unknown threading backend: " << name << ", expecting `omp` or `pool`.";
+  }
+}
+
+ParallelPool* ParallelPool::Get() {
+  static ParallelPool pool{
+      std::max(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 1)};
+  return &pool;
+}
+
+ParallelPool::ParallelPool(int32_t n_workers) {
+  for (int32_t i = 0; i < n_workers; ++i) {
+    workers_.emplace_back([this] {
+      while (true) {
+        std::shared_ptr<Job> job;
+        {
+          std::unique_lock<std::mutex> lock{mu_};
+          cv_.wait(lock, [this] { return !tickets_.empty() || stop_; });
+          if (tickets_.empty()) {
+            return;
+          }
+          job = std::move(tickets_.front());
+          tickets_.pop_front();
+        }
+        auto slot = job->slots.fetch_add(1);
+        if (slot < job->max_slots) {
+          Participate(job.get(), slot);
+        }
+      }
+    });
+  }
+}
+
+ParallelPool::~ParallelPool() {
+  {
+    std::lock_guard<std::mutex> guard{mu_};
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& t : workers_) {
+    t.join();
+  }
+}
+
+void ParallelPool::Participate(Job* job, int32_t slot) {
+  auto& local = LocalSlotRef();
+  auto prev = local;
+  local = slot;
+  size_t n_finished = 0;
+  while (true) {
+    auto begin = job->next.fetch_add(job->chunk);
+    if (begin >= job->size) {
+      break;
+    }
+    auto end = std::min(begin + job->chunk, job->size);
+    job->fn(begin, end);
+    n_finished += end - begin;
+  }
+  local = prev;
+  if (n_finished != 0) {
+    std::lock_guard<std::mutex> guard{job->mu};
+    job->finished += n_finished;
+    if (job->finished == job->size) {
+      job->cv.notify_all();
+    }
+  }
+}
+
+void ParallelPool::Run(size_t size, size_t chunk, int32_t n_threads,
+                       std::function<void(size_t, size_t)> fn) {
+  if (size == 0) {
+    return;
+  }
+  auto& local = LocalSlotRef();
+  if (local >= 0 || n_threads <= 1) {
+    // Nested loops see a single thread, same as nested OpenMP regions.
+    auto prev = local;
+    local = 0;
+    fn(0, size);
+    local = prev;
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->fn = std::move(fn);
+  job->size = size;
+  job->chunk = std::max(chunk, static_cast<size_t>(1));
+  job->max_slots = std::min(n_threads, static_cast<int32_t>(this->Size()) + 1);
+  auto n_tickets = std::min(static_cast<size_t>(job->max_slots - 1),
+                            (size - 1) / job->chunk);
+  if (n_tickets != 0) {
+    {
+      std::lock_guard<std::mutex> guard{mu_};
+      for (size_t i = 0; i < n_tickets; ++i) {
+        tickets_.push_back(job);
+      }
+    }
+    if (n_tickets == 1) {
+      cv_.notify_one();
+    } else {
+      cv_.notify_all();
+    }
+  }
+
+  Participate(job.get(), 0);
+  std::unique_lock<std::mutex> lock{job->mu};
+  job->cv.wait(lock, [&] { return job->finished == job->size; });
+}
+}  // namespace common
+}  // namespace xgboost
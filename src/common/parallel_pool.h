@@ -0,0 +1,92 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file parallel_pool.h
+ * \brief Shared pool of worker threads for `ParallelFor`, an alternative to OpenMP.
+ */
+#ifndef XGBOOST_COMMON_PARALLEL_POOL_H_
+#define XGBOOST_COMMON_PARALLEL_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief A bounded pool shared by all threads in the process.
+ *
+ *   OpenMP creates a team for each calling thread, so concurrent callers like prediction
+ *   servers oversubscribe the cores.  Parallel loops submitted to this pool run on at
+ *   most `n_threads` participants: the calling thread and pool workers that are idle.
+ *   Participants claim chunks of iterations from a shared counter, so those that finish
+ *   early take over the remaining work of slower ones.
+ */
+class ParallelPool {
+ public:
+  enum Backend : int32_t { kOpenMP = 0, kPool = 1 };
+
+ private:
+  struct Job {
+    std::function<void(size_t, size_t)> fn;
+    size_t size;
+    size_t chunk;
+    int32_t max_slots;
+    std::atomic<size_t> next{0};
+    std::atomic<int32_t> slots{1};  // 0 is taken by the calling thread.
+
+    std::mutex mu;
+    std::condition_variable cv;
+    size_t finished{0};
+  };
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  // Each entry invites one more worker to a job.
+  std::deque<std::shared_ptr<Job>> tickets_;
+  std::vector<std::thread> workers_;
+  bool stop_{false};
+
+  static std::atomic<int32_t>& BackendRef();
+  static int32_t& LocalSlotRef();
+
+  explicit ParallelPool(int32_t n_workers);
+  static void Participate(Job* job, int32_t slot);
+
+ public:
+  ~ParallelPool();
+  ParallelPool(ParallelPool const&) = delete;
+  ParallelPool& operator=(ParallelPool const&) = delete;
+
+  static ParallelPool* Get();
+
+  static Backend GetBackend() {
+    return static_cast<Backend>(BackendRef().load(std::memory_order_relaxed));
+  }
+  /*! \brief Select the backend by name, either "omp" or "pool". */
+  static void SetBackend(std::string const& name);
+  /*!
+   * \brief Index of current thread among participants of the running pool loop, -1 if
+   *        the thread is not participating in any.
+   */
+  static int32_t LocalSlot() { return LocalSlotRef(); }
+
+  /*!
+   * \brief Run `fn(begin, end)` over [0, size) in chunks, using at most `n_threads`
+   *        threads including the caller.  Returns after all chunks are finished.  Loops
+   *        nested in another pool loop run on the calling thread.
+   */
+  void Run(size_t size, size_t chunk, int32_t n_threads,
+           std::function<void(size_t, size_t)> fn);
+
+  size_t Size() const { return workers_.size(); }
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_PARALLEL_POOL_H_
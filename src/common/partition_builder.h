@@ -9,6 +9,7 @@
 
 #include <xgboost/data.h>
 #include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <utility>
 #include <memory>
@@ -23,6 +24,12 @@ namespace common {
 // 1) Effective memory allocation for intermediate results for multi-thread work
 // 2) Merging partial results produced by threads into original row set (row_set_collection_)
 // BlockSize is template to enable memory alignment easily with C++11 'alignas()' feature
+//
+// Besides buffering row indices for each task, the builder can record only the decision for
+// each row in a bit mask (`PartitionToMask`, `PartitionRangeToMask`).  Once offsets are known
+// (`CalculateMaskOffsets`), rows are written to their final position in the alternate
+// storage of `RowSetCollection` (`ScatterFromMask`), so there's no copy back and no
+// per-task buffer.
 template<size_t BlockSize>
 class PartitionBuilder {
  public:
@@ -40,6 +47,10 @@ class PartitionBuilder {
       mem_blocks_.resize(n_tasks);
       max_n_tasks_ = n_tasks;
     }
+    if (n_tasks > tasks_.size()) {
+      tasks_.resize(n_tasks);
+      masks_.resize(n_tasks * kMaskWords);
+    }
   }
 
   // split row indexes (rid_span) to 2 parts (left_part, right_part) depending
@@ -172,6 +183,93 @@ class PartitionBuilder {
     this->SetNRightElems(node_in_set, range.begin(), range.end(), n_right);
   }
 
+  /**
+   * \brief Same as `Partition`, but only records whether each row goes to the left node.
+   */
+  template <typename BinIdxType, bool any_missing>
+  void PartitionToMask(const size_t node_in_set, const size_t nid, const common::Range1d range,
+                       const int32_t split_cond, const ColumnMatrix& column_matrix,
+                       const RegTree& tree, const size_t* rid) {
+    common::Span<const size_t> rid_span(rid + range.begin(), rid + range.end());
+    const bst_uint fid = tree[nid].SplitIndex();
+    const bool default_left = tree[nid].DefaultLeft();
+    const auto column_ptr = column_matrix.GetColumn<BinIdxType, any_missing>(fid);
+
+    auto pred = [&](auto const& column) {
+      auto state = column.GetInitialState(rid_span.front());
+      using ColumnT = std::remove_reference_t<decltype(column)>;
+      return [&column, state, split_cond, default_left](size_t row_id) mutable {
+        const int32_t bin_id = column.GetBinIdx(row_id, &state);
+        if (any_missing && bin_id == ColumnT::kMissingId) {
+          return default_left;
+        }
+        return bin_id <= split_cond;
+      };
+    };
+    if (column_ptr->GetType() == xgboost::common::kDenseColumn) {
+      const common::DenseColumn<BinIdxType, any_missing>& column =
+          static_cast<const common::DenseColumn<BinIdxType, any_missing>&>(*(column_ptr.get()));
+      MaskKernel(node_in_set, range, rid_span, pred(column));
+    } else {
+      CHECK_EQ(any_missing, true);
+      const common::SparseColumn<BinIdxType>& column =
+          static_cast<const common::SparseColumn<BinIdxType>&>(*(column_ptr.get()));
+      MaskKernel(node_in_set, range, rid_span, pred(column));
+    }
+  }
+
+  /**
+   * \brief Same as `PartitionRange`, but only records whether each row goes to the left
+   *        node.
+   */
+  template <typename Pred>
+  void PartitionRangeToMask(const size_t node_in_set, const size_t nid, common::Range1d range,
+                            common::RowSetCollection const& row_set_collection, Pred pred) {
+    const size_t* p_ridx = row_set_collection[nid].begin;
+    common::Span<const size_t> ridx(p_ridx + range.begin(), p_ridx + range.end());
+    MaskKernel(node_in_set, range, ridx, pred);
+  }
+
+  // Same as `CalculateRowOffsets`, for tasks partitioned into masks.
+  void CalculateMaskOffsets() {
+    for (size_t i = 0; i < blocks_offsets_.size() - 1; ++i) {
+      size_t n_left = 0;
+      for (size_t j = blocks_offsets_[i]; j < blocks_offsets_[i + 1]; ++j) {
+        tasks_[j].n_offset_left = n_left;
+        n_left += tasks_[j].n_left;
+      }
+      size_t n_right = 0;
+      for (size_t j = blocks_offsets_[i]; j < blocks_offsets_[i + 1]; ++j) {
+        tasks_[j].n_offset_right = n_left + n_right;
+        n_right += tasks_[j].n_right;
+      }
+      left_right_nodes_sizes_[i] = {n_left, n_right};
+    }
+  }
+
+  /**
+   * \brief Write rows of a task to their final position.
+   *
+   * \param src Row indices of the node being split.
+   * \param dst Storage for row indices of both children, must not overlap with `src`.
+   */
+  void ScatterFromMask(size_t node_in_set, common::Range1d range, const size_t* src,
+                       size_t* dst) const {
+    size_t task_idx = GetTaskIdx(node_in_set, range.begin());
+    auto const& task = tasks_[task_idx];
+    uint64_t const* mask = masks_.data() + task_idx * kMaskWords;
+    size_t* p_left = dst + task.n_offset_left;
+    size_t* p_right = dst + task.n_offset_right;
+    src += range.begin();
+    for (size_t i = 0; i < range.end() - range.begin(); ++i) {
+      if ((mask[i / 64] >> (i % 64)) & 1) {
+        *p_left++ = src[i];
+      } else {
+        *p_right++ = src[i];
+      }
+    }
+  }
+
   // allocate thread local memory, should be called for each specific task
   void AllocateForTask(size_t id) {
     if (mem_blocks_[id].get() == nullptr) {
@@ -241,11 +339,39 @@ class PartitionBuilder {
     std::copy_n(right, mem_blocks_[task_idx]->n_right, right_result);
   }
 
-  size_t GetTaskIdx(int nid, size_t begin) {
+  size_t GetTaskIdx(int nid, size_t begin) const {
     return blocks_offsets_[nid] + begin / BlockSize;
   }
 
  protected:
+  static constexpr size_t kMaskWords = (BlockSize + 63) / 64;
+
+  template <typename Pred>
+  void MaskKernel(size_t node_in_set, common::Range1d range, common::Span<const size_t> ridx,
+                  Pred&& pred) {
+    CHECK_LE(ridx.size(), BlockSize);
+    size_t task_idx = GetTaskIdx(node_in_set, range.begin());
+    uint64_t* mask = masks_.data() + task_idx * kMaskWords;
+    std::fill_n(mask, kMaskWords, 0);
+    size_t n_left = 0;
+    for (size_t i = 0; i < ridx.size(); ++i) {
+      bool go_left = pred(ridx[i]);
+      mask[i / 64] |= static_cast<uint64_t>(go_left) << (i % 64);
+      n_left += go_left;
+    }
+    tasks_[task_idx].n_left = n_left;
+    tasks_[task_idx].n_right = ridx.size() - n_left;
+  }
+
+  struct TaskInfo {
+    size_t n_left{0};
+    size_t n_right{0};
+    size_t n_offset_left{0};
+    size_t n_offset_right{0};
+  };
+  std::vector<TaskInfo> tasks_;
+  std::vector<uint64_t> masks_;
+
   struct BlockInfo{
     size_t n_left;
     size_t n_right;
@@ -0,0 +1,90 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "perf_counters.h"
+
+#include <rabit/rabit.h>
+
+namespace xgboost {
+namespace common {
+PerfCounters::PerfCounters() {
+  base_.fill(0);
+  for (auto& g : gauges_) {
+    g.store(0, std::memory_order_relaxed);
+  }
+}
+
+PerfCounters* PerfCounters::Get() {
+  static PerfCounters counters;
+  return &counters;
+}
+
+PerfCounters::Slots* PerfCounters::LocalSlots() {
+  static thread_local Slots* local {nullptr};
+  if (!local) {
+    std::lock_guard<std::mutex> guard{lock_};
+    slots_.push_back(std::make_shared<Slots>());
+    local = slots_.back().get();
+  }
+  return local;
+}
+
+uint64_t PerfCounters::Read(Counter c) {
+  std::lock_guard<std::mutex> guard{lock_};
+  uint64_t sum = 0;
+  for (auto const& slots : slots_) {
+    sum += slots->values[c].load(std::memory_order_relaxed);
+  }
+  if (c == kAllreduceBytes) {
+    sum += rabit::engine::BytesReduced();
+  }
+  return sum - base_[c];
+}
+
+void PerfCounters::Reset() {
+  for (std::size_t c = 0; c < kNumCounters; ++c) {
+    auto counter = static_cast<Counter>(c);
+    auto value = this->Read(counter);
+    std::lock_guard<std::mutex> guard{lock_};
+    base_[c] += value;
+  }
+}
+
+char const* PerfCounters::Name(Counter c) {
+  switch (c) {
+    case kHistRows: return "hist_rows";
+    case kAllreduceBytes: return "allreduce_bytes";
+    case kPagesRead: return "pages_read";
+    case kPredictionCacheHits: return "prediction_cache_hits";
+    case kPredictionCacheMisses: return "prediction_cache_misses";
+    case kBoostedRounds: return "boosted_rounds";
+    case kRowCacheHits: return "row_cache_hits";
+    case kRowCacheMisses: return "row_cache_misses";
+    default: LOG(FATAL) << "Unknown counter: " << static_cast<std::size_t>(c);
+  }
+  return "";
+}
+
+char const* PerfCounters::Name(Gauge g) {
+  switch (g) {
+    case kHistPoolBytes: return "hist_pool_bytes";
+    case kHugePageBytes: return "huge_page_bytes";
+    default: LOG(FATAL) << "Unknown gauge: " << static_cast<std::size_t>(g);
+  }
+  return "";
+}
+
+Json PerfCounters::ToJson() {
+  Json out{Object{}};
+  for (std::size_t c = 0; c < kNumCounters; ++c) {
+    auto counter = static_cast<Counter>(c);
+    out[Name(counter)] = Integer{static_cast<Integer::Int>(this->Read(counter))};
+  }
+  for (std::size_t g = 0; g < kNumGauges; ++g) {
+    auto gauge = static_cast<Gauge>(g);
+    out[Name(gauge)] = Integer{static_cast<Integer::Int>(this->Read(gauge))};
+  }
+  return out;
+}
+}  // namespace common
+}  // namespace xgboost
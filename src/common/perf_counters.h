@@ -0,0 +1,89 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file perf_counters.h
+ * \brief Process wide counters for monitoring the workload of training.
+ */
+#ifndef XGBOOST_COMMON_PERF_COUNTERS_H_
+#define XGBOOST_COMMON_PERF_COUNTERS_H_
+
+#include <xgboost/json.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace xgboost {
+namespace common {
+/*!
+ * \brief Registry of performance counters.
+ *
+ *   Each thread increments its own slots without synchronization, slots of all threads
+ *   are summed up when the counters are read.  Gauges hold the last value set by any
+ *   thread.
+ */
+class PerfCounters {
+ public:
+  enum Counter : std::size_t {
+    kHistRows = 0,          // rows accumulated into CPU histograms.
+    kAllreduceBytes,        // bytes passed to rabit reductions.
+    kPagesRead,             // pages read from external memory cache.
+    kPredictionCacheHits,   // predictions continued from cached results.
+    kPredictionCacheMisses, // predictions computed from the first tree.
+    kBoostedRounds,         // calls to `Learner::UpdateOneIter`.
+    kRowCacheHits,          // rows predicted from the row cache of CPU predictor.
+    kRowCacheMisses,        // rows inserted into the row cache of CPU predictor.
+    kNumCounters
+  };
+  enum Gauge : std::size_t {
+    kHistPoolBytes = 0,     // memory held by the histogram pool of CPU hist.
+    kHugePageBytes,         // memory of large buffers requested as huge pages.
+    kNumGauges
+  };
+
+ private:
+  struct Slots {
+    std::array<std::atomic<uint64_t>, kNumCounters> values;
+    Slots() {
+      for (auto& v : values) {
+        v.store(0, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  std::mutex lock_;
+  // Slots are never freed, so counts from exited threads are kept.
+  std::vector<std::shared_ptr<Slots>> slots_;
+  // Values of counters at last reset.
+  std::array<uint64_t, kNumCounters> base_;
+  std::array<std::atomic<uint64_t>, kNumGauges> gauges_;
+
+  PerfCounters();
+  Slots* LocalSlots();
+
+ public:
+  static PerfCounters* Get();
+
+  void Add(Counter c, uint64_t n = 1) {
+    // Only the owning thread writes to the slot, no read-modify-write is needed.
+    auto& v = this->LocalSlots()->values[c];
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+  void Set(Gauge g, uint64_t value) { gauges_[g].store(value, std::memory_order_relaxed); }
+
+  /*! \brief Value of counter since last reset, summed across threads. */
+  uint64_t Read(Counter c);
+  uint64_t Read(Gauge g) const { return gauges_[g].load(std::memory_order_relaxed); }
+  /*! \brief Start counting from 0 again, gauges are not affected. */
+  void Reset();
+
+  static char const* Name(Counter c);
+  static char const* Name(Gauge g);
+  /*! \brief Dump all counters and gauges into a flat JSON object. */
+  Json ToJson();
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_PERF_COUNTERS_H_
@@ -0,0 +1,77 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file plugin_loader.cc
+ */
+#include "plugin_loader.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif  // defined(_WIN32)
+
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace common {
+namespace {
+template <typename Fn>
+int CatchAll(Fn fn) {
+  try {
+    fn();
+  } catch (dmlc::Error const &e) {
+    LOG(WARNING) << e.what();
+    return -1;
+  }
+  return 0;
+}
+
+int RegisterObjective(XGBPluginObjective const *obj) {
+  return CatchAll([&] {
+    CHECK(obj);
+    RegisterPluginObjective(*obj);
+  });
+}
+
+int RegisterMetric(XGBPluginMetric const *metric) {
+  return CatchAll([&] {
+    CHECK(metric);
+    RegisterPluginMetric(*metric);
+  });
+}
+}  // anonymous namespace
+
+XGBPluginHost const &PluginHost() {
+  static XGBPluginHost const host{XGBOOST_PLUGIN_ABI_VERSION, RegisterObjective,
+                                  RegisterMetric};
+  return host;
+}
+
+void LoadPlugin(std::string const &path) {
+  static std::mutex lock;
+  static std::set<std::string> loaded;
+  std::lock_guard<std::mutex> guard{lock};
+  if (loaded.find(path) != loaded.cend()) {
+    return;
+  }
+#if defined(_WIN32)
+  HMODULE handle = LoadLibraryA(path.c_str());
+  CHECK(handle) << "Failed to load plugin: " << path;
+  auto init = reinterpret_cast<XGBPluginInitFn>(
+      GetProcAddress(handle, XGBOOST_PLUGIN_INIT_SYMBOL));
+#else
+  void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  CHECK(handle) << "Failed to load plugin: " << path << ", " << dlerror();
+  auto init = reinterpret_cast<XGBPluginInitFn>(dlsym(handle, XGBOOST_PLUGIN_INIT_SYMBOL));
+#endif  // defined(_WIN32)
+  CHECK(init) << "Symbol `" << XGBOOST_PLUGIN_INIT_SYMBOL << "` is not found in plugin: "
+              << path;
+  CHECK_EQ(init(&PluginHost()), 0) << "Failed to initialize plugin: " << path;
+  loaded.insert(path);
+}
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,33 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file plugin_loader.h
+ * \brief Loading objectives and metrics from shared libraries, see `plugin_abi.h`.
+ */
+#ifndef XGBOOST_COMMON_PLUGIN_LOADER_H_
+#define XGBOOST_COMMON_PLUGIN_LOADER_H_
+
+#include <string>
+
+#include "xgboost/plugin_abi.h"
+
+namespace xgboost {
+/**
+ * \brief Register an objective implemented by a plugin, defined in `plugin_obj.cc`.
+ *        Name of the objective must not be used by other objectives.
+ */
+void RegisterPluginObjective(XGBPluginObjective const &obj);
+/*! \brief Register a metric implemented by a plugin, defined in `plugin_metric.cc`. */
+void RegisterPluginMetric(XGBPluginMetric const &metric);
+
+namespace common {
+/**
+ * \brief Load a plugin library and call its initialization function.  Libraries are never
+ *        unloaded as registered objectives and metrics point into them.  Loading the same
+ *        path again is a no-op.
+ */
+void LoadPlugin(std::string const &path);
+/*! \brief Host passed to plugin initialization, exposed for testing. */
+XGBPluginHost const &PluginHost();
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_PLUGIN_LOADER_H_
@@ -32,6 +32,18 @@ enum class ProbabilityDistributionType : int {
   kNormal = 0, kLogistic = 1, kExtreme = 2
 };
 
+/*!
+ * \brief PDF, CDF and derivatives of PDF evaluated at the same point.  `Terms` of each
+ *        distribution computes them together so that the exponentials are shared, the
+ *        result is the same as calling the functions separately.
+ */
+struct DistributionTerms {
+  double pdf;
+  double cdf;
+  double grad_pdf;
+  double hess_pdf;
+};
+
 struct NormalDistribution {
   XGBOOST_DEVICE static double PDF(double z) {
     return exp(-z * z / 2.0) / sqrt(2.0 * kPI);
@@ -49,6 +61,15 @@ struct NormalDistribution {
     return (z * z - 1.0) * PDF(z);
   }
 
+  XGBOOST_DEVICE static DistributionTerms Terms(double z) {
+    DistributionTerms t;
+    t.pdf = PDF(z);
+    t.cdf = CDF(z);
+    t.grad_pdf = -z * t.pdf;
+    t.hess_pdf = (z * z - 1.0) * t.pdf;
+    return t;
+  }
+
   XGBOOST_DEVICE static ProbabilityDistributionType Type() {
     return ProbabilityDistributionType::kNormal;
   }
@@ -84,6 +105,18 @@ struct LogisticDistribution {
     }
   }
 
+  XGBOOST_DEVICE static DistributionTerms Terms(double z) {
+    const double w = exp(z);
+    const bool overflow = isinf(w) || isinf(w * w);
+    const double sqrt_denominator = 1 + w;
+    DistributionTerms t;
+    t.pdf = overflow ? 0.0 : w / (sqrt_denominator * sqrt_denominator);
+    t.cdf = isinf(w) ? 1.0 : (w / (1 + w));
+    t.grad_pdf = isinf(w) ? 0.0 : (t.pdf * (1 - w) / (1 + w));
+    t.hess_pdf = overflow ? 0.0 : t.pdf * (w * w - 4 * w + 1) / ((1 + w) * (1 + w));
+    return t;
+  }
+
   XGBOOST_DEVICE static ProbabilityDistributionType Type() {
     return ProbabilityDistributionType::kLogistic;
   }
@@ -114,6 +147,17 @@ struct ExtremeDistribution {
     }
   }
 
+  XGBOOST_DEVICE static DistributionTerms Terms(double z) {
+    const double w = exp(z);
+    const double exp_neg_w = exp(-w);
+    DistributionTerms t;
+    t.pdf = isinf(w) ? 0.0 : (w * exp_neg_w);
+    t.cdf = 1 - exp_neg_w;
+    t.grad_pdf = isinf(w) ? 0.0 : ((1 - w) * t.pdf);
+    t.hess_pdf = (isinf(w) || isinf(w * w)) ? 0.0 : (w * w - 3 * w + 1) * t.pdf;
+    return t;
+  }
+
   XGBOOST_DEVICE static ProbabilityDistributionType Type() {
     return ProbabilityDistributionType::kExtreme;
   }
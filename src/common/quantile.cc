@@ -1,7 +1,9 @@
 /*!
  * Copyright 2020-2021 by XGBoost Contributors
  */
+#include <algorithm>
 #include <limits>
+#include <numeric>
 #include <utility>
 
 #include "rabit/rabit.h"
@@ -12,33 +14,70 @@
 namespace xgboost {
 namespace common {
 
+namespace {
+// Uniform random number in [0, 1) derived from the row or group index with splitmix64, so
+// the sample doesn't depend on the number of threads or the partition of pages.
+double SampleUniform(uint64_t idx) {
+  uint64_t z = idx + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z = z ^ (z >> 31);
+  return static_cast<double>(z >> 11) * (1.0 / static_cast<double>(1ULL << 53));
+}
+
+double SketchEps(int32_t max_bins, size_t n_entries) {
+  auto n_bins = std::min(static_cast<size_t>(max_bins), n_entries);
+  n_bins = std::max(n_bins, static_cast<decltype(n_bins)>(1));
+  return 1.0 / (static_cast<float>(n_bins) * WQuantileSketch<float, float>::kFactor);
+}
+}  // anonymous namespace
+
 HostSketchContainer::HostSketchContainer(
     std::vector<bst_row_t> columns_size, int32_t max_bins,
     common::Span<FeatureType const> feature_types, bool use_group,
-    int32_t n_threads)
+    int32_t n_threads, bst_row_t sample_rows, common::Span<int32_t const> feature_max_bins,
+    size_t max_total_bins)
     : feature_types_(feature_types.cbegin(), feature_types.cend()),
-      columns_size_{std::move(columns_size)}, max_bins_{max_bins},
-      use_group_ind_{use_group}, n_threads_{n_threads} {
+      sketches_capacity_{std::move(columns_size)}, max_bins_{max_bins},
+      feature_max_bins_(feature_max_bins.cbegin(), feature_max_bins.cend()),
+      max_total_bins_{max_total_bins}, use_group_ind_{use_group}, n_threads_{n_threads},
+      sample_rows_{sample_rows} {
   monitor_.Init(__func__);
-  CHECK_NE(columns_size_.size(), 0);
-  sketches_.resize(columns_size_.size());
+  CHECK_NE(sketches_capacity_.size(), 0);
+  sketches_.resize(sketches_capacity_.size());
+  columns_size_.resize(sketches_capacity_.size(), 0);
   CHECK_GE(n_threads_, 1);
-  categories_.resize(columns_size_.size());
+  categories_.resize(sketches_capacity_.size());
   ParallelFor(sketches_.size(), n_threads_, Sched::Auto(), [&](auto i) {
-    auto n_bins = std::min(static_cast<size_t>(max_bins_), columns_size_[i]);
-    n_bins = std::max(n_bins, static_cast<decltype(n_bins)>(1));
-    auto eps = 1.0 / (static_cast<float>(n_bins) * WQSketch::kFactor);
+    auto eps = SketchEps(this->MaxBins(i), sketches_capacity_[i]);
     if (!IsCat(this->feature_types_, i)) {
-      sketches_[i].Init(columns_size_[i], eps);
+      sketches_[i].Init(sketches_capacity_[i], eps);
       sketches_[i].inqueue.queue.resize(sketches_[i].limit_size * 2);
     }
   });
 }
 
+void HostSketchContainer::Reserve(std::vector<bst_row_t> const &page_columns_size) {
+  ParallelFor(sketches_.size(), n_threads_, Sched::Auto(), [&](auto i) {
+    auto n_entries = columns_size_[i] + page_columns_size[i];
+    columns_size_[i] = n_entries;
+    if (n_entries <= sketches_capacity_[i] || IsCat(this->feature_types_, i)) {
+      return;
+    }
+    // Grow geometrically to amortize the resizing across pages.  Summaries already in
+    // the sketch were pruned against a smaller total weight, so their error is still
+    // within the new bound.
+    sketches_capacity_[i] = std::max(n_entries, sketches_capacity_[i] * 2);
+    sketches_[i].Grow(sketches_capacity_[i],
+                      SketchEps(this->MaxBins(i), sketches_capacity_[i]));
+  });
+}
+
 std::vector<bst_row_t>
 HostSketchContainer::CalcColumnSize(SparsePage const &batch,
                                     bst_feature_t const n_columns,
-                                    size_t const nthreads) {
+                                    size_t const nthreads,
+                                    Span<uint8_t const> sampled) {
   auto page = batch.GetView();
   std::vector<std::vector<bst_row_t>> column_sizes(nthreads);
   for (auto &column : column_sizes) {
@@ -46,7 +85,10 @@ HostSketchContainer::CalcColumnSize(SparsePage const &batch,
   }
 
   ParallelFor(omp_ulong(page.Size()), nthreads, [&](omp_ulong i) {
-    auto &local_column_sizes = column_sizes.at(omp_get_thread_num());
+    if (!sampled.empty() && !sampled[i]) {
+      return;
+    }
+    auto &local_column_sizes = column_sizes.at(common::ThreadIdx());
     auto row = page[i];
     auto const *p_row = row.data();
     for (size_t j = 0; j < row.size(); ++j) {
@@ -64,20 +106,18 @@ HostSketchContainer::CalcColumnSize(SparsePage const &batch,
 
 std::vector<bst_feature_t> HostSketchContainer::LoadBalance(
     SparsePage const &batch, bst_feature_t n_columns, size_t const nthreads) {
+  std::vector<bst_row_t> entries_per_columns = CalcColumnSize(batch, n_columns, nthreads);
+  return LoadBalance(entries_per_columns, batch.data.Size(), nthreads);
+}
+
+std::vector<bst_feature_t> HostSketchContainer::LoadBalance(
+    std::vector<bst_row_t> const &entries_per_columns, size_t total_entries,
+    size_t const nthreads) {
   /* Some sparse datasets have their mass concentrating on small number of features.  To
    * avoid waiting for a few threads running forever, we here distribute different number
    * of columns to different threads according to number of entries.
    */
-  auto page = batch.GetView();
-  size_t const total_entries = page.data.size();
   size_t const entries_per_thread = common::DivRoundUp(total_entries, nthreads);
-
-  std::vector<std::vector<bst_row_t>> column_sizes(nthreads);
-  for (auto& column : column_sizes) {
-    column.resize(n_columns, 0);
-  }
-  std::vector<bst_row_t> entries_per_columns =
-      CalcColumnSize(batch, n_columns, nthreads);
   std::vector<bst_feature_t> cols_ptr(nthreads + 1, 0);
   size_t count {0};
   size_t current_thread {1};
@@ -171,19 +211,44 @@ void HostSketchContainer::PushRowPage(
   auto batch = page.GetView();
   // Parallel over columns.  Each thread owns a set of consecutive columns.
   auto const ncol = static_cast<bst_feature_t>(info.num_col_);
-  auto thread_columns_ptr = LoadBalance(page, info.num_col_, n_threads_);
+  // Sample rows for numerical features, categories are still collected from all rows.
+  std::vector<uint8_t> sampled;
+  if (sample_rows_ != 0 && info.num_row_ > sample_rows_) {
+    auto rate = static_cast<double>(sample_rows_) / static_cast<double>(info.num_row_);
+    // Rows in the same query group are sampled together.
+    bool by_group = info.group_ptr_.size() > 1;
+    sampled.resize(batch.Size());
+    ParallelFor(batch.Size(), n_threads_, [&](size_t i) {
+      size_t const ridx = page.base_rowid + i;
+      uint64_t key = by_group ? SearchGroupIndFromRow(info.group_ptr_, ridx) : ridx;
+      sampled[i] = SampleUniform(key) < rate;
+    });
+  }
+  bool const has_categorical =
+      std::any_of(feature_types_.cbegin(), feature_types_.cend(),
+                  [](FeatureType ft) { return ft == FeatureType::kCategorical; });
+
+  auto page_columns_size = CalcColumnSize(page, ncol, n_threads_, sampled);
+  auto n_entries = std::accumulate(page_columns_size.cbegin(), page_columns_size.cend(),
+                                   static_cast<size_t>(0));
+  auto thread_columns_ptr = LoadBalance(page_columns_size, n_entries, n_threads_);
+  this->Reserve(page_columns_size);
 
   dmlc::OMPException exc;
 #pragma omp parallel num_threads(n_threads_)
   {
     exc.Run([&]() {
-      auto tid = static_cast<uint32_t>(omp_get_thread_num());
+      auto tid = static_cast<uint32_t>(common::ThreadIdx());
       auto const begin = thread_columns_ptr[tid];
       auto const end = thread_columns_ptr[tid + 1];
 
       // do not iterate if no columns are assigned to the thread
       if (begin < end && end <= ncol) {
         for (size_t i = 0; i < batch.Size(); ++i) {
+          bool const keep = sampled.empty() || sampled[i];
+          if (!keep && !has_categorical) {
+            continue;
+          }
           size_t const ridx = page.base_rowid + i;
           SparsePage::Inst const inst = batch[i];
           auto w = weights.empty() ? 1.0f : weights[ridx];
@@ -191,8 +256,8 @@ void HostSketchContainer::PushRowPage(
           if (is_dense) {
             for (size_t ii = begin; ii < end; ii++) {
               if (IsCat(feature_types_, ii)) {
-                categories_[ii].emplace(AsCat(p_inst[ii].fvalue));
-              } else {
+                this->PushCategory(ii, p_inst[ii].fvalue);
+              } else if (keep) {
                 sketches_[ii].Push(p_inst[ii].fvalue, w);
               }
             }
@@ -201,8 +266,8 @@ void HostSketchContainer::PushRowPage(
               auto const& entry = p_inst[i];
               if (entry.index >= begin && entry.index < end) {
                 if (IsCat(feature_types_, entry.index)) {
-                  categories_[entry.index].emplace(AsCat(entry.fvalue));
-                } else {
+                  this->PushCategory(entry.index, entry.fvalue);
+                } else if (keep) {
                   sketches_[entry.index].Push(entry.fvalue, w);
                 }
               }
@@ -216,55 +281,30 @@ void HostSketchContainer::PushRowPage(
   monitor_.Stop(__func__);
 }
 
-void HostSketchContainer::GatherSketchInfo(
-    std::vector<WQSketch::SummaryContainer> const &reduced,
-    std::vector<size_t> *p_worker_segments,
-    std::vector<bst_row_t> *p_sketches_scan,
-    std::vector<WQSketch::Entry> *p_global_sketches) {
-  auto& worker_segments = *p_worker_segments;
-  worker_segments.resize(1, 0);
-  auto world = rabit::GetWorldSize();
-  auto rank = rabit::GetRank();
-  auto n_columns = sketches_.size();
-
-  std::vector<bst_row_t> sketch_size;
-  for (auto const& sketch : reduced) {
-    sketch_size.push_back(sketch.size);
+void HostSketchContainer::AllReduceCategories() {
+  if (rabit::GetWorldSize() == 1) {
+    return;
+  }
+  // Bit sets are padded to the same size on all workers and merged with a bitwise OR.
+  std::vector<size_t> n_words(categories_.size());
+  std::transform(categories_.cbegin(), categories_.cend(), n_words.begin(),
+                 [](auto const &bits) { return bits.size(); });
+  rabit::Allreduce<rabit::op::Max>(n_words.data(), n_words.size());
+  std::vector<size_t> words_ptr(n_words.size() + 1, 0);
+  std::partial_sum(n_words.cbegin(), n_words.cend(), words_ptr.begin() + 1);
+  if (words_ptr.back() == 0) {
+    return;
   }
-  std::vector<bst_row_t>& sketches_scan = *p_sketches_scan;
-  sketches_scan.resize((n_columns + 1) * world, 0);
-  size_t beg_scan = rank * (n_columns + 1);
-  std::partial_sum(sketch_size.cbegin(), sketch_size.cend(),
-                   sketches_scan.begin() + beg_scan + 1);
-  // Gather all column pointers
-  rabit::Allreduce<rabit::op::Sum>(sketches_scan.data(), sketches_scan.size());
-
-  for (int32_t i = 0; i < world; ++i) {
-    size_t back = (i + 1) * (n_columns + 1) - 1;
-    auto n_entries = sketches_scan.at(back);
-    worker_segments.push_back(n_entries);
+  std::vector<uint32_t> words(words_ptr.back(), 0);
+  for (size_t fidx = 0; fidx < categories_.size(); ++fidx) {
+    std::copy(categories_[fidx].cbegin(), categories_[fidx].cend(),
+              words.begin() + words_ptr[fidx]);
   }
-  // Offset of sketch from each worker.
-  std::partial_sum(worker_segments.begin(), worker_segments.end(),
-                   worker_segments.begin());
-  CHECK_GE(worker_segments.size(), 1);
-  auto total = worker_segments.back();
-
-  auto& global_sketches = *p_global_sketches;
-  global_sketches.resize(total, WQSketch::Entry{0, 0, 0, 0});
-  auto worker_sketch = Span<WQSketch::Entry>{global_sketches}.subspan(
-      worker_segments[rank], worker_segments[rank + 1] - worker_segments[rank]);
-  size_t cursor = 0;
-  for (auto const &sketch : reduced) {
-    std::copy(sketch.data, sketch.data + sketch.size,
-              worker_sketch.begin() + cursor);
-    cursor += sketch.size;
+  rabit::Allreduce<rabit::op::BitOR>(words.data(), words.size());
+  for (size_t fidx = 0; fidx < categories_.size(); ++fidx) {
+    categories_[fidx].assign(words.cbegin() + words_ptr[fidx],
+                             words.cbegin() + words_ptr[fidx + 1]);
   }
-
-  static_assert(sizeof(WQSketch::Entry) / 4 == sizeof(float), "");
-  rabit::Allreduce<rabit::op::Sum>(
-      reinterpret_cast<float *>(global_sketches.data()),
-      global_sketches.size() * sizeof(WQSketch::Entry) / sizeof(float));
 }
 
 void HostSketchContainer::AllReduce(
@@ -281,6 +321,7 @@ void HostSketchContainer::AllReduce(
   size_t n_columns = sketches_.size();
   rabit::Allreduce<rabit::op::Max>(&n_columns, 1);
   CHECK_EQ(n_columns, sketches_.size()) << "Number of columns differs across workers";
+  this->AllReduceCategories();
 
   // Prune the intermediate num cuts for synchronization.
   std::vector<bst_row_t> global_column_size(columns_size_);
@@ -289,7 +330,7 @@ void HostSketchContainer::AllReduce(
   ParallelFor(sketches_.size(), n_threads_, [&](size_t i) {
     int32_t intermediate_num_cuts = static_cast<int32_t>(
         std::min(global_column_size[i],
-                 static_cast<size_t>(max_bins_ * WQSketch::kFactor)));
+                 static_cast<size_t>(this->MaxBins(i) * WQSketch::kFactor)));
     if (global_column_size[i] != 0) {
       WQSketch::SummaryContainer out;
       sketches_[i].GetSummary(&out);
@@ -306,38 +347,27 @@ void HostSketchContainer::AllReduce(
     return;
   }
 
-  std::vector<size_t> worker_segments(1, 0);  // CSC pointer to sketches.
-  std::vector<bst_row_t> sketches_scan((n_columns + 1) * world, 0);
-
-  std::vector<WQSketch::Entry> global_sketches;
-  this->GatherSketchInfo(reduced, &worker_segments, &sketches_scan,
-                         &global_sketches);
+  /**
+   * Merge the summaries with rabit's reduction tree.  Each worker merges the summaries
+   * from its children pairwise and prunes them before sending up the tree, the final
+   * result is broadcasted back so all workers have the same summaries.  Comparing to
+   * gathering the summaries from all workers, the cost grows logarithmically with the
+   * number of workers.
+   */
+  // num_cuts is calculated from the global column size so it's the same on all workers.
+  int32_t max_num_cuts = *std::max_element(num_cuts.cbegin(), num_cuts.cend());
+  auto nbytes = WQSketch::SummaryContainer::CalcMemCost(max_num_cuts);
+  rabit::SerializeReducer<WQSketch::SummaryContainer> reducer;
+  reducer.Allreduce(dmlc::BeginPtr(reduced), nbytes, reduced.size());
 
-  std::vector<WQSketch::SummaryContainer> final_sketches(n_columns);
   ParallelFor(n_columns, n_threads_, [&](auto fidx) {
     int32_t intermediate_num_cuts = num_cuts[fidx];
-    auto nbytes =
-        WQSketch::SummaryContainer::CalcMemCost(intermediate_num_cuts);
-
-    for (int32_t i = 1; i < world + 1; ++i) {
-      auto size = worker_segments.at(i) - worker_segments[i - 1];
-      auto worker_sketches = Span<WQSketch::Entry>{global_sketches}.subspan(
-          worker_segments[i - 1], size);
-      auto worker_scan =
-          Span<bst_row_t>(sketches_scan)
-              .subspan((i - 1) * (n_columns + 1), (n_columns + 1));
-
-      auto worker_feature = worker_sketches.subspan(
-          worker_scan[fidx], worker_scan[fidx + 1] - worker_scan[fidx]);
-      CHECK(worker_feature.data());
-      WQSummary<float, float> summary(worker_feature.data(),
-                                      worker_feature.size());
-      auto &out = final_sketches.at(fidx);
-      out.Reduce(summary, nbytes);
+    if (reduced[fidx].size > static_cast<size_t>(intermediate_num_cuts)) {
+      WQSketch::SummaryContainer temp;
+      temp.Reserve(intermediate_num_cuts);
+      temp.SetPrune(reduced[fidx], intermediate_num_cuts);
+      reduced[fidx].CopyFrom(temp);
     }
-
-    reduced.at(fidx).Reserve(intermediate_num_cuts);
-    reduced.at(fidx).SetPrune(final_sketches.at(fidx), intermediate_num_cuts);
   });
   monitor_.Stop(__func__);
 }
@@ -354,11 +384,32 @@ void AddCutPoint(WQuantileSketch<float, float>::SummaryContainer const &summary,
   }
 }
 
-void AddCategories(std::set<bst_cat_t> const &categories, HistogramCuts *cuts) {
+void AddCategories(std::vector<uint32_t> const &categories, HistogramCuts *cuts) {
   auto &cut_values = cuts->cut_values_.HostVector();
-  for (auto const &v : categories) {
-    cut_values.push_back(v);
+  for (size_t w = 0; w < categories.size(); ++w) {
+    auto bits = categories[w];
+    for (size_t b = 0; bits != 0; ++b, bits >>= 1) {
+      if (bits & 1u) {
+        cut_values.push_back(static_cast<float>(w * 32 + b));
+      }
+    }
+  }
+}
+
+int32_t HostSketchContainer::BinCap(std::vector<int32_t> n_bins, size_t total) {
+  std::sort(n_bins.begin(), n_bins.end());
+  size_t used = 0;
+  for (size_t i = 0; i < n_bins.size(); ++i) {
+    auto n_rest = n_bins.size() - i;
+    auto bins = static_cast<size_t>(n_bins[i]);
+    if (used + bins * n_rest > total) {
+      // Remaining features all have at least `bins` bins, share the rest of the budget.
+      auto cap = total > used ? (total - used) / n_rest : 0;
+      return std::max(static_cast<int32_t>(cap), 1);
+    }
+    used += bins;
   }
+  return n_bins.empty() ? 1 : std::max(n_bins.back(), 1);
 }
 
 void HostSketchContainer::MakeCuts(HistogramCuts* cuts) {
@@ -367,6 +418,27 @@ void HostSketchContainer::MakeCuts(HistogramCuts* cuts) {
   std::vector<int32_t> num_cuts;
   this->AllReduce(&reduced, &num_cuts);
 
+  // Number of bins of each numerical feature, given by the number of distinct values in its
+  // summary and its own budget.  Summaries are the same on all workers after reduction.
+  std::vector<int32_t> max_num_bins(reduced.size(), 0);
+  for (size_t fidx = 0; fidx < reduced.size(); ++fidx) {
+    if (!IsCat(feature_types_, fidx)) {
+      max_num_bins[fidx] = std::min(num_cuts[fidx], this->MaxBins(fidx));
+    }
+  }
+  if (max_total_bins_ != 0) {
+    std::vector<int32_t> n_bins;
+    for (size_t fidx = 0; fidx < reduced.size(); ++fidx) {
+      if (!IsCat(feature_types_, fidx) && num_cuts[fidx] != 0) {
+        n_bins.push_back(std::min(static_cast<int32_t>(reduced[fidx].size), max_num_bins[fidx]));
+      }
+    }
+    auto cap = BinCap(std::move(n_bins), max_total_bins_);
+    for (auto &n : max_num_bins) {
+      n = std::min(n, cap);
+    }
+  }
+
   cuts->min_vals_.HostVector().resize(sketches_.size(), 0.0f);
   std::vector<WQSketch::SummaryContainer> final_summaries(reduced.size());
 
@@ -375,11 +447,10 @@ void HostSketchContainer::MakeCuts(HistogramCuts* cuts) {
       return;
     }
     WQSketch::SummaryContainer &a = final_summaries[fidx];
-    size_t max_num_bins = std::min(num_cuts[fidx], max_bins_);
-    a.Reserve(max_num_bins + 1);
+    a.Reserve(max_num_bins[fidx] + 1);
     CHECK(a.data);
     if (num_cuts[fidx] != 0) {
-      a.SetPrune(reduced[fidx], max_num_bins + 1);
+      a.SetPrune(reduced[fidx], max_num_bins[fidx] + 1);
       CHECK(a.data && reduced[fidx].data);
       const bst_float mval = a.data[0].value;
       cuts->min_vals_.HostVector()[fidx] = mval - fabs(mval) - 1e-5f;
@@ -391,12 +462,11 @@ void HostSketchContainer::MakeCuts(HistogramCuts* cuts) {
   });
 
   for (size_t fid = 0; fid < reduced.size(); ++fid) {
-    size_t max_num_bins = std::min(num_cuts[fid], max_bins_);
     WQSketch::SummaryContainer const& a = final_summaries[fid];
     if (IsCat(feature_types_, fid)) {
       AddCategories(categories_.at(fid), cuts);
     } else {
-      AddCutPoint(a, max_num_bins, cuts);
+      AddCutPoint(a, max_num_bins[fid], cuts);
       // push a value that is greater than anything
       const bst_float cpt = (a.size > 0) ? a.data[a.size - 1].value
                                          : cuts->min_vals_.HostVector()[fid];
@@ -444,6 +444,16 @@ void SketchContainer::Prune(size_t to) {
   timer_.Stop(__func__);
 }
 
+void SketchContainer::PruneIfLarger(size_t max_bytes) {
+  if (this->MemCostBytes() <= max_bytes) {
+    return;
+  }
+  this->Prune(static_cast<size_t>(num_bins_ * kFactor));
+  // Release the larger buffer from before pruning.
+  this->Other().clear();
+  this->Other().shrink_to_fit();
+}
+
 void SketchContainer::Merge(Span<OffsetT const> d_that_columns_ptr,
                             Span<SketchEntry const> that) {
   dh::safe_cuda(cudaSetDevice(device_));
@@ -149,6 +149,15 @@ class SketchContainer {
    * structure is already less than `to`, then no operation is performed.
    */
   void Prune(size_t to);
+  /* \brief Prune to the size used for intermediate summaries when sketch entries take more
+   *        than `max_bytes` of device memory.  Used for bounding memory usage when merging
+   *        many batches, the error bound is the same as pruning before all-reduce.
+   */
+  void PruneIfLarger(size_t max_bytes);
+  /* \brief Device memory held by sketch entries in bytes. */
+  size_t MemCostBytes() const {
+    return (entries_a_.capacity() + entries_b_.capacity()) * sizeof(SketchEntry);
+  }
   /* \brief Merge another set of sketch.
    * \param that columns of other.
    */
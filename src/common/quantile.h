@@ -17,6 +17,7 @@
 #include <iostream>
 #include <set>
 
+#include "categorical.h"
 #include "timer.h"
 
 namespace xgboost {
@@ -569,6 +570,36 @@ class QuantileSketchTemplate {
         << "invalid init parameter";
   }
 
+  /*!
+   * \brief enlarge the sketch when more data points than the ones specified in Init are
+   *        going to be pushed, existing summaries are kept.
+   * \param maxn new maximum number of data points can be feed into sketch
+   * \param eps accuracy level of summary
+   */
+  inline void Grow(size_t maxn, double eps) {
+    size_t new_nlevel, new_limit_size;
+    LimitSizeLevel(maxn, eps, &new_nlevel, &new_limit_size);
+    nlevel = std::max(nlevel, new_nlevel);
+    if (new_limit_size <= limit_size) {
+      return;
+    }
+    // re-layout the levels with the new stride
+    std::vector<Entry> new_data(new_limit_size * level.size());
+    for (size_t l = 0; l < level.size(); ++l) {
+      std::copy(level[l].data, level[l].data + level[l].size,
+                new_data.begin() + l * new_limit_size);
+    }
+    data = std::move(new_data);
+    for (size_t l = 0; l < level.size(); ++l) {
+      level[l].data = dmlc::BeginPtr(data) + l * new_limit_size;
+    }
+    limit_size = new_limit_size;
+    // a queue of size 1 is lazily resized on the first push of a different value
+    if (inqueue.queue.size() != 1 && inqueue.queue.size() < limit_size * 2) {
+      inqueue.queue.resize(limit_size * 2);
+    }
+  }
+
   /*!
    * \brief add an element to a sketch
    * \param x The element added to the sketch
@@ -708,25 +739,81 @@ class HostSketchContainer {
 
  private:
   std::vector<WQSketch> sketches_;
-  std::vector<std::set<bst_cat_t>> categories_;
+  /*! \brief Bit set of the categories seen in each categorical feature. */
+  std::vector<std::vector<uint32_t>> categories_;
   std::vector<FeatureType> const feature_types_;
 
+  /*! \brief Number of entries pushed into each column so far. */
   std::vector<bst_row_t> columns_size_;
+  /*! \brief Number of entries each sketch is currently sized for. */
+  std::vector<bst_row_t> sketches_capacity_;
   int32_t max_bins_;
+  /*! \brief Maximum number of bins of each feature overriding `max_bins_`, if positive. */
+  std::vector<int32_t> feature_max_bins_;
+  /*! \brief Upper bound of the total number of bins of numerical features, 0 for none. */
+  size_t max_total_bins_{0};
   bool use_group_ind_{false};
   int32_t n_threads_;
+  /*! \brief Number of rows sampled for sketching, 0 means using all rows. */
+  bst_row_t sample_rows_{0};
   Monitor monitor_;
 
+  void PushCategory(bst_feature_t fidx, float v) {
+    auto cat = AsCat(v);
+    if (cat < 0) {
+      InvalidCategory();
+    }
+    auto& bits = categories_[fidx];
+    auto word = static_cast<size_t>(cat) / 32;
+    if (bits.size() <= word) {
+      bits.resize(word + 1, 0);
+    }
+    bits[word] |= 1u << (static_cast<uint32_t>(cat) % 32);
+  }
+  /*! \brief Merge the category bit sets of all workers. */
+  void AllReduceCategories();
+
  public:
   /* \brief Initialize necessary info.
    *
-   * \param columns_size Size of each column.
+   * \param columns_size Expected size of each column, used for sizing the sketches.  The
+   *                     actual sizes are counted while pages are pushed and the sketches
+   *                     grow when needed, so this can be all zeros when the sizes are not
+   *                     known beforehand.
    * \param max_bins maximum number of bins for each feature.
    * \param use_group whether is assigned to group to data instance.
+   * \param sample_rows When positive and smaller than the number of rows, only a uniform
+   *                    sample of about `sample_rows` rows (or whole query groups) is
+   *                    sketched for numerical features.  By the DKW inequality the additional
+   *                    normalized rank error is bounded by sqrt(ln(2 / delta) / (2 n)) with
+   *                    probability 1 - delta for n sampled rows.
+   * \param feature_max_bins Maximum number of bins of each feature, features with a
+   *                         positive value use it instead of `max_bins`.
+   * \param max_total_bins   When positive, numerical features with more distinct values than
+   *                         a common cap are limited to the cap, so that the total number of
+   *                         bins of numerical features doesn't exceed this bound.
    */
   HostSketchContainer(std::vector<bst_row_t> columns_size, int32_t max_bins,
                       common::Span<FeatureType const> feature_types, bool use_group,
-                      int32_t n_threads);
+                      int32_t n_threads, bst_row_t sample_rows = 0,
+                      common::Span<int32_t const> feature_max_bins = {},
+                      size_t max_total_bins = 0);
+
+  /*! \brief Maximum number of bins of a feature before applying `max_total_bins`. */
+  int32_t MaxBins(size_t fidx) const {
+    if (fidx < feature_max_bins_.size() && feature_max_bins_[fidx] > 0) {
+      return feature_max_bins_[fidx];
+    }
+    return max_bins_;
+  }
+  /**
+   * \brief Largest number of bins for each feature, so that the sum over features of the
+   *        smaller of `n_bins` and this cap doesn't exceed `total`.
+   *
+   * \return The cap, which is at least 1, or the largest of `n_bins` when the total
+   *         already fits.
+   */
+  static int32_t BinCap(std::vector<int32_t> n_bins, size_t total);
 
   static bool UseGroup(MetaInfo const &info) {
     size_t const num_groups =
@@ -737,13 +824,20 @@ class HostSketchContainer {
     return use_group_ind;
   }
 
+  /* \brief Count the number of entries in each column, rows with a zero in the optional
+   *        `sampled` mask are skipped. */
   static std::vector<bst_row_t> CalcColumnSize(SparsePage const &page,
                                                bst_feature_t const n_columns,
-                                               size_t const nthreads);
+                                               size_t const nthreads,
+                                               Span<uint8_t const> sampled = {});
 
   static std::vector<bst_feature_t> LoadBalance(SparsePage const &page,
                                                 bst_feature_t n_columns,
                                                 size_t const nthreads);
+  /* \brief Distribute columns to threads according to the number of entries in each
+   *        column. */
+  static std::vector<bst_feature_t> LoadBalance(std::vector<bst_row_t> const &entries_per_column,
+                                                size_t total_entries, size_t const nthreads);
 
   static uint32_t SearchGroupIndFromRow(std::vector<bst_uint> const &group_ptr,
                                         size_t const base_rowid) {
@@ -754,20 +848,23 @@ class HostSketchContainer {
         group_ptr.cbegin() - 1;
     return group_ind;
   }
-  // Gather sketches from all workers.
-  void GatherSketchInfo(std::vector<WQSketch::SummaryContainer> const &reduced,
-                        std::vector<bst_row_t> *p_worker_segments,
-                        std::vector<bst_row_t> *p_sketches_scan,
-                        std::vector<WQSketch::Entry> *p_global_sketches);
   // Merge sketches from all workers.
   void AllReduce(std::vector<WQSketch::SummaryContainer> *p_reduced,
                  std::vector<int32_t>* p_num_cuts);
 
-  /* \brief Push a CSR matrix. */
+  /* \brief Push a CSR matrix.  Pages are streamed into the sketches one at a time, each
+   *        sketch merges pruned summaries level by level so memory usage is bounded by the
+   *        sketch size instead of the data size.  Sketches are enlarged according to the
+   *        number of entries seen so far, there's no need to count the columns in a
+   *        separated pass. */
   void PushRowPage(SparsePage const &page, MetaInfo const &info,
                    Span<float> const hessian = {});
 
   void MakeCuts(HistogramCuts* cuts);
+
+ private:
+  /* \brief Enlarge sketches that can't hold the entries of an incoming page. */
+  void Reserve(std::vector<bst_row_t> const &page_columns_size);
 };
 }  // namespace common
 }  // namespace xgboost
@@ -4,8 +4,80 @@
  */
 #include "random.h"
 
+#include "bitfield.h"
+
 namespace xgboost {
 namespace common {
+namespace {
+// SplitMix64 finalizer.
+uint64_t Mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+}  // anonymous namespace
+
+uint32_t ColumnSampler::NodeRandom(uint32_t bound) {
+  auto r = static_cast<uint32_t>(Mix(node_seed_ + (++node_counter_) * 0x9e3779b97f4a7c15ull));
+  // Multiply-shift instead of modulo, the bias is negligible for feature counts.
+  return static_cast<uint32_t>((static_cast<uint64_t>(r) * bound) >> 32);
+}
+
+std::shared_ptr<HostDeviceVector<bst_feature_t>> ColumnSampler::AcquireNodeSet() {
+  for (auto const& set : node_sets_) {
+    // Only the sampler can copy a set held by nobody else, so the count can't go up
+    // concurrently.
+    if (set.use_count() == 1) {
+      return set;
+    }
+  }
+  node_sets_.emplace_back(std::make_shared<HostDeviceVector<bst_feature_t>>());
+  return node_sets_.back();
+}
+
+std::shared_ptr<HostDeviceVector<bst_feature_t>> ColumnSampler::NodeSample(
+    std::shared_ptr<HostDeviceVector<bst_feature_t>> const& p_features, float colsample) {
+  if (colsample == 1.0f) {
+    return p_features;
+  }
+  if (feature_weights_.size() != 0) {
+    return ColSample(p_features, colsample);
+  }
+  auto const& features = p_features->ConstHostVector();
+  CHECK_GT(features.size(), 0);
+  auto m = static_cast<uint32_t>(features.size());
+  auto n = static_cast<uint32_t>(std::max(1, static_cast<int>(colsample * m)));
+
+  // Floyd's algorithm, n draws for selecting n positions out of m.
+  size_t n_words = LBitField32::ComputeStorageSize(m);
+  if (node_mask_.size() < n_words) {
+    node_mask_.resize(n_words, 0);
+  }
+  LBitField32 mask{Span<uint32_t>{node_mask_.data(), n_words}};
+  for (uint32_t j = m - n; j < m; ++j) {
+    auto t = NodeRandom(j + 1);
+    if (mask.Check(t)) {
+      mask.Set(j);
+    } else {
+      mask.Set(t);
+    }
+  }
+
+  // Scanning the mask keeps the order of the level set, no sorting is needed.
+  auto p_new_features = this->AcquireNodeSet();
+  auto& new_features = p_new_features->HostVector();
+  new_features.resize(n);
+  size_t k = 0;
+  for (uint32_t i = 0; i < m; ++i) {
+    if (mask.Check(i)) {
+      new_features[k++] = features[i];
+    }
+  }
+  CHECK_EQ(k, n);
+  std::fill_n(node_mask_.begin(), n_words, 0);
+  return p_new_features;
+}
+
 std::shared_ptr<HostDeviceVector<bst_feature_t>> ColumnSampler::ColSample(
     std::shared_ptr<HostDeviceVector<bst_feature_t>> p_features,
     float colsample) {
@@ -126,9 +126,28 @@ class ColumnSampler {
   float colsample_bynode_{1.0f};
   GlobalRandomEngine rng_;
 
+  // State of node sampling.  Draws are a hash of the seed and a counter, so they don't
+  // depend on the engine state.
+  uint64_t node_seed_{0};
+  uint64_t node_counter_{0};
+  // Bit mask over positions in the level feature set, cleared after each sample.
+  std::vector<uint32_t> node_mask_;
+  // Node feature sets, reused once they are no longer referenced outside of the sampler.
+  std::vector<std::shared_ptr<HostDeviceVector<bst_feature_t>>> node_sets_;
+
+  uint32_t NodeRandom(uint32_t bound);
+  std::shared_ptr<HostDeviceVector<bst_feature_t>> AcquireNodeSet();
+
  public:
   std::shared_ptr<HostDeviceVector<bst_feature_t>> ColSample(
       std::shared_ptr<HostDeviceVector<bst_feature_t>> p_features, float colsample);
+  /**
+   * \brief Sample a feature set for a node.  Same as `ColSample`, but the returned set is
+   *        taken from a pool of sets that were released by their users and the sampling
+   *        doesn't allocate.
+   */
+  std::shared_ptr<HostDeviceVector<bst_feature_t>> NodeSample(
+      std::shared_ptr<HostDeviceVector<bst_feature_t>> const& p_features, float colsample);
   /**
    * \brief Column sampler constructor.
    * \note This constructor manually sets the rng seed
@@ -175,6 +194,8 @@ class ColumnSampler {
               feature_set_tree_->HostVector().end(), begin_idx);
 
     feature_set_tree_ = ColSample(feature_set_tree_, colsample_bytree_);
+    node_seed_ = (static_cast<uint64_t>(rng_()) << 32) | rng_();
+    node_counter_ = 0;
   }
 
   /**
@@ -185,6 +206,14 @@ class ColumnSampler {
     feature_set_level_.clear();
   }
 
+  /**
+   * \brief Features sampled for the current tree, every feature set returned by
+   *        `GetFeatureSet` is a subset of it.
+   */
+  std::shared_ptr<HostDeviceVector<bst_feature_t> const> GetTreeFeatureSet() const {
+    return feature_set_tree_;
+  }
+
   /**
    * \brief Samples a feature set.
    *
@@ -210,7 +239,7 @@ class ColumnSampler {
       return feature_set_level_[depth];
     }
     // Need to sample for the node individually
-    return ColSample(feature_set_level_[depth], colsample_bynode_);
+    return NodeSample(feature_set_level_[depth], colsample_bynode_);
   }
 };
 
@@ -9,16 +9,21 @@
 
 #include <xgboost/data.h>
 #include <algorithm>
+#include <functional>
 #include <vector>
 #include <utility>
 #include <memory>
 
+#include "huge_page_allocator.h"
+
 namespace xgboost {
 namespace common {
 
 /*! \brief collection of rowset */
 class RowSetCollection {
  public:
+  /*! \brief storage of row indices, large enough to benefit from huge pages. */
+  using Indices = std::vector<size_t, HugePageAllocator<size_t>>;
   /*! \brief data structure to store an instance set, a subset of
    *  rows (instances) associated with a particular node in a decision
    *  tree. */
@@ -86,12 +91,12 @@ class RowSetCollection {
       return;
     }
 
-    const size_t* begin = dmlc::BeginPtr(row_indices_);
-    const size_t* end = dmlc::BeginPtr(row_indices_) + row_indices_.size();
+    const size_t* begin = row_indices_.data();
+    const size_t* end = row_indices_.data() + row_indices_.size();
     elem_of_each_node_.emplace_back(Elem(begin, end, 0));
   }
 
-  std::vector<size_t>* Data() { return &row_indices_; }
+  Indices* Data() { return &row_indices_; }
   // split rowset into two
   inline void AddSplit(unsigned node_id,
                        unsigned left_node_id,
@@ -100,7 +105,7 @@ class RowSetCollection {
                        size_t n_right) {
     const Elem e = elem_of_each_node_[node_id];
     CHECK(e.begin != nullptr);
-    size_t* all_begin = dmlc::BeginPtr(row_indices_);
+    size_t* all_begin = row_indices_.data();
     size_t* begin = all_begin + (e.begin - all_begin);
 
     CHECK_EQ(n_left + n_right, e.Size());
@@ -119,9 +124,59 @@ class RowSetCollection {
     elem_of_each_node_[node_id] = Elem(nullptr, nullptr, -1);
   }
 
+  /**
+   * \brief Storage for row indices of children of `node_id`, which is located at the same
+   *        offset as the node but in the other buffer.  Rows of a live node never overlap
+   *        with rows of another live node, so writing into the other buffer only overwrites
+   *        rows of its ancestors.
+   */
+  size_t* AlternateStorage(unsigned node_id) {
+    const Elem e = elem_of_each_node_[node_id];
+    CHECK(e.begin != nullptr);
+    if (e.Size() == 0) {
+      return const_cast<size_t*>(e.begin);
+    }
+    if (alternate_.size() != row_indices_.size()) {
+      alternate_.resize(row_indices_.size());
+    }
+    size_t* primary = row_indices_.data();
+    size_t* secondary = alternate_.data();
+    std::less_equal<const size_t*> le;
+    std::less<const size_t*> lt;
+    if (le(primary, e.begin) && lt(e.begin, primary + row_indices_.size())) {
+      return secondary + (e.begin - primary);
+    }
+    CHECK(le(secondary, e.begin) && lt(e.begin, secondary + alternate_.size()));
+    return primary + (e.begin - secondary);
+  }
+  /**
+   * \brief Same as `AddSplit`, but rows of children have been written into
+   *        `AlternateStorage(node_id)` instead of the storage of `node_id`.
+   */
+  inline void AddSplitToAlternate(unsigned node_id, unsigned left_node_id,
+                                  unsigned right_node_id, size_t n_left, size_t n_right) {
+    const Elem e = elem_of_each_node_[node_id];
+    CHECK_EQ(n_left + n_right, e.Size());
+    size_t* begin = this->AlternateStorage(node_id);
+
+    if (left_node_id >= elem_of_each_node_.size()) {
+      elem_of_each_node_.resize(left_node_id + 1, Elem(nullptr, nullptr, -1));
+    }
+    if (right_node_id >= elem_of_each_node_.size()) {
+      elem_of_each_node_.resize(right_node_id + 1, Elem(nullptr, nullptr, -1));
+    }
+
+    elem_of_each_node_[left_node_id] = Elem(begin, begin + n_left, left_node_id);
+    elem_of_each_node_[right_node_id] =
+        Elem(begin + n_left, begin + n_left + n_right, right_node_id);
+    elem_of_each_node_[node_id] = Elem(nullptr, nullptr, -1);
+  }
+
  private:
   // stores the row indexes in the set
-  std::vector<size_t> row_indices_;
+  Indices row_indices_;
+  // second buffer for partitioning rows without copying them back, see `AlternateStorage`
+  Indices alternate_;
   // vector: node_id -> elements
   std::vector<Elem> elem_of_each_node_;
 };
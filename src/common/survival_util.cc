@@ -7,12 +7,72 @@
  */
 
 #include <dmlc/registry.h>
+
+#include <cmath>
+#include <vector>
+
 #include "survival_util.h"
+#include "threading_utils.h"
 
 namespace xgboost {
 namespace common {
 
 DMLC_REGISTER_PARAMETER(AFTParam);
 
+namespace cox {
+void RiskSetSums(std::vector<size_t> const &label_order, std::vector<float> const &labels,
+                 std::vector<double> const &exp_p, int32_t n_threads, std::vector<double> *out) {
+  size_t n = label_order.size();
+  CHECK_EQ(exp_p.size(), n);
+  auto abs_label = [&](size_t i) { return std::abs(labels[label_order[i]]); };
+  auto is_start = [&](size_t i) { return i == 0 || abs_label(i - 1) < abs_label(i); };
+
+  SortedBlocks blocks{n, n_threads};
+  std::vector<double> block_sums(blocks.Size(), 0.0);
+  ParallelFor(blocks.Size(), n_threads, [&](size_t b) {
+    double sum = 0;  // we use double because we might need the precision with large datasets
+    for (size_t i = blocks.Begin(b); i < blocks.End(b); ++i) {
+      sum += exp_p[i];
+    }
+    block_sums[b] = sum;
+  });
+  std::vector<double> suffix(blocks.Size() + 1, 0.0);
+  for (size_t b = blocks.Size(); b-- > 0;) {
+    suffix[b] = suffix[b + 1] + block_sums[b];
+  }
+
+  // Suffix sums, along with the last group of ties starting in each block.
+  auto &h_out = *out;
+  h_out.resize(n);
+  std::vector<size_t> last_start(blocks.Size(), n);
+  ParallelFor(blocks.Size(), n_threads, [&](size_t b) {
+    double sum = suffix[b + 1];
+    for (size_t i = blocks.End(b); i-- > blocks.Begin(b);) {
+      sum += exp_p[i];
+      h_out[i] = sum;
+      CHECK(i == 0 || abs_label(i - 1) <= abs_label(i))
+          << "CoxRegression: labels must be in sorted order, MetaInfo::LabelArgsort failed!";
+      if (last_start[b] == n && is_start(i)) {
+        last_start[b] = i;
+      }
+    }
+  });
+  // Risk set of ties crossing the block boundary.
+  std::vector<double> carry(blocks.Size(), 0.0);
+  for (size_t b = 1; b < blocks.Size(); ++b) {
+    carry[b] = last_start[b - 1] == n ? carry[b - 1] : h_out[last_start[b - 1]];
+  }
+  ParallelFor(blocks.Size(), n_threads, [&](size_t b) {
+    double risk = carry[b];
+    for (size_t i = blocks.Begin(b); i < blocks.End(b); ++i) {
+      if (is_start(i)) {
+        risk = h_out[i];
+      }
+      h_out[i] = risk;
+    }
+  });
+}
+}  // namespace cox
+
 }  // namespace common
 }  // namespace xgboost
@@ -18,6 +18,7 @@
 #include <memory>
 #include <algorithm>
 #include <limits>
+#include <vector>
 #include "probability_distribution.h"
 
 DECLARE_FIELD_ENUM_CLASS(xgboost::common::ProbabilityDistributionType);
@@ -233,6 +234,65 @@ struct AFTLoss {
 
     return aft::Clip(hessian, aft::kMinHessian, aft::kMaxHessian);
   }
+
+  /*!
+   * \brief Compute gradient and hessian together.  The logarithm of labels and the
+   *        distribution terms are evaluated once, the result is the same as calling
+   *        `Gradient` and `Hessian`.
+   */
+  XGBOOST_DEVICE inline static
+  void GradHess(double y_lower, double y_upper, double y_pred, double sigma,
+                double *out_grad, double *out_hess) {
+    double grad_numerator, grad_denominator, hess_numerator, hess_denominator;
+    CensoringType censor_type;
+    bool z_sign;  // sign of z-score
+
+    if (y_lower == y_upper) {  // uncensored
+      const double z = (log(y_lower) - y_pred) / sigma;
+      const DistributionTerms t = Distribution::Terms(z);
+      censor_type = CensoringType::kUncensored;
+      grad_numerator = t.grad_pdf;
+      grad_denominator = sigma * t.pdf;
+      hess_numerator = -(t.pdf * t.hess_pdf - t.grad_pdf * t.grad_pdf);
+      hess_denominator = sigma * sigma * t.pdf * t.pdf;
+      z_sign = (z > 0);
+    } else {  // censored; now check what type of censorship we have
+      double z_u = 0.0, z_l = 0.0;
+      DistributionTerms u{0.0, 1.0, 0.0, 0.0}, l{0.0, 0.0, 0.0, 0.0};
+      censor_type = CensoringType::kIntervalCensored;
+      if (isinf(y_upper)) {  // right-censored
+        censor_type = CensoringType::kRightCensored;
+      } else {  // interval-censored or left-censored
+        z_u = (log(y_upper) - y_pred) / sigma;
+        u = Distribution::Terms(z_u);
+      }
+      if (y_lower <= 0.0) {  // left-censored
+        censor_type = CensoringType::kLeftCensored;
+      } else {  // interval-censored or right-censored
+        z_l = (log(y_lower) - y_pred) / sigma;
+        l = Distribution::Terms(z_l);
+      }
+      const double cdf_diff = u.cdf - l.cdf;
+      const double pdf_diff = u.pdf - l.pdf;
+      const double grad_diff = u.grad_pdf - l.grad_pdf;
+      z_sign = (z_u > 0 || z_l > 0);
+      grad_numerator = pdf_diff;
+      grad_denominator = sigma * cdf_diff;
+      hess_numerator = -(cdf_diff * grad_diff - pdf_diff * pdf_diff);
+      hess_denominator = grad_denominator * grad_denominator;
+    }
+
+    double gradient = grad_numerator / grad_denominator;
+    if (grad_denominator < aft::kEps && (isnan(gradient) || isinf(gradient))) {
+      gradient = aft::GetLimitGradAtInfPred<Distribution>(censor_type, z_sign, sigma);
+    }
+    double hessian = hess_numerator / hess_denominator;
+    if (hess_denominator < aft::kEps && (isnan(hessian) || isinf(hessian))) {
+      hessian = aft::GetLimitHessAtInfPred<Distribution>(censor_type, z_sign, sigma);
+    }
+    *out_grad = aft::Clip(gradient, aft::kMinGradient, aft::kMaxGradient);
+    *out_hess = aft::Clip(hessian, aft::kMinHessian, aft::kMaxHessian);
+  }
 };
 
 namespace aft {
@@ -341,6 +401,45 @@ GetLimitHessAtInfPred<ExtremeDistribution>(CensoringType censor_type, bool sign,
 
 }  // namespace aft
 
+namespace cox {
+/*!
+ * \brief Contiguous blocks of samples in the order of sorted labels, at most one for each
+ *        thread.  Scans over the sorted order are done by scanning blocks in parallel after
+ *        the per-block totals are known.
+ */
+class SortedBlocks {
+  size_t n_;
+  size_t block_size_;
+  size_t n_blocks_;
+
+ public:
+  SortedBlocks(size_t n, int32_t n_threads) : n_{n} {
+    // Avoid scheduling overhead on small data.
+    size_t constexpr kMinBlockSize = 4096;
+    n_blocks_ = std::min(static_cast<size_t>(std::max(n_threads, 1)),
+                         (n + kMinBlockSize - 1) / kMinBlockSize);
+    n_blocks_ = std::max(n_blocks_, static_cast<size_t>(1));
+    block_size_ = (n + n_blocks_ - 1) / n_blocks_;
+  }
+  size_t Size() const { return n_blocks_; }
+  size_t Begin(size_t b) const { return std::min(n_, b * block_size_); }
+  size_t End(size_t b) const { return std::min(n_, (b + 1) * block_size_); }
+};
+
+/*!
+ * \brief Denominators of the Cox partial likelihood, for each position in `label_order`
+ *        the sum of `exp_p` over samples whose absolute label is not smaller.  Tied samples
+ *        share the risk set of the first one (Breslow's method).
+ *
+ * \param label_order Sample indices sorted by absolute label.
+ * \param labels      Labels of samples, negative for censored ones.
+ * \param exp_p       Exponential of prediction for each position in `label_order`.
+ * \param n_threads   Number of threads.
+ * \param out         Output risk set sums.
+ */
+void RiskSetSums(std::vector<size_t> const &label_order, std::vector<float> const &labels,
+                 std::vector<double> const &exp_p, int32_t n_threads, std::vector<double> *out);
+}  // namespace cox
 }  // namespace common
 }  // namespace xgboost
 
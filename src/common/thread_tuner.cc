@@ -0,0 +1,121 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "thread_tuner.h"
+
+#include <algorithm>
+
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace common {
+namespace {
+int32_t Bucket(size_t work) {
+  int32_t bucket = 0;
+  while (work >= 4) {
+    work /= 4;
+    ++bucket;
+  }
+  return bucket;
+}
+}  // anonymous namespace
+
+void ThreadTuner::Init(int32_t max_threads, bool enabled, int32_t n_trials) {
+  CHECK_GE(max_threads, 1);
+  CHECK_GE(n_trials, 1);
+  if (max_threads != max_threads_ || enabled != enabled_ || n_trials != n_trials_) {
+    groups_.clear();
+  }
+  max_threads_ = max_threads;
+  enabled_ = enabled;
+  n_trials_ = n_trials;
+}
+
+ThreadTuner::Group* ThreadTuner::GetGroup(Phase phase, int32_t bucket) {
+  auto it = groups_.find(std::make_pair(phase, bucket));
+  if (it != groups_.end()) {
+    return &it->second;
+  }
+  Group group;
+  for (int32_t n = max_threads_; n >= 1 && group.candidates.size() < 4; n /= 2) {
+    group.candidates.push_back(n);
+  }
+  auto n = group.candidates.size();
+  group.seconds.resize(n, 0.0);
+  group.work.resize(n, 0.0);
+  group.n_trials.resize(n, 0);
+  if (n == 1) {
+    group.chosen = 0;
+  }
+  return &groups_.emplace(std::make_pair(phase, bucket), std::move(group)).first->second;
+}
+
+ThreadTuner::Trial ThreadTuner::Start(Phase phase, size_t work) {
+  Trial trial{phase, Bucket(work), -1, max_threads_, work, {}};
+  if (!enabled_) {
+    return trial;
+  }
+  auto group = this->GetGroup(phase, trial.bucket);
+  if (group->chosen >= 0) {
+    trial.n_threads = group->candidates[group->chosen];
+    return trial;
+  }
+  trial.candidate = group->next;
+  trial.n_threads = group->candidates[trial.candidate];
+  group->next = (group->next + 1) % static_cast<int32_t>(group->candidates.size());
+  trial.start = std::chrono::steady_clock::now();
+  return trial;
+}
+
+void ThreadTuner::Stop(Trial const& trial) {
+  if (trial.candidate < 0) {
+    return;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - trial.start;
+  auto group = this->GetGroup(trial.phase, trial.bucket);
+  auto c = trial.candidate;
+  group->seconds[c] += elapsed.count();
+  group->work[c] += static_cast<double>(trial.work);
+  group->n_trials[c]++;
+  auto measured = std::all_of(group->n_trials.cbegin(), group->n_trials.cend(),
+                              [&](int32_t n) { return n >= n_trials_; });
+  if (!measured) {
+    return;
+  }
+  auto throughput = [&](size_t i) {
+    return group->work[i] / std::max(group->seconds[i], 1e-9);
+  };
+  size_t best = 0;
+  for (size_t i = 1; i < group->candidates.size(); ++i) {
+    if (throughput(i) > throughput(best)) {
+      best = i;
+    }
+  }
+  group->chosen = static_cast<int32_t>(best);
+  LOG(INFO) << "Thread tuner: " << Name(trial.phase) << " with about "
+            << (size_t{1} << (2 * trial.bucket)) << " units of work uses "
+            << group->candidates[best] << " threads (" << throughput(best)
+            << " units/s, " << throughput(0) << " units/s with " << group->candidates[0]
+            << " threads).";
+}
+
+int32_t ThreadTuner::Chosen(Phase phase, size_t work) const {
+  auto it = groups_.find(std::make_pair(phase, Bucket(work)));
+  if (it == groups_.cend() || it->second.chosen < 0) {
+    return -1;
+  }
+  return it->second.candidates[it->second.chosen];
+}
+
+char const* ThreadTuner::Name(Phase phase) {
+  switch (phase) {
+    case kHistogram: return "histogram";
+    case kPartition: return "partition";
+    case kEvaluate: return "evaluate";
+    case kPredictionCache: return "prediction cache";
+    default: LOG(FATAL) << "Unknown phase: " << static_cast<int32_t>(phase);
+  }
+  return "";
+}
+}  // namespace common
+}  // namespace xgboost
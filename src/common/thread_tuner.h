@@ -0,0 +1,83 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file thread_tuner.h
+ * \brief Choose number of threads for each training phase by measuring throughput.
+ */
+#ifndef XGBOOST_COMMON_THREAD_TUNER_H_
+#define XGBOOST_COMMON_THREAD_TUNER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief Phases scale differently with threads, histograms of the root node can use all
+ *        cores while evaluating or partitioning small nodes only pays for synchronization
+ *        beyond a few threads.
+ *
+ *   Calls to each phase are grouped by the amount of work in powers of 4.  The first few
+ *   calls in each group try candidate thread counts in turn, then the one with the best
+ *   throughput is used for the rest of training and the decision is logged.  Thread
+ *   count changes the order of floating point summation, so results are not reproducible
+ *   across runs when tuning is enabled.
+ */
+class ThreadTuner {
+ public:
+  enum Phase : int32_t {
+    kHistogram = 0,
+    kPartition,
+    kEvaluate,
+    kPredictionCache,
+    kNumPhases
+  };
+
+  struct Trial {
+    Phase phase;
+    int32_t bucket;
+    int32_t candidate;  // -1 if not measured.
+    int32_t n_threads;
+    size_t work;
+    std::chrono::steady_clock::time_point start;
+  };
+
+ private:
+  struct Group {
+    std::vector<int32_t> candidates;
+    std::vector<double> seconds;
+    std::vector<double> work;
+    std::vector<int32_t> n_trials;
+    int32_t next{0};
+    int32_t chosen{-1};
+  };
+
+  bool enabled_{false};
+  int32_t max_threads_{1};
+  int32_t n_trials_{3};
+  std::map<std::pair<Phase, int32_t>, Group> groups_;
+
+  Group* GetGroup(Phase phase, int32_t bucket);
+
+ public:
+  /**
+   * \param max_threads Upper bound of the number of threads.
+   * \param enabled     When disabled, all phases run with `max_threads`.
+   * \param n_trials    Number of measurements for each candidate.
+   */
+  void Init(int32_t max_threads, bool enabled, int32_t n_trials = 3);
+
+  /** \brief Start a call to `phase`, processing `work` units (rows or nodes). */
+  Trial Start(Phase phase, size_t work);
+  void Stop(Trial const& trial);
+
+  /** \brief Chosen number of threads, -1 if still measuring. */
+  int32_t Chosen(Phase phase, size_t work) const;
+
+  static char const* Name(Phase phase);
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_THREAD_TUNER_H_
@@ -10,22 +10,26 @@
 #include <dmlc/omp.h>
 
 #include <algorithm>
+#include <atomic>
 #include <limits>
 #include <type_traits>  // std::is_signed
 #include <vector>
 
 #include "xgboost/logging.h"
+#include "parallel_pool.h"
 
 #if !defined(_OPENMP)
 extern "C" {
 inline int32_t omp_get_thread_limit() __GOMP_NOTHROW { return 1; }  // NOLINT
+inline int32_t omp_get_level() __GOMP_NOTHROW { return 0; }  // NOLINT
 }
 #endif  // !defined(_OPENMP)
 
-// MSVC doesn't implement the thread limit.
+// MSVC doesn't implement the thread limit and nesting level.
 #if defined(_OPENMP) && defined(_MSC_VER)
 extern "C" {
 inline int32_t omp_get_thread_limit() { return std::numeric_limits<int32_t>::max(); }  // NOLINT
+inline int32_t omp_get_level() { return omp_in_parallel(); }  // NOLINT
 }
 #endif  // defined(_MSC_VER)
 
@@ -151,6 +155,53 @@ void ParallelFor2d(const BlockedSpace2d& space, int nthreads, Func func) {
   exc.Rethrow();
 }
 
+/**
+ * \brief Same as `ParallelFor2d`, but threads that finish their own blocks steal
+ *        remaining blocks from other threads.  Blocks are initially distributed in the same
+ *        contiguous chunks as `ParallelFor2d` to keep locality, while unbalanced spaces
+ *        (like nodes with very different sizes) no longer leave threads idle.  Since a block
+ *        might be run by any thread, `func` must not depend on a static mapping between
+ *        threads and blocks.
+ */
+template <typename Func>
+void ParallelFor2dSteal(const BlockedSpace2d& space, int nthreads, Func func) {
+  const size_t num_blocks_in_space = space.Size();
+  nthreads = std::min(nthreads, omp_get_max_threads());
+  nthreads = std::max(nthreads, 1);
+  const size_t n = static_cast<size_t>(nthreads);
+  const size_t chunck_size = num_blocks_in_space / n + !!(num_blocks_in_space % n);
+
+  // Padded to avoid false sharing between threads claiming blocks.
+  struct Cursor {
+    std::atomic<size_t> next;
+    size_t end;
+    char pad[64];
+  };
+  std::vector<Cursor> cursors(n);
+  for (size_t tid = 0; tid < n; ++tid) {
+    size_t begin = std::min(chunck_size * tid, num_blocks_in_space);
+    cursors[tid].next.store(begin, std::memory_order_relaxed);
+    cursors[tid].end = std::min(begin + chunck_size, num_blocks_in_space);
+  }
+
+  dmlc::OMPException exc;
+#pragma omp parallel num_threads(nthreads)
+  {
+    exc.Run([&]() {
+      size_t tid = omp_get_thread_num();
+      // Drain own blocks first, then visit other threads in round robin.
+      for (size_t k = 0; k < n; ++k) {
+        auto& cursor = cursors[(tid + k) % n];
+        for (size_t i = cursor.next.fetch_add(1, std::memory_order_relaxed); i < cursor.end;
+             i = cursor.next.fetch_add(1, std::memory_order_relaxed)) {
+          func(space.GetFirstDimension(i), space.GetRange(i));
+        }
+      }
+    });
+  }
+  exc.Rethrow();
+}
+
 /**
  * OpenMP schedule
  */
@@ -169,8 +220,41 @@ struct Sched {
   Sched static Guided() { return Sched{kGuided}; }
 };
 
+/**
+ * \brief Index of current thread in the running parallel loop, use this instead of
+ *        `omp_get_thread_num` in bodies of `ParallelFor` as they might run on the
+ *        `ParallelPool`.
+ */
+inline int32_t ThreadIdx() {
+  auto slot = ParallelPool::LocalSlot();
+  if (slot >= 0 && omp_get_level() == 0) {
+    return slot;
+  }
+  return omp_get_thread_num();
+}
+
 template <typename Index, typename Func>
 void ParallelFor(Index size, int32_t n_threads, Sched sched, Func fn) {
+  if (ParallelPool::GetBackend() == ParallelPool::kPool && omp_get_level() == 0) {
+    auto n = static_cast<size_t>(std::max(size, static_cast<Index>(0)));
+    auto n_chunks = static_cast<size_t>(std::max(n_threads, 1)) * 4;
+    size_t chunk = sched.chunk;
+    if (chunk == 0) {
+      // Unlike static schedule of OpenMP, the loop is split into more chunks than threads
+      // so that idle threads can help others.
+      chunk = sched.sched == Sched::kDynamic ? 1 : std::max((n + n_chunks - 1) / n_chunks,
+                                                            static_cast<size_t>(1));
+    }
+    dmlc::OMPException exc;
+    ParallelPool::Get()->Run(n, chunk, n_threads, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        exc.Run(fn, static_cast<Index>(i));
+      }
+    });
+    exc.Rethrow();
+    return;
+  }
+
 #if defined(_MSC_VER)
   // msvc doesn't support unsigned integer as openmp index.
   using OmpInd = std::conditional_t<std::is_signed<Index>::value, Index, omp_ulong>;
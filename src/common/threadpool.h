@@ -0,0 +1,93 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file threadpool.h
+ * \brief Simple thread pool for running blocking tasks like I/O.
+ */
+#ifndef XGBOOST_COMMON_THREADPOOL_H_
+#define XGBOOST_COMMON_THREADPOOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace common {
+/**
+ * \brief Fixed size thread pool with a FIFO task queue.  Pending tasks are finished before
+ *        the pool is destroyed.  Not to be used for compute bound tasks, which should use
+ *        `ParallelFor` instead.
+ */
+class ThreadPool {
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::queue<std::function<void()>> tasks_;
+  std::vector<std::thread> pool_;
+  bool stop_{false};
+
+ public:
+  explicit ThreadPool(int32_t n_threads) {
+    CHECK_GE(n_threads, 1);
+    for (int32_t i = 0; i < n_threads; ++i) {
+      pool_.emplace_back([this] {
+        while (true) {
+          std::function<void()> task;
+          {
+            std::unique_lock<std::mutex> lock{mu_};
+            cv_.wait(lock, [this] { return !this->tasks_.empty() || stop_; });
+            if (tasks_.empty()) {
+              return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+          }
+          task();
+        }
+      });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> guard{mu_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : pool_) {
+      t.join();
+    }
+  }
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  /**
+   * \brief Submit a task, exception thrown by the task is propagated through the returned
+   *        future.
+   */
+  template <typename Fn, typename R = std::result_of_t<Fn()>>
+  std::future<R> Submit(Fn&& fn) {
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+    auto fut = task->get_future();
+    {
+      std::lock_guard<std::mutex> guard{mu_};
+      tasks_.emplace([task] { (*task)(); });
+    }
+    cv_.notify_one();
+    return fut;
+  }
+
+  size_t Size() const { return pool_.size(); }
+};
+}  // namespace common
+}  // namespace xgboost
+#endif  // XGBOOST_COMMON_THREADPOOL_H_
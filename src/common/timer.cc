@@ -7,34 +7,140 @@
 #include <utility>
 #include <vector>
 #include <sstream>
+#include <string>
 #include "timer.h"
 
-#if defined(XGBOOST_USE_NVTX)
-#include <nvToolsExt.h>
-#endif  // defined(XGBOOST_USE_NVTX)
-
 namespace xgboost {
 namespace common {
 
+Tracer* Tracer::Get() {
+  static Tracer tracer;
+  return &tracer;
+}
+
+int32_t Tracer::Intern(std::string const& name) {
+  std::lock_guard<std::mutex> guard{lock_};
+  auto it = name_ids_.find(name);
+  if (it != name_ids_.cend()) {
+    return it->second;
+  }
+  auto id = static_cast<int32_t>(names_.size());
+  names_.push_back(name);
+  name_ids_[name] = id;
+  return id;
+}
+
+Tracer::ThreadBuffer* Tracer::LocalBuffer() {
+  static thread_local std::shared_ptr<ThreadBuffer> local;
+  static thread_local uint64_t local_generation {0};
+  auto generation = generation_.load(std::memory_order_acquire);
+  if (!local || local_generation != generation) {
+    std::lock_guard<std::mutex> guard{lock_};
+    local = std::make_shared<ThreadBuffer>();
+    local->events.resize(buffer_size_);
+    local->tid = buffers_.size();
+    // Owned by the tracer as well, so events survive the exit of thread.
+    buffers_.push_back(local);
+    local_generation = generation;
+  }
+  return local.get();
+}
+
+void Tracer::Start(size_t buffer_size) {
+  CHECK_GT(buffer_size, 0);
+  std::lock_guard<std::mutex> guard{lock_};
+  buffers_.clear();
+  buffer_size_ = buffer_size;
+  start_ = Timer::ClockT::now();
+  generation_.fetch_add(1, std::memory_order_release);
+  enabled_ = true;
+}
+
+void Tracer::Stop(std::string* out) {
+  enabled_ = false;
+  std::lock_guard<std::mutex> guard{lock_};
+  auto pid = rabit::GetRank();
+  std::stringstream ss;
+  ss << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  for (auto const& buffer : buffers_) {
+    auto const& events = buffer->events;
+    size_t n_events = std::min(buffer->n_recorded, events.size());
+    size_t beg = buffer->n_recorded - n_events;
+    // Events at the front of ring buffer might be overwritten, skip the dangling ends.
+    size_t depth = 0;
+    for (size_t i = beg; i < buffer->n_recorded; ++i) {
+      auto const& e = events[i % events.size()];
+      if (e.phase == Phase::kBegin) {
+        depth++;
+      } else if (depth == 0) {
+        continue;
+      } else {
+        depth--;
+      }
+      double ts = std::chrono::duration<double, std::micro>(e.time - start_).count();
+      ss << (first ? "" : ",") << "\n  {\"name\": \"" << names_.at(e.name)
+         << "\", \"ph\": \"" << static_cast<char>(e.phase) << "\", \"ts\": " << std::fixed
+         << ts << ", \"pid\": " << pid << ", \"tid\": " << buffer->tid << "}";
+      first = false;
+    }
+  }
+  ss << "\n]}\n";
+  *out = ss.str();
+  buffers_.clear();
+  generation_.fetch_add(1, std::memory_order_release);
+}
+
 void Monitor::Start(std::string const &name) {
-  if (ConsoleLogger::ShouldLog(ConsoleLogger::LV::kDebug)) {
-    auto &stats = statistics_map_[name];
+  bool const debug = ConsoleLogger::ShouldLog(ConsoleLogger::LV::kDebug);
+  auto* tracer = Tracer::Get();
+  bool const tracing = tracer->Enabled();
+  // Profiler annotations are always emitted when compiled in, the profiler decides
+  // whether to collect them.
+  if (!debug && !tracing && !Annotation::kEnabled) {
+    return;
+  }
+  auto &stats = statistics_map_[name];
+  if (debug) {
     stats.timer.Start();
-#if defined(XGBOOST_USE_NVTX)
-    std::string nvtx_name = "xgboost::" + label_ + "::" + name;
-    stats.nvtx_id = nvtxRangeStartA(nvtx_name.c_str());
-#endif  // defined(XGBOOST_USE_NVTX)
+  }
+  if (Annotation::kEnabled) {
+    if (!stats.annotation.Initialized()) {
+      stats.annotation.Init("xgboost::" + label_ + "::" + name);
+    }
+    stats.annotation.Push();
+  }
+  if (tracing) {
+    if (stats.trace_id < 0) {
+      stats.trace_id = tracer->Intern(label_ + "::" + name);
+    }
+    tracer->Record(stats.trace_id, Tracer::Phase::kBegin);
   }
 }
 
 void Monitor::Stop(const std::string &name) {
-  if (ConsoleLogger::ShouldLog(ConsoleLogger::LV::kDebug)) {
-    auto &stats = statistics_map_[name];
+  bool const debug = ConsoleLogger::ShouldLog(ConsoleLogger::LV::kDebug);
+  auto* tracer = Tracer::Get();
+  bool const tracing = tracer->Enabled();
+  if (!debug && !tracing && !Annotation::kEnabled) {
+    return;
+  }
+  auto &stats = statistics_map_[name];
+  if (debug) {
     stats.timer.Stop();
     stats.count++;
-#if defined(XGBOOST_USE_NVTX)
-    nvtxRangeEnd(stats.nvtx_id);
-#endif  // defined(XGBOOST_USE_NVTX)
+  }
+  if (Annotation::kEnabled && stats.annotation.Initialized()) {
+    stats.annotation.Pop();
+  }
+  if (tracing && stats.trace_id >= 0) {
+    tracer->Record(stats.trace_id, Tracer::Phase::kEnd);
+  }
+}
+
+void Monitor::Count(const std::string &name, size_t n) {
+  if (ConsoleLogger::ShouldLog(ConsoleLogger::LV::kDebug)) {
+    counters_[name] += n;
   }
 }
 
@@ -64,6 +170,9 @@ void Monitor::Print() const {
   }
   LOG(CONSOLE) << "======== Monitor (" << rank << "): " << label_ << " ========";
   this->PrintStatistics(stat_map);
+  for (auto const &kv : counters_) {
+    LOG(CONSOLE) << kv.first << ": " << kv.second;
+  }
 }
 
 }  // namespace common
@@ -3,13 +3,19 @@
  */
 #pragma once
 #include <xgboost/logging.h>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "annotation.h"
+
 namespace xgboost {
 namespace common {
 
@@ -38,6 +44,64 @@ struct Timer {
   }
 };
 
+/**
+ * \brief Process wide recorder for begin/end events of Monitor timers.
+ *
+ *   Each thread writes into its own ring buffer so recording doesn't require any
+ *   locking, names are interned into integer IDs beforehand.  Recorded events are dumped
+ *   in the Chrome trace event format, which can be loaded by Perfetto or
+ *   chrome://tracing.  The process ID of events is the rabit rank.
+ */
+class Tracer {
+ public:
+  enum class Phase : char { kBegin = 'B', kEnd = 'E' };
+
+ private:
+  struct Event {
+    int32_t name;
+    Phase phase;
+    Timer::TimePointT time;
+  };
+  struct ThreadBuffer {
+    std::vector<Event> events;
+    size_t n_recorded {0};
+    size_t tid {0};
+  };
+
+  std::atomic<bool> enabled_ {false};
+  // Thread local buffers are discarded when generation changes.
+  std::atomic<uint64_t> generation_ {0};
+  size_t buffer_size_ {0};
+  Timer::TimePointT start_;
+
+  std::mutex lock_;
+  std::vector<std::string> names_;
+  std::map<std::string, int32_t> name_ids_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+  ThreadBuffer* LocalBuffer();
+
+ public:
+  static size_t constexpr kDefaultBufferSize = static_cast<size_t>(1) << 16;
+  static Tracer* Get();
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  /*! \brief Get the ID of name, IDs are valid for the lifetime of process. */
+  int32_t Intern(std::string const& name);
+  /*! \brief Start recording, events from previous session are discarded. */
+  void Start(size_t buffer_size = kDefaultBufferSize);
+  /*! \brief Stop recording and dump the events as Chrome trace JSON. */
+  void Stop(std::string* out);
+
+  void Record(int32_t name, Phase phase) {
+    auto time = Timer::ClockT::now();
+    auto* buffer = this->LocalBuffer();
+    auto& events = buffer->events;
+    events[buffer->n_recorded % events.size()] = Event{name, phase, time};
+    buffer->n_recorded++;
+  }
+};
+
 /**
  * \struct  Monitor
  *
@@ -49,7 +113,8 @@ struct Monitor {
   struct Statistics {
     Timer timer;
     size_t count{0};
-    uint64_t nvtx_id;
+    Annotation annotation;
+    int32_t trace_id{-1};
   };
 
   // from left to right, <name <count, elapsed>>
@@ -57,6 +122,7 @@ struct Monitor {
 
   std::string label_ = "";
   std::map<std::string, Statistics> statistics_map_;
+  std::map<std::string, size_t> counters_;
   Timer self_timer_;
 
   void PrintStatistics(StatMap const& statistics) const;
@@ -80,6 +146,8 @@ struct Monitor {
   void Init(std::string label) { this->label_ = label; }
   void Start(const std::string &name);
   void Stop(const std::string &name);
+  /*! \brief Accumulate a counter, printed along with the timers. */
+  void Count(const std::string &name, size_t n = 1);
 };
 }  // namespace common
 }  // namespace xgboost
@@ -8,6 +8,7 @@
 #include <dmlc/common.h>
 
 #include <xgboost/data.h>
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <type_traits>  // enable_if
@@ -28,6 +29,25 @@ namespace common {
 constexpr size_t kBlockThreads = 256;
 
 namespace detail {
+// Upper bound of elements in each block processed by a CPU thread.
+constexpr size_t kCPUBlockSize = 4096;
+
+// Placeholder for an evaluator without CPU block function.
+struct NoCPUBlock {};
+
+template <typename Functor, typename... SpanType>
+void RunCPUBlock(NoCPUBlock, Functor const& func, size_t begin, size_t end,
+                 SpanType... spans) {
+  for (size_t idx = begin; idx < end; ++idx) {
+    func(idx, spans...);
+  }
+}
+
+template <typename Block, typename Functor, typename... SpanType>
+void RunCPUBlock(Block const& block, Functor const&, size_t begin, size_t end,
+                 SpanType... spans) {
+  block(begin, end, spans...);
+}
 
 #if defined(__CUDACC__)
 template <typename Functor, typename... SpanType>
@@ -58,14 +78,24 @@ __global__ void LaunchCUDAKernel(Functor _func, Range _range,
 template <bool CompiledWithCuda = WITH_CUDA()>
 class Transform {
  private:
-  template <typename Functor>
+  template <typename Functor, typename CPUBlock = detail::NoCPUBlock>
   struct Evaluator {
    public:
-    Evaluator(Functor func, Range range, int device, bool shard) :
-        func_(func), range_{std::move(range)},
+    Evaluator(Functor func, Range range, int device, bool shard, CPUBlock block = {}) :
+        func_(func), block_(block), range_{std::move(range)},
         shard_{shard},
         device_{device} {}
 
+    /*!
+     * \brief Run `block` instead of the functor on CPU.  It's called with a contiguous
+     *        range [begin, end) of the indices followed by the spans, so that it can loop
+     *        over raw pointers and be vectorized by the compiler.
+     */
+    template <typename Block>
+    Evaluator<Functor, Block> WithCPUBlock(Block block) const {
+      return Evaluator<Functor, Block>{func_, range_, device_, shard_, block};
+    }
+
     /*!
      * \brief Evaluate the functor with input pointers to HostDeviceVector.
      *
@@ -168,16 +198,37 @@ class Transform {
 
     template <typename... HDV>
     void LaunchCPU(Functor func, HDV*... vectors) const {
-      omp_ulong end = static_cast<omp_ulong>(*(range_.end()));
       SyncHost(vectors...);
-      ParallelFor(end, [&](omp_ulong idx) {
-        func(idx, UnpackHDV(vectors)...);
+      // Unpack only once, getting the host pointer checks and tracks the vector.
+      this->LaunchCPUBlocks(func, UnpackHDV(vectors)...);
+    }
+
+    template <typename... SpanType>
+    void LaunchCPUBlocks(Functor const& func, SpanType... spans) const {
+      auto end = static_cast<size_t>(*(range_.end()));
+      // Starting a parallel region dominates the cost for tiny inputs like single row
+      // prediction.
+      size_t constexpr kMinParallelSize = 64;
+      if (end <= kMinParallelSize) {
+        detail::RunCPUBlock(block_, func, 0, end, spans...);
+        return;
+      }
+      // Smaller blocks for small inputs so that every thread has some work.
+      size_t block_size = std::min(
+          detail::kCPUBlockSize, DivRoundUp(end, static_cast<size_t>(omp_get_max_threads())));
+      auto n_blocks = static_cast<omp_ulong>(DivRoundUp(end, block_size));
+      ParallelFor(n_blocks, [&](omp_ulong i) {
+        size_t begin = i * block_size;
+        detail::RunCPUBlock(block_, func, begin, std::min(begin + block_size, end),
+                            spans...);
       });
     }
 
    private:
     /*! \brief Callable object. */
     Functor func_;
+    /*! \brief Callable object for a block of indices on CPU. */
+    CPUBlock block_;
     /*! \brief Range object specifying parallel threads index range. */
     Range range_;
     /*! \brief Whether sharding for vectors is required. */
@@ -20,7 +20,9 @@
 #include "xgboost/span.h"
 
 #include "array_interface.h"
+#include "arrow_cdi.h"
 #include "../c_api/c_api_error.h"
+#include "../common/category_dictionary.h"
 #include "../common/math.h"
 
 namespace xgboost {
@@ -599,6 +601,321 @@ class DataTableAdapter
   size_t num_columns_;
 };
 
+/**
+ * \brief Adapter for a record batch exported through the Arrow C data interface, which is
+ *        a struct array with one child array for each feature.  Buffers are read in place,
+ *        null entries are treated as missing values and indices of dictionary encoded
+ *        arrays are used as categories.  The batch is viewed as row major so that it can
+ *        also be used for inplace prediction.
+ *
+ *   String columns and dictionaries of strings are encoded with a `CategoryDictionary`
+ *   when the batch is created, only the dictionary entries are hashed for dictionary
+ *   encoded columns.
+ */
+class ArrowAdapterBatch : public detail::NoMetaInfo {
+ public:
+  enum class ArrowType : uint8_t {
+    kBool = 0,
+    kInt8 = 1,
+    kUInt8 = 2,
+    kInt16 = 3,
+    kUInt16 = 4,
+    kInt32 = 5,
+    kUInt32 = 6,
+    kInt64 = 7,
+    kUInt64 = 8,
+    kFloat32 = 9,
+    kFloat64 = 10,
+    // Codes of a string column, encoded as float with NaN for nulls.
+    kEncoded = 11
+  };
+
+  struct Column {
+    ArrowType type;
+    bool is_categorical;
+    // Offset of the first row, including the offset of parent struct array.
+    int64_t offset;
+    uint8_t const* validity;
+    void const* data;
+    // Code of each dictionary entry, only for dictionaries of strings.
+    float const* remap{nullptr};
+  };
+
+ private:
+  std::vector<Column> columns_;
+  std::vector<std::string> names_;
+  size_t num_rows_{0};
+  std::shared_ptr<common::CategoryDictionary const> categories_;
+  // Storage of codes referred by columns, shared by copies of this batch.
+  std::vector<std::shared_ptr<std::vector<float>>> codes_;
+
+  static bool IsString(char const* format) {
+    std::string fmt{format};
+    return fmt == "u" || fmt == "U" || fmt == "z" || fmt == "Z";
+  }
+
+  static ArrowType GetType(char const* format, bool is_dictionary) {
+    std::string fmt{format};
+    if (fmt.size() == 1) {
+      switch (fmt.front()) {
+        case 'b':
+          if (!is_dictionary) {
+            return ArrowType::kBool;
+          }
+          break;
+        case 'c':
+          return ArrowType::kInt8;
+        case 'C':
+          return ArrowType::kUInt8;
+        case 's':
+          return ArrowType::kInt16;
+        case 'S':
+          return ArrowType::kUInt16;
+        case 'i':
+          return ArrowType::kInt32;
+        case 'I':
+          return ArrowType::kUInt32;
+        case 'l':
+          return ArrowType::kInt64;
+        case 'L':
+          return ArrowType::kUInt64;
+        case 'f':
+          if (!is_dictionary) {
+            return ArrowType::kFloat32;
+          }
+          break;
+        case 'g':
+          if (!is_dictionary) {
+            return ArrowType::kFloat64;
+          }
+          break;
+        default:
+          break;
+      }
+    }
+    LOG(FATAL) << "Unsupported arrow type: `" << fmt << "`"
+               << (is_dictionary ? " for dictionary indices." : ".");
+    return ArrowType::kFloat32;
+  }
+
+  template <typename T>
+  static T Load(void const* data, int64_t i) {
+    return reinterpret_cast<T const*>(data)[i];
+  }
+
+  static bool GetBit(void const* bitmap, int64_t i) {
+    return (reinterpret_cast<uint8_t const*>(bitmap)[i >> 3] >> (i & 7)) & 1;
+  }
+
+  /**
+   * \brief Call `fn(i, str, len)` for `n` strings of a string array starting at `begin`,
+   *        `str` is null for null entries.
+   */
+  template <typename Fn>
+  static void VisitStrings(ArrowArray const* array, char const* format, int64_t begin,
+                           int64_t n, Fn&& fn) {
+    CHECK_EQ(array->n_buffers, 3) << "Invalid arrow string array.";
+    bool large = format[0] == 'U' || format[0] == 'Z';
+    auto const* validity =
+        array->null_count == 0 ? nullptr : static_cast<uint8_t const*>(array->buffers[0]);
+    auto const* offsets = array->buffers[1];
+    auto const* chars = static_cast<char const*>(array->buffers[2]);
+    for (int64_t i = 0; i < n; ++i) {
+      auto j = array->offset + begin + i;
+      if (validity && !GetBit(validity, j)) {
+        fn(i, nullptr, 0);
+        continue;
+      }
+      int64_t b = large ? Load<int64_t>(offsets, j) : Load<int32_t>(offsets, j);
+      int64_t e = large ? Load<int64_t>(offsets, j + 1) : Load<int32_t>(offsets, j + 1);
+      fn(i, chars + b, static_cast<size_t>(e - b));
+    }
+  }
+
+  static float GetValue(Column const& column, size_t ridx) {
+    auto i = column.offset + static_cast<int64_t>(ridx);
+    if (column.validity && !GetBit(column.validity, i)) {
+      return std::numeric_limits<float>::quiet_NaN();
+    }
+    if (column.remap) {
+      return column.remap[static_cast<int64_t>(LoadValue(column, i))];
+    }
+    return LoadValue(column, i);
+  }
+
+  static float LoadValue(Column const& column, int64_t i) {
+    switch (column.type) {
+      case ArrowType::kBool:
+        return static_cast<float>(GetBit(column.data, i));
+      case ArrowType::kInt8:
+        return static_cast<float>(Load<int8_t>(column.data, i));
+      case ArrowType::kUInt8:
+        return static_cast<float>(Load<uint8_t>(column.data, i));
+      case ArrowType::kInt16:
+        return static_cast<float>(Load<int16_t>(column.data, i));
+      case ArrowType::kUInt16:
+        return static_cast<float>(Load<uint16_t>(column.data, i));
+      case ArrowType::kInt32:
+        return static_cast<float>(Load<int32_t>(column.data, i));
+      case ArrowType::kUInt32:
+        return static_cast<float>(Load<uint32_t>(column.data, i));
+      case ArrowType::kInt64:
+        return static_cast<float>(Load<int64_t>(column.data, i));
+      case ArrowType::kUInt64:
+        return static_cast<float>(Load<uint64_t>(column.data, i));
+      case ArrowType::kFloat32:
+        return Load<float>(column.data, i);
+      case ArrowType::kFloat64:
+        return static_cast<float>(Load<double>(column.data, i));
+      case ArrowType::kEncoded:
+        return Load<float>(column.data, i);
+    }
+    return std::numeric_limits<float>::quiet_NaN();
+  }
+
+  class Line {
+   public:
+    Line(common::Span<Column const> columns, size_t ridx) : columns_{columns}, ridx_{ridx} {}
+
+    size_t Size() const { return columns_.size(); }
+    COOTuple GetElement(size_t idx) const {
+      return COOTuple{ridx_, idx, GetValue(columns_[idx], ridx_)};
+    }
+
+   private:
+    common::Span<Column const> columns_;
+    size_t ridx_;
+  };
+
+ public:
+  /**
+   * \param categories Dictionary used to encode strings, new categories are added to a
+   *                   copy of it when `extend` is true, otherwise they are treated as
+   *                   missing.  Strings are encoded by a new dictionary when it's null.
+   */
+  ArrowAdapterBatch(ArrowArray const* array, ArrowSchema const* schema,
+                    std::shared_ptr<common::CategoryDictionary const> categories = nullptr,
+                    bool extend = true) {
+    CHECK(array && schema) << "Invalid arrow record batch.";
+    CHECK(array->release && schema->release) << "Arrow record batch has been released.";
+    CHECK_EQ(std::string{schema->format}, "+s")
+        << "Expecting a struct array exported from arrow record batch.";
+    CHECK_EQ(array->n_children, schema->n_children);
+    CHECK_EQ(array->null_count, 0) << "Null rows are not supported in arrow record batch.";
+    num_rows_ = static_cast<size_t>(array->length);
+
+    // Indices are used as codes when the dictionary array is not available.
+    auto is_str_dict = [&](int64_t c) {
+      auto const* s = schema->children[c];
+      return s->dictionary && IsString(s->dictionary->format) && array->children[c]->dictionary;
+    };
+    bool has_str = false;
+    for (int64_t c = 0; c < array->n_children; ++c) {
+      has_str = has_str || IsString(schema->children[c]->format) || is_str_dict(c);
+    }
+    std::shared_ptr<common::CategoryDictionary> extended;
+    if (has_str && (extend || !categories)) {
+      extended = categories ? std::make_shared<common::CategoryDictionary>(*categories)
+                            : std::make_shared<common::CategoryDictionary>();
+      extended->Resize(static_cast<bst_feature_t>(array->n_children));
+      categories = extended;
+    }
+    auto encode = [&](bst_feature_t fidx, char const* str, size_t len) {
+      if (!str) {
+        return std::numeric_limits<float>::quiet_NaN();
+      }
+      auto code = extended ? extended->Insert(fidx, str, len) : categories->Find(fidx, str, len);
+      return code == common::CategoryDictionary::kUnknown
+                 ? std::numeric_limits<float>::quiet_NaN()
+                 : static_cast<float>(code);
+    };
+    if (has_str) {
+      categories_ = categories;
+    }
+
+    for (int64_t c = 0; c < array->n_children; ++c) {
+      auto const* child = array->children[c];
+      auto const* child_schema = schema->children[c];
+      auto fidx = static_cast<bst_feature_t>(c);
+      CHECK_GE(child->length, array->offset + array->length);
+      Column column;
+      if (IsString(child_schema->format)) {
+        codes_.emplace_back(std::make_shared<std::vector<float>>(num_rows_));
+        auto& codes = *codes_.back();
+        VisitStrings(child, child_schema->format, array->offset, array->length,
+                     [&](int64_t i, char const* str, size_t len) {
+                       codes[i] = encode(fidx, str, len);
+                     });
+        column.type = ArrowType::kEncoded;
+        column.is_categorical = true;
+        column.offset = 0;
+        column.validity = nullptr;
+        column.data = codes.data();
+        columns_.push_back(column);
+        names_.emplace_back(child_schema->name == nullptr ? "" : child_schema->name);
+        continue;
+      }
+      bool is_categorical = child_schema->dictionary != nullptr;
+      column.type = GetType(child_schema->format, is_categorical);
+      column.is_categorical = is_categorical;
+      column.offset = array->offset + child->offset;
+      CHECK_EQ(child->n_buffers, 2) << "Invalid arrow array for column " << c << ".";
+      column.validity = child->null_count == 0
+                            ? nullptr
+                            : reinterpret_cast<uint8_t const*>(child->buffers[0]);
+      column.data = child->buffers[1];
+      CHECK(column.data || array->length == 0);
+      if (is_str_dict(c)) {
+        auto const* dict = child->dictionary;
+        codes_.emplace_back(std::make_shared<std::vector<float>>(dict->length));
+        auto& codes = *codes_.back();
+        VisitStrings(dict, child_schema->dictionary->format, 0, dict->length,
+                     [&](int64_t i, char const* str, size_t len) {
+                       codes[i] = encode(fidx, str, len);
+                     });
+        column.remap = codes.data();
+      }
+      columns_.push_back(column);
+      names_.emplace_back(child_schema->name == nullptr ? "" : child_schema->name);
+    }
+  }
+
+  size_t Size() const { return num_rows_; }
+  const Line GetLine(size_t idx) const {
+    return Line{common::Span<Column const>{columns_}, idx};
+  }
+  static constexpr bool kIsRowMajor = true;
+
+  size_t NumRows() const { return num_rows_; }
+  size_t NumCols() const { return columns_.size(); }
+  /*! \brief Feature types, `c` for dictionary encoded columns and `q` for others. */
+  std::vector<std::string> FeatureTypes() const {
+    std::vector<std::string> types;
+    for (auto const& column : columns_) {
+      types.emplace_back(column.is_categorical ? "c" : "q");
+    }
+    return types;
+  }
+  /*! \brief Names of arrow fields. */
+  std::vector<std::string> const& FeatureNames() const { return names_; }
+  /*! \brief Dictionary used to encode string columns, null if there's no string column. */
+  std::shared_ptr<common::CategoryDictionary const> Categories() const { return categories_; }
+};
+
+class ArrowAdapter : public detail::SingleBatchDataIter<ArrowAdapterBatch> {
+ public:
+  ArrowAdapter(ArrowArray const* array, ArrowSchema const* schema,
+               std::shared_ptr<common::CategoryDictionary const> categories = nullptr,
+               bool extend = true)
+      : batch_{array, schema, std::move(categories), extend} {}
+  const ArrowAdapterBatch& Value() const override { return batch_; }
+  size_t NumRows() const { return batch_.NumRows(); }
+  size_t NumColumns() const { return batch_.NumCols(); }
+
+ private:
+  ArrowAdapterBatch batch_;
+};
+
 class FileAdapterBatch {
  public:
   class Line {
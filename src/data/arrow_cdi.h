@@ -0,0 +1,57 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ * \file arrow_cdi.h
+ * \brief Structures of the Arrow C data interface, copied from the Arrow specification:
+ *        https://arrow.apache.org/docs/format/CDataInterface.html
+ */
+#ifndef XGBOOST_DATA_ARROW_CDI_H_
+#define XGBOOST_DATA_ARROW_CDI_H_
+
+#include <cstdint>
+
+// The guard is defined by the specification so that other copies of the same definitions
+// can coexist.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+}  // extern "C"
+
+#endif  // ARROW_C_DATA_INTERFACE
+#endif  // XGBOOST_DATA_ARROW_CDI_H_
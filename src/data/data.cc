@@ -3,8 +3,10 @@
  * \file data.cc
  */
 #include <dmlc/registry.h>
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <numeric>
 
 #include "dmlc/io.h"
 #include "xgboost/data.h"
@@ -18,6 +20,7 @@
 #include "sparse_page_writer.h"
 #include "simple_dmatrix.h"
 
+#include "../common/common.h"
 #include "../common/io.h"
 #include "../common/linalg_op.h"
 #include "../common/math.h"
@@ -27,6 +30,7 @@
 #include "../data/adapter.h"
 #include "../data/iterative_device_dmatrix.h"
 #include "file_iterator.h"
+#include "text_parser.h"
 
 #include "validation.h"
 #include "./sparse_page_source.h"
@@ -180,6 +184,27 @@ void MetaInfo::Clear() {
   group_ptr_.clear();
   weights_.HostVector().clear();
   base_margin_ = decltype(base_margin_){};
+  label_bits_cache_ = LabelBitsCache{};
+}
+
+std::vector<uint64_t> const* MetaInfo::BinaryLabelBits() const {
+  auto& cache = label_bits_cache_;
+  if (!cache.initialized || cache.n_labels != labels_.Size()) {
+    auto const& h_labels = labels_.ConstHostVector();
+    size_t constexpr kBits = sizeof(uint64_t) * 8;
+    cache.binary = std::all_of(h_labels.cbegin(), h_labels.cend(),
+                               [](float y) { return y == 0.0f || y == 1.0f; });
+    cache.bits.clear();
+    if (cache.binary) {
+      cache.bits.resize(common::DivRoundUp(h_labels.size(), kBits), 0);
+      for (size_t i = 0; i < h_labels.size(); ++i) {
+        cache.bits[i / kBits] |= static_cast<uint64_t>(h_labels[i] == 1.0f) << (i % kBits);
+      }
+    }
+    cache.n_labels = h_labels.size();
+    cache.initialized = true;
+  }
+  return cache.binary ? &cache.bits : nullptr;
 }
 
 /*
@@ -256,6 +281,7 @@ void LoadFeatureType(std::vector<std::string>const& type_names, std::vector<Feat
 }
 
 void MetaInfo::LoadBinary(dmlc::Stream *fi) {
+  label_bits_cache_ = LabelBitsCache{};
   auto version = Version::Load(fi);
   auto major = std::get<0>(version);
   // MetaInfo is saved in `SparsePageSource'.  So the version in MetaInfo represents the
@@ -359,6 +385,7 @@ MetaInfo MetaInfo::Slice(common::Span<int32_t const> ridxs) const {
   out.feature_types.Resize(this->feature_types.Size());
   out.feature_types.Copy(this->feature_types);
   out.feature_type_names = this->feature_type_names;
+  out.categories = this->categories;
 
   return out;
 }
@@ -502,6 +529,7 @@ void MetaInfo::SetInfoFromHost(StringView key, Json arr) {
   CopyTensorInfoImpl<1>(arr, &t);
   if (key == "label") {
     this->labels_ = std::move(*t.Data());
+    this->label_bits_cache_ = LabelBitsCache{};
     auto const& h_labels = labels_.ConstHostVector();
     auto valid = std::none_of(h_labels.cbegin(), h_labels.cend(), data::LabelsCheck{});
     CHECK(valid) << "Label contains NaN, infinity or a value too large.";
@@ -651,6 +679,7 @@ void MetaInfo::Extend(MetaInfo const& that, bool accumulate_rows, bool check_col
 
   this->labels_.SetDevice(that.labels_.DeviceIdx());
   this->labels_.Extend(that.labels_);
+  this->label_bits_cache_ = LabelBitsCache{};
 
   this->weights_.SetDevice(that.weights_.DeviceIdx());
   this->weights_.Extend(that.weights_);
@@ -850,12 +879,15 @@ DMatrix* DMatrix::Load(const std::string& uri,
   DMatrix* dmat {nullptr};
   try {
     if (cache_file.empty()) {
-      std::unique_ptr<dmlc::Parser<uint32_t>> parser(
-          dmlc::Parser<uint32_t>::Create(fname.c_str(), partid, npart,
-                                         file_format.c_str()));
+      std::unique_ptr<dmlc::Parser<uint32_t>> parser(data::TextParser::Create(
+          fname, partid, npart, file_format, omp_get_max_threads()));
+      if (!parser) {
+        parser.reset(dmlc::Parser<uint32_t>::Create(fname.c_str(), partid, npart,
+                                                    file_format.c_str()));
+      }
       data::FileAdapter adapter(parser.get());
       dmat = DMatrix::Create(&adapter, std::numeric_limits<float>::quiet_NaN(),
-                             1, cache_file);
+                             omp_get_max_threads(), cache_file);
     } else {
       data::FileIterator iter{fname, uint32_t(partid), uint32_t(npart),
                               file_format};
@@ -933,9 +965,23 @@ DMatrix *DMatrix::Create(DataIterHandle iter, DMatrixHandle proxy,
                          DataIterResetCallback *reset,
                          XGDMatrixCallbackNext *next, float missing,
                          int32_t n_threads,
-                         std::string cache) {
+                         std::string cache,
+                         std::string page_format,
+                         size_t prefetch_batches,
+                         size_t memory_budget,
+                         bool quantized_checkpoint) {
+  if (memory_budget != 0) {
+    auto *in_memory = data::SimpleDMatrix::FromIterator(
+        iter, proxy, reset, next, missing, n_threads, memory_budget, prefetch_batches);
+    if (in_memory) {
+      return in_memory;
+    }
+    LOG(INFO) << "Data exceeds the memory budget of " << memory_budget
+              << " bytes, spilling to external memory with cache prefix: " << cache;
+  }
   return new data::SparsePageDMatrix(iter, proxy, reset, next, missing, n_threads,
-                                     cache);
+                                     cache, page_format, prefetch_batches,
+                                     quantized_checkpoint);
 }
 
 template DMatrix *DMatrix::Create<DataIterHandle, DMatrixHandle,
@@ -947,7 +993,8 @@ template DMatrix *DMatrix::Create<DataIterHandle, DMatrixHandle,
 template DMatrix *DMatrix::Create<DataIterHandle, DMatrixHandle,
                                   DataIterResetCallback, XGDMatrixCallbackNext>(
     DataIterHandle iter, DMatrixHandle proxy, DataIterResetCallback *reset,
-    XGDMatrixCallbackNext *next, float missing, int32_t n_threads, std::string);
+    XGDMatrixCallbackNext *next, float missing, int32_t n_threads, std::string,
+    std::string, size_t, size_t, bool);
 
 template <typename AdapterT>
 DMatrix* DMatrix::Create(AdapterT* adapter, float missing, int nthread,
@@ -970,6 +1017,9 @@ template DMatrix* DMatrix::Create<data::CSCAdapter>(
 template DMatrix* DMatrix::Create<data::DataTableAdapter>(
     data::DataTableAdapter* adapter, float missing, int nthread,
     const std::string& cache_prefix);
+template DMatrix* DMatrix::Create<data::ArrowAdapter>(
+    data::ArrowAdapter* adapter, float missing, int nthread,
+    const std::string& cache_prefix);
 template DMatrix* DMatrix::Create<data::FileAdapter>(
     data::FileAdapter* adapter, float missing, int nthread,
     const std::string& cache_prefix);
@@ -981,38 +1031,100 @@ DMatrix::Create(data::IteratorAdapter<DataIterHandle, XGBCallbackDataIterNext,
                                       XGBoostBatchCSR> *adapter,
                 float missing, int nthread, const std::string &cache_prefix);
 
-SparsePage SparsePage::GetTranspose(int num_columns) const {
+SparsePage SparsePage::GetTranspose(int num_columns, bool sort_by_value) const {
   SparsePage transpose;
-  common::ParallelGroupBuilder<Entry, bst_row_t> builder(&transpose.offset.HostVector(),
-                                                         &transpose.data.HostVector());
-  const int nthread = omp_get_max_threads();
-  builder.InitBudget(num_columns, nthread);
-  long batch_size = static_cast<long>(this->Size());  // NOLINT(*)
+  auto& out_offset = transpose.offset.HostVector();
+  auto& out_data = transpose.data.HostVector();
+  auto n_columns = static_cast<size_t>(std::max(num_columns, 0));
+  out_offset.clear();
+  out_offset.resize(n_columns + 1, 0);
+  if (this->data.Empty() || n_columns == 0) {
+    CHECK_EQ(transpose.offset.Size(), n_columns + 1);
+    return transpose;
+  }
+
   auto page = this->GetView();
-  common::ParallelFor(batch_size, [&](long i) {  // NOLINT(*)
-    int tid = omp_get_thread_num();
-    auto inst = page[i];
-    for (const auto& entry : inst) {
-      builder.AddBudget(entry.index, tid);
+  size_t n_rows = this->Size();
+  size_t nnz = this->data.Size();
+  int32_t n_threads = omp_get_max_threads();
+  // Columns are partitioned into contiguous buckets, so that per-thread counters and
+  // scatter destinations of the first pass stay in cache regardless of the number of
+  // columns.
+  size_t constexpr kMaxBuckets = 1024;
+  size_t width = common::DivRoundUp(n_columns, std::min(n_columns, kMaxBuckets));
+  size_t n_buckets = common::DivRoundUp(n_columns, width);
+  size_t n_blocks = std::min(static_cast<size_t>(std::max(n_threads, 1)), n_rows);
+  size_t block_size = common::DivRoundUp(n_rows, n_blocks);
+  auto for_each_entry = [&](size_t block, auto&& fn) {
+    auto rbeg = std::min(block * block_size, n_rows);
+    auto rend = std::min(rbeg + block_size, n_rows);
+    for (size_t r = rbeg; r < rend; ++r) {
+      for (auto const& entry : page[r]) {
+        fn(r, entry);
+      }
     }
+  };
+
+  // First pass, stable partition of entries into column buckets.
+  std::vector<size_t> pos(n_blocks * n_buckets, 0);
+  common::ParallelFor(n_blocks, n_threads, [&](size_t block) {
+    auto* p_pos = pos.data() + block * n_buckets;
+    for_each_entry(block, [&](size_t, Entry const& e) { ++p_pos[e.index / width]; });
   });
-  builder.InitStorage();
-  common::ParallelFor(batch_size, [&](long i) {  // NOLINT(*)
-    int tid = omp_get_thread_num();
-    auto inst = page[i];
-    for (const auto& entry : inst) {
-      builder.Push(
-          entry.index,
-          Entry(static_cast<bst_uint>(this->base_rowid + i), entry.fvalue),
-          tid);
+  std::vector<size_t> bucket_ptr(n_buckets + 1, 0);
+  size_t total = 0;
+  for (size_t b = 0; b < n_buckets; ++b) {
+    bucket_ptr[b] = total;
+    for (size_t block = 0; block < n_blocks; ++block) {
+      auto n = pos[block * n_buckets + b];
+      pos[block * n_buckets + b] = total;
+      total += n;
+    }
+  }
+  bucket_ptr[n_buckets] = total;
+  CHECK_EQ(total, nnz);
+  std::vector<Entry> partitioned(nnz);
+  std::vector<bst_feature_t> columns(nnz);
+  common::ParallelFor(n_blocks, n_threads, [&](size_t block) {
+    auto* p_pos = pos.data() + block * n_buckets;
+    for_each_entry(block, [&](size_t r, Entry const& e) {
+      auto i = p_pos[e.index / width]++;
+      partitioned[i] = Entry(static_cast<bst_uint>(this->base_rowid + r), e.fvalue);
+      columns[i] = e.index;
+    });
+  });
+  pos.clear();
+  pos.shrink_to_fit();
+
+  // Second pass, each bucket is counted and scattered into its own columns.
+  out_data.resize(nnz);
+  common::ParallelFor(n_buckets, n_threads, common::Sched::Dyn(), [&](size_t b) {
+    auto cbeg = b * width;
+    auto cend = std::min(cbeg + width, n_columns);
+    std::vector<size_t> cursor(cend - cbeg);
+    // Counts are accumulated into offsets owned by this bucket.
+    for (size_t i = bucket_ptr[b]; i < bucket_ptr[b + 1]; ++i) {
+      ++out_offset[columns[i] + 1];
+    }
+    size_t running = bucket_ptr[b];
+    for (size_t c = cbeg; c < cend; ++c) {
+      cursor[c - cbeg] = running;
+      running += out_offset[c + 1];
+      out_offset[c + 1] = running;
+    }
+    for (size_t i = bucket_ptr[b]; i < bucket_ptr[b + 1]; ++i) {
+      out_data[cursor[columns[i] - cbeg]++] = partitioned[i];
+    }
+    if (sort_by_value) {
+      for (size_t c = cbeg; c < cend; ++c) {
+        auto beg = c == cbeg ? bucket_ptr[b] : out_offset[c];
+        std::sort(out_data.begin() + beg, out_data.begin() + out_offset[c + 1],
+                  Entry::CmpValue);
+      }
     }
   });
 
-  if (this->data.Empty()) {
-    transpose.offset.Resize(num_columns + 1);
-    transpose.offset.Fill(0);
-  }
-  CHECK_EQ(transpose.offset.Size(), num_columns + 1);
+  CHECK_EQ(transpose.offset.Size(), n_columns + 1);
   return transpose;
 }
 
@@ -1034,15 +1146,169 @@ void SparsePage::Push(const SparsePage &batch) {
   }
 }
 
+namespace {
+/**
+ * \brief Number of threads used for pushing a column-major batch.
+ *
+ *   Each thread of the group builder holds a row counter for every row in the batch, so
+ *   the number of threads is bounded by the number of stored elements per row.  This
+ *   keeps the thread local memory below the size of the input.
+ */
+template <typename AdapterBatchT>
+int32_t ColumnMajorPushThreads(AdapterBatchT const& batch, size_t n_rows, int32_t n_threads) {
+  if (n_rows == 0) {
+    return 1;
+  }
+  size_t n_elements = 0;
+  for (size_t i = 0; i < batch.Size(); ++i) {
+    n_elements += batch.GetLine(i).Size();
+  }
+  auto bound = std::max(n_elements / n_rows, static_cast<size_t>(1));
+  return static_cast<int32_t>(std::min(static_cast<size_t>(n_threads), bound));
+}
+
+/**
+ * \brief Push a column-major batch whose row indices are sorted within each column.
+ *
+ *   Rows are split into tiles owned by threads, so both passes write only to rows of
+ *   their own tile and no thread local counters are needed.  Inside a tile, columns are
+ *   walked in blocks of rows with a cursor for each column, keeping the scatter
+ *   destination of a block in cache.  Entries of each row come out ordered by column.
+ *
+ * \return Whether the batch was pushed, false if some column is not sorted.
+ */
+template <typename AdapterBatchT>
+bool PushSortedColumns(AdapterBatchT const& batch, float missing, int32_t n_threads,
+                       SparsePage* page, uint64_t* p_max_columns) {
+  size_t n_columns = batch.Size();
+  if (n_columns == 0) {
+    return false;
+  }
+  size_t base_rowid = page->base_rowid;
+  size_t row_begin = page->Size();
+  auto is_valid = data::IsValidFunctor{missing};
+  auto key = [&](auto const& line, size_t j) { return line.GetElement(j).row_idx - base_rowid; };
+
+  // Check the input, one past the largest row of valid elements is kept for each column.
+  std::vector<size_t> column_rows(n_columns, 0);
+  std::atomic<bool> sorted{true}, valid{true};
+  size_t nnz = 0;
+  for (size_t c = 0; c < n_columns; ++c) {
+    nnz += batch.GetLine(c).Size();
+  }
+  common::ParallelFor(n_columns, n_threads, common::Sched::Guided(), [&](size_t c) {
+    auto line = batch.GetLine(c);
+    size_t prev = 0;
+    for (size_t j = 0; j < line.Size(); ++j) {
+      auto const& e = line.GetElement(j);
+      if (!std::isinf(missing) && std::isinf(e.value)) {
+        valid = false;
+      }
+      auto k = e.row_idx - base_rowid;
+      CHECK_GE(k, row_begin);
+      if (k < prev) {
+        sorted = false;
+        return;
+      }
+      prev = k;
+      if (is_valid(e)) {
+        column_rows[c] = k + 1;
+      }
+    }
+  });
+  CHECK(valid) << "Input data contains `inf` or `nan`";
+  if (!sorted) {
+    return false;
+  }
+  for (size_t c = 0; c < n_columns; ++c) {
+    if (batch.GetLine(c).Size() != 0) {
+      *p_max_columns = c + 1;
+    }
+  }
+  auto row_end = std::max(*std::max_element(column_rows.cbegin(), column_rows.cend()),
+                          row_begin);
+  size_t n_rows = row_end - row_begin;
+  auto& offset_vec = page->offset.HostVector();
+  auto& data_vec = page->data.HostVector();
+  if (offset_vec.empty()) {
+    offset_vec.emplace_back(0);
+  }
+  if (n_rows == 0) {
+    return true;
+  }
+
+  // Enough tiles for balancing, each tile searches the start of every column once.
+  size_t n_tiles = std::min(n_rows, static_cast<size_t>(std::max(n_threads, 1)) * 4);
+  size_t tile_rows = common::DivRoundUp(n_rows, n_tiles);
+  // Blocks cover about kBlockEntries output entries, and no more blocks than entries are
+  // walked so that the per-column cursor updates are amortized.
+  size_t constexpr kBlockEntries = 1 << 15;
+  double row_nnz = std::max(static_cast<double>(nnz) / n_rows, 1.0);
+  auto block_rows = std::max(static_cast<size_t>(
+                                 std::max(kBlockEntries, n_columns) / row_nnz), size_t{1});
+  auto for_each_block = [&](size_t tile, auto&& fn) {
+    auto rbeg = row_begin + std::min(tile * tile_rows, n_rows);
+    auto rend = row_begin + std::min((tile + 1) * tile_rows, n_rows);
+    std::vector<size_t> cursor(n_columns);
+    for (size_t c = 0; c < n_columns; ++c) {
+      auto line = batch.GetLine(c);
+      size_t lo = 0, hi = line.Size();
+      while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        if (key(line, mid) < rbeg) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      cursor[c] = lo;
+    }
+    for (size_t bbeg = rbeg; bbeg < rend; bbeg += block_rows) {
+      auto bend = std::min(bbeg + block_rows, rend);
+      for (size_t c = 0; c < n_columns; ++c) {
+        auto line = batch.GetLine(c);
+        auto j = cursor[c];
+        for (; j < line.Size() && key(line, j) < bend; ++j) {
+          auto const& e = line.GetElement(j);
+          if (is_valid(e)) {
+            fn(key(line, j), c, e.value);
+          }
+        }
+        cursor[c] = j;
+      }
+    }
+  };
+
+  auto out_begin = offset_vec.size() - 1;
+  CHECK_EQ(out_begin, row_begin);
+  offset_vec.resize(row_end + 1, 0);
+  common::ParallelFor(n_tiles, n_threads, common::Sched::Dyn(), [&](size_t tile) {
+    for_each_block(tile, [&](size_t r, size_t, float) { ++offset_vec[r + 1]; });
+  });
+  std::partial_sum(offset_vec.begin() + row_begin, offset_vec.end(),
+                   offset_vec.begin() + row_begin);
+  data_vec.resize(offset_vec.back());
+  std::vector<size_t> fill(offset_vec.cbegin() + row_begin, offset_vec.cend() - 1);
+  common::ParallelFor(n_tiles, n_threads, common::Sched::Dyn(), [&](size_t tile) {
+    for_each_block(tile, [&](size_t r, size_t c, float v) {
+      data_vec[fill[r - row_begin]++] = Entry(static_cast<bst_feature_t>(c), v);
+    });
+  });
+  return true;
+}
+}  // anonymous namespace
+
 template <typename AdapterBatchT>
 uint64_t SparsePage::Push(const AdapterBatchT& batch, float missing, int nthread) {
   constexpr bool kIsRowMajor = AdapterBatchT::kIsRowMajor;
-  // Allow threading only for row-major case as column-major requires O(nthread*batch_size) memory
-  nthread = kIsRowMajor ? nthread : 1;
   // Set number of threads but keep old value so we can reset it after
   int nthread_original = common::OmpSetNumThreadsWithoutHT(&nthread);
   if (!kIsRowMajor) {
-    CHECK_EQ(nthread, 1);
+    uint64_t max_columns = 0;
+    if (PushSortedColumns(batch, missing, nthread, this, &max_columns)) {
+      omp_set_num_threads(nthread_original);
+      return max_columns;
+    }
   }
   auto& offset_vec = offset.HostVector();
   auto& data_vec = data.HostVector();
@@ -1068,6 +1334,9 @@ uint64_t SparsePage::Push(const AdapterBatchT& batch, float missing, int nthread
     omp_set_num_threads(nthread_original);
     return max_columns;
   }
+  if (!kIsRowMajor) {
+    nthread = ColumnMajorPushThreads(batch, expected_rows, nthread);
+  }
   const size_t thread_size = batch_size / nthread;
 
   builder.InitBudget(expected_rows, nthread);
@@ -1078,7 +1347,7 @@ uint64_t SparsePage::Push(const AdapterBatchT& batch, float missing, int nthread
 #pragma omp parallel num_threads(nthread)
   {
     exec.Run([&]() {
-      int tid = omp_get_thread_num();
+      int tid = common::ThreadIdx();
       size_t begin = tid*thread_size;
       size_t end = tid != (nthread-1) ? (tid+1)*thread_size : batch_size;
       uint64_t& max_columns_local = max_columns_vector[tid][0];
@@ -1118,7 +1387,7 @@ uint64_t SparsePage::Push(const AdapterBatchT& batch, float missing, int nthread
 #pragma omp parallel num_threads(nthread)
   {
     exec.Run([&]() {
-      int tid = omp_get_thread_num();
+      int tid = common::ThreadIdx();
       size_t begin = tid * thread_size;
       size_t end = tid != (nthread - 1) ? (tid + 1) * thread_size : batch_size;
       for (size_t i = begin; i < end; ++i) {
@@ -1212,6 +1481,8 @@ SparsePage::Push(const data::CSCAdapterBatch& batch, float missing, int nthread)
 template uint64_t
 SparsePage::Push(const data::DataTableAdapterBatch& batch, float missing, int nthread);
 template uint64_t
+SparsePage::Push(const data::ArrowAdapterBatch& batch, float missing, int nthread);
+template uint64_t
 SparsePage::Push(const data::FileAdapterBatch& batch, float missing, int nthread);
 
 namespace data {
@@ -1219,5 +1490,6 @@ namespace data {
 // List of files that will be force linked in static links.
 DMLC_REGISTRY_LINK_TAG(sparse_page_raw_format);
 DMLC_REGISTRY_LINK_TAG(gradient_index_format);
+DMLC_REGISTRY_LINK_TAG(sparse_page_compressed_format);
 }  // namespace data
 }  // namespace xgboost
@@ -137,6 +137,7 @@ void MetaInfo::SetInfoFromCUDA(StringView key, Json array) {
   CopyTensorInfoImpl(array, &t);
   if (key == "label") {
     this->labels_ = std::move(*t.Data());
+    this->label_bits_cache_ = LabelBitsCache{};
     auto ptr = labels_.ConstDevicePointer();
     auto valid = thrust::none_of(thrust::device, ptr, ptr + labels_.Size(), data::LabelsCheck{});
     CHECK(valid) << "Label contains NaN, infinity or a value too large.";
@@ -37,7 +37,8 @@ __global__ void CompressBinEllpackKernel(
     size_t base_row,                        // batch_row_begin
     size_t n_rows,
     size_t row_stride,
-    unsigned int null_gidx_value) {
+    unsigned int null_gidx_value,
+    bool is_dense) {
   size_t irow = threadIdx.x + blockIdx.x * blockDim.x;
   int ifeature = threadIdx.y + blockIdx.y * blockDim.y;
   if (irow >= n_rows || ifeature >= row_stride) {
@@ -68,8 +69,10 @@ __global__ void CompressBinEllpackKernel(
     if (bin >= ncuts) {
       bin = ncuts - 1;
     }
-    // Add the number of bins in previous features.
-    bin += cut_rows[feature];
+    // Add the number of bins in previous features, dense matrix stores the local bin.
+    if (!is_dense) {
+      bin += cut_rows[feature];
+    }
   }
   // Write to gidx buffer.
   wr.AtomicWriteSymbol(buffer, bin, (irow + base_row) * row_stride + ifeature);
@@ -164,6 +167,9 @@ struct WriteCompressedEllpackFunctor {
       } else {
         bin_idx = accessor.SearchBin<false>(e.value, e.column_idx);
       }
+      if (accessor.is_dense) {
+        bin_idx -= accessor.feature_segments[e.column_idx];
+      }
       writer.AtomicWriteSymbol(d_buffer, bin_idx, output_position);
     }
     return 0;
@@ -218,7 +224,7 @@ void CopyDataToEllpack(const AdapterBatchT &batch,
   using Tuple = thrust::tuple<size_t, size_t, size_t>;
 
   auto device_accessor = dst->GetDeviceAccessor(device_idx);
-  common::CompressedBufferWriter writer(device_accessor.NumSymbols());
+  common::CompressedBufferWriter writer(dst->NumSymbols());
   auto d_compressed_buffer = dst->gidx_buffer.DevicePointer();
 
   // We redirect the scan output into this functor to do the actual writing
@@ -246,9 +252,12 @@ void CopyDataToEllpack(const AdapterBatchT &batch,
 
 void WriteNullValues(EllpackPageImpl* dst, int device_idx,
                      common::Span<size_t> row_counts) {
-  // Write the null values
+  // Write the null values, there's no null symbol for dense matrix.
+  if (dst->is_dense) {
+    return;
+  }
   auto device_accessor = dst->GetDeviceAccessor(device_idx);
-  common::CompressedBufferWriter writer(device_accessor.NumSymbols());
+  common::CompressedBufferWriter writer(dst->NumSymbols());
   auto d_compressed_buffer = dst->gidx_buffer.DevicePointer();
   auto row_stride = dst->row_stride;
   dh::LaunchN(row_stride * dst->n_rows, [=] __device__(size_t idx) {
@@ -295,9 +304,9 @@ struct CopyPage {
   // The number of elements to skip.
   size_t offset;
 
-  CopyPage(EllpackPageImpl *dst, EllpackPageImpl const *src, size_t offset)
+  CopyPage(int device, EllpackPageImpl *dst, EllpackPageImpl const *src, size_t offset)
       : cbw{dst->NumSymbols()}, dst_data_d{dst->gidx_buffer.DevicePointer()},
-        src_iterator_d{src->gidx_buffer.DevicePointer(), src->NumSymbols()},
+        src_iterator_d{src->ConstGidxDevicePointer(device), src->NumSymbols()},
         offset(offset) {}
 
   __device__ void operator()(size_t element_id) {
@@ -319,12 +328,39 @@ size_t EllpackPageImpl::Copy(int device, EllpackPageImpl const *page,
     return this->n_rows * this->row_stride;
   }
   gidx_buffer.SetDevice(device);
-  page->gidx_buffer.SetDevice(device);
-  dh::LaunchN(num_elements, CopyPage(this, page, offset));
+  dh::LaunchN(num_elements, CopyPage(device, this, page, offset));
   monitor_.Stop("Copy");
   return num_elements;
 }
 
+// A functor that copies a range of rows from one EllpackPage into another.
+struct CopyRowsPage {
+  common::CompressedBufferWriter cbw;
+  common::CompressedByteT* dst_data_d;
+  common::CompressedIterator<uint32_t> src_iterator_d;
+  // The number of elements to skip in source.
+  size_t offset;
+
+  CopyRowsPage(int device, EllpackPageImpl *dst, EllpackPageImpl const *src, size_t offset)
+      : cbw{dst->NumSymbols()}, dst_data_d{dst->gidx_buffer.DevicePointer()},
+        src_iterator_d{src->ConstGidxDevicePointer(device), src->NumSymbols()},
+        offset(offset) {}
+
+  __device__ void operator()(size_t element_id) {
+    cbw.AtomicWriteSymbol(dst_data_d, src_iterator_d[element_id + offset], element_id);
+  }
+};
+
+void EllpackPageImpl::CopyRows(int device, EllpackPageImpl const *page, size_t row_begin) {
+  monitor_.Start("CopyRows");
+  CHECK_EQ(row_stride, page->row_stride);
+  CHECK_EQ(NumSymbols(), page->NumSymbols());
+  CHECK_LE(row_begin + n_rows, page->n_rows);
+  gidx_buffer.SetDevice(device);
+  dh::LaunchN(n_rows * row_stride, CopyRowsPage(device, this, page, row_begin * row_stride));
+  monitor_.Stop("CopyRows");
+}
+
 // A functor that compacts the rows from one EllpackPage into another.
 struct CompactPage {
   common::CompressedBufferWriter cbw;
@@ -345,11 +381,11 @@ struct CompactPage {
   size_t base_rowid;
   size_t row_stride;
 
-  CompactPage(EllpackPageImpl* dst, EllpackPageImpl const* src,
+  CompactPage(int device, EllpackPageImpl* dst, EllpackPageImpl const* src,
               common::Span<size_t> row_indexes)
       : cbw{dst->NumSymbols()},
         dst_data_d{dst->gidx_buffer.DevicePointer()},
-        src_iterator_d{src->gidx_buffer.DevicePointer(), src->NumSymbols()},
+        src_iterator_d{src->ConstGidxDevicePointer(device), src->NumSymbols()},
         row_indexes(row_indexes),
         base_rowid{src->base_rowid},
         row_stride{src->row_stride} {}
@@ -375,8 +411,7 @@ void EllpackPageImpl::Compact(int device, EllpackPageImpl const* page,
   CHECK_EQ(NumSymbols(), page->NumSymbols());
   CHECK_LE(page->base_rowid + page->n_rows, row_indexes.size());
   gidx_buffer.SetDevice(device);
-  page->gidx_buffer.SetDevice(device);
-  dh::LaunchN(page->n_rows, CompactPage(this, page, row_indexes));
+  dh::LaunchN(page->n_rows, CompactPage(device, this, page, row_indexes));
   monitor_.Stop("Compact");
 }
 
@@ -388,6 +423,8 @@ void EllpackPageImpl::InitCompressedData(int device) {
   size_t compressed_size_bytes =
     common::CompressedBufferWriter::CalculateBufferSize(row_stride * n_rows,
       num_symbols);
+  d_prefetched_.reset();
+  prefetched_device_ = -1;
   gidx_buffer.SetDevice(device);
   // Don't call fill unnecessarily
   if (gidx_buffer.Size() == 0) {
@@ -403,7 +440,7 @@ void EllpackPageImpl::CreateHistIndices(int device,
                                         const SparsePage& row_batch,
                                         common::Span<FeatureType const> feature_types) {
   if (row_batch.Size() == 0) return;
-  unsigned int null_gidx_value = NumSymbols() - 1;
+  unsigned int null_gidx_value = cuts_.TotalBins();
 
   const auto& offset_vec = row_batch.offset.ConstHostVector();
 
@@ -454,13 +491,25 @@ void EllpackPageImpl::CreateHistIndices(int device,
         entries_d.data().get(), device_accessor.gidx_fvalue_map.data(),
         device_accessor.feature_segments.data(), feature_types,
         batch_row_begin, batch_nrows, row_stride,
-        null_gidx_value);
+        null_gidx_value, is_dense);
   }
 }
 
 // Return the number of rows contained in this page.
 size_t EllpackPageImpl::Size() const { return n_rows; }
 
+size_t EllpackPageImpl::NumSymbols() const {
+  if (!is_dense) {
+    return cuts_.TotalBins() + 1;
+  }
+  auto const& ptrs = cuts_.Ptrs();
+  uint32_t max_bins = 1;
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    max_bins = std::max(max_bins, ptrs[i] - ptrs[i - 1]);
+  }
+  return max_bins;
+}
+
 // Return the memory cost for storing the compressed features.
 size_t EllpackPageImpl::MemCostBytes(size_t num_rows, size_t row_stride,
                                      const common::HistogramCuts& cuts) {
@@ -473,15 +522,109 @@ size_t EllpackPageImpl::MemCostBytes(size_t num_rows, size_t row_stride,
 
 EllpackDeviceAccessor EllpackPageImpl::GetDeviceAccessor(
     int device, common::Span<FeatureType const> feature_types) const {
-  gidx_buffer.SetDevice(device);
   return {device,
           cuts_,
           is_dense,
           row_stride,
           base_rowid,
           n_rows,
-          common::CompressedIterator<uint32_t>(gidx_buffer.ConstDevicePointer(),
+          common::CompressedIterator<uint32_t>(this->ConstGidxDevicePointer(device),
                                                NumSymbols()),
           feature_types};
 }
+
+namespace {
+// Stream and pinned staging buffer owned by each prefetch thread, reused across pages.
+class PrefetchResource {
+  cudaStream_t stream_{nullptr};
+  int device_{-1};
+  dh::PinnedMemory staging_;
+
+  void Release() {
+    if (stream_) {
+      // Might be called during program exit, errors are ignored.
+      cudaStreamDestroy(stream_);
+      stream_ = nullptr;
+    }
+  }
+
+ public:
+  cudaStream_t Stream(int device) {
+    if (device != device_) {
+      this->Release();
+      dh::safe_cuda(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+      device_ = device;
+    }
+    return stream_;
+  }
+  dh::PinnedMemory *Staging() { return &staging_; }
+
+  ~PrefetchResource() { this->Release(); }
+};
+
+common::CompressedByteT *AllocPrefetched(size_t n_bytes, bool use_pool, cudaStream_t stream) {
+  void *ptr{nullptr};
+#if CUDART_VERSION >= 11020
+  if (use_pool) {
+    dh::safe_cuda(cudaMallocAsync(&ptr, n_bytes, stream));
+    return static_cast<common::CompressedByteT *>(ptr);
+  }
+#endif  // CUDART_VERSION >= 11020
+  dh::safe_cuda(cudaMalloc(&ptr, n_bytes));
+  return static_cast<common::CompressedByteT *>(ptr);
+}
+
+void FreePrefetched(common::CompressedByteT *ptr, int device, bool use_pool) {
+  // Freed by whichever thread releases the page last, errors are ignored as the deleter
+  // might run during program exit.
+  int current = -1;
+  cudaGetDevice(&current);
+  cudaSetDevice(device);
+#if CUDART_VERSION >= 11020
+  if (use_pool) {
+    // Ordered after all kernels on the default stream that might still read the page.
+    cudaFreeAsync(ptr, nullptr);
+    cudaSetDevice(current);
+    return;
+  }
+#endif  // CUDART_VERSION >= 11020
+  cudaFree(ptr);
+  cudaSetDevice(current);
+}
+}  // anonymous namespace
+
+void EllpackPageImpl::PrefetchToDevice(int device) {
+  auto const &h_gidx = gidx_buffer.ConstHostVector();
+  if (h_gidx.empty()) {
+    return;
+  }
+  dh::safe_cuda(cudaSetDevice(device));
+  thread_local PrefetchResource resource;
+  auto stream = resource.Stream(device);
+  // Copy from pageable memory is staged by the driver and blocks, stage it ourselves so
+  // the DMA runs at full bandwidth.
+  auto staging = resource.Staging()->GetSpan<common::CompressedByteT>(h_gidx.size());
+  std::copy(h_gidx.cbegin(), h_gidx.cend(), staging.begin());
+
+  size_t n_bytes = h_gidx.size() * sizeof(common::CompressedByteT);
+  bool use_pool = dh::detail::DeviceMemoryPoolAvailable();
+  auto ptr = AllocPrefetched(n_bytes, use_pool, stream);
+  d_prefetched_.reset(ptr, [device, use_pool](common::CompressedByteT *ptr) {
+    FreePrefetched(ptr, device, use_pool);
+  });
+  prefetched_device_ = device;
+  dh::safe_cuda(
+      cudaMemcpyAsync(ptr, staging.data(), n_bytes, cudaMemcpyHostToDevice, stream));
+  // The staging buffer is reused by the next page, and the consumer reads the device copy
+  // on a different stream.
+  dh::safe_cuda(cudaStreamSynchronize(stream));
+}
+
+common::CompressedByteT const *EllpackPageImpl::ConstGidxDevicePointer(int device) const {
+  if (d_prefetched_ && prefetched_device_ == device) {
+    return d_prefetched_.get();
+  }
+  gidx_buffer.SetDevice(device);
+  return gidx_buffer.ConstDevicePointer();
+}
 }  // namespace xgboost
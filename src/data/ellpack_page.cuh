@@ -13,12 +13,15 @@
 #include "../common/categorical.h"
 #include <thrust/binary_search.h>
 
+#include <memory>
+
 namespace xgboost {
 /** \brief Struct for accessing and manipulating an ELLPACK matrix on the
  * device. Does not own underlying memory and may be trivially copied into
  * kernels.*/
 struct EllpackDeviceAccessor {
-  /*! \brief Whether or not if the matrix is dense. */
+  /*! \brief Whether or not if the matrix is dense.  Dense matrices store bin indices
+   *         relative to the first bin of each feature. */
   bool is_dense;
   /*! \brief Row length for ELLPACK, equal to number of features. */
   size_t row_stride;
@@ -58,7 +61,7 @@ struct EllpackDeviceAccessor {
     auto row_end = row_begin + row_stride;
     auto gidx = -1;
     if (is_dense) {
-      gidx = gidx_iter[row_begin + fidx];
+      gidx = gidx_iter[row_begin + fidx] + feature_segments[fidx];
     } else {
       gidx = common::BinarySearchBin(row_begin,
                                      row_end,
@@ -166,6 +169,14 @@ class EllpackPageImpl {
    */
   size_t Copy(int device, EllpackPageImpl const *page, size_t offset);
 
+  /*! \brief Copy a contiguous range of rows from the given ELLPACK page into this page.
+   *
+   * @param device The GPU device to use.
+   * @param page The ELLPACK page to copy from.
+   * @param row_begin The first row to copy, number of copied rows is the size of this page.
+   */
+  void CopyRows(int device, EllpackPageImpl const *page, size_t row_begin);
+
   /*! \brief Compact the given ELLPACK page into the current page.
    *
    * @param device The GPU device to use.
@@ -190,14 +201,32 @@ class EllpackPageImpl {
   static size_t MemCostBytes(size_t num_rows, size_t row_stride, const common::HistogramCuts&cuts) ;
 
 
-  /*! \brief Return the total number of symbols (total number of bins plus 1 for
-   * not found). */
-  size_t NumSymbols() const { return cuts_.TotalBins() + 1; }
+  /*!
+   * \brief Return the total number of symbols.
+   *
+   * Sparse matrices use the total number of bins plus 1 for not found.  Dense matrices
+   * store the bin index relative to its feature without the null symbol, so the symbol
+   * width is sized by the feature with the most bins instead.
+   */
+  size_t NumSymbols() const;
 
   EllpackDeviceAccessor
   GetDeviceAccessor(int device,
                     common::Span<FeatureType const> feature_types = {}) const;
 
+  /*!
+   * \brief Copy the compressed buffer to device on a non-blocking stream.
+   *
+   * Used by the prefetch threads of external memory, so the transfer of the next page
+   * overlaps with computation on the current page instead of being serialized on the
+   * default stream.  Returns after the transfer is finished.
+   *
+   * @param device The GPU device to use.
+   */
+  void PrefetchToDevice(int device);
+  /*! \brief Device pointer to the compressed buffer, prefers the prefetched copy. */
+  common::CompressedByteT const* ConstGidxDevicePointer(int device) const;
+
  private:
   /*!
    * \brief Compress a single page of CSR data into ELLPACK.
@@ -227,6 +256,9 @@ public:
  private:
   common::HistogramCuts cuts_;
   common::Monitor monitor_;
+  // Read only device copy of gidx_buffer created by PrefetchToDevice.
+  std::shared_ptr<common::CompressedByteT> d_prefetched_;
+  int prefetched_device_{-1};
 };
 
 inline size_t GetRowStride(DMatrix* dmat) {
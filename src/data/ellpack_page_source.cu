@@ -21,5 +21,10 @@ void EllpackPageSource::Fetch() {
     this->WriteCache();
   }
 }
+
+void EllpackPageSource::PostRead(EllpackPage* page) const {
+  // Transfer the page while the training thread works on the previous one.
+  page->Impl()->PrefetchToDevice(param_.gpu_id);
+}
 }  // namespace data
 }  // namespace xgboost
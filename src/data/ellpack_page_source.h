@@ -38,13 +38,19 @@ class EllpackPageSource : public PageSourceIncMixIn<EllpackPage> {
     this->Fetch();
   }
 
+  ~EllpackPageSource() override { this->WaitPrefetch(); }
+
   void Fetch() final;
+  void PostRead(EllpackPage* page) const final;
 };
 
 #if !defined(XGBOOST_USE_CUDA)
 inline void EllpackPageSource::Fetch() {
   common::AssertGPUSupport();
 }
+inline void EllpackPageSource::PostRead(EllpackPage*) const {
+  common::AssertGPUSupport();
+}
 #endif  // !defined(XGBOOST_USE_CUDA)
 }  // namespace data
 }  // namespace xgboost
@@ -10,10 +10,12 @@
 #include <utility>
 
 #include "dmlc/data.h"
+#include "dmlc/omp.h"
 #include "xgboost/c_api.h"
 #include "xgboost/json.h"
 #include "xgboost/linalg.h"
 #include "array_interface.h"
+#include "text_parser.h"
 
 namespace xgboost {
 namespace data {
@@ -95,8 +97,11 @@ class FileIterator {
 
   void Reset() {
     CHECK(!type_.empty());
-    parser_.reset(dmlc::Parser<uint32_t>::Create(uri_.c_str(), part_idx_,
-                                                 n_parts_, type_.c_str()));
+    parser_.reset(TextParser::Create(uri_, part_idx_, n_parts_, type_, omp_get_max_threads()));
+    if (!parser_) {
+      parser_.reset(dmlc::Parser<uint32_t>::Create(uri_.c_str(), part_idx_,
+                                                   n_parts_, type_.c_str()));
+    }
   }
 };
 
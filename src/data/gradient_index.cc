@@ -4,7 +4,14 @@
  */
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <utility>
+#include "xgboost/generic_parameters.h"
 #include "gradient_index.h"
+#include "../common/annotation.h"
+#include "../common/column_matrix.h"
+#include "../common/feature_bundle.h"
+#include "../common/missing_bin.h"
 #include "../common/hist_util.h"
 
 namespace xgboost {
@@ -13,6 +20,7 @@ void GHistIndexMatrix::PushBatch(SparsePage const &batch,
                                  common::Span<FeatureType const> ft,
                                  size_t rbegin, size_t prev_sum, uint32_t nbins,
                                  int32_t n_threads) {
+  XGBOOST_ANNOTATE_SCOPE("xgboost::GHistIndexMatrix::PushBatch");
   // The number of threads is pegged to the batch size. If the OMP
   // block is parallelized on anything other than the batch/block size,
   // it should be reassigned
@@ -70,12 +78,23 @@ void GHistIndexMatrix::PushBatch(SparsePage const &batch,
 
   const size_t n_offsets = cut.Ptrs().size() - 1;
   const size_t n_index = row_ptr[rbegin + batch.Size()];
-  ResizeIndex(n_index, isDense_);
+  if (!mixed_bins_) {
+    ResizeIndex(n_index, isDense_);
+  } else if (!index.IsMixed()) {
+    CHECK(isDense_);
+    index.ResizeMixed(this->Size(), cut.Ptrs(), pack_bins_);
+    // Packed bins are set by masking bytes shared with other features.
+    for (auto const &seg : index.Segments()) {
+      if (seg.IsPacked()) {
+        std::fill_n(index.begin() + seg.begin, this->Size() * seg.row_bytes, 0);
+      }
+    }
+  }
 
   CHECK_GT(cut.Values().size(), 0U);
 
   uint32_t *offsets = nullptr;
-  if (isDense_) {
+  if (isDense_ && !index.IsMixed()) {
     index.ResizeOffset(n_offsets);
     offsets = index.Offset();
     for (size_t i = 0; i < n_offsets; ++i) {
@@ -83,39 +102,38 @@ void GHistIndexMatrix::PushBatch(SparsePage const &batch,
     }
   }
 
-  if (isDense_) {
+  if (index.IsMixed()) {
+    SetIndexData(ft, batch_threads, batch, rbegin, nbins,
+                 [this](size_t i, size_t, uint32_t idx) { index.SetMixed(i, idx); });
+  } else if (isDense_) {
     common::BinTypeSize curent_bin_size = index.GetBinTypeSize();
     if (curent_bin_size == common::kUint8BinsTypeSize) {
-      common::Span<uint8_t> index_data_span = {index.data<uint8_t>(), n_index};
-      SetIndexData(index_data_span, ft, batch_threads, batch, rbegin, nbins,
-                   [offsets](auto idx, auto j) {
-                     return static_cast<uint8_t>(idx - offsets[j]);
+      auto *index_data = index.data<uint8_t>();
+      SetIndexData(ft, batch_threads, batch, rbegin, nbins,
+                   [=](size_t i, size_t j, uint32_t idx) {
+                     index_data[i] = static_cast<uint8_t>(idx - offsets[j]);
                    });
 
     } else if (curent_bin_size == common::kUint16BinsTypeSize) {
-      common::Span<uint16_t> index_data_span = {index.data<uint16_t>(),
-                                                n_index};
-      SetIndexData(index_data_span, ft, batch_threads, batch, rbegin, nbins,
-                   [offsets](auto idx, auto j) {
-                     return static_cast<uint16_t>(idx - offsets[j]);
+      auto *index_data = index.data<uint16_t>();
+      SetIndexData(ft, batch_threads, batch, rbegin, nbins,
+                   [=](size_t i, size_t j, uint32_t idx) {
+                     index_data[i] = static_cast<uint16_t>(idx - offsets[j]);
                    });
     } else {
       CHECK_EQ(curent_bin_size, common::kUint32BinsTypeSize);
-      common::Span<uint32_t> index_data_span = {index.data<uint32_t>(),
-                                                n_index};
-      SetIndexData(index_data_span, ft, batch_threads, batch, rbegin, nbins,
-                   [offsets](auto idx, auto j) {
-                     return static_cast<uint32_t>(idx - offsets[j]);
-                   });
+      auto *index_data = index.data<uint32_t>();
+      SetIndexData(ft, batch_threads, batch, rbegin, nbins,
+                   [=](size_t i, size_t j, uint32_t idx) { index_data[i] = idx - offsets[j]; });
     }
 
     /* For sparse DMatrix we have to store index of feature for each bin
        in index field to chose right offset. So offset is nullptr and index is
        not reduced */
   } else {
-    common::Span<uint32_t> index_data_span = {index.data<uint32_t>(), n_index};
-    SetIndexData(index_data_span, ft, batch_threads, batch, rbegin, nbins,
-                 [](auto idx, auto) { return idx; });
+    auto *index_data = index.data<uint32_t>();
+    SetIndexData(ft, batch_threads, batch, rbegin, nbins,
+                 [=](size_t i, size_t, uint32_t idx) { index_data[i] = idx; });
   }
 
   common::ParallelFor(bst_omp_uint(nbins), n_threads, [&](bst_omp_uint idx) {
@@ -124,30 +142,40 @@ void GHistIndexMatrix::PushBatch(SparsePage const &batch,
       hit_count_tloc_[tid * nbins + idx] = 0;  // reset for next batch
     }
   });
+  this->Track();
 }
 
-void GHistIndexMatrix::Init(DMatrix* p_fmat, int max_bins, common::Span<float> hess) {
-  cut = common::SketchOnDMatrix(p_fmat, max_bins, hess);
+void GHistIndexMatrix::Init(DMatrix* p_fmat, int max_bins, common::Span<float> hess,
+                            bst_row_t sketch_sample_rows) {
+  BatchParam param{GenericParameter::kCpuId, max_bins, hess};
+  param.sketch_sample_rows = sketch_sample_rows;
+  this->Init(p_fmat, param);
+}
 
-  max_num_bins = max_bins;
+void GHistIndexMatrix::Init(DMatrix* p_fmat, BatchParam const& param) {
+  cut = common::SketchOnDMatrix(p_fmat, param.max_bin, param.hess, param.sketch_sample_rows,
+                                param.feature_max_bin, param.max_total_bins);
+
+  max_num_bins = MaxNumBins(param, cut);
   const int32_t nthread = omp_get_max_threads();
   const uint32_t nbins = cut.Ptrs().back();
   hit_count.resize(nbins, 0);
   hit_count_tloc_.resize(nthread * nbins, 0);
 
   this->p_fmat = p_fmat;
-  size_t new_size = 1;
-  for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
-    new_size += batch.Size();
-  }
-
-  row_ptr.resize(new_size);
+  // Use the meta info instead of iterating through pages, which reads the whole cache for
+  // external memory.
+  row_ptr.resize(p_fmat->Info().num_row_ + 1);
   row_ptr[0] = 0;
 
   size_t rbegin = 0;
   size_t prev_sum = 0;
   const bool isDense = p_fmat->IsDense();
   this->isDense_ = isDense;
+  this->pack_bins_ = isDense && param.pack_bins && common::Index::HasPackableBins(cut.Ptrs());
+  this->mixed_bins_ =
+      this->pack_bins_ ||
+      (isDense && param.HasBinBudget() && common::Index::HasMixedBinTypes(cut.Ptrs()));
   auto ft = p_fmat->Info().feature_types.ConstHostSpan();
 
   for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
@@ -155,6 +183,7 @@ void GHistIndexMatrix::Init(DMatrix* p_fmat, int max_bins, common::Span<float> h
     prev_sum = row_ptr[rbegin + batch.Size()];
     rbegin += batch.Size();
   }
+  CHECK_EQ(rbegin, p_fmat->Info().num_row_);
 }
 
 void GHistIndexMatrix::Init(SparsePage const &batch,
@@ -182,6 +211,122 @@ void GHistIndexMatrix::Init(SparsePage const &batch,
   this->PushBatch(batch, ft, rbegin, prev_sum, nbins, n_threads);
 }
 
+void GHistIndexMatrix::Init(common::HistogramCuts cuts, int32_t max_bins_per_feat,
+                            bool is_dense, size_t n_samples, int32_t n_threads) {
+  CHECK_GE(n_threads, 1);
+  base_rowid = 0;
+  isDense_ = is_dense;
+  mixed_bins_ = false;
+  pack_bins_ = false;
+  cut = std::move(cuts);
+  max_num_bins = max_bins_per_feat;
+  row_ptr.clear();
+  row_ptr.resize(n_samples + 1, 0);
+  const uint32_t nbins = cut.Ptrs().back();
+  hit_count.clear();
+  hit_count.resize(nbins, 0);
+  hit_count_tloc_.clear();
+  hit_count_tloc_.resize(n_threads * nbins, 0);
+  this->Track();
+}
+
+void GHistIndexMatrix::Push(SparsePage const &batch, common::Span<FeatureType const> ft,
+                            int32_t n_threads) {
+  CHECK_GE(n_threads, 1);
+  CHECK_LE(batch.base_rowid + batch.Size() + 1, row_ptr.size());
+  const uint32_t nbins = cut.Ptrs().back();
+  CHECK_GE(hit_count_tloc_.size(), n_threads * nbins);
+  size_t rbegin = batch.base_rowid;
+  size_t prev_sum = row_ptr[rbegin];
+  this->PushBatch(batch, ft, rbegin, prev_sum, nbins, n_threads);
+}
+
+void GHistIndexMatrix::GatherRows(GHistIndexMatrix const &that,
+                                  common::Span<int32_t const> ridxs, int32_t n_threads) {
+  CHECK_GE(n_threads, 1);
+  CHECK_EQ(that.base_rowid, 0) << "Gathering rows from paged gradient index is not supported.";
+  base_rowid = 0;
+  isDense_ = that.isDense_;
+  cut = that.cut;
+  max_num_bins = that.max_num_bins;
+
+  row_ptr.clear();
+  row_ptr.resize(ridxs.size() + 1, 0);
+  for (size_t i = 0; i < ridxs.size(); ++i) {
+    auto ridx = ridxs[i];
+    CHECK_GE(ridx, 0);
+    CHECK_LT(static_cast<size_t>(ridx), that.Size()) << "Row index out of bound.";
+    row_ptr[i + 1] = row_ptr[i] + (that.row_ptr[ridx + 1] - that.row_ptr[ridx]);
+  }
+
+  // Rows are copied segment by segment, an index without mixed bin types is a single
+  // segment with variable row size.  Rows of a mixed segment are copied as bytes.
+  struct CopySegment {
+    size_t src_begin, dst_begin, row_size, bin_size;
+  };
+  std::vector<CopySegment> segments;
+  if (that.index.IsMixed()) {
+    mixed_bins_ = true;
+    pack_bins_ = that.index.IsPacked();
+    index.ResizeMixed(ridxs.size(), cut.Ptrs(), pack_bins_);
+    auto const &src_segments = that.index.Segments();
+    auto const &dst_segments = index.Segments();
+    CHECK_EQ(src_segments.size(), dst_segments.size());
+    for (size_t s = 0; s < src_segments.size(); ++s) {
+      segments.push_back(
+          {src_segments[s].begin, dst_segments[s].begin, src_segments[s].row_bytes, 1});
+    }
+  } else {
+    mixed_bins_ = false;
+    pack_bins_ = false;
+    auto bin_size = static_cast<size_t>(that.index.GetBinTypeSize());
+    index.SetBinTypeSize(that.index.GetBinTypeSize());
+    index.Resize(row_ptr.back() * bin_size);
+    if (that.index.Offset()) {
+      index.ResizeOffset(that.index.OffsetSize());
+      std::copy_n(that.index.Offset(), that.index.OffsetSize(), index.Offset());
+    }
+    segments.push_back({0, 0, 0, bin_size});
+  }
+
+  const uint32_t nbins = cut.Ptrs().back();
+  hit_count.clear();
+  hit_count.resize(nbins, 0);
+  hit_count_tloc_.clear();
+  hit_count_tloc_.resize(n_threads * nbins, 0);
+
+  auto src = that.index.data<uint8_t>();
+  auto dst = index.data<uint8_t>();
+  common::ParallelFor(ridxs.size(), n_threads, [&](size_t i) {
+    auto tid = common::ThreadIdx();
+    for (auto const &seg : segments) {
+      auto n = seg.row_size ? seg.row_size : row_ptr[i + 1] - row_ptr[i];
+      auto ibegin = seg.row_size ? ridxs[i] * seg.row_size : that.row_ptr[ridxs[i]];
+      auto obegin = seg.row_size ? i * seg.row_size : row_ptr[i];
+      std::copy_n(src + seg.src_begin + ibegin * seg.bin_size, n * seg.bin_size,
+                  dst + seg.dst_begin + obegin * seg.bin_size);
+    }
+    for (size_t j = row_ptr[i]; j < row_ptr[i + 1]; ++j) {
+      ++hit_count_tloc_[tid * nbins + index[j]];
+    }
+  });
+  common::ParallelFor(nbins, n_threads, [&](size_t idx) {
+    for (int32_t tid = 0; tid < n_threads; ++tid) {
+      hit_count[idx] += hit_count_tloc_[tid * nbins + idx];
+      hit_count_tloc_[tid * nbins + idx] = 0;
+    }
+  });
+  this->Track();
+}
+
+void GHistIndexMatrix::Track() {
+  auto bytes = row_ptr.capacity() * sizeof(size_t) +
+               index.NumBytes() +
+               index.OffsetSize() * sizeof(uint32_t) +
+               (hit_count.capacity() + hit_count_tloc_.capacity()) * sizeof(size_t);
+  tracked_.Update(bytes);
+}
+
 void GHistIndexMatrix::ResizeIndex(const size_t n_index,
                                    const bool isDense) {
   if ((max_num_bins - 1 <= static_cast<int>(std::numeric_limits<uint8_t>::max())) && isDense) {
@@ -196,4 +341,34 @@ void GHistIndexMatrix::ResizeIndex(const size_t n_index,
     index.Resize((sizeof(uint32_t)) * n_index);
   }
 }
+
+std::shared_ptr<common::ColumnMatrix const> GHistIndexMatrix::Columns(
+    double sparse_threshold) const {
+  std::lock_guard<std::mutex> guard{columns_lock_};
+  if (!columns_ || columns_sparse_threshold_ != sparse_threshold) {
+    auto columns = std::make_shared<common::ColumnMatrix>();
+    columns->Init(*this, sparse_threshold);
+    columns_ = std::move(columns);
+    columns_sparse_threshold_ = sparse_threshold;
+  }
+  return columns_;
+}
+
+std::shared_ptr<common::FeatureBundles const> GHistIndexMatrix::Bundles(
+    common::Span<FeatureType const> ft, int32_t n_threads) const {
+  std::lock_guard<std::mutex> guard{columns_lock_};
+  if (!bundles_) {
+    bundles_ = std::make_shared<common::FeatureBundles>(*this, ft, n_threads);
+  }
+  return bundles_;
+}
+
+std::shared_ptr<common::MissingBins const> GHistIndexMatrix::MissingBins(
+    int32_t n_threads) const {
+  std::lock_guard<std::mutex> guard{columns_lock_};
+  if (!missing_bins_) {
+    missing_bins_ = std::make_shared<common::MissingBins>(*this, n_threads);
+  }
+  return missing_bins_;
+}
 }  // namespace xgboost
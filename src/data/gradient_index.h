@@ -4,11 +4,15 @@
  */
 #ifndef XGBOOST_DATA_GRADIENT_INDEX_H_
 #define XGBOOST_DATA_GRADIENT_INDEX_H_
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include "xgboost/base.h"
 #include "xgboost/data.h"
 #include "../common/categorical.h"
 #include "../common/hist_util.h"
+#include "../common/memory_tracker.h"
 #include "../common/threading_utils.h"
 
 namespace xgboost {
@@ -37,28 +41,65 @@ class GHistIndexMatrix {
   size_t base_rowid{0};
 
   GHistIndexMatrix() = default;
-  GHistIndexMatrix(DMatrix* x, int32_t max_bin, common::Span<float> hess = {}) {
-    this->Init(x, max_bin, hess);
+  GHistIndexMatrix(DMatrix* x, int32_t max_bin, common::Span<float> hess = {},
+                   bst_row_t sketch_sample_rows = 0) {
+    this->Init(x, max_bin, hess, sketch_sample_rows);
   }
+  GHistIndexMatrix(DMatrix* x, BatchParam const& param) { this->Init(x, param); }
   // Create a global histogram matrix, given cut
-  void Init(DMatrix* p_fmat, int max_num_bins, common::Span<float> hess);
+  void Init(DMatrix* p_fmat, int max_num_bins, common::Span<float> hess,
+            bst_row_t sketch_sample_rows = 0);
+  /**
+   * \brief Create a global histogram matrix with cuts built according to the batch
+   *        parameter.  With per-feature bin budgets, `max_num_bins` is the largest number
+   *        of bins of a feature, so the bin type is chosen by the budgets actually used.
+   *        Dense data is then stored with the narrowest bin type of each feature, see
+   *        `common::Index::ResizeMixed`, which also packs bins of features with few bins
+   *        when `BatchParam::pack_bins` is set.
+   */
+  void Init(DMatrix* p_fmat, BatchParam const& param);
+  /*! \brief `max_num_bins` of an index built with the parameter and cuts. */
+  static int32_t MaxNumBins(BatchParam const& param, common::HistogramCuts const& cuts) {
+    if (!param.HasBinBudget()) {
+      return param.max_bin;
+    }
+    return std::max(static_cast<int32_t>(cuts.MaxFeatureBins()), 1);
+  }
   void Init(SparsePage const &page, common::Span<FeatureType const> ft,
             common::HistogramCuts const &cuts, int32_t max_bins_per_feat,
             bool is_dense, int32_t n_threads);
+  /**
+   * \brief Allocate an empty index for `n_samples` rows, which is then filled by a
+   *        sequence of calls to `Push`.  Used by DMatrix that doesn't keep raw data.
+   */
+  void Init(common::HistogramCuts cuts, int32_t max_bins_per_feat, bool is_dense,
+            size_t n_samples, int32_t n_threads);
+  /**
+   * \brief Quantize a batch of rows into the index, batches must be pushed in the order
+   *        of their base row id.
+   */
+  void Push(SparsePage const &batch, common::Span<FeatureType const> ft, int32_t n_threads);
+  /**
+   * \brief Copy rows `ridxs` of another index into this one.  The cuts are shared so no
+   *        sketching is performed.  Used by sliced DMatrix.
+   */
+  void GatherRows(GHistIndexMatrix const &that, common::Span<int32_t const> ridxs,
+                  int32_t n_threads);
 
-  // specific method for sparse data as no possibility to reduce allocated memory
-  template <typename BinIdxType, typename GetOffset>
-  void SetIndexData(common::Span<BinIdxType> index_data_span,
-                    common::Span<FeatureType const> ft,
+  /**
+   * \brief Quantize a batch, `set_bin(i, j, bin)` stores the global bin of the `j`th entry
+   *        in a row, which is element `i` of the index.
+   */
+  template <typename SetBin>
+  void SetIndexData(common::Span<FeatureType const> ft,
                     size_t batch_threads, const SparsePage &batch,
-                    size_t rbegin, size_t nbins, GetOffset get_offset) {
+                    size_t rbegin, size_t nbins, SetBin set_bin) {
     const xgboost::Entry *data_ptr = batch.data.HostVector().data();
     const std::vector<bst_row_t> &offset_vec = batch.offset.HostVector();
     const size_t batch_size = batch.Size();
     CHECK_LT(batch_size, offset_vec.size());
-    BinIdxType* index_data = index_data_span.data();
     common::ParallelFor(omp_ulong(batch_size), batch_threads, [&](omp_ulong i) {
-      const int tid = omp_get_thread_num();
+      const int tid = common::ThreadIdx();
       size_t ibegin = row_ptr[rbegin + i];
       size_t iend = row_ptr[rbegin + i + 1];
       const size_t size = offset_vec[i + 1] - offset_vec[i];
@@ -68,11 +109,11 @@ class GHistIndexMatrix {
         auto e = inst[j];
         if (common::IsCat(ft, e.index)) {
           auto bin_idx = cut.SearchCatBin(e);
-          index_data[ibegin + j] = get_offset(bin_idx, j);
+          set_bin(ibegin + j, j, bin_idx);
           ++hit_count_tloc_[tid * nbins + bin_idx];
         } else {
           uint32_t idx = cut.SearchBin(inst[j]);
-          index_data[ibegin + j] = get_offset(idx, j);
+          set_bin(ibegin + j, j, idx);
           ++hit_count_tloc_[tid * nbins + idx];
         }
       }
@@ -100,10 +141,44 @@ class GHistIndexMatrix {
   bst_row_t Size() const {
     return row_ptr.empty() ? 0 : row_ptr.size() - 1;
   }
+  /**
+   * \brief Get the column matrix built from this index.  It's built on first request and
+   *        shared by all boosters training on the same DMatrix, rebuilt only when a
+   *        different `sparse_threshold` is requested.  Thread-safe.
+   *
+   *   The returned matrix refers to the cuts of this index, so the caller must keep this
+   *   index alive while using it.
+   */
+  std::shared_ptr<common::ColumnMatrix const> Columns(double sparse_threshold) const;
+  /**
+   * \brief Get exclusive feature bundles of this index, built on first request and shared
+   *        the same way as `Columns`.  Only available for dense index with a single page.
+   */
+  std::shared_ptr<common::FeatureBundles const> Bundles(common::Span<FeatureType const> ft,
+                                                        int32_t n_threads) const;
+  /**
+   * \brief Get the dense copy of this index with a bin for missing values of each feature,
+   *        built on first request and shared the same way as `Columns`.  Only available
+   *        for index with a single page.
+   */
+  std::shared_ptr<common::MissingBins const> MissingBins(int32_t n_threads) const;
 
  private:
   std::vector<size_t> hit_count_tloc_;
   bool isDense_;
+  // Store features with different bin types, only for dense data with bin budgets or
+  // packed bins.
+  bool mixed_bins_{false};
+  bool pack_bins_{false};
+  common::TrackedBytes tracked_{common::MemoryTracker::kGHistIndexMatrix};
+
+  void Track();
+
+  mutable std::mutex columns_lock_;
+  mutable std::shared_ptr<common::ColumnMatrix const> columns_;
+  mutable double columns_sparse_threshold_{0};
+  mutable std::shared_ptr<common::FeatureBundles const> bundles_;
+  mutable std::shared_ptr<common::MissingBins const> missing_bins_;
 };
 }      // namespace xgboost
 #endif  // XGBOOST_DATA_GRADIENT_INDEX_H_
@@ -1,49 +1,163 @@
 /*!
  * Copyright 2021 XGBoost contributors
  */
+#include "gradient_index_format.h"
 #include "sparse_page_writer.h"
 #include "gradient_index.h"
 #include "histogram_cut_format.h"
+#include "../common/compression.h"
 
 namespace xgboost {
 namespace data {
+namespace {
+// Bin type 0 marks an index with mixed bin types, whose layout is given by the cuts.  An
+// index with packed bins is marked by `kPackedBinsFlag` instead.
+constexpr std::underlying_type_t<common::BinTypeSize> kPackedBinsFlag = 8;
+
+std::underlying_type_t<common::BinTypeSize> BinTypeFlag(common::Index const &index) {
+  if (index.IsMixed()) {
+    return index.IsPacked() ? kPackedBinsFlag : 0;
+  }
+  return index.GetBinTypeSize();
+}
+
+void SetBinType(std::underlying_type_t<common::BinTypeSize> flag, GHistIndexMatrix *page) {
+  if (flag == 0 || flag == kPackedBinsFlag) {
+    auto n_bytes = page->index.NumBytes();
+    page->index.ResizeMixed(page->row_ptr.size() - 1, page->cut.Ptrs(),
+                            flag == kPackedBinsFlag);
+    CHECK_EQ(page->index.NumBytes(), n_bytes) << "Invalid GHistIndex file";
+  } else {
+    page->index.SetBinTypeSize(static_cast<common::BinTypeSize>(flag));
+  }
+}
+}  // anonymous namespace
+
+bool ReadGHistIndex(GHistIndexMatrix *page, dmlc::Stream *fi) {
+  if (!ReadHistogramCuts(&page->cut, fi)) {
+    return false;
+  }
+  // indptr
+  fi->Read(&page->row_ptr);
+  // offset
+  using OffsetT = std::iterator_traits<decltype(page->index.Offset())>::value_type;
+  std::vector<OffsetT> offset;
+  if (!fi->Read(&offset)) {
+    return false;
+  }
+  page->index.ResizeOffset(offset.size());
+  std::copy(offset.begin(), offset.end(), page->index.Offset());
+  // data
+  std::vector<uint8_t> data;
+  if (!fi->Read(&data)) {
+    return false;
+  }
+  page->index.Resize(data.size());
+  std::copy(data.cbegin(), data.cend(), page->index.begin());
+  // bin type
+  // Old gcc doesn't support reading from enum.
+  std::underlying_type_t<common::BinTypeSize> uint_bin_type{0};
+  if (!fi->Read(&uint_bin_type)) {
+    return false;
+  }
+  SetBinType(uint_bin_type, page);
+  // hit count
+  if (!fi->Read(&page->hit_count)) {
+    return false;
+  }
+  if (!fi->Read(&page->max_num_bins)) {
+    return false;
+  }
+  if (!fi->Read(&page->base_rowid)) {
+    return false;
+  }
+  bool is_dense = false;
+  if (!fi->Read(&is_dense)) {
+    return false;
+  }
+  page->SetDense(is_dense);
+  return true;
+}
+
+size_t WriteGHistIndex(GHistIndexMatrix const &page, dmlc::Stream *fo) {
+  size_t bytes = 0;
+  bytes += WriteHistogramCuts(page.cut, fo);
+  // indptr
+  fo->Write(page.row_ptr);
+  bytes += page.row_ptr.size() * sizeof(decltype(page.row_ptr)::value_type) +
+           sizeof(uint64_t);
+  // offset
+  using OffsetT = std::iterator_traits<decltype(page.index.Offset())>::value_type;
+  std::vector<OffsetT> offset(page.index.OffsetSize());
+  std::copy(page.index.Offset(),
+            page.index.Offset() + page.index.OffsetSize(), offset.begin());
+  fo->Write(offset);
+  bytes += page.index.OffsetSize() * sizeof(OffsetT) + sizeof(uint64_t);
+  // data
+  std::vector<uint8_t> data(page.index.begin(), page.index.end());
+  fo->Write(data);
+  bytes += data.size() * sizeof(decltype(data)::value_type) + sizeof(uint64_t);
+  // bin type
+  std::underlying_type_t<common::BinTypeSize> uint_bin_type = BinTypeFlag(page.index);
+  fo->Write(uint_bin_type);
+  bytes += sizeof(page.index.GetBinTypeSize());
+  // hit count
+  fo->Write(page.hit_count);
+  bytes +=
+      page.hit_count.size() * sizeof(decltype(page.hit_count)::value_type) +
+      sizeof(uint64_t);
+  // max_bins, base row, is_dense
+  fo->Write(page.max_num_bins);
+  bytes += sizeof(page.max_num_bins);
+  fo->Write(page.base_rowid);
+  bytes += sizeof(page.base_rowid);
+  fo->Write(page.IsDense());
+  bytes += sizeof(page.IsDense());
+  return bytes;
+}
 
 class GHistIndexRawFormat : public SparsePageFormat<GHistIndexMatrix> {
+ public:
+  bool Read(GHistIndexMatrix* page, dmlc::SeekStream* fi) override {
+    return ReadGHistIndex(page, fi);
+  }
+
+  size_t Write(GHistIndexMatrix const &page, dmlc::Stream *fo) override {
+    return WriteGHistIndex(page, fo);
+  }
+};
+
+/**
+ * \brief Same layout as the raw format, but row pointers and hit count are delta encoded
+ *        and the bin index is compressed with LZ.
+ */
+class GHistIndexCompressedFormat : public SparsePageFormat<GHistIndexMatrix> {
  public:
   bool Read(GHistIndexMatrix* page, dmlc::SeekStream* fi) override {
     if (!ReadHistogramCuts(&page->cut, fi)) {
       return false;
     }
     // indptr
-    fi->Read(&page->row_ptr);
+    CHECK(common::ReadBlock(fi, &page->row_ptr)) << "Invalid GHistIndex file";
     // offset
     using OffsetT = std::iterator_traits<decltype(page->index.Offset())>::value_type;
     std::vector<OffsetT> offset;
-    if (!fi->Read(&offset)) {
-      return false;
-    }
+    CHECK(common::ReadBlock(fi, &offset)) << "Invalid GHistIndex file";
     page->index.ResizeOffset(offset.size());
     std::copy(offset.begin(), offset.end(), page->index.Offset());
     // data
     std::vector<uint8_t> data;
-    if (!fi->Read(&data)) {
-      return false;
-    }
+    CHECK(common::ReadBlock(fi, &data)) << "Invalid GHistIndex file";
     page->index.Resize(data.size());
     std::copy(data.cbegin(), data.cend(), page->index.begin());
     // bin type
-    // Old gcc doesn't support reading from enum.
     std::underlying_type_t<common::BinTypeSize> uint_bin_type{0};
     if (!fi->Read(&uint_bin_type)) {
       return false;
     }
-    common::BinTypeSize size_type =
-        static_cast<common::BinTypeSize>(uint_bin_type);
-    page->index.SetBinTypeSize(size_type);
+    SetBinType(uint_bin_type, page);
     // hit count
-    if (!fi->Read(&page->hit_count)) {
-      return false;
-    }
+    CHECK(common::ReadBlock(fi, &page->hit_count)) << "Invalid GHistIndex file";
     if (!fi->Read(&page->max_num_bins)) {
       return false;
     }
@@ -62,30 +176,24 @@ class GHistIndexRawFormat : public SparsePageFormat<GHistIndexMatrix> {
     size_t bytes = 0;
     bytes += WriteHistogramCuts(page.cut, fo);
     // indptr
-    fo->Write(page.row_ptr);
-    bytes += page.row_ptr.size() * sizeof(decltype(page.row_ptr)::value_type) +
-             sizeof(uint64_t);
+    bytes += common::WriteIntegerBlock(common::BlockCodec::kDeltaVarint,
+                                       common::Span<size_t const>{page.row_ptr}, fo);
     // offset
     using OffsetT = std::iterator_traits<decltype(page.index.Offset())>::value_type;
-    std::vector<OffsetT> offset(page.index.OffsetSize());
-    std::copy(page.index.Offset(),
-              page.index.Offset() + page.index.OffsetSize(), offset.begin());
-    fo->Write(offset);
-    bytes += page.index.OffsetSize() * sizeof(OffsetT) + sizeof(uint64_t);
+    bytes += common::WriteBlock(
+        common::BlockCodec::kRaw,
+        common::Span<OffsetT const>{page.index.Offset(), page.index.OffsetSize()}, fo);
     // data
-    std::vector<uint8_t> data(page.index.begin(), page.index.end());
-    fo->Write(data);
-    bytes += data.size() * sizeof(decltype(data)::value_type) + sizeof(uint64_t);
+    bytes += common::WriteBlock(
+        common::BlockCodec::kLZ,
+        common::Span<uint8_t const>{page.index.data<uint8_t>(), page.index.NumBytes()}, fo);
     // bin type
-    std::underlying_type_t<common::BinTypeSize> uint_bin_type =
-        page.index.GetBinTypeSize();
+    std::underlying_type_t<common::BinTypeSize> uint_bin_type = BinTypeFlag(page.index);
     fo->Write(uint_bin_type);
-    bytes += sizeof(page.index.GetBinTypeSize());
+    bytes += sizeof(uint_bin_type);
     // hit count
-    fo->Write(page.hit_count);
-    bytes +=
-        page.hit_count.size() * sizeof(decltype(page.hit_count)::value_type) +
-        sizeof(uint64_t);
+    bytes += common::WriteIntegerBlock(common::BlockCodec::kDeltaVarint,
+                                       common::Span<size_t const>{page.hit_count}, fo);
     // max_bins, base row, is_dense
     fo->Write(page.max_num_bins);
     bytes += sizeof(page.max_num_bins);
@@ -103,5 +211,9 @@ XGBOOST_REGISTER_GHIST_INDEX_PAGE_FORMAT(raw)
     .describe("Raw GHistIndex binary data format.")
     .set_body([]() { return new GHistIndexRawFormat(); });
 
+XGBOOST_REGISTER_GHIST_INDEX_PAGE_FORMAT(compressed)
+    .describe("Compressed GHistIndex binary data format.")
+    .set_body([]() { return new GHistIndexCompressedFormat(); });
+
 }  // namespace data
 }  // namespace xgboost
@@ -0,0 +1,31 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ * \file gradient_index_format.h
+ * \brief Serialization of GHistIndexMatrix shared by the external memory page format and
+ *        the binary DMatrix file.
+ */
+#ifndef XGBOOST_DATA_GRADIENT_INDEX_FORMAT_H_
+#define XGBOOST_DATA_GRADIENT_INDEX_FORMAT_H_
+
+#include <dmlc/io.h>
+
+#include "gradient_index.h"
+
+namespace xgboost {
+namespace data {
+/**
+ * \brief Read a gradient index along with its cuts, the stream doesn't need to be
+ *        seekable.
+ *
+ * \return Whether the read is successful.
+ */
+bool ReadGHistIndex(GHistIndexMatrix *page, dmlc::Stream *fi);
+/**
+ * \brief Write a gradient index along with its cuts.
+ *
+ * \return Number of bytes written.
+ */
+size_t WriteGHistIndex(GHistIndexMatrix const &page, dmlc::Stream *fo);
+}  // namespace data
+}  // namespace xgboost
+#endif  // XGBOOST_DATA_GRADIENT_INDEX_FORMAT_H_
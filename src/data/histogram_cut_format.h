@@ -8,7 +8,7 @@
 
 namespace xgboost {
 namespace data {
-inline bool ReadHistogramCuts(common::HistogramCuts *cuts, dmlc::SeekStream *fi) {
+inline bool ReadHistogramCuts(common::HistogramCuts *cuts, dmlc::Stream *fi) {
   if (!fi->Read(&cuts->cut_values_.HostVector())) {
     return false;
   }
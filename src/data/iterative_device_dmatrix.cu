@@ -82,6 +82,22 @@ void IterativeDeviceDMatrix::Initialize(DataIterHandle iter_handle, float missin
     nnz += thrust::reduce(thrust::cuda::par(alloc), row_counts.begin(),
                           row_counts.end());
     batches++;
+
+    // Merge the batch sketches early when they hold too much device memory.
+    size_t sketch_bytes = 0;
+    for (auto const& sketch : sketch_containers) {
+      sketch_bytes += sketch.MemCostBytes();
+    }
+    if (sketch_containers.size() > 1 &&
+        sketch_bytes > common::detail::SketchMemoryBudget(get_device()) / 4) {
+      auto& merged = sketch_containers.front();
+      for (auto it = sketch_containers.cbegin() + 1; it != sketch_containers.cend(); ++it) {
+        merged.Merge(it->ColumnsPtr(), it->Data());
+        merged.FixError();
+      }
+      sketch_containers.erase(sketch_containers.begin() + 1, sketch_containers.end());
+      merged.PruneIfLarger(0);
+    }
   }
   iter.Reset();
   dh::safe_cuda(cudaSetDevice(get_device()));
@@ -44,6 +44,7 @@ class IterativeDeviceDMatrix : public DMatrix {
 
   bool EllpackExists() const override { return true; }
   bool SparsePageExists() const override { return false; }
+  bool GHistIndexExists() const override { return false; }
   DMatrix *Slice(common::Span<int32_t const> ridxs) override {
     LOG(FATAL) << "Slicing DMatrix is not supported for Device DMatrix.";
     return nullptr;
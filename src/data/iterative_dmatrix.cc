@@ -0,0 +1,139 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include "iterative_dmatrix.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rabit/rabit.h"
+#include "../common/hist_util.h"
+#include "../common/quantile.h"
+#include "gradient_index.h"
+#include "proxy_dmatrix.h"
+#include "simple_batch_iterator.h"
+#include "sparse_page_source.h"
+
+namespace xgboost {
+namespace data {
+void IterativeDMatrix::Initialize(DataIterHandle iter_handle, float missing, int32_t n_threads,
+                                  size_t prefetch_batches, std::shared_ptr<DMatrix> ref) {
+  // A handle passed to external iterator.
+  DMatrixProxy* proxy = MakeProxy(proxy_);
+  CHECK(proxy);
+  n_threads = n_threads <= 0 ? omp_get_max_threads() : n_threads;
+
+  // The external iterator.  Each batch is copied into a transient CSR page, so only
+  // `prefetch_batches + 1` batches of raw data are alive at any time.
+  BatchPipeline pipeline{DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext>{
+                             iter_handle, reset_, next_},
+                         proxy, missing, n_threads, prefetch_batches};
+  std::shared_ptr<IterBatch> batch;
+
+  /**
+   * Pass 1: Meta info and column sizes.  The CPU sketch container can grow its summaries
+   * while streaming, but knowing the size of each column beforehand avoids resizing.
+   * Column sizes are not needed when cuts come from the reference.
+   */
+  size_t n_features = 0;
+  size_t n_samples = 0;
+  size_t nnz = 0;
+  size_t n_batches = 0;
+  std::vector<bst_row_t> column_sizes;
+
+  pipeline.Reset();
+  while ((batch = pipeline.Next())) {
+    this->info_.Extend(std::move(batch->info), false, false);
+    n_features = std::max(n_features, batch->n_features);
+    auto& page = *batch->page;
+    page.SetBaseRowId(n_samples);
+    if (!ref) {
+      auto batch_column_sizes = common::HostSketchContainer::CalcColumnSize(
+          page, static_cast<bst_feature_t>(n_features), n_threads);
+      column_sizes.resize(std::max(column_sizes.size(), batch_column_sizes.size()), 0);
+      for (size_t i = 0; i < batch_column_sizes.size(); ++i) {
+        column_sizes[i] += batch_column_sizes[i];
+      }
+    }
+    n_samples += page.Size();
+    nnz += page.data.Size();
+    n_batches++;
+  }
+  CHECK_NE(n_batches, 0) << "Must have at least 1 batch.";
+
+  this->info_.num_row_ = n_samples;
+  this->info_.num_col_ = n_features;
+  this->info_.num_nonzero_ = nnz;
+  rabit::Allreduce<rabit::op::Max>(&info_.num_col_, 1);
+  if (ref) {
+    // Trailing empty columns are not seen by the iterator.
+    CHECK_LE(info_.num_col_, ref->Info().num_col_)
+        << "Reference DMatrix has fewer features than the data.";
+    info_.num_col_ = ref->Info().num_col_;
+  }
+  CHECK_NE(info_.num_col_, 0);
+  column_sizes.resize(info_.num_col_, 0);
+
+  /**
+   * Pass 2: Sketch, or copy the cuts from the reference.
+   */
+  auto ft = this->info_.feature_types.ConstHostSpan();
+  size_t base_rowid = 0;
+  common::HistogramCuts cuts;
+  if (ref) {
+    // Use the existing index of the reference as it is, like the one built for training.
+    auto ref_param = ref->PageExists<GHistIndexMatrix>() ? BatchParam{} : batch_param_;
+    for (auto const& page : ref->GetBatches<GHistIndexMatrix>(ref_param)) {
+      cuts = page.cut;
+      break;
+    }
+  } else {
+    common::HostSketchContainer sketch(column_sizes, batch_param_.max_bin, ft,
+                                       common::HostSketchContainer::UseGroup(info_),
+                                       n_threads);
+    pipeline.Reset();
+    while ((batch = pipeline.Next())) {
+      auto& page = *batch->page;
+      page.SetBaseRowId(base_rowid);
+      sketch.PushRowPage(page, info_);
+      base_rowid += page.Size();
+    }
+    CHECK_EQ(base_rowid, n_samples) << "Inconsistent number of rows between iterations.";
+    sketch.MakeCuts(&cuts);
+  }
+
+  /**
+   * Pass 3: Quantize.
+   */
+  ghist_ = std::make_shared<GHistIndexMatrix>();
+  ghist_->Init(std::move(cuts), batch_param_.max_bin, this->IsDense(), n_samples, n_threads);
+  ghist_->p_fmat = this;
+  base_rowid = 0;
+  pipeline.Reset();
+  while ((batch = pipeline.Next())) {
+    auto& page = *batch->page;
+    page.SetBaseRowId(base_rowid);
+    ghist_->Push(page, ft, n_threads);
+    base_rowid += page.Size();
+  }
+  CHECK_EQ(base_rowid, n_samples) << "Inconsistent number of rows between iterations.";
+  pipeline.Reset();
+}
+
+BatchSet<GHistIndexMatrix> IterativeDMatrix::GetGradientIndex(BatchParam const& param) {
+  CHECK(ghist_);
+  if (param != batch_param_ && param != BatchParam{}) {
+    CHECK(param.hess.empty())
+        << "Quantile DMatrix can not be re-sketched with hessian, use `hist` tree method.";
+    LOG(FATAL) << "`max_bin` must be the same as the one used to construct Quantile "
+                  "DMatrix, expected: "
+               << batch_param_.max_bin << ", got: " << param.max_bin;
+  }
+  auto begin_iter = BatchIterator<GHistIndexMatrix>(
+      new SimpleBatchIteratorImpl<GHistIndexMatrix>(ghist_));
+  return BatchSet<GHistIndexMatrix>(begin_iter);
+}
+}  // namespace data
+}  // namespace xgboost
@@ -0,0 +1,96 @@
+/*!
+ * Copyright 2021 by Contributors
+ * \file iterative_dmatrix.h
+ * \brief Quantile DMatrix for CPU hist, built directly from an external data iterator.
+ */
+#ifndef XGBOOST_DATA_ITERATIVE_DMATRIX_H_
+#define XGBOOST_DATA_ITERATIVE_DMATRIX_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/c_api.h"
+#include "gradient_index.h"
+#include "proxy_dmatrix.h"
+#include "simple_batch_iterator.h"
+
+namespace xgboost {
+namespace data {
+/**
+ * \brief CPU counterpart of `IterativeDeviceDMatrix`.  Data from the iterator is sketched
+ *        and then quantized into a single `GHistIndexMatrix`, only one batch of raw data
+ *        is held in memory at any time and no cache file is written.  As a result only the
+ *        `hist` tree method can be used for training.
+ *
+ *        When a reference DMatrix is given, its histogram cuts are reused and the data is
+ *        only quantized.  Micro-batches quantized against the same cuts skip sketching and
+ *        keep the histogram size of the training buffers unchanged across updates.
+ */
+class IterativeDMatrix : public DMatrix {
+  MetaInfo info_;
+  BatchParam batch_param_;
+  std::shared_ptr<GHistIndexMatrix> ghist_;
+
+  DMatrixHandle proxy_;
+  DataIterResetCallback *reset_;
+  XGDMatrixCallbackNext *next_;
+
+ public:
+  void Initialize(DataIterHandle iter, float missing, int32_t n_threads,
+                  size_t prefetch_batches, std::shared_ptr<DMatrix> ref);
+
+ public:
+  explicit IterativeDMatrix(DataIterHandle iter, DMatrixHandle proxy,
+                            DataIterResetCallback *reset, XGDMatrixCallbackNext *next,
+                            float missing, int32_t n_threads, int32_t max_bin,
+                            size_t prefetch_batches = 0,
+                            std::shared_ptr<DMatrix> ref = nullptr)
+      : proxy_{proxy}, reset_{reset}, next_{next} {
+    batch_param_ = BatchParam{GenericParameter::kCpuId, max_bin};
+    this->Initialize(iter, missing, n_threads, prefetch_batches, std::move(ref));
+  }
+  ~IterativeDMatrix() override = default;
+
+  bool EllpackExists() const override { return false; }
+  bool SparsePageExists() const override { return false; }
+  bool GHistIndexExists() const override { return true; }
+  DMatrix *Slice(common::Span<int32_t const> ridxs) override {
+    LOG(FATAL) << "Slicing DMatrix is not supported for Quantile DMatrix.";
+    return nullptr;
+  }
+  BatchSet<SparsePage> GetRowBatches() override {
+    LOG(FATAL) << "Quantile DMatrix doesn't hold raw data, only `hist` tree method is "
+                  "supported.";
+    return BatchSet<SparsePage>(BatchIterator<SparsePage>(nullptr));
+  }
+  BatchSet<CSCPage> GetColumnBatches() override {
+    LOG(FATAL) << "Not implemented.";
+    return BatchSet<CSCPage>(BatchIterator<CSCPage>(nullptr));
+  }
+  BatchSet<SortedCSCPage> GetSortedColumnBatches() override {
+    LOG(FATAL) << "Not implemented.";
+    return BatchSet<SortedCSCPage>(BatchIterator<SortedCSCPage>(nullptr));
+  }
+  BatchSet<EllpackPage> GetEllpackBatches(const BatchParam&) override {
+    LOG(FATAL) << "Not implemented.";
+    return BatchSet<EllpackPage>(BatchIterator<EllpackPage>(nullptr));
+  }
+  BatchSet<GHistIndexMatrix> GetGradientIndex(const BatchParam& param) override;
+
+  bool SingleColBlock() const override { return true; }
+
+  MetaInfo& Info() override {
+    return info_;
+  }
+  MetaInfo const& Info() const override {
+    return info_;
+  }
+};
+}  // namespace data
+}  // namespace xgboost
+
+#endif  // XGBOOST_DATA_ITERATIVE_DMATRIX_H_
@@ -82,6 +82,7 @@ class DMatrixProxy : public DMatrix {
   bool SingleColBlock() const override { return true; }
   bool EllpackExists() const override { return true; }
   bool SparsePageExists() const override { return false; }
+  bool GHistIndexExists() const override { return false; }
   DMatrix *Slice(common::Span<int32_t const> ridxs) override {
     LOG(FATAL) << "Slicing DMatrix is not supported for Proxy DMatrix.";
     return nullptr;
@@ -119,6 +120,12 @@ inline DMatrixProxy *MakeProxy(DMatrixHandle proxy) {
   return typed;
 }
 
+namespace detail {
+// Number of samples and features of device data stored in the proxy.
+size_t NSamplesDevice(DMatrixProxy *proxy);
+size_t NFeaturesDevice(DMatrixProxy *proxy);
+}  // namespace detail
+
 template <typename Fn>
 decltype(auto) HostAdapterDispatch(DMatrixProxy const* proxy, Fn fn, bool* type_error = nullptr) {
   if (proxy->Adapter().type() == typeid(std::shared_ptr<CSRArrayAdapter>)) {
@@ -8,6 +8,8 @@
 #include <limits>
 #include <type_traits>
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 
 #include "xgboost/data.h"
 #include "xgboost/c_api.h"
@@ -18,9 +20,18 @@
 #include "../common/threading_utils.h"
 #include "adapter.h"
 #include "gradient_index.h"
+#include "gradient_index_format.h"
+#include "proxy_dmatrix.h"
+#include "sparse_page_source.h"
 
 namespace xgboost {
 namespace data {
+namespace {
+char const* kRawDataReleased =
+    "Raw data of DMatrix is released after quantization, only `hist` tree method and "
+    "prediction with the quantized data are supported.";
+}  // anonymous namespace
+
 MetaInfo& SimpleDMatrix::Info() { return info_; }
 
 const MetaInfo& SimpleDMatrix::Info() const { return info_; }
@@ -45,7 +56,68 @@ DMatrix* SimpleDMatrix::Slice(common::Span<int32_t const> ridxs) {
   return out;
 }
 
+bool SimpleDMatrix::ReleaseRawData() {
+  std::lock_guard<std::mutex> guard{gradient_index_lock_};
+  if (!gradient_index_) {
+    return false;
+  }
+  // Iterators holding the pages keep them alive until they finish.
+  sparse_page_.reset();
+  column_page_.reset();
+  sorted_column_page_.reset();
+  return true;
+}
+
+bool SimpleDMatrix::RecodeCategories(std::vector<std::vector<float>> const& remap) {
+  std::lock_guard<std::mutex> guard{gradient_index_lock_};
+  CHECK(sparse_page_) << kRawDataReleased;
+  auto const& h_offset = sparse_page_->offset.ConstHostVector();
+  auto const& h_data = sparse_page_->data.ConstHostVector();
+  size_t n_rows = h_offset.size() - 1;
+  auto recode = [&](Entry e) {
+    if (e.index < remap.size() && !remap[e.index].empty()) {
+      auto const& map = remap[e.index];
+      auto code = static_cast<size_t>(e.fvalue);
+      e.fvalue = code < map.size() ? map[code] : std::numeric_limits<float>::quiet_NaN();
+    }
+    return e;
+  };
+  // Pages held by iterators are not modified, a new page is created instead.
+  auto page = std::make_shared<SparsePage>();
+  auto& offset = page->offset.HostVector();
+  offset.resize(h_offset.size(), 0);
+  auto n_threads = omp_get_max_threads();
+  common::ParallelFor(n_rows, n_threads, [&](size_t i) {
+    size_t n = 0;
+    for (auto j = h_offset[i]; j < h_offset[i + 1]; ++j) {
+      n += !std::isnan(recode(h_data[j]).fvalue);
+    }
+    offset[i + 1] = n;
+  });
+  std::partial_sum(offset.cbegin(), offset.cend(), offset.begin());
+  auto& data = page->data.HostVector();
+  data.resize(offset.back());
+  common::ParallelFor(n_rows, n_threads, [&](size_t i) {
+    auto k = offset[i];
+    for (auto j = h_offset[i]; j < h_offset[i + 1]; ++j) {
+      auto e = recode(h_data[j]);
+      if (!std::isnan(e.fvalue)) {
+        data[k++] = e;
+      }
+    }
+  });
+  sparse_page_ = std::move(page);
+  info_.num_nonzero_ = offset.back();
+  // Derived pages are built from the old codes.
+  column_page_.reset();
+  sorted_column_page_.reset();
+  ellpack_page_.reset();
+  gradient_index_.reset();
+  return true;
+}
+
 BatchSet<SparsePage> SimpleDMatrix::GetRowBatches() {
+  CHECK(sparse_page_) << kRawDataReleased;
   // since csr is the default data structure so `source_` is always available.
   auto begin_iter = BatchIterator<SparsePage>(
       new SimpleBatchIteratorImpl<SparsePage>(sparse_page_));
@@ -55,6 +127,7 @@ BatchSet<SparsePage> SimpleDMatrix::GetRowBatches() {
 BatchSet<CSCPage> SimpleDMatrix::GetColumnBatches() {
   // column page doesn't exist, generate it
   if (!column_page_) {
+    CHECK(sparse_page_) << kRawDataReleased;
     column_page_.reset(new CSCPage(sparse_page_->GetTranspose(info_.num_col_)));
   }
   auto begin_iter =
@@ -65,9 +138,9 @@ BatchSet<CSCPage> SimpleDMatrix::GetColumnBatches() {
 BatchSet<SortedCSCPage> SimpleDMatrix::GetSortedColumnBatches() {
   // Sorted column page doesn't exist, generate it
   if (!sorted_column_page_) {
+    CHECK(sparse_page_) << kRawDataReleased;
     sorted_column_page_.reset(
-        new SortedCSCPage(sparse_page_->GetTranspose(info_.num_col_)));
-    sorted_column_page_->SortRows();
+        new SortedCSCPage(sparse_page_->GetTranspose(info_.num_col_, true)));
   }
   auto begin_iter = BatchIterator<SortedCSCPage>(
       new SimpleBatchIteratorImpl<SortedCSCPage>(sorted_column_page_));
@@ -91,13 +164,16 @@ BatchSet<EllpackPage> SimpleDMatrix::GetEllpackBatches(const BatchParam& param)
 }
 
 BatchSet<GHistIndexMatrix> SimpleDMatrix::GetGradientIndex(const BatchParam& param) {
+  std::lock_guard<std::mutex> guard{gradient_index_lock_};
   if (!(batch_param_ != BatchParam{})) {
     CHECK(param != BatchParam{}) << "Batch parameter is not initialized.";
   }
   if (!gradient_index_  || (batch_param_ != param && param != BatchParam{}) || param.regen) {
     CHECK_GE(param.max_bin, 2);
     CHECK_EQ(param.gpu_id, -1);
-    gradient_index_.reset(new GHistIndexMatrix(this, param.max_bin, param.hess));
+    CHECK(sparse_page_) << kRawDataReleased;
+    gradient_index_.reset(
+        new GHistIndexMatrix(this, param));
     batch_param_ = param;
     CHECK_EQ(batch_param_.hess.data(), param.hess.data());
   }
@@ -201,6 +277,43 @@ SimpleDMatrix::SimpleDMatrix(AdapterT* adapter, float missing, int nthread) {
   info_.num_nonzero_ = data_vec.size();
 }
 
+SimpleDMatrix* SimpleDMatrix::FromIterator(DataIterHandle iter, DMatrixHandle proxy,
+                                           DataIterResetCallback* reset,
+                                           XGDMatrixCallbackNext* next, float missing,
+                                           int32_t nthread, size_t memory_budget,
+                                           size_t prefetch_batches) {
+  BatchPipeline pipeline{DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext>{
+                             iter, reset, next},
+                         MakeProxy(proxy), missing, nthread, prefetch_batches};
+  std::unique_ptr<SimpleDMatrix> out{new SimpleDMatrix};
+  auto& info = out->info_;
+  auto& page = *out->sparse_page_;
+  size_t n_features = 0;
+  size_t n_batches = 0;
+  std::shared_ptr<IterBatch> batch;
+
+  pipeline.Reset();
+  while ((batch = pipeline.Next())) {
+    info.Extend(std::move(batch->info), false, false);
+    n_features = std::max(n_features, batch->n_features);
+    page.Push(*batch->page);
+    n_batches++;
+    // The gradient index takes at least 1 byte for each entry.
+    if (memory_budget != 0 && page.MemCostBytes() + page.data.Size() > memory_budget) {
+      pipeline.Reset();
+      return nullptr;
+    }
+  }
+  pipeline.Reset();
+  CHECK_NE(n_batches, 0) << "Must have at least 1 batch.";
+
+  info.num_row_ = page.Size();
+  info.num_col_ = n_features;
+  info.num_nonzero_ = page.data.Size();
+  rabit::Allreduce<rabit::op::Max>(&info.num_col_, 1);
+  return out.release();
+}
+
 SimpleDMatrix::SimpleDMatrix(dmlc::Stream* in_stream) {
   int tmagic;
   CHECK(in_stream->Read(&tmagic)) << "invalid input file format";
@@ -208,15 +321,33 @@ SimpleDMatrix::SimpleDMatrix(dmlc::Stream* in_stream) {
   info_.LoadBinary(in_stream);
   in_stream->Read(&sparse_page_->offset.HostVector());
   in_stream->Read(&sparse_page_->data.HostVector());
+  // Files written by older versions end here.
+  if (in_stream->Read(&tmagic)) {
+    CHECK_EQ(tmagic, kGHistIndexMagic) << "invalid format, magic number mismatch";
+    gradient_index_ = std::make_shared<GHistIndexMatrix>();
+    CHECK(ReadGHistIndex(gradient_index_.get(), in_stream)) << "invalid gradient index";
+    gradient_index_->p_fmat = this;
+    batch_param_ = BatchParam{GenericParameter::kCpuId,
+                              static_cast<int32_t>(gradient_index_->max_num_bins)};
+  }
 }
 
-void SimpleDMatrix::SaveToLocalFile(const std::string& fname) {
+void SimpleDMatrix::SaveToLocalFile(const std::string& fname, int32_t max_bin) {
+    CHECK(sparse_page_) << kRawDataReleased;
     std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname.c_str(), "w"));
     int tmagic = kMagic;
     fo->Write(tmagic);
     info_.SaveBinary(fo.get());
     fo->Write(sparse_page_->offset.HostVector());
     fo->Write(sparse_page_->data.HostVector());
+    if (max_bin > 0) {
+      auto const& page =
+          *this->GetBatches<GHistIndexMatrix>(BatchParam{GenericParameter::kCpuId, max_bin})
+               .begin();
+      tmagic = kGHistIndexMagic;
+      fo->Write(tmagic);
+      WriteGHistIndex(page, fo.get());
+    }
 }
 
 template SimpleDMatrix::SimpleDMatrix(DenseAdapter* adapter, float missing,
@@ -231,6 +362,8 @@ template SimpleDMatrix::SimpleDMatrix(CSCAdapter* adapter, float missing,
                                      int nthread);
 template SimpleDMatrix::SimpleDMatrix(DataTableAdapter* adapter, float missing,
                                      int nthread);
+template SimpleDMatrix::SimpleDMatrix(ArrowAdapter* adapter, float missing,
+                                     int nthread);
 template SimpleDMatrix::SimpleDMatrix(FileAdapter* adapter, float missing,
                                      int nthread);
 template SimpleDMatrix::SimpleDMatrix(
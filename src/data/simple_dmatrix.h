@@ -8,9 +8,11 @@
 #define XGBOOST_DATA_SIMPLE_DMATRIX_H_
 
 #include <xgboost/base.h>
+#include <xgboost/c_api.h>
 #include <xgboost/data.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "gradient_index.h"
@@ -27,7 +29,29 @@ class SimpleDMatrix : public DMatrix {
   explicit SimpleDMatrix(dmlc::Stream* in_stream);
   ~SimpleDMatrix() override = default;
 
-  void SaveToLocalFile(const std::string& fname);
+  /**
+   * \brief Load all batches from an external data iterator into memory.
+   *
+   * \param memory_budget    Upper bound of bytes for the raw data plus the estimated size of
+   *                         the gradient index, 0 for no limit.
+   * \param prefetch_batches Number of batches read ahead from the iterator.
+   *
+   * \return The loaded DMatrix, or nullptr once the data exceeds the budget.  The iterator
+   *         is reset in both cases.
+   */
+  static SimpleDMatrix* FromIterator(DataIterHandle iter, DMatrixHandle proxy,
+                                     DataIterResetCallback* reset, XGDMatrixCallbackNext* next,
+                                     float missing, int32_t nthread, size_t memory_budget,
+                                     size_t prefetch_batches);
+
+  /**
+   * \brief Save the DMatrix into a binary file.
+   *
+   * \param fname   Output file name.
+   * \param max_bin When positive, the gradient index with `max_bin` is saved along with
+   *                the raw data, so loading the file doesn't need to sketch it again.
+   */
+  void SaveToLocalFile(const std::string& fname, int32_t max_bin = 0);
 
   MetaInfo& Info() override;
 
@@ -35,9 +59,13 @@ class SimpleDMatrix : public DMatrix {
 
   bool SingleColBlock() const override { return true; }
   DMatrix* Slice(common::Span<int32_t const> ridxs) override;
+  bool ReleaseRawData() override;
+  bool RecodeCategories(std::vector<std::vector<float>> const& remap) override;
 
   /*! \brief magic number used to identify SimpleDMatrix binary files */
   static const int kMagic = 0xffffab01;
+  /*! \brief magic number marking the optional gradient index section in binary files */
+  static const int kGHistIndexMagic = 0xffffab02;
 
  private:
   BatchSet<SparsePage> GetRowBatches() override;
@@ -47,19 +75,24 @@ class SimpleDMatrix : public DMatrix {
   BatchSet<GHistIndexMatrix> GetGradientIndex(const BatchParam& param) override;
 
   MetaInfo info_;
-  // Primary storage type
+  // Primary storage type, released after quantization on request.
   std::shared_ptr<SparsePage> sparse_page_ = std::make_shared<SparsePage>();
   std::shared_ptr<CSCPage> column_page_{nullptr};
   std::shared_ptr<SortedCSCPage> sorted_column_page_{nullptr};
   std::shared_ptr<EllpackPage> ellpack_page_{nullptr};
   std::shared_ptr<GHistIndexMatrix> gradient_index_{nullptr};
   BatchParam batch_param_;
+  // Boosters training concurrently on the same DMatrix share the gradient index.
+  std::mutex gradient_index_lock_;
 
   bool EllpackExists() const override {
     return static_cast<bool>(ellpack_page_);
   }
   bool SparsePageExists() const override {
-    return true;
+    return static_cast<bool>(sparse_page_);
+  }
+  bool GHistIndexExists() const override {
+    return static_cast<bool>(gradient_index_);
   }
 };
 }  // namespace data
@@ -0,0 +1,146 @@
+/*!
+ * Copyright 2021 by Contributors
+ * \file slice_dmatrix.cc
+ */
+#include "slice_dmatrix.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../common/threading_utils.h"
+#include "./simple_batch_iterator.h"
+
+namespace xgboost {
+namespace data {
+SliceDMatrix::SliceDMatrix(std::shared_ptr<DMatrix> parent, common::Span<int32_t const> ridxs)
+    : parent_{std::move(parent)}, ridxs_(ridxs.cbegin(), ridxs.cend()) {
+  CHECK(parent_);
+  CHECK(parent_->SingleColBlock()) << "Slicing external memory DMatrix is not supported.";
+  auto n_samples = parent_->Info().num_row_;
+  for (auto ridx : ridxs_) {
+    CHECK_GE(ridx, 0);
+    CHECK_LT(static_cast<bst_row_t>(ridx), n_samples) << "Row index out of bound.";
+  }
+  info_ = parent_->Info().Slice(ridxs_);
+
+  // Calculate number of non-missing values from either type of page in parent, without
+  // generating a new one.
+  auto count = [&](auto const& row_ptr) {
+    uint64_t nnz = 0;
+    for (auto ridx : ridxs_) {
+      nnz += row_ptr[ridx + 1] - row_ptr[ridx];
+    }
+    return nnz;
+  };
+  if (!parent_->PageExists<SparsePage>() && parent_->PageExists<GHistIndexMatrix>()) {
+    for (auto const& page : parent_->GetBatches<GHistIndexMatrix>(BatchParam{})) {
+      info_.num_nonzero_ = count(page.row_ptr);
+    }
+  } else {
+    for (auto const& page : parent_->GetBatches<SparsePage>()) {
+      info_.num_nonzero_ = count(page.offset.ConstHostVector());
+    }
+  }
+}
+
+DMatrix* SliceDMatrix::Slice(common::Span<int32_t const> ridxs) {
+  std::vector<int32_t> composed(ridxs.size());
+  std::transform(ridxs.cbegin(), ridxs.cend(), composed.begin(), [&](int32_t ridx) {
+    CHECK_GE(ridx, 0);
+    CHECK_LT(static_cast<size_t>(ridx), ridxs_.size()) << "Row index out of bound.";
+    return ridxs_[ridx];
+  });
+  auto out = new SliceDMatrix{parent_, composed};
+  // Meta info might have been modified after creating this view.
+  auto nnz = out->info_.num_nonzero_;
+  out->info_ = this->Info().Slice(ridxs);
+  out->info_.num_nonzero_ = nnz;
+  return out;
+}
+
+BatchSet<SparsePage> SliceDMatrix::GetRowBatches() {
+  if (!sparse_page_) {
+    sparse_page_ = std::make_shared<SparsePage>();
+    auto& h_offset = sparse_page_->offset.HostVector();
+    auto& h_data = sparse_page_->data.HostVector();
+    for (auto const& page : parent_->GetBatches<SparsePage>()) {
+      auto const& p_offset = page.offset.ConstHostVector();
+      auto const& p_data = page.data.ConstHostVector();
+      h_offset.resize(ridxs_.size() + 1, 0);
+      for (size_t i = 0; i < ridxs_.size(); ++i) {
+        auto ridx = ridxs_[i];
+        h_offset[i + 1] = h_offset[i] + (p_offset[ridx + 1] - p_offset[ridx]);
+      }
+      h_data.resize(h_offset.back());
+      common::ParallelFor(ridxs_.size(), omp_get_max_threads(), [&](size_t i) {
+        auto ridx = ridxs_[i];
+        std::copy(p_data.cbegin() + p_offset[ridx], p_data.cbegin() + p_offset[ridx + 1],
+                  h_data.begin() + h_offset[i]);
+      });
+    }
+  }
+  auto begin_iter =
+      BatchIterator<SparsePage>(new SimpleBatchIteratorImpl<SparsePage>(sparse_page_));
+  return BatchSet<SparsePage>(begin_iter);
+}
+
+BatchSet<CSCPage> SliceDMatrix::GetColumnBatches() {
+  if (!column_page_) {
+    auto const& page = *this->GetBatches<SparsePage>().begin();
+    column_page_.reset(new CSCPage(page.GetTranspose(info_.num_col_)));
+  }
+  auto begin_iter =
+      BatchIterator<CSCPage>(new SimpleBatchIteratorImpl<CSCPage>(column_page_));
+  return BatchSet<CSCPage>(begin_iter);
+}
+
+BatchSet<SortedCSCPage> SliceDMatrix::GetSortedColumnBatches() {
+  if (!sorted_column_page_) {
+    auto const& page = *this->GetBatches<SparsePage>().begin();
+    sorted_column_page_.reset(new SortedCSCPage(page.GetTranspose(info_.num_col_, true)));
+  }
+  auto begin_iter = BatchIterator<SortedCSCPage>(
+      new SimpleBatchIteratorImpl<SortedCSCPage>(sorted_column_page_));
+  return BatchSet<SortedCSCPage>(begin_iter);
+}
+
+BatchSet<EllpackPage> SliceDMatrix::GetEllpackBatches(const BatchParam& param) {
+  if (!(ellpack_param_ != BatchParam{})) {
+    CHECK(param != BatchParam{}) << "Batch parameter is not initialized.";
+  }
+  if (!ellpack_page_ || (ellpack_param_ != param && param != BatchParam{})) {
+    CHECK_GE(param.gpu_id, 0);
+    CHECK_GE(param.max_bin, 2);
+    ellpack_page_.reset(new EllpackPage(this, param));
+    ellpack_param_ = param;
+  }
+  auto begin_iter =
+      BatchIterator<EllpackPage>(new SimpleBatchIteratorImpl<EllpackPage>(ellpack_page_));
+  return BatchSet<EllpackPage>(begin_iter);
+}
+
+BatchSet<GHistIndexMatrix> SliceDMatrix::GetGradientIndex(const BatchParam& param) {
+  std::lock_guard<std::mutex> guard{gradient_index_lock_};
+  if (!gradient_index_ || (batch_param_ != param && param != BatchParam{}) || param.regen) {
+    CHECK_EQ(param.gpu_id, -1);
+    if (!param.hess.empty()) {
+      // Cuts weighted by hessian are specific to this subset of rows.
+      CHECK_GE(param.max_bin, 2);
+      gradient_index_.reset(new GHistIndexMatrix(this, param));
+    } else {
+      for (auto const& page : parent_->GetBatches<GHistIndexMatrix>(param)) {
+        gradient_index_ = std::make_shared<GHistIndexMatrix>();
+        gradient_index_->GatherRows(page, ridxs_, omp_get_max_threads());
+        gradient_index_->p_fmat = this;
+      }
+    }
+    batch_param_ = param;
+  }
+  auto begin_iter = BatchIterator<GHistIndexMatrix>(
+      new SimpleBatchIteratorImpl<GHistIndexMatrix>(gradient_index_));
+  return BatchSet<GHistIndexMatrix>(begin_iter);
+}
+}  // namespace data
+}  // namespace xgboost
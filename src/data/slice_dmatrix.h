@@ -0,0 +1,75 @@
+/*!
+ * Copyright 2021 by Contributors
+ * \file slice_dmatrix.h
+ * \brief A row subset of another DMatrix that doesn't copy the raw data.
+ */
+#ifndef XGBOOST_DATA_SLICE_DMATRIX_H_
+#define XGBOOST_DATA_SLICE_DMATRIX_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/span.h"
+#include "gradient_index.h"
+
+namespace xgboost {
+namespace data {
+/**
+ * \brief View of selected rows in a parent DMatrix.
+ *
+ *   Only the meta info is sliced on construction.  Pages are generated lazily from the
+ *   parent when requested: the gradient index is gathered from the gradient index of the
+ *   parent, reusing its histogram cuts, so training with `hist` never copies the raw data.
+ *   The CSR page is materialized only when some other algorithm asks for it.  The parent
+ *   is kept alive by the view.
+ */
+class SliceDMatrix : public DMatrix {
+  std::shared_ptr<DMatrix> parent_;
+  std::vector<int32_t> ridxs_;
+  MetaInfo info_;
+
+  std::shared_ptr<SparsePage> sparse_page_{nullptr};
+  std::shared_ptr<CSCPage> column_page_{nullptr};
+  std::shared_ptr<SortedCSCPage> sorted_column_page_{nullptr};
+  std::shared_ptr<EllpackPage> ellpack_page_{nullptr};
+  std::shared_ptr<GHistIndexMatrix> gradient_index_{nullptr};
+  BatchParam batch_param_;
+  BatchParam ellpack_param_;
+  std::mutex gradient_index_lock_;
+
+ public:
+  SliceDMatrix(std::shared_ptr<DMatrix> parent, common::Span<int32_t const> ridxs);
+  ~SliceDMatrix() override = default;
+
+  MetaInfo& Info() override { return info_; }
+  MetaInfo const& Info() const override { return info_; }
+  bool SingleColBlock() const override { return true; }
+  /*! \brief Slicing a view creates another view of the same parent. */
+  DMatrix* Slice(common::Span<int32_t const> ridxs) override;
+
+  std::shared_ptr<DMatrix> Parent() const { return parent_; }
+  common::Span<int32_t const> RowIndices() const { return ridxs_; }
+
+ private:
+  BatchSet<SparsePage> GetRowBatches() override;
+  BatchSet<CSCPage> GetColumnBatches() override;
+  BatchSet<SortedCSCPage> GetSortedColumnBatches() override;
+  BatchSet<EllpackPage> GetEllpackBatches(const BatchParam& param) override;
+  BatchSet<GHistIndexMatrix> GetGradientIndex(const BatchParam& param) override;
+
+  bool EllpackExists() const override { return static_cast<bool>(ellpack_page_); }
+  bool SparsePageExists() const override { return static_cast<bool>(sparse_page_); }
+  /**
+   * The gradient index of parent can be gathered without touching raw data, so it's
+   * considered available.
+   */
+  bool GHistIndexExists() const override {
+    return static_cast<bool>(gradient_index_) || parent_->PageExists<GHistIndexMatrix>();
+  }
+};
+}  // namespace data
+}  // namespace xgboost
+#endif  // XGBOOST_DATA_SLICE_DMATRIX_H_
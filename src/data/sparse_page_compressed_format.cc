@@ -0,0 +1,90 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file sparse_page_compressed_format.cc
+ *  Compressed binary format of sparse page, trading CPU time for smaller cache files.
+ */
+#include <xgboost/data.h>
+#include <dmlc/registry.h>
+
+#include <vector>
+
+#include "xgboost/logging.h"
+#include "./sparse_page_writer.h"
+#include "../common/compression.h"
+
+namespace xgboost {
+namespace data {
+
+DMLC_REGISTRY_FILE_TAG(sparse_page_compressed_format);
+
+/**
+ * \brief Row offsets and feature indices are delta encoded, feature values are compressed
+ *        with LZ.  Indices and values are stored separately as they compress differently.
+ */
+template<typename T>
+class SparsePageCompressedFormat : public SparsePageFormat<T> {
+ public:
+  bool Read(T* page, dmlc::SeekStream* fi) override {
+    auto& offset_vec = page->offset.HostVector();
+    if (!common::ReadBlock(fi, &offset_vec)) {
+      return false;
+    }
+    CHECK_NE(offset_vec.size(), 0U) << "Invalid SparsePage file";
+    std::vector<bst_feature_t> index;
+    std::vector<float> fvalue;
+    CHECK(common::ReadBlock(fi, &index)) << "Invalid SparsePage file";
+    CHECK(common::ReadBlock(fi, &fvalue)) << "Invalid SparsePage file";
+    CHECK_EQ(index.size(), offset_vec.back()) << "Invalid SparsePage file";
+    CHECK_EQ(fvalue.size(), index.size()) << "Invalid SparsePage file";
+    auto& data_vec = page->data.HostVector();
+    data_vec.resize(index.size());
+    for (size_t i = 0; i < data_vec.size(); ++i) {
+      data_vec[i] = Entry{index[i], fvalue[i]};
+    }
+    CHECK_EQ(fi->Read(&page->base_rowid, sizeof(page->base_rowid)), sizeof(page->base_rowid))
+        << "Invalid SparsePage file";
+    return true;
+  }
+
+  size_t Write(const T& page, dmlc::Stream* fo) override {
+    const auto& offset_vec = page.offset.HostVector();
+    const auto& data_vec = page.data.HostVector();
+    CHECK(page.offset.Size() != 0 && offset_vec[0] == 0);
+    CHECK_EQ(offset_vec.back(), page.data.Size());
+    size_t bytes = common::WriteIntegerBlock(common::BlockCodec::kDeltaVarint,
+                                             common::Span<bst_row_t const>{offset_vec}, fo);
+    std::vector<bst_feature_t> index(data_vec.size());
+    std::vector<float> fvalue(data_vec.size());
+    for (size_t i = 0; i < data_vec.size(); ++i) {
+      index[i] = data_vec[i].index;
+      fvalue[i] = data_vec[i].fvalue;
+    }
+    bytes += common::WriteIntegerBlock(common::BlockCodec::kDeltaVarint,
+                                       common::Span<bst_feature_t const>{index}, fo);
+    bytes += common::WriteBlock(common::BlockCodec::kLZ, common::Span<float const>{fvalue}, fo);
+    fo->Write(&page.base_rowid, sizeof(page.base_rowid));
+    bytes += sizeof(page.base_rowid);
+    return bytes;
+  }
+};
+
+XGBOOST_REGISTER_SPARSE_PAGE_FORMAT(compressed)
+.describe("Compressed binary data format.")
+.set_body([]() {
+    return new SparsePageCompressedFormat<SparsePage>();
+  });
+
+XGBOOST_REGISTER_CSC_PAGE_FORMAT(compressed)
+.describe("Compressed binary data format.")
+.set_body([]() {
+    return new SparsePageCompressedFormat<CSCPage>();
+  });
+
+XGBOOST_REGISTER_SORTED_CSC_PAGE_FORMAT(compressed)
+.describe("Compressed binary data format.")
+.set_body([]() {
+    return new SparsePageCompressedFormat<SortedCSCPage>();
+  });
+
+}  // namespace data
+}  // namespace xgboost
@@ -5,8 +5,13 @@
  * \author Tianqi Chen
  */
 #include "./sparse_page_dmatrix.h"
+
+#include <cstdio>
+
 #include "./simple_batch_iterator.h"
 #include "gradient_index.h"
+#include "gradient_index_format.h"
+#include "../common/io.h"
 
 namespace xgboost {
 namespace data {
@@ -15,41 +20,37 @@ MetaInfo &SparsePageDMatrix::Info() { return info_; }
 
 const MetaInfo &SparsePageDMatrix::Info() const { return info_; }
 
+#if !defined(XGBOOST_USE_CUDA)
 namespace detail {
 // Use device dispatch
-size_t NSamplesDevice(DMatrixProxy *proxy)
-#if defined(XGBOOST_USE_CUDA)
-;  // NOLINT
-#else
-{
+size_t NSamplesDevice(DMatrixProxy *proxy) {
   common::AssertGPUSupport();
   return 0;
 }
-#endif
-size_t NFeaturesDevice(DMatrixProxy *proxy)
-#if defined(XGBOOST_USE_CUDA)
-;  // NOLINT
-#else
-{
+size_t NFeaturesDevice(DMatrixProxy *proxy) {
   common::AssertGPUSupport();
   return 0;
 }
-#endif
 }  // namespace detail
+#endif  // !defined(XGBOOST_USE_CUDA)
 
 
 SparsePageDMatrix::SparsePageDMatrix(DataIterHandle iter_handle, DMatrixHandle proxy_handle,
                                      DataIterResetCallback *reset,
                                      XGDMatrixCallbackNext *next, float missing,
-                                     int32_t nthreads, std::string cache_prefix)
+                                     int32_t nthreads, std::string cache_prefix,
+                                     std::string page_format, size_t prefetch_batches,
+                                     bool quantized_checkpoint)
     : proxy_{proxy_handle}, iter_{iter_handle}, reset_{reset}, next_{next}, missing_{missing},
-      cache_prefix_{std::move(cache_prefix)} {
+      cache_prefix_{std::move(cache_prefix)}, page_format_{std::move(page_format)},
+      prefetch_batches_{prefetch_batches}, quantized_checkpoint_{quantized_checkpoint} {
   ctx_.nthread = nthreads;
+  CHECK(page_format_ == "raw" || page_format_ == "compressed")
+      << "Unknown page format: " << page_format_;
   cache_prefix_ = cache_prefix_.empty() ? "DMatrix" : cache_prefix_;
   if (rabit::IsDistributed()) {
     cache_prefix_ += ("-r" + std::to_string(rabit::GetRank()));
   }
-  DMatrixProxy *proxy = MakeProxy(proxy_);
   auto iter = DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext>{
       iter_, reset_, next_};
 
@@ -58,31 +59,15 @@ SparsePageDMatrix::SparsePageDMatrix(DataIterHandle iter_handle, DMatrixHandle p
   size_t n_samples = 0;
   size_t nnz = 0;
 
-  auto num_rows = [&]() {
-    bool type_error {false};
-    size_t n_samples = HostAdapterDispatch(
-        proxy, [](auto const &value) { return value.NumRows(); }, &type_error);
-    if (type_error) {
-      n_samples = detail::NSamplesDevice(proxy);
-    }
-    return n_samples;
-  };
-  auto num_cols = [&]() {
-    bool type_error {false};
-    size_t n_features = HostAdapterDispatch(
-        proxy, [](auto const &value) { return value.NumCols(); }, &type_error);
-    if (type_error) {
-      n_features = detail::NFeaturesDevice(proxy);
-    }
-    return n_features;
-  };
-
-  // the proxy is iterated together with the sparse page source so we can obtain all
-  // information in 1 pass.
+  // the iterator is consumed together with the sparse page source so we can obtain all
+  // information in 1 pass.  Meta info is taken from the batch of each page as the proxy
+  // might be ahead of the source.
   for (auto const &page : this->GetRowBatchesImpl()) {
-    this->info_.Extend(std::move(proxy->Info()), false, false);
-    n_features = std::max(n_features, num_cols());
-    n_samples += num_rows();
+    auto *batch = sparse_page_source_->Batch();
+    CHECK(batch);
+    this->info_.Extend(std::move(batch->info), false, false);
+    n_features = std::max(n_features, batch->n_features);
+    n_samples += page.Size();
     nnz += page.data.Size();
     n_batches++;
   }
@@ -99,7 +84,7 @@ SparsePageDMatrix::SparsePageDMatrix(DataIterHandle iter_handle, DMatrixHandle p
 }
 
 void SparsePageDMatrix::InitializeSparsePage() {
-  auto id = MakeCache(this, ".row.page", cache_prefix_, &cache_info_);
+  auto id = MakeCache(this, ".row.page", cache_prefix_, page_format_, &cache_info_);
   // Don't use proxy DMatrix once this is already initialized, this allows users to
   // release the iterator and data.
   if (cache_info_.at(id)->written) {
@@ -114,7 +99,7 @@ void SparsePageDMatrix::InitializeSparsePage() {
   sparse_page_source_.reset();  // clear before creating new one to prevent conflicts.
   sparse_page_source_ = std::make_shared<SparsePageSource>(
       iter, proxy, this->missing_, this->ctx_.Threads(), this->info_.num_col_,
-      this->n_batches_, cache_info_.at(id));
+      this->n_batches_, cache_info_.at(id), prefetch_batches_);
 }
 
 BatchSet<SparsePage> SparsePageDMatrix::GetRowBatchesImpl() {
@@ -128,7 +113,7 @@ BatchSet<SparsePage> SparsePageDMatrix::GetRowBatches() {
 }
 
 BatchSet<CSCPage> SparsePageDMatrix::GetColumnBatches() {
-  auto id = MakeCache(this, ".col.page", cache_prefix_, &cache_info_);
+  auto id = MakeCache(this, ".col.page", cache_prefix_, page_format_, &cache_info_);
   CHECK_NE(this->Info().num_col_, 0);
   this->InitializeSparsePage();
   if (!column_source_) {
@@ -143,7 +128,7 @@ BatchSet<CSCPage> SparsePageDMatrix::GetColumnBatches() {
 }
 
 BatchSet<SortedCSCPage> SparsePageDMatrix::GetSortedColumnBatches() {
-  auto id = MakeCache(this, ".sorted.col.page", cache_prefix_, &cache_info_);
+  auto id = MakeCache(this, ".sorted.col.page", cache_prefix_, page_format_, &cache_info_);
   CHECK_NE(this->Info().num_col_, 0);
   this->InitializeSparsePage();
   if (!sorted_column_source_) {
@@ -158,14 +143,19 @@ BatchSet<SortedCSCPage> SparsePageDMatrix::GetSortedColumnBatches() {
 }
 
 BatchSet<GHistIndexMatrix> SparsePageDMatrix::GetGradientIndex(const BatchParam& param) {
-  CHECK_GE(param.max_bin, 2);
   if (param.hess.empty()) {
     // hist method doesn't support full external memory implementation, so we concatenate
     // all index here.
     if (!ghist_index_page_ || (param != batch_param_ && param != BatchParam{})) {
-      this->InitializeSparsePage();
-      ghist_index_page_.reset(new GHistIndexMatrix{this, param.max_bin});
-      this->InitializeSparsePage();
+      CHECK_GE(param.max_bin, 2);
+      if (!quantized_checkpoint_ || !this->LoadGHistIndexCheckpoint(param)) {
+        this->InitializeSparsePage();
+        ghist_index_page_.reset(new GHistIndexMatrix{this, param});
+        this->InitializeSparsePage();
+        if (quantized_checkpoint_) {
+          this->SaveGHistIndexCheckpoint(param);
+        }
+      }
       batch_param_ = param;
     }
     auto begin_iter = BatchIterator<GHistIndexMatrix>(
@@ -173,22 +163,27 @@ BatchSet<GHistIndexMatrix> SparsePageDMatrix::GetGradientIndex(const BatchParam&
     return BatchSet<GHistIndexMatrix>(begin_iter);
   }
 
-  auto id = MakeCache(this, ".gradient_index.page", cache_prefix_, &cache_info_);
+  CHECK_GE(param.max_bin, 2);
+  auto id =
+      MakeCache(this, ".gradient_index.page", cache_prefix_, page_format_, &cache_info_);
   this->InitializeSparsePage();
   if (!cache_info_.at(id)->written || (batch_param_ != param && param != BatchParam{})) {
     cache_info_.erase(id);
-    MakeCache(this, ".gradient_index.page", cache_prefix_, &cache_info_);
-    auto cuts = common::SketchOnDMatrix(this, param.max_bin, param.hess);
+    MakeCache(this, ".gradient_index.page", cache_prefix_, page_format_, &cache_info_);
+    auto cuts = common::SketchOnDMatrix(this, param.max_bin, param.hess,
+                                        param.sketch_sample_rows, param.feature_max_bin,
+                                        param.max_total_bins);
     this->InitializeSparsePage();  // reset after use.
 
     batch_param_ = param;
     ghist_index_source_.reset();
     CHECK_NE(cuts.Values().size(), 0);
     auto ft = this->info_.feature_types.ConstHostSpan();
+    auto max_num_bins = GHistIndexMatrix::MaxNumBins(param, cuts);
     ghist_index_source_.reset(new GradientIndexPageSource(
         this->missing_, this->ctx_.Threads(), this->Info().num_col_,
         this->n_batches_, cache_info_.at(id), param, std::move(cuts),
-        this->IsDense(), param.max_bin, ft, sparse_page_source_));
+        this->IsDense(), max_num_bins, ft, sparse_page_source_));
   } else {
     CHECK(ghist_index_source_);
     ghist_index_source_->Reset();
@@ -197,6 +192,69 @@ BatchSet<GHistIndexMatrix> SparsePageDMatrix::GetGradientIndex(const BatchParam&
   return BatchSet<GHistIndexMatrix>(BatchIterator<GHistIndexMatrix>(begin_iter));
 }
 
+namespace {
+constexpr int32_t kCheckpointMagic = 0xffffab03;
+
+// Everything the gradient index depends on other than the data itself.
+void WriteCheckpointHeader(MetaInfo const &info, BatchParam const &param, dmlc::Stream *fo) {
+  fo->Write(kCheckpointMagic);
+  fo->Write(static_cast<int32_t>(rabit::GetWorldSize()));
+  fo->Write(static_cast<uint64_t>(info.num_row_));
+  fo->Write(static_cast<uint64_t>(info.num_col_));
+  fo->Write(static_cast<uint64_t>(info.num_nonzero_));
+  fo->Write(static_cast<int32_t>(param.max_bin));
+  fo->Write(static_cast<uint64_t>(param.sketch_sample_rows));
+  fo->Write(param.feature_max_bin);
+  fo->Write(static_cast<uint64_t>(param.max_total_bins));
+  fo->Write(param.pack_bins);
+}
+}  // anonymous namespace
+
+bool SparsePageDMatrix::LoadGHistIndexCheckpoint(BatchParam const &param) {
+  auto name = this->CheckpointName();
+  std::unique_ptr<dmlc::Stream> fi{dmlc::Stream::Create(name.c_str(), "r", true)};
+  std::shared_ptr<GHistIndexMatrix> page;
+  if (fi) {
+    // Compare the header byte by byte with the one expected for the current data.
+    std::string expected;
+    {
+      common::MemoryBufferStream fo{&expected};
+      WriteCheckpointHeader(this->Info(), param, &fo);
+    }
+    std::string header(expected.size(), '\0');
+    page = std::make_shared<GHistIndexMatrix>();
+    if (fi->Read(&header[0], header.size()) != header.size() || header != expected ||
+        !ReadGHistIndex(page.get(), fi.get()) || page->Size() != this->Info().num_row_) {
+      LOG(WARNING) << "Ignoring invalid or outdated quantized checkpoint: " << name;
+      page.reset();
+    }
+  }
+  int32_t valid = static_cast<bool>(page);
+  rabit::Allreduce<rabit::op::Min>(&valid, 1);
+  if (!valid) {
+    return false;
+  }
+  LOG(INFO) << "Loaded quantized checkpoint: " << name;
+  page->p_fmat = this;
+  ghist_index_page_ = std::move(page);
+  return true;
+}
+
+void SparsePageDMatrix::SaveGHistIndexCheckpoint(BatchParam const &param) const {
+  CHECK(ghist_index_page_);
+  // Write to a temporary file first so a failure in the middle doesn't leave a truncated
+  // checkpoint behind.
+  auto name = this->CheckpointName();
+  auto tmp = name + ".tmp";
+  {
+    std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(tmp.c_str(), "w")};
+    WriteCheckpointHeader(this->Info(), param, fo.get());
+    WriteGHistIndex(*ghist_index_page_, fo.get());
+  }
+  CHECK_EQ(std::rename(tmp.c_str(), name.c_str()), 0)
+      << "Failed to write quantized checkpoint: " << name;
+}
+
 #if !defined(XGBOOST_USE_CUDA)
 BatchSet<EllpackPage> SparsePageDMatrix::GetEllpackBatches(const BatchParam& param) {
   common::AssertGPUSupport();
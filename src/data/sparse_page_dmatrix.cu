@@ -11,13 +11,13 @@ namespace data {
 BatchSet<EllpackPage> SparsePageDMatrix::GetEllpackBatches(const BatchParam& param) {
   CHECK_GE(param.gpu_id, 0);
   CHECK_GE(param.max_bin, 2);
-  auto id = MakeCache(this, ".ellpack.page", cache_prefix_, &cache_info_);
+  auto id = MakeCache(this, ".ellpack.page", cache_prefix_, "raw", &cache_info_);
   size_t row_stride = 0;
   this->InitializeSparsePage();
   if (!cache_info_.at(id)->written || (batch_param_ != param && param != BatchParam{})) {
     // reinitialize the cache
     cache_info_.erase(id);
-    MakeCache(this, ".ellpack.page", cache_prefix_, &cache_info_);
+    MakeCache(this, ".ellpack.page", cache_prefix_, "raw", &cache_info_);
     std::unique_ptr<common::HistogramCuts> cuts;
     cuts.reset(new common::HistogramCuts{
         common::DeviceSketch(param.gpu_id, this, param.max_bin, 0)});
@@ -71,17 +71,33 @@ class SparsePageDMatrix : public DMatrix {
   float missing_;
   GenericParameter ctx_;
   std::string cache_prefix_;
+  std::string page_format_;
+  // Number of batches read ahead from the iterator while the cache is being written.
+  size_t prefetch_batches_ {0};
+  // Keep the concatenated gradient index for hist in a file that outlives this DMatrix.
+  bool quantized_checkpoint_ {false};
   uint32_t n_batches_ {0};
   // sparse page is the source to other page types, we make a special member function.
   void InitializeSparsePage();
   // Non-virtual version that can be used in constructor
   BatchSet<SparsePage> GetRowBatchesImpl();
 
+  std::string CheckpointName() const { return cache_prefix_ + ".gradient_index.ckpt"; }
+  /**
+   * \brief Load the gradient index from checkpoint if it's built with the same parameter
+   *        on the same data.  In distributed training all workers must load, otherwise
+   *        none of them does as the cuts are sketched together.
+   */
+  bool LoadGHistIndexCheckpoint(BatchParam const &param);
+  void SaveGHistIndexCheckpoint(BatchParam const &param) const;
+
  public:
   explicit SparsePageDMatrix(DataIterHandle iter, DMatrixHandle proxy,
                              DataIterResetCallback *reset,
                              XGDMatrixCallbackNext *next, float missing,
-                             int32_t nthreads, std::string cache_prefix);
+                             int32_t nthreads, std::string cache_prefix,
+                             std::string page_format = "raw", size_t prefetch_batches = 0,
+                             bool quantized_checkpoint = false);
 
   ~SparsePageDMatrix() override {
     // Clear out all resources before deleting the cache file.
@@ -129,6 +145,9 @@ class SparsePageDMatrix : public DMatrix {
   bool SparsePageExists() const override {
     return static_cast<bool>(sparse_page_source_);
   }
+  bool GHistIndexExists() const override {
+    return static_cast<bool>(ghist_index_page_);
+  }
 };
 
 inline std::string MakeId(std::string prefix, SparsePageDMatrix *ptr) {
@@ -139,13 +158,13 @@ inline std::string MakeId(std::string prefix, SparsePageDMatrix *ptr) {
 
 inline std::string
 MakeCache(SparsePageDMatrix *ptr, std::string format, std::string prefix,
-          std::map<std::string, std::shared_ptr<Cache>> *out) {
+          std::string page_format, std::map<std::string, std::shared_ptr<Cache>> *out) {
   auto &cache_info = *out;
   auto name = MakeId(prefix, ptr);
   auto id = name + format;
   auto it = cache_info.find(id);
   if (it == cache_info.cend()) {
-    cache_info[id].reset(new Cache{false, name, format});
+    cache_info[id].reset(new Cache{false, name, format, page_format});
     LOG(INFO) << "Make cache:" << cache_info[id]->ShardName() << std::endl;
   }
   return id;
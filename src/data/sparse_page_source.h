@@ -6,6 +6,9 @@
 #define XGBOOST_DATA_SPARSE_PAGE_SOURCE_H_
 
 #include <algorithm>  // std::min
+#include <atomic>
+#include <cmath>
+#include <deque>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,6 +26,11 @@
 #include "proxy_dmatrix.h"
 
 #include "../common/common.h"
+#include "../common/io.h"
+#include "../common/memory_tracker.h"
+#include "../common/perf_counters.h"
+#include "../common/threadpool.h"
+#include "../common/timer.h"
 
 namespace xgboost {
 namespace data {
@@ -38,11 +46,14 @@ struct Cache {
   bool written;
   std::string name;
   std::string format;
+  // name of the registered page format used to encode pages, like "raw" or "compressed".
+  std::string page_format;
   // offset into binary cache file.
   std::vector<size_t> offset;
 
-  Cache(bool w, std::string n, std::string fmt)
-      : written{w}, name{std::move(n)}, format{std::move(fmt)} {
+  Cache(bool w, std::string n, std::string fmt, std::string page_fmt = "raw")
+      : written{w}, name{std::move(n)}, format{std::move(fmt)},
+        page_format{std::move(page_fmt)} {
     offset.push_back(0);
   }
 
@@ -77,6 +88,56 @@ class TryLockGuard {
   }
 };
 
+/**
+ * \brief Choose the number of pre-fetched pages.  The depth is enough to hide the time of
+ *        reading a page behind the time consumer spends on pages, and is bounded by the
+ *        available memory.
+ */
+class PrefetchScheduler {
+  // moving averages in seconds.
+  double read_{0};
+  double consume_{0};
+  bool measured_{false};
+
+ public:
+  // Used before any measurement is available.
+  static uint32_t constexpr kDefaultDepth = 4;
+  static uint32_t constexpr kMaxDepth = 32;
+  // Only use this fraction of available memory for pre-fetched pages.
+  static double constexpr kMemoryFraction = 0.5;
+
+  void Update(double read_seconds, double consume_seconds) {
+    double constexpr kDecay = 0.7;
+    if (!measured_) {
+      read_ = read_seconds;
+      consume_ = consume_seconds;
+      measured_ = true;
+    } else {
+      read_ = kDecay * read_ + (1.0 - kDecay) * read_seconds;
+      consume_ = kDecay * consume_ + (1.0 - kDecay) * consume_seconds;
+    }
+  }
+
+  /**
+   * \param n_batches   Total number of pages.
+   * \param page_bytes  Average size of a page.
+   * \param avail_bytes Available memory.
+   */
+  uint32_t Depth(uint32_t n_batches, size_t page_bytes, size_t avail_bytes) const {
+    double depth = kDefaultDepth;
+    if (measured_) {
+      // One more page for the one being consumed.
+      depth = std::ceil(read_ / std::max(consume_, 1e-6)) + 1.0;
+    }
+    depth = std::min(depth, static_cast<double>(kMaxDepth));
+    if (page_bytes != 0) {
+      depth = std::min(depth, std::floor(avail_bytes * kMemoryFraction / page_bytes));
+    }
+    depth = std::min(depth, static_cast<double>(n_batches));
+    return std::max(static_cast<uint32_t>(depth), 1u);
+  }
+};
+
 template <typename S>
 class SparsePageSourceImpl : public BatchIteratorImpl<S> {
  protected:
@@ -96,11 +157,23 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
 
   std::shared_ptr<Cache> cache_info_;
   std::unique_ptr<dmlc::Stream> fo_;
+  // Mapped cache file for reading local cache without system calls.
+  std::unique_ptr<common::MmapFile> mmap_;
+
+  // Threads for reading pages, created on first read.
+  std::unique_ptr<common::ThreadPool> io_pool_;
+  PrefetchScheduler prefetch_;
+  // Time for reading each page in the ring, written by the I/O threads.
+  std::vector<double> read_seconds_;
+  // Measures time spent by consumer between two reads.
+  common::Timer consume_timer_;
 
   using Ring = std::vector<std::future<std::shared_ptr<S>>>;
   // A ring storing futures to data.  Since the DMatrix iterator is forward only, so we
   // can pre-fetch data in a ring.
   std::unique_ptr<Ring> ring_{new Ring};
+  // Pages held by the ring, estimated by their size in the cache file.
+  common::TrackedBytes ring_bytes_{common::MemoryTracker::kPageRing};
 
   bool ReadCache() {
     CHECK(!at_end_);
@@ -111,42 +184,81 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
       fo_.reset();  // flush the data to disk.
       ring_->resize(n_batches_);
     }
-    // An heuristic for number of pre-fetched batches.  We can make it part of BatchParam
-    // to let user adjust number of pre-fetched batches when needed.
-    uint32_t constexpr kPreFetch = 4;
-
-    size_t n_prefetch_batches = std::min(kPreFetch, n_batches_);
-    CHECK_GT(n_prefetch_batches, 0) << "total batches:" << n_batches_;
+    if (!mmap_ && common::MmapFile::Supported(cache_info_->ShardName())) {
+      mmap_.reset(new common::MmapFile{cache_info_->ShardName()});
+    }
+    if (!io_pool_) {
+      uint32_t constexpr kIOThreads = 4;
+      auto n_threads = std::min(kIOThreads, std::max(std::thread::hardware_concurrency(), 1u));
+      io_pool_.reset(new common::ThreadPool(static_cast<int32_t>(n_threads)));
+      read_seconds_.resize(n_batches_, 0.0);
+    }
+    if (count_ != 0) {
+      // The previous page has been read and consumed.
+      consume_timer_.Stop();
+      prefetch_.Update(read_seconds_.at(count_ - 1), consume_timer_.ElapsedSeconds());
+    }
+    CHECK_GT(n_batches_, 0);
+    size_t page_bytes = cache_info_->offset.back() / n_batches_;
+    size_t n_prefetch_batches =
+        prefetch_.Depth(n_batches_, page_bytes, common::AvailableHostMemory());
     size_t fetch_it = count_;
     for (size_t i = 0; i < n_prefetch_batches; ++i, ++fetch_it) {
       fetch_it %= n_batches_;  // ring
       if (ring_->at(fetch_it).valid()) { continue; }
       auto const *self = this;  // make sure it's const
       CHECK_LT(fetch_it, cache_info_->offset.size());
-      ring_->at(fetch_it) = std::async(std::launch::async, [fetch_it, self]() {
-        std::unique_ptr<SparsePageFormat<S>> fmt{CreatePageFormat<S>("raw")};
+      double *p_seconds = &read_seconds_[fetch_it];
+      ring_->at(fetch_it) = io_pool_->Submit([fetch_it, self, p_seconds]() {
+        common::Timer timer;
+        timer.Start();
+        // Decoding happens here, off the training thread.
+        std::unique_ptr<SparsePageFormat<S>> fmt{
+            CreatePageFormat<S>(self->cache_info_->page_format)};
         auto n = self->cache_info_->ShardName();
         size_t offset = self->cache_info_->offset.at(fetch_it);
-        std::unique_ptr<dmlc::SeekStream> fi{
-            dmlc::SeekStream::CreateForRead(n.c_str())};
-        fi->Seek(offset);
-        CHECK_EQ(fi->Tell(), offset);
+        std::unique_ptr<dmlc::SeekStream> fi;
+        if (self->mmap_) {
+          size_t end = self->cache_info_->offset.at(fetch_it + 1);
+          CHECK_LE(end, self->mmap_->Size()) << "Invalid cache file: " << n;
+          // The buffer is only read from.
+          auto ptr = const_cast<char*>(self->mmap_->Data()) + offset;
+          fi.reset(new common::MemoryFixSizeBuffer{ptr, end - offset});
+        } else {
+          fi.reset(dmlc::SeekStream::CreateForRead(n.c_str()));
+          fi->Seek(offset);
+          CHECK_EQ(fi->Tell(), offset);
+        }
         auto page = std::make_shared<S>();
         CHECK(fmt->Read(page.get(), fi.get()));
+        common::PerfCounters::Get()->Add(common::PerfCounters::kPagesRead);
+        self->PostRead(page.get());
+        timer.Stop();
+        *p_seconds = timer.ElapsedSeconds();
         return page;
       });
     }
-    CHECK_EQ(std::count_if(ring_->cbegin(), ring_->cend(),
+    // Pages fetched with a deeper ring before the depth is reduced are still valid.
+    CHECK_GE(std::count_if(ring_->cbegin(), ring_->cend(),
                            [](auto const &f) { return f.valid(); }),
              n_prefetch_batches)
         << "Sparse DMatrix assumes forward iteration.";
+    CHECK(ring_->at(count_).valid()) << "Sparse DMatrix assumes forward iteration.";
     page_ = (*ring_)[count_].get();
+    consume_timer_.Reset();
+    size_t ring_bytes = cache_info_->offset.at(count_ + 1) - cache_info_->offset.at(count_);
+    for (size_t i = 0; i < ring_->size(); ++i) {
+      if (ring_->at(i).valid()) {
+        ring_bytes += cache_info_->offset.at(i + 1) - cache_info_->offset.at(i);
+      }
+    }
+    ring_bytes_.Update(ring_bytes);
     return true;
   }
 
   void WriteCache() {
     CHECK(!cache_info_->written);
-    std::unique_ptr<SparsePageFormat<S>> fmt{CreatePageFormat<S>("raw")};
+    std::unique_ptr<SparsePageFormat<S>> fmt{CreatePageFormat<S>(cache_info_->page_format)};
     if (!fo_) {
       auto n = cache_info_->ShardName();
       fo_.reset(dmlc::Stream::Create(n.c_str(), "w"));
@@ -156,6 +268,17 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
   }
 
   virtual void Fetch() = 0;
+  // Called by the I/O threads after a page is read from cache, the read time includes it.
+  virtual void PostRead(S*) const {}
+  // Wait for all pending reads.  Sources overriding PostRead must call it in their own
+  // destructor.
+  void WaitPrefetch() {
+    for (auto& fu : *ring_) {
+      if (fu.valid()) {
+        fu.get();
+      }
+    }
+  }
 
  public:
   SparsePageSourceImpl(float missing, int nthreads, bst_feature_t n_features,
@@ -166,11 +289,7 @@ class SparsePageSourceImpl : public BatchIteratorImpl<S> {
   SparsePageSourceImpl(SparsePageSourceImpl const &that) = delete;
 
   ~SparsePageSourceImpl() override {
-    for (auto& fu : *ring_) {
-      if (fu.valid()) {
-        fu.get();
-      }
-    }
+    this->WaitPrefetch();
   }
 
   uint32_t Iter() const { return count_; }
@@ -204,22 +323,139 @@ inline void DevicePush(DMatrixProxy* proxy, float missing, SparsePage* page) {
 }
 #endif
 
-class SparsePageSource : public SparsePageSourceImpl<SparsePage> {
+/**
+ * \brief A batch from the external iterator, copied out of the proxy DMatrix so that the
+ *        iterator can move on to the next batch while this one is being processed.
+ */
+struct IterBatch {
+  // Data of the batch, with empty rows at the end included.  Base row id is not set.
+  std::shared_ptr<SparsePage> page{std::make_shared<SparsePage>()};
+  // Meta info set on the proxy, moved out of it.
+  MetaInfo info;
+  size_t n_features{0};
+};
+
+/**
+ * \brief Consume an external data iterator, optionally reading up to `depth` batches ahead
+ *        of the consumer on a background thread.
+ *
+ *   With a positive depth, the `reset` and `next` callbacks are invoked from a single
+ *   thread owned by the pipeline instead of the thread constructing the DMatrix.  The
+ *   callbacks are never called concurrently, and the data set on the proxy in `next` is
+ *   copied before the next call, so it only needs to stay valid until then.
+ */
+class BatchPipeline {
   DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext> iter_;
   DMatrixProxy* proxy_;
+  float missing_;
+  int32_t n_threads_;
+  size_t depth_;
+
+  std::unique_ptr<common::ThreadPool> producer_;
+  // Batches being read, in the order of iteration.
+  std::deque<std::future<std::shared_ptr<IterBatch>>> queue_;
+  // Only accessed by the producer, which runs one task at a time.
+  bool exhausted_{false};
+  std::atomic<bool> cancelled_{false};
+
+  std::shared_ptr<IterBatch> Produce() {
+    if (exhausted_ || cancelled_) {
+      return nullptr;
+    }
+    if (!iter_.Next()) {
+      exhausted_ = true;
+      return nullptr;
+    }
+    auto batch = std::make_shared<IterBatch>();
+    batch->info = std::move(proxy_->Info());
+    bool type_error{false};
+    size_t n_samples = HostAdapterDispatch(
+        proxy_,
+        [&](auto const& adapter_batch) {
+          batch->n_features = adapter_batch.NumCols();
+          batch->page->Push(adapter_batch, missing_, n_threads_);
+          return adapter_batch.NumRows();
+        },
+        &type_error);
+    if (type_error) {
+      n_samples = detail::NSamplesDevice(proxy_);
+      batch->n_features = detail::NFeaturesDevice(proxy_);
+      DevicePush(proxy_, missing_, batch->page.get());
+    }
+    // Trailing empty rows are not pushed.
+    auto& offset = batch->page->offset.HostVector();
+    CHECK_LE(offset.size(), n_samples + 1);
+    offset.resize(n_samples + 1, offset.back());
+    return batch;
+  }
+  // Wait for pending reads of the current pass.
+  void Drain() {
+    for (auto& fu : queue_) {
+      fu.wait();
+    }
+    queue_.clear();
+  }
+
+ public:
+  BatchPipeline(DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext> iter,
+                DMatrixProxy* proxy, float missing, int32_t n_threads, size_t depth)
+      : iter_{iter}, proxy_{proxy}, missing_{missing}, n_threads_{n_threads}, depth_{depth} {
+    CHECK(proxy_);
+    if (depth_ != 0) {
+      producer_.reset(new common::ThreadPool{1});
+    }
+  }
+  BatchPipeline(BatchPipeline const& that) = delete;
+  ~BatchPipeline() {
+    cancelled_ = true;
+    this->Drain();
+  }
+
+  /*! \brief Start a new pass over the iterator. */
+  void Reset() {
+    this->Drain();
+    if (!producer_) {
+      iter_.Reset();
+      exhausted_ = false;
+      return;
+    }
+    producer_->Submit([this] {
+      iter_.Reset();
+      exhausted_ = false;
+    }).get();
+  }
+  /*! \brief Next batch of the current pass, nullptr at the end. */
+  std::shared_ptr<IterBatch> Next() {
+    if (!producer_) {
+      return this->Produce();
+    }
+    if (queue_.empty()) {
+      // Start reading ahead on the first call after reset.
+      for (size_t i = 0; i < depth_; ++i) {
+        queue_.emplace_back(producer_->Submit([this] { return this->Produce(); }));
+      }
+    }
+    auto fu = std::move(queue_.front());
+    queue_.pop_front();
+    // Keep `depth` batches in flight while the consumer works on this one.
+    queue_.emplace_back(producer_->Submit([this] { return this->Produce(); }));
+    return fu.get();
+  }
+};
+
+class SparsePageSource : public SparsePageSourceImpl<SparsePage> {
+  BatchPipeline pipeline_;
+  // Current batch from the iterator, null once the cache is written.
+  std::shared_ptr<IterBatch> batch_;
+  bool use_iter_ {true};
   size_t base_row_id_ {0};
 
   void Fetch() final {
     page_ = std::make_shared<SparsePage>();
     if (!this->ReadCache()) {
-      bool type_error { false };
-      CHECK(proxy_);
-      HostAdapterDispatch(proxy_, [&](auto const &adapter_batch) {
-        page_->Push(adapter_batch, this->missing_, this->nthreads_);
-      }, &type_error);
-      if (type_error) {
-        DevicePush(proxy_, missing_, page_.get());
-      }
+      CHECK(use_iter_);
+      CHECK(batch_);
+      page_ = batch_->page;
       page_->SetBaseRowId(base_row_id_);
       base_row_id_ += page_->Size();
       n_batches_++;
@@ -228,26 +464,36 @@ class SparsePageSource : public SparsePageSourceImpl<SparsePage> {
   }
 
  public:
+  /**
+   * \param prefetch_batches Number of batches read ahead from the iterator on a background
+   *        thread while writing the cache, 0 to read them synchronously.
+   */
   SparsePageSource(
       DataIterProxy<DataIterResetCallback, XGDMatrixCallbackNext> iter,
       DMatrixProxy *proxy, float missing, int nthreads,
-      bst_feature_t n_features, uint32_t n_batches, std::shared_ptr<Cache> cache)
+      bst_feature_t n_features, uint32_t n_batches, std::shared_ptr<Cache> cache,
+      size_t prefetch_batches = 0)
       : SparsePageSourceImpl(missing, nthreads, n_features, n_batches, cache),
-        iter_{iter}, proxy_{proxy} {
+        pipeline_{iter, proxy, missing, nthreads, prefetch_batches} {
     if (!cache_info_->written) {
-      iter_.Reset();
-      CHECK_EQ(iter_.Next(), 1) << "Must have at least 1 batch.";
+      pipeline_.Reset();
+      batch_ = pipeline_.Next();
+      CHECK(batch_) << "Must have at least 1 batch.";
     }
     this->Fetch();
   }
 
+  /*! \brief Batch of the current page as read from the iterator, null if read from cache. */
+  IterBatch* Batch() const { return use_iter_ ? batch_.get() : nullptr; }
+
   SparsePageSource& operator++() final {
     TryLockGuard guard{single_threaded_};
     count_++;
     if (cache_info_->written) {
       at_end_ = (count_ == n_batches_);
     } else {
-      at_end_ = !iter_.Next();
+      batch_ = pipeline_.Next();
+      at_end_ = !batch_;
     }
 
     if (at_end_) {
@@ -256,7 +502,8 @@ class SparsePageSource : public SparsePageSourceImpl<SparsePage> {
         CHECK_EQ(count_, n_batches_);
       }
       CHECK_GE(count_, 1);
-      proxy_ = nullptr;
+      use_iter_ = false;
+      batch_.reset();
     } else {
       this->Fetch();
     }
@@ -264,9 +511,11 @@ class SparsePageSource : public SparsePageSourceImpl<SparsePage> {
   }
 
   void Reset() override {
-    if (proxy_) {
+    if (use_iter_ && !cache_info_->written) {
       TryLockGuard guard{single_threaded_};
-      iter_.Reset();
+      pipeline_.Reset();
+      batch_ = pipeline_.Next();
+      CHECK(batch_) << "Must have at least 1 batch.";
     }
     SparsePageSourceImpl::Reset();
 
@@ -336,10 +585,9 @@ class SortedCSCPageSource : public PageSourceIncMixIn<SortedCSCPage> {
       auto const &csr = this->source_->Page();
       this->page_.reset(new SortedCSCPage{});
       // we might be able to optimize this by merging transpose and pushcsc
-      this->page_->PushCSC(csr->GetTranspose(n_features_));
+      this->page_->PushCSC(csr->GetTranspose(n_features_, true));
       CHECK_EQ(this->page_->Size(), n_features_);
       CHECK_EQ(this->page_->data.Size(), csr->data.Size());
-      this->page_->SortRows();
       page_->SetBaseRowId(csr->base_rowid);
       this->WriteCache();
     }
@@ -0,0 +1,470 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include "text_parser.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <map>
+#include <string>
+
+#include "xgboost/logging.h"
+#include "../common/charconv.h"
+#include "../common/common.h"
+#include "../common/threading_utils.h"
+
+namespace xgboost {
+namespace data {
+constexpr size_t TextParser::kBlockBytes;
+
+namespace {
+// Chunks smaller than this are not worth a thread.
+constexpr size_t kMinChunkBytes = static_cast<size_t>(1) << 20;
+
+inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+/**
+ * \brief Find the first line boundary at or after `pos` in a buffer of `size` bytes.  A
+ *        boundary is either end of the buffer or the position after a line break.
+ */
+size_t AlignToLine(char const* data, size_t size, size_t pos) {
+  if (pos == 0 || pos >= size) {
+    return std::min(pos, size);
+  }
+  if (data[pos - 1] == '\n') {
+    return pos;
+  }
+  auto nl = static_cast<char const*>(std::memchr(data + pos, '\n', size - pos));
+  return nl == nullptr ? size : static_cast<size_t>(nl - data) + 1;
+}
+
+template <typename Fn>
+void ForEachLine(char const* beg, char const* end, Fn&& fn) {
+  while (beg != end) {
+    auto nl = static_cast<char const*>(std::memchr(beg, '\n', end - beg));
+    auto lend = nl == nullptr ? end : nl;
+    fn(beg, lend);
+    beg = nl == nullptr ? end : nl + 1;
+  }
+}
+
+// Find the next token separated by blanks in [*p, end), advances `p` past the token.
+inline bool NextToken(char const** p, char const* end, char const** tbeg, char const** tend) {
+  auto it = *p;
+  while (it != end && IsBlank(*it)) {
+    ++it;
+  }
+  if (it == end) {
+    *p = it;
+    return false;
+  }
+  *tbeg = it;
+  while (it != end && !IsBlank(*it)) {
+    ++it;
+  }
+  *tend = it;
+  *p = it;
+  return true;
+}
+
+inline void Trim(char const** beg, char const** end) {
+  while (*beg != *end && IsBlank(**beg)) {
+    ++(*beg);
+  }
+  while (*end != *beg && IsBlank(*(*end - 1))) {
+    --(*end);
+  }
+}
+
+float ParseFloat(char const* beg, char const* end) {
+  float v{0};
+  auto res = from_chars(beg, end, v);
+  if (XGBOOST_EXPECT(res.ec == std::errc(), true)) {
+    return v;
+  }
+  // Fall back to the C library for input not handled by `from_chars`, like values with
+  // more than 9 significant digits, an explicit `+` sign, `inf` or `nan`.
+  std::string str{beg, end};
+  char* endptr{nullptr};
+  v = std::strtof(str.c_str(), &endptr);
+  CHECK(!str.empty() && endptr == str.c_str() + str.size())
+      << "Invalid floating point value: `" << str << "`";
+  return v;
+}
+
+template <typename T>
+T ParseUnsigned(char const* beg, char const* end) {
+  CHECK(beg != end) << "Empty integer value.";
+  uint64_t v{0};
+  for (auto it = beg; it != end; ++it) {
+    CHECK(*it >= '0' && *it <= '9') << "Invalid integer value: `" << std::string{beg, end}
+                                    << "`";
+    v = v * 10 + static_cast<uint64_t>(*it - '0');
+    CHECK_LE(v, static_cast<uint64_t>(std::numeric_limits<T>::max()))
+        << "Integer value is out of range: `" << std::string{beg, end} << "`";
+  }
+  return static_cast<T>(v);
+}
+
+struct ChunkCount {
+  size_t n_rows{0};
+  size_t n_entries{0};
+  size_t n_weights{0};
+  size_t n_qids{0};
+  uint32_t min_index{std::numeric_limits<uint32_t>::max()};
+};
+
+// Pointers into the block storage, with the row and entry position of a chunk.
+struct ChunkSink {
+  size_t row;
+  size_t entry;
+  size_t* offset;
+  float* label;
+  float* weight;
+  uint64_t* qid;
+  uint32_t* index;
+  float* value;
+};
+
+inline char const* StripComment(char const* beg, char const* end) {
+  auto hash = static_cast<char const*>(std::memchr(beg, '#', end - beg));
+  return hash == nullptr ? end : hash;
+}
+
+inline bool IsQid(char const* beg, char const* end) {
+  return end - beg > 4 && std::strncmp(beg, "qid:", 4) == 0;
+}
+
+/**
+ * LIBSVM line: label[:weight] [qid:n] index[:value] ...  Index without value is treated
+ * as value 1.
+ */
+void CountLibSVM(char const* beg, char const* end, ChunkCount* out) {
+  ForEachLine(beg, end, [&](char const* lbeg, char const* lend) {
+    lend = StripComment(lbeg, lend);
+    char const *p{lbeg}, *tbeg{nullptr}, *tend{nullptr};
+    if (!NextToken(&p, lend, &tbeg, &tend)) {
+      return;
+    }
+    out->n_rows++;
+    if (std::find(tbeg, tend, ':') != tend) {
+      out->n_weights++;
+    }
+    while (NextToken(&p, lend, &tbeg, &tend)) {
+      if (IsQid(tbeg, tend)) {
+        out->n_qids++;
+      } else {
+        out->n_entries++;
+      }
+    }
+  });
+}
+
+void ParseLibSVM(char const* beg, char const* end, ChunkSink sink, ChunkCount* out) {
+  ForEachLine(beg, end, [&](char const* lbeg, char const* lend) {
+    lend = StripComment(lbeg, lend);
+    char const *p{lbeg}, *tbeg{nullptr}, *tend{nullptr};
+    if (!NextToken(&p, lend, &tbeg, &tend)) {
+      return;
+    }
+    auto row = sink.row + out->n_rows;
+    auto colon = std::find(tbeg, tend, ':');
+    sink.label[row] = ParseFloat(tbeg, colon);
+    if (colon != tend) {
+      sink.weight[row] = ParseFloat(colon + 1, tend);
+      out->n_weights++;
+    }
+    while (NextToken(&p, lend, &tbeg, &tend)) {
+      if (IsQid(tbeg, tend)) {
+        sink.qid[row] = ParseUnsigned<uint64_t>(tbeg + 4, tend);
+        out->n_qids++;
+        continue;
+      }
+      auto pos = sink.entry + out->n_entries;
+      colon = std::find(tbeg, tend, ':');
+      auto fidx = ParseUnsigned<uint32_t>(tbeg, colon);
+      sink.index[pos] = fidx;
+      sink.value[pos] = colon == tend ? 1.0f : ParseFloat(colon + 1, tend);
+      out->min_index = std::min(out->min_index, fidx);
+      out->n_entries++;
+    }
+    out->n_rows++;
+    sink.offset[row + 1] = sink.entry + out->n_entries;
+  });
+}
+
+inline bool IsBlankLine(char const* beg, char const* end) {
+  return std::all_of(beg, end, IsBlank);
+}
+
+// Visit fields of a CSV line, `fn` is called with column index and trimmed field.
+template <typename Fn>
+void ForEachField(char const* beg, char const* end, char delimiter, Fn&& fn) {
+  int32_t column = 0;
+  while (true) {
+    auto fend = std::find(beg, end, delimiter);
+    char const *fbeg{beg}, *ftrim{fend};
+    Trim(&fbeg, &ftrim);
+    fn(column, fbeg, ftrim);
+    if (fend == end) {
+      break;
+    }
+    beg = fend + 1;
+    column++;
+  }
+}
+
+void CountCSV(char const* beg, char const* end, TextParser::Param const& param,
+              ChunkCount* out) {
+  ForEachLine(beg, end, [&](char const* lbeg, char const* lend) {
+    if (IsBlankLine(lbeg, lend)) {
+      return;
+    }
+    out->n_rows++;
+    ForEachField(lbeg, lend, param.delimiter, [&](int32_t column, char const* fbeg,
+                                              char const* fend) {
+      if (column == param.label_column || column == param.weight_column) {
+        return;
+      }
+      if (fbeg != fend) {
+        out->n_entries++;
+      }
+    });
+  });
+}
+
+void ParseCSV(char const* beg, char const* end, TextParser::Param const& param,
+              ChunkSink sink, ChunkCount* out) {
+  ForEachLine(beg, end, [&](char const* lbeg, char const* lend) {
+    if (IsBlankLine(lbeg, lend)) {
+      return;
+    }
+    auto row = sink.row + out->n_rows;
+    sink.label[row] = 0.0f;
+    uint32_t fidx = 0;
+    ForEachField(lbeg, lend, param.delimiter, [&](int32_t column, char const* fbeg,
+                                              char const* fend) {
+      if (column == param.label_column) {
+        if (fbeg != fend) {
+          sink.label[row] = ParseFloat(fbeg, fend);
+        }
+        return;
+      }
+      if (column == param.weight_column) {
+        if (fbeg != fend) {
+          sink.weight[row] = ParseFloat(fbeg, fend);
+        }
+        return;
+      }
+      if (fbeg != fend) {
+        auto pos = sink.entry + out->n_entries;
+        sink.index[pos] = fidx;
+        sink.value[pos] = ParseFloat(fbeg, fend);
+        out->n_entries++;
+      }
+      fidx++;
+    });
+    out->n_rows++;
+    sink.offset[row + 1] = sink.entry + out->n_entries;
+  });
+}
+
+bool IsRegularFile(std::string const& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  return (st.st_mode & S_IFMT) == S_IFREG;
+}
+}  // anonymous namespace
+
+TextParser::TextParser(std::string path, Param param, uint32_t part_idx, uint32_t n_parts,
+                       int32_t n_threads)
+    : file_{new common::MmapFile{std::move(path)}},
+      param_{param},
+      n_threads_{std::max(n_threads, 1)} {
+  CHECK_GT(n_parts, 0);
+  CHECK_LT(part_idx, n_parts);
+  auto data = file_->Data();
+  auto size = file_->Size();
+  auto boundary = [&](uint32_t k) {
+    return k == n_parts ? size : AlignToLine(data, size, size / n_parts * k);
+  };
+  part_begin_ = boundary(part_idx);
+  part_end_ = std::max(part_begin_, boundary(part_idx + 1));
+  this->BeforeFirst();
+}
+
+void TextParser::BeforeFirst() {
+  cursor_ = part_begin_;
+  block_ = dmlc::RowBlock<uint32_t>{};
+}
+
+bool TextParser::Next() {
+  while (cursor_ < part_end_) {
+    auto end = AlignToLine(file_->Data(), part_end_, std::min(cursor_ + kBlockBytes, part_end_));
+    auto n_rows = this->ParseBlock(cursor_, end);
+    cursor_ = end;
+    if (n_rows != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t TextParser::ParseBlock(size_t begin, size_t end) {
+  auto data = file_->Data();
+  size_t n_chunks = std::min(static_cast<size_t>(n_threads_) * 4,
+                             common::DivRoundUp(end - begin, kMinChunkBytes));
+  n_chunks = std::max(n_chunks, static_cast<size_t>(1));
+  std::vector<size_t> bounds(n_chunks + 1, end);
+  bounds[0] = begin;
+  for (size_t i = 1; i < n_chunks; ++i) {
+    bounds[i] = std::max(bounds[i - 1],
+                         AlignToLine(data, end, begin + (end - begin) / n_chunks * i));
+  }
+
+  // Pass 1: count rows and entries of each chunk.
+  std::vector<ChunkCount> counts(n_chunks);
+  common::ParallelFor(n_chunks, n_threads_, common::Sched::Dyn(), [&](size_t i) {
+    auto cbeg = data + bounds[i];
+    auto cend = data + bounds[i + 1];
+    if (param_.format == Format::kLibSVM) {
+      CountLibSVM(cbeg, cend, &counts[i]);
+    } else {
+      CountCSV(cbeg, cend, param_, &counts[i]);
+    }
+  });
+
+  std::vector<size_t> row_base(n_chunks + 1, 0), entry_base(n_chunks + 1, 0);
+  size_t n_weights = 0, n_qids = 0;
+  for (size_t i = 0; i < n_chunks; ++i) {
+    row_base[i + 1] = row_base[i] + counts[i].n_rows;
+    entry_base[i + 1] = entry_base[i] + counts[i].n_entries;
+    n_weights += counts[i].n_weights;
+    n_qids += counts[i].n_qids;
+  }
+  auto n_rows = row_base.back();
+  auto n_entries = entry_base.back();
+  CHECK(n_qids == 0 || n_qids == n_rows) << "qid must be specified for either all or none of "
+                                            "the rows.";
+
+  offset_.resize(n_rows + 1);
+  offset_[0] = 0;
+  label_.resize(n_rows);
+  weight_.clear();
+  if (n_weights != 0 || (param_.format == Format::kCSV && param_.weight_column >= 0)) {
+    weight_.resize(n_rows, 1.0f);
+  }
+  qid_.resize(n_qids);
+  index_.resize(n_entries);
+  value_.resize(n_entries);
+
+  // Pass 2: parse into the final position.
+  std::vector<ChunkCount> parsed(n_chunks);
+  common::ParallelFor(n_chunks, n_threads_, common::Sched::Dyn(), [&](size_t i) {
+    auto cbeg = data + bounds[i];
+    auto cend = data + bounds[i + 1];
+    ChunkSink sink{row_base[i],          entry_base[i],       offset_.data(),
+                   label_.data(),        weight_.data(),      qid_.data(),
+                   index_.data(),        value_.data()};
+    if (param_.format == Format::kLibSVM) {
+      ParseLibSVM(cbeg, cend, sink, &parsed[i]);
+    } else {
+      ParseCSV(cbeg, cend, param_, sink, &parsed[i]);
+    }
+    CHECK_EQ(parsed[i].n_rows, counts[i].n_rows);
+    CHECK_EQ(parsed[i].n_entries, counts[i].n_entries);
+  });
+
+  if (param_.format == Format::kLibSVM) {
+    uint32_t min_index = std::numeric_limits<uint32_t>::max();
+    for (auto const& c : parsed) {
+      min_index = std::min(min_index, c.min_index);
+    }
+    if (param_.indexing_mode > 0) {
+      CHECK_GT(min_index, 0) << "Found feature index 0 with 1-based indexing.";
+    }
+    bool one_based =
+        param_.indexing_mode > 0 || (param_.indexing_mode < 0 && n_entries != 0 && min_index > 0);
+    if (one_based) {
+      common::ParallelFor(n_entries, n_threads_, [&](size_t i) { index_[i]--; });
+    }
+  }
+
+  block_.size = n_rows;
+  block_.offset = offset_.data();
+  block_.label = label_.data();
+  block_.weight = weight_.empty() ? nullptr : weight_.data();
+  block_.qid = qid_.empty() ? nullptr : qid_.data();
+  block_.field = nullptr;
+  block_.index = index_.data();
+  block_.value = value_.data();
+  return n_rows;
+}
+
+dmlc::Parser<uint32_t>* TextParser::Create(std::string const& uri, uint32_t part_idx,
+                                           uint32_t n_parts, std::string const& type,
+                                           int32_t n_threads) {
+  auto splited = common::Split(uri, '?');
+  if (splited.empty() || splited.size() > 2) {
+    return nullptr;
+  }
+  auto const& path = splited.front();
+  if (!common::MmapFile::Supported(path) ||
+      !IsRegularFile(dmlc::io::URI(path.c_str()).name)) {
+    return nullptr;
+  }
+
+  std::map<std::string, std::string> args;
+  if (splited.size() == 2) {
+    for (auto const& kv : common::Split(splited.back(), '&')) {
+      auto pos = kv.find('=');
+      if (pos == std::string::npos) {
+        return nullptr;
+      }
+      args[kv.substr(0, pos)] = kv.substr(pos + 1);
+    }
+  }
+  std::string format = type;
+  if (format == "auto") {
+    format = args.find("format") == args.cend() ? "libsvm" : args.at("format");
+  }
+  args.erase("format");
+
+  Param param;
+  if (format == "libsvm") {
+    param.format = Format::kLibSVM;
+  } else if (format == "csv") {
+    param.format = Format::kCSV;
+  } else {
+    return nullptr;
+  }
+  try {
+    for (auto const& kv : args) {
+      if (kv.first == "indexing_mode" && param.format == Format::kLibSVM) {
+        param.indexing_mode = std::stoi(kv.second);
+      } else if (kv.first == "label_column" && param.format == Format::kCSV) {
+        param.label_column = std::stoi(kv.second);
+      } else if (kv.first == "weight_column" && param.format == Format::kCSV) {
+        param.weight_column = std::stoi(kv.second);
+      } else if (kv.first == "delimiter" && param.format == Format::kCSV &&
+                 kv.second.size() == 1) {
+        param.delimiter = kv.second.front();
+      } else {
+        return nullptr;
+      }
+    }
+  } catch (std::exception const&) {
+    // Let dmlc report the invalid parameter.
+    return nullptr;
+  }
+  return new TextParser{path, param, part_idx, n_parts, n_threads};
+}
+}  // namespace data
+}  // namespace xgboost
@@ -0,0 +1,95 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ * \file text_parser.h
+ * \brief Multi-threaded parser for LIBSVM and CSV text files.
+ */
+#ifndef XGBOOST_DATA_TEXT_PARSER_H_
+#define XGBOOST_DATA_TEXT_PARSER_H_
+
+#include <dmlc/data.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../common/io.h"
+
+namespace xgboost {
+namespace data {
+/**
+ * \brief Native replacement of the dmlc text parsers for local files.
+ *
+ *   The file is memory mapped and parsed in blocks of roughly `kBlockBytes`.  Each block is
+ *   split into chunks at line boundaries, which are parsed by independent threads in 2
+ *   passes.  The first pass counts rows and entries of each chunk so that the second pass
+ *   can write directly into the final CSR buffers without any concatenation.  Floating
+ *   point values are parsed by `from_chars`.
+ *
+ *   The same URI parameters as dmlc are recognized:
+ *
+ *   - format: `libsvm` (default) or `csv`.
+ *   - indexing_mode: LIBSVM only, 0 for 0-based (default), positive for 1-based and
+ *     negative for detecting 1-based indices when there's no 0 index in a block.
+ *   - label_column, weight_column: CSV only, index of the label and weight columns.
+ *   - delimiter: CSV only, single character separating fields.
+ *
+ *   Empty fields in CSV files are treated as missing values.
+ */
+class TextParser : public dmlc::Parser<uint32_t> {
+ public:
+  enum class Format : int8_t { kLibSVM = 0, kCSV = 1 };
+
+  struct Param {
+    Format format{Format::kLibSVM};
+    int32_t indexing_mode{0};
+    int32_t label_column{-1};
+    int32_t weight_column{-1};
+    char delimiter{','};
+  };
+
+  /*! \brief Size of text parsed by each call to `Next`. */
+  static constexpr size_t kBlockBytes = static_cast<size_t>(256) << 20;
+
+ private:
+  std::unique_ptr<common::MmapFile> file_;
+  Param param_;
+  int32_t n_threads_;
+  // Range of the file belonging to this part.
+  size_t part_begin_{0};
+  size_t part_end_{0};
+  size_t cursor_{0};
+
+  // Storage of the current block.
+  std::vector<size_t> offset_;
+  std::vector<float> label_;
+  std::vector<float> weight_;
+  std::vector<uint64_t> qid_;
+  std::vector<uint32_t> index_;
+  std::vector<float> value_;
+  dmlc::RowBlock<uint32_t> block_;
+
+  /*! \brief Parse text in [begin, end) into the block storage, returns number of rows. */
+  size_t ParseBlock(size_t begin, size_t end);
+
+ public:
+  TextParser(std::string path, Param param, uint32_t part_idx, uint32_t n_parts,
+             int32_t n_threads);
+
+  void BeforeFirst() override;
+  bool Next() override;
+  dmlc::RowBlock<uint32_t> const& Value() const override { return block_; }
+  size_t BytesRead() const override { return cursor_ - part_begin_; }
+
+  /**
+   * \brief Create a parser for the uri.  Returns nullptr when the input is not supported,
+   *        like remote files or unrecognized parameters, in which case the dmlc parser
+   *        should be used instead.
+   */
+  static dmlc::Parser<uint32_t>* Create(std::string const& uri, uint32_t part_idx,
+                                        uint32_t n_parts, std::string const& type,
+                                        int32_t n_threads);
+};
+}  // namespace data
+}  // namespace xgboost
+#endif  // XGBOOST_DATA_TEXT_PARSER_H_
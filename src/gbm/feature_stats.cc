@@ -0,0 +1,48 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "feature_stats.h"
+
+#include <vector>
+
+#include "xgboost/logging.h"
+#include "gbtree_model.h"
+#include "../common/threading_utils.h"
+
+namespace xgboost {
+namespace gbm {
+void FeatureStats::Extend(GBTreeModel const& model, int32_t n_threads) {
+  CHECK_EQ(model.Generation(), generation_);
+  CHECK_LE(this->Size(), model.trees.size());
+  auto n_features = model.learner_model_param->num_feature;
+  count_.resize(n_features, 0);
+  gain_.resize(n_features, 0);
+  cover_.resize(n_features, 0);
+
+  auto begin = this->Size();
+  std::vector<std::vector<Split>> new_splits(model.trees.size() - begin);
+  common::ParallelFor(new_splits.size(), n_threads, common::Sched::Dyn(), [&](size_t i) {
+    auto const& tree = *model.trees[begin + i];
+    tree.WalkTree([&](bst_node_t nidx) {
+      auto const& node = tree[nidx];
+      if (!node.IsLeaf()) {
+        new_splits[i].push_back(
+            {node.SplitIndex(), tree.Stat(nidx).loss_chg, tree.Stat(nidx).sum_hess});
+      }
+      return true;
+    });
+  });
+  // Totals are accumulated in the order of trees, same as summing up splits of all trees.
+  for (auto const& tree_splits : new_splits) {
+    for (auto const& split : tree_splits) {
+      CHECK_LT(split.fidx, n_features);
+      count_[split.fidx]++;
+      gain_[split.fidx] += split.gain;
+      cover_[split.fidx] += split.cover;
+    }
+    splits_.insert(splits_.end(), tree_splits.cbegin(), tree_splits.cend());
+    tree_ptr_.push_back(splits_.size());
+  }
+}
+}  // namespace gbm
+}  // namespace xgboost
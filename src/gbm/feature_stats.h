@@ -0,0 +1,70 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file feature_stats.h
+ * \brief Split statistics of trees used for feature importance.
+ */
+#ifndef XGBOOST_GBM_FEATURE_STATS_H_
+#define XGBOOST_GBM_FEATURE_STATS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/span.h"
+
+namespace xgboost {
+namespace gbm {
+struct GBTreeModel;
+
+/**
+ * \brief Splits of each tree in a model along with per-feature totals over all trees.
+ *
+ *   Like the flattened forest of predictor, it's extended when new trees are committed and
+ *   rebuilt when the generation of model changes.  Querying importance over the whole model
+ *   only reads the totals, while a subset of trees reads the recorded splits instead of
+ *   walking the trees.
+ */
+class FeatureStats {
+ public:
+  struct Split {
+    bst_feature_t fidx;
+    float gain;
+    float cover;
+  };
+
+ private:
+  std::vector<Split> splits_;
+  // Segment of splits for each tree.
+  std::vector<size_t> tree_ptr_{0};
+  std::vector<size_t> count_;
+  std::vector<float> gain_;
+  std::vector<float> cover_;
+  uint64_t generation_{0};
+
+ public:
+  FeatureStats() = default;
+  explicit FeatureStats(uint64_t generation) : generation_{generation} {}
+
+  /**
+   * \brief Collect splits of trees in the model that are not yet recorded, trees are walked
+   *        in parallel.
+   */
+  void Extend(GBTreeModel const& model, int32_t n_threads);
+
+  size_t Size() const { return tree_ptr_.size() - 1; }
+  uint64_t Generation() const { return generation_; }
+
+  /*! \brief Splits of a tree in the order of `RegTree::WalkTree`. */
+  common::Span<Split const> Splits(size_t tree_idx) const {
+    return {splits_.data() + tree_ptr_[tree_idx], tree_ptr_[tree_idx + 1] - tree_ptr_[tree_idx]};
+  }
+  /*! \brief Number of splits of each feature over all trees. */
+  std::vector<size_t> const& Count() const { return count_; }
+  /*! \brief Sum of gain of each feature over all trees. */
+  std::vector<float> const& Gain() const { return gain_; }
+  /*! \brief Sum of cover of each feature over all trees. */
+  std::vector<float> const& Cover() const { return cover_; }
+};
+}  // namespace gbm
+}  // namespace xgboost
+#endif  // XGBOOST_GBM_FEATURE_STATS_H_
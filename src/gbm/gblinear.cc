@@ -26,6 +26,7 @@
 #include "../common/timer.h"
 #include "../common/common.h"
 #include "../common/threading_utils.h"
+#include "../data/adapter.h"
 
 namespace xgboost {
 namespace gbm {
@@ -164,8 +165,27 @@ class GBLinear : public GradientBooster {
     LinearCheckLayer(layer_begin, layer_end);
     const int ngroup = model_.learner_model_param->num_output_group;
     for (int gid = 0; gid < ngroup; ++gid) {
-      this->Pred(inst, dmlc::BeginPtr(*out_preds), gid,
-                 learner_model_param_->base_score);
+      (*out_preds)[gid] = learner_model_param_->base_score;
+    }
+    this->Pred(inst, dmlc::BeginPtr(*out_preds));
+  }
+
+  void InplacePredict(dmlc::any const &x, std::shared_ptr<DMatrix> p_m, float missing,
+                      PredictionCacheEntry *out_preds, uint32_t layer_begin,
+                      uint32_t layer_end) const override {
+    LinearCheckLayer(layer_begin, layer_end);
+    if (x.type() == typeid(std::shared_ptr<data::DenseAdapter>)) {
+      this->InplacePredictImpl<data::DenseAdapter>(x, p_m, missing, out_preds);
+    } else if (x.type() == typeid(std::shared_ptr<data::CSRAdapter>)) {
+      this->InplacePredictImpl<data::CSRAdapter>(x, p_m, missing, out_preds);
+    } else if (x.type() == typeid(std::shared_ptr<data::ArrayAdapter>)) {
+      this->InplacePredictImpl<data::ArrayAdapter>(x, p_m, missing, out_preds);
+    } else if (x.type() == typeid(std::shared_ptr<data::CSRArrayAdapter>)) {
+      this->InplacePredictImpl<data::CSRArrayAdapter>(x, p_m, missing, out_preds);
+    } else if (x.type() == typeid(std::shared_ptr<data::ArrowAdapter>)) {
+      this->InplacePredictImpl<data::ArrowAdapter>(x, p_m, missing, out_preds);
+    } else {
+      LOG(FATAL) << "Unsupported data type for inplace predict.";
     }
   }
 
@@ -287,15 +307,49 @@ class GBLinear : public GradientBooster {
         const size_t ridx = page.base_rowid + i;
         // loop over output groups
         for (int gid = 0; gid < ngroup; ++gid) {
-          float margin =
+          preds[ridx * ngroup + gid] =
               (base_margin.Size() != 0) ? base_margin(ridx, gid) : learner_model_param_->base_score;
-          this->Pred(batch[i], &preds[ridx * ngroup], gid, margin);
         }
+        this->Pred(batch[i], &preds[ridx * ngroup]);
       });
     }
     monitor_.Stop("PredictBatchInternal");
   }
 
+  template <typename Adapter>
+  void InplacePredictImpl(dmlc::any const &x, std::shared_ptr<DMatrix> p_m, float missing,
+                          PredictionCacheEntry *out_preds) const {
+    auto m = dmlc::get<std::shared_ptr<Adapter>>(x);
+    CHECK_EQ(m->NumColumns(), learner_model_param_->num_feature)
+        << "Number of columns in data must equal to trained model.";
+    auto const &batch = m->Value();
+    size_t const n_rows = m->NumRows();
+    size_t const ngroup = learner_model_param_->num_output_group;
+    auto &preds = out_preds->predictions.HostVector();
+    preds.resize(n_rows * ngroup);
+    auto const *base_margin = p_m ? p_m->Info().base_margin_.Data() : nullptr;
+    if (base_margin && base_margin->Size() != 0) {
+      CHECK_EQ(base_margin->Size(), preds.size()) << "Invalid shape of base margin.";
+      auto const &h_margin = base_margin->ConstHostVector();
+      std::copy(h_margin.cbegin(), h_margin.cend(), preds.begin());
+    } else {
+      std::fill(preds.begin(), preds.end(), learner_model_param_->base_score);
+    }
+    common::ParallelFor(n_rows, generic_param_->Threads(), [&](size_t ridx) {
+      auto line = batch.GetLine(ridx);
+      this->PredRow(
+          [&](auto &&fn) {
+            for (size_t c = 0; c < line.Size(); ++c) {
+              auto e = line.GetElement(c);
+              if (e.value != missing && !common::CheckNAN(e.value)) {
+                fn(static_cast<bst_feature_t>(e.column_idx), e.value);
+              }
+            }
+          },
+          &preds[ridx * ngroup]);
+    });
+  }
+
   bool CheckConvergence() {
     if (param_.tolerance == 0.0f) return false;
     if (is_converged_) return true;
@@ -324,14 +378,57 @@ class GBLinear : public GradientBooster {
     }
   }
 
-  void Pred(const SparsePage::Inst &inst, bst_float *preds, int gid,
-            bst_float base) {
-    bst_float psum = model_.Bias()[gid] + base;
-    for (const auto& ins : inst) {
-      if (ins.index >= model_.learner_model_param->num_feature) continue;
-      psum += ins.fvalue * model_[ins.index][gid];
+  // preds of all output groups must be initialized with the margin.
+  void Pred(const SparsePage::Inst &inst, bst_float *preds) const {
+    this->PredRow(
+        [&](auto &&fn) {
+          for (const auto &ins : inst) {
+            fn(ins.index, ins.fvalue);
+          }
+        },
+        preds);
+  }
+
+  /**
+   * \brief Add the linear predictor of a row to the margin of all output groups.  Entries
+   *        are visited once and the weights of a feature are contiguous across groups,
+   *        instead of visiting the row once for each group.  Sums of each group are in the
+   *        same order as before, so results don't change.
+   *
+   * \param visit_row Calls its argument with feature index and value of each entry.
+   * \param preds     Margin of each output group.
+   */
+  template <typename VisitRow>
+  void PredRow(VisitRow &&visit_row, bst_float *preds) const {
+    // Weights of untrained model are all zero.
+    if (model_.weight.empty()) {
+      return;
+    }
+    auto const ngroup = model_.learner_model_param->num_output_group;
+    auto const nfeature = model_.learner_model_param->num_feature;
+    auto const *bias = model_.Bias();
+    if (ngroup == 1) {
+      bst_float psum = preds[0] + bias[0];
+      visit_row([&](bst_feature_t fidx, float fvalue) {
+        if (fidx < nfeature) {
+          psum += fvalue * model_[fidx][0];
+        }
+      });
+      preds[0] = psum;
+      return;
+    }
+    for (uint32_t gid = 0; gid < ngroup; ++gid) {
+      preds[gid] += bias[gid];
     }
-    preds[gid] = psum;
+    visit_row([&](bst_feature_t fidx, float fvalue) {
+      if (fidx >= nfeature) {
+        return;
+      }
+      auto const *w = model_[fidx];
+      for (uint32_t gid = 0; gid < ngroup; ++gid) {
+        preds[gid] += fvalue * w[gid];
+      }
+    });
   }
 
   // biase margin score
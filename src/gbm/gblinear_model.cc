@@ -12,21 +12,12 @@ namespace gbm {
 void GBLinearModel::SaveModel(Json* p_out) const {
   auto& out = *p_out;
 
-  size_t const n_weights = weight.size();
-  std::vector<Json> j_weights(n_weights);
-  for (size_t i = 0; i < n_weights; ++i) {
-    j_weights[i] = weight[i];
-  }
-  out["weights"] = std::move(j_weights);
+  out["weights"] = F32Array{std::vector<float>(weight.cbegin(), weight.cend())};
 }
 
 void GBLinearModel::LoadModel(Json const& in) {
-  auto const& j_weights = get<Array const>(in["weights"]);
-  auto n_weights = j_weights.size();
-  weight.resize(n_weights);
-  for (size_t i = 0; i < n_weights; ++i) {
-    weight[i] = get<Number const>(j_weights[i]);
-  }
+  auto const j_weights = GetNumericArray<float>(in["weights"]);
+  weight.assign(j_weights.cbegin(), j_weights.cend());
 }
 
 DMLC_REGISTER_PARAMETER(DeprecatedGBLinearModelParam);
@@ -13,6 +13,7 @@
 #include <string>
 #include <limits>
 #include <algorithm>
+#include <sstream>
 
 #include "xgboost/data.h"
 #include "xgboost/gbm.h"
@@ -25,9 +26,12 @@
 #include "gbtree.h"
 #include "gbtree_model.h"
 #include "../common/common.h"
+#include "../common/perf_counters.h"
 #include "../common/random.h"
 #include "../common/timer.h"
 #include "../common/threading_utils.h"
+#include "../predictor/compiled_forest.h"
+#include "../predictor/flat_forest.h"
 
 namespace xgboost {
 namespace gbm {
@@ -52,6 +56,22 @@ void GBTree::Configure(const Args& cfg) {
         Predictor::Create("cpu_predictor", this->generic_param_));
   }
   cpu_predictor_->Configure(cfg);
+  if (!quickscorer_predictor_ &&
+      tparam_.predictor == PredictorType::kQuickScorerPredictor) {
+    quickscorer_predictor_ = std::unique_ptr<Predictor>(
+        Predictor::Create("quickscorer_predictor", this->generic_param_));
+  }
+  if (quickscorer_predictor_) {
+    quickscorer_predictor_->Configure(cfg);
+  }
+  if (!compiled_predictor_ &&
+      tparam_.predictor == PredictorType::kCompiledPredictor) {
+    compiled_predictor_ = std::unique_ptr<Predictor>(
+        Predictor::Create("compiled_predictor", this->generic_param_));
+  }
+  if (compiled_predictor_) {
+    compiled_predictor_->Configure(cfg);
+  }
 #if defined(XGBOOST_USE_CUDA)
   auto n_gpus = common::AllVisibleGPUs();
   if (!gpu_predictor_ && n_gpus != 0) {
@@ -134,7 +154,11 @@ void GBTree::PerformTreeMethodHeuristic(DMatrix* fmat) {
     return;
   }
 
-  if (rabit::IsDistributed()) {
+  if (!fmat->PageExists<SparsePage>() && fmat->PageExists<GHistIndexMatrix>()) {
+    LOG(INFO) << "Tree method is automatically selected to be 'hist' "
+                 "since Quantile DMatrix is used.";
+    tparam_.tree_method = TreeMethod::kHist;
+  } else if (rabit::IsDistributed()) {
     LOG(INFO) << "Tree method is automatically selected to be 'approx' "
                  "for distributed training.";
     tparam_.tree_method = TreeMethod::kApprox;
@@ -219,6 +243,17 @@ void CopyGradient(HostDeviceVector<GradientPair> const *in_gpair,
 void GBTree::DoBoost(DMatrix* p_fmat,
                      HostDeviceVector<GradientPair>* in_gpair,
                      PredictionCacheEntry* predt) {
+  this->DoBoostImpl(p_fmat, in_gpair, predt, nullptr);
+}
+
+void GBTree::DoBoostFused(DMatrix* p_fmat, HostDeviceVector<GradientPair>* in_gpair,
+                          PredictionCacheEntry* predt, GradientSource const& source) {
+  this->DoBoostImpl(p_fmat, in_gpair, predt, &source);
+}
+
+void GBTree::DoBoostImpl(DMatrix* p_fmat, HostDeviceVector<GradientPair>* in_gpair,
+                         PredictionCacheEntry* predt, GradientSource const* source) {
+  model_.CheckNotShared("Training");
   std::vector<std::vector<std::unique_ptr<RegTree> > > new_trees;
   const int ngroup = model_.learner_model_param->num_output_group;
   ConfigureWithKnownData(this->cfg_, p_fmat);
@@ -236,33 +271,86 @@ void GBTree::DoBoost(DMatrix* p_fmat,
        static_cast<size_t>(ngroup)},
       device};
   CHECK_NE(ngroup, 0);
-  if (ngroup == 1) {
+  if (source && (device != GenericParameter::kCpuId ||
+                 tparam_.process_type != TreeProcessType::kDefault)) {
+    // Only new trees built on CPU can consume the gradient lazily.
+    (*source)(0, p_fmat->Info().num_row_);
+    source = nullptr;
+  }
+  if (this->MultiOutputTree()) {
+    if (!model_.trees.empty()) {
+      CHECK(model_.IsMultiTarget())
+          << "Can not continue training a model with one tree per output using "
+             "`multi_output_tree`.";
+    }
+    CHECK(tparam_.process_type == TreeProcessType::kDefault)
+        << "`multi_output_tree` doesn't support updating existing trees.";
+    for (auto const& up : updaters_) {
+      CHECK_EQ(up->Name(), std::string{"grow_quantile_histmaker"})
+          << "`multi_output_tree` is only supported by the `hist` tree method.";
+    }
+    if (source) {
+      (*source)(0, p_fmat->Info().num_row_);
+    }
+    // A single tree for all groups using the full gradient matrix, the rest of groups
+    // have no tree in this iteration.
     std::vector<std::unique_ptr<RegTree>> ret;
     BoostNewTrees(in_gpair, p_fmat, 0, &ret);
     const size_t num_new_trees = ret.size();
     new_trees.push_back(std::move(ret));
+    new_trees.resize(ngroup);
+    if (updaters_.size() > 0 && num_new_trees == 1 && this->UnitTreeWeights() &&
+        predt->predictions.Size() > 0 &&
+        updaters_.back()->UpdateMultiTargetPredictionCache(p_fmat, out)) {
+      predt->Update(1);
+    }
+  } else if (ngroup == 1) {
+    std::vector<std::unique_ptr<RegTree>> ret;
+    BoostNewTrees(in_gpair, p_fmat, 0, &ret, source);
+    const size_t num_new_trees = ret.size();
+    new_trees.push_back(std::move(ret));
     auto v_predt = out.Slice(linalg::All(), 0);
-    if (updaters_.size() > 0 && num_new_trees == 1 &&
+    if (updaters_.size() > 0 && num_new_trees == 1 && this->UnitTreeWeights() &&
         predt->predictions.Size() > 0 &&
         updaters_.back()->UpdatePredictionCache(p_fmat, v_predt)) {
       predt->Update(1);
     }
   } else {
+    CHECK(!model_.IsMultiTarget())
+        << "Set `multi_strategy` to `multi_output_tree` for continuing training of a model "
+           "with multi-target trees.";
     CHECK_EQ(in_gpair->Size() % ngroup, 0U)
         << "must have exactly ngroup * nrow gpairs";
     HostDeviceVector<GradientPair> tmp(in_gpair->Size() / ngroup,
                                        GradientPair(),
                                        in_gpair->DeviceIdx());
+    // The first group is copied as soon as gradient of rows is computed, the rest of
+    // groups are available after boosting the first group.
+    GradientSource first_group;
+    if (source) {
+      GradientPair const* gpair_h = in_gpair->ConstHostVector().data();
+      GradientPair* tmp_h = tmp.HostVector().data();
+      first_group = [=](size_t begin, size_t end) {
+        (*source)(begin, end);
+        for (size_t i = begin; i < end; ++i) {
+          tmp_h[i] = gpair_h[i * ngroup];
+        }
+      };
+    }
     bool update_predict = true;
     for (int gid = 0; gid < ngroup; ++gid) {
-      CopyGradient(in_gpair, ngroup, gid, &tmp);
       std::vector<std::unique_ptr<RegTree> > ret;
-      BoostNewTrees(&tmp, p_fmat, gid, &ret);
+      if (source && gid == 0) {
+        BoostNewTrees(&tmp, p_fmat, gid, &ret, &first_group);
+      } else {
+        CopyGradient(in_gpair, ngroup, gid, &tmp);
+        BoostNewTrees(&tmp, p_fmat, gid, &ret);
+      }
       const size_t num_new_trees = ret.size();
       new_trees.push_back(std::move(ret));
       auto v_predt = out.Slice(linalg::All(), gid);
       if (!(updaters_.size() > 0 && predt->predictions.Size() > 0 &&
-            num_new_trees == 1 &&
+            num_new_trees == 1 && this->UnitTreeWeights() &&
             updaters_.back()->UpdatePredictionCache(p_fmat, v_predt))) {
         update_predict = false;
       }
@@ -319,7 +407,8 @@ void GBTree::InitUpdater(Args const& cfg) {
 void GBTree::BoostNewTrees(HostDeviceVector<GradientPair>* gpair,
                            DMatrix *p_fmat,
                            int bst_group,
-                           std::vector<std::unique_ptr<RegTree> >* ret) {
+                           std::vector<std::unique_ptr<RegTree> >* ret,
+                           GradientSource const* source) {
   std::vector<RegTree*> new_trees;
   ret->clear();
   // create the trees
@@ -333,6 +422,9 @@ void GBTree::BoostNewTrees(HostDeviceVector<GradientPair>* gpair,
       // create new tree
       std::unique_ptr<RegTree> ptr(new RegTree());
       ptr->param.UpdateAllowUnknown(this->cfg_);
+      if (this->MultiOutputTree()) {
+        ptr->SetNumTargets(model_.learner_model_param->num_output_group);
+      }
       new_trees.push_back(ptr.get());
       ret->push_back(std::move(ptr));
     } else if (tparam_.process_type == TreeProcessType::kUpdate) {
@@ -353,11 +445,17 @@ void GBTree::BoostNewTrees(HostDeviceVector<GradientPair>* gpair,
     }
   }
   // update the trees
-  CHECK_EQ(gpair->Size(), p_fmat->Info().num_row_)
+  size_t n_targets = this->MultiOutputTree() ? model_.learner_model_param->num_output_group : 1;
+  CHECK_EQ(gpair->Size(), p_fmat->Info().num_row_ * n_targets)
       << "Mismatching size between number of rows from input data and size of "
          "gradient vector.";
   for (auto& up : updaters_) {
-    up->Update(gpair, p_fmat, new_trees);
+    if (source && up == updaters_.front()) {
+      // Only the first updater sees gradient before it's fully computed.
+      up->UpdateFused(gpair, *source, p_fmat, new_trees);
+    } else {
+      up->Update(gpair, p_fmat, new_trees);
+    }
   }
 }
 
@@ -432,6 +530,7 @@ void GBTree::LoadModel(Json const& in) {
 }
 
 void GBTree::SaveModel(Json* p_out) const {
+  model_.CheckNotShared("Saving model");
   auto& out = *p_out;
   out["name"] = String("gbtree");
   out["model"] = Object();
@@ -444,6 +543,8 @@ void GBTree::Slice(int32_t layer_begin, int32_t layer_end, int32_t step,
   CHECK(configured_);
   CHECK(out);
 
+  model_.CheckNotShared("Slicing model");
+
   auto p_gbtree = dynamic_cast<GBTree *>(out);
   CHECK(p_gbtree);
   GBTreeModel &out_model = p_gbtree->model_;
@@ -455,11 +556,12 @@ void GBTree::Slice(int32_t layer_begin, int32_t layer_end, int32_t step,
   CHECK_GT(layer_end, layer_begin);
   CHECK_GE(step, 1);
   int32_t n_layers = (layer_end - layer_begin) / step;
-  std::vector<std::unique_ptr<RegTree>> &out_trees = out_model.trees;
+  std::vector<std::shared_ptr<RegTree>> &out_trees = out_model.trees;
   out_trees.resize(layer_trees * n_layers);
   std::vector<int32_t> &out_trees_info = out_model.tree_info;
   out_trees_info.resize(layer_trees * n_layers);
   out_model.param.num_trees = out_model.trees.size();
+  out_model.Invalidate();
   if (!this->model_.trees_to_update.empty()) {
     CHECK_EQ(this->model_.trees_to_update.size(), this->model_.trees.size())
         << "Not all trees are updated, "
@@ -471,11 +573,9 @@ void GBTree::Slice(int32_t layer_begin, int32_t layer_end, int32_t step,
   *out_of_bound = detail::SliceTrees(
       layer_begin, layer_end, step, this->model_, tparam_, layer_trees,
       [&](auto const &in_it, auto const &out_it) {
-        auto new_tree =
-            std::make_unique<RegTree>(*this->model_.trees.at(in_it));
-        bst_group_t group = this->model_.tree_info[in_it];
-        out_trees.at(out_it) = std::move(new_tree);
-        out_trees_info.at(out_it) = group;
+        // Share the tree instead of copying it.
+        out_trees.at(out_it) = this->model_.trees.at(in_it);
+        out_trees_info.at(out_it) = this->model_.tree_info[in_it];
       });
 }
 
@@ -502,6 +602,9 @@ void GBTree::PredictBatch(DMatrix* p_fmat,
   if (out_preds->predictions.Size() == 0 && p_fmat->Info().num_row_ != 0) {
     CHECK_EQ(out_preds->version, 0);
   }
+  common::PerfCounters::Get()->Add(out_preds->version == 0
+                                       ? common::PerfCounters::kPredictionCacheMisses
+                                       : common::PerfCounters::kPredictionCacheHits);
 
   auto const& predictor = GetPredictor(&out_preds->predictions, p_fmat);
   if (out_preds->version == 0) {
@@ -526,10 +629,55 @@ void GBTree::PredictBatch(DMatrix* p_fmat,
   }
 }
 
+std::shared_ptr<FeatureStats const> GBTree::GetFeatureStats() const {
+  std::lock_guard<std::mutex> guard{feature_stats_lock_};
+  if (!feature_stats_ || feature_stats_->Generation() != model_.Generation() ||
+      feature_stats_->Size() > model_.trees.size()) {
+    feature_stats_ = std::make_shared<FeatureStats>(model_.Generation());
+    feature_stats_->Extend(model_, generic_param_->Threads());
+  } else if (feature_stats_->Size() < model_.trees.size()) {
+    if (feature_stats_.use_count() != 1) {
+      // Statistics are still used by another query, extend on a copy.
+      feature_stats_ = std::make_shared<FeatureStats>(*feature_stats_);
+    }
+    feature_stats_->Extend(model_, generic_param_->Threads());
+  }
+  return feature_stats_;
+}
+
+void GBTree::UseSharedForest(common::Span<char const> image,
+                             std::shared_ptr<void const> owner) {
+  auto forest = predictor::FlatForest::FromImage(image, std::move(owner), model_.Generation());
+  CHECK_EQ(forest->Size(), model_.trees.size())
+      << "Flattened forest doesn't match trees of the model.";
+  model_.shared_forest = std::move(forest);
+}
+
+void GBTree::GenerateSource(std::string* out) const {
+  model_.CheckNotShared("Code generation");
+  std::ostringstream os;
+  predictor::GenerateForestSource(model_, &os);
+  *out = os.str();
+}
+
 std::unique_ptr<Predictor> const &
 GBTree::GetPredictor(HostDeviceVector<float> const *out_pred,
                      DMatrix *f_dmat) const {
   CHECK(configured_);
+  if (model_.shared_forest) {
+    CHECK(tparam_.predictor == PredictorType::kAuto ||
+          tparam_.predictor == PredictorType::kCPUPredictor)
+        << "Shared model is only supported by `cpu_predictor`.";
+    CHECK(cpu_predictor_);
+    return cpu_predictor_;
+  }
+  if (model_.IsMultiTarget()) {
+    CHECK(tparam_.predictor == PredictorType::kAuto ||
+          tparam_.predictor == PredictorType::kCPUPredictor)
+        << "Multi-target trees are only supported by `cpu_predictor`.";
+    CHECK(cpu_predictor_);
+    return cpu_predictor_;
+  }
   if (tparam_.predictor != PredictorType::kAuto) {
     if (tparam_.predictor == PredictorType::kGPUPredictor) {
 #if defined(XGBOOST_USE_CUDA)
@@ -548,6 +696,14 @@ GBTree::GetPredictor(HostDeviceVector<float> const *out_pred,
       common::AssertOneAPISupport();
 #endif  // defined(XGBOOST_USE_ONEAPI)
     }
+    if (tparam_.predictor == PredictorType::kQuickScorerPredictor) {
+      CHECK(quickscorer_predictor_);
+      return quickscorer_predictor_;
+    }
+    if (tparam_.predictor == PredictorType::kCompiledPredictor) {
+      CHECK(compiled_predictor_);
+      return compiled_predictor_;
+    }
     CHECK(cpu_predictor_);
     return cpu_predictor_;
   }
@@ -635,6 +791,9 @@ void GPUDartInplacePredictInc(common::Span<float> out_predts,
 
 
 class Dart : public GBTree {
+  // Pairs of tree index and weight.
+  using TreeWeights = std::vector<std::pair<size_t, float>>;
+
  public:
   explicit Dart(LearnerModelParam const* booster_config) :
       GBTree(booster_config) {}
@@ -642,6 +801,8 @@ class Dart : public GBTree {
   void Configure(const Args& cfg) override {
     GBTree::Configure(cfg);
     dparam_.UpdateAllowUnknown(cfg);
+    CHECK(tparam_.multi_strategy == MultiStrategy::kOneOutputPerTree)
+        << "`multi_output_tree` is not supported by dart.";
   }
 
   void Slice(int32_t layer_begin, int32_t layer_end, int32_t step,
@@ -725,46 +886,15 @@ class Dart : public GBTree {
     uint32_t tree_begin, tree_end;
     std::tie(tree_begin, tree_end) =
         detail::LayerToTree(model_, tparam_, layer_begin, layer_end);
-    auto n_groups = model_.learner_model_param->num_output_group;
-
-    PredictionCacheEntry predts;  // temporary storage for prediction
-    if (generic_param_->gpu_id != GenericParameter::kCpuId) {
-      predts.predictions.SetDevice(generic_param_->gpu_id);
-    }
-    predts.predictions.Resize(p_fmat->Info().num_row_ * n_groups, 0);
 
+    TreeWeights trees;
     for (size_t i = tree_begin; i < tree_end; i += 1) {
       if (training && std::binary_search(idx_drop_.cbegin(), idx_drop_.cend(), i)) {
         continue;
       }
-
-      CHECK_GE(i, p_out_preds->version);
-      auto version = i / this->LayerTrees();
-      p_out_preds->version = version;
-      predts.predictions.Fill(0);
-      predictor->PredictBatch(p_fmat, &predts, model_, i, i + 1);
-
-      // Multiple the weight to output prediction.
-      auto w = this->weight_drop_.at(i);
-      auto group = model_.tree_info.at(i);
-      CHECK_EQ(p_out_preds->predictions.Size(), predts.predictions.Size());
-
-      size_t n_rows = p_fmat->Info().num_row_;
-      if (predts.predictions.DeviceIdx() != GenericParameter::kCpuId) {
-        p_out_preds->predictions.SetDevice(predts.predictions.DeviceIdx());
-        GPUDartPredictInc(p_out_preds->predictions.DeviceSpan(),
-                          predts.predictions.DeviceSpan(), w, n_rows, n_groups,
-                          group);
-      } else {
-        auto &h_out_predts = p_out_preds->predictions.HostVector();
-        auto &h_predts = predts.predictions.HostVector();
-#pragma omp parallel for
-        for (omp_ulong ridx = 0; ridx < p_fmat->Info().num_row_; ++ridx) {
-          const size_t offset = ridx * n_groups + group;
-          h_out_predts[offset] += (h_predts[offset] * w);
-        }
-      }
+      trees.emplace_back(i, this->weight_drop_.at(i));
     }
+    this->PredictWeightedTrees(p_fmat, trees, &p_out_preds->predictions);
   }
 
   void PredictBatch(DMatrix* p_fmat,
@@ -773,7 +903,49 @@ class Dart : public GBTree {
                     unsigned layer_begin,
                     unsigned layer_end) override {
     DropTrees(training);
-    this->PredictBatchImpl(p_fmat, p_out_preds, training, layer_begin, layer_end);
+    if (p_out_preds == drop_entry_) {
+      drop_entry_ = nullptr;
+    }
+    uint32_t n_layers = this->BoostedRounds();
+    if (layer_begin != 0 || (layer_end != 0 && layer_end < n_layers)) {
+      // Cache is only maintained for the full model.
+      this->PredictBatchImpl(p_fmat, p_out_preds, training, layer_begin, layer_end);
+      return;
+    }
+
+    // Bring the cache up to date with current tree weights.
+    this->SyncHistory();
+    auto version = p_out_preds->version;
+    size_t n_predts = p_fmat->Info().num_row_ * model_.learner_model_param->num_output_group;
+    if (version == 0 || version > n_layers || version < history_begin_ ||
+        p_out_preds->predictions.Size() != n_predts) {
+      this->PredictBatchImpl(p_fmat, p_out_preds, false, 0, n_layers);
+    } else {
+      for (auto layer = version; layer < n_layers; ++layer) {
+        this->PredictWeightedTrees(p_fmat, history_.at(layer - history_begin_),
+                                   &p_out_preds->predictions);
+      }
+    }
+    p_out_preds->version = n_layers;
+    if (!training) {
+      return;
+    }
+
+    // Remove the dropped trees, they are restored with new weights in `CommitModel`.
+    dropped_predts_.Resize(0);
+    if (!idx_drop_.empty()) {
+      TreeWeights dropped;
+      for (auto i : idx_drop_) {
+        dropped.emplace_back(i, weight_drop_.at(i));
+      }
+      dropped_predts_.SetDevice(p_out_preds->predictions.DeviceIdx());
+      dropped_predts_.Resize(n_predts, 0);
+      this->PredictWeightedTrees(p_fmat, dropped, &dropped_predts_);
+      this->AddScaled(&dropped_predts_, -1.0f, &p_out_preds->predictions);
+    }
+    // Predictions no longer represent the full model.
+    p_out_preds->version = 0;
+    drop_entry_ = p_out_preds;
   }
 
   void InplacePredict(dmlc::any const &x, std::shared_ptr<DMatrix> p_m,
@@ -864,6 +1036,16 @@ class Dart : public GBTree {
     }
   }
 
+  void PredictRows(common::Span<float const>, float, common::Span<float>, uint32_t,
+                   uint32_t) const override {
+    LOG(FATAL) << "Row prediction is not supported by dart booster.";
+  }
+
+  void PredictCascade(DMatrix*, HostDeviceVector<bst_float>*, std::vector<uint32_t>*,
+                      uint32_t, float, float, uint32_t, uint32_t) const override {
+    LOG(FATAL) << "Cascaded prediction is not supported by dart booster.";
+  }
+
   void PredictInstance(const SparsePage::Inst &inst,
                        std::vector<bst_float> *out_preds,
                        unsigned layer_begin, unsigned layer_end) override {
@@ -899,15 +1081,111 @@ class Dart : public GBTree {
   // commit new trees all at once
   void
   CommitModel(std::vector<std::vector<std::unique_ptr<RegTree>>>&& new_trees,
-              DMatrix*, PredictionCacheEntry*) override {
+              DMatrix* p_fmat, PredictionCacheEntry* predts) override {
+    this->SyncHistory();
+    uint32_t n_layers = this->BoostedRounds();
     int num_new_trees = 0;
     for (uint32_t gid = 0; gid < model_.learner_model_param->num_output_group; ++gid) {
       num_new_trees += new_trees[gid].size();
       model_.CommitModel(std::move(new_trees[gid]), gid);
     }
-    size_t num_drop = NormalizeTrees(num_new_trees);
+    TreeWeights delta;
+    float drop_factor = 1.0f;
+    size_t num_drop = NormalizeTrees(num_new_trees, &delta, &drop_factor);
+    history_.emplace_back(delta);
     LOG(INFO) << "drop " << num_drop << " trees, "
               << "weight = " << weight_drop_.back();
+
+    if (predts == nullptr || predts != drop_entry_) {
+      return;
+    }
+    drop_entry_ = nullptr;
+    // Restore the dropped trees with their new weights, then add new trees.
+    if (dropped_predts_.Size() != 0) {
+      this->AddScaled(&dropped_predts_, drop_factor, &predts->predictions);
+    }
+    TreeWeights added;
+    for (size_t i = model_.trees.size() - num_new_trees; i < model_.trees.size(); ++i) {
+      added.emplace_back(i, weight_drop_.at(i));
+    }
+    this->PredictWeightedTrees(p_fmat, added, &predts->predictions);
+    predts->version = n_layers + 1;
+  }
+
+  // New trees have weights other than 1.
+  bool UnitTreeWeights() const override { return false; }
+
+  // Add predictions of trees multiplied by their weights to `out_predts`.
+  void PredictWeightedTrees(DMatrix* p_fmat, TreeWeights const& trees,
+                            HostDeviceVector<float>* out_predts) const {
+    if (trees.empty()) {
+      return;
+    }
+    auto &predictor = this->GetPredictor(out_predts, p_fmat);
+    CHECK(predictor);
+    auto n_groups = model_.learner_model_param->num_output_group;
+    size_t n_rows = p_fmat->Info().num_row_;
+
+    PredictionCacheEntry predts;  // temporary storage for prediction
+    if (generic_param_->gpu_id != GenericParameter::kCpuId) {
+      predts.predictions.SetDevice(generic_param_->gpu_id);
+    }
+    predts.predictions.Resize(n_rows * n_groups, 0);
+    for (auto const& tree : trees) {
+      auto i = tree.first;
+      auto w = tree.second;
+      predts.predictions.Fill(0);
+      predictor->PredictBatch(p_fmat, &predts, model_, i, i + 1);
+
+      // Multiple the weight to output prediction.
+      auto group = model_.tree_info.at(i);
+      CHECK_EQ(out_predts->Size(), predts.predictions.Size());
+      if (predts.predictions.DeviceIdx() != GenericParameter::kCpuId) {
+        out_predts->SetDevice(predts.predictions.DeviceIdx());
+        GPUDartPredictInc(out_predts->DeviceSpan(), predts.predictions.DeviceSpan(), w,
+                          n_rows, n_groups, group);
+      } else {
+        auto &h_out_predts = out_predts->HostVector();
+        auto &h_predts = predts.predictions.HostVector();
+#pragma omp parallel for
+        for (omp_ulong ridx = 0; ridx < n_rows; ++ridx) {
+          const size_t offset = ridx * n_groups + group;
+          h_out_predts[offset] += (h_predts[offset] * w);
+        }
+      }
+    }
+  }
+
+  // out_predts += w * predts
+  void AddScaled(HostDeviceVector<float>* predts, float w,
+                 HostDeviceVector<float>* out_predts) const {
+    CHECK_EQ(predts->Size(), out_predts->Size());
+    auto n_groups = model_.learner_model_param->num_output_group;
+    size_t n_rows = predts->Size() / n_groups;
+    if (predts->DeviceIdx() != GenericParameter::kCpuId) {
+      out_predts->SetDevice(predts->DeviceIdx());
+      for (bst_group_t group = 0; group < n_groups; ++group) {
+        GPUDartPredictInc(out_predts->DeviceSpan(), predts->DeviceSpan(), w, n_rows,
+                          n_groups, group);
+      }
+    } else {
+      auto &h_out_predts = out_predts->HostVector();
+      auto const &h_predts = predts->ConstHostVector();
+      auto n = static_cast<omp_ulong>(h_predts.size());
+#pragma omp parallel for
+      for (omp_ulong i = 0; i < n; ++i) {
+        h_out_predts[i] += h_predts[i] * w;
+      }
+    }
+  }
+
+  // Discard history that doesn't belong to current trees, like after loading a model.
+  void SyncHistory() {
+    uint32_t n_layers = this->BoostedRounds();
+    if (history_begin_ + history_.size() != n_layers) {
+      history_.clear();
+      history_begin_ = n_layers;
+    }
   }
 
   // Select which trees to drop.
@@ -959,35 +1237,42 @@ class Dart : public GBTree {
     }
   }
 
-  // set normalization factors
-  inline size_t NormalizeTrees(size_t size_new_trees) {
+  /*!
+   * \brief Set normalization factors.
+   *
+   * \param size_new_trees Number of trees in the new layer.
+   * \param p_delta        Change of tree weights, including weights of new trees.
+   * \param p_factor       Factor applied to weights of dropped trees.
+   */
+  inline size_t NormalizeTrees(size_t size_new_trees, TreeWeights* p_delta, float* p_factor) {
     float lr = 1.0 * dparam_.learning_rate / size_new_trees;
     size_t num_drop = idx_drop_.size();
-    if (num_drop == 0) {
-      for (size_t i = 0; i < size_new_trees; ++i) {
-        weight_drop_.push_back(1.0);
+    auto scale_dropped = [&](float factor) {
+      for (auto i : idx_drop_) {
+        auto w = weight_drop_[i];
+        weight_drop_[i] *= factor;
+        p_delta->emplace_back(i, weight_drop_[i] - w);
       }
-    } else {
+      *p_factor = factor;
+    };
+    float new_weight = 1.0;
+    if (num_drop != 0) {
       if (dparam_.normalize_type == 1) {
         // normalize_type 1
         float factor = 1.0 / (1.0 + lr);
-        for (auto i : idx_drop_) {
-          weight_drop_[i] *= factor;
-        }
-        for (size_t i = 0; i < size_new_trees; ++i) {
-          weight_drop_.push_back(factor);
-        }
+        scale_dropped(factor);
+        new_weight = factor;
       } else {
         // normalize_type 0
         float factor = 1.0 * num_drop / (num_drop + lr);
-        for (auto i : idx_drop_) {
-          weight_drop_[i] *= factor;
-        }
-        for (size_t i = 0; i < size_new_trees; ++i) {
-          weight_drop_.push_back(1.0 / (num_drop + lr));
-        }
+        scale_dropped(factor);
+        new_weight = 1.0 / (num_drop + lr);
       }
     }
+    for (size_t i = 0; i < size_new_trees; ++i) {
+      p_delta->emplace_back(weight_drop_.size(), new_weight);
+      weight_drop_.push_back(new_weight);
+    }
     // reset
     idx_drop_.clear();
     return num_drop;
@@ -1011,6 +1296,13 @@ class Dart : public GBTree {
   std::vector<bst_float> weight_drop_;
   // indexes of dropped trees
   std::vector<size_t> idx_drop_;
+  // Change of tree weights made by each layer since `history_begin_`, used for bringing
+  // prediction cache up to date without predicting all trees.
+  std::vector<TreeWeights> history_;
+  uint32_t history_begin_ {0};
+  // Weighted prediction of dropped trees for the training cache entry `drop_entry_`.
+  HostDeviceVector<float> dropped_predts_;
+  PredictionCacheEntry const* drop_entry_ {nullptr};
   // temporal storage for per thread
   std::vector<RegTree::FVec> thread_temp_;
 };
@@ -13,6 +13,7 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <unordered_map>
@@ -28,6 +29,7 @@
 #include "xgboost/host_device_vector.h"
 
 #include "gbtree_model.h"
+#include "feature_stats.h"
 #include "../common/common.h"
 #include "../common/timer.h"
 
@@ -47,13 +49,22 @@ enum class PredictorType : int {
   kAuto = 0,
   kCPUPredictor,
   kGPUPredictor,
-  kOneAPIPredictor
+  kOneAPIPredictor,
+  kQuickScorerPredictor,
+  kCompiledPredictor
+};
+
+// how multiple outputs are represented by trees
+enum class MultiStrategy : int {
+  kOneOutputPerTree = 0,
+  kMultiOutputTree = 1
 };
 }  // namespace xgboost
 
 DECLARE_FIELD_ENUM_CLASS(xgboost::TreeMethod);
 DECLARE_FIELD_ENUM_CLASS(xgboost::TreeProcessType);
 DECLARE_FIELD_ENUM_CLASS(xgboost::PredictorType);
+DECLARE_FIELD_ENUM_CLASS(xgboost::MultiStrategy);
 
 namespace xgboost {
 namespace gbm {
@@ -71,8 +82,16 @@ struct GBTreeTrainParam : public XGBoostParameter<GBTreeTrainParam> {
   TreeProcessType process_type;
   // predictor type
   PredictorType predictor;
+  // shared library of the compiled forest for compiled_predictor
+  std::string compiled_library;
   // tree construction method
   TreeMethod tree_method;
+  // Features to compute SHAP interaction values for, stored as a JSON string.
+  std::string interaction_features;
+  // Number of rows whose predictions are cached by CPU predictor, 0 to disable.
+  size_t row_cache_size;
+  // whether a single tree with vector leaves is built for all outputs
+  MultiStrategy multi_strategy;
   // declare parameters
   DMLC_DECLARE_PARAMETER(GBTreeTrainParam) {
     DMLC_DECLARE_FIELD(num_parallel_tree)
@@ -96,7 +115,13 @@ struct GBTreeTrainParam : public XGBoostParameter<GBTreeTrainParam> {
         .add_enum("cpu_predictor", PredictorType::kCPUPredictor)
         .add_enum("gpu_predictor", PredictorType::kGPUPredictor)
         .add_enum("oneapi_predictor", PredictorType::kOneAPIPredictor)
+        .add_enum("quickscorer_predictor", PredictorType::kQuickScorerPredictor)
+        .add_enum("compiled_predictor", PredictorType::kCompiledPredictor)
         .describe("Predictor algorithm type");
+    DMLC_DECLARE_FIELD(compiled_library)
+        .set_default("")
+        .describe("Path of the shared library compiled from source generated for this model, "
+                  "used by compiled_predictor.");
     DMLC_DECLARE_FIELD(tree_method)
         .set_default(TreeMethod::kAuto)
         .add_enum("auto",      TreeMethod::kAuto)
@@ -105,6 +130,21 @@ struct GBTreeTrainParam : public XGBoostParameter<GBTreeTrainParam> {
         .add_enum("hist",      TreeMethod::kHist)
         .add_enum("gpu_hist",  TreeMethod::kGPUHist)
         .describe("Choice of tree construction method.");
+    DMLC_DECLARE_FIELD(interaction_features)
+        .set_default("")
+        .describe("Restrict SHAP interaction values to interactions involving at least one"
+                  " of the listed features, e.g. [0, 3].  Empty for all features.");
+    DMLC_DECLARE_FIELD(row_cache_size)
+        .set_default(0)
+        .describe("Maximum number of rows whose predictions are cached by CPU predictor for "
+                  "row-wise and in-place prediction, evicted in least recently used order.  "
+                  "0 disables the cache.");
+    DMLC_DECLARE_FIELD(multi_strategy)
+        .set_default(MultiStrategy::kOneOutputPerTree)
+        .add_enum("one_output_per_tree", MultiStrategy::kOneOutputPerTree)
+        .add_enum("multi_output_tree", MultiStrategy::kMultiOutputTree)
+        .describe("Build one tree for each output group, or a single tree with a vector of"
+                  " weights in each leaf shared by all output groups (hist only).");
   }
 };
 
@@ -159,7 +199,8 @@ inline std::pair<uint32_t, uint32_t> LayerToTree(gbm::GBTreeModel const &model,
                                                  GBTreeTrainParam const &tparam,
                                                  size_t layer_begin,
                                                  size_t layer_end) {
-  bst_group_t groups = model.learner_model_param->num_output_group;
+  // A multi-target tree covers all output groups.
+  bst_group_t groups = model.IsMultiTarget() ? 1 : model.learner_model_param->num_output_group;
   uint32_t tree_begin = layer_begin * groups * tparam.num_parallel_tree;
   uint32_t tree_end = layer_end * groups * tparam.num_parallel_tree;
   if (tree_end == 0) {
@@ -217,6 +258,8 @@ class GBTree : public GradientBooster {
   void DoBoost(DMatrix* p_fmat,
                HostDeviceVector<GradientPair>* in_gpair,
                PredictionCacheEntry* predt) override;
+  void DoBoostFused(DMatrix* p_fmat, HostDeviceVector<GradientPair>* in_gpair,
+                    PredictionCacheEntry* predt, GradientSource const& source) override;
 
   bool UseGPU() const override {
     return
@@ -247,9 +290,20 @@ class GBTree : public GradientBooster {
     return model_.learner_model_param->num_output_group == 1;
   }
 
+  bool AdditiveLayers() const override {
+    return this->UnitTreeWeights();
+  }
+
+  // Whether a single tree with vector leaves is built for all output groups.
+  bool MultiOutputTree() const {
+    return tparam_.multi_strategy == MultiStrategy::kMultiOutputTree &&
+           model_.learner_model_param->num_output_group > 1;
+  }
+
   // Number of trees per layer.
   auto LayerTrees() const {
-    auto n_trees = model_.learner_model_param->num_output_group * tparam_.num_parallel_tree;
+    auto n_groups = model_.IsMultiTarget() ? 1 : model_.learner_model_param->num_output_group;
+    auto n_trees = n_groups * tparam_.num_parallel_tree;
     return n_trees;
   }
 
@@ -295,60 +349,105 @@ class GBTree : public GradientBooster {
           x, p_m, model_, missing, out_preds, tree_begin, tree_end);
       CHECK(success) << msg << std::endl
                      << "Current Predictor: "
-                     << (tparam_.predictor == PredictorType::kCPUPredictor
-                             ? "cpu_predictor"
-                             : "gpu_predictor");
+                     << (tparam_.predictor == PredictorType::kGPUPredictor
+                             ? "gpu_predictor"
+                             : "cpu_predictor");
+    }
+  }
+
+  void PredictRows(common::Span<float const> values, float missing,
+                   common::Span<float> out_preds, uint32_t layer_begin,
+                   uint32_t layer_end) const override {
+    CHECK(configured_);
+    uint32_t tree_begin, tree_end;
+    std::tie(tree_begin, tree_end) =
+        detail::LayerToTree(model_, tparam_, layer_begin, layer_end);
+    CHECK_LE(tree_end, model_.trees.size()) << "Invalid number of trees.";
+    cpu_predictor_->PredictRows(values, missing, out_preds, model_, tree_begin, tree_end);
+  }
+
+  bool PredictBatchMany(DMatrix* p_fmat, std::vector<GradientBooster const*> const& boosters,
+                        std::vector<HostDeviceVector<bst_float>*> const& out_preds)
+      const override {
+    CHECK(configured_);
+    std::vector<GBTreeModel const*> models;
+    for (auto const* booster : boosters) {
+      auto const* gbtree = dynamic_cast<GBTree const*>(booster);
+      // Weighted trees of dart and models configured for GPU are predicted one by one.
+      if (!gbtree || !gbtree->UnitTreeWeights() || gbtree->UseGPU() ||
+          gbtree->model_.shared_forest) {
+        return false;
+      }
+      models.push_back(&gbtree->model_);
+    }
+    for (size_t i = 0; i < models.size(); ++i) {
+      cpu_predictor_->InitOutPredictions(p_fmat->Info(), out_preds[i], *models[i]);
     }
+    cpu_predictor_->PredictBatchMany(p_fmat, models, out_preds);
+    return true;
+  }
+
+  void PredictCascade(DMatrix* p_fmat, HostDeviceVector<bst_float>* out_preds,
+                      std::vector<uint32_t>* out_n_trees, uint32_t stage_layers,
+                      float margin_lower, float margin_upper, uint32_t layer_begin,
+                      uint32_t layer_end) const override {
+    CHECK(configured_);
+    CHECK_GT(stage_layers, 0) << "Number of layers in each stage must be positive.";
+    uint32_t tree_begin, tree_end;
+    std::tie(tree_begin, tree_end) =
+        detail::LayerToTree(model_, tparam_, layer_begin, layer_end);
+    CHECK_LE(tree_end, model_.trees.size()) << "Invalid number of trees.";
+    uint32_t stage_trees = stage_layers * tparam_.num_parallel_tree *
+                           model_.learner_model_param->num_output_group;
+    cpu_predictor_->PredictCascade(p_fmat, out_preds, out_n_trees, model_, stage_trees,
+                                   margin_lower, margin_upper, tree_begin, tree_end);
   }
 
   void FeatureScore(std::string const& importance_type, common::Span<int32_t const> trees,
                     std::vector<bst_feature_t>* features,
                     std::vector<float>* scores) const override {
+    model_.CheckNotShared("Feature importance");
     // Because feature with no importance doesn't appear in the return value so
     // we need to set up another pair of vectors to store the values during
     // computation.
-    std::vector<size_t> split_counts(this->model_.learner_model_param->num_feature, 0);
+    auto stats = this->GetFeatureStats();
+    auto split_counts = stats->Count();
     std::vector<float> gain_map(this->model_.learner_model_param->num_feature, 0);
-    std::vector<int32_t> tree_idx;
-    if (trees.empty()) {
-      tree_idx.resize(this->model_.trees.size());
-      std::iota(tree_idx.begin(), tree_idx.end(), 0);
-      trees = common::Span<int32_t const>(tree_idx);
+    bool is_gain = importance_type == "gain" || importance_type == "total_gain";
+    bool is_cover = importance_type == "cover" || importance_type == "total_cover";
+    if (importance_type != "weight" && !is_gain && !is_cover) {
+      LOG(FATAL)
+          << "Unknown feature importance type, expected one of: "
+          << R"({"weight", "total_gain", "total_cover", "gain", "cover"}, got: )"
+          << importance_type;
     }
 
-    auto total_n_trees = model_.trees.size();
-    auto add_score = [&](auto fn) {
+    if (trees.empty()) {
+      // totals over all trees are maintained by the cached statistics.
+      if (is_gain) {
+        gain_map = stats->Gain();
+      } else if (is_cover) {
+        gain_map = stats->Cover();
+      }
+    } else {
+      std::fill(split_counts.begin(), split_counts.end(), 0);
+      auto total_n_trees = model_.trees.size();
       for (auto idx : trees) {
-        CHECK_LE(idx, total_n_trees) << "Invalid tree index.";
-        auto const& p_tree = model_.trees[idx];
-        p_tree->WalkTree([&](bst_node_t nidx) {
-          auto const& node = (*p_tree)[nidx];
-          if (!node.IsLeaf()) {
-            split_counts[node.SplitIndex()]++;
-            fn(p_tree, nidx, node.SplitIndex());
+        CHECK_LT(idx, total_n_trees) << "Invalid tree index.";
+        for (auto const& split : stats->Splits(idx)) {
+          split_counts[split.fidx]++;
+          if (is_gain) {
+            gain_map[split.fidx] += split.gain;
+          } else if (is_cover) {
+            gain_map[split.fidx] += split.cover;
           }
-          return true;
-        });
+        }
       }
-    };
-
+    }
     if (importance_type == "weight") {
-      add_score([&](auto const &p_tree, bst_node_t, bst_feature_t split) {
-        gain_map[split] = split_counts[split];
-      });
-    } else if (importance_type == "gain" || importance_type == "total_gain") {
-      add_score([&](auto const &p_tree, bst_node_t nidx, bst_feature_t split) {
-        gain_map[split] += p_tree->Stat(nidx).loss_chg;
-      });
-    } else if (importance_type == "cover" || importance_type == "total_cover") {
-      add_score([&](auto const &p_tree, bst_node_t nidx, bst_feature_t split) {
-        gain_map[split] += p_tree->Stat(nidx).sum_hess;
-      });
-    } else {
-      LOG(FATAL)
-          << "Unknown feature importance type, expected one of: "
-          << R"({"weight", "total_gain", "total_cover", "gain", "cover"}, got: )"
-          << importance_type;
+      for (size_t i = 0; i < gain_map.size(); ++i) {
+        gain_map[i] = split_counts[i];
+      }
     }
     if (importance_type == "gain" || importance_type == "cover") {
       for (size_t i = 0; i < gain_map.size(); ++i) {
@@ -372,6 +471,7 @@ class GBTree : public GradientBooster {
     CHECK(configured_);
     uint32_t tree_begin, tree_end;
     std::tie(tree_begin, tree_end) = detail::LayerToTree(model_, tparam_, layer_begin, layer_end);
+    model_.CheckNotShared("Predicting single instance");
     cpu_predictor_->PredictInstance(inst, out_preds, model_,
                                     tree_end);
   }
@@ -396,6 +496,7 @@ class GBTree : public GradientBooster {
     CHECK_EQ(tree_begin, 0)
         << "Predict contribution supports only iteration end: (0, "
            "n_iteration), using model slicing instead.";
+    model_.CheckNotShared("Predicting contribution");
     this->GetPredictor()->PredictContribution(
         p_fmat, out_contribs, model_, tree_end, nullptr, approximate);
   }
@@ -409,6 +510,7 @@ class GBTree : public GradientBooster {
     CHECK_EQ(tree_begin, 0)
         << "Predict interaction contribution supports only iteration end: (0, "
            "n_iteration), using model slicing instead.";
+    model_.CheckNotShared("Predicting interaction contribution");
     this->GetPredictor()->PredictInteractionContributions(
         p_fmat, out_contribs, model_, tree_end, nullptr, approximate);
   }
@@ -416,8 +518,16 @@ class GBTree : public GradientBooster {
   std::vector<std::string> DumpModel(const FeatureMap& fmap,
                                      bool with_stats,
                                      std::string format) const override {
+    model_.CheckNotShared("Dumping model");
     return model_.DumpModel(fmap, with_stats, format);
   }
+  void DumpModelTable(TreeTable* out) const override {
+    model_.CheckNotShared("Dumping model");
+    model_.DumpTable(out, generic_param_->Threads());
+  }
+  void GenerateSource(std::string* out) const override;
+  void UseSharedForest(common::Span<char const> image,
+                       std::shared_ptr<void const> owner) override;
 
  protected:
   // initialize updater before using them
@@ -427,10 +537,22 @@ class GBTree : public GradientBooster {
   void BoostNewTrees(HostDeviceVector<GradientPair>* gpair,
                      DMatrix *p_fmat,
                      int bst_group,
-                     std::vector<std::unique_ptr<RegTree> >* ret);
+                     std::vector<std::unique_ptr<RegTree> >* ret,
+                     GradientSource const* source = nullptr);
+  // `source` is null if the gradient is already computed.
+  void DoBoostImpl(DMatrix* p_fmat, HostDeviceVector<GradientPair>* in_gpair,
+                   PredictionCacheEntry* predt, GradientSource const* source);
 
   std::unique_ptr<Predictor> const& GetPredictor(HostDeviceVector<float> const* out_pred = nullptr,
                                                  DMatrix* f_dmat = nullptr) const;
+  /*! \brief Get split statistics of current model, extended or rebuilt as needed. */
+  std::shared_ptr<FeatureStats const> GetFeatureStats() const;
+
+  /*!
+   * \brief Whether trees are summed with unit weight, in which case updaters can add new
+   *        trees to the prediction cache directly.
+   */
+  virtual bool UnitTreeWeights() const { return true; }
 
   // commit new trees all at once
   virtual void CommitModel(std::vector<std::vector<std::unique_ptr<RegTree>>>&& new_trees,
@@ -451,6 +573,8 @@ class GBTree : public GradientBooster {
   std::vector<std::unique_ptr<TreeUpdater>> updaters_;
   // Predictors
   std::unique_ptr<Predictor> cpu_predictor_;
+  std::unique_ptr<Predictor> quickscorer_predictor_;
+  std::unique_ptr<Predictor> compiled_predictor_;
 #if defined(XGBOOST_USE_CUDA)
   std::unique_ptr<Predictor> gpu_predictor_;
 #endif  // defined(XGBOOST_USE_CUDA)
@@ -458,6 +582,9 @@ class GBTree : public GradientBooster {
   std::unique_ptr<Predictor> oneapi_predictor_;
 #endif  // defined(XGBOOST_USE_ONEAPI)
   common::Monitor monitor_;
+  // cached split statistics for feature importance
+  mutable std::shared_ptr<FeatureStats> feature_stats_;
+  mutable std::mutex feature_stats_lock_;
 };
 
 }  // namespace gbm
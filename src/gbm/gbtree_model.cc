@@ -1,15 +1,57 @@
 /*!
  * Copyright 2019-2020 by Contributors
  */
+#include <limits>
 #include <utility>
+#include <vector>
 
 #include "xgboost/json.h"
 #include "xgboost/logging.h"
 #include "gbtree_model.h"
 #include "gbtree.h"
+#include "../common/threading_utils.h"
 
 namespace xgboost {
 namespace gbm {
+void GBTreeModel::DumpTable(TreeTable* out, int32_t n_threads) const {
+  std::vector<size_t> tree_ptr(trees.size() + 1, 0);
+  for (size_t i = 0; i < trees.size(); ++i) {
+    CHECK(!trees[i]->IsMultiTarget()) << "Dumping table of vector leaf is not supported.";
+    auto const& p = trees[i]->param;
+    tree_ptr[i + 1] = tree_ptr[i] + p.num_nodes - p.num_deleted;
+  }
+  out->Resize(tree_ptr.back());
+  common::ParallelFor(trees.size(), n_threads, common::Sched::Dyn(), [&](size_t i) {
+    auto const& tree = *trees[i];
+    auto k = tree_ptr[i];
+    for (bst_node_t nidx = 0; nidx < tree.param.num_nodes; ++nidx) {
+      auto const& node = tree[nidx];
+      if (node.IsDeleted()) {
+        continue;
+      }
+      out->tree_id[k] = static_cast<int32_t>(i);
+      out->node_id[k] = nidx;
+      out->gain[k] = tree.Stat(nidx).loss_chg;
+      out->cover[k] = tree.Stat(nidx).sum_hess;
+      if (node.IsLeaf()) {
+        out->feature[k] = -1;
+        out->value[k] = node.LeafValue();
+        out->left[k] = out->right[k] = out->missing[k] = -1;
+      } else {
+        out->feature[k] = static_cast<int32_t>(node.SplitIndex());
+        out->value[k] = tree.NodeSplitType(nidx) == FeatureType::kCategorical
+                            ? std::numeric_limits<float>::quiet_NaN()
+                            : node.SplitCond();
+        out->left[k] = node.LeftChild();
+        out->right[k] = node.RightChild();
+        out->missing[k] = node.DefaultChild();
+      }
+      ++k;
+    }
+    CHECK_EQ(k, tree_ptr[i + 1]);
+  });
+}
+
 void GBTreeModel::Save(dmlc::Stream* fo) const {
   CHECK_EQ(param.num_trees, static_cast<int32_t>(trees.size()));
 
@@ -43,6 +85,7 @@ void GBTreeModel::Load(dmlc::Stream* fi) {
   }
   trees.clear();
   trees_to_update.clear();
+  this->Invalidate();
   for (int32_t i = 0; i < param.num_trees; ++i) {
     std::unique_ptr<RegTree> ptr(new RegTree());
     ptr->Load(fi);
@@ -77,13 +120,8 @@ void GBTreeModel::SaveModel(Json* p_out) const {
     trees_json[t] = std::move(tree_json);
   }
 
-  std::vector<Json> tree_info_json(tree_info.size());
-  for (size_t i = 0; i < tree_info.size(); ++i) {
-    tree_info_json[i] = Integer(tree_info[i]);
-  }
-
   out["trees"] = Array(std::move(trees_json));
-  out["tree_info"] = Array(std::move(tree_info_json));
+  out["tree_info"] = I32Array{std::vector<int32_t>(tree_info.cbegin(), tree_info.cend())};
 }
 
 void GBTreeModel::LoadModel(Json const& in) {
@@ -91,6 +129,7 @@ void GBTreeModel::LoadModel(Json const& in) {
 
   trees.clear();
   trees_to_update.clear();
+  this->Invalidate();
 
   auto const& trees_json = get<Array const>(in["trees"]);
   trees.resize(trees_json.size());
@@ -101,11 +140,9 @@ void GBTreeModel::LoadModel(Json const& in) {
     trees.at(tree_id)->LoadModel(trees_json[t]);
   }
 
-  tree_info.resize(param.num_trees);
-  auto const& tree_info_json = get<Array const>(in["tree_info"]);
-  for (int32_t i = 0; i < param.num_trees; ++i) {
-    tree_info[i] = get<Integer const>(tree_info_json[i]);
-  }
+  auto tree_info_json = GetNumericArray<int32_t>(in["tree_info"]);
+  CHECK_GE(tree_info_json.size(), static_cast<size_t>(param.num_trees));
+  tree_info.assign(tree_info_json.cbegin(), tree_info_json.cbegin() + param.num_trees);
 }
 
 }  // namespace gbm
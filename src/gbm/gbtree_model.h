@@ -12,6 +12,7 @@
 #include <xgboost/parameter.h>
 #include <xgboost/learner.h>
 
+#include <atomic>
 #include <memory>
 #include <utility>
 #include <string>
@@ -23,6 +24,10 @@ namespace xgboost {
 
 class Json;
 
+namespace predictor {
+class FlatForest;
+}  // namespace predictor
+
 namespace gbm {
 
 /*! \brief model parameters */
@@ -94,12 +99,14 @@ struct GBTreeModel : public Model {
 
   void InitTreesToUpdate() {
     if (trees_to_update.size() == 0u) {
-      for (auto & tree : trees) {
-        trees_to_update.push_back(std::move(tree));
+      // Committed trees might be shared with sliced models, update a private copy.
+      for (auto const& tree : trees) {
+        trees_to_update.push_back(std::make_unique<RegTree>(*tree));
       }
       trees.clear();
       param.num_trees = 0;
       tree_info.clear();
+      this->Invalidate();
     }
   }
 
@@ -117,6 +124,10 @@ struct GBTreeModel : public Model {
     });
     return dump;
   }
+  /*! \brief Write nodes of all trees into a table, trees are processed in parallel. */
+  void DumpTable(TreeTable* out, int32_t n_threads) const;
+  /*! \brief Whether trees have vector leaves covering all output groups. */
+  bool IsMultiTarget() const { return !trees.empty() && trees.front()->IsMultiTarget(); }
   void CommitModel(std::vector<std::unique_ptr<RegTree> >&& new_trees,
                    int bst_group) {
     for (auto & new_tree : new_trees) {
@@ -125,17 +136,46 @@ struct GBTreeModel : public Model {
     }
     param.num_trees += static_cast<int>(new_trees.size());
   }
+  /*!
+   * \brief Identifier of current set of trees.  Appending new trees with `CommitModel`
+   *        keeps the identifier, any other change to existing trees must call `Invalidate`
+   *        so that structures derived from the trees (like the flattened forest used by
+   *        predictor) can be rebuilt.
+   */
+  uint64_t Generation() const { return generation_; }
+  void Invalidate() { generation_ = NewGeneration(); }
 
   // base margin
   LearnerModelParam const* learner_model_param;
   // model parameter
   GBTreeModelParam param;
-  /*! \brief vector of trees stored in the model */
-  std::vector<std::unique_ptr<RegTree> > trees;
+  /*!
+   * \brief vector of trees stored in the model.  Trees are immutable once committed and
+   *        can be shared between models, for instance by `GBTree::Slice`.
+   */
+  std::vector<std::shared_ptr<RegTree> > trees;
   /*! \brief for the update process, a place to keep the initial trees */
   std::vector<std::unique_ptr<RegTree> > trees_to_update;
   /*! \brief some information indicator of the tree, reserved */
   std::vector<int> tree_info;
+  /*!
+   * \brief Flattened forest viewing a shared model image, see `Learner::LoadSharedModel`.
+   *        Trees of such model are single leaf placeholders, so only predictions made
+   *        through the forest are available.
+   */
+  std::shared_ptr<predictor::FlatForest const> shared_forest;
+
+  void CheckNotShared(char const* op) const {
+    CHECK(!shared_forest) << op << " is not supported by shared model, which only keeps "
+                                   "the flattened forest for prediction.";
+  }
+
+ private:
+  static uint64_t NewGeneration() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+  }
+  uint64_t generation_{NewGeneration()};
 };
 }  // namespace gbm
 }  // namespace xgboost
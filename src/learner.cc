@@ -9,11 +9,19 @@
 #include <dmlc/thread_local.h>
 
 #include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
 #include <mutex>
+#include <thread>
 #include <algorithm>
+#include <functional>
 #include <iomanip>
 #include <limits>
+#include <map>
 #include <memory>
+#include <numeric>
+#include <set>
 #include <sstream>
 #include <string>
 #include <stack>
@@ -37,18 +45,41 @@
 #include "xgboost/objective.h"
 #include "xgboost/parameter.h"
 
+#include "common/category_dictionary.h"
 #include "common/common.h"
 #include "common/io.h"
+#include "common/memory_tracker.h"
 #include "common/observer.h"
+#include "common/perf_counters.h"
 #include "common/random.h"
 #include "common/timer.h"
 #include "common/charconv.h"
 #include "common/version.h"
 #include "common/threading_utils.h"
+#include "data/proxy_dmatrix.h"
+#include "predictor/flat_forest.h"
+#include "tree/compact_tree.h"
 
 namespace {
 
 const char* kMaxDeltaStepDefaultValue = "0.7";
+
+/*!
+ * \brief Both text JSON and UBJSON objects start with '{', the first key of UBJSON is
+ *        prefixed by an integer type marker.
+ */
+std::ios::openmode JsonModeFromPrefix(char const* prefix) {
+  switch (prefix[1]) {
+    case 'i':
+    case 'U':
+    case 'I':
+    case 'l':
+    case 'L':
+      return std::ios::binary;
+    default:
+      return std::ios::in;
+  }
+}
 }  // anonymous namespace
 
 namespace xgboost {
@@ -68,6 +99,215 @@ bool Learner::AllowLazyCheckPoint() const {
 
 Learner::~Learner() = default;
 
+namespace {
+// Same as the early stopping callback in the Python package.
+bool IsMaximizeMetric(std::string const& name) {
+  if (name == "mape") {
+    return false;
+  }
+  for (char const* prefix : {"auc", "aucpr", "map", "ndcg"}) {
+    if (name.find(prefix) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// FNV-1a over the shape of data and meta info affecting the prediction.  The feature values
+// are not hashed as it's as costly as prediction for a large dataset.
+uint64_t DataFingerprint(MetaInfo const& info) {
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&](void const* ptr, size_t n_bytes) {
+    auto const* bytes = static_cast<uint8_t const*>(ptr);
+    for (size_t i = 0; i < n_bytes; ++i) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+  };
+  auto mix_vec = [&](std::vector<float> const& vec) {
+    uint64_t size = vec.size();
+    mix(&size, sizeof(size));
+    mix(vec.data(), vec.size() * sizeof(float));
+  };
+  mix(&info.num_row_, sizeof(info.num_row_));
+  mix(&info.num_col_, sizeof(info.num_col_));
+  mix(&info.num_nonzero_, sizeof(info.num_nonzero_));
+  mix_vec(info.labels_.ConstHostVector());
+  mix_vec(info.weights_.ConstHostVector());
+  mix_vec(info.base_margin_.Data()->ConstHostVector());
+  return hash;
+}
+
+constexpr char kPredictionCacheMagic[] = "xgpc";
+}  // anonymous namespace
+
+TrainLoopResult Learner::Train(std::shared_ptr<DMatrix> train,
+                               std::vector<std::shared_ptr<DMatrix>> const& evals,
+                               TrainLoopParam const& param) {
+  CHECK_GE(param.num_boost_round, 0) << "Invalid number of boosting rounds.";
+  CHECK_GE(param.early_stopping_rounds, 0) << "Invalid number of early stopping rounds.";
+  CHECK_GT(param.eval_period, 0) << "Invalid evaluation period.";
+  bool early_stopping = param.early_stopping_rounds > 0;
+  CHECK(!early_stopping || !evals.empty())
+      << "Early stopping requires at least one evaluation dataset.";
+
+  this->Configure();
+  int32_t const begin = this->BoostedRounds();
+  int32_t const end = begin + param.num_boost_round;
+  TrainLoopResult result;
+  std::vector<std::string> names;
+  std::vector<double> scores;
+  size_t metric_idx = 0;
+  bool maximize = false;
+
+  for (int32_t iter = begin; iter < end; ++iter) {
+    this->UpdateOneIter(iter, train);
+    ++result.n_rounds;
+    if (evals.empty() || ((iter - begin + 1) % param.eval_period != 0 && iter != end - 1)) {
+      continue;
+    }
+    this->EvalMetrics(evals, &names, &scores);
+    CHECK(!names.empty()) << "No evaluation metric is available.";
+    if (result.best_iteration < 0) {
+      if (param.metric.empty()) {
+        metric_idx = names.size() - 1;
+      } else {
+        auto it = std::find(names.cbegin(), names.cend(), param.metric);
+        CHECK(it != names.cend()) << "Unknown metric for early stopping: " << param.metric;
+        metric_idx = std::distance(names.cbegin(), it);
+      }
+      maximize = param.maximize < 0 ? IsMaximizeMetric(names[metric_idx]) : param.maximize != 0;
+      result.maximize = maximize;
+    }
+    double score = scores[(evals.size() - 1) * names.size() + metric_idx];
+    if (result.best_iteration < 0 ||
+        (maximize ? score > result.best_score : score < result.best_score)) {
+      result.best_iteration = iter;
+      result.best_score = score;
+    } else if (early_stopping && iter - result.best_iteration >= param.early_stopping_rounds) {
+      break;
+    }
+  }
+
+  if (early_stopping && result.best_iteration >= 0) {
+    std::ostringstream os;
+    os.precision(std::numeric_limits<double>::max_digits10);
+    os << result.best_score;
+    this->SetAttr("best_score", os.str());
+    this->SetAttr("best_iteration", std::to_string(result.best_iteration));
+  }
+  return result;
+}
+
+std::vector<TrainLoopResult> Learner::TrainSweep(
+    std::vector<Learner*> const& learners, std::shared_ptr<DMatrix> train,
+    std::vector<std::shared_ptr<DMatrix>> const& evals, SweepParam const& param) {
+  CHECK(!learners.empty()) << "No booster to train.";
+  CHECK_GE(param.num_boost_round, 0) << "Invalid number of boosting rounds.";
+  CHECK_GE(param.rung_rounds, 0) << "Invalid number of rounds in a rung.";
+  CHECK(param.keep_ratio > 0.0 && param.keep_ratio <= 1.0) << "Invalid keep ratio.";
+  int32_t const rung = param.rung_rounds == 0 ? param.num_boost_round : param.rung_rounds;
+  CHECK(!evals.empty() || rung >= param.num_boost_round)
+      << "Successive halving requires at least one evaluation dataset.";
+  auto const n_threads = common::OmpGetNumThreads(param.n_threads);
+
+  std::vector<std::string> nthread_original(learners.size(), "0");
+  for (size_t i = 0; i < learners.size(); ++i) {
+    auto const& args = learners[i]->GetConfigurationArguments();
+    auto it = args.find("nthread");
+    if (it != args.cend()) {
+      nthread_original[i] = it->second;
+    }
+  }
+
+  std::vector<TrainLoopResult> results(learners.size());
+  std::vector<double> last_scores(learners.size(), 0.0);
+  TrainLoopParam loop;
+  loop.metric = param.metric;
+  loop.maximize = param.maximize;
+  auto train_one = [&](size_t i, int32_t rounds, int32_t threads) {
+    auto* learner = learners[i];
+    learner->SetParam("nthread", std::to_string(threads));
+    TrainLoopParam this_loop = loop;
+    this_loop.num_boost_round = rounds;
+    this_loop.eval_period = std::max(rounds, 1);
+    auto r = learner->Train(train, evals, this_loop);
+    auto& result = results[i];
+    result.n_rounds += r.n_rounds;
+    if (r.best_iteration >= 0) {
+      result.maximize = r.maximize;
+      last_scores[i] = r.best_score;
+      if (result.best_iteration < 0 ||
+          (r.maximize ? r.best_score > result.best_score : r.best_score < result.best_score)) {
+        result.best_iteration = r.best_iteration;
+        result.best_score = r.best_score;
+      }
+    }
+  };
+
+  std::vector<size_t> active(learners.size());
+  std::iota(active.begin(), active.end(), 0);
+  int32_t done = 0;
+  // Keep the best boosters at the end of each rung.
+  auto halve = [&]() {
+    if (done % rung != 0 || done >= param.num_boost_round || active.size() <= 1) {
+      return;
+    }
+    auto maximize = results[active.front()].maximize;
+    std::stable_sort(active.begin(), active.end(), [&](size_t l, size_t r) {
+      return maximize ? last_scores[l] > last_scores[r] : last_scores[l] < last_scores[r];
+    });
+    auto n_keep = static_cast<size_t>(
+        std::ceil(static_cast<double>(active.size()) * param.keep_ratio));
+    active.resize(std::max(n_keep, static_cast<size_t>(1)));
+    std::sort(active.begin(), active.end());
+  };
+
+  if (param.num_boost_round > 0) {
+    // Lazily built data is shared, so the first round of each booster runs alone.
+    for (auto i : active) {
+      train_one(i, 1, n_threads);
+    }
+    done = 1;
+    halve();
+  }
+  while (done < param.num_boost_round) {
+    // Shorter first rung, as it includes the first round.
+    int32_t rounds = std::min(rung - done % rung, param.num_boost_round - done);
+    size_t n_workers = std::min(active.size(), static_cast<size_t>(n_threads));
+    int32_t threads = std::max(n_threads / static_cast<int32_t>(n_workers), 1);
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> errors(n_workers);
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < n_workers; ++w) {
+      workers.emplace_back([&, w] {
+        try {
+          for (size_t k = next++; k < active.size(); k = next++) {
+            train_one(active[k], rounds, threads);
+          }
+        } catch (...) {
+          errors[w] = std::current_exception();
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    for (auto const& e : errors) {
+      if (e) {
+        std::rethrow_exception(e);
+      }
+    }
+    done += rounds;
+    halve();
+  }
+
+  for (size_t i = 0; i < learners.size(); ++i) {
+    learners[i]->SetParam("nthread", nthread_original[i]);
+  }
+  return results;
+}
+
 /*! \brief training parameter for regression
  *
  * Should be deprecated, but still used for being compatible with binary IO.
@@ -171,6 +411,10 @@ struct LearnerTrainParam : public XGBoostParameter<LearnerTrainParam> {
   DataSplitMode dsplit {DataSplitMode::kAuto};
   // flag to disable default metric
   bool disable_default_eval_metric {false};
+  // compute gradient during the first pass of tree construction when supported.
+  bool fuse_gradient {false};
+  // number of threads used by asynchronous evaluation, 0 means the same as nthread.
+  int32_t eval_nthread {0};
   // FIXME(trivialfis): The following parameters belong to model itself, but can be
   // specified by users.  Move them to model parameter once we can get rid of binary IO.
   std::string booster;
@@ -187,6 +431,15 @@ struct LearnerTrainParam : public XGBoostParameter<LearnerTrainParam> {
     DMLC_DECLARE_FIELD(disable_default_eval_metric)
         .set_default(false)
         .describe("Flag to disable default metric. Set to >0 to disable");
+    DMLC_DECLARE_FIELD(fuse_gradient)
+        .set_default(false)
+        .describe("Compute gradient while building the root histogram of trees instead of "
+                  "in a separated pass over data.  Only used by supported objectives on CPU.");
+    DMLC_DECLARE_FIELD(eval_nthread)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe("Number of threads used by asynchronous evaluation, 0 means the same as "
+                  "nthread.");
     DMLC_DECLARE_FIELD(booster)
         .set_default("gbtree")
         .describe("Gradient booster used for training.");
@@ -250,6 +503,51 @@ using ThreadLocalPredictionCache =
 class LearnerConfiguration : public Learner {
  private:
   std::mutex config_lock_;
+  // Keys passed to `SetParam` since the last configuration.
+  std::set<std::string> changed_params_;
+  // Whether any of the changed keys is new, which needs validation.
+  bool new_params_{false};
+  // Whether the learner itself needs configuration, instead of only its components.
+  bool full_configuration_{true};
+
+  /*! \brief Whether the parameter belongs to the learner instead of its components. */
+  static bool IsLearnerParameter(std::string const& key) {
+    static std::set<std::string> const kKeys = [] {
+      std::set<std::string> keys;
+      for (auto const& fields :
+           {LearnerTrainParam::__FIELDS__(), LearnerModelParamLegacy::__FIELDS__(),
+            GenericParameter::__FIELDS__()}) {
+        for (auto const& field : fields) {
+          keys.insert(field.name);
+        }
+      }
+      return keys;
+    }();
+    return kKeys.find(key) != kKeys.cend();
+  }
+
+  /*!
+   * \brief Reconfigure components after `SetParam` when none of the learner parameters
+   *        changed, which skips feature counting and parameter validation.
+   */
+  void ConfigureComponents() {
+    monitor_.Start("ConfigureComponents");
+    Args args = {cfg_.cbegin(), cfg_.cend()};
+    ConsoleLogger::Configure(args);
+    obj_->Configure(args);
+    gbm_->Configure(args);
+    generic_parameters_.ConfigureGpuId(this->gbm_->UseGPU());
+    this->ConfigureMetrics(args);
+
+    bool validate = new_params_;
+    changed_params_.clear();
+    new_params_ = false;
+    this->need_configuration_ = false;
+    if (validate && generic_parameters_.validate_parameters) {
+      this->ValidateParameters();
+    }
+    monitor_.Stop("ConfigureComponents");
+  }
 
  protected:
   static std::string const kEvalMetric;  // NOLINT
@@ -263,12 +561,33 @@ class LearnerConfiguration : public Learner {
   std::vector<std::string> feature_names_;
   // Type of each feature, usually set from DMatrix.
   std::vector<std::string> feature_types_;
+  // String categories of features, taken from training DMatrix.
+  std::shared_ptr<common::CategoryDictionary const> categories_;
 
   common::Monitor monitor_;
   LearnerModelParamLegacy mparam_;
   LearnerModelParam learner_model_param_;
   LearnerTrainParam tparam_;
   std::vector<std::string> metric_names_;
+  // Memory mapped model file waiting to be parsed, see `LoadModelLazy`.
+  mutable std::unique_ptr<common::MmapFile> lazy_model_;
+  mutable std::mutex lazy_lock_;
+
+  /*! \brief Parse the model deferred by `LoadModelLazy`, if there's any. */
+  void LoadLazyModel() const {
+    std::unique_ptr<common::MmapFile> model;
+    {
+      std::lock_guard<std::mutex> guard(lazy_lock_);
+      model = std::move(lazy_model_);
+    }
+    if (!model) {
+      return;
+    }
+    // The stream only reads from the mapped buffer.
+    common::MemoryFixSizeBuffer fs(const_cast<char*>(model->Data()), model->Size());  // NOLINT
+    // Loading is logically const, the model is observed as if it were loaded eagerly.
+    const_cast<LearnerConfiguration*>(this)->LoadModel(&fs);
+  }
 
  public:
   explicit LearnerConfiguration(std::vector<std::shared_ptr<DMatrix> > cache)
@@ -286,12 +605,24 @@ class LearnerConfiguration : public Learner {
     }
   }
 
+  /*! \brief Configure the learner and all its components on the next `Configure`. */
+  void RequireFullConfiguration() {
+    full_configuration_ = true;
+    this->need_configuration_ = true;
+  }
+
   // Configuration before data is known.
   void Configure() override {
     // Varient of double checked lock
     if (!this->need_configuration_) { return; }
     std::lock_guard<std::mutex> guard(config_lock_);
     if (!this->need_configuration_) { return; }
+    this->LoadLazyModel();
+    if (!full_configuration_ &&
+        std::none_of(changed_params_.cbegin(), changed_params_.cend(), IsLearnerParameter)) {
+      this->ConfigureComponents();
+      return;
+    }
 
     monitor_.Start("Configure");
     auto old_tparam = tparam_;
@@ -347,6 +678,9 @@ class LearnerConfiguration : public Learner {
 
     this->ConfigureMetrics(args);
 
+    changed_params_.clear();
+    new_params_ = false;
+    full_configuration_ = false;
     this->need_configuration_ = false;
     if (generic_parameters_.validate_parameters) {
       this->ValidateParameters();
@@ -362,6 +696,7 @@ class LearnerConfiguration : public Learner {
 
   void LoadConfig(Json const& in) override {
     CHECK(IsA<Object>(in));
+    this->LoadLazyModel();
     Version::Load(in);
 
     auto const& learner_parameters = get<Object>(in["learner"]);
@@ -396,7 +731,7 @@ class LearnerConfiguration : public Learner {
     // make sure the GPU ID is valid in new environment before start running configure.
     generic_parameters_.ConfigureGpuId(false);
 
-    this->need_configuration_ = true;
+    this->RequireFullConfiguration();
   }
 
   void SaveConfig(Json* p_out) const override {
@@ -427,15 +762,23 @@ class LearnerConfiguration : public Learner {
   }
 
   void SetParam(const std::string& key, const std::string& value) override {
-    this->need_configuration_ = true;
+    // Setting a parameter to its current value doesn't need configuration.
     if (key == kEvalMetric) {
       if (std::find(metric_names_.cbegin(), metric_names_.cend(),
-                    value) == metric_names_.cend()) {
-        metric_names_.emplace_back(value);
+                    value) != metric_names_.cend()) {
+        return;
       }
+      metric_names_.emplace_back(value);
     } else {
+      auto it = cfg_.find(key);
+      if (it != cfg_.cend() && it->second == value) {
+        return;
+      }
+      new_params_ = new_params_ || it == cfg_.cend();
       cfg_[key] = value;
     }
+    changed_params_.insert(key);
+    this->need_configuration_ = true;
   }
   // Short hand for setting multiple parameters
   void SetParams(std::vector<std::pair<std::string, std::string>> const& args) override {
@@ -445,15 +788,18 @@ class LearnerConfiguration : public Learner {
   }
 
   uint32_t GetNumFeature() const override {
+    this->LoadLazyModel();
     return learner_model_param_.num_feature;
   }
 
   void SetAttr(const std::string& key, const std::string& value) override {
+    this->LoadLazyModel();
     attributes_[key] = value;
     mparam_.contain_extra_attrs = 1;
   }
 
   bool GetAttr(const std::string& key, std::string* out) const override {
+    this->LoadLazyModel();
     auto it = attributes_.find(key);
     if (it == attributes_.end()) return false;
     *out = it->second;
@@ -461,6 +807,7 @@ class LearnerConfiguration : public Learner {
   }
 
   bool DelAttr(const std::string& key) override {
+    this->LoadLazyModel();
     auto it = attributes_.find(key);
     if (it == attributes_.end()) { return false; }
     attributes_.erase(it);
@@ -468,23 +815,33 @@ class LearnerConfiguration : public Learner {
   }
 
   void SetFeatureNames(std::vector<std::string> const& fn) override {
+    this->LoadLazyModel();
     feature_names_ = fn;
   }
 
   void GetFeatureNames(std::vector<std::string>* fn) const override {
+    this->LoadLazyModel();
     *fn = feature_names_;
   }
 
   void SetFeatureTypes(std::vector<std::string> const& ft) override {
+    this->LoadLazyModel();
     this->feature_types_ = ft;
   }
 
   void GetFeatureTypes(std::vector<std::string>* p_ft) const override {
+    this->LoadLazyModel();
     auto& ft = *p_ft;
     ft = this->feature_types_;
   }
 
+  std::shared_ptr<common::CategoryDictionary const> GetCategories() const override {
+    this->LoadLazyModel();
+    return categories_;
+  }
+
   std::vector<std::string> GetAttrNames() const override {
+    this->LoadLazyModel();
     std::vector<std::string> out;
     for (auto const& kv : attributes_) {
       out.emplace_back(kv.first);
@@ -662,6 +1019,12 @@ class LearnerIO : public LearnerConfiguration {
   // Used to identify the offset of JSON string when
   // Will be removed once JSON takes over.  Right now we still loads some RDS files from R.
   std::string const serialisation_header_ { u8"CONFIG-offset:" };
+  // Header of compact inference only model.
+  std::string const compact_header_ { "xgbc" };
+  // Header of shared inference only model.
+  std::string const shared_header_ { "xgbs" };
+  // Flattened forest in shared model starts at cache line boundary of the file.
+  static size_t constexpr kSharedAlign = 64;
 
  public:
   explicit LearnerIO(std::vector<std::shared_ptr<DMatrix> > cache) :
@@ -669,6 +1032,8 @@ class LearnerIO : public LearnerConfiguration {
 
   void LoadModel(Json const& in) override {
     CHECK(IsA<Object>(in));
+    // Eager loading replaces any pending lazy model.
+    lazy_model_.reset();
     Version::Load(in);
     auto const& learner = get<Object>(in["learner"]);
     mparam_.FromJson(learner.at("learner_model_param"));
@@ -711,8 +1076,15 @@ class LearnerIO : public LearnerConfiguration {
         feature_types_.emplace_back(type);
       }
     }
+    it = learner.find("categories");
+    categories_.reset();
+    if (it != learner.cend()) {
+      auto categories = std::make_shared<common::CategoryDictionary>();
+      categories->LoadModel(it->second);
+      categories_ = std::move(categories);
+    }
 
-    this->need_configuration_ = true;
+    this->RequireFullConfiguration();
   }
 
   void SaveModel(Json* p_out) const override {
@@ -748,9 +1120,13 @@ class LearnerIO : public LearnerConfiguration {
     for (auto const& type : feature_types_) {
       feature_types.emplace_back(type);
     }
+    if (categories_ && !categories_->Empty()) {
+      categories_->SaveModel(&learner["categories"]);
+    }
   }
   // About to be deprecated by JSON format
   void LoadModel(dmlc::Stream* fi) override {
+    lazy_model_.reset();
     generic_parameters_.UpdateAllowUnknown(Args{});
     tparam_.Init(std::vector<std::pair<std::string, std::string>>{});
     // TODO(tqchen) mark deprecation of old format.
@@ -765,14 +1141,31 @@ class LearnerIO : public LearnerConfiguration {
       if (header == "binf") {
         CHECK_EQ(fp.Read(&header[0], 4), 4U);
       }
+      if (header == compact_header_) {
+        CHECK_EQ(fp.Read(&header[0], 4), 4U);
+        this->LoadCompactModel(&fp);
+        return;
+      }
+      if (header == shared_header_) {
+        // Not loaded in place, copy the stream into aligned memory owned by the model.
+        std::string buffer;
+        common::FixedSizeStream{&fp}.Take(&buffer);
+        auto n = common::DivRoundUp(buffer.size(), sizeof(predictor::FlatNode));
+        auto storage = std::make_shared<std::vector<predictor::FlatNode>>(n);
+        std::copy(buffer.cbegin(), buffer.cend(), reinterpret_cast<char*>(storage->data()));
+        common::Span<char const> image{reinterpret_cast<char const*>(storage->data()),
+                                       buffer.size()};
+        this->LoadSharedModel(image, std::move(storage));
+        return;
+      }
     }
 
     if (header[0] == '{') {
-      // Dispatch to JSON
+      // Dispatch to JSON or UBJSON
       auto json_stream = common::FixedSizeStream(&fp);
       std::string buffer;
       json_stream.Take(&buffer);
-      auto model = Json::Load({buffer.c_str(), buffer.size()});
+      auto model = Json::Load({buffer.c_str(), buffer.size()}, JsonModeFromPrefix(header.c_str()));
       this->LoadModel(model);
       return;
     }
@@ -869,7 +1262,7 @@ class LearnerIO : public LearnerConfiguration {
       tparam_.dsplit = DataSplitMode::kRow;
     }
 
-    this->need_configuration_ = true;
+    this->RequireFullConfiguration();
   }
 
   // Save model into binary format.  The code is about to be deprecated by more robust
@@ -927,6 +1320,110 @@ class LearnerIO : public LearnerConfiguration {
     }
   }
 
+  void LoadModelLazy(std::string const& fname) override {
+    if (!common::MmapFile::Supported(fname)) {
+      std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+      this->LoadModel(fi.get());
+      return;
+    }
+    // Map the file right away so that invalid path is reported by the call site.
+    std::unique_ptr<common::MmapFile> model{new common::MmapFile{fname}};
+    std::lock_guard<std::mutex> guard(lazy_lock_);
+    lazy_model_ = std::move(model);
+    this->RequireFullConfiguration();
+  }
+
+  void SaveCompactModel(dmlc::Stream* fo, std::string const& leaf_type) const override {
+    auto type = ParseCompactLeafType(leaf_type);
+    CHECK_EQ(tparam_.booster, "gbtree") << "Compact model only supports gbtree booster.";
+    // Model without trees is stored as JSON header.
+    Json model{Object()};
+    this->SaveModel(&model);
+    auto& j_trees = get<Array>(model["learner"]["gradient_booster"]["model"]["trees"]);
+    std::vector<RegTree> trees(j_trees.size());
+    for (size_t i = 0; i < trees.size(); ++i) {
+      trees[i].LoadModel(j_trees[i]);
+    }
+    j_trees.clear();
+    std::string header;
+    Json::Dump(model, &header);
+    fo->Write(compact_header_.data(), compact_header_.size());
+    fo->Write(header);
+    SaveCompactTrees(trees, learner_model_param_.num_feature, type, fo);
+  }
+
+  void LoadCompactModel(dmlc::Stream* fi) {
+    std::string header;
+    CHECK(fi->Read(&header)) << "Invalid compact model.";
+    auto model = Json::Load({header.c_str(), header.size()});
+    std::vector<RegTree> trees;
+    auto error_bound = LoadCompactTrees(fi, &trees);
+    auto& j_trees = get<Array>(model["learner"]["gradient_booster"]["model"]["trees"]);
+    for (size_t i = 0; i < trees.size(); ++i) {
+      Json j_tree{Object()};
+      trees[i].SaveModel(&j_tree);
+      j_tree["id"] = Integer(static_cast<Integer::Int>(i));
+      j_trees.emplace_back(std::move(j_tree));
+    }
+    this->LoadModel(model);
+    this->SetAttr("compact_margin_error", std::to_string(error_bound));
+    LOG(INFO) << "Loaded compact model, prediction margin differs from the original model "
+                 "by at most "
+              << error_bound << ".";
+  }
+
+  void SaveSharedModel(dmlc::Stream* fo) const override {
+    CHECK_EQ(tparam_.booster, "gbtree") << "Shared model only supports gbtree booster.";
+    Json model{Object()};
+    this->SaveModel(&model);
+    auto& j_trees = get<Array>(model["learner"]["gradient_booster"]["model"]["trees"]);
+    predictor::FlatForest forest;
+    for (size_t i = 0; i < j_trees.size(); ++i) {
+      RegTree tree;
+      tree.LoadModel(j_trees[i]);
+      CHECK(!tree.IsMultiTarget() && !tree.HasCategoricalSplit())
+          << "Shared model only supports trees with numerical splits and scalar leaves.";
+      forest.Push(tree);
+      // Trees are replaced by single leaf placeholders, so that the JSON header stays small
+      // while the number of trees and their groups are kept.
+      Json j_tree{Object()};
+      RegTree{}.SaveModel(&j_tree);
+      j_tree["id"] = Integer(static_cast<Integer::Int>(i));
+      j_trees[i] = std::move(j_tree);
+    }
+    std::string header, image;
+    Json::Dump(model, &header);
+    forest.SaveImage(&image);
+
+    // Layout: magic, size of header and image, header, padding, image.
+    uint64_t sizes[2]{header.size(), image.size()};
+    fo->Write(shared_header_.data(), shared_header_.size());
+    fo->Write(sizes, sizeof(sizes));
+    fo->Write(header.data(), header.size());
+    size_t offset = shared_header_.size() + sizeof(sizes) + header.size();
+    std::string padding(common::DivRoundUp(offset, kSharedAlign) * kSharedAlign - offset, '\0');
+    fo->Write(padding.data(), padding.size());
+    fo->Write(image.data(), image.size());
+  }
+
+  void LoadSharedModel(common::Span<char const> image,
+                       std::shared_ptr<void const> owner) override {
+    uint64_t sizes[2];
+    size_t offset = shared_header_.size() + sizeof(sizes);
+    CHECK_GE(image.size(), offset) << "Invalid shared model.";
+    CHECK(std::equal(shared_header_.cbegin(), shared_header_.cend(), image.data()))
+        << "Invalid shared model.";
+    std::copy_n(image.data() + shared_header_.size(), sizeof(sizes),
+                reinterpret_cast<char*>(sizes));
+    CHECK_LE(offset + sizes[0], image.size()) << "Invalid shared model.";
+    auto model = Json::Load({image.data() + offset, static_cast<size_t>(sizes[0])});
+    offset = common::DivRoundUp(offset + sizes[0], kSharedAlign) * kSharedAlign;
+    CHECK_LE(offset + sizes[1], image.size()) << "Invalid shared model.";
+
+    this->LoadModel(model);
+    gbm_->UseSharedForest(image.subspan(offset, sizes[1]), std::move(owner));
+  }
+
   void Save(dmlc::Stream* fo) const override {
     Json memory_snapshot{Object()};
     memory_snapshot["Model"] = Object();
@@ -936,18 +1433,20 @@ class LearnerIO : public LearnerConfiguration {
     auto &config = memory_snapshot["Config"];
     this->SaveConfig(&config);
     std::string out_str;
-    Json::Dump(memory_snapshot, &out_str);
+    Json::Dump(memory_snapshot, &out_str, std::ios::binary);
     fo->Write(out_str.c_str(), out_str.size());
   }
 
   void Load(dmlc::Stream* fi) override {
     common::PeekableInStream fp(fi);
-    char c {0};
-    fp.PeekRead(&c, 1);
-    if (c == '{') {
+    char prefix[2] {0, 0};
+    fp.PeekRead(prefix, 2);
+    if (prefix[0] == '{') {
       std::string buffer;
       common::FixedSizeStream{&fp}.Take(&buffer);
-      auto memory_snapshot = Json::Load({buffer.c_str(), buffer.size()});
+      // Snapshots from older versions are text JSON.
+      auto memory_snapshot =
+          Json::Load({buffer.c_str(), buffer.size()}, JsonModeFromPrefix(prefix));
       this->LoadModel(memory_snapshot["Model"]);
       this->LoadConfig(memory_snapshot["Config"]);
     } else {
@@ -988,6 +1487,76 @@ class LearnerIO : public LearnerConfiguration {
   }
 };
 
+/*!
+ * \brief A persistent thread running one task at a time.  The thread is kept alive across
+ *        tasks so that thread local states like the prediction cache are reused.
+ */
+class BackgroundEvaluator {
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::function<std::string()> task_;
+  bool busy_ {false};
+  bool stop_ {false};
+  std::string result_;
+  std::exception_ptr error_;
+  std::thread worker_;
+
+  void Loop() {
+    std::unique_lock<std::mutex> guard{lock_};
+    while (true) {
+      cv_.wait(guard, [this] { return stop_ || task_; });
+      if (!task_) {
+        return;
+      }
+      auto task = std::move(task_);
+      task_ = nullptr;
+      guard.unlock();
+      std::string result;
+      std::exception_ptr error;
+      try {
+        result = task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      guard.lock();
+      result_ = std::move(result);
+      error_ = error;
+      busy_ = false;
+      cv_.notify_all();
+    }
+  }
+
+ public:
+  BackgroundEvaluator() : worker_{[this] { this->Loop(); }} {}
+  ~BackgroundEvaluator() {
+    {
+      std::lock_guard<std::mutex> guard{lock_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+  /*! \brief Start a task, the previous task must have been waited. */
+  void Submit(std::function<std::string()> task) {
+    std::lock_guard<std::mutex> guard{lock_};
+    CHECK(!busy_);
+    busy_ = true;
+    task_ = std::move(task);
+    cv_.notify_all();
+  }
+  /*! \brief Wait for the last task and return its result, empty if there's no task. */
+  std::string Wait() {
+    std::unique_lock<std::mutex> guard{lock_};
+    cv_.wait(guard, [this] { return !busy_; });
+    auto error = error_;
+    error_ = nullptr;
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return std::move(result_);
+  }
+};
+
 /*!
  * \brief learner that performs gradient boosting for a specific objective
  * function. It does training and prediction.
@@ -1020,6 +1589,16 @@ class LearnerImpl : public LearnerIO {
     return gbm_->DumpModel(fmap, with_stats, format);
   }
 
+  void DumpModelTable(TreeTable* out) override {
+    this->Configure();
+    gbm_->DumpModelTable(out);
+  }
+
+  void GenerateSource(std::string* out) override {
+    this->Configure();
+    gbm_->GenerateSource(out);
+  }
+
   Learner *Slice(int32_t begin_layer, int32_t end_layer, int32_t step,
                  bool *out_of_bound) override {
     this->Configure();
@@ -1040,6 +1619,7 @@ class LearnerImpl : public LearnerIO {
     out_impl->attributes_ = this->attributes_;
     out_impl->SetFeatureNames(this->feature_names_);
     out_impl->SetFeatureTypes(this->feature_types_);
+    out_impl->categories_ = this->categories_;
     out_impl->LoadConfig(config);
     out_impl->Configure();
     CHECK_EQ(out_impl->learner_model_param_.num_feature, this->learner_model_param_.num_feature);
@@ -1059,6 +1639,7 @@ class LearnerImpl : public LearnerIO {
 
   void UpdateOneIter(int iter, std::shared_ptr<DMatrix> train) override {
     monitor_.Start("UpdateOneIter");
+    common::PerfCounters::Get()->Add(common::PerfCounters::kBoostedRounds);
     TrainingObserver::Instance().Update(iter);
     this->Configure();
     if (generic_parameters_.seed_per_iteration) {
@@ -1066,6 +1647,7 @@ class LearnerImpl : public LearnerIO {
     }
 
     this->CheckDataSplitMode();
+    this->AdoptCategories(*train);
     this->ValidateDMatrix(train.get(), true);
 
     auto local_cache = this->GetPredictionCache();
@@ -1076,24 +1658,51 @@ class LearnerImpl : public LearnerIO {
     TrainingObserver::Instance().Observe(predt.predictions, "Predictions");
     monitor_.Stop("PredictRaw");
 
+    if (this->CanFuseGradient(train->Info())) {
+      monitor_.Start("GetGradient");
+      obj_->PrepareGradient(predt.predictions, train->Info(), iter, &gpair_);
+      monitor_.Stop("GetGradient");
+      auto const& info = train->Info();
+      GradientSource source = [&](size_t begin, size_t end) {
+        obj_->GetGradientRange(predt.predictions, info, begin, end, &gpair_);
+      };
+      gbm_->DoBoostFused(train.get(), &gpair_, &predt, source);
+      this->LogMemoryUsage(iter);
+      monitor_.Stop("UpdateOneIter");
+      return;
+    }
+
     monitor_.Start("GetGradient");
     obj_->GetGradient(predt.predictions, train->Info(), iter, &gpair_);
     monitor_.Stop("GetGradient");
     TrainingObserver::Instance().Observe(gpair_, "Gradients");
 
     gbm_->DoBoost(train.get(), &gpair_, &predt);
+    this->LogMemoryUsage(iter);
     monitor_.Stop("UpdateOneIter");
   }
 
+  void LogMemoryUsage(int iter) const {
+    auto tracker = common::MemoryTracker::Get();
+    if (!tracker->Enabled()) {
+      return;
+    }
+    std::string usage;
+    Json::Dump(tracker->ToJson(), &usage);
+    LOG(CONSOLE) << "[" << iter << "] memory usage: " << usage;
+  }
+
   void BoostOneIter(int iter, std::shared_ptr<DMatrix> train,
                     HostDeviceVector<GradientPair>* in_gpair) override {
     monitor_.Start("BoostOneIter");
+    common::PerfCounters::Get()->Add(common::PerfCounters::kBoostedRounds);
     this->Configure();
     if (generic_parameters_.seed_per_iteration) {
       common::GlobalRandom().seed(generic_parameters_.seed * kRandSeedMagic + iter);
     }
 
     this->CheckDataSplitMode();
+    this->AdoptCategories(*train);
     this->ValidateDMatrix(train.get(), true);
     auto local_cache = this->GetPredictionCache();
     local_cache->Cache(train, generic_parameters_.gpu_id);
@@ -1107,45 +1716,188 @@ class LearnerImpl : public LearnerIO {
                           const std::vector<std::string>& data_names) override {
     monitor_.Start("EvalOneIter");
     this->Configure();
+    this->ConfigureDefaultMetric();
 
     std::ostringstream os;
     os.precision(std::numeric_limits<double>::max_digits10);
     os << '[' << iter << ']' << std::setiosflags(std::ios::fixed);
-    if (metrics_.size() == 0 && tparam_.disable_default_eval_metric <= 0) {
-      auto warn_default_eval_metric = [](const std::string& objective, const std::string& before,
-                                         const std::string& after, const std::string& version) {
-        LOG(WARNING) << "Starting in XGBoost " << version << ", the default evaluation metric "
-                     << "used with the objective '" << objective << "' was changed from '"
-                     << before << "' to '" << after << "'. Explicitly set eval_metric if you'd "
-                     << "like to restore the old behavior.";
-      };
-      if (tparam_.objective == "binary:logitraw") {
-        warn_default_eval_metric(tparam_.objective, "auc", "logloss", "1.4.0");
+    std::vector<double> scores;
+    for (size_t i = 0; i < data_sets.size(); ++i) {
+      std::shared_ptr<DMatrix> m = data_sets[i];
+      PredTransformKind transform;
+      auto const& out = this->EvalPredict(m, &transform);
+      Metric::EvalMany(metrics_, out, m->Info(), tparam_.dsplit == DataSplitMode::kRow,
+                       &scores, transform);
+      for (size_t j = 0; j < metrics_.size(); ++j) {
+        os << '\t' << data_names[i] << '-' << metrics_[j]->Name() << ':' << scores[j];
+      }
+
+      auto it = eval_cohorts_.find(m.get());
+      if (it == eval_cohorts_.cend()) {
+        continue;
+      }
+      auto const& cohorts = *it->second;
+      auto const& h_out = out.ConstHostVector();
+      size_t stride = m->Info().num_row_ == 0 ? 0 : h_out.size() / m->Info().num_row_;
+      HostDeviceVector<float> cohort_out;
+      for (size_t c = 0; c < cohorts.rows.size(); ++c) {
+        if (cohorts.global_rows[c] == 0) {
+          continue;
+        }
+        auto const& rows = cohorts.rows[c];
+        cohort_out.Resize(rows.size() * stride);
+        auto& h_cohort_out = cohort_out.HostVector();
+        for (size_t r = 0; r < rows.size(); ++r) {
+          std::copy_n(h_out.cbegin() + rows[r] * stride, stride,
+                      h_cohort_out.begin() + r * stride);
+        }
+        Metric::EvalMany(metrics_, cohort_out, cohorts.infos[c],
+                         tparam_.dsplit == DataSplitMode::kRow, &scores, transform);
+        for (size_t j = 0; j < metrics_.size(); ++j) {
+          os << '\t' << data_names[i] << '[' << c << "]-" << metrics_[j]->Name() << ':'
+             << scores[j];
+        }
       }
-      metrics_.emplace_back(Metric::Create(obj_->DefaultEvalMetric(), &generic_parameters_));
-      metrics_.back()->Configure({cfg_.begin(), cfg_.end()});
     }
 
-    auto local_cache = this->GetPredictionCache();
+    monitor_.Stop("EvalOneIter");
+    return os.str();
+  }
+
+  std::string EvalOneIterAsync(int iter,
+                               const std::vector<std::shared_ptr<DMatrix>>& data_sets,
+                               const std::vector<std::string>& data_names) override {
+    CHECK(!rabit::IsDistributed())
+        << "Asynchronous evaluation is not supported in distributed training.";
+    this->Configure();
+    // Trees are immutable once committed, the snapshot shares them with this learner.
+    bool out_of_bound = false;
+    std::shared_ptr<LearnerImpl> snapshot{
+        dynamic_cast<LearnerImpl*>(this->Slice(0, 0, 1, &out_of_bound))};
+    CHECK(snapshot);
+    // The snapshot only predicts on the background thread.
+    ThreadLocalPredictionCache::Get()->erase(snapshot.get());
+    snapshot->eval_cohorts_ = eval_cohorts_;
+    if (tparam_.eval_nthread > 0) {
+      snapshot->SetParam("nthread", std::to_string(tparam_.eval_nthread));
+    }
+    if (!evaluator_) {
+      evaluator_.reset(new BackgroundEvaluator);
+    }
+
+    auto prev = evaluator_->Wait();
+    evaluator_->Submit([this, snapshot, iter, data_sets, data_names] {
+      // Continue from predictions of the previous snapshot, then release it on this thread.
+      MovePredictionCache(eval_snapshot_.get(), snapshot.get());
+      eval_snapshot_ = snapshot;
+      return snapshot->EvalOneIter(iter, data_sets, data_names);
+    });
+    return prev;
+  }
+
+  std::string WaitEvalOneIter() override {
+    return evaluator_ ? evaluator_->Wait() : std::string{};
+  }
+
+  void EvalMetrics(std::vector<std::shared_ptr<DMatrix>> const& data_sets,
+                   std::vector<std::string>* out_names,
+                   std::vector<double>* out_results) override {
+    monitor_.Start("EvalMetrics");
+    this->Configure();
+    this->ConfigureDefaultMetric();
+
+    out_names->resize(metrics_.size());
+    std::transform(metrics_.cbegin(), metrics_.cend(), out_names->begin(),
+                   [](std::unique_ptr<Metric> const& ev) { return ev->Name(); });
+    out_results->resize(data_sets.size() * metrics_.size());
+    std::vector<double> scores;
     for (size_t i = 0; i < data_sets.size(); ++i) {
       std::shared_ptr<DMatrix> m = data_sets[i];
-      auto &predt = local_cache->Cache(m, generic_parameters_.gpu_id);
-      this->ValidateDMatrix(m.get(), false);
-      this->PredictRaw(m.get(), &predt, false, 0, 0);
-
-      auto &out = output_predictions_.Cache(m, generic_parameters_.gpu_id).predictions;
-      out.Resize(predt.predictions.Size());
-      out.Copy(predt.predictions);
+      PredTransformKind transform;
+      auto const& out = this->EvalPredict(m, &transform);
+      Metric::EvalMany(metrics_, out, m->Info(), tparam_.dsplit == DataSplitMode::kRow,
+                       &scores, transform);
+      std::copy(scores.cbegin(), scores.cend(), out_results->begin() + i * metrics_.size());
+    }
+    monitor_.Stop("EvalMetrics");
+  }
 
-      obj_->EvalTransform(&out);
-      for (auto& ev : metrics_) {
-        os << '\t' << data_names[i] << '-' << ev->Name() << ':'
-           << ev->Eval(out, m->Info(), tparam_.dsplit == DataSplitMode::kRow);
+  void SetEvalCohorts(std::shared_ptr<DMatrix> data,
+                      std::vector<uint32_t> const& cohorts) override {
+    for (auto it = eval_cohorts_.begin(); it != eval_cohorts_.end();) {
+      if (it->second->ref.expired()) {
+        it = eval_cohorts_.erase(it);
+      } else {
+        ++it;
       }
     }
+    if (cohorts.empty()) {
+      eval_cohorts_.erase(data.get());
+      return;
+    }
 
-    monitor_.Stop("EvalOneIter");
-    return os.str();
+    auto const& info = data->Info();
+    CHECK_EQ(cohorts.size(), info.num_row_) << "Cohort must be specified for each row.";
+    CHECK(info.group_ptr_.empty()) << "Cohorts are not supported for ranking datasets.";
+    uint32_t n_cohorts = *std::max_element(cohorts.cbegin(), cohorts.cend()) + 1;
+    // All workers need to agree on the cohorts for allreduce in metrics.
+    rabit::Allreduce<rabit::op::Max>(&n_cohorts, 1);
+
+    EvalCohorts entry;
+    entry.ref = data;
+    entry.rows.resize(n_cohorts);
+    for (size_t i = 0; i < cohorts.size(); ++i) {
+      entry.rows[cohorts[i]].push_back(static_cast<int32_t>(i));
+    }
+    entry.global_rows.resize(n_cohorts);
+    for (uint32_t c = 0; c < n_cohorts; ++c) {
+      entry.infos.emplace_back(info.Slice(entry.rows[c]));
+      entry.global_rows[c] = entry.rows[c].size();
+    }
+    rabit::Allreduce<rabit::op::Sum>(entry.global_rows.data(), entry.global_rows.size());
+    eval_cohorts_[data.get()] = std::make_shared<EvalCohorts const>(std::move(entry));
+  }
+
+  void SavePredictionCache(std::shared_ptr<DMatrix> data, dmlc::Stream* fo) override {
+    this->Configure();
+    auto& entry = this->GetPredictionCache()->Cache(data, generic_parameters_.gpu_id);
+    this->ValidateDMatrix(data.get(), true);
+    this->PredictRaw(data.get(), &entry, false, 0, 0);
+
+    fo->Write(kPredictionCacheMagic, sizeof(kPredictionCacheMagic) - 1);
+    fo->Write(DataFingerprint(data->Info()));
+    fo->Write(tparam_.booster);
+    fo->Write(static_cast<int32_t>(this->BoostedRounds()));
+    fo->Write(entry.version);
+    fo->Write(entry.predictions.ConstHostVector());
+  }
+
+  void LoadPredictionCache(std::shared_ptr<DMatrix> data, dmlc::Stream* fi) override {
+    this->Configure();
+    std::string magic(sizeof(kPredictionCacheMagic) - 1, '\0');
+    CHECK_EQ(fi->Read(&magic[0], magic.size()), magic.size()) << "Invalid prediction cache.";
+    CHECK_EQ(magic, kPredictionCacheMagic) << "Invalid prediction cache.";
+    uint64_t fingerprint{0};
+    std::string booster;
+    int32_t n_rounds{0};
+    uint32_t version{0};
+    std::vector<float> predictions;
+    CHECK(fi->Read(&fingerprint) && fi->Read(&booster) && fi->Read(&n_rounds) &&
+          fi->Read(&version) && fi->Read(&predictions))
+        << "Invalid prediction cache.";
+
+    CHECK_EQ(fingerprint, DataFingerprint(data->Info()))
+        << "Prediction cache is saved for a different DMatrix.";
+    CHECK_EQ(booster, tparam_.booster) << "Prediction cache is saved for a different booster.";
+    CHECK_EQ(n_rounds, this->BoostedRounds())
+        << "Prediction cache is saved for a model with different number of boosted rounds.";
+    CHECK_EQ(predictions.size(),
+             data->Info().num_row_ * learner_model_param_.num_output_group)
+        << "Invalid prediction cache.";
+
+    auto& entry = this->GetPredictionCache()->Cache(data, generic_parameters_.gpu_id);
+    entry.predictions.HostVector() = std::move(predictions);
+    entry.version = version;
   }
 
   void Predict(std::shared_ptr<DMatrix> data, bool output_margin,
@@ -1167,7 +1919,13 @@ class LearnerImpl : public LearnerIO {
       gbm_->PredictLeaf(data.get(), out_preds, layer_begin, layer_end);
     } else {
       auto local_cache = this->GetPredictionCache();
-      auto& prediction = local_cache->Cache(data, generic_parameters_.gpu_id);
+      auto& cached = local_cache->Cache(data, generic_parameters_.gpu_id);
+      // Predicting a slice of the model would drop the cache, which is expensive to rebuild
+      // for evaluation data, especially in external memory.  Use a temporary entry instead.
+      bool keep_cache = cached.version != 0 &&
+                        (layer_begin != 0 || (layer_end != 0 && layer_end < cached.version));
+      PredictionCacheEntry temp;
+      auto& prediction = keep_cache ? temp : cached;
       this->PredictRaw(data.get(), &prediction, training, layer_begin, layer_end);
       // Copy the prediction cache to output prediction. out_preds comes from C API
       out_preds->SetDevice(generic_parameters_.gpu_id);
@@ -1212,6 +1970,120 @@ class LearnerImpl : public LearnerIO {
     *out_preds = &out_predictions.predictions;
   }
 
+  void InplacePredictIncremental(dmlc::any const &x, std::shared_ptr<DMatrix> p_m,
+                                 PredictionType type, float missing,
+                                 common::Span<float> margin, uint32_t *n_layers,
+                                 HostDeviceVector<bst_float> **out_preds) override {
+    this->Configure();
+    CHECK(type == PredictionType::kValue || type == PredictionType::kMargin)
+        << "Unsupported prediction type:" << static_cast<int>(type);
+    CHECK(gbm_->AdditiveLayers())
+        << "Incremental prediction is not supported by booster: " << tparam_.booster;
+    uint32_t const n_total = this->BoostedRounds();
+    CHECK_LE(*n_layers, n_total)
+        << "Margin has more layers than the model, restart the margin from 0 layer.";
+    auto n_groups = learner_model_param_.num_output_group;
+    CHECK_EQ(margin.size() % n_groups, 0) << "Invalid size of margin.";
+    auto& entry = this->GetThreadLocal().prediction_entry;
+    auto& predictions = entry.predictions;
+    if (*n_layers == 0 || *n_layers < n_total) {
+      std::shared_ptr<DMatrix> p_base = p_m;
+      if (*n_layers != 0) {
+        // Zero base margin so that only the new layers are predicted.
+        p_base.reset(new data::DMatrixProxy);
+        auto& base_margin = p_base->Info().base_margin_;
+        base_margin.Reshape(margin.size() / n_groups, n_groups);
+        auto& h_base_margin = base_margin.Data()->HostVector();
+        std::fill(h_base_margin.begin(), h_base_margin.end(), 0.0f);
+      }
+      // Layer end of 0 means all layers, an empty model is predicted as base margin only.
+      gbm_->InplacePredict(x, p_base, missing, &entry, *n_layers, n_total);
+      auto const& h_predt = predictions.ConstHostVector();
+      CHECK_EQ(h_predt.size(), margin.size()) << "Invalid size of margin.";
+      if (*n_layers == 0) {
+        std::copy(h_predt.cbegin(), h_predt.cend(), margin.begin());
+      } else {
+        std::transform(h_predt.cbegin(), h_predt.cend(), margin.cbegin(), margin.begin(),
+                       std::plus<float>{});
+      }
+    }
+    *n_layers = n_total;
+    predictions.Resize(margin.size());
+    auto& h_predt = predictions.HostVector();
+    std::copy(margin.cbegin(), margin.cend(), h_predt.begin());
+    if (type == PredictionType::kValue) {
+      obj_->PredTransform(&predictions);
+    }
+    *out_preds = &predictions;
+  }
+
+  void PredictRows(common::Span<float const> values, float missing, PredictionType type,
+                   common::Span<float> out_preds, uint32_t iteration_begin,
+                   uint32_t iteration_end) override {
+    this->Configure();
+    CHECK(type == PredictionType::kValue || type == PredictionType::kMargin)
+        << "Unsupported prediction type:" << static_cast<int>(type);
+    auto const n_features = learner_model_param_.num_feature;
+    CHECK_NE(n_features, 0);
+    size_t const n = values.size() / n_features * learner_model_param_.num_output_group;
+    gbm_->PredictRows(values, missing, out_preds, iteration_begin, iteration_end);
+    if (type == PredictionType::kValue) {
+      // Objectives transform predictions in place, reuse the thread local buffer to avoid
+      // allocation.
+      auto& transformed = this->GetThreadLocal().row_predictions;
+      transformed.Resize(n);
+      auto& h_transformed = transformed.HostVector();
+      std::copy_n(out_preds.data(), n, h_transformed.begin());
+      obj_->PredTransform(&transformed);
+      std::copy_n(h_transformed.cbegin(), n, out_preds.data());
+    }
+  }
+
+  void PredictCascade(std::shared_ptr<DMatrix> data, bool output_margin,
+                      uint32_t stage_layers, float margin_lower, float margin_upper,
+                      HostDeviceVector<bst_float> *out_preds,
+                      std::vector<uint32_t> *out_n_trees, uint32_t layer_begin,
+                      uint32_t layer_end) override {
+    this->Configure();
+    CHECK_LE(margin_lower, margin_upper);
+    this->ValidateDMatrix(data.get(), false);
+    gbm_->PredictCascade(data.get(), out_preds, out_n_trees, stage_layers, margin_lower,
+                         margin_upper, layer_begin, layer_end);
+    if (!output_margin) {
+      obj_->PredTransform(out_preds);
+    }
+  }
+
+  static void PredictManyImpl(std::vector<Learner*> const& learners,
+                              std::shared_ptr<DMatrix> data, bool output_margin,
+                              std::vector<HostDeviceVector<bst_float>*> const& out_preds) {
+    CHECK_EQ(learners.size(), out_preds.size());
+    if (learners.empty()) {
+      return;
+    }
+    std::vector<LearnerImpl*> impls;
+    std::vector<GradientBooster const*> boosters;
+    for (auto* learner : learners) {
+      auto* impl = dynamic_cast<LearnerImpl*>(learner);
+      CHECK(impl) << "Unknown learner implementation.";
+      impl->Configure();
+      impl->ValidateDMatrix(data.get(), false);
+      impls.push_back(impl);
+      boosters.push_back(impl->gbm_.get());
+    }
+    if (!boosters.front()->PredictBatchMany(data.get(), boosters, out_preds)) {
+      for (size_t i = 0; i < learners.size(); ++i) {
+        learners[i]->Predict(data, output_margin, out_preds[i], 0, 0);
+      }
+      return;
+    }
+    if (!output_margin) {
+      for (size_t i = 0; i < impls.size(); ++i) {
+        impls[i]->obj_->PredTransform(out_preds[i]);
+      }
+    }
+  }
+
   void CalcFeatureScore(std::string const& importance_type, common::Span<int32_t const> trees,
                         std::vector<bst_feature_t>* features, std::vector<float>* scores) override {
     this->Configure();
@@ -1238,6 +2110,48 @@ class LearnerImpl : public LearnerIO {
     gbm_->PredictBatch(data, out_preds, training, layer_begin, layer_end);
   }
 
+  // Use the default metric of objective if no metric is specified.
+  void ConfigureDefaultMetric() {
+    if (metrics_.size() == 0 && tparam_.disable_default_eval_metric <= 0) {
+      auto warn_default_eval_metric = [](const std::string& objective, const std::string& before,
+                                         const std::string& after, const std::string& version) {
+        LOG(WARNING) << "Starting in XGBoost " << version << ", the default evaluation metric "
+                     << "used with the objective '" << objective << "' was changed from '"
+                     << before << "' to '" << after << "'. Explicitly set eval_metric if you'd "
+                     << "like to restore the old behavior.";
+      };
+      if (tparam_.objective == "binary:logitraw") {
+        warn_default_eval_metric(tparam_.objective, "auc", "logloss", "1.4.0");
+      }
+      metrics_.emplace_back(Metric::Create(obj_->DefaultEvalMetric(), &generic_parameters_));
+      metrics_.back()->Configure({cfg_.begin(), cfg_.end()});
+    }
+  }
+  /*!
+   * \brief Prediction for evaluation, computed from the prediction cache.  When the
+   *        evaluation transform of objective is element-wise, the cached raw prediction is
+   *        returned as it is and the transform is left to metrics.
+   */
+  HostDeviceVector<float> const& EvalPredict(std::shared_ptr<DMatrix> m,
+                                             PredTransformKind* transform) {
+    auto local_cache = this->GetPredictionCache();
+    auto &predt = local_cache->Cache(m, generic_parameters_.gpu_id);
+    this->ValidateDMatrix(m.get(), false);
+    this->PredictRaw(m.get(), &predt, false, 0, 0);
+
+    *transform = obj_->EvalTransformKind();
+    if (*transform != PredTransformKind::kOther) {
+      return predt.predictions;
+    }
+    *transform = PredTransformKind::kIdentity;
+    auto &out = output_predictions_.Cache(m, generic_parameters_.gpu_id).predictions;
+    out.Resize(predt.predictions.Size());
+    out.Copy(predt.predictions);
+
+    obj_->EvalTransform(&out);
+    return out;
+  }
+
   void ValidateDMatrix(DMatrix* p_fmat, bool is_training) const {
     MetaInfo const& info = p_fmat->Info();
     info.Validate(generic_parameters_.gpu_id);
@@ -1261,6 +2175,53 @@ class LearnerImpl : public LearnerIO {
     if (p_fmat->Info().num_row_ == 0) {
       LOG(WARNING) << "Empty dataset at worker: " << rabit::GetRank();
     }
+    this->MatchCategories(p_fmat);
+  }
+
+  /*! \brief Add string categories of training data not yet known to the model. */
+  void AdoptCategories(DMatrix const& train) {
+    auto const& categories = train.Info().categories;
+    if (!categories || categories == categories_) {
+      return;
+    }
+    if (!categories_) {
+      categories_ = categories;
+      return;
+    }
+    // Existing codes are kept, so trees built so far are still valid.
+    auto merged = std::make_shared<common::CategoryDictionary>(*categories_);
+    merged->Merge(*categories);
+    categories_ = std::move(merged);
+  }
+  /**
+   * \brief Recode string categories of the data with the codes of the model, categories
+   *        unknown to the model become missing.  Done in place on first use of the data,
+   *        after which the data shares the categories of the model.
+   */
+  void MatchCategories(DMatrix* p_fmat) const {
+    auto& info = p_fmat->Info();
+    if (!info.categories || !categories_ || info.categories == categories_) {
+      return;
+    }
+    std::vector<std::vector<float>> remap;
+    if (!categories_->Remap(*info.categories, &remap)) {
+      CHECK(p_fmat->RecodeCategories(remap))
+          << "The DMatrix is encoded with string categories different from the booster's, "
+             "which can only be recoded for in-memory DMatrix.";
+    }
+    info.categories = categories_;
+  }
+
+  /*! \brief Whether gradient can be computed lazily by the booster. */
+  bool CanFuseGradient(MetaInfo const& info) const {
+    if (!tparam_.fuse_gradient || generic_parameters_.gpu_id != GenericParameter::kCpuId ||
+        info.num_row_ == 0 || !obj_->SupportsGradientRange()) {
+      return false;
+    }
+    // Rows with negative hessian are excluded from tree construction, which can not be
+    // known before the gradient is computed.
+    auto const& weights = info.weights_.ConstHostVector();
+    return std::none_of(weights.cbegin(), weights.cend(), [](float w) { return w < 0; });
   }
 
  private:
@@ -1271,6 +2232,45 @@ class LearnerImpl : public LearnerIO {
   /*! \brief Temporary storage to prediction.  Useful for storing data transformed by
    *  objective function */
   PredictionContainer output_predictions_;
+  /*! \brief Rows and meta info of each cohort in an evaluation dataset. */
+  struct EvalCohorts {
+    std::weak_ptr<DMatrix> ref;
+    std::vector<std::vector<int32_t>> rows;
+    std::vector<MetaInfo> infos;
+    // number of rows in each cohort across all workers.
+    std::vector<double> global_rows;
+  };
+  // Immutable once set, shared with evaluation snapshots.
+  std::map<DMatrix const*, std::shared_ptr<EvalCohorts const>> eval_cohorts_;
+  // Model evaluated by the last asynchronous evaluation, only accessed by the evaluator.
+  std::shared_ptr<LearnerImpl> eval_snapshot_;
+  // Declared last so that the evaluator thread is joined before other members are freed.
+  std::unique_ptr<BackgroundEvaluator> evaluator_;
+
+  /*! \brief Move the prediction cache of the calling thread between learners. */
+  static void MovePredictionCache(LearnerImpl* from, LearnerImpl* to) {
+    if (!from) {
+      return;
+    }
+    auto local_map = ThreadLocalPredictionCache::Get();
+    auto it = local_map->find(from);
+    if (it == local_map->cend()) {
+      return;
+    }
+    auto& src_cache = it->second;
+    std::vector<std::shared_ptr<DMatrix>> matrices;
+    for (auto const& kv : src_cache.Container()) {
+      matrices.emplace_back(kv.second.ref.lock());
+    }
+    auto dst_cache = to->GetPredictionCache();
+    for (auto const& m : matrices) {
+      auto& src = src_cache.Entry(m.get());
+      auto& dst = dst_cache->Cache(m, to->generic_parameters_.gpu_id);
+      dst.predictions = std::move(src.predictions);
+      dst.version = src.version;
+    }
+    local_map->erase(it);
+  }
 };
 
 constexpr int32_t LearnerImpl::kRandSeedMagic;
@@ -1279,4 +2279,10 @@ Learner* Learner::Create(
     const std::vector<std::shared_ptr<DMatrix> >& cache_data) {
   return new LearnerImpl(cache_data);
 }
+
+void Learner::PredictMany(std::vector<Learner*> const& learners, std::shared_ptr<DMatrix> data,
+                          bool output_margin,
+                          std::vector<HostDeviceVector<bst_float>*> const& out_preds) {
+  LearnerImpl::PredictManyImpl(learners, std::move(data), output_margin, out_preds);
+}
 }  // namespace xgboost
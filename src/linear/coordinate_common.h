@@ -21,12 +21,18 @@ namespace linear {
 
 struct CoordinateParam : public XGBoostParameter<CoordinateParam> {
   int top_k;
+  int block_size;
   DMLC_DECLARE_PARAMETER(CoordinateParam) {
     DMLC_DECLARE_FIELD(top_k)
         .set_lower_bound(0)
         .set_default(0)
         .describe("The number of top features to select in 'thrifty' feature_selector. "
                   "The value of zero means using all the features.");
+    DMLC_DECLARE_FIELD(block_size)
+        .set_lower_bound(1)
+        .set_default(1)
+        .describe("Number of features updated in one parallel region.  Values greater "
+                  "than 1 keep the columns resident in memory, sharded by rows.");
   }
 };
 
@@ -125,7 +131,7 @@ GetGradientParallel(GenericParameter const *ctx, int group_idx, int num_group,
       if (p.GetHess() < 0.0f) {
         return;
       }
-      auto t_idx = omp_get_thread_num();
+      auto t_idx = common::ThreadIdx();
       sum_grad_tloc[t_idx] += p.GetGrad() * v;
       sum_hess_tloc[t_idx] += p.GetHess() * v * v;
     });
@@ -328,21 +334,71 @@ class RandomFeatureSelector : public FeatureSelector {
  * the largest magnitude of univariate weight change, by passing the top_k value
  * through the `param` argument of Setup(). That would reduce the complexity to
  * O(num_feature*top_k).
+ *
+ * \note For in-memory data, gradient sums are computed once in Setup() and then
+ * maintained incrementally: after the weight of a feature changes by dw, the gradient of
+ * each row in its column changes by hess * value * dw, so only features sharing a row with
+ * that column are updated and pushed into a priority queue keyed by the magnitude of their
+ * weight change.  Stale entries in the queue are skipped by comparing versions.
  */
 class GreedyFeatureSelector : public FeatureSelector {
+  struct Candidate {
+    float dw;
+    bst_uint fidx;
+    bst_uint version;
+    // largest weight change first, ties broken by smaller feature index.
+    bool operator<(Candidate const &that) const {
+      return dw < that.dw || (dw == that.dw && fidx > that.fidx);
+    }
+  };
+
  public:
   void Setup(const gbm::GBLinearModel &model,
-             const std::vector<GradientPair> &,
-             DMatrix *, float, float, int param) override {
+             const std::vector<GradientPair> &gpair,
+             DMatrix *p_fmat, float alpha, float lambda, int param) override {
     top_k_ = static_cast<bst_uint>(param);
     const bst_uint ngroup = model.learner_model_param->num_output_group;
+    const bst_omp_uint nfeat = model.learner_model_param->num_feature;
     if (param <= 0) top_k_ = std::numeric_limits<bst_uint>::max();
     if (counter_.size() == 0) {
       counter_.resize(ngroup);
       gpair_sums_.resize(model.learner_model_param->num_feature * ngroup);
+      last_fidx_.resize(ngroup);
+      last_weight_.resize(ngroup);
+      queues_.resize(ngroup);
+      versions_.resize(nfeat * ngroup);
     }
     for (bst_uint gid = 0u; gid < ngroup; ++gid) {
       counter_[gid] = 0u;
+      last_fidx_[gid] = -1;
+    }
+    incremental_ = p_fmat->SingleColBlock();
+    if (!incremental_) {
+      return;
+    }
+    std::fill(gpair_sums_.begin(), gpair_sums_.end(), std::make_pair(0., 0.));
+    for (const auto &batch : p_fmat->GetBatches<CSCPage>()) {
+      auto page = batch.GetView();
+      common::ParallelFor(static_cast<bst_omp_uint>(batch.Size()), [&](bst_omp_uint i) {
+        const auto col = page[i];
+        for (bst_uint gid = 0u; gid < ngroup; ++gid) {
+          auto &sums = gpair_sums_[gid * nfeat + i];
+          for (auto const &c : col) {
+            auto &p = gpair[c.index * ngroup + gid];
+            if (p.GetHess() < 0.f) continue;
+            sums.first += p.GetGrad() * c.fvalue;
+            sums.second += p.GetHess() * c.fvalue * c.fvalue;
+          }
+        }
+      });
+    }
+    for (bst_uint gid = 0u; gid < ngroup; ++gid) {
+      auto &queue = queues_[gid];
+      queue.clear();
+      for (bst_omp_uint fidx = 0; fidx < nfeat; ++fidx) {
+        queue.push_back(this->MakeCandidate(model, gid, fidx, alpha, lambda));
+      }
+      std::make_heap(queue.begin(), queue.end());
     }
   }
 
@@ -354,6 +410,80 @@ class GreedyFeatureSelector : public FeatureSelector {
     // stop after either reaching top-K or going through all the features in a group
     if (k >= top_k_ || counter_[group_idx] == model.learner_model_param->num_feature) return -1;
 
+    int best_fidx = incremental_
+                        ? this->NextIncremental(model, group_idx, gpair, p_fmat, alpha, lambda)
+                        : this->NextFull(model, group_idx, gpair, p_fmat, alpha, lambda);
+    last_fidx_[group_idx] = best_fidx;
+    last_weight_[group_idx] = model[best_fidx][group_idx];
+    return best_fidx;
+  }
+
+ protected:
+  Candidate MakeCandidate(const gbm::GBLinearModel &model, int group_idx, bst_uint fidx,
+                          float alpha, float lambda) const {
+    const bst_uint nfeat = model.learner_model_param->num_feature;
+    auto &s = gpair_sums_[group_idx * nfeat + fidx];
+    float dw = std::abs(static_cast<bst_float>(
+        CoordinateDelta(s.first, s.second, model[fidx][group_idx], alpha, lambda)));
+    return {dw, fidx, versions_[group_idx * nfeat + fidx]};
+  }
+
+  int NextIncremental(const gbm::GBLinearModel &model, int group_idx,
+                      const std::vector<GradientPair> &gpair, DMatrix *p_fmat, float alpha,
+                      float lambda) {
+    const int ngroup = model.learner_model_param->num_output_group;
+    const bst_uint nfeat = model.learner_model_param->num_feature;
+    auto &queue = queues_[group_idx];
+    auto *versions = versions_.data() + group_idx * nfeat;
+    auto last = last_fidx_[group_idx];
+    double dw = last < 0 ? 0.0 : model[last][group_idx] - last_weight_[group_idx];
+    if (dw != 0.0) {
+      // rows of the last updated column, and features sharing those rows.
+      touched_.clear();
+      auto *sums = gpair_sums_.data() + group_idx * nfeat;
+      for (const auto &col_batch : p_fmat->GetBatches<CSCPage>()) {
+        auto col = col_batch.GetView()[last];
+        for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
+          auto page = batch.GetView();
+          for (auto const &c : col) {
+            auto &p = gpair[c.index * ngroup + group_idx];
+            if (p.GetHess() < 0.f) continue;
+            const double scale = p.GetHess() * c.fvalue * dw;
+            for (auto const &e : page[c.index - batch.base_rowid]) {
+              sums[e.index].first += scale * e.fvalue;
+              if (versions[e.index] != version_) {
+                versions[e.index] = version_;
+                touched_.push_back(e.index);
+              }
+            }
+          }
+        }
+      }
+      for (auto fidx : touched_) {
+        queue.push_back(this->MakeCandidate(model, group_idx, fidx, alpha, lambda));
+        std::push_heap(queue.begin(), queue.end());
+      }
+      ++version_;
+      if (queue.size() > 4 * static_cast<size_t>(nfeat)) {
+        queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                   [&](Candidate const &c) {
+                                     return c.version != versions[c.fidx];
+                                   }),
+                    queue.end());
+        std::make_heap(queue.begin(), queue.end());
+      }
+    }
+    while (queue.front().version != versions[queue.front().fidx]) {
+      std::pop_heap(queue.begin(), queue.end());
+      queue.pop_back();
+    }
+    // The best one stays in queue, it's replaced once its weight changes.
+    return static_cast<int>(queue.front().fidx);
+  }
+
+  int NextFull(const gbm::GBLinearModel &model, int group_idx,
+               const std::vector<GradientPair> &gpair, DMatrix *p_fmat, float alpha,
+               float lambda) {
     const int ngroup = model.learner_model_param->num_output_group;
     const bst_omp_uint nfeat = model.learner_model_param->num_feature;
     // Calculate univariate gradient sums
@@ -388,10 +518,17 @@ class GreedyFeatureSelector : public FeatureSelector {
     return best_fidx;
   }
 
- protected:
   bst_uint top_k_;
   std::vector<bst_uint> counter_;
   std::vector<std::pair<double, double>> gpair_sums_;
+  bool incremental_ {false};
+  std::vector<int> last_fidx_;
+  std::vector<bst_float> last_weight_;
+  std::vector<std::vector<Candidate>> queues_;
+  // version of each feature's latest entry in queue.
+  std::vector<bst_uint> versions_;
+  bst_uint version_ {1};
+  std::vector<bst_uint> touched_;
 };
 
 /**
@@ -0,0 +1,58 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "sharded_columns.h"
+
+#include <algorithm>
+
+#include "xgboost/logging.h"
+#include "../common/common.h"
+#include "../common/threading_utils.h"
+
+namespace xgboost {
+namespace linear {
+void ShardedColumns::Init(DMatrix* p_fmat, int32_t n_shards) {
+  auto const& info = p_fmat->Info();
+  CHECK_GE(n_shards, 1);
+  n_shards_ = n_shards;
+  n_features_ = info.num_col_;
+  n_rows_ = info.num_row_;
+  n_nonzero_ = info.num_nonzero_;
+  auto rows_per_shard = std::max(common::DivRoundUp(n_rows_, n_shards), bst_row_t{1});
+  auto shard_of = [&](bst_row_t ridx) { return static_cast<size_t>(ridx / rows_per_shard); };
+  auto stride = static_cast<size_t>(n_features_) + 1;
+
+  // count entries of each column in each shard, then write them out in a second pass.
+  std::vector<size_t> counts(n_shards_ * stride, 0);
+  for (auto const& batch : p_fmat->GetBatches<CSCPage>()) {
+    auto page = batch.GetView();
+    CHECK_LE(batch.Size(), n_features_);
+    common::ParallelFor(batch.Size(), n_shards, common::Sched::Dyn(), [&](size_t fidx) {
+      for (auto const& e : page[fidx]) {
+        counts[shard_of(e.index) * stride + fidx]++;
+      }
+    });
+  }
+  ptr_.resize(counts.size());
+  size_t n_entries = 0;
+  for (int32_t s = 0; s < n_shards_; ++s) {
+    for (size_t fidx = 0; fidx < stride; ++fidx) {
+      ptr_[s * stride + fidx] = n_entries;
+      n_entries += counts[s * stride + fidx];
+    }
+  }
+  CHECK_EQ(n_entries, n_nonzero_);
+  entries_.resize(n_entries);
+
+  std::vector<size_t> cursor(ptr_);
+  for (auto const& batch : p_fmat->GetBatches<CSCPage>()) {
+    auto page = batch.GetView();
+    common::ParallelFor(batch.Size(), n_shards, common::Sched::Dyn(), [&](size_t fidx) {
+      for (auto const& e : page[fidx]) {
+        entries_[cursor[shard_of(e.index) * stride + fidx]++] = e;
+      }
+    });
+  }
+}
+}  // namespace linear
+}  // namespace xgboost
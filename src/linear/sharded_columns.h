@@ -0,0 +1,55 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file sharded_columns.h
+ * \brief Column store for block coordinate descent.
+ */
+#ifndef XGBOOST_LINEAR_SHARDED_COLUMNS_H_
+#define XGBOOST_LINEAR_SHARDED_COLUMNS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/span.h"
+
+namespace xgboost {
+namespace linear {
+/**
+ * \brief Columns of the feature matrix split into shards of contiguous rows, one shard
+ *        for each thread.  A thread only visits entries of its own shard, so it can update
+ *        residuals of the rows it owns without synchronising with other threads.
+ *
+ *   Built once from the `CSCPage` of a DMatrix and kept across boosting rounds, so the
+ *   column pages don't need to be fetched again for every feature.
+ */
+class ShardedColumns {
+  // offsets of column `fidx` in shard `s` is [ptr_[s * (n_features + 1) + fidx], +1)
+  std::vector<size_t> ptr_;
+  std::vector<Entry> entries_;
+  int32_t n_shards_{0};
+  bst_feature_t n_features_{0};
+  bst_row_t n_rows_{0};
+  size_t n_nonzero_{0};
+
+ public:
+  void Init(DMatrix* p_fmat, int32_t n_shards);
+  /*! \brief Whether this is built from a DMatrix of the same shape with same shards. */
+  bool Matches(MetaInfo const& info, int32_t n_shards) const {
+    return !ptr_.empty() && n_shards_ == n_shards && n_rows_ == info.num_row_ &&
+           n_nonzero_ == info.num_nonzero_ && n_features_ == info.num_col_;
+  }
+
+  int32_t NumShards() const { return n_shards_; }
+  bst_feature_t NumFeatures() const { return n_features_; }
+  common::Span<Entry const> Column(int32_t shard, bst_feature_t fidx) const {
+    auto const* ptr = ptr_.data() + shard * (n_features_ + 1);
+    return {entries_.data() + ptr[fidx], ptr[fidx + 1] - ptr[fidx]};
+  }
+  size_t MemCostBytes() const {
+    return entries_.size() * sizeof(Entry) + ptr_.size() * sizeof(size_t);
+  }
+};
+}  // namespace linear
+}  // namespace xgboost
+#endif  // XGBOOST_LINEAR_SHARDED_COLUMNS_H_
@@ -4,9 +4,13 @@
  */
 
 #include <xgboost/linear_updater.h>
+
+#include <vector>
+
 #include "./param.h"
 #include "../common/timer.h"
 #include "coordinate_common.h"
+#include "sharded_columns.h"
 #include "xgboost/json.h"
 
 namespace xgboost {
@@ -64,6 +68,12 @@ class CoordinateUpdater : public LinearUpdater {
                     tparam_.reg_alpha_denorm,
                     tparam_.reg_lambda_denorm, cparam_.top_k);
     // update weights
+    if (cparam_.block_size > 1 && tparam_.feature_selector != kGreedy) {
+      monitor_.Start("UpdateFeatureBlock");
+      this->UpdateFeatureBlocks(&in_gpair->HostVector(), p_fmat, model);
+      monitor_.Stop("UpdateFeatureBlock");
+      return;
+    }
     for (int group_idx = 0; group_idx < ngroup; ++group_idx) {
       for (unsigned i = 0U; i < model->learner_model_param->num_feature; i++) {
         int fidx = selector_->NextFeature
@@ -90,12 +100,108 @@ class CoordinateUpdater : public LinearUpdater {
     UpdateResidualParallel(fidx, group_idx, ngroup, dw, in_gpair, p_fmat);
   }
 
+  /**
+   * \brief Same as calling `UpdateFeature` on each selected feature, but features are
+   *        taken in blocks and each block is updated in a single parallel region.  The
+   *        greedy selector is not supported as it needs the latest gradient to select the
+   *        next feature.
+   */
+  void UpdateFeatureBlocks(std::vector<GradientPair> *in_gpair, DMatrix *p_fmat,
+                           gbm::GBLinearModel *model) {
+    const int ngroup = model->learner_model_param->num_output_group;
+    const unsigned nfeat = model->learner_model_param->num_feature;
+    auto n_threads = learner_param_->Threads();
+    if (!columns_.Matches(p_fmat->Info(), n_threads)) {
+      columns_.Init(p_fmat, n_threads);
+    }
+    std::vector<int> block;
+    for (int group_idx = 0; group_idx < ngroup; ++group_idx) {
+      bool done = false;
+      for (unsigned i = 0U; i < nfeat && !done;) {
+        block.clear();
+        for (; i < nfeat && block.size() < static_cast<size_t>(cparam_.block_size); ++i) {
+          int fidx = selector_->NextFeature(i, *model, group_idx, *in_gpair, p_fmat,
+                                            tparam_.reg_alpha_denorm,
+                                            tparam_.reg_lambda_denorm);
+          if (fidx < 0) {
+            done = true;
+            break;
+          }
+          block.push_back(fidx);
+        }
+        this->UpdateFeatureBlock(block, group_idx, in_gpair, model);
+      }
+    }
+  }
+
+  void UpdateFeatureBlock(std::vector<int> const &block, int group_idx,
+                          std::vector<GradientPair> *in_gpair, gbm::GBLinearModel *model) {
+    const int ngroup = model->learner_model_param->num_output_group;
+    const int32_t n_shards = columns_.NumShards();
+    // Partial sums are written by each shard, every thread then reduces them in the same
+    // order so all threads see the same weight change.
+    sums_.resize(n_shards);
+    auto &gpair = *in_gpair;
+    dmlc::OMPException exc;
+#pragma omp parallel num_threads(n_shards)
+    {
+      exc.Run([&]() {
+        const int32_t tid = omp_get_thread_num();
+        const int32_t n_threads = omp_get_num_threads();
+        for (auto fidx : block) {
+          for (int32_t s = tid; s < n_shards; s += n_threads) {
+            double sum_grad = 0.0, sum_hess = 0.0;
+            for (auto const &c : columns_.Column(s, fidx)) {
+              auto const &p = gpair[c.index * ngroup + group_idx];
+              if (p.GetHess() < 0.0f) continue;
+              sum_grad += p.GetGrad() * c.fvalue;
+              sum_hess += p.GetHess() * c.fvalue * c.fvalue;
+            }
+            sums_[s] = std::make_pair(sum_grad, sum_hess);
+          }
+#pragma omp barrier
+          bst_float &w = (*model)[fidx][group_idx];
+          const bst_float w_old = w;
+          double sum_grad = 0.0, sum_hess = 0.0;
+          for (auto const &s : sums_) {
+            sum_grad += s.first;
+            sum_hess += s.second;
+          }
+          auto dw = static_cast<float>(
+              tparam_.learning_rate * CoordinateDelta(sum_grad, sum_hess, w_old,
+                                                      tparam_.reg_alpha_denorm,
+                                                      tparam_.reg_lambda_denorm));
+          // all threads have read the sums and the weight.
+#pragma omp barrier
+          if (tid == 0) {
+            w = w_old + dw;
+          }
+          if (dw == 0.0f) {
+            continue;
+          }
+          // rows of a shard are only touched by its owner, no need to wait for others.
+          for (int32_t s = tid; s < n_shards; s += n_threads) {
+            for (auto const &c : columns_.Column(s, fidx)) {
+              auto &p = gpair[c.index * ngroup + group_idx];
+              if (p.GetHess() < 0.0f) continue;
+              p += GradientPair(p.GetHess() * c.fvalue * dw, 0);
+            }
+          }
+        }
+      });
+    }
+    exc.Rethrow();
+  }
+
  private:
   CoordinateParam cparam_;
   // training parameter
   LinearTrainParam tparam_;
   std::unique_ptr<FeatureSelector> selector_;
   common::Monitor monitor_;
+  // columns kept across rounds for block updates
+  ShardedColumns columns_;
+  std::vector<std::pair<double, double>> sums_;
 };
 
 XGBOOST_REGISTER_LINEAR_UPDATER(CoordinateUpdater, "coord_descent")
@@ -4,18 +4,40 @@
  */
 
 #include <xgboost/linear_updater.h>
+
+#include <algorithm>
+#include <vector>
+
 #include "coordinate_common.h"
+#include "sharded_columns.h"
+#include "xgboost/json.h"
 
 namespace xgboost {
 namespace linear {
 
 DMLC_REGISTRY_FILE_TAG(updater_shotgun);
 
+struct ShotgunParam : public XGBoostParameter<ShotgunParam> {
+  bool deterministic;
+  DMLC_DECLARE_PARAMETER(ShotgunParam) {
+    DMLC_DECLARE_FIELD(deterministic)
+        .set_default(false)
+        .describe("Update features in fixed blocks against the same residual, so the "
+                  "result doesn't depend on thread scheduling.");
+  }
+};
+
+DMLC_REGISTER_PARAMETER(ShotgunParam);
+
 class ShotgunUpdater : public LinearUpdater {
+  // number of features updated against the same residual in deterministic mode.
+  static constexpr size_t kBlockSize = 16;
+
  public:
   // set training parameter
   void Configure(Args const& args) override {
-    param_.UpdateAllowUnknown(args);
+    auto rest = param_.UpdateAllowUnknown(args);
+    sparam_.UpdateAllowUnknown(rest);
     if (param_.feature_selector != kCyclic &&
         param_.feature_selector != kShuffle) {
       LOG(FATAL) << "Unsupported feature selector for shotgun updater.\n"
@@ -26,10 +48,14 @@ class ShotgunUpdater : public LinearUpdater {
   void LoadConfig(Json const& in) override {
     auto const& config = get<Object const>(in);
     FromJson(config.at("linear_train_param"), &param_);
+    if (config.find("shotgun_param") != config.cend()) {
+      FromJson(config.at("shotgun_param"), &sparam_);
+    }
   }
   void SaveConfig(Json* p_out) const override {
     auto& out = *p_out;
     out["linear_train_param"] = ToJson(param_);
+    out["shotgun_param"] = ToJson(sparam_);
   }
 
   void Update(HostDeviceVector<GradientPair> *in_gpair, DMatrix *p_fmat,
@@ -48,43 +74,51 @@ class ShotgunUpdater : public LinearUpdater {
       UpdateBiasResidualParallel(gid, ngroup, dbias, &in_gpair->HostVector(), p_fmat);
     }
 
-    // lock-free parallel updates of weights
     selector_->Setup(*model, in_gpair->ConstHostVector(), p_fmat,
                      param_.reg_alpha_denorm, param_.reg_lambda_denorm, 0);
+    if (sparam_.deterministic) {
+      this->UpdateDeterministic(&gpair, p_fmat, model);
+    } else {
+      this->UpdateHogwild(&gpair, p_fmat, model);
+    }
+  }
+
+ private:
+  /**
+   * \brief Lock-free parallel updates of weights.  Each weight is owned by the thread
+   *        updating its feature, while residuals of a row might be changed by several
+   *        threads at once so they are added atomically instead of being lost.  Gradients
+   *        are read without synchronisation and might be stale.
+   */
+  void UpdateHogwild(std::vector<GradientPair> *p_gpair, DMatrix *p_fmat,
+                     gbm::GBLinearModel *model) {
+    auto &gpair = *p_gpair;
+    const int ngroup = model->learner_model_param->num_output_group;
     for (const auto &batch : p_fmat->GetBatches<CSCPage>()) {
       auto page = batch.GetView();
       const auto nfeat = static_cast<bst_omp_uint>(batch.Size());
       dmlc::OMPException exc;
-#pragma omp parallel for schedule(static)
+      // Columns have very different lengths, hand them out in small chunks.
+#pragma omp parallel for schedule(dynamic, 16) num_threads(learner_param_->Threads())
       for (bst_omp_uint i = 0; i < nfeat; ++i) {
         exc.Run([&]() {
           int ii = selector_->NextFeature
-            (i, *model, 0, in_gpair->ConstHostVector(), p_fmat, param_.reg_alpha_denorm,
+            (i, *model, 0, gpair, p_fmat, param_.reg_alpha_denorm,
             param_.reg_lambda_denorm);
           if (ii < 0) return;
           const bst_uint fid = ii;
           auto col = page[ii];
           for (int gid = 0; gid < ngroup; ++gid) {
-            double sum_grad = 0.0, sum_hess = 0.0;
-            for (auto& c : col) {
-              const GradientPair &p = gpair[c.index * ngroup + gid];
-              if (p.GetHess() < 0.0f) continue;
-              const bst_float v = c.fvalue;
-              sum_grad += p.GetGrad() * v;
-              sum_hess += p.GetHess() * v * v;
-            }
-            bst_float &w = (*model)[fid][gid];
-            auto dw = static_cast<bst_float>(
-                param_.learning_rate *
-                CoordinateDelta(sum_grad, sum_hess, w, param_.reg_alpha_denorm,
-                                param_.reg_lambda_denorm));
+            auto dw = this->CoordinateStep(col, gid, ngroup, gpair, &(*model)[fid][gid]);
             if (dw == 0.f) continue;
-            w += dw;
             // update grad values
             for (auto& c : col) {
               GradientPair &p = gpair[c.index * ngroup + gid];
               if (p.GetHess() < 0.0f) continue;
-              p += GradientPair(p.GetHess() * c.fvalue * dw, 0);
+              auto delta = p.GetHess() * c.fvalue * dw;
+              auto grad = reinterpret_cast<GradientPair::ValueT *>(&p);
+#pragma omp atomic
+              *grad += delta;
             }
           }
         });
@@ -93,9 +127,95 @@ class ShotgunUpdater : public LinearUpdater {
     }
   }
 
+  /**
+   * \brief Features are taken in blocks of `kBlockSize`, weights of a block are computed
+   *        in parallel from the same residual, then residuals are updated by threads
+   *        owning disjoint ranges of rows, visiting features in block order.  The result
+   *        only depends on the feature order.
+   */
+  void UpdateDeterministic(std::vector<GradientPair> *p_gpair, DMatrix *p_fmat,
+                           gbm::GBLinearModel *model) {
+    auto &gpair = *p_gpair;
+    const int ngroup = model->learner_model_param->num_output_group;
+    const auto nfeat = static_cast<bst_omp_uint>(p_fmat->Info().num_col_);
+    auto n_threads = learner_param_->Threads();
+    if (!columns_.Matches(p_fmat->Info(), n_threads)) {
+      columns_.Init(p_fmat, n_threads);
+    }
+    std::vector<int> block;
+    std::vector<float> dw;
+    for (bst_omp_uint i = 0; i < nfeat;) {
+      block.clear();
+      for (; i < nfeat && block.size() < kBlockSize; ++i) {
+        int fidx = selector_->NextFeature(i, *model, 0, gpair, p_fmat,
+                                          param_.reg_alpha_denorm, param_.reg_lambda_denorm);
+        if (fidx >= 0) {
+          block.push_back(fidx);
+        }
+      }
+      dw.resize(block.size() * ngroup);
+      common::ParallelFor(block.size(), n_threads, common::Sched::Dyn(), [&](size_t k) {
+        auto fid = block[k];
+        for (int gid = 0; gid < ngroup; ++gid) {
+          // gradient of a feature is summed over all shards in a fixed order.
+          double sum_grad = 0.0, sum_hess = 0.0;
+          for (int32_t s = 0; s < columns_.NumShards(); ++s) {
+            for (auto const &c : columns_.Column(s, fid)) {
+              const GradientPair &p = gpair[c.index * ngroup + gid];
+              if (p.GetHess() < 0.0f) continue;
+              sum_grad += p.GetGrad() * c.fvalue;
+              sum_hess += p.GetHess() * c.fvalue * c.fvalue;
+            }
+          }
+          bst_float &w = (*model)[fid][gid];
+          dw[k * ngroup + gid] = static_cast<bst_float>(
+              param_.learning_rate * CoordinateDelta(sum_grad, sum_hess, w,
+                                                     param_.reg_alpha_denorm,
+                                                     param_.reg_lambda_denorm));
+          w += dw[k * ngroup + gid];
+        }
+      });
+      common::ParallelFor(columns_.NumShards(), n_threads, [&](int32_t s) {
+        for (size_t k = 0; k < block.size(); ++k) {
+          auto col = columns_.Column(s, block[k]);
+          for (int gid = 0; gid < ngroup; ++gid) {
+            auto delta = dw[k * ngroup + gid];
+            if (delta == 0.f) continue;
+            for (auto const &c : col) {
+              GradientPair &p = gpair[c.index * ngroup + gid];
+              if (p.GetHess() < 0.0f) continue;
+              p += GradientPair(p.GetHess() * c.fvalue * delta, 0);
+            }
+          }
+        }
+      });
+    }
+  }
+
+  bst_float CoordinateStep(common::Span<Entry const> col, int gid, int ngroup,
+                           std::vector<GradientPair> const &gpair, bst_float *p_w) const {
+    double sum_grad = 0.0, sum_hess = 0.0;
+    for (auto& c : col) {
+      const GradientPair &p = gpair[c.index * ngroup + gid];
+      if (p.GetHess() < 0.0f) continue;
+      const bst_float v = c.fvalue;
+      sum_grad += p.GetGrad() * v;
+      sum_hess += p.GetHess() * v * v;
+    }
+    auto dw = static_cast<bst_float>(
+        param_.learning_rate * CoordinateDelta(sum_grad, sum_hess, *p_w,
+                                               param_.reg_alpha_denorm,
+                                               param_.reg_lambda_denorm));
+    *p_w += dw;
+    return dw;
+  }
+
  protected:
   // training parameters
   LinearTrainParam param_;
+  ShotgunParam sparam_;
+  // columns sharded by rows, only used in deterministic mode.
+  ShardedColumns columns_;
 
   std::unique_ptr<FeatureSelector> selector_;
 };
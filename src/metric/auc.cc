@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <functional>
 #include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -15,7 +16,9 @@
 #include "rabit/rabit.h"
 #include "xgboost/linalg.h"
 #include "xgboost/host_device_vector.h"
+#include "xgboost/json.h"
 #include "xgboost/metric.h"
+#include "xgboost/parameter.h"
 
 #include "auc.h"
 
@@ -135,6 +138,104 @@ double MultiClassOVR(common::Span<float const> predts, MetaInfo const &info,
   return auc_sum;
 }
 
+/**
+ * Sort indices by descending prediction, starting from the order of previous evaluation.
+ * Predictions change little between boosting rounds, so the previous order consists of a
+ * few long sorted runs, which are merged in parallel.
+ */
+void WarmStartArgSort(common::Span<float const> predts, std::vector<size_t> *p_sorted_idx,
+                      int32_t n_threads) {
+  auto &sorted_idx = *p_sorted_idx;
+  auto comp = [&](size_t l, size_t r) { return predts[l] > predts[r]; };
+  std::vector<size_t> bounds{0};
+  for (size_t i = 1; i < sorted_idx.size(); ++i) {
+    if (comp(sorted_idx[i], sorted_idx[i - 1])) {
+      bounds.push_back(i);
+    }
+  }
+  bounds.push_back(sorted_idx.size());
+  while (bounds.size() > 2) {
+    size_t n_runs = bounds.size() - 1;
+    common::ParallelFor(n_runs / 2, n_threads, [&](size_t i) {
+      auto beg = sorted_idx.begin();
+      std::inplace_merge(beg + bounds[2 * i], beg + bounds[2 * i + 1], beg + bounds[2 * i + 2],
+                         comp);
+    });
+    std::vector<size_t> merged;
+    for (size_t i = 0; i < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+    }
+    if (n_runs % 2 == 1) {
+      merged.push_back(bounds.back());
+    }
+    bounds = std::move(merged);
+  }
+}
+
+/**
+ * Weighted (negative, positive) sum of samples in each bin of prediction, summed across
+ * workers.  Bins are evenly spaced between the global minimum and maximum prediction,
+ * ordered by descending prediction.
+ */
+std::vector<double> BinaryLabelHistogram(common::Span<float const> predts,
+                                         common::Span<float const> labels,
+                                         OptionalWeights weights, size_t n_bins,
+                                         int32_t n_threads) {
+  std::vector<float> lo_tloc(n_threads, std::numeric_limits<float>::max());
+  std::vector<float> hi_tloc(n_threads, std::numeric_limits<float>::lowest());
+  common::ParallelFor(predts.size(), n_threads, [&](size_t i) {
+    auto t_idx = common::ThreadIdx();
+    lo_tloc[t_idx] = std::min(lo_tloc[t_idx], predts[i]);
+    hi_tloc[t_idx] = std::max(hi_tloc[t_idx], predts[i]);
+  });
+  std::array<float, 2> range{-*std::min_element(lo_tloc.cbegin(), lo_tloc.cend()),
+                             *std::max_element(hi_tloc.cbegin(), hi_tloc.cend())};
+  rabit::Allreduce<rabit::op::Max>(range.data(), range.size());
+  double lo = -range[0], hi = range[1];
+  double scale = hi > lo ? n_bins / (hi - lo) : 0.0;
+
+  std::vector<double> hist_tloc(n_threads * n_bins * 2, 0.0);
+  common::ParallelFor(predts.size(), n_threads, [&](size_t i) {
+    auto bin = std::min(static_cast<size_t>((hi - predts[i]) * scale), n_bins - 1);
+    auto *hist = hist_tloc.data() + common::ThreadIdx() * n_bins * 2;
+    hist[bin * 2] += (1.0f - labels[i]) * weights[i];
+    hist[bin * 2 + 1] += labels[i] * weights[i];
+  });
+  std::vector<double> hist(n_bins * 2, 0.0);
+  common::ParallelFor(hist.size(), n_threads, [&](size_t j) {
+    for (int32_t t = 0; t < n_threads; ++t) {
+      hist[j] += hist_tloc[t * hist.size() + j];
+    }
+  });
+  rabit::Allreduce<rabit::op::Sum>(hist.data(), hist.size());
+  return hist;
+}
+
+/**
+ * Same as `BinaryAUC`, with samples in the same bin treated as ties.
+ */
+template <typename Fn>
+std::tuple<double, double, double> BinnedBinaryAUC(std::vector<double> const &hist,
+                                                   Fn &&area_fn) {
+  double fp{0}, tp{0}, fp_prev{0}, tp_prev{0}, auc{0};
+  for (size_t i = 0; i < hist.size(); i += 2) {
+    if (hist[i] == 0 && hist[i + 1] == 0) {
+      continue;
+    }
+    fp += hist[i];
+    tp += hist[i + 1];
+    auc += area_fn(fp_prev, fp, tp_prev, tp);
+    fp_prev = fp;
+    tp_prev = tp;
+  }
+  if (fp <= 0.0f || tp <= 0.0f) {
+    auc = 0;
+    fp = 0;
+    tp = 0;
+  }
+  return std::make_tuple(fp, tp, auc);
+}
+
 std::tuple<double, double, double>
 BinaryROCAUC(common::Span<float const> predts, common::Span<float const> labels,
              OptionalWeights weights) {
@@ -179,10 +280,10 @@ double GroupRankingROC(common::Span<float const> predts,
  *
  *   https://doi.org/10.1371/journal.pone.0092209
  */
-std::tuple<double, double, double> BinaryPRAUC(common::Span<float const> predts,
-                                               common::Span<float const> labels,
-                                               OptionalWeights weights) {
-  auto const sorted_idx = common::ArgSort<size_t>(predts, std::greater<>{});
+std::tuple<double, double, double> SortedBinaryPRAUC(common::Span<float const> predts,
+                                                     common::Span<float const> labels,
+                                                     OptionalWeights weights,
+                                                     std::vector<size_t> const &sorted_idx) {
   double total_pos{0}, total_neg{0};
   for (size_t i = 0; i < labels.size(); ++i) {
     auto w = weights[i];
@@ -201,6 +302,13 @@ std::tuple<double, double, double> BinaryPRAUC(common::Span<float const> predts,
   return std::make_tuple(1.0, 1.0, auc);
 }
 
+std::tuple<double, double, double> BinaryPRAUC(common::Span<float const> predts,
+                                               common::Span<float const> labels,
+                                               OptionalWeights weights) {
+  auto const sorted_idx = common::ArgSort<size_t>(predts, std::greater<>{});
+  return SortedBinaryPRAUC(predts, labels, weights, sorted_idx);
+}
+
 /**
  * Cast LTR problem to binary classification problem by comparing pairs.
  */
@@ -240,15 +348,70 @@ std::pair<double, uint32_t> RankingAUC(std::vector<float> const &predts,
         auc = 0;
       }
     }
-    auc_tloc[omp_get_thread_num()] += auc;
+    auc_tloc[common::ThreadIdx()] += auc;
   });
   double sum_auc = std::accumulate(auc_tloc.cbegin(), auc_tloc.cend(), 0.0);
 
   return std::make_pair(sum_auc, n_groups - invalid_groups);
 }
 
+struct AUCParam : public XGBoostParameter<AUCParam> {
+  uint32_t auc_approx_bins;
+  bool auc_warm_start;
+  DMLC_DECLARE_PARAMETER(AUCParam) {
+    DMLC_DECLARE_FIELD(auc_approx_bins)
+        .set_default(0)
+        .describe(
+            "Approximate binary AUC on CPU with a histogram of this many evenly spaced bins "
+            "of prediction, instead of sorting the predictions.  Samples in the same bin are "
+            "treated as ties.  0 means exact.");
+    DMLC_DECLARE_FIELD(auc_warm_start)
+        .set_default(false)
+        .describe(
+            "Sort predictions for exact binary AUC on CPU starting from the order of last "
+            "evaluation on the same data.");
+  }
+};
+
+DMLC_REGISTER_PARAMETER(AUCParam);
+
 template <typename Curve>
 class EvalAUC : public Metric {
+ protected:
+  AUCParam param_;
+  std::vector<size_t> sorted_idx_;
+  // order of predictions from last evaluation of each dataset.
+  std::map<MetaInfo const *, std::vector<size_t>> warm_sorted_idx_;
+
+  std::vector<size_t> const &SortedIdx(common::Span<float const> predts,
+                                       MetaInfo const &info) {
+    if (!param_.auc_warm_start) {
+      sorted_idx_ = common::ArgSort<size_t>(predts, std::greater<>{});
+      return sorted_idx_;
+    }
+    // The previous order is only a hint, a stale entry costs performance but not accuracy.
+    auto &sorted_idx = warm_sorted_idx_[&info];
+    if (sorted_idx.size() != predts.size()) {
+      sorted_idx.resize(predts.size());
+      std::iota(sorted_idx.begin(), sorted_idx.end(), 0);
+    }
+    WarmStartArgSort(predts, &sorted_idx, tparam_->Threads());
+    return sorted_idx;
+  }
+
+ public:
+  void Configure(Args const &args) override { param_.UpdateAllowUnknown(args); }
+  void SaveConfig(Json *p_out) const override {
+    auto &out = *p_out;
+    out["name"] = String(this->Name());
+    out["auc_param"] = ToJson(param_);
+  }
+  void LoadConfig(Json const &in) override {
+    if (IsA<Object>(in["auc_param"])) {
+      FromJson(in["auc_param"], &param_);
+    }
+  }
+
   double Eval(const HostDeviceVector<bst_float> &preds, const MetaInfo &info,
               bool distributed) override {
     double auc {0};
@@ -304,14 +467,25 @@ class EvalAUC : public Metric {
        * binary classification
        */
       double fp{0}, tp{0};
-      if (!(preds.Empty() || info.labels_.Empty())) {
-        std::tie(fp, tp, auc) =
-            static_cast<Curve *>(this)->EvalBinary(preds, info);
+      double local_area{0};
+      if (param_.auc_approx_bins != 0 && tparam_->gpu_id == GenericParameter::kCpuId) {
+        // The histogram is summed across workers, so is the result.
+        auto hist = BinaryLabelHistogram(
+            preds.ConstHostSpan(), info.labels_.ConstHostSpan(),
+            OptionalWeights{info.weights_.ConstHostSpan()}, param_.auc_approx_bins,
+            tparam_->Threads());
+        std::tie(fp, tp, auc) = static_cast<Curve *>(this)->EvalBinaryApprox(hist);
+        local_area = fp * tp;
+      } else {
+        if (!(preds.Empty() || info.labels_.Empty())) {
+          std::tie(fp, tp, auc) =
+              static_cast<Curve *>(this)->EvalBinary(preds, info);
+        }
+        local_area = fp * tp;
+        std::array<double, 2> result{auc, local_area};
+        rabit::Allreduce<rabit::op::Sum>(result.data(), result.size());
+        std::tie(auc, local_area) = common::UnpackArr(std::move(result));
       }
-      double local_area = fp * tp;
-      std::array<double, 2> result{auc, local_area};
-      rabit::Allreduce<rabit::op::Sum>(result.data(), result.size());
-      std::tie(auc, local_area) = common::UnpackArr(std::move(result));
       if (local_area <= 0) {
         // the dataset across all workers have only positive or negative sample
         auc = std::numeric_limits<double>::quiet_NaN();
@@ -366,9 +540,11 @@ class EvalROCAUC : public EvalAUC<EvalROCAUC> {
   EvalBinary(HostDeviceVector<float> const &predts, MetaInfo const &info) {
     double fp, tp, auc;
     if (tparam_->gpu_id == GenericParameter::kCpuId) {
+      auto h_predts = predts.ConstHostSpan();
       std::tie(fp, tp, auc) =
-          BinaryROCAUC(predts.ConstHostVector(), info.labels_.ConstHostVector(),
-                       OptionalWeights{info.weights_.ConstHostSpan()});
+          BinaryAUC(h_predts, info.labels_.ConstHostSpan(),
+                    OptionalWeights{info.weights_.ConstHostSpan()},
+                    this->SortedIdx(h_predts, info), TrapezoidArea);
     } else {
       std::tie(fp, tp, auc) = GPUBinaryROCAUC(predts.ConstDeviceSpan(), info,
                                               tparam_->gpu_id, &this->d_cache_);
@@ -376,6 +552,10 @@ class EvalROCAUC : public EvalAUC<EvalROCAUC> {
     return std::make_tuple(fp, tp, auc);
   }
 
+  std::tuple<double, double, double> EvalBinaryApprox(std::vector<double> const &hist) {
+    return BinnedBinaryAUC(hist, TrapezoidArea);
+  }
+
  public:
   char const* Name() const override {
     return "auc";
@@ -419,9 +599,11 @@ class EvalPRAUC : public EvalAUC<EvalPRAUC> {
   EvalBinary(HostDeviceVector<float> const &predts, MetaInfo const &info) {
     double pr, re, auc;
     if (tparam_->gpu_id == GenericParameter::kCpuId) {
+      auto h_predts = predts.ConstHostSpan();
       std::tie(pr, re, auc) =
-          BinaryPRAUC(predts.ConstHostSpan(), info.labels_.ConstHostSpan(),
-                      OptionalWeights{info.weights_.ConstHostSpan()});
+          SortedBinaryPRAUC(h_predts, info.labels_.ConstHostSpan(),
+                            OptionalWeights{info.weights_.ConstHostSpan()},
+                            this->SortedIdx(h_predts, info));
     } else {
       std::tie(pr, re, auc) = GPUBinaryPRAUC(predts.ConstDeviceSpan(), info,
                                              tparam_->gpu_id, &this->d_cache_);
@@ -429,6 +611,22 @@ class EvalPRAUC : public EvalAUC<EvalPRAUC> {
     return std::make_tuple(pr, re, auc);
   }
 
+  std::tuple<double, double, double> EvalBinaryApprox(std::vector<double> const &hist) {
+    double total_pos{0}, total_neg{0};
+    for (size_t i = 0; i < hist.size(); i += 2) {
+      total_neg += hist[i];
+      total_pos += hist[i + 1];
+    }
+    if (total_pos <= 0 || total_neg <= 0) {
+      return {1.0f, 1.0f, std::numeric_limits<float>::quiet_NaN()};
+    }
+    auto fn = [total_pos](double fp_prev, double fp, double tp_prev, double tp) {
+      return detail::CalcDeltaPRAUC(fp_prev, fp, tp_prev, tp, total_pos);
+    };
+    auto auc = std::get<2>(BinnedBinaryAUC(hist, fn));
+    return std::make_tuple(1.0, 1.0, auc);
+  }
+
   double EvalMultiClass(HostDeviceVector<float> const &predts,
                        MetaInfo const &info, size_t n_classes) {
     if (tparam_->gpu_id == GenericParameter::kCpuId) {
@@ -9,12 +9,17 @@
 #include <rabit/rabit.h>
 #include <xgboost/metric.h>
 #include <dmlc/registry.h>
+
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 #include "metric_common.h"
 #include "../common/math.h"
 #include "../common/common.h"
 #include "../common/threading_utils.h"
+#include "../common/transform.h"
 
 #if defined(XGBOOST_USE_CUDA)
 #include <thrust/execution_policy.h>  // thrust::cuda::par
@@ -51,7 +56,7 @@ class ElementWiseMetricsReduction {
 
     common::ParallelFor(ndata, n_threads, [&](size_t i) {
       float wt = h_weights.size() > 0 ? h_weights[i] : 1.0f;
-      auto t_idx = omp_get_thread_num();
+      auto t_idx = common::ThreadIdx();
       score_tloc[t_idx] += policy_.EvalRow(h_labels[i], h_preds[i]) * wt;
       weight_tloc[t_idx] += wt;
     });
@@ -221,6 +226,7 @@ struct EvalRowMPHE {
 };
 
 struct EvalError {
+  EvalError() : threshold_{0.5f}, has_param_{false} {}
   explicit EvalError(const char* param) {
     if (param != nullptr) {
       CHECK_EQ(sscanf(param, "%f", &threshold_), 1)
@@ -322,6 +328,7 @@ struct EvalGammaNLogLik {
 };
 
 struct EvalTweedieNLogLik {
+  EvalTweedieNLogLik() = default;
   explicit EvalTweedieNLogLik(const char* param) {
     CHECK(param != nullptr)
         << "tweedie-nloglik must be in format tweedie-nloglik@rho";
@@ -347,14 +354,223 @@ struct EvalTweedieNLogLik {
   }
 
  protected:
-  bst_float rho_;
+  bst_float rho_ {1.5f};
+};
+
+/*!
+ * \brief Type erased element-wise policy, so that different metrics can be evaluated by the
+ *        same kernel in a single pass over data.
+ */
+struct FusedPolicy {
+  enum Kind : int32_t {
+    kRMSE, kRMSLE, kMAE, kMAPE, kMPHE, kLogLoss, kError, kPoisson, kGammaDeviance,
+    kGammaNLogLik, kTweedie
+  };
+
+  FusedPolicy() = default;
+  explicit FusedPolicy(EvalRowRMSE const&) : kind{kRMSE} {}
+  explicit FusedPolicy(EvalRowRMSLE const&) : kind{kRMSLE} {}
+  explicit FusedPolicy(EvalRowMAE const&) : kind{kMAE} {}
+  explicit FusedPolicy(EvalRowMAPE const&) : kind{kMAPE} {}
+  explicit FusedPolicy(EvalRowMPHE const&) : kind{kMPHE} {}
+  explicit FusedPolicy(EvalRowLogLoss const&) : kind{kLogLoss} {}
+  explicit FusedPolicy(EvalError const& policy) : kind{kError}, error{policy} {}
+  explicit FusedPolicy(EvalPoissonNegLogLik const&) : kind{kPoisson} {}
+  explicit FusedPolicy(EvalGammaDeviance const&) : kind{kGammaDeviance} {}
+  explicit FusedPolicy(EvalGammaNLogLik const&) : kind{kGammaNLogLik} {}
+  explicit FusedPolicy(EvalTweedieNLogLik const& policy) : kind{kTweedie}, tweedie{policy} {}
+
+  XGBOOST_DEVICE bst_float EvalRow(bst_float label, bst_float pred) const {
+    switch (kind) {
+      case kRMSE: return EvalRowRMSE{}.EvalRow(label, pred);
+      case kRMSLE: return EvalRowRMSLE{}.EvalRow(label, pred);
+      case kMAE: return EvalRowMAE{}.EvalRow(label, pred);
+      case kMAPE: return EvalRowMAPE{}.EvalRow(label, pred);
+      case kMPHE: return EvalRowMPHE{}.EvalRow(label, pred);
+      case kLogLoss: return EvalRowLogLoss{}.EvalRow(label, pred);
+      case kError: return error.EvalRow(label, pred);
+      case kPoisson: return EvalPoissonNegLogLik{}.EvalRow(label, pred);
+      case kGammaDeviance: return EvalGammaDeviance{}.EvalRow(label, pred);
+      case kGammaNLogLik: return EvalGammaNLogLik{}.EvalRow(label, pred);
+      case kTweedie: return tweedie.EvalRow(label, pred);
+    }
+    return 0;
+  }
+
+  Kind kind {kRMSE};
+  EvalError error;
+  EvalTweedieNLogLik tweedie;
+};
+
+XGBOOST_DEVICE inline float ApplyPredTransform(PredTransformKind kind, float pred) {
+  switch (kind) {
+    case PredTransformKind::kSigmoid: return common::Sigmoid(pred);
+    case PredTransformKind::kExp: return expf(pred);
+    default: return pred;
+  }
+}
+
+/*!
+ * \brief Reduction of multiple element-wise metrics, labels, weights and predictions are
+ *        read only once.  Prediction is transformed on the fly.
+ */
+class FusedEWiseReduction {
+ public:
+  // number of metrics reduced by one device kernel, the reduction result lives in registers.
+  static constexpr size_t kMaxDeviceMetrics = 8;
+
+  explicit FusedEWiseReduction(std::vector<FusedPolicy> policies,
+                               PredTransformKind transform = PredTransformKind::kIdentity)
+      : policies_{std::move(policies)}, transform_{transform} {}
+
+  /*!
+   * \brief Returns sum of residue for each policy, followed by sum of weights.  Labels are
+   *        read from `label_bits` instead when it's not null.
+   */
+  std::vector<double> CpuReduceMetrics(const HostDeviceVector<bst_float> &weights,
+                                       const HostDeviceVector<bst_float> &labels,
+                                       const HostDeviceVector<bst_float> &preds,
+                                       std::vector<uint64_t> const* label_bits,
+                                       int32_t n_threads) const {
+    size_t ndata = labels.Size();
+    size_t constexpr kBits = sizeof(uint64_t) * 8;
+    auto const* bits = label_bits ? label_bits->data() : nullptr;
+    const auto& h_labels = labels.HostVector();
+    const auto& h_weights = weights.HostVector();
+    const auto& h_preds = preds.HostVector();
+
+    size_t n_metrics = policies_.size();
+    // pad to cache line to avoid false sharing between threads.
+    size_t constexpr kPad = 64 / sizeof(double);
+    size_t stride = common::DivRoundUp(n_metrics + 1, kPad) * kPad;
+    std::vector<double> tloc(n_threads * stride, 0.0);
+    auto const* policies = policies_.data();
+    auto transform = transform_;
+
+    common::ParallelFor(ndata, n_threads, [&](size_t i) {
+      float wt = h_weights.size() > 0 ? h_weights[i] : 1.0f;
+      auto t_idx = common::ThreadIdx();
+      double* sums = tloc.data() + t_idx * stride;
+      float label = bits ? static_cast<float>((bits[i / kBits] >> (i % kBits)) & 1)
+                         : h_labels[i];
+      float pred = ApplyPredTransform(transform, h_preds[i]);
+      for (size_t j = 0; j < n_metrics; ++j) {
+        sums[j] += policies[j].EvalRow(label, pred) * wt;
+      }
+      sums[n_metrics] += wt;
+    });
+
+    std::vector<double> result(n_metrics + 1, 0.0);
+    for (int32_t t = 0; t < n_threads; ++t) {
+      for (size_t j = 0; j <= n_metrics; ++j) {
+        result[j] += tloc[t * stride + j];
+      }
+    }
+    return result;
+  }
+
+#if defined(XGBOOST_USE_CUDA)
+  struct DeviceResult {
+    double residue[kMaxDeviceMetrics] {0};
+    double weight {0};
+
+    XGBOOST_DEVICE DeviceResult operator+(DeviceResult const& that) const {
+      DeviceResult out;
+      for (size_t j = 0; j < kMaxDeviceMetrics; ++j) {
+        out.residue[j] = residue[j] + that.residue[j];
+      }
+      out.weight = weight + that.weight;
+      return out;
+    }
+  };
+
+  std::vector<double> DeviceReduceMetrics(const HostDeviceVector<bst_float>& weights,
+                                          const HostDeviceVector<bst_float>& labels,
+                                          const HostDeviceVector<bst_float>& preds) {
+    size_t n_data = preds.Size();
+    size_t n_metrics = policies_.size();
+    auto s_label = labels.DeviceSpan();
+    auto s_preds = preds.DeviceSpan();
+    auto s_weights = weights.DeviceSpan();
+    bool const is_null_weight = weights.Size() == 0;
+    auto transform = transform_;
+
+    std::vector<double> result(n_metrics + 1, 0.0);
+    dh::XGBCachingDeviceAllocator<char> alloc;
+    for (size_t begin = 0; begin < n_metrics; begin += kMaxDeviceMetrics) {
+      size_t n = std::min(kMaxDeviceMetrics, n_metrics - begin);
+      FusedPolicy d_policies[kMaxDeviceMetrics];
+      std::copy_n(policies_.cbegin() + begin, n, d_policies);
+      // Captured by value.
+      auto op = [=] XGBOOST_DEVICE(size_t idx) {
+        float weight = is_null_weight ? 1.0f : s_weights[idx];
+        float label = s_label[idx];
+        float pred = ApplyPredTransform(transform, s_preds[idx]);
+        DeviceResult res;
+        for (size_t j = 0; j < n; ++j) {
+          res.residue[j] = d_policies[j].EvalRow(label, pred) * weight;
+        }
+        res.weight = weight;
+        return res;
+      };
+      thrust::counting_iterator<size_t> it(0);
+      DeviceResult reduced = thrust::transform_reduce(
+          thrust::cuda::par(alloc), it, it + n_data, op, DeviceResult{},
+          thrust::plus<DeviceResult>());
+      std::copy_n(reduced.residue, n, result.begin() + begin);
+      result.back() = reduced.weight;
+    }
+    return result;
+  }
+#endif  // XGBOOST_USE_CUDA
+
+  std::vector<double> Reduce(const GenericParameter &ctx,
+                             const HostDeviceVector<bst_float>& weights,
+                             const HostDeviceVector<bst_float>& labels,
+                             const HostDeviceVector<bst_float>& preds,
+                             std::vector<uint64_t> const* label_bits = nullptr) {
+    std::vector<double> result;
+    if (ctx.gpu_id < 0) {
+      result = CpuReduceMetrics(weights, labels, preds, label_bits, ctx.Threads());
+    }
+#if defined(XGBOOST_USE_CUDA)
+    else {  // NOLINT
+      preds.SetDevice(ctx.gpu_id);
+      labels.SetDevice(ctx.gpu_id);
+      weights.SetDevice(ctx.gpu_id);
+
+      dh::safe_cuda(cudaSetDevice(ctx.gpu_id));
+      result = DeviceReduceMetrics(weights, labels, preds);
+    }
+#endif  // defined(XGBOOST_USE_CUDA)
+    return result;
+  }
+
+ private:
+  std::vector<FusedPolicy> policies_;
+  PredTransformKind transform_;
+};
+
+void TransformPrediction(PredTransformKind kind, HostDeviceVector<bst_float>* io_preds) {
+  common::Transform<>::Init(
+      [=] XGBOOST_DEVICE(size_t idx, common::Span<bst_float> preds) {
+        preds[idx] = ApplyPredTransform(kind, preds[idx]);
+      },
+      common::Range{0, static_cast<int64_t>(io_preds->Size())}, io_preds->DeviceIdx())
+      .Eval(io_preds);
+}
+
+/*! \brief Element-wise metric that can be evaluated together with other element-wise metrics. */
+struct FusibleEWiseMetric : public Metric {
+  virtual FusedPolicy Fused() const = 0;
+  virtual double GetFinal(double esum, double wsum) const = 0;
 };
 /*!
  * \brief base class of element-wise evaluation
  * \tparam Derived the name of subclass
  */
 template<typename Policy>
-struct EvalEWiseBase : public Metric {
+struct EvalEWiseBase : public FusibleEWiseMetric {
   EvalEWiseBase() = default;
   explicit EvalEWiseBase(char const* policy_param) :
     policy_{policy_param}, reducer_{policy_} {}
@@ -378,11 +594,91 @@ struct EvalEWiseBase : public Metric {
     return policy_.Name();
   }
 
+  FusedPolicy Fused() const override { return FusedPolicy{policy_}; }
+  double GetFinal(double esum, double wsum) const override {
+    return Policy::GetFinal(esum, wsum);
+  }
+
  private:
   Policy policy_;
   ElementWiseMetricsReduction<Policy> reducer_{policy_};
 };
 
+}  // namespace metric
+
+void Metric::EvalMany(std::vector<std::unique_ptr<Metric>> const& metrics,
+                      HostDeviceVector<bst_float> const& preds, MetaInfo const& info,
+                      bool distributed, std::vector<double>* out,
+                      PredTransformKind transform) {
+  CHECK(transform != PredTransformKind::kOther);
+  out->resize(metrics.size());
+  if (metrics.empty()) {
+    return;
+  }
+  if (transform != PredTransformKind::kIdentity) {
+    bool all_ewise = std::all_of(metrics.cbegin(), metrics.cend(), [](auto const& m) {
+      return dynamic_cast<metric::FusibleEWiseMetric const*>(m.get()) != nullptr;
+    });
+    if (!all_ewise) {
+      // Other metrics need the transformed prediction.
+      HostDeviceVector<bst_float> transformed;
+      transformed.SetDevice(preds.DeviceIdx());
+      transformed.Resize(preds.Size());
+      transformed.Copy(preds);
+      metric::TransformPrediction(transform, &transformed);
+      EvalMany(metrics, transformed, info, distributed, out);
+      return;
+    }
+  }
+  auto ranked_idx = metric::EvalRankMany(metrics, *metrics.front()->tparam_, preds, info,
+                                         distributed, out);
+  std::vector<size_t> fused_idx;
+  std::vector<metric::FusedPolicy> policies;
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    auto const* ewise = dynamic_cast<metric::FusibleEWiseMetric const*>(metrics[i].get());
+    if (ewise) {
+      fused_idx.push_back(i);
+      policies.push_back(ewise->Fused());
+    }
+  }
+  // Metrics of binary classification read labels packed into bits.
+  std::vector<uint64_t> const* label_bits = nullptr;
+  auto const& ctx = *metrics.front()->tparam_;
+  if (ctx.gpu_id < 0 &&
+      std::any_of(policies.cbegin(), policies.cend(), [](metric::FusedPolicy const& p) {
+        return p.kind == metric::FusedPolicy::kLogLoss || p.kind == metric::FusedPolicy::kError;
+      })) {
+    label_bits = info.BinaryLabelBits();
+  }
+  if (fused_idx.size() < 2 && transform == PredTransformKind::kIdentity && !label_bits) {
+    fused_idx.clear();
+  }
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    if (!std::binary_search(fused_idx.cbegin(), fused_idx.cend(), i) &&
+        !std::binary_search(ranked_idx.cbegin(), ranked_idx.cend(), i)) {
+      (*out)[i] = metrics[i]->Eval(preds, info, distributed);
+    }
+  }
+  if (fused_idx.empty()) {
+    return;
+  }
+
+  CHECK_EQ(preds.Size(), info.labels_.Size())
+      << "label and prediction size not match, "
+      << "hint: use merror or mlogloss for multi-class classification";
+  metric::FusedEWiseReduction reducer{std::move(policies), transform};
+  auto dat = reducer.Reduce(ctx, info.weights_, info.labels_, preds, label_bits);
+  // One message for all metrics.
+  if (distributed) {
+    rabit::Allreduce<rabit::op::Sum>(dat.data(), dat.size());
+  }
+  for (size_t j = 0; j < fused_idx.size(); ++j) {
+    auto const* ewise = static_cast<metric::FusibleEWiseMetric const*>(metrics[fused_idx[j]].get());
+    (*out)[fused_idx[j]] = ewise->GetFinal(dat[j], dat.back());
+  }
+}
+
+namespace metric {
 XGBOOST_REGISTER_METRIC(RMSE, "rmse")
 .describe("Rooted mean square error.")
 .set_body([](const char* param) { return new EvalEWiseBase<EvalRowRMSE>(); });
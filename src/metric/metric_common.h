@@ -6,7 +6,9 @@
 #define XGBOOST_METRIC_METRIC_COMMON_H_
 
 #include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "../common/common.h"
 
@@ -61,6 +63,18 @@ struct EvalRankConfig {
   bool minus{false};
 };
 
+/*!
+ * \brief Evaluate all ranking metrics in `metrics` with a single sort per query group,
+ *        used by `Metric::EvalMany`.
+ *
+ * \return Indices of the evaluated metrics in ascending order, empty if there's nothing
+ *         to share.
+ */
+std::vector<size_t> EvalRankMany(std::vector<std::unique_ptr<Metric>> const &metrics,
+                                 GenericParameter const &tparam,
+                                 HostDeviceVector<bst_float> const &preds, MetaInfo const &info,
+                                 bool distributed, std::vector<double> *out);
+
 class PackedReduceResult {
   double residue_sum_ { 0 };
   double weights_sum_ { 0 };
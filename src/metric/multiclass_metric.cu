@@ -60,7 +60,7 @@ class MultiClassMetricsReduction {
         bst_float weight = is_null_weight ? 1.0f : h_weights[idx];
         auto label = static_cast<int>(h_labels[idx]);
         if (label >= 0 && label < static_cast<int>(n_class)) {
-          auto t_idx = omp_get_thread_num();
+          auto t_idx = common::ThreadIdx();
           scores_tloc[t_idx] +=
               EvalRowPolicy::EvalRow(label, h_preds.data() + idx * n_class,
                                      n_class) *
@@ -0,0 +1,108 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file plugin_metric.cc
+ * \brief Metric calling block callbacks of a plugin library, see `plugin_abi.h`.
+ */
+#include <dmlc/registry.h>
+#include <rabit/rabit.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "xgboost/host_device_vector.h"
+#include "xgboost/logging.h"
+#include "xgboost/metric.h"
+#include "xgboost/plugin_abi.h"
+
+#include "../common/common.h"
+#include "../common/plugin_loader.h"
+#include "../common/threading_utils.h"
+
+namespace xgboost {
+namespace metric {
+namespace {
+constexpr size_t kBlockRows = 2048;
+}  // anonymous namespace
+
+class PluginMetric : public Metric {
+  XGBPluginMetric desc_;
+  std::string name_;
+  void *state_{nullptr};
+
+ public:
+  PluginMetric(XGBPluginMetric const &desc, std::string const &name, char const *param)
+      : desc_{desc}, name_{param ? name + "@" + param : name} {
+    if (desc_.create) {
+      state_ = desc_.create(param);
+    }
+  }
+  ~PluginMetric() override {
+    if (state_ && desc_.destroy) {
+      desc_.destroy(state_);
+    }
+  }
+
+  double Eval(HostDeviceVector<bst_float> const &preds, MetaInfo const &info,
+              bool distributed) override {
+    std::array<double, 2> dat{0.0, 0.0};
+    if (info.num_row_ != 0) {
+      CHECK_EQ(preds.Size(), info.labels_.Size())
+          << "label and prediction size not match, hint: use merror or mlogloss for "
+             "multi-class classification";
+      CHECK_EQ(preds.Size() % info.num_row_, 0U);
+      auto const &h_weights = info.weights_.ConstHostVector();
+      if (!h_weights.empty()) {
+        CHECK_EQ(h_weights.size(), info.num_row_)
+            << "Number of weights should be equal to number of rows.";
+      }
+      size_t const n_targets = preds.Size() / info.num_row_;
+      auto const *h_preds = preds.ConstHostPointer();
+      auto const *h_labels = info.labels_.ConstHostPointer();
+      auto n_blocks = common::DivRoundUp(info.num_row_, kBlockRows);
+      std::vector<std::array<double, 2>> partial(n_blocks, {0.0, 0.0});
+      common::ParallelFor(n_blocks, tparam_->Threads(), [&](size_t b) {
+        XGBPluginBlock block;
+        block.row_begin = b * kBlockRows;
+        block.n_rows = std::min<size_t>(kBlockRows, info.num_row_ - block.row_begin);
+        block.n_targets = n_targets;
+        block.predt = h_preds + block.row_begin * n_targets;
+        block.labels = h_labels + block.row_begin * n_targets;
+        block.weights = h_weights.empty() ? nullptr : h_weights.data() + block.row_begin;
+        CHECK_EQ(desc_.eval(state_, &block, &partial[b][0], &partial[b][1]), 0)
+            << "Plugin metric `" << name_ << "` failed to evaluate.";
+      });
+      // Sum up blocks in order so the result doesn't depend on number of threads.
+      for (auto const &p : partial) {
+        dat[0] += p[0];
+        dat[1] += p[1];
+      }
+    }
+    if (distributed) {
+      rabit::Allreduce<rabit::op::Sum>(dat.data(), dat.size());
+    }
+    if (desc_.finalize) {
+      return desc_.finalize(state_, dat[0], dat[1]);
+    }
+    return dat[1] == 0 ? dat[0] : dat[0] / dat[1];
+  }
+
+  const char *Name() const override { return name_.c_str(); }
+};
+}  // namespace metric
+
+void RegisterPluginMetric(XGBPluginMetric const &metric) {
+  CHECK(metric.name) << "Plugin metric must have a name.";
+  CHECK(metric.eval) << "Plugin metric `" << metric.name << "` has no eval function.";
+  std::string name{metric.name};
+  XGBPluginMetric desc = metric;
+  desc.name = nullptr;
+  ::dmlc::Registry<MetricReg>::Get()
+      ->__REGISTER__(name)
+      .describe("Metric loaded from plugin.")
+      .set_body([desc, name](char const *param) {
+        return new metric::PluginMetric(desc, name, param);
+      });
+}
+}  // namespace xgboost
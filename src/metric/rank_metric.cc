@@ -23,12 +23,16 @@
 #include <rabit/rabit.h>
 #include <xgboost/metric.h>
 #include <dmlc/registry.h>
+#include <algorithm>
 #include <cmath>
-
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <vector>
 
 #include "xgboost/host_device_vector.h"
 #include "../common/math.h"
+#include "../common/survival_util.h"
 #include "../common/threading_utils.h"
 #include "metric_common.h"
 
@@ -155,6 +159,50 @@ struct EvalAMS : public Metric {
   float ratio_;
 };
 
+/*!
+ * \brief A query group sorted once and shared by all ranking metrics evaluated on it.
+ */
+struct RankGroup {
+  // Labels of the top-k instances, in descending order of prediction.  Ties are broken
+  // by row index so the result is the same as a stable sort.
+  std::vector<unsigned> by_pred;
+  // Top-k labels in descending order, used for the ideal DCG.
+  std::vector<unsigned> by_label;
+  // Number of relevant instances in the whole group.
+  unsigned n_rel{0};
+};
+
+struct EvalRank;
+
+namespace {
+std::vector<unsigned> const &CheckGroupPtr(HostDeviceVector<bst_float> const &preds,
+                                           MetaInfo const &info, std::vector<unsigned> *tgptr) {
+  CHECK_EQ(preds.Size(), info.labels_.Size())
+      << "label size predict size not match";
+  // quick consistency when group is not available
+  tgptr->assign(2, 0);
+  tgptr->back() = static_cast<unsigned>(preds.Size());
+  const auto &gptr = info.group_ptr_.size() == 0 ? *tgptr : info.group_ptr_;
+
+  CHECK_NE(gptr.size(), 0U) << "must specify group when constructing rank file";
+  CHECK_EQ(gptr.back(), preds.Size())
+      << "EvalRank: group structure must match number of prediction";
+  return gptr;
+}
+
+/*!
+ * \brief Sort every query group once up to the largest top-k among `metrics` and
+ *        accumulate the per-group score of each metric into `out_sums`.
+ *
+ *  Groups are visited from the largest to the smallest with dynamic scheduling, as group
+ *  sizes in ranking datasets are usually skewed.
+ */
+void EvalRankGroups(std::vector<EvalRank const *> const &metrics,
+                    HostDeviceVector<bst_float> const &preds, MetaInfo const &info,
+                    std::vector<unsigned> const &gptr, int32_t n_threads,
+                    std::vector<double> *out_sums);
+}  // anonymous namespace
+
 /*! \brief Evaluate rank list */
 struct EvalRank : public Metric, public EvalRankConfig {
  private:
@@ -164,17 +212,8 @@ struct EvalRank : public Metric, public EvalRankConfig {
  public:
   double Eval(const HostDeviceVector<bst_float> &preds, const MetaInfo &info,
               bool distributed) override {
-    CHECK_EQ(preds.Size(), info.labels_.Size())
-        << "label size predict size not match";
-
-    // quick consistency when group is not available
-    std::vector<unsigned> tgptr(2, 0);
-    tgptr[1] = static_cast<unsigned>(preds.Size());
-    const auto &gptr = info.group_ptr_.size() == 0 ? tgptr : info.group_ptr_;
-
-    CHECK_NE(gptr.size(), 0U) << "must specify group when constructing rank file";
-    CHECK_EQ(gptr.back(), preds.Size())
-        << "EvalRank: group structure must match number of prediction";
+    std::vector<unsigned> tgptr;
+    auto const &gptr = CheckGroupPtr(preds, info, &tgptr);
 
     const auto ngroups = static_cast<bst_omp_uint>(gptr.size() - 1);
     // sum statistics
@@ -191,32 +230,10 @@ struct EvalRank : public Metric, public EvalRankConfig {
     }
 
     CHECK(tparam_);
-    std::vector<double> sum_tloc(tparam_->Threads(), 0.0);
-
     if (!rank_gpu_ || tparam_->gpu_id < 0) {
-      const auto &labels = info.labels_.ConstHostVector();
-      const auto &h_preds = preds.ConstHostVector();
-
-      dmlc::OMPException exc;
-#pragma omp parallel num_threads(tparam_->Threads())
-      {
-        exc.Run([&]() {
-          // each thread takes a local rec
-          PredIndPairContainer rec;
-#pragma omp for schedule(static)
-          for (bst_omp_uint k = 0; k < ngroups; ++k) {
-            exc.Run([&]() {
-              rec.clear();
-              for (unsigned j = gptr[k]; j < gptr[k + 1]; ++j) {
-                rec.emplace_back(h_preds[j], static_cast<int>(labels[j]));
-              }
-              sum_tloc[omp_get_thread_num()] += this->EvalGroup(&rec);
-            });
-          }
-        });
-      }
-      sum_metric = std::accumulate(sum_tloc.cbegin(), sum_tloc.cend(), 0.0);
-      exc.Rethrow();
+      std::vector<double> sums;
+      EvalRankGroups({this}, preds, info, gptr, tparam_->Threads(), &sums);
+      sum_metric = sums.front();
     }
 
     if (distributed) {
@@ -233,6 +250,10 @@ struct EvalRank : public Metric, public EvalRankConfig {
     return name.c_str();
   }
 
+  /*! \brief Whether the metric needs the ideal ordering of labels. */
+  virtual bool NeedIdeal() const { return false; }
+  virtual double EvalGroup(RankGroup const &group) const = 0;
+
  protected:
   explicit EvalRank(const char* name, const char* param) {
     using namespace std;  // NOLINT(*)
@@ -253,22 +274,134 @@ struct EvalRank : public Metric, public EvalRankConfig {
       this->name = name;
     }
   }
-
-  virtual double EvalGroup(PredIndPairContainer *recptr) const = 0;
 };
 
+namespace {
+void EvalRankGroups(std::vector<EvalRank const *> const &metrics,
+                    HostDeviceVector<bst_float> const &preds, MetaInfo const &info,
+                    std::vector<unsigned> const &gptr, int32_t n_threads,
+                    std::vector<double> *out_sums) {
+  const auto &labels = info.labels_.ConstHostVector();
+  const auto &h_preds = preds.ConstHostVector();
+  const auto ngroups = static_cast<bst_omp_uint>(gptr.size() - 1);
+
+  size_t max_k = 0;
+  bool need_ideal = false;
+  for (auto const *m : metrics) {
+    max_k = std::max(max_k, static_cast<size_t>(m->topn));
+    need_ideal |= m->NeedIdeal();
+  }
+
+  // Largest group first, so a skewed tail doesn't end up on a single thread.
+  std::vector<bst_omp_uint> order(ngroups);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](bst_omp_uint l, bst_omp_uint r) {
+    return gptr[l + 1] - gptr[l] > gptr[r + 1] - gptr[r];
+  });
+
+  std::vector<double> sum_tloc(n_threads * metrics.size(), 0.0);
+  std::vector<RankGroup> groups(n_threads);
+  std::vector<std::vector<unsigned>> rows(n_threads);
+  common::ParallelFor(ngroups, n_threads, common::Sched::Dyn(), [&](bst_omp_uint i) {
+    auto tid = common::ThreadIdx();
+    auto g = order[i];
+    auto beg = gptr[g];
+    size_t n = gptr[g + 1] - beg;
+    size_t k = std::min(max_k, n);
+    auto &group = groups[tid];
+    auto &idx = rows[tid];
+
+    idx.resize(n);
+    std::iota(idx.begin(), idx.end(), beg);
+    auto by_pred = [&](unsigned l, unsigned r) {
+      return h_preds[l] > h_preds[r] || (h_preds[l] == h_preds[r] && l < r);
+    };
+    if (k < n) {
+      std::nth_element(idx.begin(), idx.begin() + k, idx.end(), by_pred);
+    }
+    std::sort(idx.begin(), idx.begin() + k, by_pred);
+    group.by_pred.resize(k);
+    for (size_t j = 0; j < k; ++j) {
+      group.by_pred[j] = static_cast<int>(labels[idx[j]]);
+    }
+
+    group.n_rel = 0;
+    for (size_t j = 0; j < n; ++j) {
+      group.n_rel += static_cast<int>(labels[beg + j]) != 0;
+    }
+    if (need_ideal) {
+      group.by_label.resize(n);
+      for (size_t j = 0; j < n; ++j) {
+        group.by_label[j] = static_cast<int>(labels[beg + j]);
+      }
+      if (k < n) {
+        std::nth_element(group.by_label.begin(), group.by_label.begin() + k,
+                         group.by_label.end(), std::greater<>{});
+      }
+      std::sort(group.by_label.begin(), group.by_label.begin() + k, std::greater<>{});
+      group.by_label.resize(k);
+    }
+
+    for (size_t m = 0; m < metrics.size(); ++m) {
+      sum_tloc[tid * metrics.size() + m] += metrics[m]->EvalGroup(group);
+    }
+  });
+
+  out_sums->assign(metrics.size(), 0.0);
+  for (int32_t t = 0; t < n_threads; ++t) {
+    for (size_t m = 0; m < metrics.size(); ++m) {
+      (*out_sums)[m] += sum_tloc[t * metrics.size() + m];
+    }
+  }
+}
+}  // anonymous namespace
+
+std::vector<size_t> EvalRankMany(std::vector<std::unique_ptr<Metric>> const &metrics,
+                                 GenericParameter const &tparam,
+                                 HostDeviceVector<bst_float> const &preds, MetaInfo const &info,
+                                 bool distributed, std::vector<double> *out) {
+  // GPU ranking metrics have their own sort.
+  if (tparam.gpu_id >= 0) {
+    return {};
+  }
+  std::vector<size_t> ranked_idx;
+  std::vector<EvalRank const *> ranked;
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    auto const *rank = dynamic_cast<EvalRank const *>(metrics[i].get());
+    if (rank) {
+      ranked_idx.push_back(i);
+      ranked.push_back(rank);
+    }
+  }
+  if (ranked.size() < 2) {
+    return {};
+  }
+
+  std::vector<unsigned> tgptr;
+  auto const &gptr = CheckGroupPtr(preds, info, &tgptr);
+  std::vector<double> dat;
+  EvalRankGroups(ranked, preds, info, gptr, tparam.Threads(), &dat);
+  dat.push_back(static_cast<double>(gptr.size() - 1));
+  if (distributed) {
+    rabit::Allreduce<rabit::op::Sum>(dat.data(), dat.size());
+  }
+  for (size_t j = 0; j < ranked_idx.size(); ++j) {
+    (*out)[ranked_idx[j]] = dat[j] / dat.back();
+  }
+  return ranked_idx;
+}
+
 /*! \brief Precision at N, for both classification and rank */
 struct EvalPrecision : public EvalRank {
  public:
   explicit EvalPrecision(const char* name, const char* param) : EvalRank(name, param) {}
 
-  double EvalGroup(PredIndPairContainer *recptr) const override {
-    PredIndPairContainer &rec(*recptr);
+  double EvalGroup(RankGroup const &group) const override {
+    auto const &rec = group.by_pred;
     // calculate Precision
-    std::stable_sort(rec.begin(), rec.end(), common::CmpFirst);
     unsigned nhit = 0;
     for (size_t j = 0; j < rec.size() && j < this->topn; ++j) {
-      nhit += (rec[j].second != 0);
+      nhit += (rec[j] != 0);
     }
     return static_cast<double>(nhit) / this->topn;
   }
@@ -277,10 +410,10 @@ struct EvalPrecision : public EvalRank {
 /*! \brief NDCG: Normalized Discounted Cumulative Gain at N */
 struct EvalNDCG : public EvalRank {
  private:
-  double CalcDCG(const PredIndPairContainer &rec) const {
+  double CalcDCG(std::vector<unsigned> const &rec) const {
     double sumdcg = 0.0;
     for (size_t i = 0; i < rec.size() && i < this->topn; ++i) {
-      const unsigned rel = rec[i].second;
+      const unsigned rel = rec[i];
       if (rel != 0) {
         sumdcg += ((1 << rel) - 1) / std::log2(i + 2.0);
       }
@@ -291,12 +424,10 @@ struct EvalNDCG : public EvalRank {
  public:
   explicit EvalNDCG(const char* name, const char* param) : EvalRank(name, param) {}
 
-  double EvalGroup(PredIndPairContainer *recptr) const override {
-    PredIndPairContainer &rec(*recptr);
-    std::stable_sort(rec.begin(), rec.end(), common::CmpFirst);
-    double dcg = CalcDCG(rec);
-    std::stable_sort(rec.begin(), rec.end(), common::CmpSecond);
-    double idcg = CalcDCG(rec);
+  bool NeedIdeal() const override { return true; }
+  double EvalGroup(RankGroup const &group) const override {
+    double dcg = CalcDCG(group.by_pred);
+    double idcg = CalcDCG(group.by_label);
     if (idcg == 0.0f) {
       if (this->minus) {
         return 0.0f;
@@ -313,21 +444,19 @@ struct EvalMAP : public EvalRank {
  public:
   explicit EvalMAP(const char* name, const char* param) : EvalRank(name, param) {}
 
-  double EvalGroup(PredIndPairContainer *recptr) const override {
-    PredIndPairContainer &rec(*recptr);
-    std::stable_sort(rec.begin(), rec.end(), common::CmpFirst);
+  double EvalGroup(RankGroup const &group) const override {
+    auto const &rec = group.by_pred;
     unsigned nhits = 0;
     double sumap = 0.0;
-    for (size_t i = 0; i < rec.size(); ++i) {
-      if (rec[i].second != 0) {
+    for (size_t i = 0; i < rec.size() && i < this->topn; ++i) {
+      if (rec[i] != 0) {
         nhits += 1;
-        if (i < this->topn) {
-          sumap += static_cast<double>(nhits) / (i + 1);
-        }
+        sumap += static_cast<double>(nhits) / (i + 1);
       }
     }
-    if (nhits != 0) {
-      sumap /= nhits;
+    // hits below the cut off still count towards the normalization.
+    if (group.n_rel != 0) {
+      sumap /= group.n_rel;
       return sumap;
     } else {
       if (this->minus) {
@@ -350,34 +479,36 @@ struct EvalCox : public Metric {
 
     const auto ndata = static_cast<bst_omp_uint>(info.labels_.Size());
     const auto &label_order = info.LabelAbsSort();
+    auto n_threads = tparam_->Threads();
 
-    // pre-compute a sum for the denominator
-    double exp_p_sum = 0;  // we use double because we might need the precision with large datasets
-
+    // Predictions are already transformed by exp.
     const auto &h_preds = preds.ConstHostVector();
-    for (omp_ulong i = 0; i < ndata; ++i) {
-      exp_p_sum += h_preds[i];
-    }
-
-    double out = 0;
-    double accumulated_sum = 0;
-    bst_omp_uint num_events = 0;
+    std::vector<double> exp_p(ndata);
+    common::ParallelFor(ndata, n_threads,
+                        [&](bst_omp_uint i) { exp_p[i] = h_preds[label_order[i]]; });
+    // The denominator only changes after we move forward in time (labels are sorted).
     const auto& labels = info.labels_.ConstHostVector();
-    for (bst_omp_uint i = 0; i < ndata; ++i) {
-      const size_t ind = label_order[i];
-      const auto label = labels[ind];
-      if (label > 0) {
-        out -= log(h_preds[ind]) - log(exp_p_sum);
-        ++num_events;
-      }
-
-      // only update the denominator after we move forward in time (labels are sorted)
-      accumulated_sum += h_preds[ind];
-      if (i == ndata - 1 || std::abs(label) < std::abs(labels[label_order[i + 1]])) {
-        exp_p_sum -= accumulated_sum;
-        accumulated_sum = 0;
+    std::vector<double> risk;
+    common::cox::RiskSetSums(label_order, labels, exp_p, n_threads, &risk);
+
+    common::cox::SortedBlocks blocks(ndata, n_threads);
+    std::vector<double> block_out(blocks.Size(), 0.0);
+    std::vector<bst_omp_uint> block_events(blocks.Size(), 0);
+    common::ParallelFor(blocks.Size(), n_threads, [&](size_t b) {
+      double out = 0;
+      bst_omp_uint num_events = 0;
+      for (size_t i = blocks.Begin(b); i < blocks.End(b); ++i) {
+        if (labels[label_order[i]] > 0) {
+          out -= log(exp_p[i]) - log(risk[i]);
+          ++num_events;
+        }
       }
-    }
+      block_out[b] = out;
+      block_events[b] = num_events;
+    });
+    double out = std::accumulate(block_out.cbegin(), block_out.cend(), 0.0);
+    auto num_events = std::accumulate(block_events.cbegin(), block_events.cend(),
+                                      static_cast<bst_omp_uint>(0));
 
     return out/num_events;  // normalize by the number of events
   }
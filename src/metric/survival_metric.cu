@@ -63,7 +63,7 @@ class ElementWiseSurvivalMetricsReduction {
     common::ParallelFor(ndata, n_threads, [&](size_t i) {
       const double wt =
           h_weights.empty() ? 1.0 : static_cast<double>(h_weights[i]);
-      auto t_idx = omp_get_thread_num();
+      auto t_idx = common::ThreadIdx();
       score_tloc[t_idx] +=
           policy_.EvalRow(static_cast<double>(h_labels_lower_bound[i]),
                           static_cast<double>(h_labels_upper_bound[i]),
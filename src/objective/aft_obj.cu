@@ -56,14 +56,12 @@ class AFTObj : public ObjFunction {
       const double pred = static_cast<double>(_preds[_idx]);
       const double label_lower_bound = static_cast<double>(_labels_lower_bound[_idx]);
       const double label_upper_bound = static_cast<double>(_labels_upper_bound[_idx]);
-      const float grad = static_cast<float>(
-          AFTLoss<Distribution>::Gradient(label_lower_bound, label_upper_bound,
-                                          pred, aft_loss_distribution_scale));
-      const float hess = static_cast<float>(
-          AFTLoss<Distribution>::Hessian(label_lower_bound, label_upper_bound,
-                                         pred, aft_loss_distribution_scale));
+      double grad, hess;
+      AFTLoss<Distribution>::GradHess(label_lower_bound, label_upper_bound, pred,
+                                      aft_loss_distribution_scale, &grad, &hess);
       const bst_float w = is_null_weight ? 1.0f : _weights[_idx];
-      _out_gpair[_idx] = GradientPair(grad * w, hess * w);
+      _out_gpair[_idx] = GradientPair(static_cast<float>(grad) * w,
+                                      static_cast<float>(hess) * w);
     },
     common::Range{0, static_cast<int64_t>(ndata)}, device).Eval(
         out_gpair, &preds, &info.labels_lower_bound_, &info.labels_upper_bound_,
@@ -117,6 +115,7 @@ class AFTObj : public ObjFunction {
   void EvalTransform(HostDeviceVector<bst_float> *io_preds) override {
     // do nothing here, since the AFT metric expects untransformed prediction score
   }
+  PredTransformKind EvalTransformKind() const override { return PredTransformKind::kIdentity; }
 
   bst_float ProbToMargin(bst_float base_score) const override {
     return std::log(base_score);
@@ -19,6 +19,7 @@
 
 #include "../common/common.h"
 #include "../common/math.h"
+#include "../common/threading_utils.h"
 #include "../common/transform.h"
 
 namespace xgboost {
@@ -48,13 +49,69 @@ class SoftmaxMultiClassObj : public ObjFunction {
 
   ObjInfo Task() const override { return {ObjInfo::kClassification, false}; }
 
+  // Gradient of a single data point, `label` must be valid.
+  XGBOOST_DEVICE static void CalcGradient(common::Span<bst_float const> point, bst_float label,
+                                          bst_float wt, common::Span<GradientPair> out) {
+    auto const nclass = static_cast<int>(point.size());
+    // Part of Softmax function
+    bst_float wmax = std::numeric_limits<bst_float>::min();
+    for (auto const i : point) { wmax = fmaxf(i, wmax); }
+    double wsum = 0.0f;
+    for (auto const i : point) { wsum += expf(i - wmax); }
+    for (int k = 0; k < nclass; ++k) {
+      // Computation duplicated to avoid creating a cache.
+      bst_float p = expf(point[k] - wmax) / static_cast<float>(wsum);
+      const float eps = 1e-16f;
+      const bst_float h = fmax(2.0f * p * (1.0f - p) * wt, eps);
+      p = label == k ? p - 1.0f : p;
+      out[k] = GradientPair(p * wt, h);
+    }
+  }
+
+  /*!
+   * \brief Gradient of rows in [begin, end) on CPU.  Each row is processed with a few
+   *        contiguous loops over classes using `ExpNonPositive`, which are vectorized by
+   *        the compiler.
+   */
+  static void CalcGradientHost(common::Span<bst_float const> preds,
+                               std::vector<bst_float> const& labels,
+                               std::vector<bst_float> const& weights, size_t begin,
+                               size_t end, size_t nclass, std::vector<float>* p_exp,
+                               common::Span<GradientPair> out_gpair) {
+    auto& exp = *p_exp;
+    exp.resize(nclass);
+    float const eps = 1e-16f;
+    for (size_t idx = begin; idx < end; ++idx) {
+      auto const* point = preds.data() + idx * nclass;
+      auto* gpair = out_gpair.data() + idx * nclass;
+      bst_float wt = weights.empty() ? 1.0f : weights[idx];
+      auto label = static_cast<size_t>(labels[idx]);
+
+      float wmax = point[0];
+      for (size_t k = 1; k < nclass; ++k) {
+        wmax = std::max(point[k], wmax);
+      }
+      for (size_t k = 0; k < nclass; ++k) {
+        exp[k] = common::ExpNonPositive(point[k] - wmax);
+      }
+      double wsum = 0.0;
+      for (size_t k = 0; k < nclass; ++k) {
+        wsum += exp[k];
+      }
+      float const inv = 1.0f / static_cast<float>(wsum);
+      for (size_t k = 0; k < nclass; ++k) {
+        float p = exp[k] * inv;
+        float h = std::max(2.0f * p * (1.0f - p) * wt, eps);
+        gpair[k] = GradientPair(p * wt, h);
+      }
+      gpair[label] += GradientPair(-wt, 0.0f);
+    }
+  }
+
   void GetGradient(const HostDeviceVector<bst_float>& preds,
                    const MetaInfo& info,
                    int iter,
                    HostDeviceVector<GradientPair>* out_gpair) override {
-    // Remove unused parameter compiler warning.
-    (void) iter;
-
     if (info.labels_.Size() == 0) {
       return;
     }
@@ -69,6 +126,18 @@ class SoftmaxMultiClassObj : public ObjFunction {
     const auto ndata = static_cast<int64_t>(preds.Size() / nclass);
 
     auto device = tparam_->gpu_id;
+    if (device < 0) {
+      // Avoid the transform on CPU, it evaluates one row at a time with scalar exp.
+      this->PrepareGradient(preds, info, iter, out_gpair);
+      size_t constexpr kBlockOfRows = 256;
+      size_t n_blocks = common::DivRoundUp(static_cast<size_t>(ndata), kBlockOfRows);
+      common::ParallelFor(n_blocks, tparam_->Threads(), [&](size_t block) {
+        size_t begin = block * kBlockOfRows;
+        size_t end = std::min(begin + kBlockOfRows, static_cast<size_t>(ndata));
+        this->GetGradientRange(preds, info, begin, end, out_gpair);
+      });
+      return;
+    }
     out_gpair->SetDevice(device);
     info.labels_.SetDevice(device);
     info.weights_.SetDevice(device);
@@ -94,26 +163,13 @@ class SoftmaxMultiClassObj : public ObjFunction {
                            common::Span<bst_float const> weights,
                            common::Span<int> _label_correct) {
           common::Span<bst_float const> point = preds.subspan(idx * nclass, nclass);
-
-          // Part of Softmax function
-          bst_float wmax = std::numeric_limits<bst_float>::min();
-          for (auto const i : point) { wmax = fmaxf(i, wmax); }
-          double wsum = 0.0f;
-          for (auto const i : point) { wsum += expf(i - wmax); }
           auto label = labels[idx];
           if (label < 0 || label >= nclass) {
             _label_correct[0] = 0;
             label = 0;
           }
           bst_float wt = is_null_weight ? 1.0f : weights[idx];
-          for (int k = 0; k < nclass; ++k) {
-            // Computation duplicated to avoid creating a cache.
-            bst_float p = expf(point[k] - wmax) / static_cast<float>(wsum);
-            const float eps = 1e-16f;
-            const bst_float h = fmax(2.0f * p * (1.0f - p) * wt, eps);
-            p = label == k ? p - 1.0f : p;
-            gpair[idx * nclass + k] = GradientPair(p * wt, h);
-          }
+          CalcGradient(point, label, wt, gpair.subspan(idx * nclass, nclass));
         }, common::Range{0, ndata}, device, false)
         .Eval(out_gpair, &info.labels_, &preds, &info.weights_, &label_correct_);
 
@@ -124,6 +180,46 @@ class SoftmaxMultiClassObj : public ObjFunction {
       }
     }
   }
+
+  bool SupportsGradientRange() const override { return true; }
+
+  void PrepareGradient(const HostDeviceVector<bst_float>& preds, const MetaInfo& info, int,
+                       HostDeviceVector<GradientPair>* out_gpair) override {
+    CHECK_NE(info.labels_.Size(), 0U) << "label set cannot be empty";
+    CHECK(preds.Size() == (static_cast<size_t>(param_.num_class) * info.labels_.Size()))
+        << "SoftmaxMultiClassObj: label size and pred size does not match.\n"
+        << "label.Size() * num_class: "
+        << info.labels_.Size() * static_cast<size_t>(param_.num_class) << "\n"
+        << "num_class: " << param_.num_class << "\n"
+        << "preds.Size(): " << preds.Size();
+    if (info.weights_.Size() != 0) {
+      CHECK_EQ(info.weights_.Size(), info.labels_.Size())
+          << "Number of weights should be equal to number of data points.";
+    }
+    auto const nclass = param_.num_class;
+    auto const& labels = info.labels_.ConstHostVector();
+    bool label_correct = std::all_of(labels.cbegin(), labels.cend(), [&](bst_float y) {
+      return y >= 0 && y < nclass;
+    });
+    if (!label_correct) {
+      LOG(FATAL) << "SoftmaxMultiClassObj: label must be in [0, num_class).";
+    }
+    preds.ConstHostVector();
+    info.weights_.ConstHostVector();
+    out_gpair->Resize(preds.Size());
+    out_gpair->HostVector();
+  }
+
+  void GetGradientRange(const HostDeviceVector<bst_float>& preds, const MetaInfo& info,
+                        size_t begin, size_t end,
+                        HostDeviceVector<GradientPair>* out_gpair) const override {
+    size_t const nclass = param_.num_class;
+    // scratch for exponentials, shared by all rows of the range.
+    thread_local std::vector<float> exp;
+    CalcGradientHost(preds.ConstHostSpan(), info.labels_.ConstHostVector(),
+                     info.weights_.ConstHostVector(), begin, end, nclass, &exp,
+                     out_gpair->HostSpan());
+  }
   void PredTransform(HostDeviceVector<bst_float>* io_preds) const override {
     this->Transform(io_preds, output_prob_);
   }
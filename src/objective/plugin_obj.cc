@@ -0,0 +1,167 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file plugin_obj.cc
+ * \brief Objective calling block callbacks of a plugin library, see `plugin_abi.h`.
+ */
+#include <dmlc/registry.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xgboost/host_device_vector.h"
+#include "xgboost/json.h"
+#include "xgboost/logging.h"
+#include "xgboost/objective.h"
+#include "xgboost/plugin_abi.h"
+
+#include "../common/common.h"
+#include "../common/plugin_loader.h"
+#include "../common/threading_utils.h"
+
+namespace xgboost {
+namespace obj {
+namespace {
+constexpr size_t kBlockRows = 2048;
+static_assert(sizeof(GradientPair) == sizeof(float) * 2,
+              "Plugins write gradient pairs as interleaved floats.");
+}  // anonymous namespace
+
+class PluginObjective : public ObjFunction {
+  XGBPluginObjective desc_;
+  std::string name_;
+  std::string default_metric_;
+  Json config_{Object{}};
+  void *state_{nullptr};
+
+  void Reset() {
+    if (state_ && desc_.destroy) {
+      desc_.destroy(state_);
+    }
+    state_ = nullptr;
+    if (desc_.create) {
+      std::string str;
+      Json::Dump(config_, &str);
+      state_ = desc_.create(str.c_str());
+    }
+  }
+
+ public:
+  PluginObjective(XGBPluginObjective const &desc, std::string name, std::string metric)
+      : desc_{desc}, name_{std::move(name)}, default_metric_{std::move(metric)} {
+    this->Reset();
+  }
+  ~PluginObjective() override {
+    if (state_ && desc_.destroy) {
+      desc_.destroy(state_);
+    }
+  }
+
+  void Configure(std::vector<std::pair<std::string, std::string>> const &args) override {
+    config_ = Object{};
+    for (auto const &kv : args) {
+      config_[kv.first] = String{kv.second};
+    }
+    this->Reset();
+  }
+
+  void GetGradient(HostDeviceVector<bst_float> const &preds, MetaInfo const &info,
+                   int iteration, HostDeviceVector<GradientPair> *out_gpair) override {
+    this->PrepareGradient(preds, info, iteration, out_gpair);
+    auto n_blocks = common::DivRoundUp(info.num_row_, kBlockRows);
+    common::ParallelFor(n_blocks, tparam_->Threads(), [&](size_t b) {
+      this->GetGradientRange(preds, info, b * kBlockRows,
+                             std::min<size_t>((b + 1) * kBlockRows, info.num_row_), out_gpair);
+    });
+  }
+
+  bool SupportsGradientRange() const override { return true; }
+
+  void PrepareGradient(HostDeviceVector<bst_float> const &preds, MetaInfo const &info, int,
+                       HostDeviceVector<GradientPair> *out_gpair) override {
+    CHECK_NE(info.num_row_, 0U);
+    CHECK_EQ(preds.Size(), info.labels_.Size())
+        << "labels are not correctly provided, preds.size=" << preds.Size()
+        << ", label.size=" << info.labels_.Size() << ", Objective: " << name_;
+    CHECK_EQ(preds.Size() % info.num_row_, 0U);
+    if (info.weights_.Size() != 0) {
+      CHECK_EQ(info.weights_.Size(), info.num_row_)
+          << "Number of weights should be equal to number of rows.";
+    }
+    preds.ConstHostVector();
+    info.labels_.ConstHostVector();
+    info.weights_.ConstHostVector();
+    out_gpair->Resize(preds.Size());
+    out_gpair->HostVector();
+  }
+
+  void GetGradientRange(HostDeviceVector<bst_float> const &preds, MetaInfo const &info,
+                        size_t begin, size_t end,
+                        HostDeviceVector<GradientPair> *out_gpair) const override {
+    size_t const n_targets = preds.Size() / info.num_row_;
+    auto const &h_weights = info.weights_.ConstHostVector();
+    XGBPluginBlock block;
+    block.row_begin = begin;
+    block.n_rows = end - begin;
+    block.n_targets = n_targets;
+    block.predt = preds.ConstHostPointer() + begin * n_targets;
+    block.labels = info.labels_.ConstHostPointer() + begin * n_targets;
+    block.weights = h_weights.empty() ? nullptr : h_weights.data() + begin;
+    auto *out = reinterpret_cast<float *>(out_gpair->HostPointer() + begin * n_targets);
+    CHECK_EQ(desc_.gradient(state_, &block, out), 0)
+        << "Plugin objective `" << name_ << "` failed to compute gradient.";
+  }
+
+  const char *DefaultEvalMetric() const override { return default_metric_.c_str(); }
+
+  void PredTransform(HostDeviceVector<bst_float> *io_preds) const override {
+    if (!desc_.pred_transform) {
+      return;
+    }
+    auto &h_preds = io_preds->HostVector();
+    auto n_blocks = common::DivRoundUp(h_preds.size(), kBlockRows);
+    common::ParallelFor(n_blocks, tparam_->Threads(), [&](size_t b) {
+      auto begin = b * kBlockRows;
+      auto n = std::min(kBlockRows, h_preds.size() - begin);
+      CHECK_EQ(desc_.pred_transform(state_, h_preds.data() + begin, n), 0)
+          << "Plugin objective `" << name_ << "` failed to transform prediction.";
+    });
+  }
+
+  bst_float ProbToMargin(bst_float base_score) const override {
+    return desc_.prob_to_margin ? desc_.prob_to_margin(state_, base_score) : base_score;
+  }
+
+  ObjInfo Task() const override { return ObjInfo{static_cast<ObjInfo::Task>(desc_.task)}; }
+
+  void SaveConfig(Json *p_out) const override {
+    auto &out = *p_out;
+    out["name"] = String{name_};
+    out["plugin_param"] = config_;
+  }
+
+  void LoadConfig(Json const &in) override {
+    config_ = in["plugin_param"];
+    this->Reset();
+  }
+};
+}  // namespace obj
+
+void RegisterPluginObjective(XGBPluginObjective const &obj) {
+  CHECK(obj.name) << "Plugin objective must have a name.";
+  CHECK(obj.gradient) << "Plugin objective `" << obj.name << "` has no gradient function.";
+  CHECK(obj.task >= kXGBPluginRegression && obj.task <= kXGBPluginOther)
+      << "Invalid task for plugin objective `" << obj.name << "`.";
+  std::string name{obj.name};
+  std::string metric{obj.default_metric ? obj.default_metric : "rmse"};
+  XGBPluginObjective desc = obj;
+  // The strings are owned by the plugin, only callbacks are used after registration.
+  desc.name = nullptr;
+  desc.default_metric = nullptr;
+  ::dmlc::Registry<ObjFunctionReg>::Get()
+      ->__REGISTER__(name)
+      .describe("Objective loaded from plugin.")
+      .set_body([desc, name, metric]() { return new obj::PluginObjective(desc, name, metric); });
+}
+}  // namespace xgboost
@@ -7,6 +7,7 @@
 #include <xgboost/objective.h>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <utility>
 
 #include "xgboost/json.h"
@@ -35,15 +36,26 @@ DMLC_REGISTRY_FILE_TAG(rank_obj_gpu);
 #endif  // defined(XGBOOST_USE_CUDA)
 
 struct LambdaRankParam : public XGBoostParameter<LambdaRankParam> {
+  enum PairMethod { kMean = 0, kTopK = 1 };
   size_t num_pairsample;
   float fix_list_weight;
+  int lambdarank_pair_method;
   // declare parameters
   DMLC_DECLARE_PARAMETER(LambdaRankParam) {
     DMLC_DECLARE_FIELD(num_pairsample).set_lower_bound(1).set_default(1)
-        .describe("Number of pair generated for each instance.");
+        .describe("Number of pair generated for each instance.  When the pair method is "
+                  "`topk`, this is the number of top documents used for pairing.");
     DMLC_DECLARE_FIELD(fix_list_weight).set_lower_bound(0.0f).set_default(0.0f)
         .describe("Normalize the weight of each list by this value,"
                   " if equals 0, no effect will happen");
+    DMLC_DECLARE_FIELD(lambdarank_pair_method)
+        .set_default(kMean)
+        .add_enum("mean", kMean)
+        .add_enum("topk", kTopK)
+        .describe(
+            "How to construct pairs.  mean: sample `num_pairsample` pairs for each "
+            "document.  topk: pair each of the top `num_pairsample` documents ranked by "
+            "the current prediction with every document that has a different label.");
   }
 };
 
@@ -119,10 +131,13 @@ class PairwiseLambdaWeightComputer {
   }
 
 #if defined(__CUDACC__)
+  explicit PairwiseLambdaWeightComputer(const dh::SegmentSorter<float>&) {}
   PairwiseLambdaWeightComputer(const bst_float*,
                                const bst_float*,
                                const dh::SegmentSorter<float>&) {}
 
+  void Update(const bst_float*, const bst_float*, const dh::SegmentSorter<float>&) {}
+
   class PairwiseLambdaWeightMultiplier {
    public:
     // Adjust the items weight by this value
@@ -188,11 +203,18 @@ class BaseLambdaWeightMultiplier {
 // This type does that using the SegmentSorter
 class IndexablePredictionSorter {
  public:
+  IndexablePredictionSorter() = default;
   IndexablePredictionSorter(const bst_float *dpreds,
                             const dh::SegmentSorter<float> &segment_label_sorter) {
-    // Sort the predictions first
-    segment_pred_sorter_.SortItems(dpreds, segment_label_sorter.GetNumItems(),
-                                   segment_label_sorter.GetGroupSegmentsSpan());
+    this->SortPredictions(dpreds, segment_label_sorter);
+  }
+
+  // Sort the predictions within the groups of the labels. The buffers of the sorter are
+  // reused, so sorting the predictions of every iteration allocates nothing.
+  void SortPredictions(const bst_float *dpreds,
+                       const dh::SegmentSorter<float> &segment_label_sorter) {
+    segment_pred_sorter_.SortItemsSegmented(dpreds, segment_label_sorter.GetNumItems(),
+                                            segment_label_sorter.GetGroupsSpan());
 
     // Create an index for the sorted prediction positions
     segment_pred_sorter_.CreateIndexableSortedPositions();
@@ -269,12 +291,11 @@ class NDCGLambdaWeightComputer
      const common::Span<const float> dgroup_dcgs_;  // Group DCG values
   };
 
-  NDCGLambdaWeightComputer(const bst_float *dpreds,
-                           const bst_float*,
-                           const dh::SegmentSorter<float> &segment_label_sorter)
-    : IndexablePredictionSorter(dpreds, segment_label_sorter),
-      dgroup_dcg_(segment_label_sorter.GetNumGroups(), 0.0f),
-      weight_multiplier_(segment_label_sorter, *this) {
+  // The group DCG values only depend on the labels, they are computed once for the sorted
+  // labels and kept across iterations.
+  explicit NDCGLambdaWeightComputer(const dh::SegmentSorter<float> &segment_label_sorter)
+    : dgroup_dcg_(segment_label_sorter.GetNumGroups(), 0.0f),
+      segment_label_sorter_(&segment_label_sorter) {
     const auto &group_segments = segment_label_sorter.GetGroupSegmentsSpan();
 
     // Allocator to be used for managing space overhead while performing transformed reductions
@@ -296,12 +317,25 @@ class NDCGLambdaWeightComputer
     CHECK_EQ(static_cast<unsigned>(end_range.second - dgroup_dcg_.begin()), dgroup_dcg_.size());
   }
 
+  NDCGLambdaWeightComputer(const bst_float *dpreds,
+                           const bst_float *dlabels,
+                           const dh::SegmentSorter<float> &segment_label_sorter)
+    : NDCGLambdaWeightComputer(segment_label_sorter) {
+    this->Update(dpreds, dlabels, segment_label_sorter);
+  }
+
+  // Prepare for the predictions of an iteration
+  void Update(const bst_float *dpreds, const bst_float *,
+              const dh::SegmentSorter<float> &segment_label_sorter) {
+    this->SortPredictions(dpreds, segment_label_sorter);
+  }
+
   inline const common::Span<const float> GetGroupDcgsSpan() const {
     return { dgroup_dcg_.data().get(), dgroup_dcg_.size() };
   }
 
   inline const NDCGLambdaWeightMultiplier GetWeightMultiplier() const {
-    return weight_multiplier_;
+    return {*segment_label_sorter_, *this};
   }
 #endif
 
@@ -370,8 +404,7 @@ class NDCGLambdaWeightComputer
 
 #if defined(__CUDACC__)
   dh::caching_device_vector<float> dgroup_dcg_;
-  // This computes the adjustment to the weight
-  const NDCGLambdaWeightMultiplier weight_multiplier_;
+  const dh::SegmentSorter<float> *segment_label_sorter_;
 #endif
 };
 
@@ -505,12 +538,20 @@ class MAPLambdaWeightComputer
   }
 
 #if defined(__CUDACC__)
+  explicit MAPLambdaWeightComputer(const dh::SegmentSorter<float> &segment_label_sorter)
+    : segment_label_sorter_(&segment_label_sorter) {}
+
   MAPLambdaWeightComputer(const bst_float *dpreds,
                           const bst_float *dlabels,
                           const dh::SegmentSorter<float> &segment_label_sorter)
-    : IndexablePredictionSorter(dpreds, segment_label_sorter),
-      dmap_stats_(segment_label_sorter.GetNumItems(), MAPStats()),
-      weight_multiplier_(segment_label_sorter, *this) {
+    : MAPLambdaWeightComputer(segment_label_sorter) {
+    this->Update(dpreds, dlabels, segment_label_sorter);
+  }
+
+  // Prepare for the predictions of an iteration, the MAP stats depend on the prediction order
+  void Update(const bst_float *dpreds, const bst_float *dlabels,
+              const dh::SegmentSorter<float> &segment_label_sorter) {
+    this->SortPredictions(dpreds, segment_label_sorter);
     this->CreateMAPStats(dlabels, segment_label_sorter);
   }
 
@@ -524,36 +565,35 @@ class MAPLambdaWeightComputer
 
     // First, determine postive labels in the dataset individually
     auto nitems = segment_label_sorter.GetNumItems();
-    dh::caching_device_vector<uint32_t> dhits(nitems, 0);
+    dhits_.resize(nitems);
+    dmap_stats_.resize(nitems);
     // Original positions of the predictions after they have been sorted
     const auto &pred_original_pos = this->GetPredictionSorter().GetOriginalPositionsSpan();
     // Unsorted labels
     const float *unsorted_labels = dlabels;
     auto DeterminePositiveLabelLambda = [=] __device__(uint32_t idx) {
-      return (unsorted_labels[pred_original_pos[idx]] > 0.0f) ? 1 : 0;
+      return (unsorted_labels[pred_original_pos[idx]] > 0.0f) ? 1u : 0u;
     };  // NOLINT
 
-    thrust::transform(thrust::make_counting_iterator(static_cast<uint32_t>(0)),
-                      thrust::make_counting_iterator(nitems),
-                      dhits.begin(),
-                      DeterminePositiveLabelLambda);
-
     // Allocator to be used by sort for managing space overhead while performing prefix scans
     dh::XGBCachingDeviceAllocator<char> alloc;
 
     // Next, prefix scan the positive labels that are segmented to accumulate them.
-    // This is required for computing the accumulated precisions
+    // This is required for computing the accumulated precisions.  The labels are tested
+    // while they are being scanned.
     const auto &group_segments = segment_label_sorter.GetGroupSegmentsSpan();
     // Data segmented into different groups...
     thrust::inclusive_scan_by_key(thrust::cuda::par(alloc),
                                   dh::tcbegin(group_segments), dh::tcend(group_segments),
-                                  dhits.begin(),  // Input value
-                                  dhits.begin());  // In-place scan
+                                  dh::MakeTransformIterator<uint32_t>(
+                                    thrust::make_counting_iterator(static_cast<uint32_t>(0)),
+                                    DeterminePositiveLabelLambda),  // Input value
+                                  dhits_.begin());
 
     // Compute accumulated precisions for each item, assuming positive and
     // negative instances are missing.
     // But first, compute individual item precisions
-    const auto *dhits_arr = dhits.data().get();
+    const auto *dhits_arr = dhits_.data().get();
     // Group info on device
     const auto &dgroups = segment_label_sorter.GetGroupsSpan();
     auto ComputeItemPrecisionLambda = [=] __device__(uint32_t idx) {
@@ -567,17 +607,15 @@ class MAPLambdaWeightComputer
       return MAPStats{};
     };  // NOLINT
 
-    thrust::transform(thrust::make_counting_iterator(static_cast<uint32_t>(0)),
-                      thrust::make_counting_iterator(nitems),
-                      this->dmap_stats_.begin(),
-                      ComputeItemPrecisionLambda);
-
     // Lastly, compute the accumulated precisions for all the items segmented by groups.
-    // The precisions are accumulated within each group
+    // The precisions are accumulated within each group, item precisions are computed as
+    // they are scanned.
     thrust::inclusive_scan_by_key(thrust::cuda::par(alloc),
                                   dh::tcbegin(group_segments), dh::tcend(group_segments),
-                                  this->dmap_stats_.begin(),  // Input map stats
-                                  this->dmap_stats_.begin());  // In-place scan and output here
+                                  dh::MakeTransformIterator<MAPStats>(
+                                    thrust::make_counting_iterator(static_cast<uint32_t>(0)),
+                                    ComputeItemPrecisionLambda),  // Input map stats
+                                  this->dmap_stats_.begin());  // Output here
   }
 
   inline const common::Span<const MAPStats> GetMapStatsSpan() const {
@@ -616,12 +654,15 @@ class MAPLambdaWeightComputer
                                                // prediction value
   };
 
-  inline const MAPLambdaWeightMultiplier GetWeightMultiplier() const { return weight_multiplier_; }
+  inline const MAPLambdaWeightMultiplier GetWeightMultiplier() const {
+    return {*segment_label_sorter_, *this};
+  }
 
  private:
+  // Both are reused across iterations
+  dh::caching_device_vector<uint32_t> dhits_;
   dh::caching_device_vector<MAPStats> dmap_stats_;
-  // This computes the adjustment to the weight
-  const MAPLambdaWeightMultiplier weight_multiplier_;
+  const dh::SegmentSorter<float> *segment_label_sorter_;
 #endif
 };
 
@@ -629,6 +670,7 @@ class MAPLambdaWeightComputer
 class SortedLabelList : dh::SegmentSorter<float> {
  private:
   const LambdaRankParam &param_;                      // Objective configuration
+  std::vector<uint32_t> groups_;                      // Groups of the sorted labels
 
  public:
   explicit SortedLabelList(const LambdaRankParam &param)
@@ -636,21 +678,42 @@ class SortedLabelList : dh::SegmentSorter<float> {
 
   // Sort the labels that are grouped by 'groups'
   void Sort(const HostDeviceVector<bst_float> &dlabels, const std::vector<uint32_t> &groups) {
+    groups_ = groups;
     this->SortItems(dlabels.ConstDevicePointer(), dlabels.Size(), groups);
   }
 
+  // Whether the sorted labels are still those of 'dlabels' grouped by 'groups', labels of the
+  // training data don't change across iterations so the sort is reused.
+  bool Matches(const HostDeviceVector<bst_float> &dlabels,
+               const std::vector<uint32_t> &groups) const {
+    if (groups != groups_ || dlabels.Size() != this->GetNumItems()) {
+      return false;
+    }
+    const auto &sorted_labels = this->GetItemsSpan();
+    const auto &original_pos = this->GetOriginalPositionsSpan();
+    dh::XGBCachingDeviceAllocator<char> alloc;
+    return thrust::equal(thrust::cuda::par(alloc),
+                         dh::tcbegin(sorted_labels), dh::tcend(sorted_labels),
+                         thrust::make_permutation_iterator(
+                           thrust::device_ptr<const float>(dlabels.ConstDevicePointer()),
+                           dh::tcbegin(original_pos)));
+  }
+
+  inline const dh::SegmentSorter<float> &GetSorter() const { return *this; }
+
   // This kernel can only run *after* the kernel in sort is completed, as they
   // use the default stream
   template <typename LambdaWeightComputerT>
   void ComputeGradients(const bst_float *dpreds,   // Unsorted predictions
-                        const bst_float *dlabels,  // Unsorted labels
                         const HostDeviceVector<bst_float> &weights,
+                        const LambdaWeightComputerT &weight_computer,
                         int iter,
                         GradientPair *out_gpair,
                         float weight_normalization_factor) {
     // Group info on device
     const auto &dgroups = this->GetGroupsSpan();
-    uint32_t ngroups = this->GetNumGroups() + 1;
+    // The group each sorted label belongs to
+    const auto &group_segments = this->GetGroupSegmentsSpan();
 
     uint32_t total_items = this->GetNumItems();
     uint32_t niter = param_.num_pairsample * total_items;
@@ -666,7 +729,6 @@ class SortedLabelList : dh::SegmentSorter<float> {
 
     // This is used to adjust the weight of different elements based on the different ranking
     // objective function policies
-    LambdaWeightComputerT weight_computer(dpreds, dlabels, *this);
     auto wmultiplier = weight_computer.GetWeightMultiplier();
 
     int device_id = -1;
@@ -675,10 +737,7 @@ class SortedLabelList : dh::SegmentSorter<float> {
     dh::LaunchN(niter, nullptr, [=] __device__(uint32_t idx) {
       // First, determine the group 'idx' belongs to
       uint32_t item_idx = idx % total_items;
-      uint32_t group_idx =
-          thrust::upper_bound(thrust::seq, dgroups.begin(),
-                              dgroups.begin() + ngroups, item_idx) -
-          dgroups.begin();
+      uint32_t group_idx = group_segments[item_idx] + 1;
       // Span of this group within the larger labels/predictions sorted tuple
       uint32_t group_begin = dgroups[group_idx - 1];
       uint32_t group_end = dgroups[group_idx];
@@ -772,9 +831,10 @@ class LambdaRankObj : public ObjFunction {
           << "group pointer back: " << (gptr.size() == 0 ? 0 : gptr.back());
 
 #if defined(__CUDACC__)
-    // Check if we have a GPU assignment; else, revert back to CPU
+    // Check if we have a GPU assignment; else, revert back to CPU.  Top-k pairing is only
+    // implemented on CPU.
     auto device = tparam_->gpu_id;
-    if (device >= 0) {
+    if (device >= 0 && param_.lambdarank_pair_method == LambdaRankParam::kMean) {
       ComputeGradientsOnGPU(preds, info, iter, out_gpair, gptr);
     } else {
       // Revert back to CPU
@@ -788,6 +848,7 @@ class LambdaRankObj : public ObjFunction {
   const char* DefaultEvalMetric() const override {
     return "map";
   }
+  PredTransformKind EvalTransformKind() const override { return PredTransformKind::kIdentity; }
 
   void SaveConfig(Json* p_out) const override {
     auto& out = *p_out;
@@ -810,6 +871,66 @@ class LambdaRankObj : public ObjFunction {
     return ngroup / sum_weights;
   }
 
+  /*!
+   * \brief Sample `num_pairsample` pairs for each document, the other document is drawn
+   *        uniformly from those with a different label.
+   * \param lst the group, sorted by prediction
+   */
+  void MakeMeanPairs(std::vector<ListEntry> const &lst, bst_float weight, std::minstd_rand *rnd,
+                     std::vector<std::pair<bst_float, unsigned>> *p_rec,
+                     std::vector<LambdaPair> *pairs) const {
+    auto &rec = *p_rec;
+    rec.resize(lst.size());
+    for (unsigned i = 0; i < lst.size(); ++i) {
+      rec[i] = std::make_pair(lst[i].label, i);
+    }
+    std::stable_sort(rec.begin(), rec.end(), common::CmpFirst);
+    // enumerate buckets with same label
+    // for each item in the lst, grab another sample randomly
+    for (unsigned i = 0; i < rec.size(); ) {
+      unsigned j = i + 1;
+      while (j < rec.size() && rec[j].first == rec[i].first) ++j;
+      // bucket in [i,j), get a sample outside bucket
+      unsigned nleft = i, nright = static_cast<unsigned>(rec.size() - j);
+      if (nleft + nright != 0) {
+        int nsample = param_.num_pairsample;
+        while (nsample --) {
+          for (unsigned pid = i; pid < j; ++pid) {
+            unsigned ridx =
+                std::uniform_int_distribution<unsigned>(0, nleft + nright - 1)(*rnd);
+            if (ridx < nleft) {
+              pairs->emplace_back(rec[ridx].second, rec[pid].second, weight);
+            } else {
+              pairs->emplace_back(rec[pid].second, rec[ridx+j-i].second, weight);
+            }
+          }
+        }
+      }
+      i = j;
+    }
+  }
+
+  /*!
+   * \brief Pair each of the top `num_pairsample` documents with all documents that have a
+   *        different label.  The number of pairs is linear in the group size.
+   * \param lst the group, sorted by prediction
+   */
+  void MakeTopKPairs(std::vector<ListEntry> const &lst, bst_float weight,
+                     std::vector<LambdaPair> *pairs) const {
+    auto n = static_cast<unsigned>(lst.size());
+    auto topk = static_cast<unsigned>(std::min(param_.num_pairsample, lst.size()));
+    for (unsigned i = 0; i < topk; ++i) {
+      // pairs within the top-k are generated once, by the higher ranked document.
+      for (unsigned j = i + 1; j < n; ++j) {
+        if (lst[i].label > lst[j].label) {
+          pairs->emplace_back(i, j, weight);
+        } else if (lst[i].label < lst[j].label) {
+          pairs->emplace_back(j, i, weight);
+        }
+      }
+    }
+  }
+
   void ComputeGradientsOnCPU(const HostDeviceVector<bst_float>& preds,
                              const MetaInfo& info,
                              int iter,
@@ -826,75 +947,64 @@ class LambdaRankObj : public ObjFunction {
     out_gpair->Resize(preds.Size());
 
     dmlc::OMPException exc;
-    #pragma omp parallel
+    #pragma omp parallel num_threads(tparam_->Threads())
     {
       exc.Run([&]() {
         // parallel construct, declare random number generator here, so that each
         // thread use its own random number generator, seed by thread id and current iteration
         std::minstd_rand rnd((iter + 1) * 1111);
+        // scratch space reused by all groups processed by this thread
         std::vector<LambdaPair> pairs;
         std::vector<ListEntry>  lst;
         std::vector< std::pair<bst_float, unsigned> > rec;
 
-        #pragma omp for schedule(static)
-        for (bst_omp_uint k = 0; k < ngroup; ++k) {
-          exc.Run([&]() {
-            lst.clear(); pairs.clear();
-            for (unsigned j = gptr[k]; j < gptr[k+1]; ++j) {
-              lst.emplace_back(preds_h[j], labels[j], j);
-              gpair[j] = GradientPair(0.0f, 0.0f);
-            }
-            std::stable_sort(lst.begin(), lst.end(), ListEntry::CmpPred);
-            rec.resize(lst.size());
-            for (unsigned i = 0; i < lst.size(); ++i) {
-              rec[i] = std::make_pair(lst[i].label, i);
-            }
-            std::stable_sort(rec.begin(), rec.end(), common::CmpFirst);
-            // enumerate buckets with same label
-            // for each item in the lst, grab another sample randomly
-            for (unsigned i = 0; i < rec.size(); ) {
-              unsigned j = i + 1;
-              while (j < rec.size() && rec[j].first == rec[i].first) ++j;
-              // bucket in [i,j), get a sample outside bucket
-              unsigned nleft = i, nright = static_cast<unsigned>(rec.size() - j);
-              if (nleft + nright != 0) {
-                int nsample = param_.num_pairsample;
-                while (nsample --) {
-                  for (unsigned pid = i; pid < j; ++pid) {
-                    unsigned ridx =
-                        std::uniform_int_distribution<unsigned>(0, nleft + nright - 1)(rnd);
-                    if (ridx < nleft) {
-                      pairs.emplace_back(rec[ridx].second, rec[pid].second,
-                          info.GetWeight(k) * weight_normalization_factor);
-                    } else {
-                      pairs.emplace_back(rec[pid].second, rec[ridx+j-i].second,
-                          info.GetWeight(k) * weight_normalization_factor);
-                    }
-                  }
-                }
-              }
-              i = j;
-            }
-            // get lambda weight for the pairs
-            LambdaWeightComputerT::GetLambdaWeight(lst, &pairs);
-            // rescale each gradient and hessian so that the lst have constant weighted
-            float scale = 1.0f / param_.num_pairsample;
-            if (param_.fix_list_weight != 0.0f) {
-              scale *= param_.fix_list_weight / (gptr[k + 1] - gptr[k]);
-            }
-            for (auto & pair : pairs) {
-              const ListEntry &pos = lst[pair.pos_index];
-              const ListEntry &neg = lst[pair.neg_index];
-              const bst_float w = pair.weight * scale;
-              const float eps = 1e-16f;
-              bst_float p = common::Sigmoid(pos.pred - neg.pred);
-              bst_float g = p - 1.0f;
-              bst_float h = std::max(p * (1.0f - p), eps);
-              // accumulate gradient and hessian in both pid, and nid
-              gpair[pos.rindex] += GradientPair(g * w, 2.0f*w*h);
-              gpair[neg.rindex] += GradientPair(-g * w, 2.0f*w*h);
-            }
-          });
+        auto process = [&](bst_omp_uint k) {
+          lst.clear(); pairs.clear();
+          for (unsigned j = gptr[k]; j < gptr[k+1]; ++j) {
+            lst.emplace_back(preds_h[j], labels[j], j);
+            gpair[j] = GradientPair(0.0f, 0.0f);
+          }
+          std::stable_sort(lst.begin(), lst.end(), ListEntry::CmpPred);
+          bst_float group_weight = info.GetWeight(k) * weight_normalization_factor;
+          if (param_.lambdarank_pair_method == LambdaRankParam::kTopK) {
+            MakeTopKPairs(lst, group_weight, &pairs);
+          } else {
+            MakeMeanPairs(lst, group_weight, &rnd, &rec, &pairs);
+          }
+          // get lambda weight for the pairs
+          LambdaWeightComputerT::GetLambdaWeight(lst, &pairs);
+          // rescale each gradient and hessian so that the lst have constant weighted
+          float scale = param_.lambdarank_pair_method == LambdaRankParam::kTopK
+                            ? 1.0f
+                            : 1.0f / param_.num_pairsample;
+          if (param_.fix_list_weight != 0.0f) {
+            scale *= param_.fix_list_weight / (gptr[k + 1] - gptr[k]);
+          }
+          for (auto & pair : pairs) {
+            const ListEntry &pos = lst[pair.pos_index];
+            const ListEntry &neg = lst[pair.neg_index];
+            const bst_float w = pair.weight * scale;
+            const float eps = 1e-16f;
+            bst_float p = common::Sigmoid(pos.pred - neg.pred);
+            bst_float g = p - 1.0f;
+            bst_float h = std::max(p * (1.0f - p), eps);
+            // accumulate gradient and hessian in both pid, and nid
+            gpair[pos.rindex] += GradientPair(g * w, 2.0f*w*h);
+            gpair[neg.rindex] += GradientPair(-g * w, 2.0f*w*h);
+          }
+        };
+        if (param_.lambdarank_pair_method == LambdaRankParam::kTopK) {
+          // group sizes are often skewed, balance them dynamically
+          #pragma omp for schedule(dynamic)
+          for (bst_omp_uint k = 0; k < ngroup; ++k) {
+            exc.Run(process, k);
+          }
+        } else {
+          // keep the static schedule so that the sampled pairs are reproducible.
+          #pragma omp for schedule(static)
+          for (bst_omp_uint k = 0; k < ngroup; ++k) {
+            exc.Run(process, k);
+          }
         }
       });
     }
@@ -926,18 +1036,29 @@ class LambdaRankObj : public ObjFunction {
     auto d_gpair = out_gpair->DevicePointer();
     auto d_labels = info.labels_.ConstDevicePointer();
 
-    SortedLabelList slist(param_);
-
-    // Sort the labels within the groups on the device
-    slist.Sort(info.labels_, gptr);
+    // Sort the labels within the groups on the device, the sorted labels and everything
+    // derived from them are kept until the labels or the groups change.
+    if (!label_list_ || device_ != device || !label_list_->Matches(info.labels_, gptr)) {
+      weight_computer_.reset();
+      label_list_.reset(new SortedLabelList(param_));
+      label_list_->Sort(info.labels_, gptr);
+      weight_computer_.reset(new LambdaWeightComputerT(label_list_->GetSorter()));
+      device_ = device;
+    }
+    // Sort the predictions of this iteration
+    weight_computer_->Update(d_preds, d_labels, label_list_->GetSorter());
 
     // Initialize the gradients next
     out_gpair->Fill(GradientPair(0.0f, 0.0f));
 
     // Finally, compute the gradients
-    slist.ComputeGradients<LambdaWeightComputerT>
-      (d_preds, d_labels, info.weights_, iter, d_gpair, weight_normalization_factor);
+    label_list_->ComputeGradients<LambdaWeightComputerT>
+      (d_preds, info.weights_, *weight_computer_, iter, d_gpair, weight_normalization_factor);
   }
+
+  std::unique_ptr<SortedLabelList> label_list_;
+  std::unique_ptr<LambdaWeightComputerT> weight_computer_;
+  int32_t device_{-1};
 #endif
 
   LambdaRankParam param_;
@@ -38,6 +38,7 @@ struct LinearSquareLoss {
   static const char* DefaultEvalMetric() { return "rmse"; }
 
   static const char* Name() { return "reg:squarederror"; }
+  static PredTransformKind Transform() { return PredTransformKind::kIdentity; }
   static ObjInfo Info() { return {ObjInfo::kRegression, true}; }
 };
 
@@ -64,6 +65,7 @@ struct SquaredLogError {
   static const char* DefaultEvalMetric() { return "rmsle"; }
 
   static const char* Name() { return "reg:squaredlogerror"; }
+  static PredTransformKind Transform() { return PredTransformKind::kIdentity; }
 
   static ObjInfo Info() { return {ObjInfo::kRegression, false}; }
 };
@@ -101,6 +103,7 @@ struct LogisticRegression {
   static const char* DefaultEvalMetric() { return "rmse"; }
 
   static const char* Name() { return "reg:logistic"; }
+  static PredTransformKind Transform() { return PredTransformKind::kSigmoid; }
 
   static ObjInfo Info() { return {ObjInfo::kRegression, false}; }
 };
@@ -134,6 +137,7 @@ struct PseudoHuberError {
   static const char* Name() {
     return "reg:pseudohubererror";
   }
+  static PredTransformKind Transform() { return PredTransformKind::kIdentity; }
   static ObjInfo Info() { return {ObjInfo::kRegression, false}; }
 };
 
@@ -177,6 +181,7 @@ struct LogisticRaw : public LogisticRegression {
   static const char* DefaultEvalMetric() { return "logloss"; }
 
   static const char* Name() { return "binary:logitraw"; }
+  static PredTransformKind Transform() { return PredTransformKind::kIdentity; }
 
   static ObjInfo Info() { return {ObjInfo::kRegression, false}; }
 };
@@ -8,8 +8,10 @@
 #include <dmlc/omp.h>
 #include <xgboost/logging.h>
 #include <xgboost/objective.h>
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "xgboost/host_device_vector.h"
@@ -19,7 +21,9 @@
 
 #include "../common/transform.h"
 #include "../common/common.h"
+#include "../common/math.h"
 #include "../common/threading_utils.h"
+#include "../common/survival_util.h"
 #include "./regression_loss.h"
 
 
@@ -30,6 +34,16 @@ namespace obj {
 DMLC_REGISTRY_FILE_TAG(regression_obj_gpu);
 #endif  // defined(XGBOOST_USE_CUDA)
 
+namespace {
+// CPU block for `PredTransform` of objectives with log link.
+void ExpBlock(size_t begin, size_t end, common::Span<float> _preds) {
+  float* preds = _preds.data();
+  for (size_t i = begin; i < end; ++i) {
+    preds[i] = common::ExpBranchFree(preds[i]);
+  }
+}
+}  // anonymous namespace
+
 struct RegLossParam : public XGBoostParameter<RegLossParam> {
   float scale_pos_weight;
   // declare parameters
@@ -56,6 +70,40 @@ class RegLossObj : public ObjFunction {
     return Loss::Info();
   }
 
+  XGBOOST_DEVICE static GradientPair CalcGradient(bst_float predt, bst_float label, bst_float w,
+                                                  bst_float scale_pos_weight) {
+    bst_float p = Loss::PredTransform(predt);
+    if (label == 1.0f) {
+      w *= scale_pos_weight;
+    }
+    return GradientPair(Loss::FirstOrderGradient(p, label) * w,
+                        Loss::SecondOrderGradient(p, label) * w);
+  }
+
+  XGBOOST_DEVICE static void GradientBlock(size_t begin, size_t end,
+                                           common::Span<float> _additional_input,
+                                           common::Span<GradientPair> _out_gpair,
+                                           common::Span<const bst_float> _preds,
+                                           common::Span<const bst_float> _labels,
+                                           common::Span<const bst_float> _weights) {
+    const bst_float* preds_ptr = _preds.data();
+    const bst_float* labels_ptr = _labels.data();
+    const bst_float* weights_ptr = _weights.data();
+    GradientPair* out_gpair_ptr = _out_gpair.data();
+    const float _scale_pos_weight = _additional_input[1];
+    const bool _is_null_weight = _additional_input[2];
+
+    for (size_t idx = begin; idx < end; ++idx) {
+      bst_float w = _is_null_weight ? 1.0f : weights_ptr[idx];
+      bst_float label = labels_ptr[idx];
+      if (!Loss::CheckLabel(label)) {
+        // If there is an incorrect label, the host code will know.
+        _additional_input[0] = 0;
+      }
+      out_gpair_ptr[idx] = CalcGradient(preds_ptr[idx], label, w, _scale_pos_weight);
+    }
+  }
+
   void GetGradient(const HostDeviceVector<bst_float>& preds,
                    const MetaInfo &info, int,
                    HostDeviceVector<GradientPair>* out_gpair) override {
@@ -77,45 +125,17 @@ class RegLossObj : public ObjFunction {
     additional_input_.HostVector().begin()[1] = scale_pos_weight;
     additional_input_.HostVector().begin()[2] = is_null_weight;
 
-    const size_t nthreads = tparam_->Threads();
-    bool on_device = device >= 0;
-    // On CPU we run the transformation each thread processing a contigious block of data
-    // for better performance.
-    const size_t n_data_blocks =
-        std::max(static_cast<size_t>(1), (on_device ? ndata : nthreads));
-    const size_t block_size = ndata / n_data_blocks + !!(ndata % n_data_blocks);
+    // Each element on device, contiguous blocks of data on CPU.
     common::Transform<>::Init(
-        [block_size, ndata] XGBOOST_DEVICE(
-            size_t data_block_idx, common::Span<float> _additional_input,
-            common::Span<GradientPair> _out_gpair,
-            common::Span<const bst_float> _preds,
-            common::Span<const bst_float> _labels,
-            common::Span<const bst_float> _weights) {
-          const bst_float* preds_ptr = _preds.data();
-          const bst_float* labels_ptr = _labels.data();
-          const bst_float* weights_ptr = _weights.data();
-          GradientPair* out_gpair_ptr = _out_gpair.data();
-          const size_t begin = data_block_idx*block_size;
-          const size_t end = std::min(ndata, begin + block_size);
-          const float _scale_pos_weight = _additional_input[1];
-          const bool _is_null_weight = _additional_input[2];
-
-          for (size_t idx = begin; idx < end; ++idx) {
-            bst_float p = Loss::PredTransform(preds_ptr[idx]);
-            bst_float w = _is_null_weight ? 1.0f : weights_ptr[idx];
-            bst_float label = labels_ptr[idx];
-            if (label == 1.0f) {
-              w *= _scale_pos_weight;
-            }
-            if (!Loss::CheckLabel(label)) {
-              // If there is an incorrect label, the host code will know.
-              _additional_input[0] = 0;
-            }
-            out_gpair_ptr[idx] = GradientPair(Loss::FirstOrderGradient(p, label) * w,
-                                              Loss::SecondOrderGradient(p, label) * w);
-          }
+        [] XGBOOST_DEVICE(size_t idx, common::Span<float> _additional_input,
+                          common::Span<GradientPair> _out_gpair,
+                          common::Span<const bst_float> _preds,
+                          common::Span<const bst_float> _labels,
+                          common::Span<const bst_float> _weights) {
+          GradientBlock(idx, idx + 1, _additional_input, _out_gpair, _preds, _labels, _weights);
         },
-        common::Range{0, static_cast<int64_t>(n_data_blocks)}, device)
+        common::Range{0, static_cast<int64_t>(ndata)}, device)
+        .WithCPUBlock(GradientBlock)
         .Eval(&additional_input_, out_gpair, &preds, &info.labels_,
               &info.weights_);
 
@@ -125,6 +145,48 @@ class RegLossObj : public ObjFunction {
     }
   }
 
+  bool SupportsGradientRange() const override { return true; }
+
+  void PrepareGradient(const HostDeviceVector<bst_float>& preds, const MetaInfo& info, int,
+                       HostDeviceVector<GradientPair>* out_gpair) override {
+    CHECK_EQ(preds.Size(), info.labels_.Size())
+        << " " << "labels are not correctly provided"
+        << "preds.size=" << preds.Size() << ", label.size=" << info.labels_.Size() << ", "
+        << "Loss: " << Loss::Name();
+    CHECK_NE(info.num_row_, 0U);
+    CHECK_EQ(preds.Size() % info.num_row_, 0U);
+    size_t const ndata = preds.Size();
+    if (info.weights_.Size() != 0) {
+      CHECK_EQ(info.weights_.Size(), ndata)
+          << "Number of weights should be equal to number of data points.";
+    }
+    auto const& labels = info.labels_.ConstHostVector();
+    bool label_correct = std::all_of(labels.cbegin(), labels.cend(),
+                                     [](bst_float y) { return Loss::CheckLabel(y); });
+    if (!label_correct) {
+      LOG(FATAL) << Loss::LabelErrorMsg();
+    }
+    preds.ConstHostVector();
+    info.weights_.ConstHostVector();
+    out_gpair->Resize(ndata);
+    out_gpair->HostVector();
+  }
+
+  void GetGradientRange(const HostDeviceVector<bst_float>& preds, const MetaInfo& info,
+                        size_t begin, size_t end,
+                        HostDeviceVector<GradientPair>* out_gpair) const override {
+    size_t const n_targets = preds.Size() / info.num_row_;
+    auto const& h_preds = preds.ConstHostVector();
+    auto const& h_labels = info.labels_.ConstHostVector();
+    auto const& h_weights = info.weights_.ConstHostVector();
+    auto& h_gpair = out_gpair->HostVector();
+    bool const is_null_weight = h_weights.empty();
+    for (size_t idx = begin * n_targets; idx < end * n_targets; ++idx) {
+      bst_float w = is_null_weight ? 1.0f : h_weights[idx];
+      h_gpair[idx] = CalcGradient(h_preds[idx], h_labels[idx], w, param_.scale_pos_weight);
+    }
+  }
+
  public:
   const char* DefaultEvalMetric() const override {
     return Loss::DefaultEvalMetric();
@@ -136,9 +198,23 @@ class RegLossObj : public ObjFunction {
           _preds[_idx] = Loss::PredTransform(_preds[_idx]);
         }, common::Range{0, static_cast<int64_t>(io_preds->Size())},
         io_preds->DeviceIdx())
+        .WithCPUBlock([](size_t begin, size_t end, common::Span<float> _preds) {
+          float* preds = _preds.data();
+          if (Loss::Transform() == PredTransformKind::kSigmoid) {
+            for (size_t i = begin; i < end; ++i) {
+              preds[i] = common::SigmoidBranchFree(preds[i]);
+            }
+          } else {
+            for (size_t i = begin; i < end; ++i) {
+              preds[i] = Loss::PredTransform(preds[i]);
+            }
+          }
+        })
         .Eval(io_preds);
   }
 
+  PredTransformKind EvalTransformKind() const override { return Loss::Transform(); }
+
   float ProbToMargin(float base_score) const override {
     return Loss::ProbToMargin(base_score);
   }
@@ -265,11 +341,13 @@ class PoissonRegression : public ObjFunction {
         },
         common::Range{0, static_cast<int64_t>(io_preds->Size())},
         io_preds->DeviceIdx())
+        .WithCPUBlock(ExpBlock)
         .Eval(io_preds);
   }
   void EvalTransform(HostDeviceVector<bst_float> *io_preds) override {
     PredTransform(io_preds);
   }
+  PredTransformKind EvalTransformKind() const override { return PredTransformKind::kExp; }
   bst_float ProbToMargin(bst_float base_score) const override {
     return std::log(base_score);
   }
@@ -327,50 +405,50 @@ class CoxRegression : public ObjFunction {
           << "Number of weights should be equal to number of data points.";
     }
 
-    // pre-compute a sum
-    double exp_p_sum = 0;  // we use double because we might need the precision with large datasets
-    for (omp_ulong i = 0; i < ndata; ++i) {
-      exp_p_sum += std::exp(preds_h[label_order[i]]);
-    }
-
-    // start calculating grad and hess
+    auto n_threads = tparam_->Threads();
+    std::vector<double> exp_p(ndata);
+    common::ParallelFor(ndata, n_threads, [&](omp_ulong i) {
+      exp_p[i] = std::exp(static_cast<double>(preds_h[label_order[i]]));
+    });
+    // Denominators with Breslow's method for ties.
     const auto& labels = info.labels_.HostVector();
-    double r_k = 0;
-    double s_k = 0;
-    double last_exp_p = 0.0;
-    double last_abs_y = 0.0;
-    double accumulated_sum = 0;
-    for (omp_ulong i = 0; i < ndata; ++i) { // NOLINT(*)
-      const size_t ind = label_order[i];
-      const double p = preds_h[ind];
-      const double exp_p = std::exp(p);
-      const double w = info.GetWeight(ind);
-      const double y = labels[ind];
-      const double abs_y = std::abs(y);
-
-      // only update the denominator after we move forward in time (labels are sorted)
-      // this is Breslow's method for ties
-      accumulated_sum += last_exp_p;
-      if (last_abs_y < abs_y) {
-        exp_p_sum -= accumulated_sum;
-        accumulated_sum = 0;
-      } else {
-        CHECK(last_abs_y <= abs_y) << "CoxRegression: labels must be in sorted order, " <<
-                                      "MetaInfo::LabelArgsort failed!";
+    std::vector<double> risk;
+    common::cox::RiskSetSums(label_order, labels, exp_p, n_threads, &risk);
+
+    // r_k and s_k are prefix sums over events in the sorted order, scanned in blocks.
+    common::cox::SortedBlocks blocks(ndata, n_threads);
+    std::vector<std::pair<double, double>> block_sums(blocks.Size() + 1, {0.0, 0.0});
+    common::ParallelFor(blocks.Size(), n_threads, [&](size_t b) {
+      double r_k = 0, s_k = 0;
+      for (size_t i = blocks.Begin(b); i < blocks.End(b); ++i) {
+        if (labels[label_order[i]] > 0) {
+          r_k += 1.0 / risk[i];
+          s_k += 1.0 / (risk[i] * risk[i]);
+        }
       }
+      block_sums[b + 1] = {r_k, s_k};
+    });
+    for (size_t b = 1; b < block_sums.size(); ++b) {
+      block_sums[b].first += block_sums[b - 1].first;
+      block_sums[b].second += block_sums[b - 1].second;
+    }
 
-      if (y > 0) {
-        r_k += 1.0/exp_p_sum;
-        s_k += 1.0/(exp_p_sum*exp_p_sum);
+    common::ParallelFor(blocks.Size(), n_threads, [&](size_t b) {
+      double r_k = block_sums[b].first;
+      double s_k = block_sums[b].second;
+      for (size_t i = blocks.Begin(b); i < blocks.End(b); ++i) {
+        const size_t ind = label_order[i];
+        const double w = info.GetWeight(ind);
+        const double y = labels[ind];
+        if (y > 0) {
+          r_k += 1.0 / risk[i];
+          s_k += 1.0 / (risk[i] * risk[i]);
+        }
+        const double grad = exp_p[i] * r_k - static_cast<bst_float>(y > 0);
+        const double hess = exp_p[i] * r_k - exp_p[i] * exp_p[i] * s_k;
+        gpair[ind] = GradientPair(grad * w, hess * w);
       }
-
-      const double grad = exp_p*r_k - static_cast<bst_float>(y > 0);
-      const double hess = exp_p*r_k - exp_p*exp_p * s_k;
-      gpair.at(ind) = GradientPair(grad * w, hess * w);
-
-      last_abs_y = abs_y;
-      last_exp_p = exp_p;
-    }
+    });
   }
   void PredTransform(HostDeviceVector<bst_float> *io_preds) const override {
     std::vector<bst_float> &preds = io_preds->HostVector();
@@ -382,6 +460,7 @@ class CoxRegression : public ObjFunction {
   void EvalTransform(HostDeviceVector<bst_float> *io_preds) override {
     PredTransform(io_preds);
   }
+  PredTransformKind EvalTransformKind() const override { return PredTransformKind::kExp; }
   bst_float ProbToMargin(bst_float base_score) const override {
     return std::log(base_score);
   }
@@ -460,11 +539,13 @@ class GammaRegression : public ObjFunction {
         },
         common::Range{0, static_cast<int64_t>(io_preds->Size())},
         io_preds->DeviceIdx())
+        .WithCPUBlock(ExpBlock)
         .Eval(io_preds);
   }
   void EvalTransform(HostDeviceVector<bst_float> *io_preds) override {
     PredTransform(io_preds);
   }
+  PredTransformKind EvalTransformKind() const override { return PredTransformKind::kExp; }
   bst_float ProbToMargin(bst_float base_score) const override {
     return std::log(base_score);
   }
@@ -567,8 +648,10 @@ class TweedieRegression : public ObjFunction {
         },
         common::Range{0, static_cast<int64_t>(io_preds->Size())},
         io_preds->DeviceIdx())
+        .WithCPUBlock(ExpBlock)
         .Eval(io_preds);
   }
+  PredTransformKind EvalTransformKind() const override { return PredTransformKind::kExp; }
 
   bst_float ProbToMargin(bst_float base_score) const override {
     return std::log(base_score);
@@ -0,0 +1,152 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file compiled_forest.cc
+ */
+#include "compiled_forest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "xgboost/logging.h"
+#include "xgboost/tree_model.h"
+
+#include "../gbm/gbtree_model.h"
+
+namespace xgboost {
+namespace predictor {
+namespace {
+// Hexadecimal literal, so that constants are exactly the same after compilation.
+std::string FloatLiteral(float v) {
+  if (std::isnan(v)) {
+    return "NAN";
+  }
+  if (std::isinf(v)) {
+    return v > 0 ? "INFINITY" : "(-INFINITY)";
+  }
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%af", static_cast<double>(v));
+  return buf;
+}
+
+void Indent(int32_t depth, std::ostream *os) {
+  for (int32_t i = 0; i < depth; ++i) {
+    *os << "  ";
+  }
+}
+
+void GenerateNode(RegTree const &tree, bst_node_t nidx, size_t tree_idx, int32_t depth,
+                  std::ostream *os) {
+  auto const &node = tree[nidx];
+  Indent(depth, os);
+  if (node.IsLeaf()) {
+    *os << "return " << FloatLiteral(node.LeafValue()) << ";\n";
+    return;
+  }
+  auto x = "x[" + std::to_string(node.SplitIndex()) + "]";
+  if (tree.GetSplitTypes()[nidx] == FeatureType::kCategorical) {
+    auto const &segment = tree.GetSplitCategoriesPtr()[nidx];
+    *os << "if (" << x << " != " << x << " ? " << (node.DefaultLeft() ? 1 : 0)
+        << " : xgb_cat_left(" << x << ", xgb_cats_" << tree_idx << " + " << segment.beg
+        << ", " << segment.size << ")) {\n";
+  } else if (node.DefaultLeft()) {
+    // NaN fails both comparisons, missing values go right unless negated.
+    *os << "if (!(" << x << " >= " << FloatLiteral(node.SplitCond()) << ")) {\n";
+  } else {
+    *os << "if (" << x << " < " << FloatLiteral(node.SplitCond()) << ") {\n";
+  }
+  GenerateNode(tree, node.LeftChild(), tree_idx, depth + 1, os);
+  Indent(depth, os);
+  *os << "} else {\n";
+  GenerateNode(tree, node.RightChild(), tree_idx, depth + 1, os);
+  Indent(depth, os);
+  *os << "}\n";
+}
+}  // anonymous namespace
+
+void GenerateForestSource(gbm::GBTreeModel const &model, std::ostream *os) {
+  auto const &param = *model.learner_model_param;
+  auto n_trees = model.trees.size();
+  auto &out = *os;
+  out << "/* Generated by XGBoost from a model with " << n_trees << " trees. */\n"
+      << "#include <math.h>\n"
+      << "#include <stdint.h>\n\n"
+      << "#if defined(_WIN32)\n"
+      << "#define XGB_COMPILED_EXPORT __declspec(dllexport)\n"
+      << "#else\n"
+      << "#define XGB_COMPILED_EXPORT __attribute__((visibility(\"default\")))\n"
+      << "#endif\n\n"
+      << "#if defined(__cplusplus)\n"
+      << "extern \"C\" {\n"
+      << "#endif\n\n"
+      << "/* Same as common::Decision, categories are stored from the highest bit. */\n"
+      << "static inline int xgb_cat_left(float v, uint32_t const *cats, uint32_t n) {\n"
+      << "  uint32_t c = (uint32_t)(int32_t)v;\n"
+      << "  uint32_t w = c / 32;\n"
+      << "  return w >= n || !((cats[w] >> (31 - c % 32)) & 1u);\n"
+      << "}\n\n";
+
+  for (size_t i = 0; i < n_trees; ++i) {
+    auto const &tree = *model.trees[i];
+    CHECK(!tree.IsMultiTarget()) << "Code generation doesn't support vector leaf.";
+    auto cats = tree.GetSplitCategories();
+    if (!cats.empty()) {
+      out << "static uint32_t const xgb_cats_" << i << "[" << cats.size() << "] = {";
+      for (size_t k = 0; k < cats.size(); ++k) {
+        out << (k == 0 ? "" : ", ") << cats[k] << "u";
+      }
+      out << "};\n";
+    }
+    out << "static float xgb_tree_" << i << "(float const *x) {\n";
+    GenerateNode(tree, RegTree::kRoot, i, 1, os);
+    out << "}\n\n";
+  }
+
+  if (n_trees != 0) {
+    out << "static float (*const xgb_trees[" << n_trees << "])(float const *) = {\n";
+    for (size_t i = 0; i < n_trees; ++i) {
+      out << "  xgb_tree_" << i << ",\n";
+    }
+    out << "};\n"
+        << "static int32_t const xgb_tree_group[" << n_trees << "] = {";
+    for (size_t i = 0; i < n_trees; ++i) {
+      out << (i == 0 ? "" : ", ") << model.tree_info[i];
+    }
+    out << "};\n\n";
+  }
+
+  out << "XGB_COMPILED_EXPORT int32_t xgboost_compiled_abi(void) { return "
+      << kCompiledForestABI << "; }\n"
+      << "XGB_COMPILED_EXPORT uint32_t xgboost_compiled_num_feature(void) { return "
+      << param.num_feature << "u; }\n"
+      << "XGB_COMPILED_EXPORT uint32_t xgboost_compiled_num_group(void) { return "
+      << param.num_output_group << "u; }\n"
+      << "XGB_COMPILED_EXPORT uint32_t xgboost_compiled_num_tree(void) { return " << n_trees
+      << "u; }\n"
+      << "XGB_COMPILED_EXPORT float xgboost_compiled_base_score(void) { return "
+      << FloatLiteral(param.base_score) << "; }\n\n"
+      << "XGB_COMPILED_EXPORT void xgboost_compiled_predict(float const *x, uint32_t "
+         "tree_begin,\n"
+      << "                                                  uint32_t tree_end, float *out) {\n";
+  if (n_trees != 0) {
+    // Trees are added in the same order as `cpu_predictor`, the whole forest is inlined.
+    out << "  uint32_t t;\n"
+        << "  if (tree_begin == 0 && tree_end == " << n_trees << "u) {\n";
+    for (size_t i = 0; i < n_trees; ++i) {
+      out << "    out[" << model.tree_info[i] << "] += xgb_tree_" << i << "(x);\n";
+    }
+    out << "    return;\n"
+        << "  }\n"
+        << "  for (t = tree_begin; t < tree_end; ++t) {\n"
+        << "    out[xgb_tree_group[t]] += xgb_trees[t](x);\n"
+        << "  }\n";
+  } else {
+    out << "  (void)x;\n  (void)tree_begin;\n  (void)tree_end;\n  (void)out;\n";
+  }
+  out << "}\n\n"
+      << "#if defined(__cplusplus)\n"
+      << "}  /* extern \"C\" */\n"
+      << "#endif\n";
+}
+}  // namespace predictor
+}  // namespace xgboost
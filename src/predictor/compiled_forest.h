@@ -0,0 +1,48 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file compiled_forest.h
+ * \brief Code generation of tree models for ahead-of-time compilation.
+ */
+#ifndef XGBOOST_PREDICTOR_COMPILED_FOREST_H_
+#define XGBOOST_PREDICTOR_COMPILED_FOREST_H_
+
+#include <cstdint>
+#include <ostream>
+
+#include "xgboost/base.h"
+
+namespace xgboost {
+namespace gbm {
+struct GBTreeModel;
+}  // namespace gbm
+
+namespace predictor {
+/**
+ * \brief Interface between generated source and `compiled_predictor`, bumped when the
+ *        exported functions change.
+ *
+ *   A compiled forest exports the following C functions:
+ *
+ *   - `int32_t xgboost_compiled_abi(void)`
+ *   - `uint32_t xgboost_compiled_num_feature(void)`
+ *   - `uint32_t xgboost_compiled_num_group(void)`
+ *   - `uint32_t xgboost_compiled_num_tree(void)`
+ *   - `float xgboost_compiled_base_score(void)`
+ *   - `void xgboost_compiled_predict(float const *x, uint32_t tree_begin, uint32_t tree_end,
+ *                                    float *out)`
+ *
+ *   where `x` is a dense row with NaN for missing values, and the leaf values of trees in
+ *   [tree_begin, tree_end) are added to `out`, one value for each output group.
+ */
+constexpr int32_t kCompiledForestABI = 1;
+
+/**
+ * \brief Generate C source of a forest where trees are unrolled into nested branches, with
+ *        split conditions as constants.  The C99 source is compiled into a shared library and
+ *        loaded by `compiled_predictor`, or linked into other programs directly.  Models with
+ *        vector leaf are not supported.
+ */
+void GenerateForestSource(gbm::GBTreeModel const &model, std::ostream *os);
+}  // namespace predictor
+}  // namespace xgboost
+#endif  // XGBOOST_PREDICTOR_COMPILED_FOREST_H_
@@ -0,0 +1,245 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ *
+ * \brief Predictor calling a forest compiled ahead of time from generated source, see
+ *        `GenerateForestSource`.
+ */
+#include <dmlc/omp.h>
+#include <dmlc/any.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif  // defined(_WIN32)
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/logging.h"
+#include "xgboost/predictor.h"
+#include "xgboost/tree_model.h"
+
+#include "compiled_forest.h"
+#include "../common/annotation.h"
+#include "../common/threading_utils.h"
+#include "../gbm/gbtree_model.h"
+
+namespace xgboost {
+namespace predictor {
+
+DMLC_REGISTRY_FILE_TAG(compiled_predictor);
+
+namespace {
+/**
+ * \brief Shared library of a compiled forest, unloaded on destruction.
+ */
+class CompiledForest {
+  using CountFn = uint32_t (*)();
+  using PredictFn = void (*)(float const *, uint32_t, uint32_t, float *);
+
+#if defined(_WIN32)
+  HMODULE handle_{nullptr};
+#else
+  void *handle_{nullptr};
+#endif  // defined(_WIN32)
+  PredictFn predict_{nullptr};
+  uint32_t num_feature_{0};
+  uint32_t num_group_{0};
+  uint32_t num_tree_{0};
+
+  template <typename Fn>
+  Fn Symbol(char const *name) const {
+#if defined(_WIN32)
+    auto sym = reinterpret_cast<Fn>(GetProcAddress(handle_, name));
+#else
+    auto sym = reinterpret_cast<Fn>(dlsym(handle_, name));
+#endif  // defined(_WIN32)
+    CHECK(sym) << "Symbol `" << name << "` is not found in compiled forest.";
+    return sym;
+  }
+
+ public:
+  explicit CompiledForest(std::string const &path) {
+#if defined(_WIN32)
+    handle_ = LoadLibraryA(path.c_str());
+    CHECK(handle_) << "Failed to load compiled forest: " << path;
+#else
+    handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    CHECK(handle_) << "Failed to load compiled forest: " << path << ", " << dlerror();
+#endif  // defined(_WIN32)
+    auto abi = this->Symbol<int32_t (*)()>("xgboost_compiled_abi")();
+    CHECK_EQ(abi, kCompiledForestABI)
+        << "Compiled forest is generated by an incompatible version of XGBoost.";
+    num_feature_ = this->Symbol<CountFn>("xgboost_compiled_num_feature")();
+    num_group_ = this->Symbol<CountFn>("xgboost_compiled_num_group")();
+    num_tree_ = this->Symbol<CountFn>("xgboost_compiled_num_tree")();
+    predict_ = this->Symbol<PredictFn>("xgboost_compiled_predict");
+  }
+  CompiledForest(CompiledForest const &) = delete;
+  CompiledForest &operator=(CompiledForest const &) = delete;
+  ~CompiledForest() {
+#if defined(_WIN32)
+    FreeLibrary(handle_);
+#else
+    dlclose(handle_);
+#endif  // defined(_WIN32)
+  }
+
+  /*! \brief Whether the library is compiled from the model, judged by its shape. */
+  bool Match(gbm::GBTreeModel const &model) const {
+    return num_tree_ == model.trees.size() &&
+           num_feature_ == model.learner_model_param->num_feature &&
+           num_group_ == model.learner_model_param->num_output_group;
+  }
+  void Predict(float const *x, uint32_t tree_begin, uint32_t tree_end, float *out) const {
+    predict_(x, tree_begin, tree_end, out);
+  }
+};
+}  // anonymous namespace
+
+class CompiledPredictor : public Predictor {
+  std::unique_ptr<Predictor> cpu_predictor_;
+  std::string path_;
+  std::unique_ptr<CompiledForest> forest_;
+
+  CompiledForest const *GetForest(gbm::GBTreeModel const &model) const {
+    if (!forest_) {
+      LOG(WARNING) << "`compiled_library` is not set, falling back to `cpu_predictor`.";
+      return nullptr;
+    }
+    if (!forest_->Match(model)) {
+      LOG(WARNING) << "Compiled forest `" << path_ << "` doesn't match the model, falling "
+                   << "back to `cpu_predictor`.";
+      return nullptr;
+    }
+    return forest_.get();
+  }
+
+  void PredictDMatrix(DMatrix *p_fmat, std::vector<bst_float> *out_preds,
+                      gbm::GBTreeModel const &model, CompiledForest const &forest,
+                      uint32_t tree_begin, uint32_t tree_end) const {
+    auto const n_threads = omp_get_max_threads();
+    auto const num_group = model.learner_model_param->num_output_group;
+    auto const num_feature = model.learner_model_param->num_feature;
+    CHECK_EQ(out_preds->size(), p_fmat->Info().num_row_ * num_group);
+
+    // Dense rows with NaN for missing values.
+    std::vector<float> rows(n_threads * num_feature, std::numeric_limits<float>::quiet_NaN());
+    auto &preds = *out_preds;
+    for (auto const &batch : p_fmat->GetBatches<SparsePage>()) {
+      auto page = batch.GetView();
+      common::ParallelFor(static_cast<bst_omp_uint>(batch.Size()), n_threads,
+                          [&](bst_omp_uint i) {
+        auto *x = rows.data() + common::ThreadIdx() * num_feature;
+        auto inst = page[i];
+        for (auto const &e : inst) {
+          x[e.index] = e.fvalue;
+        }
+        auto row_idx = batch.base_rowid + i;
+        forest.Predict(x, tree_begin, tree_end, preds.data() + row_idx * num_group);
+        for (auto const &e : inst) {
+          x[e.index] = std::numeric_limits<float>::quiet_NaN();
+        }
+      });
+    }
+  }
+
+ public:
+  explicit CompiledPredictor(GenericParameter const *generic_param)
+      : Predictor::Predictor{generic_param},
+        cpu_predictor_{Predictor::Create("cpu_predictor", generic_param)} {}
+
+  void Configure(const std::vector<std::pair<std::string, std::string>> &cfg) override {
+    Predictor::Configure(cfg);
+    cpu_predictor_->Configure(cfg);
+    for (auto const &kv : cfg) {
+      if (kv.first == "compiled_library" && kv.second != path_) {
+        forest_.reset();
+        path_ = kv.second;
+        if (!path_.empty()) {
+          forest_.reset(new CompiledForest{path_});
+        }
+      }
+    }
+  }
+
+  void PredictBatch(DMatrix *dmat, PredictionCacheEntry *predts,
+                    const gbm::GBTreeModel &model, uint32_t tree_begin,
+                    uint32_t tree_end = 0) const override {
+    XGBOOST_ANNOTATE_SCOPE("xgboost::CompiledPredictor::PredictBatch");
+    if (tree_end == 0) {
+      tree_end = model.trees.size();
+    }
+    auto forest = this->GetForest(model);
+    if (!forest) {
+      cpu_predictor_->PredictBatch(dmat, predts, model, tree_begin, tree_end);
+      return;
+    }
+    this->PredictDMatrix(dmat, &predts->predictions.HostVector(), model, *forest,
+                         tree_begin, tree_end);
+  }
+
+  bool InplacePredict(dmlc::any const &x, std::shared_ptr<DMatrix> p_m,
+                      const gbm::GBTreeModel &model, float missing,
+                      PredictionCacheEntry *out_preds, uint32_t tree_begin,
+                      unsigned tree_end) const override {
+    return cpu_predictor_->InplacePredict(x, p_m, model, missing, out_preds, tree_begin,
+                                          tree_end);
+  }
+
+  void PredictInstance(const SparsePage::Inst &inst, std::vector<bst_float> *out_preds,
+                       const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictInstance(inst, out_preds, model, ntree_limit);
+  }
+
+  void PredictLeaf(DMatrix *p_fmat, HostDeviceVector<bst_float> *out_preds,
+                   const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeaf(p_fmat, out_preds, model, ntree_limit);
+  }
+
+  void PredictLeafOrdinal(DMatrix *p_fmat, common::Span<std::uint8_t> out,
+                          const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeafOrdinal(p_fmat, out, model, ntree_limit);
+  }
+
+  void PredictLeafOrdinal(DMatrix *p_fmat, common::Span<std::uint16_t> out,
+                          const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeafOrdinal(p_fmat, out, model, ntree_limit);
+  }
+
+  void PredictLeafOneHot(DMatrix *p_fmat, common::Span<std::uint32_t> out_indices,
+                         const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeafOneHot(p_fmat, out_indices, model, ntree_limit);
+  }
+
+  void PredictContribution(DMatrix *p_fmat, HostDeviceVector<float> *out_contribs,
+                           const gbm::GBTreeModel &model, uint32_t ntree_limit,
+                           std::vector<bst_float> const *tree_weights, bool approximate,
+                           int condition, unsigned condition_feature) const override {
+    cpu_predictor_->PredictContribution(p_fmat, out_contribs, model, ntree_limit,
+                                        tree_weights, approximate, condition,
+                                        condition_feature);
+  }
+
+  void PredictInteractionContributions(DMatrix *p_fmat, HostDeviceVector<bst_float> *out_contribs,
+                                       const gbm::GBTreeModel &model, unsigned ntree_limit,
+                                       std::vector<bst_float> const *tree_weights,
+                                       bool approximate) const override {
+    cpu_predictor_->PredictInteractionContributions(p_fmat, out_contribs, model, ntree_limit,
+                                                    tree_weights, approximate);
+  }
+};
+
+XGBOOST_REGISTER_PREDICTOR(CompiledPredictor, "compiled_predictor")
+.describe("Make predictions with a forest compiled ahead of time into a shared library.")
+.set_body([](GenericParameter const* generic_param) {
+            return new CompiledPredictor(generic_param);
+          });
+}  // namespace predictor
+}  // namespace xgboost
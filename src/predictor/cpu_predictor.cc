@@ -4,9 +4,14 @@
 #include <dmlc/omp.h>
 #include <dmlc/any.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "xgboost/base.h"
 #include "xgboost/data.h"
@@ -15,10 +20,18 @@
 #include "xgboost/tree_updater.h"
 #include "xgboost/logging.h"
 #include "xgboost/host_device_vector.h"
+#include "xgboost/json.h"
 
+#include "flat_forest.h"
 #include "predict_fn.h"
+#include "row_cache.h"
+#include "simd_traversal.h"
+#include "tree_shap.h"
 #include "../data/adapter.h"
+#include "../data/gradient_index.h"
+#include "../common/annotation.h"
 #include "../common/math.h"
+#include "../common/perf_counters.h"
 #include "../common/threading_utils.h"
 #include "../common/categorical.h"
 #include "../gbm/gbtree_model.h"
@@ -42,15 +55,15 @@ bst_node_t GetLeafIndex(RegTree const &tree, const RegTree::FVec &feat,
 }
 
 bst_float PredValue(const SparsePage::Inst &inst,
-                    const std::vector<std::unique_ptr<RegTree>> &trees,
+                    const std::vector<std::shared_ptr<RegTree>> &trees,
                     const std::vector<int> &tree_info, int bst_group,
                     RegTree::FVec *p_feats, unsigned tree_begin,
                     unsigned tree_end) {
   bst_float psum = 0.0f;
   p_feats->Fill(inst);
   for (size_t i = tree_begin; i < tree_end; ++i) {
-    if (tree_info[i] == bst_group) {
-      auto const &tree = *trees[i];
+    auto const &tree = *trees[i];
+    if (tree_info[i] == bst_group || tree.IsMultiTarget()) {
       bool has_categorical = tree.HasCategoricalSplit();
       auto cats = tree.GetCategoriesMatrix();
       bst_node_t nidx = -1;
@@ -59,7 +72,7 @@ bst_float PredValue(const SparsePage::Inst &inst,
       } else {
         nidx = GetLeafIndex<true, false>(tree, *p_feats, cats);
       }
-      psum += (*trees[i])[nidx].LeafValue();
+      psum += tree.IsMultiTarget() ? tree.LeafVector(nidx)[bst_group] : tree[nidx].LeafValue();
     }
   }
   p_feats->Drop(inst);
@@ -67,61 +80,146 @@ bst_float PredValue(const SparsePage::Inst &inst,
 }
 
 template <bool has_categorical>
-bst_float
-PredValueByOneTree(const RegTree::FVec &p_feats, RegTree const &tree,
-                   RegTree::CategoricalSplitMatrix const& cats) {
-  const bst_node_t leaf = p_feats.HasMissing() ?
-    GetLeafIndex<true, has_categorical>(tree, p_feats, cats) :
-    GetLeafIndex<false, has_categorical>(tree, p_feats, cats);
-  return tree[leaf].LeafValue();
+bst_float PredValueByOneTree(const RegTree::FVec &p_feats, FlatForest const &forest,
+                             size_t tree_id, RegTree::CategoricalSplitMatrix const &cats) {
+  auto const *tree = forest.Tree(tree_id);
+  auto const &leaf = p_feats.HasMissing()
+                         ? GetLeaf<true, has_categorical>(tree, p_feats, cats)
+                         : GetLeaf<false, has_categorical>(tree, p_feats, cats);
+  return forest.LeafValue(leaf);
 }
 
-void PredictByAllTrees(gbm::GBTreeModel const &model, const size_t tree_begin,
-                       const size_t tree_end, std::vector<bst_float> *out_preds,
-                       const size_t predict_offset, const size_t num_group,
+// Add the leaf vector of a multi-target tree to all output groups of a row.
+template <bool has_categorical>
+void PredVectorByOneTree(const RegTree::FVec &p_feats, FlatForest const &forest,
+                         size_t tree_id, RegTree const &tree,
+                         RegTree::CategoricalSplitMatrix const &cats, bst_float *out) {
+  auto const *flat = forest.Tree(tree_id);
+  auto const &leaf = p_feats.HasMissing()
+                         ? GetLeaf<true, has_categorical>(flat, p_feats, cats)
+                         : GetLeaf<false, has_categorical>(flat, p_feats, cats);
+  auto weights = tree.LeafVector(leaf.nidx);
+  for (size_t t = 0; t < weights.size(); ++t) {
+    out[t] += weights[t];
+  }
+}
+
+/**
+ * \brief Trees of a model inside a forest, the forest may hold trees of multiple models.
+ */
+struct ForestSlice {
+  gbm::GBTreeModel const *model;
+  // Position of the first tree of the model in the forest.
+  size_t forest_offset;
+  size_t tree_begin;
+  size_t tree_end;
+  std::vector<bst_float> *out_preds;
+};
+
+void PredictByAllTrees(FlatForest const &forest, ForestSlice const &slice,
+                       const size_t predict_offset,
                        const std::vector<RegTree::FVec> &thread_temp,
-                       const size_t offset, const size_t block_size) {
-  std::vector<bst_float> &preds = *out_preds;
-  for (size_t tree_id = tree_begin; tree_id < tree_end; ++tree_id) {
+                       const size_t offset, const size_t block_size,
+                       float const *dense = nullptr, int32_t num_feature = 0) {
+  auto const &model = *slice.model;
+  std::vector<bst_float> &preds = *slice.out_preds;
+  const size_t num_group = model.learner_model_param->num_output_group;
+  // Number of rows in this block that can be traversed with SIMD instructions.
+  int32_t const width = dense ? SimdTraversalWidth() : 0;
+  size_t const n_simd = width == 0 ? 0 : block_size / width * width;
+  float simd_out[16];
+  for (size_t tree_id = slice.tree_begin; tree_id < slice.tree_end; ++tree_id) {
     const size_t gid = model.tree_info[tree_id];
-    auto const &tree = *model.trees[tree_id];
-    auto const& cats = tree.GetCategoriesMatrix();
-    auto has_categorical = tree.HasCategoricalSplit();
-
-    if (has_categorical) {
+    const size_t flat_id = slice.forest_offset + tree_id;
+    auto const& cats = model.trees[tree_id]->GetCategoriesMatrix();
+    if (model.trees[tree_id]->IsMultiTarget()) {
+      auto const& tree = *model.trees[tree_id];
+      for (size_t i = 0; i < block_size; ++i) {
+        auto *out = preds.data() + (predict_offset + i) * num_group;
+        if (forest.HasCategorical(flat_id)) {
+          PredVectorByOneTree<true>(thread_temp[offset + i], forest, flat_id, tree, cats, out);
+        } else {
+          PredVectorByOneTree<false>(thread_temp[offset + i], forest, flat_id, tree, cats, out);
+        }
+      }
+    } else if (n_simd != 0 && !forest.HasCategorical(flat_id)) {
+      for (size_t i = 0; i < n_simd; i += width) {
+        SimdTraverse(forest.Tree(flat_id), forest.LeafValues(), dense + i * num_feature,
+                     num_feature, simd_out);
+        for (int32_t k = 0; k < width; ++k) {
+          preds[(predict_offset + i + k) * num_group + gid] += simd_out[k];
+        }
+      }
+      for (size_t i = n_simd; i < block_size; ++i) {
+        preds[(predict_offset + i) * num_group + gid] +=
+            PredValueByOneTree<false>(thread_temp[offset + i], forest, flat_id, cats);
+      }
+    } else if (forest.HasCategorical(flat_id)) {
       for (size_t i = 0; i < block_size; ++i) {
         preds[(predict_offset + i) * num_group + gid] +=
-            PredValueByOneTree<true>(thread_temp[offset + i], tree, cats);
+            PredValueByOneTree<true>(thread_temp[offset + i], forest, flat_id, cats);
       }
     } else {
       for (size_t i = 0; i < block_size; ++i) {
         preds[(predict_offset + i) * num_group + gid] +=
-            PredValueByOneTree<false>(thread_temp[offset + i], tree, cats);
+            PredValueByOneTree<false>(thread_temp[offset + i], forest, flat_id, cats);
       }
     }
   }
 }
 
+/**
+ * \brief Fill the feature vectors for a block of rows.  When `compact` is not empty, only
+ *        the features used by the forest are stored and `num_feature` is the number of
+ *        used features.  When `dense` is not null, the rows are also written into the row
+ *        major dense buffer used by SIMD traversal, which is expected to be filled with NaN
+ *        and has the same layout as the feature vectors.
+ */
 template <typename DataView>
 void FVecFill(const size_t block_size, const size_t batch_offset, const int num_feature,
-              DataView* batch, const size_t fvec_offset, std::vector<RegTree::FVec>* p_feats) {
+              DataView* batch, const size_t fvec_offset, std::vector<RegTree::FVec>* p_feats,
+              common::Span<int32_t const> compact = {}, float* dense = nullptr) {
   for (size_t i = 0; i < block_size; ++i) {
     RegTree::FVec &feats = (*p_feats)[fvec_offset + i];
-    if (feats.Size() == 0) {
+    if (feats.Size() != static_cast<size_t>(num_feature)) {
       feats.Init(num_feature);
     }
     const SparsePage::Inst inst = (*batch)[batch_offset + i];
-    feats.Fill(inst);
+    if (compact.empty()) {
+      feats.Fill(inst);
+    } else {
+      feats.Fill(inst, compact);
+    }
+    if (dense) {
+      for (auto const& e : inst) {
+        if (e.index < compact.size() && compact[e.index] >= 0) {
+          dense[i * num_feature + compact[e.index]] = e.fvalue;
+        }
+      }
+    }
   }
 }
 
 template <typename DataView>
 void FVecDrop(const size_t block_size, const size_t batch_offset, DataView* batch,
-              const size_t fvec_offset, std::vector<RegTree::FVec>* p_feats) {
+              const size_t fvec_offset, std::vector<RegTree::FVec>* p_feats,
+              common::Span<int32_t const> compact = {}, const int num_feature = 0,
+              float* dense = nullptr) {
   for (size_t i = 0; i < block_size; ++i) {
     RegTree::FVec &feats = (*p_feats)[fvec_offset + i];
     const SparsePage::Inst inst = (*batch)[batch_offset + i];
-    feats.Drop(inst);
+    if (compact.empty()) {
+      feats.Drop(inst);
+    } else {
+      feats.Drop(inst, compact);
+    }
+    if (dense) {
+      for (auto const& e : inst) {
+        if (e.index < compact.size() && compact[e.index] >= 0) {
+          dense[i * num_feature + compact[e.index]] = std::numeric_limits<float>::quiet_NaN();
+        }
+      }
+    }
   }
 }
 
@@ -158,7 +256,7 @@ class AdapterView {
     bst_feature_t columns = adapter_->NumColumns();
     auto const &batch = adapter_->Value();
     auto row = batch.GetLine(i);
-    auto t = omp_get_thread_num();
+    auto t = common::ThreadIdx();
     auto const beg = (columns * kUnroll * t) + (current_unroll_[t] * columns);
     size_t non_missing {beg};
     for (size_t c = 0; c < row.Size(); ++c) {
@@ -182,61 +280,125 @@ class AdapterView {
   bst_row_t const static base_rowid = 0;  // NOLINT
 };
 
+/**
+ * \brief Predict blocks of rows with all slices of the forest, features of each row are
+ *        filled only once for all slices.
+ */
 template <typename DataView, size_t block_of_rows_size>
-void PredictBatchByBlockOfRowsKernel(
-    DataView batch, std::vector<bst_float> *out_preds,
-    gbm::GBTreeModel const &model, int32_t tree_begin, int32_t tree_end,
-    std::vector<RegTree::FVec> *p_thread_temp) {
+void PredictBatchByBlockOfRowsKernel(DataView batch, FlatForest const &forest,
+                                     common::Span<ForestSlice const> slices,
+                                     std::vector<RegTree::FVec> *p_thread_temp) {
   auto &thread_temp = *p_thread_temp;
-  int32_t const num_group = model.learner_model_param->num_output_group;
-
-  CHECK_EQ(model.param.size_leaf_vector, 0)
-      << "size_leaf_vector is enforced to 0 so far";
+  for (auto const &slice : slices) {
+    CHECK_EQ(slice.model->param.size_leaf_vector, 0)
+        << "size_leaf_vector is enforced to 0 so far";
+  }
   // parallel over local batch
   const auto nsize = static_cast<bst_omp_uint>(batch.Size());
-  const int num_feature = model.learner_model_param->num_feature;
+  // Feature vectors only hold features used by the forest.
+  const int num_feature = forest.NumUsedFeatures();
+  auto compact = forest.CompactIndex();
   omp_ulong n_blocks = common::DivRoundUp(nsize, block_of_rows_size);
 
+  // Dense buffer for traversing multiple rows with SIMD instructions, only used for
+  // blocked prediction with moderate number of used features.
+  size_t constexpr kMaxSimdFeatures = 4096;
+  bool const use_simd = block_of_rows_size >= 8 && SimdTraversalWidth() != 0 &&
+                        num_feature > 0 && static_cast<size_t>(num_feature) <= kMaxSimdFeatures;
+  std::vector<float> dense;
+  if (use_simd) {
+    dense.resize(thread_temp.size() * num_feature, std::numeric_limits<float>::quiet_NaN());
+  }
+
   common::ParallelFor(n_blocks, [&](bst_omp_uint block_id) {
     const size_t batch_offset = block_id * block_of_rows_size;
     const size_t block_size =
         std::min(nsize - batch_offset, block_of_rows_size);
-    const size_t fvec_offset = omp_get_thread_num() * block_of_rows_size;
+    const size_t fvec_offset = common::ThreadIdx() * block_of_rows_size;
+    float *block_dense = use_simd ? dense.data() + fvec_offset * num_feature : nullptr;
 
     FVecFill(block_size, batch_offset, num_feature, &batch, fvec_offset,
-             p_thread_temp);
+             p_thread_temp, compact, block_dense);
     // process block of rows through all trees to keep cache locality
-    PredictByAllTrees(model, tree_begin, tree_end, out_preds,
-                      batch_offset + batch.base_rowid, num_group, thread_temp,
-                      fvec_offset, block_size);
-    FVecDrop(block_size, batch_offset, &batch, fvec_offset, p_thread_temp);
+    for (auto const &slice : slices) {
+      PredictByAllTrees(forest, slice, batch_offset + batch.base_rowid, thread_temp,
+                        fvec_offset, block_size, block_dense, num_feature);
+    }
+    FVecDrop(block_size, batch_offset, &batch, fvec_offset, p_thread_temp, compact,
+             num_feature, block_dense);
   });
 }
 
-float FillNodeMeanValues(RegTree const *tree, bst_node_t nidx, std::vector<float> *mean_values) {
-  bst_float result;
-  auto &node = (*tree)[nidx];
-  auto &node_mean_values = *mean_values;
-  if (node.IsLeaf()) {
-    result = node.LeafValue();
-  } else {
-    result = FillNodeMeanValues(tree, node.LeftChild(), mean_values) *
-             tree->Stat(node.LeftChild()).sum_hess;
-    result += FillNodeMeanValues(tree, node.RightChild(), mean_values) *
-              tree->Stat(node.RightChild()).sum_hess;
-    result /= tree->Stat(nidx).sum_hess;
-  }
-  node_mean_values[nidx] = result;
-  return result;
-}
-
-void FillNodeMeanValues(RegTree const* tree, std::vector<float>* mean_values) {
-  size_t num_nodes = tree->param.num_nodes;
-  if (mean_values->size() == num_nodes) {
-    return;
+/**
+ * \brief Predict with quantized data, for dense data the local bin index is read directly
+ *        from the gradient index.
+ */
+template <typename BinIdxType>
+void PredictGHistIndexKernel(GHistIndexMatrix const &page, gbm::GBTreeModel const &model,
+                             FlatForest const &forest, std::vector<int32_t> const &split_bins,
+                             uint32_t tree_begin, uint32_t tree_end,
+                             std::vector<bst_float> *out_preds) {
+  auto &preds = *out_preds;
+  auto const num_group = model.learner_model_param->num_output_group;
+  auto const *index = page.index.data<BinIdxType>();
+  auto const &ptrs = page.cut.Ptrs();
+  auto const n_used = forest.NumUsedFeatures();
+  auto const *used = forest.UsedFeatures().data();
+  int32_t const n_threads = omp_get_max_threads();
+  // Local bin index of each compact feature for current row, used only by sparse data.
+  std::vector<int32_t> thread_bins;
+  // Compact feature index of each bin, -1 for features not used by the forest.  Used only
+  // by sparse data.
+  std::vector<int32_t> bin_feature;
+  if (!page.IsDense()) {
+    thread_bins.resize(n_threads * n_used, -1);
+    bin_feature.resize(page.cut.TotalBins(), -1);
+    for (bst_feature_t c = 0; c < n_used; ++c) {
+      auto f = used[c];
+      std::fill(bin_feature.begin() + ptrs[f], bin_feature.begin() + ptrs[f + 1], c);
+    }
   }
-  mean_values->resize(num_nodes);
-  FillNodeMeanValues(tree, 0, mean_values);
+
+  common::ParallelFor(static_cast<bst_omp_uint>(page.Size()), n_threads,
+                      [&](bst_omp_uint ridx) {
+    auto const beg = page.row_ptr[ridx];
+    auto const end = page.row_ptr[ridx + 1];
+    auto *predts = preds.data() + (page.base_rowid + ridx) * num_group;
+    if (page.IsDense()) {
+      auto const *row = index + beg;
+      auto get_bin = [row, used](uint32_t cidx) {
+        return static_cast<int32_t>(row[used[cidx]]);
+      };
+      for (uint32_t tree_id = tree_begin; tree_id < tree_end; ++tree_id) {
+        auto offset = forest.TreeOffset(tree_id);
+        auto const &leaf =
+            GetLeafByBin<false>(forest.Tree(tree_id), split_bins.data() + offset, get_bin);
+        predts[model.tree_info[tree_id]] += forest.LeafValue(leaf);
+      }
+    } else {
+      auto *bins = thread_bins.data() + common::ThreadIdx() * n_used;
+      for (size_t i = beg; i < end; ++i) {
+        auto gidx = index[i];
+        auto cidx = bin_feature[gidx];
+        if (cidx >= 0) {
+          bins[cidx] = static_cast<int32_t>(gidx - ptrs[used[cidx]]);
+        }
+      }
+      auto get_bin = [bins](uint32_t cidx) { return bins[cidx]; };
+      for (uint32_t tree_id = tree_begin; tree_id < tree_end; ++tree_id) {
+        auto offset = forest.TreeOffset(tree_id);
+        auto const &leaf =
+            GetLeafByBin<true>(forest.Tree(tree_id), split_bins.data() + offset, get_bin);
+        predts[model.tree_info[tree_id]] += forest.LeafValue(leaf);
+      }
+      for (size_t i = beg; i < end; ++i) {
+        auto cidx = bin_feature[index[i]];
+        if (cidx >= 0) {
+          bins[cidx] = -1;
+        }
+      }
+    }
+  });
 }
 
 class CPUPredictor : public Predictor {
@@ -249,9 +411,57 @@ class CPUPredictor : public Predictor {
     }
   }
 
-  void PredictDMatrix(DMatrix *p_fmat, std::vector<bst_float> *out_preds,
-                      gbm::GBTreeModel const &model, int32_t tree_begin,
-                      int32_t tree_end) const {
+  /**
+   * \brief Predict using the existing gradient index of DMatrix, which avoids reading the
+   *        sparse page.
+   *
+   * \return false if the model can not be evaluated on the quantized data.
+   */
+  bool PredictGHistIndex(DMatrix *p_fmat, std::vector<bst_float> *out_preds,
+                         gbm::GBTreeModel const &model, FlatForest const &forest,
+                         uint32_t tree_begin, uint32_t tree_end) const {
+    if (model.IsMultiTarget()) {
+      return false;
+    }
+    std::vector<int32_t> split_bins;
+    for (auto const &page : p_fmat->GetBatches<GHistIndexMatrix>(BatchParam{})) {
+      // Bins stored with mixed types are predicted from raw data instead.
+      if (page.index.IsMixed()) {
+        return false;
+      }
+      // All pages share the same cuts.
+      if (split_bins.empty() && !forest.SplitBins(page.cut, &split_bins)) {
+        return false;
+      }
+      if (!page.IsDense()) {
+        PredictGHistIndexKernel<uint32_t>(page, model, forest, split_bins, tree_begin,
+                                          tree_end, out_preds);
+        continue;
+      }
+      switch (page.index.GetBinTypeSize()) {
+        case common::kUint8BinsTypeSize:
+          PredictGHistIndexKernel<uint8_t>(page, model, forest, split_bins, tree_begin,
+                                           tree_end, out_preds);
+          break;
+        case common::kUint16BinsTypeSize:
+          PredictGHistIndexKernel<uint16_t>(page, model, forest, split_bins, tree_begin,
+                                            tree_end, out_preds);
+          break;
+        case common::kUint32BinsTypeSize:
+          PredictGHistIndexKernel<uint32_t>(page, model, forest, split_bins, tree_begin,
+                                            tree_end, out_preds);
+          break;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * \brief Predict all slices of the forest with one pass over the sparse pages.  Blocks
+   *        of rows are used for dense data.
+   */
+  void PredictSparsePages(DMatrix *p_fmat, FlatForest const &forest,
+                          common::Span<ForestSlice const> slices) const {
     const int threads = omp_get_max_threads();
     constexpr double kDensityThresh = .5;
     size_t total = std::max(p_fmat->Info().num_row_ * p_fmat->Info().num_col_,
@@ -262,26 +472,39 @@ class CPUPredictor : public Predictor {
 
     std::vector<RegTree::FVec> feat_vecs;
     InitThreadTemp(threads * (blocked ? kBlockOfRowsSize : 1),
-                   model.learner_model_param->num_feature, &feat_vecs);
-    for (auto const &batch : p_fmat->GetBatches<SparsePage>()) {
-      CHECK_EQ(out_preds->size(),
+                   forest.NumUsedFeatures(), &feat_vecs);
+    for (auto const &slice : slices) {
+      CHECK_EQ(slice.out_preds->size(),
                p_fmat->Info().num_row_ *
-                   model.learner_model_param->num_output_group);
+                   slice.model->learner_model_param->num_output_group);
+    }
+    for (auto const &batch : p_fmat->GetBatches<SparsePage>()) {
       size_t constexpr kUnroll = 8;
       if (blocked) {
         PredictBatchByBlockOfRowsKernel<SparsePageView<kUnroll>,
                                         kBlockOfRowsSize>(
-            SparsePageView<kUnroll>{&batch}, out_preds, model, tree_begin,
-            tree_end, &feat_vecs);
+            SparsePageView<kUnroll>{&batch}, forest, slices, &feat_vecs);
 
       } else {
         PredictBatchByBlockOfRowsKernel<SparsePageView<kUnroll>, 1>(
-            SparsePageView<kUnroll>{&batch}, out_preds, model, tree_begin,
-            tree_end, &feat_vecs);
+            SparsePageView<kUnroll>{&batch}, forest, slices, &feat_vecs);
       }
     }
   }
 
+  void PredictDMatrix(DMatrix *p_fmat, std::vector<bst_float> *out_preds,
+                      gbm::GBTreeModel const &model, int32_t tree_begin,
+                      int32_t tree_end) const {
+    auto forest = this->GetForest(model);
+    if (p_fmat->PageExists<GHistIndexMatrix>() &&
+        this->PredictGHistIndex(p_fmat, out_preds, model, *forest, tree_begin, tree_end)) {
+      return;
+    }
+    ForestSlice slice{&model, 0, static_cast<size_t>(tree_begin),
+                      static_cast<size_t>(tree_end), out_preds};
+    this->PredictSparsePages(p_fmat, *forest, {&slice, 1});
+  }
+
  public:
   explicit CPUPredictor(GenericParameter const* generic_param) :
       Predictor::Predictor{generic_param} {}
@@ -289,6 +512,7 @@ class CPUPredictor : public Predictor {
   void PredictBatch(DMatrix *dmat, PredictionCacheEntry *predts,
                     const gbm::GBTreeModel &model, uint32_t tree_begin,
                     uint32_t tree_end = 0) const override {
+    XGBOOST_ANNOTATE_SCOPE("xgboost::CPUPredictor::PredictBatch");
     auto* out_preds = &predts->predictions;
     // This is actually already handled in gbm, but large amount of tests rely on the
     // behaviour.
@@ -299,6 +523,27 @@ class CPUPredictor : public Predictor {
                          tree_end);
   }
 
+  void PredictBatchMany(DMatrix *dmat, std::vector<gbm::GBTreeModel const *> const &models,
+                        std::vector<HostDeviceVector<bst_float> *> const &out_preds)
+      const override {
+    XGBOOST_ANNOTATE_SCOPE("xgboost::CPUPredictor::PredictBatchMany");
+    CHECK_EQ(models.size(), out_preds.size());
+    // Trees of all models are flattened into one forest so that the compact feature
+    // index covers all of them.  The forest is not cached as flattening is cheap compared
+    // to a pass over the data.
+    FlatForest forest;
+    std::vector<ForestSlice> slices;
+    for (size_t i = 0; i < models.size(); ++i) {
+      auto const &model = *models[i];
+      slices.push_back(ForestSlice{&model, forest.Size(), 0, model.trees.size(),
+                                   &out_preds[i]->HostVector()});
+      for (auto const &tree : model.trees) {
+        forest.Push(*tree);
+      }
+    }
+    this->PredictSparsePages(dmat, forest, slices);
+  }
+
   template <typename Adapter, size_t kBlockSize>
   void DispatchedInplacePredict(dmlc::any const &x, std::shared_ptr<DMatrix> p_m,
                                 const gbm::GBTreeModel &model, float missing,
@@ -316,14 +561,35 @@ class CPUPredictor : public Predictor {
       info.num_row_ = m->NumRows();
       this->InitOutPredictions(info, &(out_preds->predictions), model);
     }
-    std::vector<Entry> workspace(m->NumColumns() * 8 * threads);
     auto &predictions = out_preds->predictions.HostVector();
+    if (row_cache_) {
+      auto forest = this->GetForest(model);
+      auto const &batch = m->Value();
+      auto n_groups = model.learner_model_param->num_output_group;
+      common::ParallelFor(m->NumRows(), threads, [&](size_t r) {
+        auto &workspace = LocalRowWorkspace(*forest, m->NumColumns());
+        auto line = batch.GetLine(r);
+        size_t nnz = 0;
+        for (size_t c = 0; c < line.Size(); ++c) {
+          auto e = line.GetElement(c);
+          if (missing != e.value && !common::CheckNAN(e.value)) {
+            workspace.entries[nnz++] = Entry{static_cast<bst_feature_t>(e.column_idx), e.value};
+          }
+        }
+        this->PredictRow({workspace.entries.data(), nnz}, *forest, model, tree_begin, tree_end,
+                         &workspace.feats, {predictions.data() + r * n_groups, n_groups});
+      });
+      return;
+    }
+    std::vector<Entry> workspace(m->NumColumns() * 8 * threads);
     std::vector<RegTree::FVec> thread_temp;
     InitThreadTemp(threads * kBlockSize, model.learner_model_param->num_feature,
                    &thread_temp);
+    auto forest = this->GetForest(model);
+    ForestSlice slice{&model, 0, tree_begin, tree_end, &predictions};
     PredictBatchByBlockOfRowsKernel<AdapterView<Adapter>, kBlockSize>(
         AdapterView<Adapter>(m.get(), missing, common::Span<Entry>{workspace}),
-        &predictions, model, tree_begin, tree_end, &thread_temp);
+        *forest, {&slice, 1}, &thread_temp);
   }
 
   bool InplacePredict(dmlc::any const &x, std::shared_ptr<DMatrix> p_m,
@@ -342,12 +608,115 @@ class CPUPredictor : public Predictor {
     } else if (x.type() == typeid(std::shared_ptr<data::CSRArrayAdapter>)) {
       this->DispatchedInplacePredict<data::CSRArrayAdapter, 1> (
           x, p_m, model, missing, out_preds, tree_begin, tree_end);
+    } else if (x.type() == typeid(std::shared_ptr<data::ArrowAdapter>)) {
+      this->DispatchedInplacePredict<data::ArrowAdapter, kBlockOfRowsSize>(
+          x, p_m, model, missing, out_preds, tree_begin, tree_end);
     } else {
       return false;
     }
     return true;
   }
 
+  void PredictRows(common::Span<float const> values, float missing,
+                   common::Span<float> out_preds, const gbm::GBTreeModel &model,
+                   uint32_t tree_begin, uint32_t tree_end) const override {
+    auto const num_feature = model.learner_model_param->num_feature;
+    auto const num_group = model.learner_model_param->num_output_group;
+    CHECK_NE(num_feature, 0);
+    CHECK_EQ(values.size() % num_feature, 0)
+        << "Number of values must be a multiple of number of features.";
+    size_t const n_rows = values.size() / num_feature;
+    CHECK_GE(out_preds.size(), n_rows * num_group) << "Output buffer is too small.";
+    if (tree_end == 0) {
+      tree_end = model.trees.size();
+    }
+    CHECK_LE(tree_end, model.trees.size()) << "Invalid number of trees.";
+
+    auto forest = this->GetForest(model);
+    auto &workspace = LocalRowWorkspace(*forest, num_feature);
+    std::fill_n(out_preds.data(), n_rows * num_group, model.learner_model_param->base_score);
+    for (size_t r = 0; r < n_rows; ++r) {
+      auto row = values.subspan(r * num_feature, num_feature);
+      size_t nnz = 0;
+      for (bst_feature_t f = 0; f < num_feature; ++f) {
+        if (row[f] != missing && !common::CheckNAN(row[f])) {
+          workspace.entries[nnz++] = Entry{f, row[f]};
+        }
+      }
+      this->PredictRow({workspace.entries.data(), nnz}, *forest, model, tree_begin, tree_end,
+                       &workspace.feats, out_preds.subspan(r * num_group, num_group));
+    }
+  }
+
+  void PredictCascade(DMatrix *p_fmat, HostDeviceVector<bst_float> *out_preds,
+                      std::vector<uint32_t> *out_n_trees, const gbm::GBTreeModel &model,
+                      uint32_t stage_trees, float margin_lower, float margin_upper,
+                      uint32_t tree_begin, uint32_t tree_end) const override {
+    CHECK_EQ(model.learner_model_param->num_output_group, 1)
+        << "Cascaded prediction only supports models with single output group.";
+    CHECK_GT(stage_trees, 0);
+    if (tree_end == 0) {
+      tree_end = model.trees.size();
+    }
+    CHECK_LE(tree_begin, tree_end);
+    auto const &info = p_fmat->Info();
+    this->InitOutPredictions(info, out_preds, model);
+    auto &preds = out_preds->HostVector();
+    auto &n_trees = *out_n_trees;
+    n_trees.resize(info.num_row_);
+    std::fill(n_trees.begin(), n_trees.end(), 0);
+
+    auto forest = this->GetForest(model);
+    int const num_feature = forest->NumUsedFeatures();
+    auto compact = forest->CompactIndex();
+    std::vector<RegTree::FVec> feat_vecs;
+    InitThreadTemp(omp_get_max_threads() * kBlockOfRowsSize, num_feature, &feat_vecs);
+    for (auto const &batch : p_fmat->GetBatches<SparsePage>()) {
+      SparsePageView<1> page{&batch};
+      const auto nsize = static_cast<bst_omp_uint>(batch.Size());
+      omp_ulong n_blocks = common::DivRoundUp(nsize, kBlockOfRowsSize);
+      common::ParallelFor(n_blocks, [&](bst_omp_uint block_id) {
+        const size_t batch_offset = block_id * kBlockOfRowsSize;
+        const size_t block_size = std::min(nsize - batch_offset, kBlockOfRowsSize);
+        const size_t fvec_offset = common::ThreadIdx() * kBlockOfRowsSize;
+        FVecFill(block_size, batch_offset, num_feature, &page, fvec_offset, &feat_vecs,
+                 compact);
+        // Position of rows in current block that are still being evaluated.
+        uint32_t active[kBlockOfRowsSize];
+        size_t n_active = block_size;
+        for (size_t i = 0; i < block_size; ++i) {
+          active[i] = i;
+        }
+        auto const base_rowid = batch.base_rowid + batch_offset;
+        for (uint32_t stage_begin = tree_begin; stage_begin < tree_end && n_active != 0;
+             stage_begin += stage_trees) {
+          uint32_t stage_end = std::min(tree_end, stage_begin + stage_trees);
+          for (uint32_t tree_id = stage_begin; tree_id < stage_end; ++tree_id) {
+            auto const &cats = model.trees[tree_id]->GetCategoriesMatrix();
+            bool has_categorical = forest->HasCategorical(tree_id);
+            for (size_t k = 0; k < n_active; ++k) {
+              auto const &feats = feat_vecs[fvec_offset + active[k]];
+              preds[base_rowid + active[k]] +=
+                  has_categorical ? PredValueByOneTree<true>(feats, *forest, tree_id, cats)
+                                  : PredValueByOneTree<false>(feats, *forest, tree_id, cats);
+            }
+          }
+          // Keep rows with margin inside the bound for next stage.
+          size_t kept = 0;
+          for (size_t k = 0; k < n_active; ++k) {
+            auto ridx = base_rowid + active[k];
+            n_trees[ridx] = stage_end - tree_begin;
+            if (preds[ridx] >= margin_lower && preds[ridx] <= margin_upper) {
+              active[kept++] = active[k];
+            }
+          }
+          n_active = kept;
+        }
+        FVecDrop(block_size, batch_offset, &page, fvec_offset, &feat_vecs, compact);
+      });
+    }
+  }
+
   void PredictInstance(const SparsePage::Inst& inst,
                        std::vector<bst_float>* out_preds,
                        const gbm::GBTreeModel& model, unsigned ntree_limit) const override {
@@ -368,12 +737,69 @@ class CPUPredictor : public Predictor {
     }
   }
 
+  // Traverse blocks of rows through the first `n_trees` trees, calling `fn(ridx, tree_id,
+  // nidx)` with the leaf reached by each row.
+  template <typename Fn>
+  void PredictLeafByBlockOfRows(DMatrix *p_fmat, gbm::GBTreeModel const &model,
+                                uint32_t n_trees, Fn &&fn) const {
+    auto forest = this->GetForest(model);
+    int const num_feature = forest->NumUsedFeatures();
+    auto compact = forest->CompactIndex();
+    std::vector<RegTree::FVec> feat_vecs;
+    InitThreadTemp(omp_get_max_threads() * kBlockOfRowsSize, num_feature, &feat_vecs);
+    for (auto const &batch : p_fmat->GetBatches<SparsePage>()) {
+      SparsePageView<1> page{&batch};
+      const auto nsize = static_cast<bst_omp_uint>(batch.Size());
+      omp_ulong n_blocks = common::DivRoundUp(nsize, kBlockOfRowsSize);
+      common::ParallelFor(n_blocks, [&](bst_omp_uint block_id) {
+        const size_t batch_offset = block_id * kBlockOfRowsSize;
+        const size_t block_size = std::min(nsize - batch_offset, kBlockOfRowsSize);
+        const size_t fvec_offset = common::ThreadIdx() * kBlockOfRowsSize;
+        FVecFill(block_size, batch_offset, num_feature, &page, fvec_offset, &feat_vecs,
+                 compact);
+        auto const base_rowid = batch.base_rowid + batch_offset;
+        for (uint32_t tree_id = 0; tree_id < n_trees; ++tree_id) {
+          auto const *tree = forest->Tree(tree_id);
+          auto const &cats = model.trees[tree_id]->GetCategoriesMatrix();
+          bool has_categorical = forest->HasCategorical(tree_id);
+          for (size_t i = 0; i < block_size; ++i) {
+            auto const &feats = feat_vecs[fvec_offset + i];
+            auto const &leaf =
+                has_categorical
+                    ? (feats.HasMissing() ? GetLeaf<true, true>(tree, feats, cats)
+                                          : GetLeaf<false, true>(tree, feats, cats))
+                    : (feats.HasMissing() ? GetLeaf<true, false>(tree, feats, cats)
+                                          : GetLeaf<false, false>(tree, feats, cats));
+            fn(base_rowid + i, tree_id, leaf.nidx);
+          }
+        }
+        FVecDrop(block_size, batch_offset, &page, fvec_offset, &feat_vecs, compact);
+      });
+    }
+  }
+
+  template <typename T>
+  void PredictLeafCompact(DMatrix *p_fmat, common::Span<T> out, gbm::GBTreeModel const &model,
+                          uint32_t ntree_limit, bool one_hot) const {
+    LeafOrdinals ordinals{model, ntree_limit};
+    ordinals.CheckOutput(p_fmat->Info().num_row_, out.size(), std::numeric_limits<T>::max(),
+                         one_hot);
+    auto n_trees = ordinals.NumTrees();
+    auto write = [&](auto get) {
+      this->PredictLeafByBlockOfRows(
+          p_fmat, model, n_trees, [&](size_t ridx, uint32_t tree_id, bst_node_t nidx) {
+            out[ridx * n_trees + tree_id] = static_cast<T>(get(tree_id, nidx));
+          });
+    };
+    if (one_hot) {
+      write([&](uint32_t tree_id, bst_node_t nidx) { return ordinals.Column(tree_id, nidx); });
+    } else {
+      write([&](uint32_t tree_id, bst_node_t nidx) { return ordinals.Ordinal(tree_id, nidx); });
+    }
+  }
+
   void PredictLeaf(DMatrix* p_fmat, HostDeviceVector<bst_float>* out_preds,
                    const gbm::GBTreeModel& model, unsigned ntree_limit) const override {
-    const int nthread = omp_get_max_threads();
-    std::vector<RegTree::FVec> feat_vecs;
-    const int num_feature = model.learner_model_param->num_feature;
-    InitThreadTemp(nthread, num_feature, &feat_vecs);
     const MetaInfo& info = p_fmat->Info();
     // number of valid trees
     if (ntree_limit == 0 || ntree_limit > model.trees.size()) {
@@ -381,28 +807,25 @@ class CPUPredictor : public Predictor {
     }
     std::vector<bst_float>& preds = out_preds->HostVector();
     preds.resize(info.num_row_ * ntree_limit);
-    // start collecting the prediction
-    for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
-      // parallel over local batch
-      auto page = batch.GetView();
-      const auto nsize = static_cast<bst_omp_uint>(batch.Size());
-      common::ParallelFor(nsize, [&](bst_omp_uint i) {
-        const int tid = omp_get_thread_num();
-        auto ridx = static_cast<size_t>(batch.base_rowid + i);
-        RegTree::FVec &feats = feat_vecs[tid];
-        if (feats.Size() == 0) {
-          feats.Init(num_feature);
-        }
-        feats.Fill(page[i]);
-        for (unsigned j = 0; j < ntree_limit; ++j) {
-          auto const& tree = *model.trees[j];
-          auto const& cats = tree.GetCategoriesMatrix();
-          bst_node_t tid = GetLeafIndex<true, true>(tree, feats, cats);
-          preds[ridx * ntree_limit + j] = static_cast<bst_float>(tid);
-        }
-        feats.Drop(page[i]);
-      });
-    }
+    this->PredictLeafByBlockOfRows(
+        p_fmat, model, ntree_limit, [&](size_t ridx, uint32_t tree_id, bst_node_t nidx) {
+          preds[ridx * ntree_limit + tree_id] = static_cast<bst_float>(nidx);
+        });
+  }
+
+  void PredictLeafOrdinal(DMatrix *p_fmat, common::Span<std::uint8_t> out,
+                          const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    this->PredictLeafCompact(p_fmat, out, model, ntree_limit, false);
+  }
+
+  void PredictLeafOrdinal(DMatrix *p_fmat, common::Span<std::uint16_t> out,
+                          const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    this->PredictLeafCompact(p_fmat, out, model, ntree_limit, false);
+  }
+
+  void PredictLeafOneHot(DMatrix *p_fmat, common::Span<std::uint32_t> out_indices,
+                         const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    this->PredictLeafCompact(p_fmat, out_indices, model, ntree_limit, true);
   }
 
   void PredictContribution(DMatrix *p_fmat,
@@ -411,10 +834,11 @@ class CPUPredictor : public Predictor {
                            std::vector<bst_float> const *tree_weights,
                            bool approximate, int condition,
                            unsigned condition_feature) const override {
+    CHECK(!model.IsMultiTarget()) << "SHAP values are not supported for multi-target trees.";
     const int nthread = omp_get_max_threads();
     const int num_feature = model.learner_model_param->num_feature;
     std::vector<RegTree::FVec> feat_vecs;
-    InitThreadTemp(nthread,  num_feature, &feat_vecs);
+    InitThreadTemp(nthread * kBlockOfRowsSize, num_feature, &feat_vecs);
     const MetaInfo& info = p_fmat->Info();
     // number of valid trees
     if (ntree_limit == 0 || ntree_limit > model.trees.size()) {
@@ -430,67 +854,203 @@ class CPUPredictor : public Predictor {
     // make sure contributions is zeroed, we could be reusing a previously
     // allocated one
     std::fill(contribs.begin(), contribs.end(), 0);
-    // initialize tree node mean values
-    std::vector<std::vector<float>> mean_values(ntree_limit);
-    common::ParallelFor(bst_omp_uint(ntree_limit), [&](bst_omp_uint i) {
-      FillNodeMeanValues(model.trees[i].get(), &(mean_values[i]));
-    });
+    // tree node mean values and decision paths
+    auto shap = this->GetShapForest(model);
+    // Approximate contributions only need the leaf of each row, which is found with the
+    // same traversal as prediction.
+    std::shared_ptr<FlatForest const> forest;
+    common::Span<int32_t const> compact;
+    int fvec_size = num_feature;
+    if (approximate) {
+      forest = this->GetForest(model);
+      compact = forest->CompactIndex();
+      fvec_size = forest->NumUsedFeatures();
+    }
     auto base_margin = info.base_margin_.View(GenericParameter::kCpuId);
     // start collecting the contributions
     for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
-      auto page = batch.GetView();
-      // parallel over local batch
+      SparsePageView<1> page{&batch};
       const auto nsize = static_cast<bst_omp_uint>(batch.Size());
-      common::ParallelFor(nsize, [&](bst_omp_uint i) {
-        auto row_idx = static_cast<size_t>(batch.base_rowid + i);
-        RegTree::FVec &feats = feat_vecs[omp_get_thread_num()];
-        if (feats.Size() == 0) {
-          feats.Init(num_feature);
-        }
+      omp_ulong n_blocks = common::DivRoundUp(nsize, kBlockOfRowsSize);
+      // parallel over blocks of rows, each block goes through all trees to reuse the paths
+      // while they are still in cache.
+      common::ParallelFor(n_blocks, [&](bst_omp_uint block_id) {
+        const size_t batch_offset = block_id * kBlockOfRowsSize;
+        const size_t block_size = std::min(nsize - batch_offset, kBlockOfRowsSize);
+        const size_t fvec_offset = common::ThreadIdx() * kBlockOfRowsSize;
+        FVecFill(block_size, batch_offset, fvec_size, &page, fvec_offset, &feat_vecs, compact);
+        std::vector<TreeShapForest::PathWeight> workspace(shap->MaxPathLength() + 1);
         std::vector<bst_float> this_tree_contribs(ncolumns);
-        // loop over all classes
-        for (int gid = 0; gid < ngroup; ++gid) {
-          bst_float* p_contribs = &contribs[(row_idx * ngroup + gid) * ncolumns];
-          feats.Fill(page[i]);
-          // calculate contributions
-          for (unsigned j = 0; j < ntree_limit; ++j) {
-            auto *tree_mean_values = &mean_values.at(j);
-            std::fill(this_tree_contribs.begin(), this_tree_contribs.end(), 0);
-            if (model.tree_info[j] != gid) {
-              continue;
+        for (unsigned j = 0; j < ntree_limit; ++j) {
+          auto gid = model.tree_info[j];
+          bst_float w = tree_weights == nullptr ? 1 : (*tree_weights)[j];
+          if (approximate) {
+            auto const *tree = forest->Tree(j);
+            auto const &cats = model.trees[j]->GetCategoriesMatrix();
+            for (size_t i = 0; i < block_size; ++i) {
+              auto row_idx = static_cast<size_t>(batch.base_rowid + batch_offset + i);
+              auto const &feats = feat_vecs[fvec_offset + i];
+              auto const &leaf = forest->HasCategorical(j)
+                                     ? GetLeaf<true, true>(tree, feats, cats)
+                                     : GetLeaf<true, false>(tree, feats, cats);
+              shap->CalculateApprox(j, leaf.nidx, num_feature, w,
+                                    &contribs[(row_idx * ngroup + gid) * ncolumns]);
             }
-            if (!approximate) {
-              model.trees[j]->CalculateContributions(
-                  feats, tree_mean_values, &this_tree_contribs[0], condition,
-                  condition_feature);
-            } else {
-              model.trees[j]->CalculateContributionsApprox(
-                  feats, tree_mean_values, &this_tree_contribs[0]);
+            continue;
+          }
+          bool use_path = condition == 0 && !shap->HasCategorical(j);
+          // RegTree doesn't modify the mean values.
+          auto *tree_mean_values = const_cast<std::vector<float> *>(&shap->MeanValues(j));
+          for (size_t i = 0; i < block_size; ++i) {
+            auto row_idx = static_cast<size_t>(batch.base_rowid + batch_offset + i);
+            RegTree::FVec const &feats = feat_vecs[fvec_offset + i];
+            bst_float *p_contribs = &contribs[(row_idx * ngroup + gid) * ncolumns];
+            if (use_path) {
+              shap->Calculate(j, feats, w, workspace.data(), p_contribs);
+              continue;
             }
+            std::fill(this_tree_contribs.begin(), this_tree_contribs.end(), 0);
+            model.trees[j]->CalculateContributions(feats, tree_mean_values,
+                                                   &this_tree_contribs[0], condition,
+                                                   condition_feature);
             for (size_t ci = 0; ci < ncolumns; ++ci) {
-              p_contribs[ci] +=
-                  this_tree_contribs[ci] *
-                  (tree_weights == nullptr ? 1 : (*tree_weights)[j]);
+              p_contribs[ci] += this_tree_contribs[ci] * w;
             }
           }
-          feats.Drop(page[i]);
-          // add base margin to BIAS
-          if (base_margin.Size() != 0) {
-            CHECK_EQ(base_margin.Shape(1), ngroup);
-            p_contribs[ncolumns - 1] += base_margin(row_idx, gid);
-          } else {
-            p_contribs[ncolumns - 1] += model.learner_model_param->base_score;
+        }
+        FVecDrop(block_size, batch_offset, &page, fvec_offset, &feat_vecs, compact);
+        // add base margin to BIAS
+        for (size_t i = 0; i < block_size; ++i) {
+          auto row_idx = static_cast<size_t>(batch.base_rowid + batch_offset + i);
+          for (int gid = 0; gid < ngroup; ++gid) {
+            bst_float *p_contribs = &contribs[(row_idx * ngroup + gid) * ncolumns];
+            if (base_margin.Size() != 0) {
+              CHECK_EQ(base_margin.Shape(1), ngroup);
+              p_contribs[ncolumns - 1] += base_margin(row_idx, gid);
+            } else {
+              p_contribs[ncolumns - 1] += model.learner_model_param->base_score;
+            }
           }
         }
       });
     }
   }
 
+  void Configure(const std::vector<std::pair<std::string, std::string>> &cfg) override {
+    Predictor::Configure(cfg);
+    for (auto const &kv : cfg) {
+      if (kv.first == "row_cache_size") {
+        auto capacity = static_cast<size_t>(std::stoull(kv.second));
+        if (capacity == 0) {
+          row_cache_.reset();
+        } else if (!row_cache_ || row_cache_->Capacity() != capacity) {
+          row_cache_.reset(new RowPredictionCache{capacity});
+        }
+      } else if (kv.first == "interaction_features") {
+        interaction_features_.clear();
+        if (kv.second.empty()) {
+          continue;
+        }
+        auto j_features = Json::Load({kv.second.c_str(), kv.second.size()});
+        for (auto const &v : get<Array const>(j_features)) {
+          interaction_features_.push_back(static_cast<bst_feature_t>(get<Integer const>(v)));
+        }
+      }
+    }
+  }
+
   void PredictInteractionContributions(
       DMatrix *p_fmat, HostDeviceVector<bst_float> *out_contribs,
       const gbm::GBTreeModel &model, unsigned ntree_limit,
       std::vector<bst_float> const *tree_weights,
       bool approximate) const override {
+    CHECK(!model.IsMultiTarget()) << "SHAP values are not supported for multi-target trees.";
+    if (ntree_limit == 0 || ntree_limit > model.trees.size()) {
+      ntree_limit = static_cast<unsigned>(model.trees.size());
+    }
+    auto shap = this->GetShapForest(model);
+    bool use_path = !approximate;
+    for (unsigned j = 0; j < ntree_limit; ++j) {
+      use_path &= !shap->HasCategorical(j);
+    }
+    if (!use_path) {
+      if (!interaction_features_.empty()) {
+        LOG(WARNING) << "`interaction_features` is ignored for approximate contributions "
+                        "or models with categorical splits.";
+      }
+      this->PredictInteractionByCondition(p_fmat, out_contribs, model, ntree_limit,
+                                          tree_weights, approximate);
+      return;
+    }
+
+    const MetaInfo& info = p_fmat->Info();
+    const int ngroup = model.learner_model_param->num_output_group;
+    const int num_feature = model.learner_model_param->num_feature;
+    size_t const ncolumns = num_feature + 1;
+    size_t const mrow_chunk = ncolumns * ncolumns;
+    std::vector<uint8_t> selected;
+    if (!interaction_features_.empty()) {
+      selected.resize(num_feature, 0);
+      for (auto fidx : interaction_features_) {
+        CHECK_LT(fidx, num_feature) << "Invalid feature index in `interaction_features`.";
+        selected[fidx] = 1;
+      }
+    }
+
+    std::vector<RegTree::FVec> feat_vecs;
+    InitThreadTemp(omp_get_max_threads() * kBlockOfRowsSize, num_feature, &feat_vecs);
+    std::vector<bst_float>& contribs = out_contribs->HostVector();
+    contribs.resize(info.num_row_ * ngroup * mrow_chunk);
+    std::fill(contribs.begin(), contribs.end(), 0);
+    auto base_margin = info.base_margin_.View(GenericParameter::kCpuId);
+    for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
+      SparsePageView<1> page{&batch};
+      const auto nsize = static_cast<bst_omp_uint>(batch.Size());
+      omp_ulong n_blocks = common::DivRoundUp(nsize, kBlockOfRowsSize);
+      common::ParallelFor(n_blocks, [&](bst_omp_uint block_id) {
+        const size_t batch_offset = block_id * kBlockOfRowsSize;
+        const size_t block_size = std::min(nsize - batch_offset, kBlockOfRowsSize);
+        const size_t fvec_offset = common::ThreadIdx() * kBlockOfRowsSize;
+        FVecFill(block_size, batch_offset, num_feature, &page, fvec_offset, &feat_vecs);
+        std::vector<TreeShapForest::PathWeight> workspace((shap->MaxPathLength() + 1) * 2);
+        for (unsigned j = 0; j < ntree_limit; ++j) {
+          auto gid = model.tree_info[j];
+          bst_float w = tree_weights == nullptr ? 1 : (*tree_weights)[j];
+          for (size_t i = 0; i < block_size; ++i) {
+            auto row_idx = static_cast<size_t>(batch.base_rowid + batch_offset + i);
+            bst_float *p_contribs = &contribs[(row_idx * ngroup + gid) * mrow_chunk];
+            shap->CalculateInteractions(j, feat_vecs[fvec_offset + i], w, selected,
+                                        workspace.data(), p_contribs);
+          }
+        }
+        FVecDrop(block_size, batch_offset, &page, fvec_offset, &feat_vecs);
+        // add base margin to the diagonal of BIAS
+        for (size_t i = 0; i < block_size; ++i) {
+          auto row_idx = static_cast<size_t>(batch.base_rowid + batch_offset + i);
+          for (int gid = 0; gid < ngroup; ++gid) {
+            bst_float *p_contribs = &contribs[(row_idx * ngroup + gid) * mrow_chunk];
+            if (base_margin.Size() != 0) {
+              CHECK_EQ(base_margin.Shape(1), ngroup);
+              p_contribs[mrow_chunk - 1] += base_margin(row_idx, gid);
+            } else {
+              p_contribs[mrow_chunk - 1] += model.learner_model_param->base_score;
+            }
+          }
+        }
+      });
+    }
+  }
+
+ private:
+  /**
+   * \brief Compute interaction values by conditioning on each feature with full passes of
+   *        `PredictContribution`, used when the path based algorithm is not applicable.
+   */
+  void PredictInteractionByCondition(
+      DMatrix *p_fmat, HostDeviceVector<bst_float> *out_contribs,
+      const gbm::GBTreeModel &model, unsigned ntree_limit,
+      std::vector<bst_float> const *tree_weights,
+      bool approximate) const {
     const MetaInfo& info = p_fmat->Info();
     const int ngroup = model.learner_model_param->num_output_group;
     size_t const ncolumns = model.learner_model_param->num_feature;
@@ -538,8 +1098,127 @@ class CPUPredictor : public Predictor {
     }
   }
 
- private:
+  /*
+   * \brief Get the cached representation of model, build or extend it when the model has
+   *        been changed since last call.  A published cache is never modified, once it's
+   *        up to date concurrent predictions obtain it without taking the lock.
+   */
+  template <typename Cache>
+  static std::shared_ptr<Cache const> UpdateCache(gbm::GBTreeModel const &model,
+                                                  std::mutex *lock,
+                                                  std::shared_ptr<Cache> *p_cache) {
+    auto cache = std::atomic_load(p_cache);
+    if (cache && cache->Generation() == model.Generation() &&
+        cache->Size() == model.trees.size()) {
+      return cache;
+    }
+    std::lock_guard<std::mutex> guard{*lock};
+    // Unpublish the cache so that no other thread can acquire it during extension.
+    cache = std::atomic_exchange(p_cache, std::shared_ptr<Cache>{});
+    if (!cache || cache->Generation() != model.Generation() ||
+        cache->Size() > model.trees.size()) {
+      cache = std::make_shared<Cache>(model.Generation());
+    }
+    if (cache->Size() < model.trees.size()) {
+      if (cache.use_count() != 1) {
+        // Cache is being used by other threads, extend on a copy.
+        cache = std::make_shared<Cache>(*cache);
+      }
+      cache->Extend(model);
+    }
+    std::atomic_store(p_cache, cache);
+    return cache;
+  }
+
+  std::shared_ptr<FlatForest const> GetForest(gbm::GBTreeModel const &model) const {
+    if (model.shared_forest) {
+      return model.shared_forest;
+    }
+    return UpdateCache(model, &forest_lock_, &forest_);
+  }
+
+  std::shared_ptr<TreeShapForest const> GetShapForest(gbm::GBTreeModel const &model) const {
+    return UpdateCache(model, &shap_lock_, &shap_);
+  }
+
+  // Buffers for predicting one row at a time, reused by all calls on the same thread.
+  // Memory is only allocated when the number of features grows.
+  struct RowWorkspace {
+    RegTree::FVec feats;
+    std::vector<Entry> entries;
+  };
+  static RowWorkspace &LocalRowWorkspace(FlatForest const &forest, size_t n_features) {
+    static thread_local RowWorkspace workspace;
+    if (workspace.feats.Size() != forest.NumUsedFeatures()) {
+      workspace.feats.Init(forest.NumUsedFeatures());
+    }
+    if (workspace.entries.size() < n_features) {
+      workspace.entries.resize(n_features);
+    }
+    return workspace;
+  }
+
+  /**
+   * \brief Add leaf values of trees in [tree_begin, tree_end) to `out`, which holds the
+   *        initial outputs of the row.  Results are looked up in the row cache first when
+   *        it's enabled.
+   */
+  void PredictRow(SparsePage::Inst inst, FlatForest const &forest,
+                  gbm::GBTreeModel const &model, uint32_t tree_begin, uint32_t tree_end,
+                  RegTree::FVec *p_feats, common::Span<float> out) const {
+    RowPredictionCache::Key key;
+    uint64_t hash{0};
+    if (row_cache_) {
+      key.generation = model.Generation();
+      key.tree_begin = tree_begin;
+      key.tree_end = tree_end;
+      key.row.assign(inst.cbegin(), inst.cend());
+      key.init.assign(out.cbegin(), out.cend());
+      hash = RowPredictionCache::Hash(key);
+      if (row_cache_->Get(hash, key, out)) {
+        common::PerfCounters::Get()->Add(common::PerfCounters::kRowCacheHits);
+        return;
+      }
+    }
+
+    auto &feats = *p_feats;
+    auto compact = forest.CompactIndex();
+    feats.Fill(inst, compact);
+    for (size_t tree_id = tree_begin; tree_id < tree_end; ++tree_id) {
+      auto const &tree = *model.trees[tree_id];
+      auto const &cats = tree.GetCategoriesMatrix();
+      if (tree.IsMultiTarget()) {
+        if (forest.HasCategorical(tree_id)) {
+          PredVectorByOneTree<true>(feats, forest, tree_id, tree, cats, out.data());
+        } else {
+          PredVectorByOneTree<false>(feats, forest, tree_id, tree, cats, out.data());
+        }
+        continue;
+      }
+      auto &value = out[model.tree_info[tree_id]];
+      if (forest.HasCategorical(tree_id)) {
+        value += PredValueByOneTree<true>(feats, forest, tree_id, cats);
+      } else {
+        value += PredValueByOneTree<false>(feats, forest, tree_id, cats);
+      }
+    }
+    feats.Drop(inst, compact);
+
+    if (row_cache_) {
+      row_cache_->Put(hash, std::move(key), out);
+      common::PerfCounters::Get()->Add(common::PerfCounters::kRowCacheMisses);
+    }
+  }
+
   static size_t constexpr kBlockOfRowsSize = 64;
+
+  // Bounded cache of results for repeated rows, used by row-wise and inplace prediction.
+  std::unique_ptr<RowPredictionCache> row_cache_;
+  mutable std::mutex forest_lock_;
+  mutable std::shared_ptr<FlatForest> forest_;
+  mutable std::mutex shap_lock_;
+  mutable std::shared_ptr<TreeShapForest> shap_;
+  std::vector<bst_feature_t> interaction_features_;
 };
 
 XGBOOST_REGISTER_PREDICTOR(CPUPredictor, "cpu_predictor")
@@ -0,0 +1,184 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "flat_forest.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dmlc/endian.h"
+#include "xgboost/logging.h"
+#include "../common/hist_util.h"
+#include "../gbm/gbtree_model.h"
+
+namespace xgboost {
+namespace predictor {
+void FlatForest::Extend(gbm::GBTreeModel const& model) {
+  CHECK_EQ(model.Generation(), generation_);
+  CHECK_LE(this->Size(), model.trees.size());
+  for (size_t tree_idx = this->Size(); tree_idx < model.trees.size(); ++tree_idx) {
+    this->Push(*model.trees[tree_idx]);
+  }
+}
+
+void FlatForest::Push(RegTree const& tree) {
+  auto& nodes = nodes_.Owned();
+  auto& leaf_values = leaf_values_.Owned();
+  auto& compact_index = compact_index_.Owned();
+  auto& used_features = used_features_.Owned();
+  // Nodes are pushed into the forest in the same order as they are visited, so the
+  // position in queue is also the position in flattened tree.
+  std::vector<bst_node_t> queue{RegTree::kRoot};
+  for (size_t pos = 0; pos < queue.size(); ++pos) {
+    auto nidx = queue[pos];
+    auto const& node = tree[nidx];
+    FlatNode flat;
+    flat.nidx = nidx;
+    if (node.IsLeaf()) {
+      CHECK_LT(leaf_values.size(), std::numeric_limits<int32_t>::max());
+      flat.split_cond = 0;
+      flat.sindex = static_cast<uint32_t>(leaf_values.size());
+      flat.left = -1;
+      leaf_values.push_back(node.LeafValue());
+    } else {
+      auto fidx = node.SplitIndex();
+      if (fidx >= compact_index.size()) {
+        compact_index.resize(fidx + 1, -1);
+      }
+      if (compact_index[fidx] == -1) {
+        compact_index[fidx] = static_cast<int32_t>(used_features.size());
+        used_features.push_back(fidx);
+      }
+      flat.split_cond = node.SplitCond();
+      flat.sindex =
+          static_cast<uint32_t>(compact_index[fidx]) | (node.DefaultLeft() ? (1U << 31) : 0U);
+      flat.left = static_cast<int32_t>(queue.size());
+      queue.push_back(node.LeftChild());
+      queue.push_back(node.RightChild());
+    }
+    nodes.push_back(flat);
+  }
+  tree_ptr_.Owned().push_back(nodes.size());
+  has_categorical_.Owned().push_back(tree.HasCategoricalSplit());
+}
+
+namespace {
+/*! \brief Header of forest image, followed by arrays in the order of fields. */
+struct ImageHeader {
+  char magic[8];
+  uint64_t n_nodes;
+  uint64_t n_leaves;
+  uint64_t n_trees;
+  uint64_t n_compact;
+  uint64_t n_used;
+};
+
+constexpr char kImageMagic[8] = {'x', 'g', 'b', 'f', 'l', 'a', 't', '1'};
+constexpr size_t kImageAlign = 64;
+
+size_t AlignImage(size_t n) { return (n + kImageAlign - 1) / kImageAlign * kImageAlign; }
+
+template <typename T>
+void WriteArray(T const* data, size_t n, std::string* out) {
+  out->resize(AlignImage(out->size()), '\0');
+  out->append(reinterpret_cast<char const*>(data), n * sizeof(T));
+}
+
+template <typename T>
+common::Span<T const> ReadArray(common::Span<char const> image, size_t n, size_t* p_offset) {
+  auto offset = AlignImage(*p_offset);
+  CHECK_LE(offset + n * sizeof(T), image.size()) << "Invalid flattened forest image.";
+  *p_offset = offset + n * sizeof(T);
+  return {reinterpret_cast<T const*>(image.data() + offset), n};
+}
+}  // anonymous namespace
+
+void FlatForest::SaveImage(std::string* out) const {
+  // Image is read in place, byte order of the machine is not converted.
+  CHECK(DMLC_IO_NO_ENDIAN_SWAP) << "Flattened forest image requires little endian machine.";
+  ImageHeader header;
+  std::copy_n(kImageMagic, sizeof(kImageMagic), header.magic);
+  header.n_nodes = nodes_.size();
+  header.n_leaves = leaf_values_.size();
+  header.n_trees = this->Size();
+  header.n_compact = compact_index_.size();
+  header.n_used = used_features_.size();
+  out->assign(reinterpret_cast<char const*>(&header), sizeof(header));
+  WriteArray(nodes_.data(), nodes_.size(), out);
+  WriteArray(leaf_values_.data(), leaf_values_.size(), out);
+  WriteArray(tree_ptr_.data(), tree_ptr_.size(), out);
+  WriteArray(has_categorical_.data(), has_categorical_.size(), out);
+  WriteArray(compact_index_.data(), compact_index_.size(), out);
+  WriteArray(used_features_.data(), used_features_.size(), out);
+}
+
+std::shared_ptr<FlatForest const> FlatForest::FromImage(common::Span<char const> image,
+                                                        std::shared_ptr<void const> owner,
+                                                        uint64_t generation) {
+  CHECK(DMLC_IO_NO_ENDIAN_SWAP) << "Flattened forest image requires little endian machine.";
+  CHECK_EQ(reinterpret_cast<uintptr_t>(image.data()) % alignof(FlatNode), 0)
+      << "Flattened forest image must be aligned to " << alignof(FlatNode) << " bytes.";
+  CHECK_GE(image.size(), sizeof(ImageHeader)) << "Invalid flattened forest image.";
+  ImageHeader header;
+  std::copy_n(image.data(), sizeof(header), reinterpret_cast<char*>(&header));
+  CHECK(std::equal(kImageMagic, kImageMagic + sizeof(kImageMagic), header.magic))
+      << "Invalid flattened forest image.";
+
+  auto forest = std::make_shared<FlatForest>(generation);
+  size_t offset = sizeof(header);
+  forest->nodes_ = detail::FlatArray<FlatNode>(
+      ReadArray<FlatNode>(image, header.n_nodes, &offset));
+  forest->leaf_values_ = detail::FlatArray<float>(
+      ReadArray<float>(image, header.n_leaves, &offset));
+  forest->tree_ptr_ = detail::FlatArray<uint64_t>(
+      ReadArray<uint64_t>(image, header.n_trees + 1, &offset));
+  forest->has_categorical_ = detail::FlatArray<uint8_t>(
+      ReadArray<uint8_t>(image, header.n_trees, &offset));
+  forest->compact_index_ = detail::FlatArray<int32_t>(
+      ReadArray<int32_t>(image, header.n_compact, &offset));
+  forest->used_features_ = detail::FlatArray<bst_feature_t>(
+      ReadArray<bst_feature_t>(image, header.n_used, &offset));
+  CHECK_EQ(forest->tree_ptr_[header.n_trees], header.n_nodes)
+      << "Invalid flattened forest image.";
+  forest->image_ = std::move(owner);
+  return forest;
+}
+
+bool FlatForest::SplitBins(common::HistogramCuts const& cuts,
+                           std::vector<int32_t>* out_bins) const {
+  if (std::any_of(has_categorical_.cbegin(), has_categorical_.cend(),
+                  [](uint8_t c) { return c != 0; })) {
+    return false;
+  }
+  auto const& ptrs = cuts.Ptrs();
+  auto const& values = cuts.Values();
+  auto n_features = ptrs.size() - 1;
+  out_bins->resize(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    auto const& node = nodes_[i];
+    if (node.IsLeaf()) {
+      (*out_bins)[i] = 0;
+      continue;
+    }
+    auto fidx = used_features_[node.SplitIndex()];
+    if (fidx >= n_features) {
+      return false;
+    }
+    auto beg = values.cbegin() + ptrs[fidx];
+    auto end = values.cbegin() + ptrs[fidx + 1];
+    auto it = std::lower_bound(beg, end, node.split_cond);
+    // Values greater than the last cut are clamped into the last bin, so a split on the
+    // last cut can not be decided by bin index.
+    if (it == end || *it != node.split_cond || it == end - 1) {
+      return false;
+    }
+    (*out_bins)[i] = static_cast<int32_t>(it - beg);
+  }
+  return true;
+}
+}  // namespace predictor
+}  // namespace xgboost
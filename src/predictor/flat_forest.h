@@ -0,0 +1,244 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file flat_forest.h
+ * \brief Cache friendly layout of tree model used by CPU predictor.
+ */
+#ifndef XGBOOST_PREDICTOR_FLAT_FOREST_H_
+#define XGBOOST_PREDICTOR_FLAT_FOREST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/logging.h"
+#include "xgboost/span.h"
+#include "xgboost/tree_model.h"
+#include "../common/categorical.h"
+
+namespace xgboost {
+namespace gbm {
+struct GBTreeModel;
+}  // namespace gbm
+namespace common {
+class HistogramCuts;
+}  // namespace common
+
+namespace predictor {
+/**
+ * \brief Tree node packed into 16 bytes so that 4 nodes share a cache line.
+ *
+ *   Nodes of each tree are stored in breadth first order and children of a split node are
+ *   placed next to each other, the right child is always located right after the left
+ *   child.  Leaf values are stored in a separated array.
+ */
+struct alignas(16) FlatNode {
+  /*! \brief Split condition, unused for leaf. */
+  float split_cond;
+  /*!
+   * \brief Compact feature index of split (see `FlatForest::CompactIndex`), highest bit is
+   *        set when missing value goes to left.  For leaf this is the position of leaf
+   *        value in the leaf array.
+   */
+  uint32_t sindex;
+  /*! \brief Position of left child inside the flattened tree, -1 for leaf. */
+  int32_t left;
+  /*! \brief Index of this node in the original `RegTree`. */
+  bst_node_t nidx;
+
+  bool IsLeaf() const { return left == -1; }
+  uint32_t SplitIndex() const { return sindex & ((1U << 31) - 1U); }
+  bool DefaultLeft() const { return (sindex >> 31) != 0; }
+  int32_t DefaultChild() const { return left + !DefaultLeft(); }
+  uint32_t LeafIndex() const { return sindex; }
+};
+
+static_assert(sizeof(FlatNode) == 16, "FlatNode must be packed into 16 bytes.");
+
+namespace detail {
+/**
+ * \brief Array of flattened forest, either owned by the forest or pointing into a model
+ *        image, see `FlatForest::FromImage`.  Only owned arrays can be modified.
+ */
+template <typename T>
+class FlatArray {
+  std::vector<T> owned_;
+  common::Span<T const> mapped_;
+
+ public:
+  FlatArray() = default;
+  FlatArray(std::initializer_list<T> init) : owned_(init) {}
+  explicit FlatArray(common::Span<T const> mapped) : mapped_{mapped} {}
+
+  bool IsMapped() const { return mapped_.data() != nullptr; }
+  T const* data() const { return IsMapped() ? mapped_.data() : owned_.data(); }  // NOLINT
+  size_t size() const { return IsMapped() ? mapped_.size() : owned_.size(); }  // NOLINT
+  T const* cbegin() const { return data(); }  // NOLINT
+  T const* cend() const { return data() + size(); }  // NOLINT
+  T const& operator[](size_t i) const { return data()[i]; }
+  operator common::Span<T const>() const { return {data(), size()}; }  // NOLINT
+
+  /*! \brief Storage for modification, must not be mapped. */
+  std::vector<T>& Owned() {
+    CHECK(!IsMapped()) << "Flattened forest from model image is immutable.";
+    return owned_;
+  }
+};
+}  // namespace detail
+
+/**
+ * \brief Flattened representation of all trees in a `GBTreeModel`.  The forest is tied to
+ *        the generation of the model it's built from.
+ *
+ *   Features used by splits are renumbered into a dense compact index in the order they
+ *   are first seen, so that feature vectors for traversal only hold the used features.
+ *   Indices of existing features don't change when trees are appended.
+ */
+class FlatForest {
+  detail::FlatArray<FlatNode> nodes_;
+  detail::FlatArray<float> leaf_values_;
+  // Segment of nodes for each tree.
+  detail::FlatArray<uint64_t> tree_ptr_{0};
+  detail::FlatArray<uint8_t> has_categorical_;
+  // Compact index of each feature, -1 for features not used by any split.
+  detail::FlatArray<int32_t> compact_index_;
+  // Original index of each compact feature.
+  detail::FlatArray<bst_feature_t> used_features_;
+  uint64_t generation_{0};
+  // Keeps the memory of model image alive for mapped arrays.
+  std::shared_ptr<void const> image_;
+
+ public:
+  FlatForest() = default;
+  explicit FlatForest(uint64_t generation) : generation_{generation} {}
+
+  /**
+   * \brief Flatten trees in the model that are not yet part of this forest.
+   */
+  void Extend(gbm::GBTreeModel const& model);
+  /**
+   * \brief Flatten a single tree, for users working on trees outside of a model.
+   */
+  void Push(RegTree const& tree);
+
+  /**
+   * \brief Serialize the forest into a position independent image, which can be used by
+   *        `FromImage` without copying.  Arrays in the image start at multiples of 64
+   *        bytes from the beginning of image, so they are cache line aligned when the
+   *        image is.
+   */
+  void SaveImage(std::string* out) const;
+  /**
+   * \brief Create a read only forest viewing the image in place, so that processes
+   *        mapping the same image share its physical memory.
+   *
+   * \param image      Image created by `SaveImage`, must be aligned to 16 bytes.
+   * \param owner      Kept alive by the forest, can be null if the caller outlives it.
+   * \param generation Generation of the model the forest is used for.
+   */
+  static std::shared_ptr<FlatForest const> FromImage(common::Span<char const> image,
+                                                     std::shared_ptr<void const> owner,
+                                                     uint64_t generation);
+  /*! \brief Whether the forest is viewing a model image. */
+  bool IsMapped() const { return nodes_.IsMapped(); }
+
+  /*! \brief Number of flattened trees. */
+  size_t Size() const { return tree_ptr_.size() - 1; }
+  /*! \brief Total number of leaves, leaf indices are unique across all trees. */
+  size_t NumLeaves() const { return leaf_values_.size(); }
+  uint64_t Generation() const { return generation_; }
+  /*! \brief Number of features used by splits, which is the size of compact feature vector. */
+  bst_feature_t NumUsedFeatures() const { return used_features_.size(); }
+  /**
+   * \brief Map from feature index to compact index, -1 for unused features.  Features
+   *        beyond the size of the map are not used.  Pass it to `RegTree::FVec::Fill` for
+   *        obtaining feature vectors that can be used for traversing the forest.
+   */
+  common::Span<int32_t const> CompactIndex() const { return compact_index_; }
+  /*! \brief Original feature index of each compact index. */
+  common::Span<bst_feature_t const> UsedFeatures() const { return used_features_; }
+
+  /**
+   * \brief Express split conditions as bin index local to the split feature, rows with bin
+   *        index less than or equal to the split bin go left.
+   *
+   * \param cuts     Histogram cuts used to build the quantized data.
+   * \param out_bins Split bin for each node, in the same layout as flattened nodes.
+   *
+   * \return Whether all splits can be represented by bins, which requires all trees to be
+   *         numerical and all split conditions to be cut values.
+   */
+  bool SplitBins(common::HistogramCuts const& cuts, std::vector<int32_t>* out_bins) const;
+
+  FlatNode const* Tree(size_t tree_idx) const { return nodes_.data() + tree_ptr_[tree_idx]; }
+  /*! \brief Position of the first node of tree in the flattened array. */
+  size_t TreeOffset(size_t tree_idx) const { return tree_ptr_[tree_idx]; }
+  size_t TreeSize(size_t tree_idx) const {
+    return tree_ptr_[tree_idx + 1] - tree_ptr_[tree_idx];
+  }
+  bool HasCategorical(size_t tree_idx) const { return has_categorical_[tree_idx]; }
+  float LeafValue(FlatNode const& leaf) const { return leaf_values_[leaf.LeafIndex()]; }
+  float const* LeafValues() const { return leaf_values_.data(); }
+};
+
+/**
+ * \brief Traverse down a flattened tree.
+ *
+ * \param tree Pointer to the root of flattened tree.
+ * \param feat Compact feature vector filled with `FlatForest::CompactIndex`.
+ * \param cats Categories matrix from the original tree.
+ *
+ * \return The leaf node.
+ */
+template <bool has_missing, bool has_categorical>
+FlatNode const& GetLeaf(FlatNode const* tree, RegTree::FVec const& feat,
+                        RegTree::CategoricalSplitMatrix const& cats) {
+  FlatNode const* node = tree;
+  while (!node->IsLeaf()) {
+    auto split_index = node->SplitIndex();
+    if (has_missing && feat.IsMissing(split_index)) {
+      node = tree + node->DefaultChild();
+      continue;
+    }
+    auto fvalue = feat.GetFvalue(split_index);
+    if (has_categorical && common::IsCat(cats.split_type, node->nidx)) {
+      auto node_categories = cats.categories.subspan(cats.node_ptr[node->nidx].beg,
+                                                     cats.node_ptr[node->nidx].size);
+      node = tree + node->left + !common::Decision(node_categories, common::AsCat(fvalue));
+    } else {
+      node = tree + node->left + !(fvalue < node->split_cond);
+    }
+  }
+  return *node;
+}
+
+/**
+ * \brief Traverse down a flattened tree using quantized data.
+ *
+ * \param tree       Pointer to the root of flattened tree.
+ * \param split_bins Split bins of the tree returned by `FlatForest::SplitBins`.
+ * \param get_bin    Callable returning the local bin index of a compact feature, negative
+ *                   value for missing.
+ *
+ * \return The leaf node.
+ */
+template <bool has_missing, typename GetBin>
+FlatNode const& GetLeafByBin(FlatNode const* tree, int32_t const* split_bins,
+                             GetBin&& get_bin) {
+  FlatNode const* node = tree;
+  while (!node->IsLeaf()) {
+    int32_t bin = get_bin(node->SplitIndex());
+    if (has_missing && bin < 0) {
+      node = tree + node->DefaultChild();
+    } else {
+      node = tree + node->left + !(bin <= split_bins[node - tree]);
+    }
+  }
+  return *node;
+}
+}  // namespace predictor
+}  // namespace xgboost
+#endif  // XGBOOST_PREDICTOR_FLAT_FOREST_H_
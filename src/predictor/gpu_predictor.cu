@@ -7,7 +7,13 @@
 #include <thrust/fill.h>
 #include <thrust/host_vector.h>
 #include <GPUTreeShap/gpu_treeshap.h>
+#include <algorithm>
+#include <array>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "xgboost/data.h"
 #include "xgboost/predictor.h"
@@ -19,23 +25,60 @@
 #include "../gbm/gbtree_model.h"
 #include "../data/ellpack_page.cuh"
 #include "../data/device_adapter.cuh"
+#include "../common/annotation.h"
 #include "../common/common.h"
 #include "../common/bitfield.h"
 #include "../common/categorical.h"
 #include "../common/device_helpers.cuh"
+#include "../common/threading_utils.h"
 
 namespace xgboost {
 namespace predictor {
 
 DMLC_REGISTRY_FILE_TAG(gpu_predictor);
 
+/**
+ * \brief Compact node used by the prediction kernel, 12 bytes instead of the 20 bytes of
+ *        `RegTree::Node`.  Node indices are the same as in `RegTree`, the right child
+ *        always follows the left child so only the left child is stored.
+ */
+struct PredictNode {
+  // Split condition for split nodes, leaf value for leaf nodes.
+  float value;
+  // Left child, -1 for leaf nodes.
+  bst_node_t left;
+  // Split feature, the highest bit is set when missing values go left.
+  uint32_t sindex;
+
+  PredictNode() = default;
+  explicit PredictNode(RegTree::Node const& node)
+      : value{node.IsLeaf() ? node.LeafValue() : node.SplitCond()},
+        left{node.IsLeaf() ? RegTree::kInvalidNodeId : node.LeftChild()},
+        sindex{node.IsLeaf() ? 0 : node.SplitIndex() | (node.DefaultLeft() ? 1U << 31 : 0U)} {
+    CHECK(node.IsLeaf() || node.RightChild() == node.LeftChild() + 1);
+  }
+
+  XGBOOST_DEVICE bool IsLeaf() const { return left == RegTree::kInvalidNodeId; }
+  XGBOOST_DEVICE bst_node_t LeftChild() const { return left; }
+  XGBOOST_DEVICE bst_node_t RightChild() const { return left + 1; }
+  XGBOOST_DEVICE bool DefaultLeft() const { return (sindex >> 31) != 0; }
+  XGBOOST_DEVICE bst_node_t DefaultChild() const {
+    return this->DefaultLeft() ? this->LeftChild() : this->RightChild();
+  }
+  XGBOOST_DEVICE unsigned SplitIndex() const { return sindex & ((1U << 31) - 1U); }
+  XGBOOST_DEVICE float SplitCond() const { return value; }
+  XGBOOST_DEVICE float LeafValue() const { return value; }
+};
+static_assert(sizeof(PredictNode) == 12, "Unexpected padding in PredictNode.");
+
+template <typename NodeT>
 struct TreeView {
   RegTree::CategoricalSplitMatrix cats;
-  common::Span<RegTree::Node const> d_tree;
+  common::Span<NodeT const> d_tree;
 
   XGBOOST_DEVICE
   TreeView(size_t tree_begin, size_t tree_idx,
-           common::Span<const RegTree::Node> d_nodes,
+           common::Span<const NodeT> d_nodes,
            common::Span<size_t const> d_tree_segments,
            common::Span<FeatureType const> d_tree_split_types,
            common::Span<uint32_t const> d_cat_tree_segments,
@@ -219,11 +262,11 @@ struct DeviceAdapterLoader {
   }
 };
 
-template <bool has_missing, bool has_categorical, typename Loader>
-__device__ bst_node_t GetLeafIndex(bst_row_t ridx, TreeView const &tree,
+template <bool has_missing, bool has_categorical, typename Loader, typename NodeT>
+__device__ bst_node_t GetLeafIndex(bst_row_t ridx, TreeView<NodeT> const &tree,
                                    Loader *loader) {
   bst_node_t nidx = 0;
-  RegTree::Node n = tree.d_tree[nidx];
+  NodeT n = tree.d_tree[nidx];
   while (!n.IsLeaf()) {
     float fvalue = loader->GetElement(ridx, n.SplitIndex());
     bool is_missing = common::CheckNAN(fvalue);
@@ -234,8 +277,8 @@ __device__ bst_node_t GetLeafIndex(bst_row_t ridx, TreeView const &tree,
   return nidx;
 }
 
-template <bool has_missing, typename Loader>
-__device__ float GetLeafWeight(bst_row_t ridx, TreeView const &tree,
+template <bool has_missing, typename Loader, typename NodeT>
+__device__ float GetLeafWeight(bst_row_t ridx, TreeView<NodeT> const &tree,
                                Loader *loader) {
   bst_node_t nidx = -1;
   if (tree.HasCategoricalSplit()) {
@@ -266,7 +309,7 @@ PredictLeafKernel(Data data, common::Span<const RegTree::Node> d_nodes,
   }
   Loader loader(data, use_shared, num_features, num_rows, entry_start, missing);
   for (size_t tree_idx = tree_begin; tree_idx < tree_end; ++tree_idx) {
-    TreeView d_tree{
+    TreeView<RegTree::Node> d_tree{
         tree_begin,          tree_idx,           d_nodes,
         d_tree_segments,     d_tree_split_types, d_cat_tree_segments,
         d_cat_node_segments, d_categories};
@@ -281,43 +324,76 @@ PredictLeafKernel(Data data, common::Span<const RegTree::Node> d_nodes,
   }
 }
 
+/**
+ * \brief Predict with trees grouped into tiles, nodes of a tile are loaded into shared
+ *        memory once and shared by all rows of the block.  Tiles too large for the shared
+ *        memory are read from global memory.
+ *
+ * \param d_tiles          Boundaries of tiles, as tree indices relative to tree_begin.
+ * \param tile_smem_offset Offset in bytes of the tile cache in dynamic shared memory,
+ *                         after the memory used by the loader.
+ * \param tile_capacity    Number of nodes that fit into the tile cache.
+ */
 template <typename Loader, typename Data, bool has_missing = true>
 __global__ void
-PredictKernel(Data data, common::Span<const RegTree::Node> d_nodes,
+PredictKernel(Data data, common::Span<const PredictNode> d_nodes,
               common::Span<float> d_out_predictions,
               common::Span<size_t const> d_tree_segments,
               common::Span<int const> d_tree_group,
               common::Span<FeatureType const> d_tree_split_types,
               common::Span<uint32_t const> d_cat_tree_segments,
               common::Span<RegTree::Segment const> d_cat_node_segments,
-              common::Span<uint32_t const> d_categories, size_t tree_begin,
+              common::Span<uint32_t const> d_categories,
+              common::Span<size_t const> d_tiles, size_t tile_smem_offset,
+              size_t tile_capacity, size_t tree_begin,
               size_t tree_end, size_t num_features, size_t num_rows,
               size_t entry_start, bool use_shared, int num_group, float missing) {
   bst_uint global_idx = blockDim.x * blockIdx.x + threadIdx.x;
   Loader loader(data, use_shared, num_features, num_rows, entry_start, missing);
-  if (global_idx >= num_rows) return;
-  if (num_group == 1) {
-    float sum = 0;
-    for (size_t tree_idx = tree_begin; tree_idx < tree_end; tree_idx++) {
-      TreeView d_tree{
+  // Rows out of range still help loading tiles.
+  bool valid = global_idx < num_rows;
+  extern __shared__ char _smem_tiles[];
+  auto s_nodes = reinterpret_cast<PredictNode *>(_smem_tiles + tile_smem_offset);
+
+  float sum = 0;
+  for (size_t t = 0; t + 1 < d_tiles.size(); ++t) {
+    size_t tile_node_begin = d_tree_segments[d_tiles[t]];
+    size_t n_tile_nodes = d_tree_segments[d_tiles[t + 1]] - tile_node_begin;
+    common::Span<PredictNode const> tile_nodes;
+    // Same for all threads in the block.
+    if (n_tile_nodes <= tile_capacity) {
+      __syncthreads();
+      for (auto i : dh::BlockStrideRange(static_cast<size_t>(0), n_tile_nodes)) {
+        s_nodes[i] = d_nodes[tile_node_begin + i];
+      }
+      __syncthreads();
+      tile_nodes = {s_nodes, n_tile_nodes};
+    } else {
+      tile_nodes = d_nodes.subspan(tile_node_begin, n_tile_nodes);
+    }
+    if (!valid) {
+      continue;
+    }
+
+    for (size_t tree_idx = tree_begin + d_tiles[t]; tree_idx < tree_begin + d_tiles[t + 1];
+         ++tree_idx) {
+      TreeView<PredictNode> d_tree{
           tree_begin,          tree_idx,           d_nodes,
           d_tree_segments,     d_tree_split_types, d_cat_tree_segments,
           d_cat_node_segments, d_categories};
+      d_tree.d_tree = tile_nodes.subspan(
+          d_tree_segments[tree_idx - tree_begin] - tile_node_begin, d_tree.d_tree.size());
       float leaf = GetLeafWeight<has_missing>(global_idx, d_tree, &loader);
-      sum += leaf;
+      if (num_group == 1) {
+        sum += leaf;
+      } else {
+        int tree_group = d_tree_group[tree_idx];
+        d_out_predictions[global_idx * num_group + tree_group] += leaf;
+      }
     }
+  }
+  if (valid && num_group == 1) {
     d_out_predictions[global_idx] += sum;
-  } else {
-    for (size_t tree_idx = tree_begin; tree_idx < tree_end; tree_idx++) {
-      int tree_group = d_tree_group[tree_idx];
-      TreeView d_tree{
-          tree_begin,          tree_idx,           d_nodes,
-          d_tree_segments,     d_tree_split_types, d_cat_tree_segments,
-          d_cat_node_segments, d_categories};
-      bst_uint out_prediction_idx = global_idx * num_group + tree_group;
-      d_out_predictions[out_prediction_idx] +=
-          GetLeafWeight<has_missing>(global_idx, d_tree, &loader);
-    }
   }
 }
 
@@ -327,6 +403,8 @@ class DeviceModel {
   HostDeviceVector<RTreeNodeStat> stats;
   HostDeviceVector<size_t> tree_segments;
   HostDeviceVector<RegTree::Node> nodes;
+  // Compact copy of nodes used by `PredictKernel`.
+  dh::device_vector<PredictNode> predict_nodes;
   HostDeviceVector<int> tree_group;
   HostDeviceVector<FeatureType> split_types;
 
@@ -372,6 +450,15 @@ class DeviceModel {
           sizeof(RTreeNodeStat) * src_stats.size(), cudaMemcpyDefault));
     }
 
+    std::vector<PredictNode> h_predict_nodes(h_tree_segments.back());
+    for (auto tree_idx = tree_begin; tree_idx < tree_end; tree_idx++) {
+      auto const& src_nodes = model.trees.at(tree_idx)->GetNodes();
+      std::transform(src_nodes.cbegin(), src_nodes.cend(),
+                     h_predict_nodes.begin() + h_tree_segments[tree_idx - tree_begin],
+                     [](RegTree::Node const& node) { return PredictNode{node}; });
+    }
+    predict_nodes = h_predict_nodes;
+
     tree_group = std::move(HostDeviceVector<int>(model.tree_info.size(), 0, gpu_id));
     auto& h_tree_group = tree_group.HostVector();
     std::memcpy(h_tree_group.data(), model.tree_info.data(), sizeof(int) * model.tree_info.size());
@@ -414,6 +501,10 @@ class DeviceModel {
     this->tree_end_ = tree_end;
     this->num_group = model.learner_model_param->num_output_group;
   }
+
+  common::Span<PredictNode const> PredictNodes() const {
+    return {predict_nodes.data().get(), predict_nodes.size()};
+  }
 };
 
 struct ShapSplitCondition {
@@ -484,11 +575,12 @@ struct PathInfo {
   size_t tree_idx;
 };
 
-// Transform model into path element form for GPUTreeShap
-void ExtractPaths(
+// Transform model into path element form for GPUTreeShap, path indices start from
+// `path_begin`.  Returns the number of extracted paths.
+size_t ExtractPaths(
     dh::device_vector<gpu_treeshap::PathElement<ShapSplitCondition>> *paths,
     DeviceModel *model, dh::device_vector<uint32_t> *path_categories,
-    int gpu_id) {
+    int gpu_id, size_t path_begin = 0) {
   dh::safe_cuda(cudaSetDevice(gpu_id));
   auto& device_model = *model;
 
@@ -532,6 +624,7 @@ void ExtractPaths(
   auto d_stats = device_model.stats.ConstDeviceSpan();
   auto d_tree_group = device_model.tree_group.ConstDeviceSpan();
   auto d_path_segments = path_segments.data().get();
+  size_t tree_begin = device_model.tree_beg_;
 
   auto d_split_types = device_model.split_types.ConstDeviceSpan();
   auto d_cat_segments = device_model.categories_tree_segments.ConstDeviceSpan();
@@ -563,10 +656,12 @@ void ExtractPaths(
   dh::LaunchN(info.size(), [=] __device__(size_t idx) {
     auto path_info = d_info[idx];
     size_t tree_offset = d_tree_segments[path_info.tree_idx];
-    TreeView tree{0,                   path_info.tree_idx, d_nodes,
-                  d_tree_segments,     d_split_types,      d_cat_segments,
-                  d_cat_node_segments, d_model_categories};
-    int group = d_tree_group[path_info.tree_idx];
+    TreeView<RegTree::Node> tree{0,                   path_info.tree_idx, d_nodes,
+                                 d_tree_segments,     d_split_types,      d_cat_segments,
+                                 d_cat_node_segments, d_model_categories};
+    // Tree groups are indexed by the trees of the whole model.
+    int group = d_tree_group[path_info.tree_idx + tree_begin];
+    size_t path_idx = idx + path_begin;
     size_t child_idx = path_info.leaf_position;
     auto child = d_nodes[child_idx];
     float v = child.LeafValue();
@@ -601,17 +696,100 @@ void ExtractPaths(
       }
       d_paths[output_position--] =
           gpu_treeshap::PathElement<ShapSplitCondition>{
-              idx,           parent.SplitIndex(),
+              path_idx,      parent.SplitIndex(),
               group,         ShapSplitCondition{lower_bound, upper_bound, is_missing_path, bits},
               zero_fraction, v};
       child_idx = parent_idx;
       child = parent;
     }
     // Root node has feature -1
-    d_paths[output_position] = {idx, -1, group, ShapSplitCondition{-inf, inf, false, {}}, 1.0, v};
+    d_paths[output_position] = {path_idx, -1, group, ShapSplitCondition{-inf, inf, false, {}},
+                                1.0, v};
   });
+  return info.size();
+}
+
+// Digest of the content of a tree, used for detecting trees modified in place.
+uint64_t TreeDigest(RegTree const& tree) {
+  uint64_t constexpr kPrime = 1099511628211ull;
+  uint64_t digest = 14695981039346656037ull;
+  auto update = [&](void const* data, size_t n_bytes) {
+    auto bytes = static_cast<uint8_t const*>(data);
+    for (size_t i = 0; i < n_bytes; ++i) {
+      digest = (digest ^ bytes[i]) * kPrime;
+    }
+  };
+  auto const& nodes = tree.GetNodes();
+  auto const& stats = tree.GetStats();
+  auto const& categories = tree.GetSplitCategories();
+  update(nodes.data(), nodes.size() * sizeof(RegTree::Node));
+  update(stats.data(), stats.size() * sizeof(RTreeNodeStat));
+  update(categories.data(), categories.size() * sizeof(uint32_t));
+  return digest;
 }
 
+/*! \brief Paths of the model extracted for GPUTreeShap, kept across calls. */
+struct ShapPathCache {
+  int32_t device { GenericParameter::kCpuId };
+  std::vector<std::weak_ptr<RegTree>> trees;
+  std::vector<uint64_t> digests;
+  bool has_categorical { false };
+  size_t n_paths { 0 };
+  dh::device_vector<gpu_treeshap::PathElement<ShapSplitCondition>> paths;
+  dh::device_vector<uint32_t> categories;
+
+  /*!
+   * \brief Make the paths represent the first `tree_end` trees of model.  Paths are
+   *        extracted only for trees appended since last call, unless trees are
+   *        modified, removed or have categorical splits.
+   */
+  void Update(gbm::GBTreeModel const& model, uint32_t tree_end, int32_t gpu_id) {
+    size_t n_reused = 0;
+    if (device == gpu_id && trees.size() <= tree_end && !has_categorical) {
+      while (n_reused < trees.size() && trees[n_reused].lock() == model.trees[n_reused] &&
+             digests[n_reused] == TreeDigest(*model.trees[n_reused])) {
+        ++n_reused;
+      }
+    }
+    bool new_categorical = std::any_of(
+        model.trees.cbegin() + n_reused, model.trees.cbegin() + tree_end,
+        [](auto const& tree) { return tree->HasCategoricalSplit(); });
+    if (n_reused != trees.size() || new_categorical) {
+      // Path categories are shared by all paths, start over.
+      n_reused = 0;
+    }
+    if (n_reused == tree_end && n_reused == trees.size()) {
+      return;
+    }
+
+    DeviceModel d_model;
+    d_model.Init(model, n_reused, tree_end, gpu_id);
+    dh::device_vector<gpu_treeshap::PathElement<ShapSplitCondition>> new_paths;
+    dh::device_vector<uint32_t> new_categories;
+    size_t path_begin = n_reused == 0 ? 0 : n_paths;
+    size_t n_new = ExtractPaths(&new_paths, &d_model, &new_categories, gpu_id, path_begin);
+    if (n_reused == 0) {
+      // Swap instead of copy, paths point into the categories.
+      paths.swap(new_paths);
+      categories.swap(new_categories);
+      trees.clear();
+      digests.clear();
+      n_paths = 0;
+      has_categorical = new_categorical;
+    } else {
+      size_t n_old = paths.size();
+      paths.resize(n_old + new_paths.size());
+      thrust::copy(new_paths.cbegin(), new_paths.cend(), paths.begin() + n_old);
+    }
+    n_paths += n_new;
+    for (size_t i = trees.size(); i < tree_end; ++i) {
+      trees.emplace_back(model.trees[i]);
+      digests.push_back(TreeDigest(*model.trees[i]));
+    }
+    device = gpu_id;
+  }
+};
+
 namespace {
 template <size_t kBlockThreads>
 size_t SharedMemoryBytes(size_t cols, size_t max_shared_memory_bytes) {
@@ -624,6 +802,114 @@ size_t SharedMemoryBytes(size_t cols, size_t max_shared_memory_bytes) {
   }
   return shared_memory_bytes;
 }
+
+/**
+ * \brief Group consecutive trees into tiles for `PredictKernel`, such that nodes of each
+ *        tile fit into the shared memory left over by the loader.
+ *
+ * \param shared_memory_bytes Shared memory available for the tiles.
+ * \param out_tiles           Tile boundaries as tree indices relative to the first tree.
+ *
+ * \return Number of nodes in the largest tile that fits, which is the size of the cache.
+ */
+size_t ForestTiles(HostDeviceVector<size_t> const& tree_segments, size_t shared_memory_bytes,
+                   dh::device_vector<size_t>* out_tiles) {
+  auto const& h_tree_segments = tree_segments.ConstHostVector();
+  size_t n_trees = h_tree_segments.size() - 1;
+  size_t max_nodes = shared_memory_bytes / sizeof(PredictNode);
+  std::vector<size_t> h_tiles{0};
+  size_t capacity = 0;
+  for (size_t i = 0; i < n_trees; ++i) {
+    size_t tile_nodes = h_tree_segments[i + 1] - h_tree_segments[h_tiles.back()];
+    if (tile_nodes > max_nodes && h_tiles.back() != i) {
+      // Start a new tile with this tree.
+      h_tiles.push_back(i);
+      tile_nodes = h_tree_segments[i + 1] - h_tree_segments[i];
+    }
+    if (tile_nodes <= max_nodes) {
+      capacity = std::max(capacity, tile_nodes);
+    }
+  }
+  h_tiles.push_back(n_trees);
+  *out_tiles = h_tiles;
+  return capacity;
+}
+
+// Number of rows copied to a device at a time by staged prediction.
+constexpr size_t kShardChunkRows = 1 << 16;
+
+/**
+ * \brief Pinned staging buffers and stream for a chunk of rows in staged prediction of
+ *        host data.  Each device alternates between two slots so that transfers of one
+ *        chunk overlap with prediction of the other.
+ */
+struct ShardSlot {
+  cudaStream_t stream{nullptr};
+  dh::PinnedMemory h_offset;
+  dh::PinnedMemory h_data;
+  dh::PinnedMemory h_preds;
+  dh::device_vector<bst_row_t> d_offset;
+  dh::device_vector<Entry> d_data;
+  dh::device_vector<float> d_preds;
+  // Predictions of the chunk in flight, copied back once the stream is synchronized.
+  common::Span<float> out;
+  size_t row_begin{0};
+  bool busy{false};
+
+  ShardSlot() {
+    dh::safe_cuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+  }
+  ShardSlot(ShardSlot const&) = delete;
+  ShardSlot& operator=(ShardSlot const&) = delete;
+  ~ShardSlot() {
+    if (stream) {
+      // Might be called during stack unwinding, errors are ignored.
+      cudaStreamDestroy(stream);
+    }
+  }
+};
+
+/**
+ * \brief Staging slots kept across predictions, so that pinned memory and device buffers
+ *        are allocated once instead of for every batch.  Concurrent predictions on the
+ *        same device take different slots.
+ */
+class StagingPool {
+ public:
+  using Slots = std::array<ShardSlot, 2>;
+
+ private:
+  std::mutex lock_;
+  std::map<int32_t, std::vector<std::unique_ptr<Slots>>> free_;
+
+ public:
+  /*! \brief Take slots for a device, which must be the current device. */
+  std::unique_ptr<Slots> Acquire(int32_t device) {
+    {
+      std::lock_guard<std::mutex> guard{lock_};
+      auto& slots = free_[device];
+      if (!slots.empty()) {
+        auto ret = std::move(slots.back());
+        slots.pop_back();
+        return ret;
+      }
+    }
+    return std::make_unique<Slots>();
+  }
+  void Release(int32_t device, std::unique_ptr<Slots> slots) {
+    std::lock_guard<std::mutex> guard{lock_};
+    free_[device].emplace_back(std::move(slots));
+  }
+  /*! \brief Free all slots, each on its own device. */
+  void Clear() {
+    std::lock_guard<std::mutex> guard{lock_};
+    for (auto& kv : free_) {
+      dh::safe_cuda(cudaSetDevice(kv.first));
+      kv.second.clear();
+    }
+    free_.clear();
+  }
+};
 }  // anonymous namespace
 
 class GPUPredictor : public xgboost::Predictor {
@@ -643,19 +929,25 @@ class GPUPredictor : public xgboost::Predictor {
         SharedMemoryBytes<BLOCK_THREADS>(num_features, max_shared_memory_bytes);
     bool use_shared = shared_memory_bytes != 0;
 
+    dh::device_vector<size_t> tiles;
+    size_t tile_capacity =
+        ForestTiles(model.tree_segments, max_shared_memory_bytes - shared_memory_bytes, &tiles);
+
     size_t entry_start = 0;
     SparsePageView data(batch.data.DeviceSpan(), batch.offset.DeviceSpan(),
                         num_features);
     auto const kernel = [&](auto predict_fn) {
-      dh::LaunchKernel {GRID_SIZE, BLOCK_THREADS, shared_memory_bytes} (
-          predict_fn, data, model.nodes.ConstDeviceSpan(),
+      dh::LaunchKernel {GRID_SIZE, BLOCK_THREADS,
+                        shared_memory_bytes + tile_capacity * sizeof(PredictNode)} (
+          predict_fn, data, model.PredictNodes(),
           predictions->DeviceSpan().subspan(batch_offset),
           model.tree_segments.ConstDeviceSpan(),
           model.tree_group.ConstDeviceSpan(),
           model.split_types.ConstDeviceSpan(),
           model.categories_tree_segments.ConstDeviceSpan(),
           model.categories_node_segments.ConstDeviceSpan(),
-          model.categories.ConstDeviceSpan(), model.tree_beg_, model.tree_end_,
+          model.categories.ConstDeviceSpan(), dh::ToSpan(tiles), shared_memory_bytes,
+          tile_capacity, model.tree_beg_, model.tree_end_,
           num_features, num_rows, entry_start, use_shared, model.num_group,
           nan(""));
     };
@@ -675,25 +967,208 @@ class GPUPredictor : public xgboost::Predictor {
     DeviceModel d_model;
 
     bool use_shared = false;
+    dh::device_vector<size_t> tiles;
+    size_t tile_capacity =
+        ForestTiles(model.tree_segments, ConfigureDevice(generic_param_->gpu_id), &tiles);
     size_t entry_start = 0;
-    dh::LaunchKernel {GRID_SIZE, BLOCK_THREADS} (
+    dh::LaunchKernel {GRID_SIZE, BLOCK_THREADS, tile_capacity * sizeof(PredictNode)} (
         PredictKernel<EllpackLoader, EllpackDeviceAccessor>, batch,
-        model.nodes.ConstDeviceSpan(), out_preds->DeviceSpan().subspan(batch_offset),
+        model.PredictNodes(), out_preds->DeviceSpan().subspan(batch_offset),
         model.tree_segments.ConstDeviceSpan(), model.tree_group.ConstDeviceSpan(),
         model.split_types.ConstDeviceSpan(),
         model.categories_tree_segments.ConstDeviceSpan(),
         model.categories_node_segments.ConstDeviceSpan(),
-        model.categories.ConstDeviceSpan(), model.tree_beg_, model.tree_end_,
+        model.categories.ConstDeviceSpan(), dh::ToSpan(tiles), 0, tile_capacity,
+        model.tree_beg_, model.tree_end_,
         batch.NumFeatures(), num_rows, entry_start, use_shared,
         model.num_group, nan(""));
   }
 
+  /**
+   * \brief Predict rows [row_begin, row_end) of a host batch on one device, in chunks
+   *        staged through pinned memory.  Predictions are accumulated into `d_preds_out`
+   *        when it's on the device, otherwise into the host vector `h_preds`.
+   */
+  void PredictShard(std::vector<bst_row_t> const& h_offset, std::vector<Entry> const& h_data,
+                    DeviceModel const& model, size_t num_features, bool is_dense,
+                    size_t row_begin, size_t row_end, int32_t device, float* h_preds,
+                    float* d_preds_out = nullptr) const {
+    dh::safe_cuda(cudaSetDevice(device));
+    const uint32_t BLOCK_THREADS = 128;
+    auto max_shared_memory_bytes = ConfigureDevice(device);
+    size_t shared_memory_bytes =
+        SharedMemoryBytes<BLOCK_THREADS>(num_features, max_shared_memory_bytes);
+    bool use_shared = shared_memory_bytes != 0;
+    dh::device_vector<size_t> tiles;
+    size_t tile_capacity =
+        ForestTiles(model.tree_segments, max_shared_memory_bytes - shared_memory_bytes, &tiles);
+    size_t const num_group = model.num_group;
+
+    auto finish = [&](ShardSlot* slot) {
+      if (!slot->busy) {
+        return;
+      }
+      dh::safe_cuda(cudaStreamSynchronize(slot->stream));
+      if (!d_preds_out) {
+        std::copy(slot->out.cbegin(), slot->out.cend(), h_preds + slot->row_begin * num_group);
+      }
+      slot->out = {};
+      slot->busy = false;
+    };
+
+    auto p_slots = staging_.Acquire(device);
+    auto& slots = *p_slots;
+    if (d_preds_out) {
+      // Slot streams don't synchronize with the default stream that initialized the
+      // predictions.
+      cudaEvent_t ready;
+      dh::safe_cuda(cudaEventCreateWithFlags(&ready, cudaEventDisableTiming));
+      dh::safe_cuda(cudaEventRecord(ready, nullptr));
+      for (auto& slot : slots) {
+        dh::safe_cuda(cudaStreamWaitEvent(slot.stream, ready, 0));
+      }
+      dh::safe_cuda(cudaEventDestroy(ready));
+    }
+    size_t k = 0;
+    for (size_t begin = row_begin; begin < row_end; begin += kShardChunkRows, ++k) {
+      auto& slot = slots[k % slots.size()];
+      finish(&slot);
+      size_t n_rows = std::min(kShardChunkRows, row_end - begin);
+      size_t entry_begin = h_offset[begin];
+      size_t n_entries = h_offset[begin + n_rows] - entry_begin;
+
+      auto offset = slot.h_offset.GetSpan<bst_row_t>(n_rows + 1);
+      for (size_t i = 0; i <= n_rows; ++i) {
+        offset[i] = h_offset[begin + i] - entry_begin;
+      }
+      auto data = slot.h_data.GetSpan<Entry>(n_entries);
+      std::copy_n(h_data.data() + entry_begin, n_entries, data.data());
+
+      // Only grow the buffers, shrinking and refilling them would synchronize.
+      if (slot.d_offset.size() < offset.size()) {
+        slot.d_offset.resize(offset.size());
+      }
+      if (slot.d_data.size() < data.size()) {
+        slot.d_data.resize(data.size());
+      }
+      dh::safe_cuda(cudaMemcpyAsync(slot.d_offset.data().get(), offset.data(),
+                                    offset.size_bytes(), cudaMemcpyHostToDevice, slot.stream));
+      dh::safe_cuda(cudaMemcpyAsync(slot.d_data.data().get(), data.data(), data.size_bytes(),
+                                    cudaMemcpyHostToDevice, slot.stream));
+      common::Span<float> d_preds;
+      if (d_preds_out) {
+        d_preds = {d_preds_out + begin * num_group, n_rows * num_group};
+      } else {
+        slot.out = slot.h_preds.GetSpan<float>(n_rows * num_group);
+        std::copy_n(h_preds + begin * num_group, slot.out.size(), slot.out.data());
+        if (slot.d_preds.size() < slot.out.size()) {
+          slot.d_preds.resize(slot.out.size());
+        }
+        dh::safe_cuda(cudaMemcpyAsync(slot.d_preds.data().get(), slot.out.data(),
+                                      slot.out.size_bytes(), cudaMemcpyHostToDevice,
+                                      slot.stream));
+        d_preds = {slot.d_preds.data().get(), slot.out.size()};
+      }
+
+      SparsePageView view(
+          common::Span<Entry const>{slot.d_data.data().get(), n_entries},
+          common::Span<bst_row_t const>{slot.d_offset.data().get(), n_rows + 1},
+          num_features);
+      auto GRID_SIZE = static_cast<uint32_t>(common::DivRoundUp(n_rows, BLOCK_THREADS));
+      size_t entry_start = 0;
+      auto const kernel = [&](auto predict_fn) {
+        dh::LaunchKernel {GRID_SIZE, BLOCK_THREADS,
+                          shared_memory_bytes + tile_capacity * sizeof(PredictNode),
+                          slot.stream} (
+            predict_fn, view, model.PredictNodes(), d_preds,
+            model.tree_segments.ConstDeviceSpan(),
+            model.tree_group.ConstDeviceSpan(),
+            model.split_types.ConstDeviceSpan(),
+            model.categories_tree_segments.ConstDeviceSpan(),
+            model.categories_node_segments.ConstDeviceSpan(),
+            model.categories.ConstDeviceSpan(), dh::ToSpan(tiles), shared_memory_bytes,
+            tile_capacity, model.tree_beg_, model.tree_end_,
+            num_features, n_rows, entry_start, use_shared, model.num_group,
+            nan(""));
+      };
+      if (is_dense) {
+        kernel(PredictKernel<SparsePageLoader, SparsePageView, false>);
+      } else {
+        kernel(PredictKernel<SparsePageLoader, SparsePageView, true>);
+      }
+      dh::safe_cuda(cudaGetLastError());
+      if (!d_preds_out) {
+        dh::safe_cuda(cudaMemcpyAsync(slot.out.data(), d_preds.data(), d_preds.size_bytes(),
+                                      cudaMemcpyDeviceToHost, slot.stream));
+      }
+      slot.row_begin = begin;
+      slot.busy = true;
+    }
+    for (auto& slot : slots) {
+      finish(&slot);
+    }
+    staging_.Release(device, std::move(p_slots));
+  }
+
+  /**
+   * \brief Replicate the model to all devices and split rows of each batch evenly among
+   *        them.  Predictions are gathered on the host.
+   */
+  void PredictSharded(DMatrix* dmat, HostDeviceVector<float>* out_preds,
+                      const gbm::GBTreeModel& model, size_t tree_begin, size_t tree_end,
+                      std::vector<int32_t> const& devices) const {
+    XGBOOST_ANNOTATE_SCOPE("xgboost::GPUPredictor::PredictSharded");
+    auto n_devices = devices.size();
+    std::vector<DeviceModel> d_models(n_devices);
+    common::ParallelFor(n_devices, n_devices, [&](size_t i) {
+      d_models[i].Init(model, tree_begin, tree_end, devices[i]);
+    });
+
+    auto& h_preds = out_preds->HostVector();
+    size_t const num_features = model.learner_model_param->num_feature;
+    size_t const num_group = model.learner_model_param->num_output_group;
+    bool is_dense = dmat->IsDense();
+    size_t batch_offset = 0;
+    for (auto const& batch : dmat->GetBatches<SparsePage>()) {
+      // Pull the batch to host before sharing it among threads.
+      auto const& h_offset = batch.offset.ConstHostVector();
+      auto const& h_data = batch.data.ConstHostVector();
+      size_t n_rows = batch.Size();
+      size_t shard_rows = common::DivRoundUp(n_rows, n_devices);
+      common::ParallelFor(n_devices, n_devices, [&](size_t i) {
+        size_t begin = std::min(i * shard_rows, n_rows);
+        size_t end = std::min(begin + shard_rows, n_rows);
+        this->PredictShard(h_offset, h_data, d_models[i], num_features, is_dense, begin, end,
+                           devices[i], h_preds.data() + batch_offset);
+      });
+      batch_offset += n_rows * num_group;
+    }
+    // The calling thread might have predicted on another device.
+    dh::safe_cuda(cudaSetDevice(generic_param_->gpu_id));
+  }
+
+  /*! \brief Devices used for predicting a DMatrix, starting from `gpu_id`. */
+  std::vector<int32_t> PredictDevices() const {
+    int32_t n_visible = common::AllVisibleGPUs();
+    int32_t n = n_devices_ < 0 ? n_visible : std::min(n_devices_, n_visible);
+    std::vector<int32_t> devices(std::max(n, 1));
+    for (size_t i = 0; i < devices.size(); ++i) {
+      devices[i] = (generic_param_->gpu_id + static_cast<int32_t>(i)) % std::max(n_visible, 1);
+    }
+    return devices;
+  }
+
   void DevicePredictInternal(DMatrix* dmat, HostDeviceVector<float>* out_preds,
                              const gbm::GBTreeModel& model, size_t tree_begin,
                              size_t tree_end) const {
     if (tree_end - tree_begin == 0) {
       return;
     }
+    auto devices = this->PredictDevices();
+    if (devices.size() > 1 && dmat->PageExists<SparsePage>()) {
+      this->PredictSharded(dmat, out_preds, model, tree_begin, tree_end, devices);
+      return;
+    }
     out_preds->SetDevice(generic_param_->gpu_id);
     auto const& info = dmat->Info();
     DeviceModel d_model;
@@ -702,8 +1177,17 @@ class GPUPredictor : public xgboost::Predictor {
     if (dmat->PageExists<SparsePage>()) {
       size_t batch_offset = 0;
       for (auto &batch : dmat->GetBatches<SparsePage>()) {
-        this->PredictInternal(batch, d_model, model.learner_model_param->num_feature,
-                              out_preds, batch_offset, dmat->IsDense());
+        if (batch.data.DeviceCanRead()) {
+          this->PredictInternal(batch, d_model, model.learner_model_param->num_feature,
+                                out_preds, batch_offset, dmat->IsDense());
+        } else {
+          // Host data is streamed in chunks instead of copying the whole page from
+          // pageable memory before predicting.
+          this->PredictShard(batch.offset.ConstHostVector(), batch.data.ConstHostVector(),
+                             d_model, model.learner_model_param->num_feature,
+                             dmat->IsDense(), 0, batch.Size(), generic_param_->gpu_id,
+                             nullptr, out_preds->DevicePointer() + batch_offset);
+        }
         batch_offset += batch.Size() * model.learner_model_param->num_output_group;
       }
     } else {
@@ -726,6 +1210,7 @@ class GPUPredictor : public xgboost::Predictor {
       Predictor::Predictor{generic_param} {}
 
   ~GPUPredictor() override {
+    staging_.Clear();
     if (generic_param_->gpu_id >= 0 && generic_param_->gpu_id < common::AllVisibleGPUs()) {
       dh::safe_cuda(cudaSetDevice(generic_param_->gpu_id));
     }
@@ -734,6 +1219,7 @@ class GPUPredictor : public xgboost::Predictor {
   void PredictBatch(DMatrix* dmat, PredictionCacheEntry* predts,
                     const gbm::GBTreeModel& model, uint32_t tree_begin,
                     uint32_t tree_end = 0) const override {
+    XGBOOST_ANNOTATE_SCOPE("xgboost::GPUPredictor::PredictBatch");
     int device = generic_param_->gpu_id;
     CHECK_GE(device, 0) << "Set `gpu_id' to positive value for processing GPU data.";
     auto* out_preds = &predts->predictions;
@@ -777,15 +1263,20 @@ class GPUPredictor : public xgboost::Predictor {
 
     bool use_shared = shared_memory_bytes != 0;
     size_t entry_start = 0;
+    dh::device_vector<size_t> tiles;
+    size_t tile_capacity = ForestTiles(d_model.tree_segments,
+                                       max_shared_memory_bytes - shared_memory_bytes, &tiles);
 
-    dh::LaunchKernel {GRID_SIZE, BLOCK_THREADS, shared_memory_bytes} (
+    dh::LaunchKernel {GRID_SIZE, BLOCK_THREADS,
+                      shared_memory_bytes + tile_capacity * sizeof(PredictNode)} (
         PredictKernel<Loader, typename Loader::BatchT>, m->Value(),
-        d_model.nodes.ConstDeviceSpan(), out_preds->predictions.DeviceSpan(),
+        d_model.PredictNodes(), out_preds->predictions.DeviceSpan(),
         d_model.tree_segments.ConstDeviceSpan(), d_model.tree_group.ConstDeviceSpan(),
         d_model.split_types.ConstDeviceSpan(),
         d_model.categories_tree_segments.ConstDeviceSpan(),
         d_model.categories_node_segments.ConstDeviceSpan(),
-        d_model.categories.ConstDeviceSpan(), tree_begin, tree_end, m->NumColumns(),
+        d_model.categories.ConstDeviceSpan(), dh::ToSpan(tiles), shared_memory_bytes,
+        tile_capacity, tree_begin, tree_end, m->NumColumns(),
         m->NumRows(), entry_start, use_shared, output_groups, missing);
   }
 
@@ -837,12 +1328,9 @@ class GPUPredictor : public xgboost::Predictor {
     out_contribs->Fill(0.0f);
     auto phis = out_contribs->DeviceSpan();
 
-    dh::device_vector<gpu_treeshap::PathElement<ShapSplitCondition>>
-        device_paths;
-    DeviceModel d_model;
-    d_model.Init(model, 0, tree_end, generic_param_->gpu_id);
-    dh::device_vector<uint32_t> categories;
-    ExtractPaths(&device_paths, &d_model, &categories, generic_param_->gpu_id);
+    std::lock_guard<std::mutex> guard{shap_paths_lock_};
+    shap_paths_.Update(model, tree_end, generic_param_->gpu_id);
+    auto const& device_paths = shap_paths_.paths;
     for (auto& batch : p_fmat->GetBatches<SparsePage>()) {
       batch.data.SetDevice(generic_param_->gpu_id);
       batch.offset.SetDevice(generic_param_->gpu_id);
@@ -896,12 +1384,9 @@ class GPUPredictor : public xgboost::Predictor {
     out_contribs->Fill(0.0f);
     auto phis = out_contribs->DeviceSpan();
 
-    dh::device_vector<gpu_treeshap::PathElement<ShapSplitCondition>>
-        device_paths;
-    DeviceModel d_model;
-    d_model.Init(model, 0, tree_end, generic_param_->gpu_id);
-    dh::device_vector<uint32_t> categories;
-    ExtractPaths(&device_paths, &d_model, &categories, generic_param_->gpu_id);
+    std::lock_guard<std::mutex> guard{shap_paths_lock_};
+    shap_paths_.Update(model, tree_end, generic_param_->gpu_id);
+    auto const& device_paths = shap_paths_.paths;
     for (auto& batch : p_fmat->GetBatches<SparsePage>()) {
       batch.data.SetDevice(generic_param_->gpu_id);
       batch.offset.SetDevice(generic_param_->gpu_id);
@@ -1010,9 +1495,22 @@ class GPUPredictor : public xgboost::Predictor {
 
   void Configure(const std::vector<std::pair<std::string, std::string>>& cfg) override {
     Predictor::Configure(cfg);
+    for (auto const& kv : cfg) {
+      if (kv.first == "predictor_devices") {
+        n_devices_ = std::stoi(kv.second);
+        CHECK(n_devices_ > 0 || n_devices_ == -1) << "`predictor_devices` must be positive or -1.";
+      }
+    }
   }
 
  private:
+  // Number of devices used for predicting a DMatrix, -1 for all visible devices.
+  int32_t n_devices_{1};
+  // Paths extracted for SHAP values, guarded by the lock as prediction is const.
+  mutable ShapPathCache shap_paths_;
+  mutable std::mutex shap_paths_lock_;
+  mutable StagingPool staging_;
+
   /*! \brief Reconfigure the device when GPU is changed. */
   static size_t ConfigureDevice(int device) {
     if (device >= 0) {
@@ -8,9 +8,9 @@
 
 namespace xgboost {
 namespace predictor {
-template <bool has_missing, bool has_categorical>
+template <bool has_missing, bool has_categorical, typename NodeT>
 inline XGBOOST_DEVICE bst_node_t
-GetNextNode(const RegTree::Node &node, const bst_node_t nid, float fvalue,
+GetNextNode(const NodeT &node, const bst_node_t nid, float fvalue,
             bool is_missing, RegTree::CategoricalSplitMatrix const &cats) {
   if (has_missing && is_missing) {
     return node.DefaultChild();
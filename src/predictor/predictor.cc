@@ -2,12 +2,15 @@
  * Copyright 2017-2021 by Contributors
  */
 #include <dmlc/registry.h>
+#include <algorithm>
+#include <limits>
 #include <mutex>
 
 #include "xgboost/predictor.h"
 #include "xgboost/data.h"
 #include "xgboost/generic_parameters.h"
 
+#include "../common/memory_tracker.h"
 #include "../gbm/gbtree.h"
 
 namespace dmlc {
@@ -15,6 +18,19 @@ DMLC_REGISTRY_ENABLE(::xgboost::PredictorReg);
 }  // namespace dmlc
 
 namespace xgboost {
+PredictionContainer::PredictionContainer()
+    : tracked_{new common::TrackedBytes{common::MemoryTracker::kPredictionCache}} {}
+
+PredictionContainer::~PredictionContainer() = default;
+
+void PredictionContainer::Track() {
+  size_t bytes = 0;
+  for (auto const& kv : container_) {
+    bytes += kv.second.predictions.Size() * sizeof(bst_float);
+  }
+  tracked_->Update(bytes);
+}
+
 void PredictionContainer::ClearExpiredEntries() {
   std::vector<DMatrix*> expired;
   for (auto& kv : container_) {
@@ -25,6 +41,7 @@ void PredictionContainer::ClearExpiredEntries() {
   for (auto const& ptr : expired) {
     container_.erase(ptr);
   }
+  this->Track();
 }
 
 PredictionCacheEntry &PredictionContainer::Cache(std::shared_ptr<DMatrix> m, int32_t device) {
@@ -40,6 +57,7 @@ PredictionCacheEntry &PredictionContainer::Entry(DMatrix *m) {
   CHECK(container_.find(m) != container_.cend());
   CHECK(container_.at(m).ref.lock())
       << "[Internal error]: DMatrix: " << m << " has expired.";
+  this->Track();
   return container_.at(m);
 }
 
@@ -61,6 +79,74 @@ Predictor* Predictor::Create(
   return p_predictor;
 }
 
+LeafOrdinals::LeafOrdinals(gbm::GBTreeModel const& model, uint32_t tree_end) {
+  if (tree_end == 0 || tree_end > model.trees.size()) {
+    tree_end = static_cast<uint32_t>(model.trees.size());
+  }
+  node_ptr_.resize(tree_end + 1, 0);
+  column_ptr_.resize(tree_end + 1, 0);
+  for (uint32_t tree_id = 0; tree_id < tree_end; ++tree_id) {
+    auto const& nodes = model.trees[tree_id]->GetNodes();
+    node_ptr_[tree_id + 1] = node_ptr_[tree_id] + nodes.size();
+    uint32_t n_leaves = 0;
+    for (auto const& node : nodes) {
+      ordinals_.push_back(node.IsLeaf() && !node.IsDeleted() ? n_leaves++ : 0);
+    }
+    column_ptr_[tree_id + 1] = column_ptr_[tree_id] + n_leaves;
+    max_leaves_ = std::max(max_leaves_, static_cast<size_t>(n_leaves));
+  }
+}
+
+void LeafOrdinals::CheckOutput(size_t n_rows, size_t out_size, uint64_t max_value,
+                               bool one_hot) const {
+  CHECK_EQ(out_size, n_rows * this->NumTrees())
+      << "Output of leaf prediction should have (n_samples, n_trees) elements.";
+  if (one_hot) {
+    CHECK_LE(this->NumColumns(), max_value + 1)
+        << "Too many leaves in the model for one-hot leaf prediction.";
+  } else {
+    CHECK_LE(this->MaxLeaves(), max_value + 1)
+        << "Too many leaves in a tree for the type of leaf prediction output.";
+  }
+}
+
+namespace {
+// Fallback of compact leaf prediction for predictors without their own implementation.
+template <typename T>
+void PredictLeafCompact(Predictor const* predictor, DMatrix* dmat, common::Span<T> out,
+                        gbm::GBTreeModel const& model, uint32_t tree_end, bool one_hot) {
+  LeafOrdinals ordinals{model, tree_end};
+  ordinals.CheckOutput(dmat->Info().num_row_, out.size(), std::numeric_limits<T>::max(),
+                       one_hot);
+  HostDeviceVector<bst_float> leaves;
+  predictor->PredictLeaf(dmat, &leaves, model, ordinals.NumTrees());
+  auto const& h_leaves = leaves.ConstHostVector();
+  CHECK_EQ(h_leaves.size(), out.size());
+  auto n_trees = ordinals.NumTrees();
+  for (size_t i = 0; i < h_leaves.size(); ++i) {
+    auto tree_id = static_cast<uint32_t>(i % n_trees);
+    auto nidx = static_cast<bst_node_t>(h_leaves[i]);
+    out[i] = static_cast<T>(one_hot ? ordinals.Column(tree_id, nidx)
+                                    : ordinals.Ordinal(tree_id, nidx));
+  }
+}
+}  // anonymous namespace
+
+void Predictor::PredictLeafOrdinal(DMatrix* dmat, common::Span<std::uint8_t> out,
+                                   const gbm::GBTreeModel& model, unsigned tree_end) const {
+  PredictLeafCompact(this, dmat, out, model, tree_end, false);
+}
+
+void Predictor::PredictLeafOrdinal(DMatrix* dmat, common::Span<std::uint16_t> out,
+                                   const gbm::GBTreeModel& model, unsigned tree_end) const {
+  PredictLeafCompact(this, dmat, out, model, tree_end, false);
+}
+
+void Predictor::PredictLeafOneHot(DMatrix* dmat, common::Span<std::uint32_t> out_indices,
+                                  const gbm::GBTreeModel& model, unsigned tree_end) const {
+  PredictLeafCompact(this, dmat, out_indices, model, tree_end, true);
+}
+
 template <int32_t D>
 void ValidateBaseMarginShape(linalg::Tensor<float, D> const& margin, bst_row_t n_samples,
                              bst_group_t n_groups) {
@@ -102,5 +188,7 @@ namespace predictor {
 DMLC_REGISTRY_LINK_TAG(gpu_predictor);
 #endif  // XGBOOST_USE_CUDA
 DMLC_REGISTRY_LINK_TAG(cpu_predictor);
+DMLC_REGISTRY_LINK_TAG(quickscorer_predictor);
+DMLC_REGISTRY_LINK_TAG(compiled_predictor);
 }  // namespace predictor
 }  // namespace xgboost
@@ -0,0 +1,320 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ *
+ * \brief Predictor for forests of shallow trees based on the QuickScorer algorithm.
+ *
+ *   Instead of traversing each tree node by node, QuickScorer visits each feature once per
+ *   row and marks all split nodes evaluated to false (going right) with pre-computed
+ *   bitvectors.  The exit leaf of each tree is then the left most leaf that is still
+ *   reachable.  See: Lucchese et al. "QuickScorer: A Fast Algorithm to Rank Documents with
+ *   Additive Ensembles of Regression Trees".
+ */
+#include <dmlc/omp.h>
+#include <dmlc/any.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/logging.h"
+#include "xgboost/predictor.h"
+#include "xgboost/tree_model.h"
+
+#include "../common/annotation.h"
+#include "../common/threading_utils.h"
+#include "../gbm/gbtree_model.h"
+
+namespace xgboost {
+namespace predictor {
+
+DMLC_REGISTRY_FILE_TAG(quickscorer_predictor);
+
+namespace {
+inline uint32_t CountTrailingZeros(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(v);
+#else
+  uint32_t n = 0;
+  for (; (v & 1) == 0; v >>= 1) n++;
+  return n;
+#endif  // defined(__GNUC__) || defined(__clang__)
+}
+
+/**
+ * \brief Bitvector representation of a forest, each tree can have at most 64 leaves.
+ */
+class QuickScorerForest {
+  struct FalseNode {
+    float threshold;
+    uint32_t tree;
+    uint64_t mask;
+  };
+
+  // Split nodes grouped by feature, sorted by threshold.
+  std::vector<float> thresholds_;
+  std::vector<uint32_t> trees_;
+  std::vector<uint64_t> masks_;
+  std::vector<size_t> feature_ptr_;
+  // Split nodes with missing value going right, grouped by feature.
+  std::vector<uint32_t> missing_trees_;
+  std::vector<uint64_t> missing_masks_;
+  std::vector<size_t> missing_ptr_;
+  // Leaf values of each tree in left to right order.
+  std::vector<float> leaf_values_;
+  std::vector<size_t> leaf_ptr_;
+
+  size_t n_trees_{0};
+  uint64_t generation_{0};
+  bool supported_{true};
+
+  /**
+   * \brief Assign leaves in left to right order and collect masks for split nodes.
+   *
+   * \return Number of leaves under nidx.
+   */
+  uint32_t Build(RegTree const &tree, bst_node_t nidx, uint32_t tree_idx, uint32_t first_leaf,
+                 std::vector<std::vector<FalseNode>> *nodes,
+                 std::vector<std::vector<FalseNode>> *missing) {
+    auto const &node = tree[nidx];
+    if (node.IsLeaf()) {
+      leaf_values_.push_back(node.LeafValue());
+      return 1;
+    }
+    uint32_t n_left =
+        this->Build(tree, node.LeftChild(), tree_idx, first_leaf, nodes, missing);
+    uint32_t n_right =
+        this->Build(tree, node.RightChild(), tree_idx, first_leaf + n_left, nodes, missing);
+    if (first_leaf + n_left + n_right > 64) {
+      supported_ = false;
+      return n_left + n_right;
+    }
+    // Leaves in the left subtree can not be reached when the node goes right.
+    uint64_t left_leaves = n_left == 64 ? ~uint64_t{0} : ((uint64_t{1} << n_left) - 1);
+    uint64_t mask = ~(left_leaves << first_leaf);
+    auto fidx = node.SplitIndex();
+    (*nodes)[fidx].push_back({node.SplitCond(), tree_idx, mask});
+    if (!node.DefaultLeft()) {
+      (*missing)[fidx].push_back({node.SplitCond(), tree_idx, mask});
+    }
+    return n_left + n_right;
+  }
+
+ public:
+  explicit QuickScorerForest(gbm::GBTreeModel const &model)
+      : n_trees_{model.trees.size()}, generation_{model.Generation()} {
+    bst_feature_t n_features = model.learner_model_param->num_feature;
+    std::vector<std::vector<FalseNode>> nodes(n_features);
+    std::vector<std::vector<FalseNode>> missing(n_features);
+    leaf_ptr_.push_back(0);
+    for (size_t i = 0; i < model.trees.size() && supported_; ++i) {
+      auto const &tree = *model.trees[i];
+      if (tree.HasCategoricalSplit()) {
+        supported_ = false;
+        break;
+      }
+      this->Build(tree, RegTree::kRoot, static_cast<uint32_t>(i), 0, &nodes, &missing);
+      leaf_ptr_.push_back(leaf_values_.size());
+    }
+    if (!supported_) {
+      return;
+    }
+
+    feature_ptr_.push_back(0);
+    missing_ptr_.push_back(0);
+    for (bst_feature_t f = 0; f < n_features; ++f) {
+      auto &feature_nodes = nodes[f];
+      std::stable_sort(feature_nodes.begin(), feature_nodes.end(),
+                       [](FalseNode const &l, FalseNode const &r) {
+                         return l.threshold < r.threshold;
+                       });
+      for (auto const &n : feature_nodes) {
+        thresholds_.push_back(n.threshold);
+        trees_.push_back(n.tree);
+        masks_.push_back(n.mask);
+      }
+      feature_ptr_.push_back(thresholds_.size());
+      for (auto const &n : missing[f]) {
+        missing_trees_.push_back(n.tree);
+        missing_masks_.push_back(n.mask);
+      }
+      missing_ptr_.push_back(missing_trees_.size());
+    }
+  }
+
+  /*! \brief Whether the model can be represented with 64 bits leaf bitvectors. */
+  bool Supported() const { return supported_; }
+  size_t Size() const { return n_trees_; }
+  uint64_t Generation() const { return generation_; }
+
+  /**
+   * \brief Compute the exit leaf value of every tree for one row.
+   *
+   * \param feat      Dense feature vector of the row.
+   * \param leaves    Output bitvector for each tree, used as workspace.
+   */
+  void Score(RegTree::FVec const &feat, common::Span<uint64_t> leaves) const {
+    std::fill(leaves.begin(), leaves.end(), ~uint64_t{0});
+    for (size_t f = 0; f + 1 < feature_ptr_.size(); ++f) {
+      if (feat.IsMissing(f)) {
+        for (size_t k = missing_ptr_[f]; k < missing_ptr_[f + 1]; ++k) {
+          leaves[missing_trees_[k]] &= missing_masks_[k];
+        }
+        continue;
+      }
+      auto fvalue = feat.GetFvalue(f);
+      // Nodes with x >= threshold go right.
+      for (size_t k = feature_ptr_[f]; k < feature_ptr_[f + 1] && thresholds_[k] <= fvalue;
+           ++k) {
+        leaves[trees_[k]] &= masks_[k];
+      }
+    }
+  }
+
+  float LeafValue(size_t tree_idx, uint64_t leaves) const {
+    // The right most leaf is never masked out, so there's always at least 1 bit set.
+    return leaf_values_[leaf_ptr_[tree_idx] + CountTrailingZeros(leaves)];
+  }
+};
+}  // anonymous namespace
+
+class QuickScorerPredictor : public Predictor {
+  std::unique_ptr<Predictor> cpu_predictor_;
+  mutable std::mutex forest_lock_;
+  mutable std::shared_ptr<QuickScorerForest const> forest_;
+
+  std::shared_ptr<QuickScorerForest const> GetForest(gbm::GBTreeModel const &model) const {
+    std::lock_guard<std::mutex> guard{forest_lock_};
+    if (!forest_ || forest_->Generation() != model.Generation() ||
+        forest_->Size() != model.trees.size()) {
+      forest_ = std::make_shared<QuickScorerForest const>(model);
+      if (!forest_->Supported()) {
+        LOG(WARNING) << "Model contains categorical split or tree with more than 64 leaves, "
+                        "falling back to `cpu_predictor`.";
+      }
+    }
+    return forest_;
+  }
+
+  void PredictDMatrix(DMatrix *p_fmat, std::vector<bst_float> *out_preds,
+                      gbm::GBTreeModel const &model, QuickScorerForest const &forest,
+                      uint32_t tree_begin, uint32_t tree_end) const {
+    auto const n_threads = omp_get_max_threads();
+    auto const num_group = model.learner_model_param->num_output_group;
+    auto const num_feature = model.learner_model_param->num_feature;
+    CHECK_EQ(out_preds->size(), p_fmat->Info().num_row_ * num_group);
+
+    std::vector<RegTree::FVec> feat_vecs(n_threads);
+    std::vector<uint64_t> workspace(n_threads * forest.Size());
+    auto &preds = *out_preds;
+    for (auto const &batch : p_fmat->GetBatches<SparsePage>()) {
+      auto page = batch.GetView();
+      common::ParallelFor(static_cast<bst_omp_uint>(batch.Size()), n_threads,
+                          [&](bst_omp_uint i) {
+        auto tid = common::ThreadIdx();
+        auto &feats = feat_vecs[tid];
+        if (feats.Size() == 0) {
+          feats.Init(num_feature);
+        }
+        common::Span<uint64_t> leaves{workspace.data() + tid * forest.Size(), forest.Size()};
+        auto inst = page[i];
+        feats.Fill(inst);
+        forest.Score(feats, leaves);
+        feats.Drop(inst);
+        auto row_idx = batch.base_rowid + i;
+        for (uint32_t tree_idx = tree_begin; tree_idx < tree_end; ++tree_idx) {
+          auto gid = model.tree_info[tree_idx];
+          preds[row_idx * num_group + gid] += forest.LeafValue(tree_idx, leaves[tree_idx]);
+        }
+      });
+    }
+  }
+
+ public:
+  explicit QuickScorerPredictor(GenericParameter const *generic_param)
+      : Predictor::Predictor{generic_param},
+        cpu_predictor_{Predictor::Create("cpu_predictor", generic_param)} {}
+
+  void Configure(const std::vector<std::pair<std::string, std::string>> &cfg) override {
+    Predictor::Configure(cfg);
+    cpu_predictor_->Configure(cfg);
+  }
+
+  void PredictBatch(DMatrix *dmat, PredictionCacheEntry *predts,
+                    const gbm::GBTreeModel &model, uint32_t tree_begin,
+                    uint32_t tree_end = 0) const override {
+    XGBOOST_ANNOTATE_SCOPE("xgboost::QuickScorerPredictor::PredictBatch");
+    if (tree_end == 0) {
+      tree_end = model.trees.size();
+    }
+    auto forest = this->GetForest(model);
+    if (!forest->Supported()) {
+      cpu_predictor_->PredictBatch(dmat, predts, model, tree_begin, tree_end);
+      return;
+    }
+    this->PredictDMatrix(dmat, &predts->predictions.HostVector(), model, *forest,
+                         tree_begin, tree_end);
+  }
+
+  bool InplacePredict(dmlc::any const &x, std::shared_ptr<DMatrix> p_m,
+                      const gbm::GBTreeModel &model, float missing,
+                      PredictionCacheEntry *out_preds, uint32_t tree_begin,
+                      unsigned tree_end) const override {
+    return cpu_predictor_->InplacePredict(x, p_m, model, missing, out_preds, tree_begin,
+                                          tree_end);
+  }
+
+  void PredictInstance(const SparsePage::Inst &inst, std::vector<bst_float> *out_preds,
+                       const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictInstance(inst, out_preds, model, ntree_limit);
+  }
+
+  void PredictLeaf(DMatrix *p_fmat, HostDeviceVector<bst_float> *out_preds,
+                   const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeaf(p_fmat, out_preds, model, ntree_limit);
+  }
+
+  void PredictLeafOrdinal(DMatrix *p_fmat, common::Span<std::uint8_t> out,
+                          const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeafOrdinal(p_fmat, out, model, ntree_limit);
+  }
+
+  void PredictLeafOrdinal(DMatrix *p_fmat, common::Span<std::uint16_t> out,
+                          const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeafOrdinal(p_fmat, out, model, ntree_limit);
+  }
+
+  void PredictLeafOneHot(DMatrix *p_fmat, common::Span<std::uint32_t> out_indices,
+                         const gbm::GBTreeModel &model, unsigned ntree_limit) const override {
+    cpu_predictor_->PredictLeafOneHot(p_fmat, out_indices, model, ntree_limit);
+  }
+
+  void PredictContribution(DMatrix *p_fmat, HostDeviceVector<float> *out_contribs,
+                           const gbm::GBTreeModel &model, uint32_t ntree_limit,
+                           std::vector<bst_float> const *tree_weights, bool approximate,
+                           int condition, unsigned condition_feature) const override {
+    cpu_predictor_->PredictContribution(p_fmat, out_contribs, model, ntree_limit,
+                                        tree_weights, approximate, condition,
+                                        condition_feature);
+  }
+
+  void PredictInteractionContributions(DMatrix *p_fmat, HostDeviceVector<bst_float> *out_contribs,
+                                       const gbm::GBTreeModel &model, unsigned ntree_limit,
+                                       std::vector<bst_float> const *tree_weights,
+                                       bool approximate) const override {
+    cpu_predictor_->PredictInteractionContributions(p_fmat, out_contribs, model, ntree_limit,
+                                                    tree_weights, approximate);
+  }
+};
+
+XGBOOST_REGISTER_PREDICTOR(QuickScorerPredictor, "quickscorer_predictor")
+.describe("Make predictions for forests of shallow trees using QuickScorer algorithm.")
+.set_body([](GenericParameter const* generic_param) {
+            return new QuickScorerPredictor(generic_param);
+          });
+}  // namespace predictor
+}  // namespace xgboost
@@ -0,0 +1,81 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file row_cache.cc
+ */
+#include "row_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace xgboost {
+namespace predictor {
+namespace {
+uint64_t Mix(uint64_t h, uint64_t v) {
+  h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+  h *= 0xFF51AFD7ED558CCDULL;
+  return h ^ (h >> 33);
+}
+
+uint32_t Bits(float v) {
+  uint32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+}  // anonymous namespace
+
+bool RowPredictionCache::Key::operator==(Key const& that) const {
+  auto entry_eq = [](Entry const& l, Entry const& r) {
+    return l.index == r.index && Bits(l.fvalue) == Bits(r.fvalue);
+  };
+  auto value_eq = [](float l, float r) { return Bits(l) == Bits(r); };
+  return generation == that.generation && tree_begin == that.tree_begin &&
+         tree_end == that.tree_end && row.size() == that.row.size() &&
+         init.size() == that.init.size() &&
+         std::equal(row.cbegin(), row.cend(), that.row.cbegin(), entry_eq) &&
+         std::equal(init.cbegin(), init.cend(), that.init.cbegin(), value_eq);
+}
+
+uint64_t RowPredictionCache::Hash(Key const& key) {
+  uint64_t h = Mix(key.generation, (static_cast<uint64_t>(key.tree_begin) << 32) | key.tree_end);
+  for (auto const& e : key.row) {
+    h = Mix(h, (static_cast<uint64_t>(e.index) << 32) | Bits(e.fvalue));
+  }
+  for (auto v : key.init) {
+    h = Mix(h, Bits(v));
+  }
+  return h;
+}
+
+bool RowPredictionCache::Get(uint64_t hash, Key const& key, common::Span<float> out) {
+  std::lock_guard<std::mutex> guard{lock_};
+  auto it = index_.find(hash);
+  if (it == index_.cend() || !(it->second->key == key)) {
+    return false;
+  }
+  items_.splice(items_.begin(), items_, it->second);
+  auto const& predt = it->second->predt;
+  CHECK_EQ(predt.size(), out.size());
+  std::copy(predt.cbegin(), predt.cend(), out.begin());
+  return true;
+}
+
+void RowPredictionCache::Put(uint64_t hash, Key key, common::Span<float const> predt) {
+  if (capacity_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard{lock_};
+  auto it = index_.find(hash);
+  if (it != index_.cend()) {
+    // Same key inserted by another thread, or a collision replacing the old item.
+    items_.erase(it->second);
+    index_.erase(it);
+  } else if (items_.size() == capacity_) {
+    index_.erase(items_.back().hash);
+    items_.pop_back();
+  }
+  items_.push_front(Item{hash, std::move(key), {predt.cbegin(), predt.cend()}});
+  index_[hash] = items_.begin();
+}
+}  // namespace predictor
+}  // namespace xgboost
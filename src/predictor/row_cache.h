@@ -0,0 +1,77 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file row_cache.h
+ * \brief Bounded cache of prediction results for repeated rows in serving.
+ */
+#ifndef XGBOOST_PREDICTOR_ROW_CACHE_H_
+#define XGBOOST_PREDICTOR_ROW_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/logging.h"
+#include "xgboost/span.h"
+
+namespace xgboost {
+namespace predictor {
+/**
+ * \brief Least recently used cache of predictions keyed by the non-missing entries of a
+ *        row, the range of trees and the generation of the model.
+ *
+ *   The initial values of outputs (base score or base margin) are part of the key, so
+ *   cached results are exactly the same as computed ones.  Keys are compared in full,
+ *   hash collisions are treated as misses.  Thread-safe.
+ */
+class RowPredictionCache {
+ public:
+  struct Key {
+    uint64_t generation{0};
+    uint32_t tree_begin{0};
+    uint32_t tree_end{0};
+    std::vector<Entry> row;
+    std::vector<float> init;
+
+    bool operator==(Key const& that) const;
+  };
+
+ private:
+  struct Item {
+    uint64_t hash;
+    Key key;
+    std::vector<float> predt;
+  };
+
+  size_t capacity_;
+  std::mutex lock_;
+  // Most recently used items first.
+  std::list<Item> items_;
+  std::unordered_map<uint64_t, std::list<Item>::iterator> index_;
+
+ public:
+  explicit RowPredictionCache(size_t capacity) : capacity_{capacity} {}
+
+  size_t Capacity() const { return capacity_; }
+  size_t Size() {
+    std::lock_guard<std::mutex> guard{lock_};
+    return items_.size();
+  }
+
+  static uint64_t Hash(Key const& key);
+  /**
+   * \brief Copy cached predictions of the key into `out`.
+   *
+   * \return Whether the key is found.
+   */
+  bool Get(uint64_t hash, Key const& key, common::Span<float> out);
+  /*! \brief Insert predictions of the key, evicting the least recently used item if full. */
+  void Put(uint64_t hash, Key key, common::Span<float const> predt);
+};
+}  // namespace predictor
+}  // namespace xgboost
+#endif  // XGBOOST_PREDICTOR_ROW_CACHE_H_
@@ -0,0 +1,231 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "simd_traversal.h"
+
+#include "xgboost/logging.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XGBOOST_SIMD_TRAVERSAL 1
+#else
+#define XGBOOST_SIMD_TRAVERSAL 0
+#endif  // defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define XGBOOST_NEON_TRAVERSAL 1
+#else
+#define XGBOOST_NEON_TRAVERSAL 0
+#endif  // defined(__aarch64__) && defined(__ARM_NEON)
+
+namespace xgboost {
+namespace predictor {
+namespace {
+static_assert(sizeof(FlatNode) == 4 * sizeof(int32_t),
+              "SIMD traversal gathers FlatNode as 4 packed 32 bit integers.");
+// Offsets of fields in FlatNode, in unit of 32 bit integer.
+constexpr int32_t kCondOffset = 0;
+constexpr int32_t kSIndexOffset = 1;
+constexpr int32_t kLeftOffset = 2;
+
+#if XGBOOST_SIMD_TRAVERSAL
+__attribute__((target("avx2")))
+void TraverseAVX2(FlatNode const* tree, float const* leaf_values, float const* fvalues,
+                  int32_t stride, float* out) {
+  auto const* base = reinterpret_cast<int32_t const*>(tree);
+  __m256i const row_offset = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                _mm256_set1_epi32(stride));
+  __m256i const all_ones = _mm256_set1_epi32(-1);
+  __m256i const one = _mm256_set1_epi32(1);
+  __m256i const fidx_mask = _mm256_set1_epi32((1U << 31) - 1U);
+
+  __m256i pos = _mm256_setzero_si256();
+  __m256i node = _mm256_setzero_si256();
+  while (true) {
+    // 4 integers per node.
+    node = _mm256_slli_epi32(pos, 2);
+    __m256i left = _mm256_i32gather_epi32(base + kLeftOffset, node, 4);
+    // Lanes that haven't reached leaf yet.
+    __m256i active = _mm256_xor_si256(_mm256_cmpeq_epi32(left, all_ones), all_ones);
+    if (_mm256_testz_si256(active, active)) {
+      break;
+    }
+    __m256i sindex = _mm256_i32gather_epi32(base + kSIndexOffset, node, 4);
+    __m256 cond =
+        _mm256_i32gather_ps(reinterpret_cast<float const*>(base + kCondOffset), node, 4);
+    __m256i fidx = _mm256_add_epi32(row_offset, _mm256_and_si256(sindex, fidx_mask));
+    __m256 fvalue = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), fvalues, fidx,
+                                             _mm256_castsi256_ps(active), 4);
+    __m256 missing = _mm256_cmp_ps(fvalue, fvalue, _CMP_UNORD_Q);
+    __m256 lt = _mm256_cmp_ps(fvalue, cond, _CMP_LT_OQ);
+    // Highest bit of sindex is the default direction.
+    __m256 default_left = _mm256_castsi256_ps(_mm256_srai_epi32(sindex, 31));
+    __m256 go_left = _mm256_blendv_ps(lt, default_left, missing);
+    __m256i next = _mm256_add_epi32(left, _mm256_andnot_si256(_mm256_castps_si256(go_left), one));
+    pos = _mm256_blendv_epi8(pos, next, active);
+  }
+  __m256i leaf = _mm256_i32gather_epi32(base + kSIndexOffset, node, 4);
+  _mm256_storeu_ps(out, _mm256_i32gather_ps(leaf_values, leaf, 4));
+}
+
+__attribute__((target("avx512f")))
+void TraverseAVX512(FlatNode const* tree, float const* leaf_values, float const* fvalues,
+                    int32_t stride, float* out) {
+  auto const* base = reinterpret_cast<int32_t const*>(tree);
+  __m512i const row_offset = _mm512_mullo_epi32(
+      _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+      _mm512_set1_epi32(stride));
+  __m512i const all_ones = _mm512_set1_epi32(-1);
+  __m512i const one = _mm512_set1_epi32(1);
+  __m512i const fidx_mask = _mm512_set1_epi32((1U << 31) - 1U);
+  __m512i const default_left_bit = _mm512_set1_epi32(1U << 31);
+
+  __m512i pos = _mm512_setzero_si512();
+  __m512i node = _mm512_setzero_si512();
+  while (true) {
+    node = _mm512_slli_epi32(pos, 2);
+    __m512i left = _mm512_i32gather_epi32(node, base + kLeftOffset, 4);
+    __mmask16 active = _mm512_cmpneq_epi32_mask(left, all_ones);
+    if (active == 0) {
+      break;
+    }
+    __m512i sindex =
+        _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), active, node, base + kSIndexOffset, 4);
+    __m512 cond = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), active, node,
+                                           base + kCondOffset, 4);
+    __m512i fidx = _mm512_add_epi32(row_offset, _mm512_and_si512(sindex, fidx_mask));
+    __m512 fvalue = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), active, fidx, fvalues, 4);
+    __mmask16 missing = _mm512_cmp_ps_mask(fvalue, fvalue, _CMP_UNORD_Q);
+    __mmask16 lt = _mm512_cmp_ps_mask(fvalue, cond, _CMP_LT_OQ);
+    __mmask16 default_left = _mm512_test_epi32_mask(sindex, default_left_bit);
+    __mmask16 go_right = ~((missing & default_left) | (~missing & lt));
+    __m512i next = _mm512_mask_add_epi32(left, go_right, left, one);
+    pos = _mm512_mask_mov_epi32(pos, active, next);
+  }
+  __m512i leaf = _mm512_i32gather_epi32(node, base + kSIndexOffset, 4);
+  _mm512_storeu_ps(out, _mm512_i32gather_ps(leaf, leaf_values, 4));
+}
+#endif  // XGBOOST_SIMD_TRAVERSAL
+
+#if XGBOOST_NEON_TRAVERSAL
+// Rows traversed by a group of NEON lanes.
+constexpr int32_t kNeonLanes = 4;
+// Groups traversed together, so loads of independent rows are in flight at the same time.
+constexpr int32_t kNeonGroups = 2;
+
+/**
+ * \brief Advance 4 rows by one level.  NEON has no gather, each node is loaded with a single
+ *        128 bit load and fields are separated by transposing the 4 nodes.
+ *
+ * \return Whether any of the rows hasn't reached leaf yet.
+ */
+inline bool StepNEON(int32_t const* base, float const* fvalues, int32x4_t row_offset,
+                     int32x4_t* p_pos) {
+  int32x4_t pos = *p_pos;
+  int32x4_t n0 = vld1q_s32(base + 4 * vgetq_lane_s32(pos, 0));
+  int32x4_t n1 = vld1q_s32(base + 4 * vgetq_lane_s32(pos, 1));
+  int32x4_t n2 = vld1q_s32(base + 4 * vgetq_lane_s32(pos, 2));
+  int32x4_t n3 = vld1q_s32(base + 4 * vgetq_lane_s32(pos, 3));
+  // {cond, sindex, left, nidx} of each node into {cond_0, cond_1, left_0, left_1} and
+  // {sindex_0, sindex_1, nidx_0, nidx_1}.
+  int32x4x2_t t01 = vtrnq_s32(n0, n1);
+  int32x4x2_t t23 = vtrnq_s32(n2, n3);
+  static_assert(kCondOffset == 0 && kSIndexOffset == 1 && kLeftOffset == 2,
+                "Unexpected layout of FlatNode.");
+  int32x4_t left = vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0]));
+  uint32x4_t active = vmvnq_u32(vceqq_s32(left, vdupq_n_s32(-1)));
+  if (vmaxvq_u32(active) == 0) {
+    return false;
+  }
+  float32x4_t cond = vreinterpretq_f32_s32(
+      vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0])));
+  int32x4_t sindex = vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1]));
+  // Leaf index of finished rows is not a feature, their first feature is loaded instead.
+  int32x4_t fidx = vaddq_s32(
+      row_offset, vandq_s32(sindex, vreinterpretq_s32_u32(
+                                        vandq_u32(active, vdupq_n_u32((1U << 31) - 1U)))));
+  float32x4_t fvalue = vdupq_n_f32(0.0f);
+  fvalue = vld1q_lane_f32(fvalues + vgetq_lane_s32(fidx, 0), fvalue, 0);
+  fvalue = vld1q_lane_f32(fvalues + vgetq_lane_s32(fidx, 1), fvalue, 1);
+  fvalue = vld1q_lane_f32(fvalues + vgetq_lane_s32(fidx, 2), fvalue, 2);
+  fvalue = vld1q_lane_f32(fvalues + vgetq_lane_s32(fidx, 3), fvalue, 3);
+  uint32x4_t missing = vmvnq_u32(vceqq_f32(fvalue, fvalue));
+  uint32x4_t lt = vcltq_f32(fvalue, cond);
+  // Highest bit of sindex is the default direction.
+  uint32x4_t default_left = vreinterpretq_u32_s32(vshrq_n_s32(sindex, 31));
+  uint32x4_t go_left = vbslq_u32(missing, default_left, lt);
+  // go_left is -1 for the left child and 0 for the right child.
+  int32x4_t next = vaddq_s32(vaddq_s32(left, vdupq_n_s32(1)), vreinterpretq_s32_u32(go_left));
+  *p_pos = vbslq_s32(active, next, pos);
+  return true;
+}
+
+void TraverseNEON(FlatNode const* tree, float const* leaf_values, float const* fvalues,
+                  int32_t stride, float* out) {
+  auto const* base = reinterpret_cast<int32_t const*>(tree);
+  int32_t const offsets[kNeonLanes]{0, stride, 2 * stride, 3 * stride};
+  int32x4_t const row_offset = vld1q_s32(offsets);
+  int32x4_t const group_offset = vdupq_n_s32(kNeonLanes * stride);
+
+  int32x4_t pos[kNeonGroups]{vdupq_n_s32(0), vdupq_n_s32(0)};
+  int32x4_t group_rows[kNeonGroups]{row_offset, vaddq_s32(row_offset, group_offset)};
+  bool active = true;
+  while (active) {
+    active = false;
+    for (int32_t g = 0; g < kNeonGroups; ++g) {
+      active |= StepNEON(base, fvalues, group_rows[g], &pos[g]);
+    }
+  }
+  int32_t leaves[kNeonLanes * kNeonGroups];
+  for (int32_t g = 0; g < kNeonGroups; ++g) {
+    vst1q_s32(leaves + g * kNeonLanes, pos[g]);
+  }
+  for (int32_t k = 0; k < kNeonLanes * kNeonGroups; ++k) {
+    out[k] = leaf_values[tree[leaves[k]].LeafIndex()];
+  }
+}
+#endif  // XGBOOST_NEON_TRAVERSAL
+
+int32_t DetectWidth() {
+#if XGBOOST_SIMD_TRAVERSAL
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return 16;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return 8;
+  }
+#elif XGBOOST_NEON_TRAVERSAL
+  return kNeonLanes * kNeonGroups;
+#endif  // XGBOOST_SIMD_TRAVERSAL
+  return 0;
+}
+}  // anonymous namespace
+
+int32_t SimdTraversalWidth() {
+  static int32_t const width = DetectWidth();
+  return width;
+}
+
+void SimdTraverse(FlatNode const* tree, float const* leaf_values, float const* fvalues,
+                  int32_t stride, float* out) {
+#if XGBOOST_SIMD_TRAVERSAL
+  switch (SimdTraversalWidth()) {
+    case 16:
+      TraverseAVX512(tree, leaf_values, fvalues, stride, out);
+      return;
+    case 8:
+      TraverseAVX2(tree, leaf_values, fvalues, stride, out);
+      return;
+    default:
+      break;
+  }
+#elif XGBOOST_NEON_TRAVERSAL
+  TraverseNEON(tree, leaf_values, fvalues, stride, out);
+  return;
+#endif  // XGBOOST_SIMD_TRAVERSAL
+  LOG(FATAL) << "SIMD traversal is not supported on current CPU.";
+}
+}  // namespace predictor
+}  // namespace xgboost
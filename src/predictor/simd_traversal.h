@@ -0,0 +1,37 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file simd_traversal.h
+ * \brief Traverse multiple rows through the same flattened tree with SIMD instructions.
+ */
+#ifndef XGBOOST_PREDICTOR_SIMD_TRAVERSAL_H_
+#define XGBOOST_PREDICTOR_SIMD_TRAVERSAL_H_
+
+#include <cstdint>
+
+#include "flat_forest.h"
+
+namespace xgboost {
+namespace predictor {
+/**
+ * \brief Number of rows processed together by `SimdTraverse`, selected at runtime based on
+ *        CPU features.  0 means SIMD traversal is not available and the scalar
+ *        implementation should be used.
+ */
+int32_t SimdTraversalWidth();
+
+/**
+ * \brief Traverse `SimdTraversalWidth()` rows through a flattened tree simultaneously.  The
+ *        tree must not contain categorical split.
+ *
+ * \param tree        Root of the flattened tree.
+ * \param leaf_values Leaf values of the forest.
+ * \param fvalues     Row major dense feature matrix for the rows, missing value is
+ *                    represented by NaN.
+ * \param stride      Number of features in each row of `fvalues`.
+ * \param out         Output leaf value for each row.
+ */
+void SimdTraverse(FlatNode const* tree, float const* leaf_values, float const* fvalues,
+                  int32_t stride, float* out);
+}  // namespace predictor
+}  // namespace xgboost
+#endif  // XGBOOST_PREDICTOR_SIMD_TRAVERSAL_H_
@@ -0,0 +1,233 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "tree_shap.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "xgboost/logging.h"
+#include "../gbm/gbtree_model.h"
+
+namespace xgboost {
+namespace predictor {
+namespace {
+float FillNodeMeanValues(RegTree const &tree, bst_node_t nidx, std::vector<float> *mean_values) {
+  bst_float result;
+  auto &node = tree[nidx];
+  auto &node_mean_values = *mean_values;
+  if (node.IsLeaf()) {
+    result = node.LeafValue();
+  } else {
+    result = FillNodeMeanValues(tree, node.LeftChild(), mean_values) *
+             tree.Stat(node.LeftChild()).sum_hess;
+    result += FillNodeMeanValues(tree, node.RightChild(), mean_values) *
+              tree.Stat(node.RightChild()).sum_hess;
+    result /= tree.Stat(nidx).sum_hess;
+  }
+  node_mean_values[nidx] = result;
+  return result;
+}
+
+void ExtractPaths(RegTree const &tree, bst_node_t nidx, std::vector<ShapPathElement> *path,
+                  std::vector<ShapPathElement> *out_elements, std::vector<float> *out_leaf,
+                  std::vector<size_t> *out_ptr) {
+  auto const &node = tree[nidx];
+  if (node.IsLeaf()) {
+    out_elements->insert(out_elements->end(), path->cbegin(), path->cend());
+    out_ptr->push_back(out_elements->size());
+    out_leaf->push_back(node.LeafValue());
+    return;
+  }
+  auto fidx = node.SplitIndex();
+  float w = tree.Stat(nidx).sum_hess;
+  for (auto child : {node.LeftChild(), node.RightChild()}) {
+    bool is_left = child == node.LeftChild();
+    // Merge with previous split on the same feature, the merged element is moved to the
+    // end of path as done by unwinding in recursive TreeShap.
+    ShapPathElement e{1.0f, -std::numeric_limits<float>::infinity(),
+                      std::numeric_limits<float>::infinity(), fidx, true};
+    auto it = std::find_if(path->begin(), path->end(),
+                           [&](ShapPathElement const &p) { return p.feature_idx == fidx; });
+    std::vector<ShapPathElement> child_path{*path};
+    if (it != path->end()) {
+      e = *it;
+      child_path.erase(child_path.begin() + std::distance(path->begin(), it));
+    }
+    e.zero_fraction *= tree.Stat(child).sum_hess / w;
+    if (is_left) {
+      e.upper_bound = std::min(e.upper_bound, node.SplitCond());
+    } else {
+      e.lower_bound = std::max(e.lower_bound, node.SplitCond());
+    }
+    e.is_missing_branch = e.is_missing_branch && (node.DefaultLeft() == is_left);
+    child_path.push_back(e);
+    ExtractPaths(tree, child, &child_path, out_elements, out_leaf, out_ptr);
+  }
+}
+
+// Changes of mean value along the path to each leaf, indexed by node.
+void ExtractDeltas(RegTree const &tree, std::vector<float> const &mean_values, bst_node_t nidx,
+                   std::vector<TreeShapForest::SplitDelta> *path,
+                   std::vector<std::vector<TreeShapForest::SplitDelta>> *out) {
+  auto const &node = tree[nidx];
+  if (node.IsLeaf()) {
+    (*out)[nidx] = *path;
+    return;
+  }
+  for (auto child : {node.LeftChild(), node.RightChild()}) {
+    path->push_back({node.SplitIndex(), mean_values[child] - mean_values[nidx]});
+    ExtractDeltas(tree, mean_values, child, path, out);
+    path->pop_back();
+  }
+}
+
+// Same as `ExtendPath` in tree_model.cc
+void ExtendPath(TreeShapForest::PathWeight *unique_path, unsigned unique_depth,
+                float zero_fraction, float one_fraction) {
+  unique_path[unique_depth].zero_fraction = zero_fraction;
+  unique_path[unique_depth].one_fraction = one_fraction;
+  unique_path[unique_depth].pweight = (unique_depth == 0 ? 1.0f : 0.0f);
+  for (int i = unique_depth - 1; i >= 0; i--) {
+    unique_path[i + 1].pweight += one_fraction * unique_path[i].pweight * (i + 1) /
+                                  static_cast<float>(unique_depth + 1);
+    unique_path[i].pweight = zero_fraction * unique_path[i].pweight * (unique_depth - i) /
+                             static_cast<float>(unique_depth + 1);
+  }
+}
+
+// Same as `UnwoundPathSum` in tree_model.cc
+float UnwoundPathSum(TreeShapForest::PathWeight const *unique_path, unsigned unique_depth,
+                     unsigned path_index) {
+  const float one_fraction = unique_path[path_index].one_fraction;
+  const float zero_fraction = unique_path[path_index].zero_fraction;
+  float next_one_portion = unique_path[unique_depth].pweight;
+  float total = 0;
+  for (int i = unique_depth - 1; i >= 0; --i) {
+    if (one_fraction != 0) {
+      const float tmp =
+          next_one_portion * (unique_depth + 1) / static_cast<float>((i + 1) * one_fraction);
+      total += tmp;
+      next_one_portion = unique_path[i].pweight -
+                         tmp * zero_fraction *
+                             ((unique_depth - i) / static_cast<float>(unique_depth + 1));
+    } else if (zero_fraction != 0) {
+      total += (unique_path[i].pweight / zero_fraction) /
+               ((unique_depth - i) / static_cast<float>(unique_depth + 1));
+    }
+  }
+  return total;
+}
+}  // anonymous namespace
+
+void TreeShapForest::Extend(gbm::GBTreeModel const &model) {
+  CHECK_EQ(model.Generation(), generation_);
+  CHECK_LE(this->Size(), model.trees.size());
+  std::vector<ShapPathElement> path;
+  for (size_t tree_idx = this->Size(); tree_idx < model.trees.size(); ++tree_idx) {
+    auto const &tree = *model.trees[tree_idx];
+    mean_values_.emplace_back(tree.param.num_nodes);
+    FillNodeMeanValues(tree, RegTree::kRoot, &mean_values_.back());
+    std::vector<std::vector<SplitDelta>> node_deltas(tree.param.num_nodes);
+    std::vector<SplitDelta> delta_path;
+    ExtractDeltas(tree, mean_values_.back(), RegTree::kRoot, &delta_path, &node_deltas);
+    for (auto const &deltas : node_deltas) {
+      deltas_.insert(deltas_.end(), deltas.cbegin(), deltas.cend());
+      delta_ptr_.push_back(deltas_.size());
+    }
+    node_ptr_.push_back(node_ptr_.back() + node_deltas.size());
+    bool has_categorical = tree.HasCategoricalSplit();
+    has_categorical_.push_back(has_categorical);
+    if (!has_categorical) {
+      path.clear();
+      auto n_paths = path_ptr_.size();
+      ExtractPaths(tree, RegTree::kRoot, &path, &elements_, &leaf_values_, &path_ptr_);
+      for (auto i = n_paths; i < path_ptr_.size(); ++i) {
+        max_path_length_ = std::max(max_path_length_, path_ptr_[i] - path_ptr_[i - 1]);
+      }
+    }
+    tree_ptr_.push_back(path_ptr_.size() - 1);
+  }
+}
+
+void TreeShapForest::Calculate(size_t tree_idx, RegTree::FVec const &feat, float scale,
+                               PathWeight *workspace, float *phi) const {
+  phi[feat.Size()] += mean_values_[tree_idx].front() * scale;
+  for (size_t p = tree_ptr_[tree_idx]; p < tree_ptr_[tree_idx + 1]; ++p) {
+    auto const *path = elements_.data() + path_ptr_[p];
+    auto depth = static_cast<unsigned>(path_ptr_[p + 1] - path_ptr_[p]);
+    ExtendPath(workspace, 0, 1.0f, 1.0f);
+    for (unsigned i = 0; i < depth; ++i) {
+      ExtendPath(workspace, i + 1, path[i].zero_fraction, path[i].IsHot(feat) ? 1.0f : 0.0f);
+    }
+    float leaf_value = leaf_values_[p] * scale;
+    for (unsigned i = 1; i <= depth; ++i) {
+      float w = UnwoundPathSum(workspace, depth, i);
+      auto const &el = workspace[i];
+      phi[path[i - 1].feature_idx] += w * (el.one_fraction - el.zero_fraction) * leaf_value;
+    }
+  }
+}
+
+void TreeShapForest::CalculateInteractions(size_t tree_idx, RegTree::FVec const &feat,
+                                           float scale, common::Span<uint8_t const> selected,
+                                           PathWeight *workspace, float *phi) const {
+  size_t const n_columns = feat.Size() + 1;
+  size_t const bias = feat.Size();
+  phi[bias * n_columns + bias] += mean_values_[tree_idx].front() * scale;
+  auto is_selected = [&](bst_feature_t fidx) { return selected.empty() || selected[fidx]; };
+  PathWeight *conditioned = workspace + max_path_length_ + 1;
+
+  for (size_t p = tree_ptr_[tree_idx]; p < tree_ptr_[tree_idx + 1]; ++p) {
+    auto const *path = elements_.data() + path_ptr_[p];
+    auto depth = static_cast<unsigned>(path_ptr_[p + 1] - path_ptr_[p]);
+    ExtendPath(workspace, 0, 1.0f, 1.0f);
+    unsigned n_selected = 0;
+    for (unsigned i = 0; i < depth; ++i) {
+      ExtendPath(workspace, i + 1, path[i].zero_fraction, path[i].IsHot(feat) ? 1.0f : 0.0f);
+      n_selected += is_selected(path[i].feature_idx);
+    }
+    float leaf_value = leaf_values_[p] * scale;
+    for (unsigned i = 1; i <= depth; ++i) {
+      auto fi = path[i - 1].feature_idx;
+      auto const &ei = workspace[i];
+      float &diag = phi[fi * n_columns + fi];
+      diag += UnwoundPathSum(workspace, depth, i) * (ei.one_fraction - ei.zero_fraction) *
+              leaf_value;
+      bool row_selected = is_selected(fi);
+      if (depth == 1 || (!row_selected && n_selected == 0)) {
+        continue;
+      }
+      // Difference between conditioning feature i on and off, halved as the interaction
+      // is split between (i, j) and (j, i).
+      float condition_scale = (ei.one_fraction - ei.zero_fraction) * leaf_value / 2.0f;
+      unsigned c = 0;
+      ExtendPath(conditioned, 0, 1.0f, 1.0f);
+      for (unsigned k = 1; k <= depth; ++k) {
+        if (k != i) {
+          ++c;
+          ExtendPath(conditioned, c, workspace[k].zero_fraction, workspace[k].one_fraction);
+        }
+      }
+      c = 0;
+      for (unsigned k = 1; k <= depth; ++k) {
+        if (k == i) {
+          continue;
+        }
+        ++c;
+        auto fk = path[k - 1].feature_idx;
+        if (!row_selected && !is_selected(fk)) {
+          continue;
+        }
+        auto const &ek = conditioned[c];
+        float v = UnwoundPathSum(conditioned, depth - 1, c) *
+                  (ek.one_fraction - ek.zero_fraction) * condition_scale;
+        phi[fi * n_columns + fk] += v;
+        diag -= v;
+      }
+    }
+  }
+}
+}  // namespace predictor
+}  // namespace xgboost
@@ -0,0 +1,154 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file tree_shap.h
+ * \brief Path based TreeSHAP for CPU predictor.
+ */
+#ifndef XGBOOST_PREDICTOR_TREE_SHAP_H_
+#define XGBOOST_PREDICTOR_TREE_SHAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/span.h"
+#include "xgboost/tree_model.h"
+
+namespace xgboost {
+namespace gbm {
+struct GBTreeModel;
+}  // namespace gbm
+
+namespace predictor {
+/**
+ * \brief A feature on the path from root to leaf.  Splits on the same feature along a
+ *        path are merged into one element.
+ */
+struct ShapPathElement {
+  /*! \brief Fraction of training samples following the path, given by hessian. */
+  float zero_fraction;
+  /*! \brief Rows with feature value in [lower_bound, upper_bound) follow the path. */
+  float lower_bound;
+  float upper_bound;
+  bst_feature_t feature_idx;
+  /*! \brief Whether missing value follows the path. */
+  bool is_missing_branch;
+
+  bool IsHot(RegTree::FVec const& feat) const {
+    if (feat.IsMissing(feature_idx)) {
+      return is_missing_branch;
+    }
+    auto fvalue = feat.GetFvalue(feature_idx);
+    return fvalue >= lower_bound && fvalue < upper_bound;
+  }
+};
+
+/**
+ * \brief Decision paths of all trees in a `GBTreeModel`, extracted once so that SHAP
+ *        values of a row can be computed by iterating over leaves instead of recursing
+ *        through the tree and rebuilding the unique path at each node.  See "Linear time
+ *        TreeSHAP" and `gputreeshap` for the formulation.
+ *
+ *   Trees with categorical splits are not represented by paths, `RegTree` is used for
+ *   them instead.
+ */
+class TreeShapForest {
+ public:
+  /*! \brief Permutation weight of unique path, used as workspace during evaluation. */
+  struct PathWeight {
+    float zero_fraction;
+    float one_fraction;
+    float pweight;
+  };
+  /*! \brief Change of mean value along a split on the path to a leaf, for approximate
+   *         (Saabas) contributions. */
+  struct SplitDelta {
+    bst_feature_t feature_idx;
+    float delta;
+  };
+
+ private:
+  std::vector<ShapPathElement> elements_;
+  std::vector<float> leaf_values_;
+  // Segment of elements for each path.
+  std::vector<size_t> path_ptr_{0};
+  // Segment of paths for each tree.
+  std::vector<size_t> tree_ptr_{0};
+  std::vector<std::vector<float>> mean_values_;
+  std::vector<SplitDelta> deltas_;
+  // Segment of deltas for each node, only leaves have non-empty segments.
+  std::vector<size_t> delta_ptr_{0};
+  // Position of the first node of each tree in `delta_ptr_`.
+  std::vector<size_t> node_ptr_{0};
+  std::vector<uint8_t> has_categorical_;
+  size_t max_path_length_{0};
+  uint64_t generation_{0};
+
+ public:
+  TreeShapForest() = default;
+  explicit TreeShapForest(uint64_t generation) : generation_{generation} {}
+
+  /**
+   * \brief Extract paths from trees in the model that are not yet part of this forest.
+   */
+  void Extend(gbm::GBTreeModel const& model);
+
+  size_t Size() const { return mean_values_.size(); }
+  uint64_t Generation() const { return generation_; }
+  /*! \brief Maximum number of unique features in a path. */
+  size_t MaxPathLength() const { return max_path_length_; }
+  bool HasCategorical(size_t tree_idx) const { return has_categorical_[tree_idx]; }
+  /*! \brief Expected value of each node weighted by hessian. */
+  std::vector<float> const& MeanValues(size_t tree_idx) const { return mean_values_[tree_idx]; }
+
+  /**
+   * \brief Accumulate approximate contributions of a row, which are the changes of mean
+   *        value along the path to its leaf attributed to the split features.
+   *
+   * \param tree_idx   Index of tree.
+   * \param leaf       The leaf reached by the row.
+   * \param n_features Number of features, the bias is stored after the features.
+   * \param scale      Weight of the tree.
+   * \param phi        Output contributions.
+   */
+  void CalculateApprox(size_t tree_idx, bst_node_t leaf, size_t n_features, float scale,
+                       float* phi) const {
+    phi[n_features] += mean_values_[tree_idx].front() * scale;
+    auto node = node_ptr_[tree_idx] + leaf;
+    for (auto i = delta_ptr_[node]; i < delta_ptr_[node + 1]; ++i) {
+      phi[deltas_[i].feature_idx] += deltas_[i].delta * scale;
+    }
+  }
+
+  /**
+   * \brief Accumulate SHAP values of a numerical tree for a row.
+   *
+   * \param tree_idx  Index of tree, must not contain categorical split.
+   * \param feat      Dense feature vector.
+   * \param scale     Weight of the tree.
+   * \param workspace Buffer with at least `MaxPathLength() + 1` elements.
+   * \param phi       Output contributions with bias as the last element.
+   */
+  void Calculate(size_t tree_idx, RegTree::FVec const& feat, float scale,
+                 PathWeight* workspace, float* phi) const;
+  /**
+   * \brief Accumulate SHAP interaction values of a numerical tree for a row.  Each path is
+   *        conditioned on each of its features in turn, so the whole interaction matrix is
+   *        obtained in a single pass over the paths.
+   *
+   * \param tree_idx  Index of tree, must not contain categorical split.
+   * \param feat      Dense feature vector.
+   * \param scale     Weight of the tree.
+   * \param selected  Optional mask of features, when not empty only interactions involving
+   *                  at least one selected feature are computed.  The diagonal holds the
+   *                  remaining effect so that each row still sums up to the SHAP value.
+   * \param workspace Buffer with at least `2 * (MaxPathLength() + 1)` elements.
+   * \param phi       Output interaction matrix with shape (n_features + 1, n_features + 1).
+   */
+  void CalculateInteractions(size_t tree_idx, RegTree::FVec const& feat, float scale,
+                             common::Span<uint8_t const> selected, PathWeight* workspace,
+                             float* phi) const;
+};
+}  // namespace predictor
+}  // namespace xgboost
+#endif  // XGBOOST_PREDICTOR_TREE_SHAP_H_
@@ -0,0 +1,372 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file scoring_server.cc
+ */
+#include "scoring_server.h"
+
+#if !defined(_WIN32)
+#include <sys/un.h>
+#endif  // !defined(_WIN32)
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include "../data/adapter.h"
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace serve {
+constexpr uint32_t ScoringServer::kStats;
+constexpr uint32_t ScoringServer::kShutdown;
+constexpr uint32_t ScoringServer::kMaxRequestRows;
+
+MicroBatcher::MicroBatcher(std::unique_ptr<Learner> learner, BatchConfig config)
+    : learner_{std::move(learner)}, config_{config} {
+  CHECK_GE(config_.max_batch_rows, 1);
+  learner_->Configure();
+  n_features_ = learner_->GetNumFeature();
+  worker_ = std::thread{[this] { this->Loop(); }};
+}
+
+MicroBatcher::~MicroBatcher() {
+  {
+    std::lock_guard<std::mutex> guard{mu_};
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::future<std::vector<float>> MicroBatcher::Submit(std::vector<float> values,
+                                                     size_t n_rows) {
+  CHECK_EQ(values.size(), n_rows * n_features_)
+      << "Number of columns in data must equal to trained model.";
+  Request request;
+  request.values = std::move(values);
+  request.n_rows = n_rows;
+  request.arrival = std::chrono::steady_clock::now();
+  auto fut = request.result.get_future();
+  {
+    std::lock_guard<std::mutex> guard{mu_};
+    CHECK(!stop_);
+    pending_rows_ += n_rows;
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+  return fut;
+}
+
+MicroBatcher::Stats MicroBatcher::GetStats() const {
+  std::lock_guard<std::mutex> guard{mu_};
+  return stats_;
+}
+
+void MicroBatcher::Loop() {
+  std::vector<Request> batch;
+  while (true) {
+    std::unique_lock<std::mutex> lock{mu_};
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    // Wait for more requests until the deadline of the oldest one, pending requests are
+    // drained without waiting once stopped.
+    auto deadline = queue_.front().arrival + config_.max_delay;
+    cv_.wait_until(lock, deadline, [this] {
+      return stop_ || pending_rows_ >= config_.max_batch_rows;
+    });
+    size_t n_rows{0};
+    while (!queue_.empty() &&
+           (batch.empty() || n_rows + queue_.front().n_rows <= config_.max_batch_rows)) {
+      n_rows += queue_.front().n_rows;
+      pending_rows_ -= queue_.front().n_rows;
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    lock.unlock();
+
+    this->PredictBatch(&batch);
+    batch.clear();
+  }
+}
+
+void MicroBatcher::PredictBatch(std::vector<Request> *p_requests) {
+  auto &requests = *p_requests;
+  size_t n_rows{0};
+  for (auto const &r : requests) {
+    n_rows += r.n_rows;
+  }
+  batch_.resize(n_rows * n_features_);
+  auto out = batch_.begin();
+  for (auto const &r : requests) {
+    out = std::copy(r.values.cbegin(), r.values.cend(), out);
+  }
+
+  try {
+    auto adapter = std::make_shared<data::DenseAdapter>(batch_.data(), n_rows, n_features_);
+    HostDeviceVector<float> *p_predt{nullptr};
+    learner_->InplacePredict(adapter, nullptr, config_.type,
+                             std::numeric_limits<float>::quiet_NaN(), &p_predt,
+                             config_.iteration_begin, config_.iteration_end);
+    auto const &predt = p_predt->ConstHostVector();
+    CHECK_EQ(predt.size() % std::max(n_rows, static_cast<size_t>(1)), 0);
+    size_t n_outputs = n_rows == 0 ? 0 : predt.size() / n_rows;
+    auto it = predt.cbegin();
+    for (auto &r : requests) {
+      auto end = it + r.n_rows * n_outputs;
+      r.result.set_value(std::vector<float>(it, end));
+      it = end;
+    }
+  } catch (std::exception const &) {
+    for (auto &r : requests) {
+      r.result.set_exception(std::current_exception());
+    }
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard{mu_};
+  for (auto const &r : requests) {
+    double latency =
+        std::chrono::duration<double, std::micro>(now - r.arrival).count();
+    stats_.latency_sum += latency;
+    stats_.latency_max = std::max(stats_.latency_max, latency);
+  }
+  stats_.n_requests += requests.size();
+  stats_.n_rows += n_rows;
+  stats_.n_batches += 1;
+}
+
+ScoringServer::ScoringServer(std::vector<std::unique_ptr<MicroBatcher>> models,
+                             std::chrono::seconds report_interval)
+    : models_{std::move(models)}, report_interval_{report_interval} {
+  CHECK(!models_.empty()) << "At least one model is required.";
+  rabit::utils::Socket::Startup();
+}
+
+ScoringServer::~ScoringServer() {
+  this->Stop();
+  for (auto &c : connections_) {
+    if (c.thread.joinable()) {
+      c.thread.join();
+    }
+  }
+  if (listener_.sockfd != rabit::utils::kInvalidSocket) {
+    listener_.Close();
+  }
+#if !defined(_WIN32)
+  if (!unix_path_.empty()) {
+    std::remove(unix_path_.c_str());
+  }
+#endif  // !defined(_WIN32)
+}
+
+int32_t ScoringServer::ListenTCP(int32_t begin, int32_t end) {
+  listener_.Create();
+  int32_t port = listener_.TryBindHost(begin, end);
+  CHECK_NE(port, -1) << "Failed to bind a port in [" << begin << ", " << end << ").";
+  listener_.Listen(128);
+  return port;
+}
+
+void ScoringServer::ListenUnix(std::string const &path) {
+#if defined(_WIN32)
+  LOG(FATAL) << "Unix domain socket is not supported on Windows.";
+#else
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  CHECK_LT(path.size(), sizeof(addr.sun_path)) << "Socket path is too long: " << path;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  std::remove(path.c_str());
+  listener_.sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener_.sockfd == rabit::utils::kInvalidSocket) {
+    rabit::utils::Socket::Error("Create");
+  }
+  if (bind(listener_.sockfd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+    rabit::utils::Socket::Error("Bind");
+  }
+  unix_path_ = path;
+  listener_.Listen(128);
+#endif  // defined(_WIN32)
+}
+
+void ScoringServer::Stop() {
+  {
+    std::lock_guard<std::mutex> guard{mu_};
+    stop_ = true;
+  }
+  cv_.notify_all();
+}
+
+namespace {
+// Wait until the socket is readable, returns false on timeout.
+bool WaitReadable(rabit::utils::TCPSocket const &sock, std::chrono::seconds timeout) {
+  pollfd pfd;
+  pfd.fd = sock.sockfd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  auto ret = rabit::utils::PollImpl(&pfd, 1, timeout);
+  if (ret < 0) {
+    rabit::utils::Socket::Error("Poll");
+  }
+  return ret > 0;
+}
+
+void Reply(rabit::utils::TCPSocket *sock, uint32_t status, void const *payload,
+           uint32_t n, size_t n_bytes) {
+  uint32_t header[2]{status, n};
+  sock->SendAll(header, sizeof(header));
+  if (n_bytes != 0) {
+    sock->SendAll(payload, n_bytes);
+  }
+}
+
+void ReplyText(rabit::utils::TCPSocket *sock, uint32_t status, std::string const &text) {
+  Reply(sock, status, text.data(), static_cast<uint32_t>(text.size()), text.size());
+}
+}  // anonymous namespace
+
+void ScoringServer::Serve(rabit::utils::TCPSocket sock) {
+  // Time out regularly to check whether the server is stopped.
+  auto const kPollInterval = std::chrono::seconds{1};
+  try {
+    while (!stop_) {
+      if (!WaitReadable(sock, kPollInterval)) {
+        continue;
+      }
+      uint32_t header[3];
+      if (sock.RecvAll(header, sizeof(header)) != sizeof(header)) {
+        break;  // closed by client
+      }
+      auto model = header[0], n_rows = header[1], n_cols = header[2];
+      if (model == kShutdown) {
+        ReplyText(&sock, kOk, "");
+        this->Stop();
+        break;
+      }
+      if (model == kStats) {
+        std::string str;
+        Json::Dump(this->StatsJson(), &str);
+        ReplyText(&sock, kText, str);
+        continue;
+      }
+      if (n_rows == 0 && model < models_.size()) {
+        Reply(&sock, kOk, nullptr, 0, 0);
+        continue;
+      }
+      if (model >= models_.size() || n_cols != models_[model]->NumFeatures() ||
+          n_rows > kMaxRequestRows) {
+        std::stringstream ss;
+        ss << "Invalid request, model: " << model << ", rows: " << n_rows
+           << ", columns: " << n_cols;
+        ReplyText(&sock, kError, ss.str());
+        break;
+      }
+      std::vector<float> values(static_cast<size_t>(n_rows) * n_cols);
+      size_t n_bytes = values.size() * sizeof(float);
+      if (sock.RecvAll(values.data(), n_bytes) != n_bytes) {
+        break;
+      }
+      try {
+        auto predt = models_[model]->Submit(std::move(values), n_rows).get();
+        Reply(&sock, kOk, predt.data(), static_cast<uint32_t>(predt.size()),
+              predt.size() * sizeof(float));
+      } catch (dmlc::Error const &e) {
+        ReplyText(&sock, kError, e.what());
+      }
+    }
+  } catch (dmlc::Error const &e) {
+    LOG(WARNING) << "Connection closed with error: " << e.what();
+  }
+  sock.Close();
+}
+
+Json ScoringServer::StatsJson() const {
+  auto elapsed = std::max(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count(),
+      std::numeric_limits<double>::epsilon());
+  Json out{Array{}};
+  auto &arr = get<Array>(out);
+  for (auto const &m : models_) {
+    auto s = m->GetStats();
+    Json stats{Object{}};
+    stats["requests"] = Integer{static_cast<Integer::Int>(s.n_requests)};
+    stats["rows"] = Integer{static_cast<Integer::Int>(s.n_rows)};
+    stats["batches"] = Integer{static_cast<Integer::Int>(s.n_batches)};
+    stats["qps"] = Number{static_cast<float>(s.n_requests / elapsed)};
+    stats["mean_batch_rows"] =
+        Number{static_cast<float>(s.n_batches == 0 ? 0.0 : double(s.n_rows) / s.n_batches)};
+    stats["mean_latency_us"] =
+        Number{static_cast<float>(s.n_requests == 0 ? 0.0 : s.latency_sum / s.n_requests)};
+    stats["max_latency_us"] = Number{static_cast<float>(s.latency_max)};
+    arr.emplace_back(std::move(stats));
+  }
+  return out;
+}
+
+void ScoringServer::Report() {
+  auto stats = this->StatsJson();
+  auto const &arr = get<Array const>(stats);
+  for (size_t i = 0; i < arr.size(); ++i) {
+    auto const &s = arr[i];
+    LOG(CONSOLE) << "model " << i << ": requests=" << get<Integer const>(s["requests"])
+                 << " qps=" << get<Number const>(s["qps"])
+                 << " mean_batch_rows=" << get<Number const>(s["mean_batch_rows"])
+                 << " mean_latency_us=" << get<Number const>(s["mean_latency_us"])
+                 << " max_latency_us=" << get<Number const>(s["max_latency_us"]);
+  }
+}
+
+void ScoringServer::Run() {
+  CHECK_NE(listener_.sockfd, rabit::utils::kInvalidSocket)
+      << "Call ListenTCP or ListenUnix before running the server.";
+  start_ = std::chrono::steady_clock::now();
+  std::thread reporter;
+  if (report_interval_.count() != 0) {
+    reporter = std::thread{[this] {
+      std::unique_lock<std::mutex> lock{mu_};
+      while (!cv_.wait_for(lock, report_interval_, [this] { return stop_.load(); })) {
+        lock.unlock();
+        this->Report();
+        lock.lock();
+      }
+    }};
+  }
+
+  auto const kPollInterval = std::chrono::seconds{1};
+  while (!stop_) {
+    // Join finished connections.
+    connections_.remove_if([](Connection &c) {
+      if (c.done) {
+        c.thread.join();
+        return true;
+      }
+      return false;
+    });
+    if (!WaitReadable(listener_, kPollInterval)) {
+      continue;
+    }
+    auto sock = listener_.Accept();
+    connections_.emplace_back();
+    auto &c = connections_.back();
+    c.thread = std::thread{[this, sock, &c] {
+      this->Serve(sock);
+      c.done = true;
+    }};
+  }
+
+  for (auto &c : connections_) {
+    c.thread.join();
+  }
+  connections_.clear();
+  if (reporter.joinable()) {
+    reporter.join();
+  }
+  this->Report();
+}
+}  // namespace serve
+}  // namespace xgboost
@@ -0,0 +1,156 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file scoring_server.h
+ * \brief Scoring server with adaptive micro-batching, used by the `serve` task of CLI.
+ */
+#ifndef XGBOOST_SERVE_SCORING_SERVER_H_
+#define XGBOOST_SERVE_SCORING_SERVER_H_
+
+#include <rabit/internal/socket.h>
+#include <xgboost/json.h>
+#include <xgboost/learner.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xgboost {
+namespace serve {
+struct BatchConfig {
+  /*! \brief Maximum number of rows predicted in one batch. */
+  size_t max_batch_rows{1024};
+  /*! \brief Maximum time a request waits for other requests to join its batch. */
+  std::chrono::microseconds max_delay{1000};
+  PredictionType type{PredictionType::kValue};
+  uint32_t iteration_begin{0};
+  uint32_t iteration_end{0};
+};
+
+/*!
+ * \brief Collect concurrent prediction requests of a model into batches.  A batch is
+ *        predicted once it has `max_batch_rows` rows or its oldest request has waited for
+ *        `max_delay`, so that the latency deadline holds under low load while throughput
+ *        benefits from blocked prediction kernels under high load.
+ */
+class MicroBatcher {
+ public:
+  struct Stats {
+    uint64_t n_requests{0};
+    uint64_t n_rows{0};
+    uint64_t n_batches{0};
+    // Latency from submission to the completion of prediction, in microseconds.
+    double latency_sum{0};
+    double latency_max{0};
+  };
+
+ private:
+  struct Request {
+    std::vector<float> values;
+    size_t n_rows;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<std::vector<float>> result;
+  };
+
+  std::unique_ptr<Learner> learner_;
+  BatchConfig config_;
+  bst_feature_t n_features_;
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  size_t pending_rows_{0};
+  bool stop_{false};
+  Stats stats_;
+
+  std::vector<float> batch_;
+  std::thread worker_;
+
+  void PredictBatch(std::vector<Request> *p_requests);
+  void Loop();
+
+ public:
+  MicroBatcher(std::unique_ptr<Learner> learner, BatchConfig config);
+  ~MicroBatcher();
+
+  /*!
+   * \brief Submit dense rows in row major, missing values are represented by NaN.
+   *
+   * \return Future of the prediction, with one value for each output of each row.
+   */
+  std::future<std::vector<float>> Submit(std::vector<float> values, size_t n_rows);
+  bst_feature_t NumFeatures() const { return n_features_; }
+  Stats GetStats() const;
+};
+
+/*!
+ * \brief Scoring server over TCP or Unix domain socket.  All integers and floats are in
+ *        native byte order.  A request is
+ *
+ *          uint32 model, uint32 n_rows, uint32 n_cols, float32 values[n_rows * n_cols]
+ *
+ *        where `model` is the index of model in the order they are loaded.  The response is
+ *
+ *          uint32 status, uint32 n, payload
+ *
+ *        The payload is `n` float32 predictions for `kOk`, and `n` bytes of text for `kText`
+ *        and `kError`.  Requests for the special model `kStats` return statistics of all
+ *        models as JSON text, and `kShutdown` stops the server.  Connection is closed after
+ *        a malformed request.
+ */
+class ScoringServer {
+ public:
+  enum Status : uint32_t { kOk = 0, kText = 1, kError = 2 };
+  static constexpr uint32_t kStats = 0xfffffffe;
+  static constexpr uint32_t kShutdown = 0xffffffff;
+  // Upper bound of rows in a single request.
+  static constexpr uint32_t kMaxRequestRows = 1u << 20;
+
+ private:
+  struct Connection {
+    std::thread thread;
+    std::atomic<bool> done{false};
+  };
+
+  std::vector<std::unique_ptr<MicroBatcher>> models_;
+  std::chrono::seconds report_interval_;
+  rabit::utils::TCPSocket listener_;
+  std::string unix_path_;
+  std::chrono::steady_clock::time_point start_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::atomic<bool> stop_{false};
+  std::list<Connection> connections_;
+
+  void Serve(rabit::utils::TCPSocket sock);
+  void Report();
+
+ public:
+  /*!
+   * \param models          Loaded models, used in the given order.
+   * \param report_interval Interval of logging statistics, 0 disables logging.
+   */
+  ScoringServer(std::vector<std::unique_ptr<MicroBatcher>> models,
+                std::chrono::seconds report_interval);
+  ~ScoringServer();
+  /*! \brief Listen on the first available TCP port in [begin, end), returns the port. */
+  int32_t ListenTCP(int32_t begin, int32_t end);
+  /*! \brief Listen on a Unix domain socket, any existing file at the path is removed. */
+  void ListenUnix(std::string const &path);
+  /*! \brief Accept connections until a shutdown request is received. */
+  void Run();
+  void Stop();
+  Json StatsJson() const;
+};
+}  // namespace serve
+}  // namespace xgboost
+#endif  // XGBOOST_SERVE_SCORING_SERVER_H_
@@ -0,0 +1,320 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "compact_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "xgboost/logging.h"
+
+namespace xgboost {
+namespace {
+int32_t constexpr kCompactTreeVersion = 1;
+
+template <typename T, typename V>
+void WriteAs(std::vector<V> const& values, dmlc::Stream* fo) {
+  std::vector<T> narrowed(values.cbegin(), values.cend());
+  fo->Write(narrowed);
+}
+
+template <typename T, typename V>
+void ReadAs(dmlc::Stream* fi, std::vector<V>* out) {
+  std::vector<T> narrowed;
+  CHECK(fi->Read(&narrowed)) << "Invalid compact model.";
+  out->assign(narrowed.cbegin(), narrowed.cend());
+}
+
+/*! \brief Visit nodes in breadth first order such that children are placed together. */
+template <typename Fn>
+void VisitBFS(RegTree const& tree, Fn&& fn) {
+  std::vector<bst_node_t> queue{RegTree::kRoot};
+  for (size_t pos = 0; pos < queue.size(); ++pos) {
+    auto const& node = tree[queue[pos]];
+    int32_t left = -1;
+    if (!node.IsLeaf()) {
+      left = static_cast<int32_t>(queue.size());
+      queue.push_back(node.LeftChild());
+      queue.push_back(node.RightChild());
+    }
+    fn(node, left);
+  }
+}
+
+float Dequantize(CompactLeafType type, int32_t q, float scale) {
+  switch (type) {
+    case CompactLeafType::kFloat16:
+      return HalfToFloat(static_cast<uint16_t>(q)) * scale;
+    case CompactLeafType::kInt8:
+      return static_cast<float>(q) * scale;
+  }
+  return 0.0f;
+}
+}  // anonymous namespace
+
+CompactLeafType ParseCompactLeafType(std::string const& name) {
+  if (name == "fp16") {
+    return CompactLeafType::kFloat16;
+  } else if (name == "int8") {
+    return CompactLeafType::kInt8;
+  }
+  LOG(FATAL) << "Unknown leaf type for compact model: " << name
+             << ", expecting `fp16` or `int8`.";
+  return CompactLeafType::kFloat16;
+}
+
+uint16_t FloatToHalf(float value) {
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+  uint32_t const sign = (x >> 16) & 0x8000U;
+  uint32_t const f_exp = (x >> 23) & 0xffU;
+  uint32_t mant = x & 0x7fffffU;
+  if (f_exp == 0xffU) {
+    // inf or nan
+    return static_cast<uint16_t>(sign | 0x7c00U | (mant != 0 ? 0x200U : 0U));
+  }
+  int32_t const exp = static_cast<int32_t>(f_exp) - 127 + 15;
+  if (exp >= 31) {
+    return static_cast<uint16_t>(sign | 0x7c00U);
+  }
+  if (exp <= 0) {
+    // subnormal
+    if (exp < -10) {
+      return static_cast<uint16_t>(sign);
+    }
+    mant |= 0x800000U;
+    uint32_t const shift = static_cast<uint32_t>(14 - exp);
+    uint32_t h_mant = mant >> shift;
+    uint32_t const rem = mant & ((1U << shift) - 1U);
+    uint32_t const halfway = 1U << (shift - 1U);
+    if (rem > halfway || (rem == halfway && (h_mant & 1U))) {
+      ++h_mant;
+    }
+    return static_cast<uint16_t>(sign | h_mant);
+  }
+  uint32_t h = sign | (static_cast<uint32_t>(exp) << 10) | (mant >> 13);
+  uint32_t const rem = mant & 0x1fffU;
+  // Carry into exponent is the correct rounding.
+  if (rem > 0x1000U || (rem == 0x1000U && (h & 1U))) {
+    ++h;
+  }
+  return static_cast<uint16_t>(h);
+}
+
+float HalfToFloat(uint16_t value) {
+  uint32_t const sign = static_cast<uint32_t>(value & 0x8000U) << 16;
+  uint32_t exp = (value >> 10) & 0x1fU;
+  uint32_t mant = value & 0x3ffU;
+  uint32_t x;
+  if (exp == 0) {
+    if (mant == 0) {
+      x = sign;
+    } else {
+      // normalize subnormal
+      exp = 127 - 15 + 1;
+      while ((mant & 0x400U) == 0) {
+        mant <<= 1;
+        --exp;
+      }
+      mant &= 0x3ffU;
+      x = sign | (exp << 23) | (mant << 13);
+    }
+  } else if (exp == 0x1fU) {
+    x = sign | 0x7f800000U | (mant << 13);
+  } else {
+    x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+  }
+  float result;
+  std::memcpy(&result, &x, sizeof(result));
+  return result;
+}
+
+double SaveCompactTrees(std::vector<RegTree> const& trees, bst_feature_t n_features,
+                        CompactLeafType type, dmlc::Stream* fo) {
+  // Distinct split values for each feature, shared by all trees.
+  std::vector<std::vector<float>> cuts(n_features);
+  for (auto const& tree : trees) {
+    CHECK(!tree.HasCategoricalSplit())
+        << "Compact model doesn't support categorical splits.";
+    CHECK_EQ(tree.param.size_leaf_vector, 0) << "Vector leaf is not supported.";
+    VisitBFS(tree, [&](RegTree::Node const& node, int32_t) {
+      if (!node.IsLeaf()) {
+        CHECK_LT(node.SplitIndex(), n_features);
+        cuts[node.SplitIndex()].push_back(node.SplitCond());
+      }
+    });
+  }
+  size_t max_cuts = 0;
+  for (auto& feature_cuts : cuts) {
+    std::sort(feature_cuts.begin(), feature_cuts.end());
+    feature_cuts.erase(std::unique(feature_cuts.begin(), feature_cuts.end()),
+                       feature_cuts.end());
+    max_cuts = std::max(max_cuts, feature_cuts.size());
+  }
+  uint8_t index_bytes = max_cuts <= (1UL << 8) ? 1 : (max_cuts <= (1UL << 16) ? 2 : 4);
+
+  fo->Write(kCompactTreeVersion);
+  fo->Write(static_cast<uint8_t>(type));
+  fo->Write(index_bytes);
+  fo->Write(static_cast<uint64_t>(cuts.size()));
+  for (auto const& feature_cuts : cuts) {
+    fo->Write(feature_cuts);
+  }
+  fo->Write(static_cast<uint64_t>(trees.size()));
+
+  double error_bound = 0;
+  std::vector<int32_t> left;
+  std::vector<uint32_t> sindex;
+  std::vector<uint32_t> cond_index;
+  std::vector<float> leaves;
+  std::vector<int32_t> quantized;
+  for (auto const& tree : trees) {
+    left.clear();
+    sindex.clear();
+    cond_index.clear();
+    leaves.clear();
+    VisitBFS(tree, [&](RegTree::Node const& node, int32_t left_pos) {
+      left.push_back(left_pos);
+      if (node.IsLeaf()) {
+        leaves.push_back(node.LeafValue());
+      } else {
+        auto const& feature_cuts = cuts[node.SplitIndex()];
+        auto it = std::lower_bound(feature_cuts.cbegin(), feature_cuts.cend(),
+                                   node.SplitCond());
+        sindex.push_back(node.SplitIndex() | (node.DefaultLeft() ? (1U << 31) : 0U));
+        cond_index.push_back(static_cast<uint32_t>(std::distance(feature_cuts.cbegin(), it)));
+      }
+    });
+    fo->Write(left);
+    fo->Write(sindex);
+    switch (index_bytes) {
+      case 1:
+        WriteAs<uint8_t>(cond_index, fo);
+        break;
+      case 2:
+        WriteAs<uint16_t>(cond_index, fo);
+        break;
+      default:
+        WriteAs<uint32_t>(cond_index, fo);
+    }
+
+    float max_abs = 0;
+    for (auto v : leaves) {
+      max_abs = std::max(max_abs, std::abs(v));
+    }
+    // Normalize leaf values into [-1, 1] for fp16 to avoid overflow.
+    float scale = type == CompactLeafType::kInt8 ? max_abs / 127.0f : max_abs;
+    scale = scale == 0 ? 1.0f : scale;
+    float max_error = 0;
+    quantized.clear();
+    for (auto v : leaves) {
+      int32_t q;
+      if (type == CompactLeafType::kInt8) {
+        q = static_cast<int32_t>(std::round(std::min(std::max(v / scale, -127.0f), 127.0f)));
+      } else {
+        q = FloatToHalf(v / scale);
+      }
+      quantized.push_back(q);
+      max_error = std::max(max_error, std::abs(v - Dequantize(type, q, scale)));
+    }
+    fo->Write(scale);
+    if (type == CompactLeafType::kInt8) {
+      WriteAs<int8_t>(quantized, fo);
+    } else {
+      WriteAs<uint16_t>(quantized, fo);
+    }
+    error_bound += max_error;
+  }
+  fo->Write(error_bound);
+  return error_bound;
+}
+
+double LoadCompactTrees(dmlc::Stream* fi, std::vector<RegTree>* out_trees) {
+  int32_t version{0};
+  CHECK(fi->Read(&version)) << "Invalid compact model.";
+  CHECK_EQ(version, kCompactTreeVersion) << "Unsupported compact model version.";
+  uint8_t type_value{0}, index_bytes{0};
+  CHECK(fi->Read(&type_value)) << "Invalid compact model.";
+  CHECK(fi->Read(&index_bytes)) << "Invalid compact model.";
+  auto type = static_cast<CompactLeafType>(type_value);
+  CHECK(type == CompactLeafType::kFloat16 || type == CompactLeafType::kInt8)
+      << "Invalid compact model.";
+  uint64_t n_features{0};
+  CHECK(fi->Read(&n_features)) << "Invalid compact model.";
+  std::vector<std::vector<float>> cuts(n_features);
+  for (auto& feature_cuts : cuts) {
+    CHECK(fi->Read(&feature_cuts)) << "Invalid compact model.";
+  }
+  uint64_t n_trees{0};
+  CHECK(fi->Read(&n_trees)) << "Invalid compact model.";
+
+  auto& trees = *out_trees;
+  trees.clear();
+  trees.resize(n_trees);
+  std::vector<int32_t> left;
+  std::vector<uint32_t> sindex;
+  std::vector<uint32_t> cond_index;
+  std::vector<float> leaves;
+  std::vector<int32_t> quantized;
+  std::vector<bst_node_t> nidx;
+  for (auto& tree : trees) {
+    CHECK(fi->Read(&left)) << "Invalid compact model.";
+    CHECK(fi->Read(&sindex)) << "Invalid compact model.";
+    switch (index_bytes) {
+      case 1:
+        ReadAs<uint8_t>(fi, &cond_index);
+        break;
+      case 2:
+        ReadAs<uint16_t>(fi, &cond_index);
+        break;
+      default:
+        ReadAs<uint32_t>(fi, &cond_index);
+    }
+    float scale{1.0f};
+    CHECK(fi->Read(&scale)) << "Invalid compact model.";
+    if (type == CompactLeafType::kInt8) {
+      ReadAs<int8_t>(fi, &quantized);
+    } else {
+      ReadAs<uint16_t>(fi, &quantized);
+    }
+    leaves.clear();
+    for (auto q : quantized) {
+      leaves.push_back(Dequantize(type, q, scale));
+    }
+    CHECK_EQ(sindex.size(), cond_index.size()) << "Invalid compact model.";
+    CHECK_EQ(left.size(), sindex.size() + leaves.size()) << "Invalid compact model.";
+
+    // Nodes are expanded in the same order as they are written, children of each node
+    // are allocated together.
+    nidx.assign(left.size(), RegTree::kInvalidNodeId);
+    nidx.front() = RegTree::kRoot;
+    size_t split_pos = 0, leaf_pos = 0;
+    for (size_t pos = 0; pos < left.size(); ++pos) {
+      CHECK_NE(nidx[pos], RegTree::kInvalidNodeId) << "Invalid compact model.";
+      if (left[pos] == -1) {
+        tree[nidx[pos]].SetLeaf(leaves[leaf_pos++]);
+        continue;
+      }
+      CHECK_GT(left[pos], static_cast<int32_t>(pos)) << "Invalid compact model.";
+      CHECK_LT(static_cast<size_t>(left[pos]) + 1, left.size()) << "Invalid compact model.";
+      auto fidx = sindex[split_pos] & ((1U << 31) - 1U);
+      bool default_left = (sindex[split_pos] >> 31) != 0;
+      CHECK_LT(fidx, cuts.size()) << "Invalid compact model.";
+      CHECK_LT(cond_index[split_pos], cuts[fidx].size()) << "Invalid compact model.";
+      float split_cond = cuts[fidx][cond_index[split_pos]];
+      ++split_pos;
+      tree.ExpandNode(nidx[pos], fidx, split_cond, default_left, 0.0f, 0.0f, 0.0f, 0.0f,
+                      0.0f, 0.0f, 0.0f);
+      nidx[left[pos]] = tree[nidx[pos]].LeftChild();
+      nidx[left[pos] + 1] = tree[nidx[pos]].RightChild();
+    }
+    tree.param.num_feature = static_cast<int>(n_features);
+  }
+  double error_bound{0};
+  CHECK(fi->Read(&error_bound)) << "Invalid compact model.";
+  return error_bound;
+}
+}  // namespace xgboost
@@ -0,0 +1,56 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file compact_tree.h
+ * \brief Compact inference only encoding of trees.
+ */
+#ifndef XGBOOST_TREE_COMPACT_TREE_H_
+#define XGBOOST_TREE_COMPACT_TREE_H_
+
+#include <dmlc/io.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/tree_model.h"
+
+namespace xgboost {
+/*! \brief Encoding of leaf values in compact trees. */
+enum class CompactLeafType : uint8_t {
+  kFloat16 = 0,
+  kInt8 = 1
+};
+
+CompactLeafType ParseCompactLeafType(std::string const& name);
+
+/*! \brief Convert to IEEE 754 half precision with round to nearest even. */
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+/**
+ * \brief Write trees in compact encoding.  Training statistics are dropped, split
+ *        conditions are stored as indices into tables of distinct split values for each
+ *        feature and leaf values are quantized with a scale for each tree.  Only numerical
+ *        trees are supported.
+ *
+ * \param trees      Trees to be written.
+ * \param n_features Number of features in the model.
+ * \param type       Encoding of leaf values.
+ * \param fo         Output stream.
+ *
+ * \return The upper bound of absolute error in margin caused by quantizing leaf values,
+ *         which is also recorded in the output.
+ */
+double SaveCompactTrees(std::vector<RegTree> const& trees, bst_feature_t n_features,
+                        CompactLeafType type, dmlc::Stream* fo);
+
+/**
+ * \brief Read trees written by `SaveCompactTrees`.  Restored trees have zero statistics,
+ *        hence can not be used for SHAP values or further training.
+ *
+ * \return The recorded upper bound of absolute error in margin.
+ */
+double LoadCompactTrees(dmlc::Stream* fi, std::vector<RegTree>* out_trees);
+}  // namespace xgboost
+#endif  // XGBOOST_TREE_COMPACT_TREE_H_
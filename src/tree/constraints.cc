@@ -2,12 +2,12 @@
  * Copyright 2018-2019 by Contributors
  */
 #include <algorithm>
-#include <unordered_set>
 #include <vector>
 
 #include "xgboost/span.h"
 #include "xgboost/json.h"
 #include "constraints.h"
+#include "../common/bitfield.h"
 #include "param.h"
 
 namespace xgboost {
@@ -28,8 +28,6 @@ void FeatureInteractionConstraintHost::Reset() {
   if (!enabled_) {
     return;
   }
-  // Read std::vector<std::vector<bst_feature_t>> first and then
-  //   convert to std::vector<std::unordered_set<bst_feature_t>>
   std::vector<std::vector<bst_feature_t>> tmp;
   try {
     ParseInteractionConstraint(this->interaction_constraint_str_, &tmp);
@@ -38,66 +36,69 @@ void FeatureInteractionConstraintHost::Reset() {
                << this->interaction_constraint_str_ << "\n"
                << "With error:\n" << e.what();
   }
-  for (const auto& e : tmp) {
-    interaction_constraints_.emplace_back(e.begin(), e.end());
+  n_words_ = std::max(LBitField64::ComputeStorageSize(n_features_), static_cast<size_t>(1));
+  interaction_constraints_.clear();
+  interaction_constraints_.resize(tmp.size() * n_words_, 0);
+  for (size_t i = 0; i < tmp.size(); ++i) {
+    LBitField64 bits{common::Span<BitFieldValue>{interaction_constraints_}.subspan(
+        i * n_words_, n_words_)};
+    for (auto fid : tmp[i]) {
+      CHECK_LT(fid, n_features_) << "Feature index in interaction constraint is out of range.";
+      bits.Set(fid);
+    }
   }
 
   // Initialise interaction constraints record with all variables permitted for the first node
   node_constraints_.clear();
-  node_constraints_.resize(1, std::unordered_set<bst_feature_t>());
-  node_constraints_[0].reserve(n_features_);
+  node_constraints_.resize(n_words_, 0);
+  LBitField64 root{common::Span<BitFieldValue>{node_constraints_}};
   for (bst_feature_t i = 0; i < n_features_; ++i) {
-    node_constraints_[0].insert(i);
+    root.Set(i);
   }
 
   // Initialise splits record
   splits_.clear();
-  splits_.resize(1, std::unordered_set<bst_feature_t>());
+  splits_.resize(n_words_, 0);
 }
 
 void FeatureInteractionConstraintHost::SplitImpl(
     bst_node_t node_id, bst_feature_t feature_id, bst_node_t left_id, bst_node_t right_id) {
   bst_node_t newsize = std::max(left_id, right_id) + 1;
-
-  // Record previous splits for child nodes
-  auto feature_splits = splits_[node_id];  // fid history of current node
-  feature_splits.insert(feature_id);  // add feature of current node
-  splits_.resize(newsize);
-  splits_[left_id] = feature_splits;
-  splits_[right_id] = feature_splits;
-
-  // Resize constraints record, initialise all features to be not permitted for new nodes
   CHECK_NE(newsize, 0);
-  node_constraints_.resize(newsize, std::unordered_set<bst_feature_t>());
-
-  // Permit features used in previous splits
-  for (bst_feature_t fid : feature_splits) {
-    node_constraints_[left_id].insert(fid);
-    node_constraints_[right_id].insert(fid);
-  }
+  // New nodes have no feature permitted, resizing keeps records of existing nodes.
+  auto n_nodes = std::max(static_cast<size_t>(newsize), splits_.size() / n_words_);
+  splits_.resize(n_nodes * n_words_, 0);
+  node_constraints_.resize(n_nodes * n_words_, 0);
 
-  // Loop across specified interactions in constraints
-  for (const auto &constraint : interaction_constraints_) {
-    // flags whether the specified interaction is still relevant
-    bst_uint flag = 1;
+  // Record previous splits for child nodes, fid history of current node plus the feature
+  // of current node.
+  std::vector<BitFieldValue> feature_splits(splits_.cbegin() + node_id * n_words_,
+                                            splits_.cbegin() + (node_id + 1) * n_words_);
+  LBitField64{common::Span<BitFieldValue>{feature_splits}}.Set(feature_id);
 
-    // Test relevance of specified interaction by checking all previous
-    // features are included
-    for (bst_uint checkvar : feature_splits) {
-      if (constraint.count(checkvar) == 0) {
-        flag = 0;
-        break;   // interaction is not relevant due to unmet constraint
+  // Permit features used in previous splits, then all other features of interactions that
+  // are still relevant, which are the ones including all previous features.
+  std::vector<BitFieldValue> allowed{feature_splits};
+  for (size_t c = 0; c < interaction_constraints_.size() / n_words_; ++c) {
+    auto const *constraint = interaction_constraints_.data() + c * n_words_;
+    bool relevant = true;
+    for (size_t w = 0; w < n_words_; ++w) {
+      if ((feature_splits[w] & ~constraint[w]) != 0) {
+        relevant = false;
+        break;
       }
     }
-
-    // If interaction is still relevant, permit all other features in the
-    // interaction
-    if (flag == 1) {
-      for (bst_uint k : constraint) {
-        node_constraints_[left_id].insert(k);
-        node_constraints_[right_id].insert(k);
+    if (relevant) {
+      for (size_t w = 0; w < n_words_; ++w) {
+        allowed[w] |= constraint[w];
       }
     }
   }
+
+  for (auto nid : {left_id, right_id}) {
+    std::copy(feature_splits.cbegin(), feature_splits.cend(),
+              splits_.begin() + nid * n_words_);
+    std::copy(allowed.cbegin(), allowed.cend(), node_constraints_.begin() + nid * n_words_);
+  }
 }
 }  // namespace xgboost
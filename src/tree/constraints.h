@@ -5,36 +5,41 @@
 #define XGBOOST_TREE_CONSTRAINTS_H_
 
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 #include "xgboost/span.h"
 #include "xgboost/base.h"
 
 #include "param.h"
+#include "../common/bitfield.h"
 
 namespace xgboost {
 /*!
  * \brief Feature interaction constraint implementation for CPU tree updaters.
  *
- * The interface is similar to the one for GPU Hist.
+ * The interface is similar to the one for GPU Hist.  Feature sets are stored as bitsets
+ * with `n_words_` words each, so a query is a single bit test and the allowed features of
+ * a child node are computed with bitwise operations.
  */
 class FeatureInteractionConstraintHost {
  protected:
+  using BitFieldValue = LBitField64::value_type;
+  // number of words in the bitset of a feature set
+  size_t n_words_{0};
   // interaction_constraints_[constraint_id] contains a single interaction
   //   constraint, which specifies a group of feature IDs that can interact
   //   with each other
-  std::vector< std::unordered_set<bst_feature_t> > interaction_constraints_;
-  // int_cont_[nid] contains the set of all feature IDs that are allowed to
+  std::vector<BitFieldValue> interaction_constraints_;
+  // node_constraints_[nid] contains the set of all feature IDs that are allowed to
   //   be used for a split at node nid
-  std::vector< std::unordered_set<bst_feature_t> > node_constraints_;
+  std::vector<BitFieldValue> node_constraints_;
   // splits_[nid] contains the set of all feature IDs that have been used for
   //   splits in node nid and its parents
-  std::vector< std::unordered_set<bst_feature_t> > splits_;
+  std::vector<BitFieldValue> splits_;
   // string passed by user.
   std::string interaction_constraint_str_;
   // number of features in DMatrix/Booster
-  bst_feature_t n_features_;
+  bst_feature_t n_features_{0};
   bool enabled_{false};
 
   void SplitImpl(int32_t node_id, bst_feature_t feature_id, bst_node_t left_id,
@@ -51,9 +56,18 @@ class FeatureInteractionConstraintHost {
     }
   }
 
+  bool Enabled() const { return enabled_; }
+
+  /*! \brief Bitset of features allowed for splitting the node, only valid when enabled. */
+  CLBitField64 NodeFeatures(bst_node_t nid) const {
+    auto node_bits = common::Span<BitFieldValue const>{node_constraints_}.subspan(
+        static_cast<size_t>(nid) * n_words_, n_words_);
+    return CLBitField64{node_bits};
+  }
+
   bool Query(bst_node_t nid, bst_feature_t fid) const {
     if (!enabled_) { return true; }
-    return node_constraints_.at(nid).find(fid) != node_constraints_.at(nid).cend();
+    return fid < n_features_ && this->NodeFeatures(nid).Check(fid);
   }
 
   void Reset();
@@ -0,0 +1,59 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include "exact_columns.h"
+
+#include "xgboost/logging.h"
+#include "../common/threading_utils.h"
+
+namespace xgboost {
+namespace tree {
+constexpr uint32_t ExactColumns::kNewValue;
+constexpr uint32_t ExactColumns::kRowMask;
+constexpr uint32_t ExactColumns::kInvalidRank;
+
+void ExactColumns::Init(DMatrix* p_fmat, int32_t n_threads) {
+  auto const& info = p_fmat->Info();
+  CHECK_LE(info.num_row_, static_cast<bst_row_t>(kRowMask))
+      << "Exact tree method supports at most " << kRowMask << " rows.";
+  CHECK(p_fmat->SingleColBlock());
+  n_rows_ = info.num_row_;
+  n_nonzero_ = info.num_nonzero_;
+
+  for (auto const& batch : p_fmat->GetBatches<SortedCSCPage>()) {
+    auto page = batch.GetView();
+    auto n_features = batch.Size();
+    entry_ptr_.resize(n_features + 1);
+    value_ptr_.resize(n_features + 1);
+    entry_ptr_[0] = value_ptr_[0] = 0;
+    // count distinct values
+    std::vector<size_t> n_values(n_features, 0);
+    common::ParallelFor(n_features, n_threads, common::Sched::Dyn(), [&](size_t fidx) {
+      auto col = page[fidx];
+      for (size_t i = 0; i < col.size(); ++i) {
+        n_values[fidx] += i == 0 || col[i].fvalue != col[i - 1].fvalue;
+      }
+    });
+    for (size_t fidx = 0; fidx < n_features; ++fidx) {
+      entry_ptr_[fidx + 1] = entry_ptr_[fidx] + page[fidx].size();
+      value_ptr_[fidx + 1] = value_ptr_[fidx] + n_values[fidx];
+    }
+    entries_.resize(entry_ptr_.back());
+    values_.resize(value_ptr_.back());
+    common::ParallelFor(n_features, n_threads, common::Sched::Dyn(), [&](size_t fidx) {
+      auto col = page[fidx];
+      auto out = entries_.data() + entry_ptr_[fidx];
+      auto value = values_.data() + value_ptr_[fidx];
+      for (size_t i = 0; i < col.size(); ++i) {
+        uint32_t mark = 0;
+        if (i == 0 || col[i].fvalue != col[i - 1].fvalue) {
+          *value++ = col[i].fvalue;
+          mark = kNewValue;
+        }
+        out[i] = static_cast<uint32_t>(col[i].index) | mark;
+      }
+    });
+  }
+}
+}  // namespace tree
+}  // namespace xgboost
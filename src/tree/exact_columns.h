@@ -0,0 +1,67 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file exact_columns.h
+ * \brief Compact column store for the exact tree method.
+ */
+#ifndef XGBOOST_TREE_EXACT_COLUMNS_H_
+#define XGBOOST_TREE_EXACT_COLUMNS_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "xgboost/base.h"
+#include "xgboost/data.h"
+#include "xgboost/span.h"
+
+namespace xgboost {
+namespace tree {
+/**
+ * \brief Columns sorted by feature value, with each entry stored as a 32 bit row index
+ *        instead of the 8 bytes `Entry`.  Entries with the same value are consecutive, the
+ *        first one of each group is marked with the highest bit and the distinct values
+ *        are stored once for each column.  While enumerating splits, the rank of the
+ *        current value is obtained by counting marks, so comparing values becomes
+ *        comparing ranks and the actual value is only needed when a split is proposed.
+ *
+ *   Built from the `SortedCSCPage` of a DMatrix, then shared by all trees trained on it.
+ */
+class ExactColumns {
+  std::vector<size_t> entry_ptr_;
+  std::vector<uint32_t> entries_;
+  std::vector<size_t> value_ptr_;
+  std::vector<float> values_;
+  bst_row_t n_rows_{0};
+  size_t n_nonzero_{0};
+
+ public:
+  static constexpr uint32_t kNewValue = 1u << 31;
+  static constexpr uint32_t kRowMask = kNewValue - 1;
+  static constexpr uint32_t kInvalidRank = std::numeric_limits<uint32_t>::max();
+
+  struct Column {
+    common::Span<uint32_t const> entries;
+    common::Span<float const> values;
+  };
+
+  void Init(DMatrix* p_fmat, int32_t n_threads);
+  /*! \brief Whether this is built from a DMatrix of the same shape. */
+  bool Matches(MetaInfo const& info) const {
+    return !entry_ptr_.empty() && n_rows_ == info.num_row_ &&
+           n_nonzero_ == info.num_nonzero_ && NumFeatures() == info.num_col_;
+  }
+
+  size_t NumFeatures() const { return entry_ptr_.empty() ? 0 : entry_ptr_.size() - 1; }
+  Column operator[](bst_feature_t fidx) const {
+    auto beg = entry_ptr_[fidx], end = entry_ptr_[fidx + 1];
+    auto vbeg = value_ptr_[fidx], vend = value_ptr_[fidx + 1];
+    return {{entries_.data() + beg, end - beg}, {values_.data() + vbeg, vend - vbeg}};
+  }
+  size_t MemCostBytes() const {
+    return entries_.size() * sizeof(uint32_t) + values_.size() * sizeof(float) +
+           (entry_ptr_.size() + value_ptr_.size()) * sizeof(size_t);
+  }
+};
+}  // namespace tree
+}  // namespace xgboost
+#endif  // XGBOOST_TREE_EXACT_COLUMNS_H_
@@ -2,6 +2,7 @@
  * Copyright 2020 by XGBoost Contributors
  */
 #include <limits>
+#include <vector>
 #include "evaluate_splits.cuh"
 #include "../../common/categorical.h"
 
@@ -209,8 +210,8 @@ __device__ void EvaluateFeature(
 
 template <int BLOCK_THREADS, typename GradientSumT>
 __global__ void EvaluateSplitsKernel(
-    EvaluateSplitInputs<GradientSumT> left,
-    EvaluateSplitInputs<GradientSumT> right,
+    common::Span<EvaluateSplitInputs<GradientSumT> const> d_inputs,
+    common::Span<size_t const> feature_offsets,
     TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
     common::Span<DeviceSplitCandidate> out_candidates) {
   // KeyValuePair here used as threadIdx.x -> gain_value
@@ -238,13 +239,12 @@ __global__ void EvaluateSplitsKernel(
 
   __syncthreads();
 
-  // If this block is working on the left or right node
-  bool is_left = blockIdx.x < left.feature_set.size();
-  EvaluateSplitInputs<GradientSumT>& inputs = is_left ? left : right;
+  // One block for each feature of each node.
+  size_t node = dh::SegmentId(feature_offsets, blockIdx.x);
+  EvaluateSplitInputs<GradientSumT> const inputs = d_inputs[node];
 
-  // One block for each feature. Features are sampled, so fidx != blockIdx.x
-  int fidx = inputs.feature_set[is_left ? blockIdx.x
-                                        : blockIdx.x - left.feature_set.size()];
+  // Features are sampled, so fidx != blockIdx.x
+  int fidx = inputs.feature_set[blockIdx.x - feature_offsets[node]];
   if (common::IsCat(inputs.feature_types, fidx)) {
     EvaluateFeature<BLOCK_THREADS, SumReduceT, BlockScanT, MaxReduceT,
                     TempStorage, GradientSumT,
@@ -275,33 +275,38 @@ __device__ DeviceSplitCandidate operator+(const DeviceSplitCandidate& a,
 template <typename GradientSumT>
 void EvaluateSplits(common::Span<DeviceSplitCandidate> out_splits,
                     TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
-                    EvaluateSplitInputs<GradientSumT> left,
-                    EvaluateSplitInputs<GradientSumT> right) {
-  size_t combined_num_features =
-      left.feature_set.size() + right.feature_set.size();
+                    std::vector<EvaluateSplitInputs<GradientSumT>> const& inputs) {
+  CHECK_EQ(out_splits.size(), inputs.size());
+  if (inputs.empty()) {
+    return;
+  }
+  std::vector<size_t> h_feature_offsets(inputs.size() + 1, 0);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    h_feature_offsets[i + 1] = h_feature_offsets[i] + inputs[i].feature_set.size();
+  }
+  size_t combined_num_features = h_feature_offsets.back();
+
+  dh::TemporaryArray<EvaluateSplitInputs<GradientSumT>> d_inputs(inputs.size());
+  dh::safe_cuda(cudaMemcpyAsync(d_inputs.data().get(), inputs.data(),
+                                inputs.size() * sizeof(EvaluateSplitInputs<GradientSumT>),
+                                cudaMemcpyHostToDevice));
+  dh::TemporaryArray<size_t> feature_offsets(h_feature_offsets.size());
+  dh::safe_cuda(cudaMemcpyAsync(feature_offsets.data().get(), h_feature_offsets.data(),
+                                h_feature_offsets.size() * sizeof(size_t),
+                                cudaMemcpyHostToDevice));
+
   dh::TemporaryArray<DeviceSplitCandidate> feature_best_splits(
       combined_num_features);
-  // One block for each feature
-  uint32_t constexpr kBlockThreads = 256;
-  dh::LaunchKernel {uint32_t(combined_num_features), kBlockThreads, 0}(
-      EvaluateSplitsKernel<kBlockThreads, GradientSumT>, left, right, evaluator,
-      dh::ToSpan(feature_best_splits));
-
-  // Reduce to get best candidate for left and right child over all features
-  auto reduce_offset =
-      dh::MakeTransformIterator<size_t>(thrust::make_counting_iterator(0llu),
-                                        [=] __device__(size_t idx) -> size_t {
-                                          if (idx == 0) {
-                                            return 0;
-                                          }
-                                          if (idx == 1) {
-                                            return left.feature_set.size();
-                                          }
-                                          if (idx == 2) {
-                                            return combined_num_features;
-                                          }
-                                          return 0;
-                                        });
+  if (combined_num_features != 0) {
+    // One block for each feature of each node
+    uint32_t constexpr kBlockThreads = 256;
+    dh::LaunchKernel {uint32_t(combined_num_features), kBlockThreads, 0}(
+        EvaluateSplitsKernel<kBlockThreads, GradientSumT>, dh::ToSpan(d_inputs),
+        dh::ToSpan(feature_offsets), evaluator, dh::ToSpan(feature_best_splits));
+  }
+
+  // Reduce to get best candidate for each node over all features
+  auto reduce_offset = feature_offsets.data().get();
   size_t temp_storage_bytes = 0;
   auto num_segments = out_splits.size();
   cub::DeviceSegmentedReduce::Sum(nullptr, temp_storage_bytes,
@@ -313,13 +318,30 @@ void EvaluateSplits(common::Span<DeviceSplitCandidate> out_splits,
                                   num_segments, reduce_offset, reduce_offset + 1);
 }
 
+template <typename GradientSumT>
+void EvaluateSplits(common::Span<DeviceSplitCandidate> out_splits,
+                    TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
+                    EvaluateSplitInputs<GradientSumT> left,
+                    EvaluateSplitInputs<GradientSumT> right) {
+  EvaluateSplits(out_splits, evaluator,
+                 std::vector<EvaluateSplitInputs<GradientSumT>>{left, right});
+}
+
 template <typename GradientSumT>
 void EvaluateSingleSplit(common::Span<DeviceSplitCandidate> out_split,
                          TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
                          EvaluateSplitInputs<GradientSumT> input) {
-  EvaluateSplits(out_split, evaluator, input, {});
+  EvaluateSplits(out_split, evaluator, std::vector<EvaluateSplitInputs<GradientSumT>>{input});
 }
 
+template void EvaluateSplits<GradientPair>(
+    common::Span<DeviceSplitCandidate> out_splits,
+    TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
+    std::vector<EvaluateSplitInputs<GradientPair>> const& inputs);
+template void EvaluateSplits<GradientPairPrecise>(
+    common::Span<DeviceSplitCandidate> out_splits,
+    TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
+    std::vector<EvaluateSplitInputs<GradientPairPrecise>> const& inputs);
 template void EvaluateSplits<GradientPair>(
     common::Span<DeviceSplitCandidate> out_splits,
     TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
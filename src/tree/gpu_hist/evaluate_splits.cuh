@@ -4,6 +4,9 @@
 #ifndef EVALUATE_SPLITS_CUH_
 #define EVALUATE_SPLITS_CUH_
 #include <xgboost/span.h>
+
+#include <vector>
+
 #include "../../data/ellpack_page.cuh"
 #include "../split_evaluator.h"
 #include "../constraints.cuh"
@@ -24,6 +27,19 @@ struct EvaluateSplitInputs {
   common::Span<const float> min_fvalue;
   common::Span<const GradientSumT> gradient_histogram;
 };
+/**
+ * \brief Evaluate splits for a batch of nodes with a single kernel launch, one block for
+ *        each feature of each node.
+ *
+ * \param out_splits Best split of each node, in device memory.
+ * \param evaluator  Split evaluator.
+ * \param inputs     Inputs of each node, device memory referenced by the inputs must stay
+ *                   valid until the evaluation is finished on the device.
+ */
+template <typename GradientSumT>
+void EvaluateSplits(common::Span<DeviceSplitCandidate> out_splits,
+                    TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
+                    std::vector<EvaluateSplitInputs<GradientSumT>> const& inputs);
 template <typename GradientSumT>
 void EvaluateSplits(common::Span<DeviceSplitCandidate> out_splits,
                     TreeEvaluator::SplitEvaluator<GPUTrainingParam> evaluator,
@@ -147,8 +147,8 @@ class PoissonSampling : public thrust::binary_function<GradientPair, size_t, Gra
 
 NoSampling::NoSampling(EllpackPageImpl const* page) : page_(page) {}
 
-GradientBasedSample NoSampling::Sample(common::Span<GradientPair> gpair, DMatrix* dmat) {
-  return {dmat->Info().num_row_, page_, gpair};
+GradientBasedSample NoSampling::Sample(common::Span<GradientPair> gpair, DMatrix*) {
+  return {page_->n_rows, page_, gpair};
 }
 
 ExternalMemoryNoSampling::ExternalMemoryNoSampling(EllpackPageImpl const* page,
@@ -176,13 +176,13 @@ GradientBasedSample ExternalMemoryNoSampling::Sample(common::Span<GradientPair>
 UniformSampling::UniformSampling(EllpackPageImpl const* page, float subsample)
     : page_(page), subsample_(subsample) {}
 
-GradientBasedSample UniformSampling::Sample(common::Span<GradientPair> gpair, DMatrix* dmat) {
+GradientBasedSample UniformSampling::Sample(common::Span<GradientPair> gpair, DMatrix*) {
   // Set gradient pair to 0 with p = 1 - subsample
   thrust::replace_if(dh::tbegin(gpair), dh::tend(gpair),
                      thrust::counting_iterator<size_t>(0),
                      BernoulliTrial(common::GlobalRandom()(), subsample_),
                      GradientPair());
-  return {dmat->Info().num_row_, page_, gpair};
+  return {page_->n_rows, page_, gpair};
 }
 
 ExternalMemoryUniformSampling::ExternalMemoryUniformSampling(EllpackPageImpl const* page,
@@ -243,8 +243,8 @@ GradientBasedSampling::GradientBasedSampling(EllpackPageImpl const* page,
       grad_sum_(n_rows, 0.0f) {}
 
 GradientBasedSample GradientBasedSampling::Sample(common::Span<GradientPair> gpair,
-                                                  DMatrix* dmat) {
-  size_t n_rows = dmat->Info().num_row_;
+                                                  DMatrix*) {
+  size_t n_rows = page_->n_rows;
   size_t threshold_index = GradientBasedSampler::CalculateThresholdIndex(
       gpair, dh::ToSpan(threshold_), dh::ToSpan(grad_sum_), n_rows * subsample_);
 
@@ -315,6 +315,54 @@ GradientBasedSample ExternalMemoryGradientBasedSampling::Sample(common::Span<Gra
   return {sample_rows, page_.get(), dh::ToSpan(gpair_)};
 }
 
+ExternalMemoryGradientBasedIndexSampling::ExternalMemoryGradientBasedIndexSampling(
+    EllpackPageImpl const* page,
+    size_t n_rows,
+    BatchParam batch_param,
+    float subsample)
+    : batch_param_(std::move(batch_param)),
+      subsample_(subsample),
+      threshold_(n_rows + 1, 0.0f),
+      grad_sum_(n_rows, 0.0f),
+      page_(new EllpackPageImpl(batch_param_.gpu_id, page->Cuts(), page->is_dense,
+                                page->row_stride, n_rows)),
+      row_index_(n_rows) {}
+
+GradientBasedSample ExternalMemoryGradientBasedIndexSampling::Sample(
+    common::Span<GradientPair> gpair, DMatrix* dmat) {
+  if (!page_concatenated_) {
+    // Concatenate all the external memory ELLPACK pages into a single in-memory page.
+    size_t offset = 0;
+    for (auto& batch : dmat->GetBatches<EllpackPage>(batch_param_)) {
+      auto page = batch.Impl();
+      size_t num_elements = page_->Copy(batch_param_.gpu_id, page, offset);
+      offset += num_elements;
+    }
+    page_concatenated_ = true;
+  }
+
+  size_t n_rows = dmat->Info().num_row_;
+  size_t threshold_index = GradientBasedSampler::CalculateThresholdIndex(
+      gpair, dh::ToSpan(threshold_), dh::ToSpan(grad_sum_), n_rows * subsample_);
+
+  // Perform Poisson sampling in place.
+  thrust::transform(dh::tbegin(gpair), dh::tend(gpair),
+                    thrust::counting_iterator<size_t>(0),
+                    dh::tbegin(gpair),
+                    PoissonSampling(dh::ToSpan(threshold_),
+                                    threshold_index,
+                                    RandomWeight(common::GlobalRandom()())));
+
+  // Index the sample rows, the page and gradient pairs are left as they are.
+  auto end = thrust::copy_if(thrust::counting_iterator<bst_uint>(0),
+                             thrust::counting_iterator<bst_uint>(n_rows), dh::tbegin(gpair),
+                             row_index_.begin(), IsNonZero());
+  size_t sample_rows = thrust::distance(row_index_.begin(), end);
+
+  return {sample_rows, page_.get(), gpair,
+          common::Span<bst_uint const>{row_index_.data().get(), sample_rows}};
+}
+
 GradientBasedSampler::GradientBasedSampler(EllpackPageImpl const* page,
                                            size_t n_rows,
                                            const BatchParam& batch_param,
@@ -335,7 +383,11 @@ GradientBasedSampler::GradientBasedSampler(EllpackPageImpl const* page,
         }
         break;
       case TrainParam::kGradientBased:
-        if (is_external_memory) {
+        if (is_external_memory &&
+            ConcatenatedPageFits(page, n_rows, batch_param.gpu_id)) {
+          strategy_.reset(new ExternalMemoryGradientBasedIndexSampling(
+              page, n_rows, batch_param, subsample));
+        } else if (is_external_memory) {
           strategy_.reset(
               new ExternalMemoryGradientBasedSampling(page, n_rows, batch_param, subsample));
         } else {
@@ -362,6 +414,14 @@ GradientBasedSample GradientBasedSampler::Sample(common::Span<GradientPair> gpai
   return sample;
 }
 
+bool GradientBasedSampler::ConcatenatedPageFits(EllpackPageImpl const* page, size_t n_rows,
+                                                int device) {
+  // Leave the rest for the row partitioner, histograms and the pages being read.
+  double constexpr kMemoryFraction = 0.5;
+  size_t page_bytes = EllpackPageImpl::MemCostBytes(n_rows, page->row_stride, page->Cuts());
+  return page_bytes < dh::AvailableMemory(device) * kMemoryFraction;
+}
+
 size_t GradientBasedSampler::CalculateThresholdIndex(
     common::Span<GradientPair> gpair, common::Span<float> threshold,
     common::Span<float> grad_sum, size_t sample_rows) {
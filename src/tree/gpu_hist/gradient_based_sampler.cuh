@@ -19,6 +19,9 @@ struct GradientBasedSample {
   EllpackPageImpl const* page;
   /*!\brief Gradient pairs for the sampled rows. */
   common::Span<GradientPair> gpair;
+  /*!\brief Indices of the sampled rows in page when the page is not compacted, empty
+   *         otherwise.  Gradient pairs are indexed by the rows of page. */
+  common::Span<bst_uint const> row_index;
 };
 
 class SamplingStrategy {
@@ -117,6 +120,31 @@ class ExternalMemoryGradientBasedSampling : public SamplingStrategy {
   dh::caching_device_vector<size_t> sample_row_index_;
 };
 
+/*!
+ * \brief Gradient-based sampling in external memory mode, without compaction.
+ *
+ * All pages are concatenated into a single device page once, sampled rows are passed to
+ * the tree updater as an index list into that page instead of being copied into a new page
+ * every iteration.  Used when the concatenated page fits in device memory.
+ */
+class ExternalMemoryGradientBasedIndexSampling : public SamplingStrategy {
+ public:
+  ExternalMemoryGradientBasedIndexSampling(EllpackPageImpl const* page,
+                                           size_t n_rows,
+                                           BatchParam batch_param,
+                                           float subsample);
+  GradientBasedSample Sample(common::Span<GradientPair> gpair, DMatrix* dmat) override;
+
+ private:
+  BatchParam batch_param_;
+  float subsample_;
+  dh::caching_device_vector<float> threshold_;
+  dh::caching_device_vector<float> grad_sum_;
+  std::unique_ptr<EllpackPageImpl> page_;
+  bool page_concatenated_{false};
+  dh::caching_device_vector<bst_uint> row_index_;
+};
+
 /*! \brief Draw a sample of rows from a DMatrix.
  *
  * \see Ke, G., Meng, Q., Finley, T., Wang, T., Chen, W., Ma, W., ... & Liu, T. Y. (2017).
@@ -142,6 +170,8 @@ class GradientBasedSampler {
                                         common::Span<float> threshold,
                                         common::Span<float> grad_sum,
                                         size_t sample_rows);
+  /*! \brief Whether all pages concatenated into a single page fit in device memory. */
+  static bool ConcatenatedPageFits(EllpackPageImpl const* page, size_t n_rows, int device);
 
  private:
   common::Monitor monitor_;
@@ -125,28 +125,28 @@ template HistRounding<GradientPair>
 CreateRoundingFactor(common::Span<GradientPair const> gpair);
 
 template <typename GradientSumT, bool use_shared_memory_histograms>
-__global__ void SharedMemHistKernel(EllpackDeviceAccessor matrix,
-                                    FeatureGroupsAccessor feature_groups,
-                                    common::Span<const RowPartitioner::RowIndexT> d_ridx,
-                                    GradientSumT* __restrict__ d_node_hist,
-                                    const GradientPair* __restrict__ d_gpair,
-                                    HistRounding<GradientSumT> const rounding) {
-  using SharedSumT = typename HistRounding<GradientSumT>::SharedSumT;
+__device__ void BuildNodeHistogram(EllpackDeviceAccessor const& matrix,
+                                   FeatureGroup const& group,
+                                   common::Span<const RowPartitioner::RowIndexT> d_ridx,
+                                   GradientSumT* __restrict__ d_node_hist,
+                                   const GradientPair* __restrict__ d_gpair,
+                                   HistRounding<GradientSumT> const& rounding,
+                                   typename HistRounding<GradientSumT>::SharedSumT* smem_arr) {
   using T = typename GradientSumT::ValueT;
-
-  extern __shared__ char smem[];
-  FeatureGroup group = feature_groups[blockIdx.y];
-  SharedSumT *smem_arr = reinterpret_cast<SharedSumT *>(smem);
   if (use_shared_memory_histograms) {
-    dh::BlockFill(smem_arr, group.num_bins, SharedSumT());
+    dh::BlockFill(smem_arr, group.num_bins, typename HistRounding<GradientSumT>::SharedSumT());
     __syncthreads();
   }
   int feature_stride = matrix.is_dense ? group.num_features : matrix.row_stride;
   size_t n_elements = feature_stride * d_ridx.size();
   for (auto idx : dh::GridStrideRange(static_cast<size_t>(0), n_elements)) {
     int ridx = d_ridx[idx / feature_stride];
-    int gidx = matrix.gidx_iter[ridx * matrix.row_stride + group.start_feature +
-                                idx % feature_stride];
+    size_t column = group.start_feature + idx % feature_stride;
+    int gidx = matrix.gidx_iter[ridx * matrix.row_stride + column];
+    if (matrix.is_dense) {
+      // Dense matrix stores the bin relative to its feature.
+      gidx += matrix.feature_segments[column];
+    }
     if (gidx != matrix.NumBins()) {
       // If we are not using shared memory, accumulate the values directly into
       // global memory
@@ -176,14 +176,50 @@ __global__ void SharedMemHistKernel(EllpackDeviceAccessor matrix,
   }
 }
 
-template <typename GradientSumT>
-void BuildGradientHistogram(EllpackDeviceAccessor const& matrix,
-                            FeatureGroupsAccessor const& feature_groups,
-                            common::Span<GradientPair const> gpair,
-                            common::Span<const uint32_t> d_ridx,
-                            common::Span<GradientSumT> histogram,
-                            HistRounding<GradientSumT> rounding,
-                            bool force_global_memory) {
+template <typename GradientSumT, bool use_shared_memory_histograms>
+__global__ void SharedMemHistKernel(EllpackDeviceAccessor matrix,
+                                    FeatureGroupsAccessor feature_groups,
+                                    common::Span<const RowPartitioner::RowIndexT> d_ridx,
+                                    GradientSumT* __restrict__ d_node_hist,
+                                    const GradientPair* __restrict__ d_gpair,
+                                    HistRounding<GradientSumT> const rounding) {
+  using SharedSumT = typename HistRounding<GradientSumT>::SharedSumT;
+  extern __shared__ char smem[];
+  FeatureGroup group = feature_groups[blockIdx.y];
+  BuildNodeHistogram<GradientSumT, use_shared_memory_histograms>(
+      matrix, group, d_ridx, d_node_hist, d_gpair, rounding,
+      reinterpret_cast<SharedSumT *>(smem));
+}
+
+/**
+ * \brief Same as `SharedMemHistKernel`, with the node selected by `blockIdx.z`.
+ */
+template <typename GradientSumT, bool use_shared_memory_histograms>
+__global__ void SharedMemHistBatchKernel(
+    EllpackDeviceAccessor matrix, FeatureGroupsAccessor feature_groups,
+    common::Span<HistogramSegment<GradientSumT> const> segments,
+    const GradientPair* __restrict__ d_gpair, HistRounding<GradientSumT> const rounding) {
+  using SharedSumT = typename HistRounding<GradientSumT>::SharedSumT;
+  extern __shared__ char smem[];
+  FeatureGroup group = feature_groups[blockIdx.y];
+  HistogramSegment<GradientSumT> segment = segments[blockIdx.z];
+  BuildNodeHistogram<GradientSumT, use_shared_memory_histograms>(
+      matrix, group, segment.ridx, segment.histogram, d_gpair, rounding,
+      reinterpret_cast<SharedSumT *>(smem));
+}
+
+namespace {
+/**
+ * \brief Launch a histogram kernel with shared memory if the largest feature group fits.
+ *
+ * \param n_nodes Number of nodes processed by the launch, one grid layer each.
+ * \param launch  Callable taking the kernel instance, grid and block size, shared memory
+ *                size.
+ */
+template <typename GradientSumT, typename SharedKernel, typename GlobalKernel, typename Fn>
+void LaunchHistKernel(FeatureGroupsAccessor const& feature_groups, bool force_global_memory,
+                      uint32_t n_nodes, SharedKernel shared_kernel, GlobalKernel global_kernel,
+                      Fn&& launch) {
   // decide whether to use shared memory
   int device = 0;
   dh::safe_cuda(cudaGetDevice(&device));
@@ -230,22 +266,61 @@ void BuildGradientHistogram(EllpackDeviceAccessor const& matrix,
     int num_groups_threshold = 4;
     grid_size = common::DivRoundUp(
         grid_size, common::DivRoundUp(num_groups, num_groups_threshold));
+    // Nodes share the device, at least one block for each node.
+    grid_size = std::max(grid_size / n_nodes, 1u);
 
-    using T = typename GradientSumT::ValueT;
-    dh::LaunchKernel {dim3(grid_size, num_groups),
-          static_cast<uint32_t>(block_threads),
-          smem_size} (kernel, matrix, feature_groups, d_ridx,
-                      histogram.data(), gpair.data(), rounding);
+    launch(kernel, dim3(grid_size, num_groups, n_nodes),
+           static_cast<uint32_t>(block_threads), smem_size);
   };
 
   if (shared) {
-    runit(SharedMemHistKernel<GradientSumT, true>);
+    runit(shared_kernel);
   } else {
-    runit(SharedMemHistKernel<GradientSumT, false>);
+    runit(global_kernel);
   }
 
   dh::safe_cuda(cudaGetLastError());
 }
+}  // anonymous namespace
+
+template <typename GradientSumT>
+void BuildGradientHistogram(EllpackDeviceAccessor const& matrix,
+                            FeatureGroupsAccessor const& feature_groups,
+                            common::Span<GradientPair const> gpair,
+                            common::Span<const uint32_t> d_ridx,
+                            common::Span<GradientSumT> histogram,
+                            HistRounding<GradientSumT> rounding,
+                            bool force_global_memory) {
+  LaunchHistKernel<GradientSumT>(
+      feature_groups, force_global_memory, 1, SharedMemHistKernel<GradientSumT, true>,
+      SharedMemHistKernel<GradientSumT, false>,
+      [&](auto kernel, dim3 grid, uint32_t block_threads, size_t smem_size) {
+        dh::LaunchKernel {grid, block_threads, smem_size} (
+            kernel, matrix, feature_groups, d_ridx, histogram.data(), gpair.data(), rounding);
+      });
+}
+
+template <typename GradientSumT>
+void BuildGradientHistogram(EllpackDeviceAccessor const& matrix,
+                            FeatureGroupsAccessor const& feature_groups,
+                            common::Span<GradientPair const> gpair,
+                            common::Span<HistogramSegment<GradientSumT> const> segments,
+                            HistRounding<GradientSumT> rounding,
+                            bool force_global_memory) {
+  // Grid dimension z is limited to 65535.
+  constexpr size_t kMaxNodes = 65535;
+  for (size_t begin = 0; begin < segments.size(); begin += kMaxNodes) {
+    auto batch = segments.subspan(begin, std::min(kMaxNodes, segments.size() - begin));
+    LaunchHistKernel<GradientSumT>(
+        feature_groups, force_global_memory, static_cast<uint32_t>(batch.size()),
+        SharedMemHistBatchKernel<GradientSumT, true>,
+        SharedMemHistBatchKernel<GradientSumT, false>,
+        [&](auto kernel, dim3 grid, uint32_t block_threads, size_t smem_size) {
+          dh::LaunchKernel {grid, block_threads, smem_size} (
+              kernel, matrix, feature_groups, batch, gpair.data(), rounding);
+        });
+  }
+}
 
 template void BuildGradientHistogram<GradientPair>(
     EllpackDeviceAccessor const& matrix,
@@ -265,5 +340,21 @@ template void BuildGradientHistogram<GradientPairPrecise>(
     HistRounding<GradientPairPrecise> rounding,
     bool force_global_memory);
 
+template void BuildGradientHistogram<GradientPair>(
+    EllpackDeviceAccessor const& matrix,
+    FeatureGroupsAccessor const& feature_groups,
+    common::Span<GradientPair const> gpair,
+    common::Span<HistogramSegment<GradientPair> const> segments,
+    HistRounding<GradientPair> rounding,
+    bool force_global_memory);
+
+template void BuildGradientHistogram<GradientPairPrecise>(
+    EllpackDeviceAccessor const& matrix,
+    FeatureGroupsAccessor const& feature_groups,
+    common::Span<GradientPair const> gpair,
+    common::Span<HistogramSegment<GradientPairPrecise> const> segments,
+    HistRounding<GradientPairPrecise> rounding,
+    bool force_global_memory);
+
 }  // namespace tree
 }  // namespace xgboost
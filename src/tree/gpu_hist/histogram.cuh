@@ -63,6 +63,30 @@ void BuildGradientHistogram(EllpackDeviceAccessor const& matrix,
                             common::Span<GradientSumT> histogram,
                             HistRounding<GradientSumT> rounding,
                             bool force_global_memory = false);
+
+/**
+ * \brief Rows of a node and the output histogram, used for building histograms of
+ *        multiple nodes in a single kernel launch.
+ */
+template <typename GradientSumT>
+struct HistogramSegment {
+  common::Span<const uint32_t> ridx;
+  GradientSumT* histogram;
+};
+
+/**
+ * \brief Build histograms for a batch of nodes with one kernel launch.  Each thread block
+ *        works on a single node so the shared memory histogram is private to that node.
+ *
+ * \param segments Device span of node segments.
+ */
+template <typename GradientSumT>
+void BuildGradientHistogram(EllpackDeviceAccessor const& matrix,
+                            FeatureGroupsAccessor const& feature_groups,
+                            common::Span<GradientPair const> gpair,
+                            common::Span<HistogramSegment<GradientSumT> const> segments,
+                            HistRounding<GradientSumT> rounding,
+                            bool force_global_memory = false);
 }  // namespace tree
 }  // namespace xgboost
 
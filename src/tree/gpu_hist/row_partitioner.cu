@@ -4,6 +4,7 @@
 #include <thrust/iterator/discard_iterator.h>
 #include <thrust/iterator/transform_output_iterator.h>
 #include <thrust/sequence.h>
+#include <algorithm>
 #include <vector>
 #include "../../common/device_helpers.cuh"
 #include "row_partitioner.cuh"
@@ -97,11 +98,39 @@ RowPartitioner::RowPartitioner(int device_idx, size_t num_rows)
   Reset(device_idx, ridx_.CurrentSpan(), position_.CurrentSpan());
   left_counts_.resize(256);
   thrust::fill(left_counts_.begin(), left_counts_.end(), 0);
-  streams_.resize(2);
+  streams_.resize(1);
   for (auto& stream : streams_) {
     dh::safe_cuda(cudaStreamCreate(&stream));
   }
 }
+
+RowPartitioner::RowPartitioner(int device_idx, common::Span<RowIndexT const> ridx)
+    : RowPartitioner(device_idx, ridx.size()) {
+  dh::safe_cuda(cudaMemcpyAsync(ridx_.Current(), ridx.data(), ridx.size_bytes(),
+                                cudaMemcpyDeviceToDevice));
+}
+
+void RowPartitioner::SynchronizePositions() {
+  if (pending_.empty()) {
+    return;
+  }
+  dh::safe_cuda(cudaStreamSynchronize(streams_[0]));
+  std::vector<int64_t> h_left_counts(left_counts_.size());
+  dh::safe_cuda(cudaMemcpy(h_left_counts.data(), left_counts_.data().get(),
+                           left_counts_.size() * sizeof(int64_t), cudaMemcpyDeviceToHost));
+  for (auto const& split : pending_) {
+    Segment segment = ridx_segments_.at(split.nidx);
+    int64_t left_count = h_left_counts.at(split.nidx);
+    CHECK_LE(left_count, segment.Size());
+    CHECK_GE(left_count, 0);
+    ridx_segments_.resize(std::max(static_cast<bst_node_t>(ridx_segments_.size()),
+                                   std::max(split.left_nidx, split.right_nidx) + 1));
+    ridx_segments_[split.left_nidx] = Segment(segment.begin, segment.begin + left_count);
+    ridx_segments_[split.right_nidx] = Segment(segment.begin + left_count, segment.end);
+  }
+  pending_.clear();
+}
+
 RowPartitioner::~RowPartitioner() {
   dh::safe_cuda(cudaSetDevice(device_idx_));
   for (auto& stream : streams_) {
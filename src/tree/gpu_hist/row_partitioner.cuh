@@ -61,10 +61,20 @@ class RowPartitioner {
   dh::caching_device_vector<int64_t>
       left_counts_;  // Useful to keep a bunch of zeroed memory for sort position
   std::vector<cudaStream_t> streams_;
-  dh::PinnedMemory pinned_;
+  /*! \brief Splits whose left counts haven't been copied back to host yet. */
+  struct PendingSplit {
+    bst_node_t nidx;
+    bst_node_t left_nidx;
+    bst_node_t right_nidx;
+  };
+  std::vector<PendingSplit> pending_;
 
  public:
   RowPartitioner(int device_idx, size_t num_rows);
+  /**
+   * \brief Start from a subset of rows, all of them belong to the root node.
+   */
+  RowPartitioner(int device_idx, common::Span<RowIndexT const> ridx);
   ~RowPartitioner();
   RowPartitioner(const RowPartitioner&) = delete;
   RowPartitioner& operator=(const RowPartitioner&) = delete;
@@ -109,12 +119,24 @@ class RowPartitioner {
   template <typename UpdatePositionOpT>
   void UpdatePosition(bst_node_t nidx, bst_node_t left_nidx,
                       bst_node_t right_nidx, UpdatePositionOpT op) {
+    this->UpdatePositionAsync(nidx, left_nidx, right_nidx, op);
+    this->SynchronizePositions();
+  }
+
+  /**
+   * \brief Same as `UpdatePosition`, but the host doesn't wait for the number of rows in
+   * the left child.  Multiple nodes can be partitioned this way, followed by a single call
+   * to `SynchronizePositions` before the rows of any child node are accessed.
+   */
+  template <typename UpdatePositionOpT>
+  void UpdatePositionAsync(bst_node_t nidx, bst_node_t left_nidx,
+                           bst_node_t right_nidx, UpdatePositionOpT op) {
     Segment segment = ridx_segments_.at(nidx);  // rows belongs to node nidx
     auto d_ridx = ridx_.CurrentSpan();
     auto d_position = position_.CurrentSpan();
     if (left_counts_.size() <= nidx) {
-      left_counts_.resize((nidx * 2) + 1);
-      thrust::fill(left_counts_.begin(), left_counts_.end(), 0);
+      // Keep counts of pending splits.
+      left_counts_.resize((nidx * 2) + 1, 0);
     }
     // Now we divide the row segment into left and right node.
 
@@ -129,24 +151,16 @@ class RowPartitioner {
       AtomicIncrement(d_left_count, new_position == left_nidx);
       d_position[idx] = new_position;
     });
-    // Overlap device to host memory copy (left_count) with sort
-    int64_t &left_count = pinned_.GetSpan<int64_t>(1)[0];
-    dh::safe_cuda(cudaMemcpyAsync(&left_count, d_left_count, sizeof(int64_t),
-                                  cudaMemcpyDeviceToHost, streams_[0]));
-
-    SortPositionAndCopy(segment, left_nidx, right_nidx, d_left_count, streams_[1]);
-
-    dh::safe_cuda(cudaStreamSynchronize(streams_[0]));
-    CHECK_LE(left_count, segment.Size());
-    CHECK_GE(left_count, 0);
-    ridx_segments_.resize(std::max(static_cast<bst_node_t>(ridx_segments_.size()),
-                                   std::max(left_nidx, right_nidx) + 1));
-    ridx_segments_[left_nidx] =
-        Segment(segment.begin, segment.begin + left_count);
-    ridx_segments_[right_nidx] =
-        Segment(segment.begin + left_count, segment.end);
+    SortPositionAndCopy(segment, left_nidx, right_nidx, d_left_count, streams_[0]);
+    pending_.push_back({nidx, left_nidx, right_nidx});
   }
 
+  /**
+   * \brief Wait for all pending partitions and record the row segments of the new nodes.
+   *        Left counts of all pending splits are copied to host in one transfer.
+   */
+  void SynchronizePositions();
+
   /**
    * \brief Finalise the position of all training instances after tree
    * construction is complete. Does not update any other meta information in
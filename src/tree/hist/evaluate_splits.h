@@ -11,11 +11,16 @@
 #include <utility>
 #include <vector>
 
+#include "rabit/rabit.h"
 #include "xgboost/task.h"
 #include "../param.h"
 #include "../constraints.h"
 #include "../split_evaluator.h"
+#include "quantizer.h"
 #include "../../common/categorical.h"
+#include "../../common/column_subset.h"
+#include "../../common/feature_bundle.h"
+#include "../../common/missing_bin.h"
 #include "../../common/random.h"
 #include "../../common/hist_util.h"
 #include "../../data/gradient_index.h"
@@ -33,6 +38,8 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
   };
 
  private:
+  using GradientPairT = xgboost::detail::GradientPairInternal<GradientSumT>;
+
   TrainParam param_;
   std::shared_ptr<common::ColumnSampler> column_sampler_;
   TreeEvaluator tree_evaluator_;
@@ -40,6 +47,78 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
   FeatureInteractionConstraintHost interaction_constraints_;
   std::vector<NodeEntry> snode_;
   ObjInfo task_;
+  GradientQuantizer quantizer_;
+  // Features evaluated by this worker, best splits are synchronized among workers when
+  // each of them evaluates a different range.
+  bst_feature_t feature_begin_{0};
+  bst_feature_t feature_end_{std::numeric_limits<bst_feature_t>::max()};
+  bool sync_splits_{false};
+  // Histograms are built on bundled bins when set.
+  common::FeatureBundles const *bundles_{nullptr};
+  // Histograms are built on bins of features sampled for the tree when set.
+  common::ColumnSubset const *column_subset_{nullptr};
+  // Histograms have a bin for missing values of each feature when set.
+  common::MissingBins const *missing_bins_{nullptr};
+
+  // POD representation of a split for choosing the best one among workers, categories of
+  // partition based splits are broadcast by the winning worker.
+  struct WorkerSplit {
+    float loss_chg;
+    bst_feature_t sindex;
+    float split_value;
+    int32_t is_cat;
+    int32_t rank;
+    double left_grad, left_hess, right_grad, right_hess;
+
+    static void Reduce(WorkerSplit &dst, WorkerSplit const &src) {  // NOLINT
+      SplitEntry best;
+      best.loss_chg = dst.loss_chg;
+      best.sindex = dst.sindex;
+      if (best.NeedReplace(src.loss_chg, src.sindex & ((1U << 31) - 1U))) {
+        dst = src;
+      }
+    }
+  };
+
+  void AllreduceSplits(std::vector<ExpandEntry> *p_entries) const {
+    auto &entries = *p_entries;
+    int32_t rank = rabit::GetRank();
+    std::vector<WorkerSplit> splits(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+      auto const &s = entries[i].split;
+      splits[i] = {s.loss_chg,
+                   s.sindex,
+                   s.split_value,
+                   static_cast<int32_t>(s.is_cat),
+                   rank,
+                   s.left_sum.GetGrad(),
+                   s.left_sum.GetHess(),
+                   s.right_sum.GetGrad(),
+                   s.right_sum.GetHess()};
+    }
+    rabit::Reducer<WorkerSplit, WorkerSplit::Reduce> reducer;
+    reducer.Allreduce(splits.data(), splits.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+      auto const &best = splits[i];
+      auto &s = entries[i].split;
+      s.loss_chg = best.loss_chg;
+      s.sindex = best.sindex;
+      s.split_value = best.split_value;
+      s.is_cat = best.is_cat != 0;
+      s.left_sum = GradStats{best.left_grad, best.left_hess};
+      s.right_sum = GradStats{best.right_grad, best.right_hess};
+      if (s.is_cat) {
+        uint64_t n_words = best.rank == rank ? s.cat_bits.size() : 0;
+        rabit::Broadcast(&n_words, sizeof(n_words), best.rank);
+        s.cat_bits.resize(n_words);
+        if (n_words != 0) {
+          rabit::Broadcast(s.cat_bits.data(), n_words * sizeof(uint32_t), best.rank);
+        }
+      } else {
+        s.cat_bits.clear();
+      }
+    }
+  }
 
   // if sum of statistics for non-missing values in the node
   // is equal to sum of statistics for all values:
@@ -55,12 +134,77 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
   }
   enum SplitType { kNum = 0, kOneHot = 1, kPart = 2 };
 
+  /**
+   * \brief Same order as stable sorting all categories by weight, but only categories
+   *        with entries are sorted.  Categories without entry have 0 weight and are placed
+   *        between negative and positive weights in the order of their index.
+   */
+  void SortSparseCategories(TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator,
+                            common::GHistRow<GradientSumT> const &f_hist,
+                            common::SparseHistRow<GradientSumT> const &row,
+                            std::pair<size_t, size_t> range, uint32_t bin_begin,
+                            std::vector<size_t> *p_sorted_idx) const {
+    auto &sorted_idx = *p_sorted_idx;
+    std::vector<std::pair<double, size_t>> negative, positive;
+    // -1 for negative weight, 1 for positive weight.
+    std::vector<int8_t> sign(f_hist.size(), 0);
+    for (size_t k = range.first; k < range.second; ++k) {
+      size_t c = row.bins[k] - bin_begin;
+      double w = evaluator.CalcWeightCat(param_, quantizer_.ToFloatingPoint(f_hist[c]));
+      if (w < 0) {
+        negative.emplace_back(w, c);
+        sign[c] = -1;
+      } else if (w > 0) {
+        positive.emplace_back(w, c);
+        sign[c] = 1;
+      }
+    }
+    auto by_weight = [](std::pair<double, size_t> const &l, std::pair<double, size_t> const &r) {
+      return l.first < r.first;
+    };
+    std::stable_sort(negative.begin(), negative.end(), by_weight);
+    std::stable_sort(positive.begin(), positive.end(), by_weight);
+    sorted_idx.clear();
+    sorted_idx.reserve(f_hist.size());
+    for (auto const &c : negative) {
+      sorted_idx.push_back(c.second);
+    }
+    for (size_t c = 0; c < f_hist.size(); ++c) {
+      if (sign[c] == 0) {
+        sorted_idx.push_back(c);
+      }
+    }
+    for (auto const &c : positive) {
+      sorted_idx.push_back(c.second);
+    }
+  }
+
+  /**
+   * \brief Stable sort all categories of a dense histogram by weight.  Weights are computed
+   *        once per category instead of in every comparison.
+   */
+  void SortCategories(TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator,
+                      common::GHistRow<GradientSumT> const &f_hist,
+                      std::vector<double> *p_weights, std::vector<size_t> *p_sorted_idx) const {
+    auto &weights = *p_weights;
+    auto &sorted_idx = *p_sorted_idx;
+    weights.resize(f_hist.size());
+    for (size_t c = 0; c < f_hist.size(); ++c) {
+      weights[c] = evaluator.CalcWeightCat(param_, quantizer_.ToFloatingPoint(f_hist[c]));
+    }
+    sorted_idx.resize(f_hist.size());
+    std::iota(sorted_idx.begin(), sorted_idx.end(), 0);
+    std::stable_sort(sorted_idx.begin(), sorted_idx.end(),
+                     [&](size_t l, size_t r) { return weights[l] < weights[r]; });
+  }
+
   // Enumerate/Scan the split values of specific feature
   // Returns the sum of gradients corresponding to the data points that contains
-  // a non-missing value for the particular feature fid.
+  // a non-missing value for the particular feature fid.  `f_hist` is the histogram of
+  // feature fid.
   template <int d_step, SplitType split_type>
   GradStats EnumerateSplit(common::HistogramCuts const &cut, common::Span<size_t const> sorted_idx,
-                           const common::GHistRow<GradientSumT> &hist, bst_feature_t fidx,
+                           const common::GHistRow<GradientSumT> &f_hist, bst_feature_t fidx,
                            bst_node_t nidx,
                            TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator,
                            SplitEntry *p_best) const {
@@ -71,7 +215,7 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
     const std::vector<bst_float> &cut_val = cut.Values();
     auto const &parent = snode_[nidx];
     int32_t n_bins{static_cast<int32_t>(cut_ptr.at(fidx + 1) - cut_ptr[fidx])};
-    auto f_hist = hist.subspan(cut_ptr[fidx], n_bins);
+    CHECK_EQ(f_hist.size(), static_cast<size_t>(n_bins));
 
     // statistics on both sides of split
     GradStats left_sum;
@@ -95,23 +239,28 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
       ibegin = static_cast<int32_t>(cut_ptr[fidx + 1]) - 1;
       iend = static_cast<int32_t>(cut_ptr[fidx]) - 1;
     }
+    if (split_type == kPart) {
+      // Only the first `max_cat_threshold` categories in sorted order can form the partition.
+      auto n_enum = std::min(n_bins, static_cast<int32_t>(param_.max_cat_threshold));
+      iend = ibegin + d_step * n_enum;
+    }
 
     auto calc_bin_value = [&](auto i) {
       switch (split_type) {
         case kNum: {
-          left_sum.Add(hist[i].GetGrad(), hist[i].GetHess());
+          left_sum.Add(quantizer_.ToFloatingPoint(f_hist[i - imin]));
           right_sum.SetSubstract(parent.stats, left_sum);
           break;
         }
         case kOneHot: {
           // not-chosen categories go to left
-          right_sum = GradStats{hist[i]};
+          right_sum = quantizer_.ToFloatingPoint(f_hist[i - imin]);
           left_sum.SetSubstract(parent.stats, right_sum);
           break;
         }
         case kPart: {
           auto j = d_step == 1 ? (i - ibegin) : (ibegin - i);
-          right_sum.Add(f_hist[sorted_idx[j]].GetGrad(), f_hist[sorted_idx[j]].GetHess());
+          right_sum.Add(quantizer_.ToFloatingPoint(f_hist[sorted_idx[j]]));
           left_sum.SetSubstract(parent.stats, right_sum);
           break;
         }
@@ -202,6 +351,167 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
     return left_sum;
   }
 
+  // Buffers for scanning numerical features, reused by each thread.
+  struct ScanBuffer {
+    // Prefix sums of non-missing statistics from the first bin.
+    std::vector<double> fwd_grad, fwd_hess;
+    // Suffix sums of non-missing statistics from the last bin.
+    std::vector<double> bwd_grad, bwd_hess;
+    // Loss change of splitting at each bin, infinity for invalid splits.
+    std::vector<float> fwd_loss, bwd_loss;
+  };
+
+  /**
+   * \brief Enumerate splits of a numerical feature without `max_delta_step`.
+   *
+   *   Equivalent to the forward and backward `EnumerateSplit<d_step, kNum>`, but the
+   *   sequential part is limited to the prefix sums of the histogram.  Loss changes of
+   *   both directions of missing values are computed for all bins in one branch free loop
+   *   that can be vectorized by the compiler, then the best split is picked in the same
+   *   order as the scalar scan.  With monotone constraints, weights of children are
+   *   clamped to the bounds of the node in the same loop.
+   *
+   * \param missing Statistics of rows missing the feature when the histogram has a bin for
+   *                them, otherwise missing values are detected from the node statistics.
+   */
+  void EnumerateNumerical(common::HistogramCuts const &cut,
+                          common::GHistRow<GradientSumT> const &f_hist, bst_feature_t fidx,
+                          bst_node_t nidx,
+                          TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator,
+                          GradientPairT const *missing, ScanBuffer *p_buf,
+                          SplitEntry *p_best) const {
+    auto const &cut_val = cut.Values();
+    auto const ibegin = cut.Ptrs()[fidx];
+    auto const &parent = snode_[nidx];
+    size_t n_bins = f_hist.size();
+    auto &buf = *p_buf;
+    buf.fwd_grad.resize(n_bins);
+    buf.fwd_hess.resize(n_bins);
+    buf.fwd_loss.resize(n_bins);
+
+    double sum_grad{0}, sum_hess{0};
+    for (size_t k = 0; k < n_bins; ++k) {
+      auto bin = quantizer_.ToFloatingPoint(f_hist[k]);
+      sum_grad += bin.GetGrad();
+      sum_hess += bin.GetHess();
+      buf.fwd_grad[k] = sum_grad;
+      buf.fwd_hess[k] = sum_hess;
+    }
+    bool has_missing =
+        missing ? (missing->GetGrad() != 0 || missing->GetHess() != 0)
+                : SplitContainsMissingValues(GradStats{sum_grad, sum_hess}, parent);
+    if (has_missing) {
+      buf.bwd_grad.resize(n_bins);
+      buf.bwd_hess.resize(n_bins);
+      buf.bwd_loss.resize(n_bins);
+      sum_grad = sum_hess = 0;
+      for (size_t k = n_bins; k != 0; --k) {
+        auto bin = quantizer_.ToFloatingPoint(f_hist[k - 1]);
+        sum_grad += bin.GetGrad();
+        sum_hess += bin.GetHess();
+        buf.bwd_grad[k - 1] = sum_grad;
+        buf.bwd_hess[k - 1] = sum_hess;
+      }
+    }
+
+    // Same as `SplitEvaluator::CalcSplitGain` without constraint and `max_delta_step`.
+    double const parent_grad = parent.stats.GetGrad();
+    double const parent_hess = parent.stats.GetHess();
+    double const root_gain = parent.root_gain;
+    float const min_child_weight = param_.min_child_weight;
+    float const reg_alpha = param_.reg_alpha;
+    float const reg_lambda = param_.reg_lambda;
+    float constexpr kInvalid = std::numeric_limits<float>::infinity();
+    auto calc_gain = [=](double grad, double hess) {
+      return hess <= 0 ? 0.0f
+                       : static_cast<float>(common::Sqr(ThresholdL1(grad, reg_alpha)) /
+                                            (hess + reg_lambda));
+    };
+    auto calc_loss = [=](double grad, double hess) {
+      double other_grad = parent_grad - grad, other_hess = parent_hess - hess;
+      float gain = calc_gain(grad, hess) + calc_gain(other_grad, other_hess);
+      auto loss = static_cast<float>(static_cast<double>(gain) - root_gain);
+      return hess >= min_child_weight && other_hess >= min_child_weight ? loss : kInvalid;
+    };
+    // Same as `SplitEvaluator::CalcSplitGain` with monotone constraints, the bounds of a
+    // node always satisfy lower <= upper so clamping doesn't need branches.
+    int32_t const constraint = evaluator.has_constraint ? evaluator.constraints[fidx] : 0;
+    float const lower = evaluator.has_constraint ? evaluator.lower[nidx] : 0.0f;
+    float const upper = evaluator.has_constraint ? evaluator.upper[nidx] : 0.0f;
+    auto calc_weight = [=](double grad, double hess) {
+      float w = hess < min_child_weight || hess <= 0.0
+                    ? 0.0f
+                    : static_cast<float>(-ThresholdL1(grad, reg_alpha) / (hess + reg_lambda));
+      return std::min(std::max(w, lower), upper);
+    };
+    auto calc_gain_given_weight = [=](double grad, double hess, float w) {
+      auto g = static_cast<float>(grad), h = static_cast<float>(hess);
+      return hess <= 0 ? 0.0f : -(2.0f * g * w + (h + reg_lambda) * common::Sqr(w));
+    };
+    // `is_left` tells whether the accumulated statistic is the left child.
+    auto calc_constrained_loss = [=](double grad, double hess, bool is_left) {
+      double other_grad = parent_grad - grad, other_hess = parent_hess - hess;
+      float w = calc_weight(grad, hess), other_w = calc_weight(other_grad, other_hess);
+      float gain = calc_gain_given_weight(grad, hess, w) +
+                   calc_gain_given_weight(other_grad, other_hess, other_w);
+      float wleft = is_left ? w : other_w, wright = is_left ? other_w : w;
+      bool monotone = constraint == 0 || (constraint > 0 ? wleft <= wright : wleft >= wright);
+      auto loss = static_cast<float>(static_cast<double>(gain) - root_gain);
+      return hess >= min_child_weight && other_hess >= min_child_weight && monotone ? loss
+                                                                                 : kInvalid;
+    };
+
+    double const *fwd_grad = buf.fwd_grad.data(), *fwd_hess = buf.fwd_hess.data();
+    float *fwd_loss = buf.fwd_loss.data();
+    double const *bwd_grad = buf.bwd_grad.data(), *bwd_hess = buf.bwd_hess.data();
+    float *bwd_loss = buf.bwd_loss.data();
+    if (evaluator.has_constraint) {
+      for (size_t k = 0; k < n_bins; ++k) {
+        fwd_loss[k] = calc_constrained_loss(fwd_grad[k], fwd_hess[k], true);
+      }
+      if (has_missing) {
+        for (size_t k = 0; k < n_bins; ++k) {
+          bwd_loss[k] = calc_constrained_loss(bwd_grad[k], bwd_hess[k], false);
+        }
+      }
+    } else if (has_missing) {
+      for (size_t k = 0; k < n_bins; ++k) {
+        fwd_loss[k] = calc_loss(fwd_grad[k], fwd_hess[k]);
+        bwd_loss[k] = calc_loss(bwd_grad[k], bwd_hess[k]);
+      }
+    } else {
+      for (size_t k = 0; k < n_bins; ++k) {
+        fwd_loss[k] = calc_loss(fwd_grad[k], fwd_hess[k]);
+      }
+    }
+
+    // Forward enumeration splits at the right bound of each bin with missing values going
+    // right, backward enumeration splits at the left bound with missing values going left.
+    // Invalid splits are rejected by `NeedReplace` as infinity.
+    SplitEntry best;
+    for (size_t k = 0; k < n_bins; ++k) {
+      if (best.NeedReplace(fwd_loss[k], fidx)) {
+        GradStats left{fwd_grad[k], fwd_hess[k]};
+        GradStats right;
+        right.SetSubstract(parent.stats, left);
+        best.Update(fwd_loss[k], fidx, cut_val[ibegin + k], false, false, left, right);
+      }
+    }
+    if (has_missing) {
+      for (size_t k = n_bins; k != 0; --k) {
+        auto i = k - 1;
+        if (best.NeedReplace(buf.bwd_loss[i], fidx)) {
+          GradStats right{buf.bwd_grad[i], buf.bwd_hess[i]};
+          GradStats left;
+          left.SetSubstract(parent.stats, right);
+          auto split_pt = i == 0 ? cut.MinValues()[fidx] : cut_val[ibegin + i - 1];
+          best.Update(buf.bwd_loss[i], fidx, split_pt, true, false, left, right);
+        }
+      }
+    }
+    p_best->Update(best);
+  }
+
  public:
   void EvaluateSplits(const common::HistCollection<GradientSumT> &hist,
                       common::HistogramCuts const &cut,
@@ -216,6 +526,19 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
       auto nidx = entries[nidx_in_set].nid;
       features[nidx_in_set] =
           column_sampler_->GetFeatureSet(tree.GetDepth(nidx));
+      if (interaction_constraints_.Enabled()) {
+        // Drop features disallowed by interaction constraints before partitioning the
+        // work, so that threads are not assigned blocks of features skipped later.
+        auto allowed = interaction_constraints_.NodeFeatures(nidx);
+        auto node_features = std::make_shared<HostDeviceVector<bst_feature_t>>();
+        auto &h_node_features = node_features->HostVector();
+        for (auto fidx : features[nidx_in_set]->ConstHostVector()) {
+          if (allowed.Check(fidx)) {
+            h_node_features.push_back(fidx);
+          }
+        }
+        features[nidx_in_set] = node_features;
+      }
     }
     CHECK(!features.empty());
     const size_t grain_size =
@@ -231,47 +554,106 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
       }
     }
     auto evaluator = tree_evaluator_.GetEvaluator();
+    // Gains of numerical splits are evaluated by the vectorized scan unless the weights of
+    // children are clipped by `max_delta_step`.
+    bool const vectorized = param_.max_delta_step == 0.0f;
 
     common::ParallelFor2d(space, n_threads_, [&](size_t nidx_in_set, common::Range1d r) {
-      auto tidx = omp_get_thread_num();
+      auto tidx = common::ThreadIdx();
       auto entry = &tloc_candidates[n_threads_ * nidx_in_set + tidx];
       auto best = &entry->split;
       auto nidx = entry->nid;
-      auto histogram = hist[nidx];
+      bool is_sparse = hist.IsSparse(nidx);
+      auto histogram = is_sparse ? common::GHistRow<GradientSumT>{} : hist[nidx];
+      // Histogram of a single feature for sparse nodes.
+      std::vector<GradientPairT> f_buffer;
+      // Categories sorted by weight for partition based splits.
+      std::vector<size_t> sorted_idx;
+      std::vector<double> cat_weights;
+      ScanBuffer scan;
       auto features_set = features[nidx_in_set]->ConstHostSpan();
+      auto const &cut_ptr = cut.Ptrs();
       for (auto fidx_in_set = r.begin(); fidx_in_set < r.end(); fidx_in_set++) {
         auto fidx = features_set[fidx_in_set];
         bool is_cat = common::IsCat(feature_types, fidx);
-        if (!interaction_constraints_.Query(nidx, fidx)) {
+        if (fidx < feature_begin_ || fidx >= feature_end_) {
           continue;
         }
+        auto n_bins = cut_ptr.at(fidx + 1) - cut_ptr[fidx];
+        // First bin of the feature in the histogram.
+        auto f_begin = bundles_         ? bundles_->FeatureBegin(fidx)
+                       : column_subset_ ? column_subset_->FeatureBegin(fidx)
+                       : missing_bins_  ? missing_bins_->FeatureBegin(fidx)
+                                        : cut_ptr[fidx];
+        common::GHistRow<GradientSumT> f_hist;
+        std::pair<size_t, size_t> range;
+        if (bundles_ && bundles_->IsBundled(fidx)) {
+          // Bins of the feature are recovered from its bundle.
+          auto b_range = bundles_->BundleRange(fidx);
+          f_buffer.resize(n_bins);
+          if (is_sparse) {
+            auto const &row = hist.SparseRow(nidx);
+            range = row.Range(b_range.first, b_range.second);
+            if (range.first == range.second && param_.min_child_weight > 0) {
+              continue;
+            }
+            auto beg = row.bins.cbegin() + range.first;
+            auto end = row.bins.cbegin() + range.second;
+            bundles_->Unbundle(fidx, [&](uint32_t bin) {
+              auto it = std::lower_bound(beg, end, bin);
+              return (it == end || *it != bin) ? GradientPairT{}
+                                               : row.values[it - row.bins.cbegin()];
+            }, common::Span<GradientPairT>{f_buffer});
+          } else {
+            bundles_->Unbundle(fidx, [&](uint32_t bin) { return histogram[bin]; },
+                               common::Span<GradientPairT>{f_buffer});
+          }
+          f_hist = {f_buffer.data(), f_buffer.size()};
+        } else if (is_sparse) {
+          auto const &row = hist.SparseRow(nidx);
+          range = row.Range(f_begin, f_begin + n_bins);
+          if (range.first == range.second && param_.min_child_weight > 0) {
+            // One of the children is always empty.
+            continue;
+          }
+          f_buffer.assign(n_bins, GradientPairT{});
+          for (size_t k = range.first; k < range.second; ++k) {
+            f_buffer[row.bins[k] - f_begin] = row.values[k];
+          }
+          f_hist = {f_buffer.data(), f_buffer.size()};
+        } else {
+          f_hist = histogram.subspan(f_begin, n_bins);
+        }
         if (is_cat) {
-          auto n_bins = cut.Ptrs().at(fidx + 1) - cut.Ptrs()[fidx];
           if (common::UseOneHot(n_bins, param_.max_cat_to_onehot, task_)) {
-            EnumerateSplit<+1, kOneHot>(cut, {}, histogram, fidx, nidx, evaluator, best);
-            EnumerateSplit<-1, kOneHot>(cut, {}, histogram, fidx, nidx, evaluator, best);
+            EnumerateSplit<+1, kOneHot>(cut, {}, f_hist, fidx, nidx, evaluator, best);
+            EnumerateSplit<-1, kOneHot>(cut, {}, f_hist, fidx, nidx, evaluator, best);
           } else {
-            auto const &cut_ptr = cut.Ptrs();
-            std::vector<size_t> sorted_idx(n_bins);
-            std::iota(sorted_idx.begin(), sorted_idx.end(), 0);
-            auto feat_hist = histogram.subspan(cut_ptr[fidx], n_bins);
-            std::stable_sort(sorted_idx.begin(), sorted_idx.end(), [&](size_t l, size_t r) {
-              auto ret = evaluator.CalcWeightCat(param_, feat_hist[l]) <
-                         evaluator.CalcWeightCat(param_, feat_hist[r]);
-              static_assert(std::is_same<decltype(ret), bool>::value, "");
-              return ret;
-            });
+            if (is_sparse) {
+              this->SortSparseCategories(evaluator, f_hist, hist.SparseRow(nidx), range,
+                                         f_begin, &sorted_idx);
+            } else {
+              this->SortCategories(evaluator, f_hist, &cat_weights, &sorted_idx);
+            }
+            // When the enumeration is truncated by `max_cat_threshold` the returned sum
+            // doesn't cover all categories and the other end of sorted categories is
+            // enumerated as well.
             auto grad_stats =
-                EnumerateSplit<+1, kPart>(cut, sorted_idx, histogram, fidx, nidx, evaluator, best);
+                EnumerateSplit<+1, kPart>(cut, sorted_idx, f_hist, fidx, nidx, evaluator, best);
             if (SplitContainsMissingValues(grad_stats, snode_[nidx])) {
-              EnumerateSplit<-1, kPart>(cut, sorted_idx, histogram, fidx, nidx, evaluator, best);
+              EnumerateSplit<-1, kPart>(cut, sorted_idx, f_hist, fidx, nidx, evaluator, best);
             }
           }
+        } else if (vectorized) {
+          auto const *missing = (missing_bins_ && !is_sparse)
+                                    ? &histogram[missing_bins_->MissingBin(fidx)]
+                                    : nullptr;
+          this->EnumerateNumerical(cut, f_hist, fidx, nidx, evaluator, missing, &scan, best);
         } else {
           auto grad_stats =
-              EnumerateSplit<+1, kNum>(cut, {}, histogram, fidx, nidx, evaluator, best);
+              EnumerateSplit<+1, kNum>(cut, {}, f_hist, fidx, nidx, evaluator, best);
           if (SplitContainsMissingValues(grad_stats, snode_[nidx])) {
-            EnumerateSplit<-1, kNum>(cut, {}, histogram, fidx, nidx, evaluator, best);
+            EnumerateSplit<-1, kNum>(cut, {}, f_hist, fidx, nidx, evaluator, best);
           }
         }
       }
@@ -284,6 +666,9 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
             tloc_candidates[n_threads_ * nidx_in_set + tidx].split);
       }
     }
+    if (sync_splits_) {
+      this->AllreduceSplits(&entries);
+    }
   }
   // Add splits to tree, handles all statistic
   void ApplyTreeSplit(ExpandEntry const& candidate, RegTree *p_tree) {
@@ -326,15 +711,8 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
                       candidate.split.left_sum.GetHess(), candidate.split.right_sum.GetHess());
     }
 
-    // Set up child constraints
     auto left_child = tree[candidate.nid].LeftChild();
     auto right_child = tree[candidate.nid].RightChild();
-    tree_evaluator_.AddSplit(candidate.nid, left_child, right_child,
-                             tree[candidate.nid].SplitIndex(), left_weight,
-                             right_weight);
-
-    auto max_node = std::max(left_child, tree[candidate.nid].RightChild());
-    max_node = std::max(candidate.nid, max_node);
     snode_.resize(tree.GetNodes().size());
     snode_.at(left_child).stats = candidate.split.left_sum;
     snode_.at(left_child).root_gain = evaluator.CalcGain(
@@ -343,13 +721,45 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
     snode_.at(right_child).root_gain = evaluator.CalcGain(
         candidate.nid, param_, GradStats{candidate.split.right_sum});
 
+    // Set up child constraints, which invalidates the evaluator.
+    tree_evaluator_.AddSplit(candidate.nid, left_child, right_child,
+                             tree[candidate.nid].SplitIndex(), left_weight,
+                             right_weight);
+
     interaction_constraints_.Split(candidate.nid,
                                    tree[candidate.nid].SplitIndex(), left_child,
                                    right_child);
   }
 
   auto Evaluator() const { return tree_evaluator_.GetEvaluator(); }
+  /*! \brief Set the quantizer used to convert integer histograms into gradient sums. */
+  void SetQuantizer(GradientQuantizer const& quantizer) { quantizer_ = quantizer; }
   auto const& Stats() const { return snode_; }
+  /**
+   * \brief Evaluate histograms built on bundled bins, features keep their original
+   *        indices in splits.  The bundles must outlive evaluation.
+   */
+  void SetBundles(common::FeatureBundles const* bundles) { bundles_ = bundles; }
+  /**
+   * \brief Evaluate histograms built on bins of a subset of features, which must contain
+   *        all features sampled for the tree.  The subset must outlive evaluation.
+   */
+  void SetColumnSubset(common::ColumnSubset const* subset) { column_subset_ = subset; }
+  /**
+   * \brief Evaluate histograms built on a dense index with a missing bin for each feature.
+   *        The index must outlive evaluation.
+   */
+  void SetMissingBins(common::MissingBins const* missing_bins) { missing_bins_ = missing_bins; }
+  /**
+   * \brief Only evaluate features in [begin, end), the best split of each node is then
+   *        chosen among all workers.  Used when each worker only has the histogram bins
+   *        of its own features.
+   */
+  void SetFeatureRange(bst_feature_t begin, bst_feature_t end) {
+    feature_begin_ = begin;
+    feature_end_ = end;
+    sync_splits_ = true;
+  }
 
   float InitRoot(GradStats const& root_sum) {
     snode_.resize(1);
@@ -364,6 +774,11 @@ template <typename GradientSumT, typename ExpandEntry> class HistEvaluator {
   }
 
  public:
+  void SetThreads(int32_t n_threads) {
+    CHECK_GE(n_threads, 1);
+    n_threads_ = n_threads;
+  }
+
   // The column sampler must be constructed by caller since we need to preserve the rng
   // for the entire training session.
   explicit HistEvaluator(TrainParam const &param, MetaInfo const &info, int32_t n_threads,
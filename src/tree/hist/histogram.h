@@ -6,31 +6,96 @@
 
 #include <algorithm>
 #include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "rabit/rabit.h"
 #include "xgboost/tree_model.h"
+#include "../../common/column_matrix.h"
 #include "../../common/hist_util.h"
+#include "../../common/perf_counters.h"
+#include "../../common/threading_utils.h"
+#include "../../common/timer.h"
 #include "../../data/gradient_index.h"
 
 namespace xgboost {
 namespace tree {
+/**
+ * \brief Partition features into contiguous ranges with similar number of bins, one for
+ *        each worker.
+ *
+ * \param cut_ptrs Bin pointers of histogram cuts.
+ * \return Feature boundaries, worker k owns features in [ret[k], ret[k + 1]).
+ */
+inline std::vector<bst_feature_t> PartitionFeatures(std::vector<uint32_t> const &cut_ptrs,
+                                                    size_t n_workers) {
+  CHECK_GE(cut_ptrs.size(), 1);
+  CHECK_GE(n_workers, 1);
+  auto n_features = static_cast<bst_feature_t>(cut_ptrs.size() - 1);
+  std::vector<bst_feature_t> feature_ptr(n_workers + 1, n_features);
+  feature_ptr.front() = 0;
+  double total_bins = cut_ptrs.back();
+  for (size_t k = 1; k < n_workers; ++k) {
+    auto target = static_cast<uint32_t>(total_bins * k / n_workers);
+    auto it = std::lower_bound(cut_ptrs.cbegin(), cut_ptrs.cend() - 1, target);
+    feature_ptr[k] = std::max(static_cast<bst_feature_t>(it - cut_ptrs.cbegin()),
+                              feature_ptr[k - 1]);
+  }
+  return feature_ptr;
+}
+
 template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
   using GradientPairT = xgboost::detail::GradientPairInternal<GradientSumT>;
   using GHistRowT = common::GHistRow<GradientSumT>;
 
+  enum : uint16_t { kNoNode = std::numeric_limits<uint16_t>::max() };
+  // Each thread might hold a histogram for every node in a sweep.
+  static constexpr size_t kMaxSweepNodes = 16;
+
   /*! \brief culmulative histogram of gradients. */
   common::HistCollection<GradientSumT> hist_;
   /*! \brief culmulative local parent histogram of gradients. */
   common::HistCollection<GradientSumT> hist_local_worker_;
   common::GHistBuilder<GradientSumT> builder_;
   common::ParallelGHistBuilder<GradientSumT> buffer_;
-  rabit::Reducer<GradientPairT, GradientPairT::Reduce> reducer_;
   BatchParam param_;
   int32_t n_threads_{-1};
   size_t n_batches_{0};
   // Whether XGBoost is running in distributed environment.
   bool is_distributed_{false};
+  // Index of node in the build set for each row, -1 if the row is not in any of the nodes.
+  // Used by column-wise building.
+  std::vector<int32_t> row_slot_;
+  // Compact version of `row_slot_` used by building with a sweep over all rows,
+  // `kNoNode` if the row is not in any of the nodes.
+  std::vector<uint16_t> row_node_;
+  // Rows of each node within a block of the sweep, for each thread.
+  std::vector<std::vector<size_t>> sweep_rows_;
+  // Nodes built together with rows more than this ratio of all rows are built by a sweep
+  // over all rows, 0 means disabled.
+  double node_sweep_ratio_{0};
+  // Budget in bytes for cached histograms, 0 means unlimited.
+  size_t max_cached_bytes_{0};
+  // Parents of the last built nodes, their histograms are released in the next round.
+  std::vector<bst_node_t> releasable_;
+  // Cached histograms were evicted, nodes are built without the subtraction trick.
+  bool build_all_{false};
+  // Nodes with entries fewer than this ratio of total bins use sparse histograms, 0 means
+  // disabled.
+  double sparse_hist_ratio_{0};
+  // Zero histogram for each thread used by building sparse histograms.
+  std::vector<std::vector<GradientPairT>> sparse_scratch_;
+  // Nodes with non-zero bins across all workers fewer than this ratio of total bins are
+  // synchronized as (bin, value) pairs, 0 means disabled.
+  double sparse_sync_ratio_{0};
+  // Send histogram values in single precision during synchronization.
+  bool sync_single_precision_{false};
+  // Histogram bins owned by each worker when histograms are reduce-scattered, worker k
+  // receives bins in [worker_bins_[k], worker_bins_[k + 1]).  Empty means allreduce.
+  std::vector<uint32_t> worker_bins_;
+  common::Monitor monitor_;
 
  public:
   /**
@@ -40,12 +105,38 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
    * \param n_threads        Number of threads.
    * \param is_distributed   Mostly used for testing to allow injecting parameters instead
    *                         of using global rabit variable.
+   * \param max_cached_bytes Memory budget for cached histograms, histograms are evicted
+   *                         and rebuilt explicitly once the budget is exceeded.  0 means
+   *                         unlimited.
+   * \param sparse_hist_ratio Nodes with number of entries below this ratio of total bins
+   *                          store only bins with entries.  Only used for single batch
+   *                          data in non-distributed training.  0 means disabled.
+   * \param sparse_sync_ratio Nodes with number of non-zero bins summed over workers below
+   *                          this ratio of total bins are synchronized as sparse
+   *                          histograms.  0 means disabled.
+   * \param sync_single_precision Send histograms in single precision during
+   *                              synchronization.
+   * \param node_sweep_ratio Nodes built together with rows more than this ratio of all
+   *                         rows are built by sweeping all rows in order.  Only used for
+   *                         single batch data.  0 means disabled.
    */
   void Reset(uint32_t total_bins, BatchParam p, int32_t n_threads, size_t n_batches,
-             bool is_distributed) {
+             bool is_distributed, size_t max_cached_bytes = 0, double sparse_hist_ratio = 0,
+             double sparse_sync_ratio = 0, bool sync_single_precision = false,
+             double node_sweep_ratio = 0) {
     CHECK_GE(n_threads, 1);
+    monitor_.Init("HistogramBuilder");
     n_threads_ = n_threads;
     n_batches_ = n_batches;
+    max_cached_bytes_ = max_cached_bytes;
+    releasable_.clear();
+    build_all_ = false;
+    sparse_hist_ratio_ = sparse_hist_ratio;
+    sparse_scratch_.clear();
+    sparse_sync_ratio_ = sparse_sync_ratio;
+    sync_single_precision_ = sync_single_precision;
+    node_sweep_ratio_ = node_sweep_ratio;
+    worker_bins_.clear();
     param_ = p;
     hist_.Init(total_bins);
     hist_local_worker_.Init(total_bins);
@@ -54,12 +145,40 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
     is_distributed_ = is_distributed;
   }
 
+  /**
+   * \brief Reduce-scatter histograms in distributed training, each worker only receives
+   *        the bins of features it evaluates.  Bins of other features are left with
+   *        unspecified values.  Must be called after `Reset`.
+   *
+   * \param worker_bins Bin boundaries of each worker, of size n_workers + 1.
+   */
+  void SetReduceScatter(std::vector<uint32_t> worker_bins) {
+    CHECK_EQ(worker_bins.size(), static_cast<size_t>(rabit::GetWorldSize()) + 1);
+    worker_bins_ = std::move(worker_bins);
+  }
+  bool IsReduceScatter() const { return !worker_bins_.empty(); }
+  /*! \brief Rows accumulated in a single precision histogram before promoting to double. */
+  static constexpr size_t kFloatBlockRows = 1 << 13;
+  /**
+   * \brief Accumulate at most `block_rows` rows in each per-thread histogram, partial
+   *        histograms are promoted to double precision and reduced in double precision
+   *        before being rounded into the node histogram.  Used by single precision
+   *        histograms, 0 means disabled.  Must be called after `Reset`.
+   */
+  void SetBlockRows(size_t block_rows) { buffer_.SetBlockRows(block_rows); }
+  /** \brief Change the number of threads used by the next builds. */
+  void SetThreads(int32_t n_threads) {
+    CHECK_GE(n_threads, 1);
+    n_threads_ = n_threads;
+  }
+
   template <bool any_missing>
   void BuildLocalHistograms(size_t page_idx, common::BlockedSpace2d space,
                             GHistIndexMatrix const &gidx,
                             std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
                             common::RowSetCollection const &row_set_collection,
-                            const std::vector<GradientPair> &gpair_h) {
+                            const std::vector<GradientPair> &gpair_h,
+                            GradientSource const *source = nullptr) {
     const size_t n_nodes = nodes_for_explicit_hist_build.size();
     CHECK_GT(n_nodes, 0);
 
@@ -76,8 +195,8 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
     }
 
     // Parallel processing by nodes and data in each node
-    common::ParallelFor2d(space, this->n_threads_, [&](size_t nid_in_set, common::Range1d r) {
-      const auto tid = static_cast<unsigned>(omp_get_thread_num());
+    common::ParallelFor2dSteal(space, this->n_threads_, [&](size_t nid_in_set, common::Range1d r) {
+      const auto tid = static_cast<unsigned>(common::ThreadIdx());
       const int32_t nid = nodes_for_explicit_hist_build[nid_in_set].nid;
       auto elem = row_set_collection[nid];
       auto start_of_row_set = std::min(r.begin(), elem.Size());
@@ -85,10 +204,192 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
       auto rid_set = common::RowSetCollection::Elem(elem.begin + start_of_row_set,
                                                     elem.begin + end_of_row_set, nid);
       auto hist = buffer_.GetInitializedHist(tid, nid_in_set);
+      common::PerfCounters::Get()->Add(common::PerfCounters::kHistRows, rid_set.Size());
+      if (source && rid_set.Size() != 0) {
+        // Only used for the root node, which contains all rows in order.
+        (*source)(start_of_row_set, end_of_row_set);
+      }
       if (rid_set.Size() != 0) {
         builder_.template BuildHist<any_missing>(gpair_h, rid_set, gidx, hist);
+        buffer_.AddRows(tid, nid_in_set, rid_set.Size());
+      }
+    });
+  }
+
+  /**
+   * \brief Cost model for choosing between row-wise and column-wise histogram building.
+   *        Row-wise building visits only entries of rows in the nodes, but writes are
+   *        scattered over the whole histogram.  Column-wise building visits all entries of
+   *        sparse columns, with writes local to the bins of a single feature.
+   */
+  bool UseColumnWise(common::ColumnMatrix const &columns, GHistIndexMatrix const &gidx,
+                     std::vector<ExpandEntry> const &nodes,
+                     common::RowSetCollection const &row_set_collection) const {
+    // Roughly the size of L2 cache, below which scattered writes are cheap.
+    size_t constexpr kCacheBytes = 1 << 20;
+    // Relative cost of a write that misses cache.
+    double constexpr kScatterCost = 4.0;
+    if (gidx.IsDense() || n_batches_ != 1 || gidx.Size() == 0 ||
+        builder_.GetNumBins() * sizeof(GradientPairT) <= kCacheBytes) {
+      return false;
+    }
+    size_t n_rows_in_nodes = 0;
+    for (auto const &node : nodes) {
+      n_rows_in_nodes += row_set_collection[node.nid].Size();
+    }
+    double fraction = static_cast<double>(n_rows_in_nodes) / static_cast<double>(gidx.Size());
+    double row_wise = fraction * static_cast<double>(gidx.row_ptr.back()) * kScatterCost;
+    // Dense columns are accessed by rows in nodes, sparse columns are walked entirely.
+    double column_wise = 0;
+    for (bst_feature_t fidx = 0; fidx < columns.GetNumFeature(); ++fidx) {
+      if (columns.GetColumnType(fidx) == common::kDenseColumn) {
+        column_wise += static_cast<double>(n_rows_in_nodes);
+      } else {
+        column_wise += static_cast<double>(columns.GetFeatureCount(fidx));
+      }
+    }
+    return column_wise < row_wise;
+  }
+
+  /**
+   * \brief Build histograms by iterating over columns.  Each thread accumulates whole
+   *        features so that writes are local to the bins of a single feature.  Only
+   *        single batch data is supported.
+   */
+  void BuildLocalHistogramsColumnWise(common::ColumnMatrix const &columns,
+                                      std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
+                                      common::RowSetCollection const &row_set_collection,
+                                      std::vector<GradientPair> const &gpair_h) {
+    const size_t n_nodes = nodes_for_explicit_hist_build.size();
+    CHECK_GT(n_nodes, 0);
+    CHECK_EQ(n_batches_, 1) << "Column-wise histogram building requires single batch.";
+    // All threads write into the target histograms, with only one buffer per node the
+    // reduction is skipped.
+    std::vector<GHistRowT> target_hists(n_nodes);
+    for (size_t i = 0; i < n_nodes; ++i) {
+      target_hists[i] = hist_[nodes_for_explicit_hist_build[i].nid];
+    }
+    common::BlockedSpace2d space(n_nodes, [](size_t) { return 1; }, 1);
+    buffer_.Reset(1, n_nodes, space, target_hists);
+    for (size_t i = 0; i < n_nodes; ++i) {
+      buffer_.GetInitializedHist(0, i);
+    }
+
+    row_slot_.resize(gpair_h.size(), -1);
+    auto mark_rows = [&](int32_t slot) {
+      common::ParallelFor(n_nodes, n_threads_, [&](size_t i) {
+        auto elem = row_set_collection[nodes_for_explicit_hist_build[i].nid];
+        for (auto it = elem.begin; it != elem.end; ++it) {
+          row_slot_[*it] = slot == -1 ? -1 : static_cast<int32_t>(i);
+        }
+      });
+    };
+    mark_rows(0);
+    switch (columns.GetTypeSize()) {
+      case common::kUint8BinsTypeSize:
+        this->DispatchColumnWise<uint8_t>(columns, nodes_for_explicit_hist_build,
+                                          row_set_collection, gpair_h, target_hists);
+        break;
+      case common::kUint16BinsTypeSize:
+        this->DispatchColumnWise<uint16_t>(columns, nodes_for_explicit_hist_build,
+                                           row_set_collection, gpair_h, target_hists);
+        break;
+      case common::kUint32BinsTypeSize:
+        this->DispatchColumnWise<uint32_t>(columns, nodes_for_explicit_hist_build,
+                                           row_set_collection, gpair_h, target_hists);
+        break;
+      default:
+        CHECK(false);  // no default behavior
+    }
+    mark_rows(-1);
+  }
+
+  /**
+   * \brief Whether nodes are built by a sweep over all rows, used when the nodes cover
+   *        most rows so that reading the whole index in order is cheaper than gathering
+   *        rows of each node.
+   */
+  bool UseNodeSweep(GHistIndexMatrix const &gidx, std::vector<ExpandEntry> const &nodes,
+                    common::RowSetCollection const &row_set_collection) const {
+    if (node_sweep_ratio_ <= 0 || n_batches_ != 1 || gidx.base_rowid != 0 ||
+        nodes.size() < 2 || nodes.size() > kMaxSweepNodes) {
+      return false;
+    }
+    size_t n_rows_in_nodes = 0;
+    for (auto const &node : nodes) {
+      n_rows_in_nodes += row_set_collection[node.nid].Size();
+    }
+    return static_cast<double>(n_rows_in_nodes) >=
+           node_sweep_ratio_ * static_cast<double>(gidx.Size());
+  }
+
+  /**
+   * \brief Build histograms by sweeping blocks of rows in order.  Each row is labelled
+   *        with the index of its node in the build set, then rows of a block are
+   *        dispatched to the histograms of their nodes.  The index is read sequentially
+   *        once for all nodes instead of being gathered node by node.  Only single batch
+   *        data is supported.
+   */
+  template <bool any_missing>
+  void BuildLocalHistogramsByNode(GHistIndexMatrix const &gidx,
+                                  std::vector<ExpandEntry> const &nodes,
+                                  common::RowSetCollection const &row_set_collection,
+                                  std::vector<GradientPair> const &gpair_h) {
+    size_t constexpr kBlockSize = 2048;
+    const size_t n_nodes = nodes.size();
+    CHECK_GT(n_nodes, 0);
+    CHECK(n_nodes <= kMaxSweepNodes);
+    CHECK_EQ(n_batches_, 1) << "Building histograms by sweep requires single batch.";
+    const size_t n_rows = gidx.Size();
+    std::vector<GHistRowT> target_hists(n_nodes);
+    for (size_t i = 0; i < n_nodes; ++i) {
+      target_hists[i] = hist_[nodes[i].nid];
+    }
+    common::BlockedSpace2d space(n_nodes, [&](size_t) { return n_rows; }, kBlockSize);
+    buffer_.Reset(this->n_threads_, n_nodes, space, target_hists);
+
+    row_node_.resize(n_rows);
+    const size_t n_blocks = common::DivRoundUp(n_rows, kBlockSize);
+    common::ParallelFor(n_blocks, n_threads_, [&](size_t block) {
+      auto begin = block * kBlockSize;
+      std::fill(row_node_.begin() + begin,
+                row_node_.begin() + std::min(begin + kBlockSize, n_rows),
+                static_cast<uint16_t>(kNoNode));
+    });
+    common::ParallelFor(n_nodes, n_threads_, [&](size_t i) {
+      auto elem = row_set_collection[nodes[i].nid];
+      for (auto it = elem.begin; it != elem.end; ++it) {
+        row_node_[*it] = static_cast<uint16_t>(i);
+      }
+    });
+
+    sweep_rows_.resize(static_cast<size_t>(n_threads_) * n_nodes);
+    common::ParallelFor(n_blocks, n_threads_, [&](size_t block) {
+      const auto tid = static_cast<size_t>(common::ThreadIdx());
+      auto *rows = sweep_rows_.data() + tid * n_nodes;
+      for (size_t i = 0; i < n_nodes; ++i) {
+        rows[i].clear();
+      }
+      auto begin = block * kBlockSize;
+      auto end = std::min(begin + kBlockSize, n_rows);
+      for (size_t ridx = begin; ridx < end; ++ridx) {
+        auto slot = row_node_[ridx];
+        if (slot != kNoNode) {
+          rows[slot].push_back(ridx);
+        }
+      }
+      for (size_t i = 0; i < n_nodes; ++i) {
+        if (rows[i].empty()) {
+          continue;
+        }
+        auto hist = buffer_.GetInitializedHist(tid, i);
+        common::PerfCounters::Get()->Add(common::PerfCounters::kHistRows, rows[i].size());
+        common::RowSetCollection::Elem rid_set(rows[i].data(), rows[i].data() + rows[i].size(),
+                                               nodes[i].nid);
+        builder_.template BuildHist<any_missing>(gpair_h, rid_set, gidx, hist);
       }
     });
+    monitor_.Count("NodeSweep", n_nodes);
   }
 
   void
@@ -96,6 +397,35 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
               std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
               std::vector<ExpandEntry> const &nodes_for_subtraction_trick,
               RegTree *p_tree) {
+    size_t n_new = nodes_for_explicit_hist_build.size() + nodes_for_subtraction_trick.size();
+    if (!is_distributed_) {
+      // Histograms of split nodes are no longer needed once both children are built.
+      // Distributed training requires new histograms to be contiguous for allreduce.
+      for (auto nidx : releasable_) {
+        if (hist_.RowExists(nidx)) {
+          hist_.FreeHistRow(nidx);
+          monitor_.Count("RecycledHist");
+        } else if (hist_.IsSparse(nidx)) {
+          hist_.FreeSparseRow(nidx);
+        }
+      }
+    }
+    releasable_.clear();
+    build_all_ = false;
+    if (max_cached_bytes_ != 0) {
+      // Parents evicted in previous rounds can not be used for subtraction.
+      for (auto const &entry : nodes_for_subtraction_trick) {
+        build_all_ |= !hist_.RowExists((*p_tree)[entry.nid].Parent());
+      }
+      if (!this->CanHost(n_new)) {
+        // Drop all cached histograms, parents are no longer available for subtraction.
+        monitor_.Count("EvictedHist", hist_.AllocatedRows() - hist_.FreeRows());
+        hist_.Init(builder_.GetNumBins());
+        hist_local_worker_.Init(builder_.GetNumBins());
+        build_all_ = true;
+      }
+    }
+
     if (is_distributed_) {
       this->AddHistRowsDistributed(starting_index, sync_count,
                                    nodes_for_explicit_hist_build,
@@ -105,14 +435,33 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
                              nodes_for_explicit_hist_build,
                              nodes_for_subtraction_trick);
     }
+    if (build_all_) {
+      // Left children are added before right children in distributed training, so all
+      // histograms are contiguous.
+      *sync_count = static_cast<int>(n_new);
+    }
+    size_t pool_bytes = hist_.AllocatedRows() * builder_.GetNumBins() * sizeof(GradientPairT);
+    if (is_distributed_) {
+      pool_bytes *= 2;  // local copy of histograms
+    }
+    common::PerfCounters::Get()->Set(common::PerfCounters::kHistPoolBytes, pool_bytes);
   }
 
+  /*! \brief Whether building the last nodes required evicting cached histograms. */
+  bool Evicted() const { return build_all_; }
+
   /** Main entry point of this class, build histogram for tree nodes. */
   void BuildHist(size_t page_id, common::BlockedSpace2d space, GHistIndexMatrix const &gidx,
                  RegTree *p_tree, common::RowSetCollection const &row_set_collection,
                  std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
                  std::vector<ExpandEntry> const &nodes_for_subtraction_trick,
-                 std::vector<GradientPair> const &gpair) {
+                 std::vector<GradientPair> const &gpair,
+                 common::ColumnMatrix const *columns = nullptr) {
+    if (sparse_hist_ratio_ > 0 && n_batches_ == 1 && !is_distributed_) {
+      this->BuildHistWithSparse(gidx, p_tree, row_set_collection, nodes_for_explicit_hist_build,
+                                nodes_for_subtraction_trick, gpair, columns);
+      return;
+    }
     int starting_index = std::numeric_limits<int>::max();
     int sync_count = 0;
     if (page_id == 0) {
@@ -120,37 +469,63 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
                         nodes_for_explicit_hist_build,
                         nodes_for_subtraction_trick, p_tree);
     }
-    if (gidx.IsDense()) {
-      this->BuildLocalHistograms<false>(page_id, space, gidx,
-                                        nodes_for_explicit_hist_build,
-                                        row_set_collection, gpair);
+    if (build_all_ && !nodes_for_subtraction_trick.empty()) {
+      // Parent histograms are evicted, build the siblings explicitly as well.
+      std::vector<ExpandEntry> nodes{nodes_for_explicit_hist_build};
+      nodes.insert(nodes.end(), nodes_for_subtraction_trick.cbegin(),
+                   nodes_for_subtraction_trick.cend());
+      monitor_.Count("RebuiltHist", nodes_for_subtraction_trick.size());
+      common::BlockedSpace2d all_space(
+          nodes.size(),
+          [&](size_t nidx_in_set) { return row_set_collection[nodes[nidx_in_set].nid].Size(); },
+          256);
+      this->BuildHistImpl(page_id, all_space, gidx, p_tree, row_set_collection, nodes, {},
+                          gpair, columns, starting_index, sync_count);
     } else {
-      this->BuildLocalHistograms<true>(page_id, space, gidx,
-                                       nodes_for_explicit_hist_build,
-                                       row_set_collection, gpair);
+      this->BuildHistImpl(page_id, space, gidx, p_tree, row_set_collection,
+                          nodes_for_explicit_hist_build, nodes_for_subtraction_trick, gpair,
+                          columns, starting_index, sync_count);
     }
-
-    CHECK_GE(n_batches_, 1);
-    if (page_id != n_batches_ - 1) {
-      return;
+  }
+  /**
+   * \brief Build histogram of the root node, gradient of each block of rows is computed by
+   *        `source` right before the block is accumulated.  Gradient computation and
+   *        histogram building share a single pass over rows.  Only handles single batch
+   *        data with the root containing all rows.
+   */
+  void BuildRootHist(GHistIndexMatrix const &gidx, RegTree *p_tree,
+                     common::RowSetCollection const &row_set_collection, ExpandEntry const &root,
+                     std::vector<GradientPair> const &gpair, GradientSource const &source) {
+    CHECK_EQ(n_batches_, 1);
+    CHECK_EQ(row_set_collection[root.nid].Size(), gpair.size());
+    std::vector<ExpandEntry> nodes{root};
+    int starting_index = std::numeric_limits<int>::max();
+    int sync_count = 0;
+    this->AddHistRows(&starting_index, &sync_count, nodes, {}, p_tree);
+    common::BlockedSpace2d space(1, [&](size_t) { return gpair.size(); }, 256);
+    if (gidx.IsDense()) {
+      this->BuildLocalHistograms<false>(0, space, gidx, nodes, row_set_collection, gpair,
+                                        &source);
+    } else {
+      this->BuildLocalHistograms<true>(0, space, gidx, nodes, row_set_collection, gpair,
+                                       &source);
     }
-
     if (is_distributed_) {
-      this->SyncHistogramDistributed(p_tree, nodes_for_explicit_hist_build,
-                                     nodes_for_subtraction_trick,
-                                     starting_index, sync_count);
+      monitor_.Start("AllReduce");
+      this->SyncHistogramDistributed(p_tree, nodes, {}, starting_index, sync_count);
+      monitor_.Stop("AllReduce");
     } else {
-      this->SyncHistogramLocal(p_tree, nodes_for_explicit_hist_build,
-                               nodes_for_subtraction_trick, starting_index,
-                               sync_count);
+      this->SyncHistogramLocal(p_tree, nodes, {}, starting_index, sync_count);
     }
   }
+
   /** same as the other build hist but handles only single batch data (in-core) */
   void BuildHist(size_t page_id, GHistIndexMatrix const &gidx, RegTree *p_tree,
                  common::RowSetCollection const &row_set_collection,
                  std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
                  std::vector<ExpandEntry> const &nodes_for_subtraction_trick,
-                 std::vector<GradientPair> const &gpair) {
+                 std::vector<GradientPair> const &gpair,
+                 common::ColumnMatrix const *columns = nullptr) {
     const size_t n_nodes = nodes_for_explicit_hist_build.size();
     // create space of size (# rows in each node)
     common::BlockedSpace2d space(
@@ -162,7 +537,7 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
         256);
     this->BuildHist(page_id, space, gidx, p_tree, row_set_collection,
                     nodes_for_explicit_hist_build, nodes_for_subtraction_trick,
-                    gpair);
+                    gpair, columns);
   }
 
   void SyncHistogramDistributed(
@@ -174,32 +549,71 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
     common::BlockedSpace2d space(
         nodes_for_explicit_hist_build.size(), [&](size_t) { return nbins; },
         1024);
-    common::ParallelFor2d(
-        space, n_threads_, [&](size_t node, common::Range1d r) {
-          const auto &entry = nodes_for_explicit_hist_build[node];
-          auto this_hist = this->hist_[entry.nid];
-          // Merging histograms from each thread into once
-          buffer_.ReduceHist(node, r.begin(), r.end());
-          // Store posible parent node
-          auto this_local = hist_local_worker_[entry.nid];
-          common::CopyHist(this_local, this_hist, r.begin(), r.end());
+    auto has_sibling = [&](ExpandEntry const &entry) {
+      return !(*p_tree)[entry.nid].IsRoot() && !nodes_for_subtraction_trick.empty();
+    };
+    auto merge = [&](size_t node, common::Range1d r) {
+      const auto &entry = nodes_for_explicit_hist_build[node];
+      auto this_hist = this->hist_[entry.nid];
+      // Merging histograms from each thread into once
+      buffer_.ReduceHist(node, r.begin(), r.end());
+      // Store posible parent node
+      auto this_local = hist_local_worker_[entry.nid];
+      common::CopyHist(this_local, this_hist, r.begin(), r.end());
 
-          if (!(*p_tree)[entry.nid].IsRoot()) {
-            const size_t parent_id = (*p_tree)[entry.nid].Parent();
-            const int subtraction_node_id =
-                nodes_for_subtraction_trick[node].nid;
-            auto parent_hist = this->hist_local_worker_[parent_id];
-            auto sibling_hist = this->hist_[subtraction_node_id];
-            common::SubtractionHist(sibling_hist, parent_hist, this_hist,
-                                    r.begin(), r.end());
-            // Store posible parent node
-            auto sibling_local = hist_local_worker_[subtraction_node_id];
-            common::CopyHist(sibling_local, sibling_hist, r.begin(), r.end());
-          }
-        });
+      if (has_sibling(entry)) {
+        const size_t parent_id = (*p_tree)[entry.nid].Parent();
+        const int subtraction_node_id = nodes_for_subtraction_trick[node].nid;
+        auto parent_hist = this->hist_local_worker_[parent_id];
+        auto sibling_hist = this->hist_[subtraction_node_id];
+        common::SubtractionHist(sibling_hist, parent_hist, this_hist, r.begin(), r.end());
+        // Store posible parent node
+        auto sibling_local = hist_local_worker_[subtraction_node_id];
+        common::CopyHist(sibling_local, sibling_hist, r.begin(), r.end());
+      }
+    };
+    // Only left children are synchronized, right children are obtained by subtraction
+    // after the allreduce.
+    auto synced_node = [&](size_t node) {
+      const auto &entry = nodes_for_explicit_hist_build[node];
+      if (!has_sibling(entry) || (*p_tree)[entry.nid].IsLeftChild()) {
+        return entry.nid;
+      }
+      return nodes_for_subtraction_trick[node].nid;
+    };
 
-    reducer_.Allreduce(this->hist_[starting_index].data(),
-                       builder_.GetNumBins() * sync_count);
+    if (this->IsReduceScatter() || sparse_sync_ratio_ > 0 || sync_single_precision_) {
+      // Both need all nodes to be merged before sending, reduce-scatter sends them in a
+      // single message and compression needs all workers to agree on the format first.
+      common::ParallelFor2d(space, n_threads_, merge);
+      std::vector<bst_node_t> synced(nodes_for_explicit_hist_build.size());
+      for (size_t node = 0; node < synced.size(); ++node) {
+        synced[node] = synced_node(node);
+      }
+      if (this->IsReduceScatter()) {
+        this->ReduceScatter(synced);
+      } else {
+        this->SyncCompressed(synced);
+      }
+    } else {
+      common::BlockedSpace2d node_space(1, [&](size_t) { return nbins; }, 1024);
+      // Histograms are merged one node at a time, the allreduce of each finished node
+      // runs in background while the following nodes are being merged.
+      std::vector<rabit::Request> requests;
+      for (size_t node = 0; node < nodes_for_explicit_hist_build.size(); ++node) {
+        common::ParallelFor2d(node_space, n_threads_,
+                              [&](size_t, common::Range1d r) { merge(node, r); });
+        auto hist = this->hist_[synced_node(node)];
+        requests.emplace_back(rabit::IAllreduce<rabit::op::Sum>(
+            reinterpret_cast<GradientSumT *>(hist.data()), hist.size() * 2));
+      }
+      for (auto &request : requests) {
+        request.Wait();
+      }
+    }
+    if (nodes_for_subtraction_trick.empty()) {
+      return;
+    }
 
     ParallelSubtractionHist(space, nodes_for_explicit_hist_build,
                             nodes_for_subtraction_trick, p_tree);
@@ -228,7 +642,7 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
           // Merging histograms from each thread into once
           this->buffer_.ReduceHist(node, r.begin(), r.end());
 
-          if (!(*p_tree)[entry.nid].IsRoot()) {
+          if (!(*p_tree)[entry.nid].IsRoot() && !nodes_for_subtraction_trick.empty()) {
             const size_t parent_id = (*p_tree)[entry.nid].Parent();
             const int subtraction_node_id =
                 nodes_for_subtraction_trick[node].nid;
@@ -248,6 +662,380 @@ template <typename GradientSumT, typename ExpandEntry> class HistogramBuilder {
   auto& Buffer() { return buffer_; }
 
  private:
+  /**
+   * \brief Reduce-scatter histograms of nodes.  Bins of each worker are padded to the
+   *        same size so segments of the reduce-scatter align with feature boundaries, the
+   *        buffer is laid out as [worker][node][bin].
+   */
+  void ReduceScatter(std::vector<bst_node_t> const &nodes) {
+    size_t const n_workers = worker_bins_.size() - 1;
+    size_t const n_nodes = nodes.size();
+    size_t const rank = rabit::GetRank();
+    uint32_t step = 0;
+    for (size_t k = 0; k < n_workers; ++k) {
+      step = std::max(step, worker_bins_[k + 1] - worker_bins_[k]);
+    }
+    if (step == 0 || n_nodes == 0) {
+      return;
+    }
+    std::vector<GradientPairT> buffer(n_workers * n_nodes * step);
+    common::ParallelFor(n_workers * n_nodes, n_threads_, [&](size_t i) {
+      size_t k = i / n_nodes, node = i % n_nodes;
+      auto hist = hist_[nodes[node]];
+      std::copy(hist.cbegin() + worker_bins_[k], hist.cbegin() + worker_bins_[k + 1],
+                buffer.begin() + i * step);
+    });
+    rabit::ReduceScatter<rabit::op::Sum>(reinterpret_cast<GradientSumT *>(buffer.data()),
+                                         buffer.size() * 2);
+    common::ParallelFor(n_nodes, n_threads_, [&](size_t node) {
+      auto hist = hist_[nodes[node]];
+      auto src = buffer.cbegin() + (rank * n_nodes + node) * step;
+      std::copy(src, src + (worker_bins_[rank + 1] - worker_bins_[rank]),
+                hist.begin() + worker_bins_[rank]);
+    });
+  }
+
+  /**
+   * \brief Allreduce histograms of nodes with reduced traffic.  Workers first agree on
+   *        the number of non-zero bins of each node, nodes below `sparse_sync_ratio_` are
+   *        gathered as (bin, value) pairs and summed locally, others are reduced densely.
+   *        Values are sent in single precision if `sync_single_precision_` is set.
+   */
+  void SyncCompressed(std::vector<bst_node_t> const &nodes) {
+    if (sync_single_precision_) {
+      this->SyncCompressedImpl<float>(nodes);
+    } else {
+      this->SyncCompressedImpl<GradientSumT>(nodes);
+    }
+  }
+
+  template <typename ValueT>
+  void SyncCompressedImpl(std::vector<bst_node_t> const &nodes) {
+    size_t const n_workers = rabit::GetWorldSize();
+    size_t const rank = rabit::GetRank();
+    size_t const nbins = builder_.GetNumBins();
+    // Number of non-zero bins of each node on each worker.
+    std::vector<uint64_t> nnz(nodes.size() * n_workers, 0);
+    common::ParallelFor(nodes.size(), n_threads_, [&](size_t i) {
+      auto hist = hist_[nodes[i]];
+      nnz[i * n_workers + rank] =
+          std::count_if(hist.cbegin(), hist.cend(), [](GradientPairT const &g) {
+            return g.GetGrad() != 0 || g.GetHess() != 0;
+          });
+    });
+    rabit::Allreduce<rabit::op::Sum>(nnz.data(), nnz.size());
+
+    struct SparseEntry {
+      uint32_t bin;
+      ValueT grad;
+      ValueT hess;
+    };
+    std::vector<SparseEntry> entries;
+    std::vector<ValueT> values;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      auto hist = hist_[nodes[i]];
+      auto node_nnz = common::Span<uint64_t>{nnz}.subspan(i * n_workers, n_workers);
+      uint64_t total = std::accumulate(node_nnz.cbegin(), node_nnz.cend(), uint64_t{0});
+      if (static_cast<double>(total) < sparse_sync_ratio_ * static_cast<double>(nbins)) {
+        uint64_t begin = std::accumulate(node_nnz.cbegin(), node_nnz.cbegin() + rank,
+                                         uint64_t{0});
+        entries.resize(total);
+        for (size_t bin = 0, k = begin; bin < nbins; ++bin) {
+          auto g = hist[bin];
+          if (g.GetGrad() != 0 || g.GetHess() != 0) {
+            entries[k++] = {static_cast<uint32_t>(bin), static_cast<ValueT>(g.GetGrad()),
+                            static_cast<ValueT>(g.GetHess())};
+          }
+        }
+        rabit::Allgather(entries.data(), total, begin, node_nnz[rank],
+                         node_nnz[(rank + n_workers - 1) % n_workers]);
+        std::fill(hist.begin(), hist.end(), GradientPairT{});
+        for (auto const &e : entries) {
+          hist[e.bin] += GradientPairT{static_cast<GradientSumT>(e.grad),
+                                       static_cast<GradientSumT>(e.hess)};
+        }
+      } else if (std::is_same<ValueT, GradientSumT>::value) {
+        rabit::Allreduce<rabit::op::Sum>(reinterpret_cast<GradientSumT *>(hist.data()),
+                                         hist.size() * 2);
+      } else {
+        values.resize(nbins * 2);
+        auto p_hist = reinterpret_cast<GradientSumT const *>(hist.data());
+        std::transform(p_hist, p_hist + values.size(), values.begin(),
+                       [](GradientSumT v) { return static_cast<ValueT>(v); });
+        rabit::Allreduce<rabit::op::Sum>(values.data(), values.size());
+        for (size_t bin = 0; bin < nbins; ++bin) {
+          hist[bin] = GradientPairT{static_cast<GradientSumT>(values[bin * 2]),
+                                    static_cast<GradientSumT>(values[bin * 2 + 1])};
+        }
+      }
+    }
+  }
+
+  // Whether the histogram of a node with n_rows should be sparse.
+  bool UseSparse(GHistIndexMatrix const &gidx, size_t n_rows) const {
+    if (gidx.Size() == 0) {
+      return false;
+    }
+    double entries_per_row =
+        static_cast<double>(gidx.row_ptr.back()) / static_cast<double>(gidx.Size());
+    return static_cast<double>(n_rows) * entries_per_row <
+           sparse_hist_ratio_ * static_cast<double>(builder_.GetNumBins());
+  }
+
+  /**
+   * \brief Same as `BuildHist`, but nodes with few rows are built into sparse histograms.
+   *        Siblings of sparse nodes are sparse if their parent is sparse, otherwise they are
+   *        obtained by subtracting the sparse histogram from the dense parent.
+   */
+  void BuildHistWithSparse(GHistIndexMatrix const &gidx, RegTree *p_tree,
+                           common::RowSetCollection const &row_set_collection,
+                           std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
+                           std::vector<ExpandEntry> const &nodes_for_subtraction_trick,
+                           std::vector<GradientPair> const &gpair,
+                           common::ColumnMatrix const *columns) {
+    auto const &tree = *p_tree;
+    bool has_sibling = !nodes_for_subtraction_trick.empty();
+    std::vector<ExpandEntry> dense_build, dense_subtraction, sparse_build;
+    // Pairs of (index in sparse_build, sibling) with sparse and dense parents.
+    std::vector<std::pair<size_t, ExpandEntry>> sparse_siblings, dense_siblings;
+    for (size_t i = 0; i < nodes_for_explicit_hist_build.size(); ++i) {
+      auto const &entry = nodes_for_explicit_hist_build[i];
+      bool sparse_parent = !tree[entry.nid].IsRoot() && hist_.IsSparse(tree[entry.nid].Parent());
+      bool sparse = !tree[entry.nid].IsRoot() &&
+                    (sparse_parent || this->UseSparse(gidx, row_set_collection[entry.nid].Size()));
+      if (!sparse) {
+        dense_build.push_back(entry);
+        if (has_sibling) {
+          dense_subtraction.push_back(nodes_for_subtraction_trick[i]);
+        }
+        continue;
+      }
+      if (has_sibling) {
+        auto &siblings = sparse_parent ? sparse_siblings : dense_siblings;
+        siblings.emplace_back(sparse_build.size(), nodes_for_subtraction_trick[i]);
+      }
+      sparse_build.push_back(entry);
+    }
+
+    int starting_index = std::numeric_limits<int>::max();
+    int sync_count = 0;
+    std::vector<ExpandEntry> dense_rows{dense_subtraction};
+    for (auto const &sibling : dense_siblings) {
+      dense_rows.push_back(sibling.second);
+    }
+    this->AddHistRows(&starting_index, &sync_count, dense_build, dense_rows, p_tree);
+    if (build_all_) {
+      // Parent histograms are evicted, build the siblings explicitly as well.
+      monitor_.Count("RebuiltHist", nodes_for_subtraction_trick.size());
+      dense_build.insert(dense_build.end(), dense_rows.cbegin(), dense_rows.cend());
+      dense_subtraction.clear();
+      for (auto const &sibling : sparse_siblings) {
+        sparse_build.push_back(sibling.second);
+      }
+      sparse_siblings.clear();
+      dense_siblings.clear();
+    }
+
+    for (auto const &entry : sparse_build) {
+      hist_.AddSparseRow(entry.nid);
+    }
+    for (auto const &sibling : sparse_siblings) {
+      hist_.AddSparseRow(sibling.second.nid);
+    }
+    if (gidx.IsDense()) {
+      this->BuildSparseHistograms<false>(gidx, sparse_build, row_set_collection, gpair);
+    } else {
+      this->BuildSparseHistograms<true>(gidx, sparse_build, row_set_collection, gpair);
+    }
+    if (!dense_build.empty()) {
+      common::BlockedSpace2d space(
+          dense_build.size(),
+          [&](size_t nidx_in_set) {
+            return row_set_collection[dense_build[nidx_in_set].nid].Size();
+          },
+          256);
+      this->BuildHistImpl(0, space, gidx, p_tree, row_set_collection, dense_build,
+                          dense_subtraction, gpair, columns, starting_index, sync_count);
+    }
+    for (auto const &entry : sparse_build) {
+      if (!tree[entry.nid].IsRoot()) {
+        releasable_.push_back(tree[entry.nid].Parent());
+      }
+    }
+
+    // sibling = parent - node, bins of node are a subset of bins of its parent.
+    common::ParallelFor(sparse_siblings.size(), n_threads_, [&](size_t i) {
+      auto const &node = hist_.SparseRow(sparse_build[sparse_siblings[i].first].nid);
+      auto nidx = sparse_siblings[i].second.nid;
+      auto const &parent = hist_.SparseRow(tree[nidx].Parent());
+      auto &sibling = hist_.SparseRow(nidx);
+      sibling.bins = parent.bins;
+      sibling.values = parent.values;
+      size_t k = 0;
+      for (size_t j = 0; j < parent.Size() && k < node.Size(); ++j) {
+        if (node.bins[k] == parent.bins[j]) {
+          sibling.values[j] = parent.values[j] - node.values[k];
+          ++k;
+        }
+      }
+      CHECK_EQ(k, node.Size());
+    });
+    const size_t nbins = builder_.GetNumBins();
+    common::BlockedSpace2d space(dense_siblings.size(), [&](size_t) { return nbins; }, 1024);
+    common::ParallelFor2d(space, n_threads_, [&](size_t i, common::Range1d r) {
+      auto const &node = hist_.SparseRow(sparse_build[dense_siblings[i].first].nid);
+      auto nidx = dense_siblings[i].second.nid;
+      auto sibling = hist_[nidx];
+      common::CopyHist(sibling, hist_[tree[nidx].Parent()], r.begin(), r.end());
+      auto range = node.Range(r.begin(), r.end());
+      for (size_t k = range.first; k < range.second; ++k) {
+        auto bin = node.bins[k];
+        sibling[bin] -= node.values[k];
+      }
+    });
+  }
+
+  template <bool any_missing>
+  void BuildSparseHistograms(GHistIndexMatrix const &gidx, std::vector<ExpandEntry> const &nodes,
+                             common::RowSetCollection const &row_set_collection,
+                             std::vector<GradientPair> const &gpair) {
+    if (sparse_scratch_.size() != static_cast<size_t>(n_threads_)) {
+      sparse_scratch_.resize(n_threads_);
+    }
+    common::ParallelFor(nodes.size(), n_threads_, common::Sched::Dyn(), [&](size_t i) {
+      auto &scratch = sparse_scratch_[common::ThreadIdx()];
+      if (scratch.empty()) {
+        scratch.resize(builder_.GetNumBins());
+      }
+      auto nidx = nodes[i].nid;
+      auto elem = row_set_collection[nidx];
+      builder_.template BuildSparseHist<any_missing>(
+          gpair, elem, gidx, {scratch.data(), scratch.size()}, &hist_.SparseRow(nidx));
+    });
+    monitor_.Count("SparseHist", nodes.size());
+  }
+
+  void BuildHistImpl(size_t page_id, common::BlockedSpace2d space, GHistIndexMatrix const &gidx,
+                     RegTree *p_tree, common::RowSetCollection const &row_set_collection,
+                     std::vector<ExpandEntry> const &nodes_for_explicit_hist_build,
+                     std::vector<ExpandEntry> const &nodes_for_subtraction_trick,
+                     std::vector<GradientPair> const &gpair,
+                     common::ColumnMatrix const *columns, int starting_index, int sync_count) {
+    if (columns &&
+        this->UseColumnWise(*columns, gidx, nodes_for_explicit_hist_build, row_set_collection)) {
+      this->BuildLocalHistogramsColumnWise(*columns, nodes_for_explicit_hist_build,
+                                           row_set_collection, gpair);
+    } else if (this->UseNodeSweep(gidx, nodes_for_explicit_hist_build, row_set_collection)) {
+      if (gidx.IsDense()) {
+        this->BuildLocalHistogramsByNode<false>(gidx, nodes_for_explicit_hist_build,
+                                                row_set_collection, gpair);
+      } else {
+        this->BuildLocalHistogramsByNode<true>(gidx, nodes_for_explicit_hist_build,
+                                               row_set_collection, gpair);
+      }
+    } else if (gidx.IsDense()) {
+      this->BuildLocalHistograms<false>(page_id, space, gidx,
+                                        nodes_for_explicit_hist_build,
+                                        row_set_collection, gpair);
+    } else {
+      this->BuildLocalHistograms<true>(page_id, space, gidx,
+                                       nodes_for_explicit_hist_build,
+                                       row_set_collection, gpair);
+    }
+
+    CHECK_GE(n_batches_, 1);
+    if (page_id != n_batches_ - 1) {
+      return;
+    }
+
+    if (is_distributed_) {
+      monitor_.Start("AllReduce");
+      this->SyncHistogramDistributed(p_tree, nodes_for_explicit_hist_build,
+                                     nodes_for_subtraction_trick,
+                                     starting_index, sync_count);
+      monitor_.Stop("AllReduce");
+    } else {
+      this->SyncHistogramLocal(p_tree, nodes_for_explicit_hist_build,
+                               nodes_for_subtraction_trick, starting_index,
+                               sync_count);
+    }
+    for (auto const &entry : nodes_for_explicit_hist_build) {
+      if (!(*p_tree)[entry.nid].IsRoot()) {
+        releasable_.push_back((*p_tree)[entry.nid].Parent());
+      }
+    }
+  }
+
+  // Whether n_new histograms can be added without exceeding the memory budget.
+  bool CanHost(size_t n_new) const {
+    if (max_cached_bytes_ == 0) {
+      return true;
+    }
+    size_t n_reused = std::min(n_new, hist_.FreeRows());
+    size_t n_rows = hist_.AllocatedRows() + n_new - n_reused;
+    size_t bytes = n_rows * builder_.GetNumBins() * sizeof(GradientPairT);
+    if (is_distributed_) {
+      bytes *= 2;  // local copy of histograms
+    }
+    return bytes <= max_cached_bytes_;
+  }
+
+  template <typename BinIdxType>
+  void DispatchColumnWise(common::ColumnMatrix const &columns,
+                          std::vector<ExpandEntry> const &nodes,
+                          common::RowSetCollection const &row_set_collection,
+                          std::vector<GradientPair> const &gpair_h,
+                          std::vector<GHistRowT> const &hists) {
+    if (columns.AnyMissing()) {
+      this->BuildColumnWise<BinIdxType, true>(columns, nodes, row_set_collection, gpair_h,
+                                              hists);
+    } else {
+      this->BuildColumnWise<BinIdxType, false>(columns, nodes, row_set_collection, gpair_h,
+                                               hists);
+    }
+  }
+
+  template <typename BinIdxType, bool any_missing>
+  void BuildColumnWise(common::ColumnMatrix const &columns,
+                       std::vector<ExpandEntry> const &nodes,
+                       common::RowSetCollection const &row_set_collection,
+                       std::vector<GradientPair> const &gpair_h,
+                       std::vector<GHistRowT> const &hists) {
+    auto const *pgh = gpair_h.data();
+    auto const *row_slot = row_slot_.data();
+    common::ParallelFor(columns.GetNumFeature(), n_threads_, common::Sched::Dyn(),
+                        [&](bst_feature_t fidx) {
+      auto column_ptr = columns.GetColumn<BinIdxType, any_missing>(fidx);
+      if (column_ptr->GetType() == common::kDenseColumn) {
+        // Walk rows of each node.
+        auto const &column =
+            static_cast<common::DenseColumn<BinIdxType, any_missing> const &>(*column_ptr);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+          auto elem = row_set_collection[nodes[i].nid];
+          auto hist = hists[i];
+          for (auto it = elem.begin; it != elem.end; ++it) {
+            if (any_missing && column.IsMissing(*it)) {
+              continue;
+            }
+            hist[column.GetGlobalBinIdx(*it)].Add(pgh[*it].GetGrad(), pgh[*it].GetHess());
+          }
+        }
+      } else {
+        // Walk the column and look up the node of each row.
+        auto const &column = static_cast<common::SparseColumn<BinIdxType> const &>(*column_ptr);
+        auto const *row_data = column.GetRowData();
+        for (size_t k = 0; k < column.Size(); ++k) {
+          auto rid = row_data[k];
+          auto slot = row_slot[rid];
+          if (slot == -1) {
+            continue;
+          }
+          hists[slot][column.GetGlobalBinIdx(k)].Add(pgh[rid].GetGrad(), pgh[rid].GetHess());
+        }
+      }
+    });
+  }
+
   void
   ParallelSubtractionHist(const common::BlockedSpace2d &space,
                           const std::vector<ExpandEntry> &nodes,
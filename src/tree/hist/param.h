@@ -11,10 +11,120 @@ namespace tree {
 struct CPUHistMakerTrainParam
     : public XGBoostParameter<CPUHistMakerTrainParam> {
   bool single_precision_histogram;
+  bool compensated_histogram;
+  bool quantize_gradient;
+  bool deterministic_histogram;
+  size_t max_cached_hist_bytes;
+  int32_t lossguide_batch_size;
+  float sparse_hist_ratio;
+  float sparse_sync_ratio;
+  bool sync_single_precision;
+  bool reduce_scatter_hist;
+  int32_t parallel_tree_concurrency;
+  bool tune_threads;
+  bool feature_bundling;
+  float dense_missing_ratio;
+  float goss_top_rate;
+  float node_sweep_ratio;
+  bool release_raw_data;
+  bool feature_parallel;
   // declare parameters
   DMLC_DECLARE_PARAMETER(CPUHistMakerTrainParam) {
     DMLC_DECLARE_FIELD(single_precision_histogram).set_default(false).describe(
         "Use single precision to build histograms.");
+    DMLC_DECLARE_FIELD(compensated_histogram).set_default(true).describe(
+        "Accumulate bounded blocks of rows in single precision histograms and sum the "
+        "blocks in double precision.  Only used with single_precision_histogram.");
+    DMLC_DECLARE_FIELD(quantize_gradient).set_default(false).describe(
+        "Quantize gradient to 16 bit integers with a global scale and build histograms "
+        "with 64 bit integers.  Takes precedence over single_precision_histogram.");
+    DMLC_DECLARE_FIELD(deterministic_histogram).set_default(false).describe(
+        "Round gradient such that double precision histogram sums are exact, which makes "
+        "the model independent of the number of threads.  Takes precedence over "
+        "single_precision_histogram.");
+    DMLC_DECLARE_FIELD(max_cached_hist_bytes)
+        .set_default(0)
+        .describe(
+            "Memory budget in bytes for cached node histograms.  Once exceeded, cached "
+            "histograms are dropped and nodes are built without the subtraction trick. "
+            "0 means unlimited.");
+    DMLC_DECLARE_FIELD(lossguide_batch_size)
+        .set_default(1)
+        .set_lower_bound(1)
+        .describe(
+            "Maximum number of nodes expanded in one pass over data with lossguide policy. "
+            "Larger values approximate the best first order with fewer passes.");
+    DMLC_DECLARE_FIELD(sparse_hist_ratio)
+        .set_default(0.125f)
+        .set_lower_bound(0.0f)
+        .describe(
+            "Nodes with number of entries less than this ratio of total bins store only the "
+            "bins with entries in their histograms.  0 means disabled.");
+    DMLC_DECLARE_FIELD(sparse_sync_ratio)
+        .set_default(0.0f)
+        .set_lower_bound(0.0f)
+        .describe(
+            "Histograms with non-zero bins summed over all workers less than this ratio of "
+            "total bins are synchronized as (bin, value) pairs in distributed training.  0 "
+            "means disabled.");
+    DMLC_DECLARE_FIELD(sync_single_precision)
+        .set_default(false)
+        .describe("Send histograms in single precision in distributed training.");
+    DMLC_DECLARE_FIELD(reduce_scatter_hist)
+        .set_default(false)
+        .describe(
+            "Each worker only receives histograms of its own range of features and "
+            "evaluates splits on them, best splits are then chosen among workers.");
+    DMLC_DECLARE_FIELD(parallel_tree_concurrency)
+        .set_default(1)
+        .set_lower_bound(1)
+        .describe(
+            "Maximum number of trees from the same boosting round (num_parallel_tree) built "
+            "concurrently, each with its own buffers and a share of threads.");
+    DMLC_DECLARE_FIELD(tune_threads)
+        .set_default(false)
+        .describe(
+            "Measure the throughput of each training phase with different number of threads "
+            "during the first iterations and use the fastest one afterward.  Results are not "
+            "reproducible across runs as the order of summation depends on thread count.");
+    DMLC_DECLARE_FIELD(feature_bundling)
+        .set_default(false)
+        .describe(
+            "Build histograms on bundles of mutually exclusive sparse features, like one-hot "
+            "encoded columns, for dense data on a single worker.  Splits still use the "
+            "original features.");
+    DMLC_DECLARE_FIELD(dense_missing_ratio)
+        .set_range(0.0f, 1.0f)
+        .set_default(0.0f)
+        .describe(
+            "Data with missing values but with at least this ratio of non-missing entries is "
+            "stored as dense with a bin for missing values of each feature, for a single "
+            "worker.  0 means disabled.");
+    DMLC_DECLARE_FIELD(goss_top_rate)
+        .set_range(0.0f, 1.0f)
+        .set_default(0.5f)
+        .describe(
+            "Fraction of sampled rows chosen by largest absolute gradient with "
+            "gradient_based sampling, the others are sampled uniformly from the remaining "
+            "rows with amplified gradient.");
+    DMLC_DECLARE_FIELD(node_sweep_ratio)
+        .set_range(0.0f, 1.0f)
+        .set_default(0.0f)
+        .describe(
+            "Nodes built together whose rows are at least this ratio of all rows are built "
+            "by sweeping all rows in order with the node of each row, instead of gathering "
+            "rows of each node.  0 means disabled.");
+    DMLC_DECLARE_FIELD(release_raw_data)
+        .set_default(false)
+        .describe(
+            "Release the raw data of the training DMatrix once it's quantized, prediction on "
+            "the training data then uses the quantized data.");
+    DMLC_DECLARE_FIELD(feature_parallel)
+        .set_default(false)
+        .describe(
+            "Parallelize over features instead of rows on a single worker, for wide data "
+            "with few rows.  Each thread builds and evaluates histograms of its own features "
+            "for all nodes being expanded, only the best splits are reduced.");
   }
 };
 }  // namespace tree
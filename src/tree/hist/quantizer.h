@@ -0,0 +1,158 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#ifndef XGBOOST_TREE_HIST_QUANTIZER_H_
+#define XGBOOST_TREE_HIST_QUANTIZER_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "rabit/rabit.h"
+#include "xgboost/base.h"
+#include "../param.h"
+#include "../../common/common.h"
+#include "../../common/threading_utils.h"
+
+namespace xgboost {
+namespace tree {
+/**
+ * \brief Quantize gradient into 16 bit integers with a global scale, such that histograms
+ *        can be accumulated with integers.  Integer sums are exact, hence the resulting
+ *        histograms are independent of the number of threads and workers.
+ *
+ *   The unit of gradient and hessian are powers of 2, so converting integer sums back to
+ *   floating point is exact as well.  The default quantizer has unit 1 and is used by
+ *   floating point histograms.
+ */
+class GradientQuantizer {
+  GradStats unit_{1.0, 1.0};
+
+ public:
+  static int32_t constexpr kMaxValue = std::numeric_limits<int16_t>::max();
+
+  GradientQuantizer() = default;
+  /**
+   * \brief Choose the unit based on maximum absolute gradient and hessian across all
+   *        workers.
+   */
+  GradientQuantizer(std::vector<GradientPair> const &gpair, int32_t n_threads) {
+    std::vector<float> tloc_max(n_threads * 2, 0.0f);
+    common::ParallelFor(gpair.size(), n_threads, [&](size_t i) {
+      auto tidx = common::ThreadIdx();
+      auto &max_grad = tloc_max[tidx * 2];
+      auto &max_hess = tloc_max[tidx * 2 + 1];
+      max_grad = std::max(max_grad, std::abs(gpair[i].GetGrad()));
+      max_hess = std::max(max_hess, std::abs(gpair[i].GetHess()));
+    });
+    float max_abs[2]{0.0f, 0.0f};
+    for (int32_t t = 0; t < n_threads; ++t) {
+      max_abs[0] = std::max(max_abs[0], tloc_max[t * 2]);
+      max_abs[1] = std::max(max_abs[1], tloc_max[t * 2 + 1]);
+    }
+    rabit::Allreduce<rabit::op::Max>(max_abs, 2);
+    auto unit = [](float v) {
+      if (v == 0.0f || !std::isfinite(v)) {
+        return 1.0;
+      }
+      int32_t exp;
+      // smallest power of 2 satisfying v / unit <= kMaxValue
+      std::frexp(static_cast<double>(v) / kMaxValue, &exp);
+      return std::ldexp(1.0, exp);
+    };
+    unit_ = GradStats{unit(max_abs[0]), unit(max_abs[1])};
+  }
+
+  /**
+   * \brief Round gradient to multiples of unit in place, the results are integers stored
+   *        as floating point.
+   */
+  void Quantize(std::vector<GradientPair> *gpair, int32_t n_threads) const {
+    auto &h_gpair = *gpair;
+    common::ParallelFor(h_gpair.size(), n_threads, [&](size_t i) {
+      auto g = std::nearbyint(h_gpair[i].GetGrad() / unit_.GetGrad());
+      auto h = std::nearbyint(h_gpair[i].GetHess() / unit_.GetHess());
+      h_gpair[i] = GradientPair{static_cast<float>(g), static_cast<float>(h)};
+    });
+  }
+
+  template <typename T>
+  GradStats ToFloatingPoint(detail::GradientPairInternal<T> const &sum) const {
+    return GradStats{static_cast<double>(sum.GetGrad()) * unit_.GetGrad(),
+                     static_cast<double>(sum.GetHess()) * unit_.GetHess()};
+  }
+  GradStats const &Unit() const { return unit_; }
+};
+
+/**
+ * \brief Round gradient to multiples of a power of 2 small enough to keep the precision of
+ *        floating point histograms, but large enough that every sum of the rounded values
+ *        is exact in double precision.  Histograms are then independent of the order of
+ *        summation, hence of the number of threads, while being built as usual.
+ *
+ *   With `unit` being 2^-52 of the smallest power of 2 not less than the sums of positive
+ *   and negative values, any partial sum is a multiple of `unit` below 2^53 units.  Only
+ *   values less than 2^-28 of the sums are actually changed.
+ */
+class GradientRounding {
+  GradStats unit_{0.0, 0.0};
+  static size_t constexpr kBlockRows = 2048;
+
+  static double Unit(double sum) {
+    if (sum == 0.0 || !std::isfinite(sum)) {
+      return 0.0;
+    }
+    int32_t exp;
+    std::frexp(sum, &exp);
+    return std::ldexp(1.0, exp - std::numeric_limits<double>::digits + 1);
+  }
+  static float RoundValue(float v, double unit) {
+    return unit == 0.0 ? v : static_cast<float>(std::nearbyint(v / unit) * unit);
+  }
+
+ public:
+  GradientRounding() = default;
+  /**
+   * \brief Choose the unit based on sums of absolute gradient and hessian across all
+   *        workers.
+   */
+  GradientRounding(std::vector<GradientPair> const &gpair, int32_t n_threads) {
+    // Positive and negative sums of gradient and hessian.  Blocks of fixed size are summed
+    // in order so the unit doesn't depend on the number of threads.
+    auto n_blocks = common::DivRoundUp(gpair.size(), kBlockRows);
+    std::vector<std::array<double, 4>> partial(n_blocks, {0.0, 0.0, 0.0, 0.0});
+    common::ParallelFor(n_blocks, n_threads, [&](size_t b) {
+      auto &sum = partial[b];
+      auto end = std::min(gpair.size(), (b + 1) * kBlockRows);
+      for (size_t i = b * kBlockRows; i < end; ++i) {
+        double g = gpair[i].GetGrad(), h = gpair[i].GetHess();
+        sum[g < 0 ? 1 : 0] += std::abs(g);
+        sum[h < 0 ? 3 : 2] += std::abs(h);
+      }
+    });
+    std::array<double, 4> sum{0.0, 0.0, 0.0, 0.0};
+    for (auto const &p : partial) {
+      for (size_t k = 0; k < sum.size(); ++k) {
+        sum[k] += p[k];
+      }
+    }
+    rabit::Allreduce<rabit::op::Sum>(sum.data(), sum.size());
+    unit_ = GradStats{Unit(std::max(sum[0], sum[1])), Unit(std::max(sum[2], sum[3]))};
+  }
+
+  /*! \brief Round gradient to multiples of unit in place. */
+  void Round(std::vector<GradientPair> *gpair, int32_t n_threads) const {
+    auto &h_gpair = *gpair;
+    common::ParallelFor(h_gpair.size(), n_threads, [&](size_t i) {
+      h_gpair[i] = GradientPair{RoundValue(h_gpair[i].GetGrad(), unit_.GetGrad()),
+                                RoundValue(h_gpair[i].GetHess(), unit_.GetHess())};
+    });
+  }
+  GradStats const &Unit() const { return unit_; }
+};
+}  // namespace tree
+}  // namespace xgboost
+#endif  // XGBOOST_TREE_HIST_QUANTIZER_H_
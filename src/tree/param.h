@@ -34,11 +34,21 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
   int max_leaves;
   // if using histogram based algorithm, maximum number of bins per feature
   int max_bin;
+  // if using histogram based algorithm, number of rows sampled for building the cuts
+  size_t sketch_sample_rows;
+  // if using histogram based algorithm, maximum number of bins of each feature
+  std::vector<int> max_bin_per_feature;
+  // if using histogram based algorithm, maximum total number of bins of numerical features
+  size_t max_total_bins;
+  // if using histogram based algorithm, pack bins of features with few bins into 2 or 4 bits
+  bool pack_bins;
   // growing policy
   enum TreeGrowPolicy { kDepthWise = 0, kLossGuide = 1 };
   int grow_policy;
 
   uint32_t max_cat_to_onehot{1};
+  // maximum number of categories in the chosen partition of a categorical split
+  uint32_t max_cat_threshold{64};
 
   //----- the rest parameters are less important ----
   // minimum amount of hessian(weight) allowed in a child
@@ -66,6 +76,10 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
   float sketch_eps;
   // accuracy of sketch
   float sketch_ratio;
+  // maximum number of trees sharing the same sketch in approx
+  int sketch_refresh_interval;
+  // relative change of hessian that triggers a new sketch in approx
+  float sketch_refresh_drift;
   // option to open cacheline optimization
   bool cache_opt;
   // whether refresh updater needs to update the leaf values
@@ -101,6 +115,27 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
         "Maximum number of leaves; 0 indicates no limit.");
     DMLC_DECLARE_FIELD(max_bin).set_lower_bound(2).set_default(256).describe(
         "if using histogram-based algorithm, maximum number of bins per feature");
+    DMLC_DECLARE_FIELD(sketch_sample_rows)
+        .set_default(0)
+        .describe(
+            "if using histogram-based algorithm, build the cuts from a uniform sample of about "
+            "this number of rows, 0 means using all rows.");
+    DMLC_DECLARE_FIELD(max_bin_per_feature)
+        .set_default(std::vector<int>())
+        .describe(
+            "if using histogram-based algorithm, maximum number of bins of each feature, "
+            "features without a positive value use max_bin.");
+    DMLC_DECLARE_FIELD(max_total_bins)
+        .set_default(0)
+        .describe(
+            "if using histogram-based algorithm, upper bound of the total number of bins of "
+            "numerical features, features with more distinct values share the budget "
+            "evenly.  0 means no bound.");
+    DMLC_DECLARE_FIELD(pack_bins)
+        .set_default(false)
+        .describe(
+            "if using histogram-based algorithm on dense data, store bins of features with at "
+            "most 16 bins in 4 bits and at most 4 bins in 2 bits.");
     DMLC_DECLARE_FIELD(grow_policy)
         .set_default(kDepthWise)
         .add_enum("depthwise", kDepthWise)
@@ -113,6 +148,12 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
         .set_default(4)
         .set_lower_bound(1)
         .describe("Maximum number of categories to use one-hot encoding based split.");
+    DMLC_DECLARE_FIELD(max_cat_threshold)
+        .set_default(64)
+        .set_lower_bound(1)
+        .describe(
+            "Maximum number of categories considered for each partition based split, categories "
+            "in the chosen partition go to the right child.");
     DMLC_DECLARE_FIELD(min_child_weight)
         .set_lower_bound(0.0f)
         .set_default(1.0f)
@@ -162,6 +203,17 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
         .set_lower_bound(0.0f)
         .set_default(2.0f)
         .describe("EXP Param: Sketch accuracy related parameter of approximate algorithm.");
+    DMLC_DECLARE_FIELD(sketch_refresh_interval)
+        .set_lower_bound(1)
+        .set_default(1)
+        .describe("Maximum number of trees using the same sketch in approximate algorithm. "
+                  "1 means sketching for every tree.");
+    DMLC_DECLARE_FIELD(sketch_refresh_drift)
+        .set_lower_bound(0.0f)
+        .set_default(0.0f)
+        .describe("Sketch again once the L1 distance between current hessian and the "
+                  "hessian used by last sketch exceeds this ratio of the latter.  0 means "
+                  "only sketch_refresh_interval is used.");
     DMLC_DECLARE_FIELD(cache_opt)
         .set_default(true)
         .describe("EXP Param: Cache aware optimization.");
@@ -221,6 +273,17 @@ struct TrainParam : public XGBoostParameter<TrainParam> {
   }
 };
 
+/*! \brief Batch parameter for fetching the gradient index used by CPU hist. */
+inline BatchParam HistBatch(TrainParam const &param) {
+  BatchParam batch{GenericParameter::kCpuId, param.max_bin};
+  batch.sketch_sample_rows = param.sketch_sample_rows;
+  batch.feature_max_bin.assign(param.max_bin_per_feature.cbegin(),
+                               param.max_bin_per_feature.cend());
+  batch.max_total_bins = param.max_total_bins;
+  batch.pack_bins = param.pack_bins;
+  return batch;
+}
+
 /*! \brief Loss functions */
 
 // functions for L1 cost
@@ -10,6 +10,7 @@
 
 #include <dmlc/registry.h>
 #include <xgboost/base.h>
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <limits>
@@ -31,6 +32,11 @@ class TreeEvaluator {
   HostDeviceVector<float> lower_bounds_;
   HostDeviceVector<float> upper_bounds_;
   HostDeviceVector<int32_t> monotone_;
+  // Bounds on CPU, grown with the tree instead of being allocated for the maximum number
+  // of nodes, and updated in place without going through `HostDeviceVector`.  Views
+  // returned by `GetEvaluator` are invalidated by `AddSplit`.
+  std::vector<float> h_lower_bounds_;
+  std::vector<float> h_upper_bounds_;
   int32_t device_;
   bool has_constraint_;
 
@@ -49,8 +55,13 @@ class TreeEvaluator {
     } else {
       monotone_.HostVector() = p.monotone_constraints;
       monotone_.HostVector().resize(n_features, 0);
-      lower_bounds_.Resize(p.MaxNodes(), -std::numeric_limits<float>::max());
-      upper_bounds_.Resize(p.MaxNodes(), std::numeric_limits<float>::max());
+      if (device_ == GenericParameter::kCpuId) {
+        h_lower_bounds_.resize(1, -std::numeric_limits<float>::max());
+        h_upper_bounds_.resize(1, std::numeric_limits<float>::max());
+      } else {
+        lower_bounds_.Resize(p.MaxNodes(), -std::numeric_limits<float>::max());
+        upper_bounds_.Resize(p.MaxNodes(), std::numeric_limits<float>::max());
+      }
       has_constraint_ = true;
     }
 
@@ -142,8 +153,8 @@ class TreeEvaluator {
           upper_bounds_.ConstDeviceSpan(), has_constraint_};
     } else {
       auto constraints = monotone_.ConstHostSpan();
-      return SplitEvaluator<ParamT>{constraints, lower_bounds_.ConstHostSpan(),
-                                    upper_bounds_.ConstHostSpan(),
+      return SplitEvaluator<ParamT>{constraints, common::Span<float const>{h_lower_bounds_},
+                                    common::Span<float const>{h_upper_bounds_},
                                     has_constraint_};
     }
   }
@@ -154,6 +165,10 @@ class TreeEvaluator {
     if (!has_constraint_) {
       return;
     }
+    if (device_ == GenericParameter::kCpuId) {
+      this->AddSplitHost(nodeid, leftid, rightid, f, left_weight, right_weight);
+      return;
+    }
     common::Transform<>::Init(
         [=] XGBOOST_DEVICE(size_t, common::Span<float> lower,
                            common::Span<float> upper,
@@ -179,6 +194,35 @@ class TreeEvaluator {
         common::Range(0, 1), device_, false)
         .Eval(&lower_bounds_, &upper_bounds_, &monotone_);
   }
+
+ private:
+  void AddSplitHost(bst_node_t nodeid, bst_node_t leftid, bst_node_t rightid,
+                    bst_feature_t f, float left_weight, float right_weight) {
+    auto n_nodes = static_cast<size_t>(std::max(leftid, rightid)) + 1;
+    if (h_lower_bounds_.size() < n_nodes) {
+      h_lower_bounds_.resize(n_nodes, -std::numeric_limits<float>::max());
+      h_upper_bounds_.resize(n_nodes, std::numeric_limits<float>::max());
+    }
+    auto &lower = h_lower_bounds_;
+    auto &upper = h_upper_bounds_;
+    lower[leftid] = lower[nodeid];
+    upper[leftid] = upper[nodeid];
+
+    lower[rightid] = lower[nodeid];
+    upper[rightid] = upper[nodeid];
+    int32_t c = monotone_.ConstHostVector()[f];
+    bst_float mid = (left_weight + right_weight) / 2;
+
+    CHECK(!common::CheckNAN(mid));
+
+    if (c < 0) {
+      lower[leftid] = mid;
+      upper[rightid] = mid;
+    } else if (c > 0) {
+      upper[leftid] = mid;
+      lower[rightid] = mid;
+    }
+  }
 };
 }  // namespace tree
 }  // namespace xgboost
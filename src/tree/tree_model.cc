@@ -752,9 +752,30 @@ bool RegTree::Equal(const RegTree& b) const {
       ret = false;
       return false;
     }
+    if (self[nidx].IsLeaf() && self.IsMultiTarget()) {
+      auto l = self.LeafVector(nidx);
+      auto r = b.LeafVector(nidx);
+      if (!std::equal(l.cbegin(), l.cend(), r.cbegin())) {
+        ret = false;
+        return false;
+      }
+    }
     return true;
   });
-  return ret;
+  return ret && param.size_leaf_vector == b.param.size_leaf_vector;
+}
+
+void RegTree::SetNumTargets(bst_group_t n_targets) {
+  CHECK_EQ(param.num_nodes, 1) << "Number of targets must be set before expanding tree.";
+  CHECK_GT(n_targets, 1);
+  param.size_leaf_vector = static_cast<int>(n_targets);
+  leaf_vector_.assign(n_targets, 0.0f);
+}
+
+void RegTree::SetLeafVector(bst_node_t nidx, common::Span<float const> weights) {
+  CHECK(IsMultiTarget());
+  CHECK_EQ(weights.size(), static_cast<size_t>(param.size_leaf_vector));
+  std::copy(weights.cbegin(), weights.cend(), leaf_vector_.begin() + nidx * weights.size());
 }
 
 bst_node_t RegTree::GetNumLeaves() const {
@@ -861,6 +882,15 @@ void RegTree::Load(dmlc::Stream* fi) {
 
   split_types_.resize(param.num_nodes, FeatureType::kNumerical);
   split_categories_segments_.resize(param.num_nodes);
+
+  leaf_vector_.resize(static_cast<size_t>(param.num_nodes) * param.size_leaf_vector);
+  if (!leaf_vector_.empty()) {
+    CHECK_EQ(fi->Read(dmlc::BeginPtr(leaf_vector_), sizeof(float) * leaf_vector_.size()),
+             sizeof(float) * leaf_vector_.size());
+    if (!DMLC_IO_NO_ENDIAN_SWAP) {
+      dmlc::ByteSwap(dmlc::BeginPtr(leaf_vector_), sizeof(float), leaf_vector_.size());
+    }
+  }
 }
 
 void RegTree::Save(dmlc::Stream* fo) const {
@@ -892,28 +922,38 @@ void RegTree::Save(dmlc::Stream* fo) const {
       fo->Write(&x, sizeof(x));
     }
   }
+  // Leaf vectors are appended after node statistics.
+  CHECK_EQ(leaf_vector_.size(), static_cast<size_t>(param.num_nodes) * param.size_leaf_vector);
+  if (DMLC_IO_NO_ENDIAN_SWAP) {
+    fo->Write(dmlc::BeginPtr(leaf_vector_), sizeof(float) * leaf_vector_.size());
+  } else {
+    for (float w : leaf_vector_) {
+      dmlc::ByteSwap(&w, sizeof(w), 1);
+      fo->Write(&w, sizeof(w));
+    }
+  }
 }
 
 void RegTree::LoadCategoricalSplit(Json const& in) {
-  auto const& categories_segments = get<Array const>(in["categories_segments"]);
-  auto const& categories_sizes = get<Array const>(in["categories_sizes"]);
-  auto const& categories_nodes = get<Array const>(in["categories_nodes"]);
-  auto const& categories = get<Array const>(in["categories"]);
+  auto const categories_segments = GetNumericArray<int64_t>(in["categories_segments"]);
+  auto const categories_sizes = GetNumericArray<int64_t>(in["categories_sizes"]);
+  auto const categories_nodes = GetNumericArray<bst_node_t>(in["categories_nodes"]);
+  auto const categories = GetNumericArray<int32_t>(in["categories"]);
 
   size_t cnt = 0;
   bst_node_t last_cat_node = -1;
   if (!categories_nodes.empty()) {
-    last_cat_node = get<Integer const>(categories_nodes[cnt]);
+    last_cat_node = categories_nodes[cnt];
   }
   for (bst_node_t nidx = 0; nidx < param.num_nodes; ++nidx) {
     if (nidx == last_cat_node) {
-      auto j_begin = get<Integer const>(categories_segments[cnt]);
-      auto j_end = get<Integer const>(categories_sizes[cnt]) + j_begin;
+      auto j_begin = categories_segments[cnt];
+      auto j_end = categories_sizes[cnt] + j_begin;
       bst_cat_t max_cat{std::numeric_limits<bst_cat_t>::min()};
       CHECK_NE(j_end - j_begin, 0) << nidx;
 
       for (auto j = j_begin; j < j_end; ++j) {
-        auto const &category = get<Integer const>(categories[j]);
+        auto const &category = categories[j];
         auto cat = common::AsCat(category);
         max_cat = std::max(max_cat, cat);
       }
@@ -924,7 +964,7 @@ void RegTree::LoadCategoricalSplit(Json const& in) {
       std::vector<uint32_t> cat_bits_storage(size, 0);
       common::CatBitField cat_bits{common::Span<uint32_t>(cat_bits_storage)};
       for (auto j = j_begin; j < j_end; ++j) {
-        cat_bits.Set(common::AsCat(get<Integer const>(categories[j])));
+        cat_bits.Set(common::AsCat(categories[j]));
       }
 
       auto begin = split_categories_.size();
@@ -938,7 +978,7 @@ void RegTree::LoadCategoricalSplit(Json const& in) {
       if (cnt == categories_nodes.size()) {
         last_cat_node = -1;
       } else {
-        last_cat_node = get<Integer const>(categories_nodes[cnt]);
+        last_cat_node = categories_nodes[cnt];
       }
     } else {
       split_categories_segments_[nidx].beg = categories.size();
@@ -952,34 +992,34 @@ void RegTree::SaveCategoricalSplit(Json* p_out) const {
   CHECK_EQ(this->split_types_.size(), param.num_nodes);
   CHECK_EQ(this->GetSplitCategoriesPtr().size(), param.num_nodes);
 
-  std::vector<Json> categories_segments;
-  std::vector<Json> categories_sizes;
-  std::vector<Json> categories;
-  std::vector<Json> categories_nodes;
+  I64Array categories_segments;
+  I64Array categories_sizes;
+  I32Array categories;
+  I32Array categories_nodes;
 
   for (size_t i = 0; i < nodes_.size(); ++i) {
     if (this->split_types_[i] == FeatureType::kCategorical) {
-      categories_nodes.emplace_back(i);
-      auto begin = categories.size();
-      categories_segments.emplace_back(static_cast<Integer::Int>(begin));
+      categories_nodes.GetArray().emplace_back(static_cast<int32_t>(i));
+      auto begin = categories.Size();
+      categories_segments.GetArray().emplace_back(static_cast<int64_t>(begin));
       auto segment = split_categories_segments_[i];
       auto node_categories =
           this->GetSplitCategories().subspan(segment.beg, segment.size);
       common::KCatBitField const cat_bits(node_categories);
       for (size_t i = 0; i < cat_bits.Size(); ++i) {
         if (cat_bits.Check(i)) {
-          categories.emplace_back(static_cast<Integer::Int>(i));
+          categories.GetArray().emplace_back(static_cast<int32_t>(i));
         }
       }
-      size_t size = categories.size() - begin;
-      categories_sizes.emplace_back(static_cast<Integer::Int>(size));
+      size_t size = categories.Size() - begin;
+      categories_sizes.GetArray().emplace_back(static_cast<int64_t>(size));
     }
   }
 
-  out["categories_segments"] = categories_segments;
-  out["categories_sizes"] = categories_sizes;
-  out["categories_nodes"] = categories_nodes;
-  out["categories"] = categories;
+  out["categories_segments"] = std::move(categories_segments);
+  out["categories_sizes"] = std::move(categories_sizes);
+  out["categories_nodes"] = std::move(categories_nodes);
+  out["categories"] = std::move(categories);
 }
 
 void RegTree::LoadModel(Json const& in) {
@@ -987,30 +1027,30 @@ void RegTree::LoadModel(Json const& in) {
   auto n_nodes = param.num_nodes;
   CHECK_NE(n_nodes, 0);
   // stats
-  auto const& loss_changes = get<Array const>(in["loss_changes"]);
+  auto const loss_changes = GetNumericArray<float>(in["loss_changes"]);
   CHECK_EQ(loss_changes.size(), n_nodes);
-  auto const& sum_hessian = get<Array const>(in["sum_hessian"]);
+  auto const sum_hessian = GetNumericArray<float>(in["sum_hessian"]);
   CHECK_EQ(sum_hessian.size(), n_nodes);
-  auto const& base_weights = get<Array const>(in["base_weights"]);
+  auto const base_weights = GetNumericArray<float>(in["base_weights"]);
   CHECK_EQ(base_weights.size(), n_nodes);
   // nodes
-  auto const& lefts = get<Array const>(in["left_children"]);
+  auto const lefts = GetNumericArray<bst_node_t>(in["left_children"]);
   CHECK_EQ(lefts.size(), n_nodes);
-  auto const& rights = get<Array const>(in["right_children"]);
+  auto const rights = GetNumericArray<bst_node_t>(in["right_children"]);
   CHECK_EQ(rights.size(), n_nodes);
-  auto const& parents = get<Array const>(in["parents"]);
+  auto const parents = GetNumericArray<bst_node_t>(in["parents"]);
   CHECK_EQ(parents.size(), n_nodes);
-  auto const& indices = get<Array const>(in["split_indices"]);
+  auto const indices = GetNumericArray<bst_feature_t>(in["split_indices"]);
   CHECK_EQ(indices.size(), n_nodes);
-  auto const& conds = get<Array const>(in["split_conditions"]);
+  auto const conds = GetNumericArray<float>(in["split_conditions"]);
   CHECK_EQ(conds.size(), n_nodes);
-  auto const& default_left = get<Array const>(in["default_left"]);
+  auto const default_left = GetNumericArray<uint8_t>(in["default_left"]);
   CHECK_EQ(default_left.size(), n_nodes);
 
   bool has_cat = get<Object const>(in).find("split_type") != get<Object const>(in).cend();
-  std::vector<Json> split_type;
+  std::vector<int32_t> split_type;
   if (has_cat) {
-    split_type = get<Array const>(in["split_type"]);
+    split_type = GetNumericArray<int32_t>(in["split_type"]);
   }
   stats_.clear();
   nodes_.clear();
@@ -1023,22 +1063,15 @@ void RegTree::LoadModel(Json const& in) {
   CHECK_EQ(n_nodes, split_categories_segments_.size());
   for (int32_t i = 0; i < n_nodes; ++i) {
     auto& s = stats_[i];
-    s.loss_chg = get<Number const>(loss_changes[i]);
-    s.sum_hess = get<Number const>(sum_hessian[i]);
-    s.base_weight = get<Number const>(base_weights[i]);
+    s.loss_chg = loss_changes[i];
+    s.sum_hess = sum_hessian[i];
+    s.base_weight = base_weights[i];
 
     auto& n = nodes_[i];
-    bst_node_t left = get<Integer const>(lefts[i]);
-    bst_node_t right = get<Integer const>(rights[i]);
-    bst_node_t parent = get<Integer const>(parents[i]);
-    bst_feature_t ind = get<Integer const>(indices[i]);
-    float cond { get<Number const>(conds[i]) };
-    bool dft_left { get<Boolean const>(default_left[i]) };
-    n = Node{left, right, parent, ind, cond, dft_left};
+    n = Node{lefts[i], rights[i], parents[i], indices[i], conds[i], default_left[i] != 0};
 
     if (has_cat) {
-      split_types_[i] =
-          static_cast<FeatureType>(get<Integer const>(split_type[i]));
+      split_types_[i] = static_cast<FeatureType>(split_type[i]);
     }
   }
 
@@ -1064,6 +1097,12 @@ void RegTree::LoadModel(Json const& in) {
   }
   CHECK_EQ(static_cast<bst_node_t>(deleted_nodes_.size()), param.num_deleted);
   CHECK_EQ(this->split_categories_segments_.size(), param.num_nodes);
+
+  leaf_vector_.clear();
+  if (this->IsMultiTarget()) {
+    leaf_vector_ = GetNumericArray<float>(in["leaf_vector"]);
+    CHECK_EQ(leaf_vector_.size(), static_cast<size_t>(n_nodes) * param.size_leaf_vector);
+  }
 }
 
 void RegTree::SaveModel(Json* p_out) const {
@@ -1078,39 +1117,39 @@ void RegTree::SaveModel(Json* p_out) const {
   CHECK_EQ(param.num_nodes, static_cast<int>(stats_.size()));
   out["tree_param"] = ToJson(param);
   CHECK_EQ(get<String>(out["tree_param"]["num_nodes"]), std::to_string(param.num_nodes));
-  using I = Integer::Int;
   auto n_nodes = param.num_nodes;
 
+  // Numeric fields are typed arrays, stored in bulk by the binary JSON writer.
   // stats
-  std::vector<Json> loss_changes(n_nodes);
-  std::vector<Json> sum_hessian(n_nodes);
-  std::vector<Json> base_weights(n_nodes);
+  F32Array loss_changes(n_nodes);
+  F32Array sum_hessian(n_nodes);
+  F32Array base_weights(n_nodes);
 
   // nodes
-  std::vector<Json> lefts(n_nodes);
-  std::vector<Json> rights(n_nodes);
-  std::vector<Json> parents(n_nodes);
-  std::vector<Json> indices(n_nodes);
-  std::vector<Json> conds(n_nodes);
-  std::vector<Json> default_left(n_nodes);
-  std::vector<Json> split_type(n_nodes);
+  I32Array lefts(n_nodes);
+  I32Array rights(n_nodes);
+  I32Array parents(n_nodes);
+  I32Array indices(n_nodes);
+  F32Array conds(n_nodes);
+  U8Array default_left(n_nodes);
+  U8Array split_type(n_nodes);
   CHECK_EQ(this->split_types_.size(), param.num_nodes);
 
   for (bst_node_t i = 0; i < n_nodes; ++i) {
     auto const& s = stats_[i];
-    loss_changes[i] = s.loss_chg;
-    sum_hessian[i] = s.sum_hess;
-    base_weights[i] = s.base_weight;
+    loss_changes.GetArray()[i] = s.loss_chg;
+    sum_hessian.GetArray()[i] = s.sum_hess;
+    base_weights.GetArray()[i] = s.base_weight;
 
     auto const& n = nodes_[i];
-    lefts[i] = static_cast<I>(n.LeftChild());
-    rights[i] = static_cast<I>(n.RightChild());
-    parents[i] = static_cast<I>(n.Parent());
-    indices[i] = static_cast<I>(n.SplitIndex());
-    conds[i] = n.SplitCond();
-    default_left[i] = n.DefaultLeft();
+    lefts.GetArray()[i] = n.LeftChild();
+    rights.GetArray()[i] = n.RightChild();
+    parents.GetArray()[i] = n.Parent();
+    indices.GetArray()[i] = static_cast<int32_t>(n.SplitIndex());
+    conds.GetArray()[i] = n.SplitCond();
+    default_left.GetArray()[i] = static_cast<uint8_t>(n.DefaultLeft());
 
-    split_type[i] = static_cast<I>(this->NodeSplitType(i));
+    split_type.GetArray()[i] = static_cast<uint8_t>(this->NodeSplitType(i));
   }
 
   this->SaveCategoricalSplit(&out);
@@ -1126,6 +1165,10 @@ void RegTree::SaveModel(Json* p_out) const {
   out["split_indices"] = std::move(indices);
   out["split_conditions"] = std::move(conds);
   out["default_left"] = std::move(default_left);
+
+  if (this->IsMultiTarget()) {
+    out["leaf_vector"] = F32Array{std::vector<float>(leaf_vector_)};
+  }
 }
 
 void RegTree::CalculateContributionsApprox(const RegTree::FVec &feat,
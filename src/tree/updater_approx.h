@@ -77,15 +77,13 @@ class ApproxRowPartitioner {
     });
     auto node_ptr = p_tree->GetCategoriesMatrix().node_ptr;
     auto categories = p_tree->GetCategoriesMatrix().categories;
-    common::ParallelFor2d(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
+    common::ParallelFor2dSteal(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
       auto candidate = candidates[node_in_set];
       auto is_cat = candidate.split.is_cat;
       const int32_t nid = candidate.nid;
       auto fidx = candidate.split.SplitIndex();
-      const size_t task_id = partition_builder_.GetTaskIdx(node_in_set, r.begin());
-      partition_builder_.AllocateForTask(task_id);
-      partition_builder_.PartitionRange(
-          node_in_set, nid, r, fidx, &row_set_collection_, [&](size_t row_id) {
+      partition_builder_.PartitionRangeToMask(
+          node_in_set, nid, r, row_set_collection_, [&](size_t row_id) {
             auto cut_value = SearchCutValue(row_id, fidx, index, cut_ptrs, cut_values);
             if (std::isnan(cut_value)) {
               return candidate.split.DefaultLeft();
@@ -103,12 +101,12 @@ class ApproxRowPartitioner {
           });
     });
 
-    partition_builder_.CalculateRowOffsets();
-    common::ParallelFor2d(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
+    partition_builder_.CalculateMaskOffsets();
+    common::ParallelFor2dSteal(space, ctx->Threads(), [&](size_t node_in_set, common::Range1d r) {
       auto candidate = candidates[node_in_set];
       const int32_t nid = candidate.nid;
-      partition_builder_.MergeToArray(node_in_set, r.begin(),
-                                      const_cast<size_t *>(row_set_collection_[nid].begin));
+      partition_builder_.ScatterFromMask(node_in_set, r, row_set_collection_[nid].begin,
+                                         row_set_collection_.AlternateStorage(nid));
     });
     for (size_t i = 0; i < candidates.size(); ++i) {
       auto const &candidate = candidates[i];
@@ -118,7 +116,7 @@ class ApproxRowPartitioner {
       CHECK_EQ(n_left + n_right, row_set_collection_[nidx].Size());
       bst_node_t left_nidx = (*p_tree)[nidx].LeftChild();
       bst_node_t right_nidx = (*p_tree)[nidx].RightChild();
-      row_set_collection_.AddSplit(nidx, left_nidx, right_nidx, n_left, n_right);
+      row_set_collection_.AddSplitToAlternate(nidx, left_nidx, right_nidx, n_left, n_right);
     }
   }
 
@@ -343,7 +343,7 @@ class BaseMaker: public TreeUpdater {
 #pragma omp parallel
     {
       exc.Run([&]() {
-        const int tid = omp_get_thread_num();
+        const int tid = common::ThreadIdx();
         thread_temp[tid].resize(tree.param.num_nodes, TStats());
         for (unsigned int nid : qexpand_) {
           thread_temp[tid][nid] = TStats();
@@ -355,7 +355,7 @@ class BaseMaker: public TreeUpdater {
     const auto ndata = static_cast<bst_omp_uint>(fmat.Info().num_row_);
     common::ParallelFor(ndata, [&](bst_omp_uint ridx) {
       const int nid = position_[ridx];
-      const int tid = omp_get_thread_num();
+      const int tid = common::ThreadIdx();
       if (nid >= 0) {
         thread_temp[tid][nid].Add(gpair[ridx]);
       }
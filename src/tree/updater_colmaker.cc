@@ -16,7 +16,10 @@
 #include "xgboost/json.h"
 #include "param.h"
 #include "constraints.h"
+#include "exact_columns.h"
+#include "../common/arena.h"
 #include "../common/random.h"
+#include "../common/threading_utils.h"
 #include "split_evaluator.h"
 
 namespace xgboost {
@@ -108,15 +111,19 @@ class ColMaker: public TreeUpdater {
                     "support external memory training.";
     }
     this->LazyGetColumnDensity(dmat);
+    if (!columns_.Matches(dmat->Info())) {
+      columns_.Init(dmat, tparam_->Threads());
+    }
     // rescale learning rate according to size of trees
     float lr = param_.learning_rate;
     param_.learning_rate = lr / trees.size();
-    interaction_constraints_.Configure(param_, dmat->Info().num_row_);
+    interaction_constraints_.Configure(param_, dmat->Info().num_col_);
     // build tree
     for (auto tree : trees) {
       CHECK(tparam_);
+      arena_.Reset();
       Builder builder(param_, colmaker_param_, interaction_constraints_, tparam_,
-                      column_densities_);
+                      column_densities_, columns_, &arena_);
       builder.Update(gpair->ConstHostVector(), dmat, tree);
     }
     param_.learning_rate = lr;
@@ -128,6 +135,10 @@ class ColMaker: public TreeUpdater {
   ColMakerTrainParam colmaker_param_;
   // SplitEvaluator that will be cloned for each Builder
   std::vector<float> column_densities_;
+  // Temporary buffers of builders, reused across trees.
+  common::Arena arena_;
+  // Sorted columns of the training data, reused across trees.
+  ExactColumns columns_;
 
   FeatureInteractionConstraintHost interaction_constraints_;
   // data structure
@@ -137,6 +148,8 @@ class ColMaker: public TreeUpdater {
     GradStats stats;
     /*! \brief last feature value scanned */
     bst_float last_fvalue { 0 };
+    /*! \brief rank of last feature value scanned in current column */
+    uint32_t last_rank { ExactColumns::kInvalidRank };
     /*! \brief current best solution */
     SplitEntry best;
     // constructor
@@ -160,10 +173,17 @@ class ColMaker: public TreeUpdater {
     // constructor
     explicit Builder(const TrainParam &param, const ColMakerTrainParam &colmaker_train_param,
                      FeatureInteractionConstraintHost _interaction_constraints,
-                     GenericParameter const *ctx, const std::vector<float> &column_densities)
+                     GenericParameter const *ctx, const std::vector<float> &column_densities,
+                     ExactColumns const &columns, common::Arena *arena)
         : param_(param),
           colmaker_train_param_{colmaker_train_param},
           ctx_{ctx},
+          columns_{columns},
+          arena_{arena},
+          position_{common::ArenaAllocator<int>{arena}},
+          stemp_{common::ArenaAllocator<common::ArenaVector<ThreadEntry>>{arena}},
+          snode_{common::ArenaAllocator<NodeEntry>{arena}},
+          qexpand_{common::ArenaAllocator<int>{arena}},
           tree_evaluator_(param_, column_densities.size(), GenericParameter::kCpuId),
           interaction_constraints_{std::move(_interaction_constraints)},
           column_densities_(column_densities) {}
@@ -171,7 +191,7 @@ class ColMaker: public TreeUpdater {
     virtual void Update(const std::vector<GradientPair>& gpair,
                         DMatrix* p_fmat,
                         RegTree* p_tree) {
-      std::vector<int> newnodes;
+      common::ArenaVector<int> newnodes{common::ArenaAllocator<int>{arena_}};
       this->InitData(gpair, *p_fmat);
       this->InitNewNode(qexpand_, gpair, *p_fmat, *p_tree);
       for (int depth = 0; depth < param_.max_depth; ++depth) {
@@ -241,7 +261,8 @@ class ColMaker: public TreeUpdater {
         // setup temp space for each thread
         // reserve a small space
         stemp_.clear();
-        stemp_.resize(this->ctx_->Threads(), std::vector<ThreadEntry>());
+        common::ArenaVector<ThreadEntry> empty{common::ArenaAllocator<ThreadEntry>{arena_}};
+        stemp_.resize(this->ctx_->Threads(), empty);
         for (auto& i : stemp_) {
           i.clear(); i.reserve(256);
         }
@@ -257,7 +278,7 @@ class ColMaker: public TreeUpdater {
      * \brief initialize the base_weight, root_gain,
      *  and NodeEntry for all the new nodes in qexpand
      */
-    inline void InitNewNode(const std::vector<int>& qexpand,
+    inline void InitNewNode(const common::ArenaVector<int>& qexpand,
                             const std::vector<GradientPair>& gpair,
                             const DMatrix& fmat,
                             const RegTree& tree) {
@@ -275,7 +296,7 @@ class ColMaker: public TreeUpdater {
       #pragma omp parallel for schedule(static)
       for (bst_omp_uint ridx = 0; ridx < ndata; ++ridx) {
         exc.Run([&]() {
-          const int tid = omp_get_thread_num();
+          const int tid = common::ThreadIdx();
           if (position_[ridx] < 0) return;
           stemp_[tid][position_[ridx]].stats.Add(gpair[ridx]);
         });
@@ -303,8 +324,8 @@ class ColMaker: public TreeUpdater {
     }
     /*! \brief update queue expand add in new leaves */
     inline void UpdateQueueExpand(const RegTree& tree,
-                                  const std::vector<int> &qexpand,
-                                  std::vector<int>* p_newnodes) {
+                                  const common::ArenaVector<int> &qexpand,
+                                  common::ArenaVector<int>* p_newnodes) {
       p_newnodes->clear();
       for (int nid : qexpand) {
         if (!tree[ nid ].IsLeaf()) {
@@ -316,21 +337,24 @@ class ColMaker: public TreeUpdater {
 
     // update enumeration solution
     inline void UpdateEnumeration(
-        int nid, GradientPair gstats, bst_float fvalue, int d_step,
-        bst_uint fid, GradStats &c, std::vector<ThreadEntry> &temp, // NOLINT(*)
+        int nid, GradientPair gstats, uint32_t rank, common::Span<float const> values,
+        int d_step, bst_uint fid, GradStats &c,
+        common::ArenaVector<ThreadEntry> &temp, // NOLINT(*)
         TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator) const {
       // get the statistics of nid
       ThreadEntry &e = temp[nid];
       // test if first hit, this is fine, because we set 0 during init
       if (e.stats.Empty()) {
         e.stats.Add(gstats);
-        e.last_fvalue = fvalue;
+        e.last_rank = rank;
       } else {
         // try to find a split
-        if (fvalue != e.last_fvalue &&
+        if (rank != e.last_rank &&
             e.stats.sum_hess >= param_.min_child_weight) {
           c.SetSubstract(snode_[nid].stats, e.stats);
           if (c.sum_hess >= param_.min_child_weight) {
+            bst_float const fvalue = values[rank];
+            e.last_fvalue = values[e.last_rank];
             bst_float loss_chg {0};
             if (d_step == -1) {
               loss_chg = static_cast<bst_float>(
@@ -361,68 +385,66 @@ class ColMaker: public TreeUpdater {
         }
         // update the statistics
         e.stats.Add(gstats);
-        e.last_fvalue = fvalue;
+        e.last_rank = rank;
       }
     }
     // same as EnumerateSplit, with cacheline prefetch optimization
     void EnumerateSplit(
-        const Entry *begin, const Entry *end, int d_step, bst_uint fid,
+        ExactColumns::Column const &col, int d_step, bst_uint fid,
         const std::vector<GradientPair> &gpair,
-        std::vector<ThreadEntry> &temp, // NOLINT(*)
+        common::ArenaVector<ThreadEntry> &temp, // NOLINT(*)
         TreeEvaluator::SplitEvaluator<TrainParam> const &evaluator) const {
       CHECK(param_.cache_opt) << "Support for `cache_opt' is removed in 1.0.0";
-      const std::vector<int> &qexpand = qexpand_;
+      const common::ArenaVector<int> &qexpand = qexpand_;
       // clear all the temp statistics
       for (auto nid : qexpand) {
         temp[nid].stats = GradStats();
+        temp[nid].last_rank = ExactColumns::kInvalidRank;
       }
       // left statistics
       GradStats c;
-      // local cache buffer for position and gradient pair
-      constexpr int kBuffer = 32;
+      // local cache buffer for position, gradient pair and rank of value
+      constexpr size_t kBuffer = 32;
       int buf_position[kBuffer] = {};
       GradientPair buf_gpair[kBuffer] = {};
-      // aligned ending position
-      const Entry *align_end;
-      if (d_step > 0) {
-        align_end = begin + (end - begin) / kBuffer * kBuffer;
-      } else {
-        align_end = begin - (begin - end) / kBuffer * kBuffer;
-      }
-      int i;
-      const Entry *it;
-      const int align_step = d_step * kBuffer;
-      // internal cached loop
-      for (it = begin; it != align_end; it += align_step) {
-        const Entry *p;
-        for (i = 0, p = it; i < kBuffer; ++i, p += d_step) {
-          buf_position[i] = position_[p->index];
-          buf_gpair[i] = gpair[p->index];
+      uint32_t buf_rank[kBuffer] = {};
+      auto const entries = col.entries;
+      auto const values = col.values;
+      size_t const n = entries.size();
+      // The first entry of each value is marked, counting marks gives the rank.  Wraps
+      // around before the first entry in forward search and after the last entry in
+      // backward search.
+      uint32_t rank = d_step > 0 ? ExactColumns::kInvalidRank
+                                 : static_cast<uint32_t>(values.size() - 1);
+      for (size_t begin = 0; begin < n; begin += kBuffer) {
+        size_t const size = std::min(kBuffer, n - begin);
+        for (size_t i = 0; i < size; ++i) {
+          uint32_t const entry = entries[d_step > 0 ? begin + i : n - 1 - (begin + i)];
+          uint32_t const mark = entry >> 31;
+          uint32_t const ridx = entry & ExactColumns::kRowMask;
+          if (d_step > 0) {
+            rank += mark;
+            buf_rank[i] = rank;
+          } else {
+            buf_rank[i] = rank;
+            rank -= mark;
+          }
+          buf_position[i] = position_[ridx];
+          buf_gpair[i] = gpair[ridx];
         }
-        for (i = 0, p = it; i < kBuffer; ++i, p += d_step) {
+        for (size_t i = 0; i < size; ++i) {
           const int nid = buf_position[i];
           if (nid < 0 || !interaction_constraints_.Query(nid, fid)) { continue; }
-          this->UpdateEnumeration(nid, buf_gpair[i],
-                                  p->fvalue, d_step,
-                                  fid, c, temp, evaluator);
+          this->UpdateEnumeration(nid, buf_gpair[i], buf_rank[i], values, d_step, fid, c, temp,
+                                  evaluator);
         }
       }
-
-      // finish up the ending piece
-      for (it = align_end, i = 0; it != end; ++i, it += d_step) {
-        buf_position[i] = position_[it->index];
-        buf_gpair[i] = gpair[it->index];
-      }
-      for (it = align_end, i = 0; it != end; ++i, it += d_step) {
-        const int nid = buf_position[i];
-        if (nid < 0 || !interaction_constraints_.Query(nid, fid)) { continue; }
-        this->UpdateEnumeration(nid, buf_gpair[i],
-                                it->fvalue, d_step,
-                                fid, c, temp, evaluator);
-      }
       // finish updating all statistics, check if it is possible to include all sum statistics
       for (int nid : qexpand) {
         ThreadEntry &e = temp[nid];
+        if (e.last_rank != ExactColumns::kInvalidRank) {
+          e.last_fvalue = values[e.last_rank];
+        }
         c.SetSubstract(snode_[nid].stats, e.stats);
         if (e.stats.sum_hess >= param_.min_child_weight &&
             c.sum_hess >= param_.min_child_weight) {
@@ -447,8 +469,7 @@ class ColMaker: public TreeUpdater {
     }
 
     // update the solution candidate
-    virtual void UpdateSolution(const SortedCSCPage &batch,
-                                const std::vector<bst_feature_t> &feat_set,
+    virtual void UpdateSolution(const std::vector<bst_feature_t> &feat_set,
                                 const std::vector<GradientPair> &gpair,
                                 DMatrix*) {
       // start enumeration
@@ -459,24 +480,20 @@ class ColMaker: public TreeUpdater {
           std::max(static_cast<int>(num_features / this->ctx_->Threads() / 32), 1);
 #endif  // defined(_OPENMP)
       {
-        auto page = batch.GetView();
         dmlc::OMPException exc;
 #pragma omp parallel for schedule(dynamic, batch_size)
         for (bst_omp_uint i = 0; i < num_features; ++i) {
           exc.Run([&]() {
             auto evaluator = tree_evaluator_.GetEvaluator();
             bst_feature_t const fid = feat_set[i];
-            int32_t const tid = omp_get_thread_num();
-            auto c = page[fid];
-            const bool ind =
-                c.size() != 0 && c[0].fvalue == c[c.size() - 1].fvalue;
+            int32_t const tid = common::ThreadIdx();
+            auto c = columns_[fid];
+            const bool ind = c.values.size() == 1;
             if (colmaker_train_param_.NeedForwardSearch(column_densities_[fid], ind)) {
-              this->EnumerateSplit(c.data(), c.data() + c.size(), +1, fid, gpair, stemp_[tid],
-                                   evaluator);
+              this->EnumerateSplit(c, +1, fid, gpair, stemp_[tid], evaluator);
             }
             if (colmaker_train_param_.NeedBackwardSearch()) {
-              this->EnumerateSplit(c.data() + c.size() - 1, c.data() - 1, -1, fid, gpair,
-                                   stemp_[tid], evaluator);
+              this->EnumerateSplit(c, -1, fid, gpair, stemp_[tid], evaluator);
             }
           });
         }
@@ -485,16 +502,14 @@ class ColMaker: public TreeUpdater {
     }
     // find splits at current level, do split per level
     inline void FindSplit(int depth,
-                          const std::vector<int> &qexpand,
+                          const common::ArenaVector<int> &qexpand,
                           const std::vector<GradientPair> &gpair,
                           DMatrix *p_fmat,
                           RegTree *p_tree) {
       auto evaluator = tree_evaluator_.GetEvaluator();
 
       auto feat_set = column_sampler_.GetFeatureSet(depth);
-      for (const auto &batch : p_fmat->GetBatches<SortedCSCPage>()) {
-        this->UpdateSolution(batch, feat_set->HostVector(), gpair, p_fmat);
-      }
+      this->UpdateSolution(feat_set->HostVector(), gpair, p_fmat);
       // after this each thread's stemp will get the best candidates, aggregate results
       this->SyncBestSolution(qexpand);
       // get the best result, we can synchronize the solution
@@ -520,7 +535,7 @@ class ColMaker: public TreeUpdater {
       }
     }
     // reset position of each data points after split is created in the tree
-    inline void ResetPosition(const std::vector<int> &qexpand,
+    inline void ResetPosition(const common::ArenaVector<int> &qexpand,
                               DMatrix* p_fmat,
                               const RegTree& tree) {
       // set the positions in the nondefault
@@ -552,7 +567,7 @@ class ColMaker: public TreeUpdater {
     }
     // customization part
     // synchronize the best solution of each node
-    virtual void SyncBestSolution(const std::vector<int> &qexpand) {
+    virtual void SyncBestSolution(const common::ArenaVector<int> &qexpand) {
       for (int nid : qexpand) {
         NodeEntry &e = snode_[nid];
         CHECK(this->ctx_);
@@ -561,11 +576,11 @@ class ColMaker: public TreeUpdater {
         }
       }
     }
-    virtual void SetNonDefaultPosition(const std::vector<int> &qexpand,
+    virtual void SetNonDefaultPosition(const common::ArenaVector<int> &qexpand,
                                        DMatrix *p_fmat,
                                        const RegTree &tree) {
       // step 1, classify the non-default data into right places
-      std::vector<unsigned> fsplits;
+      common::ArenaVector<unsigned> fsplits{common::ArenaAllocator<unsigned>{arena_}};
       for (int nid : qexpand) {
         if (!tree[nid].IsLeaf()) {
           fsplits.push_back(tree[nid].SplitIndex());
@@ -614,14 +629,17 @@ class ColMaker: public TreeUpdater {
     // number of omp thread used during training
     GenericParameter const* ctx_;
     common::ColumnSampler column_sampler_;
+    ExactColumns const& columns_;
+    // memory of the buffers below, owned by the updater.
+    common::Arena* arena_;
     // Instance Data: current node position in the tree of each instance
-    std::vector<int> position_;
+    common::ArenaVector<int> position_;
     // PerThread x PerTreeNode: statistics for per thread construction
-    std::vector< std::vector<ThreadEntry> > stemp_;
+    common::ArenaVector<common::ArenaVector<ThreadEntry>> stemp_;
     /*! \brief TreeNode Data: statistics for each constructed node */
-    std::vector<NodeEntry> snode_;
+    common::ArenaVector<NodeEntry> snode_;
     /*! \brief queue of nodes to be expanded */
-    std::vector<int> qexpand_;
+    common::ArenaVector<int> qexpand_;
     TreeEvaluator tree_evaluator_;
 
     FeatureInteractionConstraintHost interaction_constraints_;
@@ -6,8 +6,10 @@
 #include <xgboost/tree_updater.h>
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <memory>
 #include <limits>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -22,6 +24,7 @@
 #include "../common/bitfield.h"
 #include "../common/timer.h"
 #include "../common/categorical.h"
+#include "../common/random.h"
 #include "../data/ellpack_page.cuh"
 
 #include "param.h"
@@ -47,12 +50,16 @@ struct GPUHistMakerTrainParam
     : public XGBoostParameter<GPUHistMakerTrainParam> {
   bool single_precision_histogram;
   bool debug_synchronize;
+  int32_t n_gpus;
   // declare parameters
   DMLC_DECLARE_PARAMETER(GPUHistMakerTrainParam) {
     DMLC_DECLARE_FIELD(single_precision_histogram).set_default(false).describe(
         "Use single precision to build histograms.");
     DMLC_DECLARE_FIELD(debug_synchronize).set_default(false).describe(
         "Check if all distributed tree are identical after tree construction.");
+    DMLC_DECLARE_FIELD(n_gpus).set_default(1).set_lower_bound(-1).describe(
+        "Number of GPUs used by each worker, starting from gpu_id.  -1 means all visible "
+        "GPUs.");
   }
 };
 #if !defined(GTEST_TEST)
@@ -108,6 +115,10 @@ class DeviceHistogram {
   dh::device_vector<typename GradientSumT::ValueT>& Data() {
     return data_;
   }
+  /*! \brief Number of histograms that can be held before memory is recycled. */
+  size_t Capacity() const {
+    return std::max(kStopGrowingSize, data_.size()) / HistogramSize();
+  }
 
   void AllocateHistogram(int nidx) {
     if (HistogramExists(nidx)) return;
@@ -161,6 +172,11 @@ template <typename GradientSumT>
 struct GPUHistMakerDevice {
   int device_id;
   EllpackPageImpl const* page;
+  // Number of training rows handled by this device.
+  bst_uint n_rows;
+  // Whether other devices in this process take part in the reduction.  When true, the
+  // sum of gradient is reduced by the device reducer as rabit is driven by a single thread.
+  bool reduce_on_device {false};
   common::Span<FeatureType const> feature_types;
   BatchParam batch_param;
 
@@ -202,6 +218,7 @@ struct GPUHistMakerDevice {
                      BatchParam _batch_param)
       : device_id(_device_id),
         page(_page),
+        n_rows(_n_rows),
         feature_types{_feature_types},
         param(std::move(_param)),
         tree_evaluator(param, n_features, _device_id),
@@ -232,6 +249,10 @@ struct GPUHistMakerDevice {
   // Note that the column sampler must be passed by value because it is not
   // thread safe
   void Reset(HostDeviceVector<GradientPair>* dh_gpair, DMatrix* dmat, int64_t num_columns) {
+    this->Reset(dh_gpair->ConstDeviceSpan(), dmat, num_columns);
+  }
+  // `in_gpair` contains gradient of rows handled by this device, can be on another device.
+  void Reset(common::Span<GradientPair const> in_gpair, DMatrix* dmat, int64_t num_columns) {
     auto const& info = dmat->Info();
     this->column_sampler.Init(num_columns, info.feature_weights.HostVector(),
                               param.colsample_bynode, param.colsample_bylevel,
@@ -242,12 +263,12 @@ struct GPUHistMakerDevice {
     std::fill(node_sum_gradients.begin(), node_sum_gradients.end(),
               GradientPair());
 
-    if (d_gpair.size() != dh_gpair->Size()) {
-      d_gpair.resize(dh_gpair->Size());
+    if (d_gpair.size() != in_gpair.size()) {
+      d_gpair.resize(in_gpair.size());
     }
     dh::safe_cuda(cudaMemcpyAsync(
-        d_gpair.data().get(), dh_gpair->ConstDevicePointer(),
-        dh_gpair->Size() * sizeof(GradientPair), cudaMemcpyDeviceToDevice));
+        d_gpair.data().get(), in_gpair.data(),
+        in_gpair.size_bytes(), cudaMemcpyDefault));
     auto sample = sampler->Sample(dh::ToSpan(d_gpair), dmat);
     page = sample.page;
     gpair = sample.gpair;
@@ -255,7 +276,12 @@ struct GPUHistMakerDevice {
     histogram_rounding = CreateRoundingFactor<GradientSumT>(this->gpair);
 
     row_partitioner.reset();  // Release the device memory first before reallocating
-    row_partitioner.reset(new RowPartitioner(device_id,  sample.sample_rows));
+    if (sample.row_index.empty()) {
+      row_partitioner.reset(new RowPartitioner(device_id, sample.sample_rows));
+    } else {
+      // Only visit the sampled rows of an uncompacted page.
+      row_partitioner.reset(new RowPartitioner(device_id, sample.row_index));
+    }
     hist.Reset();
   }
 
@@ -288,55 +314,82 @@ struct GPUHistMakerDevice {
     return result.front();
   }
 
-  void EvaluateLeftRightSplits(
-      GPUExpandEntry candidate, int left_nidx, int right_nidx, const RegTree& tree,
-      common::Span<GPUExpandEntry> pinned_candidates_out) {
-    dh::TemporaryArray<DeviceSplitCandidate> splits_out(2);
+  /**
+   * \brief Evaluate splits for children of all candidates expanded in one round with a
+   *        single kernel launch, the resulting entries are copied to host asynchronously.
+   *
+   * \param candidates            Expanded candidates.
+   * \param tree                  Tree with the candidates applied.
+   * \param pinned_candidates_out Entries of the left and right child of each candidate.
+   */
+  void EvaluateLeftRightSplits(std::vector<GPUExpandEntry> const& candidates,
+                               const RegTree& tree,
+                               common::Span<GPUExpandEntry> pinned_candidates_out) {
+    CHECK_EQ(pinned_candidates_out.size(), candidates.size() * 2);
+    if (candidates.empty()) {
+      return;
+    }
     GPUTrainingParam gpu_param(param);
-    auto left_sampled_features =
-        column_sampler.GetFeatureSet(tree.GetDepth(left_nidx));
-    left_sampled_features->SetDevice(device_id);
-    common::Span<bst_feature_t> left_feature_set =
-        interaction_constraints.Query(left_sampled_features->DeviceSpan(),
-                                      left_nidx);
-    auto right_sampled_features =
-        column_sampler.GetFeatureSet(tree.GetDepth(right_nidx));
-    right_sampled_features->SetDevice(device_id);
-    common::Span<bst_feature_t> right_feature_set =
-        interaction_constraints.Query(right_sampled_features->DeviceSpan(),
-                                      left_nidx);
     auto matrix = page->GetDeviceAccessor(device_id);
+    std::vector<EvaluateSplitInputs<GradientSumT>> inputs;
+    std::vector<int> h_nidx;
+    std::vector<int> h_depth;
+    // Feature sets must stay alive until the evaluation is done.
+    std::vector<std::shared_ptr<HostDeviceVector<bst_feature_t>>> sampled(candidates.size() * 2);
+    // Results of interaction constraints share a buffer, make a copy for each node.
+    std::vector<dh::caching_device_vector<bst_feature_t>> constrained(candidates.size() * 2);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      auto const& candidate = candidates[i];
+      for (int k = 0; k < 2; ++k) {
+        bool is_left = k == 0;
+        int left_nidx = tree[candidate.nid].LeftChild();
+        int nidx = is_left ? left_nidx : tree[candidate.nid].RightChild();
+        auto& sampled_features = sampled[i * 2 + k];
+        sampled_features = column_sampler.GetFeatureSet(tree.GetDepth(nidx));
+        sampled_features->SetDevice(device_id);
+        common::Span<bst_feature_t> feature_set =
+            interaction_constraints.Query(sampled_features->DeviceSpan(), left_nidx);
+        if (feature_set.data() != sampled_features->DeviceSpan().data()) {
+          auto& copy = constrained[i * 2 + k];
+          copy.resize(feature_set.size());
+          dh::safe_cuda(cudaMemcpyAsync(copy.data().get(), feature_set.data(),
+                                        feature_set.size_bytes(), cudaMemcpyDeviceToDevice));
+          feature_set = dh::ToSpan(copy);
+        }
+        auto sum = is_left ? candidate.split.left_sum : candidate.split.right_sum;
+        inputs.emplace_back(EvaluateSplitInputs<GradientSumT>{
+            nidx,
+            {sum.GetGrad(), sum.GetHess()},
+            gpu_param,
+            feature_set,
+            feature_types,
+            matrix.feature_segments,
+            matrix.gidx_fvalue_map,
+            matrix.min_fvalue,
+            hist.GetNodeHistogram(nidx)});
+        h_nidx.push_back(nidx);
+        h_depth.push_back(candidate.depth + 1);
+      }
+    }
 
-    EvaluateSplitInputs<GradientSumT> left{
-      left_nidx,
-      {candidate.split.left_sum.GetGrad(),
-            candidate.split.left_sum.GetHess()},
-          gpu_param,
-          left_feature_set,
-          feature_types,
-          matrix.feature_segments,
-          matrix.gidx_fvalue_map,
-          matrix.min_fvalue,
-          hist.GetNodeHistogram(left_nidx)};
-    EvaluateSplitInputs<GradientSumT> right{
-        right_nidx,
-        {candidate.split.right_sum.GetGrad(),
-         candidate.split.right_sum.GetHess()},
-        gpu_param,
-        right_feature_set,
-        feature_types,
-        matrix.feature_segments,
-        matrix.gidx_fvalue_map,
-        matrix.min_fvalue,
-        hist.GetNodeHistogram(right_nidx)};
+    dh::TemporaryArray<DeviceSplitCandidate> splits_out(inputs.size());
     auto d_splits_out = dh::ToSpan(splits_out);
-    EvaluateSplits(d_splits_out, tree_evaluator.GetEvaluator<GPUTrainingParam>(), left, right);
-    dh::TemporaryArray<GPUExpandEntry> entries(2);
     auto evaluator = tree_evaluator.GetEvaluator<GPUTrainingParam>();
+    EvaluateSplits(d_splits_out, evaluator, inputs);
+
+    dh::TemporaryArray<int> nidx_storage(h_nidx.size());
+    dh::TemporaryArray<int> depth_storage(h_depth.size());
+    dh::safe_cuda(cudaMemcpyAsync(nidx_storage.data().get(), h_nidx.data(),
+                                  h_nidx.size() * sizeof(int), cudaMemcpyHostToDevice));
+    dh::safe_cuda(cudaMemcpyAsync(depth_storage.data().get(), h_depth.data(),
+                                  h_depth.size() * sizeof(int), cudaMemcpyHostToDevice));
+    auto d_nidx = dh::ToSpan(nidx_storage);
+    auto d_depth = dh::ToSpan(depth_storage);
+    dh::TemporaryArray<GPUExpandEntry> entries(inputs.size());
     auto d_entries = entries.data().get();
-    dh::LaunchN(2, [=] __device__(size_t idx) {
+    dh::LaunchN(inputs.size(), [=] __device__(size_t idx) {
       auto split = d_splits_out[idx];
-      auto nidx = idx == 0 ? left_nidx : right_nidx;
+      auto nidx = d_nidx[idx];
 
       float base_weight = evaluator.CalcWeight(
           nidx, gpu_param, GradStats{split.left_sum + split.right_sum});
@@ -346,8 +399,8 @@ struct GPUHistMakerDevice {
           nidx, gpu_param, GradStats{split.right_sum});
 
       d_entries[idx] =
-          GPUExpandEntry{nidx,        candidate.depth + 1, d_splits_out[idx],
-                      base_weight, left_weight,         right_weight};
+          GPUExpandEntry{nidx,        d_depth[idx], split,
+                         base_weight, left_weight,  right_weight};
     });
     dh::safe_cuda(cudaMemcpyAsync(
         pinned_candidates_out.data(), entries.data().get(),
@@ -363,6 +416,34 @@ struct GPUHistMakerDevice {
                            d_ridx, d_node_hist, histogram_rounding);
   }
 
+  /**
+   * \brief Build histograms for a list of nodes with a single kernel launch.
+   *        Histograms must be allocated beforehand.
+   */
+  void BuildHist(std::vector<int> const& nidx) {
+    if (nidx.empty()) {
+      return;
+    }
+    if (nidx.size() == 1) {
+      this->BuildHist(nidx.front());
+      return;
+    }
+    std::vector<HistogramSegment<GradientSumT>> h_segments(nidx.size());
+    for (size_t i = 0; i < nidx.size(); ++i) {
+      h_segments[i].ridx = row_partitioner->GetRows(nidx[i]);
+      h_segments[i].histogram = hist.GetNodeHistogram(nidx[i]).data();
+    }
+    dh::TemporaryArray<HistogramSegment<GradientSumT>> segments(h_segments.size());
+    dh::safe_cuda(cudaMemcpyAsync(segments.data().get(), h_segments.data(),
+                                  sizeof(HistogramSegment<GradientSumT>) * h_segments.size(),
+                                  cudaMemcpyHostToDevice));
+    BuildGradientHistogram(page->GetDeviceAccessor(device_id),
+                           feature_groups->DeviceAccessor(device_id), gpair,
+                           common::Span<HistogramSegment<GradientSumT> const>{
+                               segments.data().get(), segments.size()},
+                           histogram_rounding);
+  }
+
   void SubtractionTrick(int nidx_parent, int nidx_histogram,
                         int nidx_subtraction) {
     auto d_node_hist_parent = hist.GetNodeHistogram(nidx_parent);
@@ -375,21 +456,15 @@ struct GPUHistMakerDevice {
     });
   }
 
-  bool CanDoSubtractionTrick(int nidx_parent, int nidx_histogram,
-                             int nidx_subtraction) {
-    // Make sure histograms are already allocated
-    hist.AllocateHistogram(nidx_subtraction);
-    return hist.HistogramExists(nidx_histogram) &&
-           hist.HistogramExists(nidx_parent);
-  }
-
+  // Partition rows of nidx without waiting for the result, `RowPartitioner::SynchronizePositions`
+  // must be called before accessing rows of the children.
   void UpdatePosition(int nidx, RegTree* p_tree) {
     RegTree::Node split_node = (*p_tree)[nidx];
     auto split_type = p_tree->NodeSplitType(nidx);
     auto d_matrix = page->GetDeviceAccessor(device_id);
     auto node_cats = dh::ToSpan(node_categories);
 
-    row_partitioner->UpdatePosition(
+    row_partitioner->UpdatePositionAsync(
         nidx, split_node.LeftChild(), split_node.RightChild(),
         [=] __device__(bst_uint ridx) {
           // given a row index, returns the node id it belongs to
@@ -438,11 +513,11 @@ struct GPUHistMakerDevice {
       dh::CopyToD(categories_segments, &d_categories_segments);
     }
 
-    if (row_partitioner->GetRows().size() != p_fmat->Info().num_row_) {
+    if (row_partitioner->GetRows().size() != n_rows) {
       row_partitioner.reset();  // Release the device memory first before reallocating
-      row_partitioner.reset(new RowPartitioner(device_id, p_fmat->Info().num_row_));
+      row_partitioner.reset(new RowPartitioner(device_id, n_rows));
     }
-    if (page->n_rows == p_fmat->Info().num_row_) {
+    if (page->n_rows == n_rows) {
       FinalisePositionInPage(page, dh::ToSpan(d_nodes),
                              dh::ToSpan(d_split_types), dh::ToSpan(d_categories),
                              dh::ToSpan(d_categories_segments));
@@ -535,35 +610,56 @@ struct GPUHistMakerDevice {
   }
 
   /**
-   * \brief Build GPU local histograms for the left and right child of some parent node
+   * \brief Build histograms for children of all candidates expanded in one round.  Nodes
+   *        are batched into as few kernel launches as possible, which matters when there
+   *        are many small nodes, e.g. deep trees grown by lossguide.
    */
-  void BuildHistLeftRight(const GPUExpandEntry &candidate, int nidx_left,
-        int nidx_right, dh::AllReducer* reducer) {
-    auto build_hist_nidx = nidx_left;
-    auto subtraction_trick_nidx = nidx_right;
-
-    // Decide whether to build the left histogram or right histogram
-    // Use sum of Hessian as a heuristic to select node with fewest training instances
-    bool fewer_right = candidate.split.right_sum.GetHess() < candidate.split.left_sum.GetHess();
-    if (fewer_right) {
-      std::swap(build_hist_nidx, subtraction_trick_nidx);
-    }
-
-    this->BuildHist(build_hist_nidx);
-    this->AllReduceHist(build_hist_nidx, reducer);
-
-    // Check whether we can use the subtraction trick to calculate the other
-    bool do_subtraction_trick = this->CanDoSubtractionTrick(
-        candidate.nid, build_hist_nidx, subtraction_trick_nidx);
+  void BuildHistLeftRight(std::vector<GPUExpandEntry> const& candidates,
+                          RegTree const& tree, dh::AllReducer* reducer) {
+    // Keep the batch well within the histogram cache, otherwise allocating a histogram
+    // could recycle the memory of another node in the same batch.
+    size_t const max_batch = std::max(hist.Capacity() / 4, static_cast<size_t>(1));
+    for (size_t begin = 0; begin < candidates.size(); begin += max_batch) {
+      size_t end = std::min(begin + max_batch, candidates.size());
+      std::vector<int> build_nidx;
+      std::vector<int> subtraction_nidx;
+      for (size_t i = begin; i < end; ++i) {
+        auto const& candidate = candidates[i];
+        int build = tree[candidate.nid].LeftChild();
+        int subtraction = tree[candidate.nid].RightChild();
+        // Use sum of Hessian as a heuristic to select node with fewest training instances
+        if (candidate.split.right_sum.GetHess() < candidate.split.left_sum.GetHess()) {
+          std::swap(build, subtraction);
+        }
+        build_nidx.push_back(build);
+        subtraction_nidx.push_back(subtraction);
+      }
+      // Allocate before taking any pointer, allocation can resize the storage.
+      for (auto nidx : build_nidx) {
+        hist.AllocateHistogram(nidx);
+      }
+      for (auto nidx : subtraction_nidx) {
+        hist.AllocateHistogram(nidx);
+      }
+      this->BuildHist(build_nidx);
+      for (auto nidx : build_nidx) {
+        this->AllReduceHist(nidx, reducer);
+      }
 
-    if (do_subtraction_trick) {
-      // Calculate other histogram using subtraction trick
-      this->SubtractionTrick(candidate.nid, build_hist_nidx,
-                             subtraction_trick_nidx);
-    } else {
-      // Calculate other histogram manually
-      this->BuildHist(subtraction_trick_nidx);
-      this->AllReduceHist(subtraction_trick_nidx, reducer);
+      std::vector<int> remaining;
+      for (size_t i = begin; i < end; ++i) {
+        auto k = i - begin;
+        if (hist.HistogramExists(candidates[i].nid) && hist.HistogramExists(build_nidx[k])) {
+          this->SubtractionTrick(candidates[i].nid, build_nidx[k], subtraction_nidx[k]);
+        } else {
+          remaining.push_back(subtraction_nidx[k]);
+        }
+      }
+      // Parent histogram has been recycled, build the other child manually
+      this->BuildHist(remaining);
+      for (auto nidx : remaining) {
+        this->AllReduceHist(nidx, reducer);
+      }
     }
   }
 
@@ -628,8 +724,16 @@ struct GPUHistMakerDevice {
         thrust::device_ptr<GradientPair const>(gpair.data()),
         thrust::device_ptr<GradientPair const>(gpair.data() + gpair.size()),
         GradientPair{}, thrust::plus<GradientPair>{});
-    rabit::Allreduce<rabit::op::Sum, float>(reinterpret_cast<float*>(&root_sum),
-                                            2);
+    if (reduce_on_device) {
+      dh::TemporaryArray<GradientPair> d_root_sum(1, root_sum);
+      auto ptr = reinterpret_cast<float*>(d_root_sum.data().get());
+      reducer->AllReduceSum(ptr, ptr, 2);
+      reducer->Synchronize();
+      dh::safe_cuda(cudaMemcpy(&root_sum, d_root_sum.data().get(), sizeof(GradientPair),
+                               cudaMemcpyDeviceToHost));
+    } else {
+      rabit::Allreduce<rabit::op::Sum, float>(reinterpret_cast<float*>(&root_sum), 2);
+    }
 
     this->BuildHist(kRootNIdx);
     this->AllReduceHist(kRootNIdx, reducer);
@@ -666,6 +770,10 @@ struct GPUHistMakerDevice {
 
   void UpdateTree(HostDeviceVector<GradientPair>* gpair_all, DMatrix* p_fmat,
                   RegTree* p_tree, dh::AllReducer* reducer) {
+    this->UpdateTree(gpair_all->ConstDeviceSpan(), p_fmat, p_tree, reducer);
+  }
+  void UpdateTree(common::Span<GradientPair const> gpair_all, DMatrix* p_fmat,
+                  RegTree* p_tree, dh::AllReducer* reducer) {
     auto& tree = *p_tree;
     Driver<GPUExpandEntry> driver(static_cast<TrainParam::TreeGrowPolicy>(param.grow_policy));
 
@@ -682,9 +790,8 @@ struct GPUHistMakerDevice {
     // The set of leaves that can be expanded asynchronously
     auto expand_set = driver.Pop();
     while (!expand_set.empty()) {
-      auto new_candidates =
-          pinned.GetSpan<GPUExpandEntry>(expand_set.size() * 2, GPUExpandEntry());
-
+      // Candidates whose children are expanded.
+      std::vector<GPUExpandEntry> expanded;
       for (auto i = 0ull; i < expand_set.size(); i++) {
         auto candidate = expand_set.at(i);
         if (!candidate.IsValid(param, num_leaves)) {
@@ -695,29 +802,29 @@ struct GPUHistMakerDevice {
         num_leaves++;
 
         int left_child_nidx = tree[candidate.nid].LeftChild();
-        int right_child_nidx = tree[candidate.nid].RightChild();
         // Only create child entries if needed
         if (GPUExpandEntry::ChildIsValid(param, tree.GetDepth(left_child_nidx),
                                          num_leaves)) {
           monitor.Start("UpdatePosition");
           this->UpdatePosition(candidate.nid, p_tree);
           monitor.Stop("UpdatePosition");
-
-          monitor.Start("BuildHist");
-          this->BuildHistLeftRight(candidate, left_child_nidx, right_child_nidx, reducer);
-          monitor.Stop("BuildHist");
-
-          monitor.Start("EvaluateSplits");
-          this->EvaluateLeftRightSplits(candidate, left_child_nidx,
-                                        right_child_nidx, *p_tree,
-                                        new_candidates.subspan(i * 2, 2));
-          monitor.Stop("EvaluateSplits");
-        } else {
-          // Set default
-          new_candidates[i * 2] = GPUExpandEntry();
-          new_candidates[i * 2 + 1] = GPUExpandEntry();
+          expanded.push_back(candidate);
         }
       }
+
+      // One host round trip for partitions of the whole round.
+      monitor.Start("UpdatePosition");
+      row_partitioner->SynchronizePositions();
+      monitor.Stop("UpdatePosition");
+
+      monitor.Start("BuildHist");
+      this->BuildHistLeftRight(expanded, *p_tree, reducer);
+      monitor.Stop("BuildHist");
+
+      monitor.Start("EvaluateSplits");
+      auto new_candidates = pinned.GetSpan<GPUExpandEntry>(expanded.size() * 2);
+      this->EvaluateLeftRightSplits(expanded, *p_tree, new_candidates);
+      monitor.Stop("EvaluateSplits");
       dh::safe_cuda(cudaDeviceSynchronize());
       driver.Push(new_candidates.begin(), new_candidates.end());
       expand_set = driver.Pop();
@@ -788,19 +895,73 @@ class GPUHistMakerSpecialised {
     auto page = (*dmat->GetBatches<EllpackPage>(batch_param).begin()).Impl();
     dh::safe_cuda(cudaSetDevice(device_));
     info_->feature_types.SetDevice(device_);
-    maker.reset(new GPUHistMakerDevice<GradientSumT>(device_,
-                                                     page,
-                                                     info_->feature_types.ConstDeviceSpan(),
-                                                     info_->num_row_,
-                                                     param_,
-                                                     column_sampling_seed,
-                                                     info_->num_col_,
-                                                     batch_param));
+    auto devices = this->LocalDevices();
+    if (devices.size() > 1) {
+      this->InitShards(devices, page, column_sampling_seed, batch_param);
+    } else {
+      maker.reset(new GPUHistMakerDevice<GradientSumT>(device_,
+                                                       page,
+                                                       info_->feature_types.ConstDeviceSpan(),
+                                                       info_->num_row_,
+                                                       param_,
+                                                       column_sampling_seed,
+                                                       info_->num_col_,
+                                                       batch_param));
+    }
 
     p_last_fmat_ = dmat;
     initialised_ = true;
   }
 
+  std::vector<int> LocalDevices() const {
+    int32_t n_visible = common::AllVisibleGPUs();
+    int32_t n_gpus = hist_maker_param_.n_gpus == -1 ? n_visible : hist_maker_param_.n_gpus;
+    CHECK_LE(n_gpus, n_visible) << "Only " << n_visible << " GPUs are visible.";
+    std::vector<int> devices(n_gpus);
+    for (int32_t i = 0; i < n_gpus; ++i) {
+      devices[i] = (device_ + i) % n_visible;
+    }
+    return devices;
+  }
+
+  /**
+   * \brief Split rows of the ELLPACK page into contiguous blocks, one for each device.
+   *        Every device grows the same tree from histograms reduced across devices.
+   */
+  void InitShards(std::vector<int> const& devices, EllpackPageImpl const* page,
+                  uint32_t column_sampling_seed, BatchParam const& batch_param) {
+    CHECK_EQ(page->n_rows, info_->num_row_)
+        << "Training with multiple GPUs in one process is not supported for external "
+           "memory.";
+    dh::AllReducer::InitLocal(devices, &shard_reducers_);
+    size_t n_shards = devices.size();
+    shard_ptr_.resize(n_shards + 1);
+    for (size_t k = 0; k <= n_shards; ++k) {
+      shard_ptr_[k] = page->n_rows * k / n_shards;
+    }
+    for (size_t k = 0; k < n_shards; ++k) {
+      size_t n_rows = shard_ptr_[k + 1] - shard_ptr_[k];
+      // Rows are copied on the main device then moved.
+      dh::safe_cuda(cudaSetDevice(device_));
+      shard_pages_.emplace_back(
+          new EllpackPageImpl(device_, page->Cuts(), page->is_dense, page->row_stride, n_rows));
+      shard_pages_.back()->CopyRows(device_, page, shard_ptr_[k]);
+      shard_pages_.back()->gidx_buffer.SetDevice(devices[k]);
+
+      dh::safe_cuda(cudaSetDevice(devices[k]));
+      shard_feature_types_.emplace_back(new HostDeviceVector<FeatureType>);
+      shard_feature_types_.back()->Copy(info_->feature_types);
+      shard_feature_types_.back()->SetDevice(devices[k]);
+      BatchParam shard_param{batch_param};
+      shard_param.gpu_id = devices[k];
+      shards_.emplace_back(new GPUHistMakerDevice<GradientSumT>(
+          devices[k], shard_pages_.back().get(), shard_feature_types_.back()->ConstDeviceSpan(),
+          n_rows, param_, column_sampling_seed, info_->num_col_, shard_param));
+      shards_.back()->reduce_on_device = true;
+    }
+    dh::safe_cuda(cudaSetDevice(device_));
+  }
+
   void InitData(DMatrix* dmat) {
     if (!initialised_) {
       monitor_.Start("InitDataOnce");
@@ -831,20 +992,93 @@ class GPUHistMakerSpecialised {
     monitor_.Stop("InitData");
 
     gpair->SetDevice(device_);
-    maker->UpdateTree(gpair, p_fmat, p_tree, &reducer_);
+    if (!shards_.empty()) {
+      this->UpdateTreeSharded(gpair, p_fmat, p_tree);
+    } else {
+      maker->UpdateTree(gpair, p_fmat, p_tree, &reducer_);
+    }
+  }
+
+  // Grow the tree on all devices, each device runs in its own thread so that collective
+  // calls can be made concurrently.
+  void UpdateTreeSharded(HostDeviceVector<GradientPair>* gpair, DMatrix* p_fmat,
+                         RegTree* p_tree) {
+    auto d_gpair = gpair->ConstDeviceSpan();
+    size_t n_shards = shards_.size();
+    std::vector<RegTree> local_trees(n_shards - 1, *p_tree);
+    // Random engines are thread local, seed them from the engine of this thread.
+    std::vector<uint32_t> seeds(n_shards);
+    for (auto& seed : seeds) {
+      seed = common::GlobalRandom()();
+    }
+    std::vector<std::exception_ptr> errors(n_shards);
+    std::vector<std::thread> workers;
+    for (size_t k = 0; k < n_shards; ++k) {
+      workers.emplace_back([&, k]() {
+        try {
+          dh::safe_cuda(cudaSetDevice(shards_[k]->device_id));
+          common::GlobalRandom().seed(seeds[k]);
+          RegTree* tree = k == 0 ? p_tree : &local_trees[k - 1];
+          auto shard_gpair = d_gpair.subspan(shard_ptr_[k], shard_ptr_[k + 1] - shard_ptr_[k]);
+          shards_[k]->UpdateTree(shard_gpair, p_fmat, tree, shard_reducers_[k].get());
+        } catch (...) {
+          errors[k] = std::current_exception();
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    for (auto const& e : errors) {
+      if (e) {
+        std::rethrow_exception(e);
+      }
+    }
+    dh::safe_cuda(cudaSetDevice(device_));
+    if (hist_maker_param_.debug_synchronize) {
+      for (auto const& tree : local_trees) {
+        CHECK(tree == *p_tree);
+      }
+    }
   }
 
   bool UpdatePredictionCache(const DMatrix *data,
                              linalg::VectorView<bst_float> p_out_preds) {
-    if (maker == nullptr || p_last_fmat_ == nullptr || p_last_fmat_ != data) {
+    if ((maker == nullptr && shards_.empty()) || p_last_fmat_ == nullptr ||
+        p_last_fmat_ != data) {
       return false;
     }
     monitor_.Start("UpdatePredictionCache");
-    maker->UpdatePredictionCache(p_out_preds);
+    if (shards_.empty()) {
+      maker->UpdatePredictionCache(p_out_preds);
+    } else {
+      this->UpdatePredictionCacheSharded(p_out_preds);
+    }
     monitor_.Stop("UpdatePredictionCache");
     return true;
   }
 
+  void UpdatePredictionCacheSharded(linalg::VectorView<bst_float> out_preds) {
+    for (size_t k = 0; k < shards_.size(); ++k) {
+      auto shard_device = shards_[k]->device_id;
+      size_t n_rows = shard_ptr_[k + 1] - shard_ptr_[k];
+      dh::safe_cuda(cudaSetDevice(shard_device));
+      dh::caching_device_vector<float> shard_preds(n_rows, 0.0f);
+      shards_[k]->UpdatePredictionCache(
+          linalg::MakeTensorView(dh::ToSpan(shard_preds), {n_rows}, shard_device));
+
+      dh::safe_cuda(cudaSetDevice(device_));
+      dh::caching_device_vector<float> delta(n_rows);
+      dh::safe_cuda(cudaMemcpyPeer(delta.data().get(), device_, shard_preds.data().get(),
+                                   shard_device, n_rows * sizeof(float)));
+      auto d_delta = dh::ToSpan(delta);
+      size_t begin = shard_ptr_[k];
+      dh::LaunchN(n_rows, [=] __device__(size_t i) mutable {
+        out_preds(begin + i) += d_delta[i];
+      });
+    }
+  }
+
   TrainParam param_;   // NOLINT
   MetaInfo* info_{};   // NOLINT
 
@@ -858,6 +1092,14 @@ class GPUHistMakerSpecialised {
 
   dh::AllReducer reducer_;
 
+  // Used when training with multiple devices in this process.
+  std::vector<std::unique_ptr<dh::AllReducer>> shard_reducers_;
+  std::vector<std::unique_ptr<EllpackPageImpl>> shard_pages_;
+  std::vector<std::unique_ptr<HostDeviceVector<FeatureType>>> shard_feature_types_;
+  std::vector<std::unique_ptr<GPUHistMakerDevice<GradientSumT>>> shards_;
+  // First row of each device.
+  std::vector<size_t> shard_ptr_;
+
   DMatrix* p_last_fmat_ { nullptr };
   int device_{-1};
   ObjInfo task_;
@@ -7,6 +7,7 @@
 #include <rabit/rabit.h>
 #include <vector>
 #include <algorithm>
+#include <cmath>
 
 #include "xgboost/tree_updater.h"
 #include "xgboost/base.h"
@@ -356,7 +357,7 @@ class CQHistMaker: public HistMaker {
             if (offset >= 0) {
               this->UpdateHistCol(gpair, page[fid], info, tree,
                                   fset, offset,
-                                  &thread_hist_[omp_get_thread_num()]);
+                                  &thread_hist_[common::ThreadIdx()]);
             }
           });
         }
@@ -436,7 +437,7 @@ class CQHistMaker: public HistMaker {
             if (offset >= 0) {
               this->UpdateSketchCol(gpair, page[fid], tree,
                                     work_set_size, offset,
-                                    &thread_sketch_[omp_get_thread_num()]);
+                                    &thread_sketch_[common::ThreadIdx()]);
             }
           });
         }
@@ -649,11 +650,39 @@ class GlobalProposalHistMaker: public CQHistMaker {
   }
 
  protected:
+  // Whether cuts proposed for a previous tree can be used by the current one.
+  bool ReuseSketch(const std::vector<GradientPair> &gpair, DMatrix const *p_fmat,
+                   const std::vector<bst_feature_t> &fset) {
+    if (cached_rptr_.empty() || p_fmat != cached_fmat_ || fset != cached_fset_ ||
+        n_reused_ + 1 >= this->param_.sketch_refresh_interval) {
+      return false;
+    }
+    if (this->param_.sketch_refresh_drift > 0.0f) {
+      CHECK_EQ(gpair.size(), cached_hess_.size());
+      double drift = 0, total = 0;
+      const auto ndata = static_cast<bst_omp_uint>(gpair.size());
+#pragma omp parallel for schedule(static) reduction(+ : drift, total)
+      for (bst_omp_uint i = 0; i < ndata; ++i) {
+        drift += std::abs(gpair[i].GetHess() - cached_hess_[i]);
+        total += std::abs(cached_hess_[i]);
+      }
+      // All workers must agree on the cuts.
+      double sums[2] = {drift, total};
+      rabit::Allreduce<rabit::op::Sum>(sums, 2);
+      if (sums[0] > this->param_.sketch_refresh_drift * sums[1]) {
+        LOG(DEBUG) << "Sketch again with hessian drift: " << sums[0] / sums[1];
+        return false;
+      }
+    }
+    ++n_reused_;
+    return true;
+  }
+
   void ResetPosAndPropose(const std::vector<GradientPair> &gpair,
                           DMatrix *p_fmat,
                           const std::vector<bst_feature_t> &fset,
                           const RegTree &tree) override {
-    if (this->qexpand_.size() == 1) {
+    if (this->qexpand_.size() == 1 && !this->ReuseSketch(gpair, p_fmat, fset)) {
       cached_rptr_.clear();
       cached_cut_.clear();
     }
@@ -662,6 +691,14 @@ class GlobalProposalHistMaker: public CQHistMaker {
       CQHistMaker::ResetPosAndPropose(gpair, p_fmat, fset, tree);
       cached_rptr_ = this->wspace_.rptr;
       cached_cut_ = this->wspace_.cut;
+      cached_fmat_ = p_fmat;
+      cached_fset_ = fset;
+      n_reused_ = 0;
+      if (this->param_.sketch_refresh_interval > 1 && this->param_.sketch_refresh_drift > 0.0f) {
+        cached_hess_.resize(gpair.size());
+        std::transform(gpair.cbegin(), gpair.cend(), cached_hess_.begin(),
+                       [](GradientPair const &g) { return g.GetHess(); });
+      }
     } else {
       this->wspace_.cut.clear();
       this->wspace_.rptr.clear();
@@ -724,7 +761,7 @@ class GlobalProposalHistMaker: public CQHistMaker {
             if (offset >= 0) {
               this->UpdateHistCol(gpair, page[fid], info, tree,
                                   fset, offset,
-                                  &this->thread_hist_[omp_get_thread_num()]);
+                                  &this->thread_hist_[common::ThreadIdx()]);
             }
           });
         }
@@ -748,6 +785,13 @@ class GlobalProposalHistMaker: public CQHistMaker {
   std::vector<unsigned> cached_rptr_;
   // cached cut value.
   std::vector<bst_float> cached_cut_;
+  // data and features used for the cached cuts.
+  DMatrix const *cached_fmat_{nullptr};
+  std::vector<bst_feature_t> cached_fset_;
+  // hessian used for the cached cuts, only kept if drift is checked.
+  std::vector<float> cached_hess_;
+  // number of trees reusing the cached cuts.
+  int32_t n_reused_{0};
 };
 
 XGBOOST_REGISTER_TREE_UPDATER(LocalHistMaker, "grow_local_histmaker")
@@ -10,10 +10,15 @@
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <queue>
+#include <random>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -24,6 +29,7 @@
 #include "param.h"
 #include "./updater_quantile_hist.h"
 #include "./split_evaluator.h"
+#include "./driver.h"
 #include "../common/random.h"
 #include "../common/hist_util.h"
 #include "../common/row_set.h"
@@ -35,14 +41,703 @@ namespace tree {
 
 DMLC_REGISTRY_FILE_TAG(updater_quantile_hist);
 
+namespace {
+// Global bin of a feature in a row, -1 if missing.
+int32_t RowBin(GHistIndexMatrix const& gmat, size_t ridx, bst_feature_t fidx) {
+  auto const& ptrs = gmat.cut.Ptrs();
+  size_t begin = gmat.row_ptr[ridx];
+  size_t end = gmat.row_ptr[ridx + 1];
+  if (gmat.IsDense()) {
+    return gmat.index[begin + fidx];
+  }
+  for (size_t j = begin; j < end; ++j) {
+    auto bin = gmat.index[j];
+    if (bin >= ptrs[fidx] && bin < ptrs[fidx + 1]) {
+      return static_cast<int32_t>(bin);
+    }
+  }
+  return -1;
+}
+}  // anonymous namespace
+
+/*!
+ * \brief Grow a tree with a vector of weights in each leaf, one weight for each target.
+ *        Histogram of a node stores gradient of all targets for each bin, gain of a split
+ *        is the sum of gain over all targets.
+ */
+class MultiTargetHistBuilder {
+  struct ExpandEntry : public CPUExpandEntry {
+    // Last bin going to the left child, missing values follow the default direction.
+    int32_t split_bin{-1};
+    ExpandEntry() = default;
+    ExpandEntry(bst_node_t nidx, int32_t depth) : CPUExpandEntry{nidx, depth, 0.0f} {}
+  };
+  using Hist = std::vector<GradientPairPrecise>;
+
+  TrainParam const& param_;
+  // Parameter for statistics of a single target, minimum child weight is applied to the
+  // sum of hessian over all targets instead.
+  TrainParam target_param_;
+  size_t n_targets_{0};
+  int32_t n_threads_;
+  common::ColumnSampler column_sampler_;
+  common::RowSetCollection row_set_collection_;
+  // Last tree and its training data, for updating the prediction cache.  The cache can only
+  // be updated when all rows are in the row set.
+  DMatrix const* p_last_fmat_{nullptr};
+  RegTree const* p_last_tree_{nullptr};
+  bool all_rows_{false};
+  // Histograms and gradient sums of nodes waiting to be expanded.
+  std::map<bst_node_t, Hist> hist_;
+  std::map<bst_node_t, Hist> node_sum_;
+  std::vector<Hist> thread_hist_;
+  common::Monitor monitor_;
+
+  void SetLeafWeight(std::vector<GradientPairPrecise> const& sum, bst_node_t nidx,
+                     RegTree* p_tree) const {
+    std::vector<float> weights(n_targets_);
+    for (size_t t = 0; t < n_targets_; ++t) {
+      weights[t] = CalcWeight(target_param_, sum[t].GetGrad(), sum[t].GetHess()) *
+                   param_.learning_rate;
+    }
+    p_tree->SetLeafVector(nidx, weights);
+  }
+
+  void InitData(GHistIndexMatrix const& gmat, std::vector<GradientPair> const& gpair,
+                MetaInfo const& info) {
+    CHECK(!rabit::IsDistributed()) << "Multi-target tree doesn't support distributed training.";
+    auto const& h_ft = info.feature_types.ConstHostVector();
+    CHECK(std::none_of(h_ft.cbegin(), h_ft.cend(),
+                       [](FeatureType t) { return t == FeatureType::kCategorical; }))
+        << "Multi-target tree doesn't support categorical data.";
+    CHECK(param_.monotone_constraints.empty() && param_.interaction_constraints.empty())
+        << "Multi-target tree doesn't support feature constraints.";
+    CHECK_EQ(gmat.row_ptr.size(), info.num_row_ + 1)
+        << "Multi-target tree doesn't support external memory.";
+    CHECK_EQ(gpair.size(), info.num_row_ * n_targets_)
+        << "Mismatching size between number of rows and size of gradient matrix.";
+
+    auto& rows = *row_set_collection_.Data();
+    rows.clear();
+    rows.reserve(info.num_row_);
+    auto& rnd = common::GlobalRandom();
+    std::bernoulli_distribution coin_flip(param_.subsample);
+    for (size_t ridx = 0; ridx < info.num_row_; ++ridx) {
+      auto row = gpair.data() + ridx * n_targets_;
+      // Rows with negative hessian are dropped, same as single target tree.
+      bool neg_hess = std::any_of(row, row + n_targets_,
+                                  [](GradientPair const& g) { return g.GetHess() < 0.0f; });
+      if (neg_hess || (param_.subsample < 1.0f && !coin_flip(rnd))) {
+        continue;
+      }
+      rows.push_back(ridx);
+    }
+    all_rows_ = rows.size() == info.num_row_;
+    row_set_collection_.Clear();
+    row_set_collection_.Init();
+
+    column_sampler_.Init(info.num_col_, info.feature_weights.ConstHostVector(),
+                         param_.colsample_bynode, param_.colsample_bylevel,
+                         param_.colsample_bytree);
+    hist_.clear();
+    node_sum_.clear();
+  }
+
+  void BuildHist(GHistIndexMatrix const& gmat, std::vector<GradientPair> const& gpair,
+                 bst_node_t nidx) {
+    monitor_.Start(__func__);
+    auto const& elem = row_set_collection_[nidx];
+    size_t const n_bins = gmat.cut.Ptrs().back();
+    auto& hist = hist_[nidx];
+    hist.assign(n_bins * n_targets_, GradientPairPrecise{});
+
+    auto accumulate = [&](size_t const* begin, size_t const* end, GradientPairPrecise* out) {
+      for (auto it = begin; it != end; ++it) {
+        auto ridx = *it;
+        auto row = gpair.data() + ridx * n_targets_;
+        for (size_t j = gmat.row_ptr[ridx]; j < gmat.row_ptr[ridx + 1]; ++j) {
+          auto h = out + static_cast<size_t>(gmat.index[j]) * n_targets_;
+          for (size_t t = 0; t < n_targets_; ++t) {
+            h[t].Add(row[t].GetGrad(), row[t].GetHess());
+          }
+        }
+      }
+    };
+    // Rows are divided into blocks, each block has its own histogram.
+    size_t constexpr kMinRowsPerBlock = 1024;
+    size_t n_blocks = std::min(static_cast<size_t>(n_threads_),
+                               std::max(elem.Size() / kMinRowsPerBlock, static_cast<size_t>(1)));
+    if (n_blocks == 1) {
+      accumulate(elem.begin, elem.end, hist.data());
+    } else {
+      thread_hist_.resize(n_blocks);
+      size_t block_size = common::DivRoundUp(elem.Size(), n_blocks);
+      common::ParallelFor(n_blocks, n_threads_, [&](size_t b) {
+        auto begin = elem.begin + std::min(b * block_size, elem.Size());
+        auto end = elem.begin + std::min((b + 1) * block_size, elem.Size());
+        auto& local = thread_hist_[b];
+        local.assign(hist.size(), GradientPairPrecise{});
+        accumulate(begin, end, local.data());
+      });
+      common::ParallelFor(hist.size(), n_threads_, [&](size_t i) {
+        for (size_t b = 0; b < n_blocks; ++b) {
+          hist[i] += thread_hist_[b][i];
+        }
+      });
+    }
+    monitor_.Stop(__func__);
+  }
+
+  void EnumerateFeature(common::HistogramCuts const& cut, bst_feature_t fidx, Hist const& hist,
+                        Hist const& sum, double parent_gain, ExpandEntry* best) const {
+    auto const& ptrs = cut.Ptrs();
+    auto const& values = cut.Values();
+    auto const& mins = cut.MinValues();
+    int32_t ibegin = static_cast<int32_t>(ptrs[fidx]);
+    int32_t iend = static_cast<int32_t>(ptrs[fidx + 1]);
+    Hist left(n_targets_), right(n_targets_);
+
+    auto try_split = [&](int32_t split_bin, float split_value, bool default_left) {
+      GradStats left_sum, right_sum;
+      for (size_t t = 0; t < n_targets_; ++t) {
+        left_sum.Add(left[t].GetGrad(), left[t].GetHess());
+        right_sum.Add(right[t].GetGrad(), right[t].GetHess());
+      }
+      if (left_sum.GetHess() < param_.min_child_weight || left_sum.GetHess() <= 0.0 ||
+          right_sum.GetHess() < param_.min_child_weight || right_sum.GetHess() <= 0.0) {
+        return;
+      }
+      double gain = 0;
+      for (size_t t = 0; t < n_targets_; ++t) {
+        gain += CalcGain(target_param_, left[t].GetGrad(), left[t].GetHess()) +
+                CalcGain(target_param_, right[t].GetGrad(), right[t].GetHess());
+      }
+      if (best->split.Update(static_cast<float>(gain - parent_gain), fidx, split_value,
+                             default_left, false, left_sum, right_sum)) {
+        best->split_bin = split_bin;
+      }
+    };
+
+    // Forward enumeration, missing values go to the right.
+    std::fill(left.begin(), left.end(), GradientPairPrecise{});
+    for (int32_t i = ibegin; i < iend; ++i) {
+      for (size_t t = 0; t < n_targets_; ++t) {
+        left[t] += hist[i * n_targets_ + t];
+        right[t] = sum[t] - left[t];
+      }
+      try_split(i, values[i], false);
+    }
+    // Backward enumeration, missing values go to the left.
+    std::fill(right.begin(), right.end(), GradientPairPrecise{});
+    for (int32_t i = iend - 1; i >= ibegin; --i) {
+      for (size_t t = 0; t < n_targets_; ++t) {
+        right[t] += hist[i * n_targets_ + t];
+        left[t] = sum[t] - right[t];
+      }
+      try_split(i - 1, i == ibegin ? mins[fidx] : values[i - 1], true);
+    }
+  }
+
+  void EvaluateSplit(GHistIndexMatrix const& gmat, ExpandEntry* entry) {
+    monitor_.Start(__func__);
+    auto const& hist = hist_.at(entry->nid);
+    auto const& sum = node_sum_.at(entry->nid);
+    double parent_gain = 0;
+    for (size_t t = 0; t < n_targets_; ++t) {
+      parent_gain += CalcGain(target_param_, sum[t].GetGrad(), sum[t].GetHess());
+    }
+    auto features = column_sampler_.GetFeatureSet(entry->depth);
+    auto const& h_features = features->ConstHostVector();
+    std::vector<ExpandEntry> tloc(n_threads_, *entry);
+    common::ParallelFor(h_features.size(), n_threads_, [&](size_t i) {
+      EnumerateFeature(gmat.cut, h_features[i], hist, sum, parent_gain,
+                       &tloc[common::ThreadIdx()]);
+    });
+    for (auto const& e : tloc) {
+      if (entry->split.Update(e.split)) {
+        entry->split_bin = e.split_bin;
+      }
+    }
+    monitor_.Stop(__func__);
+  }
+
+  void ApplySplit(GHistIndexMatrix const& gmat, ExpandEntry const& e, RegTree* p_tree) {
+    monitor_.Start(__func__);
+    auto fidx = e.split.SplitIndex();
+    bool default_left = e.split.DefaultLeft();
+    auto const& hist = hist_.at(e.nid);
+    auto const& sum = node_sum_.at(e.nid);
+    auto const& ptrs = gmat.cut.Ptrs();
+
+    Hist left(n_targets_), right(n_targets_);
+    if (default_left) {
+      for (uint32_t i = e.split_bin + 1; i < ptrs[fidx + 1]; ++i) {
+        for (size_t t = 0; t < n_targets_; ++t) {
+          right[t] += hist[i * n_targets_ + t];
+        }
+      }
+      for (size_t t = 0; t < n_targets_; ++t) {
+        left[t] = sum[t] - right[t];
+      }
+    } else {
+      for (uint32_t i = ptrs[fidx]; i <= static_cast<uint32_t>(e.split_bin); ++i) {
+        for (size_t t = 0; t < n_targets_; ++t) {
+          left[t] += hist[i * n_targets_ + t];
+        }
+      }
+      for (size_t t = 0; t < n_targets_; ++t) {
+        right[t] = sum[t] - left[t];
+      }
+    }
+
+    auto left_hess = e.split.left_sum.GetHess();
+    auto right_hess = e.split.right_sum.GetHess();
+    // Scalar weights are unused, the leaf vectors are set below.
+    p_tree->ExpandNode(e.nid, fidx, e.split.split_value, default_left, 0.0f, 0.0f, 0.0f,
+                       e.split.loss_chg, left_hess + right_hess, left_hess, right_hess);
+    auto left_nidx = (*p_tree)[e.nid].LeftChild();
+    auto right_nidx = (*p_tree)[e.nid].RightChild();
+    this->SetLeafWeight(left, left_nidx, p_tree);
+    this->SetLeafWeight(right, right_nidx, p_tree);
+    node_sum_[left_nidx] = std::move(left);
+    node_sum_[right_nidx] = std::move(right);
+
+    auto const& elem = row_set_collection_[e.nid];
+    auto begin = const_cast<size_t*>(elem.begin);
+    auto end = const_cast<size_t*>(elem.end);
+    auto mid = std::stable_partition(begin, end, [&](size_t ridx) {
+      auto bin = RowBin(gmat, ridx, fidx);
+      return bin < 0 ? default_left : bin <= e.split_bin;
+    });
+    row_set_collection_.AddSplit(e.nid, left_nidx, right_nidx, mid - begin, end - mid);
+    monitor_.Stop(__func__);
+  }
+
+ public:
+  explicit MultiTargetHistBuilder(TrainParam const& param)
+      : param_{param}, n_threads_{omp_get_max_threads()} {
+    monitor_.Init(__func__);
+  }
+
+  void Update(GHistIndexMatrix const& gmat, HostDeviceVector<GradientPair>* gpair,
+              DMatrix* p_fmat, RegTree* p_tree) {
+    monitor_.Start(__func__);
+    p_last_fmat_ = p_fmat;
+    p_last_tree_ = p_tree;
+    n_targets_ = p_tree->NumTargets();
+    target_param_ = param_;
+    target_param_.min_child_weight = 0.0f;
+    auto const& h_gpair = gpair->ConstHostVector();
+    this->InitData(gmat, h_gpair, p_fmat->Info());
+
+    auto& root_sum = node_sum_[RegTree::kRoot];
+    root_sum.assign(n_targets_, GradientPairPrecise{});
+    auto const& root = row_set_collection_[RegTree::kRoot];
+    for (auto it = root.begin; it != root.end; ++it) {
+      for (size_t t = 0; t < n_targets_; ++t) {
+        root_sum[t] += GradientPairPrecise{h_gpair[*it * n_targets_ + t]};
+      }
+    }
+    this->SetLeafWeight(root_sum, RegTree::kRoot, p_tree);
+    p_tree->Stat(RegTree::kRoot).sum_hess = std::accumulate(
+        root_sum.cbegin(), root_sum.cend(), 0.0,
+        [](double acc, GradientPairPrecise const& g) { return acc + g.GetHess(); });
+
+    Driver<ExpandEntry> driver(static_cast<TrainParam::TreeGrowPolicy>(param_.grow_policy));
+    ExpandEntry root_entry{RegTree::kRoot, p_tree->GetDepth(RegTree::kRoot)};
+    this->BuildHist(gmat, h_gpair, RegTree::kRoot);
+    this->EvaluateSplit(gmat, &root_entry);
+    driver.Push(root_entry);
+
+    int32_t num_leaves = 1;
+    auto expand_set = driver.Pop();
+    while (!expand_set.empty()) {
+      std::vector<ExpandEntry> valid_candidates;
+      for (auto const& candidate : expand_set) {
+        if (!candidate.IsValid(param_, num_leaves)) {
+          hist_.erase(candidate.nid);
+          node_sum_.erase(candidate.nid);
+          continue;
+        }
+        this->ApplySplit(gmat, candidate, p_tree);
+        num_leaves++;
+
+        // Build the histogram of the smaller child, the other one is obtained by
+        // subtracting it from the parent.
+        auto left_nidx = (*p_tree)[candidate.nid].LeftChild();
+        auto right_nidx = (*p_tree)[candidate.nid].RightChild();
+        bool left_smaller =
+            row_set_collection_[left_nidx].Size() <= row_set_collection_[right_nidx].Size();
+        auto small_nidx = left_smaller ? left_nidx : right_nidx;
+        auto large_nidx = left_smaller ? right_nidx : left_nidx;
+        this->BuildHist(gmat, h_gpair, small_nidx);
+        auto& parent = hist_.at(candidate.nid);
+        auto const& small = hist_.at(small_nidx);
+        for (size_t i = 0; i < parent.size(); ++i) {
+          parent[i] -= small[i];
+        }
+        hist_[large_nidx] = std::move(parent);
+        hist_.erase(candidate.nid);
+        node_sum_.erase(candidate.nid);
+
+        int32_t depth = candidate.depth + 1;
+        for (auto nidx : {left_nidx, right_nidx}) {
+          ExpandEntry child{nidx, depth};
+          if (CPUExpandEntry::ChildIsValid(param_, depth, num_leaves)) {
+            this->EvaluateSplit(gmat, &child);
+            valid_candidates.push_back(child);
+          } else {
+            hist_.erase(nidx);
+            node_sum_.erase(nidx);
+          }
+        }
+      }
+      driver.Push(valid_candidates.begin(), valid_candidates.end());
+      expand_set = driver.Pop();
+    }
+    hist_.clear();
+    node_sum_.clear();
+    monitor_.Stop(__func__);
+  }
+
+  bool UpdatePredictionCache(DMatrix const* data, linalg::MatrixView<float> out_preds) {
+    if (!p_last_tree_ || data != p_last_fmat_ || !all_rows_) {
+      return false;
+    }
+    monitor_.Start(__func__);
+    CHECK_EQ(out_preds.Shape(1), n_targets_);
+    CHECK_EQ(out_preds.DeviceIdx(), GenericParameter::kCpuId);
+    auto const& tree = *p_last_tree_;
+    size_t n_nodes = row_set_collection_.end() - row_set_collection_.begin();
+    common::BlockedSpace2d space(
+        n_nodes, [&](size_t node) { return row_set_collection_[node].Size(); }, 1024);
+    common::ParallelFor2d(space, n_threads_, [&](size_t node, common::Range1d r) {
+      auto const& rowset = row_set_collection_[node];
+      if (rowset.begin == nullptr || rowset.end == nullptr) {
+        return;
+      }
+      auto leaf = tree.LeafVector(rowset.node_id);
+      for (auto it = rowset.begin + r.begin(); it < rowset.begin + r.end(); ++it) {
+        for (size_t t = 0; t < n_targets_; ++t) {
+          out_preds(*it, t) += leaf[t];
+        }
+      }
+    });
+    monitor_.Stop(__func__);
+    return true;
+  }
+};
+
+/*!
+ * \brief Grow a tree with threads owning disjoint ranges of features, for wide data with few
+ *        rows.  Histograms of a feature for all nodes being expanded are built from the
+ *        column matrix, evaluated and discarded right away, so no histogram is stored for
+ *        nodes and only the best splits are reduced across threads.
+ */
+class FeatureParallelHistBuilder {
+  struct ExpandEntry : public CPUExpandEntry {
+    // Last bin going to the left child, missing values follow the default direction.
+    int32_t split_bin{-1};
+    ExpandEntry() = default;
+    ExpandEntry(bst_node_t nidx, int32_t depth) : CPUExpandEntry{nidx, depth, 0.0f} {}
+  };
+  // Number of feature ranges for each thread, ranges are balanced by number of values.
+  static size_t constexpr kRangesPerThread = 4;
+
+  TrainParam const& param_;
+  int32_t n_threads_;
+  common::ColumnSampler column_sampler_;
+  // Node of each row, -1 for rows not used by the tree.
+  std::vector<bst_node_t> positions_;
+  std::vector<GradStats> node_sum_;
+  // Boundaries of feature ranges.
+  std::vector<bst_feature_t> ranges_;
+  // Last tree and its training data, for updating the prediction cache.  The cache can only
+  // be updated when all rows are used.
+  DMatrix const* p_last_fmat_{nullptr};
+  RegTree const* p_last_tree_{nullptr};
+  bool all_rows_{false};
+  common::Monitor monitor_;
+
+  void InitData(ColumnMatrix const& columns, std::vector<GradientPair> const& gpair,
+                MetaInfo const& info) {
+    CHECK_EQ(gpair.size(), info.num_row_);
+    positions_.resize(info.num_row_);
+    auto& rnd = common::GlobalRandom();
+    std::bernoulli_distribution coin_flip(param_.subsample);
+    all_rows_ = true;
+    for (size_t ridx = 0; ridx < info.num_row_; ++ridx) {
+      bool used = gpair[ridx].GetHess() >= 0.0f &&
+                  (param_.subsample >= 1.0f || coin_flip(rnd));
+      positions_[ridx] = used ? RegTree::kRoot : -1;
+      all_rows_ = all_rows_ && used;
+    }
+    column_sampler_.Init(info.num_col_, info.feature_weights.ConstHostVector(),
+                         param_.colsample_bynode, param_.colsample_bylevel,
+                         param_.colsample_bytree);
+
+    size_t n_features = columns.GetNumFeature();
+    size_t total = 0;
+    for (bst_feature_t fidx = 0; fidx < n_features; ++fidx) {
+      total += columns.GetFeatureCount(fidx);
+    }
+    size_t n_ranges = static_cast<size_t>(n_threads_) * kRangesPerThread;
+    size_t per_range = std::max(common::DivRoundUp(total, n_ranges), static_cast<size_t>(1));
+    ranges_.assign(1, 0);
+    size_t acc = 0;
+    for (bst_feature_t fidx = 0; fidx < n_features; ++fidx) {
+      acc += columns.GetFeatureCount(fidx);
+      if (acc >= per_range * ranges_.size()) {
+        ranges_.push_back(fidx + 1);
+      }
+    }
+    if (ranges_.back() != n_features) {
+      ranges_.push_back(n_features);
+    }
+  }
+
+  void EnumerateFeature(common::HistogramCuts const& cut, bst_feature_t fidx,
+                        GradientPairPrecise const* hist, GradStats const& sum,
+                        double parent_gain, ExpandEntry* best) const {
+    auto const& ptrs = cut.Ptrs();
+    auto const& values = cut.Values();
+    auto const& mins = cut.MinValues();
+    int32_t ibegin = static_cast<int32_t>(ptrs[fidx]);
+    int32_t iend = static_cast<int32_t>(ptrs[fidx + 1]);
+
+    auto try_split = [&](GradStats const& left, GradStats const& right, int32_t split_bin,
+                         float split_value, bool default_left) {
+      if (left.GetHess() < param_.min_child_weight || left.GetHess() <= 0.0 ||
+          right.GetHess() < param_.min_child_weight || right.GetHess() <= 0.0) {
+        return;
+      }
+      double gain = CalcGain(param_, left.GetGrad(), left.GetHess()) +
+                    CalcGain(param_, right.GetGrad(), right.GetHess());
+      if (best->split.Update(static_cast<float>(gain - parent_gain), fidx, split_value,
+                             default_left, false, left, right)) {
+        best->split_bin = split_bin;
+      }
+    };
+
+    // Forward enumeration, missing values go to the right.
+    GradStats left, right;
+    for (int32_t i = ibegin; i < iend; ++i) {
+      left.Add(hist[i - ibegin].GetGrad(), hist[i - ibegin].GetHess());
+      right.SetSubstract(sum, left);
+      try_split(left, right, i, values[i], false);
+    }
+    // Backward enumeration, missing values go to the left.
+    right = GradStats{};
+    for (int32_t i = iend - 1; i >= ibegin; --i) {
+      right.Add(hist[i - ibegin].GetGrad(), hist[i - ibegin].GetHess());
+      left.SetSubstract(sum, right);
+      try_split(left, right, i - 1, i == ibegin ? mins[fidx] : values[i - 1], true);
+    }
+  }
+
+  void EvaluateSplits(GHistIndexMatrix const& gmat, ColumnMatrix const& columns,
+                      std::vector<GradientPair> const& gpair, RegTree const& tree,
+                      std::vector<ExpandEntry>* p_nodes) {
+    monitor_.Start(__func__);
+    auto& nodes = *p_nodes;
+    size_t const n_nodes = nodes.size();
+    std::vector<int32_t> slots(tree.GetNodes().size(), -1);
+    std::vector<double> parent_gain(n_nodes);
+    // Features sampled for each node, empty when all features are used.
+    std::vector<std::vector<bool>> sampled(n_nodes);
+    bool sampling = param_.colsample_bynode < 1.0f || param_.colsample_bylevel < 1.0f ||
+                    param_.colsample_bytree < 1.0f;
+    for (size_t i = 0; i < n_nodes; ++i) {
+      slots[nodes[i].nid] = static_cast<int32_t>(i);
+      auto const& sum = node_sum_[nodes[i].nid];
+      parent_gain[i] = CalcGain(param_, sum.GetGrad(), sum.GetHess());
+      if (sampling) {
+        sampled[i].resize(columns.GetNumFeature(), false);
+        for (auto fidx : column_sampler_.GetFeatureSet(nodes[i].depth)->ConstHostVector()) {
+          sampled[i][fidx] = true;
+        }
+      }
+    }
+
+    auto const& ptrs = gmat.cut.Ptrs();
+    size_t const n_ranges = ranges_.size() - 1;
+    std::vector<std::vector<ExpandEntry>> best(n_ranges, nodes);
+    common::ParallelFor(n_ranges, n_threads_, common::Sched::Dyn(), [&](size_t r) {
+      std::vector<GradientPairPrecise> hist;
+      auto& local = best[r];
+      for (bst_feature_t fidx = ranges_[r]; fidx < ranges_[r + 1]; ++fidx) {
+        if (columns.GetFeatureCount(fidx) == 0) {
+          continue;
+        }
+        size_t const n_bins = ptrs[fidx + 1] - ptrs[fidx];
+        hist.assign(n_bins * n_nodes, GradientPairPrecise{});
+        uint32_t const base = ptrs[fidx];
+        columns.VisitColumn(fidx, [&](size_t ridx, uint32_t bin) {
+          auto nidx = positions_[ridx];
+          if (nidx < 0 || slots[nidx] < 0) {
+            return;
+          }
+          hist[slots[nidx] * n_bins + (bin - base)] += GradientPairPrecise{gpair[ridx]};
+        });
+        for (size_t i = 0; i < n_nodes; ++i) {
+          if (sampling && !sampled[i][fidx]) {
+            continue;
+          }
+          this->EnumerateFeature(gmat.cut, fidx, hist.data() + i * n_bins,
+                                 node_sum_[nodes[i].nid], parent_gain[i], &local[i]);
+        }
+      }
+    });
+    for (size_t i = 0; i < n_nodes; ++i) {
+      for (size_t r = 0; r < n_ranges; ++r) {
+        if (nodes[i].split.Update(best[r][i].split)) {
+          nodes[i].split_bin = best[r][i].split_bin;
+        }
+      }
+    }
+    monitor_.Stop(__func__);
+  }
+
+  void ApplySplits(GHistIndexMatrix const& gmat, std::vector<ExpandEntry> const& nodes,
+                   RegTree* p_tree) {
+    monitor_.Start(__func__);
+    auto& tree = *p_tree;
+    for (auto const& e : nodes) {
+      auto parent_sum = e.split.left_sum;
+      parent_sum.Add(e.split.right_sum);
+      auto base_weight = CalcWeight(param_, parent_sum);
+      auto left_weight = CalcWeight(param_, e.split.left_sum);
+      auto right_weight = CalcWeight(param_, e.split.right_sum);
+      tree.ExpandNode(e.nid, e.split.SplitIndex(), e.split.split_value,
+                      e.split.DefaultLeft(), base_weight, left_weight * param_.learning_rate,
+                      right_weight * param_.learning_rate, e.split.loss_chg,
+                      parent_sum.GetHess(), e.split.left_sum.GetHess(),
+                      e.split.right_sum.GetHess());
+      node_sum_.resize(tree.GetNodes().size());
+      node_sum_[tree[e.nid].LeftChild()] = e.split.left_sum;
+      node_sum_[tree[e.nid].RightChild()] = e.split.right_sum;
+    }
+    // Split bin of each node being split, -2 for other nodes.
+    std::vector<int32_t> split_bins(tree.GetNodes().size(), -2);
+    for (auto const& e : nodes) {
+      split_bins[e.nid] = e.split_bin;
+    }
+    common::ParallelFor(positions_.size(), n_threads_, [&](size_t ridx) {
+      auto nidx = positions_[ridx];
+      if (nidx < 0 || split_bins[nidx] == -2) {
+        return;
+      }
+      auto const& node = tree[nidx];
+      auto bin = RowBin(gmat, ridx, node.SplitIndex());
+      bool go_left = bin < 0 ? node.DefaultLeft() : bin <= split_bins[nidx];
+      positions_[ridx] = go_left ? node.LeftChild() : node.RightChild();
+    });
+    monitor_.Stop(__func__);
+  }
+
+ public:
+  explicit FeatureParallelHistBuilder(TrainParam const& param)
+      : param_{param}, n_threads_{omp_get_max_threads()} {
+    monitor_.Init(__func__);
+  }
+
+  /*! \brief Whether the data and parameters are supported by this builder. */
+  static bool Supported(TrainParam const& param, MetaInfo const& info,
+                        GHistIndexMatrix const& gmat) {
+    auto const& h_ft = info.feature_types.ConstHostVector();
+    return !rabit::IsDistributed() && gmat.row_ptr.size() == info.num_row_ + 1 &&
+           param.monotone_constraints.empty() && param.interaction_constraints.empty() &&
+           param.sampling_method == TrainParam::kUniform &&
+           std::none_of(h_ft.cbegin(), h_ft.cend(),
+                        [](FeatureType t) { return t == FeatureType::kCategorical; });
+  }
+
+  void Update(GHistIndexMatrix const& gmat, ColumnMatrix const& columns,
+              HostDeviceVector<GradientPair>* gpair, DMatrix* p_fmat, RegTree* p_tree) {
+    monitor_.Start(__func__);
+    p_last_fmat_ = p_fmat;
+    p_last_tree_ = p_tree;
+    auto const& h_gpair = gpair->ConstHostVector();
+    this->InitData(columns, h_gpair, p_fmat->Info());
+
+    GradStats root_sum;
+    for (size_t ridx = 0; ridx < positions_.size(); ++ridx) {
+      if (positions_[ridx] == RegTree::kRoot) {
+        root_sum.Add(h_gpair[ridx]);
+      }
+    }
+    node_sum_.assign(1, root_sum);
+    auto weight = CalcWeight(param_, root_sum);
+    p_tree->Stat(RegTree::kRoot).sum_hess = root_sum.GetHess();
+    p_tree->Stat(RegTree::kRoot).base_weight = weight;
+    (*p_tree)[RegTree::kRoot].SetLeaf(param_.learning_rate * weight);
+
+    Driver<ExpandEntry> driver(static_cast<TrainParam::TreeGrowPolicy>(param_.grow_policy));
+    std::vector<ExpandEntry> candidates{ExpandEntry{RegTree::kRoot, 0}};
+    this->EvaluateSplits(gmat, columns, h_gpair, *p_tree, &candidates);
+    driver.Push(candidates.begin(), candidates.end());
+
+    int32_t num_leaves = 1;
+    auto expand_set = driver.Pop();
+    while (!expand_set.empty()) {
+      std::vector<ExpandEntry> applied;
+      for (auto const& candidate : expand_set) {
+        if (candidate.IsValid(param_, num_leaves)) {
+          applied.push_back(candidate);
+          num_leaves++;
+        }
+      }
+      this->ApplySplits(gmat, applied, p_tree);
+      candidates.clear();
+      for (auto const& e : applied) {
+        int32_t depth = e.depth + 1;
+        if (!CPUExpandEntry::ChildIsValid(param_, depth, num_leaves)) {
+          continue;
+        }
+        candidates.emplace_back((*p_tree)[e.nid].LeftChild(), depth);
+        candidates.emplace_back((*p_tree)[e.nid].RightChild(), depth);
+      }
+      if (!candidates.empty()) {
+        this->EvaluateSplits(gmat, columns, h_gpair, *p_tree, &candidates);
+      }
+      driver.Push(candidates.begin(), candidates.end());
+      expand_set = driver.Pop();
+    }
+    monitor_.Stop(__func__);
+  }
+
+  bool UpdatePredictionCache(DMatrix const* data, linalg::VectorView<float> out_preds) {
+    if (!p_last_tree_ || data != p_last_fmat_ || !all_rows_) {
+      return false;
+    }
+    monitor_.Start(__func__);
+    CHECK_EQ(out_preds.DeviceIdx(), GenericParameter::kCpuId);
+    CHECK_EQ(out_preds.Size(), positions_.size());
+    auto const& tree = *p_last_tree_;
+    common::ParallelFor(positions_.size(), n_threads_, [&](size_t ridx) {
+      out_preds(ridx) += tree[positions_[ridx]].LeafValue();
+    });
+    monitor_.Stop(__func__);
+    return true;
+  }
+};
+
+QuantileHistMaker::QuantileHistMaker(ObjInfo task) : task_{task} {
+  updater_monitor_.Init("QuantileHistMaker");
+}
+
+QuantileHistMaker::~QuantileHistMaker() = default;
+
 DMLC_REGISTER_PARAMETER(CPUHistMakerTrainParam);
 
 void QuantileHistMaker::Configure(const Args& args) {
-  // initialize pruner
-  if (!pruner_) {
-    pruner_.reset(TreeUpdater::Create("prune", tparam_, task_));
+  // Splits violating `min_split_loss` or `max_depth` are never applied during expansion,
+  // so there's nothing left for the pruner and only the synchronization is needed.
+  if (!syncher_) {
+    syncher_.reset(TreeUpdater::Create("sync", tparam_, task_));
   }
-  pruner_->Configure(args);
+  syncher_->Configure(args);
+  args_ = args;
   param_.UpdateAllowUnknown(args);
   hist_maker_param_.UpdateAllowUnknown(args);
 }
@@ -52,34 +747,104 @@ void QuantileHistMaker::SetBuilder(const size_t n_trees,
                                    std::unique_ptr<Builder<GradientSumT>>* builder,
                                    DMatrix *dmat) {
   builder->reset(
-      new Builder<GradientSumT>(n_trees, param_, std::move(pruner_), dmat, task_));
+      new Builder<GradientSumT>(n_trees, param_, std::move(syncher_), dmat, task_));
+  (*builder)->SetHistParam(hist_maker_param_);
 }
 
 template<typename GradientSumT>
-void QuantileHistMaker::CallBuilderUpdate(const std::unique_ptr<Builder<GradientSumT>>& builder,
-                                          HostDeviceVector<GradientPair> *gpair,
-                                          DMatrix *dmat,
-                                          GHistIndexMatrix const& gmat,
-                                          const std::vector<RegTree *> &trees) {
-  for (auto tree : trees) {
-    builder->Update(gmat, column_matrix_, gpair, dmat, tree);
+void QuantileHistMaker::CallBuilderUpdate(
+    const std::unique_ptr<Builder<GradientSumT>>& builder,
+    std::vector<std::unique_ptr<Builder<GradientSumT>>>* workers,
+    HostDeviceVector<GradientPair> *gpair,
+    DMatrix *dmat,
+    GHistIndexMatrix const& gmat,
+    ColumnMatrix const& column_matrix,
+    const std::vector<RegTree *> &trees,
+    GradientSource const* source) {
+  size_t n_concurrent = std::min(
+      static_cast<size_t>(hist_maker_param_.parallel_tree_concurrency), trees.size());
+  // Histograms are synchronized in the order of nodes, trees must be built one by one in
+  // distributed training.
+  if (n_concurrent <= 1 || source || rabit::IsDistributed()) {
+    for (auto tree : trees) {
+      builder->Update(gmat, column_matrix, gpair, dmat, tree, source);
+    }
+    return;
+  }
+
+  updater_monitor_.Start("ConcurrentUpdate");
+  while (workers->size() < n_concurrent - 1) {
+    std::unique_ptr<TreeUpdater> syncher{TreeUpdater::Create("sync", tparam_, task_)};
+    syncher->Configure(args_);
+    workers->emplace_back(
+        new Builder<GradientSumT>(trees.size(), param_, std::move(syncher), dmat, task_));
+    workers->back()->SetHistParam(hist_maker_param_);
+  }
+  // Each tree samples with its own seed drawn from the global random engine, so the result
+  // doesn't depend on scheduling of the threads.
+  auto& rnd = common::GlobalRandom();
+  std::vector<common::GlobalRandomEngine::result_type> seeds(trees.size());
+  for (auto& seed : seeds) {
+    seed = rnd();
+  }
+  // The gradient index and column matrix are shared, each builder owns its histograms and
+  // row partitions.
+  int32_t n_threads = std::max(omp_get_max_threads() / static_cast<int32_t>(n_concurrent), 1);
+  dmlc::OMPException exc;
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < n_concurrent; ++w) {
+    Builder<GradientSumT>* p_builder = w == 0 ? builder.get() : workers->at(w - 1).get();
+    threads.emplace_back([&, w, p_builder]() {
+      exc.Run([&]() {
+        omp_set_num_threads(n_threads);
+        for (size_t i = w; i < trees.size(); i += n_concurrent) {
+          common::GlobalRandom().seed(seeds[i]);
+          p_builder->Update(gmat, column_matrix, gpair, dmat, trees[i], nullptr);
+        }
+      });
+    });
   }
+  for (auto& t : threads) {
+    t.join();
+  }
+  exc.Rethrow();
+  updater_monitor_.Stop("ConcurrentUpdate");
 }
 
 void QuantileHistMaker::Update(HostDeviceVector<GradientPair> *gpair,
                                DMatrix *dmat,
                                const std::vector<RegTree *> &trees) {
-  auto it = dmat->GetBatches<GHistIndexMatrix>(
-                    BatchParam{GenericParameter::kCpuId, param_.max_bin})
-                .begin();
+  this->UpdateImpl(gpair, dmat, trees, nullptr);
+}
+
+void QuantileHistMaker::UpdateFused(HostDeviceVector<GradientPair> *gpair,
+                                    GradientSource const &source, DMatrix *dmat,
+                                    const std::vector<RegTree *> &trees) {
+  // Sampling, quantization and rounding require the full gradient before building the root.
+  if (trees.size() != 1 || trees.front()->IsMultiTarget() ||
+      hist_maker_param_.quantize_gradient || hist_maker_param_.deterministic_histogram ||
+      hist_maker_param_.feature_parallel ||
+      param_.subsample < 1.0f) {
+    TreeUpdater::UpdateFused(gpair, source, dmat, trees);
+    return;
+  }
+  this->UpdateImpl(gpair, dmat, trees, &source);
+}
+
+void QuantileHistMaker::UpdateImpl(HostDeviceVector<GradientPair> *gpair, DMatrix *dmat,
+                                   const std::vector<RegTree *> &trees,
+                                   GradientSource const *source) {
+  auto it = dmat->GetBatches<GHistIndexMatrix>(HistBatch(param_)).begin();
   auto p_gmat = it.Page();
-  if (dmat != p_last_dmat_ || is_gmat_initialized_ == false) {
-    updater_monitor_.Start("GmatInitialization");
-    column_matrix_.Init(*p_gmat, param_.sparse_threshold);
-    updater_monitor_.Stop("GmatInitialization");
-    // A proper solution is puting cut matrix in DMatrix, see:
-    // https://github.com/dmlc/xgboost/issues/5143
-    is_gmat_initialized_ = true;
+  // The column matrix is cached in the gradient index, shared by all boosters using the
+  // same DMatrix.
+  updater_monitor_.Start("GmatInitialization");
+  auto p_columns = p_gmat->Columns(param_.sparse_threshold);
+  updater_monitor_.Stop("GmatInitialization");
+  // Prediction with the quantized data doesn't support multi-target trees or mixed bins.
+  if (hist_maker_param_.release_raw_data && !trees.empty() &&
+      !trees.front()->IsMultiTarget() && !p_gmat->index.IsMixed()) {
+    dmat->ReleaseRawData();
   }
   // rescale learning rate according to size of trees
   float lr = param_.learning_rate;
@@ -87,26 +852,64 @@ void QuantileHistMaker::Update(HostDeviceVector<GradientPair> *gpair,
 
   // build tree
   const size_t n_trees = trees.size();
-  if (hist_maker_param_.single_precision_histogram) {
+  bool feature_parallel = hist_maker_param_.feature_parallel && !trees.empty() &&
+                          !trees.front()->IsMultiTarget() &&
+                          FeatureParallelHistBuilder::Supported(param_, dmat->Info(), *p_gmat);
+  if (hist_maker_param_.feature_parallel && !feature_parallel) {
+    LOG(WARNING) << "`feature_parallel` is not supported with distributed training, external "
+                    "memory, categorical data, feature constraints, gradient based sampling "
+                    "or multi-target trees.";
+  }
+  if (!feature_parallel) {
+    // Prediction cache must be updated by the builder of the last tree.
+    feature_parallel_builder_.reset();
+  }
+  if (feature_parallel) {
+    if (!feature_parallel_builder_) {
+      feature_parallel_builder_.reset(new FeatureParallelHistBuilder{param_});
+    }
+    for (auto tree : trees) {
+      feature_parallel_builder_->Update(*p_gmat, *p_columns, gpair, dmat, tree);
+    }
+  } else if (!trees.empty() && trees.front()->IsMultiTarget()) {
+    if (!multi_target_builder_) {
+      multi_target_builder_.reset(new MultiTargetHistBuilder{param_});
+    }
+    for (auto tree : trees) {
+      multi_target_builder_->Update(*p_gmat, gpair, dmat, tree);
+    }
+  } else if (hist_maker_param_.quantize_gradient) {
+    if (!quantized_builder_) {
+      this->SetBuilder(n_trees, &quantized_builder_, dmat);
+    }
+    CallBuilderUpdate(quantized_builder_, &quantized_workers_, gpair, dmat, *p_gmat, *p_columns,
+                      trees, source);
+  } else if (hist_maker_param_.single_precision_histogram &&
+             !hist_maker_param_.deterministic_histogram) {
     if (!float_builder_) {
       this->SetBuilder(n_trees, &float_builder_, dmat);
     }
-    CallBuilderUpdate(float_builder_, gpair, dmat, *p_gmat, trees);
+    CallBuilderUpdate(float_builder_, &float_workers_, gpair, dmat, *p_gmat, *p_columns, trees,
+                      source);
   } else {
     if (!double_builder_) {
       SetBuilder(n_trees, &double_builder_, dmat);
     }
-    CallBuilderUpdate(double_builder_, gpair, dmat, *p_gmat, trees);
+    CallBuilderUpdate(double_builder_, &double_workers_, gpair, dmat, *p_gmat, *p_columns, trees,
+                      source);
   }
 
   param_.learning_rate = lr;
-
-  p_last_dmat_ = dmat;
 }
 
 bool QuantileHistMaker::UpdatePredictionCache(
     const DMatrix* data, linalg::VectorView<float> out_preds) {
-  if (hist_maker_param_.single_precision_histogram && float_builder_) {
+  if (feature_parallel_builder_) {
+    return feature_parallel_builder_->UpdatePredictionCache(data, out_preds);
+  } else if (hist_maker_param_.quantize_gradient && quantized_builder_) {
+      return quantized_builder_->UpdatePredictionCache(data, out_preds);
+  } else if (hist_maker_param_.single_precision_histogram &&
+             !hist_maker_param_.deterministic_histogram && float_builder_) {
       return float_builder_->UpdatePredictionCache(data, out_preds);
   } else if (double_builder_) {
       return double_builder_->UpdatePredictionCache(data, out_preds);
@@ -115,40 +918,63 @@ bool QuantileHistMaker::UpdatePredictionCache(
   }
 }
 
+bool QuantileHistMaker::UpdateMultiTargetPredictionCache(const DMatrix* data,
+                                                         linalg::MatrixView<float> out_preds) {
+  if (!multi_target_builder_) {
+    return false;
+  }
+  return multi_target_builder_->UpdatePredictionCache(data, out_preds);
+}
+
 
 template <typename GradientSumT>
 template <bool any_missing>
 void QuantileHistMaker::Builder<GradientSumT>::InitRoot(
-    DMatrix *p_fmat, RegTree *p_tree, const std::vector<GradientPair> &gpair_h,
-    int *num_leaves, std::vector<CPUExpandEntry> *expand) {
+    DMatrix *p_fmat, const ColumnMatrix &column_matrix, RegTree *p_tree,
+    const std::vector<GradientPair> &gpair_h, int *num_leaves,
+    std::vector<CPUExpandEntry> *expand) {
   CPUExpandEntry node(RegTree::kRoot, p_tree->GetDepth(0), 0.0f);
 
   nodes_for_explicit_hist_build_.clear();
   nodes_for_subtraction_trick_.clear();
   nodes_for_explicit_hist_build_.push_back(node);
 
-  size_t page_id = 0;
-  for (auto const &gidx : p_fmat->GetBatches<GHistIndexMatrix>(
-           {GenericParameter::kCpuId, param_.max_bin})) {
-    this->histogram_builder_->BuildHist(
-        page_id, gidx, p_tree, row_set_collection_,
-        nodes_for_explicit_hist_build_, nodes_for_subtraction_trick_, gpair_h);
-    ++page_id;
+  builder_monitor_.Start("BuildHist");
+  auto hist_trial = tuner_.Start(common::ThreadTuner::kHistogram,
+                                 row_set_collection_[RegTree::kRoot].Size());
+  this->histogram_builder_->SetThreads(hist_trial.n_threads);
+  if (gradient_source_) {
+    auto const &gidx = *p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_)).begin();
+    this->histogram_builder_->BuildRootHist(this->HistIndex(gidx), p_tree, row_set_collection_,
+                                            node, gpair_h, *gradient_source_);
+  } else {
+    size_t page_id = 0;
+    for (auto const &gidx : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
+      this->histogram_builder_->BuildHist(
+          page_id, this->HistIndex(gidx), p_tree, row_set_collection_,
+          nodes_for_explicit_hist_build_, nodes_for_subtraction_trick_, gpair_h,
+          &column_matrix);
+      ++page_id;
+    }
   }
+  tuner_.Stop(hist_trial);
+  builder_monitor_.Stop("BuildHist");
 
   {
     auto nid = RegTree::kRoot;
     GHistRowT hist = this->histogram_builder_->Histogram()[nid];
     GradientPairT grad_stat;
-    if (data_layout_ == DataLayout::kDenseDataZeroBased ||
-        data_layout_ == DataLayout::kDenseDataOneBased) {
-      auto const &gmat = *(p_fmat
-                               ->GetBatches<GHistIndexMatrix>(BatchParam{
-                                   GenericParameter::kCpuId, param_.max_bin})
-                               .begin());
+    // Bins of the chosen feature are not available on all workers with reduce-scatter.
+    if ((data_layout_ == DataLayout::kDenseDataZeroBased ||
+         data_layout_ == DataLayout::kDenseDataOneBased) &&
+        !this->histogram_builder_->IsReduceScatter()) {
+      auto const &gmat =
+          this->HistIndex(*(p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_)).begin()));
       const std::vector<uint32_t> &row_ptr = gmat.cut.Ptrs();
-      const uint32_t ibegin = row_ptr[fid_least_bins_];
-      const uint32_t iend = row_ptr[fid_least_bins_ + 1];
+      // Each bundle covers all rows as well, so does each feature in the column subset.
+      auto fidx = (bundles_ || use_column_subset_) ? 0 : fid_least_bins_;
+      const uint32_t ibegin = row_ptr[fidx];
+      const uint32_t iend = row_ptr[fidx + 1];
       auto begin = hist.data();
       for (uint32_t i = ibegin; i < iend; ++i) {
         const GradientPairT et = begin[i];
@@ -163,20 +989,23 @@ void QuantileHistMaker::Builder<GradientSumT>::InitRoot(
           reinterpret_cast<GradientSumT *>(&grad_stat), 2);
     }
 
-    auto weight = evaluator_->InitRoot(GradStats{grad_stat});
-    p_tree->Stat(RegTree::kRoot).sum_hess = grad_stat.GetHess();
+    auto root_sum = quantizer_.ToFloatingPoint(grad_stat);
+    auto weight = evaluator_->InitRoot(root_sum);
+    p_tree->Stat(RegTree::kRoot).sum_hess = root_sum.GetHess();
     p_tree->Stat(RegTree::kRoot).base_weight = weight;
     (*p_tree)[RegTree::kRoot].SetLeaf(param_.learning_rate * weight);
 
     std::vector<CPUExpandEntry> entries{node};
     builder_monitor_.Start("EvaluateSplits");
     auto ft = p_fmat->Info().feature_types.ConstHostSpan();
-    for (auto const &gmat : p_fmat->GetBatches<GHistIndexMatrix>(
-             BatchParam{GenericParameter::kCpuId, param_.max_bin})) {
+    auto eval_trial = tuner_.Start(common::ThreadTuner::kEvaluate, entries.size());
+    evaluator_->SetThreads(eval_trial.n_threads);
+    for (auto const &gmat : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
       evaluator_->EvaluateSplits(histogram_builder_->Histogram(), gmat.cut, ft,
                                  *p_tree, &entries);
       break;
     }
+    tuner_.Stop(eval_trial);
     builder_monitor_.Stop("EvaluateSplits");
     node = entries.front();
   }
@@ -243,17 +1072,26 @@ void QuantileHistMaker::Builder<GradientSumT>::ExpandTree(
   builder_monitor_.Start("ExpandTree");
   int num_leaves = 0;
 
-  Driver<CPUExpandEntry> driver(static_cast<TrainParam::TreeGrowPolicy>(param_.grow_policy));
+  Driver<CPUExpandEntry> driver(static_cast<TrainParam::TreeGrowPolicy>(param_.grow_policy),
+                                hist_param_.lossguide_batch_size);
   std::vector<CPUExpandEntry> expand;
-  InitRoot<any_missing>(p_fmat, p_tree, gpair_h, &num_leaves, &expand);
+  InitRoot<any_missing>(p_fmat, column_matrix, p_tree, gpair_h, &num_leaves, &expand);
   driver.Push(expand[0]);
 
   int32_t depth = 0;
   while (!driver.IsEmpty()) {
     expand = driver.Pop();
-    depth = expand[0].depth + 1;
-    std::vector<CPUExpandEntry> nodes_for_apply_split;
-    std::vector<CPUExpandEntry> nodes_to_evaluate;
+    // Nodes in a batch might have different depths with lossguide, histograms are needed
+    // as long as any of the children can be split.
+    depth = std::min_element(expand.cbegin(), expand.cend(),
+                             [](CPUExpandEntry const& l, CPUExpandEntry const& r) {
+                               return l.depth < r.depth;
+                             })->depth + 1;
+    // Reuse capacity of the previous iterations.
+    auto& nodes_for_apply_split = nodes_for_apply_split_;
+    auto& nodes_to_evaluate = nodes_to_evaluate_;
+    nodes_for_apply_split.clear();
+    nodes_to_evaluate.clear();
     nodes_for_explicit_hist_build_.clear();
     nodes_for_subtraction_trick_.clear();
 
@@ -264,15 +1102,23 @@ void QuantileHistMaker::Builder<GradientSumT>::ExpandTree(
       SplitSiblings(nodes_for_apply_split, &nodes_to_evaluate, p_tree);
 
       if (depth < param_.max_depth) {
+        builder_monitor_.Start("BuildHist");
+        size_t n_rows = 0;
+        for (auto const &entry : nodes_for_explicit_hist_build_) {
+          n_rows += row_set_collection_[entry.nid].Size();
+        }
+        auto hist_trial = tuner_.Start(common::ThreadTuner::kHistogram, n_rows);
+        this->histogram_builder_->SetThreads(hist_trial.n_threads);
         size_t i = 0;
-        for (auto const &gidx : p_fmat->GetBatches<GHistIndexMatrix>(
-                 {GenericParameter::kCpuId, param_.max_bin})) {
+        for (auto const &gidx : p_fmat->GetBatches<GHistIndexMatrix>(HistBatch(param_))) {
           this->histogram_builder_->BuildHist(
-              i, gidx, p_tree, row_set_collection_,
+              i, this->HistIndex(gidx), p_tree, row_set_collection_,
               nodes_for_explicit_hist_build_, nodes_for_subtraction_trick_,
-              gpair_h);
+              gpair_h, &column_matrix);
           ++i;
         }
+        tuner_.Stop(hist_trial);
+        builder_monitor_.Stop("BuildHist");
       } else {
         int starting_index = std::numeric_limits<int>::max();
         int sync_count = 0;
@@ -283,8 +1129,11 @@ void QuantileHistMaker::Builder<GradientSumT>::ExpandTree(
 
       builder_monitor_.Start("EvaluateSplits");
       auto ft = p_fmat->Info().feature_types.ConstHostSpan();
+      auto eval_trial = tuner_.Start(common::ThreadTuner::kEvaluate, nodes_to_evaluate.size());
+      evaluator_->SetThreads(eval_trial.n_threads);
       evaluator_->EvaluateSplits(this->histogram_builder_->Histogram(),
                                  gmat.cut, ft, *p_tree, &nodes_to_evaluate);
+      tuner_.Stop(eval_trial);
       builder_monitor_.Stop("EvaluateSplits");
 
       for (size_t i = 0; i < nodes_for_apply_split.size(); ++i) {
@@ -303,12 +1152,17 @@ void QuantileHistMaker::Builder<GradientSumT>::Update(
     const GHistIndexMatrix &gmat,
     const ColumnMatrix &column_matrix,
     HostDeviceVector<GradientPair> *gpair,
-    DMatrix *p_fmat, RegTree *p_tree) {
+    DMatrix *p_fmat, RegTree *p_tree, GradientSource const* source) {
   builder_monitor_.Start("Update");
+  CHECK(!source || (GetNumberOfTrees() == 1 && !std::is_integral<GradientSumT>::value));
+  arena_.Reset();
+  gradient_source_ = source;
 
   std::vector<GradientPair>* gpair_ptr = &(gpair->HostVector());
-  // in case 'num_parallel_trees != 1' no posibility to change initial gpair
-  if (GetNumberOfTrees() != 1) {
+  // in case 'num_parallel_trees != 1' no posibility to change initial gpair, quantized
+  // and rounded gradient is only used for building histograms.
+  if (GetNumberOfTrees() != 1 || std::is_integral<GradientSumT>::value ||
+      hist_param_.deterministic_histogram) {
     gpair_local_.resize(gpair_ptr->size());
     gpair_local_ = *gpair_ptr;
     gpair_ptr = &gpair_local_;
@@ -322,7 +1176,8 @@ void QuantileHistMaker::Builder<GradientSumT>::Update(
   } else {
     ExpandTree<false>(gmat, column_matrix, p_fmat, p_tree, *gpair_ptr);
   }
-  pruner_->Update(gpair, p_fmat, std::vector<RegTree*>{p_tree});
+  gradient_source_ = nullptr;
+  syncher_->Update(gpair, p_fmat, std::vector<RegTree*>{p_tree});
 
   builder_monitor_.Stop("Update");
 }
@@ -342,31 +1197,71 @@ bool QuantileHistMaker::Builder<GradientSumT>::UpdatePredictionCache(
   CHECK_GT(out_preds.Size(), 0U);
 
   size_t n_nodes = row_set_collection_.end() - row_set_collection_.begin();
+  // Leaf value of each row set, looked up once instead of in every block.
+  std::vector<bst_float> leaf_values(n_nodes, 0.0f);
+  for (size_t node = 0; node < n_nodes; ++node) {
+    const RowSetCollection::Elem rowset = row_set_collection_[node];
+    if (rowset.begin == nullptr || rowset.end == nullptr) {
+      continue;
+    }
+    int nid = rowset.node_id;
+    // if a node is marked as deleted by the pruner, traverse upward to locate
+    // a non-deleted leaf.
+    if ((*p_last_tree_)[nid].IsDeleted()) {
+      while ((*p_last_tree_)[nid].IsDeleted()) {
+        nid = (*p_last_tree_)[nid].Parent();
+      }
+      CHECK((*p_last_tree_)[nid].IsLeaf());
+    }
+    leaf_values[node] = (*p_last_tree_)[nid].LeafValue();
+  }
 
   common::BlockedSpace2d space(n_nodes, [&](size_t node) {
     return row_set_collection_[node].Size();
   }, 1024);
   CHECK_EQ(out_preds.DeviceIdx(), GenericParameter::kCpuId);
-  common::ParallelFor2d(space, this->nthread_, [&](size_t node, common::Range1d r) {
+  auto trial = tuner_.Start(common::ThreadTuner::kPredictionCache, out_preds.Size());
+  common::ParallelFor2d(space, trial.n_threads, [&](size_t node, common::Range1d r) {
     const RowSetCollection::Elem rowset = row_set_collection_[node];
     if (rowset.begin != nullptr && rowset.end != nullptr) {
-      int nid = rowset.node_id;
-      bst_float leaf_value;
-      // if a node is marked as deleted by the pruner, traverse upward to locate
-      // a non-deleted leaf.
-      if ((*p_last_tree_)[nid].IsDeleted()) {
-        while ((*p_last_tree_)[nid].IsDeleted()) {
-          nid = (*p_last_tree_)[nid].Parent();
-        }
-        CHECK((*p_last_tree_)[nid].IsLeaf());
-      }
-      leaf_value = (*p_last_tree_)[nid].LeafValue();
-
+      auto leaf_value = leaf_values[node];
       for (const size_t* it = rowset.begin + r.begin(); it < rowset.begin + r.end(); ++it) {
         out_preds(*it) += leaf_value;
       }
     }
   });
+  tuner_.Stop(trial);
+
+  if (!unused_rows_.empty()) {
+    // Rows excluded from the row set are not partitioned, walk the tree with their bins
+    // using the same split conditions as `ApplySplit`.
+    auto const& tree = *p_last_tree_;
+    auto const& gmat =
+        *(p_last_fmat_mutable_->GetBatches<GHistIndexMatrix>(HistBatch(param_)).begin());
+    auto n_tree_nodes = static_cast<bst_node_t>(tree.GetNodes().size());
+    std::vector<CPUExpandEntry> nodes;
+    for (bst_node_t nid = 0; nid < n_tree_nodes; ++nid) {
+      if (!tree[nid].IsLeaf() && !tree[nid].IsDeleted()) {
+        nodes.emplace_back(nid, tree.GetDepth(nid), 0.0f);
+      }
+    }
+    std::vector<int32_t> split_bins(n_tree_nodes, -1);
+    std::vector<int32_t> conditions(nodes.size());
+    this->FindSplitConditions(nodes, tree, gmat, common::Span<int32_t>{conditions});
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      split_bins[nodes[i].nid] = conditions[i];
+    }
+    common::ParallelFor(unused_rows_.size(), this->nthread_, [&](size_t i) {
+      auto ridx = unused_rows_[i];
+      bst_node_t nid = RegTree::kRoot;
+      while (!tree[nid].IsLeaf()) {
+        auto bin = RowBin(gmat, ridx, tree[nid].SplitIndex());
+        bool go_left = bin < 0 ? tree[nid].DefaultLeft() : bin <= split_bins[nid];
+        nid = go_left ? tree[nid].LeftChild() : tree[nid].RightChild();
+      }
+      out_preds(ridx) += tree[nid].LeafValue();
+    });
+  }
 
   builder_monitor_.Stop("UpdatePredictionCache");
   return true;
@@ -375,7 +1270,7 @@ bool QuantileHistMaker::Builder<GradientSumT>::UpdatePredictionCache(
 template<typename GradientSumT>
 void QuantileHistMaker::Builder<GradientSumT>::InitSampling(const DMatrix& fmat,
                                                 std::vector<GradientPair>* gpair,
-                                                std::vector<size_t>* row_indices) {
+                                                common::RowSetCollection::Indices*) {
   const auto& info = fmat.Info();
   auto& rnd = common::GlobalRandom();
   std::vector<GradientPair>& gpair_ref = *gpair;
@@ -398,7 +1293,7 @@ void QuantileHistMaker::Builder<GradientSumT>::InitSampling(const DMatrix& fmat,
   #pragma omp parallel num_threads(nthread)
   {
     exc.Run([&]() {
-      const size_t tid = omp_get_thread_num();
+      const size_t tid = common::ThreadIdx();
       const size_t ibegin = tid * discard_size;
       const size_t iend = (tid == (nthread - 1)) ?
                           info.num_row_ : ibegin + discard_size;
@@ -410,6 +1305,74 @@ void QuantileHistMaker::Builder<GradientSumT>::InitSampling(const DMatrix& fmat,
   exc.Rethrow();
 #endif  // XGBOOST_CUSTOMIZE_GLOBAL_PRNG
 }
+template <typename GradientSumT>
+void QuantileHistMaker::Builder<GradientSumT>::InitGradientBasedSampling(
+    std::vector<GradientPair> *gpair, common::Span<uint8_t> sampled) {
+  auto &h_gpair = *gpair;
+  size_t n_rows = h_gpair.size();
+  CHECK_EQ(sampled.size(), n_rows);
+  // Rows with negative hessian are never sampled.
+  auto abs_grad = arena_.Alloc<float>(n_rows);
+  common::ParallelFor(n_rows, this->nthread_, [&](size_t i) {
+    abs_grad[i] = h_gpair[i].GetHess() >= 0.0f ? std::abs(h_gpair[i].GetGrad()) : -1.0f;
+  });
+  size_t n_valid = std::count_if(abs_grad.cbegin(), abs_grad.cend(),
+                                 [](float g) { return g >= 0.0f; });
+  size_t n_sample = std::max<size_t>(std::lround(param_.subsample * n_valid),
+                                     std::min<size_t>(n_valid, 1));
+  size_t n_top = static_cast<size_t>(hist_param_.goss_top_rate * n_sample);
+  size_t n_rand = n_sample - n_top;
+
+  // Rows with absolute gradient greater than the threshold are kept, ties with the
+  // threshold fill the remaining slots of `n_top` in the order of rows.
+  float threshold = std::numeric_limits<float>::infinity();
+  if (n_top != 0) {
+    auto sorted = arena_.Alloc<float>(n_rows);
+    std::copy(abs_grad.cbegin(), abs_grad.cend(), sorted.begin());
+    std::nth_element(sorted.begin(), sorted.begin() + (n_rows - n_top), sorted.end());
+    threshold = sorted[n_rows - n_top];
+  }
+  size_t n_greater = std::count_if(abs_grad.cbegin(), abs_grad.cend(),
+                                   [&](float g) { return g > threshold; });
+  size_t n_rest = n_valid - n_top;
+  double prob = n_rest == 0 ? 0.0 : static_cast<double>(n_rand) / static_cast<double>(n_rest);
+  float amplify = prob > 0.0 ? static_cast<float>(1.0 / prob) : 0.0f;
+
+  // Fixed size blocks with their own engines, the sample doesn't depend on the number of
+  // threads.
+  size_t constexpr kBlockSize = 4096;
+  auto seed = common::GlobalRandom()();
+  size_t n_blocks = common::DivRoundUp(n_rows, kBlockSize);
+  auto ties = arena_.Alloc<size_t>(n_blocks + 1);
+  common::ParallelFor(n_blocks, this->nthread_, [&](size_t block) {
+    size_t end = std::min(n_rows, (block + 1) * kBlockSize);
+    ties[block + 1] = std::count(abs_grad.cbegin() + block * kBlockSize,
+                                 abs_grad.cbegin() + end, threshold);
+  });
+  std::partial_sum(ties.cbegin(), ties.cend(), ties.begin());
+  common::ParallelFor(n_blocks, this->nthread_, [&](size_t block) {
+    std::minstd_rand eng(static_cast<std::minstd_rand::result_type>(seed + block));
+    std::bernoulli_distribution coin_flip(std::min(prob, 1.0));
+    size_t n_ties = ties[block];
+    size_t end = std::min(n_rows, (block + 1) * kBlockSize);
+    for (size_t i = block * kBlockSize; i < end; ++i) {
+      bool is_top = abs_grad[i] > threshold ||
+                    (abs_grad[i] == threshold && n_greater + n_ties++ < n_top);
+      if (abs_grad[i] < 0.0f) {
+        sampled[i] = 0;
+      } else if (is_top) {
+        sampled[i] = 1;
+      } else if (coin_flip(eng)) {
+        sampled[i] = 1;
+        h_gpair[i] = GradientPair{h_gpair[i].GetGrad() * amplify,
+                                  h_gpair[i].GetHess() * amplify};
+      } else {
+        sampled[i] = 0;
+      }
+    }
+  });
+}
+
 template<typename GradientSumT>
 size_t QuantileHistMaker::Builder<GradientSumT>::GetNumberOfTrees() {
   return n_trees_;
@@ -432,9 +1395,6 @@ void QuantileHistMaker::Builder<GradientSumT>::InitData(
   {
     // initialize the row set
     row_set_collection_.Clear();
-    // initialize histogram collection
-    uint32_t nbins = gmat.cut.Ptrs().back();
-    // initialize histogram builder
     dmlc::OMPException exc;
 #pragma omp parallel
     {
@@ -443,19 +1403,23 @@ void QuantileHistMaker::Builder<GradientSumT>::InitData(
       });
     }
     exc.Rethrow();
-    this->histogram_builder_->Reset(
-        nbins, BatchParam{GenericParameter::kCpuId, param_.max_bin},
-        this->nthread_, 1, rabit::IsDistributed());
+    tuner_.Init(this->nthread_, hist_param_.tune_threads);
 
-    std::vector<size_t>& row_indices = *row_set_collection_.Data();
+    auto& row_indices = *row_set_collection_.Data();
     row_indices.resize(info.num_row_);
     size_t* p_row_indices = row_indices.data();
     // mark subsample and build list of member rows
 
-    if (param_.subsample < 1.0f) {
-      CHECK_EQ(param_.sampling_method, TrainParam::kUniform)
-        << "Only uniform sampling is supported, "
-        << "gradient-based sampling is only support by GPU Hist.";
+    unused_rows_.clear();
+    // Whether each row is chosen by gradient-based sampling.
+    common::Span<uint8_t> sampled;
+    if (param_.subsample < 1.0f &&
+        param_.sampling_method == TrainParam::kGradientBased) {
+      builder_monitor_.Start("InitSampling");
+      sampled = arena_.Alloc<uint8_t>(info.num_row_);
+      InitGradientBasedSampling(gpair, sampled);
+      builder_monitor_.Stop("InitSampling");
+    } else if (param_.subsample < 1.0f) {
       builder_monitor_.Start("InitSampling");
       InitSampling(fmat, gpair, &row_indices);
       builder_monitor_.Stop("InitSampling");
@@ -463,42 +1427,48 @@ void QuantileHistMaker::Builder<GradientSumT>::InitData(
       // We should check that the partitioning was done correctly
       // and each row of the dataset fell into exactly one of the categories
     }
-    common::MemStackAllocator<bool, 128> buff(this->nthread_);
-    bool* p_buff = buff.Get();
-    std::fill(p_buff, p_buff + this->nthread_, false);
 
     const size_t block_size = info.num_row_ / this->nthread_ + !!(info.num_row_ % this->nthread_);
+    // Gradient is not available yet if it's computed during building the root histogram,
+    // objectives producing it guarantee non-negative hessian.
+    bool has_neg_hess = false;
+    if (!gradient_source_) {
+      bool* p_buff = arena_.Alloc<bool>(this->nthread_, false).data();
 
-    #pragma omp parallel num_threads(this->nthread_)
-    {
-      exc.Run([&]() {
-        const size_t tid = omp_get_thread_num();
-        const size_t ibegin = tid * block_size;
-        const size_t iend = std::min(static_cast<size_t>(ibegin + block_size),
-            static_cast<size_t>(info.num_row_));
-
-        for (size_t i = ibegin; i < iend; ++i) {
-          if ((*gpair)[i].GetHess() < 0.0f) {
-            p_buff[tid] = true;
-            break;
+      #pragma omp parallel num_threads(this->nthread_)
+      {
+        exc.Run([&]() {
+          const size_t tid = common::ThreadIdx();
+          const size_t ibegin = tid * block_size;
+          const size_t iend = std::min(static_cast<size_t>(ibegin + block_size),
+              static_cast<size_t>(info.num_row_));
+
+          for (size_t i = ibegin; i < iend; ++i) {
+            if ((*gpair)[i].GetHess() < 0.0f) {
+              p_buff[tid] = true;
+              break;
+            }
           }
-        }
-      });
-    }
-    exc.Rethrow();
+        });
+      }
+      exc.Rethrow();
 
-    bool has_neg_hess = false;
-    for (int32_t tid = 0; tid < this->nthread_; ++tid) {
-      if (p_buff[tid]) {
-        has_neg_hess = true;
+      for (int32_t tid = 0; tid < this->nthread_; ++tid) {
+        if (p_buff[tid]) {
+          has_neg_hess = true;
+        }
       }
     }
 
-    if (has_neg_hess) {
+    if (has_neg_hess || !sampled.empty()) {
+      // Excluded rows are skipped by histogram building and partitioning, their prediction
+      // cache is updated by walking the tree.
       size_t j = 0;
       for (size_t i = 0; i < info.num_row_; ++i) {
-        if ((*gpair)[i].GetHess() >= 0.0f) {
+        if (sampled.empty() ? (*gpair)[i].GetHess() >= 0.0f : sampled[i] != 0) {
           p_row_indices[j++] = i;
+        } else {
+          unused_rows_.push_back(i);
         }
       }
       row_indices.resize(j);
@@ -506,7 +1476,7 @@ void QuantileHistMaker::Builder<GradientSumT>::InitData(
       #pragma omp parallel num_threads(this->nthread_)
       {
         exc.Run([&]() {
-          const size_t tid = omp_get_thread_num();
+          const size_t tid = common::ThreadIdx();
           const size_t ibegin = tid * block_size;
           const size_t iend = std::min(static_cast<size_t>(ibegin + block_size),
               static_cast<size_t>(info.num_row_));
@@ -521,6 +1491,17 @@ void QuantileHistMaker::Builder<GradientSumT>::InitData(
 
   row_set_collection_.Init();
 
+  if (std::is_integral<GradientSumT>::value) {
+    builder_monitor_.Start("QuantizeGradient");
+    quantizer_ = GradientQuantizer{*gpair, this->nthread_};
+    quantizer_.Quantize(gpair, this->nthread_);
+    builder_monitor_.Stop("QuantizeGradient");
+  } else if (hist_param_.deterministic_histogram) {
+    builder_monitor_.Start("RoundGradient");
+    GradientRounding{*gpair, this->nthread_}.Round(gpair, this->nthread_);
+    builder_monitor_.Stop("RoundGradient");
+  }
+
   {
     /* determine layout of data */
     const size_t nrow = info.num_row_;
@@ -528,9 +1509,17 @@ void QuantileHistMaker::Builder<GradientSumT>::InitData(
     const size_t nnz = info.num_nonzero_;
     // number of discrete bins for feature 0
     const uint32_t nbins_f0 = gmat.cut.Ptrs()[1] - gmat.cut.Ptrs()[0];
+    missing_bins_.reset();
     if (nrow * ncol == nnz) {
       // dense data with zero-based indexing
       data_layout_ = DataLayout::kDenseDataZeroBased;
+    } else if (hist_param_.dense_missing_ratio > 0.0f && gmat.Size() == nrow &&
+               !rabit::IsDistributed() &&
+               static_cast<double>(nnz) >=
+                   hist_param_.dense_missing_ratio * static_cast<double>(nrow * ncol)) {
+      // mostly dense data, stored as dense with a missing bin for each feature
+      missing_bins_ = gmat.MissingBins(this->nthread_);
+      data_layout_ = DataLayout::kDenseDataZeroBased;
     } else if (nbins_f0 == 0 && nrow * (ncol - 1) == nnz) {
       // dense data with one-based indexing
       data_layout_ = DataLayout::kDenseDataOneBased;
@@ -548,12 +1537,69 @@ void QuantileHistMaker::Builder<GradientSumT>::InitData(
     evaluator_.reset(new HistEvaluator<GradientSumT, CPUExpandEntry>{
         param_, info, this->nthread_, column_sampler_, task_, false});
   }
+  evaluator_->SetQuantizer(quantizer_);
+
+  {
+    // initialize histogram builder, histograms are built on bundled features, or on
+    // features sampled for this tree, when the index is dense with a single page.
+    bool reduce_scatter = hist_param_.reduce_scatter_hist && rabit::IsDistributed() &&
+                          rabit::GetWorldSize() > 1;
+    bool single_page = gmat.IsDense() && gmat.Size() == info.num_row_;
+    uint32_t nbins =
+        missing_bins_ ? missing_bins_->Index().cut.TotalBins() : gmat.cut.Ptrs().back();
+    bundles_.reset();
+    use_column_subset_ = false;
+    if (hist_param_.feature_bundling && single_page && !rabit::IsDistributed()) {
+      auto bundles = gmat.Bundles(info.feature_types.ConstHostSpan(), this->nthread_);
+      if (bundles->NumBundles() < bundles->NumFeatures()) {
+        bundles_ = std::move(bundles);
+        nbins = bundles_->Index().cut.TotalBins();
+      }
+    }
+    if (!bundles_ && param_.colsample_bytree < 1.0f && single_page && !reduce_scatter &&
+        !gmat.index.IsMixed()) {
+      // The feature set is synchronized among workers, so are the histogram bins.
+      builder_monitor_.Start("InitColumnSubset");
+      if (!column_subset_) {
+        column_subset_.reset(new common::ColumnSubset);
+      }
+      auto features = column_sampler_->GetTreeFeatureSet()->ConstHostSpan();
+      column_subset_->Init(gmat, features, this->nthread_);
+      use_column_subset_ = true;
+      nbins = column_subset_->Index().cut.TotalBins();
+      builder_monitor_.Stop("InitColumnSubset");
+    }
+    this->histogram_builder_->Reset(
+        nbins, HistBatch(param_),
+        this->nthread_, 1, rabit::IsDistributed(), hist_param_.max_cached_hist_bytes,
+        hist_param_.sparse_hist_ratio, hist_param_.sparse_sync_ratio,
+        hist_param_.sync_single_precision, hist_param_.node_sweep_ratio);
+    bool compensated =
+        std::is_same<GradientSumT, float>::value && hist_param_.compensated_histogram;
+    this->histogram_builder_->SetBlockRows(
+        compensated ? HistogramBuilder<GradientSumT, CPUExpandEntry>::kFloatBlockRows : 0);
+  }
+  evaluator_->SetBundles(bundles_.get());
+  evaluator_->SetColumnSubset(use_column_subset_ ? column_subset_.get() : nullptr);
+  evaluator_->SetMissingBins(missing_bins_.get());
+  if (hist_param_.reduce_scatter_hist && rabit::IsDistributed() &&
+      rabit::GetWorldSize() > 1) {
+    // Each worker evaluates a contiguous range of features with similar number of bins.
+    auto const &cut_ptrs = gmat.cut.Ptrs();
+    auto feature_ptr = PartitionFeatures(cut_ptrs, rabit::GetWorldSize());
+    std::vector<uint32_t> worker_bins(feature_ptr.size());
+    std::transform(feature_ptr.cbegin(), feature_ptr.cend(), worker_bins.begin(),
+                   [&](bst_feature_t fidx) { return cut_ptrs[fidx]; });
+    this->histogram_builder_->SetReduceScatter(std::move(worker_bins));
+    auto rank = rabit::GetRank();
+    evaluator_->SetFeatureRange(feature_ptr[rank], feature_ptr[rank + 1]);
+  }
 
   if (data_layout_ == DataLayout::kDenseDataZeroBased
       || data_layout_ == DataLayout::kDenseDataOneBased) {
     /* specialized code for dense data:
        choose the column that has a least positive number of discrete bins.
-       For dense data (with no missing value),
+       For dense data (with no missing value, or with missing bins),
        the sum of gradient histogram is equal to snode[nid] */
     const std::vector<uint32_t>& row_ptr = gmat.cut.Ptrs();
     const auto nfeature = static_cast<bst_uint>(row_ptr.size() - 1);
@@ -578,9 +1624,8 @@ void QuantileHistMaker::Builder<GradientSumT>::FindSplitConditions(
                                                      const std::vector<CPUExpandEntry>& nodes,
                                                      const RegTree& tree,
                                                      const GHistIndexMatrix& gmat,
-                                                     std::vector<int32_t>* split_conditions) {
-  const size_t n_nodes = nodes.size();
-  split_conditions->resize(n_nodes);
+                                                     common::Span<int32_t> split_conditions) {
+  CHECK_EQ(split_conditions.size(), nodes.size());
 
   for (size_t i = 0; i < nodes.size(); ++i) {
     const int32_t nid = nodes[i].nid;
@@ -598,7 +1643,7 @@ void QuantileHistMaker::Builder<GradientSumT>::FindSplitConditions(
         split_cond = static_cast<int32_t>(bound);
       }
     }
-    (*split_conditions)[i] = split_cond;
+    split_conditions[i] = split_cond;
   }
 }
 template <typename GradientSumT>
@@ -611,73 +1656,73 @@ void QuantileHistMaker::Builder<GradientSumT>::AddSplitsToRowSet(
     const size_t n_left = partition_builder_.GetNLeftElems(i);
     const size_t n_right = partition_builder_.GetNRightElems(i);
     CHECK_EQ((*p_tree)[nid].LeftChild() + 1, (*p_tree)[nid].RightChild());
-    row_set_collection_.AddSplit(nid, (*p_tree)[nid].LeftChild(),
+    row_set_collection_.AddSplitToAlternate(nid, (*p_tree)[nid].LeftChild(),
         (*p_tree)[nid].RightChild(), n_left, n_right);
   }
 }
 
 template <typename GradientSumT>
 template <bool any_missing>
-void QuantileHistMaker::Builder<GradientSumT>::ApplySplit(const std::vector<CPUExpandEntry> nodes,
+void QuantileHistMaker::Builder<GradientSumT>::ApplySplit(const std::vector<CPUExpandEntry>& nodes,
                                             const GHistIndexMatrix& gmat,
                                             const ColumnMatrix& column_matrix,
                                             RegTree* p_tree) {
   builder_monitor_.Start("ApplySplit");
   // 1. Find split condition for each split
   const size_t n_nodes = nodes.size();
-  std::vector<int32_t> split_conditions;
-  FindSplitConditions(nodes, *p_tree, gmat, &split_conditions);
+  auto split_conditions = arena_.Alloc<int32_t>(n_nodes);
+  FindSplitConditions(nodes, *p_tree, gmat, split_conditions);
   // 2.1 Create a blocked space of size SUM(samples in each node)
   common::BlockedSpace2d space(n_nodes, [&](size_t node_in_set) {
     int32_t nid = nodes[node_in_set].nid;
     return row_set_collection_[nid].Size();
   }, kPartitionBlockSize);
+  size_t n_rows = 0;
+  for (auto const& node : nodes) {
+    n_rows += row_set_collection_[node.nid].Size();
+  }
+  auto trial = tuner_.Start(common::ThreadTuner::kPartition, n_rows);
   // 2.2 Initialize the partition builder
-  // allocate buffers for storage intermediate results by each thread
   partition_builder_.Init(space.Size(), n_nodes, [&](size_t node_in_set) {
     const int32_t nid = nodes[node_in_set].nid;
     const size_t size = row_set_collection_[nid].Size();
     const size_t n_tasks = size / kPartitionBlockSize + !!(size % kPartitionBlockSize);
     return n_tasks;
   });
-  // 2.3 Split elements of row_set_collection_ to left and right child-nodes for each node
-  // Store results in intermediate buffers from partition_builder_
-  common::ParallelFor2d(space, this->nthread_, [&](size_t node_in_set, common::Range1d r) {
-    size_t begin = r.begin();
+  // 2.3 Record the decision for each row of each node into masks of partition_builder_
+  common::ParallelFor2dSteal(space, trial.n_threads, [&](size_t node_in_set, common::Range1d r) {
     const int32_t nid = nodes[node_in_set].nid;
-    const size_t task_id = partition_builder_.GetTaskIdx(node_in_set, begin);
-    partition_builder_.AllocateForTask(task_id);
-      switch (column_matrix.GetTypeSize()) {
+    switch (column_matrix.GetTypeSize()) {
       case common::kUint8BinsTypeSize:
-        partition_builder_.template Partition<uint8_t, any_missing>(node_in_set, nid, r,
+        partition_builder_.template PartitionToMask<uint8_t, any_missing>(node_in_set, nid, r,
                   split_conditions[node_in_set], column_matrix,
                   *p_tree, row_set_collection_[nid].begin);
         break;
       case common::kUint16BinsTypeSize:
-        partition_builder_.template Partition<uint16_t, any_missing>(node_in_set, nid, r,
+        partition_builder_.template PartitionToMask<uint16_t, any_missing>(node_in_set, nid, r,
                   split_conditions[node_in_set], column_matrix,
                   *p_tree, row_set_collection_[nid].begin);
         break;
       case common::kUint32BinsTypeSize:
-        partition_builder_.template Partition<uint32_t, any_missing>(node_in_set, nid, r,
+        partition_builder_.template PartitionToMask<uint32_t, any_missing>(node_in_set, nid, r,
                   split_conditions[node_in_set], column_matrix,
                   *p_tree, row_set_collection_[nid].begin);
         break;
       default:
         CHECK(false);  // no default behavior
     }
-    });
-  // 3. Compute offsets to copy blocks of row-indexes
-  // from partition_builder_ to row_set_collection_
-  partition_builder_.CalculateRowOffsets();
+  });
+  // 3. Compute offsets of each block in the children
+  partition_builder_.CalculateMaskOffsets();
 
-  // 4. Copy elements from partition_builder_ to row_set_collection_ back
-  // with updated row-indexes for each tree-node
-  common::ParallelFor2d(space, this->nthread_, [&](size_t node_in_set, common::Range1d r) {
+  // 4. Write row-indexes into the alternate storage of row_set_collection_ at their final
+  // positions, no copy back is needed.
+  common::ParallelFor2dSteal(space, trial.n_threads, [&](size_t node_in_set, common::Range1d r) {
     const int32_t nid = nodes[node_in_set].nid;
-    partition_builder_.MergeToArray(node_in_set, r.begin(),
-        const_cast<size_t*>(row_set_collection_[nid].begin));
+    partition_builder_.ScatterFromMask(node_in_set, r, row_set_collection_[nid].begin,
+                                       row_set_collection_.AlternateStorage(nid));
   });
+  tuner_.Stop(trial);
   // 5. Add info about splits into row_set_collection_
   AddSplitsToRowSet(nodes, p_tree);
   builder_monitor_.Stop("ApplySplit");
@@ -685,6 +1730,7 @@ void QuantileHistMaker::Builder<GradientSumT>::ApplySplit(const std::vector<CPUE
 
 template struct QuantileHistMaker::Builder<float>;
 template struct QuantileHistMaker::Builder<double>;
+template struct QuantileHistMaker::Builder<int64_t>;
 
 XGBOOST_REGISTER_TREE_UPDATER(FastHistMaker, "grow_fast_histmaker")
 .describe("(Deprecated, use grow_quantile_histmaker instead.)"
@@ -25,6 +25,7 @@
 #include "hist/histogram.h"
 #include "hist/expand_entry.h"
 #include "hist/param.h"
+#include "hist/quantizer.h"
 
 #include "constraints.h"
 #include "./param.h"
@@ -35,7 +36,12 @@
 #include "../common/hist_util.h"
 #include "../common/row_set.h"
 #include "../common/partition_builder.h"
+#include "../common/arena.h"
 #include "../common/column_matrix.h"
+#include "../common/column_subset.h"
+#include "../common/feature_bundle.h"
+#include "../common/missing_bin.h"
+#include "../common/thread_tuner.h"
 
 namespace xgboost {
 
@@ -92,20 +98,30 @@ using xgboost::common::GHistBuilder;
 using xgboost::common::ColumnMatrix;
 using xgboost::common::Column;
 
+class MultiTargetHistBuilder;
+class FeatureParallelHistBuilder;
+
 /*! \brief construct a tree using quantized feature values */
 class QuantileHistMaker: public TreeUpdater {
  public:
-  explicit QuantileHistMaker(ObjInfo task) : task_{task} {
-    updater_monitor_.Init("QuantileHistMaker");
-  }
+  explicit QuantileHistMaker(ObjInfo task);
+  ~QuantileHistMaker() override;
   void Configure(const Args& args) override;
 
   void Update(HostDeviceVector<GradientPair>* gpair,
               DMatrix* dmat,
               const std::vector<RegTree*>& trees) override;
+  /*!
+   * \brief Gradient is computed while building the root histogram when a single tree is
+   *        grown from all rows with floating point histogram.
+   */
+  void UpdateFused(HostDeviceVector<GradientPair>* gpair, GradientSource const& source,
+                   DMatrix* dmat, const std::vector<RegTree*>& trees) override;
 
   bool UpdatePredictionCache(const DMatrix *data,
                              linalg::VectorView<float> out_preds) override;
+  bool UpdateMultiTargetPredictionCache(const DMatrix *data,
+                                        linalg::MatrixView<float> out_preds) override;
 
   void LoadConfig(Json const& in) override {
     auto const& config = get<Object const>(in);
@@ -142,10 +158,6 @@ class QuantileHistMaker: public TreeUpdater {
   CPUHistMakerTrainParam hist_maker_param_;
   // training parameter
   TrainParam param_;
-  // column accessor
-  ColumnMatrix column_matrix_;
-  DMatrix const* p_last_dmat_ {nullptr};
-  bool is_gmat_initialized_ {false};
 
   // actual builder that runs the algorithm
   template<typename GradientSumT>
@@ -155,26 +167,30 @@ class QuantileHistMaker: public TreeUpdater {
     using GradientPairT = xgboost::detail::GradientPairInternal<GradientSumT>;
     // constructor
     explicit Builder(const size_t n_trees, const TrainParam& param,
-                     std::unique_ptr<TreeUpdater> pruner, DMatrix const* fmat, ObjInfo task)
+                     std::unique_ptr<TreeUpdater> syncher, DMatrix const* fmat, ObjInfo task)
         : n_trees_(n_trees),
           param_(param),
-          pruner_(std::move(pruner)),
+          syncher_(std::move(syncher)),
           p_last_tree_(nullptr),
           p_last_fmat_(fmat),
           histogram_builder_{new HistogramBuilder<GradientSumT, CPUExpandEntry>},
           task_{task} {
       builder_monitor_.Init("Quantile::Builder");
     }
-    // update one tree, growing
+    // update one tree, growing.  If `source` is not null, gradient is computed during
+    // building the root histogram.
     virtual void Update(const GHistIndexMatrix& gmat,
                         const ColumnMatrix& column_matrix,
                         HostDeviceVector<GradientPair>* gpair,
                         DMatrix* p_fmat,
-                        RegTree* p_tree);
+                        RegTree* p_tree,
+                        GradientSource const* source = nullptr);
 
     bool UpdatePredictionCache(const DMatrix* data,
                                linalg::VectorView<float> out_preds);
 
+    void SetHistParam(CPUHistMakerTrainParam const& param) { hist_param_ = param; }
+
    protected:
     // initialize temp data structure
     void InitData(const GHistIndexMatrix& gmat,
@@ -186,22 +202,32 @@ class QuantileHistMaker: public TreeUpdater {
 
     void InitSampling(const DMatrix& fmat,
                       std::vector<GradientPair>* gpair,
-                      std::vector<size_t>* row_indices);
+                      common::RowSetCollection::Indices* row_indices);
+    /*!
+     * \brief Gradient-based one-side sampling, rows with largest absolute gradient are
+     *        kept and the others are sampled uniformly with amplified gradient.
+     *
+     * \param sampled Output, whether each row is sampled.
+     */
+    void InitGradientBasedSampling(std::vector<GradientPair>* gpair,
+                                   common::Span<uint8_t> sampled);
 
     template <bool any_missing>
-    void ApplySplit(std::vector<CPUExpandEntry> nodes,
-                        const GHistIndexMatrix& gmat,
-                        const ColumnMatrix& column_matrix,
-                        RegTree* p_tree);
+    void ApplySplit(const std::vector<CPUExpandEntry>& nodes,
+                    const GHistIndexMatrix& gmat,
+                    const ColumnMatrix& column_matrix,
+                    RegTree* p_tree);
 
     void AddSplitsToRowSet(const std::vector<CPUExpandEntry>& nodes, RegTree* p_tree);
 
 
     void FindSplitConditions(const std::vector<CPUExpandEntry>& nodes, const RegTree& tree,
-                             const GHistIndexMatrix& gmat, std::vector<int32_t>* split_conditions);
+                             const GHistIndexMatrix& gmat,
+                             common::Span<int32_t> split_conditions);
 
     template <bool any_missing>
     void InitRoot(DMatrix* p_fmat,
+                  const ColumnMatrix& column_matrix,
                   RegTree *p_tree,
                   const std::vector<GradientPair> &gpair_h,
                   int *num_leaves, std::vector<CPUExpandEntry> *expand);
@@ -230,19 +256,40 @@ class QuantileHistMaker: public TreeUpdater {
     const TrainParam& param_;
     // number of omp thread used during training
     int nthread_;
+    // number of threads for each phase, chosen by measurement if tune_threads is set.
+    common::ThreadTuner tuner_;
     std::shared_ptr<common::ColumnSampler> column_sampler_{
         std::make_shared<common::ColumnSampler>()};
 
+    // rows excluded from the row set, e.g. not chosen by gradient-based sampling.
     std::vector<size_t> unused_rows_;
     // the internal row sets
     RowSetCollection row_set_collection_;
     std::vector<GradientPair> gpair_local_;
+    // computes gradient for the tree being built, null if gradient is already available.
+    GradientSource const* gradient_source_{nullptr};
+    // unit of quantized gradient, only used by integer histograms.
+    GradientQuantizer quantizer_;
+    // histograms are built on bundled features when set.
+    std::shared_ptr<common::FeatureBundles const> bundles_;
+    // histograms are built on features sampled for the tree when set, buffers of the
+    // subset are kept across trees.
+    std::unique_ptr<common::ColumnSubset> column_subset_;
+    bool use_column_subset_{false};
+    // histograms of data with missing values are built on a dense index when set.
+    std::shared_ptr<common::MissingBins const> missing_bins_;
+    GHistIndexMatrix const& HistIndex(GHistIndexMatrix const& gidx) const {
+      return bundles_             ? bundles_->Index()
+             : use_column_subset_ ? column_subset_->Index()
+             : missing_bins_      ? missing_bins_->Index()
+                                  : gidx;
+    }
 
     /*! \brief feature with least # of bins. to be used for dense specialization
                of InitNewNode() */
     uint32_t fid_least_bins_;
 
-    std::unique_ptr<TreeUpdater> pruner_;
+    std::unique_ptr<TreeUpdater> syncher_;
     std::unique_ptr<HistEvaluator<GradientSumT, CPUExpandEntry>> evaluator_;
 
     static constexpr size_t kPartitionBlockSize = 2048;
@@ -258,12 +305,18 @@ class QuantileHistMaker: public TreeUpdater {
     std::vector<CPUExpandEntry> nodes_for_subtraction_trick_;
     // list of nodes whose histograms would be built explicitly.
     std::vector<CPUExpandEntry> nodes_for_explicit_hist_build_;
+    // nodes split in current iteration and their children.
+    std::vector<CPUExpandEntry> nodes_for_apply_split_;
+    std::vector<CPUExpandEntry> nodes_to_evaluate_;
+    // temporary buffers of a single tree, reset at the beginning of each update.
+    common::Arena arena_;
 
     enum class DataLayout { kDenseDataZeroBased, kDenseDataOneBased, kSparseData };
     DataLayout data_layout_;
     std::unique_ptr<HistogramBuilder<GradientSumT, CPUExpandEntry>>
         histogram_builder_;
     ObjInfo task_;
+    CPUHistMakerTrainParam hist_param_;
 
     common::Monitor builder_monitor_;
   };
@@ -274,16 +327,33 @@ class QuantileHistMaker: public TreeUpdater {
 
   template<typename GradientSumT>
   void CallBuilderUpdate(const std::unique_ptr<Builder<GradientSumT>>& builder,
+                         std::vector<std::unique_ptr<Builder<GradientSumT>>>* workers,
                          HostDeviceVector<GradientPair> *gpair,
                          DMatrix *dmat,
                          GHistIndexMatrix const& gmat,
-                         const std::vector<RegTree *> &trees);
+                         ColumnMatrix const& column_matrix,
+                         const std::vector<RegTree *> &trees,
+                         GradientSource const* source);
+
+  void UpdateImpl(HostDeviceVector<GradientPair>* gpair, DMatrix* dmat,
+                  const std::vector<RegTree*>& trees, GradientSource const* source);
 
  protected:
   std::unique_ptr<Builder<float>> float_builder_;
   std::unique_ptr<Builder<double>> double_builder_;
-
-  std::unique_ptr<TreeUpdater> pruner_;
+  std::unique_ptr<Builder<int64_t>> quantized_builder_;
+  // additional builders for constructing trees of the same round concurrently.
+  std::vector<std::unique_ptr<Builder<float>>> float_workers_;
+  std::vector<std::unique_ptr<Builder<double>>> double_workers_;
+  std::vector<std::unique_ptr<Builder<int64_t>>> quantized_workers_;
+  // builder for trees with vector leaves
+  std::unique_ptr<MultiTargetHistBuilder> multi_target_builder_;
+  // builder parallelized over features, for wide data
+  std::unique_ptr<FeatureParallelHistBuilder> feature_parallel_builder_;
+
+  std::unique_ptr<TreeUpdater> syncher_;
+  // arguments used to configure synchers of additional builders.
+  Args args_;
   ObjInfo task_;
 };
 }  // namespace tree
@@ -7,20 +7,23 @@
 #include <rabit/rabit.h>
 #include <xgboost/tree_updater.h>
 
+#include <algorithm>
 #include <vector>
-#include <limits>
 
 #include "xgboost/json.h"
 #include "./param.h"
 #include "../common/io.h"
 #include "../common/threading_utils.h"
-#include "../predictor/predict_fn.h"
+#include "../predictor/flat_forest.h"
 
 namespace xgboost {
 namespace tree {
 
 DMLC_REGISTRY_FILE_TAG(updater_refresh);
 
+// number of rows filled into feature vectors at a time by each thread.
+constexpr size_t kBlockOfRowsSize = 64;
+
 /*! \brief pruner that prunes a tree after growing finishs */
 class TreeRefresher: public TreeUpdater {
  public:
@@ -47,57 +50,75 @@ class TreeRefresher: public TreeUpdater {
               const std::vector<RegTree*> &trees) override {
     if (trees.size() == 0) return;
     const std::vector<GradientPair> &gpair_h = gpair->ConstHostVector();
+    // Rows are walked through flattened trees, only statistics of leaves are accumulated
+    // and the rest are summed from leaves afterward.
+    predictor::FlatForest forest;
+    for (auto tree : trees) {
+      forest.Push(*tree);
+    }
+    const size_t n_leaves = forest.NumLeaves();
+    // Feature vectors only hold features used by the trees.
+    const bst_feature_t n_features = forest.NumUsedFeatures();
+    auto compact = forest.CompactIndex();
     // thread temporal space
     std::vector<std::vector<GradStats> > stemp;
     std::vector<RegTree::FVec> fvec_temp;
     // setup temp space for each thread
     const int nthread = omp_get_max_threads();
-    fvec_temp.resize(nthread, RegTree::FVec());
+    fvec_temp.resize(nthread * kBlockOfRowsSize, RegTree::FVec());
     stemp.resize(nthread, std::vector<GradStats>());
     dmlc::OMPException exc;
     #pragma omp parallel
     {
       exc.Run([&]() {
-        int tid = omp_get_thread_num();
-        int num_nodes = 0;
-        for (auto tree : trees) {
-          num_nodes += tree->param.num_nodes;
-        }
-        stemp[tid].resize(num_nodes, GradStats());
+        int tid = common::ThreadIdx();
+        stemp[tid].resize(n_leaves, GradStats());
         std::fill(stemp[tid].begin(), stemp[tid].end(), GradStats());
-        fvec_temp[tid].Init(trees[0]->param.num_feature);
+        for (size_t i = 0; i < kBlockOfRowsSize; ++i) {
+          fvec_temp[tid * kBlockOfRowsSize + i].Init(n_features);
+        }
       });
     }
     exc.Rethrow();
     // if it is C++11, use lazy evaluation for Allreduce,
     // to gain speedup in recovery
     auto lazy_get_stats = [&]() {
-      const MetaInfo &info = p_fmat->Info();
       // start accumulating statistics
       for (const auto &batch : p_fmat->GetBatches<SparsePage>()) {
         auto page = batch.GetView();
-        CHECK_LT(batch.Size(), std::numeric_limits<unsigned>::max());
-        const auto nbatch = static_cast<bst_omp_uint>(batch.Size());
-        common::ParallelFor(nbatch, [&](bst_omp_uint i) {
-          SparsePage::Inst inst = page[i];
-          const int tid = omp_get_thread_num();
-          const auto ridx = static_cast<bst_uint>(batch.base_rowid + i);
-          RegTree::FVec &feats = fvec_temp[tid];
-          feats.Fill(inst);
-          int offset = 0;
-          for (auto tree : trees) {
-            AddStats(*tree, feats, gpair_h, info, ridx,
-                     dmlc::BeginPtr(stemp[tid]) + offset);
-            offset += tree->param.num_nodes;
+        const size_t nsize = batch.Size();
+        const size_t n_blocks = common::DivRoundUp(nsize, kBlockOfRowsSize);
+        // parallel over blocks of rows, each block goes through all trees so that a tree
+        // stays in cache while the rows are traversed.
+        common::ParallelFor(n_blocks, [&](size_t block_id) {
+          const int tid = common::ThreadIdx();
+          const size_t begin = block_id * kBlockOfRowsSize;
+          const size_t block_size = std::min(nsize - begin, kBlockOfRowsSize);
+          RegTree::FVec *feats = dmlc::BeginPtr(fvec_temp) + tid * kBlockOfRowsSize;
+          for (size_t i = 0; i < block_size; ++i) {
+            feats[i].Fill(page[begin + i], compact);
+          }
+          GradStats *leaf_stats = dmlc::BeginPtr(stemp[tid]);
+          for (size_t tree_idx = 0; tree_idx < trees.size(); ++tree_idx) {
+            auto const *tree = forest.Tree(tree_idx);
+            auto const &cats = trees[tree_idx]->GetCategoriesMatrix();
+            const bool has_cat = forest.HasCategorical(tree_idx);
+            for (size_t i = 0; i < block_size; ++i) {
+              auto const &leaf = has_cat
+                                     ? predictor::GetLeaf<true, true>(tree, feats[i], cats)
+                                     : predictor::GetLeaf<true, false>(tree, feats[i], cats);
+              leaf_stats[leaf.LeafIndex()].Add(gpair_h[batch.base_rowid + begin + i]);
+            }
+          }
+          for (size_t i = 0; i < block_size; ++i) {
+            feats[i].Drop(page[begin + i], compact);
           }
-          feats.Drop(inst);
         });
       }
       // aggregate the statistics
-      auto num_nodes = static_cast<int>(stemp[0].size());
-      common::ParallelFor(num_nodes, [&](int nid) {
+      common::ParallelFor(n_leaves, [&](size_t i) {
         for (int tid = 1; tid < nthread; ++tid) {
-          stemp[0][nid].Add(stemp[tid][nid]);
+          stemp[0][i].Add(stemp[tid][i]);
         }
       });
     };
@@ -105,35 +126,28 @@ class TreeRefresher: public TreeUpdater {
     // rescale learning rate according to size of trees
     float lr = param_.learning_rate;
     param_.learning_rate = lr / trees.size();
-    int offset = 0;
-    for (auto tree : trees) {
-      this->Refresh(dmlc::BeginPtr(stemp[0]) + offset, 0, tree);
-      offset += tree->param.num_nodes;
+    std::vector<GradStats> node_stats;
+    for (size_t tree_idx = 0; tree_idx < trees.size(); ++tree_idx) {
+      auto const *tree = forest.Tree(tree_idx);
+      node_stats.assign(trees[tree_idx]->param.num_nodes, GradStats());
+      // children are placed after their parent in the flattened tree.
+      for (size_t k = forest.TreeSize(tree_idx); k-- > 0;) {
+        auto const &node = tree[k];
+        auto &stats = node_stats[node.nidx];
+        if (node.IsLeaf()) {
+          stats = stemp[0][node.LeafIndex()];
+        } else {
+          stats.Add(node_stats[tree[node.left].nidx]);
+          stats.Add(node_stats[tree[node.left + 1].nidx]);
+        }
+      }
+      this->Refresh(dmlc::BeginPtr(node_stats), 0, trees[tree_idx]);
     }
     // set learning rate back
     param_.learning_rate = lr;
   }
 
  private:
-  inline static void AddStats(const RegTree &tree,
-                              const RegTree::FVec &feat,
-                              const std::vector<GradientPair> &gpair,
-                              const MetaInfo&,
-                              const bst_uint ridx,
-                              GradStats *gstats) {
-    // start from groups that belongs to current data
-    auto pid = 0;
-    gstats[pid].Add(gpair[ridx]);
-    auto const& cats = tree.GetCategoriesMatrix();
-    // traverse tree
-    while (!tree[pid].IsLeaf()) {
-      unsigned split_index = tree[pid].SplitIndex();
-      pid = predictor::GetNextNode<true, true>(
-          tree[pid], pid, feat.GetFvalue(split_index), feat.IsMissing(split_index),
-          cats);
-      gstats[pid].Add(gpair[ridx]);
-    }
-  }
   inline void Refresh(const GradStats *gstats,
                       int nid, RegTree *p_tree) {
     RegTree &tree = *p_tree;
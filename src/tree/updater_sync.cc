@@ -3,7 +3,10 @@
  * \file updater_sync.cc
  * \brief synchronize the tree in all distributed nodes
  */
+#include <rabit/rabit.h>
 #include <xgboost/tree_updater.h>
+
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <limits>
@@ -18,7 +21,10 @@ DMLC_REGISTRY_FILE_TAG(updater_sync);
 
 /*!
  * \brief syncher that synchronize the tree in all distributed nodes
- * can implement various strategies, so far it is always set to node 0's tree
+ * can implement various strategies, so far it is always set to node 0's tree.
+ *
+ * Workers usually grow identical trees, so a digest of the trees is compared first and
+ * the trees are only broadcast when workers disagree.
  */
 class TreeSyncher: public TreeUpdater {
  public:
@@ -35,6 +41,16 @@ class TreeSyncher: public TreeUpdater {
               DMatrix*,
               const std::vector<RegTree*> &trees) override {
     if (rabit::GetWorldSize() == 1) return;
+    uint64_t digest = kFnvOffset;
+    for (auto tree : trees) {
+      digest = Digest(*tree, digest);
+    }
+    // max of both the digest and its complement, equal digests give complementary values.
+    uint64_t range[2] = {digest, ~digest};
+    rabit::Allreduce<rabit::op::Max>(range, 2);
+    if (range[0] == ~range[1]) {
+      return;
+    }
     std::string s_model;
     common::MemoryBufferStream fs(&s_model);
     int rank = rabit::GetRank();
@@ -49,8 +65,29 @@ class TreeSyncher: public TreeUpdater {
       tree->Load(&fs);
     }
   }
+
+ private:
+  static constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+
+  template <typename T>
+  static uint64_t Digest(std::vector<T> const& data, uint64_t digest) {
+    auto const* bytes = reinterpret_cast<uint8_t const*>(data.data());
+    for (size_t i = 0; i < data.size() * sizeof(T); ++i) {
+      digest = (digest ^ bytes[i]) * 1099511628211ULL;
+    }
+    return digest;
+  }
+  static uint64_t Digest(RegTree const& tree, uint64_t digest) {
+    digest = Digest(tree.GetNodes(), digest);
+    digest = Digest(tree.GetStats(), digest);
+    digest = Digest(tree.GetSplitTypes(), digest);
+    auto cats = tree.GetSplitCategories();
+    return Digest(std::vector<uint32_t>(cats.cbegin(), cats.cend()), digest);
+  }
 };
 
+constexpr uint64_t TreeSyncher::kFnvOffset;
+
 XGBOOST_REGISTER_TREE_UPDATER(TreeSyncher, "sync")
 .describe("Syncher that synchronize the tree in all distributed nodes.")
 .set_body([](ObjInfo) {
@@ -0,0 +1,83 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \brief Benchmarks for data ingestion, sketching and JSON parsing.
+ */
+#include <benchmark/benchmark.h>
+#include <xgboost/data.h>
+#include <xgboost/json.h>
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../../src/common/hist_util.h"
+#include "../../../src/common/quantile.h"
+#include "../../../src/data/adapter.h"
+#include "helpers.h"
+
+namespace xgboost {
+namespace bench {
+namespace {
+void SparsePagePush(benchmark::State& state) {
+  auto shape = GetShape(state);
+  auto values = GenerateValues(shape);
+  data::DenseAdapter adapter{values.data(), shape.rows, shape.cols};
+  auto n_threads = omp_get_max_threads();
+  for (auto _ : state) {
+    SparsePage page;
+    page.Push(adapter.Value(), std::numeric_limits<float>::quiet_NaN(), n_threads);
+    benchmark::DoNotOptimize(page.data.HostPointer());
+  }
+  state.SetItemsProcessed(state.iterations() * shape.rows * shape.cols);
+}
+BENCHMARK(SparsePagePush)->Apply(DataShapes)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void HostSketch(benchmark::State& state) {
+  auto shape = GetShape(state);
+  auto p_fmat = GenerateDMatrix(shape);
+  auto const& info = p_fmat->Info();
+  auto n_threads = omp_get_max_threads();
+  for (auto _ : state) {
+    std::vector<bst_row_t> columns_size(info.num_col_, 0);
+    common::HostSketchContainer container{columns_size, 256, info.feature_types.ConstHostSpan(),
+                                          false, n_threads};
+    for (auto const& page : p_fmat->GetBatches<SparsePage>()) {
+      container.PushRowPage(page, info, {});
+    }
+    common::HistogramCuts cuts;
+    container.MakeCuts(&cuts);
+    benchmark::DoNotOptimize(cuts.Values().data());
+  }
+  state.SetItemsProcessed(state.iterations() * info.num_nonzero_);
+}
+BENCHMARK(HostSketch)->Apply(DataShapes)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void JsonParse(benchmark::State& state) {
+  // A model-like document: an array of objects holding numeric arrays.
+  int64_t n_objects = state.range(0);
+  Json doc{Array{}};
+  auto& arr = get<Array>(doc);
+  for (int64_t i = 0; i < n_objects; ++i) {
+    Json obj{Object{}};
+    obj["id"] = Integer{i};
+    obj["name"] = String{"node_" + std::to_string(i)};
+    std::vector<Json> values;
+    for (int32_t j = 0; j < 64; ++j) {
+      values.emplace_back(Number{static_cast<float>(i * j) / 7.0f});
+    }
+    obj["values"] = Array{std::move(values)};
+    arr.emplace_back(std::move(obj));
+  }
+  std::string str;
+  Json::Dump(doc, &str);
+  for (auto _ : state) {
+    auto loaded = Json::Load(StringView{str});
+    benchmark::DoNotOptimize(&loaded);
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(JsonParse)->Arg(1 << 10)->Arg(1 << 14)->Unit(benchmark::kMillisecond);
+}  // anonymous namespace
+}  // namespace bench
+}  // namespace xgboost
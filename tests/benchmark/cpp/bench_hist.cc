@@ -0,0 +1,197 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \brief Benchmarks for the kernels of the `hist` tree method.
+ */
+#include <benchmark/benchmark.h>
+#include <xgboost/task.h>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../../../src/common/column_matrix.h"
+#include "../../../src/common/hist_simd.h"
+#include "../../../src/common/hist_util.h"
+#include "../../../src/common/partition_builder.h"
+#include "../../../src/common/random.h"
+#include "../../../src/common/row_set.h"
+#include "../../../src/common/threading_utils.h"
+#include "../../../src/data/gradient_index.h"
+#include "../../../src/tree/hist/evaluate_splits.h"
+#include "../../../src/tree/updater_quantile_hist.h"
+#include "helpers.h"
+
+namespace xgboost {
+namespace bench {
+namespace {
+int32_t constexpr kMaxBins = 256;
+
+struct HistFixture {
+  std::shared_ptr<DMatrix> p_fmat;
+  GHistIndexMatrix gmat;
+  std::vector<GradientPair> gpair;
+  common::RowSetCollection row_set;
+
+  explicit HistFixture(Shape shape)
+      : p_fmat{GenerateDMatrix(shape)},
+        gmat{p_fmat.get(), kMaxBins},
+        gpair{GenerateGradients(shape.rows)} {
+    auto& rows = *row_set.Data();
+    rows.resize(shape.rows);
+    std::iota(rows.begin(), rows.end(), 0);
+    row_set.Init();
+  }
+};
+
+void BuildHist(benchmark::State& state) {
+  HistFixture fixture{GetShape(state)};
+  auto const& gmat = fixture.gmat;
+  uint32_t n_bins = gmat.cut.TotalBins();
+  common::GHistBuilder<double> builder{n_bins};
+  common::HistCollection<double> hist;
+  hist.Init(n_bins);
+  hist.AddHistRow(0);
+  hist.AllocateAllData();
+  for (auto _ : state) {
+    common::InitilizeHistByZeroes(hist[0], 0, n_bins);
+    if (gmat.IsDense()) {
+      builder.BuildHist<false>(fixture.gpair, fixture.row_set[0], gmat, hist[0]);
+    } else {
+      builder.BuildHist<true>(fixture.gpair, fixture.row_set[0], gmat, hist[0]);
+    }
+    benchmark::DoNotOptimize(hist[0].data());
+  }
+  state.SetItemsProcessed(state.iterations() * gmat.row_ptr.back());
+}
+BENCHMARK(BuildHist)->Apply(DataShapes)->Unit(benchmark::kMillisecond);
+
+// Single threaded kernel for dense rows, used for comparing vector instruction sets per
+// core.
+template <typename FPType>
+void DenseRowHist(benchmark::State& state) {
+  if (!common::DenseHistSimdSupported()) {
+    state.SkipWithError("SIMD histogram is not supported on current CPU.");
+    return;
+  }
+  auto shape = GetShape(state);
+  std::mt19937_64 rng{0};
+  std::uniform_int_distribution<uint32_t> dist{0, kMaxBins - 1};
+  std::vector<uint8_t> index(shape.rows * shape.cols);
+  for (auto& bin : index) {
+    bin = static_cast<uint8_t>(dist(rng));
+  }
+  std::vector<uint32_t> offsets(shape.cols);
+  for (size_t j = 0; j < shape.cols; ++j) {
+    offsets[j] = static_cast<uint32_t>(j * kMaxBins);
+  }
+  auto gpair = GenerateGradients(shape.rows);
+  std::vector<FPType> hist(shape.cols * kMaxBins * 2);
+  for (auto _ : state) {
+    std::fill(hist.begin(), hist.end(), FPType{0});
+    for (size_t i = 0; i < shape.rows; ++i) {
+      common::AddDenseRowSimd(index.data() + i * shape.cols, offsets.data(), shape.cols,
+                              reinterpret_cast<float const*>(gpair.data() + i), hist.data());
+    }
+    benchmark::DoNotOptimize(hist.data());
+  }
+  state.SetItemsProcessed(state.iterations() * index.size());
+}
+BENCHMARK_TEMPLATE(DenseRowHist, float)
+    ->Args({1 << 14, 16, 0})
+    ->Args({1 << 14, 128, 0})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(DenseRowHist, double)
+    ->Args({1 << 14, 16, 0})
+    ->Args({1 << 14, 128, 0})
+    ->Unit(benchmark::kMicrosecond);
+
+template <bool any_missing>
+void PartitionImpl(HistFixture* fixture, common::ColumnMatrix const& columns,
+                   RegTree const& tree, int32_t split_cond, benchmark::State* state) {
+  size_t constexpr kBlockSize = 2048;
+  common::PartitionBuilder<kBlockSize> builder;
+  auto n_threads = omp_get_max_threads();
+  auto& row_set = fixture->row_set;
+  size_t n_rows = row_set[0].Size();
+  common::BlockedSpace2d space(1, [&](size_t) { return n_rows; }, kBlockSize);
+  for (auto _ : *state) {
+    builder.Init(space.Size(), 1, [&](size_t) { return space.Size(); });
+    common::ParallelFor2dSteal(space, n_threads, [&](size_t, common::Range1d r) {
+      switch (columns.GetTypeSize()) {
+        case common::kUint8BinsTypeSize:
+          builder.PartitionToMask<uint8_t, any_missing>(0, RegTree::kRoot, r, split_cond,
+                                                        columns, tree, row_set[0].begin);
+          break;
+        case common::kUint16BinsTypeSize:
+          builder.PartitionToMask<uint16_t, any_missing>(0, RegTree::kRoot, r, split_cond,
+                                                         columns, tree, row_set[0].begin);
+          break;
+        default:
+          builder.PartitionToMask<uint32_t, any_missing>(0, RegTree::kRoot, r, split_cond,
+                                                         columns, tree, row_set[0].begin);
+      }
+    });
+    builder.CalculateMaskOffsets();
+    common::ParallelFor2dSteal(space, n_threads, [&](size_t, common::Range1d r) {
+      builder.ScatterFromMask(0, r, row_set[0].begin, row_set.AlternateStorage(RegTree::kRoot));
+    });
+    benchmark::DoNotOptimize(builder.GetNLeftElems(0));
+  }
+  state->SetItemsProcessed(state->iterations() * n_rows);
+}
+
+void Partition(benchmark::State& state) {
+  HistFixture fixture{GetShape(state)};
+  auto const& gmat = fixture.gmat;
+  common::ColumnMatrix columns;
+  columns.Init(gmat, 0.2);
+  // Split the first feature at its median bin.
+  auto const& ptrs = gmat.cut.Ptrs();
+  auto split_cond = static_cast<int32_t>(ptrs[0] + (ptrs[1] - ptrs[0]) / 2);
+  RegTree tree;
+  tree.ExpandNode(RegTree::kRoot, 0, gmat.cut.Values()[split_cond], true, 0.0f, 0.0f, 0.0f,
+                  1.0f, 1.0f, 0.5f, 0.5f);
+  if (columns.AnyMissing()) {
+    PartitionImpl<true>(&fixture, columns, tree, split_cond, &state);
+  } else {
+    PartitionImpl<false>(&fixture, columns, tree, split_cond, &state);
+  }
+}
+BENCHMARK(Partition)->Apply(DataShapes)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void EvaluateSplits(benchmark::State& state) {
+  HistFixture fixture{GetShape(state)};
+  auto const& gmat = fixture.gmat;
+  uint32_t n_bins = gmat.cut.TotalBins();
+  common::HistCollection<double> hist;
+  hist.Init(n_bins);
+  hist.AddHistRow(0);
+  hist.AllocateAllData();
+  common::GHistBuilder<double> builder{n_bins};
+  builder.BuildHist<true>(fixture.gpair, fixture.row_set[0], gmat, hist[0]);
+
+  tree::TrainParam param;
+  param.UpdateAllowUnknown(Args{});
+  GradientPairPrecise total;
+  for (auto const& g : fixture.gpair) {
+    total += GradientPairPrecise{g};
+  }
+  tree::HistEvaluator<double, tree::CPUExpandEntry> evaluator{
+      param, fixture.p_fmat->Info(), omp_get_max_threads(),
+      std::make_shared<common::ColumnSampler>(), ObjInfo{ObjInfo::kRegression}};
+  evaluator.InitRoot(tree::GradStats{total});
+  RegTree tree;
+  std::vector<tree::CPUExpandEntry> entries(1);
+  for (auto _ : state) {
+    entries.front() = tree::CPUExpandEntry{RegTree::kRoot, 0, 0.0f};
+    evaluator.EvaluateSplits(hist, gmat.cut, {}, tree, &entries);
+    benchmark::DoNotOptimize(entries.front().split.loss_chg);
+  }
+  state.SetItemsProcessed(state.iterations() * n_bins);
+}
+BENCHMARK(EvaluateSplits)->Apply(DataShapes)->Unit(benchmark::kMicrosecond)->UseRealTime();
+}  // anonymous namespace
+}  // namespace bench
+}  // namespace xgboost
@@ -0,0 +1,113 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \brief Benchmarks for the CPU predictor.
+ */
+#include <benchmark/benchmark.h>
+#include <xgboost/generic_parameters.h>
+#include <xgboost/learner.h>
+#include <xgboost/predictor.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../../src/gbm/gbtree_model.h"
+#include "../../../src/predictor/flat_forest.h"
+#include "../../../src/predictor/simd_traversal.h"
+#include "helpers.h"
+
+namespace xgboost {
+namespace bench {
+namespace {
+int32_t constexpr kTrees = 128;
+int32_t constexpr kDepth = 6;
+
+void PredictBatch(benchmark::State& state, std::string const& name) {
+  auto shape = GetShape(state);
+  auto p_fmat = GenerateDMatrix(shape);
+
+  LearnerModelParam mparam;
+  mparam.base_score = 0.5;
+  mparam.num_feature = shape.cols;
+  mparam.num_output_group = 1;
+  gbm::GBTreeModel model{&mparam};
+  std::mt19937_64 rng{0};
+  std::vector<std::unique_ptr<RegTree>> trees;
+  for (int32_t i = 0; i < kTrees; ++i) {
+    trees.push_back(GenerateTree(shape.cols, kDepth, &rng));
+  }
+  model.CommitModel(std::move(trees), 0);
+
+  GenericParameter ctx;
+  ctx.Init(Args{});
+  std::unique_ptr<Predictor> predictor{Predictor::Create(name, &ctx)};
+  predictor->Configure({});
+  for (auto _ : state) {
+    // Fresh entry, so nothing is reused from previous iteration.
+    PredictionCacheEntry predts;
+    predictor->InitOutPredictions(p_fmat->Info(), &predts.predictions, model);
+    predictor->PredictBatch(p_fmat.get(), &predts, model, 0, kTrees);
+    benchmark::DoNotOptimize(predts.predictions.HostPointer());
+  }
+  state.SetItemsProcessed(state.iterations() * shape.rows);
+}
+BENCHMARK_CAPTURE(PredictBatch, cpu_predictor, std::string{"cpu_predictor"})
+    ->Apply(DataShapes)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Single threaded multi-row traversal kernel, used for comparing vector instruction sets
+// per core.
+void SimdTraverse(benchmark::State& state) {
+  auto width = predictor::SimdTraversalWidth();
+  if (width == 0) {
+    state.SkipWithError("SIMD traversal is not supported on current CPU.");
+    return;
+  }
+  auto shape = GetShape(state);
+  shape.rows = shape.rows / width * width;
+  auto values = GenerateValues(shape);
+
+  LearnerModelParam mparam;
+  mparam.num_feature = shape.cols;
+  mparam.num_output_group = 1;
+  gbm::GBTreeModel model{&mparam};
+  std::mt19937_64 rng{0};
+  std::vector<std::unique_ptr<RegTree>> trees;
+  for (int32_t i = 0; i < kTrees; ++i) {
+    trees.push_back(GenerateTree(shape.cols, kDepth, &rng));
+  }
+  model.CommitModel(std::move(trees), 0);
+  predictor::FlatForest forest{model.Generation()};
+  forest.Extend(model);
+  // Splits use compact feature indices, which are within the stride of original rows.
+  auto stride = static_cast<int32_t>(shape.cols);
+
+  std::vector<float> out(shape.rows);
+  std::vector<float> leaves(width);
+  for (auto _ : state) {
+    std::fill(out.begin(), out.end(), 0.0f);
+    for (size_t i = 0; i < shape.rows; i += width) {
+      for (int32_t t = 0; t < kTrees; ++t) {
+        predictor::SimdTraverse(forest.Tree(t), forest.LeafValues(),
+                                values.data() + i * shape.cols, stride, leaves.data());
+        for (int32_t k = 0; k < width; ++k) {
+          out[i + k] += leaves[k];
+        }
+      }
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * shape.rows);
+}
+BENCHMARK(SimdTraverse)
+    ->Args({1 << 12, 16, 0})
+    ->Args({1 << 12, 16, 20})
+    ->Args({1 << 12, 128, 0})
+    ->Unit(benchmark::kMillisecond);
+}  // anonymous namespace
+}  // namespace bench
+}  // namespace xgboost
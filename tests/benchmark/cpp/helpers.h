@@ -0,0 +1,126 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file helpers.h
+ * \brief Synthetic data shared by the micro-benchmarks.
+ *
+ *  Every benchmark taking data runs over the shapes listed in `DataShapes`, each shape is
+ *  passed as the arguments {rows, columns, sparsity in percent}.  The shapes can be
+ *  replaced by setting the environment variable `XGBOOST_BENCH_SHAPES` to a list like
+ *  "100000x64x0;10000x512x90".
+ */
+#ifndef XGBOOST_BENCH_HELPERS_H_
+#define XGBOOST_BENCH_HELPERS_H_
+
+#include <benchmark/benchmark.h>
+#include <xgboost/base.h>
+#include <xgboost/data.h>
+#include <xgboost/tree_model.h>
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../../src/data/adapter.h"
+
+namespace xgboost {
+namespace bench {
+struct Shape {
+  size_t rows;
+  size_t cols;
+  int64_t sparsity;  // percentage of missing values
+};
+
+inline Shape GetShape(benchmark::State const& state) {
+  return {static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)),
+          state.range(2)};
+}
+
+inline void DataShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"rows", "cols", "sparsity"});
+  char const* env = std::getenv("XGBOOST_BENCH_SHAPES");
+  if (env == nullptr) {
+    for (int64_t rows : {1 << 14, 1 << 18}) {
+      for (int64_t cols : {16, 128}) {
+        for (int64_t sparsity : {0, 80}) {
+          b->Args({rows, cols, sparsity});
+        }
+      }
+    }
+    return;
+  }
+  std::stringstream ss{env};
+  std::string shape;
+  while (std::getline(ss, shape, ';')) {
+    int64_t rows = 0, cols = 0, sparsity = 0;
+    char sep;
+    std::stringstream ss_shape{shape};
+    ss_shape >> rows >> sep >> cols >> sep >> sparsity;
+    CHECK(rows > 0 && cols > 0 && sparsity >= 0 && sparsity < 100)
+        << "Invalid shape: " << shape;
+    b->Args({rows, cols, sparsity});
+  }
+}
+
+/*! \brief Dense row major values with missing values being NaN. */
+inline std::vector<float> GenerateValues(Shape shape, uint64_t seed = 0) {
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+  std::vector<float> values(shape.rows * shape.cols);
+  float sparsity = static_cast<float>(shape.sparsity) / 100.0f;
+  for (auto& v : values) {
+    v = dist(rng) < sparsity ? std::numeric_limits<float>::quiet_NaN() : dist(rng);
+  }
+  return values;
+}
+
+inline std::shared_ptr<DMatrix> GenerateDMatrix(Shape shape, uint64_t seed = 0) {
+  auto values = GenerateValues(shape, seed);
+  data::DenseAdapter adapter{values.data(), shape.rows, shape.cols};
+  std::shared_ptr<DMatrix> p_fmat{
+      DMatrix::Create(&adapter, std::numeric_limits<float>::quiet_NaN(), 0)};
+  std::mt19937_64 rng{seed};
+  std::normal_distribution<float> dist;
+  auto& labels = p_fmat->Info().labels_.HostVector();
+  labels.resize(shape.rows);
+  for (auto& l : labels) {
+    l = dist(rng);
+  }
+  return p_fmat;
+}
+
+inline std::vector<GradientPair> GenerateGradients(size_t n, uint64_t seed = 0) {
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<float> dist{-1.0f, 1.0f};
+  std::vector<GradientPair> gpair(n);
+  for (auto& g : gpair) {
+    g = GradientPair{dist(rng), std::abs(dist(rng)) + 0.1f};
+  }
+  return gpair;
+}
+
+/*! \brief Complete tree of `depth` with random splits on features in [0, n_features). */
+inline std::unique_ptr<RegTree> GenerateTree(bst_feature_t n_features, int32_t depth,
+                                             std::mt19937_64* rng) {
+  std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+  std::uniform_int_distribution<bst_feature_t> feature{0, n_features - 1};
+  std::unique_ptr<RegTree> tree{new RegTree};
+  std::vector<bst_node_t> level{RegTree::kRoot};
+  for (int32_t d = 0; d < depth; ++d) {
+    std::vector<bst_node_t> next;
+    for (auto nidx : level) {
+      tree->ExpandNode(nidx, feature(*rng), dist(*rng), dist(*rng) < 0.5f, 0.0f,
+                       dist(*rng) - 0.5f, dist(*rng) - 0.5f, 1.0f, 1.0f, 0.5f, 0.5f);
+      next.push_back((*tree)[nidx].LeftChild());
+      next.push_back((*tree)[nidx].RightChild());
+    }
+    level = std::move(next);
+  }
+  return tree;
+}
+}  // namespace bench
+}  // namespace xgboost
+#endif  // XGBOOST_BENCH_HELPERS_H_
@@ -0,0 +1,454 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ * \file bench_e2e.cc
+ * \brief End-to-end training and inference benchmark over synthetic data of a few standard
+ *        shapes, reporting a JSON document for comparing commits.
+ *
+ *  Each pair of data shape and tree method is run in a child process so the peak resident
+ *  memory is measured per run.  See `doc/contrib/unit_tests.rst` for usage.
+ */
+#include <xgboost/base.h>
+#include <xgboost/data.h>
+#include <xgboost/json.h>
+#include <xgboost/learner.h>
+#include <xgboost/logging.h>
+#include <xgboost/version_config.h>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif  // !defined(_WIN32)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../../src/common/memory_tracker.h"
+#include "../../../src/common/perf_counters.h"
+#include "../../../src/common/timer.h"
+#include "../../../src/data/adapter.h"
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#endif  // defined(_WIN32)
+
+namespace xgboost {
+namespace bench {
+namespace {
+using DMatrixPtr = std::shared_ptr<DMatrix>;
+float constexpr kNaN = std::numeric_limits<float>::quiet_NaN();
+
+struct Options {
+  int32_t rounds{32};
+  int32_t predict_repeats{3};
+  double scale{1.0};
+  std::string filter;
+  std::vector<std::string> tree_methods;
+  std::string output;
+  // Set in child processes, running a single case.
+  std::string run_case;
+};
+
+/**
+ * \brief A data shape.  `make(rows, seed, copy)` generates a DMatrix, different copies of
+ *        the same seed hold the same data but don't share any prediction cache.
+ */
+struct Case {
+  std::string name;
+  size_t rows;
+  std::vector<std::string> tree_methods;
+  Args params;
+  std::function<DMatrixPtr(size_t, uint64_t, size_t)> make;
+};
+
+// Weights of features in the response are fixed, so train and test data share the same
+// underlying function.
+std::vector<float> FeatureWeights(size_t n) {
+  std::mt19937_64 rng{1994};
+  std::normal_distribution<float> dist;
+  std::vector<float> w(n);
+  for (auto &v : w) {
+    v = dist(rng);
+  }
+  return w;
+}
+
+float Signal(float v) { return v > 0.5f ? v : -v * v; }
+
+/*! \brief Dense features with uniform values, the response is a sum of non-linear terms. */
+void DenseFeatures(size_t rows, size_t cols, uint64_t seed, std::vector<float> *x,
+                   std::vector<float> *y) {
+  auto w = FeatureWeights(cols);
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+  std::normal_distribution<float> noise{0.0f, 0.1f};
+  x->resize(rows * cols);
+  y->resize(rows);
+  for (size_t i = 0; i < rows; ++i) {
+    float s = 0;
+    for (size_t j = 0; j < cols; ++j) {
+      float v = dist(rng);
+      (*x)[i * cols + j] = v;
+      s += w[j] * Signal(v);
+    }
+    (*y)[i] = s + noise(rng);
+  }
+}
+
+DMatrixPtr FromDense(std::vector<float> const &x, std::vector<float> y, size_t cols) {
+  data::DenseAdapter adapter{x.data(), y.size(), cols};
+  DMatrixPtr p_fmat{DMatrix::Create(&adapter, kNaN, 0)};
+  p_fmat->Info().labels_.HostVector() = std::move(y);
+  return p_fmat;
+}
+
+DMatrixPtr DenseTall(size_t rows, uint64_t seed, size_t) {
+  size_t constexpr kCols = 32;
+  std::vector<float> x, y;
+  DenseFeatures(rows, kCols, seed, &x, &y);
+  return FromDense(x, std::move(y), kCols);
+}
+
+DMatrixPtr SparseWide(size_t rows, uint64_t seed, size_t) {
+  size_t constexpr kCols = 4096;
+  double constexpr kDensity = 0.01;
+  auto w = FeatureWeights(kCols);
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+  std::normal_distribution<float> noise{0.0f, 0.1f};
+  std::geometric_distribution<size_t> gap{kDensity};
+  std::vector<size_t> indptr{0};
+  std::vector<unsigned> indices;
+  std::vector<float> values, y(rows);
+  for (size_t i = 0; i < rows; ++i) {
+    float s = 0;
+    for (size_t j = gap(rng); j < kCols; j += gap(rng) + 1) {
+      float v = dist(rng);
+      indices.push_back(static_cast<unsigned>(j));
+      values.push_back(v);
+      s += w[j] * Signal(v);
+    }
+    indptr.push_back(indices.size());
+    y[i] = s + noise(rng);
+  }
+  data::CSRAdapter adapter{indptr.data(), indices.data(), values.data(), rows, values.size(),
+                           kCols};
+  DMatrixPtr p_fmat{DMatrix::Create(&adapter, kNaN, 0)};
+  p_fmat->Info().labels_.HostVector() = std::move(y);
+  return p_fmat;
+}
+
+DMatrixPtr Categorical(size_t rows, uint64_t seed, size_t) {
+  size_t constexpr kCat = 8, kNum = 8, kCols = kCat + kNum;
+  int32_t constexpr kLevels = 32;
+  auto w = FeatureWeights(kCols);
+  auto effects = FeatureWeights(kCat * kLevels);
+  std::mt19937_64 rng{seed};
+  std::uniform_int_distribution<int32_t> level{0, kLevels - 1};
+  std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+  std::normal_distribution<float> noise{0.0f, 0.1f};
+  std::vector<float> x(rows * kCols), y(rows);
+  for (size_t i = 0; i < rows; ++i) {
+    float s = 0;
+    for (size_t j = 0; j < kCat; ++j) {
+      auto c = level(rng);
+      x[i * kCols + j] = static_cast<float>(c);
+      s += effects[j * kLevels + c];
+    }
+    for (size_t j = kCat; j < kCols; ++j) {
+      float v = dist(rng);
+      x[i * kCols + j] = v;
+      s += w[j] * Signal(v);
+    }
+    y[i] = s + noise(rng);
+  }
+  auto p_fmat = FromDense(x, std::move(y), kCols);
+  std::vector<char const *> types(kCols, "q");
+  std::fill_n(types.begin(), kCat, "c");
+  p_fmat->Info().SetFeatureInfo("feature_type", types.data(), types.size());
+  return p_fmat;
+}
+
+DMatrixPtr Ranking(size_t rows, uint64_t seed, size_t) {
+  size_t constexpr kCols = 32;
+  bst_group_t constexpr kGroupSize = 32;
+  rows = std::max(rows / kGroupSize, static_cast<size_t>(1)) * kGroupSize;
+  std::vector<float> x, y;
+  DenseFeatures(rows, kCols, seed, &x, &y);
+  // Relevance degrees in [0, 4].
+  for (auto &v : y) {
+    v = std::min(std::floor(4.0f / (1.0f + std::exp(-v)) + 0.5f), 4.0f);
+  }
+  auto p_fmat = FromDense(x, std::move(y), kCols);
+  auto &group_ptr = p_fmat->Info().group_ptr_;
+  for (size_t i = 0; i <= rows; i += kGroupSize) {
+    group_ptr.push_back(static_cast<bst_group_t>(i));
+  }
+  return p_fmat;
+}
+
+DMatrixPtr ExternalMemory(size_t rows, uint64_t seed, size_t copy) {
+  size_t constexpr kCols = 32;
+  // Files are written into the working directory and reused by all copies.
+  std::string path = "xgboost_e2e_" + std::to_string(seed) + ".libsvm";
+  if (copy == 0) {
+    std::vector<float> x, y;
+    DenseFeatures(rows, kCols, seed, &x, &y);
+    std::ofstream fout{path};
+    for (size_t i = 0; i < rows; ++i) {
+      fout << y[i];
+      for (size_t j = 0; j < kCols; ++j) {
+        fout << " " << j << ":" << x[i * kCols + j];
+      }
+      fout << "\n";
+    }
+  }
+  auto uri = path + "#" + path + "." + std::to_string(copy) + ".cache";
+  return DMatrixPtr{DMatrix::Load(uri, true, false, "libsvm")};
+}
+
+std::vector<Case> Cases(double scale) {
+  auto rows = [scale](size_t n) {
+    return std::max(static_cast<size_t>(static_cast<double>(n) * scale),
+                    static_cast<size_t>(64));
+  };
+  std::vector<std::string> all{"exact", "approx", "hist"};
+  return {
+      {"dense_tall", rows(1 << 20), all, {}, DenseTall},
+      {"sparse_wide", rows(1 << 17), all, {}, SparseWide},
+      {"categorical", rows(1 << 18), {"hist"}, {}, Categorical},
+      {"ranking", rows(1 << 18), all, {{"objective", "rank:pairwise"}}, Ranking},
+      {"external_memory", rows(1 << 18), {"approx", "hist"}, {}, ExternalMemory},
+  };
+}
+
+/*! \brief Peak resident set size of this process in bytes, 0 if unknown. */
+int64_t PeakRSS() {
+#if defined(_WIN32)
+  return 0;
+#else
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return static_cast<int64_t>(usage.ru_maxrss);
+#else
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif  // defined(__APPLE__)
+#endif  // defined(_WIN32)
+}
+
+/*! \brief Total time and count of each `Monitor` timer from recorded trace events. */
+Json Phases(std::string const &trace) {
+  auto events = Json::Load(StringView{trace});
+  // Open events of each thread.
+  std::map<int64_t, std::vector<std::pair<std::string, double>>> stacks;
+  std::map<std::string, std::pair<int64_t, double>> totals;
+  for (auto const &e : get<Array const>(events["traceEvents"])) {
+    auto const &name = get<String const>(e["name"]);
+    auto tid = get<Integer const>(e["tid"]);
+    auto ts = get<Number const>(e["ts"]);
+    auto &stack = stacks[tid];
+    if (get<String const>(e["ph"]) == "B") {
+      stack.emplace_back(name, ts);
+      continue;
+    }
+    CHECK(!stack.empty() && stack.back().first == name);
+    auto &total = totals[name];
+    total.first++;
+    total.second += (ts - stack.back().second) / 1e6;
+    stack.pop_back();
+  }
+  Json out{Object{}};
+  for (auto const &kv : totals) {
+    Json phase{Object{}};
+    phase["count"] = Integer{kv.second.first};
+    phase["seconds"] = Number{kv.second.second};
+    out[kv.first] = phase;
+  }
+  return out;
+}
+
+Json Run(Case const &c, std::string const &tree_method, Options const &opt) {
+  Json result{Object{}};
+  result["case"] = String{c.name};
+  result["tree_method"] = String{tree_method};
+
+  common::Timer timer;
+  timer.Start();
+  auto p_train = c.make(c.rows, 0, 0);
+  timer.Stop();
+  result["rows"] = Integer{static_cast<int64_t>(p_train->Info().num_row_)};
+  result["cols"] = Integer{static_cast<int64_t>(p_train->Info().num_col_)};
+  result["nnz"] = Integer{static_cast<int64_t>(p_train->Info().num_nonzero_)};
+  result["data_seconds"] = Number{timer.ElapsedSeconds()};
+
+  std::vector<DMatrixPtr> tests;
+  for (int32_t i = 0; i < opt.predict_repeats; ++i) {
+    tests.push_back(c.make(std::max(c.rows / 4, static_cast<size_t>(1)), 1, i));
+  }
+
+  common::MemoryTracker::Get()->SetEnabled(true);
+  common::MemoryTracker::Get()->ResetPeak();
+  common::PerfCounters::Get()->Reset();
+  common::Tracer::Get()->Start(static_cast<size_t>(1) << 20);
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_train})};
+  Args params{{"tree_method", tree_method}, {"max_depth", "8"}, {"eta", "0.1"}};
+  params.insert(params.end(), c.params.cbegin(), c.params.cend());
+  learner->SetParams(params);
+
+  // The first iteration includes quantization and other initialization.
+  timer.Reset();
+  learner->UpdateOneIter(0, p_train);
+  timer.Stop();
+  result["first_iteration_seconds"] = Number{timer.ElapsedSeconds()};
+  timer.Reset();
+  for (int32_t i = 1; i < opt.rounds; ++i) {
+    learner->UpdateOneIter(i, p_train);
+  }
+  timer.Stop();
+  result["iterations_per_second"] =
+      Number{opt.rounds > 1 ? (opt.rounds - 1) / timer.ElapsedSeconds() : 0.0};
+
+  HostDeviceVector<float> predt;
+  size_t n_predicted = 0;
+  timer.Reset();
+  for (auto const &p_test : tests) {
+    learner->Predict(p_test, false, &predt, 0, 0);
+    n_predicted += p_test->Info().num_row_;
+  }
+  timer.Stop();
+  result["predict_rows_per_second"] = Number{n_predicted / timer.ElapsedSeconds()};
+
+  std::string trace;
+  common::Tracer::Get()->Stop(&trace);
+  result["phases"] = Phases(trace);
+  result["counters"] = common::PerfCounters::Get()->ToJson();
+  result["memory"] = common::MemoryTracker::Get()->ToJson();
+  result["peak_rss_bytes"] = Integer{PeakRSS()};
+  return result;
+}
+
+std::vector<std::string> Split(std::string const &str) {
+  std::vector<std::string> out;
+  std::stringstream ss{str};
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    out.push_back(item);
+  }
+  return out;
+}
+
+Options ParseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    CHECK_LT(i + 1, argc) << "Missing value for " << arg;
+    std::string value{argv[++i]};
+    if (arg == "--rounds") {
+      opt.rounds = std::stoi(value);
+    } else if (arg == "--predict-repeats") {
+      opt.predict_repeats = std::stoi(value);
+    } else if (arg == "--scale") {
+      opt.scale = std::stod(value);
+    } else if (arg == "--filter") {
+      opt.filter = value;
+    } else if (arg == "--tree-method") {
+      opt.tree_methods = Split(value);
+    } else if (arg == "--output") {
+      opt.output = value;
+    } else if (arg == "--run-case") {
+      opt.run_case = value;
+    } else {
+      LOG(FATAL) << "Unknown argument: " << arg << "\n"
+                 << "Usage: " << argv[0] << " [--rounds N] [--predict-repeats N] "
+                 << "[--scale F] [--filter SUBSTRING] [--tree-method M1,M2] [--output FILE]";
+    }
+  }
+  CHECK_GE(opt.rounds, 1);
+  CHECK_GE(opt.predict_repeats, 1);
+  CHECK_GT(opt.scale, 0.0);
+  return opt;
+}
+
+/*! \brief Run a case in a child process and parse its output. */
+Json RunChild(std::string const &exe, std::string const &id, Options const &opt) {
+  std::stringstream cmd;
+  cmd << "\"" << exe << "\" --run-case " << id << " --rounds " << opt.rounds
+      << " --predict-repeats " << opt.predict_repeats << " --scale " << opt.scale;
+  auto *pipe = popen(cmd.str().c_str(), "r");
+  CHECK(pipe) << "Failed to run: " << cmd.str();
+  std::string out;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), pipe)) != 0) {
+    out.append(buffer, n);
+  }
+  CHECK_EQ(pclose(pipe), 0) << "Failed to run: " << cmd.str();
+  return Json::Load(StringView{out});
+}
+}  // anonymous namespace
+}  // namespace bench
+}  // namespace xgboost
+
+int main(int argc, char **argv) {
+  using namespace xgboost;  // NOLINT
+  auto opt = bench::ParseArgs(argc, argv);
+  auto cases = bench::Cases(opt.scale);
+
+  if (!opt.run_case.empty()) {
+    // Case ID is `name/tree_method`.
+    auto pos = opt.run_case.find('/');
+    CHECK_NE(pos, std::string::npos) << "Invalid case: " << opt.run_case;
+    auto name = opt.run_case.substr(0, pos);
+    auto it = std::find_if(cases.cbegin(), cases.cend(),
+                           [&](bench::Case const &c) { return c.name == name; });
+    CHECK(it != cases.cend()) << "Unknown case: " << name;
+    std::string str;
+    Json::Dump(bench::Run(*it, opt.run_case.substr(pos + 1), opt), &str);
+    std::cout << str << std::endl;
+    return 0;
+  }
+
+  Json results{Array{}};
+  for (auto const &c : cases) {
+    auto methods = opt.tree_methods.empty() ? c.tree_methods : opt.tree_methods;
+    for (auto const &method : methods) {
+      auto id = c.name + "/" + method;
+      if (id.find(opt.filter) == std::string::npos) {
+        continue;
+      }
+      LOG(CONSOLE) << "Running " << id;
+      get<Array>(results).push_back(bench::RunChild(argv[0], id, opt));
+    }
+  }
+
+  Json report{Object{}};
+  std::stringstream version;
+  version << XGBOOST_VER_MAJOR << "." << XGBOOST_VER_MINOR << "." << XGBOOST_VER_PATCH;
+  report["version"] = String{version.str()};
+  report["rounds"] = Integer{opt.rounds};
+  report["scale"] = Number{opt.scale};
+  report["results"] = results;
+  std::string str;
+  Json::Dump(report, &str);
+  if (opt.output.empty()) {
+    std::cout << str << std::endl;
+  } else {
+    std::ofstream fout{opt.output};
+    fout << str << std::endl;
+  }
+  return 0;
+}
@@ -7,7 +7,14 @@
 #include <xgboost/data.h>
 #include <xgboost/learner.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+
 #include "../helpers.h"
+#include "../../../src/common/base64.h"
 #include "../../../src/common/io.h"
 
 #include "../../../src/c_api/c_api_error.h"
@@ -148,6 +155,53 @@ TEST(CAPI, JsonModelIO) {
 
   ASSERT_EQ(model_str_0.front(), '{');
   ASSERT_EQ(model_str_0, model_str_1);
+
+  // UBJSON through file name extension.
+  std::string modelfile_ubj = tempdir.path + "/model.ubj";
+  ASSERT_EQ(XGBoosterSaveModel(handle, modelfile_ubj.c_str()), 0);
+  ASSERT_EQ(XGBoosterLoadModel(handle, modelfile_ubj.c_str()), 0);
+  XGBoosterSaveModel(handle, modelfile_1.c_str());
+  ASSERT_EQ(common::LoadSequentialFile(modelfile_1), model_str_0);
+
+  // Buffer in each format, loaded back with format detection.
+  for (std::string format : {"json", "ubj", "deprecated"}) {
+    bst_ulong len{0};
+    char const *data{nullptr};
+    std::string config = R"({"format": ")" + format + R"("})";
+    ASSERT_EQ(XGBoosterSaveModelToBuffer(handle, config.c_str(), &len, &data), 0);
+    std::string buffer{data, data + len};
+    if (format == "ubj") {
+      ASSERT_EQ(buffer, common::LoadSequentialFile(modelfile_ubj));
+    }
+    ASSERT_EQ(XGBoosterLoadModelFromBuffer(handle, buffer.data(), buffer.size()), 0);
+    if (format != "deprecated") {
+      XGBoosterSaveModel(handle, modelfile_1.c_str());
+      ASSERT_EQ(common::LoadSequentialFile(modelfile_1), model_str_0);
+    }
+  }
+}
+
+TEST(CAPI, SerializeToBase64) {
+  auto p_dmat = RandomDataGenerator(32, 10, 0).GenerateDMatrix(true);
+  std::shared_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->UpdateOneIter(0, p_dmat);
+  BoosterHandle handle = learner.get();
+
+  bst_ulong len{0};
+  char const *data{nullptr};
+  ASSERT_EQ(XGBoosterSerializeToBuffer(handle, &len, &data), 0);
+  std::string raw{data, data + len};
+  ASSERT_EQ(XGBoosterSerializeToBase64(handle, &len, &data), 0);
+  std::string text{data, data + len};
+  std::string expected;
+  common::base64::Encode(raw.data(), raw.size(), &expected);
+  ASSERT_EQ(text, expected);
+
+  std::shared_ptr<Learner> loaded{Learner::Create({p_dmat})};
+  ASSERT_EQ(XGBoosterUnserializeFromBase64(loaded.get(), text.data(), text.size()), 0);
+  ASSERT_EQ(XGBoosterSerializeToBuffer(loaded.get(), &len, &data), 0);
+  ASSERT_EQ(std::string(data, data + len), raw);
+  ASSERT_EQ(XGBoosterUnserializeFromBase64(loaded.get(), "a=b", 3), -1);
 }
 
 TEST(CAPI, CatchDMLCError) {
@@ -287,4 +341,572 @@ TEST(CAPI, BuildInfo) {
   ASSERT_TRUE(get<Object const>(loaded).find("USE_CUDA") != get<Object const>(loaded).cend());
   ASSERT_TRUE(get<Object const>(loaded).find("USE_NCCL") != get<Object const>(loaded).cend());
 }
+
+TEST(CAPI, PredictFromRows) {
+  size_t constexpr kRows = 16, kCols = 8;
+  auto gen = RandomDataGenerator{kRows, kCols, 0.2};
+  HostDeviceVector<float> storage;
+  gen.GenerateDense(&storage);
+  auto p_dmat = gen.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->SetParam("objective", "binary:logistic");
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_dmat);
+  }
+  BoosterHandle handle = learner.get();
+
+  auto const &h_data = storage.ConstHostVector();
+  for (auto type : {PredictionType::kValue, PredictionType::kMargin}) {
+    HostDeviceVector<float> expected;
+    learner->Predict(p_dmat, type == PredictionType::kMargin, &expected, 0, 0);
+    auto const &h_expected = expected.ConstHostVector();
+    float out{0};
+    for (size_t i = 0; i < kRows; ++i) {
+      ASSERT_EQ(XGBoosterPredictFromRows(handle, h_data.data() + i * kCols, 1, kCols,
+                                         std::numeric_limits<float>::quiet_NaN(),
+                                         static_cast<int>(type), 0, 0, &out, 1),
+                0);
+      ASSERT_NEAR(out, h_expected[i], kRtEps);
+    }
+    // Batch of all rows.
+    std::vector<float> batch(kRows);
+    ASSERT_EQ(XGBoosterPredictFromRows(handle, h_data.data(), kRows, kCols,
+                                       std::numeric_limits<float>::quiet_NaN(),
+                                       static_cast<int>(type), 0, 0, batch.data(),
+                                       batch.size()),
+              0);
+    for (size_t i = 0; i < kRows; ++i) {
+      ASSERT_NEAR(batch[i], h_expected[i], kRtEps);
+    }
+  }
+  // Output buffer is too small.
+  float out{0};
+  ASSERT_EQ(XGBoosterPredictFromRows(handle, h_data.data(), 2, kCols,
+                                     std::numeric_limits<float>::quiet_NaN(), 0, 0, 0, &out,
+                                     1),
+            -1);
+}
+
+TEST(CAPI, PredictManyFromDMatrix) {
+  size_t constexpr kRows = 128, kCols = 16;
+  for (float sparsity : {0.0f, 0.6f}) {
+    auto p_dmat = RandomDataGenerator{kRows, kCols, sparsity}.GenerateDMatrix(true);
+    std::vector<std::unique_ptr<Learner>> learners;
+    for (auto objective : {"binary:logistic", "reg:squarederror", "reg:logistic"}) {
+      learners.emplace_back(Learner::Create({p_dmat}));
+      learners.back()->SetParam("objective", objective);
+      learners.back()->SetParam("max_depth", std::to_string(learners.size() + 1));
+      learners.back()->SetParam("colsample_bytree", "0.5");
+      for (size_t i = 0; i < 4; ++i) {
+        learners.back()->UpdateOneIter(i, p_dmat);
+      }
+    }
+    DMatrixHandle dmat = &p_dmat;
+    for (bool margin : {false, true}) {
+      std::vector<HostDeviceVector<float>> expected(learners.size());
+      std::vector<BoosterHandle> handles;
+      for (size_t i = 0; i < learners.size(); ++i) {
+        learners[i]->Predict(p_dmat, margin, &expected[i], 0, 0);
+        handles.push_back(learners[i].get());
+      }
+      Json config{Object{}};
+      config["output_margin"] = Boolean{margin};
+      std::string str;
+      Json::Dump(config, &str);
+      std::vector<float const *> results(handles.size());
+      std::vector<bst_ulong> lens(handles.size());
+      ASSERT_EQ(XGBoosterPredictManyFromDMatrix(handles.data(), handles.size(), dmat,
+                                                str.c_str(), results.data(), lens.data()),
+                0);
+      for (size_t i = 0; i < handles.size(); ++i) {
+        auto const &h_expected = expected[i].ConstHostVector();
+        ASSERT_EQ(lens[i], h_expected.size());
+        for (size_t j = 0; j < lens[i]; ++j) {
+          ASSERT_NEAR(results[i][j], h_expected[j], kRtEps);
+        }
+      }
+    }
+  }
+
+  // Dart falls back to predicting boosters one by one.
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0.0f}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> gbtree{Learner::Create({p_dmat})};
+  std::unique_ptr<Learner> dart{Learner::Create({p_dmat})};
+  dart->SetParam("booster", "dart");
+  for (size_t i = 0; i < 2; ++i) {
+    gbtree->UpdateOneIter(i, p_dmat);
+    dart->UpdateOneIter(i, p_dmat);
+  }
+  HostDeviceVector<float> expected;
+  dart->Predict(p_dmat, false, &expected, 0, 0);
+  std::vector<BoosterHandle> handles{gbtree.get(), dart.get()};
+  std::vector<float const *> results(2);
+  std::vector<bst_ulong> lens(2);
+  DMatrixHandle dmat = &p_dmat;
+  char const *config = R"({"output_margin": false})";
+  ASSERT_EQ(XGBoosterPredictManyFromDMatrix(handles.data(), handles.size(), dmat, config,
+                                            results.data(), lens.data()),
+            0);
+  ASSERT_EQ(lens[1], kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_NEAR(results[1][i], expected.ConstHostVector()[i], kRtEps);
+  }
+  // Duplicated booster.
+  handles[1] = gbtree.get();
+  ASSERT_EQ(XGBoosterPredictManyFromDMatrix(handles.data(), handles.size(), dmat, config,
+                                            results.data(), lens.data()),
+            -1);
+}
+
+TEST(CAPI, PredictFromDenseIncremental) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->SetParam("objective", "binary:logistic");
+  BoosterHandle handle = learner.get();
+  HostDeviceVector<float> storage;
+  auto array = RandomDataGenerator{kRows, kCols, 0.2}.GenerateArrayInterface(&storage);
+
+  Json config{Object{}};
+  config["type"] = Integer{static_cast<int64_t>(PredictionType::kValue)};
+  config["training"] = Boolean{false};
+  config["iteration_begin"] = Integer{0};
+  config["iteration_end"] = Integer{0};
+  config["strict_shape"] = Boolean{false};
+  config["missing"] = Number{std::numeric_limits<float>::quiet_NaN()};
+  config["cache_id"] = Integer{0};
+  std::string str;
+  Json::Dump(config, &str);
+
+  std::vector<float> margin(kRows);
+  unsigned n_layers{0};
+  uint64_t fingerprint{0};
+  bst_ulong const *out_shape;
+  bst_ulong out_dim;
+  float const *out_result;
+  for (size_t round = 0; round < 6; round += 2) {
+    for (size_t i = round; i < round + 2; ++i) {
+      learner->UpdateOneIter(i, p_dmat);
+    }
+    ASSERT_EQ(XGBoosterPredictFromDense(handle, array.c_str(), str.c_str(), nullptr,
+                                        &out_shape, &out_dim, &out_result),
+              0);
+    std::vector<float> expected(out_result, out_result + kRows);
+    ASSERT_EQ(XGBoosterPredictFromDenseIncremental(handle, array.c_str(), str.c_str(),
+                                                   nullptr, margin.data(), margin.size(),
+                                                   &n_layers, &fingerprint, &out_shape,
+                                                   &out_dim, &out_result),
+              0);
+    ASSERT_EQ(n_layers, round + 2);
+    ASSERT_EQ(out_dim, 1);
+    ASSERT_EQ(out_shape[0], kRows);
+    for (size_t i = 0; i < kRows; ++i) {
+      ASSERT_NEAR(out_result[i], expected[i], kRtEps);
+    }
+  }
+
+  // Changed data is rejected.
+  storage.HostVector()[3] += 1.0f;
+  ASSERT_EQ(XGBoosterPredictFromDenseIncremental(handle, array.c_str(), str.c_str(), nullptr,
+                                                 margin.data(), margin.size(), &n_layers,
+                                                 &fingerprint, &out_shape, &out_dim,
+                                                 &out_result),
+            -1);
+  ASSERT_EQ(n_layers, 6);
+  // Restart the margin.
+  n_layers = 0;
+  ASSERT_EQ(XGBoosterPredictFromDenseIncremental(handle, array.c_str(), str.c_str(), nullptr,
+                                                 margin.data(), margin.size(), &n_layers,
+                                                 &fingerprint, &out_shape, &out_dim,
+                                                 &out_result),
+            0);
+  ASSERT_EQ(n_layers, 6);
+}
+
+TEST(CAPI, Train) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0}.Seed(1).GenerateDMatrix(true);
+  auto p_valid = RandomDataGenerator{kRows, kCols, 0}.Seed(2).GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_train, p_valid})};
+  learner->SetParam("eval_metric", "rmse");
+  BoosterHandle handle = learner.get();
+  DMatrixHandle dtrain = &p_train;
+  DMatrixHandle dmats[] = {&p_train, &p_valid};
+
+  bst_ulong n_rounds{0};
+  int best_iteration{0};
+  double best_score{0};
+  ASSERT_EQ(XGBoosterTrain(handle, dtrain, dmats, 2, R"({"num_boost_round": 8, "eval_period": 3})",
+                           &n_rounds, &best_iteration, &best_score),
+            0);
+  ASSERT_EQ(n_rounds, 8ul);
+  ASSERT_EQ(learner->BoostedRounds(), 8);
+  ASSERT_GE(best_iteration, 2);
+  ASSERT_LT(best_iteration, 8);
+  std::vector<std::string> names;
+  std::vector<double> scores;
+  learner->EvalMetrics({p_train, p_valid}, &names, &scores);
+  ASSERT_EQ(names, std::vector<std::string>{"rmse"});
+  ASSERT_EQ(scores.size(), 2ul);
+  std::string attr;
+  ASSERT_FALSE(learner->GetAttr("best_iteration", &attr));
+
+  // Maximizing the training error, which only improves in the first round.
+  ASSERT_EQ(XGBoosterTrain(handle, dtrain, dmats, 1,
+                           R"({"num_boost_round": 8, "early_stopping_rounds": 2,)"
+                           R"( "metric": "rmse", "maximize": true})",
+                           &n_rounds, &best_iteration, &best_score),
+            0);
+  ASSERT_EQ(n_rounds, 3ul);
+  ASSERT_EQ(best_iteration, 8);
+  ASSERT_EQ(learner->BoostedRounds(), 11);
+  ASSERT_TRUE(learner->GetAttr("best_iteration", &attr));
+  ASSERT_EQ(attr, "8");
+
+  // Unknown metric.
+  ASSERT_EQ(XGBoosterTrain(handle, dtrain, dmats, 1,
+                           R"({"num_boost_round": 1, "metric": "auc"})", &n_rounds,
+                           &best_iteration, &best_score),
+            -1);
+}
+
+TEST(CAPI, TrainSweep) {
+  size_t constexpr kRows = 128, kCols = 8, kBoosters = 4;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0}.Seed(1).GenerateDMatrix(true);
+  auto p_valid = RandomDataGenerator{kRows, kCols, 0}.Seed(2).GenerateDMatrix(true);
+  std::vector<std::unique_ptr<Learner>> learners;
+  std::vector<BoosterHandle> handles;
+  for (size_t i = 0; i < kBoosters; ++i) {
+    learners.emplace_back(Learner::Create({p_train, p_valid}));
+    learners.back()->SetParams({{"tree_method", "hist"},
+                                {"eta", std::to_string(0.1 * (i + 1))},
+                                {"eval_metric", "rmse"}});
+    handles.push_back(learners.back().get());
+  }
+  DMatrixHandle dtrain = &p_train;
+  DMatrixHandle dmats[] = {&p_train};
+
+  std::vector<bst_ulong> n_rounds(kBoosters);
+  std::vector<int> best_iteration(kBoosters);
+  std::vector<double> best_score(kBoosters);
+  // Ranked by training error, after 2 rounds only 2 boosters continue, after 4 rounds only 1.
+  ASSERT_EQ(XGBoosterTrainSweep(handles.data(), kBoosters, dtrain, dmats, 1,
+                                R"({"num_boost_round": 6, "rung_rounds": 2, "nthread": 2})",
+                                n_rounds.data(), best_iteration.data(), best_score.data()),
+            0);
+  std::vector<bst_ulong> sorted{n_rounds};
+  std::sort(sorted.begin(), sorted.end());
+  ASSERT_EQ(sorted, (std::vector<bst_ulong>{2, 2, 4, 6}));
+  for (size_t i = 0; i < kBoosters; ++i) {
+    ASSERT_EQ(learners[i]->BoostedRounds(), static_cast<int32_t>(n_rounds[i]));
+    ASSERT_EQ(best_iteration[i], static_cast<int>(n_rounds[i]) - 1);
+    // The training error decreases with larger learning rate.
+    if (i != kBoosters - 1) {
+      ASSERT_LE(n_rounds[i], n_rounds[i + 1]);
+    }
+  }
+  ASSERT_EQ(n_rounds.back(), 6ul);
+
+  // Without evaluation data all boosters are trained fully.
+  ASSERT_EQ(XGBoosterTrainSweep(handles.data(), kBoosters, dtrain, nullptr, 0,
+                                R"({"num_boost_round": 3})", n_rounds.data(),
+                                best_iteration.data(), best_score.data()),
+            0);
+  for (size_t i = 0; i < kBoosters; ++i) {
+    ASSERT_EQ(n_rounds[i], 3ul);
+    ASSERT_EQ(best_iteration[i], -1);
+  }
+  // Halving requires evaluation data.
+  ASSERT_EQ(XGBoosterTrainSweep(handles.data(), kBoosters, dtrain, nullptr, 0,
+                                R"({"num_boost_round": 3, "rung_rounds": 1})", n_rounds.data(),
+                                best_iteration.data(), best_score.data()),
+            -1);
+}
+
+TEST(CAPI, DumpModelTable) {
+  size_t constexpr kRows = 128, kCols = 8, kRounds = 4;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0.2}.Seed(1).GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_train})};
+  learner->SetParam("max_depth", "3");
+  for (size_t i = 0; i < kRounds; ++i) {
+    learner->UpdateOneIter(i, p_train);
+  }
+  BoosterHandle handle = learner.get();
+  bst_ulong n_nodes{0};
+  char const* out{nullptr};
+  ASSERT_EQ(XGBoosterDumpModelTable(handle, "{}", &n_nodes, &out), 0);
+  auto table = Json::Load(StringView{out});
+  auto column = [&](char const* name) {
+    EXPECT_EQ(get<Integer const>(table[name]["shape"][0]), static_cast<int64_t>(n_nodes));
+    return get<Integer const>(table[name]["data"][0]);
+  };
+  auto tree_id = reinterpret_cast<int32_t const*>(column("tree_id"));
+  auto node_id = reinterpret_cast<int32_t const*>(column("node_id"));
+  auto feature = reinterpret_cast<int32_t const*>(column("feature"));
+  auto value = reinterpret_cast<float const*>(column("value"));
+  auto left = reinterpret_cast<int32_t const*>(column("left"));
+
+  // compare with the JSON dump
+  auto dumps = learner->DumpModel(FeatureMap{}, true, "json");
+  ASSERT_EQ(dumps.size(), kRounds);
+  size_t n_leaves = 0;
+  for (auto const& dump : dumps) {
+    std::string::size_type pos = 0;
+    while ((pos = dump.find("\"leaf\"", pos)) != std::string::npos) {
+      ++n_leaves;
+      ++pos;
+    }
+  }
+  size_t n_table_leaves = 0;
+  for (bst_ulong i = 0; i < n_nodes; ++i) {
+    ASSERT_LT(tree_id[i], static_cast<int32_t>(kRounds));
+    if (feature[i] < 0) {
+      ++n_table_leaves;
+      ASSERT_EQ(left[i], -1);
+    } else {
+      ASSERT_LT(feature[i], static_cast<int32_t>(kCols));
+      ASSERT_FALSE(std::isnan(value[i]));
+      ASSERT_GT(left[i], node_id[i]);
+    }
+  }
+  ASSERT_EQ(n_leaves, n_table_leaves);
+}
+
+TEST(CAPI, PerfCounters) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_train})};
+  learner->SetParam("tree_method", "hist");
+  BoosterHandle handle = learner.get();
+
+  char const* out;
+  ASSERT_EQ(XGBoosterGetPerfCounters(handle, R"({"reset": true})", &out), 0);
+  for (int32_t i = 0; i < 2; ++i) {
+    learner->UpdateOneIter(i, p_train);
+  }
+  ASSERT_EQ(XGBoosterGetPerfCounters(handle, R"({"reset": true})", &out), 0);
+  auto counters = Json::Load(StringView{out});
+  ASSERT_EQ(get<Integer const>(counters["boosted_rounds"]), 2);
+  ASSERT_GE(get<Integer const>(counters["hist_rows"]), static_cast<int64_t>(kRows * 2));
+  ASSERT_GE(get<Integer const>(counters["prediction_cache_misses"]), 1);
+  ASSERT_GE(get<Integer const>(counters["prediction_cache_hits"]), 1);
+  ASSERT_GT(get<Integer const>(counters["hist_pool_bytes"]), 0);
+
+  ASSERT_EQ(XGBoosterGetPerfCounters(handle, nullptr, &out), 0);
+  counters = Json::Load(StringView{out});
+  ASSERT_EQ(get<Integer const>(counters["boosted_rounds"]), 0);
+}
+
+TEST(CAPI, MemoryUsage) {
+  ASSERT_EQ(XGBSetGlobalConfig(R"({"track_memory": true})"), 0);
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_train})};
+  learner->SetParam("tree_method", "hist");
+  learner->UpdateOneIter(0, p_train);
+
+  char const* out;
+  ASSERT_EQ(XGBGetMemoryUsage(R"({"reset_peak": true})", &out), 0);
+  auto usage = Json::Load(StringView{out});
+  ASSERT_GT(get<Integer const>(usage["prediction_cache"]["current"]), 0);
+  ASSERT_GT(get<Integer const>(usage["gradient_index"]["peak"]), 0);
+  ASSERT_GT(get<Integer const>(usage["hist_collection"]["peak"]), 0);
+
+  learner.reset();
+  ASSERT_EQ(XGBGetMemoryUsage(nullptr, &out), 0);
+  usage = Json::Load(StringView{out});
+  ASSERT_EQ(get<Integer const>(usage["hist_collection"]["current"]), 0);
+  ASSERT_EQ(XGBSetGlobalConfig(R"({"track_memory": false})"), 0);
+}
+
+TEST(CAPI, BoostOneIterFromInterface) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0}.Seed(1).GenerateDMatrix(true);
+  DMatrixHandle dtrain = &p_train;
+
+  HostDeviceVector<float> grad(kRows), hess(kRows), interleaved(kRows * 2);
+  SimpleLCG lcg;
+  SimpleRealUniformDistribution<float> dist{0.1f, 1.0f};
+  for (size_t i = 0; i < kRows; ++i) {
+    grad.HostVector()[i] = dist(&lcg) - 0.5f;
+    hess.HostVector()[i] = dist(&lcg);
+    interleaved.HostVector()[i * 2] = grad.HostVector()[i];
+    interleaved.HostVector()[i * 2 + 1] = hess.HostVector()[i];
+  }
+  std::string grad_str, hess_str, interleaved_str;
+  Json::Dump(GetArrayInterface(&grad, kRows, 1), &grad_str);
+  Json::Dump(GetArrayInterface(&hess, kRows, 1), &hess_str);
+  Json::Dump(GetArrayInterface(&interleaved, kRows, 2), &interleaved_str);
+
+  auto train = [&](std::function<int(BoosterHandle)> boost) {
+    std::unique_ptr<Learner> learner{Learner::Create({p_train})};
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(boost(learner.get()), 0);
+    }
+    Json model{Object()};
+    learner->SaveModel(&model);
+    return model;
+  };
+  auto expected = train([&](BoosterHandle handle) {
+    return XGBoosterBoostOneIter(handle, dtrain, grad.HostPointer(), hess.HostPointer(),
+                                 kRows);
+  });
+  auto split = train([&](BoosterHandle handle) {
+    return XGBoosterBoostOneIterFromInterface(handle, dtrain, 0, grad_str.c_str(),
+                                              hess_str.c_str());
+  });
+  ASSERT_EQ(split, expected);
+  auto fused = train([&](BoosterHandle handle) {
+    return XGBoosterBoostOneIterFromInterface(handle, dtrain, 0, interleaved_str.c_str(),
+                                              nullptr);
+  });
+  ASSERT_EQ(fused, expected);
+
+  // interleaved gradient must have 2 columns.
+  std::unique_ptr<Learner> learner{Learner::Create({p_train})};
+  ASSERT_EQ(XGBoosterBoostOneIterFromInterface(learner.get(), dtrain, 0, grad_str.c_str(),
+                                               nullptr),
+            -1);
+}
+
+TEST(CAPI, PredictionSession) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_dmat);
+  }
+  BoosterHandle handle = learner.get();
+  DMatrixHandle dmat = &p_dmat;
+
+  Json config{Object{}};
+  config["type"] = Integer{static_cast<int64_t>(PredictionType::kMargin)};
+  config["training"] = Boolean{false};
+  config["iteration_begin"] = Integer{0};
+  config["iteration_end"] = Integer{2};
+  config["strict_shape"] = Boolean{false};
+  std::string str;
+  Json::Dump(config, &str);
+
+  bst_ulong const *shape;
+  bst_ulong dim;
+  float const *expected;
+  ASSERT_EQ(XGBoosterPredictFromDMatrix(handle, dmat, str.c_str(), &shape, &dim, &expected),
+            0);
+  std::vector<float> h_expected(expected, expected + kRows);
+
+  PredictionSessionHandle session;
+  ASSERT_EQ(XGBoosterCreatePredictionSession(handle, str.c_str(), &session), 0);
+  std::vector<std::thread> workers;
+  std::vector<int32_t> results(4, -1);
+  for (size_t t = 0; t < results.size(); ++t) {
+    workers.emplace_back([&, t]() {
+      int32_t correct = 1;
+      for (size_t i = 0; i < 4; ++i) {
+        bst_ulong const *out_shape;
+        bst_ulong out_dim;
+        float const *out_result;
+        if (XGPredictionSessionPredictFromDMatrix(session, dmat, &out_shape, &out_dim,
+                                                  &out_result) != 0 ||
+            out_dim != 1 || out_shape[0] != kRows ||
+            !std::equal(h_expected.cbegin(), h_expected.cend(), out_result)) {
+          correct = 0;
+        }
+      }
+      results[t] = correct;
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  for (auto r : results) {
+    ASSERT_EQ(r, 1);
+  }
+  ASSERT_EQ(XGPredictionSessionFree(session), 0);
+}
+
+namespace {
+void CountPredictCallback(void *user_data, int status, char const *) {
+  if (status == 0) {
+    static_cast<std::atomic<int32_t> *>(user_data)->fetch_add(1);
+  } else {
+    static_cast<std::atomic<int32_t> *>(user_data)->fetch_sub(1000);
+  }
+}
+}  // anonymous namespace
+
+TEST(CAPI, PredictAsync) {
+  size_t constexpr kRows = 32, kCols = 8;
+  auto gen = RandomDataGenerator{kRows, kCols, 0.2};
+  HostDeviceVector<float> storage;
+  gen.GenerateDense(&storage);
+  auto p_dmat = gen.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->SetParam("objective", "binary:logistic");
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_dmat);
+  }
+  BoosterHandle handle = learner.get();
+  HostDeviceVector<float> expected;
+  learner->Predict(p_dmat, false, &expected, 0, 0);
+  auto const &h_expected = expected.ConstHostVector();
+  auto const &h_data = storage.ConstHostVector();
+
+  // Keep all rows in flight from a single thread.
+  std::atomic<int32_t> n_done{0};
+  std::vector<float> out(kRows, 0);
+  std::vector<PredictFutureHandle> futures(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_EQ(XGBoosterPredictFromRowsAsync(handle, h_data.data() + i * kCols, 1, kCols,
+                                            std::numeric_limits<float>::quiet_NaN(), 0, 0, 0,
+                                            out.data() + i, 1, CountPredictCallback, &n_done,
+                                            &futures[i]),
+              0);
+  }
+  for (auto fut : futures) {
+    ASSERT_EQ(XGPredictFutureWait(fut), 0);
+    int ready{0};
+    ASSERT_EQ(XGPredictFutureReady(fut, &ready), 0);
+    ASSERT_EQ(ready, 1);
+    ASSERT_EQ(XGPredictFutureFree(fut), 0);
+  }
+  ASSERT_EQ(n_done.load(), static_cast<int32_t>(kRows));
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_NEAR(out[i], h_expected[i], kRtEps);
+  }
+
+  // Prediction session with DMatrix.
+  Json config{Object{}};
+  config["type"] = Integer{static_cast<int64_t>(PredictionType::kValue)};
+  config["training"] = Boolean{false};
+  config["iteration_begin"] = Integer{0};
+  config["iteration_end"] = Integer{0};
+  config["strict_shape"] = Boolean{false};
+  std::string str;
+  Json::Dump(config, &str);
+  PredictionSessionHandle session;
+  ASSERT_EQ(XGBoosterCreatePredictionSession(handle, str.c_str(), &session), 0);
+  DMatrixHandle dmat = &p_dmat;
+  PredictFutureHandle fut;
+  std::fill(out.begin(), out.end(), 0);
+  ASSERT_EQ(XGPredictionSessionPredictAsync(session, dmat, out.data(), out.size(), nullptr,
+                                            nullptr, &fut),
+            0);
+  ASSERT_EQ(XGPredictFutureWait(fut), 0);
+  ASSERT_EQ(XGPredictFutureFree(fut), 0);
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_NEAR(out[i], h_expected[i], kRtEps);
+  }
+
+  // Errors are reported through both the callback and the future.
+  n_done = 0;
+  ASSERT_EQ(XGPredictionSessionPredictAsync(session, dmat, out.data(), 1,
+                                            CountPredictCallback, &n_done, &fut),
+            0);
+  ASSERT_EQ(XGPredictFutureWait(fut), -1);
+  ASSERT_NE(std::string{XGBGetLastError()}.find("too small"), std::string::npos);
+  ASSERT_EQ(XGPredictFutureFree(fut), 0);
+  ASSERT_EQ(n_done.load(), -1000);
+  ASSERT_EQ(XGPredictionSessionFree(session), 0);
+}
 }  // namespace xgboost
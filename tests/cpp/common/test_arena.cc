@@ -0,0 +1,59 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "../../../src/common/arena.h"
+
+namespace xgboost {
+namespace common {
+TEST(Arena, Alloc) {
+  Arena arena;
+  ASSERT_EQ(arena.Capacity(), 0);
+  auto a = arena.Alloc<int32_t>(16, 3);
+  ASSERT_EQ(a.size(), 16);
+  for (auto v : a) {
+    ASSERT_EQ(v, 3);
+  }
+  auto b = arena.Alloc<double>(3);
+  ASSERT_EQ(reinterpret_cast<std::uintptr_t>(b.data()) % alignof(double), 0);
+  ASSERT_GE(reinterpret_cast<char*>(b.data()),
+            reinterpret_cast<char*>(a.data() + a.size()));
+  ASSERT_EQ(arena.Capacity(), Arena::kMinBlockSize);
+
+  // Larger than a block.
+  auto c = arena.Alloc<char>(Arena::kMinBlockSize * 3);
+  ASSERT_EQ(c.size(), Arena::kMinBlockSize * 3);
+  auto capacity = arena.Capacity();
+  ASSERT_GT(capacity, Arena::kMinBlockSize * 3);
+
+  // Blocks are merged, the same amount of allocation doesn't grow the arena.
+  arena.Reset();
+  ASSERT_EQ(arena.Capacity(), capacity);
+  arena.Alloc<int32_t>(16);
+  arena.Alloc<double>(3);
+  arena.Alloc<char>(Arena::kMinBlockSize * 3);
+  ASSERT_EQ(arena.Capacity(), capacity);
+}
+
+TEST(Arena, Vector) {
+  Arena arena;
+  ArenaVector<int32_t> vec{ArenaAllocator<int32_t>{&arena}};
+  for (int32_t i = 0; i < 1024; ++i) {
+    vec.push_back(i);
+  }
+  for (int32_t i = 0; i < 1024; ++i) {
+    ASSERT_EQ(vec[i], i);
+  }
+  ArenaVector<ArenaVector<int32_t>> nested{ArenaAllocator<ArenaVector<int32_t>>{&arena}};
+  nested.resize(4, vec);
+  ASSERT_EQ(nested[3].back(), 1023);
+  ASSERT_TRUE(nested[3].get_allocator() == vec.get_allocator());
+
+  Arena other;
+  ASSERT_FALSE(ArenaAllocator<int32_t>{&other} == vec.get_allocator());
+}
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,67 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+#include "../../../src/common/base64.h"
+#include "../../../src/common/io.h"
+#include "../../../src/common/random.h"
+
+namespace xgboost {
+namespace common {
+TEST(Base64, Codec) {
+  auto& rng = GlobalRandom();
+  for (size_t n : {0, 1, 2, 3, 4, 29, 30, 31, 32, 33, 1000, 4097}) {
+    std::string raw(n, '\0');
+    for (auto& c : raw) {
+      c = static_cast<char>(rng());
+    }
+    std::string expected;
+    {
+      MemoryBufferStream fo(&expected);
+      Base64OutStream out(&fo);
+      // Unaligned writes go through the pending bytes of stream.
+      out.Write(raw.data(), n / 2);
+      out.Write(raw.data() + n / 2, n - n / 2);
+      out.Finish();
+    }
+    ASSERT_EQ(expected.size(), (n + 2) / 3 * 4);
+    std::string encoded;
+    base64::Encode(raw.data(), raw.size(), &encoded);
+    ASSERT_EQ(encoded, expected);
+
+    std::string decoded;
+    base64::Decode(encoded.data(), encoded.size(), &decoded);
+    ASSERT_EQ(decoded, raw);
+
+    // Reader buffer smaller than the text forces groups to cross the buffer boundary.
+    for (size_t buffer_size : {7, 256}) {
+      std::string text = " " + encoded + "\n";
+      MemoryFixSizeBuffer fi(&text[0], text.size());
+      Base64InStream in(&fi, buffer_size);
+      in.InitPosition();
+      std::string read(n, '\0');
+      size_t pos = 0, chunk = 1;
+      while (pos < n) {
+        auto got = in.Read(&read[pos], std::min(chunk, n - pos));
+        ASSERT_NE(got, 0);
+        pos += got;
+        chunk = chunk * 3 + 1;
+      }
+      ASSERT_EQ(read, raw);
+    }
+  }
+
+  std::string invalid(64, 'A');
+  invalid[40] = '*';
+  std::string decoded;
+  ASSERT_THROW(base64::Decode(invalid.data(), invalid.size(), &decoded), dmlc::Error);
+  invalid[40] = static_cast<char>(0xC1);
+  ASSERT_THROW(base64::Decode(invalid.data(), invalid.size(), &decoded), dmlc::Error);
+  ASSERT_THROW(base64::Decode(invalid.data(), invalid.size() - 1, &decoded), dmlc::Error);
+}
+}  // namespace common
+}  // namespace xgboost
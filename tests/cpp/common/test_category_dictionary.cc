@@ -0,0 +1,103 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/json.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../../../src/common/category_dictionary.h"
+
+namespace xgboost {
+namespace common {
+namespace {
+bst_cat_t Insert(CategoryDictionary *dict, bst_feature_t fidx, std::string const &str) {
+  return dict->Insert(fidx, str.data(), str.size());
+}
+bst_cat_t Find(CategoryDictionary const &dict, bst_feature_t fidx, std::string const &str) {
+  return dict.Find(fidx, str.data(), str.size());
+}
+}  // anonymous namespace
+
+TEST(CategoryDictionary, Insert) {
+  CategoryDictionary dict{2};
+  ASSERT_TRUE(dict.Empty());
+  // Enough categories to grow the table a few times.
+  size_t constexpr kCats = 1000;
+  for (size_t i = 0; i < kCats; ++i) {
+    ASSERT_EQ(Insert(&dict, 1, "cat_" + std::to_string(i)), static_cast<bst_cat_t>(i));
+  }
+  ASSERT_FALSE(dict.Empty());
+  // Existing categories keep their codes.
+  ASSERT_EQ(Insert(&dict, 1, "cat_3"), 3);
+  ASSERT_EQ(dict.Categories(1).size(), kCats);
+  for (size_t i = 0; i < kCats; ++i) {
+    ASSERT_EQ(Find(dict, 1, "cat_" + std::to_string(i)), static_cast<bst_cat_t>(i));
+  }
+  ASSERT_EQ(Find(dict, 0, "cat_0"), CategoryDictionary::kUnknown);
+  ASSERT_EQ(Find(dict, 1, "cat"), CategoryDictionary::kUnknown);
+  ASSERT_EQ(Find(dict, 4, "cat_0"), CategoryDictionary::kUnknown);
+  // Empty string is a valid category.
+  ASSERT_EQ(Insert(&dict, 0, ""), 0);
+  ASSERT_EQ(Find(dict, 0, ""), 0);
+}
+
+TEST(CategoryDictionary, MergeRemap) {
+  CategoryDictionary model{2};
+  Insert(&model, 0, "a");
+  Insert(&model, 0, "b");
+  Insert(&model, 1, "x");
+
+  CategoryDictionary data{3};
+  Insert(&data, 0, "b");
+  Insert(&data, 0, "c");
+  Insert(&data, 0, "a");
+  Insert(&data, 1, "x");
+
+  std::vector<std::vector<float>> map;
+  ASSERT_FALSE(model.Remap(data, &map));
+  ASSERT_EQ(map.size(), 3);
+  ASSERT_EQ(map[0].size(), 3);
+  ASSERT_EQ(map[0][0], 1);
+  ASSERT_TRUE(std::isnan(map[0][1]));
+  ASSERT_EQ(map[0][2], 0);
+  // Same codes.
+  ASSERT_TRUE(map[1].empty());
+  ASSERT_TRUE(map[2].empty());
+
+  model.Merge(data);
+  ASSERT_EQ(model.NumFeatures(), 3);
+  ASSERT_EQ(model.Categories(0), std::vector<std::string>({"a", "b", "c"}));
+  ASSERT_FALSE(model.Remap(data, &map));
+  ASSERT_EQ(map[0], std::vector<float>({1, 2, 0}));
+
+  CategoryDictionary prefix{1};
+  Insert(&prefix, 0, "a");
+  Insert(&prefix, 0, "b");
+  ASSERT_TRUE(model.Remap(prefix, &map));
+}
+
+TEST(CategoryDictionary, IO) {
+  CategoryDictionary dict{3};
+  Insert(&dict, 0, "a");
+  Insert(&dict, 0, "b");
+  Insert(&dict, 2, "\"quoted\"");
+
+  Json out;
+  dict.SaveModel(&out);
+  std::string str;
+  Json::Dump(out, &str);
+
+  CategoryDictionary loaded;
+  loaded.LoadModel(Json::Load(StringView{str}));
+  ASSERT_EQ(loaded.NumFeatures(), 3);
+  ASSERT_TRUE(loaded.Categories(1).empty());
+  ASSERT_EQ(Find(loaded, 0, "b"), 1);
+  ASSERT_EQ(Find(loaded, 2, "\"quoted\""), 0);
+  // Loaded dictionary can be extended.
+  ASSERT_EQ(Insert(&loaded, 0, "c"), 2);
+}
+}  // namespace common
+}  // namespace xgboost
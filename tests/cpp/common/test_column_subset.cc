@@ -0,0 +1,55 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../../../src/common/column_subset.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace common {
+TEST(ColumnSubset, Init) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0}.Seed(3).GenerateDMatrix();
+  GHistIndexMatrix gmat(p_fmat.get(), 16);
+  ASSERT_TRUE(gmat.IsDense());
+  auto const &ptrs = gmat.cut.Ptrs();
+
+  ColumnSubset subset;
+  for (auto const &features : std::vector<std::vector<bst_feature_t>>{{1, 4, 5}, {0, 7}}) {
+    // Reinitialized with a different subset, as it's done for each tree.
+    subset.Init(gmat, features, 2);
+    ASSERT_EQ(subset.NumFeatures(), features.size());
+    auto const &index = subset.Index();
+    ASSERT_TRUE(index.IsDense());
+    ASSERT_EQ(index.Size(), kRows);
+    ASSERT_EQ(index.index.GetBinTypeSize(), gmat.index.GetBinTypeSize());
+    ASSERT_EQ(index.hit_count.size(), index.cut.TotalBins());
+
+    for (bst_feature_t f = 0; f < kCols; ++f) {
+      auto it = std::find(features.cbegin(), features.cend(), f);
+      ASSERT_EQ(subset.Contains(f), it != features.cend());
+    }
+    for (size_t j = 0; j < features.size(); ++j) {
+      auto f = features[j];
+      auto begin = subset.FeatureBegin(f);
+      ASSERT_EQ(begin, index.cut.Ptrs()[j]);
+      auto n_bins = ptrs[f + 1] - ptrs[f];
+      ASSERT_EQ(index.cut.Ptrs()[j + 1] - begin, n_bins);
+      ASSERT_EQ(index.cut.MinValues()[j], gmat.cut.MinValues()[f]);
+      for (size_t k = 0; k < n_bins; ++k) {
+        ASSERT_EQ(index.cut.Values()[begin + k], gmat.cut.Values()[ptrs[f] + k]);
+        ASSERT_EQ(index.hit_count[begin + k], gmat.hit_count[ptrs[f] + k]);
+      }
+      for (size_t r = 0; r < kRows; ++r) {
+        ASSERT_EQ(index.index[r * features.size() + j] - begin,
+                  gmat.index[r * kCols + f] - ptrs[f]);
+      }
+    }
+  }
+}
+}  // namespace common
+}  // namespace xgboost
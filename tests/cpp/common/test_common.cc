@@ -10,5 +10,21 @@ TEST(ArgSort, Basic) {
   std::vector<bst_feature_t> sol{2, 1, 0};
   ASSERT_EQ(ret, sol);
 }
+
+TEST(DefaultInitAllocator, Basic) {
+  std::vector<uint32_t, DefaultInitAllocator<uint32_t>> vec;
+  vec.resize(16, 3);
+  for (auto v : vec) {
+    ASSERT_EQ(v, 3);
+  }
+  vec.resize(32);
+  ASSERT_EQ(vec.size(), 32);
+  vec.push_back(7);
+  ASSERT_EQ(vec.back(), 7);
+  ASSERT_EQ(vec.front(), 3);
+
+  std::vector<std::string, DefaultInitAllocator<std::string>> strs(2);
+  ASSERT_TRUE(strs[0].empty());
+}
 }  // namespace common
 }  // namespace xgboost
@@ -0,0 +1,82 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../../src/common/compression.h"
+#include "../../../src/common/io.h"
+
+namespace xgboost {
+namespace common {
+TEST(Compression, LZ) {
+  std::mt19937 rng{3};
+  // Larger than a chunk to test the parallel path.
+  for (size_t n : {0ul, 1ul, 4ul, 17ul, 1000ul, (1ul << 20) + 17}) {
+    std::vector<uint8_t> random(n), repeated(n);
+    for (size_t i = 0; i < n; ++i) {
+      random[i] = static_cast<uint8_t>(rng());
+      repeated[i] = static_cast<uint8_t>(i % 7);
+    }
+    for (auto const &input : {random, repeated}) {
+      std::vector<uint8_t> compressed;
+      LZCompress(input, &compressed);
+      std::vector<uint8_t> decompressed(n);
+      ASSERT_TRUE(LZDecompress(compressed, decompressed));
+      ASSERT_EQ(decompressed, input);
+
+      std::string buffer;
+      MemoryBufferStream fo{&buffer};
+      auto bytes = WriteBlock(BlockCodec::kLZ, Span<uint8_t const>{input}, &fo);
+      ASSERT_EQ(bytes, buffer.size());
+      MemoryBufferStream fi{&buffer};
+      std::vector<uint8_t> loaded;
+      ASSERT_TRUE(ReadBlock(&fi, &loaded));
+      ASSERT_EQ(loaded, input);
+      ASSERT_FALSE(ReadBlock(&fi, &loaded));
+    }
+    std::vector<uint8_t> compressed;
+    LZCompress(repeated, &compressed);
+    if (n > 100) {
+      ASSERT_LT(compressed.size(), n / 10);
+    }
+    if (n > 1) {
+      // Corrupted input is detected instead of writing out of bounds.
+      compressed.resize(compressed.size() - 1);
+      std::vector<uint8_t> decompressed(n);
+      ASSERT_FALSE(LZDecompress(compressed, decompressed));
+    }
+  }
+}
+
+TEST(Compression, DeltaVarint) {
+  std::vector<uint64_t> values{0, 3, 3, 10, 1ul << 40, 5, std::numeric_limits<uint64_t>::max(),
+                               0};
+  std::string buffer;
+  MemoryBufferStream fo{&buffer};
+  auto bytes = WriteIntegerBlock(BlockCodec::kDeltaVarint, Span<uint64_t const>{values}, &fo);
+  ASSERT_EQ(bytes, buffer.size());
+  MemoryBufferStream fi{&buffer};
+  std::vector<uint64_t> loaded;
+  ASSERT_TRUE(ReadBlock(&fi, &loaded));
+  ASSERT_EQ(loaded, values);
+
+  std::vector<size_t> offsets(1000);
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    offsets[i] = offsets[i - 1] + i % 50;
+  }
+  std::vector<uint8_t> encoded;
+  DeltaVarintEncode(Span<size_t const>{offsets}, &encoded);
+  // Each delta fits in a single byte.
+  ASSERT_EQ(encoded.size(), offsets.size());
+  std::vector<size_t> decoded(offsets.size());
+  ASSERT_TRUE(DeltaVarintDecode(Span<uint8_t const>{encoded}, Span<size_t>{decoded}));
+  ASSERT_EQ(decoded, offsets);
+  ASSERT_FALSE(DeltaVarintDecode(Span<uint8_t const>{encoded}.subspan(1), Span<size_t>{decoded}));
+}
+}  // namespace common
+}  // namespace xgboost
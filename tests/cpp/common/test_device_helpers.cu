@@ -173,6 +173,34 @@ TEST(Allocator, OOM) {
   cudaGetLastError();
 }
 
+TEST(Allocator, MemoryPool) {
+  dh::safe_cuda(cudaSetDevice(0));
+  if (!dh::detail::DeviceMemoryPoolAvailable()) {
+    GTEST_SKIP() << "Memory pool is not supported.";
+  }
+  size_t constexpr kBytes = 1 << 24;
+  auto before = dh::detail::GetDeviceMemoryPoolStats(0);
+  {
+    dh::device_vector<char> vec(kBytes);
+    auto during = dh::detail::GetDeviceMemoryPoolStats(0);
+    ASSERT_GE(during.used, before.used + kBytes);
+    ASSERT_GE(during.used_high, kBytes);
+  }
+  dh::safe_cuda(cudaDeviceSynchronize());
+  auto after = dh::detail::GetDeviceMemoryPoolStats(0);
+  ASSERT_EQ(after.used, before.used);
+  // Freed memory is kept by the pool.
+  ASSERT_GE(after.reserved, kBytes);
+
+  auto config = GlobalConfigThreadLocalStore::Get();
+  config->use_device_memory_pool = false;
+  {
+    dh::device_vector<char> vec(kBytes);
+    ASSERT_EQ(dh::detail::GetDeviceMemoryPoolStats(0).used, before.used);
+  }
+  config->use_device_memory_pool = true;
+}
+
 TEST(DeviceHelpers, ArgSort) {
   dh::device_vector<float> values(20);
   dh::Iota(dh::ToSpan(values));  // accending
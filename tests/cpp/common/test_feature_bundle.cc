@@ -0,0 +1,72 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../../../src/common/feature_bundle.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace common {
+TEST(FeatureBundles, Unbundle) {
+  size_t constexpr kRows = 1024, kGroups = 4, kLevels = 8, kDense = 3;
+  size_t constexpr kCols = kGroups * kLevels + kDense;
+  auto x = GenerateOneHotColumns(kRows, kGroups, kLevels, kDense);
+  auto p_fmat = GetDMatrixFromData(x, kRows, kCols);
+  GHistIndexMatrix gmat(p_fmat.get(), 64);
+  ASSERT_TRUE(gmat.IsDense());
+
+  FeatureBundles bundles{gmat, {}, 2};
+  ASSERT_EQ(bundles.NumFeatures(), kCols);
+  // Levels of each categorical variable are bundled together.
+  ASSERT_EQ(bundles.NumBundles(), kGroups + kDense);
+  for (size_t j = 0; j < kGroups * kLevels; ++j) {
+    ASSERT_TRUE(bundles.IsBundled(j));
+    ASSERT_EQ(bundles.BundleRange(j), bundles.BundleRange(j / kLevels * kLevels));
+  }
+  for (size_t j = kGroups * kLevels; j < kCols; ++j) {
+    ASSERT_FALSE(bundles.IsBundled(j));
+  }
+
+  auto const &index = bundles.Index();
+  ASSERT_TRUE(index.IsDense());
+  ASSERT_EQ(index.Size(), kRows);
+  ASSERT_EQ(index.index.GetBinTypeSize(), kUint8BinsTypeSize);
+  ASSERT_LT(index.cut.TotalBins(), gmat.cut.TotalBins());
+
+  // Histograms recovered from bundles are the same as histograms built on features.
+  auto gpair = GenerateRandomGradients(kRows);
+  auto const &h_gpair = gpair.ConstHostVector();
+  std::vector<GradientPairPrecise> hist(gmat.cut.TotalBins());
+  std::vector<GradientPairPrecise> bundled(index.cut.TotalBins());
+  for (size_t i = 0; i < kRows; ++i) {
+    for (size_t j = 0; j < kCols; ++j) {
+      hist[gmat.index[i * kCols + j]] += GradientPairPrecise{h_gpair[i]};
+    }
+    for (size_t b = 0; b < bundles.NumBundles(); ++b) {
+      bundled[index.index[i * bundles.NumBundles() + b]] += GradientPairPrecise{h_gpair[i]};
+    }
+  }
+
+  auto const &ptrs = gmat.cut.Ptrs();
+  std::vector<GradientPairPrecise> f_hist;
+  for (bst_feature_t j = 0; j < kCols; ++j) {
+    auto n_bins = ptrs[j + 1] - ptrs[j];
+    f_hist.resize(n_bins);
+    if (bundles.IsBundled(j)) {
+      bundles.Unbundle(j, [&](uint32_t bin) { return bundled[bin]; },
+                       Span<GradientPairPrecise>{f_hist});
+    } else {
+      std::copy_n(bundled.cbegin() + bundles.FeatureBegin(j), n_bins, f_hist.begin());
+    }
+    for (size_t k = 0; k < n_bins; ++k) {
+      ASSERT_NEAR(f_hist[k].GetGrad(), hist[ptrs[j] + k].GetGrad(), kRtEps);
+      ASSERT_NEAR(f_hist[k].GetHess(), hist[ptrs[j] + k].GetHess(), kRtEps);
+    }
+  }
+}
+}  // namespace common
+}  // namespace xgboost
@@ -2,10 +2,12 @@
  * Copyright 2019-2021 by XGBoost Contributors
  */
 #include <gtest/gtest.h>
+#include <cmath>
 #include <vector>
 #include <string>
 #include <utility>
 
+#include "../../../src/common/hist_simd.h"
 #include "../../../src/common/hist_util.h"
 #include "../../../src/data/gradient_index.h"
 #include "../helpers.h"
@@ -144,6 +146,88 @@ TEST(ParallelGHistBuilder, ReduceHistFloat) {
   ParallelGHistBuilderReduceHist<float>();
 }
 
+TEST(ParallelGHistBuilder, BlockRows) {
+  constexpr size_t kBins = 4;
+  constexpr size_t kRows = 1 << 20;
+  constexpr float kValue = 0.1f;
+  HistCollection<float> collection;
+  collection.Init(kBins);
+  collection.AddHistRow(0);
+  collection.AllocateAllData();
+
+  auto reduce = [&](size_t block_rows) {
+    ParallelGHistBuilder<float> hist_builder;
+    hist_builder.Init(kBins);
+    hist_builder.SetBlockRows(block_rows);
+    common::BlockedSpace2d space(1, [&](size_t) { return 1; }, 1);
+    hist_builder.Reset(1, 1, space, {collection[0]});
+    for (size_t r = 0; r < kRows; ++r) {
+      auto hist = hist_builder.GetInitializedHist(0, 0);
+      hist[r % kBins].Add(kValue, 1.0f);
+      hist_builder.AddRows(0, 0, 1);
+    }
+    hist_builder.ReduceHist(0, 0, kBins);
+    return collection[0][0];
+  };
+
+  double expected = static_cast<double>(kValue) * (kRows / kBins);
+  auto naive = reduce(0);
+  auto blocked = reduce(1024);
+  ASSERT_EQ(blocked.GetHess(), kRows / kBins);
+  ASSERT_NEAR(blocked.GetGrad(), expected, expected * 1e-6);
+  ASSERT_GT(std::abs(naive.GetGrad() - expected), std::abs(blocked.GetGrad() - expected));
+}
+
+TEST(ParallelGHistBuilder, LazyBinding) {
+  constexpr size_t kBins = 10;
+  constexpr size_t kNodes = 3;
+  constexpr size_t kThreads = 4;
+  constexpr size_t kTasksPerNode = 4;
+
+  HistCollection<double> collection;
+  collection.Init(kBins);
+  for (size_t inode = 0; inode < kNodes; inode++) {
+    collection.AddHistRow(inode);
+  }
+  collection.AllocateAllData();
+  std::vector<GHistRow<double>> target_hist(kNodes);
+  for (size_t i = 0; i < target_hist.size(); ++i) {
+    target_hist[i] = collection[i];
+    // Garbage from previous iterations must not leak into the result.
+    for (size_t j = 0; j < kBins; ++j) {
+      target_hist[i][j].Add(100.0, 100.0);
+    }
+  }
+
+  ParallelGHistBuilder<double> hist_builder;
+  hist_builder.Init(kBins);
+  common::BlockedSpace2d space(kNodes, [&](size_t) { return kTasksPerNode; }, 1);
+  hist_builder.Reset(kThreads, kNodes, space, target_hist);
+
+  // Run tasks on threads other than the statically scheduled ones, owner of node 0 never
+  // touches it.
+  for (size_t inode = 0; inode < kNodes; ++inode) {
+    for (size_t t = 0; t < kTasksPerNode; ++t) {
+      size_t tid = (hist_builder.NodeOwner(inode) + 1 + t % 2) % kThreads;
+      if (inode != 0 && t == 0) {
+        tid = hist_builder.NodeOwner(inode);
+      }
+      auto hist = hist_builder.GetInitializedHist(tid, inode);
+      for (size_t j = 0; j < kBins; ++j) {
+        hist[j].Add(1.0, static_cast<double>(j));
+      }
+    }
+  }
+
+  for (size_t inode = 0; inode < kNodes; ++inode) {
+    hist_builder.ReduceHist(inode, 0, kBins);
+    for (size_t j = 0; j < kBins; ++j) {
+      ASSERT_EQ(collection[inode][j].GetGrad(), kTasksPerNode);
+      ASSERT_EQ(collection[inode][j].GetHess(), static_cast<double>(j * kTasksPerNode));
+    }
+  }
+}
+
 TEST(CutsBuilder, SearchGroupInd) {
   size_t constexpr kNumGroups = 4;
   size_t constexpr kRows = 17;
@@ -298,6 +382,174 @@ TEST(HistUtil, IndexBinBound) {
   }
 }
 
+TEST(HistUtil, BinCap) {
+  ASSERT_EQ(HostSketchContainer::BinCap({4, 8, 16}, 100), 16);
+  // 4 + 2 * 10 = 24
+  ASSERT_EQ(HostSketchContainer::BinCap({16, 4, 300}, 24), 10);
+  ASSERT_EQ(HostSketchContainer::BinCap({16, 4, 300}, 25), 10);
+  ASSERT_EQ(HostSketchContainer::BinCap({16, 4, 300}, 26), 11);
+  ASSERT_EQ(HostSketchContainer::BinCap({16, 4, 300}, 2), 1);
+}
+
+TEST(HistUtil, FeatureBinBudget) {
+  size_t constexpr kRows = 2048, kCols = 4;
+  int32_t constexpr kMaxBin = 16;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0).Seed(3).GenerateDMatrix();
+
+  // Per-feature budgets override max_bin, features without one use max_bin.
+  std::vector<int32_t> feature_max_bin{8, 0, 300};
+  auto cuts = SketchOnDMatrix(p_fmat.get(), kMaxBin, {}, 0, feature_max_bin);
+  ASSERT_LE(cuts.FeatureBins(0), 8);
+  ASSERT_GT(cuts.FeatureBins(0), 1);
+  ASSERT_LE(cuts.FeatureBins(1), kMaxBin);
+  ASSERT_GT(cuts.FeatureBins(2), kMaxBin);
+  ASSERT_LE(cuts.FeatureBins(2), 300);
+  ASSERT_LE(cuts.FeatureBins(3), kMaxBin);
+
+  // A total budget keeps the index in uint8 despite a large max_bin.
+  BatchParam param{GenericParameter::kCpuId, 1024};
+  param.max_total_bins = kCols * 200;
+  GHistIndexMatrix gmat{p_fmat.get(), param};
+  ASSERT_LE(gmat.cut.TotalBins(), param.max_total_bins);
+  ASSERT_GT(gmat.cut.MaxFeatureBins(), 100);
+  ASSERT_EQ(gmat.max_num_bins, gmat.cut.MaxFeatureBins());
+  ASSERT_EQ(gmat.index.GetBinTypeSize(), kUint8BinsTypeSize);
+
+  GHistIndexMatrix unbounded{p_fmat.get(), 1024};
+  ASSERT_EQ(unbounded.index.GetBinTypeSize(), kUint16BinsTypeSize);
+  ASSERT_GT(unbounded.cut.TotalBins(), gmat.cut.TotalBins());
+}
+
+TEST(HistUtil, MixedBinTypes) {
+  size_t constexpr kRows = 2048, kCols = 4;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0).Seed(3).GenerateDMatrix();
+  BatchParam param{GenericParameter::kCpuId, 16};
+  param.feature_max_bin = {0, 1024};
+  GHistIndexMatrix gmat{p_fmat.get(), param};
+  ASSERT_GT(gmat.cut.FeatureBins(1), 256);
+
+  ASSERT_TRUE(gmat.index.IsMixed());
+  auto const &segments = gmat.index.Segments();
+  ASSERT_EQ(segments.size(), 2);
+  ASSERT_EQ(segments[0].bin_type_size, kUint8BinsTypeSize);
+  ASSERT_EQ(segments[0].features, std::vector<bst_feature_t>({0, 2, 3}));
+  ASSERT_EQ(segments[1].bin_type_size, kUint16BinsTypeSize);
+  ASSERT_EQ(segments[1].features, std::vector<bst_feature_t>({1}));
+  ASSERT_EQ(gmat.index.Size(), kRows * kCols);
+  ASSERT_LT(gmat.index.NumBytes(), kRows * kCols * sizeof(uint16_t));
+
+  // Same bins as an index with a single bin type.
+  GHistIndexMatrix uniform;
+  auto const &page = *p_fmat->GetBatches<SparsePage>().begin();
+  uniform.Init(page, {}, gmat.cut, gmat.max_num_bins, true, 2);
+  ASSERT_FALSE(uniform.index.IsMixed());
+  for (size_t i = 0; i < uniform.index.Size(); ++i) {
+    ASSERT_EQ(gmat.index[i], uniform.index[i]);
+  }
+  ASSERT_EQ(gmat.hit_count, uniform.hit_count);
+
+  auto gpair = GenerateRandomGradients(kRows).HostVector();
+  std::vector<size_t> rows;
+  for (size_t i = 0; i < kRows; i += 3) {
+    rows.push_back(i);
+  }
+  RowSetCollection::Elem elem{rows.data(), rows.data() + rows.size()};
+  auto n_bins = gmat.cut.TotalBins();
+  GHistBuilder<double> builder(n_bins);
+  std::vector<GradientPairPrecise> expected(n_bins), got(n_bins);
+  builder.BuildHist<false>(gpair, elem, uniform, expected);
+  builder.BuildHist<false>(gpair, elem, gmat, got);
+  for (size_t i = 0; i < n_bins; ++i) {
+    ASSERT_EQ(expected[i], got[i]);
+  }
+
+  std::vector<GradientPairPrecise> scratch(n_bins);
+  SparseHistRow<double> sparse;
+  RowSetCollection::Elem few{rows.data(), rows.data() + 8};
+  builder.BuildSparseHist<false>(gpair, few, gmat, scratch, &sparse);
+  std::fill(expected.begin(), expected.end(), GradientPairPrecise{});
+  builder.BuildHist<false>(gpair, few, uniform, expected);
+  ASSERT_LE(sparse.bins.size(), 8 * kCols);
+  for (size_t i = 0; i < sparse.bins.size(); ++i) {
+    ASSERT_EQ(sparse.values[i], expected[sparse.bins[i]]);
+  }
+
+  std::vector<int32_t> ridxs{5, 1, 2047};
+  GHistIndexMatrix gathered;
+  gathered.GatherRows(gmat, ridxs, 2);
+  ASSERT_TRUE(gathered.index.IsMixed());
+  for (size_t i = 0; i < ridxs.size(); ++i) {
+    for (size_t j = 0; j < kCols; ++j) {
+      ASSERT_EQ(gathered.index[i * kCols + j], gmat.index[ridxs[i] * kCols + j]);
+    }
+  }
+}
+
+TEST(HistUtil, PackedBins) {
+  size_t constexpr kRows = 1024, kCols = 6;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0).Seed(5).GenerateDMatrix();
+  BatchParam param{GenericParameter::kCpuId, 64};
+  param.feature_max_bin = {3, 16, 0, 4, 12, 5};
+  param.pack_bins = true;
+  GHistIndexMatrix gmat{p_fmat.get(), param};
+
+  ASSERT_TRUE(gmat.index.IsMixed());
+  ASSERT_TRUE(gmat.index.IsPacked());
+  auto const &ptrs = gmat.cut.Ptrs();
+  for (auto const &seg : gmat.index.Segments()) {
+    for (auto f : seg.features) {
+      ASSERT_EQ(BinBitsOf(ptrs[f + 1] - ptrs[f], true), seg.bits);
+    }
+    ASSERT_EQ(seg.row_bytes, DivRoundUp(seg.features.size() * seg.bits, 8));
+  }
+  ASSERT_TRUE(gmat.index.Segments().front().IsPacked());
+  ASSERT_LT(gmat.index.NumBytes(), kRows * kCols);
+
+  GHistIndexMatrix uniform;
+  auto const &page = *p_fmat->GetBatches<SparsePage>().begin();
+  uniform.Init(page, {}, gmat.cut, gmat.max_num_bins, true, 2);
+  ASSERT_FALSE(uniform.index.IsMixed());
+  for (size_t i = 0; i < uniform.index.Size(); ++i) {
+    ASSERT_EQ(gmat.index[i], uniform.index[i]);
+  }
+  ASSERT_EQ(gmat.hit_count, uniform.hit_count);
+
+  auto gpair = GenerateRandomGradients(kRows).HostVector();
+  std::vector<size_t> rows;
+  for (size_t i = 0; i < kRows; i += 2) {
+    rows.push_back(i);
+  }
+  RowSetCollection::Elem elem{rows.data(), rows.data() + rows.size()};
+  auto n_bins = gmat.cut.TotalBins();
+  GHistBuilder<double> builder(n_bins);
+  std::vector<GradientPairPrecise> expected(n_bins), got(n_bins);
+  builder.BuildHist<false>(gpair, elem, uniform, expected);
+  builder.BuildHist<false>(gpair, elem, gmat, got);
+  for (size_t i = 0; i < n_bins; ++i) {
+    ASSERT_EQ(expected[i], got[i]);
+  }
+
+  std::vector<GradientPairPrecise> scratch(n_bins);
+  SparseHistRow<double> sparse;
+  RowSetCollection::Elem few{rows.data(), rows.data() + 8};
+  builder.BuildSparseHist<false>(gpair, few, gmat, scratch, &sparse);
+  std::fill(expected.begin(), expected.end(), GradientPairPrecise{});
+  builder.BuildHist<false>(gpair, few, uniform, expected);
+  for (size_t i = 0; i < sparse.bins.size(); ++i) {
+    ASSERT_EQ(sparse.values[i], expected[sparse.bins[i]]);
+  }
+
+  std::vector<int32_t> ridxs{7, 0, 1023};
+  GHistIndexMatrix gathered;
+  gathered.GatherRows(gmat, ridxs, 2);
+  ASSERT_TRUE(gathered.index.IsPacked());
+  for (size_t i = 0; i < ridxs.size(); ++i) {
+    for (size_t j = 0; j < kCols; ++j) {
+      ASSERT_EQ(gathered.index[i * kCols + j], gmat.index[ridxs[i] * kCols + j]);
+    }
+  }
+}
+
 template <typename T>
 void CheckIndexData(T* data_ptr, uint32_t* offsets,
                     const GHistIndexMatrix& hmat, size_t n_cols) {
@@ -402,5 +654,50 @@ TEST(HistUtil, SketchCategoricalFeatures) {
                           return SketchOnDMatrix(p_fmat, num_bins);
                         });
 }
+
+namespace {
+template <typename FPType, typename BinIdxType>
+void TestAddDenseRowSimd() {
+  // Not a multiple of vector width to cover the remainder loop.
+  size_t constexpr kCols = 19, kBinsPerFeature = 13, kRows = 64;
+  std::vector<uint32_t> offsets(kCols);
+  for (size_t j = 0; j < kCols; ++j) {
+    offsets[j] = j * kBinsPerFeature;
+  }
+  std::vector<FPType> expected(kCols * kBinsPerFeature * 2, 0), got(expected.size(), 0);
+  std::vector<BinIdxType> index(kCols);
+  SimpleLCG lcg;
+  for (size_t i = 0; i < kRows; ++i) {
+    for (auto& bin : index) {
+      bin = static_cast<BinIdxType>(lcg() % kBinsPerFeature);
+    }
+    // Integer values are used by integer histograms.
+    float gh[2]{static_cast<float>(i % 11) - 5.0f, static_cast<float>(i % 7) + 1.0f};
+    AddDenseRowSimd(index.data(), offsets.data(), kCols, gh, got.data());
+    for (size_t j = 0; j < kCols; ++j) {
+      expected[2 * (index[j] + offsets[j])] += static_cast<FPType>(gh[0]);
+      expected[2 * (index[j] + offsets[j]) + 1] += static_cast<FPType>(gh[1]);
+    }
+  }
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(got[i], expected[i]);
+  }
+}
+}  // anonymous namespace
+
+TEST(HistUtil, AddDenseRowSimd) {
+  if (!DenseHistSimdSupported()) {
+    GTEST_SKIP() << "SIMD histogram is not supported on current CPU.";
+  }
+  TestAddDenseRowSimd<float, uint8_t>();
+  TestAddDenseRowSimd<float, uint16_t>();
+  TestAddDenseRowSimd<float, uint32_t>();
+  TestAddDenseRowSimd<double, uint8_t>();
+  TestAddDenseRowSimd<double, uint16_t>();
+  TestAddDenseRowSimd<double, uint32_t>();
+  TestAddDenseRowSimd<int64_t, uint8_t>();
+  TestAddDenseRowSimd<int64_t, uint16_t>();
+  TestAddDenseRowSimd<int64_t, uint32_t>();
+}
 }  // namespace common
 }  // namespace xgboost
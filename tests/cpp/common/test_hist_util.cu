@@ -10,6 +10,7 @@
 
 #include <xgboost/data.h>
 #include <xgboost/c_api.h>
+#include <xgboost/global_config.h>
 
 #include "test_hist_util.h"
 #include "../helpers.h"
@@ -61,6 +62,15 @@ TEST(HistUtil, SketchBatchNumElements) {
   size_t rows = avail_elem / kCols * 10;
   auto batch = detail::SketchBatchNumElements(0, rows, kCols, rows * kCols, device, 256, false);
   ASSERT_EQ(batch, avail_elem);
+
+  // Explicit budget.
+  auto config = GlobalConfigThreadLocalStore::Get();
+  size_t constexpr kBudget = 1 << 20;
+  config->sketch_memory_budget = kBudget;
+  ASSERT_EQ(detail::SketchMemoryBudget(device), kBudget);
+  batch = detail::SketchBatchNumElements(0, rows, kCols, rows * kCols, device, 256, false);
+  ASSERT_EQ(batch, kBudget / per_elem);
+  config->sketch_memory_budget = 0;
 }
 
 TEST(HistUtil, DeviceSketchMemory) {
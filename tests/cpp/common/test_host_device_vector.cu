@@ -183,6 +183,40 @@ TEST(HostDeviceVector, Empty) {
   ASSERT_TRUE(vec.Empty());
 }
 
+TEST(HostDeviceVector, Pinned) {
+  size_t n = 1001;
+  HostDeviceVector<int> vec(n, 1, 0);
+  vec.SetHostMemory(HostMemory::kPinned);
+  ASSERT_EQ(vec.GetHostMemory(), HostMemory::kPinned);
+  auto d_vec = vec.DeviceSpan();
+  dh::LaunchN(n, [=] __device__(size_t i) { d_vec[i] += static_cast<int>(i); });
+  vec.PrefetchHost();
+  ASSERT_FALSE(vec.HostCanRead());
+  auto const& h_vec = vec.ConstHostVector();
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(h_vec[i], static_cast<int>(i) + 1);
+  }
+
+  // Staged back to device after modification on host.
+  vec.HostVector().back() = 0;
+  thrust::device_ptr<int const> ptr{vec.ConstDevicePointer()};
+  ASSERT_EQ(ptr[n - 1], 0);
+  ASSERT_EQ(ptr[0], 1);
+}
+
+TEST(HostDeviceVector, DeviceOnly) {
+  HostDeviceVector<float> vec {1.0f, 2.0f, 3.0f, 4.0f};
+  vec.SetDevice(0);
+  vec.SetHostMemory(HostMemory::kDeviceOnly);
+  vec.ConstDeviceSpan();
+  // Still readable on host before it's written on device.
+  ASSERT_EQ(vec.ConstHostVector().size(), 4);
+  auto d_vec = vec.DeviceSpan();
+  ASSERT_EQ(d_vec.size(), 4);
+  ASSERT_EQ(vec.Size(), 4);
+  EXPECT_THROW(vec.ConstHostVector(), dmlc::Error);
+}
+
 TEST(HostDeviceVector, MGPU_Basic) {  // NOLINT
   if (AllVisibleGPUs() < 2) {
     LOG(WARNING) << "Not testing in multi-gpu environment.";
@@ -0,0 +1,50 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "../../../src/common/huge_page_allocator.h"
+#include "../../../src/common/perf_counters.h"
+
+namespace xgboost {
+namespace common {
+namespace {
+template <typename T>
+bool IsAligned(T const* ptr) {
+  return reinterpret_cast<std::uintptr_t>(ptr) % 64 == 0;
+}
+}  // anonymous namespace
+
+TEST(HugePageAllocator, Basic) {
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> small;
+  small.resize(3, 1);
+  ASSERT_TRUE(IsAligned(small.data()));
+  ASSERT_EQ(small.back(), 1);
+
+  auto counters = PerfCounters::Get();
+  size_t constexpr kLarge = 4 * 1024 * 1024;
+  for (auto mode : {"none", "transparent", "explicit"}) {
+    detail::SetHugePageMode(mode);
+    auto before = counters->Read(PerfCounters::kHugePageBytes);
+    {
+      std::vector<double, HugePageAllocator<double>> large(kLarge / sizeof(double), 2.0);
+      ASSERT_TRUE(IsAligned(large.data()));
+      ASSERT_EQ(large[kLarge / sizeof(double) - 1], 2.0);
+#if defined(__linux__)
+      if (detail::GetHugePageMode() == detail::HugePageMode::kNone) {
+        ASSERT_EQ(counters->Read(PerfCounters::kHugePageBytes), before);
+      } else {
+        ASSERT_GE(counters->Read(PerfCounters::kHugePageBytes), before + kLarge);
+      }
+#endif  // defined(__linux__)
+    }
+    ASSERT_EQ(counters->Read(PerfCounters::kHugePageBytes), before);
+  }
+  detail::SetHugePageMode("none");
+  ASSERT_THROW(detail::SetHugePageMode("1GB"), dmlc::Error);
+}
+}  // namespace common
+}  // namespace xgboost
@@ -89,5 +89,31 @@ TEST(IO, LoadSequentialFile) {
 
   ASSERT_THROW(LoadSequentialFile("non-exist", true), dmlc::Error);
 }
+
+TEST(IO, MmapFile) {
+  dmlc::TemporaryDirectory tempdir;
+  std::string path = tempdir.path + "/mmap.bin";
+  std::string content(4096 + 17, '\0');
+  for (size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<char>(i % 251);
+  }
+  {
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(content.data(), content.size());
+  }
+  ASSERT_TRUE(MmapFile::Supported(path));
+  ASSERT_FALSE(MmapFile::Supported("s3://bucket/mmap.bin"));
+  {
+    MmapFile mapped{path};
+    ASSERT_EQ(mapped.Size(), content.size());
+    ASSERT_EQ(std::string(mapped.Data(), mapped.Size()), content);
+  }
+  {
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+  }
+  MmapFile empty{path};
+  ASSERT_EQ(empty.Size(), 0);
+  ASSERT_THROW(MmapFile{"non-exist"}, dmlc::Error);
+}
 }  // namespace common
 }  // namespace xgboost
@@ -580,4 +580,81 @@ TEST(Json, DISABLED_RoundTripExhaustive) {
     test(static_cast<uint32_t>(i));
   }
 }
+
+TEST(Json, ParseString) {
+  std::string long_str(4096, 'a');
+  std::string doc = R"({"b": ")" + long_str + R"(\n\"tail\"", "a": "", "b": "last"})";
+  auto json = Json::Load(StringView{doc});
+  ASSERT_EQ(get<String const>(json["a"]), "");
+  // Last one wins for duplicated keys.
+  ASSERT_EQ(get<String const>(json["b"]), "last");
+
+  doc = R"({"b": ")" + long_str + R"(\n\"tail\""})";
+  json = Json::Load(StringView{doc});
+  ASSERT_EQ(get<String const>(json["b"]), long_str + "\n\"tail\"");
+
+  std::string unterminated = R"({"b": "abc)";
+  EXPECT_THROW(Json::Load(StringView{unterminated}), dmlc::Error);
+  std::string line_break = "{\"b\": \"ab\nc\"}";
+  EXPECT_THROW(Json::Load(StringView{line_break}), dmlc::Error);
+}
+
+TEST(Json, TypedArray) {
+  F32Array f32{std::vector<float>{1.5f, -2.0f}};
+  I32Array i32{std::vector<int32_t>{1, -2, 3}};
+  I64Array i64{std::vector<int64_t>{std::numeric_limits<int64_t>::max()}};
+  Json json{Object()};
+  json["f32"] = std::move(f32);
+  json["i32"] = std::move(i32);
+  json["i64"] = std::move(i64);
+  ASSERT_EQ(get<F32Array const>(json["f32"]).size(), 2ul);
+  ASSERT_EQ(get<I32Array const>(json["i32"])[1], -2);
+
+  // Text JSON has no typed array, loaded as normal array.
+  std::string str;
+  Json::Dump(json, &str);
+  auto loaded = Json::Load(StringView{str});
+  auto const& arr = get<Array const>(loaded["i32"]);
+  ASSERT_EQ(arr.size(), 3ul);
+  ASSERT_EQ(get<Integer const>(arr[1]), -2);
+  ASSERT_EQ(get<Number const>(get<Array const>(loaded["f32"])[0]), 1.5f);
+  ASSERT_EQ(get<Integer const>(get<Array const>(loaded["i64"])[0]),
+            std::numeric_limits<int64_t>::max());
+}
+
+TEST(UBJson, RoundTrip) {
+  std::string ori_buffer = GetModelStr();
+  Json origin {Json::Load(StringView{ori_buffer.c_str(), ori_buffer.size()})};
+  origin["f32"] = F32Array{std::vector<float>{0.5f, std::numeric_limits<float>::quiet_NaN(),
+                                              -std::numeric_limits<float>::infinity()}};
+  origin["i32"] = I32Array{std::vector<int32_t>{std::numeric_limits<int32_t>::min(), 0}};
+  origin["i64"] = I64Array{std::vector<int64_t>{-1, 1ll << 40}};
+  origin["null"] = Null();
+  origin["str"] = String{"line\n\"quoted\""};
+
+  std::string out;
+  Json::Dump(origin, &out, std::ios::binary);
+  // Object in UBJSON starts with the same marker as text JSON.
+  ASSERT_EQ(out[0], '{');
+  auto loaded = Json::Load(StringView{out}, std::ios::binary);
+  ASSERT_EQ(loaded, origin);
+  ASSERT_TRUE(IsA<F32Array>(loaded["f32"]));
+  ASSERT_TRUE(std::isnan(get<F32Array const>(loaded["f32"])[1]));
+  ASSERT_EQ(get<I32Array const>(loaded["i32"])[0], std::numeric_limits<int32_t>::min());
+  ASSERT_EQ(get<I64Array const>(loaded["i64"])[1], 1ll << 40);
+
+  // Typed array is smaller than the text representation.
+  std::string text;
+  Json::Dump(Json{I32Array{std::vector<int32_t>(128, 1234567)}}, &text);
+  std::string binary;
+  Json::Dump(Json{I32Array{std::vector<int32_t>(128, 1234567)}}, &binary, std::ios::binary);
+  ASSERT_LT(binary.size(), text.size());
+}
+
+TEST(UBJson, Invalid) {
+  std::string truncated{"{L"};
+  EXPECT_THROW(Json::Load(StringView{truncated}, std::ios::binary), dmlc::Error);
+  std::string unknown{"[X]"};
+  EXPECT_THROW(Json::Load(StringView{unknown}, std::ios::binary), dmlc::Error);
+}
 }  // namespace xgboost
@@ -0,0 +1,26 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include "../../../src/common/math.h"
+
+namespace xgboost {
+namespace common {
+TEST(Math, ExpBranchFree) {
+  for (float x = -87.0f; x < 88.7f; x += 0.37f) {
+    auto expected = std::exp(static_cast<double>(x));
+    ASSERT_NEAR(ExpBranchFree(x) / expected, 1.0, 1e-6) << x;
+    ASSERT_NEAR(SigmoidBranchFree(x), Sigmoid(x), 1e-6) << x;
+  }
+  ASSERT_TRUE(std::isinf(ExpBranchFree(100.0f)));
+  ASSERT_GE(ExpBranchFree(-100.0f), 0.0f);
+  ASSERT_LE(ExpBranchFree(-100.0f), 2 * std::numeric_limits<float>::min());
+  ASSERT_EQ(SigmoidBranchFree(-100.0f), 0.0f);
+  ASSERT_EQ(SigmoidBranchFree(100.0f), 1.0f);
+}
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,73 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/host_device_vector.h>
+
+#include <utility>
+
+#include "../../../src/common/hist_util.h"
+#include "../../../src/common/memory_tracker.h"
+
+namespace xgboost {
+namespace common {
+TEST(MemoryTracker, TrackedBytes) {
+  auto tracker = MemoryTracker::Get();
+  auto owner = MemoryTracker::kPageRing;
+  auto base = tracker->Current(owner);
+  {
+    TrackedBytes disabled{owner};
+    disabled.Update(128);
+    ASSERT_EQ(tracker->Current(owner), base);
+  }
+
+  tracker->SetEnabled(true);
+  tracker->ResetPeak();
+  {
+    TrackedBytes bytes{owner};
+    bytes.Update(256);
+    ASSERT_EQ(tracker->Current(owner), base + 256);
+    auto copied = bytes;
+    ASSERT_EQ(tracker->Current(owner), base + 512);
+    auto moved = std::move(bytes);
+    ASSERT_EQ(tracker->Current(owner), base + 512);
+    moved.Update(64);
+    ASSERT_EQ(tracker->Current(owner), base + 320);
+    ASSERT_EQ(tracker->Peak(owner), base + 512);
+  }
+  ASSERT_EQ(tracker->Current(owner), base);
+  ASSERT_EQ(tracker->Peak(owner), base + 512);
+  tracker->ResetPeak();
+  ASSERT_EQ(tracker->Peak(owner), base);
+  tracker->SetEnabled(false);
+}
+
+TEST(MemoryTracker, Owners) {
+  auto tracker = MemoryTracker::Get();
+  tracker->SetEnabled(true);
+  auto host = MemoryTracker::kHostDeviceVectorHost;
+  auto hist = MemoryTracker::kHistCollection;
+  auto host_base = tracker->Current(host);
+  auto hist_base = tracker->Current(hist);
+  {
+    HostDeviceVector<float> vec(1024, 0.0f);
+    ASSERT_GE(tracker->Current(host), host_base + 1024 * sizeof(float));
+
+    uint32_t constexpr kBins = 16;
+    HistCollection<double> collection;
+    collection.Init(kBins);
+    collection.AddHistRow(0);
+    collection.AllocateData(0);
+    ASSERT_EQ(tracker->Current(hist),
+              hist_base + kBins * sizeof(xgboost::detail::GradientPairInternal<double>));
+  }
+  ASSERT_EQ(tracker->Current(host), host_base);
+  ASSERT_EQ(tracker->Current(hist), hist_base);
+
+  auto usage = tracker->ToJson();
+  ASSERT_EQ(get<Object const>(usage).size(), static_cast<size_t>(MemoryTracker::kNumOwners));
+  ASSERT_TRUE(IsA<Integer>(usage["page_ring"]["peak"]));
+  tracker->SetEnabled(false);
+}
+}  // namespace common
+}  // namespace xgboost
@@ -0,0 +1,62 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../../../src/common/missing_bin.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace common {
+TEST(MissingBins, Init) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0.1}.Seed(3).GenerateDMatrix();
+  GHistIndexMatrix gmat(p_fmat.get(), 16);
+  ASSERT_FALSE(gmat.IsDense());
+  auto const &ptrs = gmat.cut.Ptrs();
+
+  MissingBins missing_bins{gmat, 2};
+  ASSERT_EQ(missing_bins.NumFeatures(), kCols);
+  auto const &index = missing_bins.Index();
+  ASSERT_TRUE(index.IsDense());
+  ASSERT_EQ(index.Size(), kRows);
+  ASSERT_EQ(index.index.GetBinTypeSize(), kUint8BinsTypeSize);
+  ASSERT_EQ(index.cut.TotalBins(), gmat.cut.TotalBins() + kCols);
+  ASSERT_EQ(index.hit_count.size(), index.cut.TotalBins());
+
+  // Bins of each row in the source index, missing bins for other features.
+  std::vector<uint32_t> expected(kRows * kCols);
+  for (size_t r = 0; r < kRows; ++r) {
+    for (bst_feature_t f = 0; f < kCols; ++f) {
+      expected[r * kCols + f] = missing_bins.MissingBin(f);
+    }
+    for (auto i = gmat.row_ptr[r]; i < gmat.row_ptr[r + 1]; ++i) {
+      auto bin = gmat.index[i];
+      auto f = static_cast<bst_feature_t>(
+          std::upper_bound(ptrs.cbegin(), ptrs.cend(), bin) - ptrs.cbegin() - 1);
+      expected[r * kCols + f] = missing_bins.FeatureBegin(f) + (bin - ptrs[f]);
+    }
+  }
+  std::vector<size_t> n_missing(kCols, 0);
+  for (size_t i = 0; i < kRows * kCols; ++i) {
+    ASSERT_EQ(index.index[i], expected[i]);
+    n_missing[i % kCols] += expected[i] == missing_bins.MissingBin(i % kCols);
+  }
+
+  for (bst_feature_t f = 0; f < kCols; ++f) {
+    auto begin = missing_bins.FeatureBegin(f);
+    auto n_bins = ptrs[f + 1] - ptrs[f];
+    ASSERT_EQ(missing_bins.MissingBin(f), begin + n_bins);
+    ASSERT_EQ(index.cut.MinValues()[f], gmat.cut.MinValues()[f]);
+    for (size_t k = 0; k < n_bins; ++k) {
+      ASSERT_EQ(index.cut.Values()[begin + k], gmat.cut.Values()[ptrs[f] + k]);
+      ASSERT_EQ(index.hit_count[begin + k], gmat.hit_count[ptrs[f] + k]);
+    }
+    ASSERT_EQ(index.hit_count[missing_bins.MissingBin(f)], n_missing[f]);
+  }
+}
+}  // namespace common
+}  // namespace xgboost
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <xgboost/json.h>
 #include <xgboost/logging.h>
 #include <string>
 #include "../../../src/common/timer.h"
@@ -31,5 +32,43 @@ TEST(Monitor, Logging) {
   output = testing::internal::GetCapturedStderr();
   ASSERT_EQ(output.size(), 0);
 }
+
+TEST(Monitor, Trace) {
+  Args args = {std::make_pair("verbosity", "1")};
+  ConsoleLogger::Configure(args);
+  auto* tracer = Tracer::Get();
+  // Ring buffer holds 3 events, first begin/end pair is overwritten.
+  tracer->Start(3);
+  {
+    Monitor monitor;
+    monitor.Init("Trace");
+    monitor.Start("outer");
+    monitor.Stop("outer");
+    monitor.Start("inner");
+    monitor.Stop("inner");
+    monitor.Start("last");
+  }
+  std::string trace;
+  tracer->Stop(&trace);
+  auto j_trace = Json::Load(StringView{trace});
+  auto const& events = get<Array const>(j_trace["traceEvents"]);
+  ASSERT_EQ(events.size(), 3);
+  ASSERT_EQ(get<String const>(events[0]["name"]), "Trace::inner");
+  ASSERT_EQ(get<String const>(events[0]["ph"]), "B");
+  ASSERT_EQ(get<String const>(events[1]["ph"]), "E");
+  ASSERT_EQ(get<String const>(events[2]["name"]), "Trace::last");
+  ASSERT_LE(get<Number const>(events[0]["ts"]), get<Number const>(events[1]["ts"]));
+
+  // Nothing is recorded after stop.
+  {
+    Monitor monitor;
+    monitor.Start("basic");
+    monitor.Stop("basic");
+  }
+  tracer->Start();
+  tracer->Stop(&trace);
+  j_trace = Json::Load(StringView{trace});
+  ASSERT_TRUE(get<Array const>(j_trace["traceEvents"]).empty());
+}
 }  // namespace common
 }  // namespace xgboost
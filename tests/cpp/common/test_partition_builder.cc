@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <functional>
+#include <numeric>
 #include <vector>
 #include <string>
 #include <utility>
@@ -75,5 +77,61 @@ TEST(PartitionBuilder, BasicTest) {
   }
 }
 
+TEST(PartitionBuilder, Mask) {
+  constexpr size_t kBlockSize = 16;
+  constexpr size_t kRows = 100;
+  RowSetCollection row_set;
+  auto& rows = *row_set.Data();
+  rows.resize(kRows);
+  std::iota(rows.begin(), rows.end(), 0);
+  row_set.Init();
+
+  PartitionBuilder<kBlockSize> builder;
+  // Split nodes twice, rows are written into the second buffer then back into the first one.
+  auto split = [&](bst_node_t nidx, bst_node_t left, bst_node_t right, size_t mod) {
+    size_t n_rows = row_set[nidx].Size();
+    size_t n_tasks = n_rows / kBlockSize + !!(n_rows % kBlockSize);
+    builder.Init(n_tasks, 1, [&](size_t) { return n_tasks; });
+    auto pred = [&](size_t ridx) { return ridx % mod == 0; };
+    for (size_t j = 0; j < n_tasks; ++j) {
+      Range1d r{j * kBlockSize, std::min((j + 1) * kBlockSize, n_rows)};
+      builder.PartitionRangeToMask(0, nidx, r, row_set, pred);
+    }
+    builder.CalculateMaskOffsets();
+    auto src = row_set[nidx].begin;
+    auto dst = row_set.AlternateStorage(nidx);
+    ASSERT_NE(src, dst);
+    for (size_t j = 0; j < n_tasks; ++j) {
+      Range1d r{j * kBlockSize, std::min((j + 1) * kBlockSize, n_rows)};
+      builder.ScatterFromMask(0, r, src, dst);
+    }
+    row_set.AddSplitToAlternate(nidx, left, right, builder.GetNLeftElems(0),
+                                builder.GetNRightElems(0));
+  };
+
+  split(0, 1, 2, 2);
+  split(1, 3, 4, 3);
+
+  auto check = [&](bst_node_t nidx, std::function<bool(size_t)> in_node) {
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < kRows; ++i) {
+      if (in_node(i)) {
+        expected.push_back(i);
+      }
+    }
+    auto const& elem = row_set[nidx];
+    ASSERT_EQ(elem.Size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(elem.begin[i], expected[i]);
+    }
+  };
+  // Rows keep their relative order.
+  check(2, [](size_t i) { return i % 2 != 0; });
+  check(3, [](size_t i) { return i % 6 == 0; });
+  check(4, [](size_t i) { return i % 2 == 0 && i % 3 != 0; });
+  // Node 3 and 4 are back into the first buffer.
+  ASSERT_EQ(row_set[3].begin, rows.data());
+}
+
 }  // namespace common
 }  // namespace xgboost
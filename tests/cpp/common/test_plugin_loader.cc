@@ -0,0 +1,81 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/metric.h>
+#include <xgboost/objective.h>
+#include <xgboost/plugin_abi.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "../../../src/common/plugin_loader.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace {
+int SquaredErrorGrad(void const *, XGBPluginBlock const *block, float *out) {
+  for (size_t i = 0; i < block->n_rows * block->n_targets; ++i) {
+    float w = block->weights ? block->weights[i / block->n_targets] : 1.0f;
+    out[2 * i] = (block->predt[i] - block->labels[i]) * w;
+    out[2 * i + 1] = w;
+  }
+  return 0;
+}
+
+int AbsoluteError(void const *, XGBPluginBlock const *block, double *sum, double *wsum) {
+  for (size_t i = 0; i < block->n_rows * block->n_targets; ++i) {
+    float w = block->weights ? block->weights[i / block->n_targets] : 1.0f;
+    *sum += std::abs(block->predt[i] - block->labels[i]) * w;
+    *wsum += w;
+  }
+  return 0;
+}
+}  // anonymous namespace
+
+TEST(PluginLoader, Objective) {
+  XGBPluginObjective desc{};
+  desc.name = "test:plugin_squarederror";
+  desc.default_metric = "test_plugin_mae";
+  desc.task = kXGBPluginRegression;
+  desc.gradient = SquaredErrorGrad;
+  auto const &host = common::PluginHost();
+  ASSERT_EQ(host.abi_version, XGBOOST_PLUGIN_ABI_VERSION);
+  ASSERT_EQ(host.register_objective(&desc), 0);
+  // Names can't be registered twice.
+  ASSERT_NE(host.register_objective(&desc), 0);
+
+  auto tparam = CreateEmptyGenericParam(GPUIDX);
+  std::unique_ptr<ObjFunction> obj{ObjFunction::Create(desc.name, &tparam)};
+  obj->Configure({});
+  ASSERT_TRUE(obj->SupportsGradientRange());
+  ASSERT_STREQ(obj->DefaultEvalMetric(), "test_plugin_mae");
+  CheckObjFunction(obj,
+                   {0, 0.1f, 0.9f, 1, 0, 0.1f, 0.9f, 1},
+                   {0, 0, 0, 0, 1, 1, 1, 1},
+                   {1, 1, 1, 1, 2, 2, 2, 2},
+                   {0, 0.1f, 0.9f, 1.0f, -2.0f, -1.8f, -0.2f, 0},
+                   {1, 1, 1, 1, 2, 2, 2, 2});
+  auto config = CheckConfigReload(obj, desc.name);
+  ASSERT_TRUE(IsA<Object>(config["plugin_param"]));
+}
+
+TEST(PluginLoader, Metric) {
+  XGBPluginMetric desc{};
+  desc.name = "test_plugin_mae";
+  desc.eval = AbsoluteError;
+  ASSERT_EQ(common::PluginHost().register_metric(&desc), 0);
+
+  auto tparam = CreateEmptyGenericParam(GPUIDX);
+  std::unique_ptr<Metric> metric{Metric::Create("test_plugin_mae", &tparam)};
+  ASSERT_STREQ(metric->Name(), "test_plugin_mae");
+  EXPECT_NEAR(GetMetricEval(metric.get(), {0, 1, 2, 3}, {0, 0, 0, 0}), 1.5f, kRtEps);
+  EXPECT_NEAR(GetMetricEval(metric.get(), {0, 1, 2, 3}, {0, 0, 0, 0}, {1, 1, 1, 3}), 2.0f,
+              kRtEps);
+}
+
+TEST(PluginLoader, Load) {
+  EXPECT_THROW(common::LoadPlugin("non-existent-plugin.so"), dmlc::Error);
+}
+}  // namespace xgboost
@@ -45,6 +45,24 @@ TEST(ProbabilityDistribution, DistributionGeneric) {
   RunDistributionGenericTest<ExtremeDistribution>();
 }
 
+template <typename Distribution>
+void RunDistributionTermsTest() {
+  for (int i = -1000; i <= 1000; ++i) {
+    const double z = static_cast<double>(i) / 10.0;
+    DistributionTerms t = Distribution::Terms(z);
+    EXPECT_DOUBLE_EQ(t.pdf, Distribution::PDF(z));
+    EXPECT_DOUBLE_EQ(t.cdf, Distribution::CDF(z));
+    EXPECT_DOUBLE_EQ(t.grad_pdf, Distribution::GradPDF(z));
+    EXPECT_DOUBLE_EQ(t.hess_pdf, Distribution::HessPDF(z));
+  }
+}
+
+TEST(ProbabilityDistribution, DistributionTerms) {
+  RunDistributionTermsTest<NormalDistribution>();
+  RunDistributionTermsTest<LogisticDistribution>();
+  RunDistributionTermsTest<ExtremeDistribution>();
+}
+
 TEST(ProbabilityDistribution, NormalDist) {
   // "Three-sigma rule" (https://en.wikipedia.org/wiki/68–95–99.7_rule)
   //   68% of values are within 1 standard deviation away from the mean
@@ -20,6 +20,66 @@ TEST(Quantile, LoadBalance) {
   CHECK_EQ(n_cols, kCols);
 }
 
+TEST(Quantile, StreamingPages) {
+  size_t constexpr kRows = 1000, kCols = 16, kPages = 4;
+  int32_t constexpr kBins = 64;
+  std::vector<std::shared_ptr<DMatrix>> pages;
+  for (size_t i = 0; i < kPages; ++i) {
+    pages.emplace_back(RandomDataGenerator{kRows, kCols, 0.3}.Seed(i).GenerateDMatrix());
+  }
+  auto n_threads = OmpGetNumThreads(0);
+  auto ft = pages.front()->Info().feature_types.ConstHostSpan();
+
+  // Sketch with known column sizes.
+  std::vector<bst_row_t> column_size(kCols, 0);
+  for (auto const &m : pages) {
+    for (auto const &page : m->GetBatches<SparsePage>()) {
+      auto page_size = HostSketchContainer::CalcColumnSize(page, kCols, n_threads);
+      for (size_t i = 0; i < kCols; ++i) {
+        column_size[i] += page_size[i];
+      }
+    }
+  }
+  HostSketchContainer sized(column_size, kBins, ft, false, n_threads);
+  // Sketch without knowing the sizes, summaries grow with incoming pages.
+  HostSketchContainer streaming(std::vector<bst_row_t>(kCols, 0), kBins, ft, false, n_threads);
+  for (auto const &m : pages) {
+    for (auto const &page : m->GetBatches<SparsePage>()) {
+      sized.PushRowPage(page, m->Info());
+      streaming.PushRowPage(page, m->Info());
+    }
+  }
+  HistogramCuts sized_cuts, streaming_cuts;
+  sized.MakeCuts(&sized_cuts);
+  streaming.MakeCuts(&streaming_cuts);
+
+  ASSERT_EQ(sized_cuts.Ptrs(), streaming_cuts.Ptrs());
+  auto const &svals = sized_cuts.Values();
+  auto const &dvals = streaming_cuts.Values();
+  for (size_t i = 0; i < svals.size(); ++i) {
+    ASSERT_NEAR(svals[i], dvals[i], 2e-2f);
+  }
+}
+
+TEST(Quantile, SampleRows) {
+  size_t constexpr kRows = 20000, kCols = 4;
+  int32_t constexpr kBins = 32;
+  auto m = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix();
+  auto full = SketchOnDMatrix(m.get(), kBins);
+  auto sampled = SketchOnDMatrix(m.get(), kBins, {}, kRows / 4);
+
+  ASSERT_EQ(full.Ptrs().size(), sampled.Ptrs().size());
+  for (size_t f = 0; f < kCols; ++f) {
+    auto full_beg = full.Ptrs()[f];
+    auto sampled_beg = sampled.Ptrs()[f];
+    auto n_cuts = std::min(full.Ptrs()[f + 1] - full_beg, sampled.Ptrs()[f + 1] - sampled_beg);
+    // Skip the last cut, which is an upper bound instead of a quantile.
+    for (size_t i = 0; i + 1 < n_cuts; ++i) {
+      ASSERT_NEAR(full.Values()[full_beg + i], sampled.Values()[sampled_beg + i], 5e-2f);
+    }
+  }
+}
+
 void TestDistributedQuantile(size_t rows, size_t cols) {
   std::string msg {"Skipping AllReduce test"};
   int32_t constexpr kWorkers = 4;
@@ -187,5 +247,39 @@ TEST(Quantile, SameOnAllWorkers) {
   rabit::Finalize();
 #endif  // defined(__unix__)
 }
+
+TEST(Quantile, DistributedCategories) {
+#if defined(__unix__)
+  std::string msg{"Skipping Quantile DistributedCategories test"};
+  int32_t constexpr kWorkers = 4;
+  InitRabitContext(msg, kWorkers);
+  auto world = rabit::GetWorldSize();
+  if (world != 1) {
+    CHECK_EQ(world, kWorkers);
+  } else {
+    LOG(WARNING) << msg;
+    return;
+  }
+  // Each worker sees a few categories of its own, some of them past the first word of
+  // the bit set.
+  auto rank = rabit::GetRank();
+  std::vector<float> x{static_cast<float>(rank), static_cast<float>(40 + rank * 30),
+                       static_cast<float>(rank)};
+  auto m = GetDMatrixFromData(x, x.size(), 1);
+  m->Info().feature_types.HostVector() = {FeatureType::kCategorical};
+  auto cuts = SketchOnDMatrix(m.get(), 16);
+
+  std::vector<float> expected;
+  for (int32_t r = 0; r < world; ++r) {
+    expected.push_back(r);
+  }
+  for (int32_t r = 0; r < world; ++r) {
+    expected.push_back(40 + r * 30);
+  }
+  ASSERT_EQ(cuts.Values(), expected);
+  ASSERT_EQ(cuts.Ptrs().back(), expected.size());
+  rabit::Finalize();
+#endif  // defined(__unix__)
+}
 }  // namespace common
 }  // namespace xgboost
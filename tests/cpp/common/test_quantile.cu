@@ -139,6 +139,31 @@ TEST(GPUQuantile, Prune) {
   });
 }
 
+TEST(GPUQuantile, PruneIfLarger) {
+  constexpr size_t kRows = 1000, kCols = 100;
+  RunWithSeedsAndBins(kRows, [=](int32_t seed, size_t n_bins, MetaInfo const& info) {
+    HostDeviceVector<FeatureType> ft;
+    SketchContainer sketch(ft, n_bins, kCols, kRows, 0);
+
+    HostDeviceVector<float> storage;
+    std::string interface_str = RandomDataGenerator{kRows, kCols, 0}
+                                    .Device(0)
+                                    .Seed(seed)
+                                    .GenerateArrayInterface(&storage);
+    data::CupyAdapter adapter(interface_str);
+    AdapterDeviceSketch(adapter.Value(), n_bins, info,
+                        std::numeric_limits<float>::quiet_NaN(), &sketch);
+    auto n_entries = sketch.Data().size();
+    sketch.PruneIfLarger(sketch.MemCostBytes());
+    ASSERT_EQ(sketch.Data().size(), n_entries);
+
+    sketch.PruneIfLarger(0);
+    ASSERT_LE(sketch.Data().size(), n_bins * SketchContainer::kFactor * kCols);
+    ASSERT_LE(sketch.MemCostBytes(), n_entries * sizeof(SketchEntry));
+    TestQuantileElemRank(0, sketch.Data(), sketch.ColumnsPtr());
+  });
+}
+
 TEST(GPUQuantile, MergeEmpty) {
   constexpr size_t kRows = 1000, kCols = 100;
   size_t n_bins = 10;
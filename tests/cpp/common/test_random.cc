@@ -78,6 +78,41 @@ TEST(ColumnSampler, ThreadSynchronisation) {
   ASSERT_TRUE(success);
 }
 
+TEST(ColumnSampler, NodeSampling) {
+  size_t constexpr kCols = 100;
+  ColumnSampler cs{0};
+  cs.Init(kCols, {}, 0.3f, 1.0f, 1.0f);
+  std::vector<float> freq(kCols, 0);
+  size_t constexpr kIters = 4096;
+  HostDeviceVector<bst_feature_t> const* prev{nullptr};
+  for (size_t i = 0; i < kIters; ++i) {
+    auto fset = cs.GetFeatureSet(0);
+    // Released sets are reused.
+    if (prev) {
+      ASSERT_EQ(fset.get(), prev);
+    }
+    prev = fset.get();
+    auto const& h_fset = fset->ConstHostVector();
+    ASSERT_EQ(h_fset.size(), 30);
+    ASSERT_TRUE(std::is_sorted(h_fset.cbegin(), h_fset.cend()));
+    ASSERT_EQ(std::adjacent_find(h_fset.cbegin(), h_fset.cend()), h_fset.cend());
+    for (auto f : h_fset) {
+      ASSERT_LT(f, kCols);
+      freq[f] += 1.0f;
+    }
+  }
+  for (auto f : freq) {
+    EXPECT_NEAR(f / kIters, 0.3, 0.03);
+  }
+
+  // Sets held by the caller are not overwritten.
+  auto set0 = cs.GetFeatureSet(0);
+  auto h_set0 = set0->ConstHostVector();
+  auto set1 = cs.GetFeatureSet(0);
+  ASSERT_NE(set0.get(), set1.get());
+  ASSERT_EQ(set0->ConstHostVector(), h_set0);
+}
+
 TEST(ColumnSampler, WeightedSampling) {
   auto test_basic = [](int first) {
     std::vector<float> feature_weights(2);
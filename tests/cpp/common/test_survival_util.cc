@@ -3,6 +3,10 @@
  */
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <numeric>
+#include <vector>
+
 #include "../../../src/common/survival_util.h"
 
 namespace xgboost {
@@ -41,5 +45,63 @@ TEST(AFTLoss, RobustGradientPair) {  // Ensure that INF and NAN don't show up in
   RobustTestSuite<ExtremeDistribution>(100.0, 100.0, 2.0);
 }
 
+template <typename Distribution>
+inline static void FusedTestSuite(double y_lower, double y_upper, double sigma) {
+  for (int i = 50; i >= -50; --i) {
+    const double y_pred = std::log(std::pow(10.0, static_cast<double>(i)));
+    double grad, hess;
+    AFTLoss<Distribution>::GradHess(y_lower, y_upper, y_pred, sigma, &grad, &hess);
+    ASSERT_DOUBLE_EQ(grad, AFTLoss<Distribution>::Gradient(y_lower, y_upper, y_pred, sigma))
+        << "y \\in [" << y_lower << ", " << y_upper << "], y_pred = " << y_pred;
+    ASSERT_DOUBLE_EQ(hess, AFTLoss<Distribution>::Hessian(y_lower, y_upper, y_pred, sigma))
+        << "y \\in [" << y_lower << ", " << y_upper << "], y_pred = " << y_pred;
+  }
+}
+
+template <typename Distribution>
+inline static void FusedTestAllCensoring() {
+  FusedTestSuite<Distribution>(100.0, 100.0, 2.0);   // uncensored
+  FusedTestSuite<Distribution>(16.0, 200.0, 2.0);    // interval-censored
+  FusedTestSuite<Distribution>(0.0, 200.0, 1.0);     // left-censored
+  FusedTestSuite<Distribution>(16.0, std::numeric_limits<double>::infinity(), 0.5);
+}
+
+TEST(AFTLoss, FusedGradientPair) {
+  FusedTestAllCensoring<NormalDistribution>();
+  FusedTestAllCensoring<LogisticDistribution>();
+  FusedTestAllCensoring<ExtremeDistribution>();
+}
+
+TEST(Cox, RiskSetSums) {
+  // Long runs of ties crossing block boundaries, with both censored and uncensored samples.
+  size_t constexpr kRows = 50000;
+  std::vector<float> labels(kRows);
+  std::vector<double> exp_p(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    labels[i] = static_cast<float>(i / 9000 + 1) * (i % 3 == 0 ? -1.0f : 1.0f);
+    exp_p[i] = static_cast<double>(i % 7 + 1);
+  }
+  std::vector<size_t> label_order(kRows);
+  std::iota(label_order.begin(), label_order.end(), 0);
+
+  std::vector<double> expected(kRows);
+  double sum = 0;
+  for (size_t i = kRows; i-- > 0;) {
+    sum += exp_p[i];
+    expected[i] = sum;
+  }
+  for (size_t i = 1; i < kRows; ++i) {
+    if (std::abs(labels[i - 1]) == std::abs(labels[i])) {
+      expected[i] = expected[i - 1];
+    }
+  }
+
+  for (int32_t n_threads : {1, 3, 16}) {
+    std::vector<double> risk;
+    cox::RiskSetSums(label_order, labels, exp_p, n_threads, &risk);
+    ASSERT_EQ(risk, expected);
+  }
+}
+
 }  // namespace common
 }  // namespace xgboost
@@ -0,0 +1,53 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "../../../src/common/thread_tuner.h"
+
+namespace xgboost {
+namespace common {
+TEST(ThreadTuner, Disabled) {
+  ThreadTuner tuner;
+  tuner.Init(8, false);
+  for (size_t i = 0; i < 16; ++i) {
+    auto trial = tuner.Start(ThreadTuner::kHistogram, 1024);
+    ASSERT_EQ(trial.n_threads, 8);
+    tuner.Stop(trial);
+  }
+  ASSERT_EQ(tuner.Chosen(ThreadTuner::kHistogram, 1024), -1);
+}
+
+TEST(ThreadTuner, Choose) {
+  ThreadTuner tuner;
+  int32_t n_trials = 2;
+  tuner.Init(8, true, n_trials);
+  std::set<int32_t> tried;
+  // 4 candidates: 8, 4, 2, 1
+  for (int32_t i = 0; i < 4 * n_trials; ++i) {
+    ASSERT_EQ(tuner.Chosen(ThreadTuner::kPartition, 1000), -1);
+    auto trial = tuner.Start(ThreadTuner::kPartition, 1000);
+    tried.insert(trial.n_threads);
+    tuner.Stop(trial);
+  }
+  ASSERT_EQ(tried, (std::set<int32_t>{1, 2, 4, 8}));
+  auto chosen = tuner.Chosen(ThreadTuner::kPartition, 1000);
+  ASSERT_NE(tried.find(chosen), tried.cend());
+  // Same bucket of work.
+  ASSERT_EQ(tuner.Chosen(ThreadTuner::kPartition, 1023), chosen);
+  ASSERT_EQ(tuner.Start(ThreadTuner::kPartition, 1000).n_threads, chosen);
+  // Other phases and sizes are measured independently.
+  ASSERT_EQ(tuner.Chosen(ThreadTuner::kPartition, 1 << 20), -1);
+  ASSERT_EQ(tuner.Chosen(ThreadTuner::kEvaluate, 1000), -1);
+
+  // Changing the number of threads resets the decisions.
+  tuner.Init(4, true, n_trials);
+  ASSERT_EQ(tuner.Chosen(ThreadTuner::kPartition, 1000), -1);
+  tuner.Init(1, true, n_trials);
+  ASSERT_EQ(tuner.Start(ThreadTuner::kHistogram, 10).n_threads, 1);
+  ASSERT_EQ(tuner.Chosen(ThreadTuner::kHistogram, 10), 1);
+}
+}  // namespace common
+}  // namespace xgboost
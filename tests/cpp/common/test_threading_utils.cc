@@ -1,6 +1,10 @@
 #include <cstddef>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "../../../src/common/column_matrix.h"
 #include "../../../src/common/threading_utils.h"
 
@@ -88,6 +92,121 @@ TEST(ParallelFor2dNonUniform, Test) {
 
   omp_set_num_threads(old);
 }
+TEST(ParallelFor2dSteal, Test) {
+  constexpr size_t kDim1 = 6;
+  constexpr size_t kGrainSize = 16;
+
+  auto old = omp_get_max_threads();
+  omp_set_num_threads(4);
+
+  // all the work is in the first node, other threads should steal from the first one.
+  std::vector<size_t> dim2{4096, 1, 1, 1, 1, 1};
+  BlockedSpace2d space(kDim1, [&](size_t i) { return dim2[i]; }, kGrainSize);
+
+  std::vector<std::vector<int>> working_space(kDim1);
+  for (size_t i = 0; i < kDim1; i++) {
+    working_space[i].resize(dim2[i], 0);
+  }
+
+  ParallelFor2dSteal(space, omp_get_max_threads(), [&](size_t i, Range1d r) {
+    for (auto j = r.begin(); j < r.end(); ++j) {
+      working_space[i][j] += 1;
+    }
+  });
+
+  for (size_t i = 0; i < kDim1; i++) {
+    for (size_t j = 0; j < dim2[i]; j++) {
+      ASSERT_EQ(working_space[i][j], 1);
+    }
+  }
+
+  // empty space and more threads than blocks
+  ParallelFor2dSteal(BlockedSpace2d{0, [](size_t) { return 0; }, 1}, 4,
+                     [&](size_t, Range1d) { LOG(FATAL) << "Unreachable"; });
+  std::vector<int> counts(2, 0);
+  ParallelFor2dSteal(BlockedSpace2d{2, [](size_t) { return 1; }, 1}, 4,
+                     [&](size_t i, Range1d) { counts[i]++; });
+  ASSERT_EQ(counts[0], 1);
+  ASSERT_EQ(counts[1], 1);
+
+  omp_set_num_threads(old);
+}
+
+TEST(ParallelPool, ParallelFor) {
+  ParallelPool::SetBackend("pool");
+  ASSERT_EQ(ParallelPool::GetBackend(), ParallelPool::kPool);
+  size_t constexpr kSize = 1000;
+  int32_t n_threads = 4;
+  std::vector<int32_t> visited(kSize, 0);
+  std::vector<std::atomic<int32_t>> used(n_threads);
+  for (auto& u : used) {
+    u = 0;
+  }
+  for (auto sched : {Sched::Static(), Sched::Dyn(), Sched::Static(7), Sched::Guided()}) {
+    ParallelFor(kSize, n_threads, sched, [&](size_t i) {
+      auto tidx = ThreadIdx();
+      ASSERT_GE(tidx, 0);
+      ASSERT_LT(tidx, n_threads);
+      used[tidx]++;
+      visited[i]++;
+    });
+  }
+  for (auto v : visited) {
+    ASSERT_EQ(v, 4);
+  }
+  ASSERT_GT(used[0], 0);
+  ASSERT_EQ(ParallelPool::LocalSlot(), -1);
+
+  // nested loops run on a single thread.
+  std::vector<int32_t> nested(16, 0);
+  ParallelFor(nested.size(), n_threads, Sched::Dyn(), [&](size_t i) {
+    auto outer = ThreadIdx();
+    ParallelFor(4, n_threads, Sched::Static(), [&](size_t) {
+      ASSERT_EQ(ThreadIdx(), 0);
+      nested[i]++;
+    });
+    ASSERT_EQ(ThreadIdx(), outer);
+  });
+  for (auto v : nested) {
+    ASSERT_EQ(v, 4);
+  }
+
+  ASSERT_THROW(ParallelFor(kSize, n_threads, Sched::Dyn(),
+                           [&](size_t i) {
+                             if (i == kSize / 2) {
+                               LOG(FATAL) << "Test";
+                             }
+                           }),
+               dmlc::Error);
+  ParallelPool::SetBackend("omp");
+  ASSERT_THROW(ParallelPool::SetBackend("tbb"), dmlc::Error);
+  ASSERT_EQ(ParallelPool::GetBackend(), ParallelPool::kOpenMP);
+}
+
+TEST(ParallelPool, ConcurrentCallers) {
+  auto pool = ParallelPool::Get();
+  size_t constexpr kSize = 4096;
+  std::vector<std::thread> callers;
+  std::vector<int64_t> sums(8, 0);
+  for (size_t t = 0; t < sums.size(); ++t) {
+    callers.emplace_back([&, t] {
+      std::atomic<int64_t> sum{0};
+      pool->Run(kSize, 16, 4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          sum += i;
+        }
+      });
+      sums[t] = sum;
+    });
+  }
+  for (auto& c : callers) {
+    c.join();
+  }
+  for (auto s : sums) {
+    ASSERT_EQ(s, static_cast<int64_t>(kSize * (kSize - 1) / 2));
+  }
+}
+
 #if defined(_OPENMP)
 TEST(OmpSetNumThreads, Basic) {
   auto nthreads = 2;
@@ -0,0 +1,41 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "../../../src/common/threadpool.h"
+
+namespace xgboost {
+namespace common {
+TEST(ThreadPool, Basic) {
+  std::atomic<int32_t> n_finished{0};
+  std::vector<std::future<int32_t>> results;
+  {
+    ThreadPool pool{3};
+    ASSERT_EQ(pool.Size(), 3);
+    for (int32_t i = 0; i < 64; ++i) {
+      results.emplace_back(pool.Submit([i, &n_finished] {
+        n_finished++;
+        return i * 2;
+      }));
+    }
+    for (int32_t i = 0; i < 64; ++i) {
+      ASSERT_EQ(results[i].get(), i * 2);
+    }
+
+    auto fut = pool.Submit([]() -> int32_t { LOG(FATAL) << "error"; return 0; });
+    ASSERT_THROW(fut.get(), dmlc::Error);
+
+    // Pending tasks are finished before the pool is destroyed.
+    for (int32_t i = 0; i < 16; ++i) {
+      pool.Submit([&n_finished] { n_finished++; });
+    }
+  }
+  ASSERT_EQ(n_finished, 64 + 16);
+}
+}  // namespace common
+}  // namespace xgboost
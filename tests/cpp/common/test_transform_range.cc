@@ -51,6 +51,29 @@ TEST(Transform, DeclareUnifiedTest(Basic)) {
 }
 
 #if !defined(__CUDACC__)
+TEST(Transform, CPUBlock) {
+  size_t constexpr kSize{10000};
+  HostDeviceVector<bst_float> out_vec(kSize, 0.0f);
+  HostDeviceVector<int32_t> n_calls(kSize, 0);
+  Transform<>::Init(
+      [](size_t idx, Span<float> out, Span<int32_t>) { out[idx] = -1.0f; },
+      Range{0, static_cast<Range::DifferenceType>(kSize)}, -1)
+      .WithCPUBlock([](size_t begin, size_t end, Span<float> out, Span<int32_t> calls) {
+        ASSERT_LT(begin, end);
+        for (size_t i = begin; i < end; ++i) {
+          out[i] = static_cast<float>(i);
+          calls[i]++;
+        }
+      })
+      .Eval(&out_vec, &n_calls);
+  auto const& h_out = out_vec.ConstHostVector();
+  auto const& h_calls = n_calls.ConstHostVector();
+  for (size_t i = 0; i < kSize; ++i) {
+    ASSERT_EQ(h_out[i], static_cast<float>(i));
+    ASSERT_EQ(h_calls[i], 1);
+  }
+}
+
 TEST(TransformDeathTest, Exception) {
   size_t const kSize {16};
   std::vector<bst_float> h_in(kSize);
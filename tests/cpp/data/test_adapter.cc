@@ -1,10 +1,14 @@
 // Copyright (c) 2019-2021 by XGBoost Contributors
 #include <gtest/gtest.h>
+#include <cmath>
+#include <string>
 #include <type_traits>
+#include <vector>
 #include <utility>
 #include <xgboost/data.h>
 #include "../../../src/data/adapter.h"
 #include "../../../src/data/simple_dmatrix.h"
+#include "../../../src/common/common.h"
 #include "../../../src/common/timer.h"
 #include "../helpers.h"
 
@@ -160,4 +164,235 @@ TEST(Adapter, IteratorAdapter) {
   }
   ASSERT_EQ(num_batch, 1);
 }
+
+namespace {
+void ReleaseArrowSchemaForTest(ArrowSchema*) {}
+void ReleaseArrowArrayForTest(ArrowArray*) {}
+
+// A record batch with 4 rows and columns of float32 (with null), int32 (with offset),
+// dictionary encoded int8 and boolean.
+class ArrowBatchForTest {
+  std::vector<float> f32_{1, 2, 3, 4};
+  std::vector<int32_t> i32_{0, 5, 6, 7, 8};
+  std::vector<int8_t> dict_{0, 1, 1, 0};
+  std::vector<uint8_t> f32_validity_{0b1011};
+  std::vector<uint8_t> boolean_{0b0101};
+
+  std::vector<std::vector<void const*>> buffers_;
+  std::vector<std::string> formats_{"f", "i", "c", "b"};
+  std::vector<std::string> names_{"f32", "i32", "dict", "bool"};
+  std::vector<ArrowArray> arrays_;
+  std::vector<ArrowArray*> p_arrays_;
+  std::vector<ArrowSchema> schemas_;
+  std::vector<ArrowSchema*> p_schemas_;
+  ArrowSchema dictionary_;
+  void const* struct_buffer_{nullptr};
+
+ public:
+  static size_t constexpr kRows = 4;
+  static size_t constexpr kCols = 4;
+
+  ArrowArray array;
+  ArrowSchema schema;
+
+  ArrowBatchForTest() : arrays_(kCols), schemas_(kCols) {
+    buffers_ = {{f32_validity_.data(), f32_.data()},
+                {nullptr, i32_.data()},
+                {nullptr, dict_.data()},
+                {nullptr, boolean_.data()}};
+    dictionary_ = ArrowSchema{"u", nullptr, nullptr, 0, 0, nullptr, nullptr,
+                              ReleaseArrowSchemaForTest, nullptr};
+    for (size_t i = 0; i < kCols; ++i) {
+      int64_t null_count = i == 0 ? 1 : 0;
+      int64_t offset = i == 1 ? 1 : 0;
+      arrays_[i] = ArrowArray{static_cast<int64_t>(kRows), null_count, offset, 2, 0,
+                              buffers_[i].data(), nullptr, nullptr, ReleaseArrowArrayForTest,
+                              nullptr};
+      schemas_[i] = ArrowSchema{formats_[i].c_str(), names_[i].c_str(), nullptr, 0, 0,
+                                nullptr, i == 2 ? &dictionary_ : nullptr,
+                                ReleaseArrowSchemaForTest, nullptr};
+      p_arrays_.push_back(&arrays_[i]);
+      p_schemas_.push_back(&schemas_[i]);
+    }
+    array = ArrowArray{static_cast<int64_t>(kRows), 0, 0, 1, static_cast<int64_t>(kCols),
+                       &struct_buffer_, p_arrays_.data(), nullptr, ReleaseArrowArrayForTest,
+                       nullptr};
+    schema = ArrowSchema{"+s", "", nullptr, 0, static_cast<int64_t>(kCols), p_schemas_.data(),
+                         nullptr, ReleaseArrowSchemaForTest, nullptr};
+  }
+};
+
+size_t constexpr ArrowBatchForTest::kRows;
+size_t constexpr ArrowBatchForTest::kCols;
+
+// A record batch with a string column and a dictionary encoded column of strings, empty
+// strings in the string column are nulls.
+class ArrowStringBatchForTest {
+  std::vector<int32_t> str_offsets_{0};
+  std::string chars_;
+  std::vector<uint8_t> validity_;
+  std::vector<int8_t> indices_;
+  std::vector<int32_t> dict_offsets_{0};
+  std::string dict_chars_;
+
+  std::vector<std::vector<void const*>> buffers_;
+  std::vector<void const*> dict_buffers_;
+  ArrowArray dict_array_;
+  ArrowSchema dict_schema_;
+  std::vector<ArrowArray> arrays_;
+  std::vector<ArrowArray*> p_arrays_;
+  std::vector<ArrowSchema> schemas_;
+  std::vector<ArrowSchema*> p_schemas_;
+  void const* struct_buffer_{nullptr};
+
+ public:
+  ArrowArray array;
+  ArrowSchema schema;
+
+  ArrowStringBatchForTest(std::vector<std::string> const& strings,
+                          std::vector<int8_t> const& indices,
+                          std::vector<std::string> const& dictionary)
+      : indices_{indices}, arrays_(2), schemas_(2) {
+    CHECK_EQ(strings.size(), indices.size());
+    auto n_rows = static_cast<int64_t>(strings.size());
+    validity_.resize(common::DivRoundUp(strings.size(), 8), 0);
+    int64_t null_count = 0;
+    for (size_t i = 0; i < strings.size(); ++i) {
+      if (strings[i].empty()) {
+        ++null_count;
+      } else {
+        validity_[i / 8] |= 1 << (i % 8);
+      }
+      chars_ += strings[i];
+      str_offsets_.push_back(static_cast<int32_t>(chars_.size()));
+    }
+    for (auto const& str : dictionary) {
+      dict_chars_ += str;
+      dict_offsets_.push_back(static_cast<int32_t>(dict_chars_.size()));
+    }
+
+    buffers_ = {{validity_.data(), str_offsets_.data(), chars_.data()},
+                {nullptr, indices_.data()}};
+    dict_buffers_ = {nullptr, dict_offsets_.data(), dict_chars_.data()};
+    dict_array_ = ArrowArray{static_cast<int64_t>(dictionary.size()), 0, 0, 3, 0,
+                             dict_buffers_.data(), nullptr, nullptr, ReleaseArrowArrayForTest,
+                             nullptr};
+    dict_schema_ = ArrowSchema{"u", nullptr, nullptr, 0, 0, nullptr, nullptr,
+                               ReleaseArrowSchemaForTest, nullptr};
+    arrays_[0] = ArrowArray{n_rows, null_count, 0, 3, 0, buffers_[0].data(), nullptr,
+                            nullptr, ReleaseArrowArrayForTest, nullptr};
+    arrays_[1] = ArrowArray{n_rows, 0, 0, 2, 0, buffers_[1].data(), nullptr, &dict_array_,
+                            ReleaseArrowArrayForTest, nullptr};
+    schemas_[0] = ArrowSchema{"u", "str", nullptr, 0, 0, nullptr, nullptr,
+                              ReleaseArrowSchemaForTest, nullptr};
+    schemas_[1] = ArrowSchema{"c", "dict", nullptr, 0, 0, nullptr, &dict_schema_,
+                              ReleaseArrowSchemaForTest, nullptr};
+    for (size_t i = 0; i < arrays_.size(); ++i) {
+      p_arrays_.push_back(&arrays_[i]);
+      p_schemas_.push_back(&schemas_[i]);
+    }
+    array = ArrowArray{n_rows, 0, 0, 1, 2, &struct_buffer_, p_arrays_.data(), nullptr,
+                       ReleaseArrowArrayForTest, nullptr};
+    schema = ArrowSchema{"+s", "", nullptr, 0, 2, p_schemas_.data(), nullptr,
+                         ReleaseArrowSchemaForTest, nullptr};
+  }
+};
+
+void CheckArrowCodes(data::ArrowAdapterBatch const& batch,
+                     std::vector<std::vector<float>> const& expected) {
+  ASSERT_EQ(batch.Size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    auto line = batch.GetLine(i);
+    for (size_t j = 0; j < line.Size(); ++j) {
+      auto value = line.GetElement(j).value;
+      if (std::isnan(expected[i][j])) {
+        ASSERT_TRUE(std::isnan(value));
+      } else {
+        ASSERT_EQ(value, expected[i][j]);
+      }
+    }
+  }
+}
+}  // anonymous namespace
+
+TEST(Adapter, ArrowAdapter) {
+  ArrowBatchForTest batch;
+  data::ArrowAdapter adapter{&batch.array, &batch.schema};
+  ASSERT_EQ(adapter.NumRows(), ArrowBatchForTest::kRows);
+  ASSERT_EQ(adapter.NumColumns(), ArrowBatchForTest::kCols);
+  ASSERT_EQ(adapter.Value().FeatureTypes(), std::vector<std::string>({"q", "q", "c", "q"}));
+
+  data::SimpleDMatrix dmat(&adapter, std::numeric_limits<float>::quiet_NaN(), 2);
+  ASSERT_EQ(dmat.Info().num_row_, ArrowBatchForTest::kRows);
+  ASSERT_EQ(dmat.Info().num_col_, ArrowBatchForTest::kCols);
+  // One null value.
+  ASSERT_EQ(dmat.Info().num_nonzero_, ArrowBatchForTest::kRows * ArrowBatchForTest::kCols - 1);
+
+  std::vector<std::vector<float>> expected{
+      {1, 5, 0, 1}, {2, 6, 1, 0}, {7, 1, 1}, {4, 8, 0, 0}};
+  auto const& page = *dmat.GetBatches<SparsePage>().begin();
+  auto view = page.GetView();
+  for (size_t i = 0; i < ArrowBatchForTest::kRows; ++i) {
+    auto inst = view[i];
+    ASSERT_EQ(inst.size(), expected[i].size());
+    for (size_t j = 0; j < inst.size(); ++j) {
+      ASSERT_EQ(inst[j].fvalue, expected[i][j]);
+    }
+  }
+  ASSERT_EQ(view[2][0].index, 1);
+
+  DMatrixHandle handle;
+  ASSERT_EQ(XGDMatrixCreateFromArrow(&batch.array, &batch.schema,
+                                     R"({"missing": NaN, "nthread": 1})", &handle),
+            0);
+  auto p_m = *static_cast<std::shared_ptr<DMatrix>*>(handle);
+  ASSERT_EQ(p_m->Info().feature_names,
+            std::vector<std::string>({"f32", "i32", "dict", "bool"}));
+  ASSERT_EQ(p_m->Info().feature_types.ConstHostVector()[2], FeatureType::kCategorical);
+  ASSERT_EQ(XGDMatrixFree(handle), 0);
+}
+
+TEST(Adapter, ArrowStringCategories) {
+  float nan = std::numeric_limits<float>::quiet_NaN();
+  ArrowStringBatchForTest train{{"b", "a", "", "b"}, {1, 0, 1, 1}, {"x", "y"}};
+  data::ArrowAdapter adapter{&train.array, &train.schema};
+  auto categories = adapter.Value().Categories();
+  ASSERT_TRUE(categories);
+  ASSERT_EQ(adapter.Value().FeatureTypes(), std::vector<std::string>({"c", "c"}));
+  ASSERT_EQ(categories->Categories(0), std::vector<std::string>({"b", "a"}));
+  ASSERT_EQ(categories->Categories(1), std::vector<std::string>({"x", "y"}));
+  CheckArrowCodes(adapter.Value(), {{0, 1}, {1, 0}, {nan, 1}, {0, 1}});
+
+  // Unseen categories are missing when the dictionary is not extended.
+  ArrowStringBatchForTest test{{"a", "c", "b", ""}, {0, 1, 1, 0}, {"z", "x"}};
+  data::ArrowAdapter fixed{&test.array, &test.schema, categories, false};
+  ASSERT_EQ(fixed.Value().Categories(), categories);
+  CheckArrowCodes(fixed.Value(), {{1, nan}, {nan, 0}, {0, 0}, {nan, nan}});
+
+  data::ArrowAdapter extended{&test.array, &test.schema, categories, true};
+  auto ext = extended.Value().Categories();
+  ASSERT_EQ(ext->Categories(0), std::vector<std::string>({"b", "a", "c"}));
+  ASSERT_EQ(ext->Categories(1), std::vector<std::string>({"x", "y", "z"}));
+  CheckArrowCodes(extended.Value(), {{1, 2}, {2, 0}, {0, 0}, {nan, 2}});
+  // The reference dictionary is not modified.
+  ASSERT_EQ(categories->Categories(0).size(), 2);
+
+  // Data encoded by its own dictionary is recoded to match the reference.
+  data::ArrowAdapter own{&test.array, &test.schema};
+  data::SimpleDMatrix dmat(&own, nan, 1);
+  std::vector<std::vector<float>> remap;
+  ASSERT_FALSE(categories->Remap(*own.Value().Categories(), &remap));
+  ASSERT_TRUE(dmat.RecodeCategories(remap));
+  ASSERT_EQ(dmat.Info().num_nonzero_, 4);
+  std::vector<std::vector<Entry>> expected{{{0, 1}}, {{1, 0}}, {{0, 0}, {1, 0}}, {}};
+  auto const& page = *dmat.GetBatches<SparsePage>().begin();
+  auto view = page.GetView();
+  for (size_t i = 0; i < expected.size(); ++i) {
+    auto inst = view[i];
+    ASSERT_EQ(inst.size(), expected[i].size());
+    for (size_t j = 0; j < inst.size(); ++j) {
+      ASSERT_EQ(inst[j], expected[i][j]);
+    }
+  }
+}
 }  // namespace xgboost
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <dmlc/filesystem.h>
+#include <algorithm>
 #include <fstream>
 #include <memory>
 #include <vector>
@@ -83,6 +84,49 @@ TEST(SparsePage, PushCSCAfterTranspose) {
   }
 }
 
+TEST(SparsePage, Transpose) {
+  // More columns than buckets of the transpose, so that buckets hold multiple columns.
+  size_t constexpr kRows = 512, kCols = 3000;
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0.9}.GenerateDMatrix();
+  auto const& page = *p_fmat->GetBatches<SparsePage>().begin();
+  auto h_page = page.GetView();
+
+  std::vector<std::vector<Entry>> expected(kCols);
+  for (size_t i = 0; i < h_page.Size(); ++i) {
+    for (auto const& e : h_page[i]) {
+      expected[e.index].emplace_back(page.base_rowid + i, e.fvalue);
+    }
+  }
+
+  for (bool sort_by_value : {false, true}) {
+    auto transpose = page.GetTranspose(kCols, sort_by_value);
+    ASSERT_EQ(transpose.Size(), kCols);
+    ASSERT_EQ(transpose.data.Size(), page.data.Size());
+    auto h_transpose = transpose.GetView();
+    for (size_t j = 0; j < kCols; ++j) {
+      auto column = expected[j];
+      if (sort_by_value) {
+        std::stable_sort(column.begin(), column.end(), Entry::CmpValue);
+      }
+      auto got = h_transpose[j];
+      ASSERT_EQ(got.size(), column.size());
+      for (size_t k = 0; k < column.size(); ++k) {
+        if (sort_by_value) {
+          ASSERT_EQ(got[k].fvalue, column[k].fvalue);
+        } else {
+          ASSERT_EQ(got[k].index, column[k].index);
+          ASSERT_EQ(got[k].fvalue, column[k].fvalue);
+        }
+      }
+    }
+  }
+
+  SparsePage empty;
+  auto transpose = empty.GetTranspose(kCols);
+  ASSERT_EQ(transpose.Size(), kCols);
+  ASSERT_EQ(transpose.data.Size(), 0);
+}
+
 TEST(DMatrix, Uri) {
   size_t constexpr kRows {16};
   size_t constexpr kCols {8};
@@ -34,6 +34,9 @@ TEST(EllpackPage, BuildGidxDense) {
   common::CompressedIterator<uint32_t> gidx(h_gidx_buffer.data(), page->NumSymbols());
 
   ASSERT_EQ(page->row_stride, kNCols);
+  // Dense matrix stores bin index relative to feature without the null symbol.
+  auto const& h_cut_ptrs = page->Cuts().Ptrs();
+  ASSERT_EQ(page->NumSymbols(), 3);
 
   std::vector<uint32_t> solution = {
     0, 3, 8,  9, 14, 17, 20, 21,
@@ -54,7 +57,7 @@ TEST(EllpackPage, BuildGidxDense) {
     1, 4, 7, 10, 14, 16, 19, 21,
   };
   for (size_t i = 0; i < kNRows * kNCols; ++i) {
-    ASSERT_EQ(solution[i], gidx[i]);
+    ASSERT_EQ(solution[i], gidx[i] + h_cut_ptrs[i % kNCols]);
   }
 }
 
@@ -236,4 +239,37 @@ TEST(EllpackPage, Compact) {
     }
   }
 }
+
+TEST(EllpackPage, PrefetchToDevice) {
+  constexpr size_t kRows = 64;
+  constexpr size_t kCols = 8;
+  auto dmat = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix();
+  BatchParam param{0, 16};
+  auto page = (*dmat->GetBatches<EllpackPage>(param).begin()).Impl();
+  auto const& h_gidx = page->gidx_buffer.ConstHostVector();
+
+  // Same as a page read from external memory cache, only the host buffer is available.
+  EllpackPageImpl prefetched(0, page->Cuts(), page->is_dense, page->row_stride, kRows);
+  prefetched.gidx_buffer.HostVector() = h_gidx;
+  prefetched.PrefetchToDevice(0);
+
+  auto d_gidx = prefetched.ConstGidxDevicePointer(0);
+  ASSERT_NE(d_gidx, prefetched.gidx_buffer.ConstDevicePointer());
+  std::vector<common::CompressedByteT> copied(h_gidx.size());
+  dh::safe_cuda(cudaMemcpy(copied.data(), d_gidx, copied.size(), cudaMemcpyDeviceToHost));
+  ASSERT_EQ(copied, h_gidx);
+
+  thrust::device_vector<bst_float> row_d(kCols);
+  thrust::device_vector<bst_float> row_result_d(kCols);
+  std::vector<bst_float> row(kCols);
+  std::vector<bst_float> row_result(kCols);
+  for (size_t i = 0; i < kRows; ++i) {
+    dh::LaunchN(kCols, ReadRowFunction(page->GetDeviceAccessor(0), i, row_d.data().get()));
+    thrust::copy(row_d.begin(), row_d.end(), row.begin());
+    dh::LaunchN(kCols,
+                ReadRowFunction(prefetched.GetDeviceAccessor(0), i, row_result_d.data().get()));
+    thrust::copy(row_result_d.begin(), row_result_d.end(), row_result.begin());
+    EXPECT_EQ(row, row_result);
+  }
+}
 }  // namespace xgboost
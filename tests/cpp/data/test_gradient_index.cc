@@ -4,7 +4,10 @@
 #include <gtest/gtest.h>
 #include <xgboost/data.h>
 
+#include <thread>
+
 #include "../helpers.h"
+#include "../../../src/common/column_matrix.h"
 #include "../../../src/data/gradient_index.h"
 
 namespace xgboost {
@@ -57,5 +60,34 @@ TEST(GradientIndex, FromCategoricalBasic) {
     ASSERT_EQ(common::AsCat(x[i]), common::AsCat(bin_value));
   }
 }
+
+TEST(GradientIndex, SharedColumns) {
+  size_t constexpr kRows = 256, kCols = 16;
+  auto m = RandomDataGenerator{kRows, kCols, 0.5}.GenerateDMatrix();
+  BatchParam param{GenericParameter::kCpuId, 32};
+
+  size_t constexpr kThreads = 4;
+  std::vector<std::shared_ptr<GHistIndexMatrix const>> gidx(kThreads);
+  std::vector<std::shared_ptr<common::ColumnMatrix const>> columns(kThreads);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < kThreads; ++i) {
+    workers.emplace_back([&, i]() {
+      gidx[i] = m->GetBatches<GHistIndexMatrix>(param).begin().Page();
+      columns[i] = gidx[i]->Columns(0.2);
+    });
+  }
+  for (auto& t : workers) {
+    t.join();
+  }
+  for (size_t i = 1; i < kThreads; ++i) {
+    ASSERT_EQ(gidx[i], gidx[0]);
+    ASSERT_EQ(columns[i], columns[0]);
+  }
+  ASSERT_EQ(columns[0]->GetNumFeature(), kCols);
+  // Rebuilt for a different threshold, the old one is still valid for its holders.
+  auto dense = gidx[0]->Columns(0.0);
+  ASSERT_NE(dense, columns[0]);
+  ASSERT_EQ(gidx[0]->Columns(0.0), dense);
+}
 }  // namespace data
 }  // namespace xgboost
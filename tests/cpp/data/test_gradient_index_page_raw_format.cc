@@ -3,15 +3,18 @@
  */
 #include <gtest/gtest.h>
 
+#include <string>
+
 #include "../../../src/data/gradient_index.h"
 #include "../../../src/data/sparse_page_source.h"
 #include "../helpers.h"
 
 namespace xgboost {
 namespace data {
-TEST(GHistIndexPageRawFormat, IO) {
+namespace {
+void TestGHistIndexPageFormat(std::string name) {
   std::unique_ptr<SparsePageFormat<GHistIndexMatrix>> format{
-      CreatePageFormat<GHistIndexMatrix>("raw")};
+      CreatePageFormat<GHistIndexMatrix>(name)};
   auto m = RandomDataGenerator{100, 14, 0.5}.GenerateDMatrix();
   dmlc::TemporaryDirectory tmpdir;
   std::string path = tmpdir.path + "/ghistindex.page";
@@ -42,7 +45,14 @@ TEST(GHistIndexPageRawFormat, IO) {
     ASSERT_TRUE(std::equal(loaded.index.Offset(),
                            loaded.index.Offset() + loaded.index.OffsetSize(),
                            page.index.Offset()));
+    ASSERT_EQ(loaded.row_ptr, page.row_ptr);
+    ASSERT_EQ(loaded.hit_count, page.hit_count);
   }
 }
+}  // anonymous namespace
+
+TEST(GHistIndexPageRawFormat, IO) { TestGHistIndexPageFormat("raw"); }
+
+TEST(GHistIndexPageCompressedFormat, IO) { TestGHistIndexPageFormat("compressed"); }
 } // namespace data
 } // namespace xgboost
@@ -108,9 +108,12 @@ TEST(IterativeDeviceDMatrix, RowMajor) {
     common::Span<float const> s_data{static_cast<float const*>(loaded.data), cols * rows};
     dh::CopyDeviceSpanToVector(&h_data, s_data);
 
+    auto const& h_cut_ptrs = impl->Cuts().Ptrs();
     for(auto i = 0ull; i < rows * cols; i++) {
       int column_idx = i % cols;
-      EXPECT_EQ(impl->Cuts().SearchBin(h_data[i], column_idx), iterator[i]);
+      // Dense matrix stores bin index relative to feature.
+      EXPECT_EQ(impl->Cuts().SearchBin(h_data[i], column_idx),
+                iterator[i] + h_cut_ptrs[column_idx]);
     }
     EXPECT_EQ(m.Info().num_col_, cols);
     EXPECT_EQ(m.Info().num_row_, rows);
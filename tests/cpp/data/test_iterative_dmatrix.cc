@@ -0,0 +1,117 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+
+#include "../helpers.h"
+#include "../../../src/common/column_matrix.h"
+#include "../../../src/data/iterative_dmatrix.h"
+#include "../../../src/data/gradient_index.h"
+#include "../../../src/data/adapter.h"
+
+namespace xgboost {
+namespace data {
+namespace {
+void TestEquivalent(float sparsity, size_t prefetch_batches = 0) {
+  ArrayIterForTest iter{sparsity};
+  int32_t max_bin = 64;
+  IterativeDMatrix m(&iter, iter.Proxy(), Reset, Next, std::numeric_limits<float>::quiet_NaN(),
+                     0, max_bin, prefetch_batches);
+  ASSERT_EQ(m.Info().num_col_, ArrayIterForTest::kCols);
+  ASSERT_EQ(m.Info().num_row_, ArrayIterForTest::kRows);
+  ASSERT_FALSE(m.PageExists<SparsePage>());
+  ASSERT_TRUE(m.PageExists<GHistIndexMatrix>());
+
+  std::string interface_str = iter.AsArray();
+  auto adapter = ArrayAdapter(StringView{interface_str});
+  std::unique_ptr<DMatrix> dm{
+      DMatrix::Create(&adapter, std::numeric_limits<float>::quiet_NaN(), 0)};
+  ASSERT_EQ(dm->Info().num_nonzero_, m.Info().num_nonzero_);
+  ASSERT_EQ(dm->IsDense(), m.IsDense());
+
+  size_t n_batches = 0;
+  for (auto const &from_iter :
+       m.GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, max_bin})) {
+    for (auto const &from_data :
+         dm->GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, max_bin})) {
+      ASSERT_EQ(from_iter.cut.Ptrs(), from_data.cut.Ptrs());
+      ASSERT_EQ(from_iter.cut.Values(), from_data.cut.Values());
+      ASSERT_EQ(from_iter.cut.MinValues(), from_data.cut.MinValues());
+      ASSERT_EQ(from_iter.row_ptr, from_data.row_ptr);
+      ASSERT_EQ(from_iter.hit_count, from_data.hit_count);
+      ASSERT_EQ(from_iter.IsDense(), from_data.IsDense());
+      ASSERT_EQ(from_iter.index.GetBinTypeSize(), from_data.index.GetBinTypeSize());
+      ASSERT_TRUE(std::equal(from_iter.index.begin(), from_iter.index.end(),
+                             from_data.index.begin()));
+
+      // Column matrix is built from the gradient index alone.
+      common::ColumnMatrix columns_iter, columns_data;
+      columns_iter.Init(from_iter, 0.2);
+      columns_data.Init(from_data, 0.2);
+      for (bst_feature_t fidx = 0; fidx < m.Info().num_col_; ++fidx) {
+        ASSERT_EQ(columns_iter.GetColumnType(fidx), columns_data.GetColumnType(fidx));
+      }
+    }
+    ++n_batches;
+  }
+  ASSERT_EQ(n_batches, 1);
+}
+}  // anonymous namespace
+
+TEST(IterativeDMatrix, Dense) { TestEquivalent(0.0); }
+
+TEST(IterativeDMatrix, Sparse) { TestEquivalent(0.6); }
+
+TEST(IterativeDMatrix, Prefetch) {
+  TestEquivalent(0.0, 1);
+  TestEquivalent(0.6, 4);
+}
+
+TEST(IterativeDMatrix, MaxBin) {
+  ArrayIterForTest iter{0.0};
+  IterativeDMatrix m(&iter, iter.Proxy(), Reset, Next, std::numeric_limits<float>::quiet_NaN(),
+                     0, 32);
+  // Default parameter is accepted.
+  for (auto const &page : m.GetBatches<GHistIndexMatrix>(BatchParam{})) {
+    ASSERT_EQ(page.max_num_bins, 32);
+  }
+  EXPECT_THROW(m.GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, 64}), dmlc::Error);
+  EXPECT_THROW(m.GetBatches<SparsePage>(), dmlc::Error);
+}
+
+TEST(IterativeDMatrix, Ref) {
+  int32_t max_bin = 32;
+  ArrayIterForTest ref_iter{0.0};
+  std::shared_ptr<DMatrix> ref{new IterativeDMatrix(&ref_iter, ref_iter.Proxy(), Reset, Next,
+                                                    std::numeric_limits<float>::quiet_NaN(),
+                                                    0, max_bin)};
+  auto const &ref_page = *ref->GetBatches<GHistIndexMatrix>(BatchParam{}).begin();
+
+  // A smaller batch is quantized with cuts of the reference.
+  ArrayIterForTest iter{0.0, 64, ArrayIterForTest::kCols, 4};
+  IterativeDMatrix m(&iter, iter.Proxy(), Reset, Next, std::numeric_limits<float>::quiet_NaN(),
+                     0, max_bin, 0, ref);
+  ASSERT_EQ(m.Info().num_row_, 64);
+  std::string interface_str = iter.AsArray();
+  auto adapter = ArrayAdapter(StringView{interface_str});
+  std::unique_ptr<DMatrix> dm{
+      DMatrix::Create(&adapter, std::numeric_limits<float>::quiet_NaN(), 0)};
+  GHistIndexMatrix expected;
+  for (auto const &page : dm->GetBatches<SparsePage>()) {
+    expected.Init(page, {}, ref_page.cut, max_bin, dm->IsDense(), 1);
+  }
+
+  for (auto const &page : m.GetBatches<GHistIndexMatrix>(BatchParam{})) {
+    ASSERT_EQ(page.cut.Ptrs(), ref_page.cut.Ptrs());
+    ASSERT_EQ(page.cut.Values(), ref_page.cut.Values());
+    ASSERT_EQ(page.cut.MinValues(), ref_page.cut.MinValues());
+    ASSERT_EQ(page.row_ptr, expected.row_ptr);
+    ASSERT_EQ(page.hit_count, expected.hit_count);
+    ASSERT_TRUE(std::equal(page.index.begin(), page.index.end(), expected.index.begin()));
+  }
+}
+}  // namespace data
+}  // namespace xgboost
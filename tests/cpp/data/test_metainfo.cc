@@ -298,6 +298,27 @@ TEST(MetaInfo, HostExtend) {
   }
 }
 
+TEST(MetaInfo, BinaryLabelBits) {
+  xgboost::MetaInfo info;
+  size_t const kRows = 130;
+  std::vector<float> labels(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    labels[i] = i % 3 == 0;
+  }
+  info.SetInfo("label", labels.data(), xgboost::DataType::kFloat32, kRows);
+  auto const* bits = info.BinaryLabelBits();
+  ASSERT_TRUE(bits);
+  ASSERT_EQ(bits->size(), 3ul);
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_EQ(((*bits)[i / 64] >> (i % 64)) & 1, labels[i]);
+  }
+
+  // Setting labels invalidates the cache.
+  labels[1] = 0.5f;
+  info.SetInfo("label", labels.data(), xgboost::DataType::kFloat32, kRows);
+  ASSERT_FALSE(info.BinaryLabelBits());
+}
+
 namespace xgboost {
 TEST(MetaInfo, CPUStridedData) { TestMetaInfoStridedData(GenericParameter::kCpuId); }
 }  // namespace xgboost
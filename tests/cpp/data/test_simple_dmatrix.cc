@@ -193,6 +193,90 @@ TEST(SimpleDMatrix, FromCSC) {
   EXPECT_EQ(inst[0].index, 1);
 }
 
+TEST(SimpleDMatrix, FromCSCMultiThreads) {
+  size_t constexpr kRows = 32, kCols = 16;
+  std::vector<float> data;
+  std::vector<unsigned> row_idx;
+  std::vector<size_t> col_ptr{0};
+  for (size_t c = 0; c < kCols; ++c) {
+    for (size_t r = 0; r < kRows; ++r) {
+      // Leave some holes so rows have different lengths.
+      if ((r + c) % 3 != 0) {
+        row_idx.push_back(r);
+        data.push_back(static_cast<float>(r * kCols + c));
+      }
+    }
+    col_ptr.push_back(data.size());
+  }
+  data::CSCAdapter adapter(col_ptr.data(), row_idx.data(), data.data(), kCols, kRows);
+  data::SimpleDMatrix single(&adapter, std::numeric_limits<float>::quiet_NaN(), 1);
+  data::SimpleDMatrix multi(&adapter, std::numeric_limits<float>::quiet_NaN(), 4);
+  ASSERT_EQ(single.Info().num_row_, multi.Info().num_row_);
+  ASSERT_EQ(single.Info().num_nonzero_, multi.Info().num_nonzero_);
+
+  auto const &expected = *single.GetBatches<SparsePage>().begin();
+  auto const &got = *multi.GetBatches<SparsePage>().begin();
+  ASSERT_EQ(expected.offset.HostVector(), got.offset.HostVector());
+  auto const &h_expected = expected.data.HostVector();
+  auto const &h_got = got.data.HostVector();
+  ASSERT_EQ(h_expected.size(), h_got.size());
+  for (size_t i = 0; i < h_expected.size(); ++i) {
+    ASSERT_EQ(h_expected[i].index, h_got[i].index);
+    ASSERT_EQ(h_expected[i].fvalue, h_got[i].fvalue);
+  }
+}
+
+TEST(SimpleDMatrix, FromCSCUnsortedColumns) {
+  // Enough rows for several tiles and blocks.
+  size_t constexpr kRows = 20000, kCols = 24;
+  float constexpr kMissing = -1.0f;
+  std::vector<float> data;
+  std::vector<unsigned> row_idx;
+  std::vector<size_t> col_ptr{0};
+  std::vector<std::vector<Entry>> expected(kRows);
+  for (size_t c = 0; c < kCols; ++c) {
+    for (size_t r = 0; r < kRows; ++r) {
+      if ((r * 7 + c) % 5 == 0) {
+        continue;
+      }
+      auto v = (r + c) % 11 == 0 ? kMissing : static_cast<float>(r * kCols + c);
+      row_idx.push_back(r);
+      data.push_back(v);
+      if (v != kMissing) {
+        expected[r].emplace_back(c, v);
+      }
+    }
+    col_ptr.push_back(data.size());
+  }
+  auto check = [&](data::SimpleDMatrix &dmat) {
+    ASSERT_EQ(dmat.Info().num_row_, kRows);
+    auto const &page = *dmat.GetBatches<SparsePage>().begin();
+    auto view = page.GetView();
+    size_t nnz = 0;
+    for (size_t r = 0; r < kRows; ++r) {
+      auto inst = view[r];
+      ASSERT_EQ(inst.size(), expected[r].size());
+      for (size_t j = 0; j < inst.size(); ++j) {
+        ASSERT_EQ(inst[j].index, expected[r][j].index);
+        ASSERT_EQ(inst[j].fvalue, expected[r][j].fvalue);
+      }
+      nnz += inst.size();
+    }
+    ASSERT_EQ(dmat.Info().num_nonzero_, nnz);
+  };
+
+  data::CSCAdapter sorted(col_ptr.data(), row_idx.data(), data.data(), kCols, 0);
+  data::SimpleDMatrix from_sorted(&sorted, kMissing, 4);
+  check(from_sorted);
+
+  // Unsorted columns go through the generic builder.
+  std::reverse(row_idx.begin() + col_ptr[1], row_idx.begin() + col_ptr[2]);
+  std::reverse(data.begin() + col_ptr[1], data.begin() + col_ptr[2]);
+  data::CSCAdapter unsorted(col_ptr.data(), row_idx.data(), data.data(), kCols, 0);
+  data::SimpleDMatrix from_unsorted(&unsorted, kMissing, 4);
+  check(from_unsorted);
+}
+
 TEST(SimpleDMatrix, FromFile) {
   std::string filename = "test.libsvm";
   CreateBigTestData(filename, 3 * 5);
@@ -327,3 +411,39 @@ TEST(SimpleDMatrix, SaveLoadBinary) {
   delete dmat;
   delete dmat_read;
 }
+
+TEST(SimpleDMatrix, SaveLoadBinaryWithGHistIndex) {
+  dmlc::TemporaryDirectory tempdir;
+  size_t constexpr kRows = 64, kCols = 8;
+  int32_t constexpr kBins = 16;
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0.3}.GenerateDMatrix(true);
+  auto simple_dmat = dynamic_cast<data::SimpleDMatrix *>(p_fmat.get());
+  ASSERT_TRUE(simple_dmat);
+
+  const std::string tmp_binfile = tempdir.path + "/quantized.binary";
+  simple_dmat->SaveToLocalFile(tmp_binfile, kBins);
+  std::unique_ptr<DMatrix> dmat_read{DMatrix::Load(tmp_binfile, true, false)};
+  ASSERT_EQ(dmat_read->Info().num_row_, kRows);
+  ASSERT_EQ(dmat_read->Info().labels_.HostVector(), p_fmat->Info().labels_.HostVector());
+  ASSERT_TRUE(dmat_read->PageExists<GHistIndexMatrix>());
+
+  BatchParam param{GenericParameter::kCpuId, kBins};
+  auto const &expected = *p_fmat->GetBatches<GHistIndexMatrix>(param).begin();
+  auto const &loaded = *dmat_read->GetBatches<GHistIndexMatrix>(param).begin();
+  ASSERT_EQ(loaded.p_fmat, dmat_read.get());
+  ASSERT_EQ(loaded.cut.Values(), expected.cut.Values());
+  ASSERT_EQ(loaded.cut.Ptrs(), expected.cut.Ptrs());
+  ASSERT_EQ(loaded.cut.MinValues(), expected.cut.MinValues());
+  ASSERT_EQ(loaded.row_ptr, expected.row_ptr);
+  ASSERT_EQ(loaded.hit_count, expected.hit_count);
+  ASSERT_EQ(loaded.IsDense(), expected.IsDense());
+  for (size_t i = 0; i < expected.row_ptr.back(); ++i) {
+    ASSERT_EQ(loaded.index[i], expected.index[i]);
+  }
+
+  // Without max_bin the file is the same as before.
+  const std::string raw_binfile = tempdir.path + "/raw.binary";
+  simple_dmat->SaveToLocalFile(raw_binfile);
+  std::unique_ptr<DMatrix> raw_read{DMatrix::Load(raw_binfile, true, false)};
+  ASSERT_FALSE(raw_read->PageExists<GHistIndexMatrix>());
+}
@@ -0,0 +1,112 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/data.h>
+
+#include <array>
+#include <memory>
+
+#include "../../../src/data/gradient_index.h"
+#include "../../../src/data/slice_dmatrix.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace data {
+namespace {
+void CheckRowsEqual(DMatrix* lhs, DMatrix* rhs) {
+  for (auto const& l_batch : lhs->GetBatches<SparsePage>()) {
+    auto l_page = l_batch.GetView();
+    for (auto const& r_batch : rhs->GetBatches<SparsePage>()) {
+      auto r_page = r_batch.GetView();
+      ASSERT_EQ(l_batch.Size(), r_batch.Size());
+      for (size_t i = 0; i < l_batch.Size(); ++i) {
+        auto l_inst = l_page[i];
+        auto r_inst = r_page[i];
+        ASSERT_EQ(l_inst.size(), r_inst.size());
+        for (size_t j = 0; j < l_inst.size(); ++j) {
+          ASSERT_EQ(l_inst[j].index, r_inst[j].index);
+          ASSERT_EQ(l_inst[j].fvalue, r_inst[j].fvalue);
+        }
+      }
+    }
+  }
+}
+}  // anonymous namespace
+
+TEST(SliceDMatrix, Basic) {
+  size_t constexpr kRows{64}, kCols{8};
+  auto p_m = RandomDataGenerator{kRows, kCols, 0.4}.GenerateDMatrix(true);
+  std::array<int32_t, 5> ridxs{1, 3, 5, 3, 63};
+
+  std::unique_ptr<DMatrix> copied{p_m->Slice(ridxs)};
+  SliceDMatrix view{p_m, ridxs};
+  ASSERT_EQ(view.Info().num_row_, ridxs.size());
+  ASSERT_EQ(view.Info().num_col_, kCols);
+  ASSERT_EQ(view.Info().num_nonzero_, copied->Info().num_nonzero_);
+  ASSERT_EQ(view.Info().labels_.HostVector(), copied->Info().labels_.HostVector());
+
+  ASSERT_FALSE(view.PageExists<SparsePage>());
+  CheckRowsEqual(&view, copied.get());
+  ASSERT_TRUE(view.PageExists<SparsePage>());
+
+  std::array<int32_t, 1> out_of_bound{kRows};
+  ASSERT_THROW(SliceDMatrix(p_m, out_of_bound), dmlc::Error);
+}
+
+TEST(SliceDMatrix, GradientIndex) {
+  size_t constexpr kRows{128}, kCols{13};
+  int32_t constexpr kBins{16};
+  auto p_m = RandomDataGenerator{kRows, kCols, 0.3}.GenerateDMatrix();
+  std::array<int32_t, 6> ridxs{0, 7, 8, 64, 100, 127};
+  SliceDMatrix view{p_m, ridxs};
+
+  BatchParam param{GenericParameter::kCpuId, kBins};
+  auto const& parent = *p_m->GetBatches<GHistIndexMatrix>(param).begin();
+  ASSERT_TRUE(view.PageExists<GHistIndexMatrix>());
+  auto const& gathered = *view.GetBatches<GHistIndexMatrix>(param).begin();
+  // Gathering the gradient index doesn't need the raw data.
+  ASSERT_FALSE(view.PageExists<SparsePage>());
+
+  ASSERT_EQ(gathered.cut.Values(), parent.cut.Values());
+  ASSERT_EQ(gathered.cut.Ptrs(), parent.cut.Ptrs());
+  ASSERT_EQ(gathered.row_ptr.size(), ridxs.size() + 1);
+  ASSERT_EQ(gathered.IsDense(), parent.IsDense());
+
+  std::vector<size_t> hit_count(gathered.hit_count.size(), 0);
+  for (size_t i = 0; i < ridxs.size(); ++i) {
+    auto ridx = ridxs[i];
+    auto n = parent.row_ptr[ridx + 1] - parent.row_ptr[ridx];
+    ASSERT_EQ(gathered.row_ptr[i + 1] - gathered.row_ptr[i], n);
+    for (size_t j = 0; j < n; ++j) {
+      auto bin = gathered.index[gathered.row_ptr[i] + j];
+      ASSERT_EQ(bin, parent.index[parent.row_ptr[ridx] + j]);
+      hit_count[bin]++;
+    }
+  }
+  ASSERT_EQ(hit_count, gathered.hit_count);
+}
+
+TEST(SliceDMatrix, Compose) {
+  size_t constexpr kRows{32}, kCols{4};
+  auto p_m = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+  std::array<int32_t, 4> ridxs{2, 4, 6, 8};
+  auto view = std::make_shared<SliceDMatrix>(p_m, ridxs);
+
+  std::array<int32_t, 2> sub{1, 3};
+  std::unique_ptr<DMatrix> composed{view->Slice(sub)};
+  auto p_composed = dynamic_cast<SliceDMatrix*>(composed.get());
+  ASSERT_TRUE(p_composed);
+  ASSERT_EQ(p_composed->Parent(), p_m);
+  ASSERT_EQ(p_composed->RowIndices().size(), sub.size());
+  ASSERT_EQ(p_composed->RowIndices()[0], 4);
+  ASSERT_EQ(p_composed->RowIndices()[1], 8);
+
+  std::array<int32_t, 2> expected{4, 8};
+  std::unique_ptr<DMatrix> copied{p_m->Slice(expected)};
+  ASSERT_EQ(composed->Info().num_nonzero_, copied->Info().num_nonzero_);
+  ASSERT_EQ(composed->Info().labels_.HostVector(), copied->Info().labels_.HostVector());
+  CheckRowsEqual(composed.get(), copied.get());
+}
+}  // namespace data
+}  // namespace xgboost
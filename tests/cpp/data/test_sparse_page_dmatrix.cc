@@ -2,9 +2,11 @@
 #include <dmlc/filesystem.h>
 #include <gtest/gtest.h>
 #include <xgboost/data.h>
+#include <fstream>
 #include <thread>
 #include <future>
 #include "../../../src/common/io.h"
+#include "../../../src/common/perf_counters.h"
 #include "../../../src/data/adapter.h"
 #include "../../../src/data/simple_dmatrix.h"
 #include "../../../src/data/sparse_page_dmatrix.h"
@@ -14,7 +16,7 @@
 using namespace xgboost;  // NOLINT
 
 template <typename Page>
-void TestSparseDMatrixLoadFile() {
+void TestSparseDMatrixLoadFile(size_t prefetch_batches = 0) {
   dmlc::TemporaryDirectory tmpdir;
   auto opath = tmpdir.path + "/1-based.svm";
   CreateBigTestData(opath, 3 * 64, false);
@@ -26,7 +28,9 @@ void TestSparseDMatrixLoadFile() {
                             data::fileiter::Next,
                             std::numeric_limits<float>::quiet_NaN(),
                             1,
-                            "cache"};
+                            "cache",
+                            "raw",
+                            prefetch_batches};
   ASSERT_EQ(m.Info().num_col_, 5);
   ASSERT_EQ(m.Info().num_row_, 64);
 
@@ -58,6 +62,8 @@ void TestSparseDMatrixLoadFile() {
 TEST(SparsePageDMatrix, LoadFile) {
   TestSparseDMatrixLoadFile<SparsePage>();
   TestSparseDMatrixLoadFile<CSCPage>();
+  // Batches are read ahead from the iterator.
+  TestSparseDMatrixLoadFile<SparsePage>(2);
   TestSparseDMatrixLoadFile<SortedCSCPage>();
 }
 
@@ -100,6 +106,94 @@ TEST(SparsePageDMatrix, RetainSparsePage) {
   TestRetainPage<SortedCSCPage>();
 }
 
+TEST(SparsePageDMatrix, MemoryBudget) {
+  dmlc::TemporaryDirectory tmpdir;
+  auto prefix = tmpdir.path + "/cache";
+  ArrayIterForTest iter{0.2, 256, 8, 4};
+  auto create = [&](size_t budget) {
+    return std::unique_ptr<DMatrix>{DMatrix::Create(
+        static_cast<DataIterHandle>(&iter), iter.Proxy(), Reset, Next,
+        std::numeric_limits<float>::quiet_NaN(), 1, prefix, "raw", 0, budget)};
+  };
+  auto in_memory = create(1ul << 30);
+  ASSERT_TRUE(dynamic_cast<data::SimpleDMatrix *>(in_memory.get()));
+  // Exceeded by the first batch.
+  auto spilled = create(1024);
+  ASSERT_TRUE(dynamic_cast<data::SparsePageDMatrix *>(spilled.get()));
+
+  ASSERT_EQ(in_memory->Info().num_row_, 256);
+  ASSERT_EQ(in_memory->Info().num_row_, spilled->Info().num_row_);
+  ASSERT_EQ(in_memory->Info().num_col_, spilled->Info().num_col_);
+  ASSERT_EQ(in_memory->Info().num_nonzero_, spilled->Info().num_nonzero_);
+
+  SparsePage expected, out;
+  for (auto const &page : in_memory->GetBatches<SparsePage>()) {
+    expected.Push(page);
+  }
+  for (auto const &page : spilled->GetBatches<SparsePage>()) {
+    out.Push(page);
+  }
+  ASSERT_EQ(expected.offset.HostVector(), out.offset.HostVector());
+  auto const &h_expected = expected.data.ConstHostVector();
+  auto const &h_out = out.data.ConstHostVector();
+  ASSERT_EQ(h_expected.size(), h_out.size());
+  for (size_t i = 0; i < h_expected.size(); ++i) {
+    ASSERT_EQ(h_expected[i].index, h_out[i].index);
+    ASSERT_EQ(h_expected[i].fvalue, h_out[i].fvalue);
+  }
+}
+
+TEST(SparsePageDMatrix, QuantizedCheckpoint) {
+  dmlc::TemporaryDirectory tmpdir;
+  auto prefix = tmpdir.path + "/cache";
+  ArrayIterForTest iter{0.2, 256, 8, 4};
+  auto create = [&] {
+    return std::unique_ptr<DMatrix>{DMatrix::Create(
+        static_cast<DataIterHandle>(&iter), iter.Proxy(), Reset, Next,
+        std::numeric_limits<float>::quiet_NaN(), 1, prefix, "raw", 0, 0, true)};
+  };
+  auto const ckpt = prefix + ".gradient_index.ckpt";
+  BatchParam param{GenericParameter::kCpuId, 32};
+
+  std::vector<float> cut_values;
+  std::vector<size_t> row_ptr;
+  std::vector<uint8_t> index;
+  {
+    auto m = create();
+    auto const &gidx = *m->GetBatches<GHistIndexMatrix>(param).begin();
+    cut_values = gidx.cut.Values();
+    row_ptr = gidx.row_ptr;
+    index.assign(gidx.index.begin(), gidx.index.end());
+  }
+  // The checkpoint outlives the DMatrix.
+  ASSERT_TRUE(std::ifstream{ckpt}.good());
+
+  auto check = [&](DMatrix *m) {
+    common::PerfCounters::Get()->Reset();
+    auto const &gidx = *m->GetBatches<GHistIndexMatrix>(param).begin();
+    // Loaded from the checkpoint without reading any page.
+    ASSERT_EQ(common::PerfCounters::Get()->Read(common::PerfCounters::kPagesRead), 0);
+    ASSERT_EQ(gidx.cut.Values(), cut_values);
+    ASSERT_EQ(gidx.row_ptr, row_ptr);
+    ASSERT_EQ(std::vector<uint8_t>(gidx.index.begin(), gidx.index.end()), index);
+    ASSERT_EQ(gidx.p_fmat, m);
+  };
+  check(create().get());
+
+  // Built with a different parameter, the checkpoint is replaced.
+  {
+    auto m = create();
+    param.max_bin = 16;
+    common::PerfCounters::Get()->Reset();
+    auto const &gidx = *m->GetBatches<GHistIndexMatrix>(param).begin();
+    ASSERT_NE(common::PerfCounters::Get()->Read(common::PerfCounters::kPagesRead), 0);
+    cut_values = gidx.cut.Values();
+    row_ptr = gidx.row_ptr;
+    index.assign(gidx.index.begin(), gidx.index.end());
+  }
+  check(create().get());
+}
+
 TEST(SparsePageDMatrix, MetaInfo) {
   dmlc::TemporaryDirectory tempdir;
   const std::string tmp_file = tempdir.path + "/simple.libsvm";
@@ -258,3 +352,24 @@ TEST(SparsePageDMatrix, Determinism) {
     ASSERT_EQ(caches[i], caches.front());
   }
 }
+
+TEST(SparsePageDMatrix, PrefetchScheduler) {
+  data::PrefetchScheduler scheduler;
+  size_t constexpr kPageBytes = 1024;
+  auto n_default = static_cast<uint32_t>(data::PrefetchScheduler::kDefaultDepth);
+  ASSERT_EQ(scheduler.Depth(64, kPageBytes, kPageBytes * 1024), n_default);
+  // Limited by number of batches.
+  ASSERT_EQ(scheduler.Depth(2, kPageBytes, kPageBytes * 1024), 2);
+
+  // Slow disk, read takes 10 times longer than consuming a page.
+  scheduler.Update(1.0, 0.1);
+  ASSERT_EQ(scheduler.Depth(64, kPageBytes, kPageBytes * 1024), 11);
+  // Limited by memory.
+  ASSERT_EQ(scheduler.Depth(64, kPageBytes, kPageBytes * 8), 4);
+  ASSERT_EQ(scheduler.Depth(64, kPageBytes, 0), 1);
+
+  // Fast disk.
+  data::PrefetchScheduler fast;
+  fast.Update(0.01, 1.0);
+  ASSERT_EQ(fast.Depth(64, kPageBytes, kPageBytes * 1024), 2);
+}
@@ -5,27 +5,33 @@
 #include <dmlc/filesystem.h>
 #include <xgboost/data.h>
 
+#include <fstream>
+#include <string>
+
 #include "../../../src/data/sparse_page_source.h"
 #include "../helpers.h"
 
 namespace xgboost {
 namespace data {
-template <typename S> void TestSparsePageRawFormat() {
-  std::unique_ptr<SparsePageFormat<S>> format{CreatePageFormat<S>("raw")};
+template <typename S> void TestSparsePageRawFormat(std::string name = "raw") {
+  std::unique_ptr<SparsePageFormat<S>> format{CreatePageFormat<S>(name)};
 
   auto m = RandomDataGenerator{100, 14, 0.5}.GenerateDMatrix();
   ASSERT_TRUE(m->SingleColBlock());
   dmlc::TemporaryDirectory tmpdir;
   std::string path = tmpdir.path + "/sparse.page";
   S orig;
+  size_t bytes{0};
   {
     // block code to flush the stream
     std::unique_ptr<dmlc::Stream> fo{dmlc::Stream::Create(path.c_str(), "w")};
     for (auto const &page : m->GetBatches<S>()) {
       orig.Push(page);
-      format->Write(page, fo.get());
+      bytes += format->Write(page, fo.get());
     }
   }
+  // returned size is used as offset into the cache file.
+  ASSERT_EQ(bytes, std::ifstream(path, std::ios::binary | std::ios::ate).tellg());
 
   S page;
   std::unique_ptr<dmlc::SeekStream> fi{dmlc::SeekStream::CreateForRead(path.c_str())};
@@ -52,5 +58,17 @@ TEST(SparsePageRawFormat, CSCPage) {
 TEST(SparsePageRawFormat, SortedCSCPage) {
   TestSparsePageRawFormat<SortedCSCPage>();
 }
+
+TEST(SparsePageCompressedFormat, SparsePage) {
+  TestSparsePageRawFormat<SparsePage>("compressed");
+}
+
+TEST(SparsePageCompressedFormat, CSCPage) {
+  TestSparsePageRawFormat<CSCPage>("compressed");
+}
+
+TEST(SparsePageCompressedFormat, SortedCSCPage) {
+  TestSparsePageRawFormat<SortedCSCPage>("compressed");
+}
 }  // namespace data
 }  // namespace xgboost
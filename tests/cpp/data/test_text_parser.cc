@@ -0,0 +1,165 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include <gtest/gtest.h>
+#include <dmlc/filesystem.h>
+
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "../../../src/data/text_parser.h"
+
+namespace xgboost {
+namespace data {
+namespace {
+std::string WriteFile(dmlc::TemporaryDirectory const& tempdir, std::string const& name,
+                      std::string const& content) {
+  auto path = tempdir.path + "/" + name;
+  std::ofstream fout(path);
+  fout << content;
+  return path;
+}
+}  // anonymous namespace
+
+TEST(TextParser, LibSVM) {
+  dmlc::TemporaryDirectory tempdir;
+  auto path = WriteFile(tempdir, "test.libsvm",
+                        "1 0:1.5 3:2\n"
+                        "\n"
+                        "# comment line\n"
+                        "0:2 1 2:-3.25e1  # trailing comment\r\n");
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser{
+      TextParser::Create(path, 0, 1, "auto", 4)};
+  ASSERT_TRUE(parser);
+  ASSERT_TRUE(parser->Next());
+  auto const& block = parser->Value();
+  ASSERT_EQ(block.size, 2);
+  ASSERT_EQ(block.offset[0], 0);
+  ASSERT_EQ(block.offset[1], 2);
+  ASSERT_EQ(block.offset[2], 4);
+  ASSERT_EQ(block.label[0], 1.0f);
+  ASSERT_EQ(block.label[1], 0.0f);
+  ASSERT_TRUE(block.weight);
+  ASSERT_EQ(block.weight[0], 1.0f);
+  ASSERT_EQ(block.weight[1], 2.0f);
+  ASSERT_FALSE(block.qid);
+
+  uint32_t index[] = {0, 3, 1, 2};
+  float value[] = {1.5f, 2.0f, 1.0f, -32.5f};
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_EQ(block.index[i], index[i]);
+    ASSERT_EQ(block.value[i], value[i]);
+  }
+  ASSERT_FALSE(parser->Next());
+
+  // Data can be read again after reset.
+  parser->BeforeFirst();
+  ASSERT_TRUE(parser->Next());
+  ASSERT_EQ(parser->Value().size, 2);
+}
+
+TEST(TextParser, LibSVMIndexingMode) {
+  dmlc::TemporaryDirectory tempdir;
+  auto path = WriteFile(tempdir, "test.libsvm", "1 qid:3 1:1 4:2\n0 qid:4 2:1\n");
+  for (auto mode : {"1", "-1"}) {
+    std::unique_ptr<dmlc::Parser<uint32_t>> parser{TextParser::Create(
+        path + "?format=libsvm&indexing_mode=" + mode, 0, 1, "auto", 2)};
+    ASSERT_TRUE(parser);
+    ASSERT_TRUE(parser->Next());
+    auto const& block = parser->Value();
+    ASSERT_EQ(block.size, 2);
+    ASSERT_EQ(block.index[0], 0);
+    ASSERT_EQ(block.index[1], 3);
+    ASSERT_EQ(block.index[2], 1);
+    ASSERT_TRUE(block.qid);
+    ASSERT_EQ(block.qid[0], 3);
+    ASSERT_EQ(block.qid[1], 4);
+  }
+
+  auto zero_based = WriteFile(tempdir, "zero.libsvm", "1 0:1\n");
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser{
+      TextParser::Create(zero_based + "?indexing_mode=1", 0, 1, "libsvm", 2)};
+  ASSERT_TRUE(parser);
+  EXPECT_THROW(parser->Next(), dmlc::Error);
+}
+
+TEST(TextParser, CSV) {
+  dmlc::TemporaryDirectory tempdir;
+  auto path = WriteFile(tempdir, "test.csv",
+                        "1.0, 0.5, 3, 2\n"
+                        "2.0,,1.0000000001, 4 \n"
+                        "\n"
+                        "3.0,nan,+1,0.5\n");
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser{TextParser::Create(
+      path + "?format=csv&label_column=0&weight_column=3", 0, 1, "auto", 3)};
+  ASSERT_TRUE(parser);
+  ASSERT_TRUE(parser->Next());
+  auto const& block = parser->Value();
+  ASSERT_EQ(block.size, 3);
+  ASSERT_EQ(block.offset[1], 2);
+  ASSERT_EQ(block.offset[2], 3);
+  ASSERT_EQ(block.offset[3], 5);
+  for (size_t i = 0; i < block.size; ++i) {
+    ASSERT_EQ(block.label[i], static_cast<float>(i + 1));
+  }
+  ASSERT_EQ(block.weight[0], 2.0f);
+  ASSERT_EQ(block.weight[1], 4.0f);
+  ASSERT_EQ(block.weight[2], 0.5f);
+
+  ASSERT_EQ(block.index[0], 0);
+  ASSERT_EQ(block.value[0], 0.5f);
+  ASSERT_EQ(block.index[1], 1);
+  ASSERT_EQ(block.value[1], 3.0f);
+  // Missing value is skipped.
+  ASSERT_EQ(block.index[2], 1);
+  ASSERT_EQ(block.value[2], 1.0f);
+  ASSERT_TRUE(std::isnan(block.value[3]));
+  ASSERT_EQ(block.value[4], 1.0f);
+  ASSERT_FALSE(parser->Next());
+}
+
+TEST(TextParser, Partition) {
+  dmlc::TemporaryDirectory tempdir;
+  std::string content;
+  size_t constexpr kRows = 97;
+  for (size_t i = 0; i < kRows; ++i) {
+    content += std::to_string(i) + " " + std::to_string(i % 7) + ":" + std::to_string(i) +
+               "\n";
+  }
+  auto path = WriteFile(tempdir, "test.libsvm", content);
+  for (uint32_t n_parts : {1u, 3u, 8u}) {
+    size_t n_rows = 0;
+    for (uint32_t part = 0; part < n_parts; ++part) {
+      std::unique_ptr<dmlc::Parser<uint32_t>> parser{
+          TextParser::Create(path, part, n_parts, "libsvm", 4)};
+      ASSERT_TRUE(parser);
+      while (parser->Next()) {
+        auto const& block = parser->Value();
+        for (size_t i = 0; i < block.size; ++i) {
+          ASSERT_EQ(block.label[i], static_cast<float>(n_rows));
+          ASSERT_EQ(block.index[block.offset[i]], n_rows % 7);
+          ++n_rows;
+        }
+      }
+    }
+    ASSERT_EQ(n_rows, kRows);
+  }
+}
+
+TEST(TextParser, Unsupported) {
+  dmlc::TemporaryDirectory tempdir;
+  auto path = WriteFile(tempdir, "test.libsvm", "1 0:1\n");
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser{
+      TextParser::Create(path, 0, 1, "libfm", 1)};
+  ASSERT_FALSE(parser);
+  parser.reset(TextParser::Create(path + "?unknown=1", 0, 1, "auto", 1));
+  ASSERT_FALSE(parser);
+  parser.reset(TextParser::Create(tempdir.path, 0, 1, "auto", 1));
+  ASSERT_FALSE(parser);
+  parser.reset(TextParser::Create("s3://bucket/test.libsvm", 0, 1, "auto", 1));
+  ASSERT_FALSE(parser);
+}
+}  // namespace data
+}  // namespace xgboost
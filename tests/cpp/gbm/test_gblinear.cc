@@ -3,10 +3,16 @@
  */
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "../helpers.h"
+#include "../../../src/data/adapter.h"
+#include "../../../src/data/proxy_dmatrix.h"
 #include "xgboost/json.h"
 #include "xgboost/logging.h"
 #include "xgboost/gbm.h"
@@ -44,5 +50,70 @@ TEST(GBLinear, JsonIO) {
     ASSERT_EQ(weights.size(), 17);
   }
 }
+
+TEST(GBLinear, InplacePredict) {
+  bst_row_t constexpr kRows = 64;
+  bst_feature_t constexpr kCols = 8;
+  size_t constexpr kClasses = 3;
+  auto gen = RandomDataGenerator{kRows, kCols, 0.5}.Device(GenericParameter::kCpuId);
+  HostDeviceVector<float> data;
+  HostDeviceVector<bst_row_t> rptrs;
+  HostDeviceVector<bst_feature_t> columns;
+  gen.GenerateCSR(&data, &rptrs, &columns);
+  auto csr = std::make_shared<data::CSRAdapter>(rptrs.HostPointer(), columns.HostPointer(),
+                                                data.HostPointer(), kRows, data.Size(), kCols);
+  std::shared_ptr<DMatrix> p_fmat{
+      DMatrix::Create(csr.get(), std::numeric_limits<float>::quiet_NaN(), 1)};
+  auto &labels = p_fmat->Info().labels_.HostVector();
+  labels.resize(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    labels[i] = i % kClasses;
+  }
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_fmat})};
+  learner->SetParams(Args{{"booster", "gblinear"},
+                          {"objective", "multi:softprob"},
+                          {"num_class", std::to_string(kClasses)}});
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_fmat);
+  }
+  HostDeviceVector<float> expected;
+  learner->Predict(p_fmat, true, &expected, 0, 0);
+  ASSERT_EQ(expected.Size(), kRows * kClasses);
+
+  HostDeviceVector<float> *p_predt;
+  learner->InplacePredict(dmlc::any(csr), nullptr, PredictionType::kMargin,
+                          std::numeric_limits<float>::quiet_NaN(), &p_predt, 0, 0);
+  ASSERT_EQ(p_predt->HostVector(), expected.HostVector());
+
+  std::vector<float> dense(kRows * kCols, std::numeric_limits<float>::quiet_NaN());
+  auto const &h_rptrs = rptrs.ConstHostVector();
+  for (size_t i = 0; i < kRows; ++i) {
+    for (auto j = h_rptrs[i]; j < h_rptrs[i + 1]; ++j) {
+      dense[i * kCols + columns.HostVector()[j]] = data.HostVector()[j];
+    }
+  }
+  auto x = std::make_shared<data::DenseAdapter>(dense.data(), kRows, kCols);
+  learner->InplacePredict(dmlc::any(x), nullptr, PredictionType::kMargin,
+                          std::numeric_limits<float>::quiet_NaN(), &p_predt, 0, 0);
+  ASSERT_EQ(p_predt->HostVector(), expected.HostVector());
+
+  // Base margin replaces the base score.
+  std::shared_ptr<DMatrix> p_margin{new data::DMatrixProxy};
+  auto &base_margin = p_margin->Info().base_margin_;
+  base_margin.Reshape(kRows, kClasses);
+  auto &h_margin = base_margin.Data()->HostVector();
+  auto predict_with_margin = [&](float margin) {
+    std::fill(h_margin.begin(), h_margin.end(), margin);
+    learner->InplacePredict(dmlc::any(x), p_margin, PredictionType::kMargin,
+                            std::numeric_limits<float>::quiet_NaN(), &p_predt, 0, 0);
+    return p_predt->HostVector();
+  };
+  auto zero = predict_with_margin(0.0f);
+  auto one = predict_with_margin(1.0f);
+  for (size_t i = 0; i < zero.size(); ++i) {
+    ASSERT_NEAR(one[i] - zero[i], 1.0f, 1e-5);
+  }
+}
 }  // namespace gbm
 }  // namespace xgboost
@@ -5,6 +5,8 @@
 #include <dmlc/filesystem.h>
 #include <xgboost/generic_parameters.h>
 
+#include <numeric>
+
 #include "xgboost/base.h"
 #include "xgboost/host_device_vector.h"
 #include "xgboost/learner.h"
@@ -294,6 +296,41 @@ TEST(Dart, Prediction) {
   }
 }
 
+TEST(Dart, PredictionCache) {
+  size_t constexpr kRows = 128, kCols = 10;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0}.Seed(1).GenerateDMatrix(true);
+  auto p_valid = RandomDataGenerator{kRows, kCols, 0}.Seed(2).GenerateDMatrix(true);
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_train, p_valid})};
+  learner->SetParams(Args{{"booster", "dart"},
+                          {"rate_drop", "0.3"},
+                          {"tree_method", "hist"},
+                          {"max_depth", "3"}});
+  for (size_t i = 0; i < 32; ++i) {
+    learner->UpdateOneIter(i, p_train);
+    // Cache of validation data is brought up to date incrementally.
+    learner->EvalOneIter(i, {p_valid}, {"valid"});
+  }
+
+  // A loaded model has no cache, all trees are predicted with their current weights.
+  Json model{Object()};
+  learner->SaveModel(&model);
+  std::unique_ptr<Learner> loaded{Learner::Create({})};
+  loaded->LoadModel(model);
+
+  for (auto p_fmat : {p_train, p_valid}) {
+    HostDeviceVector<float> cached, expected;
+    learner->Predict(p_fmat, true, &cached, 0, 0);
+    loaded->Predict(p_fmat, true, &expected, 0, 0);
+    auto const& h_cached = cached.ConstHostVector();
+    auto const& h_expected = expected.ConstHostVector();
+    ASSERT_EQ(h_cached.size(), h_expected.size());
+    for (size_t i = 0; i < h_cached.size(); ++i) {
+      ASSERT_NEAR(h_cached[i], h_expected[i], 1e-4);
+    }
+  }
+}
+
 std::pair<Json, Json> TestModelSlice(std::string booster) {
   size_t constexpr kRows = 1000, kCols = 100, kForest = 2, kClasses = 3;
   auto m = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix(true, false, kClasses);
@@ -349,9 +386,10 @@ std::pair<Json, Json> TestModelSlice(std::string booster) {
 
   auto get_info = [&](Json const& model) {
     if (booster == "gbtree") {
-      return get<Array const>(model["learner"]["gradient_booster"]["model"]["tree_info"]);
+      return get<I32Array const>(model["learner"]["gradient_booster"]["model"]["tree_info"]);
     } else {
-      return get<Array const>(model["learner"]["gradient_booster"]["gbtree"]["model"]["tree_info"]);
+      return get<I32Array const>(
+          model["learner"]["gradient_booster"]["gbtree"]["model"]["tree_info"]);
     }
   };
 
@@ -365,7 +403,7 @@ std::pair<Json, Json> TestModelSlice(std::string booster) {
     for (size_t j = 0; j < kClasses; ++j) {
       for (size_t k = 0; k < kForest; ++k) {
         auto idx = layer * kLayerSize + j * kForest + k;
-        auto const &group = get<Integer const>(sliced_info.at(idx));
+        auto const &group = sliced_info.at(idx);
         CHECK_EQ(static_cast<size_t>(group), j);
       }
     }
@@ -416,6 +454,53 @@ TEST(Dart, Slice) {
   ASSERT_EQ(weights.size(), trees.size());
 }
 
+TEST(GBTree, SliceSharedTrees) {
+  size_t constexpr kRows = 256, kCols = 10;
+  int32_t constexpr kIters = 4;
+  auto m = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({m})};
+  learner->SetParams(Args{{"tree_method", "hist"}, {"max_depth", "2"}});
+  for (int32_t i = 0; i < kIters; ++i) {
+    learner->UpdateOneIter(i, m);
+  }
+
+  bool out_of_bound = false;
+  std::unique_ptr<Learner> sliced{learner->Slice(0, 2, 1, &out_of_bound)};
+  ASSERT_FALSE(out_of_bound);
+  HostDeviceVector<float> expected;
+  sliced->Predict(m, true, &expected, 0, 0);
+
+  // Refreshing leaves of the original model must not change the trees shared with slice.
+  auto& h_labels = m->Info().labels_.HostVector();
+  for (auto& v : h_labels) {
+    v = v * 4.0f + 1.0f;
+  }
+  learner->SetParams(Args{{"process_type", "update"},
+                          {"updater", "refresh"},
+                          {"refresh_leaf", "1"}});
+  for (int32_t i = 0; i < kIters; ++i) {
+    learner->UpdateOneIter(i, m);
+  }
+  HostDeviceVector<float> refreshed;
+  learner->Predict(m, true, &refreshed, 0, 2);
+  HostDeviceVector<float> got;
+  sliced->Predict(m, true, &got, 0, 0);
+  ASSERT_EQ(got.Size(), expected.Size());
+  bool changed = false;
+  for (size_t i = 0; i < got.Size(); ++i) {
+    ASSERT_NEAR(got.HostVector()[i], expected.HostVector()[i], kRtEps);
+    changed |= std::abs(refreshed.HostVector()[i] - expected.HostVector()[i]) > kRtEps;
+  }
+  ASSERT_TRUE(changed);
+
+  // Slice keeps the shared trees alive.
+  learner.reset();
+  sliced->Predict(m, true, &got, 0, 0);
+  for (size_t i = 0; i < got.Size(); ++i) {
+    ASSERT_NEAR(got.HostVector()[i], expected.HostVector()[i], kRtEps);
+  }
+}
+
 TEST(GBTree, FeatureScore) {
   size_t n_samples = 1000, n_features = 10, n_classes = 4;
   auto m = RandomDataGenerator{n_samples, n_features, 0.5}.GenerateDMatrix(true, false, n_classes);
@@ -453,6 +538,37 @@ TEST(GBTree, FeatureScore) {
   test_eq("cover");
 }
 
+TEST(GBTree, FeatureScoreCache) {
+  size_t n_samples = 256, n_features = 10;
+  auto m = RandomDataGenerator{n_samples, n_features, 0.5}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({m})};
+  learner->Configure();
+
+  auto n_splits = [&](std::vector<int32_t> const& trees) {
+    std::vector<bst_feature_t> features;
+    std::vector<float> scores;
+    learner->CalcFeatureScore("weight", trees, &features, &scores);
+    return std::accumulate(scores.cbegin(), scores.cend(), 0.0f);
+  };
+
+  std::vector<int32_t> trees;
+  for (int32_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, m);
+    trees.push_back(i);
+    // Totals are extended with new trees, and agree with summing up selected trees.
+    auto total = n_splits({});
+    ASSERT_EQ(total, n_splits(trees));
+    ASSERT_GT(total, 0);
+
+    std::vector<bst_feature_t> features, features_subset;
+    std::vector<float> scores, scores_subset;
+    learner->CalcFeatureScore("total_gain", {}, &features, &scores);
+    learner->CalcFeatureScore("total_gain", trees, &features_subset, &scores_subset);
+    ASSERT_EQ(features, features_subset);
+    ASSERT_EQ(scores, scores_subset);
+  }
+}
+
 TEST(GBTree, PredictRange) {
   size_t n_samples = 1000, n_features = 10, n_classes = 4;
   auto m = RandomDataGenerator{n_samples, n_features, 0.5}.GenerateDMatrix(true, false, n_classes);
@@ -495,4 +611,84 @@ TEST(GBTree, PredictRange) {
                  dmlc::Error);
   }
 }
+
+TEST(GBTree, MultiOutputTree) {
+  size_t constexpr kRows = 500, kCols = 8, kClasses = 3;
+  int32_t constexpr kIters = 3;
+  auto m = RandomDataGenerator{kRows, kCols, 0.3}.GenerateDMatrix(true, false, kClasses);
+
+  std::unique_ptr<Learner> learner{Learner::Create({m})};
+  learner->SetParams(Args{{"tree_method", "hist"},
+                          {"num_class", std::to_string(kClasses)},
+                          {"multi_strategy", "multi_output_tree"}});
+  for (int32_t i = 0; i < kIters; ++i) {
+    learner->UpdateOneIter(i, m);
+  }
+  ASSERT_EQ(learner->BoostedRounds(), kIters);
+
+  Json model{Object()};
+  learner->SaveModel(&model);
+  auto const& j_trees = get<Array const>(model["learner"]["gradient_booster"]["model"]["trees"]);
+  // One tree for all classes in each iteration.
+  ASSERT_EQ(j_trees.size(), static_cast<size_t>(kIters));
+
+  HostDeviceVector<float> predt;
+  learner->Predict(m, true, &predt, 0, 0);
+  ASSERT_EQ(predt.Size(), kRows * kClasses);
+  auto const& h_predt = predt.ConstHostVector();
+  // Trees are not constant over classes.
+  ASSERT_NE(h_predt[0], h_predt[1]);
+
+  std::unique_ptr<Learner> loaded{Learner::Create({m})};
+  loaded->LoadModel(model);
+  HostDeviceVector<float> loaded_predt;
+  loaded->Predict(m, true, &loaded_predt, 0, 0);
+  auto const& h_loaded = loaded_predt.ConstHostVector();
+  for (size_t i = 0; i < h_predt.size(); ++i) {
+    ASSERT_NEAR(h_loaded[i], h_predt[i], kRtEps);
+  }
+
+  // The first layer has the same prediction as a model with a single round.
+  HostDeviceVector<float> first_layer;
+  learner->Predict(m, true, &first_layer, 0, 1);
+  bool out_of_bound = false;
+  std::unique_ptr<Learner> sliced{learner->Slice(0, 1, 1, &out_of_bound)};
+  ASSERT_FALSE(out_of_bound);
+  HostDeviceVector<float> sliced_predt;
+  sliced->Predict(m, true, &sliced_predt, 0, 0);
+  for (size_t i = 0; i < first_layer.Size(); ++i) {
+    ASSERT_NEAR(first_layer.HostVector()[i], sliced_predt.HostVector()[i], kRtEps);
+  }
+
+  // The prediction cache is updated by the updater only when all rows are used, otherwise
+  // the new tree is predicted by the predictor.
+  for (auto subsample : {"1.0", "0.5"}) {
+    std::unique_ptr<Learner> cached{Learner::Create({m})};
+    cached->SetParams(Args{{"tree_method", "hist"},
+                           {"num_class", std::to_string(kClasses)},
+                           {"subsample", subsample},
+                           {"multi_strategy", "multi_output_tree"}});
+    for (int32_t i = 0; i < kIters; ++i) {
+      cached->UpdateOneIter(i, m);
+    }
+    HostDeviceVector<float> cached_predt;
+    cached->Predict(m, true, &cached_predt, 0, 0);
+    Json cached_model{Object()};
+    cached->SaveModel(&cached_model);
+    std::unique_ptr<Learner> fresh{Learner::Create({m})};
+    fresh->LoadModel(cached_model);
+    HostDeviceVector<float> fresh_predt;
+    fresh->Predict(m, true, &fresh_predt, 0, 0);
+    ASSERT_EQ(cached_predt.Size(), fresh_predt.Size());
+    for (size_t i = 0; i < cached_predt.Size(); ++i) {
+      ASSERT_NEAR(cached_predt.HostVector()[i], fresh_predt.HostVector()[i], kRtEps);
+    }
+  }
+
+  std::unique_ptr<Learner> approx{Learner::Create({m})};
+  approx->SetParams(Args{{"tree_method", "approx"},
+                         {"num_class", std::to_string(kClasses)},
+                         {"multi_strategy", "multi_output_tree"}});
+  ASSERT_THROW(approx->UpdateOneIter(0, m), dmlc::Error);
+}
 }  // namespace xgboost
@@ -309,6 +309,29 @@ GenerateRandomCategoricalSingleColumn(int n, size_t num_categories) {
   return x;
 }
 
+/**
+ * \brief Generate dense row major data with `n_groups` one-hot encoded categorical
+ *        variables of `n_levels` columns each, followed by `n_dense` uniform columns.
+ */
+inline std::vector<float> GenerateOneHotColumns(size_t n_rows, size_t n_groups,
+                                                size_t n_levels, size_t n_dense) {
+  size_t n_cols = n_groups * n_levels + n_dense;
+  std::vector<float> x(n_rows * n_cols, 0.0f);
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<size_t> level(0, n_levels - 1);
+  std::uniform_real_distribution<float> value(0.0f, 1.0f);
+  for (size_t i = 0; i < n_rows; ++i) {
+    auto row = x.begin() + i * n_cols;
+    for (size_t g = 0; g < n_groups; ++g) {
+      row[g * n_levels + level(rng)] = 1.0f;
+    }
+    for (size_t j = n_groups * n_levels; j < n_cols; ++j) {
+      row[j] = value(rng);
+    }
+  }
+  return x;
+}
+
 std::shared_ptr<DMatrix> GetDMatrixFromData(const std::vector<float> &x,
                                             int num_rows, int num_columns);
 
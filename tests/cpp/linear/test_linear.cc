@@ -7,6 +7,7 @@
 #include "../helpers.h"
 #include "test_json_io.h"
 #include "../../../src/gbm/gblinear_model.h"
+#include "../../../src/linear/coordinate_common.h"
 #include "xgboost/base.h"
 
 namespace xgboost {
@@ -43,6 +44,41 @@ TEST(Linear, Shotgun) {
   }
 }
 
+TEST(Linear, ShotgunDeterministic) {
+  size_t constexpr kRows = 64;
+  size_t constexpr kCols = 32;
+
+  auto p_fmat = xgboost::RandomDataGenerator(kRows, kCols, 0.3).GenerateDMatrix();
+  LearnerModelParam mparam;
+  mparam.num_feature = kCols;
+  mparam.num_output_group = 1;
+  mparam.base_score = 0.5;
+
+  auto train = [&](int32_t n_threads) {
+    auto lparam = xgboost::CreateEmptyGenericParam(GPUIDX);
+    lparam.nthread = n_threads;
+    auto updater = std::unique_ptr<xgboost::LinearUpdater>(
+        xgboost::LinearUpdater::Create("shotgun", &lparam));
+    updater->Configure({{"eta", "0.5"}, {"deterministic", "1"}});
+    auto gpair = GenerateRandomGradients(kRows);
+    xgboost::gbm::GBLinearModel model{&mparam};
+    model.LazyInitModel();
+    for (size_t i = 0; i < 3; ++i) {
+      updater->Update(&gpair, p_fmat.get(), &model, gpair.Size());
+    }
+    return model.weight;
+  };
+
+  auto expected = train(1);
+  ASSERT_EQ(train(1), expected);
+  auto got = train(4);
+  ASSERT_EQ(expected.size(), got.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    // Shards differ between thread counts, which only changes the summation order.
+    ASSERT_NEAR(expected[i], got[i], 1e-5);
+  }
+}
+
 TEST(Shotgun, JsonIO) {
   TestUpdaterJsonIO("shotgun");
 }
@@ -71,6 +107,81 @@ TEST(Linear, coordinate) {
   ASSERT_EQ(model.Bias()[0], 5.0f);
 }
 
+TEST(Linear, CoordinateBlock) {
+  size_t constexpr kRows = 64;
+  size_t constexpr kCols = 10;
+
+  auto p_fmat = xgboost::RandomDataGenerator(kRows, kCols, 0.3).GenerateDMatrix();
+
+  auto lparam = xgboost::CreateEmptyGenericParam(GPUIDX);
+  LearnerModelParam mparam;
+  mparam.num_feature = kCols;
+  mparam.num_output_group = 1;
+  mparam.base_score = 0.5;
+
+  auto train = [&](std::string block_size) {
+    auto updater = std::unique_ptr<xgboost::LinearUpdater>(
+        xgboost::LinearUpdater::Create("coord_descent", &lparam));
+    updater->Configure({{"eta", "0.5"}, {"lambda", "0.1"}, {"block_size", block_size}});
+    auto gpair = GenerateRandomGradients(kRows);
+    xgboost::gbm::GBLinearModel model{&mparam};
+    model.LazyInitModel();
+    for (size_t i = 0; i < 3; ++i) {
+      updater->Update(&gpair, p_fmat.get(), &model, gpair.Size());
+    }
+    return model.weight;
+  };
+
+  auto expected = train("1");
+  auto got = train("4");
+  ASSERT_EQ(expected.size(), got.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR(expected[i], got[i], 1e-5);
+  }
+}
+
+TEST(Linear, GreedySelector) {
+  size_t constexpr kRows = 64;
+  size_t constexpr kCols = 16;
+
+  auto p_fmat = xgboost::RandomDataGenerator(kRows, kCols, 0.5).GenerateDMatrix();
+  LearnerModelParam mparam;
+  mparam.num_feature = kCols;
+  mparam.num_output_group = 1;
+  mparam.base_score = 0.5;
+  xgboost::gbm::GBLinearModel model{&mparam};
+  model.LazyInitModel();
+
+  auto gpair = GenerateRandomGradients(kRows).HostVector();
+  float constexpr kAlpha = 0.1, kLambda = 1.0;
+  linear::GreedyFeatureSelector selector;
+  selector.Setup(model, gpair, p_fmat.get(), kAlpha, kLambda, 0);
+  for (size_t i = 0; i < kCols - 1; ++i) {
+    // brute force
+    int expected = 0;
+    float best = 0;
+    for (bst_feature_t f = 0; f < kCols; ++f) {
+      auto grad = linear::GetGradient(0, 1, f, gpair, p_fmat.get());
+      float dw = std::abs(static_cast<float>(
+          linear::CoordinateDelta(grad.first, grad.second, model[f][0], kAlpha, kLambda)));
+      if (dw > best) {
+        best = dw;
+        expected = f;
+      }
+    }
+    int fidx = selector.NextFeature(i, model, 0, gpair, p_fmat.get(), kAlpha, kLambda);
+    ASSERT_EQ(fidx, expected);
+
+    auto grad = linear::GetGradient(0, 1, fidx, gpair, p_fmat.get());
+    auto dw = static_cast<float>(
+        0.5 * linear::CoordinateDelta(grad.first, grad.second, model[fidx][0], kAlpha, kLambda));
+    model[fidx][0] += dw;
+    linear::UpdateResidualParallel(fidx, 0, 1, dw, &gpair, p_fmat.get());
+  }
+  ASSERT_EQ(selector.NextFeature(kCols - 1, model, 0, gpair, p_fmat.get(), kAlpha, kLambda),
+            -1);
+}
+
 TEST(Coordinate, JsonIO){
   TestUpdaterJsonIO("coord_descent");
 }
@@ -1,4 +1,7 @@
 #include <xgboost/metric.h>
+
+#include <memory>
+
 #include "../helpers.h"
 
 namespace xgboost {
@@ -256,5 +259,48 @@ TEST(Metric, DeclareUnifiedTest(RankingPRAUC)) {
                   {0, 2, 5, 9, 14, 20}),  // group info
               0.556021f, 0.001f);
 }
+
+TEST(Metric, DeclareUnifiedTest(ApproxAUC)) {
+  auto tparam = xgboost::CreateEmptyGenericParam(GPUIDX);
+  size_t constexpr kRows = 4096;
+  HostDeviceVector<float> predts(kRows);
+  MetaInfo info;
+  info.num_row_ = kRows;
+  auto& h_labels = info.labels_.HostVector();
+  auto& h_predts = predts.HostVector();
+  h_labels.resize(kRows);
+  SimpleLCG lcg;
+  SimpleRealUniformDistribution<float> dist{0.0f, 1.0f};
+  for (size_t i = 0; i < kRows; ++i) {
+    h_labels[i] = dist(&lcg) > 0.5f;
+    // informative but noisy prediction.
+    h_predts[i] = h_labels[i] * 0.3f + dist(&lcg);
+  }
+
+  for (auto name : {"auc", "aucpr"}) {
+    std::unique_ptr<Metric> exact{Metric::Create(name, &tparam)};
+    std::unique_ptr<Metric> approx{Metric::Create(name, &tparam)};
+    approx->Configure({{"auc_approx_bins", "65536"}});
+    std::unique_ptr<Metric> warm{Metric::Create(name, &tparam)};
+    warm->Configure({{"auc_warm_start", "1"}});
+
+    auto expected = exact->Eval(predts, info, false);
+    ASSERT_NEAR(approx->Eval(predts, info, false), expected, 1e-3) << name;
+    ASSERT_NEAR(warm->Eval(predts, info, false), expected, 1e-10) << name;
+    // Perturb the prediction like a boosting round, then sort with the previous order.
+    for (size_t i = 0; i < kRows; ++i) {
+      h_predts[i] += (dist(&lcg) - 0.5f) * 0.01f;
+    }
+    expected = exact->Eval(predts, info, false);
+    ASSERT_NEAR(warm->Eval(predts, info, false), expected, 1e-10) << name;
+  }
+
+  // A single bin treats all samples as ties.
+  std::unique_ptr<Metric> coarse{Metric::Create("auc", &tparam)};
+  coarse->Configure({{"auc_approx_bins", "1"}});
+  if (GPUIDX < 0) {
+    ASSERT_NEAR(coarse->Eval(predts, info, false), 0.5, 1e-10);
+  }
+}
 }  // namespace metric
 }  // namespace xgboost
@@ -6,8 +6,10 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "../helpers.h"
+#include "../../../src/common/math.h"
 
 namespace xgboost {
 namespace {
@@ -276,3 +278,85 @@ TEST(Metric, DeclareUnifiedTest(PoissionNegLogLik)) {
 
   xgboost::CheckDeterministicMetricElementWise(xgboost::StringView{"mphe"}, GPUIDX);
 }
+
+TEST(Metric, DeclareUnifiedTest(FusedEvaluation)) {
+  auto lparam = xgboost::CreateEmptyGenericParam(GPUIDX);
+  std::vector<std::unique_ptr<xgboost::Metric>> metrics;
+  // More element-wise metrics than a single device kernel can handle, mixed with auc.
+  for (auto name : {"rmse", "rmsle", "mae", "auc", "mphe", "logloss", "error", "error@0.7",
+                    "poisson-nloglik", "gamma-deviance", "gamma-nloglik",
+                    "tweedie-nloglik@1.2"}) {
+    metrics.emplace_back(xgboost::Metric::Create(name, &lparam));
+    metrics.back()->Configure({});
+  }
+
+  size_t constexpr kRows = 1024;
+  xgboost::HostDeviceVector<float> predts(kRows);
+  xgboost::MetaInfo info;
+  info.num_row_ = kRows;
+  auto& h_labels = info.labels_.HostVector();
+  auto& h_weights = info.weights_.HostVector();
+  auto& h_predts = predts.HostVector();
+  h_labels.resize(kRows);
+  h_weights.resize(kRows);
+  xgboost::SimpleLCG lcg;
+  xgboost::SimpleRealUniformDistribution<float> dist{0.01f, 0.99f};
+  for (size_t i = 0; i < kRows; ++i) {
+    h_predts[i] = dist(&lcg);
+    h_labels[i] = i % 2;
+    h_weights[i] = dist(&lcg);
+  }
+
+  std::vector<double> fused;
+  xgboost::Metric::EvalMany(metrics, predts, info, false, &fused);
+  ASSERT_EQ(fused.size(), metrics.size());
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    auto expected = metrics[i]->Eval(predts, info, false);
+    EXPECT_NEAR(fused[i], expected, std::abs(expected) * 1e-6) << metrics[i]->Name();
+  }
+}
+
+TEST(Metric, DeclareUnifiedTest(LazyTransform)) {
+  auto lparam = xgboost::CreateEmptyGenericParam(GPUIDX);
+  size_t constexpr kRows = 512;
+  xgboost::HostDeviceVector<float> margin(kRows);
+  xgboost::MetaInfo info;
+  info.num_row_ = kRows;
+  auto& h_labels = info.labels_.HostVector();
+  auto& h_margin = margin.HostVector();
+  h_labels.resize(kRows);
+  xgboost::SimpleLCG lcg;
+  xgboost::SimpleRealUniformDistribution<float> dist{-3.0f, 3.0f};
+  for (size_t i = 0; i < kRows; ++i) {
+    h_margin[i] = dist(&lcg);
+    h_labels[i] = i % 2;
+  }
+
+  auto check = [&](std::vector<char const*> names, xgboost::PredTransformKind kind,
+                   float (*fn)(float)) {
+    std::vector<std::unique_ptr<xgboost::Metric>> metrics;
+    for (auto name : names) {
+      metrics.emplace_back(xgboost::Metric::Create(name, &lparam));
+      metrics.back()->Configure({});
+    }
+    xgboost::HostDeviceVector<float> transformed(kRows);
+    auto& h_transformed = transformed.HostVector();
+    for (size_t i = 0; i < kRows; ++i) {
+      h_transformed[i] = fn(h_margin[i]);
+    }
+    std::vector<double> lazy, expected;
+    xgboost::Metric::EvalMany(metrics, margin, info, false, &lazy, kind);
+    xgboost::Metric::EvalMany(metrics, transformed, info, false, &expected);
+    ASSERT_EQ(lazy.size(), expected.size());
+    for (size_t i = 0; i < lazy.size(); ++i) {
+      EXPECT_NEAR(lazy[i], expected[i], std::abs(expected[i]) * 1e-6) << names[i];
+    }
+  };
+  auto sigmoid = [](float x) { return xgboost::common::Sigmoid(x); };
+  auto exponential = [](float x) { return expf(x); };
+  check({"logloss"}, xgboost::PredTransformKind::kSigmoid, sigmoid);
+  check({"logloss", "error"}, xgboost::PredTransformKind::kSigmoid, sigmoid);
+  // auc requires the transformed prediction.
+  check({"logloss", "auc"}, xgboost::PredTransformKind::kSigmoid, sigmoid);
+  check({"poisson-nloglik", "rmse"}, xgboost::PredTransformKind::kExp, exponential);
+}
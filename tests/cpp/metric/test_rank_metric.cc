@@ -1,4 +1,8 @@
 // Copyright by Contributors
+#include <cmath>
+#include <memory>
+#include <vector>
+
 #include <xgboost/metric.h>
 
 #include "../helpers.h"
@@ -154,3 +158,45 @@ TEST(Metric, DeclareUnifiedTest(MAP)) {
               0.25f, 0.001f);
   delete metric;
 }
+
+#if !defined(__CUDACC__)
+TEST(Metric, RankSharedSort) {
+  auto lparam = xgboost::CreateEmptyGenericParam(GPUIDX);
+  std::vector<std::unique_ptr<xgboost::Metric>> metrics;
+  for (auto name : {"ndcg", "ndcg@3", "map@2", "map-", "pre@5", "ndcg@10-", "rmse"}) {
+    metrics.emplace_back(xgboost::Metric::Create(name, &lparam));
+    metrics.back()->Configure({});
+  }
+
+  // Skewed group sizes, with tied predictions to exercise the tie breaking.
+  xgboost::MetaInfo info;
+  info.group_ptr_ = {0};
+  for (size_t size : {1, 2, 200, 3, 17, 1, 64, 5}) {
+    info.group_ptr_.push_back(info.group_ptr_.back() + size);
+  }
+  size_t n_rows = info.group_ptr_.back();
+  info.num_row_ = n_rows;
+  xgboost::HostDeviceVector<float> predts(n_rows);
+  auto& h_labels = info.labels_.HostVector();
+  auto& h_predts = predts.HostVector();
+  h_labels.resize(n_rows);
+  xgboost::SimpleLCG lcg;
+  xgboost::SimpleRealUniformDistribution<float> dist{0.0f, 4.0f};
+  for (size_t i = 0; i < n_rows; ++i) {
+    h_predts[i] = std::round(dist(&lcg) * 2.0f);
+    h_labels[i] = std::floor(dist(&lcg));
+  }
+
+  std::vector<double> shared;
+  xgboost::Metric::EvalMany(metrics, predts, info, false, &shared);
+  ASSERT_EQ(shared.size(), metrics.size());
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    auto expected = metrics[i]->Eval(predts, info, false);
+    EXPECT_NEAR(shared[i], expected, 1e-10) << metrics[i]->Name();
+  }
+
+  // Relevant documents below the cut-off count towards the normalization of map@k.
+  std::unique_ptr<xgboost::Metric> map{xgboost::Metric::Create("map@1", &lparam)};
+  EXPECT_NEAR(GetMetricEval(map.get(), {0.9f, 0.1f, 0.5f}, {1, 1, 0}), 0.5, 1e-10);
+}
+#endif
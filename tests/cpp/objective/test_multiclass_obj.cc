@@ -1,6 +1,9 @@
 /*!
  * Copyright 2018-2019 XGBoost contributors
  */
+#include <algorithm>
+#include <cmath>
+
 #include <xgboost/objective.h>
 #include <xgboost/generic_parameters.h>
 #include "../../src/common/common.h"
@@ -77,4 +80,48 @@ TEST(Objective, DeclareUnifiedTest(SoftprobMultiClassBasic)) {
     EXPECT_NEAR(preds[i], out_preds[i], 0.01f);
   }
 }
+
+TEST(Objective, DeclareUnifiedTest(SoftmaxMultiClassManyClasses)) {
+  GenericParameter lparam = CreateEmptyGenericParam(GPUIDX);
+  size_t constexpr kClasses = 203, kRows = 517;
+  std::unique_ptr<ObjFunction> obj {ObjFunction::Create("multi:softprob", &lparam)};
+  obj->Configure({{"num_class", std::to_string(kClasses)}});
+
+  HostDeviceVector<bst_float> preds(kRows * kClasses);
+  MetaInfo info;
+  info.num_row_ = kRows;
+  auto& h_preds = preds.HostVector();
+  auto& h_labels = info.labels_.HostVector();
+  auto& h_weights = info.weights_.HostVector();
+  SimpleLCG lcg;
+  SimpleRealUniformDistribution<float> dist{-20.0f, 20.0f};
+  for (auto& v : h_preds) {
+    v = dist(&lcg);
+  }
+  for (size_t i = 0; i < kRows; ++i) {
+    h_labels.push_back(i % kClasses);
+    h_weights.push_back(0.5f + (i % 3));
+  }
+
+  HostDeviceVector<GradientPair> gpair;
+  obj->GetGradient(preds, info, 0, &gpair);
+  auto const& h_gpair = gpair.ConstHostVector();
+  ASSERT_EQ(h_gpair.size(), kRows * kClasses);
+  for (size_t i = 0; i < kRows; ++i) {
+    auto const* point = h_preds.data() + i * kClasses;
+    double wmax = *std::max_element(point, point + kClasses);
+    double wsum = 0;
+    for (size_t k = 0; k < kClasses; ++k) {
+      wsum += std::exp(point[k] - wmax);
+    }
+    for (size_t k = 0; k < kClasses; ++k) {
+      double p = std::exp(point[k] - wmax) / wsum;
+      double wt = h_weights[i];
+      double g = (k == h_labels[i] ? p - 1.0 : p) * wt;
+      double h = std::max(2.0 * p * (1.0 - p) * wt, 1e-16);
+      ASSERT_NEAR(h_gpair[i * kClasses + k].GetGrad(), g, 1e-5);
+      ASSERT_NEAR(h_gpair[i * kClasses + k].GetHess(), h, 1e-5);
+    }
+  }
+}
 }  // namespace xgboost
@@ -134,4 +134,38 @@ TEST(Objective, DeclareUnifiedTest(MAPRankingGPair)) {
   ASSERT_NO_THROW(obj->DefaultEvalMetric());
 }
 
+
+TEST(Objective, DeclareUnifiedTest(TopKPairRankingGPair)) {
+  xgboost::GenericParameter lparam = xgboost::CreateEmptyGenericParam(GPUIDX);
+
+  std::unique_ptr<xgboost::ObjFunction> obj {
+    xgboost::ObjFunction::Create("rank:pairwise", &lparam)
+  };
+  obj->Configure({{"lambdarank_pair_method", "topk"}, {"num_pairsample", "1"}});
+  CheckConfigReload(obj, "rank:pairwise");
+
+  // Only the top document (row 1) is paired, with both documents of a different label.
+  CheckRankingObjFunction(obj,
+                          {0, 0.1f, 0, 0.1f},
+                          {0,   1, 0, 1},
+                          {1.0f},
+                          {0, 4},
+                          {0.475f, -0.95f, 0.475f, 0.0f},
+                          {0.4988f, 0.9975f, 0.4988f, 0.0f});
+
+  // Covers the whole group, each pair with different labels is used once.
+  obj->Configure({{"lambdarank_pair_method", "topk"}, {"num_pairsample", "16"}});
+  CheckRankingObjFunction(obj,
+                          {0, 0.1f, 0, 0.1f},
+                          {0,   1, 0, 1},
+                          {1.0f},
+                          {0, 4},
+                          {0.95f, -0.95f, 0.95f, -0.95f},
+                          {0.9975f, 0.9975f, 0.9975f, 0.9975f});
+
+  Json j_obj {Object()};
+  obj->SaveConfig(&j_obj);
+  ASSERT_EQ(get<String>(j_obj["lambda_rank_param"]["lambdarank_pair_method"]), "topk");
+}
+
 }  // namespace xgboost
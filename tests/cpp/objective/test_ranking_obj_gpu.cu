@@ -89,6 +89,39 @@ TEST(Objective, RankSegmentSorterAscendingTest) {
                                                      5, 4, 6});
 }
 
+TEST(Objective, RankSegmentSorterSegmentedTest) {
+  std::vector<uint32_t> groups{0, 4, 7, 12};
+  std::vector<float> hpreds{-9.78f, 24.367f, 0.908f, -11.47f,
+                            -1.03f, -2.79f, -3.1f,
+                            104.22f, 103.1f, -101.7f, 100.5f, 45.1f};
+  auto expected = RankSegmentSorterTestImpl<float>(
+    groups, hpreds,
+    {24.367f, 0.908f, -9.78f, -11.47f,   // Expected sorted predictions
+     -1.03f, -2.79f, -3.1f,
+     104.22f, 103.1f, 100.5f, 45.1f, -101.7f},
+    {1, 2, 0, 3,                         // Expected original positions
+     4, 5, 6,
+     7, 8, 10, 11, 9});
+
+  dh::SegmentSorter<float> sorter;
+  dh::device_vector<float> dpreds(hpreds);
+  // The second sort reuses the buffers of the first one.
+  for (size_t i = 0; i < 2; ++i) {
+    sorter.SortItemsSegmented(dpreds.data().get(), dpreds.size(), expected->GetGroupsSpan());
+    ASSERT_EQ(sorter.GetNumGroups(), groups.size() - 1);
+    std::vector<float> sorted(dpreds.size());
+    dh::CopyDeviceSpanToVector(&sorted, sorter.GetItemsSpan());
+    std::vector<float> expected_sorted(dpreds.size());
+    dh::CopyDeviceSpanToVector(&expected_sorted, expected->GetItemsSpan());
+    EXPECT_EQ(sorted, expected_sorted);
+    std::vector<uint32_t> pos(dpreds.size());
+    dh::CopyDeviceSpanToVector(&pos, sorter.GetOriginalPositionsSpan());
+    std::vector<uint32_t> expected_pos(dpreds.size());
+    dh::CopyDeviceSpanToVector(&expected_pos, expected->GetOriginalPositionsSpan());
+    EXPECT_EQ(pos, expected_pos);
+  }
+}
+
 using CountFunctor = uint32_t (*)(const int *, uint32_t, int);
 void RankItemCountImpl(const std::vector<int> &sorted_items, CountFunctor f,
                        int find_val, uint32_t exp_val) {
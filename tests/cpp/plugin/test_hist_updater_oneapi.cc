@@ -0,0 +1,51 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/tree_updater.h>
+
+#include <string>
+
+#include "../helpers.h"
+
+namespace xgboost {
+namespace {
+void CompareWithCPUHist(float sparsity) {
+  size_t constexpr kRows = 2048, kCols = 16;
+  auto p_dmat = RandomDataGenerator{kRows, kCols, sparsity}.Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows);
+  auto lparam = CreateEmptyGenericParam(0);
+  Args args{{"max_depth", "4"}, {"max_bin", "64"}};
+
+  auto train = [&](std::string const& name) {
+    RegTree tree;
+    tree.param.num_feature = kCols;
+    std::unique_ptr<TreeUpdater> updater{
+        TreeUpdater::Create(name, &lparam, ObjInfo{ObjInfo::kRegression})};
+    updater->Configure(args);
+    updater->Update(&gpair, p_dmat.get(), {&tree});
+    return tree;
+  };
+  auto expected = train("grow_quantile_histmaker");
+  auto tree = train("grow_quantile_histmaker_oneapi");
+
+  ASSERT_EQ(tree.GetNodes().size(), expected.GetNodes().size());
+  ASSERT_GT(tree.NumExtraNodes(), 0);
+  for (bst_node_t nidx = 0; nidx < static_cast<bst_node_t>(tree.GetNodes().size()); ++nidx) {
+    ASSERT_EQ(tree[nidx].IsLeaf(), expected[nidx].IsLeaf());
+    if (tree[nidx].IsLeaf()) {
+      ASSERT_NEAR(tree[nidx].LeafValue(), expected[nidx].LeafValue(), kRtEps);
+    } else {
+      ASSERT_EQ(tree[nidx].SplitIndex(), expected[nidx].SplitIndex());
+      ASSERT_EQ(tree[nidx].SplitCond(), expected[nidx].SplitCond());
+      ASSERT_EQ(tree[nidx].DefaultLeft(), expected[nidx].DefaultLeft());
+    }
+    ASSERT_NEAR(tree.Stat(nidx).sum_hess, expected.Stat(nidx).sum_hess, 1e-3);
+  }
+}
+}  // anonymous namespace
+
+TEST(Plugin, OneAPIHistUpdaterDense) { CompareWithCPUHist(0.0f); }
+
+TEST(Plugin, OneAPIHistUpdaterSparse) { CompareWithCPUHist(0.3f); }
+}  // namespace xgboost
@@ -0,0 +1,117 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include <gtest/gtest.h>
+#include <dmlc/filesystem.h>
+#include <xgboost/learner.h>
+#include <xgboost/predictor.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../../../src/gbm/gbtree_model.h"
+#include "../../../src/predictor/compiled_forest.h"
+#include "../helpers.h"
+#include "test_predictor.h"
+
+namespace xgboost {
+namespace {
+// Compile generated source into a shared library, empty if no C compiler is available.
+std::string Compile(std::string const &source, dmlc::TemporaryDirectory const &tempdir) {
+  auto src = tempdir.path + "/forest.c";
+  auto lib = tempdir.path + "/forest.so";
+  {
+    std::ofstream fout{src};
+    fout << source;
+  }
+  auto cmd = "cc -O1 -shared -fPIC " + src + " -o " + lib + " > /dev/null 2>&1";
+  if (std::system(cmd.c_str()) != 0) {
+    return "";
+  }
+  return lib;
+}
+}  // anonymous namespace
+
+TEST(CompiledPredictor, Basic) {
+  size_t constexpr kRows = 256, kCols = 16, kClasses = 3;
+  auto dmat = RandomDataGenerator(kRows, kCols, 0.3).GenerateDMatrix(true, false, kClasses);
+  std::unique_ptr<Learner> learner{Learner::Create({dmat})};
+  learner->SetParams(Args{{"num_class", std::to_string(kClasses)},
+                          {"objective", "multi:softprob"},
+                          {"max_depth", "6"}});
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, dmat);
+  }
+
+  std::string source;
+  learner->GenerateSource(&source);
+  ASSERT_NE(source.find("xgb_tree_11(float const *x)"), std::string::npos);
+  ASSERT_EQ(source.find("xgb_tree_12("), std::string::npos);
+
+  dmlc::TemporaryDirectory tempdir;
+  auto lib = Compile(source, tempdir);
+  if (lib.empty()) {
+    GTEST_SKIP() << "C compiler is not available.";
+  }
+
+  // Not cached by training.
+  auto test = RandomDataGenerator(kRows, kCols, 0.3).Seed(1).GenerateDMatrix();
+  auto predict = [&](std::string name, bool margin, uint32_t end, HostDeviceVector<float> *out) {
+    learner->SetParams(Args{{"predictor", name}, {"compiled_library", lib}});
+    learner->Predict(test, margin, out, 0, end);
+  };
+  for (auto margin : {false, true}) {
+    // All trees are inlined for the whole model, other ranges call each tree.
+    for (uint32_t end : {0, 2}) {
+      HostDeviceVector<float> cpu_predt, compiled_predt;
+      predict("cpu_predictor", margin, end, &cpu_predt);
+      predict("compiled_predictor", margin, end, &compiled_predt);
+      auto const &h_cpu = cpu_predt.ConstHostVector();
+      auto const &h_compiled = compiled_predt.ConstHostVector();
+      ASSERT_EQ(h_cpu.size(), h_compiled.size());
+      for (size_t i = 0; i < h_cpu.size(); ++i) {
+        ASSERT_NEAR(h_cpu[i], h_compiled[i], kRtEps);
+      }
+    }
+  }
+}
+
+TEST(CompiledPredictor, Categorical) {
+  size_t constexpr kCols = 10;
+  LearnerModelParam param;
+  param.num_feature = kCols;
+  param.num_output_group = 1;
+  param.base_score = 0.5;
+  uint32_t split_ind = 3;
+  float left_weight = 1.3f, right_weight = 1.7f;
+  gbm::GBTreeModel model(&param);
+  GBTreeModelForTest(&model, split_ind, 4, left_weight, right_weight);
+
+  std::ostringstream os;
+  predictor::GenerateForestSource(model, &os);
+  dmlc::TemporaryDirectory tempdir;
+  auto lib = Compile(os.str(), tempdir);
+  if (lib.empty()) {
+    GTEST_SKIP() << "C compiler is not available.";
+  }
+
+  GenericParameter runtime;
+  std::unique_ptr<Predictor> predictor{Predictor::Create("compiled_predictor", &runtime)};
+  predictor->Configure(Args{{"compiled_library", lib}});
+  for (float cat : {4.0f, 1.0f, 100.0f}) {
+    std::vector<float> row(kCols);
+    row[split_ind] = cat;
+    auto m = GetDMatrixFromData(row, 1, kCols);
+    std::vector<FeatureType> types(kCols, FeatureType::kCategorical);
+    m->Info().feature_types.HostVector() = types;
+    PredictionCacheEntry out_predictions;
+    predictor->InitOutPredictions(m->Info(), &out_predictions.predictions, model);
+    predictor->PredictBatch(m.get(), &out_predictions, model, 0);
+    // Matching category goes right, same as `common::Decision`.
+    auto expected = (cat == 4.0f ? right_weight : left_weight) + param.base_score;
+    ASSERT_EQ(out_predictions.predictions.HostVector()[0], expected);
+  }
+}
+}  // namespace xgboost
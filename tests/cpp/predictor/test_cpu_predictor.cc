@@ -5,11 +5,17 @@
 #include <gtest/gtest.h>
 #include <xgboost/predictor.h>
 
+#include <limits>
+#include <numeric>
+#include <thread>
+
 #include "../helpers.h"
 #include "test_predictor.h"
 #include "../../../src/gbm/gbtree_model.h"
 #include "../../../src/gbm/gbtree.h"
 #include "../../../src/data/adapter.h"
+#include "../../../src/common/perf_counters.h"
+#include "../../../src/common/threading_utils.h"
 
 namespace xgboost {
 TEST(CpuPredictor, Basic) {
@@ -185,7 +191,59 @@ TEST(CpuPredictor, InplacePredict) {
   }
 }
 
-void TestUpdatePredictionCache(bool use_subsampling) {
+namespace {
+void TestConcurrentInplacePredict() {
+  bst_row_t constexpr kRows{256};
+  bst_feature_t constexpr kCols{16};
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix(true);
+  std::shared_ptr<Learner> learner{Learner::Create({p_fmat})};
+  learner->SetParams(Args{{"tree_method", "hist"}, {"predictor", "cpu_predictor"}});
+  for (int32_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_fmat);
+  }
+
+  HostDeviceVector<float> data;
+  RandomDataGenerator{kRows, kCols, 0}.GenerateDense(&data);
+  std::shared_ptr<data::DenseAdapter> x{
+      new data::DenseAdapter(data.HostPointer(), kRows, kCols)};
+  HostDeviceVector<float>* p_predt;
+  learner->InplacePredict(x, nullptr, PredictionType::kValue,
+                          std::numeric_limits<float>::quiet_NaN(), &p_predt, 0, 0);
+  std::vector<float> expected = p_predt->HostVector();
+
+  // All threads share one booster, each of them gets its own output buffer.
+  std::vector<std::thread> threads;
+  std::vector<int32_t> mismatched(2 * std::thread::hardware_concurrency(), 0);
+  for (size_t t = 0; t < mismatched.size(); ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t iter = 0; iter < 8; ++iter) {
+        HostDeviceVector<float>* p_out;
+        learner->InplacePredict(x, nullptr, PredictionType::kValue,
+                                std::numeric_limits<float>::quiet_NaN(), &p_out, 0, 0);
+        mismatched[t] += p_out->HostVector() != expected;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto v : mismatched) {
+    ASSERT_EQ(v, 0);
+  }
+}
+}  // anonymous namespace
+
+TEST(CpuPredictor, ConcurrentInplacePredict) {
+  TestConcurrentInplacePredict();
+}
+
+TEST(CpuPredictor, ConcurrentInplacePredictPool) {
+  common::ParallelPool::SetBackend("pool");
+  TestConcurrentInplacePredict();
+  common::ParallelPool::SetBackend("omp");
+}
+
+void TestUpdatePredictionCache(bool use_subsampling, std::string sampling_method = "uniform") {
   size_t constexpr kRows = 64, kCols = 16, kClasses = 4;
   LearnerModelParam mparam;
   mparam.num_feature = kCols;
@@ -202,6 +260,7 @@ void TestUpdatePredictionCache(bool use_subsampling) {
   cfg["predictor"]   = "cpu_predictor";
   if (use_subsampling) {
     cfg["subsample"] = "0.5";
+    cfg["sampling_method"] = sampling_method;
   }
   Args args = {cfg.cbegin(), cfg.cend()};
   gbm->Configure(args);
@@ -242,6 +301,8 @@ TEST(CPUPredictor, CategoricalPredictLeaf) {
 TEST(CpuPredictor, UpdatePredictionCache) {
   TestUpdatePredictionCache(false);
   TestUpdatePredictionCache(true);
+  // Rows not chosen by sampling are excluded from the row set.
+  TestUpdatePredictionCache(true, "gradient_based");
 }
 
 TEST(CpuPredictor, LesserFeatures) {
@@ -252,4 +313,278 @@ TEST(CpuPredictor, Sparse) {
   TestSparsePrediction(0.2, "cpu_predictor");
   TestSparsePrediction(0.8, "cpu_predictor");
 }
+
+TEST(CpuPredictor, GHistIndex) {
+  size_t constexpr kRows = 256, kCols = 16;
+  for (float sparsity : {0.0f, 0.4f}) {
+    auto p_hist = RandomDataGenerator(kRows, kCols, sparsity).GenerateDMatrix(true);
+    std::unique_ptr<Learner> learner{Learner::Create({p_hist})};
+    learner->SetParam("tree_method", "hist");
+    learner->SetParam("max_bin", "32");
+    for (size_t i = 0; i < 4; ++i) {
+      learner->UpdateOneIter(i, p_hist);
+    }
+    ASSERT_TRUE(p_hist->PageExists<GHistIndexMatrix>());
+
+    Json model{Object{}};
+    learner->SaveModel(&model);
+    // Without prediction cache.
+    learner.reset(Learner::Create({}));
+    learner->LoadModel(model);
+    learner->SetParam("predictor", "cpu_predictor");
+
+    HostDeviceVector<float> from_hist;
+    learner->Predict(p_hist, false, &from_hist, 0, 0);
+
+    auto p_full = RandomDataGenerator(kRows, kCols, sparsity).GenerateDMatrix(true);
+    ASSERT_FALSE(p_full->PageExists<GHistIndexMatrix>());
+    HostDeviceVector<float> from_full;
+    learner->Predict(p_full, false, &from_full, 0, 0);
+
+    auto const& h_hist = from_hist.ConstHostVector();
+    auto const& h_full = from_full.ConstHostVector();
+    ASSERT_EQ(h_hist.size(), h_full.size());
+    for (size_t i = 0; i < h_hist.size(); ++i) {
+      ASSERT_NEAR(h_hist[i], h_full[i], kRtEps);
+    }
+  }
+}
+
+TEST(CpuPredictor, UsedFeatures) {
+  // Only a few of the features are used by the model, predictions with compact feature
+  // vectors must match the traversal of original trees.
+  size_t constexpr kRows = 200, kCols = 512;
+  auto lparam = CreateEmptyGenericParam(GPUIDX);
+  std::unique_ptr<Predictor> cpu_predictor{Predictor::Create("cpu_predictor", &lparam)};
+  LearnerModelParam param;
+  param.num_feature = kCols;
+  param.base_score = 0.0;
+  param.num_output_group = 1;
+  gbm::GBTreeModel model{&param};
+  for (bst_feature_t fidx : {300u, 5u, 511u, 300u}) {
+    std::vector<std::unique_ptr<RegTree>> trees;
+    trees.emplace_back(new RegTree);
+    auto& tree = *trees.back();
+    tree.ExpandNode(0, fidx, 0.5f, fidx % 2 == 0, 0.0f, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    tree.ExpandNode(tree[0].RightChild(), 64, 0.3f, true, 0.0f, -1.0f, 4.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f);
+    model.CommitModel(std::move(trees), 0);
+  }
+
+  for (float sparsity : {0.0f, 0.6f}) {
+    auto dmat = RandomDataGenerator(kRows, kCols, sparsity).GenerateDMatrix();
+    PredictionCacheEntry out_predictions;
+    cpu_predictor->InitOutPredictions(dmat->Info(), &out_predictions.predictions, model);
+    cpu_predictor->PredictBatch(dmat.get(), &out_predictions, model, 0);
+    auto const& h_predt = out_predictions.predictions.ConstHostVector();
+
+    HostDeviceVector<float> leaf;
+    cpu_predictor->PredictLeaf(dmat.get(), &leaf, model);
+    auto const& h_leaf = leaf.ConstHostVector();
+
+    auto const& batch = *dmat->GetBatches<SparsePage>().begin();
+    auto page = batch.GetView();
+    for (size_t i = 0; i < kRows; ++i) {
+      std::vector<float> instance;
+      cpu_predictor->PredictInstance(page[i], &instance, model);
+      ASSERT_NEAR(h_predt[i], instance[0], kRtEps);
+      float from_leaf = 0;
+      for (size_t t = 0; t < model.trees.size(); ++t) {
+        auto nidx = static_cast<bst_node_t>(h_leaf[i * model.trees.size() + t]);
+        ASSERT_TRUE((*model.trees[t])[nidx].IsLeaf());
+        from_leaf += (*model.trees[t])[nidx].LeafValue();
+      }
+      ASSERT_NEAR(from_leaf, instance[0], kRtEps);
+    }
+  }
+}
+TEST(CpuPredictor, ApproxContribution) {
+  LearnerModelParam param;
+  param.num_feature = 2;
+  param.base_score = 0.0;
+  param.num_output_group = 1;
+  gbm::GBTreeModel model(&param);
+  std::vector<std::unique_ptr<RegTree>> trees;
+  trees.emplace_back(new RegTree);
+  // Mean value of root is (1 * 1 + 3 * 3) / 4 = 2.5
+  trees.back()->ExpandNode(0, 1, 0.5f, true, 0.0f, 1.0f, 3.0f, 0.0f, 4.0f, 1.0f, 3.0f);
+  model.CommitModel(std::move(trees), 0);
+
+  float constexpr kNaN = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> x{0.0f, 0.0f, 0.0f, 1.0f, 0.0f, kNaN};
+  auto dmat = GetDMatrixFromData(x, 3, 2);
+  auto lparam = CreateEmptyGenericParam(GPUIDX);
+  std::unique_ptr<Predictor> cpu_predictor{Predictor::Create("cpu_predictor", &lparam)};
+  HostDeviceVector<float> contribs;
+  cpu_predictor->PredictContribution(dmat.get(), &contribs, model, 0, nullptr, true);
+  std::vector<float> expected{0.0f, -1.5f, 2.5f, 0.0f, 0.5f, 2.5f, 0.0f, -1.5f, 2.5f};
+  auto const& h_contribs = contribs.ConstHostVector();
+  ASSERT_EQ(h_contribs.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR(h_contribs[i], expected[i], kRtEps);
+  }
+
+  // Approximate contributions sum up to the margin.
+  size_t constexpr kRows = 256, kCols = 8;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0.3).GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_fmat})};
+  learner->SetParam("max_depth", "4");
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_fmat);
+  }
+  HostDeviceVector<float> margin;
+  learner->Predict(p_fmat, true, &margin, 0, 0);
+  learner->Predict(p_fmat, false, &contribs, 0, 0, false, false, true, true);
+  auto const& h_margin = margin.ConstHostVector();
+  ASSERT_EQ(contribs.Size(), kRows * (kCols + 1));
+  for (size_t i = 0; i < kRows; ++i) {
+    auto row = contribs.ConstHostSpan().subspan(i * (kCols + 1), kCols + 1);
+    ASSERT_NEAR(std::accumulate(row.cbegin(), row.cend(), 0.0f), h_margin[i], 1e-4);
+  }
+}
+
+TEST(CpuPredictor, CompactPredictLeaf) {
+  size_t constexpr kRows = 200, kCols = 4;
+  LearnerModelParam param;
+  param.num_feature = kCols;
+  param.base_score = 0.0;
+  param.num_output_group = 1;
+  gbm::GBTreeModel model(&param);
+  std::vector<std::unique_ptr<RegTree>> trees;
+  // Leaves are 2, 3, 4 for the first tree, 1, 2 for the second tree.
+  trees.emplace_back(new RegTree);
+  trees.back()->ExpandNode(0, 0, 0.5f, true, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  trees.back()->ExpandNode(1, 1, 0.5f, false, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  trees.emplace_back(new RegTree);
+  trees.back()->ExpandNode(0, 2, 0.5f, true, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  model.CommitModel(std::move(trees), 0);
+
+  LeafOrdinals ordinals{model, 0};
+  ASSERT_EQ(ordinals.NumTrees(), 2u);
+  ASSERT_EQ(ordinals.NumColumns(), 5ul);
+  ASSERT_EQ(ordinals.MaxLeaves(), 3ul);
+  std::vector<std::vector<uint32_t>> expected_ordinal{{0, 0, 0, 1, 2}, {0, 0, 1}};
+  std::vector<size_t> expected_offset{0, 3};
+
+  auto lparam = CreateEmptyGenericParam(GPUIDX);
+  std::unique_ptr<Predictor> cpu_predictor{Predictor::Create("cpu_predictor", &lparam)};
+  auto dmat = RandomDataGenerator(kRows, kCols, 0.2).GenerateDMatrix();
+  HostDeviceVector<float> leaves;
+  cpu_predictor->PredictLeaf(dmat.get(), &leaves, model);
+  auto const& h_leaves = leaves.ConstHostVector();
+  ASSERT_EQ(h_leaves.size(), kRows * 2);
+
+  std::vector<uint8_t> ordinal8(kRows * 2);
+  cpu_predictor->PredictLeafOrdinal(dmat.get(), common::Span<uint8_t>{ordinal8}, model);
+  std::vector<uint16_t> ordinal16(kRows * 2);
+  cpu_predictor->PredictLeafOrdinal(dmat.get(), common::Span<uint16_t>{ordinal16}, model);
+  std::vector<uint32_t> indices(kRows * 2);
+  cpu_predictor->PredictLeafOneHot(dmat.get(), common::Span<uint32_t>{indices}, model);
+  for (size_t i = 0; i < h_leaves.size(); ++i) {
+    auto tree_id = i % 2;
+    auto ordinal = expected_ordinal[tree_id].at(static_cast<size_t>(h_leaves[i]));
+    ASSERT_EQ(ordinal8[i], ordinal);
+    ASSERT_EQ(ordinal16[i], ordinal);
+    ASSERT_EQ(indices[i], expected_offset[tree_id] + ordinal);
+  }
+
+  // Output must have one element for each row and tree.
+  std::vector<uint16_t> short_out(kRows);
+  EXPECT_THROW(cpu_predictor->PredictLeafOrdinal(dmat.get(), common::Span<uint16_t>{short_out},
+                                                 model),
+               dmlc::Error);
+}
+
+TEST(CpuPredictor, Cascade) {
+  size_t constexpr kRows = 128, kCols = 8, kRounds = 8, kStage = 2;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0.2).GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_fmat})};
+  learner->SetParam("objective", "binary:logistic");
+  learner->SetParam("num_parallel_tree", "2");
+  for (size_t i = 0; i < kRounds; ++i) {
+    learner->UpdateOneIter(i, p_fmat);
+  }
+
+  HostDeviceVector<float> expected;
+  learner->Predict(p_fmat, false, &expected, 0, 0);
+  HostDeviceVector<float> predt;
+  std::vector<uint32_t> n_trees;
+  // No row exits early.
+  float constexpr kInf = std::numeric_limits<float>::infinity();
+  learner->PredictCascade(p_fmat, false, kStage, -kInf, kInf, &predt, &n_trees, 0, 0);
+  ASSERT_EQ(n_trees.size(), kRows);
+  auto const& h_expected = expected.ConstHostVector();
+  auto const& h_predt = predt.ConstHostVector();
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_EQ(n_trees[i], kRounds * 2);
+    ASSERT_NEAR(h_predt[i], h_expected[i], kRtEps);
+  }
+
+  // All rows exit after the first stage unless the margin is exactly 0.
+  HostDeviceVector<float> first_stage;
+  learner->Predict(p_fmat, true, &first_stage, 0, kStage);
+  learner->PredictCascade(p_fmat, true, kStage, 0.0f, 0.0f, &predt, &n_trees, 0, 0);
+  auto const& h_first = first_stage.ConstHostVector();
+  for (size_t i = 0; i < kRows; ++i) {
+    if (h_first[i] != 0.0f) {
+      ASSERT_EQ(n_trees[i], kStage * 2);
+      ASSERT_NEAR(h_predt[i], h_first[i], kRtEps);
+    }
+  }
+}
+
+TEST(CpuPredictor, RowCache) {
+  size_t constexpr kRows = 16, kCols = 8;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0.2).GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_fmat})};
+  learner->SetParams(Args{{"tree_method", "hist"}, {"predictor", "cpu_predictor"}});
+  for (int32_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_fmat);
+  }
+
+  HostDeviceVector<float> data;
+  RandomDataGenerator{kRows, kCols, 0.2}.GenerateDense(&data);
+  auto const& h_data = data.ConstHostVector();
+  auto missing = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> expected(kRows);
+  learner->PredictRows(h_data, missing, PredictionType::kMargin, expected, 0, 0);
+
+  learner->SetParam("row_cache_size", "4");
+  auto counters = common::PerfCounters::Get();
+  counters->Reset();
+  for (size_t iter = 0; iter < 2; ++iter) {
+    for (size_t i = 0; i < kRows; ++i) {
+      // Each row is predicted twice in a row, the second time from the cache.
+      for (size_t k = 0; k < 2; ++k) {
+        float predt;
+        learner->PredictRows(common::Span<float const>{h_data}.subspan(i * kCols, kCols),
+                             missing, PredictionType::kMargin, {&predt, 1}, 0, 0);
+        ASSERT_EQ(predt, expected[i]);
+      }
+    }
+  }
+  ASSERT_EQ(counters->Read(common::PerfCounters::kRowCacheHits), kRows * 2);
+  ASSERT_EQ(counters->Read(common::PerfCounters::kRowCacheMisses), kRows * 2);
+
+  // Rows are keyed by the range of trees.
+  std::vector<float> first(kRows);
+  learner->PredictRows(h_data, missing, PredictionType::kMargin, first, 0, 1);
+  learner->SetParam("row_cache_size", "0");
+  std::vector<float> expected_first(kRows);
+  learner->PredictRows(h_data, missing, PredictionType::kMargin, expected_first, 0, 1);
+  ASSERT_EQ(first, expected_first);
+
+  // In-place prediction shares the cache.
+  learner->SetParam("row_cache_size", "64");
+  std::shared_ptr<data::DenseAdapter> x{
+      new data::DenseAdapter(data.HostPointer(), kRows, kCols)};
+  counters->Reset();
+  for (size_t iter = 0; iter < 2; ++iter) {
+    HostDeviceVector<float>* p_predt;
+    learner->InplacePredict(x, nullptr, PredictionType::kMargin, missing, &p_predt, 0, 0);
+    ASSERT_EQ(p_predt->HostVector(), expected);
+  }
+  ASSERT_EQ(counters->Read(common::PerfCounters::kRowCacheHits), kRows);
+  ASSERT_EQ(counters->Read(common::PerfCounters::kRowCacheMisses), kRows);
+}
 }  // namespace xgboost
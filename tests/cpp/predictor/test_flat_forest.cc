@@ -0,0 +1,228 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../../../src/common/common.h"
+#include "../../../src/gbm/gbtree_model.h"
+#include "../../../src/predictor/flat_forest.h"
+#include "../../../src/predictor/simd_traversal.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace predictor {
+TEST(FlatForest, Layout) {
+  LearnerModelParam param;
+  param.num_feature = 2;
+  param.num_output_group = 1;
+  gbm::GBTreeModel model{&param};
+
+  std::vector<std::unique_ptr<RegTree>> trees;
+  trees.emplace_back(new RegTree);
+  auto& tree = *trees.back();
+  //     0
+  //   1   2
+  //      3 4
+  tree.ExpandNode(0, 0, 0.5f, true, 0.0f, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  tree.ExpandNode(tree[0].RightChild(), 1, 1.5f, false, 0.0f, 3.0f, 4.0f, 0.0f, 0.0f, 0.0f,
+                  0.0f);
+  model.CommitModel(std::move(trees), 0);
+
+  FlatForest forest{model.Generation()};
+  forest.Extend(model);
+  ASSERT_EQ(forest.Size(), 1);
+  auto const* nodes = forest.Tree(0);
+  ASSERT_FALSE(nodes[0].IsLeaf());
+  ASSERT_EQ(nodes[0].SplitIndex(), 0);
+  ASSERT_TRUE(nodes[0].DefaultLeft());
+  ASSERT_EQ(nodes[0].left, 1);
+  ASSERT_TRUE(nodes[1].IsLeaf());
+  ASSERT_EQ(forest.LeafValue(nodes[1]), 1.0f);
+  ASSERT_FALSE(nodes[2].IsLeaf());
+  ASSERT_EQ(nodes[2].left, 3);
+  ASSERT_EQ(forest.LeafValue(nodes[4]), 4.0f);
+
+  RegTree::FVec feat;
+  feat.Init(2);
+  std::vector<Entry> row{{0, 1.0f}, {1, 1.0f}};
+  feat.Fill(row);
+  auto cats = model.trees[0]->GetCategoriesMatrix();
+  auto const& leaf = GetLeaf<true, false>(nodes, feat, cats);
+  ASSERT_EQ(forest.LeafValue(leaf), 3.0f);
+  ASSERT_EQ(leaf.nidx, (*model.trees[0])[tree[0].RightChild()].LeftChild());
+  feat.Drop(row);
+  // missing value goes to the default child.
+  auto const& left = GetLeaf<true, false>(nodes, feat, cats);
+  ASSERT_EQ(forest.LeafValue(left), 1.0f);
+
+  // Appending new trees keeps the generation.
+  auto generation = model.Generation();
+  trees.clear();
+  trees.emplace_back(new RegTree);
+  model.CommitModel(std::move(trees), 0);
+  ASSERT_EQ(model.Generation(), generation);
+  forest.Extend(model);
+  ASSERT_EQ(forest.Size(), 2);
+  ASSERT_TRUE(forest.Tree(1)[0].IsLeaf());
+
+  model.Invalidate();
+  ASSERT_NE(model.Generation(), generation);
+}
+
+TEST(FlatForest, CompactIndex) {
+  FlatForest forest;
+  RegTree tree;
+  tree.ExpandNode(0, 7, 0.5f, true, 0.0f, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  tree.ExpandNode(tree[0].RightChild(), 3, 1.5f, false, 0.0f, 3.0f, 4.0f, 0.0f, 0.0f, 0.0f,
+                  0.0f);
+  forest.Push(tree);
+  ASSERT_EQ(forest.NumUsedFeatures(), 2);
+  auto compact = forest.CompactIndex();
+  ASSERT_EQ(compact.size(), 8);
+  ASSERT_EQ(compact[7], 0);
+  ASSERT_EQ(compact[3], 1);
+  ASSERT_EQ(compact[0], -1);
+  ASSERT_EQ(forest.UsedFeatures()[0], 7);
+  ASSERT_EQ(forest.UsedFeatures()[1], 3);
+  ASSERT_EQ(forest.Tree(0)[0].SplitIndex(), 0);
+  ASSERT_EQ(forest.Tree(0)[2].SplitIndex(), 1);
+
+  RegTree::FVec feat;
+  feat.Init(forest.NumUsedFeatures());
+  // Features not used by the forest are ignored.
+  std::vector<Entry> row{{1, 0.0f}, {3, 1.0f}, {7, 1.0f}, {9, 0.0f}};
+  feat.Fill(row, compact);
+  ASSERT_FALSE(feat.HasMissing());
+  auto cats = tree.GetCategoriesMatrix();
+  auto const& leaf = GetLeaf<false, false>(forest.Tree(0), feat, cats);
+  ASSERT_EQ(forest.LeafValue(leaf), 3.0f);
+  feat.Drop(row, compact);
+  ASSERT_TRUE(feat.IsMissing(0));
+  ASSERT_TRUE(feat.IsMissing(1));
+
+  // Existing compact indices are kept when new trees are pushed.
+  RegTree second;
+  second.ExpandNode(0, 9, 0.5f, true, 0.0f, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  second.ExpandNode(second[0].LeftChild(), 3, 0.5f, true, 0.0f, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f);
+  forest.Push(second);
+  compact = forest.CompactIndex();
+  ASSERT_EQ(forest.NumUsedFeatures(), 3);
+  ASSERT_EQ(compact[7], 0);
+  ASSERT_EQ(compact[3], 1);
+  ASSERT_EQ(compact[9], 2);
+  ASSERT_EQ(forest.Tree(1)[0].SplitIndex(), 2);
+  ASSERT_EQ(forest.Tree(1)[1].SplitIndex(), 1);
+}
+
+TEST(FlatForest, Image) {
+  FlatForest forest;
+  RegTree tree;
+  tree.ExpandNode(0, 7, 0.5f, true, 0.0f, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  tree.ExpandNode(tree[0].RightChild(), 3, 1.5f, false, 0.0f, 3.0f, 4.0f, 0.0f, 0.0f, 0.0f,
+                  0.0f);
+  forest.Push(tree);
+  forest.Push(RegTree{});
+
+  std::string image;
+  forest.SaveImage(&image);
+  // Copy into aligned memory.
+  std::vector<FlatNode> storage(common::DivRoundUp(image.size(), sizeof(FlatNode)));
+  std::copy(image.cbegin(), image.cend(), reinterpret_cast<char *>(storage.data()));
+  auto mapped = FlatForest::FromImage(
+      {reinterpret_cast<char const *>(storage.data()), image.size()}, nullptr, 3);
+  ASSERT_TRUE(mapped->IsMapped());
+  ASSERT_FALSE(forest.IsMapped());
+  ASSERT_EQ(mapped->Generation(), 3);
+  ASSERT_EQ(mapped->Size(), forest.Size());
+  ASSERT_EQ(mapped->NumLeaves(), forest.NumLeaves());
+  ASSERT_EQ(mapped->NumUsedFeatures(), forest.NumUsedFeatures());
+  ASSERT_EQ(mapped->CompactIndex().size(), forest.CompactIndex().size());
+  // Trees are viewed in place.
+  auto const *begin = reinterpret_cast<char const *>(storage.data());
+  ASSERT_GE(reinterpret_cast<char const *>(mapped->Tree(0)), begin);
+  ASSERT_LT(reinterpret_cast<char const *>(mapped->Tree(0)), begin + image.size());
+  for (size_t t = 0; t < forest.Size(); ++t) {
+    ASSERT_EQ(mapped->TreeSize(t), forest.TreeSize(t));
+    ASSERT_EQ(mapped->HasCategorical(t), forest.HasCategorical(t));
+    for (size_t i = 0; i < forest.TreeSize(t); ++i) {
+      auto const &l = forest.Tree(t)[i];
+      auto const &r = mapped->Tree(t)[i];
+      ASSERT_EQ(l.split_cond, r.split_cond);
+      ASSERT_EQ(l.sindex, r.sindex);
+      ASSERT_EQ(l.left, r.left);
+      ASSERT_EQ(l.nidx, r.nidx);
+      if (l.IsLeaf()) {
+        ASSERT_EQ(forest.LeafValue(l), mapped->LeafValue(r));
+      }
+    }
+  }
+  // Mapped forest is immutable.
+  auto copy = *mapped;
+  ASSERT_THROW(copy.Push(tree), dmlc::Error);
+  // Truncated image is rejected.
+  ASSERT_THROW(FlatForest::FromImage({reinterpret_cast<char const *>(storage.data()),
+                                      image.size() - 1},
+                                     nullptr, 3),
+               dmlc::Error);
+}
+
+TEST(FlatForest, SimdTraverse) {
+  int32_t width = SimdTraversalWidth();
+  if (width == 0) {
+    GTEST_SKIP() << "SIMD traversal is not supported on current CPU.";
+  }
+  size_t constexpr kCols = 3;
+  LearnerModelParam param;
+  param.num_feature = kCols;
+  param.num_output_group = 1;
+  gbm::GBTreeModel model{&param};
+
+  std::vector<std::unique_ptr<RegTree>> trees;
+  trees.emplace_back(new RegTree);
+  auto& tree = *trees.back();
+  tree.ExpandNode(0, 0, 0.5f, true, 0.0f, 1.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  tree.ExpandNode(tree[0].LeftChild(), 1, 0.2f, false, 0.0f, 3.0f, 4.0f, 0.0f, 0.0f, 0.0f,
+                  0.0f);
+  tree.ExpandNode(tree[0].RightChild(), 2, 0.7f, true, 0.0f, 5.0f, 6.0f, 0.0f, 0.0f, 0.0f,
+                  0.0f);
+  model.CommitModel(std::move(trees), 0);
+  FlatForest forest{model.Generation()};
+  forest.Extend(model);
+  auto cats = model.trees[0]->GetCategoriesMatrix();
+
+  std::vector<float> dense(width * kCols);
+  std::vector<float> out(width);
+  std::vector<Entry> row;
+  RegTree::FVec feat;
+  feat.Init(kCols);
+  std::vector<float> values{0.1f, 0.3f, 0.6f, 0.9f, std::numeric_limits<float>::quiet_NaN()};
+  for (size_t n = 0; n < 4; ++n) {
+    for (int32_t i = 0; i < width; ++i) {
+      for (size_t j = 0; j < kCols; ++j) {
+        dense[i * kCols + j] = values[(i * (j + 2) + n) % values.size()];
+      }
+    }
+    SimdTraverse(forest.Tree(0), forest.LeafValues(), dense.data(), kCols, out.data());
+    for (int32_t i = 0; i < width; ++i) {
+      row.clear();
+      for (size_t j = 0; j < kCols; ++j) {
+        if (!std::isnan(dense[i * kCols + j])) {
+          row.push_back({static_cast<bst_feature_t>(j), dense[i * kCols + j]});
+        }
+      }
+      feat.Fill(row);
+      auto const& leaf = GetLeaf<true, false>(forest.Tree(0), feat, cats);
+      ASSERT_EQ(out[i], forest.LeafValue(leaf));
+      feat.Drop(row);
+    }
+  }
+}
+}  // namespace predictor
+}  // namespace xgboost
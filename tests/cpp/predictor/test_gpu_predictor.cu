@@ -58,6 +58,34 @@ TEST(GPUPredictor, Basic) {
   }
 }
 
+TEST(GPUPredictor, ForestTiles) {
+  // Small trees share a tile in shared memory, while deep trees don't fit and are read
+  // from global memory.
+  size_t constexpr kRows = 8192, kCols = 16;
+  auto m = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({m})};
+  learner->SetParams(Args{{"tree_method", "hist"},
+                          {"min_child_weight", "0"},
+                          {"reg_lambda", "0"}});
+  for (size_t i = 0; i < 8; ++i) {
+    learner->SetParam("max_depth", std::to_string(i % 2 == 0 ? 2 : 16));
+    learner->UpdateOneIter(i, m);
+  }
+
+  HostDeviceVector<float> cpu_predt, gpu_predt;
+  learner->SetParam("predictor", "cpu_predictor");
+  learner->Predict(m, true, &cpu_predt, 0, 0);
+  learner->SetParam("predictor", "gpu_predictor");
+  learner->Predict(m, true, &gpu_predt, 0, 0);
+
+  auto const& h_cpu = cpu_predt.ConstHostVector();
+  auto const& h_gpu = gpu_predt.ConstHostVector();
+  ASSERT_EQ(h_cpu.size(), h_gpu.size());
+  for (size_t i = 0; i < h_cpu.size(); ++i) {
+    ASSERT_NEAR(h_cpu[i], h_gpu[i], 1e-3);
+  }
+}
+
 TEST(GPUPredictor, EllpackBasic) {
   size_t constexpr kCols {8};
   for (size_t bins = 2; bins < 258; bins += 16) {
@@ -161,6 +189,64 @@ TEST(GPUPredictor, MGPU_InplacePredict) {  // NOLINT
                dmlc::Error);
 }
 
+TEST(GPUPredictor, MGPU_ShardedPredict) {  // NOLINT
+  int32_t n_gpus = xgboost::common::AllVisibleGPUs();
+  if (n_gpus <= 1) {
+    LOG(WARNING) << "GPUPredictor.MGPU_ShardedPredict is skipped.";
+    return;
+  }
+  // More than one chunk of rows for each device.
+  size_t constexpr kRows = 150000, kCols = 8;
+  auto m = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({m})};
+  learner->SetParams(Args{{"tree_method", "hist"}, {"predictor", "gpu_predictor"}});
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, m);
+  }
+
+  HostDeviceVector<float> single, sharded;
+  learner->Predict(m, true, &single, 0, 0);
+  learner->SetParam("predictor_devices", "-1");
+  learner->Predict(m, true, &sharded, 0, 0);
+
+  auto const& h_single = single.ConstHostVector();
+  auto const& h_sharded = sharded.ConstHostVector();
+  ASSERT_EQ(h_single.size(), h_sharded.size());
+  for (size_t i = 0; i < h_single.size(); ++i) {
+    ASSERT_NEAR(h_single[i], h_sharded[i], kRtEps);
+  }
+}
+
+TEST(GPUPredictor, HostStagedPredict) {
+  // Host data spanning more than two chunks, so staging slots are reused.
+  size_t constexpr kRows = 150000, kCols = 8;
+  auto m = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({m})};
+  learner->SetParams(Args{{"tree_method", "hist"}, {"predictor", "cpu_predictor"}});
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, m);
+  }
+
+  // Not in the prediction cache of the learner.
+  auto test = RandomDataGenerator{kRows, kCols, 0.2}.Seed(1).GenerateDMatrix();
+  HostDeviceVector<float> expected;
+  learner->Predict(test, true, &expected, 0, 0);
+  learner->SetParam("predictor", "gpu_predictor");
+  auto const& h_expected = expected.ConstHostVector();
+  // Second round runs on the pooled slots.
+  for (size_t r = 0; r < 2; ++r) {
+    auto batch = *test->GetBatches<SparsePage>().begin();
+    ASSERT_FALSE(batch.data.DeviceCanRead());
+    HostDeviceVector<float> staged;
+    learner->Predict(test, true, &staged, 0, 0);
+    auto const& h_staged = staged.ConstHostVector();
+    ASSERT_EQ(h_staged.size(), h_expected.size());
+    for (size_t i = 0; i < h_staged.size(); ++i) {
+      ASSERT_NEAR(h_staged[i], h_expected[i], kRtEps);
+    }
+  }
+}
+
 TEST(GpuPredictor, LesserFeatures) {
   TestPredictionWithLesserFeatures("gpu_predictor");
 }
@@ -223,6 +309,54 @@ TEST(GPUPredictor, Shap) {
   }
 }
 
+TEST(GPUPredictor, ShapAppendTrees) {
+  size_t constexpr kCols = 2;
+  LearnerModelParam param;
+  param.num_feature = kCols;
+  param.num_output_group = 1;
+  param.base_score = 0.5;
+  gbm::GBTreeModel model(&param);
+
+  auto gpu_lparam = CreateEmptyGenericParam(0);
+  auto cpu_lparam = CreateEmptyGenericParam(-1);
+  std::unique_ptr<Predictor> gpu_predictor = std::unique_ptr<Predictor>(
+      Predictor::Create("gpu_predictor", &gpu_lparam));
+  std::unique_ptr<Predictor> cpu_predictor = std::unique_ptr<Predictor>(
+      Predictor::Create("cpu_predictor", &cpu_lparam));
+  gpu_predictor->Configure({});
+  cpu_predictor->Configure({});
+  auto dmat = RandomDataGenerator(16, kCols, 0).GenerateDMatrix();
+
+  auto check = [&](uint32_t tree_end) {
+    HostDeviceVector<float> predictions;
+    HostDeviceVector<float> cpu_predictions;
+    gpu_predictor->PredictContribution(dmat.get(), &predictions, model, tree_end);
+    cpu_predictor->PredictContribution(dmat.get(), &cpu_predictions, model, tree_end);
+    auto& phis = predictions.HostVector();
+    auto& cpu_phis = cpu_predictions.HostVector();
+    ASSERT_EQ(phis.size(), cpu_phis.size());
+    for (auto i = 0ull; i < phis.size(); i++) {
+      EXPECT_NEAR(cpu_phis[i], phis[i], 1e-3);
+    }
+  };
+
+  // Paths of previous trees are reused as the model grows.
+  for (size_t i = 0; i < 3; ++i) {
+    std::vector<std::unique_ptr<RegTree>> trees;
+    trees.push_back(std::unique_ptr<RegTree>(new RegTree));
+    trees[0]->ExpandNode(0, i % kCols, 0.5, true, 1.0, -1.0 - i, 1.0 + i, 0.0,
+                         5.0, 2.0, 3.0);
+    model.CommitModel(std::move(trees), 0);
+    check(0);
+  }
+  // Fewer trees than cached.
+  check(2);
+  // Tree modified in place.
+  model.trees.front()->Stat(1).sum_hess = 4.0;
+  (*model.trees.front())[1].SetLeaf(3.0);
+  check(0);
+}
+
 TEST(GPUPredictor, IterationRange) {
   TestIterationRange("gpu_predictor");
 }
@@ -65,6 +65,10 @@ void TestInplacePrediction(dmlc::any x, std::string predictor,
 
 void TestPredictionWithLesserFeatures(std::string preditor_name);
 
+// A single tree with a categorical split on split_cat.
+void GBTreeModelForTest(gbm::GBTreeModel *model, uint32_t split_ind, bst_cat_t split_cat,
+                        float left_weight, float right_weight);
+
 void TestCategoricalPrediction(std::string name);
 
 void TestCategoricalPredictLeaf(StringView name);
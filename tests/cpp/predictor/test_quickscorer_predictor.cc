@@ -0,0 +1,53 @@
+/*!
+ * Copyright 2021 XGBoost contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/learner.h>
+#include <xgboost/predictor.h>
+
+#include "../helpers.h"
+#include "test_predictor.h"
+
+namespace xgboost {
+TEST(QuickScorerPredictor, Basic) {
+  size_t constexpr kRows = 256, kCols = 16, kClasses = 3;
+  auto dmat = RandomDataGenerator(kRows, kCols, 0.3).GenerateDMatrix(true, false, kClasses);
+  std::unique_ptr<Learner> learner{Learner::Create({dmat})};
+  learner->SetParams(Args{{"num_class", std::to_string(kClasses)},
+                          {"objective", "multi:softprob"},
+                          {"max_depth", "6"}});
+  for (size_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, dmat);
+  }
+
+  auto predict = [&](std::string name, bool margin, HostDeviceVector<float>* out) {
+    learner->SetParam("predictor", name);
+    learner->Predict(dmat, margin, out, 0, 0);
+  };
+  for (auto margin : {false, true}) {
+    HostDeviceVector<float> cpu_predt, qs_predt;
+    predict("cpu_predictor", margin, &cpu_predt);
+    predict("quickscorer_predictor", margin, &qs_predt);
+    auto const& h_cpu = cpu_predt.ConstHostVector();
+    auto const& h_qs = qs_predt.ConstHostVector();
+    ASSERT_EQ(h_cpu.size(), h_qs.size());
+    for (size_t i = 0; i < h_cpu.size(); ++i) {
+      ASSERT_NEAR(h_cpu[i], h_qs[i], kRtEps);
+    }
+  }
+}
+
+TEST(QuickScorerPredictor, IterationRange) {
+  TestIterationRange("quickscorer_predictor");
+}
+
+TEST(QuickScorerPredictor, Sparse) {
+  TestSparsePrediction(0.2, "quickscorer_predictor");
+  TestSparsePrediction(0.8, "quickscorer_predictor");
+}
+
+TEST(QuickScorerPredictor, CategoricalPrediction) {
+  // Categorical splits are handled by falling back to CPU predictor.
+  TestCategoricalPrediction("quickscorer_predictor");
+}
+}  // namespace xgboost
@@ -0,0 +1,142 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include "../../../src/gbm/gbtree_model.h"
+#include "../../../src/predictor/tree_shap.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace predictor {
+namespace {
+size_t constexpr kCols = 3;
+
+std::unique_ptr<RegTree> MakeTree() {
+  std::unique_ptr<RegTree> p_tree{new RegTree};
+  auto& tree = *p_tree;
+  // Feature 0 is used twice on the same path.
+  tree.ExpandNode(0, 0, 0.5f, true, 0.0f, 1.0f, 2.0f, 0.0f, 10.0f, 6.0f, 4.0f);
+  tree.ExpandNode(tree[0].LeftChild(), 1, 0.2f, false, 0.0f, 3.0f, 4.0f, 0.0f, 6.0f, 2.0f,
+                  4.0f);
+  tree.ExpandNode(tree[0].RightChild(), 0, 0.7f, true, 0.0f, 5.0f, 6.0f, 0.0f, 4.0f, 1.0f,
+                  3.0f);
+  auto nidx = tree[tree[0].LeftChild()].RightChild();
+  tree.ExpandNode(nidx, 2, 0.4f, false, 0.0f, -1.0f, 7.0f, 0.0f, 4.0f, 3.0f, 1.0f);
+  return p_tree;
+}
+
+template <typename Fn>
+void ForEachRow(Fn&& fn) {
+  RegTree::FVec feat;
+  feat.Init(kCols);
+  std::vector<float> values{0.1f, 0.3f, 0.6f, 0.9f, std::numeric_limits<float>::quiet_NaN()};
+  std::vector<Entry> row;
+  for (size_t n = 0; n < values.size() * values.size(); ++n) {
+    row.clear();
+    for (size_t j = 0; j < kCols; ++j) {
+      auto v = values[(n / (j + 1) + j) % values.size()];
+      if (!std::isnan(v)) {
+        row.push_back({static_cast<bst_feature_t>(j), v});
+      }
+    }
+    feat.Fill(row);
+    fn(feat);
+    feat.Drop(row);
+  }
+}
+}  // anonymous namespace
+
+TEST(TreeShapForest, Calculate) {
+  LearnerModelParam param;
+  param.num_feature = kCols;
+  param.num_output_group = 1;
+  gbm::GBTreeModel model{&param};
+
+  std::vector<std::unique_ptr<RegTree>> trees;
+  trees.emplace_back(MakeTree());
+  model.CommitModel(std::move(trees), 0);
+
+  TreeShapForest forest{model.Generation()};
+  forest.Extend(model);
+  ASSERT_EQ(forest.Size(), 1);
+  ASSERT_FALSE(forest.HasCategorical(0));
+  ASSERT_EQ(forest.MaxPathLength(), 3);
+
+  std::vector<TreeShapForest::PathWeight> workspace(forest.MaxPathLength() + 1);
+  ForEachRow([&](RegTree::FVec const& feat) {
+    std::vector<float> expected(kCols + 1, 0.0f);
+    auto mean_values = forest.MeanValues(0);
+    model.trees[0]->CalculateContributions(feat, &mean_values, expected.data(), 0, 0);
+    std::vector<float> got(kCols + 1, 0.0f);
+    forest.Calculate(0, feat, 1.0f, workspace.data(), got.data());
+    for (size_t i = 0; i < got.size(); ++i) {
+      ASSERT_NEAR(got[i], expected[i], kRtEps);
+    }
+  });
+}
+
+TEST(TreeShapForest, CalculateInteractions) {
+  LearnerModelParam param;
+  param.num_feature = kCols;
+  param.num_output_group = 1;
+  gbm::GBTreeModel model{&param};
+
+  std::vector<std::unique_ptr<RegTree>> trees;
+  trees.emplace_back(MakeTree());
+  model.CommitModel(std::move(trees), 0);
+
+  TreeShapForest forest{model.Generation()};
+  forest.Extend(model);
+  auto const& tree = *model.trees[0];
+  size_t constexpr kColumns = kCols + 1;
+  std::vector<TreeShapForest::PathWeight> workspace((forest.MaxPathLength() + 1) * 2);
+  std::vector<uint8_t> selected{0, 1, 0};
+
+  ForEachRow([&](RegTree::FVec const& feat) {
+    auto mean_values = forest.MeanValues(0);
+    // Conditioning on each feature, same as the original algorithm in predictor.
+    std::vector<float> diag(kColumns, 0.0f);
+    tree.CalculateContributions(feat, &mean_values, diag.data(), 0, 0);
+    std::vector<float> expected(kColumns * kColumns, 0.0f);
+    for (size_t i = 0; i < kColumns; ++i) {
+      std::vector<float> on(kColumns, 0.0f), off(kColumns, 0.0f);
+      tree.CalculateContributions(feat, &mean_values, off.data(), -1, i);
+      tree.CalculateContributions(feat, &mean_values, on.data(), 1, i);
+      expected[i * kColumns + i] = diag[i];
+      for (size_t k = 0; k < kColumns; ++k) {
+        if (k != i) {
+          expected[i * kColumns + k] = (on[k] - off[k]) / 2.0f;
+          expected[i * kColumns + i] -= expected[i * kColumns + k];
+        }
+      }
+    }
+
+    std::vector<float> got(kColumns * kColumns, 0.0f);
+    forest.CalculateInteractions(0, feat, 1.0f, {}, workspace.data(), got.data());
+    for (size_t i = 0; i < got.size(); ++i) {
+      ASSERT_NEAR(got[i], expected[i], kRtEps);
+    }
+
+    std::fill(got.begin(), got.end(), 0.0f);
+    forest.CalculateInteractions(0, feat, 1.0f, selected, workspace.data(), got.data());
+    for (size_t i = 0; i < kColumns; ++i) {
+      float row_sum = 0;
+      for (size_t k = 0; k < kColumns; ++k) {
+        row_sum += got[i * kColumns + k];
+        if (i != k && (i == 1 || k == 1)) {
+          ASSERT_NEAR(got[i * kColumns + k], expected[i * kColumns + k], kRtEps);
+        } else if (i != k) {
+          ASSERT_EQ(got[i * kColumns + k], 0.0f);
+        }
+      }
+      // Rows still sum up to SHAP values.
+      ASSERT_NEAR(row_sum, diag[i], kRtEps);
+    }
+  });
+}
+}  // namespace predictor
+}  // namespace xgboost
@@ -4,6 +4,7 @@
 
 #include <string>
 #include <iostream>
+#include <cstdio>
 #include "../../../rabit/src/allreduce_base.h"
 
 TEST(AllreduceBase, InitTask)
@@ -65,4 +66,123 @@ TEST(AllreduceBase, InitWithRingReduce)
   EXPECT_EQ(base.task_id, "1");
   EXPECT_EQ(base.reduce_ring_mincount, 1ul);
 }
+
+TEST(AllreduceBase, InitWithBroadcastChunk)
+{
+  rabit::engine::AllreduceBase base;
+  // defaults
+  EXPECT_EQ(base.broadcast_chunk_size, 256ul << 10);
+  EXPECT_EQ(base.broadcast_ring_minsize, 4ul << 20);
+
+  std::string rabit_broadcast_chunk = "rabit_broadcast_chunk=64K";
+  char cmd[rabit_broadcast_chunk.size()+1];
+  std::copy(rabit_broadcast_chunk.begin(), rabit_broadcast_chunk.end(), cmd);
+  cmd[rabit_broadcast_chunk.size()] = '\0';
+
+  std::string rabit_broadcast_ring_minsize = "rabit_broadcast_ring_minsize=1M";
+  char cmd2[rabit_broadcast_ring_minsize.size()+1];
+  std::copy(rabit_broadcast_ring_minsize.begin(), rabit_broadcast_ring_minsize.end(), cmd2);
+  cmd2[rabit_broadcast_ring_minsize.size()] = '\0';
+
+  char* argv[] = {cmd, cmd2};
+  base.Init(2, argv);
+  EXPECT_EQ(base.broadcast_chunk_size, 64ul << 10);
+  EXPECT_EQ(base.broadcast_ring_minsize, 1ul << 20);
+}
+
+TEST(AllreduceBase, InitWithTransport)
+{
+  rabit::engine::AllreduceBase base;
+  EXPECT_EQ(base.link_transport, rabit::utils::Transport::kTCP);
+
+  std::string rabit_transport = "rabit_transport=tcp";
+  char cmd[rabit_transport.size()+1];
+  std::copy(rabit_transport.begin(), rabit_transport.end(), cmd);
+  cmd[rabit_transport.size()] = '\0';
+
+  char* argv[] = {cmd};
+  base.Init(1, argv);
+  EXPECT_EQ(base.link_transport, rabit::utils::Transport::kTCP);
+
+  EXPECT_THROW(base.SetParam("rabit_transport", "udp"), dmlc::Error);
+#if !defined(RABIT_USE_RSOCKET)
+  EXPECT_THROW(base.SetParam("rabit_transport", "rsocket"), dmlc::Error);
+#else
+  base.SetParam("rabit_transport", "rsocket");
+  EXPECT_EQ(base.link_transport, rabit::utils::Transport::kRSocket);
+#endif  // !defined(RABIT_USE_RSOCKET)
+}
+
+TEST(AllreduceBase, InitWithShmAllreduce)
+{
+  rabit::engine::AllreduceBase base;
+
+  std::string rabit_shm_allreduce = "rabit_shm_allreduce=1";
+  char cmd[rabit_shm_allreduce.size()+1];
+  std::copy(rabit_shm_allreduce.begin(), rabit_shm_allreduce.end(), cmd);
+  cmd[rabit_shm_allreduce.size()] = '\0';
+
+  std::string rabit_shm_buffer = "rabit_shm_buffer=1000B";
+  char cmd2[rabit_shm_buffer.size()+1];
+  std::copy(rabit_shm_buffer.begin(), rabit_shm_buffer.end(), cmd2);
+  cmd2[rabit_shm_buffer.size()] = '\0';
+
+  char* argv[] = {cmd, cmd2};
+  base.Init(2, argv);
+  EXPECT_TRUE(base.rabit_shm_allreduce);
+  // rounded up to cache line.
+  EXPECT_EQ(base.shm_slot_size, 1024ul);
+  // single worker, nothing to share.
+  EXPECT_FALSE(base.hierarchical);
+  EXPECT_EQ(base.local_size, 1);
+  EXPECT_TRUE(base.Shutdown());
+}
+
+namespace {
+class CounterModel : public rabit::Serializable {
+ public:
+  int value {0};
+  void Load(rabit::Stream *fi) override { fi->Read(&value, sizeof(value)); }
+  void Save(rabit::Stream *fo) const override { fo->Write(&value, sizeof(value)); }
+};
+}  // anonymous namespace
+
+TEST(AllreduceBase, LocalCheckPoint)
+{
+  std::string path = "allreduce_base_test_checkpoint";
+  std::string rabit_checkpoint_path = "rabit_checkpoint_path=" + path;
+  char cmd[rabit_checkpoint_path.size()+1];
+  std::copy(rabit_checkpoint_path.begin(), rabit_checkpoint_path.end(), cmd);
+  cmd[rabit_checkpoint_path.size()] = '\0';
+
+  std::string rabit_checkpoint_interval = "rabit_checkpoint_interval=2";
+  char cmd2[rabit_checkpoint_interval.size()+1];
+  std::copy(rabit_checkpoint_interval.begin(), rabit_checkpoint_interval.end(), cmd2);
+  cmd2[rabit_checkpoint_interval.size()] = '\0';
+
+  char* argv[] = {cmd, cmd2};
+  {
+    rabit::engine::AllreduceBase base;
+    base.Init(2, argv);
+    CounterModel model;
+    EXPECT_EQ(base.LoadCheckPoint(&model), 0);
+    for (int i = 1; i <= 3; ++i) {
+      model.value = i;
+      base.CheckPoint(&model);
+    }
+    EXPECT_EQ(base.VersionNumber(), 3);
+    EXPECT_TRUE(base.Shutdown());
+  }
+  {
+    // restarted worker resumes from the last persisted version.
+    rabit::engine::AllreduceBase base;
+    base.Init(2, argv);
+    CounterModel model;
+    EXPECT_EQ(base.LoadCheckPoint(&model), 2);
+    EXPECT_EQ(model.value, 2);
+    EXPECT_EQ(base.VersionNumber(), 2);
+    EXPECT_TRUE(base.Shutdown());
+  }
+  std::remove((path + ".0").c_str());
+}
 #endif  // !defined(_WIN32)
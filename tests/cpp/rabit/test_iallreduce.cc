@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+#include <rabit/rabit.h>
+
+#include <numeric>
+#include <vector>
+
+TEST(Rabit, IAllreduce) {
+  // Without initialization rabit runs as a single worker, reduction keeps the input.
+  std::vector<float> first(16), second(32);
+  std::iota(first.begin(), first.end(), 0.0f);
+  std::iota(second.begin(), second.end(), 1.0f);
+  auto first_req = rabit::IAllreduce<rabit::op::Sum>(first.data(), first.size());
+  auto second_req = rabit::IAllreduce<rabit::op::Max>(second.data(), second.size());
+  second_req.Wait();
+  first_req.Wait();
+  for (size_t i = 0; i < first.size(); ++i) {
+    ASSERT_EQ(first[i], static_cast<float>(i));
+  }
+  for (size_t i = 0; i < second.size(); ++i) {
+    ASSERT_EQ(second[i], static_cast<float>(i + 1));
+  }
+  // Waiting again or on an empty request is a no-op.
+  first_req.Wait();
+  rabit::Request{}.Wait();
+}
@@ -0,0 +1,131 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+#include <xgboost/learner.h>
+
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../../src/serve/scoring_server.h"
+#include "../../../src/data/adapter.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace serve {
+namespace {
+size_t constexpr kRows = 64, kCols = 8;
+
+std::unique_ptr<Learner> TrainModel(std::vector<float> const &values,
+                                    std::vector<float> *out_expected) {
+  data::DenseAdapter adapter(values.data(), kRows, kCols);
+  std::shared_ptr<DMatrix> p_fmat{
+      DMatrix::Create(&adapter, std::numeric_limits<float>::quiet_NaN(), 1)};
+  p_fmat->Info().labels_.Resize(kRows);
+  auto &h_labels = p_fmat->Info().labels_.HostVector();
+  for (size_t i = 0; i < kRows; ++i) {
+    h_labels[i] = i % 2;
+  }
+  std::unique_ptr<Learner> learner{Learner::Create({p_fmat})};
+  learner->SetParam("objective", "binary:logistic");
+  for (int32_t i = 0; i < 4; ++i) {
+    learner->UpdateOneIter(i, p_fmat);
+  }
+  HostDeviceVector<float> predt;
+  learner->Predict(p_fmat, false, &predt, 0, 0);
+  *out_expected = predt.ConstHostVector();
+  return learner;
+}
+
+std::vector<float> GenerateValues() {
+  HostDeviceVector<float> storage;
+  RandomDataGenerator{kRows, kCols, 0}.GenerateDense(&storage);
+  return storage.ConstHostVector();
+}
+}  // anonymous namespace
+
+TEST(MicroBatcher, Batching) {
+  auto values = GenerateValues();
+  std::vector<float> expected;
+  auto learner = TrainModel(values, &expected);
+
+  BatchConfig config;
+  config.max_batch_rows = 16;
+  config.max_delay = std::chrono::milliseconds{100};
+  MicroBatcher batcher{std::move(learner), config};
+  ASSERT_EQ(batcher.NumFeatures(), kCols);
+
+  std::vector<std::future<std::vector<float>>> futures;
+  for (size_t i = 0; i < kRows; ++i) {
+    std::vector<float> row(values.cbegin() + i * kCols, values.cbegin() + (i + 1) * kCols);
+    futures.emplace_back(batcher.Submit(std::move(row), 1));
+  }
+  for (size_t i = 0; i < kRows; ++i) {
+    auto predt = futures[i].get();
+    ASSERT_EQ(predt.size(), 1);
+    ASSERT_NEAR(predt[0], expected[i], kRtEps);
+  }
+
+  auto stats = batcher.GetStats();
+  ASSERT_EQ(stats.n_requests, kRows);
+  ASSERT_EQ(stats.n_rows, kRows);
+  // Requests are collected into batches of at most 16 rows.
+  ASSERT_GE(stats.n_batches, kRows / 16);
+  ASSERT_LT(stats.n_batches, kRows / 2);
+
+  EXPECT_THROW(batcher.Submit(std::vector<float>(kCols + 1), 1), dmlc::Error);
+}
+
+TEST(ScoringServer, TCP) {
+  auto values = GenerateValues();
+  std::vector<float> expected;
+  auto learner = TrainModel(values, &expected);
+
+  std::vector<std::unique_ptr<MicroBatcher>> models;
+  models.emplace_back(new MicroBatcher{std::move(learner), BatchConfig{}});
+  ScoringServer server{std::move(models), std::chrono::seconds{0}};
+  auto port = server.ListenTCP(9091, 9999);
+  std::thread runner{[&] { server.Run(); }};
+
+  rabit::utils::TCPSocket client;
+  client.Create();
+  ASSERT_TRUE(client.Connect(rabit::utils::SockAddr{"127.0.0.1", port}));
+  auto request = [&](uint32_t model, uint32_t n_rows, uint32_t n_cols, float const *data,
+                     uint32_t *status) {
+    uint32_t header[3]{model, n_rows, n_cols};
+    client.SendAll(header, sizeof(header));
+    client.SendAll(data, sizeof(float) * n_rows * n_cols);
+    uint32_t response[2];
+    EXPECT_EQ(client.RecvAll(response, sizeof(response)), sizeof(response));
+    *status = response[0];
+    std::string payload(*status == ScoringServer::kOk ? response[1] * sizeof(float)
+                                                      : response[1],
+                        '\0');
+    client.RecvAll(&payload[0], payload.size());
+    return payload;
+  };
+
+  uint32_t status;
+  auto payload = request(0, kRows, kCols, values.data(), &status);
+  ASSERT_EQ(status, ScoringServer::kOk);
+  ASSERT_EQ(payload.size(), kRows * sizeof(float));
+  auto const *predt = reinterpret_cast<float const *>(payload.data());
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_NEAR(predt[i], expected[i], kRtEps);
+  }
+
+  payload = request(ScoringServer::kStats, 0, 0, nullptr, &status);
+  ASSERT_EQ(status, ScoringServer::kText);
+  auto stats = Json::Load(StringView{payload.data(), payload.size()});
+  ASSERT_EQ(get<Array const>(stats).size(), 1);
+  ASSERT_EQ(get<Integer const>(stats[0]["rows"]), kRows);
+
+  payload = request(ScoringServer::kShutdown, 0, 0, nullptr, &status);
+  ASSERT_EQ(status, ScoringServer::kOk);
+  runner.join();
+  client.Close();
+}
+}  // namespace serve
+}  // namespace xgboost
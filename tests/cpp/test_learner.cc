@@ -11,6 +11,7 @@
 #include <xgboost/version_config.h>
 #include "xgboost/json.h"
 #include "../../src/common/io.h"
+#include "../../src/common/perf_counters.h"
 #include "../../src/common/random.h"
 
 namespace xgboost {
@@ -136,6 +137,46 @@ TEST(Learner, Configuration) {
   }
 }
 
+TEST(Learner, IncrementalConfiguration) {
+  size_t constexpr kRows = 64, kCols = 8;
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner { Learner::Create({p_dmat}) };
+  learner->SetParams({{"eta", "0.3"}, {"max_depth", "4"}});
+  learner->Configure();
+  Json config { Object() };
+  // Setting the same value doesn't require configuration.
+  learner->SetParam("eta", "0.3");
+  learner->SetParam("max_depth", "4");
+  learner->SaveConfig(&config);
+
+  // Parameters of components are updated without configuring the learner.
+  learner->SetParam("eta", "0.1");
+  learner->SetParam("max_depth", "2");
+  learner->UpdateOneIter(0, p_dmat);
+  HostDeviceVector<float> predt;
+  learner->Predict(p_dmat, false, &predt, 0, 0);
+
+  std::unique_ptr<Learner> expected { Learner::Create({p_dmat}) };
+  expected->SetParams({{"eta", "0.1"}, {"max_depth", "2"}});
+  expected->UpdateOneIter(0, p_dmat);
+  HostDeviceVector<float> expected_predt;
+  expected->Predict(p_dmat, false, &expected_predt, 0, 0);
+
+  auto const& h_predt = predt.ConstHostVector();
+  auto const& h_expected = expected_predt.ConstHostVector();
+  ASSERT_EQ(h_predt.size(), h_expected.size());
+  for (size_t i = 0; i < h_predt.size(); ++i) {
+    ASSERT_NEAR(h_predt[i], h_expected[i], kRtEps);
+  }
+
+  // Learner parameters still go through the full configuration.
+  learner->SetParam("base_score", "0.2");
+  learner->Configure();
+  learner->SaveConfig(&config);
+  ASSERT_EQ(get<String const>(config["learner"]["learner_model_param"]["base_score"]),
+            "0.2");
+}
+
 TEST(Learner, JsonModelIO) {
   // Test of comparing JSON object directly.
   size_t constexpr kRows = 8;
@@ -268,6 +309,327 @@ TEST(Learner, BinaryModelIO) {
   ASSERT_EQ(config_str.find("WARNING"), std::string::npos);
 }
 
+TEST(Learner, CompactModelIO) {
+  size_t constexpr kRows = 64;
+  int32_t constexpr kIters = 4;
+  auto p_dmat = RandomDataGenerator{kRows, 10, 0}.GenerateDMatrix(true);
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->Configure();
+  for (int32_t iter = 0; iter < kIters; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+  }
+  HostDeviceVector<float> expected;
+  learner->Predict(p_dmat, true, &expected, 0, 0);
+
+  for (auto type : {"fp16", "int8"}) {
+    std::string buffer;
+    common::MemoryBufferStream fo(&buffer);
+    learner->SaveCompactModel(&fo, type);
+
+    std::unique_ptr<Learner> loaded{Learner::Create({p_dmat})};
+    common::MemoryFixSizeBuffer fi(&buffer[0], buffer.size());
+    loaded->LoadModel(&fi);
+    std::string error_str;
+    ASSERT_TRUE(loaded->GetAttr("compact_margin_error", &error_str));
+    auto error_bound = std::stod(error_str);
+
+    HostDeviceVector<float> got;
+    loaded->Predict(p_dmat, true, &got, 0, 0);
+    ASSERT_EQ(got.Size(), expected.Size());
+    for (size_t i = 0; i < got.Size(); ++i) {
+      ASSERT_NEAR(got.HostVector()[i], expected.HostVector()[i], error_bound + kRtEps);
+    }
+  }
+}
+
+TEST(Learner, LazyModelIO) {
+  size_t constexpr kRows = 32;
+  int32_t constexpr kIters = 4;
+  auto p_dmat = RandomDataGenerator{kRows, 10, 0}.GenerateDMatrix(true);
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->Configure();
+  for (int32_t iter = 0; iter < kIters; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+  }
+  learner->SetAttr("best_iteration", "2");
+  HostDeviceVector<float> expected;
+  learner->Predict(p_dmat, false, &expected, 0, 0);
+
+  dmlc::TemporaryDirectory tempdir;
+  for (std::string ext : {"bin", "json", "ubj"}) {
+    std::string const fname = tempdir.path + "/lazy_model_io." + ext;
+    {
+      std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname.c_str(), "w"));
+      if (ext == "bin") {
+        learner->SaveModel(fo.get());
+      } else {
+        Json out{Object()};
+        learner->SaveModel(&out);
+        std::vector<char> str;
+        Json::Dump(out, &str, ext == "ubj" ? std::ios::binary : std::ios::out);
+        fo->Write(str.data(), str.size());
+      }
+    }
+
+    // Model is materialized by prediction.
+    std::unique_ptr<Learner> loaded{Learner::Create({p_dmat})};
+    loaded->LoadModelLazy(fname);
+    HostDeviceVector<float> got;
+    loaded->Predict(p_dmat, false, &got, 0, 0);
+    ASSERT_EQ(got.Size(), expected.Size());
+    for (size_t i = 0; i < got.Size(); ++i) {
+      ASSERT_NEAR(got.HostVector()[i], expected.HostVector()[i], kRtEps);
+    }
+    ASSERT_EQ(loaded->BoostedRounds(), kIters);
+
+    // Model is materialized by accessing attributes.
+    loaded.reset(Learner::Create({p_dmat}));
+    loaded->LoadModelLazy(fname);
+    std::string best;
+    ASSERT_TRUE(loaded->GetAttr("best_iteration", &best));
+    ASSERT_EQ(best, "2");
+
+    // Eager loading replaces the pending model.
+    loaded.reset(Learner::Create({p_dmat}));
+    loaded->LoadModelLazy(fname);
+    std::unique_ptr<Learner> empty{Learner::Create({p_dmat})};
+    empty->SetParam("num_feature", "10");
+    empty->Configure();
+    Json j_empty{Object()};
+    empty->SaveModel(&j_empty);
+    loaded->LoadModel(j_empty);
+    loaded->Configure();
+    ASSERT_EQ(loaded->BoostedRounds(), 0);
+  }
+  ASSERT_THROW(learner->LoadModelLazy(tempdir.path + "/missing.bin"), dmlc::Error);
+}
+
+TEST(Learner, SharedModelIO) {
+  size_t constexpr kRows = 64, kCols = 10;
+  int32_t constexpr kIters = 4;
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0.2}.GenerateDMatrix(true);
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  learner->SetParam("num_class", "3");
+  learner->SetParam("objective", "multi:softprob");
+  learner->Configure();
+  for (int32_t iter = 0; iter < kIters; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+  }
+  HostDeviceVector<float> expected, expected_leaf;
+  learner->Predict(p_dmat, false, &expected, 0, 0);
+  learner->Predict(p_dmat, false, &expected_leaf, 0, 0, false, true);
+
+  dmlc::TemporaryDirectory tempdir;
+  std::string const fname = tempdir.path + "/shared_model.bin";
+  {
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname.c_str(), "w"));
+    learner->SaveSharedModel(fo.get());
+  }
+
+  auto check = [&](Learner *loaded) {
+    HostDeviceVector<float> got;
+    loaded->Predict(p_dmat, false, &got, 0, 0);
+    ASSERT_EQ(got.Size(), expected.Size());
+    for (size_t i = 0; i < got.Size(); ++i) {
+      ASSERT_NEAR(got.HostVector()[i], expected.HostVector()[i], kRtEps);
+    }
+    loaded->Predict(p_dmat, false, &got, 0, 0, false, true);
+    ASSERT_EQ(got.HostVector(), expected_leaf.HostVector());
+    ASSERT_EQ(loaded->BoostedRounds(), kIters);
+  };
+
+  // Boosters loaded from the same mapped file share the trees.
+  auto file = std::make_shared<common::MmapFile>(fname);
+  common::Span<char const> image{file->Data(), file->Size()};
+  std::unique_ptr<Learner> first{Learner::Create({p_dmat})};
+  first->LoadSharedModel(image, file);
+  std::unique_ptr<Learner> second{Learner::Create({p_dmat})};
+  second->LoadSharedModel(image, file);
+  file.reset();
+  check(first.get());
+  check(second.get());
+
+  // Only prediction through the forest is supported.
+  ASSERT_THROW(first->UpdateOneIter(0, p_dmat), dmlc::Error);
+  HostDeviceVector<float> contribs;
+  ASSERT_THROW(first->Predict(p_dmat, false, &contribs, 0, 0, false, false, true),
+               dmlc::Error);
+  Json out{Object()};
+  ASSERT_THROW(second->SaveModel(&out), dmlc::Error);
+
+  // Loading from stream copies the model.
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+  std::unique_ptr<Learner> copied{Learner::Create({p_dmat})};
+  copied->LoadModel(fi.get());
+  check(copied.get());
+}
+
+TEST(Learner, EvalCohorts) {
+  size_t constexpr kRows = 128, kCols = 4;
+  auto p_fmat = RandomDataGenerator{kRows, kCols, 0}.GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_fmat})};
+  learner->SetParam("eval_metric", "rmse");
+  learner->UpdateOneIter(0, p_fmat);
+
+  // cohort 1 is empty.
+  std::vector<uint32_t> cohorts(kRows);
+  std::vector<int32_t> rows;
+  for (size_t i = 0; i < kRows; ++i) {
+    cohorts[i] = i % 3 == 0 ? 0 : 2;
+    if (cohorts[i] == 2) {
+      rows.push_back(i);
+    }
+  }
+  learner->SetEvalCohorts(p_fmat, cohorts);
+  auto result = learner->EvalOneIter(0, {p_fmat}, {"train"});
+  ASSERT_NE(result.find("train-rmse:"), std::string::npos);
+  ASSERT_NE(result.find("train[0]-rmse:"), std::string::npos);
+  ASSERT_EQ(result.find("train[1]"), std::string::npos);
+
+  std::shared_ptr<DMatrix> sliced{p_fmat->Slice(rows)};
+  auto expected = learner->EvalOneIter(0, {sliced}, {"train[2]"});
+  // strip the iteration.
+  expected = expected.substr(expected.find('\t'));
+  ASSERT_NE(result.find(expected), std::string::npos);
+
+  learner->SetEvalCohorts(p_fmat, {});
+  result = learner->EvalOneIter(0, {p_fmat}, {"train"});
+  ASSERT_EQ(result.find("train[0]"), std::string::npos);
+}
+
+TEST(Learner, EvalOneIterAsync) {
+  size_t constexpr kRows = 128, kCols = 4;
+  int32_t constexpr kIters = 4;
+  auto p_train = RandomDataGenerator{kRows, kCols, 0}.Seed(1).GenerateDMatrix(true);
+  auto p_valid = RandomDataGenerator{kRows, kCols, 0}.Seed(2).GenerateDMatrix(true);
+  std::unique_ptr<Learner> learner{Learner::Create({p_train, p_valid})};
+  learner->SetParams({{"eval_metric", "rmse"}, {"eval_nthread", "1"}});
+  std::unique_ptr<Learner> reference{Learner::Create({p_train, p_valid})};
+  reference->SetParam("eval_metric", "rmse");
+
+  std::vector<std::string> expected;
+  for (int32_t iter = 0; iter < kIters; ++iter) {
+    learner->UpdateOneIter(iter, p_train);
+    reference->UpdateOneIter(iter, p_train);
+    expected.emplace_back(reference->EvalOneIter(iter, {p_valid}, {"valid"}));
+    auto result = learner->EvalOneIterAsync(iter, {p_valid}, {"valid"});
+    if (iter == 0) {
+      ASSERT_TRUE(result.empty());
+    } else {
+      ASSERT_EQ(result, expected[iter - 1]);
+    }
+  }
+  ASSERT_EQ(learner->WaitEvalOneIter(), expected.back());
+  ASSERT_TRUE(learner->WaitEvalOneIter().empty());
+}
+
+TEST(Learner, PredictionCacheIO) {
+  size_t constexpr kRows = 64;
+  int32_t constexpr kIters = 4;
+  auto p_dmat = RandomDataGenerator{kRows, 10, 0}.Seed(1).GenerateDMatrix(true);
+  auto p_other = RandomDataGenerator{kRows, 10, 0}.Seed(2).GenerateDMatrix(true);
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+  for (int32_t iter = 0; iter < kIters; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+  }
+  std::string model_buf, cache_buf;
+  common::MemoryBufferStream model_fo(&model_buf);
+  learner->SaveModel(&model_fo);
+  common::MemoryBufferStream cache_fo(&cache_buf);
+  learner->SavePredictionCache(p_dmat, &cache_fo);
+
+  auto load = [&](std::shared_ptr<DMatrix> data) {
+    std::unique_ptr<Learner> loaded{Learner::Create({data})};
+    common::MemoryFixSizeBuffer model_fi(&model_buf[0], model_buf.size());
+    loaded->LoadModel(&model_fi);
+    common::MemoryFixSizeBuffer cache_fi(&cache_buf[0], cache_buf.size());
+    loaded->LoadPredictionCache(data, &cache_fi);
+    return loaded;
+  };
+
+  auto loaded = load(p_dmat);
+  for (int32_t iter = kIters; iter < kIters * 2; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+    loaded->UpdateOneIter(iter, p_dmat);
+  }
+  Json expected{Object()}, got{Object()};
+  learner->SaveModel(&expected);
+  loaded->SaveModel(&got);
+  ASSERT_EQ(expected, got);
+
+  // Saved for a different dataset.
+  ASSERT_THROW(load(p_other), dmlc::Error);
+  // Saved for a different model.
+  std::unique_ptr<Learner> fresh{Learner::Create({p_dmat})};
+  fresh->UpdateOneIter(0, p_dmat);
+  common::MemoryFixSizeBuffer cache_fi(&cache_buf[0], cache_buf.size());
+  ASSERT_THROW(fresh->LoadPredictionCache(p_dmat, &cache_fi), dmlc::Error);
+}
+
+TEST(Learner, PredictionCacheSlice) {
+  size_t constexpr kRows = 64;
+  int32_t constexpr kIters = 4;
+  auto p_dmat = RandomDataGenerator{kRows, 10, 0}.Seed(1).GenerateDMatrix(true);
+  auto p_valid = RandomDataGenerator{kRows, 10, 0}.Seed(2).GenerateDMatrix(true);
+
+  std::unique_ptr<Learner> learner{Learner::Create({p_dmat, p_valid})};
+  for (int32_t iter = 0; iter < kIters; ++iter) {
+    learner->UpdateOneIter(iter, p_dmat);
+    learner->EvalOneIter(iter, {p_valid}, {"valid"});
+  }
+
+  HostDeviceVector<float> full, sliced;
+  learner->Predict(p_valid, true, &full, 0, 0);
+  auto counters = common::PerfCounters::Get();
+  counters->Reset();
+  // Predicting slices of the model doesn't drop the cache of evaluation data.
+  learner->Predict(p_valid, true, &sliced, 0, 1);
+  learner->Predict(p_valid, true, &sliced, 1, 2);
+  HostDeviceVector<float> again;
+  learner->Predict(p_valid, true, &again, 0, 0);
+  ASSERT_EQ(full.HostVector(), again.HostVector());
+  ASSERT_EQ(counters->Read(common::PerfCounters::kPredictionCacheMisses), 2);
+  ASSERT_EQ(counters->Read(common::PerfCounters::kPredictionCacheHits), 1);
+  ASSERT_NE(sliced.HostVector(), full.HostVector());
+}
+
+TEST(Learner, FuseGradient) {
+  size_t constexpr kRows = 256;
+  int32_t constexpr kIters = 4;
+  auto p_dmat = RandomDataGenerator{kRows, 10, 0.2}.GenerateDMatrix(true);
+  auto& h_labels = p_dmat->Info().labels_.HostVector();
+  for (size_t i = 0; i < h_labels.size(); ++i) {
+    h_labels[i] = i % 3;
+  }
+
+  for (auto objective : {"reg:squarederror", "multi:softprob"}) {
+    std::vector<HostDeviceVector<float>> predts(2);
+    for (size_t i = 0; i < predts.size(); ++i) {
+      std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+      learner->SetParams({{"tree_method", "hist"},
+                          {"objective", objective},
+                          {"fuse_gradient", std::to_string(i)}});
+      if (std::string{objective} == "multi:softprob") {
+        learner->SetParam("num_class", "3");
+      }
+      for (int32_t iter = 0; iter < kIters; ++iter) {
+        learner->UpdateOneIter(iter, p_dmat);
+      }
+      learner->Predict(p_dmat, true, &predts[i], 0, 0);
+    }
+    auto const& expected = predts[0].ConstHostVector();
+    auto const& got = predts[1].ConstHostVector();
+    ASSERT_EQ(got.size(), expected.size());
+    for (size_t i = 0; i < got.size(); ++i) {
+      ASSERT_NEAR(got[i], expected[i], kRtEps);
+    }
+  }
+}
+
 #if defined(XGBOOST_USE_CUDA)
 // Tests for automatic GPU configuration.
 TEST(Learner, GPUConfiguration) {
@@ -426,4 +788,37 @@ TEST(Learner, FeatureInfo) {
     ASSERT_TRUE(std::equal(out_types.begin(), out_types.end(), types.begin()));
   }
 }
+
+TEST(Learner, ReleaseRawData) {
+  size_t constexpr kRows = 256, kCols = 8, kIters = 4;
+  auto train = [&](std::string release, std::shared_ptr<DMatrix> p_dmat) {
+    std::unique_ptr<Learner> learner{Learner::Create({p_dmat})};
+    learner->SetParams(
+        {{"tree_method", "hist"}, {"max_depth", "4"}, {"release_raw_data", release}});
+    for (size_t i = 0; i < kIters; ++i) {
+      learner->UpdateOneIter(i, p_dmat);
+    }
+    // Training continuation predicts the training data without the cache.
+    std::unique_ptr<Learner> loaded{Learner::Create({p_dmat})};
+    Json model{Object()};
+    learner->SaveModel(&model);
+    loaded->LoadModel(model);
+    HostDeviceVector<float> predt;
+    loaded->Predict(p_dmat, false, &predt, 0, 0);
+    return predt.HostVector();
+  };
+
+  auto p_released = RandomDataGenerator{kRows, kCols, 0.2}.Seed(3).GenerateDMatrix(true);
+  auto p_kept = RandomDataGenerator{kRows, kCols, 0.2}.Seed(3).GenerateDMatrix(true);
+  auto released = train("true", p_released);
+  auto kept = train("false", p_kept);
+  ASSERT_FALSE(p_released->PageExists<SparsePage>());
+  ASSERT_TRUE(p_kept->PageExists<SparsePage>());
+  EXPECT_THROW(p_released->GetBatches<SparsePage>(), dmlc::Error);
+
+  ASSERT_EQ(released.size(), kept.size());
+  for (size_t i = 0; i < kept.size(); ++i) {
+    ASSERT_NEAR(released[i], kept[i], kRtEps);
+  }
+}
 }  // namespace xgboost
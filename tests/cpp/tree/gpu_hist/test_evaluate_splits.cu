@@ -262,5 +262,62 @@ TEST(GpuHist, EvaluateSplits) {
   EXPECT_EQ(result_right.findex, 0);
   EXPECT_EQ(result_right.fvalue, 1.0);
 }
+
+TEST(GpuHist, EvaluateSplitsBatch) {
+  GradientPair parent_sum(0.0, 1.0);
+  TrainParam tparam = ZeroParam();
+  GPUTrainingParam param{tparam};
+
+  thrust::device_vector<bst_feature_t> feature_set =
+      std::vector<bst_feature_t>{0, 1};
+  thrust::device_vector<bst_feature_t> feature_set_first =
+      std::vector<bst_feature_t>{0};
+  thrust::device_vector<uint32_t> feature_segments =
+      std::vector<bst_row_t>{0, 2, 4};
+  thrust::device_vector<float> feature_values =
+      std::vector<float>{1.0, 2.0, 11.0, 12.0};
+  thrust::device_vector<float> feature_min_values =
+      std::vector<float>{0.0, 0.0};
+  thrust::device_vector<GradientPair> feature_histogram =
+      std::vector<GradientPair>{
+          {-0.5, 0.5}, {0.5, 0.5}, {-1.0, 0.5}, {1.0, 0.5}};
+
+  auto make_input = [&](bst_node_t nidx, common::Span<bst_feature_t> features) {
+    return EvaluateSplitInputs<GradientPair>{nidx,
+                                             parent_sum,
+                                             param,
+                                             features,
+                                             {},
+                                             dh::ToSpan(feature_segments),
+                                             dh::ToSpan(feature_values),
+                                             dh::ToSpan(feature_min_values),
+                                             dh::ToSpan(feature_histogram)};
+  };
+  // Nodes with different feature sets, including an empty one, in a single launch.
+  std::vector<EvaluateSplitInputs<GradientPair>> inputs{
+      make_input(1, dh::ToSpan(feature_set)), make_input(2, {}),
+      make_input(3, dh::ToSpan(feature_set_first)), make_input(4, dh::ToSpan(feature_set))};
+
+  TreeEvaluator tree_evaluator(tparam, feature_min_values.size(), 0);
+  auto evaluator = tree_evaluator.GetEvaluator<GPUTrainingParam>();
+  thrust::device_vector<DeviceSplitCandidate> out_splits(inputs.size());
+  EvaluateSplits(dh::ToSpan(out_splits), evaluator, inputs);
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    thrust::device_vector<DeviceSplitCandidate> expected(1);
+    EvaluateSingleSplit(dh::ToSpan(expected), evaluator, inputs[i]);
+    DeviceSplitCandidate e = expected[0];
+    DeviceSplitCandidate got = out_splits[i];
+    EXPECT_EQ(got.findex, e.findex);
+    EXPECT_EQ(got.fvalue, e.fvalue);
+    EXPECT_EQ(got.loss_chg, e.loss_chg);
+  }
+  DeviceSplitCandidate empty = out_splits[1];
+  EXPECT_EQ(empty.findex, -1);
+  DeviceSplitCandidate first = out_splits[2];
+  EXPECT_EQ(first.findex, 0);
+  DeviceSplitCandidate last = out_splits[3];
+  EXPECT_EQ(last.findex, 1);
+}
 }  // namespace tree
 }  // namespace xgboost
@@ -44,6 +44,12 @@ void VerifySampling(size_t page_size,
     EXPECT_EQ(sample.sample_rows, kRows);
     EXPECT_EQ(sample.page->n_rows, kRows);
     EXPECT_EQ(sample.gpair.size(), kRows);
+  } else if (!sample.row_index.empty()) {
+    // Sampled rows are indexed in the concatenated page.
+    EXPECT_EQ(sample.row_index.size(), sample.sample_rows);
+    EXPECT_NEAR(sample.sample_rows, sample_rows, kRows * 0.03);
+    EXPECT_EQ(sample.page->n_rows, kRows);
+    EXPECT_EQ(sample.gpair.size(), kRows);
   } else {
     EXPECT_NEAR(sample.sample_rows, sample_rows, kRows * 0.03);
     EXPECT_NEAR(sample.page->n_rows, sample_rows, kRows * 0.03f);
@@ -149,5 +155,42 @@ TEST(GradientBasedSampler, GradientBasedSamplingExternalMemory) {
   VerifySampling(kPageSize, kSubsample, kSamplingMethod, kFixedSizeSampling);
 }
 
+TEST(GradientBasedSampler, GradientBasedIndexSamplingExternalMemory) {
+  constexpr size_t kRows = 2048;
+  constexpr size_t kCols = 1;
+  constexpr float kSubsample = 0.5;
+  constexpr size_t kPageSize = 1024;
+
+  dmlc::TemporaryDirectory tmpdir;
+  std::unique_ptr<DMatrix> dmat(
+      CreateSparsePageDMatrix(kRows, kCols, kRows / kPageSize, tmpdir.path + "/cache"));
+  auto gpair = GenerateRandomGradients(kRows);
+  gpair.SetDevice(0);
+
+  BatchParam param{0, 256};
+  auto page = (*dmat->GetBatches<EllpackPage>(param).begin()).Impl();
+  ASSERT_TRUE(GradientBasedSampler::ConcatenatedPageFits(page, kRows, 0));
+  ExternalMemoryGradientBasedIndexSampling sampling(page, kRows, param, kSubsample);
+
+  // The concatenated page is reused, no compaction between iterations.
+  auto sample = sampling.Sample(gpair.DeviceSpan(), dmat.get());
+  auto concatenated = sample.page;
+  sample = sampling.Sample(gpair.DeviceSpan(), dmat.get());
+  ASSERT_EQ(sample.page, concatenated);
+  ASSERT_EQ(sample.gpair.data(), gpair.DevicePointer());
+
+  std::vector<bst_uint> h_row_index(sample.row_index.size());
+  dh::CopyDeviceSpanToVector(&h_row_index, sample.row_index);
+  auto const& h_gpair = gpair.ConstHostVector();
+  size_t n_sampled = std::count_if(h_gpair.cbegin(), h_gpair.cend(), [](GradientPair gp) {
+    return gp.GetGrad() != 0 || gp.GetHess() != 0;
+  });
+  ASSERT_EQ(h_row_index.size(), n_sampled);
+  ASSERT_TRUE(std::is_sorted(h_row_index.cbegin(), h_row_index.cend()));
+  for (auto ridx : h_row_index) {
+    ASSERT_TRUE(h_gpair[ridx].GetGrad() != 0 || h_gpair[ridx].GetHess() != 0);
+  }
+}
+
 };  // namespace tree
 };  // namespace xgboost
@@ -101,6 +101,62 @@ TEST(Histogram, GPUDeterministic) {
   }
 }
 
+template <typename Gradient>
+void TestBatchedHistogram(bool is_dense) {
+  size_t constexpr kBins = 64, kCols = 8, kRows = 4096, kNodes = 5;
+  float sparsity = is_dense ? 0.0f : 0.5f;
+  auto matrix = RandomDataGenerator(kRows, kCols, sparsity).GenerateDMatrix();
+  BatchParam batch_param{0, static_cast<int32_t>(kBins)};
+  auto gpair = GenerateRandomGradients(kRows);
+  gpair.SetDevice(0);
+  auto rounding = CreateRoundingFactor<Gradient>(gpair.DeviceSpan());
+
+  for (auto const& batch : matrix->GetBatches<EllpackPage>(batch_param)) {
+    auto* page = batch.Impl();
+    FeatureGroups feature_groups(page->Cuts(), page->is_dense, 48 * 1024, sizeof(Gradient));
+    tree::RowPartitioner row_partitioner(0, kRows);
+    auto ridx = row_partitioner.GetRows(0);
+    size_t n_bins = page->Cuts().TotalBins();
+
+    // Uneven segments, including an empty one.
+    std::vector<size_t> ptr{0, 1, 1, 100, 1000, kRows};
+    ASSERT_EQ(ptr.size(), kNodes + 1);
+    dh::device_vector<Gradient> expected(n_bins * kNodes);
+    dh::device_vector<Gradient> batched(n_bins * kNodes);
+    std::vector<HistogramSegment<Gradient>> h_segments(kNodes);
+    for (size_t i = 0; i < kNodes; ++i) {
+      auto node_ridx = ridx.subspan(ptr[i], ptr[i + 1] - ptr[i]);
+      BuildGradientHistogram(page->GetDeviceAccessor(0), feature_groups.DeviceAccessor(0),
+                             gpair.DeviceSpan(), node_ridx,
+                             dh::ToSpan(expected).subspan(i * n_bins, n_bins), rounding);
+      h_segments[i].ridx = node_ridx;
+      h_segments[i].histogram = batched.data().get() + i * n_bins;
+    }
+    dh::device_vector<HistogramSegment<Gradient>> segments(h_segments);
+    BuildGradientHistogram(page->GetDeviceAccessor(0), feature_groups.DeviceAccessor(0),
+                           gpair.DeviceSpan(),
+                           common::Span<HistogramSegment<Gradient> const>{
+                               segments.data().get(), segments.size()},
+                           rounding);
+
+    std::vector<Gradient> h_expected(expected.size());
+    thrust::copy(expected.begin(), expected.end(), h_expected.begin());
+    std::vector<Gradient> h_batched(batched.size());
+    thrust::copy(batched.begin(), batched.end(), h_batched.begin());
+    for (size_t i = 0; i < h_expected.size(); ++i) {
+      ASSERT_EQ(h_expected[i].GetGrad(), h_batched[i].GetGrad());
+      ASSERT_EQ(h_expected[i].GetHess(), h_batched[i].GetHess());
+    }
+  }
+}
+
+TEST(Histogram, GPUBatchedNodes) {
+  for (bool is_dense : {false, true}) {
+    TestBatchedHistogram<GradientPair>(is_dense);
+    TestBatchedHistogram<GradientPairPrecise>(is_dense);
+  }
+}
+
 // Test 1 vs rest categorical histogram is equivalent to one hot encoded data.
 void TestGPUHistogramCategorical(size_t num_categories) {
   size_t constexpr kRows = 340;
@@ -101,6 +101,39 @@ void TestUpdatePosition() {
 
 TEST(RowPartitioner, Basic) { TestUpdatePosition(); }
 
+TEST(RowPartitioner, UpdatePositionAsync) {
+  const int kNumRows = 10;
+  RowPartitioner rp(0, kNumRows);
+  rp.UpdatePosition(0, 1, 2, [=] __device__(RowPartitioner::RowIndexT ridx) {
+    return ridx > 4 ? 1 : 2;
+  });
+  // Split both children before synchronizing.
+  rp.UpdatePositionAsync(1, 3, 4, [=] __device__(RowPartitioner::RowIndexT ridx) {
+    return ridx < 7 ? 3 : 4;
+  });
+  rp.UpdatePositionAsync(2, 5, 6, [=] __device__(RowPartitioner::RowIndexT ridx) {
+    return ridx < 1 ? 5 : 6;
+  });
+  rp.SynchronizePositions();
+  EXPECT_EQ(rp.GetRows(3).size(), 2);
+  EXPECT_EQ(rp.GetRows(4).size(), 3);
+  EXPECT_EQ(rp.GetRows(5).size(), 1);
+  EXPECT_EQ(rp.GetRows(6).size(), 4);
+  EXPECT_EQ(rp.GetPositionHost(), std::vector<bst_node_t>({3, 3, 4, 4, 4, 5, 6, 6, 6, 6}));
+}
+
+TEST(RowPartitioner, SubsetOfRows) {
+  std::vector<RowPartitioner::RowIndexT> h_ridx{1, 4, 5, 8};
+  dh::device_vector<RowPartitioner::RowIndexT> ridx(h_ridx);
+  RowPartitioner rp(0, dh::ToSpan(ridx));
+  EXPECT_EQ(rp.GetRowsHost(0), h_ridx);
+  rp.UpdatePosition(0, 1, 2, [=] __device__(RowPartitioner::RowIndexT ridx) {
+    return ridx > 4 ? 1 : 2;
+  });
+  EXPECT_EQ(rp.GetRowsHost(1), std::vector<RowPartitioner::RowIndexT>({5, 8}));
+  EXPECT_EQ(rp.GetRowsHost(2), std::vector<RowPartitioner::RowIndexT>({1, 4}));
+}
+
 void TestFinalise() {
   const int kNumRows = 10;
   RowPartitioner rp(0, kNumRows);
@@ -0,0 +1,40 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include "../../../../src/tree/driver.h"
+#include "../../../../src/tree/hist/expand_entry.h"
+
+namespace xgboost {
+namespace tree {
+TEST(CPUHistDriver, LossGuideBatch) {
+  Driver<CPUExpandEntry> driver(TrainParam::kLossGuide, 3);
+  EXPECT_TRUE(driver.Pop().empty());
+  driver.Push(CPUExpandEntry{0, 0, 1.0f});
+  auto res = driver.Pop();
+  ASSERT_EQ(res.size(), 1);
+  ASSERT_EQ(res[0].nid, 0);
+
+  driver.Push({CPUExpandEntry{1, 1, 1.0f}, CPUExpandEntry{2, 1, 4.0f},
+               CPUExpandEntry{3, 2, 3.0f}, CPUExpandEntry{4, 2, 2.0f}});
+  // Best entries first.
+  res = driver.Pop();
+  ASSERT_EQ(res.size(), 3);
+  ASSERT_EQ(res[0].nid, 2);
+  ASSERT_EQ(res[1].nid, 3);
+  ASSERT_EQ(res[2].nid, 4);
+  res = driver.Pop();
+  ASSERT_EQ(res.size(), 1);
+  ASSERT_EQ(res[0].nid, 1);
+  ASSERT_TRUE(driver.IsEmpty());
+
+  // Default is strict best first order.
+  Driver<CPUExpandEntry> strict(TrainParam::kLossGuide);
+  strict.Push({CPUExpandEntry{1, 1, 1.0f}, CPUExpandEntry{2, 1, 4.0f}});
+  res = strict.Pop();
+  ASSERT_EQ(res.size(), 1);
+  ASSERT_EQ(res[0].nid, 2);
+}
+}  // namespace tree
+}  // namespace xgboost
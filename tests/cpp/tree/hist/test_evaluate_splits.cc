@@ -31,7 +31,7 @@ template <typename GradientSumT> void TestEvaluateSplits() {
 
   GHistIndexMatrix gmat(dmat.get(), kMaxBins);
   common::RowSetCollection row_set_collection;
-  std::vector<size_t> &row_indices = *row_set_collection.Data();
+  auto &row_indices = *row_set_collection.Data();
   row_indices.resize(kRows);
   std::iota(row_indices.begin(), row_indices.end(), 0);
   row_set_collection.Init();
@@ -86,6 +86,59 @@ TEST(HistEvaluator, Evaluate) {
   TestEvaluateSplits<double>();
 }
 
+TEST(HistEvaluator, FeatureRange) {
+  int static constexpr kRows = 8, kCols = 16;
+  size_t constexpr kMaxBins = 4;
+  TrainParam param;
+  param.UpdateAllowUnknown(Args{{"min_child_weight", "0"}, {"reg_lambda", "0"}});
+  auto dmat = RandomDataGenerator(kRows, kCols, 0).Seed(3).GenerateDMatrix();
+  GHistIndexMatrix gmat(dmat.get(), kMaxBins);
+  std::vector<GradientPair> row_gpairs = {
+      {1.23f, 0.24f}, {0.24f, 0.25f}, {0.26f, 0.27f},  {2.27f, 0.28f},
+      {0.27f, 0.29f}, {0.37f, 0.39f}, {-0.47f, 0.49f}, {0.57f, 0.59f}};
+  common::RowSetCollection row_set_collection;
+  auto &row_indices = *row_set_collection.Data();
+  row_indices.resize(kRows);
+  std::iota(row_indices.begin(), row_indices.end(), 0);
+  row_set_collection.Init();
+
+  common::HistCollection<double> hist;
+  hist.Init(gmat.cut.Ptrs().back());
+  hist.AddHistRow(0);
+  hist.AllocateAllData();
+  GHistBuilder<double>(gmat.cut.Ptrs().back())
+      .BuildHist<false>(row_gpairs, row_set_collection[0], gmat, hist[0]);
+  GradientPairPrecise total_gpair;
+  for (const auto &e : row_gpairs) {
+    total_gpair += GradientPairPrecise(e);
+  }
+
+  RegTree tree;
+  auto evaluate = [&](bst_feature_t begin, bst_feature_t end) {
+    auto evaluator = HistEvaluator<double, CPUExpandEntry>{
+        param, dmat->Info(), 2, std::make_shared<common::ColumnSampler>(),
+        ObjInfo{ObjInfo::kRegression}};
+    if (end != 0) {
+      evaluator.SetFeatureRange(begin, end);
+    }
+    evaluator.InitRoot(GradStats{total_gpair});
+    std::vector<CPUExpandEntry> entries(1);
+    entries.front().nid = 0;
+    entries.front().depth = 0;
+    evaluator.EvaluateSplits(hist, gmat.cut, {}, tree, &entries);
+    return entries.front().split;
+  };
+
+  auto full = evaluate(0, 0);
+  bst_feature_t begin = full.SplitIndex() < kCols / 2 ? kCols / 2 : 0;
+  bst_feature_t end = begin + kCols / 2;
+  // Running as a single worker, the best split comes from the range of this worker.
+  auto partial = evaluate(begin, end);
+  ASSERT_GE(partial.SplitIndex(), begin);
+  ASSERT_LT(partial.SplitIndex(), end);
+  ASSERT_LE(partial.loss_chg, full.loss_chg);
+}
+
 TEST(HistEvaluator, Apply) {
   RegTree tree;
   int static constexpr kNRows = 8, kNCols = 16;
@@ -242,5 +295,269 @@ TEST(HistEvaluator, Categorical) {
 
   ASSERT_EQ(with_onehot.split.loss_chg, with_part.split.loss_chg);
 }
+
+namespace {
+SplitEntry EvaluateHighCardinality(size_t n_cats, std::string max_cat_threshold) {
+  int static constexpr kRows = 1024, kCols = 1;
+  using GradientSumT = double;
+  std::vector<FeatureType> ft(kCols, FeatureType::kCategorical);
+
+  TrainParam param;
+  param.UpdateAllowUnknown(Args{{"min_child_weight", "0"},
+                                {"reg_lambda", "0"},
+                                {"max_cat_threshold", max_cat_threshold}});
+
+  auto dmat =
+      RandomDataGenerator(kRows, kCols, 0).Seed(3).Type(ft).MaxCategory(n_cats).GenerateDMatrix();
+
+  auto sampler = std::make_shared<common::ColumnSampler>();
+  auto evaluator = HistEvaluator<GradientSumT, CPUExpandEntry>{
+      param, dmat->Info(), 4, sampler, ObjInfo{ObjInfo::kRegression}};
+  std::vector<CPUExpandEntry> entries(1);
+
+  for (auto const &gmat : dmat->GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, 64})) {
+    common::HistCollection<GradientSumT> hist;
+
+    entries.front().nid = 0;
+    entries.front().depth = 0;
+
+    hist.Init(gmat.cut.TotalBins());
+    hist.AddHistRow(0);
+    hist.AllocateAllData();
+    auto node_hist = hist[0];
+    CHECK_EQ(node_hist.size(), n_cats);
+
+    GradientPairPrecise total_gpair;
+    for (size_t i = 0; i < node_hist.size(); ++i) {
+      node_hist[i] = {static_cast<double>(node_hist.size() / 2.0 - i), 1.0};
+      total_gpair += node_hist[i];
+    }
+    SimpleLCG lcg;
+    std::shuffle(node_hist.begin(), node_hist.end(), lcg);
+
+    RegTree tree;
+    evaluator.InitRoot(GradStats{total_gpair});
+    evaluator.EvaluateSplits(hist, gmat.cut, ft, tree, &entries);
+  }
+  return entries.front().split;
+}
+}  // anonymous namespace
+
+TEST(HistEvaluator, CategoricalThreshold) {
+  size_t n_cats{32};
+  auto full = EvaluateHighCardinality(n_cats, std::to_string(n_cats));
+  auto limited = EvaluateHighCardinality(n_cats, "4");
+  ASSERT_TRUE(full.is_cat);
+  ASSERT_TRUE(limited.is_cat);
+  ASSERT_GE(full.loss_chg, limited.loss_chg);
+
+  auto n_chosen = [&](SplitEntry const &split) {
+    common::KCatBitField cat_bits{
+        common::Span<uint32_t const>{split.cat_bits.data(), split.cat_bits.size()}};
+    size_t n{0};
+    for (uint32_t c = 0; c < n_cats; ++c) {
+      n += cat_bits.Check(c);
+    }
+    return n;
+  };
+  ASSERT_GT(n_chosen(full), 4ul);
+  ASSERT_LE(n_chosen(limited), 4ul);
+  ASSERT_GE(n_chosen(limited), 1ul);
+}
+
+namespace {
+void TestEvaluateSparseHist(std::string min_child_weight) {
+  int static constexpr kRows = 512, kCols = 2;
+  using GradientSumT = double;
+  // A categorical feature with many categories and a numerical feature.
+  std::vector<FeatureType> ft{FeatureType::kCategorical, FeatureType::kNumerical};
+  TrainParam param;
+  param.UpdateAllowUnknown(Args{{"min_child_weight", min_child_weight}, {"reg_lambda", "0"}});
+
+  auto dmat =
+      RandomDataGenerator(kRows, kCols, 0).Seed(3).Type(ft).MaxCategory(64).GenerateDMatrix();
+  auto sampler = std::make_shared<common::ColumnSampler>();
+  auto evaluator = HistEvaluator<GradientSumT, CPUExpandEntry>{
+      param, dmat->Info(), 4, sampler, ObjInfo{ObjInfo::kRegression}};
+
+  for (auto const &gmat : dmat->GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, 32})) {
+    common::HistCollection<GradientSumT> dense;
+    dense.Init(gmat.cut.TotalBins());
+    dense.AddHistRow(0);
+    dense.AllocateAllData();
+    common::HistCollection<GradientSumT> sparse;
+    sparse.Init(gmat.cut.TotalBins());
+    sparse.AddSparseRow(0);
+    auto &row = sparse.SparseRow(0);
+
+    // Only a few bins have entries, with weights of both signs.
+    GradientPairPrecise total_gpair;
+    auto node_hist = dense[0];
+    for (size_t i = 0; i < node_hist.size(); i += 3) {
+      node_hist[i] = {(i % 2 == 0 ? 1.0 : -1.0) * static_cast<double>(i % 7), 1.0};
+      total_gpair += node_hist[i];
+      row.bins.push_back(i);
+      row.values.push_back(node_hist[i]);
+    }
+    // Some data goes into the missing branch.
+    total_gpair += {1.0, 2.0};
+
+    RegTree tree;
+    evaluator.InitRoot(GradStats{total_gpair});
+    std::vector<CPUExpandEntry> expected(1), got(1);
+    evaluator.EvaluateSplits(dense, gmat.cut, ft, tree, &expected);
+    evaluator.EvaluateSplits(sparse, gmat.cut, ft, tree, &got);
+
+    auto const &l = expected.front().split, &r = got.front().split;
+    ASSERT_EQ(l.loss_chg, r.loss_chg);
+    ASSERT_EQ(l.SplitIndex(), r.SplitIndex());
+    ASSERT_EQ(l.DefaultLeft(), r.DefaultLeft());
+    ASSERT_EQ(l.split_value, r.split_value);
+    ASSERT_EQ(l.is_cat, r.is_cat);
+    ASSERT_EQ(l.cat_bits, r.cat_bits);
+  }
+}
+}  // anonymous namespace
+
+TEST(HistEvaluator, SparseHist) {
+  TestEvaluateSparseHist("0");
+  TestEvaluateSparseHist("1");
+}
+
+namespace {
+// Compare the vectorized scan with a scalar scan over both directions of missing values,
+// for the root and its left child.
+void TestNumericalScan(Args const &args) {
+  size_t constexpr kRows = 256, kCols = 16, kMaxBins = 32;
+  TrainParam param;
+  param.UpdateAllowUnknown(args);
+  auto dmat = RandomDataGenerator(kRows, kCols, 0.4).Seed(3).GenerateDMatrix();
+  GHistIndexMatrix gmat(dmat.get(), kMaxBins);
+  auto gpair = GenerateRandomGradients(kRows, -1.0f, 1.0f);
+  auto &h_gpair = gpair.HostVector();
+  for (auto &g : h_gpair) {
+    g = GradientPair{g.GetGrad(), std::abs(g.GetHess())};
+  }
+  common::RowSetCollection row_set_collection;
+  auto &row_indices = *row_set_collection.Data();
+  row_indices.resize(kRows);
+  std::iota(row_indices.begin(), row_indices.end(), 0);
+  row_set_collection.Init();
+
+  common::HistCollection<double> hist;
+  hist.Init(gmat.cut.Ptrs().back());
+  hist.AddHistRow(0);
+  hist.AddHistRow(1);
+  hist.AllocateAllData();
+  GHistBuilder<double>(gmat.cut.Ptrs().back())
+      .BuildHist<true>(h_gpair, row_set_collection[0], gmat, hist[0]);
+  GradientPairPrecise total_gpair;
+  for (const auto &e : h_gpair) {
+    total_gpair += GradientPairPrecise(e);
+  }
+
+  auto evaluator = HistEvaluator<double, CPUExpandEntry>{
+      param, dmat->Info(), 2, std::make_shared<common::ColumnSampler>(),
+      ObjInfo{ObjInfo::kRegression}};
+  evaluator.InitRoot(GradStats{total_gpair});
+  RegTree tree;
+  auto const &ptrs = gmat.cut.Ptrs();
+  auto const &values = gmat.cut.Values();
+
+  auto check = [&](bst_node_t nidx, CPUExpandEntry const &entry) {
+    auto const &split = entry.split;
+    auto parent = evaluator.Stats().at(nidx).stats;
+    auto root_gain = evaluator.Stats().at(nidx).root_gain;
+    auto loss_chg = [&](bst_feature_t fidx, GradStats const &left, GradStats const &right) {
+      return static_cast<float>(
+          evaluator.Evaluator().CalcSplitGain(param, nidx, fidx, left, right) - root_gain);
+    };
+    auto valid = [&](GradStats const &left, GradStats const &right) {
+      return left.GetHess() >= param.min_child_weight &&
+             right.GetHess() >= param.min_child_weight;
+    };
+    SplitEntry expected;
+    bool has_missing{false};
+    for (bst_feature_t fidx = 0; fidx < kCols; ++fidx) {
+      SplitEntry fwd, bwd;
+      GradStats left, right;
+      for (auto i = ptrs[fidx]; i < ptrs[fidx + 1]; ++i) {
+        left.Add(hist[nidx][i].GetGrad(), hist[nidx][i].GetHess());
+        right.SetSubstract(parent, left);
+        if (valid(left, right)) {
+          fwd.Update(loss_chg(fidx, left, right), fidx, values[i], false, false, left, right);
+        }
+      }
+      expected.Update(fwd);
+      if (left.GetGrad() == parent.GetGrad() && left.GetHess() == parent.GetHess()) {
+        continue;
+      }
+      has_missing = true;
+      right = GradStats{};
+      for (auto i = ptrs[fidx + 1]; i != ptrs[fidx]; --i) {
+        right.Add(hist[nidx][i - 1].GetGrad(), hist[nidx][i - 1].GetHess());
+        left.SetSubstract(parent, right);
+        auto split_pt = i - 1 == ptrs[fidx] ? gmat.cut.MinValues()[fidx] : values[i - 2];
+        if (valid(left, right)) {
+          bwd.Update(loss_chg(fidx, left, right), fidx, split_pt, true, false, left, right);
+        }
+      }
+      expected.Update(bwd);
+    }
+    ASSERT_TRUE(has_missing);
+    ASSERT_GT(expected.loss_chg, 0.0f);
+    ASSERT_EQ(split.loss_chg, expected.loss_chg);
+    ASSERT_EQ(split.sindex, expected.sindex);
+    ASSERT_EQ(split.split_value, expected.split_value);
+    ASSERT_EQ(split.left_sum.GetGrad(), expected.left_sum.GetGrad());
+    ASSERT_EQ(split.left_sum.GetHess(), expected.left_sum.GetHess());
+    ASSERT_EQ(split.right_sum.GetGrad(), expected.right_sum.GetGrad());
+    ASSERT_EQ(split.right_sum.GetHess(), expected.right_sum.GetHess());
+  };
+
+  std::vector<CPUExpandEntry> entries(1);
+  entries.front().nid = 0;
+  entries.front().depth = 0;
+  evaluator.EvaluateSplits(hist, gmat.cut, {}, tree, &entries);
+  check(RegTree::kRoot, entries.front());
+
+  // Evaluate the left child, whose weight is bounded by monotone constraints.
+  auto root = entries.front();
+  evaluator.ApplyTreeSplit(root, &tree);
+  auto fidx = root.split.SplitIndex();
+  std::vector<size_t> left_rows;
+  for (size_t r = 0; r < kRows; ++r) {
+    bool left = root.split.DefaultLeft();
+    for (auto j = gmat.row_ptr[r]; j < gmat.row_ptr[r + 1]; ++j) {
+      auto bin = gmat.index[j];
+      if (bin >= ptrs[fidx] && bin < ptrs[fidx + 1]) {
+        left = values[bin] <= root.split.split_value;
+      }
+    }
+    if (left) {
+      left_rows.push_back(r);
+    }
+  }
+  ASSERT_FALSE(left_rows.empty());
+  GHistBuilder<double>(gmat.cut.Ptrs().back())
+      .BuildHist<true>(h_gpair, {left_rows.data(), left_rows.data() + left_rows.size()}, gmat,
+                       hist[1]);
+  entries.front().nid = tree[RegTree::kRoot].LeftChild();
+  entries.front().depth = 1;
+  entries.front().split = SplitEntry{};
+  evaluator.EvaluateSplits(hist, gmat.cut, {}, tree, &entries);
+  check(1, entries.front());
+}
+}  // anonymous namespace
+
+TEST(HistEvaluator, UnconstrainedScan) {
+  TestNumericalScan(Args{{"min_child_weight", "2"}, {"reg_alpha", "0.1"}});
+}
+
+TEST(HistEvaluator, MonotoneScan) {
+  TestNumericalScan(Args{{"min_child_weight", "2"},
+                         {"reg_alpha", "0.1"},
+                         {"monotone_constraints", "(1,-1,1,-1,1,-1,1,-1,0,0,0,0,1,1,-1,-1)"}});
+}
 }  // namespace tree
 }  // namespace xgboost
@@ -77,7 +77,8 @@ TEST(CPUHistogram, AddRows) {
 }
 
 template <typename GradientSumT>
-void TestSyncHist(bool is_distributed) {
+void TestSyncHist(bool is_distributed, double sparse_sync_ratio = 0,
+                  bool sync_single_precision = false, bool reduce_scatter = false) {
   size_t constexpr kNRows = 8, kNCols = 16;
   int32_t constexpr kMaxBins = 4;
 
@@ -97,12 +98,16 @@ void TestSyncHist(bool is_distributed) {
   HistogramBuilder<GradientSumT, CPUExpandEntry> histogram;
   uint32_t total_bins = gmat.cut.Ptrs().back();
   histogram.Reset(total_bins, {GenericParameter::kCpuId, kMaxBins},
-                  omp_get_max_threads(), 1, is_distributed);
+                  omp_get_max_threads(), 1, is_distributed, 0, 0, sparse_sync_ratio,
+                  sync_single_precision);
+  if (reduce_scatter) {
+    histogram.SetReduceScatter({0, total_bins});
+  }
 
   RowSetCollection row_set_collection_;
   {
     row_set_collection_.Clear();
-    std::vector<size_t> &row_indices = *row_set_collection_.Data();
+    auto &row_indices = *row_set_collection_.Data();
     row_indices.resize(kNRows);
     std::iota(row_indices.begin(), row_indices.end(), 0);
     row_set_collection_.Init();
@@ -244,6 +249,33 @@ TEST(CPUHistogram, SyncHist) {
   TestSyncHist<double>(false);
 }
 
+TEST(CPUHistogram, SyncHistCompressed) {
+  // Values in the test are small integers, exact in single precision.
+  TestSyncHist<double>(true, 2.0, false);
+  TestSyncHist<double>(true, 2.0, true);
+  TestSyncHist<double>(true, 0, true);
+  TestSyncHist<float>(true, 2.0, false);
+}
+
+TEST(CPUHistogram, SyncHistReduceScatter) {
+  TestSyncHist<float>(true, 0, false, true);
+  TestSyncHist<double>(true, 0, false, true);
+}
+
+TEST(CPUHistogram, PartitionFeatures) {
+  std::vector<uint32_t> cut_ptrs{0, 4, 8, 9, 10, 16, 20};
+  auto feature_ptr = PartitionFeatures(cut_ptrs, 2);
+  ASSERT_EQ(feature_ptr, (std::vector<bst_feature_t>{0, 4, 6}));
+  feature_ptr = PartitionFeatures(cut_ptrs, 1);
+  ASSERT_EQ(feature_ptr, (std::vector<bst_feature_t>{0, 6}));
+  // More workers than features, some workers own no feature.
+  feature_ptr = PartitionFeatures(cut_ptrs, 8);
+  ASSERT_EQ(feature_ptr.size(), 9ul);
+  ASSERT_EQ(feature_ptr.front(), 0u);
+  ASSERT_EQ(feature_ptr.back(), 6u);
+  ASSERT_TRUE(std::is_sorted(feature_ptr.cbegin(), feature_ptr.cend()));
+}
+
 template <typename GradientSumT>
 void TestBuildHistogram(bool is_distributed) {
   size_t constexpr kNRows = 8, kNCols = 16;
@@ -270,7 +302,7 @@ void TestBuildHistogram(bool is_distributed) {
 
   RowSetCollection row_set_collection;
   row_set_collection.Clear();
-  std::vector<size_t> &row_indices = *row_set_collection.Data();
+  auto &row_indices = *row_set_collection.Data();
   row_indices.resize(kNRows);
   std::iota(row_indices.begin(), row_indices.end(), 0);
   row_set_collection.Init();
@@ -333,7 +365,7 @@ void TestHistogramCategorical(size_t n_categories) {
 
   RowSetCollection row_set_collection;
   row_set_collection.Clear();
-  std::vector<size_t> &row_indices = *row_set_collection.Data();
+  auto &row_indices = *row_set_collection.Data();
   row_indices.resize(kRows);
   std::iota(row_indices.begin(), row_indices.end(), 0);
   row_set_collection.Init();
@@ -379,6 +411,275 @@ TEST(CPUHistogram, Categorical) {
   }
 }
 
+namespace {
+template <typename GradientSumT>
+void TestColumnWiseHistogram(double sparse_threshold) {
+  size_t constexpr kRows = 256, kCols = 32, kLeft = 100;
+  int32_t constexpr kBins = 16;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0.7).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, -1, 1);
+  auto const &h_gpair = gpair.HostVector();
+
+  RegTree tree;
+  tree.ExpandNode(RegTree::kRoot, 0, 0.5f, true, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  std::vector<CPUExpandEntry> nodes;
+  nodes.emplace_back(tree[RegTree::kRoot].LeftChild(), tree.GetDepth(1), 0.0f);
+  nodes.emplace_back(tree[RegTree::kRoot].RightChild(), tree.GetDepth(2), 0.0f);
+
+  RowSetCollection row_set_collection;
+  InitRowPartitionForTest(&row_set_collection, kRows);
+  auto &row_indices = *row_set_collection.Data();
+  std::shuffle(row_indices.begin(), row_indices.end(), std::mt19937{0});
+  row_set_collection.AddSplit(RegTree::kRoot, nodes[0].nid, nodes[1].nid, kLeft, kRows - kLeft);
+
+  for (auto const &gidx :
+       p_fmat->GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, kBins})) {
+    ASSERT_FALSE(gidx.IsDense());
+    common::ColumnMatrix columns;
+    columns.Init(gidx, sparse_threshold);
+    auto total_bins = gidx.cut.TotalBins();
+
+    HistogramBuilder<GradientSumT, CPUExpandEntry> row_wise;
+    row_wise.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1,
+                   false);
+    row_wise.BuildHist(0, gidx, &tree, row_set_collection, nodes, {}, h_gpair);
+
+    HistogramBuilder<GradientSumT, CPUExpandEntry> column_wise;
+    column_wise.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1,
+                      false);
+    int starting_index = std::numeric_limits<int>::max();
+    int sync_count = 0;
+    column_wise.AddHistRows(&starting_index, &sync_count, nodes, {}, &tree);
+    column_wise.BuildLocalHistogramsColumnWise(columns, nodes, row_set_collection, h_gpair);
+
+    for (auto const &node : nodes) {
+      auto expected = row_wise.Histogram()[node.nid];
+      auto got = column_wise.Histogram()[node.nid];
+      ASSERT_EQ(expected.size(), got.size());
+      for (size_t i = 0; i < got.size(); ++i) {
+        ASSERT_NEAR(got[i].GetGrad(), expected[i].GetGrad(), kRtEps);
+        ASSERT_NEAR(got[i].GetHess(), expected[i].GetHess(), kRtEps);
+      }
+    }
+  }
+}
+}  // anonymous namespace
+
+TEST(CPUHistogram, ColumnWise) {
+  // All dense columns, mixed and all sparse columns.
+  for (double sparse_threshold : {0.0, 0.3, 1.0}) {
+    TestColumnWiseHistogram<float>(sparse_threshold);
+    TestColumnWiseHistogram<double>(sparse_threshold);
+  }
+}
+
+namespace {
+template <typename GradientSumT>
+void TestNodeSweepHistogram(float sparsity) {
+  size_t constexpr kRows = 5000, kCols = 8;
+  int32_t constexpr kBins = 16;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, sparsity).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, -1, 1);
+  auto const &h_gpair = gpair.HostVector();
+
+  RegTree tree;
+  tree.ExpandNode(RegTree::kRoot, 0, 0.5f, true, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  std::vector<CPUExpandEntry> nodes;
+  nodes.emplace_back(tree[RegTree::kRoot].LeftChild(), tree.GetDepth(1), 0.0f);
+  nodes.emplace_back(tree[RegTree::kRoot].RightChild(), tree.GetDepth(2), 0.0f);
+
+  RowSetCollection row_set_collection;
+  InitRowPartitionForTest(&row_set_collection, kRows);
+  auto &row_indices = *row_set_collection.Data();
+  std::shuffle(row_indices.begin(), row_indices.end(), std::mt19937{0});
+  // Rows of each node are sorted, as produced by partitioning.
+  size_t constexpr kLeft = 1800;
+  std::sort(row_indices.begin(), row_indices.begin() + kLeft);
+  std::sort(row_indices.begin() + kLeft, row_indices.end());
+  row_set_collection.AddSplit(RegTree::kRoot, nodes[0].nid, nodes[1].nid, kLeft, kRows - kLeft);
+
+  auto const &gidx = *(p_fmat->GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, kBins})
+                           .begin());
+  auto total_bins = gidx.cut.TotalBins();
+  HistogramBuilder<GradientSumT, CPUExpandEntry> row_wise;
+  row_wise.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1, false);
+  row_wise.BuildHist(0, gidx, &tree, row_set_collection, nodes, {}, h_gpair);
+
+  HistogramBuilder<GradientSumT, CPUExpandEntry> sweep;
+  sweep.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1, false, 0,
+              0, 0, false, 0.5);
+  ASSERT_TRUE(sweep.UseNodeSweep(gidx, nodes, row_set_collection));
+  sweep.BuildHist(0, gidx, &tree, row_set_collection, nodes, {}, h_gpair);
+
+  for (auto const &node : nodes) {
+    auto expected = row_wise.Histogram()[node.nid];
+    auto got = sweep.Histogram()[node.nid];
+    ASSERT_EQ(expected.size(), got.size());
+    for (size_t i = 0; i < got.size(); ++i) {
+      ASSERT_NEAR(got[i].GetGrad(), expected[i].GetGrad(), 1e-3);
+      ASSERT_NEAR(got[i].GetHess(), expected[i].GetHess(), 1e-3);
+    }
+  }
+
+  // A single node is built by gathering its rows.
+  std::vector<CPUExpandEntry> left{nodes.front()};
+  ASSERT_FALSE(sweep.UseNodeSweep(gidx, left, row_set_collection));
+}
+}  // anonymous namespace
+
+TEST(CPUHistogram, NodeSweep) {
+  for (float sparsity : {0.0f, 0.4f}) {
+    TestNodeSweepHistogram<float>(sparsity);
+    TestNodeSweepHistogram<double>(sparsity);
+  }
+}
+
+TEST(CPUHistogram, BoundedCache) {
+  size_t constexpr kRows = 64, kCols = 4;
+  int32_t constexpr kBins = 8;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, 0.0).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, -1, 1);
+  auto const &h_gpair = gpair.HostVector();
+  auto const &gidx = *(p_fmat->GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, kBins})
+                           .begin());
+  auto total_bins = gidx.cut.TotalBins();
+  // Room for 4 histograms.
+  size_t budget = total_bins * sizeof(GradientPairPrecise) * 4;
+
+  HistogramBuilder<double, CPUExpandEntry> unbounded;
+  unbounded.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1,
+                  false);
+  HistogramBuilder<double, CPUExpandEntry> bounded;
+  bounded.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1, false,
+                budget);
+
+  RegTree tree;
+  RowSetCollection row_set_collection;
+  InitRowPartitionForTest(&row_set_collection, kRows);
+
+  auto build = [&](std::vector<CPUExpandEntry> const &nodes_to_build,
+                   std::vector<CPUExpandEntry> const &nodes_to_sub) {
+    unbounded.BuildHist(0, gidx, &tree, row_set_collection, nodes_to_build, nodes_to_sub,
+                        h_gpair);
+    bounded.BuildHist(0, gidx, &tree, row_set_collection, nodes_to_build, nodes_to_sub,
+                      h_gpair);
+    ASSERT_LE(bounded.Histogram().AllocatedRows(), 4);
+    for (auto const &nodes : {nodes_to_build, nodes_to_sub}) {
+      for (auto const &node : nodes) {
+        auto expected = unbounded.Histogram()[node.nid];
+        auto got = bounded.Histogram()[node.nid];
+        for (size_t i = 0; i < got.size(); ++i) {
+          ASSERT_NEAR(got[i].GetGrad(), expected[i].GetGrad(), kRtEps);
+          ASSERT_NEAR(got[i].GetHess(), expected[i].GetHess(), kRtEps);
+        }
+      }
+    }
+  };
+  auto split = [&](bst_node_t nidx, size_t n_left) {
+    tree.ExpandNode(nidx, 0, 0.5f, true, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    auto n_right = row_set_collection[nidx].Size() - n_left;
+    row_set_collection.AddSplit(nidx, tree[nidx].LeftChild(), tree[nidx].RightChild(), n_left,
+                                n_right);
+    build({{tree[nidx].LeftChild(), tree.GetDepth(tree[nidx].LeftChild()), 0.0f}},
+          {{tree[nidx].RightChild(), tree.GetDepth(tree[nidx].RightChild()), 0.0f}});
+  };
+
+  build({{RegTree::kRoot, 0, 0.0f}}, {});
+  split(RegTree::kRoot, 30);
+  ASSERT_FALSE(bounded.Evicted());
+  // Reuses the histogram of root.
+  split(tree[RegTree::kRoot].LeftChild(), 10);
+  ASSERT_FALSE(bounded.Evicted());
+  // Exceeds the budget.
+  split(tree[RegTree::kRoot].RightChild(), 20);
+  ASSERT_TRUE(bounded.Evicted());
+  // Parent was built in last round.
+  split(tree[tree[RegTree::kRoot].RightChild()].LeftChild(), 5);
+  ASSERT_FALSE(bounded.Evicted());
+  // Parent was evicted.
+  split(tree[tree[RegTree::kRoot].LeftChild()].LeftChild(), 4);
+  ASSERT_TRUE(bounded.Evicted());
+  ASSERT_FALSE(unbounded.Evicted());
+}
+
+namespace {
+void TestSparseHistogram(float sparsity) {
+  size_t constexpr kRows = 64, kCols = 4;
+  int32_t constexpr kBins = 8;
+  auto p_fmat = RandomDataGenerator(kRows, kCols, sparsity).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, -1, 1);
+  auto const &h_gpair = gpair.HostVector();
+  auto const &gidx = *(p_fmat->GetBatches<GHistIndexMatrix>({GenericParameter::kCpuId, kBins})
+                           .begin());
+  auto total_bins = gidx.cut.TotalBins();
+  // Nodes with less than 15 rows are sparse.
+  double entries_per_row = static_cast<double>(gidx.row_ptr.back()) / kRows;
+  double ratio = 15.0 * entries_per_row / static_cast<double>(total_bins);
+
+  HistogramBuilder<double, CPUExpandEntry> dense;
+  dense.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1, false);
+  HistogramBuilder<double, CPUExpandEntry> sparse;
+  sparse.Reset(total_bins, {GenericParameter::kCpuId, kBins}, omp_get_max_threads(), 1, false, 0,
+               ratio);
+
+  RegTree tree;
+  RowSetCollection row_set_collection;
+  InitRowPartitionForTest(&row_set_collection, kRows);
+
+  auto check = [&](bst_node_t nidx, bool is_sparse) {
+    auto const &hist = sparse.Histogram();
+    ASSERT_EQ(hist.IsSparse(nidx), is_sparse);
+    ASSERT_EQ(hist.RowExists(nidx), !is_sparse);
+    std::vector<GradientPairPrecise> got(total_bins);
+    if (is_sparse) {
+      auto const &row = hist.SparseRow(nidx);
+      ASSERT_TRUE(std::is_sorted(row.bins.cbegin(), row.bins.cend()));
+      for (size_t k = 0; k < row.Size(); ++k) {
+        got[row.bins[k]] = row.values[k];
+      }
+    } else {
+      auto row = hist[nidx];
+      std::copy(row.cbegin(), row.cend(), got.begin());
+    }
+    auto expected = dense.Histogram()[nidx];
+    for (size_t i = 0; i < got.size(); ++i) {
+      ASSERT_NEAR(got[i].GetGrad(), expected[i].GetGrad(), kRtEps);
+      ASSERT_NEAR(got[i].GetHess(), expected[i].GetHess(), kRtEps);
+    }
+  };
+  auto split = [&](bst_node_t nidx, size_t n_left, bool left_sparse, bool right_sparse) {
+    tree.ExpandNode(nidx, 0, 0.5f, true, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    auto left = tree[nidx].LeftChild(), right = tree[nidx].RightChild();
+    auto n_right = row_set_collection[nidx].Size() - n_left;
+    row_set_collection.AddSplit(nidx, left, right, n_left, n_right);
+    std::vector<CPUExpandEntry> nodes_to_build{{left, tree.GetDepth(left), 0.0f}};
+    std::vector<CPUExpandEntry> nodes_to_sub{{right, tree.GetDepth(right), 0.0f}};
+    for (auto *builder : {&dense, &sparse}) {
+      builder->BuildHist(0, gidx, &tree, row_set_collection, nodes_to_build, nodes_to_sub,
+                         h_gpair);
+    }
+    check(left, left_sparse);
+    check(right, right_sparse);
+  };
+
+  for (auto *builder : {&dense, &sparse}) {
+    builder->BuildHist(0, gidx, &tree, row_set_collection, {{RegTree::kRoot, 0, 0.0f}}, {},
+                       h_gpair);
+  }
+  check(RegTree::kRoot, false);
+  split(RegTree::kRoot, 30, false, false);
+  // Sibling of sparse node with dense parent is dense.
+  split(tree[RegTree::kRoot].LeftChild(), 10, true, false);
+  // Both children of sparse node are sparse.
+  split(tree[tree[RegTree::kRoot].LeftChild()].LeftChild(), 4, true, true);
+}
+}  // anonymous namespace
+
+TEST(CPUHistogram, Sparse) {
+  TestSparseHistogram(0.0);
+  TestSparseHistogram(0.4);
+}
+
 TEST(CPUHistogram, ExternalMemory) {
   size_t constexpr kEntries = 1 << 16;
   int32_t constexpr kBins = 32;
@@ -0,0 +1,86 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "../../../../src/common/random.h"
+#include "../../../../src/tree/hist/quantizer.h"
+#include "../../helpers.h"
+
+namespace xgboost {
+namespace tree {
+TEST(GradientQuantizer, Basic) {
+  size_t constexpr kRows = 1000;
+  auto gpair = GenerateRandomGradients(kRows, -3.0f, 3.0f).HostVector();
+  GradientQuantizer quantizer{gpair, 4};
+  auto unit = quantizer.Unit();
+  for (auto u : {unit.GetGrad(), unit.GetHess()}) {
+    int32_t exp;
+    // Power of 2.
+    ASSERT_EQ(std::frexp(u, &exp), 0.5);
+  }
+
+  auto quantized = gpair;
+  quantizer.Quantize(&quantized, 4);
+  for (size_t i = 0; i < kRows; ++i) {
+    auto q = quantized[i];
+    ASSERT_EQ(q.GetGrad(), std::round(q.GetGrad()));
+    ASSERT_LE(std::abs(q.GetGrad()), GradientQuantizer::kMaxValue);
+    ASSERT_LE(std::abs(q.GetHess()), GradientQuantizer::kMaxValue);
+    auto restored = quantizer.ToFloatingPoint(q);
+    ASSERT_LE(std::abs(restored.GetGrad() - gpair[i].GetGrad()), unit.GetGrad() / 2);
+    ASSERT_LE(std::abs(restored.GetHess() - gpair[i].GetHess()), unit.GetHess() / 2);
+  }
+
+  // The default quantizer doesn't change floating point histograms.
+  GradientQuantizer identity;
+  detail::GradientPairInternal<double> sum{0.3, 0.7};
+  ASSERT_EQ(identity.ToFloatingPoint(sum).GetGrad(), 0.3);
+  ASSERT_EQ(identity.ToFloatingPoint(sum).GetHess(), 0.7);
+}
+
+TEST(GradientRounding, Basic) {
+  size_t constexpr kRows = 4096;
+  auto gpair = GenerateRandomGradients(kRows, -3.0f, 3.0f).HostVector();
+  // Values spanning many orders of magnitude.
+  for (size_t i = 0; i < kRows; i += 3) {
+    gpair[i] = GradientPair{gpair[i].GetGrad() * 1e-9f, gpair[i].GetHess() * 1e-9f};
+  }
+  GradientRounding rounding{gpair, 4};
+  ASSERT_GT(rounding.Unit().GetGrad(), 0.0);
+
+  auto rounded = gpair;
+  rounding.Round(&rounded, 4);
+  double total = 0;
+  for (auto const &g : gpair) {
+    total += std::abs(g.GetGrad());
+  }
+  for (size_t i = 0; i < kRows; ++i) {
+    auto g = rounded[i].GetGrad();
+    ASSERT_EQ(g / rounding.Unit().GetGrad(), std::round(g / rounding.Unit().GetGrad()));
+    ASSERT_LE(std::abs(g - gpair[i].GetGrad()), total * std::ldexp(1.0, -52));
+  }
+
+  // Sums in any order are the same.
+  auto sum = [&](std::vector<size_t> const &order) {
+    double s = 0;
+    for (auto i : order) {
+      s += rounded[i].GetGrad();
+    }
+    return s;
+  };
+  std::vector<size_t> order(kRows);
+  std::iota(order.begin(), order.end(), 0);
+  auto forward = sum(order);
+  std::reverse(order.begin(), order.end());
+  ASSERT_EQ(sum(order), forward);
+  std::shuffle(order.begin(), order.end(), common::GlobalRandom());
+  ASSERT_EQ(sum(order), forward);
+}
+}  // namespace tree
+}  // namespace xgboost
@@ -0,0 +1,73 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../../../src/common/io.h"
+#include "../../../src/tree/compact_tree.h"
+#include "../helpers.h"
+
+namespace xgboost {
+TEST(CompactTree, Half) {
+  for (float v : {0.0f, 1.0f, -2.5f, 0.1f, 65504.0f, 6.1035156e-05f, 5.9604645e-08f}) {
+    ASSERT_NEAR(HalfToFloat(FloatToHalf(v)), v, std::abs(v) / 1024.0f);
+  }
+  ASSERT_EQ(FloatToHalf(1.0f), 0x3c00);
+  ASSERT_EQ(FloatToHalf(-2.0f), 0xc000);
+  // Round to nearest even.
+  ASSERT_EQ(FloatToHalf(1.0f + 1.0f / 2048.0f), 0x3c00);
+  ASSERT_EQ(FloatToHalf(1.0f + 3.0f / 2048.0f), 0x3c02);
+  ASSERT_TRUE(std::isinf(HalfToFloat(FloatToHalf(1e6f))));
+  ASSERT_TRUE(std::isnan(HalfToFloat(FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(CompactTree, IO) {
+  bst_feature_t constexpr kCols = 4;
+  std::vector<RegTree> trees(2);
+  trees[0].ExpandNode(0, 1, 0.5f, true, 0.0f, 0.3f, -0.7f, 0.0f, 10.0f, 6.0f, 4.0f);
+  trees[0].ExpandNode(trees[0][0].LeftChild(), 3, 1.5f, false, 0.0f, 1.2f, 0.01f, 0.0f, 6.0f,
+                      2.0f, 4.0f);
+  trees[1].ExpandNode(0, 1, 0.5f, false, 0.0f, -0.2f, 0.4f, 0.0f, 10.0f, 5.0f, 5.0f);
+
+  for (auto type : {"fp16", "int8"}) {
+    std::string buffer;
+    common::MemoryBufferStream fo(&buffer);
+    auto error_bound = SaveCompactTrees(trees, kCols, ParseCompactLeafType(type), &fo);
+
+    common::MemoryFixSizeBuffer fi(&buffer[0], buffer.size());
+    std::vector<RegTree> loaded;
+    ASSERT_EQ(LoadCompactTrees(&fi, &loaded), error_bound);
+    ASSERT_EQ(loaded.size(), trees.size());
+
+    double max_error = 0;
+    for (size_t i = 0; i < trees.size(); ++i) {
+      auto const& tree = trees[i];
+      auto const& got = loaded[i];
+      ASSERT_EQ(got.GetNumLeaves(), tree.GetNumLeaves());
+      double tree_error = 0;
+      tree.WalkTree([&](bst_node_t nidx) {
+        auto const& node = tree[nidx];
+        auto const& node_got = got[nidx];
+        EXPECT_EQ(node.IsLeaf(), node_got.IsLeaf());
+        if (node.IsLeaf()) {
+          tree_error = std::max(
+              tree_error, static_cast<double>(std::abs(node.LeafValue() - node_got.LeafValue())));
+        } else {
+          EXPECT_EQ(node.SplitIndex(), node_got.SplitIndex());
+          EXPECT_EQ(node.SplitCond(), node_got.SplitCond());
+          EXPECT_EQ(node.DefaultLeft(), node_got.DefaultLeft());
+        }
+        return true;
+      });
+      max_error += tree_error;
+    }
+    ASSERT_LE(max_error, error_bound + kRtEps);
+    ASSERT_LT(error_bound, 0.02);
+  }
+}
+}  // namespace xgboost
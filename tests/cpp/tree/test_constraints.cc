@@ -3,6 +3,7 @@
 #include <xgboost/logging.h>
 
 #include <memory>
+#include <set>
 #include <string>
 
 #include "../../../src/tree/constraints.h"
@@ -56,5 +57,38 @@ TEST(CPUFeatureInteractionConstraint, Basic) {
   ASSERT_FALSE(constraints.Query(1, 5));
 }
 
+TEST(CPUFeatureInteractionConstraint, MultipleWords) {
+  std::string const constraints_str = R"constraint([[0, 70, 129], [70, 100]])constraint";
+  TrainParam param;
+  param.interaction_constraints = constraints_str;
+  bst_feature_t constexpr kFeatures = 130;
+
+  FeatureInteractionConstraintHost constraints;
+  constraints.Configure(param, kFeatures);
+  for (bst_feature_t f = 0; f < kFeatures; ++f) {
+    ASSERT_TRUE(constraints.Query(0, f));
+  }
+  ASSERT_FALSE(constraints.Query(0, kFeatures));
+
+  auto check = [&](bst_node_t nid, std::set<bst_feature_t> const &expected) {
+    for (bst_feature_t f = 0; f < kFeatures; ++f) {
+      ASSERT_EQ(constraints.Query(nid, f), expected.find(f) != expected.cend()) << f;
+    }
+  };
+  constraints.Split(/*node_id=*/0, /*feature_id=*/70, /*left_id=*/1, /*right_id=*/2);
+  check(1, {0, 70, 100, 129});
+  check(2, {0, 70, 100, 129});
+
+  constraints.Split(/*node_id=*/1, /*feature_id=*/129, /*left_id=*/3, /*right_id=*/4);
+  check(3, {0, 70, 129});
+  constraints.Split(/*node_id=*/2, /*feature_id=*/100, /*left_id=*/5, /*right_id=*/6);
+  check(6, {70, 100});
+  // No constraint contains all used features, only the used features are allowed.
+  constraints.Split(/*node_id=*/5, /*feature_id=*/3, /*left_id=*/7, /*right_id=*/8);
+  check(8, {3, 70, 100});
+  // Records of existing nodes are kept.
+  check(4, {0, 70, 129});
+}
+
 }  // namespace tree
 }  // namespace xgboost
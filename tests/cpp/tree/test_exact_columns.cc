@@ -0,0 +1,47 @@
+/*!
+ * Copyright 2021 by XGBoost Contributors
+ */
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "../../../src/tree/exact_columns.h"
+#include "../helpers.h"
+
+namespace xgboost {
+namespace tree {
+TEST(ExactColumns, Init) {
+  size_t constexpr kRows = 64, kCols = 8;
+  // few distinct values in each column, with missing values.
+  std::vector<float> x(kRows * kCols);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = i % 7 == 0 ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(i % 5);
+  }
+  auto p_fmat = GetDMatrixFromData(x, kRows, kCols);
+  ExactColumns columns;
+  ASSERT_FALSE(columns.Matches(p_fmat->Info()));
+  columns.Init(p_fmat.get(), 2);
+  ASSERT_TRUE(columns.Matches(p_fmat->Info()));
+  ASSERT_EQ(columns.NumFeatures(), kCols);
+
+  for (auto const &batch : p_fmat->GetBatches<SortedCSCPage>()) {
+    auto page = batch.GetView();
+    for (bst_feature_t f = 0; f < kCols; ++f) {
+      auto expected = page[f];
+      auto col = columns[f];
+      ASSERT_EQ(col.entries.size(), expected.size());
+      ASSERT_LT(col.values.size(), expected.size());
+      uint32_t rank = ExactColumns::kInvalidRank;
+      for (size_t i = 0; i < expected.size(); ++i) {
+        auto entry = col.entries[i];
+        rank += entry >> 31;
+        ASSERT_EQ(entry & ExactColumns::kRowMask, expected[i].index);
+        ASSERT_EQ(col.values[rank], expected[i].fvalue);
+      }
+      ASSERT_EQ(rank + 1, col.values.size());
+    }
+  }
+}
+}  // namespace tree
+}  // namespace xgboost
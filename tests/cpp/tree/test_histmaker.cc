@@ -65,5 +65,51 @@ TEST(GrowHistMaker, InteractionConstraint) {
   }
 }
 
+TEST(GrowHistMaker, ReuseSketch) {
+  size_t constexpr kRows = 2048;
+  size_t constexpr kCols = 8;
+  GenericParameter param;
+  param.UpdateAllowUnknown(Args{});
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0.0f}.Seed(3).GenerateDMatrix();
+
+  auto first = GenerateRandomGradients(kRows, 0.0f, 1.0f);
+  // Same hessian, different gradient.
+  HostDeviceVector<GradientPair> same_hess(kRows);
+  // Hessian concentrated on a few rows.
+  HostDeviceVector<GradientPair> skewed(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    auto g = first.HostVector()[i];
+    same_hess.HostVector()[i] = GradientPair{1.0f - 2.0f * g.GetGrad(), g.GetHess()};
+    skewed.HostVector()[i] =
+        GradientPair{first.HostVector()[i].GetGrad(), i % 16 == 0 ? 1.0f : 1e-3f};
+  }
+
+  auto train = [&](Args args, HostDeviceVector<GradientPair> *second) {
+    args.emplace_back("sketch_eps", "0.1");
+    args.emplace_back("max_depth", "3");
+    std::unique_ptr<TreeUpdater> updater{
+        TreeUpdater::Create("grow_histmaker", &param, ObjInfo{ObjInfo::kRegression})};
+    updater->Configure(args);
+    std::vector<RegTree> trees(2);
+    for (auto &tree : trees) {
+      tree.param.num_feature = kCols;
+    }
+    updater->Update(&first, p_dmat.get(), {&trees[0]});
+    updater->Update(second, p_dmat.get(), {&trees[1]});
+    Json model{Object()};
+    trees[1].SaveModel(&model);
+    return model;
+  };
+
+  // Cuts depend only on hessian.
+  ASSERT_EQ(train({{"sketch_refresh_interval", "4"}}, &same_hess), train({}, &same_hess));
+  // Reusing cuts proposed with a different hessian.
+  auto fresh = train({}, &skewed);
+  ASSERT_FALSE(train({{"sketch_refresh_interval", "4"}}, &skewed) == fresh);
+  // Hessian drift triggers a new sketch.
+  ASSERT_EQ(train({{"sketch_refresh_interval", "4"}, {"sketch_refresh_drift", "0.5"}}, &skewed),
+            fresh);
+}
+
 }  // namespace tree
 }  // namespace xgboost
@@ -10,6 +10,7 @@
 #include <string>
 
 #include "../helpers.h"
+#include "../../../src/common/random.h"
 #include "../../../src/tree/param.h"
 #include "../../../src/tree/updater_quantile_hist.h"
 #include "../../../src/tree/split_evaluator.h"
@@ -117,10 +118,11 @@ class QuantileHistMock : public QuantileHistMaker {
       auto initial_rnd = common::GlobalRandom();
       std::vector<size_t> unused_rows_cpy = this->unused_rows_;
       RealImpl::InitData(gmat, *p_fmat, tree, gpair);
-      std::vector<size_t> row_indices_initial = *(this->row_set_collection_.Data());
+      auto const& row_indices_data = *(this->row_set_collection_.Data());
+      std::vector<size_t> row_indices_initial(row_indices_data.cbegin(), row_indices_data.cend());
       std::vector<size_t> unused_row_indices_initial = this->unused_rows_;
       ASSERT_EQ(row_indices_initial.size(), p_fmat->Info().num_row_);
-      auto check_each_row_occurs_in_one_of_arrays = [](const std::vector<size_t>& first,
+      auto check_each_row_occurs_in_one_of_arrays = [](auto const& first,
                                                        const std::vector<size_t>& second,
                                                        size_t nrows) {
         ASSERT_EQ(first.size(), nrows);
@@ -135,7 +137,7 @@ class QuantileHistMock : public QuantileHistMaker {
         common::GlobalRandom() = initial_rnd;
         this->unused_rows_ = unused_rows_cpy;
         RealImpl::InitData(gmat, *p_fmat, tree, gpair);
-        std::vector<size_t>& row_indices = *(this->row_set_collection_.Data());
+        auto& row_indices = *(this->row_set_collection_.Data());
         ASSERT_EQ(row_indices_initial.size(), row_indices.size());
         for (size_t i = 0; i < row_indices_initial.size(); ++i) {
           ASSERT_EQ(row_indices_initial[i], row_indices[i]);
@@ -151,6 +153,39 @@ class QuantileHistMock : public QuantileHistMaker {
       omp_set_num_threads(nthreads);
     }
 
+    void TestGradientBasedSampling(const GHistIndexMatrix& gmat,
+                                   std::vector<GradientPair>* gpair,
+                                   DMatrix* p_fmat,
+                                   const RegTree& tree) {
+      auto h_gpair = *gpair;
+      RealImpl::InitData(gmat, *p_fmat, tree, gpair);
+      auto const& row_indices = *(this->row_set_collection_.Data());
+      auto const& unused = this->unused_rows_;
+      const size_t num_row = p_fmat->Info().num_row_;
+      ASSERT_EQ(row_indices.size() + unused.size(), num_row);
+      std::vector<size_t> all(row_indices.cbegin(), row_indices.cend());
+      all.insert(all.end(), unused.cbegin(), unused.cend());
+      std::sort(all.begin(), all.end());
+      for (size_t i = 0; i < num_row; ++i) {
+        ASSERT_EQ(all[i], i);
+      }
+      // Half of the 4 sampled rows are the ones with largest absolute gradient, the others
+      // are sampled from the remaining 6 rows with gradient amplified by 3.
+      ASSERT_GE(row_indices.size(), 2);
+      for (auto ridx : row_indices) {
+        if (ridx >= num_row - 2) {
+          ASSERT_EQ((*gpair)[ridx], h_gpair[ridx]);
+        } else {
+          ASSERT_NEAR((*gpair)[ridx].GetGrad(), h_gpair[ridx].GetGrad() * 3.0f, kRtEps);
+          ASSERT_NEAR((*gpair)[ridx].GetHess(), h_gpair[ridx].GetHess() * 3.0f, kRtEps);
+        }
+      }
+      ASSERT_TRUE(std::is_sorted(row_indices.cbegin(), row_indices.cend()));
+      ASSERT_EQ(std::count_if(row_indices.cbegin(), row_indices.cend(),
+                              [&](size_t ridx) { return ridx >= num_row - 2; }),
+                2);
+    }
+
     void TestApplySplit(const RegTree& tree) {
       std::vector<GradientPair> row_gpairs =
           { {1.23f, 0.24f}, {0.24f, 0.25f}, {0.26f, 0.27f}, {2.27f, 0.28f},
@@ -285,6 +320,23 @@ class QuantileHistMock : public QuantileHistMaker {
     }
   }
 
+  void TestGradientBasedSampling() {
+    size_t constexpr kMaxBins = 4;
+    GHistIndexMatrix gmat(dmat_.get(), kMaxBins);
+
+    RegTree tree = RegTree();
+    tree.param.UpdateAllowUnknown(cfg_);
+
+    std::vector<GradientPair> gpair =
+        { {0.10f, 0.24f}, {-0.20f, 0.24f}, {0.30f, 0.24f}, {-0.40f, 0.24f},
+          {0.50f, 0.29f}, {-0.60f, 0.29f}, {0.70f, 0.29f}, {-0.80f, 0.29f} };
+    if (double_builder_) {
+      double_builder_->TestGradientBasedSampling(gmat, &gpair, dmat_.get(), tree);
+    } else {
+      float_builder_->TestGradientBasedSampling(gmat, &gpair, dmat_.get(), tree);
+    }
+  }
+
   void TestApplySplit() {
     RegTree tree = RegTree();
     tree.param.UpdateAllowUnknown(cfg_);
@@ -318,6 +370,15 @@ TEST(QuantileHist, InitDataSampling) {
   maker_float.TestInitDataSampling();
 }
 
+TEST(QuantileHist, GradientBasedSampling) {
+  std::vector<std::pair<std::string, std::string>> cfg
+      {{"num_feature", std::to_string(QuantileHistMock::GetNumColumns())},
+       {"subsample", "0.5"},
+       {"sampling_method", "gradient_based"}};
+  QuantileHistMock maker(cfg);
+  maker.TestGradientBasedSampling();
+}
+
 TEST(QuantileHist, ApplySplit) {
   std::vector<std::pair<std::string, std::string>> cfg
       {{"num_feature", std::to_string(QuantileHistMock::GetNumColumns())},
@@ -331,5 +392,321 @@ TEST(QuantileHist, ApplySplit) {
   maker_float.TestApplySplit();
 }
 
+TEST(QuantileHist, LossGuideBatch) {
+  size_t constexpr kRows = 512, kCols = 16;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.2).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, 0.0f, 1.0f);
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  for (std::string batch : {"1", "4", "64"}) {
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    updater->Configure(Args{{"grow_policy", "lossguide"},
+                            {"max_depth", "0"},
+                            {"max_leaves", "17"},
+                            {"lossguide_batch_size", batch}});
+    RegTree tree;
+    tree.param.num_feature = kCols;
+    updater->Update(&gpair, p_dmat.get(), {&tree});
+    size_t n_leaves = 0;
+    tree.WalkTree([&](bst_node_t nidx) {
+      n_leaves += tree[nidx].IsLeaf();
+      return true;
+    });
+    // Entries exceeding max_leaves in a batch are discarded.
+    ASSERT_LE(n_leaves, 17);
+    ASSERT_GT(n_leaves, 1);
+  }
+}
+
+TEST(QuantileHist, QuantizeGradient) {
+  size_t constexpr kRows = 512, kCols = 16;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.2).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, 0.0f, 1.0f);
+  auto h_gpair = gpair.ConstHostVector();
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  auto train = [&](int32_t n_threads) {
+    auto orig = omp_get_max_threads();
+    omp_set_num_threads(n_threads);
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    updater->Configure(Args{{"quantize_gradient", "true"}, {"max_depth", "4"}});
+    RegTree tree;
+    tree.param.num_feature = kCols;
+    updater->Update(&gpair, p_dmat.get(), {&tree});
+    omp_set_num_threads(orig);
+    Json model{Object()};
+    tree.SaveModel(&model);
+    return std::make_pair(tree, model);
+  };
+
+  auto single = train(1);
+  auto multi = train(4);
+  // Integer histograms are independent of the number of threads.
+  ASSERT_EQ(single.second, multi.second);
+  // Gradient is quantized on a copy.
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_EQ(gpair.ConstHostVector()[i], h_gpair[i]);
+  }
+
+  auto const& tree = single.first;
+  ASSERT_GT(tree.NumExtraNodes(), 0);
+  double sum_hess = 0;
+  for (auto const& g : h_gpair) {
+    sum_hess += g.GetHess();
+  }
+  // Rounding error of each hessian is at most half of the unit, which is close to
+  // 1 / (2 * int16 max) here.
+  ASSERT_NEAR(tree.Stat(RegTree::kRoot).sum_hess, sum_hess,
+              kRows / static_cast<double>(GradientQuantizer::kMaxValue));
+}
+
+TEST(QuantileHist, DeterministicHistogram) {
+  size_t constexpr kRows = 2048, kCols = 16;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.2).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, -1.0f, 1.0f);
+  auto h_gpair = gpair.ConstHostVector();
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  auto train = [&](int32_t n_threads, std::string single_precision) {
+    auto orig = omp_get_max_threads();
+    omp_set_num_threads(n_threads);
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    updater->Configure(Args{{"deterministic_histogram", "true"},
+                            {"single_precision_histogram", single_precision},
+                            {"max_depth", "6"}});
+    RegTree tree;
+    tree.param.num_feature = kCols;
+    updater->Update(&gpair, p_dmat.get(), {&tree});
+    omp_set_num_threads(orig);
+    Json model{Object()};
+    tree.SaveModel(&model);
+    return std::make_pair(tree, model);
+  };
+
+  auto single = train(1, "false");
+  ASSERT_EQ(single.second, train(3, "false").second);
+  ASSERT_EQ(single.second, train(8, "false").second);
+  // Histograms are built in double precision.
+  ASSERT_EQ(single.second, train(8, "true").second);
+  // Gradient is rounded on a copy.
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_EQ(gpair.ConstHostVector()[i], h_gpair[i]);
+  }
+
+  auto const& tree = single.first;
+  ASSERT_GT(tree.NumExtraNodes(), 0);
+  double sum_hess = 0;
+  for (auto const& g : h_gpair) {
+    sum_hess += g.GetHess();
+  }
+  ASSERT_NEAR(tree.Stat(RegTree::kRoot).sum_hess, sum_hess, 1e-6);
+}
+
+TEST(QuantileHist, TuneThreads) {
+  size_t constexpr kRows = 1024, kCols = 16, kIters = 8;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.2).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, 0.0f, 1.0f);
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  auto train = [&](std::string tune) {
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    // Integer histograms are independent of the number of threads.
+    updater->Configure(
+        Args{{"quantize_gradient", "true"}, {"max_depth", "4"}, {"tune_threads", tune}});
+    std::vector<Json> models;
+    for (size_t i = 0; i < kIters; ++i) {
+      RegTree tree;
+      tree.param.num_feature = kCols;
+      updater->Update(&gpair, p_dmat.get(), {&tree});
+      Json model{Object()};
+      tree.SaveModel(&model);
+      models.push_back(model);
+    }
+    return models;
+  };
+
+  auto tuned = train("true");
+  auto fixed = train("false");
+  for (size_t i = 0; i < kIters; ++i) {
+    ASSERT_EQ(tuned[i], fixed[i]);
+  }
+}
+
+TEST(QuantileHist, FeatureBundling) {
+  size_t constexpr kRows = 1024, kGroups = 4, kLevels = 8, kDense = 2;
+  size_t constexpr kCols = kGroups * kLevels + kDense;
+  auto p_dmat =
+      GetDMatrixFromData(GenerateOneHotColumns(kRows, kGroups, kLevels, kDense), kRows, kCols);
+  auto gpair = GenerateRandomGradients(kRows, -1.0f, 1.0f);
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  auto train = [&](std::string bundling, std::string policy) {
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    // Integer histograms make the recovered bins exact.
+    updater->Configure(Args{{"quantize_gradient", "true"},
+                            {"grow_policy", policy},
+                            {"max_depth", "6"},
+                            {"feature_bundling", bundling}});
+    RegTree tree;
+    tree.param.num_feature = kCols;
+    updater->Update(&gpair, p_dmat.get(), {&tree});
+    Json model{Object()};
+    tree.SaveModel(&model);
+    return model;
+  };
+  for (std::string policy : {"depthwise", "lossguide"}) {
+    ASSERT_EQ(train("true", policy), train("false", policy));
+  }
+}
+
+TEST(QuantileHist, DenseMissing) {
+  size_t constexpr kRows = 1024, kCols = 16;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.05).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, -1.0f, 1.0f);
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  auto train = [&](std::string ratio, std::string policy) {
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    // Integer histograms make the sum of root histogram exact.
+    updater->Configure(Args{{"quantize_gradient", "true"},
+                            {"grow_policy", policy},
+                            {"max_depth", "6"},
+                            {"dense_missing_ratio", ratio}});
+    RegTree tree;
+    tree.param.num_feature = kCols;
+    updater->Update(&gpair, p_dmat.get(), {&tree});
+    Json model{Object()};
+    tree.SaveModel(&model);
+    return model;
+  };
+  for (std::string policy : {"depthwise", "lossguide"}) {
+    ASSERT_EQ(train("0.9", policy), train("0", policy));
+  }
+}
+
+TEST(QuantileHist, NothingToPrune) {
+  size_t constexpr kRows = 1024, kCols = 16;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.2).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, 0.0f, 1.0f);
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+  Args args{{"max_depth", "6"}, {"min_split_loss", "0.5"}};
+
+  std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+      "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+  updater->Configure(args);
+  RegTree tree;
+  tree.param.num_feature = kCols;
+  updater->Update(&gpair, p_dmat.get(), {&tree});
+  ASSERT_GT(tree.NumExtraNodes(), 0);
+  Json grown{Object()};
+  tree.SaveModel(&grown);
+
+  // The pruner is no longer run after growing, make sure it has nothing to do.
+  std::unique_ptr<TreeUpdater> pruner{
+      TreeUpdater::Create("prune", &tparam, ObjInfo{ObjInfo::kRegression})};
+  pruner->Configure(args);
+  pruner->Update(&gpair, p_dmat.get(), {&tree});
+  Json pruned{Object()};
+  tree.SaveModel(&pruned);
+  ASSERT_EQ(grown, pruned);
+}
+
+TEST(QuantileHist, ConcurrentParallelTrees) {
+  size_t constexpr kRows = 512, kCols = 16, kTrees = 4;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.2).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, 0.0f, 1.0f);
+  auto h_gpair = gpair.ConstHostVector();
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  auto train = [&](std::string concurrency) {
+    common::GlobalRandom().seed(0);
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    // Integer histograms are independent of the number of threads used by each tree.
+    updater->Configure(Args{{"quantize_gradient", "true"},
+                            {"subsample", "0.5"},
+                            {"max_depth", "4"},
+                            {"parallel_tree_concurrency", concurrency}});
+    std::vector<RegTree> trees(kTrees);
+    std::vector<RegTree*> p_trees;
+    for (auto& tree : trees) {
+      tree.param.num_feature = kCols;
+      p_trees.push_back(&tree);
+    }
+    updater->Update(&gpair, p_dmat.get(), p_trees);
+    std::vector<Json> models;
+    for (auto const& tree : trees) {
+      Json model{Object()};
+      tree.SaveModel(&model);
+      models.push_back(model);
+    }
+    return models;
+  };
+
+  auto two = train("2");
+  auto four = train("4");
+  ASSERT_EQ(two.size(), kTrees);
+  for (size_t i = 0; i < kTrees; ++i) {
+    // Each tree samples with its own seed, independent of the scheduling.
+    ASSERT_EQ(two[i], four[i]);
+  }
+  // Trees are built with different samples.
+  ASSERT_FALSE(two[0] == two[1]);
+  // Gradient is copied for each tree.
+  for (size_t i = 0; i < kRows; ++i) {
+    ASSERT_EQ(gpair.ConstHostVector()[i], h_gpair[i]);
+  }
+}
+
+TEST(QuantileHist, FeatureParallel) {
+  size_t constexpr kRows = 256, kCols = 2048;
+  auto p_dmat = RandomDataGenerator(kRows, kCols, 0.95).Seed(3).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows, -1.0f, 1.0f);
+  auto tparam = CreateEmptyGenericParam(GenericParameter::kCpuId);
+
+  auto train = [&](std::string feature_parallel, std::string policy, RegTree* p_tree) {
+    std::unique_ptr<TreeUpdater> updater{TreeUpdater::Create(
+        "grow_quantile_histmaker", &tparam, ObjInfo{ObjInfo::kRegression})};
+    updater->Configure(Args{{"feature_parallel", feature_parallel},
+                            {"grow_policy", policy},
+                            {"max_depth", "6"},
+                            {"min_child_weight", "0"}});
+    p_tree->param.num_feature = kCols;
+    updater->Update(&gpair, p_dmat.get(), {p_tree});
+
+    // All rows are used, the prediction cache is updated with leaf values.
+    HostDeviceVector<float> predt(kRows, 0.0f);
+    linalg::VectorView<float> out{predt.HostSpan(), {kRows}, GenericParameter::kCpuId};
+    EXPECT_TRUE(updater->UpdatePredictionCache(p_dmat.get(), out));
+    return predt.HostVector();
+  };
+
+  for (std::string policy : {"depthwise", "lossguide"}) {
+    RegTree expected, tree;
+    auto expected_predt = train("false", policy, &expected);
+    auto predt = train("true", policy, &tree);
+    ASSERT_GT(expected.NumExtraNodes(), 0);
+    ASSERT_EQ(tree.GetNodes().size(), expected.GetNodes().size());
+    for (bst_node_t nidx = 0; nidx < tree.NumNodes(); ++nidx) {
+      ASSERT_EQ(tree[nidx].IsLeaf(), expected[nidx].IsLeaf());
+      if (tree[nidx].IsLeaf()) {
+        ASSERT_NEAR(tree[nidx].LeafValue(), expected[nidx].LeafValue(), kRtEps);
+      } else {
+        ASSERT_EQ(tree[nidx].SplitIndex(), expected[nidx].SplitIndex());
+        ASSERT_EQ(tree[nidx].SplitCond(), expected[nidx].SplitCond());
+        ASSERT_EQ(tree[nidx].DefaultLeft(), expected[nidx].DefaultLeft());
+      }
+    }
+    for (size_t i = 0; i < kRows; ++i) {
+      ASSERT_NEAR(predt[i], expected_predt[i], kRtEps);
+    }
+  }
+}
 }  // namespace tree
 }  // namespace xgboost
@@ -54,5 +54,58 @@ TEST(Updater, Refresh) {
   ASSERT_NEAR(0, tree.Stat(2).loss_chg, kEps);
 }
 
+TEST(Updater, RefreshMultipleTrees) {
+  bst_row_t constexpr kRows = 256;
+  bst_feature_t constexpr kCols = 4;
+  auto p_dmat = RandomDataGenerator{kRows, kCols, 0.0f}.Seed(1).GenerateDMatrix();
+  auto gpair = GenerateRandomGradients(kRows);
+  auto const& h_gpair = gpair.ConstHostVector();
+  std::vector<std::pair<std::string, std::string>> cfg{
+      {"num_feature", std::to_string(kCols)}, {"refresh_leaf", "0"}};
+
+  std::vector<RegTree> trees(3);
+  for (size_t t = 0; t < trees.size(); ++t) {
+    auto& tree = trees[t];
+    tree.param.UpdateAllowUnknown(cfg);
+    tree.ExpandNode(0, t, 0.5f, t % 2 == 0, 0.0, 0.2f, 0.8f, 0.0f, 0.0f, 0.0f, 0.0f);
+    tree.ExpandNode(tree[0].LeftChild(), (t + 1) % kCols, 0.3f, false, 0.0, 0.1f, 0.4f,
+                    0.0f, 0.0f, 0.0f, 0.0f);
+  }
+  std::vector<RegTree*> p_trees;
+  for (auto& tree : trees) {
+    p_trees.push_back(&tree);
+  }
+
+  auto lparam = CreateEmptyGenericParam(GPUIDX);
+  std::unique_ptr<TreeUpdater> refresher(
+      TreeUpdater::Create("refresh", &lparam, ObjInfo{ObjInfo::kRegression}));
+  refresher->Configure(cfg);
+  refresher->Update(&gpair, p_dmat.get(), p_trees);
+
+  for (auto const& tree : trees) {
+    std::vector<double> sum_hess(tree.param.num_nodes, 0.0);
+    for (auto const& batch : p_dmat->GetBatches<SparsePage>()) {
+      auto page = batch.GetView();
+      for (size_t i = 0; i < batch.Size(); ++i) {
+        RegTree::FVec feats;
+        feats.Init(kCols);
+        feats.Fill(page[i]);
+        auto const& h = h_gpair[batch.base_rowid + i].GetHess();
+        bst_node_t nidx = RegTree::kRoot;
+        sum_hess[nidx] += h;
+        while (!tree[nidx].IsLeaf()) {
+          auto fvalue = feats.GetFvalue(tree[nidx].SplitIndex());
+          nidx = fvalue < tree[nidx].SplitCond() ? tree[nidx].LeftChild()
+                                                  : tree[nidx].RightChild();
+          sum_hess[nidx] += h;
+        }
+      }
+    }
+    for (bst_node_t nidx = 0; nidx < tree.param.num_nodes; ++nidx) {
+      ASSERT_NEAR(tree.Stat(nidx).sum_hess, sum_hess[nidx], 1e-3);
+    }
+  }
+}
+
 }  // namespace tree
 }  // namespace xgboost
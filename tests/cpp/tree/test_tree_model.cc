@@ -6,6 +6,7 @@
 #include "xgboost/tree_model.h"
 #include "../../../src/common/bitfield.h"
 #include "../../../src/common/categorical.h"
+#include "../../../src/common/io.h"
 
 namespace xgboost {
 #if DMLC_IO_NO_ENDIAN_SWAP  // skip on big-endian machines
@@ -200,6 +201,17 @@ void CheckReload(RegTree const &tree) {
 
   auto same = out == saved;
   ASSERT_TRUE(same);
+
+  // Typed arrays are loaded back as normal arrays from text JSON.
+  for (auto mode : {std::ios::out, std::ios::binary}) {
+    std::string str;
+    Json::Dump(out, &str, mode);
+    RegTree from_str;
+    from_str.LoadModel(Json::Load(StringView{str}, mode));
+    Json resaved{Object()};
+    from_str.SaveModel(&resaved);
+    ASSERT_EQ(out, resaved);
+  }
 }
 
 TEST(Tree, CategoricalIO) {
@@ -433,12 +445,12 @@ TEST(Tree, JsonIO) {
   ASSERT_EQ(get<String>(tparam["num_nodes"]), "3");
   ASSERT_EQ(get<String>(tparam["size_leaf_vector"]), "0");
 
-  ASSERT_EQ(get<Array const>(j_tree["left_children"]).size(), 3ul);
-  ASSERT_EQ(get<Array const>(j_tree["right_children"]).size(), 3ul);
-  ASSERT_EQ(get<Array const>(j_tree["parents"]).size(), 3ul);
-  ASSERT_EQ(get<Array const>(j_tree["split_indices"]).size(), 3ul);
-  ASSERT_EQ(get<Array const>(j_tree["split_conditions"]).size(), 3ul);
-  ASSERT_EQ(get<Array const>(j_tree["default_left"]).size(), 3ul);
+  ASSERT_EQ(get<I32Array const>(j_tree["left_children"]).size(), 3ul);
+  ASSERT_EQ(get<I32Array const>(j_tree["right_children"]).size(), 3ul);
+  ASSERT_EQ(get<I32Array const>(j_tree["parents"]).size(), 3ul);
+  ASSERT_EQ(get<I32Array const>(j_tree["split_indices"]).size(), 3ul);
+  ASSERT_EQ(get<F32Array const>(j_tree["split_conditions"]).size(), 3ul);
+  ASSERT_EQ(get<U8Array const>(j_tree["default_left"]).size(), 3ul);
 
   RegTree loaded_tree;
   loaded_tree.LoadModel(j_tree);
@@ -446,6 +458,15 @@ TEST(Tree, JsonIO) {
 
   ASSERT_TRUE(loaded_tree == tree);
 
+  // Both text and binary JSON round trip.
+  for (auto mode : {std::ios::out, std::ios::binary}) {
+    std::string str;
+    Json::Dump(j_tree, &str, mode);
+    RegTree loaded;
+    loaded.LoadModel(Json::Load(StringView{str}, mode));
+    ASSERT_TRUE(loaded == tree);
+  }
+
   auto left = tree[0].LeftChild();
   auto right = tree[0].RightChild();
   tree.ExpandNode(left, 0, 0.0f, false, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
@@ -463,4 +484,38 @@ TEST(Tree, JsonIO) {
   ASSERT_EQ(loaded_tree[1].RightChild(), -1);
   ASSERT_TRUE(tree.Equal(loaded_tree));
 }
+
+TEST(Tree, MultiTargetIO) {
+  bst_group_t constexpr kTargets = 3;
+  RegTree tree;
+  tree.SetNumTargets(kTargets);
+  ASSERT_TRUE(tree.IsMultiTarget());
+  ASSERT_EQ(tree.NumTargets(), kTargets);
+  tree.ExpandNode(0, 1, 0.5f, true, 0.0f, 0.0f, 0.0f, 1.0f, 4.0f, 1.0f, 3.0f);
+  std::vector<float> left{0.1f, 0.2f, 0.3f}, right{-0.1f, -0.2f, -0.3f};
+  tree.SetLeafVector(tree[0].LeftChild(), left);
+  tree.SetLeafVector(tree[0].RightChild(), right);
+  ASSERT_EQ(tree.LeafVector(tree[0].RightChild())[2], -0.3f);
+
+  Json j_tree{Object()};
+  tree.SaveModel(&j_tree);
+  ASSERT_EQ(get<String>(j_tree["tree_param"]["size_leaf_vector"]), "3");
+  ASSERT_EQ(get<F32Array const>(j_tree["leaf_vector"]).size(), 3ul * kTargets);
+  RegTree loaded_json;
+  loaded_json.LoadModel(j_tree);
+  ASSERT_TRUE(loaded_json == tree);
+  ASSERT_TRUE(loaded_json.Equal(tree));
+
+  std::string buffer;
+  common::MemoryBufferStream fo(&buffer);
+  tree.Save(&fo);
+  common::MemoryFixSizeBuffer fi(&buffer[0], buffer.size());
+  RegTree loaded_binary;
+  loaded_binary.Load(&fi);
+  ASSERT_TRUE(loaded_binary == tree);
+
+  // Leaf vectors take part in comparison.
+  loaded_binary.SetLeafVector(loaded_binary[0].LeftChild(), right);
+  ASSERT_FALSE(loaded_binary.Equal(tree));
+}
 }  // namespace xgboost
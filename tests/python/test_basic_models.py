@@ -189,6 +189,34 @@ class TestModels:
     def test_custom_objective(self):
         self.run_custom_objective()
 
+    def test_boost_from_array(self):
+        rng = np.random.RandomState(1994)
+        grad = rng.randn(dtrain.num_row())
+        hess = rng.uniform(0.1, 1.0, dtrain.num_row())
+
+        # numpy arrays are passed by array interface, lists are copied.
+        from_list = xgb.Booster({"max_depth": 2}, [dtrain])
+        from_array = xgb.Booster({"max_depth": 2}, [dtrain])
+        for _ in range(2):
+            from_list.boost(dtrain, list(grad.astype(np.float32)), list(hess.astype(np.float32)))
+            from_array.boost(dtrain, grad, hess)
+        np.testing.assert_allclose(from_list.predict(dtest), from_array.predict(dtest))
+
+    def test_eval_cohorts(self):
+        booster = xgb.train({"max_depth": 2, "eval_metric": "logloss"}, dtrain, 2)
+        cohorts = np.arange(dtest.num_row()) % 2
+        booster.set_eval_cohorts(dtest, cohorts)
+        msg = booster.eval_set([(dtest, "test")])
+        scores = dict(kv.split(":") for kv in msg.split()[1:])
+        assert set(scores.keys()) == {"test-logloss", "test[0]-logloss", "test[1]-logloss"}
+
+        sliced = dtest.slice(np.where(cohorts == 1)[0])
+        expected = booster.eval_set([(sliced, "test[1]")]).split()[1].split(":")[1]
+        assert scores["test[1]-logloss"] == expected
+
+        booster.set_eval_cohorts(dtest, None)
+        assert "test[0]" not in booster.eval_set([(dtest, "test")])
+
     def test_multi_eval_metric(self):
         watchlist = [(dtest, 'eval'), (dtrain, 'train')]
         param = {'max_depth': 2, 'eta': 0.2, 'verbosity': 1,
@@ -276,6 +304,28 @@ class TestModels:
         os.remove(model_path)
         assert locale.getpreferredencoding(False) == loc
 
+    def test_model_ubj_io(self):
+        X = np.random.random((10, 3))
+        y = np.random.random((10,))
+        dtrain = xgb.DMatrix(X, y)
+        bst = xgb.train({'tree_method': 'hist'}, dtrain, num_boost_round=4)
+        predt = bst.predict(dtrain)
+        j_model = bst.save_raw(raw_format='json')
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            model_path = os.path.join(tmpdir, 'model.ubj')
+            bst.save_model(model_path)
+            from_file = xgb.Booster(model_file=model_path)
+            assert from_file.save_raw(raw_format='json') == j_model
+            np.testing.assert_allclose(from_file.predict(dtrain), predt)
+
+        buf = bst.save_raw(raw_format='ubj')
+        assert buf[0:1] == b'{'
+        from_raw = xgb.Booster()
+        from_raw.load_model(buf)
+        assert from_raw.save_raw(raw_format='ubj') == buf
+        assert from_raw.save_raw(raw_format='json') == j_model
+
     @pytest.mark.skipif(**tm.no_json_schema())
     def test_json_io_schema(self):
         import jsonschema
@@ -190,3 +190,43 @@ eval[test] = {data_path}
 
             subprocess.run([exe, config_path])
             assert os.path.exists(model_out_cli)
+
+    def test_cli_predict_stream(self):
+        exe = self.get_exe()
+        data_path = "{root}/demo/data/agaricus.txt.test?format=libsvm".format(
+            root=self.PROJECT_ROOT)
+        seed = 1994
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            model_out_cli = os.path.join(tmpdir, 'test_predict_stream.json')
+            config_path = os.path.join(tmpdir, 'test_predict_stream.conf')
+
+            def run(task, name_pred, extra=''):
+                conf = self.template.format(data_path=data_path,
+                                            seed=seed,
+                                            task=task,
+                                            model_in=model_out_cli
+                                            if task != 'train' else 'NULL',
+                                            model_out=model_out_cli
+                                            if task == 'train' else 'NULL',
+                                            test_path=data_path,
+                                            name_pred=name_pred,
+                                            model_dir='NULL')
+                with open(config_path, 'w') as fd:
+                    fd.write(conf + extra)
+                subprocess.run([exe, config_path], check=True)
+
+            run('train', 'NULL')
+            predict_out = os.path.join(tmpdir, 'pred.txt')
+            run('pred', predict_out)
+            expected = numpy.loadtxt(predict_out)
+
+            stream_out = os.path.join(tmpdir, 'pred_stream.txt')
+            run('pred_stream', stream_out, 'pred_chunk_rows = 100\n')
+            numpy.testing.assert_allclose(numpy.loadtxt(stream_out), expected)
+
+            binary_out = os.path.join(tmpdir, 'pred_stream.bin')
+            run('pred_stream', binary_out,
+                'pred_chunk_rows = 333\npred_format = binary\n')
+            predt = numpy.fromfile(binary_out, dtype=numpy.float32)
+            numpy.testing.assert_allclose(predt, expected)
@@ -195,6 +195,29 @@ class TestDMatrix:
         sliced = d.slice(ridxs_arr)
         np.testing.assert_equal(sliced.get_label(), y[2:7])
 
+    def test_quantize(self):
+        from concurrent.futures import ThreadPoolExecutor
+
+        X = rng.randn(256, 8)
+        y = rng.randn(256)
+        Xy = xgb.DMatrix(X, y)
+        Xy.quantize(max_bin=64)
+        params = {"tree_method": "hist", "max_bin": 64, "nthread": 1}
+
+        def train(depth):
+            return xgb.train(
+                {"max_depth": depth, **params}, Xy, num_boost_round=4
+            ).predict(Xy)
+
+        depths = [2, 3, 4, 5]
+        with ThreadPoolExecutor(max_workers=len(depths)) as executor:
+            concurrent = list(executor.map(train, depths))
+        for depth, predt in zip(depths, concurrent):
+            expected = xgb.train(
+                {"max_depth": depth, **params}, xgb.DMatrix(X, y), num_boost_round=4
+            ).predict(Xy)
+            np.testing.assert_allclose(predt, expected)
+
     def test_feature_names_slice(self):
         data = np.random.randn(5, 5)
 
@@ -3,7 +3,9 @@ import xgboost as xgb
 import pytest
 import testing as tm
 import numpy as np
+import socket
 import sys
+import threading
 
 if sys.platform.startswith("win"):
     pytest.skip("Skipping dask tests on Windows", allow_module_level=True)
@@ -22,6 +24,21 @@ def test_rabit_tracker():
     xgb.rabit.finalize()
 
 
+def test_rabit_tracker_topology():
+    tracker = RabitTracker(
+        hostIP='127.0.0.1', n_workers=4,
+        topology={'127.0.0.2': 'rack0', '127.0.0.3': 'rack1', '127.0.0.4': 'rack0'}
+    )
+    assert tracker.location('127.0.0.2') == tracker.location('127.0.0.4')
+    assert tracker.location('127.0.0.5') == '127.0.0.5'
+    _, _, tracker.ring_map = tracker.get_link_map(4)
+    # Ranks are assigned in the order of location, then host.
+    hosts = sorted(['127.0.0.3', '127.0.0.2', '127.0.0.4', '127.0.0.2'],
+                   key=lambda h: (tracker.location(h), h))
+    tracker.hosts = dict(enumerate(hosts))
+    assert tracker.ring_crossings() == 2
+
+
 def run_rabit_ops(client, n_workers):
     from test_with_dask import _get_client_workers
     from xgboost.dask import RabitContext, _get_rabit_args
@@ -59,3 +76,78 @@ def test_rabit_ops():
     with LocalCluster(n_workers=n_workers) as cluster:
         with Client(cluster) as client:
             run_rabit_ops(client, n_workers)
+
+
+def run_fake_worker(port, task_id, links):
+    """Worker side of the tracker protocol, same as `AllreduceBase::ReConnectLinks`."""
+    from xgboost.tracker import ExSocket, kMagic
+
+    def connect(cmd, rank):
+        sock = socket.create_connection(('127.0.0.1', port))
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        tracker = ExSocket(sock)
+        tracker.sendint(kMagic)
+        assert tracker.recvint() == kMagic
+        tracker.sendint(rank)
+        tracker.sendint(-1)
+        tracker.sendstr(task_id)
+        tracker.sendstr(cmd)
+        return tracker
+
+    tracker = connect('start', -1)
+    rank = tracker.recvint()
+    tracker.recvint()           # parent
+    tracker.recvint()           # world size
+    for _ in range(tracker.recvint()):
+        tracker.recvint()       # tree neighbors
+    tracker.recvint()           # ring prev
+    tracker.recvint()           # ring next
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.bind(('127.0.0.1', 0))
+    listener.listen(16)
+    tracker.sendint(0)          # no good links
+    n_conn = tracker.recvint()
+    n_accept = tracker.recvint()
+    peers = []
+    for _ in range(n_conn):
+        host = tracker.recvstr()
+        hport = tracker.recvint()
+        hrank = tracker.recvint()
+        peer = ExSocket(socket.create_connection((host, hport)))
+        peer.sendint(rank)
+        assert peer.recvint() == hrank
+        peers.append(hrank)
+    tracker.sendint(0)          # no error
+    tracker.sendint(listener.getsockname()[1])
+    tracker.sock.close()
+    for _ in range(n_accept):
+        fd, _ = listener.accept()
+        peer = ExSocket(fd)
+        peer.sendint(rank)
+        peers.append(peer.recvint())
+    listener.close()
+    links[rank] = set(peers)
+    connect('shutdown', rank).sock.close()
+
+
+def test_rabit_tracker_bootstrap():
+    n_workers = 64
+    tracker = RabitTracker(hostIP='127.0.0.1', n_workers=n_workers)
+    tracker.start(n_workers)
+    links = {}
+    workers = [
+        threading.Thread(target=run_fake_worker, args=(tracker.port, str(i), links))
+        for i in range(n_workers)
+    ]
+    for w in workers:
+        w.start()
+    for w in workers:
+        w.join()
+    tracker.join()
+
+    tree_map, _, ring_map = tracker.get_link_map(n_workers)
+    assert len(links) == n_workers
+    for r in range(n_workers):
+        expected = set(tree_map[r]) | set(ring_map[r])
+        expected.discard(r)
+        assert links[r] == expected
@@ -0,0 +1,94 @@
+# -*- coding: utf-8 -*-
+import pytest
+import numpy as np
+
+import testing as tm
+import xgboost as xgb
+
+try:
+    import pyarrow as pa
+except ImportError:
+    pass
+
+pytestmark = pytest.mark.skipif(**tm.no_arrow())
+
+
+class TestArrow:
+    def test_arrow_table(self):
+        table = pa.table({
+            "a": pa.array([1, 2, None, 4], type=pa.int32()),
+            "b": pa.array([1.5, 2.5, 3.5, np.nan], type=pa.float64()),
+            "c": pa.array([True, False, True, None]),
+        })
+        dm = xgb.DMatrix(table)
+        assert dm.num_row() == 4
+        assert dm.num_col() == 3
+        assert dm.feature_names == ["a", "b", "c"]
+
+        X = np.array(
+            [[1, 1.5, 1], [2, 2.5, 0], [np.nan, 3.5, 1], [4, np.nan, np.nan]],
+            dtype=np.float32
+        )
+        y = np.array([0, 1, 0, 1])
+        names = ["a", "b", "c"]
+        booster = xgb.train(
+            {"min_child_weight": 0},
+            xgb.DMatrix(X, y, feature_names=names),
+            num_boost_round=4,
+        )
+        np.testing.assert_allclose(
+            booster.predict(xgb.DMatrix(X, feature_names=names)),
+            booster.predict(dm),
+            rtol=1e-6,
+        )
+
+        # Sliced batch with offset.
+        batch = table.to_batches()[0].slice(1, 2)
+        dm = xgb.DMatrix(batch)
+        assert dm.num_row() == 2
+        expected = booster.predict(xgb.DMatrix(X[1:3], feature_names=names))
+        np.testing.assert_allclose(expected, booster.predict(dm), rtol=1e-6)
+        np.testing.assert_allclose(expected, booster.inplace_predict(batch), rtol=1e-6)
+
+    def test_arrow_categorical(self):
+        rng = np.random.default_rng(1994)
+        n_samples = 256
+        cat = pa.array(
+            rng.choice(["x", "y", "z"], size=n_samples)
+        ).dictionary_encode()
+        num = pa.array(rng.normal(size=n_samples).astype(np.float32))
+        table = pa.table({"cat": cat, "num": num})
+        y = rng.normal(size=n_samples)
+
+        with pytest.raises(ValueError):
+            xgb.DMatrix(table, label=y)
+
+        dm = xgb.DMatrix(table, label=y, enable_categorical=True)
+        assert dm.feature_types == ["c", "q"]
+        booster = xgb.train(
+            {"tree_method": "hist", "max_cat_to_onehot": 1}, dm, num_boost_round=8
+        )
+        predt = booster.predict(dm)
+        inplace = booster.inplace_predict(table)
+        np.testing.assert_allclose(predt, inplace, rtol=1e-6)
+
+    def test_arrow_inplace_predict(self):
+        rng = np.random.default_rng(1994)
+        X = rng.normal(size=(128, 4)).astype(np.float32)
+        X[rng.random(size=X.shape) > 0.8] = np.nan
+        y = rng.normal(size=128)
+        names = [str(i) for i in range(X.shape[1])]
+        booster = xgb.train(
+            {"tree_method": "hist"},
+            xgb.DMatrix(X, y, feature_names=names),
+            num_boost_round=4,
+        )
+        table = pa.table({name: X[:, i] for i, name in enumerate(names)})
+        np.testing.assert_allclose(
+            booster.inplace_predict(X), booster.inplace_predict(table), rtol=1e-6
+        )
+        np.testing.assert_allclose(
+            booster.predict(xgb.DMatrix(X, feature_names=names)),
+            booster.predict(xgb.DMatrix(table)),
+            rtol=1e-6,
+        )
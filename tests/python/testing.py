@@ -60,6 +60,13 @@ def no_dt():
             'reason': 'Datatable is not installed.'}
 
 
+def no_arrow():
+    import importlib.util
+    spec = importlib.util.find_spec('pyarrow')
+    return {'condition': spec is None,
+            'reason': 'pyarrow is not installed.'}
+
+
 def no_matplotlib():
     reason = 'Matplotlib is not installed.'
     try: